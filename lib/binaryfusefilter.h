@@ -543,6 +543,46 @@ template <typename T> class binary_fuse_t
         return f == 0;
     }
 
+    // Same as contain, for each of keys. Keys are processed in groups: the
+    // fingerprint positions of every key in a group are computed and
+    // prefetched before any fingerprint is read, so the cache misses of
+    // different keys overlap instead of happening one after the other.
+    void
+    contain_batch(std::vector<uint64_t> const& keys,
+                  std::vector<bool>& result) const
+    {
+        ZoneScoped;
+        ZoneValue(static_cast<int64_t>(keys.size()));
+        constexpr size_t GROUP_SIZE = 16;
+
+        result.resize(keys.size());
+        uint64_t groupHashes[GROUP_SIZE];
+        binary_hashes_t groupPositions[GROUP_SIZE];
+        for (size_t start = 0; start < keys.size(); start += GROUP_SIZE)
+        {
+            size_t const n = std::min(GROUP_SIZE, keys.size() - start);
+            for (size_t i = 0; i < n; ++i)
+            {
+                groupHashes[i] = sip_hash24(keys[start + i], Seed);
+                groupPositions[i] = hash_batch(groupHashes[i]);
+#if defined(__GNUC__) || defined(__clang__)
+                __builtin_prefetch(Fingerprints.data() + groupPositions[i].h0);
+                __builtin_prefetch(Fingerprints.data() + groupPositions[i].h1);
+                __builtin_prefetch(Fingerprints.data() + groupPositions[i].h2);
+#endif
+            }
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                T f = binary_fuse_fingerprint(groupHashes[i]);
+                f ^= Fingerprints.at(groupPositions[i].h0) ^
+                     Fingerprints.at(groupPositions[i].h1) ^
+                     Fingerprints.at(groupPositions[i].h2);
+                result[start + i] = f == 0;
+            }
+        }
+    }
+
     // report memory usage
     size_t
     size_in_bytes() const
@@ -64,8 +64,13 @@ connection::do_read()
             }
             else if (result == request_parser::good)
             {
-                request_handler_.handle_request(request_, reply_);
-                do_write();
+                // The reply may be finished on another thread, so it is
+                // written from the socket's executor
+                request_handler_.handle_request(
+                    request_, reply_, [this, self]() {
+                        asio::post(socket_.get_executor(),
+                                   [this, self]() { do_write(); });
+                    });
             }
             else
             {
@@ -54,7 +54,32 @@ void server::add404(routeHandler callback)
 void
 server::addRoute(const std::string& routeName, routeHandler callback)
 {
-    mRoutes[routeName] = callback;
+    addAsyncRoute(routeName, [callback](const std::string& params,
+                                        std::string& content,
+                                        std::function<void()> done) {
+        callback(params, content);
+        if (done)
+        {
+            done();
+        }
+    });
+}
+
+void
+server::addAsyncRoute(const std::string& routeName,
+                      asyncRouteHandler callback, std::string contentType)
+{
+    mRoutes[routeName] = {callback, std::move(contentType)};
+}
+
+static void
+set_content_headers(reply& rep, const std::string& contentType)
+{
+    rep.headers.resize(2);
+    rep.headers[0].name = "Content-Length";
+    rep.headers[0].value = std::to_string(rep.content.size());
+    rep.headers[1].name = "Content-Type";
+    rep.headers[1].value = contentType;
 }
 
 void
@@ -87,12 +112,21 @@ server::~server()
 
 void
 server::handle_request(const request& req, reply& rep)
+{
+    handle_request(req, rep, nullptr);
+}
+
+void
+server::handle_request(const request& req, reply& rep,
+                       std::function<void()> done)
 {
     // Decode url to path.
     std::string request_path;
     if (!url_decode(req.uri, request_path))
     {
         rep = reply::stock_reply(reply::bad_request);
+        if (done)
+            done();
         return;
     }
 
@@ -113,34 +147,39 @@ server::handle_request(const request& req, reply& rep)
     auto it = mRoutes.find(command);
     if (it != mRoutes.end())
     {
-        it->second(params, rep.content);
-
+        auto const& contentType = it->second.contentType;
         rep.status = reply::ok;
-        rep.headers.resize(2);
-        rep.headers[0].name = "Content-Length";
-        rep.headers[0].value = std::to_string(rep.content.size());
-        rep.headers[1].name = "Content-Type";
-        rep.headers[1].value = "application/json";
-    }
-    else
-    {
-        it = mRoutes.find("404");
-        if (it != mRoutes.end())
+        if (done)
         {
-            it->second(params, rep.content);
-
-            rep.status = reply::not_found;
-            rep.headers.resize(2);
-            rep.headers[0].name = "Content-Length";
-            rep.headers[0].value = std::to_string(rep.content.size());
-            rep.headers[1].name = "Content-Type";
-            rep.headers[1].value = "text/html";
-        } else
+            // rep is owned by the caller until done is called
+            it->second.handler(params, rep.content,
+                               [&rep, contentType, done = std::move(done)]() {
+                                   set_content_headers(rep, contentType);
+                                   done();
+                               });
+        }
+        else
         {
-            rep = reply::stock_reply(reply::not_found);
-            return;
+            it->second.handler(params, rep.content, nullptr);
+            set_content_headers(rep, contentType);
         }
+        return;
+    }
+
+    it = mRoutes.find("404");
+    if (it != mRoutes.end())
+    {
+        it->second.handler(params, rep.content, nullptr);
+
+        rep.status = reply::not_found;
+        set_content_headers(rep, "text/html");
+    }
+    else
+    {
+        rep = reply::stock_reply(reply::not_found);
     }
+    if (done)
+        done();
 }
 
 bool
@@ -30,6 +30,12 @@ class server
 
 public:
     typedef std::function<void(const std::string&, std::string&)> routeHandler;
+    /// Handler of a route that may finish its reply later: it fills the
+    /// content and then calls the completion, from any thread. The
+    /// completion is empty when the reply is needed right away, in which case
+    /// the content must be filled before the handler returns.
+    typedef std::function<void(const std::string&, std::string&,
+                               std::function<void()>)> asyncRouteHandler;
     server(const server&) = delete;
     server& operator=(const server&) = delete;
 
@@ -42,10 +48,19 @@ public:
     ~server();
 
     void addRoute(const std::string& routeName, routeHandler callback);
+    void addAsyncRoute(const std::string& routeName,
+                       asyncRouteHandler callback,
+                       std::string contentType = "application/json");
     void add404(routeHandler callback);
 
+    /// Handles the request synchronously, rep is ready when this returns.
     void handle_request(const request& req, reply& rep);
 
+    /// Calls done once rep is ready, which may be on another thread if the
+    /// route is asynchronous.
+    void handle_request(const request& req, reply& rep,
+                        std::function<void()> done);
+
     static void parseParams(const std::string& params, std::map<std::string, std::string>& retMap);
 
 private:
@@ -71,7 +86,12 @@ private:
     /// The next socket to be accepted.
     asio::ip::tcp::socket socket_;
 
-    std::map<std::string, routeHandler> mRoutes;
+    struct route
+    {
+        asyncRouteHandler handler;
+        std::string contentType;
+    };
+    std::map<std::string, route> mRoutes;
 };
 
 } // namespace server
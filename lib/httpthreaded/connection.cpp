@@ -10,6 +10,9 @@
 
 #include "connection.hpp"
 #include "server.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
 #include <utility>
 #include <vector>
 
@@ -20,8 +23,56 @@ namespace httpThreaded
 namespace server
 {
 
+namespace
+{
+
+// How long a connection may go without receiving anything before it is closed
+constexpr std::chrono::seconds IDLE_TIMEOUT(30);
+
+bool
+equals_ignore_case(const std::string& a, const char* b)
+{
+    std::size_t i = 0;
+    for (; i < a.size() && b[i]; ++i)
+    {
+        if (std::tolower(static_cast<unsigned char>(a[i])) !=
+            std::tolower(static_cast<unsigned char>(b[i])))
+        {
+            return false;
+        }
+    }
+    return i == a.size() && !b[i];
+}
+
+// HTTP/1.1 connections persist unless the client says otherwise; HTTP/1.0 ones
+// only if the client asks
+bool
+wants_keep_alive(const request& req)
+{
+    for (auto const& h : req.headers)
+    {
+        if (equals_ignore_case(h.name, "Connection"))
+        {
+            if (equals_ignore_case(h.value, "close"))
+            {
+                return false;
+            }
+            if (equals_ignore_case(h.value, "keep-alive"))
+            {
+                return true;
+            }
+        }
+    }
+    return req.http_version_major > 1 ||
+           (req.http_version_major == 1 && req.http_version_minor >= 1);
+}
+}
+
 connection::connection(asio::ip::tcp::socket socket, server& handler)
-    : socket_(std::move(socket)), request_handler_(handler), received_count_(0)
+    : socket_(std::move(socket))
+    , request_handler_(handler)
+    , idle_timer_(socket_.get_executor())
+    , received_count_(0)
 {
 }
 
@@ -31,36 +82,37 @@ connection::start()
     do_read();
 }
 
+void
+connection::start_idle_timer()
+{
+    auto self(shared_from_this());
+    idle_timer_.expires_after(IDLE_TIMEOUT);
+    idle_timer_.async_wait([this, self](asio::error_code ec) {
+        // The timer may have been pushed back after this wait completed, so
+        // check the deadline rather than trusting ec alone.
+        if (ec != asio::error::operation_aborted &&
+            idle_timer_.expiry() <= asio::steady_timer::clock_type::now())
+        {
+            asio::error_code ignored_ec;
+            socket_.close(ignored_ec);
+        }
+    });
+}
+
 void
 connection::do_read()
 {
     auto self(shared_from_this());
+    start_idle_timer();
     socket_.async_read_some(
         asio::buffer(buffer_),
         [this, self](asio::error_code ec, std::size_t bytes_transferred) {
+            idle_timer_.cancel();
             if (!ec)
             {
-                request_parser::result_type result;
-                std::tie(result, std::ignore) =
-                    request_parser_.parse(request_, buffer_.data(),
-                                          buffer_.data() + bytes_transferred);
-                received_count_ += bytes_transferred;
-
-                if (result == request_parser::bad ||
-                    received_count_ > MAX_REQUEST_SIZE)
-                {
-                    reply_ = reply::stock_reply(reply::bad_request);
-                    do_write();
-                }
-                else if (result == request_parser::good)
-                {
-                    request_handler_.handle_request(request_, reply_);
-                    do_write();
-                }
-                else
-                {
-                    do_read();
-                }
+                parsed_ = 0;
+                buffered_ = bytes_transferred;
+                do_parse();
             }
             // If an error occurs then no new asynchronous operations are
             // started. This means that all shared_ptr references to the
@@ -70,28 +122,93 @@ connection::do_read()
         });
 }
 
+void
+connection::do_parse()
+{
+    request_parser::result_type result;
+    char* parse_end;
+    std::tie(result, parse_end) =
+        request_parser_.parse(request_, buffer_.data() + parsed_,
+                              buffer_.data() + buffered_);
+    std::size_t consumed = parse_end - (buffer_.data() + parsed_);
+    parsed_ += consumed;
+    received_count_ += consumed;
+
+    if (result == request_parser::bad || received_count_ > MAX_REQUEST_SIZE)
+    {
+        // The rest of the stream can't be trusted to start a new request
+        keep_alive_ = false;
+        reply_ = reply::stock_reply(reply::bad_request);
+        do_write();
+    }
+    else if (result == request_parser::good)
+    {
+        keep_alive_ = wants_keep_alive(request_);
+        request_handler_.handle_request(request_, reply_);
+        do_write();
+    }
+    else
+    {
+        do_read();
+    }
+}
+
+void
+connection::reset_for_next_request()
+{
+    // clear() keeps the capacity of the strings and vectors around for the
+    // next request
+    request_.method.clear();
+    request_.uri.clear();
+    request_.headers.clear();
+    request_.body.clear();
+    request_parser_.reset();
+    received_count_ = 0;
+    reply_.headers.clear();
+    reply_.content.clear();
+}
+
 void
 connection::do_write()
 {
     auto self(shared_from_this());
-    asio::async_write(socket_, reply_.to_buffers(),
-                      [this, self](asio::error_code ec, std::size_t) {
-                          if (!ec)
-                          {
-                              // Initiate graceful connection closure.
-                              asio::error_code ignored_ec;
-                              socket_.shutdown(
-                                  asio::ip::tcp::socket::shutdown_both,
-                                  ignored_ec);
-                          }
-
-                          // No new asynchronous operations are started. This
-                          // means that all shared_ptr references to the
-                          // connection object will disappear and the object
-                          // will be destroyed automatically after this handler
-                          // returns. The connection class's destructor closes
-                          // the socket.
-                      });
+    reply_.headers.emplace_back();
+    reply_.headers.back().name = "Connection";
+    reply_.headers.back().value = keep_alive_ ? "keep-alive" : "close";
+    asio::async_write(
+        socket_, reply_.to_buffers(),
+        [this, self](asio::error_code ec, std::size_t) {
+            if (ec)
+            {
+                return;
+            }
+
+            if (keep_alive_)
+            {
+                reset_for_next_request();
+                // Answer any request the client pipelined behind this one
+                // before reading more
+                if (parsed_ < buffered_)
+                {
+                    do_parse();
+                }
+                else
+                {
+                    do_read();
+                }
+                return;
+            }
+
+            // Initiate graceful connection closure.
+            asio::error_code ignored_ec;
+            socket_.shutdown(asio::ip::tcp::socket::shutdown_both, ignored_ec);
+
+            // No new asynchronous operations are started. This means that all
+            // shared_ptr references to the connection object will disappear
+            // and the object will be destroyed automatically after this
+            // handler returns. The connection class's destructor closes the
+            // socket.
+        });
 }
 
 } // namespace server
@@ -28,7 +28,10 @@ namespace server
 
 class server;
 
-/// Represents a single connection from a client.
+/// Represents a single connection from a client. Connections are kept open
+/// between requests as HTTP/1.1 allows, and requests pipelined by the client
+/// are answered in order. The request and reply are reused from one request to
+/// the next so that their buffers are only grown once per connection.
 class connection : public std::enable_shared_from_this<connection>
 {
   public:
@@ -45,21 +48,42 @@ class connection : public std::enable_shared_from_this<connection>
     /// Perform an asynchronous read operation.
     void do_read();
 
+    /// Parse what is buffered and not yet parsed, then answer the request or
+    /// read more.
+    void do_parse();
+
     /// Perform an asynchronous write operation.
     void do_write();
 
+    /// Close the connection if the client sends nothing for IDLE_TIMEOUT.
+    void start_idle_timer();
+
+    /// Clear the request and reply for the next request on this connection.
+    void reset_for_next_request();
+
     /// Socket for the connection.
     asio::ip::tcp::socket socket_;
 
     /// The handler used to process the incoming request.
     server& request_handler_;
 
+    /// Closes idle connections.
+    asio::steady_timer idle_timer_;
+
     /// Buffer for incoming data.
     std::array<char, 8192> buffer_;
 
-    /// Size of received data
+    /// Bytes in buffer_ from parsed_ to buffered_ are received but not yet
+    /// parsed; with pipelining they can hold further requests.
+    size_t parsed_{0};
+    size_t buffered_{0};
+
+    /// Size of received data for the current request
     size_t received_count_;
 
+    /// Whether to keep the connection open after the current reply.
+    bool keep_alive_{false};
+
     /// The incoming request.
     request request_;
 
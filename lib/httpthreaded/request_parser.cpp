@@ -25,7 +25,9 @@ request_parser::reset()
 {
     header_state_ = method_start;
     parsed_header_ = false;
+    binary_body_ = false;
     body_consumed_bytes_ = 0;
+    body_content_length_ = 0;
 }
 
 request_parser::result_type
@@ -290,6 +292,15 @@ request_parser::consumeHeader(request& req, char input)
 request_parser::result_type
 request_parser::initializeForBody(request const& req)
 {
+    for (auto const& header : req.headers)
+    {
+        if (header.name == "Content-Type" &&
+            header.value == "application/octet-stream")
+        {
+            binary_body_ = true;
+        }
+    }
+
     for (auto const& header : req.headers)
     {
         if (header.name == "Content-Length")
@@ -310,7 +321,7 @@ request_parser::initializeForBody(request const& req)
 request_parser::result_type
 request_parser::consumeBody(request& req, char input)
 {
-    if (is_ctl(input))
+    if (!binary_body_ && is_ctl(input))
     {
         return bad;
     }
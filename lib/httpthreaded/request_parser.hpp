@@ -129,6 +129,8 @@ class request_parser
     } header_state_;
 
     bool parsed_header_{false};
+    /// Set for application/octet-stream bodies, which may hold any byte.
+    bool binary_body_{false};
     size_t body_consumed_bytes_{0};
     size_t body_content_length_{0};
 };
@@ -79,6 +79,14 @@ void
 server::addRoute(const std::string& routeName, routeHandler callback)
 {
     mRoutes[routeName] = callback;
+    mRawRoutes.erase(routeName);
+}
+
+void
+server::addRawRoute(const std::string& routeName, routeHandler callback)
+{
+    mRoutes[routeName] = callback;
+    mRawRoutes.insert(routeName);
 }
 
 void
@@ -153,8 +161,13 @@ server::handle_request(const request& req, reply& rep)
         params = request_path.substr(pos);
     }
 
+    bool raw = mRawRoutes.find(command) != mRawRoutes.end();
     std::string parsed_body;
-    if (!url_decode(req.body, parsed_body))
+    if (raw)
+    {
+        parsed_body = req.body;
+    }
+    else if (!url_decode(req.body, parsed_body))
     {
         rep = reply::stock_reply(reply::bad_request);
         return;
@@ -179,7 +192,8 @@ server::handle_request(const request& req, reply& rep)
             rep.headers[0].name = "Content-Length";
             rep.headers[0].value = std::to_string(rep.content.size());
             rep.headers[1].name = "Content-Type";
-            rep.headers[1].value = "application/json";
+            rep.headers[1].value =
+                raw ? "application/octet-stream" : "application/json";
         }
         else
         {
@@ -18,6 +18,7 @@
 #include "connection.hpp"
 #include <functional>
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -45,6 +46,10 @@ class server
     ~server();
 
     void addRoute(const std::string& routeName, routeHandler callback);
+    // Like addRoute, but the body is passed on as received rather than
+    // URL-decoded, and a successful response is sent as
+    // application/octet-stream. For routes that speak binary XDR.
+    void addRawRoute(const std::string& routeName, routeHandler callback);
     void add404(routeHandler callback);
 
     void handle_request(const request& req, reply& rep);
@@ -87,6 +92,7 @@ class server
     std::vector<std::thread> worker_threads_{};
 
     std::map<std::string, routeHandler> mRoutes;
+    std::set<std::string> mRawRoutes;
 };
 
 } // namespace server
@@ -0,0 +1,314 @@
+#!/usr/bin/env python3
+"""
+Runs the stellar-core performance benchmarks on a fixed configuration, writes
+the results as JSON and compares them against a stored baseline.
+
+The benchmarks to run are described by a JSON harness configuration, see
+performance-eval/perf-regression.json for an example:
+
+    {
+      "apply_load": [
+        {"name": "soroban", "mode": "soroban", "conf": "apply-load.cfg"}
+      ],
+      "replay": [
+        {"name": "pubnet", "conf": "node.cfg", "meta_file": "meta.xdr",
+         "runs": 3}
+      ],
+      "benchmarks": ["sign and verify benchmarking"],
+      "thresholds": {"default": 0.1, "bench.*": 0.2}
+    }
+
+Relative paths in the harness configuration are relative to the file itself.
+
+Usage:
+    ./PerfRegression.py run -c harness.json -o results.json
+    ./PerfRegression.py compare -b baseline.json -r results.json
+    ./PerfRegression.py run -c harness.json -o results.json -b baseline.json
+"""
+
+import argparse
+import fnmatch
+import json
+import os
+import platform
+import re
+import statistics
+import subprocess
+import sys
+import time
+
+LOWER_IS_BETTER = "lower"
+HIGHER_IS_BETTER = "higher"
+
+# Log lines `apply-load` ends with, see runApplyLoad in CommandLine.cpp
+APPLY_LOAD_PATTERNS = [
+    ("max_close_ms", r"Max ledger close: ([\d.]+) milliseconds",
+     LOWER_IS_BETTER),
+    ("mean_close_ms", r"Mean ledger close:\s+([\d.]+) milliseconds",
+     LOWER_IS_BETTER),
+    ("stddev_close_ms", r"stddev ledger close:\s+([\d.]+) milliseconds",
+     LOWER_IS_BETTER),
+    ("tx_count_utilization_pct", r"Tx count utilization ([\d.]+)%",
+     HIGHER_IS_BETTER),
+    ("instruction_utilization_pct", r"Instruction utilization ([\d.]+)%",
+     HIGHER_IS_BETTER),
+    ("tx_success_rate_pct", r"Tx Success Rate: ([\d.]+)%", HIGHER_IS_BETTER),
+]
+
+# Log line `apply-load --mode replay` ends with for every ledger phase, see
+# ReplayApplyLoad::logResults
+REPLAY_PATTERN = re.compile(
+    r"\] (\S+): count \d+, min [\d.]+ ms, mean ([\d.]+) ms, "
+    r"p50 ([\d.]+) ms, p90 [\d.]+ ms, p99 ([\d.]+) ms, max [\d.]+ ms")
+
+
+def run_command(cmd, cwd=None):
+    """Runs a command, returning its output and how long it took."""
+    logging_cmd = " ".join(cmd)
+    print(f"Running: {logging_cmd}", file=sys.stderr)
+    start = time.monotonic()
+    result = subprocess.run(cmd, cwd=cwd, capture_output=True, text=True,
+                            check=False)
+    elapsed = time.monotonic() - start
+    if result.returncode != 0:
+        sys.stderr.write(result.stdout[-4000:])
+        sys.stderr.write(result.stderr[-4000:])
+        raise RuntimeError(
+            f"'{logging_cmd}' failed with exit code {result.returncode}")
+    return result.stdout + result.stderr, elapsed
+
+
+def add_metric(results, name, value, unit, better):
+    results.setdefault(name, {"samples": [], "unit": unit, "better": better})
+    results[name]["samples"].append(value)
+
+
+def read_config_value(conf, key):
+    with open(conf) as f:
+        for line in f:
+            match = re.match(rf"\s*{key}\s*=\s*(\d+)", line)
+            if match:
+                return int(match.group(1))
+    return None
+
+
+def run_apply_load(core, bench, results):
+    prefix = f"apply-load.{bench['name']}"
+    cmd = [core, "apply-load", "--conf", bench["conf"], "--mode",
+           bench.get("mode", "soroban")]
+    output, _ = run_command(cmd)
+    values = {}
+    for name, pattern, better in APPLY_LOAD_PATTERNS:
+        match = re.search(pattern, output)
+        if match:
+            values[name] = float(match.group(1))
+            unit = "ms" if name.endswith("_ms") else "%"
+            add_metric(results, f"{prefix}.{name}", values[name], unit,
+                       better)
+    if "mean_close_ms" not in values:
+        raise RuntimeError(f"No ledger close time in {prefix} output")
+
+    # Throughput of the ledgers applied, derived from the number of
+    # transactions a ledger can hold and how full the ledgers were
+    max_tx_count = read_config_value(bench["conf"], "APPLY_LOAD_MAX_TX_COUNT")
+    if max_tx_count and "tx_count_utilization_pct" in values and \
+            values["mean_close_ms"] > 0:
+        utilization = values["tx_count_utilization_pct"] / 100
+        txs_per_ledger = max_tx_count * utilization
+        add_metric(results, f"{prefix}.txs_per_second",
+                   txs_per_ledger * 1000 / values["mean_close_ms"], "tx/s",
+                   HIGHER_IS_BETTER)
+
+
+def run_replay(core, bench, results):
+    prefix = f"replay.{bench['name']}"
+    cmd = [core, "apply-load", "--conf", bench["conf"], "--mode", "replay",
+           "--meta-file", bench["meta_file"], "--runs",
+           str(bench.get("runs", 1))]
+    output, _ = run_command(cmd)
+    found = False
+    for match in REPLAY_PATTERN.finditer(output):
+        phase = match.group(1)
+        for stat, group in [("mean_ms", 2), ("p50_ms", 3), ("p99_ms", 4)]:
+            add_metric(results, f"{prefix}.{phase}.{stat}",
+                       float(match.group(group)), "ms", LOWER_IS_BETTER)
+        found = True
+    if not found:
+        raise RuntimeError(f"No phase durations in {prefix} output")
+
+
+def run_benchmark(core, name, results):
+    # Microbenchmarks report in their own formats, so their wall-clock time is
+    # what gets tracked
+    _, elapsed = run_command([core, "test", name])
+    metric = "bench." + re.sub(r"[^A-Za-z0-9]+", "_", name).strip("_")
+    add_metric(results, f"{metric}.wall_s", elapsed, "s", LOWER_IS_BETTER)
+
+
+def resolve_paths(harness, base_dir):
+    for bench in harness.get("apply_load", []) + harness.get("replay", []):
+        for key in ["conf", "meta_file"]:
+            if key in bench:
+                bench[key] = os.path.join(base_dir, bench[key])
+
+
+def get_git_info():
+    def git(*args):
+        return subprocess.run(["git"] + list(args), capture_output=True,
+                              text=True, check=False).stdout.strip()
+
+    return {
+        "commit": git("rev-parse", "HEAD"),
+        "branch": git("rev-parse", "--abbrev-ref", "HEAD"),
+        "dirty": bool(git("status", "--porcelain", "--untracked-files=no")),
+    }
+
+
+def get_host_info():
+    host = {
+        "hostname": platform.node(),
+        "platform": platform.platform(),
+        "cpu_count": os.cpu_count(),
+    }
+    try:
+        with open("/proc/cpuinfo") as f:
+            for line in f:
+                if line.startswith("model name"):
+                    host["cpu_model"] = line.split(":", 1)[1].strip()
+                    break
+        with open("/proc/meminfo") as f:
+            for line in f:
+                if line.startswith("MemTotal"):
+                    host["memory_kb"] = int(line.split()[1])
+                    break
+    except OSError:
+        pass
+    return host
+
+
+def run(args):
+    with open(args.config) as f:
+        harness = json.load(f)
+    resolve_paths(harness, os.path.dirname(os.path.abspath(args.config)))
+
+    version, _ = run_command([args.stellar_core, "version"])
+    results = {}
+    for _ in range(args.repeat):
+        for bench in harness.get("apply_load", []):
+            run_apply_load(args.stellar_core, bench, results)
+        for bench in harness.get("replay", []):
+            run_replay(args.stellar_core, bench, results)
+        for name in harness.get("benchmarks", []):
+            run_benchmark(args.stellar_core, name, results)
+
+    # The median of the repetitions is what gets compared, to damp noise
+    for metric in results.values():
+        metric["value"] = statistics.median(metric["samples"])
+
+    report = {
+        "timestamp": time.strftime("%Y-%m-%dT%H:%M:%SZ", time.gmtime()),
+        "git": get_git_info(),
+        "host": get_host_info(),
+        "stellar_core_version": version.strip().splitlines()[0],
+        "thresholds": harness.get("thresholds", {}),
+        "metrics": results,
+    }
+    with open(args.output, "w") as f:
+        json.dump(report, f, indent=2, sort_keys=True)
+    print(f"Wrote {len(results)} metrics to {args.output}", file=sys.stderr)
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            return compare_reports(json.load(f), report, args.threshold)
+    return 0
+
+
+def get_threshold(thresholds, name, override):
+    if override is not None:
+        return override
+    # The most specific matching pattern wins
+    matches = [p for p in thresholds if p != "default" and
+               fnmatch.fnmatch(name, p)]
+    if matches:
+        return thresholds[max(matches, key=len)]
+    return thresholds.get("default", 0.1)
+
+
+def compare_reports(baseline, current, override):
+    if baseline.get("host") != current.get("host"):
+        print("Warning: the baseline was recorded on a different host, "
+              "results may not be comparable", file=sys.stderr)
+
+    thresholds = current.get("thresholds") or baseline.get("thresholds", {})
+    regressions = []
+    print(f"Baseline {baseline['git']['commit'][:10]}, "
+          f"current {current['git']['commit'][:10]}")
+    print(f"{'metric':<60} {'baseline':>12} {'current':>12} {'change':>8}")
+    for name in sorted(baseline["metrics"]):
+        base = baseline["metrics"][name]
+        if name not in current["metrics"]:
+            print(f"{name:<60} {base['value']:>12.3f} {'missing':>12}")
+            regressions.append(name)
+            continue
+        value = current["metrics"][name]["value"]
+        change = (value - base["value"]) / base["value"] \
+            if base["value"] else 0.0
+        worse = change if base["better"] == LOWER_IS_BETTER else -change
+        flag = ""
+        if worse > get_threshold(thresholds, name, override):
+            flag = " REGRESSION"
+            regressions.append(name)
+        print(f"{name:<60} {base['value']:>12.3f} {value:>12.3f} "
+              f"{change * 100:>+7.1f}%{flag}")
+
+    if regressions:
+        print(f"{len(regressions)} metrics regressed beyond their threshold")
+        return 1
+    print("No regression")
+    return 0
+
+
+def compare(args):
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    with open(args.results) as f:
+        current = json.load(f)
+    return compare_reports(baseline, current, args.threshold)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Performance regression harness for stellar-core")
+    parser.add_argument("-t", "--threshold", type=float,
+                        help="relative change considered a regression, "
+                        "overrides the thresholds of the harness "
+                        "configuration (e.g. 0.05 for 5%%)")
+    subparsers = parser.add_subparsers(dest="command", required=True)
+
+    run_parser = subparsers.add_parser("run", help="run the benchmarks")
+    run_parser.add_argument("-c", "--config", required=True,
+                            help="harness configuration")
+    run_parser.add_argument("-o", "--output", required=True,
+                            help="output file for the results")
+    run_parser.add_argument("-s", "--stellar-core", default="stellar-core",
+                            help="stellar-core executable")
+    run_parser.add_argument("-n", "--repeat", type=int, default=1,
+                            help="number of times to run every benchmark")
+    run_parser.add_argument("-b", "--baseline",
+                            help="baseline to compare the results against")
+    run_parser.set_defaults(func=run)
+
+    compare_parser = subparsers.add_parser(
+        "compare", help="compare results against a baseline")
+    compare_parser.add_argument("-b", "--baseline", required=True,
+                                help="baseline results")
+    compare_parser.add_argument("-r", "--results", required=True,
+                                help="results to check")
+    compare_parser.set_defaults(func=compare)
+
+    args = parser.parse_args()
+    sys.exit(args.func(args))
+
+
+if __name__ == "__main__":
+    main()
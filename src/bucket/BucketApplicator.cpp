@@ -12,6 +12,7 @@
 #include "util/GlobalChecks.h"
 #include "util/Logging.h"
 #include "util/types.h"
+#include <Tracy.hpp>
 #include <fmt/format.h>
 
 namespace stellar
@@ -55,26 +56,75 @@ BucketApplicator::BucketApplicator(Application& app,
             mOffersRemaining = false;
         }
     }
+
+    mPos = mBucketIter.pos();
+    mSize = mBucketIter.size();
+    if (mBucketIter && mOffersRemaining)
+    {
+        startReadingBatch();
+    }
+    else
+    {
+        mOffersRemaining = false;
+    }
 }
 
 BucketApplicator::operator bool() const
 {
-    // There is more work to do (i.e. (bool) *this == true) iff:
-    // 1. The underlying bucket iterator is not EOF and
-    // 2. We have offers still remaining.
-    return static_cast<bool>(mBucketIter) && mOffersRemaining;
+    // There is more work to do (i.e. (bool) *this == true) iff the underlying
+    // bucket iterator was not EOF and we have offers still remaining when the
+    // last batch was read.
+    return mOffersRemaining;
 }
 
 size_t
 BucketApplicator::pos()
 {
-    return mBucketIter.pos();
+    return mPos;
+}
+
+void
+BucketApplicator::startReadingBatch()
+{
+    mNextBatch =
+        std::async(std::launch::async, [this]() { return readBatch(); });
+}
+
+BucketApplicator::OfferBatch
+BucketApplicator::readBatch()
+{
+    ZoneScoped;
+    OfferBatch batch;
+    batch.entries.reserve(LEDGER_ENTRY_BATCH_COMMIT_SIZE);
+    for (; mBucketIter; ++mBucketIter)
+    {
+        // Note: mUpperBoundOffset is not inclusive. However, mBucketIter.pos()
+        // returns the file offset at the end of the currently loaded entry.
+        // This means we must read until pos is strictly greater than the upper
+        // bound so that we don't skip the last offer in the range.
+        if (mBucketIter.pos() > mUpperBoundOffset)
+        {
+            break;
+        }
+
+        if (batch.entries.size() == LEDGER_ENTRY_BATCH_COMMIT_SIZE)
+        {
+            batch.pos = mBucketIter.pos();
+            return batch;
+        }
+
+        batch.entries.emplace_back(*mBucketIter);
+    }
+
+    batch.pos = mBucketIter.pos();
+    batch.last = true;
+    return batch;
 }
 
 size_t
 BucketApplicator::size() const
 {
-    return mBucketIter.size();
+    return mSize;
 }
 
 static bool
@@ -97,6 +147,23 @@ size_t
 BucketApplicator::advance(BucketApplicator::Counters& counters)
 {
     size_t count = 0;
+    if (!mOffersRemaining)
+    {
+        return count;
+    }
+
+    releaseAssert(mNextBatch.valid());
+    auto batch = mNextBatch.get();
+    mPos = batch.pos;
+    if (batch.last)
+    {
+        mOffersRemaining = false;
+    }
+    else
+    {
+        // Read the next batch while this one is applied
+        startReadingBatch();
+    }
 
     auto& root = mApp.getLedgerTxnRoot();
     AbstractLedgerTxn* ltx;
@@ -119,19 +186,8 @@ BucketApplicator::advance(BucketApplicator::Counters& counters)
         ltx->prepareNewObjects(LEDGER_ENTRY_BATCH_COMMIT_SIZE);
     }
 
-    for (; mBucketIter; ++mBucketIter)
+    for (auto const& e : batch.entries)
     {
-        // Note: mUpperBoundOffset is not inclusive. However, mBucketIter.pos()
-        // returns the file offset at the end of the currently loaded entry.
-        // This means we must read until pos is strictly greater than the upper
-        // bound so that we don't skip the last offer in the range.
-        if (mBucketIter.pos() > mUpperBoundOffset)
-        {
-            mOffersRemaining = false;
-            break;
-        }
-
-        BucketEntry const& e = *mBucketIter;
         LiveBucket::checkProtocolLegality(e, mMaxProtocolVersion);
 
         if (shouldApplyEntry(e))
@@ -195,11 +251,7 @@ BucketApplicator::advance(BucketApplicator::Counters& counters)
                 }
             }
 
-            if ((++count > LEDGER_ENTRY_BATCH_COMMIT_SIZE))
-            {
-                ++mBucketIter;
-                break;
-            }
+            ++count;
         }
     }
     if (innerLtx)
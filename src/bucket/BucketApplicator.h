@@ -6,8 +6,11 @@
 
 #include "bucket/BucketInputIterator.h"
 #include "bucket/LiveBucket.h"
+#include "util/NonCopyable.h"
 #include "util/Timer.h"
+#include <future>
 #include <memory>
+#include <vector>
 
 namespace stellar
 {
@@ -17,19 +20,49 @@ class Application;
 // Class that represents a single apply-bucket-to-database operation in
 // progress. Used during history catchup to split up the task of applying
 // bucket into scheduler-friendly, bite-sized pieces.
+//
+// Reading and decoding the bucket is overlapped with applying it: while one
+// batch of offers is written to the database, the next batch is read on a
+// background thread. Deduplication against seenKeys and all database writes
+// stay on the calling thread, so entries are applied in bucket order exactly
+// as before.
 
-class BucketApplicator
+class BucketApplicator : public NonMovableOrCopyable
 {
+    struct OfferBatch
+    {
+        std::vector<BucketEntry> entries;
+
+        // File offset just past the last entry in entries
+        size_t pos{0};
+
+        // True if this is the last batch of offers in the bucket
+        bool last{false};
+    };
+
     Application& mApp;
     uint32_t mMaxProtocolVersion;
     uint32_t mMinProtocolVersionSeen;
     uint32_t mLevel;
+
+    // Only accessed by readBatch, which runs on a background thread while
+    // mNextBatch is pending
     LiveBucketInputIterator mBucketIter;
+
     size_t mCount{0};
+    size_t mPos{0};
+    size_t mSize{0};
     std::unordered_set<LedgerKey>& mSeenKeys;
     std::streamoff mUpperBoundOffset{0};
     bool mOffersRemaining{true};
 
+    // Declared after mBucketIter so that a pending read finishes before the
+    // iterator is destroyed
+    std::future<OfferBatch> mNextBatch;
+
+    OfferBatch readBatch();
+    void startReadingBatch();
+
   public:
     class Counters
     {
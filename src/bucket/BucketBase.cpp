@@ -15,18 +15,23 @@
 #include "bucket/HotArchiveBucket.h"
 #include "bucket/LedgerCmp.h"
 #include "bucket/LiveBucket.h"
+#include "bucket/LiveBucketIndex.h"
 #include "bucket/MergeKey.h"
 #include "crypto/Hex.h"
 #include "crypto/Random.h"
 #include "main/Application.h"
 #include "medida/timer.h"
+#include "util/BlockCompressedFile.h"
 #include "util/Fs.h"
 #include "util/GlobalChecks.h"
+#include "util/IORateLimiter.h"
 #include "util/Logging.h"
 #include "util/ProtocolVersion.h"
 #include "util/types.h"
 #include <Tracy.hpp>
+#include <future>
 #include <thread>
+#include <xdrpp/marshal.h>
 
 namespace stellar
 {
@@ -56,6 +61,31 @@ BucketBase<BucketT, IndexT>::setIndex(std::unique_ptr<IndexT const>&& index)
     mIndex = std::move(index);
 }
 
+template <class BucketT, class IndexT>
+MappedFile const*
+BucketBase<BucketT, IndexT>::getMappedFile() const
+{
+    return mMappedFile.get();
+}
+
+template <class BucketT, class IndexT>
+std::shared_ptr<BlockCompressedFile::Table const> const&
+BucketBase<BucketT, IndexT>::getBlockTable() const
+{
+    return mBlockTable;
+}
+
+template <class BucketT, class IndexT>
+void
+BucketBase<BucketT, IndexT>::mapFile()
+{
+    ZoneScoped;
+    if (!isEmpty() && !mMappedFile && !mBlockTable)
+    {
+        mMappedFile = MappedFile::map(mFilename.string());
+    }
+}
+
 template <class BucketT, class IndexT>
 BucketBase<BucketT, IndexT>::BucketBase(std::string const& filename,
                                         Hash const& hash,
@@ -67,7 +97,11 @@ BucketBase<BucketT, IndexT>::BucketBase(std::string const& filename,
     {
         CLOG_TRACE(Bucket, "BucketBase::Bucket() created, file exists : {}",
                    mFilename);
-        mSize = fs::size(filename);
+        // Sizes and offsets are those of the original file, even if it was
+        // block-compressed
+        mBlockTable = BlockCompressedFile::readTable(filename);
+        mSize = mBlockTable ? static_cast<size_t>(mBlockTable->rawSize)
+                            : fs::size(filename);
     }
 }
 
@@ -336,6 +370,135 @@ BucketBase<BucketT, IndexT>::mergeInternal(
     }
 }
 
+namespace
+{
+// Bytes a rate-limited hot archive merge writes between charges to the limiter
+size_t constexpr HOT_ARCHIVE_MERGE_CHARGE_BYTES = 64 * 1024;
+
+// Positions iter at the first entry not less than lowerBound, using the index
+// to skip whole pages when possible.
+void
+seekToPartition(BucketInputIterator<LiveBucket>& iter,
+                LiveBucketIndex const& index, BucketEntry const& lowerBound)
+{
+    if (auto offset = index.getMergePartitionOffset(lowerBound.deadEntry()))
+    {
+        iter.seek(*offset);
+    }
+
+    BucketEntryIdCmp<LiveBucket> cmp;
+    while (iter && cmp(*iter, lowerBound))
+    {
+        ++iter;
+    }
+}
+
+// Merges oldBucket and newBucket without shadows as a series of key-range
+// partitions, running all but the first partition on their own threads, and
+// appends the partitions to `out` in key order. Because partitions cover
+// disjoint key ranges and are hashed in order as they are appended, the
+// resulting bucket is byte-identical to that of a serial merge. Returns false
+// without writing anything if neither input has a range index to take
+// partition boundaries from.
+bool
+mergeLivePartitions(BucketManager& bucketManager,
+                    std::shared_ptr<LiveBucket> const& oldBucket,
+                    std::shared_ptr<LiveBucket> const& newBucket,
+                    LiveBucketIndex const& oldIndex,
+                    LiveBucketIndex const& newIndex, uint32_t protocolVersion,
+                    bool keepTombstoneEntries,
+                    bool keepShadowedLifecycleEntries,
+                    BucketMetadata const& meta, MergeCounters& mc,
+                    BucketOutputIterator<LiveBucket>& out,
+                    asio::io_context& ctx)
+{
+    ZoneScoped;
+    auto const maxPartitions =
+        bucketManager.getConfig().BUCKET_MERGE_PARTITIONS;
+    auto keys = oldIndex.getMergePartitionKeys(maxPartitions);
+    if (keys.empty())
+    {
+        keys = newIndex.getMergePartitionKeys(maxPartitions);
+        if (keys.empty())
+        {
+            return false;
+        }
+    }
+
+    // DEADENTRYs compare by key alone, so they serve as partition bounds
+    std::vector<BucketEntry> bounds;
+    bounds.reserve(keys.size());
+    for (auto const& k : keys)
+    {
+        auto& bound = bounds.emplace_back();
+        bound.type(DEADENTRY);
+        bound.deadEntry() = k;
+    }
+
+    auto const numPartitions = bounds.size() + 1;
+    CLOG_DEBUG(Bucket, "Merging {} and {} in {} partitions",
+               binToHex(oldBucket->getHash()), binToHex(newBucket->getHash()),
+               numPartitions);
+
+    auto const tmpDir = bucketManager.getTmpDir();
+    auto const pipelineWrites =
+        bucketManager.getConfig().BUCKET_MERGE_PIPELINED_WRITES;
+    auto mergePartition = [&](size_t i, MergeCounters& partitionCounters) {
+        BucketInputIterator<LiveBucket> oi(oldBucket);
+        BucketInputIterator<LiveBucket> ni(newBucket);
+        if (i > 0)
+        {
+            seekToPartition(oi, oldIndex, bounds.at(i - 1));
+            seekToPartition(ni, newIndex, bounds.at(i - 1));
+        }
+
+        auto upperBound = i < bounds.size() ? &bounds.at(i) : nullptr;
+        RangeFileMergeInput<LiveBucket> inputSource(oi, ni, upperBound);
+
+        // Partition files are temporary, only the final output is fsynced
+        auto partition = std::make_unique<BucketOutputIterator<LiveBucket>>(
+            tmpDir, keepTombstoneEntries, meta, partitionCounters, ctx,
+            /*doFsync=*/false, /*writeMetaEntry=*/false, pipelineWrites);
+        auto putFunc = [&partition](BucketEntry const& entry) {
+            partition->put(entry);
+        };
+
+        std::vector<BucketInputIterator<LiveBucket>> noShadows;
+        bool keepLifecycleEntries = keepShadowedLifecycleEntries;
+        LiveBucket::mergeInternal(bucketManager, inputSource, putFunc,
+                                  protocolVersion, partitionCounters,
+                                  noShadows, keepLifecycleEntries);
+        return partition;
+    };
+
+    std::vector<MergeCounters> partitionCounters(numPartitions);
+    std::vector<
+        std::future<std::unique_ptr<BucketOutputIterator<LiveBucket>>>>
+        futures;
+    for (size_t i = 1; i < numPartitions; ++i)
+    {
+        futures.emplace_back(std::async(std::launch::async, mergePartition, i,
+                                        std::ref(partitionCounters.at(i))));
+    }
+
+    auto first = mergePartition(0, partitionCounters.at(0));
+    out.appendPartition(*first);
+    for (auto& f : futures)
+    {
+        releaseAssert(f.valid());
+        auto partition = f.get();
+        out.appendPartition(*partition);
+    }
+
+    for (auto const& counters : partitionCounters)
+    {
+        mc += counters;
+    }
+
+    return true;
+}
+}
+
 template <class BucketT, class IndexT>
 std::shared_ptr<BucketT>
 BucketBase<BucketT, IndexT>::merge(
@@ -389,9 +552,10 @@ BucketBase<BucketT, IndexT>::merge(
         meta.ext = oi.getMetadata().ext;
     }
 
-    BucketOutputIterator<BucketT> out(bucketManager.getTmpDir(),
-                                      keepTombstoneEntries, meta, mc, ctx,
-                                      doFsync);
+    BucketOutputIterator<BucketT> out(
+        bucketManager.getTmpDir(), keepTombstoneEntries, meta, mc, ctx,
+        doFsync, /*writeMetaEntry=*/true,
+        bucketManager.getConfig().BUCKET_MERGE_PIPELINED_WRITES);
 
     FileMergeInput<BucketT> inputSource(oi, ni);
     auto putFunc = [&out](typename BucketT::EntryT const& entry) {
@@ -402,8 +566,24 @@ BucketBase<BucketT, IndexT>::merge(
     std::vector<Hash> shadowHashes;
     if constexpr (std::is_same_v<BucketT, LiveBucket>)
     {
-        mergeInternal(bucketManager, inputSource, putFunc, protocolVersion, mc,
-                      shadowIterators, keepShadowedLifecycleEntries);
+        // Shadows are only used by pre-protocol 12 merges, which are never
+        // partitioned
+        bool merged = false;
+        if (bucketManager.getConfig().BUCKET_MERGE_PARTITIONS > 1 &&
+            shadows.empty() && oldBucket->isIndexed() &&
+            newBucket->isIndexed())
+        {
+            merged = mergeLivePartitions(
+                bucketManager, oldBucket, newBucket, oldBucket->getIndex(),
+                newBucket->getIndex(), protocolVersion, keepTombstoneEntries,
+                keepShadowedLifecycleEntries, meta, mc, out, ctx);
+        }
+
+        if (!merged)
+        {
+            mergeInternal(bucketManager, inputSource, putFunc, protocolVersion,
+                          mc, shadowIterators, keepShadowedLifecycleEntries);
+        }
         shadowHashes.reserve(shadows.size());
         for (auto const& s : shadows)
         {
@@ -412,8 +592,32 @@ BucketBase<BucketT, IndexT>::merge(
     }
     else
     {
-        // HotArchive BucketList does not support shadows
-        mergeInternal(bucketManager, inputSource, putFunc, protocolVersion, mc);
+        // HotArchive BucketList does not support shadows. Its merges write
+        // under HOT_ARCHIVE_MERGE_RATE, charged in chunks so that the shared
+        // limiter isn't locked for every entry.
+        auto& limiter = bucketManager.getHotArchiveMergeRateLimiter();
+        if (limiter.isLimited())
+        {
+            size_t uncharged = 0;
+            auto limitedPutFunc =
+                [&out, &limiter,
+                 &uncharged](typename BucketT::EntryT const& entry) {
+                    out.put(entry);
+                    uncharged += xdr::xdr_size(entry);
+                    if (uncharged >= HOT_ARCHIVE_MERGE_CHARGE_BYTES)
+                    {
+                        limiter.consume(uncharged);
+                        uncharged = 0;
+                    }
+                };
+            mergeInternal(bucketManager, inputSource, limitedPutFunc,
+                          protocolVersion, mc);
+        }
+        else
+        {
+            mergeInternal(bucketManager, inputSource, putFunc,
+                          protocolVersion, mc);
+        }
     }
 
     if (countMergeEvents)
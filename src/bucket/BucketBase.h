@@ -6,6 +6,7 @@
 
 #include "bucket/BucketInputIterator.h"
 #include "bucket/BucketUtils.h"
+#include "util/MappedFile.h"
 #include "util/NonCopyable.h"
 #include "util/ProtocolVersion.h"
 #include "xdr/Stellar-types.h"
@@ -76,9 +77,26 @@ class BucketBase : public NonMovableOrCopyable
 
     std::unique_ptr<IndexT const> mIndex{};
 
+    // Read-only mapping of the bucket file, only set if
+    // BUCKETLIST_DB_MMAP_BUCKETS is enabled. Bucket files are immutable once
+    // adopted, so the mapping can be shared by all snapshots.
+    std::unique_ptr<MappedFile const> mMappedFile{};
+
+    // Block table of the bucket file, only set if it is block-compressed (see
+    // BUCKETLIST_DB_COMPRESS_BUCKETS). Shared by the streams of all snapshots.
+    std::shared_ptr<BlockCompressedFile::Table const> mBlockTable{};
+
     // Returns index, throws if index not yet initialized
     IndexT const& getIndex() const;
 
+    // Returns the mapping of the bucket file, or nullptr if it is not mapped
+    MappedFile const* getMappedFile() const;
+
+    // Returns the block table of the bucket file, or nullptr if it isn't
+    // block-compressed
+    std::shared_ptr<BlockCompressedFile::Table const> const&
+    getBlockTable() const;
+
     static std::string randomFileName(std::string const& tmpDir,
                                       std::string ext);
 
@@ -111,6 +129,11 @@ class BucketBase : public NonMovableOrCopyable
     // Sets index, throws if index is already set
     void setIndex(std::unique_ptr<IndexT const>&& index);
 
+    // Memory maps the bucket file for lookups. Must be called before the
+    // bucket is shared with other threads. If mapping fails, or the file is
+    // block-compressed, lookups fall back to reading the file.
+    void mapFile();
+
     // Merge two buckets together, producing a fresh one. Entries in `oldBucket`
     // are overridden in the fresh bucket by keywise-equal entries in
     // `newBucket`. Entries are inhibited from the fresh bucket by keywise-equal
@@ -0,0 +1,261 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "bucket/BucketEntryView.h"
+#include "util/GlobalChecks.h"
+#include "util/types.h"
+#include <cstring>
+#include <xdrpp/marshal.h>
+
+namespace stellar
+{
+
+namespace
+{
+// Offsets in the XDR of a LIVEENTRY or INITENTRY. The entry starts after the
+// BucketEntryType and lastModifiedLedgerSeq, its body after its type.
+size_t constexpr ENTRY_TYPE_OFFSET = 8;
+size_t constexpr ENTRY_BODY_OFFSET = 12;
+// Size of an ed25519 AccountID, the only kind there is
+size_t constexpr ACCOUNT_ID_SIZE = 36;
+
+size_t constexpr ACCOUNT_BALANCE_OFFSET = ENTRY_BODY_OFFSET + ACCOUNT_ID_SIZE;
+size_t constexpr ACCOUNT_SEQ_NUM_OFFSET = ACCOUNT_BALANCE_OFFSET + 8;
+// Followed by the optional inflationDest, then the flags
+size_t constexpr ACCOUNT_INFLATION_DEST_OFFSET = ACCOUNT_SEQ_NUM_OFFSET + 12;
+size_t constexpr TRUSTLINE_ASSET_OFFSET = ENTRY_BODY_OFFSET + ACCOUNT_ID_SIZE;
+size_t constexpr TTL_LIVE_UNTIL_OFFSET = ENTRY_BODY_OFFSET + 32;
+
+uint32_t
+readUint32(char const* data, size_t size, size_t offset)
+{
+    if (offset + 4 > size)
+    {
+        throw xdr::xdr_runtime_error("truncated entry in BucketEntryView");
+    }
+    uint32_t res = 0;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        res = (res << 8) | static_cast<uint8_t>(data[offset + i]);
+    }
+    return res;
+}
+
+uint32_t
+readUint32(std::vector<char> const& xdr, size_t offset)
+{
+    return readUint32(xdr.data(), xdr.size(), offset);
+}
+
+uint64_t
+readUint64(std::vector<char> const& xdr, size_t offset)
+{
+    return (static_cast<uint64_t>(readUint32(xdr, offset)) << 32) |
+           readUint32(xdr, offset + 4);
+}
+
+// Types whose LedgerKey is serialized as a prefix of their LedgerEntry
+bool
+keyIsPrefixOfEntry(LedgerEntryType type)
+{
+    switch (type)
+    {
+    case ACCOUNT:
+    case TRUSTLINE:
+    case OFFER:
+    case DATA:
+    case CLAIMABLE_BALANCE:
+    case LIQUIDITY_POOL:
+    case CONFIG_SETTING:
+    case TTL:
+        return true;
+    case CONTRACT_DATA:
+    case CONTRACT_CODE:
+        // Start with an extension
+        return false;
+    }
+    return false;
+}
+}
+
+BucketEntryView::BucketEntryView(std::vector<char>&& xdr)
+    : mXdr(std::move(xdr))
+{
+}
+
+BucketEntryView::BucketEntryView(std::shared_ptr<BucketEntry const> entry)
+    : mEntry(std::move(entry))
+{
+    releaseAssert(mEntry);
+}
+
+bool
+BucketEntryView::isLive() const
+{
+    auto type = mEntry ? mEntry->type()
+                       : static_cast<BucketEntryType>(
+                             static_cast<int32_t>(readUint32(mXdr, 0)));
+    return type == LIVEENTRY || type == INITENTRY;
+}
+
+LedgerEntry const&
+BucketEntryView::liveEntry() const
+{
+    releaseAssertOrThrow(mEntry);
+    return mEntry->liveEntry();
+}
+
+LedgerEntryType
+BucketEntryView::type() const
+{
+    releaseAssertOrThrow(isLive());
+    if (mEntry)
+    {
+        return liveEntry().data.type();
+    }
+    return static_cast<LedgerEntryType>(
+        static_cast<int32_t>(readUint32(mXdr, ENTRY_TYPE_OFFSET)));
+}
+
+uint32_t
+BucketEntryView::lastModifiedLedgerSeq() const
+{
+    releaseAssertOrThrow(isLive());
+    if (mEntry)
+    {
+        return liveEntry().lastModifiedLedgerSeq;
+    }
+    return readUint32(mXdr, 4);
+}
+
+size_t
+BucketEntryView::trustLineBalanceOffset() const
+{
+    auto assetType = static_cast<AssetType>(
+        static_cast<int32_t>(readUint32(mXdr, TRUSTLINE_ASSET_OFFSET)));
+    size_t assetSize = 4;
+    switch (assetType)
+    {
+    case ASSET_TYPE_NATIVE:
+        break;
+    case ASSET_TYPE_CREDIT_ALPHANUM4:
+        assetSize += 4 + ACCOUNT_ID_SIZE;
+        break;
+    case ASSET_TYPE_CREDIT_ALPHANUM12:
+        assetSize += 12 + ACCOUNT_ID_SIZE;
+        break;
+    case ASSET_TYPE_POOL_SHARE:
+        assetSize += 32;
+        break;
+    default:
+        throw xdr::xdr_runtime_error("bad asset type in BucketEntryView");
+    }
+    return TRUSTLINE_ASSET_OFFSET + assetSize;
+}
+
+int64_t
+BucketEntryView::balance() const
+{
+    auto t = type();
+    releaseAssertOrThrow(t == ACCOUNT || t == TRUSTLINE);
+    if (mEntry)
+    {
+        return t == ACCOUNT ? liveEntry().data.account().balance
+                            : liveEntry().data.trustLine().balance;
+    }
+    auto offset =
+        t == ACCOUNT ? ACCOUNT_BALANCE_OFFSET : trustLineBalanceOffset();
+    return static_cast<int64_t>(readUint64(mXdr, offset));
+}
+
+uint32_t
+BucketEntryView::flags() const
+{
+    auto t = type();
+    releaseAssertOrThrow(t == ACCOUNT || t == TRUSTLINE);
+    if (mEntry)
+    {
+        return t == ACCOUNT ? liveEntry().data.account().flags
+                            : liveEntry().data.trustLine().flags;
+    }
+    if (t == TRUSTLINE)
+    {
+        // After the balance and limit
+        return readUint32(mXdr, trustLineBalanceOffset() + 16);
+    }
+    auto offset = ACCOUNT_INFLATION_DEST_OFFSET + 4;
+    if (readUint32(mXdr, ACCOUNT_INFLATION_DEST_OFFSET) != 0)
+    {
+        offset += ACCOUNT_ID_SIZE;
+    }
+    return readUint32(mXdr, offset);
+}
+
+SequenceNumber
+BucketEntryView::seqNum() const
+{
+    releaseAssertOrThrow(type() == ACCOUNT);
+    if (mEntry)
+    {
+        return liveEntry().data.account().seqNum;
+    }
+    return static_cast<SequenceNumber>(
+        readUint64(mXdr, ACCOUNT_SEQ_NUM_OFFSET));
+}
+
+uint32_t
+BucketEntryView::liveUntilLedgerSeq() const
+{
+    releaseAssertOrThrow(type() == TTL);
+    if (mEntry)
+    {
+        return liveEntry().data.ttl().liveUntilLedgerSeq;
+    }
+    return readUint32(mXdr, TTL_LIVE_UNTIL_OFFSET);
+}
+
+BucketEntry
+BucketEntryView::decode() const
+{
+    if (mEntry)
+    {
+        return *mEntry;
+    }
+    BucketEntry be;
+    xdr::xdr_from_opaque(mXdr, be);
+    return be;
+}
+
+bool
+BucketEntryView::hasKey(char const* body, size_t size, LedgerKey const& k,
+                        xdr::opaque_vec<> const& keyXdr)
+{
+    auto type = static_cast<BucketEntryType>(
+        static_cast<int32_t>(readUint32(body, size, 0)));
+    switch (type)
+    {
+    case METAENTRY:
+        return false;
+    case DEADENTRY:
+        return size == 4 + keyXdr.size() &&
+               std::memcmp(body + 4, keyXdr.data(), keyXdr.size()) == 0;
+    case LIVEENTRY:
+    case INITENTRY:
+        if (keyIsPrefixOfEntry(k.type()))
+        {
+            return size >= ENTRY_TYPE_OFFSET + keyXdr.size() &&
+                   std::memcmp(body + ENTRY_TYPE_OFFSET, keyXdr.data(),
+                               keyXdr.size()) == 0;
+        }
+        break;
+    default:
+        throw xdr::xdr_runtime_error("bad entry type in BucketEntryView");
+    }
+
+    BucketEntry be;
+    xdr::xdr_get g(body, body + size);
+    xdr::xdr_argpack_archive(g, be);
+    return getBucketLedgerKey(be) == k;
+}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "xdr/Stellar-ledger.h"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace stellar
+{
+
+// Read-only view of a BucketEntry, over its serialized XDR. The accessors for
+// the fields that read-only checks commonly need (balances, sequence numbers,
+// flags, TTLs) decode just that field at its offset in the XDR, so looking up
+// an account's sequence number doesn't decode its signers, home domain and
+// extensions. Call decode() for anything else.
+//
+// Entries found in a bucket index's cache are already decoded, views over
+// them read the decoded entry instead.
+class BucketEntryView
+{
+    // Either the XDR of the entry, without its record mark, or the entry
+    std::vector<char> mXdr;
+    std::shared_ptr<BucketEntry const> mEntry;
+
+    LedgerEntry const& liveEntry() const;
+    // Offset of the fields of a TRUSTLINE entry following its asset
+    size_t trustLineBalanceOffset() const;
+
+  public:
+    explicit BucketEntryView(std::vector<char>&& xdr);
+    explicit BucketEntryView(std::shared_ptr<BucketEntry const> entry);
+
+    // True for LIVEENTRY and INITENTRY, which are the only entries the
+    // LedgerEntry accessors below can be called on.
+    bool isLive() const;
+    LedgerEntryType type() const;
+    uint32_t lastModifiedLedgerSeq() const;
+
+    // ACCOUNT or TRUSTLINE
+    int64_t balance() const;
+    uint32_t flags() const;
+    // ACCOUNT
+    SequenceNumber seqNum() const;
+    // TTL
+    uint32_t liveUntilLedgerSeq() const;
+
+    BucketEntry decode() const;
+
+    // Returns true if the serialized BucketEntry in [body, body + size) is
+    // for key k, whose XDR is keyXdr. Live entries of most types start with
+    // their key, these are matched without decoding anything.
+    static bool hasKey(char const* body, size_t size, LedgerKey const& k,
+                       xdr::opaque_vec<> const& keyXdr);
+};
+}
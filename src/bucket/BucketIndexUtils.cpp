@@ -10,8 +10,17 @@
 #include "bucket/LiveBucket.h"
 #include "bucket/LiveBucketIndex.h"
 #include "main/Config.h"
+#include "util/BlockCompressedFile.h"
+#include "util/BufferedFileReader.h"
 #include "util/Fs.h"
+#include "util/MappedFile.h"
+#include "util/MemoryAccounting.h"
+#include "util/XDRStream.h"
+#include "util/types.h"
+#include <Tracy.hpp>
 #include <fmt/format.h>
+#include <istream>
+#include <streambuf>
 
 namespace stellar
 {
@@ -27,20 +36,29 @@ getPageSizeFromConfig(Config const& cfg)
     return 1UL << cfg.BUCKETLIST_DB_INDEX_PAGE_SIZE_EXPONENT;
 }
 
+bool
+hasTypedEntryIndex(LedgerEntryType type)
+{
+    return type == CONFIG_SETTING || type == CONTRACT_CODE;
+}
+
 template <class BucketT>
 std::unique_ptr<typename BucketT::IndexT const>
 createIndex(BucketManager& bm, std::filesystem::path const& filename,
-            Hash const& hash, asio::io_context& ctx, SHA256* hasher)
+            Hash const& hash, asio::io_context& ctx, SHA256* hasher,
+            fs::DurabilityGroup* durability, IORateLimiter* ioLimiter)
 {
     BUCKET_TYPE_ASSERT(BucketT);
 
     ZoneScoped;
+    MEMORY_ACCOUNTING_SCOPE(BUCKET_INDEX);
     releaseAssertOrThrow(!filename.empty());
 
     try
     {
         return std::unique_ptr<typename BucketT::IndexT const>(
-            new typename BucketT::IndexT(bm, filename, hash, ctx, hasher));
+            new typename BucketT::IndexT(bm, filename, hash, ctx, hasher,
+                                         durability, ioLimiter));
     }
     // BucketIndex throws if BucketManager shuts down before index finishes,
     // so return empty index instead of partial index
@@ -50,18 +68,26 @@ createIndex(BucketManager& bm, std::filesystem::path const& filename,
     }
 }
 
-template <class BucketT>
-std::unique_ptr<typename BucketT::IndexT const>
-loadIndex(BucketManager const& bm, std::filesystem::path const& filename,
-          std::size_t fileSize)
+namespace
 {
-    std::ifstream in(filename, std::ios::binary);
-    if (!in)
+// Read-only streambuf over a mapped index file, so cereal reads directly out
+// of the mapping instead of through an intermediate ifstream buffer.
+class MappedFileStreamBuf : public std::streambuf
+{
+  public:
+    explicit MappedFileStreamBuf(MappedFile const& file)
     {
-        throw std::runtime_error(fmt::format(
-            FMT_STRING("Error opening file {}"), filename.string()));
+        // std::streambuf never writes through the get area pointers
+        auto begin = const_cast<char*>(file.data());
+        setg(begin, begin, begin + file.size());
     }
+};
 
+template <class BucketT>
+std::unique_ptr<typename BucketT::IndexT const>
+loadIndexFromStream(BucketManager const& bm, std::istream& in,
+                    std::size_t fileSize)
+{
     std::streamoff pageSize;
     uint32_t version;
     cereal::BinaryInputArchive ar(in);
@@ -83,16 +109,104 @@ loadIndex(BucketManager const& bm, std::filesystem::path const& filename,
     return std::unique_ptr<typename BucketT::IndexT const>(
         new typename BucketT::IndexT(bm, ar, pageSize));
 }
+}
+
+bool
+maybeCompressBucketFile(BucketManager const& bm,
+                        std::filesystem::path const& filename, size_t pageSize,
+                        asio::io_context& ctx, fs::DurabilityGroup* durability)
+{
+    ZoneScoped;
+    auto const& cfg = bm.getConfig();
+    if (!cfg.BUCKETLIST_DB_COMPRESS_BUCKETS || pageSize == 0 ||
+        BlockCompressedFile::readTable(filename.string()))
+    {
+        return false;
+    }
+
+    BufferedFileReader in(BufferedFileReader::DEFAULT_BUFFER_SIZE,
+                          /*sequential=*/true);
+    in.open(filename.string());
+    auto tmp = filename.string() + ".tmp";
+    try
+    {
+        BlockCompressedFile::Writer out(ctx, !cfg.DISABLE_XDR_FSYNC);
+        out.open(tmp);
+
+        // Same page boundaries as DiskIndex. The meta entry, if any, is at
+        // offset 0 and only ever shares the first block with the first page.
+        size_t pageUpperBound = 0;
+        while (in.ensure(4) >= 4)
+        {
+            auto pos = in.pos();
+            size_t size = XDRInputFileStream::getXDRSize(in.data()) + 4;
+            if (in.ensure(size) < size)
+            {
+                throw std::runtime_error(fmt::format(
+                    FMT_STRING("Truncated bucket file {}"), filename.string()));
+            }
+            if (pos >= pageUpperBound)
+            {
+                out.endBlock();
+                pageUpperBound = roundDown(pos, pageSize) + pageSize;
+            }
+            out.write(in.data(), size);
+            in.advance(size);
+        }
+        out.close(durability);
+        in.close();
+        std::filesystem::rename(tmp, filename);
+    }
+    catch (...)
+    {
+        std::error_code ec;
+        std::filesystem::remove(tmp, ec);
+        throw;
+    }
+    return true;
+}
+
+template <class BucketT>
+std::unique_ptr<typename BucketT::IndexT const>
+loadIndex(BucketManager const& bm, std::filesystem::path const& filename,
+          std::size_t fileSize)
+{
+    ZoneScoped;
+    MEMORY_ACCOUNTING_SCOPE(BUCKET_INDEX);
+
+    // Prefer deserializing out of a sequential mapping of the index file. The
+    // file is read exactly once, so its pages can be dropped from the page
+    // cache as soon as they have been consumed.
+    if (auto mapped = MappedFile::map(filename.string(), /*sequential=*/true))
+    {
+        MappedFileStreamBuf buf(*mapped);
+        std::istream in(&buf);
+        return loadIndexFromStream<BucketT>(bm, in, fileSize);
+    }
+
+    std::ifstream in(filename, std::ios::binary);
+    if (!in)
+    {
+        throw std::runtime_error(fmt::format(
+            FMT_STRING("Error opening file {}"), filename.string()));
+    }
+
+    return loadIndexFromStream<BucketT>(bm, in, fileSize);
+}
 
 template std::unique_ptr<typename LiveBucket::IndexT const>
 createIndex<LiveBucket>(BucketManager& bm,
                         std::filesystem::path const& filename, Hash const& hash,
-                        asio::io_context& ctx, SHA256* hasher);
+                        asio::io_context& ctx, SHA256* hasher,
+                        fs::DurabilityGroup* durability,
+                        IORateLimiter* ioLimiter);
 template std::unique_ptr<typename HotArchiveBucket::IndexT const>
 createIndex<HotArchiveBucket>(BucketManager& bm,
                               std::filesystem::path const& filename,
                               Hash const& hash, asio::io_context& ctx,
-                              SHA256* hasher);
+                              SHA256* hasher,
+                              fs::DurabilityGroup* durability,
+                              IORateLimiter* ioLimiter);
 
 template std::unique_ptr<typename LiveBucket::IndexT const>
 loadIndex<LiveBucket>(BucketManager const& bm,
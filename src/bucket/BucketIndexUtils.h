@@ -29,9 +29,49 @@ namespace stellar
 
 class BucketManager;
 class Config;
+class IORateLimiter;
+namespace fs
+{
+class DurabilityGroup;
+}
 
 using AssetPoolIDMap = std::map<Asset, std::vector<PoolID>>;
+using AccountPoolIDMap = std::map<AccountID, std::vector<PoolID>>;
 using IndexPtrT = std::shared_ptr<BucketEntry const>;
+using HotArchiveIndexPtrT = std::shared_ptr<HotArchiveBucketEntry const>;
+
+// Position of a single entry in a bucket file, as recorded by the typed entry
+// index. Typed scans use it to skip entries that are dead or shadowed by a
+// newer bucket without reading and decoding them.
+struct TypedEntryOffset
+{
+    LedgerKey key;
+    std::streamoff offset{};
+    bool isDead{};
+
+    inline bool
+    operator==(TypedEntryOffset const& in) const
+    {
+        return key == in.key && offset == in.offset && isDead == in.isDead;
+    }
+
+    template <class Archive>
+    void
+    serialize(Archive& ar)
+    {
+        ar(key, offset, isDead);
+    }
+};
+
+// Maps LedgerEntryType -> every entry of that type in the bucket, in file
+// order. Only types for which hasTypedEntryIndex returns true are indexed.
+using TypedEntryIndex =
+    std::map<LedgerEntryType, std::vector<TypedEntryOffset>>;
+
+// Returns true for the entry types that get a typed entry index. These are
+// types that are scanned in full on startup or upgrade and have few enough
+// entries that keeping their keys in memory is cheap.
+bool hasTypedEntryIndex(LedgerEntryType type);
 
 // Querying a BucketIndex can return one of three states:
 // 1. CACHE_HIT: The entry is in the cache. Can either be a live or dead entry.
@@ -49,10 +89,11 @@ class IndexReturnT
 {
   private:
     // Payload maps to the possible return states:
-    // CACHE_HIT: IndexPtrT
+    // CACHE_HIT: IndexPtrT or HotArchiveIndexPtrT, depending on bucket type
     // FILE_OFFSET: std::streamoff
     // NOT_FOUND: std::monostate
-    using PayloadT = std::variant<IndexPtrT, std::streamoff, std::monostate>;
+    using PayloadT = std::variant<IndexPtrT, HotArchiveIndexPtrT,
+                                  std::streamoff, std::monostate>;
     PayloadT mPayload;
     IndexReturnState mState;
 
@@ -62,6 +103,11 @@ class IndexReturnT
     {
         releaseAssertOrThrow(entry);
     }
+    IndexReturnT(HotArchiveIndexPtrT entry)
+        : mPayload(entry), mState(IndexReturnState::CACHE_HIT)
+    {
+        releaseAssertOrThrow(entry);
+    }
     IndexReturnT(std::streamoff offset)
         : mPayload(offset), mState(IndexReturnState::FILE_OFFSET)
     {
@@ -83,6 +129,14 @@ class IndexReturnT
         releaseAssertOrThrow(std::holds_alternative<IndexPtrT>(mPayload));
         return std::get<IndexPtrT>(mPayload);
     }
+    HotArchiveIndexPtrT
+    hotArchiveCacheHit() const
+    {
+        releaseAssertOrThrow(mState == IndexReturnState::CACHE_HIT);
+        releaseAssertOrThrow(
+            std::holds_alternative<HotArchiveIndexPtrT>(mPayload));
+        return std::get<HotArchiveIndexPtrT>(mPayload);
+    }
     std::streamoff
     fileOffset() const
     {
@@ -100,10 +154,28 @@ std::streamoff getPageSizeFromConfig(Config const& cfg);
 // DiskIndex or InMemoryIndex depending on config and Bucket size.
 // Note: Constructor does not initialize the cache for live bucket indexes,
 // as this must be done when the Bucket is being added to the BucketList
+// If `durability` is set, a persisted index file is synced and renamed as
+// part of that group instead of on its own. If `ioLimiter` is set, reading
+// the bucket file is charged to it.
 template <class BucketT>
 std::unique_ptr<typename BucketT::IndexT const>
 createIndex(BucketManager& bm, std::filesystem::path const& filename,
-            Hash const& hash, asio::io_context& ctx, SHA256* hasher);
+            Hash const& hash, asio::io_context& ctx, SHA256* hasher,
+            fs::DurabilityGroup* durability = nullptr,
+            IORateLimiter* ioLimiter = nullptr);
+
+// Rewrites the bucket file in the block-compressed format (see
+// BlockCompressedFile) if BUCKETLIST_DB_COMPRESS_BUCKETS is set, the file
+// isn't compressed yet and its index reads it by pages of `pageSize` bytes (0
+// meaning the index holds every entry, in which case the bucket is too small
+// to be worth compressing). Blocks are cut where the index starts pages, so
+// the index's offsets still hold and a page lookup mostly decompresses a
+// single block. Returns true if the file was rewritten. If `durability` is
+// set, the new file is synced as part of that group.
+bool maybeCompressBucketFile(BucketManager const& bm,
+                             std::filesystem::path const& filename,
+                             size_t pageSize, asio::io_context& ctx,
+                             fs::DurabilityGroup* durability = nullptr);
 
 // Loads index from given file. If file does not exist or if saved
 // index does not have expected version or pageSize, return null
@@ -10,6 +10,8 @@
 #include "main/AppConnector.h"
 
 #include "util/GlobalChecks.h"
+#include <fmt/format.h>
+#include <medida/meter.h>
 #include <medida/metrics_registry.h>
 #include <optional>
 #include <vector>
@@ -63,23 +65,77 @@ SearchableBucketListSnapshotBase<BucketT>::loopAllBuckets(
     std::function<Loop(BucketSnapshotT const&)> f,
     BucketListSnapshot<BucketT> const& snapshot) const
 {
-    for (auto const& lev : snapshot.getLevels())
+    loopBuckets(f, snapshot, 0,
+                static_cast<uint32_t>(snapshot.getLevels().size()));
+}
+
+template <class BucketT>
+Loop
+SearchableBucketListSnapshotBase<BucketT>::loopBuckets(
+    std::function<Loop(BucketSnapshotT const&)> f,
+    BucketListSnapshot<BucketT> const& snapshot, uint32_t begin,
+    uint32_t end) const
+{
+    return loopBucketsByLevel(
+        [&f](BucketSnapshotT const& b, uint32_t) { return f(b); }, snapshot,
+        begin, end);
+}
+
+template <class BucketT>
+Loop
+SearchableBucketListSnapshotBase<BucketT>::loopBucketsByLevel(
+    std::function<Loop(BucketSnapshotT const&, uint32_t)> f,
+    BucketListSnapshot<BucketT> const& snapshot, uint32_t begin,
+    uint32_t end) const
+{
+    auto const& levels = snapshot.getLevels();
+    releaseAssert(begin <= end && end <= levels.size());
+    for (auto i = begin; i < end; ++i)
     {
-        auto processBucket = [f](BucketSnapshotT const& b) {
+        auto processBucket = [&f, i](BucketSnapshotT const& b) {
             if (b.isEmpty())
             {
                 return Loop::INCOMPLETE;
             }
 
-            return f(b);
+            return f(b, i);
         };
 
-        if (processBucket(lev.curr) == Loop::COMPLETE ||
-            processBucket(lev.snap) == Loop::COMPLETE)
+        if (processBucket(levels[i].curr) == Loop::COMPLETE ||
+            processBucket(levels[i].snap) == Loop::COMPLETE)
         {
-            return;
+            return Loop::COMPLETE;
         }
     }
+
+    return Loop::INCOMPLETE;
+}
+
+template <class BucketT>
+bool
+SearchableBucketListSnapshotBase<BucketT>::mayBeInFilteredLevels(
+    LedgerKey const& k) const
+{
+    releaseAssert(mBucketListFilter);
+    mBucketListFilterLookups.Mark();
+    if (mBucketListFilter->mayContain(k))
+    {
+        return true;
+    }
+
+    mBucketListFilterAbsent.Mark();
+    return false;
+}
+
+template <class BucketT>
+void
+SearchableBucketListSnapshotBase<BucketT>::markLevelHits(uint32_t level,
+                                                         size_t numHits) const
+{
+    if (numHits != 0 && level < mLevelHitMeters.size())
+    {
+        mLevelHitMeters[level].get().Mark(numHits);
+    }
 }
 
 template <class BucketT>
@@ -92,7 +148,7 @@ SearchableBucketListSnapshotBase<BucketT>::load(LedgerKey const& k) const
     auto startTime = mAppConnector.now();
 
     // Search function called on each Bucket in BucketList until we find the key
-    auto loadKeyBucketLoop = [&](auto const& b) {
+    auto loadKeyBucketLoop = [&](auto const& b, uint32_t level) {
         auto [be, bloomMiss] = b.getBucketEntry(k);
         if (bloomMiss)
         {
@@ -103,6 +159,7 @@ SearchableBucketListSnapshotBase<BucketT>::load(LedgerKey const& k) const
 
         if (be)
         {
+            markLevelHits(level, 1);
             result = BucketT::bucketEntryToLoadResult(be);
             return Loop::COMPLETE;
         }
@@ -112,20 +169,35 @@ SearchableBucketListSnapshotBase<BucketT>::load(LedgerKey const& k) const
         }
     };
 
-    loopAllBuckets(loadKeyBucketLoop, *mSnapshot);
+    // If the key is definitely not in the deeper levels, only search the
+    // levels above them
+    auto numLevels = static_cast<uint32_t>(mSnapshot->getLevels().size());
+    if (mBucketListFilter && !mayBeInFilteredLevels(k))
+    {
+        numLevels = mBucketListFilter->getFirstLevel();
+    }
+
+    loopBucketsByLevel(loadKeyBucketLoop, *mSnapshot, 0, numLevels);
+    recordPointLoad(k.type(), startTime);
+    return result;
+}
+
+template <class BucketT>
+void
+SearchableBucketListSnapshotBase<BucketT>::recordPointLoad(
+    LedgerEntryType type, VirtualClock::time_point startTime) const
+{
     auto endTime = mAppConnector.now();
     auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
         endTime - startTime);
 
-    auto accumulatorIter = mPointAccumulators.find(k.type());
+    auto accumulatorIter = mPointAccumulators.find(type);
     releaseAssert(accumulatorIter != mPointAccumulators.end());
     accumulatorIter->second.inc(duration.count());
 
-    auto counterIter = mPointCounters.find(k.type());
+    auto counterIter = mPointCounters.find(type);
     releaseAssert(counterIter != mPointCounters.end());
     counterIter->second.inc();
-
-    return result;
 }
 
 template <class BucketT>
@@ -139,30 +211,96 @@ SearchableBucketListSnapshotBase<BucketT>::loadKeysInternal(
     // Make a copy of the key set, this loop is destructive
     auto keys = inKeys;
     std::vector<typename BucketT::LoadT> entries;
-    auto loadKeysLoop = [&](auto const& b) {
-        b.loadKeys(keys, entries);
+    bool const batchReads =
+        mAppConnector.getConfig().BUCKETLIST_DB_BATCHED_READS;
+    auto loadKeysLoop = [&](auto const& b, uint32_t level) {
+        auto const numKeys = keys.size();
+        b.loadKeys(keys, entries, batchReads);
+        markLevelHits(level, numKeys - keys.size());
         return keys.empty() ? Loop::COMPLETE : Loop::INCOMPLETE;
     };
 
+    auto const numLevels =
+        static_cast<uint32_t>(mSnapshot->getLevels().size());
     if (!ledgerSeq || *ledgerSeq == mSnapshot->getLedgerSeq())
     {
-        loopAllBuckets(loadKeysLoop, *mSnapshot);
+        if (!mBucketListFilter)
+        {
+            loopBucketsByLevel(loadKeysLoop, *mSnapshot, 0, numLevels);
+            return entries;
+        }
+
+        // Keys that are definitely not in the deeper levels are searched for
+        // in the levels above them, then dropped before searching the rest
+        std::vector<LedgerKey> absentKeys;
+        for (auto const& k : keys)
+        {
+            if (!mayBeInFilteredLevels(k))
+            {
+                absentKeys.emplace_back(k);
+            }
+        }
+
+        auto const firstLevel = mBucketListFilter->getFirstLevel();
+        if (loopBucketsByLevel(loadKeysLoop, *mSnapshot, 0, firstLevel) ==
+            Loop::INCOMPLETE)
+        {
+            for (auto const& k : absentKeys)
+            {
+                keys.erase(k);
+            }
+
+            if (!keys.empty())
+            {
+                loopBucketsByLevel(loadKeysLoop, *mSnapshot, firstLevel,
+                                   numLevels);
+            }
+        }
     }
     else
     {
-        auto iter = mHistoricalSnapshots.find(*ledgerSeq);
-        if (iter == mHistoricalSnapshots.end())
+        auto snapshot = getSnapshotForLedger(*ledgerSeq);
+        if (!snapshot)
         {
             return std::nullopt;
         }
 
-        releaseAssert(iter->second);
-        loopAllBuckets(loadKeysLoop, *iter->second);
+        loopBucketsByLevel(loadKeysLoop, *snapshot, 0,
+                           static_cast<uint32_t>(snapshot->getLevels().size()));
     }
 
     return entries;
 }
 
+template <class BucketT>
+BucketListSnapshot<BucketT> const*
+SearchableBucketListSnapshotBase<BucketT>::getSnapshotForLedger(
+    uint32_t ledgerSeq) const
+{
+    if (ledgerSeq == mSnapshot->getLedgerSeq())
+    {
+        return mSnapshot.get();
+    }
+
+    auto copyIter = mHistoricalCopies.find(ledgerSeq);
+    if (copyIter == mHistoricalCopies.end())
+    {
+        auto iter = mHistoricalSnapshots.find(ledgerSeq);
+        if (iter == mHistoricalSnapshots.end())
+        {
+            return nullptr;
+        }
+
+        releaseAssert(iter->second);
+        copyIter = mHistoricalCopies
+                       .emplace(ledgerSeq,
+                                std::make_unique<BucketListSnapshot<BucketT>>(
+                                    *iter->second))
+                       .first;
+    }
+    return copyIter->second.get();
+}
+
 template <class BucketT>
 std::optional<std::vector<typename BucketT::LoadT>>
 SearchableBucketListSnapshotBase<BucketT>::loadKeysFromLedger(
@@ -183,17 +321,23 @@ template <class BucketT>
 SearchableBucketListSnapshotBase<BucketT>::SearchableBucketListSnapshotBase(
     BucketSnapshotManager const& snapshotManager, AppConnector const& app,
     SnapshotPtrT<BucketT>&& snapshot,
-    std::map<uint32_t, SnapshotPtrT<BucketT>>&& historicalSnapshots)
+    HistoricalSnapshotsT<BucketT> historicalSnapshots,
+    std::shared_ptr<LiveBucketListFilter const> bucketListFilter)
     : mSnapshotManager(snapshotManager)
     , mSnapshot(std::move(snapshot))
     , mHistoricalSnapshots(std::move(historicalSnapshots))
     , mAppConnector(app)
+    , mBucketListFilter(std::move(bucketListFilter))
     , mBulkLoadMeter(app.getMetrics().NewMeter(
           {BucketT::METRIC_STRING, "query", "loads"}, "query"))
     , mBloomMisses(app.getMetrics().NewMeter(
           {BucketT::METRIC_STRING, "bloom", "misses"}, "bloom"))
     , mBloomLookups(app.getMetrics().NewMeter(
           {BucketT::METRIC_STRING, "bloom", "lookups"}, "bloom"))
+    , mBucketListFilterLookups(app.getMetrics().NewMeter(
+          {BucketT::METRIC_STRING, "bloom", "bucketlist-lookups"}, "bloom"))
+    , mBucketListFilterAbsent(app.getMetrics().NewMeter(
+          {BucketT::METRIC_STRING, "bloom", "bucketlist-absent"}, "bloom"))
 {
     // Initialize point load timers for each LedgerEntry type
     for (auto t : xdr::xdr_traits<LedgerEntryType>::enum_values())
@@ -207,6 +351,19 @@ SearchableBucketListSnapshotBase<BucketT>::SearchableBucketListSnapshotBase(
             {BucketT::METRIC_STRING, label, "count"});
         mPointCounters.emplace(static_cast<LedgerEntryType>(t), counter);
     }
+
+    // Restores and archival checks are served from whichever level the key
+    // was archived to most recently, so track where Hot Archive hits land
+    if constexpr (std::is_same_v<BucketT, HotArchiveBucket>)
+    {
+        for (uint32_t i = 0; i < BucketListBase<BucketT>::kNumLevels; ++i)
+        {
+            mLevelHitMeters.emplace_back(
+                app.getMetrics().NewMeter({BucketT::METRIC_STRING, "level-hits",
+                                           fmt::format("level-{}", i)},
+                                          "entry"));
+        }
+    }
 }
 
 template <class BucketT>
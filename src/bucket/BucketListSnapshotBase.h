@@ -11,6 +11,7 @@
 #include "bucket/BucketUtils.h"
 #include "bucket/HotArchiveBucket.h"
 #include "bucket/LiveBucket.h"
+#include "bucket/LiveBucketListFilter.h"
 
 namespace medida
 {
@@ -86,9 +87,19 @@ class SearchableBucketListSnapshotBase : public NonMovableOrCopyable
 
     // Snapshot managed by SnapshotManager
     SnapshotPtrT<BucketT> mSnapshot{};
-    std::map<uint32_t, SnapshotPtrT<BucketT>> mHistoricalSnapshots;
+
+    // Shared with BucketSnapshotManager and never read directly. A historical
+    // snapshot is copied into mHistoricalCopies the first time it is queried,
+    // so snapshots that only query the current ledger never pay for copying
+    // history.
+    HistoricalSnapshotsT<BucketT> const mHistoricalSnapshots;
+    mutable std::map<uint32_t, SnapshotPtrT<BucketT>> mHistoricalCopies{};
     AppConnector const& mAppConnector;
 
+    // Filter over the deeper levels of mSnapshot, if one has been built for
+    // it. Only used for the live BucketList.
+    std::shared_ptr<LiveBucketListFilter const> const mBucketListFilter;
+
     // Tracks the sum of point load times for each LedgerEntryType, in
     // microseconds. For point loads, Timers are too expensive to maintain, so
     // we use a Counter to keep track of the total trend instead.
@@ -102,6 +113,12 @@ class SearchableBucketListSnapshotBase : public NonMovableOrCopyable
     medida::Meter& mBulkLoadMeter;
     medida::Meter& mBloomMisses;
     medida::Meter& mBloomLookups;
+    medida::Meter& mBucketListFilterLookups;
+    medida::Meter& mBucketListFilterAbsent;
+
+    // Number of keys found in each level. Only tracked for the Hot Archive
+    // BucketList, empty otherwise.
+    std::vector<std::reference_wrapper<medida::Meter>> mLevelHitMeters{};
 
     // Loops through all buckets, starting with curr at level 0, then snap at
     // level 0, etc. Calls f on each bucket. Exits early if function
@@ -109,10 +126,33 @@ class SearchableBucketListSnapshotBase : public NonMovableOrCopyable
     void loopAllBuckets(std::function<Loop(BucketSnapshotT const&)> f,
                         BucketListSnapshot<BucketT> const& snapshot) const;
 
+    // Same as loopAllBuckets, but only loops through levels [begin, end).
+    // Returns Loop::COMPLETE if f did.
+    Loop loopBuckets(std::function<Loop(BucketSnapshotT const&)> f,
+                     BucketListSnapshot<BucketT> const& snapshot,
+                     uint32_t begin, uint32_t end) const;
+
+    // Same as loopBuckets, but also passes the level of each bucket to f
+    Loop
+    loopBucketsByLevel(std::function<Loop(BucketSnapshotT const&, uint32_t)> f,
+                       BucketListSnapshot<BucketT> const& snapshot,
+                       uint32_t begin, uint32_t end) const;
+
+    void markLevelHits(uint32_t level, size_t numHits) const;
+
+    // Records a point load of a key of the given type that started at
+    // startTime in mPointAccumulators and mPointCounters
+    void recordPointLoad(LedgerEntryType type,
+                         VirtualClock::time_point startTime) const;
+
+    // Returns false if mBucketListFilter rules out k in the levels it covers
+    bool mayBeInFilteredLevels(LedgerKey const& k) const;
+
     SearchableBucketListSnapshotBase(
         BucketSnapshotManager const& snapshotManager,
         AppConnector const& appConnector, SnapshotPtrT<BucketT>&& snapshot,
-        std::map<uint32_t, SnapshotPtrT<BucketT>>&& historicalSnapshots);
+        HistoricalSnapshotsT<BucketT> historicalSnapshots,
+        std::shared_ptr<LiveBucketListFilter const> bucketListFilter);
 
     std::optional<std::vector<typename BucketT::LoadT>>
     loadKeysInternal(std::set<LedgerKey, LedgerEntryIdCmp> const& inKeys,
@@ -121,6 +161,11 @@ class SearchableBucketListSnapshotBase : public NonMovableOrCopyable
     medida::Timer& getBulkLoadTimer(std::string const& label,
                                     size_t numEntries) const;
 
+    // Returns the snapshot of the BucketList at the start of ledgerSeq, the
+    // current one or a historical one, or nullptr if it isn't retained
+    BucketListSnapshot<BucketT> const*
+    getSnapshotForLedger(uint32_t ledgerSeq) const;
+
   public:
     uint32_t
     getLedgerSeq() const
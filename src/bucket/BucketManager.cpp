@@ -3,6 +3,7 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "bucket/BucketManager.h"
+#include "bucket/BucketIndexUtils.h"
 #include "bucket/BucketInputIterator.h"
 #include "bucket/BucketManager.h"
 #include "bucket/BucketOutputIterator.h"
@@ -24,6 +25,7 @@
 #include "main/Config.h"
 #include "util/Fs.h"
 #include "util/GlobalChecks.h"
+#include "util/IORateLimiter.h"
 #include "util/LogSlowExecution.h"
 #include "util/Logging.h"
 #include "util/ProtocolVersion.h"
@@ -96,6 +98,15 @@ BucketManager::initialize()
     mLockedBucketDir = std::make_unique<std::string>(d);
     mTmpDirManager = std::make_unique<TmpDirManager>(d + "/tmp");
 
+    // Merges finished before the last shutdown, so that restarted merges
+    // whose outputs are still around reattach to them
+    {
+        std::lock_guard<std::recursive_mutex> lock(mBucketMutex);
+        mFinishedMerges.load(mergeMapFilename(), [&](Hash const& h) {
+            return fs::exists(bucketFilename(h));
+        });
+    }
+
     mLiveBucketList = std::make_unique<LiveBucketList>();
     mHotArchiveBucketList = std::make_unique<HotArchiveBucketList>();
     mSnapshotManager = std::make_unique<BucketSnapshotManager>(
@@ -158,10 +169,22 @@ BucketManager::BucketManager(Application& app)
                                                "bucketlistDB"))
     , mCacheMissMeter(app.getMetrics().NewMeter(
           {"bucketlistDB", "cache", "miss"}, "bucketlistDB"))
+    , mHotArchiveCacheHitMeter(app.getMetrics().NewMeter(
+          {HotArchiveBucket::METRIC_STRING, "cache", "hit"}, "bucketlistDB"))
+    , mHotArchiveCacheMissMeter(app.getMetrics().NewMeter(
+          {HotArchiveBucket::METRIC_STRING, "cache", "miss"}, "bucketlistDB"))
     , mLiveBucketIndexCacheEntries(
           app.getMetrics().NewCounter({"bucketlistDB", "cache", "entries"}))
     , mLiveBucketIndexCacheBytes(
           app.getMetrics().NewCounter({"bucketlistDB", "cache", "bytes"}))
+    , mLiveBucketIndexMemoryTotal(app.getMetrics().NewCounter(
+          {"bucketlistDB", "index-memory", "total"}))
+    , mLiveBucketIndexPromotions(app.getMetrics().NewMeter(
+          {"bucketlistDB", "index-memory", "promoted"}, "bucket"))
+    , mIndexBuildRateLimiter(std::make_unique<IORateLimiter>(
+          app.getConfig().BUCKETLIST_DB_INDEX_BUILD_RATE * 1024 * 1024))
+    , mHotArchiveMergeRateLimiter(std::make_unique<IORateLimiter>(
+          app.getConfig().HOT_ARCHIVE_MERGE_RATE * 1024 * 1024))
     , mBucketListEvictionCounters(app)
     , mEvictionStatistics(std::make_shared<EvictionStatistics>())
     , mConfig(app.getConfig())
@@ -180,9 +203,17 @@ BucketManager::BucketManager(Application& app)
             type, app.getMetrics().NewCounter(
                       {"bucketlist", "entrySizes", typeString}));
     }
+
+    for (uint32_t i = 0; i < LiveBucketList::kNumLevels; ++i)
+    {
+        mLiveBucketIndexMemoryByLevel.emplace_back(
+            &app.getMetrics().NewCounter(
+                {"bucketlistDB", "index-memory", fmt::format("level-{}", i)}));
+    }
 }
 
 const std::string BucketManager::kLockFilename = "stellar-core.lock";
+const std::string BucketManager::kMergeMapFilename = "merges.json";
 
 namespace
 {
@@ -234,6 +265,12 @@ BucketManager::bucketIndexFilename(Hash const& hash) const
     return getBucketDir() + "/" + basename;
 }
 
+std::string
+BucketManager::mergeMapFilename() const
+{
+    return getBucketDir() + "/" + kMergeMapFilename;
+}
+
 std::string const&
 BucketManager::getTmpDir()
 {
@@ -359,6 +396,18 @@ BucketManager::getCacheMissMeter() const
     return mCacheMissMeter;
 }
 
+medida::Meter&
+BucketManager::getHotArchiveCacheHitMeter() const
+{
+    return mHotArchiveCacheHitMeter;
+}
+
+medida::Meter&
+BucketManager::getHotArchiveCacheMissMeter() const
+{
+    return mHotArchiveCacheMissMeter;
+}
+
 void
 BucketManager::reportLiveBucketIndexCacheMetrics()
 {
@@ -405,6 +454,65 @@ BucketManager::reportLiveBucketIndexCacheMetrics()
               static_cast<int64_t>(totalEstimatedBytes));
 }
 
+void
+BucketManager::reportLiveBucketIndexMemoryMetrics()
+{
+    size_t totalBytes = 0;
+    for (uint32_t i = 0; i < LiveBucketList::kNumLevels; ++i)
+    {
+        auto const& level = mLiveBucketList->getLevel(i);
+        size_t levelBytes = level.getCurr()->getIndexMemoryUsage() +
+                            level.getSnap()->getIndexMemoryUsage();
+        mLiveBucketIndexMemoryByLevel.at(i)->set_count(levelBytes);
+        totalBytes += levelBytes;
+    }
+
+    mLiveBucketIndexMemoryTotal.set_count(totalBytes);
+    mLiveBucketIndexMemoryBytes.store(totalBytes);
+    TracyPlot("bucketlistDB.index-memory.total",
+              static_cast<int64_t>(totalBytes));
+}
+
+bool
+BucketManager::tryReserveInMemoryIndex(size_t bucketSize)
+{
+    if (mConfig.BUCKETLIST_DB_INDEX_MEMORY_BUDGET == 0)
+    {
+        return false;
+    }
+
+    // In-memory indexes hold decoded entries, which take more memory than
+    // their serialized form. Reserve conservatively until the next report
+    // measures the actual usage.
+    size_t const budget =
+        mConfig.BUCKETLIST_DB_INDEX_MEMORY_BUDGET * 1024 * 1024;
+    size_t const reservation = 2 * bucketSize;
+    auto used = mLiveBucketIndexMemoryBytes.load();
+    do
+    {
+        if (used >= budget || budget - used < reservation)
+        {
+            return false;
+        }
+    } while (!mLiveBucketIndexMemoryBytes.compare_exchange_weak(
+        used, used + reservation));
+
+    mLiveBucketIndexPromotions.Mark();
+    return true;
+}
+
+IORateLimiter&
+BucketManager::getIndexBuildRateLimiter()
+{
+    return *mIndexBuildRateLimiter;
+}
+
+IORateLimiter&
+BucketManager::getHotArchiveMergeRateLimiter()
+{
+    return *mHotArchiveMergeRateLimiter;
+}
+
 template <>
 MergeCounters
 BucketManager::readMergeCounters<LiveBucket>()
@@ -439,10 +547,15 @@ BucketManager::incrMergeCounters<HotArchiveBucket>(MergeCounters const& delta)
 
 bool
 BucketManager::renameBucketDirFile(std::filesystem::path const& src,
-                                   std::filesystem::path const& dst)
+                                   std::filesystem::path const& dst,
+                                   fs::DurabilityGroup* durability)
 {
     ZoneScoped;
-    if (mConfig.DISABLE_XDR_FSYNC)
+    if (durability)
+    {
+        return durability->rename(src.string(), dst.string(), getBucketDir());
+    }
+    else if (mConfig.DISABLE_XDR_FSYNC)
     {
         return rename(src.string().c_str(), dst.string().c_str()) == 0;
     }
@@ -456,21 +569,24 @@ template <>
 std::shared_ptr<LiveBucket>
 BucketManager::adoptFileAsBucket(
     std::string const& filename, uint256 const& hash, MergeKey* mergeKey,
-    std::unique_ptr<LiveBucket::IndexT const> index)
+    std::unique_ptr<LiveBucket::IndexT const> index,
+    fs::DurabilityGroup* durability)
 {
     return adoptFileAsBucketInternal(filename, hash, mergeKey, std::move(index),
-                                     mSharedLiveBuckets, mLiveBucketFutures);
+                                     mSharedLiveBuckets, mLiveBucketFutures,
+                                     durability);
 }
 
 template <>
 std::shared_ptr<HotArchiveBucket>
 BucketManager::adoptFileAsBucket(
     std::string const& filename, uint256 const& hash, MergeKey* mergeKey,
-    std::unique_ptr<HotArchiveBucket::IndexT const> index)
+    std::unique_ptr<HotArchiveBucket::IndexT const> index,
+    fs::DurabilityGroup* durability)
 {
     return adoptFileAsBucketInternal(filename, hash, mergeKey, std::move(index),
                                      mSharedHotArchiveBuckets,
-                                     mHotArchiveBucketFutures);
+                                     mHotArchiveBucketFutures, durability);
 }
 
 template <typename BucketT>
@@ -478,7 +594,8 @@ std::shared_ptr<BucketT>
 BucketManager::adoptFileAsBucketInternal(
     std::string const& filename, uint256 const& hash, MergeKey* mergeKey,
     std::unique_ptr<typename BucketT::IndexT const> index,
-    BucketMapT<BucketT>& bucketMap, FutureMapT<BucketT>& futureMap)
+    BucketMapT<BucketT>& bucketMap, FutureMapT<BucketT>& futureMap,
+    fs::DurabilityGroup* durability)
 {
     BUCKET_TYPE_ASSERT(BucketT);
     ZoneScoped;
@@ -523,14 +640,14 @@ BucketManager::adoptFileAsBucketInternal(
         std::string canonicalName = bucketFilename(hash);
         CLOG_DEBUG(Bucket, "Adopting bucket file {} as {}", filename,
                    canonicalName);
-        if (!renameBucketDirFile(filename, canonicalName))
+        if (!renameBucketDirFile(filename, canonicalName, durability))
         {
             std::string err("Failed to rename bucket :");
             err += strerror(errno);
             // it seems there is a race condition with external systems
             // retry after sleeping for a second works around the problem
             std::this_thread::sleep_for(std::chrono::seconds(1));
-            if (!renameBucketDirFile(filename, canonicalName))
+            if (!renameBucketDirFile(filename, canonicalName, durability))
             {
                 // if rename fails again, surface the original error
                 throw std::runtime_error(err);
@@ -538,11 +655,22 @@ BucketManager::adoptFileAsBucketInternal(
         }
 
         b = std::make_shared<BucketT>(canonicalName, hash, std::move(index));
+        if (mConfig.BUCKETLIST_DB_MMAP_BUCKETS)
+        {
+            b->mapFile();
+        }
         {
             bucketMap.emplace(hash, b);
             updateSharedBucketSize();
         }
     }
+    if (durability)
+    {
+        // Still under the lock, so no other adoption of the same bucket can
+        // return before the rename is durable. Also covers the rename of the
+        // bucket's index if it was persisted as part of the group.
+        durability->commit();
+    }
     releaseAssert(b);
     if (mergeKey)
     {
@@ -665,6 +793,10 @@ BucketManager::getBucketByHashInternal(uint256 const& hash,
 
         auto p =
             std::make_shared<BucketT>(canonicalName, hash, /*index=*/nullptr);
+        if (mConfig.BUCKETLIST_DB_MMAP_BUCKETS)
+        {
+            p->mapFile();
+        }
         bucketMap.emplace(hash, p);
         updateSharedBucketSize();
         return p;
@@ -674,22 +806,23 @@ BucketManager::getBucketByHashInternal(uint256 const& hash,
 
 template <>
 std::shared_future<std::shared_ptr<LiveBucket>>
-BucketManager::getMergeFuture(MergeKey const& key)
+BucketManager::getMergeFuture(MergeKey const& key, asio::io_context& ctx)
 {
-    return getMergeFutureInternal(key, mLiveBucketFutures);
+    return getMergeFutureInternal(key, mLiveBucketFutures, ctx);
 }
 
 template <>
 std::shared_future<std::shared_ptr<HotArchiveBucket>>
-BucketManager::getMergeFuture(MergeKey const& key)
+BucketManager::getMergeFuture(MergeKey const& key, asio::io_context& ctx)
 {
-    return getMergeFutureInternal(key, mHotArchiveBucketFutures);
+    return getMergeFutureInternal(key, mHotArchiveBucketFutures, ctx);
 }
 
 template <class BucketT>
 std::shared_future<std::shared_ptr<BucketT>>
 BucketManager::getMergeFutureInternal(MergeKey const& key,
-                                      FutureMapT<BucketT>& futureMap)
+                                      FutureMapT<BucketT>& futureMap,
+                                      asio::io_context& ctx)
 {
     BUCKET_TYPE_ASSERT(BucketT);
     ZoneScoped;
@@ -706,6 +839,7 @@ BucketManager::getMergeFutureInternal(MergeKey const& key,
             auto bucket = BucketManager::getBucketByHash<BucketT>(bucketHash);
             if (bucket)
             {
+                indexReattachedBucket(bucket, ctx);
                 CLOG_TRACE(Bucket,
                            "BucketManager::getMergeFuture returning new future "
                            "for finished merge {} with output={}",
@@ -733,6 +867,43 @@ BucketManager::getMergeFutureInternal(MergeKey const& key,
     return i->second;
 }
 
+template <class BucketT>
+void
+BucketManager::indexReattachedBucket(std::shared_ptr<BucketT> const& bucket,
+                                     asio::io_context& ctx)
+{
+    ZoneScoped;
+    // Outputs of merges finished before a restart are only known by their
+    // file, and outputs that dropped out of the BucketList may have had their
+    // index freed. Either way, merge outputs go on the BucketList, which only
+    // holds indexed buckets.
+    if (bucket->isEmpty() || bucket->isIndexed())
+    {
+        return;
+    }
+
+    std::unique_ptr<typename BucketT::IndexT const> index;
+    auto indexFilename = bucketIndexFilename(bucket->getHash());
+    if (mConfig.BUCKETLIST_DB_PERSIST_INDEX && fs::exists(indexFilename))
+    {
+        try
+        {
+            index = loadIndex<BucketT>(*this, indexFilename, bucket->getSize());
+        }
+        catch (std::runtime_error&)
+        {
+            CLOG_WARNING(Bucket, "Invalid or corrupt index file: {}",
+                         indexFilename);
+        }
+    }
+    if (!index)
+    {
+        index = createIndex<BucketT>(*this, bucket->getFilename(),
+                                     bucket->getHash(), ctx, nullptr);
+    }
+    maybeSetIndex(bucket, std::move(index));
+}
+
 template <>
 void
 BucketManager::putMergeFuture(
@@ -903,6 +1074,9 @@ BucketManager::cleanupStaleFiles(HistoryArchiveState const& has)
             // GC index as well
             auto indexFilename = bucketIndexFilename(hash);
             std::remove(indexFilename.c_str());
+
+            // Merges loaded from the saved merge map may have produced it
+            mFinishedMerges.forgetAllMergesProducing(hash);
         }
     }
 }
@@ -1005,6 +1179,13 @@ BucketManager::forgetUnreferencedBuckets(HistoryArchiveState const& has)
     bucketMapLoop(mSharedLiveBuckets, mLiveBucketFutures);
     bucketMapLoop(mSharedHotArchiveBuckets, mHotArchiveBucketFutures);
     updateSharedBucketSize();
+
+    // Runs every ledger close and on shutdown, so the saved merge map is at
+    // most a ledger behind
+    if (mFinishedMerges.isDirty())
+    {
+        mFinishedMerges.save(mergeMapFilename());
+    }
 }
 
 void
@@ -1028,6 +1209,7 @@ BucketManager::addLiveBatch(Application& app, LedgerHeader header,
     mLiveBucketListSizeCounter.set_count(mLiveBucketList->getSize());
     reportBucketEntryCountMetrics();
     reportLiveBucketIndexCacheMetrics();
+    reportLiveBucketIndexMemoryMetrics();
 }
 
 void
@@ -1352,6 +1534,8 @@ BucketManager::assumeState(HistoryArchiveState const& has,
     }
 
     mLiveBucketList->maybeInitializeCaches(mConfig);
+    mHotArchiveBucketList->maybeInitializeCaches(mConfig);
+    reportLiveBucketIndexMemoryMetrics();
 
     if (restartMerges)
     {
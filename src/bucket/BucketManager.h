@@ -19,6 +19,11 @@
 // under the Apache License, Version 2.0. See the COPYING file at the root
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
+namespace asio
+{
+class io_context;
+}
+
 namespace medida
 {
 class Timer;
@@ -36,12 +41,17 @@ class Bucket;
 class LiveBucketList;
 class HotArchiveBucketList;
 class BucketSnapshotManager;
+class IORateLimiter;
 class SearchableLiveBucketListSnapshot;
 struct BucketEntryCounters;
 enum class LedgerEntryTypeAndDurability : uint32_t;
 class SorobanNetworkConfig;
 
 struct HistoryArchiveState;
+namespace fs
+{
+class DurabilityGroup;
+}
 
 /**
  * BucketManager is responsible for maintaining a collection of Buckets of
@@ -73,6 +83,7 @@ class BucketManager : NonMovableOrCopyable
         UnorderedMap<MergeKey, std::shared_future<std::shared_ptr<BucketT>>>;
 
     static std::string const kLockFilename;
+    static std::string const kMergeMapFilename;
 
     // NB: ideally, BucketManager should have no access to mApp, as it's too
     // dangerous in the context of parallel application. BucketManager is quite
@@ -103,8 +114,23 @@ class BucketManager : NonMovableOrCopyable
     medida::Counter& mArchiveBucketListSizeCounter;
     medida::Meter& mCacheHitMeter;
     medida::Meter& mCacheMissMeter;
+    medida::Meter& mHotArchiveCacheHitMeter;
+    medida::Meter& mHotArchiveCacheMissMeter;
     medida::Counter& mLiveBucketIndexCacheEntries;
     medida::Counter& mLiveBucketIndexCacheBytes;
+    medida::Counter& mLiveBucketIndexMemoryTotal;
+    std::vector<medida::Counter*> mLiveBucketIndexMemoryByLevel;
+    medida::Meter& mLiveBucketIndexPromotions;
+    // Shared by the indexes built by IndexBucketsWork, under
+    // BUCKETLIST_DB_INDEX_BUILD_RATE
+    std::unique_ptr<IORateLimiter> mIndexBuildRateLimiter;
+    // Shared by hot archive merges, under HOT_ARCHIVE_MERGE_RATE
+    std::unique_ptr<IORateLimiter> mHotArchiveMergeRateLimiter;
+
+    // Index memory of the live BucketList as of the last call to
+    // reportLiveBucketIndexMemoryMetrics, plus the memory reserved since then
+    // for indexes promoted to in-memory form by tryReserveInMemoryIndex.
+    std::atomic<size_t> mLiveBucketIndexMemoryBytes{0};
     EvictionCounters mBucketListEvictionCounters;
     MergeCounters mLiveMergeCounters;
     MergeCounters mHotArchiveMergeCounters;
@@ -137,6 +163,10 @@ class BucketManager : NonMovableOrCopyable
     std::atomic<bool> mIsShutdown{false};
 
     void cleanupStaleFiles(HistoryArchiveState const& has);
+    std::string mergeMapFilename() const;
+    template <class BucketT>
+    void indexReattachedBucket(std::shared_ptr<BucketT> const& bucket,
+                               asio::io_context& ctx);
     void deleteTmpDirAndUnlockBucketDir();
     void deleteEntireBucketDir();
 
@@ -146,7 +176,8 @@ class BucketManager : NonMovableOrCopyable
     std::shared_ptr<BucketT> adoptFileAsBucketInternal(
         std::string const& filename, uint256 const& hash, MergeKey* mergeKey,
         std::unique_ptr<typename BucketT::IndexT const> index,
-        BucketMapT<BucketT>& bucketMap, FutureMapT<BucketT>& futureMap);
+        BucketMapT<BucketT>& bucketMap, FutureMapT<BucketT>& futureMap,
+        fs::DurabilityGroup* durability);
 
     template <class BucketT>
     std::shared_ptr<BucketT>
@@ -159,7 +190,8 @@ class BucketManager : NonMovableOrCopyable
 
     template <class BucketT>
     std::shared_future<std::shared_ptr<BucketT>>
-    getMergeFutureInternal(MergeKey const& key, FutureMapT<BucketT>& futureMap);
+    getMergeFutureInternal(MergeKey const& key, FutureMapT<BucketT>& futureMap,
+                           asio::io_context& ctx);
 
     template <class BucketT>
     void
@@ -172,6 +204,7 @@ class BucketManager : NonMovableOrCopyable
                                       FutureMapT<BucketT>& futureMap);
 
     void reportLiveBucketIndexCacheMetrics();
+    void reportLiveBucketIndexMemoryMetrics();
 
 #ifdef BUILD_TESTS
     bool mUseFakeTestValuesForNextClose{false};
@@ -199,8 +232,11 @@ class BucketManager : NonMovableOrCopyable
     LiveBucketList& getLiveBucketList();
     HotArchiveBucketList& getHotArchiveBucketList();
     BucketSnapshotManager& getBucketSnapshotManager() const;
+    // Renames within the bucket directory as part of `durability` if set,
+    // durably on its own otherwise
     bool renameBucketDirFile(std::filesystem::path const& src,
-                             std::filesystem::path const& dst);
+                             std::filesystem::path const& dst,
+                             fs::DurabilityGroup* durability = nullptr);
 
     medida::Timer& getMergeTimer();
 
@@ -208,6 +244,24 @@ class BucketManager : NonMovableOrCopyable
     template <class BucketT> medida::Meter& getBloomLookupMeter() const;
     medida::Meter& getCacheHitMeter() const;
     medida::Meter& getCacheMissMeter() const;
+    medida::Meter& getHotArchiveCacheHitMeter() const;
+    medida::Meter& getHotArchiveCacheMissMeter() const;
+
+    // Called when indexing a live bucket that is too large for an in-memory
+    // index under BUCKETLIST_DB_INDEX_CUTOFF. Returns true, and reserves
+    // memory for it, if an in-memory index for a bucket of bucketSize bytes
+    // fits in BUCKETLIST_DB_INDEX_MEMORY_BUDGET. This is threadsafe. The
+    // reservation is an estimate and is replaced by the measured memory of
+    // the BucketList's indexes on the next ledger close.
+    bool tryReserveInMemoryIndex(size_t bucketSize);
+
+    // Disk budget of bulk index builds, see BUCKETLIST_DB_INDEX_BUILD_RATE.
+    // This is threadsafe.
+    IORateLimiter& getIndexBuildRateLimiter();
+
+    // Disk budget of hot archive merges, see HOT_ARCHIVE_MERGE_RATE. This is
+    // threadsafe.
+    IORateLimiter& getHotArchiveMergeRateLimiter();
 
     // Reading and writing the merge counters is done in bulk, and takes a lock
     // briefly; this can be done from any thread.
@@ -225,11 +279,15 @@ class BucketManager : NonMovableOrCopyable
     // This method is mostly-threadsafe -- assuming you don't destruct the
     // BucketManager mid-call -- and is intended to be called from both main and
     // worker threads. Very carefully.
+    //
+    // If `durability` is set, `filename` is renamed as part of that group,
+    // which is committed before the bucket is published.
     template <class BucketT>
     std::shared_ptr<BucketT>
     adoptFileAsBucket(std::string const& filename, uint256 const& hash,
                       MergeKey* mergeKey,
-                      std::unique_ptr<typename BucketT::IndexT const> index);
+                      std::unique_ptr<typename BucketT::IndexT const> index,
+                      fs::DurabilityGroup* durability = nullptr);
 
     // Companion method to `adoptFileAsLiveBucket` also called from the
     // `BucketOutputIterator::getBucket` merge-completion path. This method
@@ -253,10 +311,11 @@ class BucketManager : NonMovableOrCopyable
     // somewhat recently) from either a map of the std::shared_futures doing the
     // merges and/or a set of records mapping merge inputs to outputs and the
     // set of outputs held in the BucketManager. Returns an invalid future if no
-    // such future can be found or synthesized.
+    // such future can be found or synthesized. Synthesized futures hold
+    // indexed buckets, unindexed outputs are indexed on `ctx` first.
     template <class BucketT>
     std::shared_future<std::shared_ptr<BucketT>>
-    getMergeFuture(MergeKey const& key);
+    getMergeFuture(MergeKey const& key, asio::io_context& ctx);
 
     // Add a reference to a merge _in progress_ (not yet adopted as a file) to
     // the BucketManager's internal map of std::shared_futures doing merges.
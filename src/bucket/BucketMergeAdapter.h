@@ -103,6 +103,93 @@ template <class BucketT> class FileMergeInput : public MergeInput<BucketT>
     }
 };
 
+// File based merge input restricted to entries strictly less than an upper
+// bound. Used by partitioned merges, where each partition reads the key range
+// [lowerBound, upperBound) of both inputs. Callers are responsible for
+// positioning the iterators at the partition's lower bound. If upperBound is
+// null, the range extends to the end of both inputs.
+template <class BucketT> class RangeFileMergeInput : public MergeInput<BucketT>
+{
+  private:
+    BucketInputIterator<BucketT>& mOldIter;
+    BucketInputIterator<BucketT>& mNewIter;
+    typename BucketT::EntryT const* const mUpperBound;
+    BucketEntryIdCmp<BucketT> mCmp;
+
+    bool
+    oldValid() const
+    {
+        return mOldIter && (!mUpperBound || mCmp(*mOldIter, *mUpperBound));
+    }
+
+    bool
+    newValid() const
+    {
+        return mNewIter && (!mUpperBound || mCmp(*mNewIter, *mUpperBound));
+    }
+
+  public:
+    RangeFileMergeInput(BucketInputIterator<BucketT>& oldIter,
+                        BucketInputIterator<BucketT>& newIter,
+                        typename BucketT::EntryT const* upperBound)
+        : mOldIter(oldIter), mNewIter(newIter), mUpperBound(upperBound)
+    {
+    }
+
+    bool
+    isDone() const override
+    {
+        return !oldValid() && !newValid();
+    }
+
+    bool
+    oldFirst() const override
+    {
+        auto oldOk = oldValid();
+        auto newOk = newValid();
+        return !newOk || (oldOk && mCmp(*mOldIter, *mNewIter));
+    }
+
+    bool
+    newFirst() const override
+    {
+        auto oldOk = oldValid();
+        auto newOk = newValid();
+        return !oldOk || (newOk && mCmp(*mNewIter, *mOldIter));
+    }
+
+    bool
+    equalKeys() const override
+    {
+        return oldValid() && newValid() && !mCmp(*mOldIter, *mNewIter) &&
+               !mCmp(*mNewIter, *mOldIter);
+    }
+
+    typename BucketT::EntryT const&
+    getOldEntry() override
+    {
+        return *mOldIter;
+    }
+
+    typename BucketT::EntryT const&
+    getNewEntry() override
+    {
+        return *mNewIter;
+    }
+
+    void
+    advanceOld() override
+    {
+        ++mOldIter;
+    }
+
+    void
+    advanceNew() override
+    {
+        ++mNewIter;
+    }
+};
+
 template <class BucketT> class MemoryMergeInput : public MergeInput<BucketT>
 {
   private:
@@ -7,9 +7,35 @@
 #include "util/GlobalChecks.h"
 #include "util/Logging.h"
 #include <Tracy.hpp>
+#include <cereal/archives/json.hpp>
+#include <cereal/cereal.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+#include <filesystem>
+#include <fstream>
 
 namespace
 {
+uint32_t const MERGE_MAP_FILE_VERSION = 1;
+
+// A merge as saved by BucketMergeMap::save, with hex hashes
+struct SavedMerge
+{
+    bool keepTombstoneEntries{false};
+    std::string curr;
+    std::string snap;
+    std::vector<std::string> shadows;
+    std::string output;
+
+    template <class Archive>
+    void
+    serialize(Archive& ar)
+    {
+        ar(CEREAL_NVP(keepTombstoneEntries), CEREAL_NVP(curr),
+           CEREAL_NVP(snap), CEREAL_NVP(shadows), CEREAL_NVP(output));
+    }
+};
+
 stellar::UnorderedSet<stellar::Hash>
 getMergeKeyHashes(stellar::MergeKey const& key)
 {
@@ -32,6 +58,7 @@ void
 BucketMergeMap::recordMerge(MergeKey const& input, Hash const& output)
 {
     ZoneScoped;
+    mDirty = true;
     mMergeKeyToOutput.emplace(input, output);
     mOutputToMergeKey.emplace(output, input);
     for (auto const& in : getMergeKeyHashes(input))
@@ -57,6 +84,7 @@ BucketMergeMap::forgetAllMergesProducing(Hash const& outputBeingDropped)
         auto const& mergeKeyProducingOutput = mergeProducingOutput->second;
         releaseAssert(output == outputBeingDropped);
         ret.emplace(mergeKeyProducingOutput);
+        mDirty = true;
 
         // It's possible for the same output to occur for multiple
         // merge keys (eg. a+b and b+a). And the set of per-input
@@ -129,4 +157,106 @@ BucketMergeMap::getOutputsUsingInput(Hash const& input,
                    hexAbbrev(i->second), hexAbbrev(input));
     }
 }
+
+void
+BucketMergeMap::save(std::string const& filename)
+{
+    ZoneScoped;
+    std::vector<SavedMerge> merges;
+    merges.reserve(mMergeKeyToOutput.size());
+    for (auto const& [key, output] : mMergeKeyToOutput)
+    {
+        SavedMerge m;
+        m.keepTombstoneEntries = key.mKeepTombstoneEntries;
+        m.curr = binToHex(key.mInputCurrBucket);
+        m.snap = binToHex(key.mInputSnapBucket);
+        for (auto const& h : key.mInputShadowBuckets)
+        {
+            m.shadows.emplace_back(binToHex(h));
+        }
+        m.output = binToHex(output);
+        merges.emplace_back(std::move(m));
+    }
+
+    // Written aside and renamed, so that a crash never leaves a truncated
+    // file behind. Not synced: losing the latest version only means redoing
+    // some merges.
+    auto tmpFilename = filename + ".tmp";
+    try
+    {
+        std::ofstream out;
+        out.exceptions(std::ios::failbit | std::ios::badbit);
+        out.open(tmpFilename);
+        {
+            cereal::JSONOutputArchive ar(out);
+            ar(cereal::make_nvp("version", MERGE_MAP_FILE_VERSION),
+               cereal::make_nvp("merges", merges));
+        }
+        out.close();
+        std::filesystem::rename(tmpFilename, filename);
+        mDirty = false;
+    }
+    catch (std::exception const& e)
+    {
+        CLOG_WARNING(Bucket, "Failed to save merge map to {}: {}", filename,
+                     e.what());
+    }
+}
+
+void
+BucketMergeMap::load(std::string const& filename,
+                     std::function<bool(Hash const&)> const& outputExists)
+{
+    ZoneScoped;
+    std::ifstream in(filename);
+    if (!in)
+    {
+        return;
+    }
+
+    try
+    {
+        in.exceptions(std::ios::badbit);
+        cereal::JSONInputArchive ar(in);
+        uint32_t version = 0;
+        ar(cereal::make_nvp("version", version));
+        if (version != MERGE_MAP_FILE_VERSION)
+        {
+            CLOG_WARNING(Bucket, "Ignoring merge map {} with version {}",
+                         filename, version);
+            return;
+        }
+        std::vector<SavedMerge> merges;
+        ar(cereal::make_nvp("merges", merges));
+
+        size_t loaded = 0;
+        for (auto const& m : merges)
+        {
+            auto output = hexToBin256(m.output);
+            if (!outputExists(output))
+            {
+                continue;
+            }
+            std::vector<Hash> shadows;
+            for (auto const& h : m.shadows)
+            {
+                shadows.emplace_back(hexToBin256(h));
+            }
+            MergeKey key{m.keepTombstoneEntries, hexToBin256(m.curr),
+                         hexToBin256(m.snap), shadows};
+            if (mMergeKeyToOutput.find(key) == mMergeKeyToOutput.end())
+            {
+                recordMerge(key, output);
+                ++loaded;
+            }
+        }
+        CLOG_INFO(Bucket, "Loaded {} of {} saved merges from {}", loaded,
+                  merges.size(), filename);
+    }
+    catch (std::exception const& e)
+    {
+        CLOG_WARNING(Bucket, "Ignoring corrupt merge map {}: {}", filename,
+                     e.what());
+    }
+}
 }
@@ -5,7 +5,9 @@
 #include "util/UnorderedMap.h"
 #include "util/UnorderedSet.h"
 #include "xdr/Stellar-types.h"
+#include <functional>
 #include <set>
+#include <string>
 
 // Copyright 2019 Stellar Development Foundation and contributors. Licensed
 // under the Apache License, Version 2.0. See the COPYING file at the root
@@ -40,10 +42,27 @@ class BucketMergeMap
     // by multiple MergeKeys.
     std::unordered_multimap<Hash, MergeKey> mOutputToMergeKey;
 
+    // Set when the map changes, cleared when it's saved.
+    bool mDirty{false};
+
   public:
     void recordMerge(MergeKey const& input, Hash const& output);
     UnorderedSet<MergeKey> forgetAllMergesProducing(Hash const& output);
     bool findMergeFor(MergeKey const& input, Hash& output);
     void getOutputsUsingInput(Hash const& input, std::set<Hash>& outputs) const;
+
+    // The map is saved alongside the buckets so that merges whose outputs
+    // are still in the bucket directory after a restart are reattached to
+    // rather than run again. It is only a cache: a missing, outdated or
+    // corrupt file just means redoing merges, so load() ignores those, and
+    // only keeps merges for which `outputExists`.
+    bool
+    isDirty() const
+    {
+        return mDirty;
+    }
+    void save(std::string const& filename);
+    void load(std::string const& filename,
+              std::function<bool(Hash const&)> const& outputExists);
 };
 }
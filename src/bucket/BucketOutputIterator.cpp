@@ -5,14 +5,18 @@
 #include "bucket/BucketOutputIterator.h"
 #include "bucket/BucketIndexUtils.h"
 #include "bucket/BucketManager.h"
+#include "bucket/BucketWriteStage.h"
 #include "bucket/HotArchiveBucket.h"
 #include "bucket/LiveBucket.h"
 #include "bucket/LiveBucketIndex.h"
 #include "ledger/LedgerTypeUtils.h"
+#include "util/FileSystemException.h"
+#include "util/Fs.h"
 #include "util/GlobalChecks.h"
 #include "util/ProtocolVersion.h"
 #include <Tracy.hpp>
 #include <filesystem>
+#include <fstream>
 
 namespace stellar
 {
@@ -27,7 +31,9 @@ BucketOutputIterator<BucketT>::BucketOutputIterator(std::string const& tmpDir,
                                                     BucketMetadata const& meta,
                                                     MergeCounters& mc,
                                                     asio::io_context& ctx,
-                                                    bool doFsync)
+                                                    bool doFsync,
+                                                    bool writeMetaEntry,
+                                                    bool pipelineWrites)
     : mFilename(BucketT::randomBucketName(tmpDir))
     , mOut(ctx, doFsync)
     , mCtx(ctx)
@@ -42,7 +48,18 @@ BucketOutputIterator<BucketT>::BucketOutputIterator(std::string const& tmpDir,
     // Will throw if unable to open the file
     mOut.open(mFilename.string());
 
-    if (protocolVersionStartsFrom(
+    if (pipelineWrites)
+    {
+        mWriteStage = std::make_unique<BucketWriteStage>(mOut, mHasher);
+    }
+
+    if (!writeMetaEntry)
+    {
+        // Partition outputs never contain a METAENTRY, the bucket they are
+        // appended to already has one.
+        mPutMeta = true;
+    }
+    else if (protocolVersionStartsFrom(
             meta.ledgerVersion,
             LiveBucket::FIRST_PROTOCOL_SUPPORTING_INITENTRY_AND_METAENTRY))
     {
@@ -73,6 +90,24 @@ BucketOutputIterator<BucketT>::BucketOutputIterator(std::string const& tmpDir,
     }
 }
 
+template <typename BucketT>
+BucketOutputIterator<BucketT>::~BucketOutputIterator() = default;
+
+template <typename BucketT>
+void
+BucketOutputIterator<BucketT>::writeEntry(typename BucketT::EntryT const& e)
+{
+    if (mWriteStage)
+    {
+        mBytesPut += mWriteStage->append(e);
+    }
+    else
+    {
+        mOut.writeOne(e, &mHasher, &mBytesPut);
+    }
+    mObjectsPut++;
+}
+
 template <typename BucketT>
 void
 BucketOutputIterator<BucketT>::put(typename BucketT::EntryT const& e)
@@ -150,8 +185,7 @@ BucketOutputIterator<BucketT>::put(typename BucketT::EntryT const& e)
         if (mCmp(*mBuf, e))
         {
             ++mMergeCounters.mOutputIteratorActualWrites;
-            mOut.writeOne(*mBuf, &mHasher, &mBytesPut);
-            mObjectsPut++;
+            writeEntry(*mBuf);
         }
     }
     else
@@ -164,6 +198,81 @@ BucketOutputIterator<BucketT>::put(typename BucketT::EntryT const& e)
     *mBuf = e;
 }
 
+template <typename BucketT>
+void
+BucketOutputIterator<BucketT>::appendPartition(
+    BucketOutputIterator<BucketT>& partition)
+{
+    ZoneScoped;
+    if (partition.mWriteStage)
+    {
+        partition.mWriteStage->drain();
+        partition.mWriteStage.reset();
+    }
+    partition.mOut.close();
+
+    if (mBuf && (partition.mBuf || partition.mObjectsPut > 0))
+    {
+        // The partition's greatest entry must sort after our own buffered
+        // entry. Partitions cover disjoint key ranges, so unlike put() the
+        // buffered entry is always flushed rather than replaced.
+        releaseAssert(!partition.mBuf || mCmp(*mBuf, *partition.mBuf));
+        ++mMergeCounters.mOutputIteratorActualWrites;
+        writeEntry(*mBuf);
+        mBuf.reset();
+    }
+
+    if (partition.mObjectsPut > 0)
+    {
+        // The partition is copied directly into mOut and mHasher
+        if (mWriteStage)
+        {
+            mWriteStage->drain();
+        }
+
+        std::ifstream in(partition.mFilename, std::ios::in | std::ios::binary);
+        if (!in)
+        {
+            FileSystemException::failWith(
+                "BucketOutputIterator::appendPartition() could not open " +
+                partition.mFilename.string());
+        }
+
+        std::vector<char> buf(fs::bufsz());
+        size_t copied = 0;
+        while (in)
+        {
+            in.read(buf.data(), buf.size());
+            auto n = static_cast<size_t>(in.gcount());
+            if (n > 0)
+            {
+                mOut.writeBytes(buf.data(), n);
+                mHasher.add(ByteSlice(buf.data(), n));
+                copied += n;
+            }
+        }
+
+        if (in.bad() || copied != partition.mBytesPut)
+        {
+            FileSystemException::failWith(
+                "BucketOutputIterator::appendPartition() failed reading " +
+                partition.mFilename.string());
+        }
+
+        mBytesPut += copied;
+        mObjectsPut += partition.mObjectsPut;
+    }
+
+    // The partition's last entry is still buffered, take it over so it is
+    // written (and counted) exactly as it would have been in a serial merge.
+    if (partition.mBuf)
+    {
+        mBuf = std::move(partition.mBuf);
+    }
+
+    std::filesystem::remove(partition.mFilename);
+}
+
 template <typename BucketT>
 std::shared_ptr<BucketT>
 BucketOutputIterator<BucketT>::getBucket(
@@ -174,12 +283,21 @@ BucketOutputIterator<BucketT>::getBucket(
     ZoneScoped;
     if (mBuf)
     {
-        mOut.writeOne(*mBuf, &mHasher, &mBytesPut);
-        mObjectsPut++;
+        writeEntry(*mBuf);
         mBuf.reset();
     }
 
-    mOut.close();
+    if (mWriteStage)
+    {
+        mWriteStage->drain();
+        mWriteStage.reset();
+    }
+
+    // The bucket file, its index file if persisted, and their renames into
+    // the bucket directory are made durable together on adoption
+    fs::DurabilityGroup durability(
+        !bucketManager.getConfig().DISABLE_XDR_FSYNC);
+    mOut.close(durability);
     if (mObjectsPut == 0 || mBytesPut == 0)
     {
         releaseAssert(mObjectsPut == 0);
@@ -214,12 +332,23 @@ BucketOutputIterator<BucketT>::getBucket(
         if (!index)
         {
             index = createIndex<BucketT>(bucketManager, mFilename, hash, mCtx,
-                                         nullptr);
+                                         nullptr, &durability);
         }
     }
 
+    // Offsets in the index are those of the uncompressed file, so the file can
+    // be compressed once the index is built
+    if (index)
+    {
+        maybeCompressBucketFile(bucketManager, mFilename, index->getPageSize(),
+                                mCtx, &durability);
+    }
+
+    // Keep the file fsync out of the bucket manager's lock, only the directory
+    // is synced under it
+    durability.syncFiles();
     auto b = bucketManager.adoptFileAsBucket<BucketT>(
-        mFilename.string(), hash, mergeKey, std::move(index));
+        mFilename.string(), hash, mergeKey, std::move(index), &durability);
 
     if constexpr (std::is_same_v<BucketT, LiveBucket>)
     {
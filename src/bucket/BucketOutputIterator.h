@@ -17,6 +17,7 @@ namespace stellar
 
 class Bucket;
 class BucketManager;
+class BucketWriteStage;
 
 // Helper class that writes new elements to a file and returns a bucket
 // when finished.
@@ -38,6 +39,13 @@ template <typename BucketT> class BucketOutputIterator
     bool mPutMeta{false};
     MergeCounters& mMergeCounters;
 
+    // Hashes and writes entries on a dedicated thread if set. Declared last so
+    // it is stopped before the stream and hasher it uses are destroyed.
+    std::unique_ptr<BucketWriteStage> mWriteStage;
+
+    // Writes e to the output file, through mWriteStage if set
+    void writeEntry(typename BucketT::EntryT const& e);
+
   public:
     // BucketOutputIterators must _always_ be constructed with BucketMetadata,
     // regardless of the ledger version the bucket is being written from, even
@@ -46,12 +54,29 @@ template <typename BucketT> class BucketOutputIterator
     // version new enough that it should _write_ the metadata to the stream in
     // the form of a METAENTRY; but that's not a thing the caller gets to decide
     // (or forget to do), it's handled automatically.
+    //
+    // The one exception is partition outputs of a partitioned merge, which
+    // hold a key range of the final bucket and are later passed to
+    // appendPartition on the iterator writing that bucket. These are
+    // constructed with writeMetaEntry = false.
+    //
+    // If pipelineWrites is set, hashing and writing happen on a dedicated
+    // thread so that the caller only has to serialize entries. The resulting
+    // bucket is identical either way.
     BucketOutputIterator(std::string const& tmpDir, bool keepTombstoneEntries,
                          BucketMetadata const& meta, MergeCounters& mc,
-                         asio::io_context& ctx, bool doFsync);
+                         asio::io_context& ctx, bool doFsync,
+                         bool writeMetaEntry = true,
+                         bool pipelineWrites = false);
+    ~BucketOutputIterator();
 
     void put(typename BucketT::EntryT const& e);
 
+    // Appends the entries written to `partition` to this output, hashing them
+    // in order, and deletes the partition's file. All entries in `partition`
+    // must be greater than any entry put into this iterator so far.
+    void appendPartition(BucketOutputIterator<BucketT>& partition);
+
     std::shared_ptr<BucketT> getBucket(
         BucketManager& bucketManager, MergeKey* mergeKey = nullptr,
         std::optional<std::vector<typename BucketT::EntryT>> inMemoryState =
@@ -8,14 +8,21 @@
 #include "bucket/SearchableBucketList.h"
 #include "ledger/LedgerTxn.h"
 #include "ledger/LedgerTypeUtils.h"
+#include "util/Fs.h"
 #include "util/GlobalChecks.h"
 #include "util/ProtocolVersion.h"
 #include "util/XDRStream.h"
 #include "util/types.h"
+#include <algorithm>
 #include <type_traits>
 
 namespace stellar
 {
+namespace
+{
+size_t constexpr RANDOM_ACCESS_BUFFER_SIZE = 64 * 1024;
+}
+
 template <class BucketT>
 BucketSnapshotBase<BucketT>::BucketSnapshotBase(
     std::shared_ptr<BucketT const> const b)
@@ -53,11 +60,22 @@ BucketSnapshotBase<BucketT>::getEntryAtOffset(LedgerKey const& k,
         return {nullptr, false};
     }
 
-    auto& stream = getStream();
-    stream.seek(pos);
-
     typename BucketT::EntryT be;
-    if (stream.readPage(be, k, pageSize))
+    bool found;
+    if (auto mapped = mBucket->getMappedFile())
+    {
+        found = XDRInputFileStream::readPageFromMemory(
+            mapped->data(), mapped->size(), static_cast<size_t>(pos), be, k,
+            pageSize);
+    }
+    else
+    {
+        auto& stream = getStream();
+        stream.seek(pos);
+        found = stream.readPage(be, k, pageSize);
+    }
+
+    if (found)
     {
         auto entry = std::make_shared<typename BucketT::EntryT const>(be);
         mBucket->getIndex().maybeAddToCache(entry);
@@ -88,7 +106,7 @@ BucketSnapshotBase<BucketT>::getBucketEntry(LedgerKey const& k) const
         }
         else
         {
-            throw std::runtime_error("Hot Archive reported cache hit");
+            return {indexRes.hotArchiveCacheHit(), false};
         }
     case IndexReturnState::FILE_OFFSET:
         return getEntryAtOffset(k, indexRes.fileOffset(),
@@ -103,11 +121,17 @@ BucketSnapshotBase<BucketT>::getBucketEntry(LedgerKey const& k) const
 // If we find the entry, we remove the found key from keys so that later buckets
 // do not load shadowed entries. If we don't find the entry, we do not remove it
 // from keys so that it will be searched for again at a lower level.
+//
+// If batchReads is set, keys that require a disk read are not loaded as
+// they are found. Instead, all of their page offsets are collected during the
+// index pass and handed to the OS in one readahead batch, after which the
+// pages are decoded in file order. This way the device sees many outstanding
+// reads instead of a single blocking read per key.
 template <class BucketT>
 void
 BucketSnapshotBase<BucketT>::loadKeys(
     std::set<LedgerKey, LedgerEntryIdCmp>& keys,
-    std::vector<typename BucketT::LoadT>& result) const
+    std::vector<typename BucketT::LoadT>& result, bool batchReads) const
 {
     ZoneScoped;
     if (isEmpty())
@@ -115,14 +139,53 @@ BucketSnapshotBase<BucketT>::loadKeys(
         return;
     }
 
-    auto currKeyIt = keys.begin();
+    auto addResult = [&](auto const& entryOp) {
+        // Don't return tombstone entries, as these do not exist wrt
+        // ledger state
+        if (!BucketT::isTombstoneEntry(*entryOp))
+        {
+            // Only live bucket loads can be metered
+            if constexpr (std::is_same_v<BucketT, LiveBucket>)
+            {
+                result.push_back(entryOp->liveEntry());
+            }
+            else
+            {
+                static_assert(std::is_same_v<BucketT, HotArchiveBucket>,
+                              "unexpected bucket type");
+                result.push_back(*entryOp);
+            }
+        }
+    };
+
+    // Keys whose page still needs to be read from disk, along with the offset
+    // of that page, in file order. Only used when batchReads is set.
+    using KeyIterT = typename std::set<LedgerKey, LedgerEntryIdCmp>::iterator;
+    std::vector<std::pair<KeyIterT, std::streamoff>> pendingReads;
+
     auto const& index = mBucket->getIndex();
+
+    // Check all keys against the bucket's filter in one batch up front. Every
+    // iteration below moves currKeyIt forward by exactly one key, so
+    // mayContainIt stays in step with it.
+    std::vector<bool> mayContain;
+    index.mayContain(keys, mayContain);
+    auto mayContainIt = mayContain.begin();
+
+    auto currKeyIt = keys.begin();
     auto indexIter = index.begin();
     while (currKeyIt != keys.end() && indexIter != index.end())
     {
+        if (!*mayContainIt++)
+        {
+            ++currKeyIt;
+            continue;
+        }
+
         // Scan for current key. Iterator returned is the lower_bound of the key
         // which will be our starting point for search for the next key
-        auto [indexRes, newIndexIter] = index.scan(indexIter, *currKeyIt);
+        auto [indexRes, newIndexIter] =
+            index.scan(indexIter, *currKeyIt, /*filterChecked=*/true);
         indexIter = newIndexIter;
 
         // Check if the index actually found the key
@@ -138,11 +201,19 @@ BucketSnapshotBase<BucketT>::loadKeys(
             }
             else
             {
-                throw std::runtime_error("Hot Archive reported cache hit");
+                entryOp = indexRes.hotArchiveCacheHit();
             }
             break;
         // Index had entry offset, so we need to load the entry
         case IndexReturnState::FILE_OFFSET:
+            if (batchReads)
+            {
+                // Defer the read, erasing other set elements does not
+                // invalidate this iterator
+                pendingReads.emplace_back(currKeyIt, indexRes.fileOffset());
+                ++currKeyIt;
+                continue;
+            }
             std::tie(entryOp, std::ignore) =
                 getEntryAtOffset(*currKeyIt, indexRes.fileOffset(),
                                  mBucket->getIndex().getPageSize());
@@ -155,33 +226,150 @@ BucketSnapshotBase<BucketT>::loadKeys(
 
         if (entryOp)
         {
-            // Don't return tombstone entries, as these do not exist wrt
-            // ledger state
-            if (!BucketT::isTombstoneEntry(*entryOp))
-            {
-                // Only live bucket loads can be metered
-                if constexpr (std::is_same_v<BucketT, LiveBucket>)
-                {
-                    bool addEntry = true;
-                    if (addEntry)
-                    {
-                        result.push_back(entryOp->liveEntry());
-                    }
-                }
-                else
-                {
-                    static_assert(std::is_same_v<BucketT, HotArchiveBucket>,
-                                  "unexpected bucket type");
-                    result.push_back(*entryOp);
-                }
-            }
-
+            addResult(entryOp);
             currKeyIt = keys.erase(currKeyIt);
             continue;
         }
 
         ++currKeyIt;
     }
+
+    if (pendingReads.empty())
+    {
+        return;
+    }
+
+    auto pageSize = mBucket->getIndex().getPageSize();
+    // Advice is about the stored file, whose offsets block-compressed buckets
+    // don't share with the index
+    if (pendingReads.size() > 1 && !mBucket->getBlockTable())
+    {
+        // Several keys can live on the same page, only advise each page once.
+        // Offsets are already sorted since keys and bucket are both sorted.
+        std::vector<std::pair<size_t, size_t>> ranges;
+        ranges.reserve(pendingReads.size());
+        for (auto const& pending : pendingReads)
+        {
+            auto off = static_cast<size_t>(pending.second);
+            if (ranges.empty() || ranges.back().first != off)
+            {
+                ranges.emplace_back(off, pageSize);
+            }
+        }
+        fs::adviseWillNeed(mBucket->getFilename().string(), ranges);
+    }
+
+    for (auto const& [keyIt, offset] : pendingReads)
+    {
+        std::shared_ptr<typename BucketT::EntryT const> entryOp;
+        std::tie(entryOp, std::ignore) =
+            getEntryAtOffset(*keyIt, offset, pageSize);
+        if (entryOp)
+        {
+            addResult(entryOp);
+            keys.erase(keyIt);
+        }
+    }
+}
+
+std::pair<std::optional<BucketEntryView>, bool>
+LiveBucketSnapshot::getBucketEntryView(LedgerKey const& k) const
+{
+    ZoneScoped;
+    if (isEmpty())
+    {
+        return {std::nullopt, false};
+    }
+
+    auto const& index = mBucket->getIndex();
+    auto indexRes = index.lookup(k);
+    switch (indexRes.getState())
+    {
+    case IndexReturnState::CACHE_HIT:
+        return {BucketEntryView(indexRes.cacheHit()), false};
+    case IndexReturnState::NOT_FOUND:
+        return {std::nullopt, false};
+    case IndexReturnState::FILE_OFFSET:
+        break;
+    }
+
+    auto const keyXdr = xdr::xdr_to_opaque(k);
+    std::vector<char> xdr;
+    auto match = [&](char const* body, size_t size) {
+        if (!BucketEntryView::hasKey(body, size, k, keyXdr))
+        {
+            return false;
+        }
+        xdr.assign(body, body + size);
+        return true;
+    };
+
+    auto pos = static_cast<size_t>(indexRes.fileOffset());
+    bool found;
+    if (auto mapped = mBucket->getMappedFile())
+    {
+        found = XDRInputFileStream::scanPageFromMemory(
+            mapped->data(), mapped->size(), pos, index.getPageSize(), match);
+    }
+    else
+    {
+        auto& stream = getStream();
+        stream.seek(pos);
+        found = stream.scanPage(index.getPageSize(), match);
+    }
+
+    if (found)
+    {
+        return {BucketEntryView(std::move(xdr)), false};
+    }
+
+    index.markBloomMiss();
+    return {std::nullopt, true};
+}
+
+std::vector<std::streamoff>
+LiveBucketSnapshot::getPageOffsets(std::streamoff begin,
+                                   std::streamoff end) const
+{
+    if (isEmpty())
+    {
+        return {};
+    }
+
+    return mBucket->getIndex().getPageOffsets(begin, end);
+}
+
+void
+LiveBucketSnapshot::seekToKey(LedgerKey const& k) const
+{
+    releaseAssert(!isEmpty());
+
+    // Both the start of the type's range and the index page are lower bounds
+    // on where keys not less than k start
+    std::streamoff pos = 0;
+    if (auto range = mBucket->getRangeForType(k.type()))
+    {
+        pos = range->first;
+    }
+    if (auto offset = mBucket->getIndex().getMergePartitionOffset(k))
+    {
+        pos = std::max(pos, *offset);
+    }
+    getStream().seek(pos);
+}
+
+bool
+LiveBucketSnapshot::readNextEntry(BucketEntry& be) const
+{
+    auto& stream = getStream();
+    while (stream.readOne(be))
+    {
+        if (be.type() != METAENTRY)
+        {
+            return true;
+        }
+    }
+    return false;
 }
 
 std::vector<PoolID> const&
@@ -196,6 +384,18 @@ LiveBucketSnapshot::getPoolIDsByAsset(Asset const& asset) const
     return mBucket->getIndex().getPoolIDsByAsset(asset);
 }
 
+std::vector<PoolID> const&
+LiveBucketSnapshot::getPoolIDsByAccount(AccountID const& accountID) const
+{
+    static std::vector<PoolID> const emptyVec = {};
+    if (isEmpty())
+    {
+        return emptyVec;
+    }
+
+    return mBucket->getIndex().getPoolIDsByAccount(accountID);
+}
+
 // Note: evicatbleKeys and keysInEvictableEntries both reference the same
 // entries. evictableEntries in order of eviction, keysInEvictableEntries in an
 // unordered but searchable set.
@@ -262,8 +462,8 @@ LiveBucketSnapshot::scanForEviction(
     };
 
     // Open new stream for eviction scan to not interfere with BucketListDB load
-    // streams
-    XDRInputFileStream stream{};
+    // streams. Scans only read a bounded region, so don't read ahead.
+    XDRInputFileStream stream(0, /*sequential=*/false, fs::bufsz());
     stream.open(mBucket->getFilename());
     stream.seek(iter.bucketFileOffset);
     BucketEntry be;
@@ -358,6 +558,64 @@ LiveBucketSnapshot::scanForEntriesOfType(
     return Loop::INCOMPLETE;
 }
 
+Loop
+LiveBucketSnapshot::scanForLiveEntriesOfType(
+    LedgerEntryType type, UnorderedSet<LedgerKey>& seenKeys,
+    std::function<Loop(LedgerEntry const&)> callback) const
+{
+    ZoneScoped;
+    if (isEmpty())
+    {
+        return Loop::INCOMPLETE;
+    }
+
+    auto const* typedEntries = mBucket->getTypedEntries(type);
+    if (!typedEntries)
+    {
+        return scanForEntriesOfType(type, [&](BucketEntry const& be) {
+            auto key = getBucketLedgerKey(be);
+            if (!seenKeys.insert(key).second || be.type() == DEADENTRY)
+            {
+                return Loop::INCOMPLETE;
+            }
+            return callback(be.liveEntry());
+        });
+    }
+
+    auto& stream = getStream();
+    BucketEntry be;
+
+    // Position of the stream after the last entry read by this scan.
+    // Consecutive live entries are read without seeking, which would drop
+    // the stream's read buffer.
+    std::optional<std::streamoff> streamPos;
+    for (auto const& entry : *typedEntries)
+    {
+        if (!seenKeys.insert(entry.key).second || entry.isDead)
+        {
+            continue;
+        }
+
+        if (streamPos != entry.offset)
+        {
+            stream.seek(entry.offset);
+        }
+
+        if (!stream.readOne(be))
+        {
+            throw std::runtime_error("Unexpected end of bucket file during "
+                                     "typed entry scan");
+        }
+        releaseAssertOrThrow(be.type() == LIVEENTRY || be.type() == INITENTRY);
+        streamPos = stream.pos();
+        if (callback(be.liveEntry()) == Loop::COMPLETE)
+        {
+            return Loop::COMPLETE;
+        }
+    }
+    return Loop::INCOMPLETE;
+}
+
 template <class BucketT>
 XDRInputFileStream&
 BucketSnapshotBase<BucketT>::getStream() const
@@ -365,8 +623,12 @@ BucketSnapshotBase<BucketT>::getStream() const
     releaseAssertOrThrow(!isEmpty());
     if (!mStream)
     {
-        mStream = std::make_unique<XDRInputFileStream>();
-        mStream->open(mBucket->getFilename().string());
+        // Mostly used for point lookups, and one is kept per bucket of every
+        // snapshot, so keep its buffer small and don't read ahead
+        mStream = std::make_unique<XDRInputFileStream>(
+            0, /*sequential=*/false, RANDOM_ACCESS_BUFFER_SIZE);
+        mStream->open(mBucket->getFilename().string(),
+                      mBucket->getBlockTable());
     }
     return *mStream;
 }
@@ -4,6 +4,7 @@
 // under the Apache License, Version 2.0. See the COPYING file at the root
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
+#include "bucket/BucketEntryView.h"
 #include "bucket/BucketUtils.h"
 #include "bucket/HotArchiveBucket.h"
 #include "bucket/LedgerCmp.h"
@@ -61,9 +62,13 @@ template <class BucketT> class BucketSnapshotBase : public NonMovable
     getBucketEntry(LedgerKey const& k) const;
 
     // Loads LedgerEntry's for given keys. When a key is found, the
-    // entry is added to result and the key is removed from keys.
+    // entry is added to result and the key is removed from keys. If
+    // batchReads is true, the file offsets of all keys are collected first and
+    // the OS is asked to read all of those pages at once before any of them is
+    // decoded.
     void loadKeys(std::set<LedgerKey, LedgerEntryIdCmp>& keys,
-                  std::vector<typename BucketT::LoadT>& result) const;
+                  std::vector<typename BucketT::LoadT>& result,
+                  bool batchReads = false) const;
 };
 
 class LiveBucketSnapshot : public BucketSnapshotBase<LiveBucket>
@@ -74,10 +79,21 @@ class LiveBucketSnapshot : public BucketSnapshotBase<LiveBucket>
     // Only allow copy constructors, is threadsafe
     LiveBucketSnapshot(LiveBucketSnapshot const& b);
 
+    // Same as getBucketEntry, but returns a view over the XDR of the entry
+    // instead of decoding it. Returns <view, bloomMiss>. Entries read this way
+    // are not added to the index cache, which holds decoded entries.
+    std::pair<std::optional<BucketEntryView>, bool>
+    getBucketEntryView(LedgerKey const& k) const;
+
     // Return all PoolIDs that contain the given asset on either side of the
     // pool
     std::vector<PoolID> const& getPoolIDsByAsset(Asset const& asset) const;
 
+    // Return the PoolIDs of all pool share trustlines held by the given
+    // account in this bucket
+    std::vector<PoolID> const&
+    getPoolIDsByAccount(AccountID const& accountID) const;
+
     Loop scanForEviction(EvictionIterator& iter, uint32_t& bytesToScan,
                          uint32_t ledgerSeq,
                          std::list<EvictionResultEntry>& evictableEntries,
@@ -89,6 +105,30 @@ class LiveBucketSnapshot : public BucketSnapshotBase<LiveBucket>
     Loop scanForEntriesOfType(
         LedgerEntryType type,
         std::function<Loop(BucketEntry const&)> callback) const;
+
+    // Scans the live entries of the specified type in the bucket whose keys
+    // are not in seenKeys, i.e. that are not shadowed by a newer bucket. Every
+    // key of the type found in this bucket, live or dead, is added to
+    // seenKeys. If the bucket has a typed entry index, shadowed and dead
+    // entries are skipped without being read.
+    Loop scanForLiveEntriesOfType(
+        LedgerEntryType type, UnorderedSet<LedgerKey>& seenKeys,
+        std::function<Loop(LedgerEntry const&)> callback) const;
+
+    // Returns the file offsets of all index pages starting strictly between
+    // begin and end. Every returned offset is the start of an entry. Returns
+    // an empty vector if the bucket is empty or not range indexed.
+    std::vector<std::streamoff> getPageOffsets(std::streamoff begin,
+                                               std::streamoff end) const;
+
+    // Positions the bucket for readNextEntry as close as the index allows
+    // before the first entry whose key is not less than k. Entries less than
+    // k may still be read after this and must be skipped by the caller.
+    void seekToKey(LedgerKey const& k) const;
+
+    // Reads the entry after the last one read, in key order, skipping the
+    // METAENTRY. Returns false at the end of the bucket.
+    bool readNextEntry(BucketEntry& be) const;
 };
 
 class HotArchiveBucketSnapshot : public BucketSnapshotBase<HotArchiveBucket>
@@ -6,6 +6,7 @@
 #include "bucket/BucketUtils.h"
 #include "bucket/HotArchiveBucket.h"
 #include "bucket/LiveBucket.h"
+#include "bucket/LiveBucketListFilter.h"
 #include "bucket/SearchableBucketList.h"
 #include "main/AppConnector.h"
 #include "main/Application.h"
@@ -18,24 +19,6 @@
 namespace stellar
 {
 
-namespace
-{
-template <class BucketT>
-std::map<uint32_t, SnapshotPtrT<BucketT>>
-copyHistoricalSnapshots(
-    std::map<uint32_t, SnapshotPtrT<BucketT>> const& snapshots)
-{
-    std::map<uint32_t, SnapshotPtrT<BucketT>> copiedSnapshots;
-    for (auto const& [ledgerSeq, snap] : snapshots)
-    {
-        copiedSnapshots.emplace(
-            ledgerSeq,
-            std::make_unique<BucketListSnapshot<BucketT> const>(*snap));
-    }
-    return copiedSnapshots;
-}
-}
-
 BucketSnapshotManager::BucketSnapshotManager(
     Application& app, SnapshotPtrT<LiveBucket>&& snapshot,
     SnapshotPtrT<HotArchiveBucket>&& hotArchiveSnapshot,
@@ -46,10 +29,19 @@ BucketSnapshotManager::BucketSnapshotManager(
     , mLiveHistoricalSnapshots()
     , mHotArchiveHistoricalSnapshots()
     , mNumHistoricalSnapshots(numLiveHistoricalSnapshots)
+    , mFilterBuilder(
+          app.getConfig().BUCKETLIST_DB_COMBINED_FILTER_LEVEL != 0
+              ? std::make_shared<LiveBucketListFilterBuilder>(
+                    app.getConfig().BUCKETLIST_DB_COMBINED_FILTER_LEVEL)
+              : nullptr)
 {
     releaseAssert(threadIsMain());
     releaseAssert(mCurrLiveSnapshot);
     releaseAssert(mCurrHotArchiveSnapshot);
+    if (mFilterBuilder)
+    {
+        mFilterBuilder->update(mAppConnector, *mCurrLiveSnapshot);
+    }
 }
 
 SearchableSnapshotConstPtr
@@ -79,7 +71,9 @@ BucketSnapshotManager::copySearchableLiveBucketListSnapshot(
             *this, mAppConnector,
             std::make_unique<BucketListSnapshot<LiveBucket>>(
                 *mCurrLiveSnapshot),
-            copyHistoricalSnapshots(mLiveHistoricalSnapshots)));
+            mLiveHistoricalSnapshots,
+            mFilterBuilder ? mFilterBuilder->getFilter(*mCurrLiveSnapshot)
+                           : nullptr));
 }
 
 SearchableHotArchiveSnapshotConstPtr
@@ -93,7 +87,7 @@ BucketSnapshotManager::copySearchableHotArchiveBucketListSnapshot(
             *this, mAppConnector,
             std::make_unique<BucketListSnapshot<HotArchiveBucket>>(
                 *mCurrHotArchiveSnapshot),
-            copyHistoricalSnapshots(mHotArchiveHistoricalSnapshots)));
+            mHotArchiveHistoricalSnapshots));
 }
 
 namespace
@@ -191,5 +185,21 @@ BucketSnapshotManager::updateCurrentSnapshot(
     updateSnapshot(mCurrLiveSnapshot, mLiveHistoricalSnapshots, liveSnapshot);
     updateSnapshot(mCurrHotArchiveSnapshot, mHotArchiveHistoricalSnapshots,
                    hotArchiveSnapshot);
+
+    // Deeper levels only change when a level spills into them, so most
+    // updates don't schedule a rebuild
+    if (mFilterBuilder)
+    {
+        mFilterBuilder->update(mAppConnector, *mCurrLiveSnapshot);
+    }
+}
+
+#ifdef BUILD_TESTS
+bool
+BucketSnapshotManager::hasCurrentLiveBucketListFilter() const
+{
+    SharedLockShared guard(mSnapshotMutex);
+    return mFilterBuilder && mFilterBuilder->getFilter(*mCurrLiveSnapshot);
+}
+#endif
 }
-}
\ No newline at end of file
@@ -27,12 +27,22 @@ namespace stellar
 
 class Application;
 class LiveBucketList;
+class LiveBucketListFilterBuilder;
 template <class BucketT> class BucketListSnapshot;
 class SearchableLiveBucketListSnapshot;
 class SearchableHotArchiveBucketListSnapshot;
 
 template <class BucketT>
 using SnapshotPtrT = std::unique_ptr<BucketListSnapshot<BucketT> const>;
+
+// ledgerSeq that the snapshot is based on -> snapshot. Historical snapshots are
+// immutable once published, so they are shared between BucketSnapshotManager
+// and every searchable snapshot rather than copied for each of them. Bucket
+// snapshots keep per-object file streams, so searchable snapshots must still
+// make their own copy of a historical snapshot before reading from it.
+template <class BucketT>
+using HistoricalSnapshotsT =
+    std::map<uint32_t, std::shared_ptr<BucketListSnapshot<BucketT> const>>;
 using SearchableSnapshotConstPtr =
     std::shared_ptr<SearchableLiveBucketListSnapshot const>;
 using SearchableHotArchiveSnapshotConstPtr =
@@ -56,14 +66,18 @@ class BucketSnapshotManager : NonMovableOrCopyable
     SnapshotPtrT<HotArchiveBucket>
         mCurrHotArchiveSnapshot GUARDED_BY(mSnapshotMutex){};
 
-    // ledgerSeq that the snapshot is based on -> snapshot
-    std::map<uint32_t, SnapshotPtrT<LiveBucket>>
+    HistoricalSnapshotsT<LiveBucket>
         mLiveHistoricalSnapshots GUARDED_BY(mSnapshotMutex);
-    std::map<uint32_t, SnapshotPtrT<HotArchiveBucket>>
+    HistoricalSnapshotsT<HotArchiveBucket>
         mHotArchiveHistoricalSnapshots GUARDED_BY(mSnapshotMutex);
 
     uint32_t const mNumHistoricalSnapshots;
 
+    // Maintains the filter over the deeper levels of the live BucketList
+    // handed to searchable snapshots, if BUCKETLIST_DB_COMBINED_FILTER_LEVEL
+    // is set
+    std::shared_ptr<LiveBucketListFilterBuilder> const mFilterBuilder;
+
   public:
     // Called by main thread to update snapshots whenever the BucketList
     // is updated
@@ -117,5 +131,11 @@ class BucketSnapshotManager : NonMovableOrCopyable
         SearchableSnapshotConstPtr& liveSnapshot,
         SearchableHotArchiveSnapshotConstPtr& hotArchiveSnapshot)
         LOCKS_EXCLUDED(mSnapshotMutex);
+
+#ifdef BUILD_TESTS
+    // Returns true if the filter over the deeper levels of the live BucketList
+    // has been built for the current snapshot
+    bool hasCurrentLiveBucketListFilter() const LOCKS_EXCLUDED(mSnapshotMutex);
+#endif
 };
 }
\ No newline at end of file
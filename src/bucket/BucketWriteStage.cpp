@@ -0,0 +1,116 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "bucket/BucketWriteStage.h"
+#include "crypto/ByteSlice.h"
+#include <Tracy.hpp>
+
+namespace stellar
+{
+
+BucketWriteStage::BucketWriteStage(OutputFileStream& out, SHA256& hasher)
+    : mOut(out), mHasher(hasher)
+{
+    mBatch.reserve(BATCH_SIZE);
+    mThread = std::thread([this]() { run(); });
+}
+
+BucketWriteStage::~BucketWriteStage()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mCV.notify_all();
+    mThread.join();
+}
+
+void
+BucketWriteStage::submit()
+{
+    ZoneScoped;
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCV.wait(lock, [this] {
+        return mError || mPending.size() < MAX_PENDING_BATCHES;
+    });
+    if (mError)
+    {
+        std::rethrow_exception(mError);
+    }
+
+    mPending.emplace_back(std::move(mBatch));
+    if (mFree.empty())
+    {
+        mBatch = std::vector<char>();
+        mBatch.reserve(BATCH_SIZE);
+    }
+    else
+    {
+        mBatch = std::move(mFree.back());
+        mFree.pop_back();
+    }
+
+    lock.unlock();
+    mCV.notify_all();
+}
+
+void
+BucketWriteStage::drain()
+{
+    ZoneScoped;
+    if (!mBatch.empty())
+    {
+        submit();
+    }
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCV.wait(lock,
+             [this] { return mError || (mPending.empty() && !mWriting); });
+    if (mError)
+    {
+        std::rethrow_exception(mError);
+    }
+}
+
+void
+BucketWriteStage::run()
+{
+    ZoneScopedN("bucket write stage");
+    std::unique_lock<std::mutex> lock(mMutex);
+    for (;;)
+    {
+        mCV.wait(lock, [this] { return mStopping || !mPending.empty(); });
+        if (mStopping)
+        {
+            // Anything still pending belongs to an abandoned output
+            return;
+        }
+
+        auto batch = std::move(mPending.front());
+        mPending.pop_front();
+        mWriting = true;
+        lock.unlock();
+
+        try
+        {
+            mHasher.add(ByteSlice(batch.data(), batch.size()));
+            mOut.writeBytes(batch.data(), batch.size());
+        }
+        catch (...)
+        {
+            lock.lock();
+            mError = std::current_exception();
+            mWriting = false;
+            mCV.notify_all();
+            return;
+        }
+
+        batch.clear();
+        lock.lock();
+        mFree.emplace_back(std::move(batch));
+        mWriting = false;
+        mCV.notify_all();
+    }
+}
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "crypto/SHA.h"
+#include "util/GlobalChecks.h"
+#include "util/NonCopyable.h"
+#include "util/XDRStream.h"
+#include "xdrpp/marshal.h"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace stellar
+{
+
+// Output stage of a BucketOutputIterator that hashes and writes bucket
+// entries on a dedicated thread. The producing thread serializes entries into
+// a batch buffer; full batches are handed to the writer thread, which adds
+// them to the hasher and writes them to the stream in order. Batches are large,
+// so the handoff takes a lock a few times per megabyte of output. Buffers are
+// recycled, and at most MAX_PENDING_BATCHES batches are queued before append
+// blocks.
+//
+// While the stage is running, the stream and hasher belong to the writer
+// thread. Callers must call drain() before using either of them directly.
+class BucketWriteStage : public NonMovableOrCopyable
+{
+  public:
+    static constexpr size_t BATCH_SIZE = 256 * 1024;
+    static constexpr size_t MAX_PENDING_BATCHES = 4;
+
+    BucketWriteStage(OutputFileStream& out, SHA256& hasher);
+    ~BucketWriteStage();
+
+    // Serializes t into the current batch, framed exactly as
+    // XDROutputFileStream::writeOne frames it. Returns the number of bytes
+    // appended.
+    template <typename T>
+    size_t
+    append(T const& t)
+    {
+        uint32_t sz = (uint32_t)xdr::xdr_size(t);
+        releaseAssertOrThrow(sz < 0x80000000);
+
+        auto const start = mBatch.size();
+        mBatch.resize(start + sz + 4);
+        char* buf = mBatch.data() + start;
+        buf[0] = static_cast<char>((sz >> 24) & 0xFF) | '\x80';
+        buf[1] = static_cast<char>((sz >> 16) & 0xFF);
+        buf[2] = static_cast<char>((sz >> 8) & 0xFF);
+        buf[3] = static_cast<char>(sz & 0xFF);
+        xdr::xdr_put p(buf + 4, buf + 4 + sz);
+        xdr_argpack_archive(p, t);
+
+        if (mBatch.size() >= BATCH_SIZE)
+        {
+            submit();
+        }
+        return sz + 4;
+    }
+
+    // Blocks until everything appended so far has been hashed and written.
+    // Rethrows the first error hit by the writer thread.
+    void drain();
+
+  private:
+    OutputFileStream& mOut;
+    SHA256& mHasher;
+
+    // Batch currently being filled by the producing thread
+    std::vector<char> mBatch;
+
+    std::mutex mMutex;
+    std::condition_variable mCV;
+    std::deque<std::vector<char>> mPending;
+    std::vector<std::vector<char>> mFree;
+    bool mWriting{false};
+    bool mStopping{false};
+    std::exception_ptr mError;
+    std::thread mThread;
+
+    void submit();
+    void run();
+};
+}
@@ -13,6 +13,7 @@
 #include "util/BufferedAsioCerealOutputArchive.h"
 #include "util/Fs.h"
 #include "util/GlobalChecks.h"
+#include "util/IORateLimiter.h"
 #include "util/LogSlowExecution.h"
 #include "util/Logging.h"
 #include <medida/meter.h>
@@ -58,7 +59,8 @@ upper_bound_pred(LedgerKey const& key, RangeIndex::value_type const& indexEntry)
 
 template <class BucketT>
 std::pair<IndexReturnT, typename DiskIndex<BucketT>::IterT>
-DiskIndex<BucketT>::scan(IterT start, LedgerKey const& k) const
+DiskIndex<BucketT>::scan(IterT start, LedgerKey const& k,
+                         bool filterChecked) const
 {
     ZoneScoped;
     ZoneValue(static_cast<int64_t>(mData.keysToOffset.size()));
@@ -72,8 +74,11 @@ DiskIndex<BucketT>::scan(IterT start, LedgerKey const& k) const
 
     // If the key is not in the bloom filter or in the lower bounded index
     // entry, return nullopt
-    mBloomLookupMeter.Mark();
-    if ((mData.filter && !mData.filter->contains(k)) ||
+    if (!filterChecked)
+    {
+        mBloomLookupMeter.Mark();
+    }
+    if ((!filterChecked && mData.filter && !mData.filter->contains(k)) ||
         keyIter == mData.keysToOffset.end() ||
         keyNotInIndexEntry(k, keyIter->first))
     {
@@ -85,6 +90,29 @@ DiskIndex<BucketT>::scan(IterT start, LedgerKey const& k) const
     }
 }
 
+template <class BucketT>
+void
+DiskIndex<BucketT>::mayContain(
+    std::set<LedgerKey, LedgerEntryIdCmp> const& keys,
+    std::vector<bool>& result) const
+{
+    ZoneScoped;
+    mBloomLookupMeter.Mark(keys.size());
+    if (!mData.filter)
+    {
+        result.assign(keys.size(), true);
+        return;
+    }
+
+    std::vector<uint64_t> keyHashes;
+    keyHashes.reserve(keys.size());
+    for (auto const& k : keys)
+    {
+        keyHashes.emplace_back(mData.filter->hashKey(k));
+    }
+    mData.filter->containsHashes(keyHashes, result);
+}
+
 template <class BucketT>
 std::optional<std::pair<std::streamoff, std::streamoff>>
 DiskIndex<BucketT>::getOffsetBounds(LedgerKey const& lowerBound,
@@ -129,31 +157,144 @@ DiskIndex<BucketT>::getRangeForType(LedgerEntryType type) const
     return std::nullopt;
 }
 
+template <class BucketT>
+std::vector<LedgerKey>
+DiskIndex<BucketT>::getPartitionKeys(size_t n) const
+{
+    std::vector<LedgerKey> keys;
+    auto const numPages = mData.keysToOffset.size();
+    if (n < 2 || numPages < n)
+    {
+        return keys;
+    }
+
+    keys.reserve(n - 1);
+    for (size_t i = 1; i < n; ++i)
+    {
+        keys.emplace_back(mData.keysToOffset.at(i * numPages / n)
+                              .first.lowerBound);
+    }
+
+    return keys;
+}
+
+template <class BucketT>
+std::optional<std::streamoff>
+DiskIndex<BucketT>::getPartitionOffset(LedgerKey const& k) const
+{
+    auto iter =
+        std::lower_bound(mData.keysToOffset.begin(), mData.keysToOffset.end(),
+                         k, lower_bound_pred);
+    if (iter == mData.keysToOffset.begin())
+    {
+        return std::nullopt;
+    }
+
+    // Every key is less than k, start from the last page and let the caller
+    // skip past its entries.
+    if (iter == mData.keysToOffset.end())
+    {
+        --iter;
+    }
+
+    return iter->second;
+}
+
+template <class BucketT>
+std::vector<std::streamoff>
+DiskIndex<BucketT>::getPageOffsets(std::streamoff begin,
+                                   std::streamoff end) const
+{
+    auto iter = std::upper_bound(
+        mData.keysToOffset.begin(), mData.keysToOffset.end(), begin,
+        [](std::streamoff off, RangeIndex::value_type const& indexEntry) {
+            return off < indexEntry.second;
+        });
+
+    std::vector<std::streamoff> offsets;
+    for (; iter != mData.keysToOffset.end() && iter->second < end; ++iter)
+    {
+        offsets.emplace_back(iter->second);
+    }
+
+    return offsets;
+}
+
+template <class BucketT>
+size_t
+DiskIndex<BucketT>::computeMemoryUsage() const
+{
+    // Ordered map nodes hold three pointers and a color besides the value
+    constexpr size_t mapNodeOverhead = 4 * sizeof(void*);
+
+    // Only heap memory owned by the index containers is counted. Nested
+    // allocations inside LedgerKeys, such as CONTRACT_DATA ScVals, are not.
+    size_t bytes = sizeof(*this) + mData.keysToOffset.capacity() *
+                                       sizeof(RangeIndex::value_type);
+    if (mData.filter)
+    {
+        bytes += mData.filter->getMemoryUsage();
+    }
+
+    if (mData.assetToPoolID)
+    {
+        for (auto const& [asset, pools] : *mData.assetToPoolID)
+        {
+            bytes += sizeof(AssetPoolIDMap::value_type) + mapNodeOverhead +
+                     pools.capacity() * sizeof(PoolID);
+        }
+    }
+
+    if (mData.accountToPoolID)
+    {
+        for (auto const& [account, pools] : *mData.accountToPoolID)
+        {
+            bytes += sizeof(AccountPoolIDMap::value_type) + mapNodeOverhead +
+                     pools.capacity() * sizeof(PoolID);
+        }
+    }
+
+    if (mData.typedEntries)
+    {
+        for (auto const& [type, entries] : *mData.typedEntries)
+        {
+            bytes += sizeof(TypedEntryIndex::value_type) + mapNodeOverhead +
+                     entries.capacity() * sizeof(TypedEntryOffset);
+        }
+    }
+
+    return bytes;
+}
+
 template <class BucketT>
 DiskIndex<BucketT>::DiskIndex(BucketManager& bm,
                               std::filesystem::path const& filename,
                               std::streamoff pageSize, Hash const& hash,
-                              asio::io_context& ctx, SHA256* hasher)
+                              asio::io_context& ctx, SHA256* hasher,
+                              fs::DurabilityGroup* durability,
+                              IORateLimiter* ioLimiter)
     : mBloomLookupMeter(bm.getBloomLookupMeter<BucketT>())
     , mBloomMissMeter(bm.getBloomMissMeter<BucketT>())
 {
     ZoneScoped;
     mData.pageSize = pageSize;
 
-    // Only LiveBucket needs an asset to poolID mapping
+    // Only LiveBucket needs asset and account to poolID mappings and typed
+    // entry offsets
     if constexpr (std::is_same_v<BucketT, LiveBucket>)
     {
         mData.assetToPoolID = std::make_unique<AssetPoolIDMap>();
+        mData.accountToPoolID = std::make_unique<AccountPoolIDMap>();
+        mData.typedEntries = std::make_unique<TypedEntryIndex>();
     }
 
-    auto fileSize = fs::size(filename.string());
-    auto estimatedIndexEntries = fileSize / pageSize;
-    mData.keysToOffset.reserve(estimatedIndexEntries);
-
     XDRInputFileStream in;
     in.open(filename.string());
+    auto estimatedIndexEntries = in.size() / pageSize;
+    mData.keysToOffset.reserve(estimatedIndexEntries);
     std::streamoff pos = 0;
     std::streamoff pageUpperBound = 0;
+    std::streamoff charged = 0;
     typename BucketT::EntryT be;
     size_t iter = 0;
     size_t _count = 0;
@@ -178,6 +319,11 @@ DiskIndex<BucketT>::DiskIndex(BucketManager& bm,
                 throw std::runtime_error("Incomplete bucket index due to "
                                          "BucketManager shutdown");
             }
+            if (ioLimiter)
+            {
+                ioLimiter->consume(in.pos() - charged);
+                charged = in.pos();
+            }
         }
 
         if (!isBucketMetaEntry<BucketT>(be))
@@ -219,6 +365,25 @@ DiskIndex<BucketT>::DiskIndex(BucketManager& bm,
                     (*mData.assetToPoolID)[poolParams.assetB].emplace_back(
                         key.liquidityPool().liquidityPoolID);
                 }
+
+                // The same query only needs to load the pool share
+                // trustlines the account actually holds. Unlike pools,
+                // trustlines are indexed on LIVEENTRY too, because the INIT
+                // version may have been merged away. DEADENTRY is skipped for
+                // the same reason as above.
+                if (be.type() != DEADENTRY && key.type() == TRUSTLINE &&
+                    key.trustLine().asset.type() == ASSET_TYPE_POOL_SHARE)
+                {
+                    (*mData.accountToPoolID)[key.trustLine().accountID]
+                        .emplace_back(
+                            key.trustLine().asset.liquidityPoolID());
+                }
+
+                if (hasTypedEntryIndex(key.type()))
+                {
+                    (*mData.typedEntries)[key.type()].push_back(
+                        {key, pos, be.type() == DEADENTRY});
+                }
             }
             else
             {
@@ -289,13 +454,14 @@ DiskIndex<BucketT>::DiskIndex(BucketManager& bm,
         releaseAssertOrThrow(mData.filter);
     }
 
+    mMemoryUsage = computeMemoryUsage();
     CLOG_DEBUG(Bucket, "Indexed {} positions in {}", mData.keysToOffset.size(),
                filename.filename());
     ZoneValue(static_cast<int64_t>(_count));
 
     if (bm.getConfig().BUCKETLIST_DB_PERSIST_INDEX)
     {
-        saveToDisk(bm, hash, ctx);
+        saveToDisk(bm, hash, ctx, durability);
     }
 }
 
@@ -312,29 +478,39 @@ DiskIndex<BucketT>::DiskIndex(Archive& ar, BucketManager const& bm,
     if constexpr (std::is_same_v<BucketT, LiveBucket>)
     {
         releaseAssertOrThrow(mData.assetToPoolID);
+        releaseAssertOrThrow(mData.accountToPoolID);
+        releaseAssertOrThrow(mData.typedEntries);
     }
     else
     {
         static_assert(std::is_same_v<BucketT, HotArchiveBucket>);
         releaseAssertOrThrow(!mData.assetToPoolID);
+        releaseAssertOrThrow(!mData.accountToPoolID);
+        releaseAssertOrThrow(!mData.typedEntries);
     }
+    mMemoryUsage = computeMemoryUsage();
 }
 
 template <class BucketT>
 void
 DiskIndex<BucketT>::saveToDisk(BucketManager& bm, Hash const& hash,
-                               asio::io_context& ctx) const
+                               asio::io_context& ctx,
+                               fs::DurabilityGroup* durability) const
 {
     ZoneScoped;
     releaseAssert(bm.getConfig().BUCKETLIST_DB_PERSIST_INDEX);
     if constexpr (std::is_same_v<BucketT, LiveBucket>)
     {
         releaseAssertOrThrow(mData.assetToPoolID);
+        releaseAssertOrThrow(mData.accountToPoolID);
+        releaseAssertOrThrow(mData.typedEntries);
     }
     else
     {
         static_assert(std::is_same_v<BucketT, HotArchiveBucket>);
         releaseAssertOrThrow(!mData.assetToPoolID);
+        releaseAssertOrThrow(!mData.accountToPoolID);
+        releaseAssertOrThrow(!mData.typedEntries);
     }
 
     auto timer =
@@ -351,19 +527,23 @@ DiskIndex<BucketT>::saveToDisk(BucketManager& bm, Hash const& hash,
         out.open(tmpFilename.string());
         cereal::BufferedAsioOutputArchive ar(out);
         ar(mData);
+        if (durability)
+        {
+            out.close(*durability);
+        }
     }
 
     std::filesystem::path canonicalName = bm.bucketIndexFilename(hash);
     CLOG_DEBUG(Bucket, "Adopting bucket index file {} as {}", tmpFilename,
                canonicalName);
-    if (!bm.renameBucketDirFile(tmpFilename, canonicalName))
+    if (!bm.renameBucketDirFile(tmpFilename, canonicalName, durability))
     {
         std::string err("Failed to rename bucket index :");
         err += strerror(errno);
         // it seems there is a race condition with external systems
         // retry after sleeping for a second works around the problem
         std::this_thread::sleep_for(std::chrono::seconds(1));
-        if (!bm.renameBucketDirFile(tmpFilename, canonicalName))
+        if (!bm.renameBucketDirFile(tmpFilename, canonicalName, durability))
         {
             // if rename fails again, surface the original error
             throw std::runtime_error(err);
@@ -426,6 +606,36 @@ DiskIndex<BucketT>::operator==(DiskIndex<BucketT> const& in) const
         }
     }
 
+    if (mData.accountToPoolID && in.mData.accountToPoolID)
+    {
+        if (!(*(mData.accountToPoolID) == *(in.mData.accountToPoolID)))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        if (mData.accountToPoolID || in.mData.accountToPoolID)
+        {
+            return false;
+        }
+    }
+
+    if (mData.typedEntries && in.mData.typedEntries)
+    {
+        if (!(*(mData.typedEntries) == *(in.mData.typedEntries)))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        if (mData.typedEntries || in.mData.typedEntries)
+        {
+            return false;
+        }
+    }
+
     if (mData.counters != in.mData.counters)
     {
         return false;
@@ -6,6 +6,7 @@
 
 #include "bucket/BucketIndexUtils.h"
 #include "bucket/BucketUtils.h"
+#include "bucket/LedgerCmp.h"
 #include "util/BinaryFuseFilter.h"
 #include "util/GlobalChecks.h"
 #include "util/XDROperators.h" // IWYU pragma: keep
@@ -17,6 +18,7 @@
 
 #include <filesystem>
 #include <memory>
+#include <set>
 
 namespace medida
 {
@@ -31,6 +33,7 @@ class io_context;
 namespace stellar
 {
 class BucketManager;
+class IORateLimiter;
 class SHA256;
 
 // maps smallest and largest LedgerKey on a given page inclusively
@@ -79,8 +82,11 @@ template <class BucketT> class DiskIndex : public NonMovableOrCopyable
         RangeIndex keysToOffset;
         std::unique_ptr<BinaryFuseFilter16> filter{};
 
-        // Note: mAssetToPoolID is null for HotArchive Bucket types
+        // Note: assetToPoolID, accountToPoolID and typedEntries are null for
+        // HotArchive Bucket types
         std::unique_ptr<AssetPoolIDMap> assetToPoolID{};
+        std::unique_ptr<AccountPoolIDMap> accountToPoolID{};
+        std::unique_ptr<TypedEntryIndex> typedEntries{};
         BucketEntryCounters counters{};
         std::map<LedgerEntryType, std::pair<std::streamoff, std::streamoff>>
             typeRanges;
@@ -90,8 +96,8 @@ template <class BucketT> class DiskIndex : public NonMovableOrCopyable
         save(Archive& ar) const
         {
             auto version = BucketT::IndexT::BUCKET_INDEX_VERSION;
-            ar(version, pageSize, keysToOffset, filter, assetToPoolID, counters,
-               typeRanges);
+            ar(version, pageSize, keysToOffset, filter, assetToPoolID,
+               accountToPoolID, typedEntries, counters, typeRanges);
         }
 
         // Note: version and pageSize must be loaded before this
@@ -104,7 +110,8 @@ template <class BucketT> class DiskIndex : public NonMovableOrCopyable
         void
         load(Archive& ar)
         {
-            ar(keysToOffset, filter, assetToPoolID, counters, typeRanges);
+            ar(keysToOffset, filter, assetToPoolID, accountToPoolID,
+               typedEntries, counters, typeRanges);
         }
 
     } mData;
@@ -112,17 +119,24 @@ template <class BucketT> class DiskIndex : public NonMovableOrCopyable
     medida::Meter& mBloomLookupMeter;
     medida::Meter& mBloomMissMeter;
 
+    // Estimated memory used by mData, computed once the index is built
+    size_t mMemoryUsage{};
+
+    size_t computeMemoryUsage() const;
+
     // Saves index to disk, overwriting any preexisting file for this index
-    void saveToDisk(BucketManager& bm, Hash const& hash,
-                    asio::io_context& ctx) const;
+    void saveToDisk(BucketManager& bm, Hash const& hash, asio::io_context& ctx,
+                    fs::DurabilityGroup* durability) const;
 
   public:
     using IterT = RangeIndex::const_iterator;
 
-    // Constructor for creating a fresh index.
+    // Constructor for creating a fresh index. Reading the bucket is charged
+    // to `ioLimiter`, if set.
     DiskIndex(BucketManager& bm, std::filesystem::path const& filename,
               std::streamoff pageSize, Hash const& hash, asio::io_context& ctx,
-              SHA256* hasher);
+              SHA256* hasher, fs::DurabilityGroup* durability,
+              IORateLimiter* ioLimiter);
 
     // Constructor for loading pre-existing index from disk. Must call preLoad
     // before calling this constructor to properly deserialize index.
@@ -134,7 +148,15 @@ template <class BucketT> class DiskIndex : public NonMovableOrCopyable
     // file offset in the bucket file for k, or std::nullopt if not found
     // iterator that points to the first index entry not less than k, or
     // BucketIndex::end()
-    std::pair<IndexReturnT, IterT> scan(IterT start, LedgerKey const& k) const;
+    // If filterChecked is set, the caller already checked k against the
+    // filter with mayContain and the filter is not probed again.
+    std::pair<IndexReturnT, IterT> scan(IterT start, LedgerKey const& k,
+                                        bool filterChecked = false) const;
+
+    // Sets result[i] to false if the i-th key of keys is definitely not in
+    // the bucket. All keys are checked against the filter in one batch.
+    void mayContain(std::set<LedgerKey, LedgerEntryIdCmp> const& keys,
+                    std::vector<bool>& result) const;
 
     // Returns [lowFileOffset, highFileOffset) that contain the key ranges
     // [lowerBound, upperBound]. If no file offsets exist, returns [0, 0]
@@ -145,6 +167,21 @@ template <class BucketT> class DiskIndex : public NonMovableOrCopyable
     std::optional<std::pair<std::streamoff, std::streamoff>>
     getRangeForType(LedgerEntryType type) const;
 
+    // Returns up to n - 1 keys that split the index into n key ranges with
+    // roughly the same number of pages. Each key is the first key of a page,
+    // and keys are returned in ascending order.
+    std::vector<LedgerKey> getPartitionKeys(size_t n) const;
+
+    // Returns the file offset of the first page that may contain a key not
+    // less than k. Returns std::nullopt if that is the first page, in which
+    // case the bucket should be read from the start.
+    std::optional<std::streamoff> getPartitionOffset(LedgerKey const& k) const;
+
+    // Returns the file offsets of all pages starting strictly between begin
+    // and end, in ascending order.
+    std::vector<std::streamoff> getPageOffsets(std::streamoff begin,
+                                               std::streamoff end) const;
+
     // Returns page size for index
     std::streamoff
     getPageSize() const
@@ -158,6 +195,13 @@ template <class BucketT> class DiskIndex : public NonMovableOrCopyable
         return mData.counters;
     }
 
+    // Returns the estimated number of bytes of memory used by the index
+    size_t
+    getMemoryUsage() const
+    {
+        return mMemoryUsage;
+    }
+
     IterT
     begin() const
     {
@@ -192,6 +236,33 @@ template <class BucketT> class DiskIndex : public NonMovableOrCopyable
         return *mData.assetToPoolID;
     }
 
+    template <int..., typename T = BucketT,
+              std::enable_if_t<std::is_same_v<T, LiveBucket>, bool> = true>
+    AccountPoolIDMap const&
+    getAccountPoolIDMap() const
+    {
+        static_assert(std::is_same_v<T, LiveBucket>);
+        releaseAssert(mData.accountToPoolID);
+        return *mData.accountToPoolID;
+    }
+
+    // Returns every entry of the given type in file order, or null if the
+    // type is not indexed or the bucket has no entries of that type.
+    template <int..., typename T = BucketT,
+              std::enable_if_t<std::is_same_v<T, LiveBucket>, bool> = true>
+    std::vector<TypedEntryOffset> const*
+    getTypedEntries(LedgerEntryType type) const
+    {
+        static_assert(std::is_same_v<T, LiveBucket>);
+        releaseAssert(mData.typedEntries);
+        auto iter = mData.typedEntries->find(type);
+        if (iter == mData.typedEntries->end())
+        {
+            return nullptr;
+        }
+        return &iter->second;
+    }
+
     void markBloomMiss() const;
 
 #ifdef BUILD_TESTS
@@ -392,8 +392,9 @@ FutureBucket<BucketT>::startMerge(Application& app, uint32_t maxProtocolVersion,
     MergeKey mk{BucketListBase<BucketT>::keepTombstoneEntries(level),
                 curr->getHash(), snap->getHash(), shadowHashes};
 
+    asio::io_context& ctx = app.getWorkerIOContext();
     std::shared_future<std::shared_ptr<BucketT>> f;
-    f = bm.getMergeFuture<BucketT>(mk);
+    f = bm.getMergeFuture<BucketT>(mk, ctx);
 
     if (f.valid())
     {
@@ -404,7 +405,6 @@ FutureBucket<BucketT>::startMerge(Application& app, uint32_t maxProtocolVersion,
         checkState();
         return;
     }
-    asio::io_context& ctx = app.getWorkerIOContext();
     bool doFsync = !app.getConfig().DISABLE_XDR_FSYNC;
     std::chrono::seconds availableTime =
         getAvailableTimeForMerge<BucketT>(app, level);
@@ -456,8 +456,13 @@ FutureBucket<BucketT>::startMerge(Application& app, uint32_t maxProtocolVersion,
 
     mOutputBucketFuture = task->get_future().share();
     bm.putMergeFuture(mk, mOutputBucketFuture);
+    // Hot archive merges yield to live BucketList merges, which the ledger
+    // close reads from
+    auto workClass = std::is_same_v<BucketT, HotArchiveBucket>
+                         ? BackgroundWorkClass::ARCHIVE_MERGE
+                         : BackgroundWorkClass::MERGE;
     app.postOnBackgroundThread(bind(&task_t::operator(), task),
-                               "FutureBucket: merge");
+                               "FutureBucket: merge", workClass);
     checkState();
 }
 
@@ -115,6 +115,21 @@ HotArchiveBucket::HotArchiveBucket() : BucketBase()
 {
 }
 
+void
+HotArchiveBucket::maybeInitializeCache(size_t totalBucketListSizeBytes,
+                                       Config const& cfg) const
+{
+    releaseAssert(mIndex);
+    mIndex->maybeInitializeCache(totalBucketListSizeBytes, cfg);
+}
+
+BucketEntryCounters const&
+HotArchiveBucket::getBucketEntryCounters() const
+{
+    releaseAssert(mIndex);
+    return mIndex->getBucketEntryCounters();
+}
+
 bool
 HotArchiveBucket::isTombstoneEntry(HotArchiveBucketEntry const& e)
 {
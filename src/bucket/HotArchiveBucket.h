@@ -47,6 +47,14 @@ class HotArchiveBucket
                      std::unique_ptr<HotArchiveBucketIndex const>&& index);
     uint32_t getBucketVersion() const;
 
+    // Initializes the random eviction cache of the bucket's index if it has
+    // not already been initialized. totalBucketListSizeBytes is the total
+    // size, in bytes, of all entries in the Hot Archive BucketList.
+    void maybeInitializeCache(size_t totalBucketListSizeBytes,
+                              Config const& cfg) const;
+
+    BucketEntryCounters const& getBucketEntryCounters() const;
+
     static std::shared_ptr<HotArchiveBucket>
     fresh(BucketManager& bucketManager, uint32_t protocolVersion,
           std::vector<LedgerEntry> const& archivedEntries,
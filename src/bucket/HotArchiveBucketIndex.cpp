@@ -5,19 +5,25 @@
 #include "bucket/HotArchiveBucketIndex.h"
 #include "bucket/BucketIndexUtils.h"
 #include "bucket/BucketManager.h"
+#include "main/Config.h"
 #include "util/GlobalChecks.h"
 #include "util/Logging.h"
+#include "util/types.h"
 #include "xdr/Stellar-ledger-entries.h"
 #include <cereal/archives/binary.hpp>
+#include <medida/meter.h>
 
 namespace stellar
 {
 
 HotArchiveBucketIndex::HotArchiveBucketIndex(
     BucketManager& bm, std::filesystem::path const& filename, Hash const& hash,
-    asio::io_context& ctx, SHA256* hasher)
+    asio::io_context& ctx, SHA256* hasher, fs::DurabilityGroup* durability,
+    IORateLimiter* ioLimiter)
     : mDiskIndex(bm, filename, getPageSize(bm.getConfig(), 0), hash, ctx,
-                 hasher)
+                 hasher, durability, ioLimiter)
+    , mCacheHitMeter(bm.getHotArchiveCacheHitMeter())
+    , mCacheMissMeter(bm.getHotArchiveCacheMissMeter())
 {
     ZoneScoped;
     releaseAssert(!filename.empty());
@@ -46,16 +52,145 @@ HotArchiveBucketIndex::HotArchiveBucketIndex(BucketManager const& bm,
                                              Archive& ar,
                                              std::streamoff pageSize)
     : mDiskIndex(ar, bm, pageSize)
+    , mCacheHitMeter(bm.getHotArchiveCacheHitMeter())
+    , mCacheMissMeter(bm.getHotArchiveCacheMissMeter())
 {
     // HotArchive only supports disk indexes
     releaseAssertOrThrow(pageSize != 0);
 }
 
+void
+HotArchiveBucketIndex::maybeInitializeCache(size_t totalBucketListSizeBytes,
+                                            Config const& cfg) const
+{
+    // Cache is already initialized
+    if (std::shared_lock<std::shared_mutex> lock(mCacheMutex); mCache)
+    {
+        return;
+    }
+
+    auto const& counters = mDiskIndex.getBucketEntryCounters();
+    auto entriesInThisBucket = counters.numEntries();
+
+    // Convert from MB to bytes, max size for entire BucketList cache
+    auto maxBucketListBytesToCache =
+        cfg.BUCKETLIST_DB_HOT_ARCHIVE_MEMORY_FOR_CACHING * 1024 * 1024;
+
+    // Nothing to cache, or cache is disabled
+    if (entriesInThisBucket == 0 || maxBucketListBytesToCache == 0)
+    {
+        return;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mCacheMutex);
+    if (totalBucketListSizeBytes < maxBucketListBytesToCache)
+    {
+        // We can cache the entire bucket
+        mCache = std::make_unique<CacheT>(entriesInThisBucket);
+        return;
+    }
+
+    // Same sizing as the LiveBucketIndex account cache: give this bucket its
+    // share of the memory, then convert that to an entry count using the
+    // average entry size of the bucket.
+    size_t bytesInThisBucket = 0;
+    for (auto const& [type, size] : counters.entryTypeSizes)
+    {
+        bytesInThisBucket += size;
+    }
+
+    double fractionOfTotalBucketListBytes =
+        static_cast<double>(bytesInThisBucket) / totalBucketListSizeBytes;
+    size_t bytesAvailableForBucketCache = static_cast<size_t>(
+        maxBucketListBytesToCache * fractionOfTotalBucketListBytes);
+    double averageEntrySize =
+        static_cast<double>(bytesInThisBucket) / entriesInThisBucket;
+
+    auto entriesToCache =
+        static_cast<size_t>(bytesAvailableForBucketCache / averageEntrySize);
+    if (entriesToCache > 0)
+    {
+        mCache = std::make_unique<CacheT>(entriesToCache);
+    }
+}
+
+bool
+HotArchiveBucketIndex::shouldUseCache() const
+{
+    std::shared_lock<std::shared_mutex> lock(mCacheMutex);
+    return mCache != nullptr;
+}
+
+HotArchiveIndexPtrT
+HotArchiveBucketIndex::getCachedEntry(LedgerKey const& k) const
+{
+    if (shouldUseCache())
+    {
+        std::shared_lock<std::shared_mutex> lock(mCacheMutex);
+        auto cachePtr = mCache->maybeGet(k);
+        if (cachePtr)
+        {
+            mCacheHitMeter.Mark();
+            return *cachePtr;
+        }
+
+        // As in LiveBucketIndex, misses are metered when the entry is inserted
+        // so that filter false positives are not counted as misses.
+    }
+
+    return nullptr;
+}
+
+IndexReturnT
+HotArchiveBucketIndex::lookup(LedgerKey const& k) const
+{
+    if (auto cached = getCachedEntry(k); cached)
+    {
+        return IndexReturnT(cached);
+    }
+
+    return mDiskIndex.scan(mDiskIndex.begin(), k).first;
+}
+
 std::pair<IndexReturnT, HotArchiveBucketIndex::IterT>
-HotArchiveBucketIndex::scan(IterT start, LedgerKey const& k) const
+HotArchiveBucketIndex::scan(IterT start, LedgerKey const& k,
+                            bool filterChecked) const
 {
     ZoneScoped;
-    return mDiskIndex.scan(start, k);
+    if (auto cached = getCachedEntry(k); cached)
+    {
+        return {IndexReturnT(cached), start};
+    }
+
+    return mDiskIndex.scan(start, k, filterChecked);
+}
+
+void
+HotArchiveBucketIndex::maybeAddToCache(HotArchiveIndexPtrT const& entry) const
+{
+    if (shouldUseCache())
+    {
+        releaseAssertOrThrow(entry);
+
+        // If we are adding an entry to the cache, we must have missed it
+        // earlier.
+        mCacheMissMeter.Mark();
+
+        std::shared_lock<std::shared_mutex> lock(mCacheMutex);
+        mCache->put(getBucketLedgerKey(*entry), entry);
+    }
+}
+
+size_t
+HotArchiveBucketIndex::getCurrentCacheSize() const
+{
+    if (shouldUseCache())
+    {
+        std::shared_lock<std::shared_mutex> lock(mCacheMutex);
+        return mCache->size();
+    }
+
+    return 0;
 }
 
 #ifdef BUILD_TESTS
@@ -69,6 +204,18 @@ HotArchiveBucketIndex::operator==(HotArchiveBucketIndex const& in) const
 
     return true;
 }
+
+size_t
+HotArchiveBucketIndex::getMaxCacheSize() const
+{
+    if (shouldUseCache())
+    {
+        std::shared_lock<std::shared_mutex> lock(mCacheMutex);
+        return mCache->maxSize();
+    }
+
+    return 0;
+}
 #endif
 
 template HotArchiveBucketIndex::HotArchiveBucketIndex(
@@ -8,11 +8,14 @@
 #include "bucket/DiskIndex.h"
 #include "bucket/HotArchiveBucket.h"
 #include "bucket/LedgerCmp.h"
+#include "ledger/LedgerHashUtils.h" // IWYU pragma: keep
 #include "util/NonCopyable.h"
+#include "util/ShardedRandomEvictionCache.h"
 #include "util/XDROperators.h" // IWYU pragma: keep
 #include "xdr/Stellar-ledger-entries.h"
 #include <filesystem>
 #include <optional>
+#include <shared_mutex>
 
 #include <cereal/archives/binary.hpp>
 
@@ -47,9 +50,27 @@ class BucketManager;
 
 class HotArchiveBucketIndex : public NonMovableOrCopyable
 {
+  public:
+    using CacheT = ShardedRandomEvictionCache<LedgerKey, HotArchiveIndexPtrT>;
+
   private:
     DiskIndex<HotArchiveBucket> const mDiskIndex;
 
+    // Optional cache of entries read from disk, keyed by LedgerKey. Restores
+    // and archived entry checks tend to look up the same keys repeatedly. Like
+    // the LiveBucketIndex cache, it is thread safe and mCacheMutex only guards
+    // mCache being set.
+    mutable std::unique_ptr<CacheT> mCache{};
+    mutable std::shared_mutex mCacheMutex;
+
+    medida::Meter& mCacheHitMeter;
+    medida::Meter& mCacheMissMeter;
+
+    bool shouldUseCache() const;
+
+    // Returns nullptr if cache is not enabled or entry not found
+    HotArchiveIndexPtrT getCachedEntry(LedgerKey const& k) const;
+
   public:
     inline static const uint32_t BUCKET_INDEX_VERSION = 0;
 
@@ -58,7 +79,8 @@ class HotArchiveBucketIndex : public NonMovableOrCopyable
     HotArchiveBucketIndex(BucketManager& bm,
                           std::filesystem::path const& filename,
                           Hash const& hash, asio::io_context& ctx,
-                          SHA256* hasher);
+                          SHA256* hasher, fs::DurabilityGroup* durability,
+                          IORateLimiter* ioLimiter);
 
     template <class Archive>
     HotArchiveBucketIndex(BucketManager const& bm, Archive& ar,
@@ -69,22 +91,28 @@ class HotArchiveBucketIndex : public NonMovableOrCopyable
     // LiveBucketIndex.
     static std::streamoff getPageSize(Config const& cfg, size_t bucketSize);
 
-    IndexReturnT
-    lookup(LedgerKey const& k) const
-    {
-        return mDiskIndex.scan(mDiskIndex.begin(), k).first;
-    }
+    // Initializes the entry cache if it has not already been initialized and
+    // BUCKETLIST_DB_HOT_ARCHIVE_MEMORY_FOR_CACHING is set. Memory is split
+    // between buckets in proportion to their share of
+    // totalBucketListSizeBytes, the total size of all entries in the Hot
+    // Archive BucketList.
+    void maybeInitializeCache(size_t totalBucketListSizeBytes,
+                              Config const& cfg) const;
+
+    IndexReturnT lookup(LedgerKey const& k) const;
+
+    void maybeAddToCache(HotArchiveIndexPtrT const& entry) const;
+
+    std::pair<IndexReturnT, IterT> scan(IterT start, LedgerKey const& k,
+                                        bool filterChecked = false) const;
 
-    // Hot Archive does not support the cache, so define empty function for
-    // consistency with LiveBucketIndex
     void
-    maybeAddToCache(
-        std::shared_ptr<HotArchiveBucketEntry const> const& entry) const
+    mayContain(std::set<LedgerKey, LedgerEntryIdCmp> const& keys,
+               std::vector<bool>& result) const
     {
+        mDiskIndex.mayContain(keys, result);
     }
 
-    std::pair<IndexReturnT, IterT> scan(IterT start, LedgerKey const& k) const;
-
     BucketEntryCounters const&
     getBucketEntryCounters() const
     {
@@ -116,6 +144,8 @@ class HotArchiveBucketIndex : public NonMovableOrCopyable
     }
 #ifdef BUILD_TESTS
     bool operator==(HotArchiveBucketIndex const& in) const;
+    size_t getMaxCacheSize() const;
 #endif
+    size_t getCurrentCacheSize() const;
 };
 }
@@ -4,6 +4,8 @@
 
 #include "bucket/HotArchiveBucketList.h"
 #include "bucket/BucketListBase.h"
+#include "main/Application.h"
+#include "main/Config.h"
 
 namespace stellar
 {
@@ -20,5 +22,44 @@ HotArchiveBucketList::addBatch(Application& app, uint32_t currLedger,
         HotArchiveBucket::FIRST_PROTOCOL_SUPPORTING_PERSISTENT_EVICTION));
     addBatchInternal(app, currLedger, currLedgerProtocol, archiveEntries,
                      restoredEntries);
+
+    // Initialize caches for any new buckets we might have added
+    maybeInitializeCaches(app.getConfig());
+}
+
+void
+HotArchiveBucketList::maybeInitializeCaches(Config const& cfg) const
+{
+    if (cfg.BUCKETLIST_DB_HOT_ARCHIVE_MEMORY_FOR_CACHING == 0)
+    {
+        return;
+    }
+
+    size_t totalSize = 0;
+    for (auto const& lev : mLevels)
+    {
+        for (auto const& b : {lev.getCurr(), lev.getSnap()})
+        {
+            if (!b->isEmpty())
+            {
+                for (auto const& [type, size] :
+                     b->getBucketEntryCounters().entryTypeSizes)
+                {
+                    totalSize += size;
+                }
+            }
+        }
+    }
+
+    for (auto const& lev : mLevels)
+    {
+        for (auto const& b : {lev.getCurr(), lev.getSnap()})
+        {
+            if (!b->isEmpty())
+            {
+                b->maybeInitializeCache(totalSize, cfg);
+            }
+        }
+    }
 }
 }
\ No newline at end of file
@@ -21,5 +21,9 @@ class HotArchiveBucketList : public BucketListBase<HotArchiveBucket>
                   uint32_t currLedgerProtocol,
                   std::vector<LedgerEntry> const& archiveEntries,
                   std::vector<LedgerKey> const& restoredEntries);
+
+    // Initializes any uninitialized caches in the BucketIndex. Should be called
+    // after every time buckets may have changed in the HotArchiveBucketList.
+    void maybeInitializeCaches(Config const& cfg) const;
 };
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include "bucket/BucketUtils.h"
 #include "bucket/LiveBucket.h"
 #include "util/GlobalChecks.h"
+#include "util/IORateLimiter.h"
 #include "util/XDRStream.h"
 #include "util/types.h"
 #include "xdr/Stellar-ledger-entries.h"
@@ -20,7 +21,8 @@ namespace
 // construction
 void
 processEntry(BucketEntry const& be, InMemoryBucketState& inMemoryState,
-             AssetPoolIDMap& assetPoolIDMap, BucketEntryCounters& counters,
+             AssetPoolIDMap& assetPoolIDMap,
+             AccountPoolIDMap& accountPoolIDMap, BucketEntryCounters& counters,
              std::streamoff& lastOffset,
              std::map<LedgerEntryType, std::streamoff>& typeStartOffsets,
              std::map<LedgerEntryType, std::streamoff>& typeEndOffsets,
@@ -45,6 +47,14 @@ processEntry(BucketEntry const& be, InMemoryBucketState& inMemoryState,
         }
     }
 
+    // Populate accountPoolIDMap
+    if (be.type() != DEADENTRY && lk.type() == TRUSTLINE &&
+        lk.trustLine().asset.type() == ASSET_TYPE_POOL_SHARE)
+    {
+        accountPoolIDMap[lk.trustLine().accountID].emplace_back(
+            lk.trustLine().asset.liquidityPoolID());
+    }
+
     inMemoryState.insert(be);
     updateTypeBoundaries(lk.type(), lastOffset, typeStartOffsets,
                          typeEndOffsets, lastTypeSeen);
@@ -98,8 +108,9 @@ InMemoryIndex::InMemoryIndex(BucketManager& bm,
     {
         releaseAssertOrThrow(be.type() != METAENTRY);
 
-        processEntry(be, mInMemoryState, mAssetPoolIDMap, mCounters, lastOffset,
-                     typeStartOffsets, typeEndOffsets, lastTypeSeen);
+        processEntry(be, mInMemoryState, mAssetPoolIDMap, mAccountPoolIDMap,
+                     mCounters, lastOffset, typeStartOffsets, typeEndOffsets,
+                     lastTypeSeen);
 
         lastOffset += xdr::xdr_size(be) + xdrOverheadBetweenEntries;
     }
@@ -110,7 +121,7 @@ InMemoryIndex::InMemoryIndex(BucketManager& bm,
 
 InMemoryIndex::InMemoryIndex(BucketManager const& bm,
                              std::filesystem::path const& filename,
-                             SHA256* hasher)
+                             SHA256* hasher, IORateLimiter* ioLimiter)
 {
     ZoneScoped;
     XDRInputFileStream in;
@@ -118,6 +129,7 @@ InMemoryIndex::InMemoryIndex(BucketManager const& bm,
     BucketEntry be;
     size_t iter = 0;
     std::streamoff lastOffset = 0;
+    std::streamoff charged = 0;
     std::map<LedgerEntryType, std::streamoff> typeStartOffsets;
     std::map<LedgerEntryType, std::streamoff> typeEndOffsets;
     std::optional<LedgerEntryType> lastTypeSeen = std::nullopt;
@@ -132,6 +144,11 @@ InMemoryIndex::InMemoryIndex(BucketManager const& bm,
                 throw std::runtime_error("Incomplete bucket index due to "
                                          "BucketManager shutdown");
             }
+            if (ioLimiter)
+            {
+                ioLimiter->consume(in.pos() - charged);
+                charged = in.pos();
+            }
         }
 
         if (be.type() == METAENTRY)
@@ -140,8 +157,9 @@ InMemoryIndex::InMemoryIndex(BucketManager const& bm,
             continue;
         }
 
-        processEntry(be, mInMemoryState, mAssetPoolIDMap, mCounters, lastOffset,
-                     typeStartOffsets, typeEndOffsets, lastTypeSeen);
+        processEntry(be, mInMemoryState, mAssetPoolIDMap, mAccountPoolIDMap,
+                     mCounters, lastOffset, typeStartOffsets, typeEndOffsets,
+                     lastTypeSeen);
         lastOffset = in.pos();
     }
 
@@ -161,12 +179,39 @@ InMemoryIndex::getRangeForType(LedgerEntryType type) const
     return std::nullopt;
 }
 
+size_t
+InMemoryIndex::getMemoryUsage() const
+{
+    // The XDR size of an entry approximates the heap memory its fields use.
+    // On top of that, every entry has a shared BucketEntry with its control
+    // block, a type erased set element and a hash set node and bucket slot.
+    constexpr size_t perEntryOverhead =
+        sizeof(BucketEntry) + 2 * sizeof(long) +
+        sizeof(InternalInMemoryBucketEntry) + 4 * sizeof(void*);
+
+    size_t bytes = sizeof(*this);
+    for (auto const& [type, size] : mCounters.entryTypeSizes)
+    {
+        bytes += size;
+    }
+    bytes += mCounters.numEntries() * perEntryOverhead;
+
+    // Pool ID vectors are small, count their map nodes only
+    constexpr size_t mapNodeOverhead = 4 * sizeof(void*) + sizeof(PoolID);
+    bytes += mAssetPoolIDMap.size() *
+             (sizeof(AssetPoolIDMap::value_type) + mapNodeOverhead);
+    bytes += mAccountPoolIDMap.size() *
+             (sizeof(AccountPoolIDMap::value_type) + mapNodeOverhead);
+    return bytes;
+}
+
 #ifdef BUILD_TESTS
 bool
 InMemoryIndex::operator==(InMemoryIndex const& in) const
 {
     return mInMemoryState == in.mInMemoryState &&
            mAssetPoolIDMap == in.mAssetPoolIDMap &&
+           mAccountPoolIDMap == in.mAccountPoolIDMap &&
            mTypeRanges == in.mTypeRanges && mCounters == in.mCounters;
 }
 #endif
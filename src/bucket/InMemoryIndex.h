@@ -14,6 +14,7 @@
 namespace stellar
 {
 
+class IORateLimiter;
 class SHA256;
 
 // LedgerKey sizes usually dominate LedgerEntry size, so we don't want to
@@ -188,6 +189,7 @@ class InMemoryIndex
   private:
     InMemoryBucketState mInMemoryState;
     AssetPoolIDMap mAssetPoolIDMap;
+    AccountPoolIDMap mAccountPoolIDMap;
     BucketEntryCounters mCounters{};
     std::map<LedgerEntryType, std::pair<std::streamoff, std::streamoff>>
         mTypeRanges;
@@ -196,7 +198,8 @@ class InMemoryIndex
     using IterT = InMemoryBucketState::IterT;
 
     InMemoryIndex(BucketManager const& bm,
-                  std::filesystem::path const& filename, SHA256* hasher);
+                  std::filesystem::path const& filename, SHA256* hasher,
+                  IORateLimiter* ioLimiter);
 
     InMemoryIndex(BucketManager& bm,
                   std::vector<BucketEntry> const& inMemoryState,
@@ -219,6 +222,12 @@ class InMemoryIndex
         return mAssetPoolIDMap;
     }
 
+    AccountPoolIDMap const&
+    getAccountPoolIDMap() const
+    {
+        return mAccountPoolIDMap;
+    }
+
     BucketEntryCounters const&
     getBucketEntryCounters() const
     {
@@ -234,6 +243,10 @@ class InMemoryIndex
     std::optional<std::pair<std::streamoff, std::streamoff>>
     getRangeForType(LedgerEntryType type) const;
 
+    // Returns the estimated number of bytes of memory used by the index,
+    // which holds every entry of the bucket
+    size_t getMemoryUsage() const;
+
 #ifdef BUILD_TESTS
     bool operator==(InMemoryIndex const& in) const;
 #endif
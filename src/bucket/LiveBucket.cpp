@@ -10,7 +10,12 @@
 #include "bucket/BucketOutputIterator.h"
 #include "bucket/BucketUtils.h"
 #include "bucket/LedgerCmp.h"
+#include <Tracy.hpp>
+#include <future>
+#include <iterator>
+#include <map>
 #include <medida/counter.h>
+#include <optional>
 
 namespace stellar
 {
@@ -337,6 +342,16 @@ LiveBucket::getIndexCacheSize() const
     return 0;
 }
 
+size_t
+LiveBucket::getIndexMemoryUsage() const
+{
+    if (mIndex)
+    {
+        return mIndex->getMemoryUsage();
+    }
+    return 0;
+}
+
 #ifdef BUILD_TESTS
 void
 LiveBucket::apply(Application& app) const
@@ -376,42 +391,106 @@ LiveBucket::getRangeForType(LedgerEntryType type) const
     return getIndex().getRangeForType(type);
 }
 
+std::vector<TypedEntryOffset> const*
+LiveBucket::getTypedEntries(LedgerEntryType type) const
+{
+    return getIndex().getTypedEntries(type);
+}
+
 std::vector<BucketEntry>
 LiveBucket::convertToBucketEntry(bool useInit,
                                  std::vector<LedgerEntry> const& initEntries,
                                  std::vector<LedgerEntry> const& liveEntries,
                                  std::vector<LedgerKey> const& deadEntries)
 {
-    std::vector<BucketEntry> bucket;
+    ZoneScoped;
+    size_t const total =
+        initEntries.size() + liveEntries.size() + deadEntries.size();
+
+    // Converts and sorts all entries of the given type, or all entries if
+    // type is not set
+    auto convert = [&](std::optional<LedgerEntryType> type, size_t count) {
+        std::vector<BucketEntry> bucket;
+        bucket.reserve(count);
+        for (auto const& e : initEntries)
+        {
+            if (!type || e.data.type() == *type)
+            {
+                BucketEntry ce;
+                ce.type(useInit ? INITENTRY : LIVEENTRY);
+                ce.liveEntry() = e;
+                bucket.push_back(ce);
+            }
+        }
+        for (auto const& e : liveEntries)
+        {
+            if (!type || e.data.type() == *type)
+            {
+                BucketEntry ce;
+                ce.type(LIVEENTRY);
+                ce.liveEntry() = e;
+                bucket.push_back(ce);
+            }
+        }
+        for (auto const& e : deadEntries)
+        {
+            if (!type || e.type() == *type)
+            {
+                BucketEntry ce;
+                ce.type(DEADENTRY);
+                ce.deadEntry() = e;
+                bucket.push_back(ce);
+            }
+        }
+
+        BucketEntryIdCmp<LiveBucket> cmp;
+        std::sort(bucket.begin(), bucket.end(), cmp);
+        releaseAssert(std::adjacent_find(bucket.begin(), bucket.end(),
+                                         [&cmp](BucketEntry const& lhs,
+                                                BucketEntry const& rhs) {
+                                             return !cmp(lhs, rhs);
+                                         }) == bucket.end());
+        return bucket;
+    };
+
+    if (total < PARALLEL_CONVERT_MIN_ENTRIES)
+    {
+        return convert(std::nullopt, total);
+    }
+
+    std::map<LedgerEntryType, size_t> typeCounts;
     for (auto const& e : initEntries)
     {
-        BucketEntry ce;
-        ce.type(useInit ? INITENTRY : LIVEENTRY);
-        ce.liveEntry() = e;
-        bucket.push_back(ce);
+        ++typeCounts[e.data.type()];
     }
     for (auto const& e : liveEntries)
     {
-        BucketEntry ce;
-        ce.type(LIVEENTRY);
-        ce.liveEntry() = e;
-        bucket.push_back(ce);
+        ++typeCounts[e.data.type()];
     }
     for (auto const& e : deadEntries)
     {
-        BucketEntry ce;
-        ce.type(DEADENTRY);
-        ce.deadEntry() = e;
-        bucket.push_back(ce);
+        ++typeCounts[e.type()];
+    }
+    if (typeCounts.size() < 2)
+    {
+        return convert(std::nullopt, total);
     }
 
-    BucketEntryIdCmp<LiveBucket> cmp;
-    std::sort(bucket.begin(), bucket.end(), cmp);
-    releaseAssert(std::adjacent_find(
-                      bucket.begin(), bucket.end(),
-                      [&cmp](BucketEntry const& lhs, BucketEntry const& rhs) {
-                          return !cmp(lhs, rhs);
-                      }) == bucket.end());
+    // Entries of different types never compare equal, so concatenating the
+    // per-type runs in type order yields the same sorted bucket
+    std::vector<std::future<std::vector<BucketEntry>>> futures;
+    for (auto const& [type, count] : typeCounts)
+    {
+        futures.emplace_back(
+            std::async(std::launch::async, convert, type, count));
+    }
+    std::vector<BucketEntry> bucket;
+    bucket.reserve(total);
+    for (auto& f : futures)
+    {
+        auto run = f.get();
+        std::move(run.begin(), run.end(), std::back_inserter(bucket));
+    }
     return bucket;
 }
 
@@ -599,6 +678,13 @@ template void LiveBucket::mergeCasesWithEqualKeys<FileMergeInput<LiveBucket>>(
     std::vector<LiveBucketInputIterator>& shadowIterators,
     bool keepShadowedLifecycleEntries);
 
+template void
+LiveBucket::mergeCasesWithEqualKeys<RangeFileMergeInput<LiveBucket>>(
+    MergeCounters& mc, RangeFileMergeInput<LiveBucket>& inputSource,
+    std::function<void(BucketEntry const&)> putFunc, uint32_t protocolVersion,
+    std::vector<LiveBucketInputIterator>& shadowIterators,
+    bool keepShadowedLifecycleEntries);
+
 template void LiveBucket::mergeCasesWithEqualKeys<MemoryMergeInput<LiveBucket>>(
     MergeCounters& mc, MemoryMergeInput<LiveBucket>& inputSource,
     std::function<void(BucketEntry const&)> putFunc, uint32_t protocolVersion,
@@ -63,6 +63,10 @@ class LiveBucket : public BucketBase<LiveBucket, LiveBucketIndex>,
     // Returns the current cache size for this bucket's index
     size_t getIndexCacheSize() const;
 
+    // Returns the estimated memory used by the bucket's index in bytes, or 0
+    // if the bucket is not indexed
+    size_t getIndexMemoryUsage() const;
+
     // At version 11, we added support for INITENTRY and METAENTRY. Before this
     // we were only supporting LIVEENTRY and DEADENTRY.
     static constexpr ProtocolVersion
@@ -74,6 +78,11 @@ class LiveBucket : public BucketBase<LiveBucket, LiveBucketIndex>,
     static void checkProtocolLegality(BucketEntry const& entry,
                                       uint32_t protocolVersion);
 
+    // Batches with at least this many entries are converted and sorted one
+    // entry type per thread. Bucket entries order by type first, so the
+    // sorted runs of each type only need to be concatenated.
+    static constexpr size_t PARALLEL_CONVERT_MIN_ENTRIES = 4096;
+
     static std::vector<BucketEntry>
     convertToBucketEntry(bool useInit,
                          std::vector<LedgerEntry> const& initEntries,
@@ -105,6 +114,12 @@ class LiveBucket : public BucketBase<LiveBucket, LiveBucketIndex>,
     std::optional<std::pair<std::streamoff, std::streamoff>>
     getRangeForType(LedgerEntryType type) const;
 
+    // Returns the key, file offset and liveness of every entry of the given
+    // type in file order, or null if the bucket's index does not track them.
+    // See LiveBucketIndex::getTypedEntries.
+    std::vector<TypedEntryOffset> const*
+    getTypedEntries(LedgerEntryType type) const;
+
     // Create a fresh bucket from given vectors of init (created) and live
     // (updated) LedgerEntries, and dead LedgerEntryKeys. The bucket will
     // be sorted, hashed, and adopted in the provided BucketManager.
@@ -7,9 +7,11 @@
 #include "bucket/BucketManager.h"
 #include "bucket/BucketUtils.h"
 #include "bucket/DiskIndex.h"
+#include "util/BlockCompressedFile.h"
 #include "util/Fs.h"
 #include "util/GlobalChecks.h"
 #include "util/Logging.h"
+#include "util/MemoryAccounting.h"
 #include "xdr/Stellar-ledger-entries.h"
 #include <ios>
 #include <medida/meter.h>
@@ -41,14 +43,26 @@ LiveBucketIndex::getPageSize(Config const& cfg, size_t bucketSize)
 LiveBucketIndex::LiveBucketIndex(BucketManager& bm,
                                  std::filesystem::path const& filename,
                                  Hash const& hash, asio::io_context& ctx,
-                                 SHA256* hasher)
+                                 SHA256* hasher,
+                                 fs::DurabilityGroup* durability,
+                                 IORateLimiter* ioLimiter)
     : mCacheHitMeter(bm.getCacheHitMeter())
     , mCacheMissMeter(bm.getCacheMissMeter())
 {
     ZoneScoped;
     releaseAssert(!filename.empty());
 
-    auto pageSize = getPageSize(bm.getConfig(), fs::size(filename.string()));
+    auto const fileSize = BlockCompressedFile::originalSize(filename.string());
+    auto pageSize = getPageSize(bm.getConfig(), fileSize);
+    if (pageSize != 0 && bm.tryReserveInMemoryIndex(fileSize))
+    {
+        CLOG_DEBUG(Bucket,
+                   "LiveBucketIndex::createIndex() promoting bucket {} of {} "
+                   "bytes to in-memory index",
+                   filename, fileSize);
+        pageSize = 0;
+    }
+
     if (pageSize == 0)
     {
 
@@ -56,7 +70,8 @@ LiveBucketIndex::LiveBucketIndex(BucketManager& bm,
                    "LiveBucketIndex::createIndex() using in-memory index for "
                    "bucket {}",
                    filename);
-        mInMemoryIndex = std::make_unique<InMemoryIndex>(bm, filename, hasher);
+        mInMemoryIndex =
+            std::make_unique<InMemoryIndex>(bm, filename, hasher, ioLimiter);
     }
     else
     {
@@ -65,7 +80,7 @@ LiveBucketIndex::LiveBucketIndex(BucketManager& bm,
                    "page size {} in bucket {}",
                    pageSize, filename);
         mDiskIndex = std::make_unique<DiskIndex<LiveBucket>>(
-            bm, filename, pageSize, hash, ctx, hasher);
+            bm, filename, pageSize, hash, ctx, hasher, durability, ioLimiter);
     }
 }
 
@@ -160,6 +175,11 @@ LiveBucketIndex::maybeInitializeCache(size_t totalBucketListAccountsSizeBytes,
 
         mCache = std::make_unique<CacheT>(accountsToCache);
     }
+
+    if (cfg.BUCKETLIST_DB_CACHE_FREQUENCY_ADMISSION)
+    {
+        mCacheSketch = std::make_unique<FrequencySketch>(mCache->maxSize());
+    }
 }
 
 LiveBucketIndex::IterT
@@ -203,6 +223,11 @@ LiveBucketIndex::getCachedEntry(LedgerKey const& k) const
     if (shouldUseCache() && isCachedType(k))
     {
         std::shared_lock<std::shared_mutex> lock(mCacheMutex);
+        if (mCacheSketch)
+        {
+            mCacheSketch->increment(std::hash<LedgerKey>{}(k));
+        }
+
         auto cachePtr = mCache->maybeGet(k);
         if (cachePtr)
         {
@@ -240,7 +265,8 @@ LiveBucketIndex::lookup(LedgerKey const& k) const
 }
 
 std::pair<IndexReturnT, LiveBucketIndex::IterT>
-LiveBucketIndex::scan(IterT start, LedgerKey const& k) const
+LiveBucketIndex::scan(IterT start, LedgerKey const& k,
+                      bool filterChecked) const
 {
     if (mDiskIndex)
     {
@@ -249,13 +275,27 @@ LiveBucketIndex::scan(IterT start, LedgerKey const& k) const
             return {IndexReturnT(cached), start};
         }
 
-        return mDiskIndex->scan(getDiskIter(start), k);
+        return mDiskIndex->scan(getDiskIter(start), k, filterChecked);
     }
 
     releaseAssertOrThrow(mInMemoryIndex);
     return mInMemoryIndex->scan(getInMemoryIter(start), k);
 }
 
+void
+LiveBucketIndex::mayContain(std::set<LedgerKey, LedgerEntryIdCmp> const& keys,
+                            std::vector<bool>& result) const
+{
+    if (mDiskIndex)
+    {
+        mDiskIndex->mayContain(keys, result);
+    }
+    else
+    {
+        result.assign(keys.size(), true);
+    }
+}
+
 std::vector<PoolID> const&
 LiveBucketIndex::getPoolIDsByAsset(Asset const& asset) const
 {
@@ -282,6 +322,32 @@ LiveBucketIndex::getPoolIDsByAsset(Asset const& asset) const
     }
 }
 
+std::vector<PoolID> const&
+LiveBucketIndex::getPoolIDsByAccount(AccountID const& accountID) const
+{
+    static const std::vector<PoolID> emptyVec = {};
+
+    if (mDiskIndex)
+    {
+        auto iter = mDiskIndex->getAccountPoolIDMap().find(accountID);
+        if (iter == mDiskIndex->getAccountPoolIDMap().end())
+        {
+            return emptyVec;
+        }
+        return iter->second;
+    }
+    else
+    {
+        releaseAssertOrThrow(mInMemoryIndex);
+        auto iter = mInMemoryIndex->getAccountPoolIDMap().find(accountID);
+        if (iter == mInMemoryIndex->getAccountPoolIDMap().end())
+        {
+            return emptyVec;
+        }
+        return iter->second;
+    }
+}
+
 std::optional<std::pair<std::streamoff, std::streamoff>>
 LiveBucketIndex::getRangeForType(LedgerEntryType type) const
 {
@@ -294,6 +360,50 @@ LiveBucketIndex::getRangeForType(LedgerEntryType type) const
     return mInMemoryIndex->getRangeForType(type);
 }
 
+std::vector<TypedEntryOffset> const*
+LiveBucketIndex::getTypedEntries(LedgerEntryType type) const
+{
+    if (mDiskIndex)
+    {
+        return mDiskIndex->getTypedEntries(type);
+    }
+
+    return nullptr;
+}
+
+std::vector<LedgerKey>
+LiveBucketIndex::getMergePartitionKeys(size_t n) const
+{
+    if (mDiskIndex)
+    {
+        return mDiskIndex->getPartitionKeys(n);
+    }
+
+    return {};
+}
+
+std::optional<std::streamoff>
+LiveBucketIndex::getMergePartitionOffset(LedgerKey const& k) const
+{
+    if (mDiskIndex)
+    {
+        return mDiskIndex->getPartitionOffset(k);
+    }
+
+    return std::nullopt;
+}
+
+std::vector<std::streamoff>
+LiveBucketIndex::getPageOffsets(std::streamoff begin, std::streamoff end) const
+{
+    if (mDiskIndex)
+    {
+        return mDiskIndex->getPageOffsets(begin, end);
+    }
+
+    return {};
+}
+
 uint32_t
 LiveBucketIndex::getPageSize() const
 {
@@ -306,6 +416,18 @@ LiveBucketIndex::getPageSize() const
     return 0;
 }
 
+size_t
+LiveBucketIndex::getMemoryUsage() const
+{
+    if (mDiskIndex)
+    {
+        return mDiskIndex->getMemoryUsage();
+    }
+
+    releaseAssertOrThrow(mInMemoryIndex);
+    return mInMemoryIndex->getMemoryUsage();
+}
+
 BucketEntryCounters const&
 LiveBucketIndex::getBucketEntryCounters() const
 {
@@ -340,6 +462,7 @@ void
 LiveBucketIndex::maybeAddToCache(
     std::shared_ptr<BucketEntry const> const& entry) const
 {
+    MEMORY_ACCOUNTING_SCOPE(BUCKET_INDEX);
     if (shouldUseCache())
     {
         releaseAssertOrThrow(entry);
@@ -353,8 +476,23 @@ LiveBucketIndex::maybeAddToCache(
         // earlier.
         mCacheMissMeter.Mark();
 
-        std::unique_lock<std::shared_mutex> lock(mCacheMutex);
-        mCache->put(k, entry);
+        std::shared_lock<std::shared_mutex> lock(mCacheMutex);
+        if (mCacheSketch)
+        {
+            // The miss was already recorded in the sketch by getCachedEntry.
+            // Only admit the entry if it has been accessed more often
+            // recently than the entry it would evict, so that one-off scans
+            // cannot flush out hot accounts.
+            auto freq = mCacheSketch->frequency(std::hash<LedgerKey>{}(k));
+            mCache->put(k, entry, [&](LedgerKey const& victim) {
+                return freq >
+                       mCacheSketch->frequency(std::hash<LedgerKey>{}(victim));
+            });
+        }
+        else
+        {
+            mCache->put(k, entry);
+        }
     }
 }
 
@@ -10,8 +10,9 @@
 #include "bucket/LedgerCmp.h"
 #include "bucket/LiveBucket.h"
 #include "ledger/LedgerHashUtils.h" // IWYU pragma: keep
+#include "util/FrequencySketch.h"
 #include "util/NonCopyable.h"
-#include "util/RandomEvictionCache.h"
+#include "util/ShardedRandomEvictionCache.h"
 #include "util/XDROperators.h" // IWYU pragma: keep
 #include "xdr/Stellar-ledger-entries.h"
 #include <filesystem>
@@ -56,18 +57,25 @@ class LiveBucketIndex : public NonMovableOrCopyable
         std::variant<InMemoryIndex::IterT, DiskIndex<LiveBucket>::IterT>;
 
     using CacheT =
-        RandomEvictionCache<LedgerKey, std::shared_ptr<BucketEntry const>>;
+        ShardedRandomEvictionCache<LedgerKey,
+                                   std::shared_ptr<BucketEntry const>>;
 
   private:
     std::unique_ptr<DiskIndex<LiveBucket> const> mDiskIndex{};
     std::unique_ptr<InMemoryIndex const> mInMemoryIndex{};
 
     // The indexes themselves are thread safe, as they are immutable after
-    // construction. The cache is not, all accesses must first acquire this
-    // mutex.
+    // construction, and so is the cache. This mutex only guards mCache being
+    // set: accesses take it shared, initialization exclusive.
     mutable std::unique_ptr<CacheT> mCache{};
     mutable std::shared_mutex mCacheMutex;
 
+    // TinyLFU admission filter for mCache, only set if
+    // BUCKETLIST_DB_CACHE_FREQUENCY_ADMISSION is enabled. The sketch is
+    // internally synchronized, so hits can be recorded while holding only a
+    // shared lock on mCacheMutex.
+    mutable std::unique_ptr<FrequencySketch> mCacheSketch{};
+
     medida::Meter& mCacheHitMeter;
     medida::Meter& mCacheMissMeter;
 
@@ -95,12 +103,14 @@ class LiveBucketIndex : public NonMovableOrCopyable
 
   public:
     inline static const std::string DB_BACKEND_STATE = "bl";
-    inline static const uint32_t BUCKET_INDEX_VERSION = 6;
+    inline static const uint32_t BUCKET_INDEX_VERSION = 8;
 
     // Constructor for creating new index from Bucketfile
     // Note: Constructor does not initialize the cache
     LiveBucketIndex(BucketManager& bm, std::filesystem::path const& filename,
-                    Hash const& hash, asio::io_context& ctx, SHA256* hasher);
+                    Hash const& hash, asio::io_context& ctx, SHA256* hasher,
+                    fs::DurabilityGroup* durability,
+                    IORateLimiter* ioLimiter);
 
     // Constructor for loading pre-existing index from disk
     // Note: Constructor does not initialize the cache
@@ -134,18 +144,55 @@ class LiveBucketIndex : public NonMovableOrCopyable
 
     IndexReturnT lookup(LedgerKey const& k) const;
 
-    std::pair<IndexReturnT, IterT> scan(IterT start, LedgerKey const& k) const;
+    // See DiskIndex::scan. filterChecked is ignored for in-memory indexes.
+    std::pair<IndexReturnT, IterT> scan(IterT start, LedgerKey const& k,
+                                        bool filterChecked = false) const;
+
+    // Sets result[i] to false if the i-th key of keys is definitely not in
+    // the bucket. In-memory indexes have no filter and report every key.
+    void mayContain(std::set<LedgerKey, LedgerEntryIdCmp> const& keys,
+                    std::vector<bool>& result) const;
 
     std::vector<PoolID> const& getPoolIDsByAsset(Asset const& asset) const;
 
+    // Returns the PoolIDs of all pool share trustlines of the given account
+    // that have a LIVEENTRY or INITENTRY in this bucket.
+    std::vector<PoolID> const&
+    getPoolIDsByAccount(AccountID const& accountID) const;
+
     void maybeAddToCache(std::shared_ptr<BucketEntry const> const& entry) const;
 
     std::optional<std::pair<std::streamoff, std::streamoff>>
     getRangeForType(LedgerEntryType type) const;
 
+    // Returns the position of every entry of the given type, in file order.
+    // Returns null if the type has no typed entry index or if this is an
+    // in-memory index, in which case callers must decode the type's range.
+    std::vector<TypedEntryOffset> const*
+    getTypedEntries(LedgerEntryType type) const;
+
+    // Returns keys splitting the bucket into at most n key ranges for a
+    // partitioned merge. Returns an empty vector for in-memory indexes.
+    std::vector<LedgerKey> getMergePartitionKeys(size_t n) const;
+
+    // Returns the file offset a partitioned merge should seek to before
+    // reading entries not less than k, or std::nullopt if it should read from
+    // the start of the bucket.
+    std::optional<std::streamoff>
+    getMergePartitionOffset(LedgerKey const& k) const;
+
+    // Returns the file offsets of all index pages starting strictly between
+    // begin and end. Returns an empty vector for in-memory indexes.
+    std::vector<std::streamoff> getPageOffsets(std::streamoff begin,
+                                               std::streamoff end) const;
+
     BucketEntryCounters const& getBucketEntryCounters() const;
     uint32_t getPageSize() const;
 
+    // Returns the estimated number of bytes of memory used by the index,
+    // not counting the random eviction cache
+    size_t getMemoryUsage() const;
+
     IterT begin() const;
     IterT end() const;
     void markBloomMiss() const;
@@ -0,0 +1,223 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "bucket/LiveBucketListFilter.h"
+#include "bucket/BucketInputIterator.h"
+#include "bucket/BucketListSnapshotBase.h"
+#include "bucket/LiveBucket.h"
+#include "crypto/ShortHash.h"
+#include "ledger/LedgerTypeUtils.h"
+#include "main/AppConnector.h"
+#include "util/GlobalChecks.h"
+#include "util/Logging.h"
+#include "util/siphash.h"
+#include <Tracy.hpp>
+#include <algorithm>
+#include <xdrpp/marshal.h>
+
+namespace stellar
+{
+
+namespace
+{
+std::vector<Hash>
+getCoveredBucketHashes(BucketListSnapshot<LiveBucket> const& snapshot,
+                       uint32_t firstLevel)
+{
+    std::vector<Hash> hashes;
+    auto const& levels = snapshot.getLevels();
+    for (uint32_t i = firstLevel; i < levels.size(); ++i)
+    {
+        hashes.emplace_back(levels[i].curr.getRawBucket()->getHash());
+        hashes.emplace_back(levels[i].snap.getRawBucket()->getHash());
+    }
+    return hashes;
+}
+}
+
+LiveBucketListFilter::LiveBucketListFilter(uint32_t firstLevel,
+                                           std::vector<Hash>&& bucketHashes,
+                                           std::vector<uint64_t>& keyHashes,
+                                           binary_fuse_seed_t const& seed)
+    : mFirstLevel(firstLevel)
+    , mBucketHashes(std::move(bucketHashes))
+    , mNumKeys(keyHashes.size())
+    , mFilter(keyHashes.size() > 1
+                  ? std::make_unique<BinaryFuseFilter16 const>(keyHashes, seed)
+                  : nullptr)
+{
+}
+
+bool
+LiveBucketListFilter::covers(
+    BucketListSnapshot<LiveBucket> const& snapshot) const
+{
+    return getCoveredBucketHashes(snapshot, mFirstLevel) == mBucketHashes;
+}
+
+bool
+LiveBucketListFilter::mayContain(LedgerKey const& k) const
+{
+    if (!mFilter)
+    {
+        return mNumKeys != 0;
+    }
+
+    return mFilter->contains(k);
+}
+
+LiveBucketListFilterBuilder::LiveBucketListFilterBuilder(uint32_t firstLevel)
+    : mFirstLevel(firstLevel), mSeed(shortHash::getShortHashInitKey())
+{
+}
+
+void
+LiveBucketListFilterBuilder::update(
+    AppConnector& app, BucketListSnapshot<LiveBucket> const& snapshot)
+{
+    auto hashes = getCoveredBucketHashes(snapshot, mFirstLevel);
+
+    MutexLocker guard(mMutex);
+    if (hashes == mRequested)
+    {
+        return;
+    }
+
+    BucketVecT buckets;
+    auto const& levels = snapshot.getLevels();
+    for (uint32_t i = mFirstLevel; i < levels.size(); ++i)
+    {
+        buckets.emplace_back(levels[i].curr.getRawBucket());
+        buckets.emplace_back(levels[i].snap.getRawBucket());
+    }
+
+    mRequested = std::move(hashes);
+    mPending = std::move(buckets);
+    if (!mBuilding)
+    {
+        mBuilding = true;
+        app.postOnBackgroundThread(
+            [self = shared_from_this()]() { self->build(); },
+            "LiveBucketListFilter: build",
+            BackgroundWorkClass::MERGE);
+    }
+}
+
+std::shared_ptr<LiveBucketListFilter const>
+LiveBucketListFilterBuilder::getFilter(
+    BucketListSnapshot<LiveBucket> const& snapshot) const
+{
+    std::shared_ptr<LiveBucketListFilter const> filter;
+    {
+        MutexLocker guard(mMutex);
+        filter = mFilter;
+    }
+
+    if (filter && filter->covers(snapshot))
+    {
+        return filter;
+    }
+    return nullptr;
+}
+
+std::vector<uint64_t>
+LiveBucketListFilterBuilder::hashBucketKeys(LiveBucket const& bucket) const
+{
+    ZoneScoped;
+    std::vector<uint64_t> hashes;
+    for (LiveBucketInputIterator in(bucket.shared_from_this()); in; ++in)
+    {
+        auto const& be = *in;
+        if (be.type() == DEADENTRY)
+        {
+            continue;
+        }
+
+        auto keyBuf = xdr::xdr_to_opaque(LedgerEntryKey(be.liveEntry()));
+        SipHash24 hasher(mSeed.data());
+        hasher.update(keyBuf.data(), keyBuf.size());
+        hashes.emplace_back(hasher.digest());
+    }
+    return hashes;
+}
+
+std::shared_ptr<LiveBucketListFilter const>
+LiveBucketListFilterBuilder::buildFilter(BucketVecT const& buckets)
+{
+    ZoneScoped;
+    std::map<Hash, std::shared_ptr<std::vector<uint64_t> const>> keyHashes;
+    std::vector<Hash> bucketHashes;
+    size_t numHashes = 0;
+    for (auto const& b : buckets)
+    {
+        bucketHashes.emplace_back(b->getHash());
+        if (b->isEmpty() || keyHashes.count(b->getHash()) != 0)
+        {
+            continue;
+        }
+
+        auto iter = mKeyHashes.find(b->getHash());
+        auto hashes = iter != mKeyHashes.end()
+                          ? iter->second
+                          : std::make_shared<std::vector<uint64_t> const>(
+                                hashBucketKeys(*b));
+        numHashes += hashes->size();
+        keyHashes.emplace(b->getHash(), std::move(hashes));
+    }
+
+    // Drop the hashes of buckets that are no longer covered
+    mKeyHashes = std::move(keyHashes);
+
+    // The same key is often live in several levels
+    std::vector<uint64_t> allHashes;
+    allHashes.reserve(numHashes);
+    for (auto const& [hash, hashes] : mKeyHashes)
+    {
+        allHashes.insert(allHashes.end(), hashes->begin(), hashes->end());
+    }
+    std::sort(allHashes.begin(), allHashes.end());
+    allHashes.erase(std::unique(allHashes.begin(), allHashes.end()),
+                    allHashes.end());
+
+    try
+    {
+        return std::make_shared<LiveBucketListFilter const>(
+            mFirstLevel, std::move(bucketHashes), allHashes, mSeed);
+    }
+    catch (std::exception const& e)
+    {
+        // Population failure is very unlikely, and lookups are still correct
+        // without the filter
+        CLOG_WARNING(Bucket,
+                     "Failed to build BucketList filter over {} keys: {}",
+                     allHashes.size(), e.what());
+        return nullptr;
+    }
+}
+
+void
+LiveBucketListFilterBuilder::build()
+{
+    ZoneScoped;
+    for (;;)
+    {
+        BucketVecT buckets;
+        {
+            MutexLocker guard(mMutex);
+            if (!mPending)
+            {
+                mBuilding = false;
+                return;
+            }
+            buckets = std::move(*mPending);
+            mPending.reset();
+        }
+
+        auto filter = buildFilter(buckets);
+
+        MutexLocker guard(mMutex);
+        mFilter = std::move(filter);
+    }
+}
+}
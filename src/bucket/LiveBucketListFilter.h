@@ -0,0 +1,114 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/BinaryFuseFilter.h"
+#include "util/NonCopyable.h"
+#include "util/ThreadAnnotations.h"
+#include "xdr/Stellar-ledger-entries.h"
+#include "xdr/Stellar-types.h"
+
+#include <map>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace stellar
+{
+
+class AppConnector;
+class LiveBucket;
+template <class BucketT> class BucketListSnapshot;
+
+// Negative lookup filter over the keys of every bucket in the deeper levels of
+// the live BucketList, starting at a configured first level. Lookups for keys
+// that don't exist would otherwise probe the filter of every one of those
+// buckets. With this filter, a single probe tells whether they can be skipped
+// entirely. Only live entries are added: a key that is not live in any
+// covered bucket can not be found there, tombstone or not.
+class LiveBucketListFilter : public NonMovableOrCopyable
+{
+    uint32_t const mFirstLevel;
+
+    // Hashes of the curr and snap bucket of each covered level, in BucketList
+    // order
+    std::vector<Hash> const mBucketHashes;
+
+    size_t const mNumKeys;
+
+    // Binary Fuse filters need at least two keys, so this is null for a
+    // filter over fewer keys
+    std::unique_ptr<BinaryFuseFilter16 const> mFilter;
+
+  public:
+    // keyHashes are the deduplicated SipHash24 digests, keyed by seed, of the
+    // keys in the buckets identified by bucketHashes.
+    LiveBucketListFilter(uint32_t firstLevel, std::vector<Hash>&& bucketHashes,
+                         std::vector<uint64_t>& keyHashes,
+                         binary_fuse_seed_t const& seed);
+
+    uint32_t
+    getFirstLevel() const
+    {
+        return mFirstLevel;
+    }
+
+    // Returns true if this filter was built from the buckets currently in the
+    // covered levels of snapshot
+    bool covers(BucketListSnapshot<LiveBucket> const& snapshot) const;
+
+    // Returns false if k is definitely not live in any covered bucket
+    bool mayContain(LedgerKey const& k) const;
+};
+
+// Keeps a LiveBucketListFilter up to date with the live BucketList. Whenever a
+// covered level changes, the filter is rebuilt on a background thread. The key
+// hashes of each covered bucket are kept between rebuilds, so a rebuild only
+// reads the buckets that are new since the previous one. Until a rebuild
+// finishes, getFilter returns null and lookups fall back to probing each
+// bucket's own filter.
+class LiveBucketListFilterBuilder
+    : public std::enable_shared_from_this<LiveBucketListFilterBuilder>,
+      public NonMovableOrCopyable
+{
+    using BucketVecT = std::vector<std::shared_ptr<LiveBucket const>>;
+
+    uint32_t const mFirstLevel;
+    binary_fuse_seed_t const mSeed;
+
+    mutable Mutex mMutex;
+    std::shared_ptr<LiveBucketListFilter const> mFilter GUARDED_BY(mMutex);
+
+    // Covered buckets of the most recent snapshot that still has to be built
+    std::optional<BucketVecT> mPending GUARDED_BY(mMutex);
+
+    // Hashes of the buckets most recently scheduled for a build, so that a
+    // build is only scheduled once per change
+    std::vector<Hash> mRequested GUARDED_BY(mMutex);
+    bool mBuilding GUARDED_BY(mMutex){false};
+
+    // Only accessed by the thread running build()
+    std::map<Hash, std::shared_ptr<std::vector<uint64_t> const>> mKeyHashes;
+
+    std::vector<uint64_t> hashBucketKeys(LiveBucket const& bucket) const;
+    std::shared_ptr<LiveBucketListFilter const>
+    buildFilter(BucketVecT const& buckets);
+    void build() LOCKS_EXCLUDED(mMutex);
+
+  public:
+    explicit LiveBucketListFilterBuilder(uint32_t firstLevel);
+
+    // Schedules a rebuild on a background thread if the covered levels of
+    // snapshot changed since the last call.
+    void update(AppConnector& app,
+                BucketListSnapshot<LiveBucket> const& snapshot)
+        LOCKS_EXCLUDED(mMutex);
+
+    // Returns the current filter if it covers snapshot, null otherwise
+    std::shared_ptr<LiveBucketListFilter const>
+    getFilter(BucketListSnapshot<LiveBucket> const& snapshot) const
+        LOCKS_EXCLUDED(mMutex);
+};
+}
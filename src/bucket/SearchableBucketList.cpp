@@ -7,12 +7,56 @@
 #include "bucket/BucketListSnapshotBase.h"
 #include "bucket/LiveBucketList.h"
 #include "ledger/LedgerTxn.h"
+#include "main/AppConnector.h"
 #include "util/GlobalChecks.h"
+#include "util/ProtocolVersion.h"
+#include "util/types.h"
 
 #include <medida/timer.h>
 
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <set>
+
 namespace stellar
 {
+namespace
+{
+LiveBucketSnapshot const&
+getBucketFromIter(BucketListSnapshot<LiveBucket> const& snapshot,
+                  EvictionIterator const& iter)
+{
+    auto& level = snapshot.getLevels().at(iter.bucketListLevel);
+    return iter.isCurrBucket ? level.curr : level.snap;
+}
+
+// Contiguous piece of the eviction scan region within a single bucket. iter
+// starts at the beginning of the chunk and is advanced by the scan.
+struct EvictionScanChunk
+{
+    LiveBucketSnapshot const* bucket;
+    EvictionIterator iter;
+    uint32_t bytesToScan;
+
+    // True if this chunk ends the scan region
+    bool isRegionEnd;
+
+    std::list<EvictionResultEntry> eligibleEntries{};
+    Loop result{Loop::INCOMPLETE};
+
+    EvictionScanChunk(LiveBucketSnapshot const& bucket,
+                      EvictionIterator const& iter, uint64_t bytesToScan,
+                      bool isRegionEnd)
+        : bucket(&bucket)
+        , iter(iter)
+        , bytesToScan(static_cast<uint32_t>(bytesToScan))
+        , isRegionEnd(isRegionEnd)
+    {
+    }
+};
+}
+
 std::unique_ptr<EvictionResultCandidates>
 SearchableLiveBucketListSnapshot::scanForEviction(
     uint32_t ledgerSeq, EvictionCounters& counters,
@@ -22,13 +66,6 @@ SearchableLiveBucketListSnapshot::scanForEviction(
     releaseAssert(mSnapshot);
     releaseAssert(stats);
 
-    auto getBucketFromIter =
-        [&levels = mSnapshot->getLevels()](
-            EvictionIterator const& iter) -> LiveBucketSnapshot const& {
-        auto& level = levels.at(iter.bucketListLevel);
-        return iter.isCurrBucket ? level.curr : level.snap;
-    };
-
     LiveBucketList::updateStartingEvictionIterator(
         evictionIter, sas.startingEvictionScanLevel, ledgerSeq);
 
@@ -47,13 +84,23 @@ SearchableLiveBucketListSnapshot::scanForEviction(
     // the linked list to check if an entry has already been evicted.
     std::unique_ptr<EvictionResultCandidates> result =
         std::make_unique<EvictionResultCandidates>(sas, ledgerSeq, ledgerVers);
+
+    auto const numThreads =
+        mAppConnector.getConfig().BACKGROUND_EVICTION_SCAN_THREADS;
+    if (numThreads > 1)
+    {
+        scanForEvictionParallel(ledgerSeq, counters, evictionIter, stats, sas,
+                                ledgerVers, numThreads, *result);
+        return result;
+    }
+
     UnorderedSet<LedgerKey> keysToEvict;
     auto startIter = evictionIter;
     auto scanSize = sas.evictionScanSize;
 
     for (;;)
     {
-        auto const& b = getBucketFromIter(evictionIter);
+        auto const& b = getBucketFromIter(*mSnapshot, evictionIter);
         LiveBucketList::checkIfEvictionScanIsStuck(
             evictionIter, sas.evictionScanSize, b.getRawBucket(), counters);
 
@@ -78,6 +125,147 @@ SearchableLiveBucketListSnapshot::scanForEviction(
     return result;
 }
 
+void
+SearchableLiveBucketListSnapshot::scanForEvictionParallel(
+    uint32_t ledgerSeq, EvictionCounters& counters,
+    EvictionIterator evictionIter, std::shared_ptr<EvictionStatistics> stats,
+    StateArchivalSettings const& sas, uint32_t ledgerVers, uint32_t numThreads,
+    EvictionResultCandidates& result) const
+{
+    ZoneScoped;
+
+    // First, walk the scan region exactly like the serial scan does, without
+    // reading any entries. Bucket sizes and index page offsets are enough to
+    // determine where the region ends, since the serial scan stops at the
+    // first entry boundary at or past scanSize bytes.
+    std::vector<EvictionScanChunk> chunks;
+    auto startIter = evictionIter;
+    uint64_t remaining = sas.evictionScanSize;
+    for (;;)
+    {
+        auto const& b = getBucketFromIter(*mSnapshot, evictionIter);
+        LiveBucketList::checkIfEvictionScanIsStuck(
+            evictionIter, sas.evictionScanSize, b.getRawBucket(), counters);
+
+        if (!b.isEmpty() &&
+            !protocolVersionIsBefore(b.getRawBucket()->getBucketVersion(),
+                                     SOROBAN_PROTOCOL_VERSION))
+        {
+            if (remaining == 0)
+            {
+                break;
+            }
+
+            uint64_t const begin = evictionIter.bucketFileOffset;
+            uint64_t const size = b.getRawBucket()->getSize();
+            uint64_t const available = size > begin ? size - begin : 0;
+            bool const lastBucket = remaining <= available;
+            uint64_t const end = begin + (lastBucket ? remaining : available);
+
+            if (begin < end)
+            {
+                // Split on up to numThreads - 1 evenly spaced page boundaries,
+                // which are always entry boundaries.
+                auto pages = b.getPageOffsets(begin, end);
+                auto numSplits =
+                    std::min<size_t>(pages.size(), numThreads - 1);
+                auto chunkIter = evictionIter;
+                for (size_t i = 1; i <= numSplits; ++i)
+                {
+                    uint64_t split =
+                        pages.at(i * pages.size() / (numSplits + 1));
+                    chunks.emplace_back(b, chunkIter,
+                                        split - chunkIter.bucketFileOffset,
+                                        false);
+                    chunkIter.bucketFileOffset = split;
+                }
+
+                chunks.emplace_back(b, chunkIter,
+                                    end - chunkIter.bucketFileOffset,
+                                    lastBucket);
+            }
+
+            if (lastBucket)
+            {
+                break;
+            }
+
+            remaining -= available;
+        }
+
+        // If we return back to the Bucket we started at, exit
+        if (LiveBucketList::updateEvictionIterAndRecordStats(
+                evictionIter, startIter, sas.startingEvictionScanLevel,
+                ledgerSeq, stats, counters))
+        {
+            break;
+        }
+    }
+
+    // Snapshot streams are not thread safe, so every worker other than the
+    // current thread gets its own copy of the snapshot.
+    auto const numWorkers = std::min<size_t>(numThreads, chunks.size());
+    std::vector<std::unique_ptr<SearchableLiveBucketListSnapshot const>>
+        workerSnapshots;
+    for (size_t i = 1; i < numWorkers; ++i)
+    {
+        workerSnapshots.emplace_back(new SearchableLiveBucketListSnapshot(
+            mSnapshotManager, mAppConnector,
+            std::make_unique<BucketListSnapshot<LiveBucket>>(*mSnapshot), {},
+            mBucketListFilter));
+    }
+
+    // Chunks are scanned independently, so an entry that is shadowed by an
+    // already evicted entry in an earlier chunk may be reported again. Since
+    // TTLs are loaded from the entire BucketList, such duplicates are
+    // filtered out below in scan order.
+    std::atomic<size_t> nextChunk{0};
+    auto worker = [&](SearchableLiveBucketListSnapshot const& bl) {
+        for (auto i = nextChunk++; i < chunks.size(); i = nextChunk++)
+        {
+            auto& chunk = chunks.at(i);
+            UnorderedSet<LedgerKey> keysInChunk;
+            chunk.result = chunk.bucket->scanForEviction(
+                chunk.iter, chunk.bytesToScan, ledgerSeq,
+                chunk.eligibleEntries, bl, ledgerVers, keysInChunk);
+        }
+    };
+
+    std::vector<std::future<void>> futures;
+    for (auto const& bl : workerSnapshots)
+    {
+        futures.emplace_back(
+            std::async(std::launch::async, worker, std::cref(*bl)));
+    }
+    worker(*this);
+    for (auto& f : futures)
+    {
+        f.get();
+    }
+
+    UnorderedSet<LedgerKey> keysToEvict;
+    for (auto& chunk : chunks)
+    {
+        for (auto& e : chunk.eligibleEntries)
+        {
+            if (keysToEvict.emplace(LedgerEntryKey(e.entry)).second)
+            {
+                result.eligibleEntries.emplace_back(std::move(e));
+            }
+        }
+    }
+
+    if (!chunks.empty() && chunks.back().isRegionEnd)
+    {
+        releaseAssert(chunks.back().result == Loop::COMPLETE);
+        result.endOfRegionIterator = chunks.back().iter;
+    }
+    else
+    {
+        result.endOfRegionIterator = evictionIter;
+    }
+}
+
 void
 SearchableLiveBucketListSnapshot::scanForEntriesOfType(
     LedgerEntryType type,
@@ -91,11 +279,209 @@ SearchableLiveBucketListSnapshot::scanForEntriesOfType(
     loopAllBuckets(f, *mSnapshot);
 }
 
+void
+SearchableLiveBucketListSnapshot::scanForEntriesOfTypeByLevel(
+    LedgerEntryType type, uint32_t numThreads,
+    std::function<void(BucketEntry const&, uint32_t)> callback) const
+{
+    ZoneScoped;
+    releaseAssert(mSnapshot);
+    auto const numLevels =
+        static_cast<uint32_t>(mSnapshot->getLevels().size());
+
+    // Snapshot streams are not thread safe, so every worker other than the
+    // current thread gets its own copy of the snapshot.
+    auto const numWorkers = std::clamp<uint32_t>(numThreads, 1, numLevels);
+    std::vector<std::unique_ptr<SearchableLiveBucketListSnapshot const>>
+        workerSnapshots;
+    for (uint32_t i = 1; i < numWorkers; ++i)
+    {
+        workerSnapshots.emplace_back(new SearchableLiveBucketListSnapshot(
+            mSnapshotManager, mAppConnector,
+            std::make_unique<BucketListSnapshot<LiveBucket>>(*mSnapshot), {},
+            mBucketListFilter));
+    }
+
+    std::atomic<uint32_t> nextLevel{0};
+    auto worker = [&](SearchableLiveBucketListSnapshot const& bl) {
+        auto f = [type, &callback](auto const& b, uint32_t level) {
+            return b.scanForEntriesOfType(
+                type, [&callback, level](BucketEntry const& be) {
+                    callback(be, level);
+                    return Loop::INCOMPLETE;
+                });
+        };
+        for (auto i = nextLevel++; i < numLevels; i = nextLevel++)
+        {
+            bl.loopBucketsByLevel(f, *bl.mSnapshot, i, i + 1);
+        }
+    };
+
+    std::vector<std::future<void>> futures;
+    for (auto const& bl : workerSnapshots)
+    {
+        futures.emplace_back(
+            std::async(std::launch::async, worker, std::cref(*bl)));
+    }
+
+    // Wait for every worker before rethrowing any failure, so no worker
+    // outlives the state it references.
+    std::exception_ptr error;
+    try
+    {
+        worker(*this);
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+        nextLevel = numLevels;
+    }
+    for (auto& f : futures)
+    {
+        f.wait();
+    }
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+    for (auto& f : futures)
+    {
+        f.get();
+    }
+}
+
+void
+SearchableLiveBucketListSnapshot::scanForLiveEntriesOfType(
+    LedgerEntryType type,
+    std::function<Loop(LedgerEntry const&)> callback) const
+{
+    ZoneScoped;
+    releaseAssert(mSnapshot);
+    UnorderedSet<LedgerKey> seenKeys;
+    auto f = [type, &seenKeys, &callback](auto const& b) {
+        return b.scanForLiveEntriesOfType(type, seenKeys, callback);
+    };
+    loopAllBuckets(f, *mSnapshot);
+}
+
+bool
+SearchableLiveBucketListSnapshot::scanLiveEntriesInRange(
+    LedgerKey const& start, std::function<bool(LedgerKey const&)> inRange,
+    std::optional<uint32_t> ledgerSeq,
+    std::function<Loop(LedgerEntry const&)> callback) const
+{
+    ZoneScoped;
+    releaseAssert(mSnapshot);
+    auto snapshot =
+        ledgerSeq ? getSnapshotForLedger(*ledgerSeq) : mSnapshot.get();
+    if (!snapshot)
+    {
+        return false;
+    }
+
+    // Where each bucket is in the scan. age is the bucket's position in the
+    // BucketList, 0 being the newest, so that of several versions of a key the
+    // one with the lowest age is current.
+    struct Cursor
+    {
+        LiveBucketSnapshot const* bucket;
+        size_t age;
+        BucketEntry entry;
+        LedgerKey key;
+
+        // Moves to the next entry not less than start, false at the end
+        bool
+        advance(LedgerKey const& start)
+        {
+            while (bucket->readNextEntry(entry))
+            {
+                key = getBucketLedgerKey(entry);
+                if (!LedgerEntryIdCmp{}(key, start))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    std::vector<Cursor> cursors;
+    loopAllBuckets(
+        [&](LiveBucketSnapshot const& b) {
+            b.seekToKey(start);
+            Cursor c{&b, cursors.size(), {}, {}};
+            if (c.advance(start))
+            {
+                cursors.emplace_back(std::move(c));
+            }
+            return Loop::INCOMPLETE;
+        },
+        *snapshot);
+
+    // Min-heap of cursors by (key, age)
+    auto later = [&cursors](size_t a, size_t b) {
+        auto const& ca = cursors[a];
+        auto const& cb = cursors[b];
+        if (LedgerEntryIdCmp{}(cb.key, ca.key))
+        {
+            return true;
+        }
+        if (LedgerEntryIdCmp{}(ca.key, cb.key))
+        {
+            return false;
+        }
+        return ca.age > cb.age;
+    };
+    std::vector<size_t> heap(cursors.size());
+    for (size_t i = 0; i < heap.size(); ++i)
+    {
+        heap[i] = i;
+    }
+    std::make_heap(heap.begin(), heap.end(), later);
+
+    while (!heap.empty())
+    {
+        auto& newest = cursors[heap.front()];
+        if (!inRange(newest.key))
+        {
+            break;
+        }
+
+        if (newest.entry.type() != DEADENTRY &&
+            callback(newest.entry.liveEntry()) == Loop::COMPLETE)
+        {
+            break;
+        }
+
+        // Move every bucket holding a version of this key past it
+        LedgerKey const key = newest.key;
+        while (!heap.empty() &&
+               !LedgerEntryIdCmp{}(key, cursors[heap.front()].key))
+        {
+            std::pop_heap(heap.begin(), heap.end(), later);
+            if (cursors[heap.back()].advance(start))
+            {
+                std::push_heap(heap.begin(), heap.end(), later);
+            }
+            else
+            {
+                heap.pop_back();
+            }
+        }
+    }
+    return true;
+}
+
 // This query has two steps:
 //  1. For each bucket, determine what PoolIDs contain the target asset via the
-//     assetToPoolID index
+//     assetToPoolID index, and what PoolIDs the account holds pool share
+//     trustlines for via the accountToPoolID index
 //  2. Perform a bulk lookup for all possible trustline keys, that is, all
-//     trustlines with the given accountID and poolID from step 1
+//     trustlines with the given accountID and a poolID found by both indexes
+//     in step 1
+// The pool entry and the account's trustline for it are usually in different
+// buckets, so the intersection can only be taken once every bucket has been
+// visited.
 std::vector<LedgerEntry>
 SearchableLiveBucketListSnapshot::loadPoolShareTrustLinesByAccountAndAsset(
     AccountID const& accountID, Asset const& asset) const
@@ -105,31 +491,45 @@ SearchableLiveBucketListSnapshot::loadPoolShareTrustLinesByAccountAndAsset(
     // This query should only be called during TX apply
     releaseAssert(mSnapshot);
 
-    LedgerKeySet trustlinesToLoad;
+    std::set<PoolID> assetPoolIDs;
+    std::set<PoolID> accountPoolIDs;
 
-    auto trustLineLoop = [&](auto const& rawB) {
+    auto poolIDLoop = [&](auto const& rawB) {
         auto const& b = static_cast<LiveBucketSnapshot const&>(rawB);
-        for (auto const& poolID : b.getPoolIDsByAsset(asset))
-        {
-            LedgerKey trustlineKey(TRUSTLINE);
-            trustlineKey.trustLine().accountID = accountID;
-            trustlineKey.trustLine().asset.type(ASSET_TYPE_POOL_SHARE);
-            trustlineKey.trustLine().asset.liquidityPoolID() = poolID;
-            trustlinesToLoad.emplace(trustlineKey);
-        }
+        auto const& byAsset = b.getPoolIDsByAsset(asset);
+        assetPoolIDs.insert(byAsset.begin(), byAsset.end());
+        auto const& byAccount = b.getPoolIDsByAccount(accountID);
+        accountPoolIDs.insert(byAccount.begin(), byAccount.end());
 
         return Loop::INCOMPLETE; // continue
     };
 
-    loopAllBuckets(trustLineLoop, *mSnapshot);
+    loopAllBuckets(poolIDLoop, *mSnapshot);
+
+    LedgerKeySet trustlinesToLoad;
+    for (auto const& poolID : accountPoolIDs)
+    {
+        if (assetPoolIDs.find(poolID) == assetPoolIDs.end())
+        {
+            continue;
+        }
+
+        LedgerKey trustlineKey(TRUSTLINE);
+        trustlineKey.trustLine().accountID = accountID;
+        trustlineKey.trustLine().asset.type(ASSET_TYPE_POOL_SHARE);
+        trustlineKey.trustLine().asset.liquidityPoolID() = poolID;
+        trustlinesToLoad.emplace(trustlineKey);
+    }
 
     auto timer =
         getBulkLoadTimer("poolshareTrustlines", trustlinesToLoad.size())
             .TimeScope();
 
     std::vector<LedgerEntry> result;
+    bool const batchReads =
+        mAppConnector.getConfig().BUCKETLIST_DB_BATCHED_READS;
     auto loadKeysLoop = [&](auto const& b) {
-        b.loadKeys(trustlinesToLoad, result);
+        b.loadKeys(trustlinesToLoad, result, batchReads);
         return trustlinesToLoad.empty() ? Loop::COMPLETE : Loop::INCOMPLETE;
     };
 
@@ -239,23 +639,64 @@ SearchableLiveBucketListSnapshot::loadKeys(
     return std::move(*op);
 }
 
+std::optional<BucketEntryView>
+SearchableLiveBucketListSnapshot::loadView(LedgerKey const& k) const
+{
+    ZoneScoped;
+
+    std::optional<BucketEntryView> result;
+    auto startTime = mAppConnector.now();
+
+    auto loadViewBucketLoop = [&](LiveBucketSnapshot const& b,
+                                  uint32_t level) {
+        auto [view, bloomMiss] = b.getBucketEntryView(k);
+        if (bloomMiss)
+        {
+            // Same as load, only measure disk performance
+            startTime = mAppConnector.now();
+        }
+
+        if (view)
+        {
+            markLevelHits(level, 1);
+            if (view->isLive())
+            {
+                result = std::move(view);
+            }
+            return Loop::COMPLETE;
+        }
+        return Loop::INCOMPLETE;
+    };
+
+    auto numLevels = static_cast<uint32_t>(mSnapshot->getLevels().size());
+    if (mBucketListFilter && !mayBeInFilteredLevels(k))
+    {
+        numLevels = mBucketListFilter->getFirstLevel();
+    }
+
+    loopBucketsByLevel(loadViewBucketLoop, *mSnapshot, 0, numLevels);
+    recordPointLoad(k.type(), startTime);
+    return result;
+}
+
 SearchableLiveBucketListSnapshot::SearchableLiveBucketListSnapshot(
     BucketSnapshotManager const& snapshotManager,
     AppConnector const& appConnector, SnapshotPtrT<LiveBucket>&& snapshot,
-    std::map<uint32_t, SnapshotPtrT<LiveBucket>>&& historicalSnapshots)
+    HistoricalSnapshotsT<LiveBucket> historicalSnapshots,
+    std::shared_ptr<LiveBucketListFilter const> bucketListFilter)
     : SearchableBucketListSnapshotBase<LiveBucket>(
           snapshotManager, appConnector, std::move(snapshot),
-          std::move(historicalSnapshots))
+          std::move(historicalSnapshots), std::move(bucketListFilter))
 {
 }
 
 SearchableHotArchiveBucketListSnapshot::SearchableHotArchiveBucketListSnapshot(
     BucketSnapshotManager const& snapshotManager,
     AppConnector const& appConnector, SnapshotPtrT<HotArchiveBucket>&& snapshot,
-    std::map<uint32_t, SnapshotPtrT<HotArchiveBucket>>&& historicalSnapshots)
+    HistoricalSnapshotsT<HotArchiveBucket> historicalSnapshots)
     : SearchableBucketListSnapshotBase<HotArchiveBucket>(
           snapshotManager, appConnector, std::move(snapshot),
-          std::move(historicalSnapshots))
+          std::move(historicalSnapshots), nullptr)
 {
 }
 
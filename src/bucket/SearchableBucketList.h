@@ -16,7 +16,19 @@ class SearchableLiveBucketListSnapshot
     SearchableLiveBucketListSnapshot(
         BucketSnapshotManager const& snapshotManager,
         AppConnector const& appConnector, SnapshotPtrT<LiveBucket>&& snapshot,
-        std::map<uint32_t, SnapshotPtrT<LiveBucket>>&& historicalSnapshots);
+        HistoricalSnapshotsT<LiveBucket> historicalSnapshots,
+        std::shared_ptr<LiveBucketListFilter const> bucketListFilter);
+
+    // Splits the eviction scan region starting at evictionIter into chunks
+    // bounded by index pages and scans them across numThreads threads,
+    // writing the same candidates and end iterator a serial scan would
+    // produce to result.
+    void scanForEvictionParallel(uint32_t ledgerSeq, EvictionCounters& counters,
+                                 EvictionIterator evictionIter,
+                                 std::shared_ptr<EvictionStatistics> stats,
+                                 StateArchivalSettings const& sas,
+                                 uint32_t ledgerVers, uint32_t numThreads,
+                                 EvictionResultCandidates& result) const;
 
   public:
     std::vector<LedgerEntry>
@@ -30,6 +42,11 @@ class SearchableLiveBucketListSnapshot
     loadKeys(std::set<LedgerKey, LedgerEntryIdCmp> const& inKeys,
              std::string const& label) const;
 
+    // Same as load, but returns a view over the XDR of the entry, for
+    // read-only callers that only need a few of its fields. Returns nullopt
+    // if the entry doesn't exist.
+    std::optional<BucketEntryView> loadView(LedgerKey const& k) const;
+
     std::unique_ptr<EvictionResultCandidates> scanForEviction(
         uint32_t ledgerSeq, EvictionCounters& counters, EvictionIterator iter,
         std::shared_ptr<EvictionStatistics> stats,
@@ -39,6 +56,33 @@ class SearchableLiveBucketListSnapshot
         LedgerEntryType type,
         std::function<Loop(BucketEntry const&)> callback) const;
 
+    // Same as scanForEntriesOfType, but bucket levels are scanned in parallel
+    // on up to numThreads threads. callback is passed the level each entry was
+    // found in and may be called concurrently for different levels. All
+    // entries of one level are passed from a single thread, newest first.
+    void scanForEntriesOfTypeByLevel(
+        LedgerEntryType type, uint32_t numThreads,
+        std::function<void(BucketEntry const&, uint32_t)> callback) const;
+
+    // Calls callback on the newest version of every live entry of the given
+    // type. Unlike scanForEntriesOfType, shadowed versions and deleted
+    // entries are not passed to the callback.
+    void scanForLiveEntriesOfType(
+        LedgerEntryType type,
+        std::function<Loop(LedgerEntry const&)> callback) const;
+
+    // Calls callback, in key order, on the newest version of every live entry
+    // whose key is not less than start, stopping at the first key (of a live
+    // or dead entry) for which inRange is false or when callback returns
+    // Loop::COMPLETE. Each bucket is read from the index page where start
+    // would be and the buckets are merged by key, so a scan that stops early
+    // reads little more than it returns. Scans the BucketList at the start of
+    // ledgerSeq if set, and returns false if that snapshot isn't retained.
+    bool scanLiveEntriesInRange(
+        LedgerKey const& start, std::function<bool(LedgerKey const&)> inRange,
+        std::optional<uint32_t> ledgerSeq,
+        std::function<Loop(LedgerEntry const&)> callback) const;
+
     friend SearchableSnapshotConstPtr
     BucketSnapshotManager::copySearchableLiveBucketListSnapshot(
         SharedLockShared const& guard) const;
@@ -51,8 +95,7 @@ class SearchableHotArchiveBucketListSnapshot
         BucketSnapshotManager const& snapshotManager,
         AppConnector const& appConnector,
         SnapshotPtrT<HotArchiveBucket>&& snapshot,
-        std::map<uint32_t, SnapshotPtrT<HotArchiveBucket>>&&
-            historicalSnapshots);
+        HistoricalSnapshotsT<HotArchiveBucket> historicalSnapshots);
 
   public:
     std::vector<HotArchiveBucketEntry>
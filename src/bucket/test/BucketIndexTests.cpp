@@ -10,23 +10,37 @@
 #include "bucket/BucketManager.h"
 #include "bucket/BucketSnapshotManager.h"
 #include "bucket/BucketUtils.h"
+#include "bucket/HotArchiveBucketList.h"
 #include "bucket/LiveBucket.h"
 #include "bucket/LiveBucketList.h"
 #include "bucket/test/BucketTestUtils.h"
+#include "ledger/InMemorySorobanState.h"
 #include "ledger/LedgerTypeUtils.h"
+#include "ledger/NetworkConfig.h"
+#include "ledger/SorobanMetrics.h"
 #include "ledger/test/LedgerTestUtils.h"
 #include "main/Application.h"
 #include "main/Config.h"
 #include "test/Catch2.h"
 #include "test/test.h"
 
+#include "util/BlockCompressedFile.h"
 #include "util/GlobalChecks.h"
+#include "util/HdrHistogram.h"
 #include "util/UnorderedMap.h"
 #include "util/UnorderedSet.h"
 #include "util/XDRCereal.h"
 #include "util/types.h"
 #include "xdr/Stellar-ledger-entries.h"
 
+#include <algorithm>
+#include <chrono>
+#include <fmt/format.h>
+#include <medida/counter.h>
+#include <medida/meter.h>
+#include <medida/metrics_registry.h>
+#include <thread>
+
 using namespace stellar;
 using namespace BucketTestUtils;
 
@@ -229,20 +243,29 @@ class BucketIndexTest
         // is at most N - 1.
         REQUIRE(currentLoadedEntry->lastModifiedLedgerSeq == ledger - 1);
 
-        for (uint32_t currLedger = ledger; currLedger > 0; --currLedger)
+        // Historical snapshots are copied on first use, so the second pass
+        // reads from the copies made during the first
+        for (int pass = 0; pass < 2; ++pass)
         {
-            auto loadRes = searchableBL->loadKeysFromLedger({lk}, currLedger);
-
-            // If we query an older snapshot, should return <null, notFound>
-            if (currLedger < ledger - mApp->getConfig().QUERY_SNAPSHOT_LEDGERS)
-            {
-                REQUIRE(!loadRes);
-            }
-            else
+            for (uint32_t currLedger = ledger; currLedger > 0; --currLedger)
             {
-                REQUIRE(loadRes);
-                REQUIRE(loadRes->size() == 1);
-                REQUIRE(loadRes->at(0).lastModifiedLedgerSeq == currLedger - 1);
+                auto loadRes =
+                    searchableBL->loadKeysFromLedger({lk}, currLedger);
+
+                // If we query an older snapshot, should return <null,
+                // notFound>
+                if (currLedger <
+                    ledger - mApp->getConfig().QUERY_SNAPSHOT_LEDGERS)
+                {
+                    REQUIRE(!loadRes);
+                }
+                else
+                {
+                    REQUIRE(loadRes);
+                    REQUIRE(loadRes->size() == 1);
+                    REQUIRE(loadRes->at(0).lastModifiedLedgerSeq ==
+                            currLedger - 1);
+                }
             }
         }
     }
@@ -607,6 +630,76 @@ class BucketIndexTest
         }
     }
 
+    // Checks that views over the entries match their decoded contents
+    void
+    testEntryViews()
+    {
+        auto searchableBL = getBM()
+                                .getBucketSnapshotManager()
+                                .copySearchableLiveBucketListSnapshot();
+        for (auto const& k : mKeysToSearch)
+        {
+            auto view = searchableBL->loadView(k);
+            auto iter = mTestEntries.find(k);
+            if (iter == mTestEntries.end())
+            {
+                REQUIRE(!view);
+                continue;
+            }
+
+            REQUIRE(view);
+            auto const& le = iter->second;
+            REQUIRE(view->isLive());
+            REQUIRE(view->decode().liveEntry() == le);
+            REQUIRE(view->type() == le.data.type());
+            REQUIRE(view->lastModifiedLedgerSeq() == le.lastModifiedLedgerSeq);
+            switch (le.data.type())
+            {
+            case ACCOUNT:
+                REQUIRE(view->balance() == le.data.account().balance);
+                REQUIRE(view->seqNum() == le.data.account().seqNum);
+                REQUIRE(view->flags() == le.data.account().flags);
+                break;
+            case TRUSTLINE:
+                REQUIRE(view->balance() == le.data.trustLine().balance);
+                REQUIRE(view->flags() == le.data.trustLine().flags);
+                break;
+            case TTL:
+                REQUIRE(view->liveUntilLedgerSeq() ==
+                        le.data.ttl().liveUntilLedgerSeq);
+                break;
+            default:
+                break;
+            }
+        }
+
+        auto keysNotInBL =
+            LedgerTestUtils::generateValidUniqueLedgerKeysWithTypes(
+                {ACCOUNT, TRUSTLINE, DATA, CLAIMABLE_BALANCE, LIQUIDITY_POOL},
+                10, mGeneratedKeys);
+        for (auto const& key : keysNotInBL)
+        {
+            REQUIRE(!searchableBL->loadView(key));
+        }
+    }
+
+    // Waits for the background build of the combined filter over the deeper
+    // levels of the current BucketList
+    void
+    waitForBucketListFilter()
+    {
+        auto& snapshotManager = getBM().getBucketSnapshotManager();
+        for (int i = 0; i < 1000; ++i)
+        {
+            if (snapshotManager.hasCurrentLiveBucketListFilter())
+            {
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        REQUIRE(snapshotManager.hasCurrentLiveBucketListFilter());
+    }
+
     void
     restartWithConfig(Config const& cfg)
     {
@@ -791,6 +884,40 @@ testAllIndexTypes(std::function<void(Config&)> f)
         cfg.BUCKETLIST_DB_INDEX_CUTOFF = 0;
         f(cfg);
     }
+
+    SECTION("range index only with batched reads")
+    {
+        Config cfg(getTestConfig());
+        cfg.BUCKETLIST_DB_INDEX_CUTOFF = 0;
+        cfg.BUCKETLIST_DB_BATCHED_READS = true;
+        f(cfg);
+    }
+
+    SECTION("range index only with memory-mapped buckets")
+    {
+        Config cfg(getTestConfig());
+        cfg.BUCKETLIST_DB_INDEX_CUTOFF = 0;
+        cfg.BUCKETLIST_DB_MMAP_BUCKETS = true;
+        f(cfg);
+    }
+
+    SECTION("range index with in-memory promotion")
+    {
+        Config cfg(getTestConfig());
+        cfg.BUCKETLIST_DB_INDEX_CUTOFF = 0;
+        cfg.BUCKETLIST_DB_INDEX_MEMORY_BUDGET = 1;
+        f(cfg);
+    }
+
+#ifdef USE_ZLIB
+    SECTION("range index only with compressed buckets")
+    {
+        Config cfg(getTestConfig());
+        cfg.BUCKETLIST_DB_INDEX_CUTOFF = 0;
+        cfg.BUCKETLIST_DB_COMPRESS_BUCKETS = true;
+        f(cfg);
+    }
+#endif
 }
 
 TEST_CASE("key-value lookup", "[bucket][bucketindex]")
@@ -800,11 +927,59 @@ TEST_CASE("key-value lookup", "[bucket][bucketindex]")
         test.buildGeneralTest();
         test.run();
         test.testInvalidKeys();
+        test.testEntryViews();
     };
 
     testAllIndexTypes(f);
 }
 
+#ifdef USE_ZLIB
+TEST_CASE("compressed bucket files", "[bucket][bucketindex]")
+{
+    Config cfg(getTestConfig());
+    cfg.BUCKETLIST_DB_INDEX_CUTOFF = 0;
+    cfg.BUCKETLIST_DB_COMPRESS_BUCKETS = true;
+    auto test = BucketIndexTest(cfg);
+    test.buildGeneralTest();
+    test.run();
+
+    // Buckets are stored compressed but still read, and hash, as the
+    // original bucket
+    size_t compressed = 0;
+    auto& liveBL = test.getBM().getLiveBucketList();
+    for (uint32_t i = 0; i < LiveBucketList::kNumLevels; ++i)
+    {
+        auto level = liveBL.getLevel(i);
+        for (auto const& b : {level.getCurr(), level.getSnap()})
+        {
+            if (b->isEmpty())
+            {
+                continue;
+            }
+            auto table =
+                BlockCompressedFile::readTable(b->getFilename().string());
+            if (!table)
+            {
+                continue;
+            }
+            ++compressed;
+            REQUIRE(b->getSize() == table->rawSize);
+
+            SHA256 hasher;
+            XDRInputFileStream in;
+            in.open(b->getFilename());
+            BucketEntry be;
+            while (in.readOne(be, &hasher))
+            {
+            }
+            REQUIRE(static_cast<size_t>(in.pos()) == b->getSize());
+            REQUIRE(hasher.finish() == b->getHash());
+        }
+    }
+    REQUIRE(compressed > 0);
+}
+#endif
+
 TEST_CASE("bl cache", "[bucket][bucketindex]")
 {
     SECTION("disable cache")
@@ -915,6 +1090,94 @@ TEST_CASE("do not load outdated values", "[bucket][bucketindex]")
     testAllIndexTypes(f);
 }
 
+TEST_CASE("bucketlist combined filter", "[bucket][bucketindex]")
+{
+    Config cfg(getTestConfig());
+    cfg.BUCKETLIST_DB_INDEX_CUTOFF = 0;
+    cfg.BUCKETLIST_DB_COMBINED_FILTER_LEVEL = 3;
+
+    auto test = BucketIndexTest(cfg);
+    test.buildMultiVersionTest();
+    test.waitForBucketListFilter();
+
+    auto& metrics = test.getApp().getMetrics();
+    auto& lookups = metrics.NewMeter(
+        {LiveBucket::METRIC_STRING, "bloom", "bucketlist-lookups"}, "bloom");
+    auto& absent = metrics.NewMeter(
+        {LiveBucket::METRIC_STRING, "bloom", "bucketlist-absent"}, "bloom");
+
+    // Live keys and tombstones in the covered levels must still be found
+    auto startingLookups = lookups.count();
+    test.run();
+    REQUIRE(lookups.count() > startingLookups);
+
+    // Keys that were never created should skip the covered levels
+    auto startingAbsent = absent.count();
+    test.testInvalidKeys();
+    REQUIRE(absent.count() > startingAbsent);
+}
+
+TEST_CASE("index memory budget", "[bucket][bucketindex]")
+{
+    VirtualClock clock;
+    Config cfg(getTestConfig());
+
+    // Every bucket is above the cutoff
+    cfg.BUCKETLIST_DB_INDEX_CUTOFF = 0;
+    cfg.BUCKETLIST_DB_INDEX_MEMORY_BUDGET = GENERATE(0, 100);
+    auto app = createTestApplication<BucketTestApplication>(clock, cfg);
+
+    for (uint32_t ledger = 0; ledger < 16; ++ledger)
+    {
+        auto entries =
+            LedgerTestUtils::generateValidUniqueLedgerEntriesWithTypes(
+                {ACCOUNT, TRUSTLINE}, 10);
+        app->getLedgerManager().setNextLedgerEntryBatchForBucketTesting(
+            {}, entries, {});
+        closeLedger(*app);
+    }
+
+    auto& bm = app->getBucketManager();
+    auto& bl = bm.getLiveBucketList();
+    size_t totalBytes = 0;
+    for (uint32_t i = 0; i < LiveBucketList::kNumLevels; ++i)
+    {
+        uint64_t levelBytes = 0;
+        auto const& level = bl.getLevel(i);
+        for (auto const& b : {level.getCurr(), level.getSnap()})
+        {
+            if (b->isEmpty())
+            {
+                REQUIRE(b->getIndexMemoryUsage() == 0);
+                continue;
+            }
+
+            REQUIRE(b->getIndexMemoryUsage() > 0);
+            levelBytes += b->getIndexMemoryUsage();
+
+            // Small buckets fit in the budget, so they are promoted. Level 0
+            // buckets are merged in memory and always indexed in memory.
+            if (i != 0)
+            {
+                bool inMemory = b->getIndex().getPageSize() == 0;
+                REQUIRE(inMemory ==
+                        (cfg.BUCKETLIST_DB_INDEX_MEMORY_BUDGET != 0));
+            }
+        }
+
+        REQUIRE(app->getMetrics()
+                    .NewCounter({"bucketlistDB", "index-memory",
+                                 fmt::format("level-{}", i)})
+                    .count() == levelBytes);
+        totalBytes += levelBytes;
+    }
+
+    REQUIRE(totalBytes > 0);
+    REQUIRE(app->getMetrics()
+                .NewCounter({"bucketlistDB", "index-memory", "total"})
+                .count() == totalBytes);
+}
+
 TEST_CASE("bucket entry counters", "[bucket][bucketindex]")
 {
     // Initialize global counter for all of bucketlist
@@ -1095,7 +1358,9 @@ TEST_CASE("in-memory index construction", "[bucket][bucketindex]")
 
 TEST_CASE("soroban cache population", "[soroban][bucketindex]")
 {
+    auto loadThreads = GENERATE(1u, 4u);
     auto f = [&](Config& cfg) {
+        cfg.SOROBAN_STATE_LOAD_THREADS = loadThreads;
         auto test = BucketIndexTest(cfg);
         test.buildMultiVersionTest(/*sorobanOnly=*/true);
         test.run();
@@ -1114,7 +1379,7 @@ TEST_CASE("soroban cache population", "[soroban][bucketindex]")
 
             // First, test that the cache is maintained correctly via `addBatch`
             REQUIRE(codeEntries.size() ==
-                    inMemorySorobanState.mContractCodeEntries.size());
+                    inMemorySorobanState.getContractCodeEntryCount());
             for (auto const& [k, v] : codeEntries)
             {
                 auto inMemoryEntry = inMemorySorobanState.get(k);
@@ -1134,7 +1399,7 @@ TEST_CASE("soroban cache population", "[soroban][bucketindex]")
             }
 
             REQUIRE(dataEntries.size() ==
-                    inMemorySorobanState.mContractDataEntries.size());
+                    inMemorySorobanState.getContractDataEntryCount());
             for (auto const& [k, v] : dataEntries)
             {
                 auto inMemoryEntry = inMemorySorobanState.get(k);
@@ -1169,6 +1434,232 @@ TEST_CASE("soroban cache population", "[soroban][bucketindex]")
     testAllIndexTypes(f);
 }
 
+TEST_CASE("in-memory soroban state sharded updates", "[soroban][bucketindex]")
+{
+    SorobanNetworkConfig sorobanConfig;
+    LedgerHeader lh;
+    lh.ledgerVersion = Config::CURRENT_LEDGER_PROTOCOL_VERSION;
+
+    auto makeTTL = [](LedgerEntry const& e, uint32_t liveUntil) {
+        LedgerEntry ttl;
+        ttl.lastModifiedLedgerSeq = 1;
+        ttl.data.type(TTL);
+        ttl.data.ttl().keyHash = getTTLKey(e).ttl().keyHash;
+        ttl.data.ttl().liveUntilLedgerSeq = liveUntil;
+        return ttl;
+    };
+
+    // Write each TTL before its data entry so that both paths have to adopt
+    // pending TTLs in order
+    auto dataEntries =
+        LedgerTestUtils::generateValidUniqueLedgerEntriesWithTypes(
+            {CONTRACT_DATA}, InMemorySorobanState::PARALLEL_UPDATE_MIN_ENTRIES);
+    std::vector<LedgerEntry> initEntries;
+    for (auto const& e : dataEntries)
+    {
+        initEntries.emplace_back(makeTTL(e, 100));
+        initEntries.emplace_back(e);
+    }
+
+    // Apply everything in one ledger, which updates shards in parallel
+    InMemorySorobanState parallel;
+    lh.ledgerSeq = 1;
+    parallel.updateState(initEntries, {}, {}, lh, &sorobanConfig);
+
+    // Apply the same entries in small batches, which updates shards serially
+    InMemorySorobanState serial;
+    size_t const batchSize = 100;
+    for (size_t i = 0; i < initEntries.size(); i += batchSize)
+    {
+        auto end = std::min(i + batchSize, initEntries.size());
+        std::vector<LedgerEntry> batch(initEntries.begin() + i,
+                                       initEntries.begin() + end);
+        lh.ledgerSeq = serial.getLedgerSeq() + 1;
+        serial.updateState(batch, {}, {}, lh, &sorobanConfig);
+    }
+
+    REQUIRE(parallel.getContractDataEntryCount() == dataEntries.size());
+    REQUIRE(serial.getContractDataEntryCount() == dataEntries.size());
+    REQUIRE(parallel.getSize() == serial.getSize());
+    for (auto const& e : initEntries)
+    {
+        auto k = LedgerEntryKey(e);
+        auto fromParallel = parallel.get(k);
+        auto fromSerial = serial.get(k);
+        REQUIRE(fromParallel);
+        REQUIRE(fromSerial);
+        REQUIRE(*fromParallel == *fromSerial);
+    }
+
+    // Bump every TTL and delete every other entry in a single ledger
+    std::vector<LedgerEntry> liveEntries;
+    std::vector<LedgerKey> deadEntries;
+    uint64_t expectedSize = 0;
+    for (size_t i = 0; i < dataEntries.size(); ++i)
+    {
+        liveEntries.emplace_back(makeTTL(dataEntries[i], 200));
+        if (i % 2 == 0)
+        {
+            deadEntries.emplace_back(LedgerEntryKey(dataEntries[i]));
+        }
+        else
+        {
+            expectedSize += xdr::xdr_size(dataEntries[i]);
+        }
+    }
+
+    lh.ledgerSeq = 2;
+    parallel.updateState({}, liveEntries, deadEntries, lh, &sorobanConfig);
+    REQUIRE(parallel.getSize() == expectedSize);
+    REQUIRE(parallel.getContractDataEntryCount() == dataEntries.size() / 2);
+    for (size_t i = 0; i < dataEntries.size(); ++i)
+    {
+        auto k = LedgerEntryKey(dataEntries[i]);
+        auto ttl = parallel.get(getTTLKey(k));
+        if (i % 2 == 0)
+        {
+            REQUIRE(!parallel.get(k));
+            REQUIRE(!ttl);
+        }
+        else
+        {
+            REQUIRE(*parallel.get(k) == dataEntries[i]);
+            REQUIRE(ttl);
+            REQUIRE(ttl->data.ttl().liveUntilLedgerSeq == 200);
+        }
+    }
+
+    // Resize the remaining entries; the state size follows the new entries
+    liveEntries.clear();
+    expectedSize = 0;
+    for (size_t i = 1; i < dataEntries.size(); i += 2)
+    {
+        auto e = dataEntries[i];
+        e.data.contractData().val.type(SCV_BYTES);
+        e.data.contractData().val.bytes().resize(i % 64);
+        liveEntries.emplace_back(e);
+        expectedSize += xdr::xdr_size(e);
+    }
+    lh.ledgerSeq = 3;
+    parallel.updateState({}, liveEntries, {}, lh, &sorobanConfig);
+    REQUIRE(parallel.getSize() == expectedSize);
+
+    // Memory overhead is reported for the entries still held
+    medida::MetricsRegistry registry;
+    HdrMetricsRegistry hdrRegistry;
+    SorobanMetrics metrics(registry, hdrRegistry);
+    parallel.reportMetrics(metrics);
+    auto parallelOverhead = metrics.mInMemoryStateOverheadBytes.count();
+    serial.reportMetrics(metrics);
+    REQUIRE(parallelOverhead > 0);
+    REQUIRE(metrics.mInMemoryStateOverheadBytes.count() > parallelOverhead);
+}
+
+TEST_CASE("in-memory soroban state TTL index", "[soroban][bucketindex]")
+{
+    SorobanNetworkConfig sorobanConfig;
+    LedgerHeader lh;
+    lh.ledgerVersion = Config::CURRENT_LEDGER_PROTOCOL_VERSION;
+
+    auto makeTTL = [](LedgerEntry const& e, uint32_t liveUntil) {
+        LedgerEntry ttl;
+        ttl.lastModifiedLedgerSeq = 1;
+        ttl.data.type(TTL);
+        ttl.data.ttl().keyHash = getTTLKey(e).ttl().keyHash;
+        ttl.data.ttl().liveUntilLedgerSeq = liveUntil;
+        return ttl;
+    };
+
+    // Entry i lives until ledger 10 + i % 50
+    auto entries = LedgerTestUtils::generateValidUniqueLedgerEntriesWithTypes(
+        {CONTRACT_DATA}, 500);
+    std::vector<LedgerEntry> initEntries;
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        initEntries.emplace_back(entries[i]);
+        initEntries.emplace_back(makeTTL(entries[i], 10 + i % 50));
+    }
+
+    InMemorySorobanState state(/* indexTTLs */ true);
+    REQUIRE(state.hasTTLIndex());
+    lh.ledgerSeq = 1;
+    state.updateState(initEntries, {}, {}, lh, &sorobanConfig);
+
+    // Expired entries come in TTL and then key hash order, whatever their
+    // shard
+    auto checkExpired = [&](uint32_t ledgerSeq) {
+        std::vector<std::pair<uint32_t, uint256>> expected;
+        for (auto const& e : entries)
+        {
+            auto ttl = state.get(getTTLKey(e));
+            if (ttl && ttl->data.ttl().liveUntilLedgerSeq < ledgerSeq)
+            {
+                expected.emplace_back(ttl->data.ttl().liveUntilLedgerSeq,
+                                      ttl->data.ttl().keyHash);
+            }
+        }
+        std::sort(expected.begin(), expected.end());
+
+        auto expired = state.getExpiredEntries(ledgerSeq, entries.size());
+        REQUIRE(expired.size() == expected.size());
+        std::vector<LedgerKey> keys;
+        for (size_t i = 0; i < expired.size(); ++i)
+        {
+            auto ttlKey = getTTLKey(*expired[i]);
+            REQUIRE(ttlKey.ttl().keyHash == expected[i].second);
+            REQUIRE(state.get(ttlKey)->data.ttl().liveUntilLedgerSeq ==
+                    expected[i].first);
+            keys.emplace_back(LedgerEntryKey(*expired[i]));
+        }
+        REQUIRE_NOTHROW(state.checkEvictedEntries(keys, ledgerSeq));
+
+        auto limited = state.getExpiredEntries(ledgerSeq, 7);
+        REQUIRE(limited.size() == std::min<size_t>(7, expired.size()));
+        for (size_t i = 0; i < limited.size(); ++i)
+        {
+            REQUIRE(limited[i] == expired[i]);
+        }
+    };
+    checkExpired(10);
+    checkExpired(35);
+    checkExpired(100);
+
+    // Extend every third entry, delete every fifth one
+    std::vector<LedgerEntry> liveEntries;
+    std::vector<LedgerKey> deadEntries;
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        if (i % 5 == 0)
+        {
+            deadEntries.emplace_back(LedgerEntryKey(entries[i]));
+            deadEntries.emplace_back(getTTLKey(entries[i]));
+        }
+        else if (i % 3 == 0)
+        {
+            liveEntries.emplace_back(makeTTL(entries[i], 1000));
+        }
+    }
+    lh.ledgerSeq = 2;
+    state.updateState({}, liveEntries, deadEntries, lh, &sorobanConfig);
+    checkExpired(35);
+    checkExpired(100);
+
+    // Entries that are still live, or gone, can't have been evicted
+    auto live = std::find_if(entries.begin(), entries.end(), [&](auto& e) {
+        auto ttl = state.get(getTTLKey(e));
+        return ttl && ttl->data.ttl().liveUntilLedgerSeq >= 100;
+    });
+    REQUIRE(live != entries.end());
+    REQUIRE_THROWS(state.checkEvictedEntries({LedgerEntryKey(*live)}, 100));
+    REQUIRE_THROWS(
+        state.checkEvictedEntries({LedgerEntryKey(entries[0])}, 100));
+
+    // The index is kept on reload
+    state.clearForTesting();
+    REQUIRE(state.hasTTLIndex());
+    REQUIRE(state.getExpiredEntries(100, entries.size()).empty());
+}
+
 TEST_CASE("load from historical snapshots", "[bucket][bucketindex]")
 {
     auto f = [&](Config& cfg) {
@@ -1204,6 +1695,81 @@ TEST_CASE(
     testAllIndexTypes(f);
 }
 
+TEST_CASE("pool share trustlines indexed by account", "[bucket][bucketindex]")
+{
+    auto test = [](Config& cfg) {
+        VirtualClock clock;
+        auto app = createTestApplication(clock, cfg);
+        auto& bm = app->getBucketManager();
+        auto vers = getAppLedgerVersion(app);
+
+        auto makeTrustline = [](AccountID const& accountID,
+                                std::optional<PoolID> poolID) {
+            auto le =
+                LedgerTestUtils::generateValidLedgerEntryOfType(TRUSTLINE);
+            le.data.trustLine().accountID = accountID;
+            if (poolID)
+            {
+                le.data.trustLine().asset.type(ASSET_TYPE_POOL_SHARE);
+                le.data.trustLine().asset.liquidityPoolID() = *poolID;
+            }
+            else
+            {
+                le.data.trustLine().asset.type(ASSET_TYPE_CREDIT_ALPHANUM4);
+                strToAssetCode(
+                    le.data.trustLine().asset.alphaNum4().assetCode, "ast1");
+            }
+            return le;
+        };
+
+        auto account = LedgerTestUtils::generateValidAccountEntry().accountID;
+        auto otherAccount =
+            LedgerTestUtils::generateValidAccountEntry().accountID;
+        PoolID initPool = sha256("init pool");
+        PoolID livePool = sha256("live pool");
+        PoolID deadPool = sha256("dead pool");
+        PoolID otherPool = sha256("other pool");
+
+        std::vector<LedgerEntry> init = {
+            makeTrustline(account, initPool),
+            makeTrustline(account, std::nullopt),
+            makeTrustline(otherAccount, otherPool)};
+        std::vector<LedgerEntry> live = {makeTrustline(account, livePool)};
+        std::vector<LedgerKey> dead = {
+            LedgerEntryKey(makeTrustline(account, deadPool))};
+
+        auto b = LiveBucket::fresh(bm, vers, init, live, dead,
+                                   /*countMergeEvents=*/false,
+                                   clock.getIOContext(), /*doFsync=*/true);
+        auto const& index = b->getIndexForTesting();
+
+        auto poolIDs = index.getPoolIDsByAccount(account);
+        std::sort(poolIDs.begin(), poolIDs.end());
+        std::vector<PoolID> expected = {initPool, livePool};
+        std::sort(expected.begin(), expected.end());
+        REQUIRE(poolIDs == expected);
+
+        REQUIRE(index.getPoolIDsByAccount(otherAccount) ==
+                std::vector<PoolID>{otherPool});
+        auto unknownAccount =
+            LedgerTestUtils::generateValidAccountEntry().accountID;
+        REQUIRE(index.getPoolIDsByAccount(unknownAccount).empty());
+    };
+
+    SECTION("individual index")
+    {
+        Config cfg(getTestConfig());
+        test(cfg);
+    }
+
+    SECTION("range index")
+    {
+        Config cfg(getTestConfig());
+        cfg.BUCKETLIST_DB_INDEX_CUTOFF = 0;
+        test(cfg);
+    }
+}
+
 TEST_CASE("ContractData key with same ScVal", "[bucket][bucketindex]")
 {
     auto f = [&](Config& cfg) {
@@ -1300,6 +1866,25 @@ TEST_CASE("serialize bucket indexes", "[bucket][bucketindex]")
             loadIndex<LiveBucket>(test.getBM(), indexFilename, b->getSize());
         REQUIRE((inMemoryIndex == *onDiskIndex));
     }
+
+    // A truncated index file must fail to load instead of producing a
+    // partially populated index
+    for (auto const& bucketHash : liveBuckets)
+    {
+        if (isZero(bucketHash))
+        {
+            continue;
+        }
+
+        auto b = test.getBM().getBucketByHash<LiveBucket>(bucketHash);
+        auto indexFilename = test.getBM().bucketIndexFilename(bucketHash);
+        auto truncatedSize = std::filesystem::file_size(indexFilename) / 2;
+        std::filesystem::resize_file(indexFilename, truncatedSize);
+        REQUIRE_THROWS_AS(
+            loadIndex<LiveBucket>(test.getBM(), indexFilename, b->getSize()),
+            std::runtime_error);
+        break;
+    }
 }
 
 // The majority of BucketListDB functionality is shared by all bucketlist types.
@@ -1459,6 +2044,104 @@ TEST_CASE("hot archive bucket lookups", "[bucket][bucketindex][archive]")
     testAllIndexTypes(f);
 }
 
+TEST_CASE("hot archive cache", "[bucket][bucketindex][archive]")
+{
+    VirtualClock clock;
+    Config cfg(getTestConfig());
+
+    // Large enough to cache every entry
+    cfg.BUCKETLIST_DB_HOT_ARCHIVE_MEMORY_FOR_CACHING = 1;
+    auto app = createTestApplication<BucketTestApplication>(clock, cfg);
+
+    UnorderedSet<LedgerKey> seenKeys;
+    auto archivedEntries =
+        LedgerTestUtils::generateUniquePersistentLedgerEntries(10, seenKeys);
+
+    auto header = app->getLedgerManager().getLastClosedLedgerHeader().header;
+    header.ledgerSeq += 1;
+    header.ledgerVersion = static_cast<uint32_t>(
+        HotArchiveBucket::FIRST_PROTOCOL_SUPPORTING_PERSISTENT_EVICTION);
+    addHotArchiveBatchAndUpdateSnapshot(*app, header, archivedEntries, {});
+
+    // Move entries out of the top level
+    for (auto i = 0; i < 20; ++i)
+    {
+        header.ledgerSeq += 1;
+        addHotArchiveBatchAndUpdateSnapshot(*app, header, {}, {});
+    }
+
+    auto& hotArchiveBl = app->getBucketManager().getHotArchiveBucketList();
+    auto getCacheSize = [&] {
+        size_t size = 0;
+        for (uint32_t i = 0; i < HotArchiveBucketList::kNumLevels; ++i)
+        {
+            auto const& level = hotArchiveBl.getLevel(i);
+            for (auto const& b : {level.getCurr(), level.getSnap()})
+            {
+                if (!b->isEmpty())
+                {
+                    size += b->getIndexForTesting().getCurrentCacheSize();
+                }
+            }
+        }
+        return size;
+    };
+
+    auto getLevelHits = [&] {
+        uint64_t hits = 0;
+        for (uint32_t i = 0; i < HotArchiveBucketList::kNumLevels; ++i)
+        {
+            hits += app->getMetrics()
+                        .NewMeter({HotArchiveBucket::METRIC_STRING,
+                                   "level-hits", fmt::format("level-{}", i)},
+                                  "entry")
+                        .count();
+        }
+        return hits;
+    };
+
+    auto& hitMeter = app->getBucketManager().getHotArchiveCacheHitMeter();
+    auto& missMeter = app->getBucketManager().getHotArchiveCacheMissMeter();
+    REQUIRE(getCacheSize() == 0);
+
+    auto searchableBL = app->getBucketManager()
+                            .getBucketSnapshotManager()
+                            .copySearchableHotArchiveBucketListSnapshot();
+    auto checkLoads = [&] {
+        for (auto const& e : archivedEntries)
+        {
+            auto entryPtr = searchableBL->load(LedgerEntryKey(e));
+            REQUIRE(entryPtr);
+            REQUIRE(entryPtr->type() == HOT_ARCHIVE_ARCHIVED);
+            REQUIRE(entryPtr->archivedEntry() == e);
+        }
+    };
+
+    // First loads read from disk and populate the cache
+    auto startHits = hitMeter.count();
+    checkLoads();
+    REQUIRE(hitMeter.count() == startHits);
+    REQUIRE(missMeter.count() == archivedEntries.size());
+    REQUIRE(getCacheSize() == archivedEntries.size());
+    REQUIRE(getLevelHits() == archivedEntries.size());
+
+    // Repeated loads are served from the cache
+    checkLoads();
+    REQUIRE(hitMeter.count() == startHits + archivedEntries.size());
+    REQUIRE(missMeter.count() == archivedEntries.size());
+
+    LedgerKeySet keys;
+    for (auto const& e : archivedEntries)
+    {
+        keys.emplace(LedgerEntryKey(e));
+    }
+
+    auto bulkLoadResult = searchableBL->loadKeys(keys);
+    REQUIRE(bulkLoadResult.size() == archivedEntries.size());
+    REQUIRE(hitMeter.count() == startHits + 2 * archivedEntries.size());
+    REQUIRE(getLevelHits() == 3 * archivedEntries.size());
+}
+
 TEST_CASE("getRangeForType bounds verification", "[bucket][bucketindex]")
 {
     auto f = [&](Config& cfg) {
@@ -1663,4 +2346,101 @@ TEST_CASE("getRangeForType bounds verification", "[bucket][bucketindex]")
 
     testAllIndexTypes(f);
 }
+
+TEST_CASE("scan for live entries of type", "[bucket][bucketindex]")
+{
+    auto f = [&](Config& cfg) {
+        auto clock = VirtualClock();
+        auto app = createTestApplication<BucketTestApplication>(clock, cfg);
+
+        // Spread entries of an indexed and an unindexed type over several
+        // buckets, updating and deleting some of them in later ledgers so
+        // that older versions are shadowed.
+        UnorderedMap<LedgerKey, LedgerEntry> expectedEntries;
+        for (auto type : {CONTRACT_CODE, OFFER})
+        {
+            auto entries =
+                LedgerTestUtils::generateValidUniqueLedgerEntriesWithTypes(
+                    {type}, 20);
+            app->getLedgerManager().setNextLedgerEntryBatchForBucketTesting(
+                entries, {}, {});
+            closeLedger(*app);
+
+            for (auto const& e : entries)
+            {
+                expectedEntries.emplace(LedgerEntryKey(e), e);
+            }
+
+            for (uint32_t ledger = 0; ledger < 5; ++ledger)
+            {
+                std::vector<LedgerEntry> liveEntries;
+                std::vector<LedgerKey> deadKeys;
+                for (auto iter = expectedEntries.begin();
+                     iter != expectedEntries.end();)
+                {
+                    if (iter->first.type() != type || !rand_flip() ||
+                        !rand_flip())
+                    {
+                        ++iter;
+                    }
+                    else if (rand_flip())
+                    {
+                        ++iter->second.lastModifiedLedgerSeq;
+                        liveEntries.emplace_back(iter->second);
+                        ++iter;
+                    }
+                    else
+                    {
+                        deadKeys.emplace_back(iter->first);
+                        iter = expectedEntries.erase(iter);
+                    }
+                }
+
+                app->getLedgerManager()
+                    .setNextLedgerEntryBatchForBucketTesting({}, liveEntries,
+                                                             deadKeys);
+                closeLedger(*app);
+            }
+        }
+
+        auto searchableBL = app->getBucketManager()
+                                .getBucketSnapshotManager()
+                                .copySearchableLiveBucketListSnapshot();
+        for (auto type : {CONTRACT_CODE, OFFER})
+        {
+            auto expected = expectedEntries;
+            searchableBL->scanForLiveEntriesOfType(
+                type, [&](LedgerEntry const& le) {
+                    auto iter = expected.find(LedgerEntryKey(le));
+                    REQUIRE(iter != expected.end());
+                    REQUIRE(iter->second == le);
+                    expected.erase(iter);
+                    return Loop::INCOMPLETE;
+                });
+
+            // Every live entry of the type was found exactly once
+            for (auto const& [k, e] : expected)
+            {
+                REQUIRE(k.type() != type);
+            }
+        }
+
+        // Loop::COMPLETE stops the scan
+        size_t numCalls = 0;
+        searchableBL->scanForLiveEntriesOfType(CONTRACT_CODE,
+                                               [&](LedgerEntry const&) {
+                                                   ++numCalls;
+                                                   return Loop::COMPLETE;
+                                               });
+        REQUIRE(numCalls == 1);
+
+        searchableBL->scanForLiveEntriesOfType(CLAIMABLE_BALANCE,
+                                               [&](LedgerEntry const&) {
+                                                   REQUIRE(false);
+                                                   return Loop::INCOMPLETE;
+                                               });
+    };
+
+    testAllIndexTypes(f);
+}
 }
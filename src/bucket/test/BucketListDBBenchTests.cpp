@@ -0,0 +1,601 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "bucket/BucketIndexUtils.h"
+#include "bucket/BucketManager.h"
+#include "bucket/BucketSnapshotManager.h"
+#include "bucket/HotArchiveBucketList.h"
+#include "bucket/LiveBucket.h"
+#include "bucket/LiveBucketIndex.h"
+#include "bucket/LiveBucketList.h"
+#include "bucket/SearchableBucketList.h"
+#include "bucket/test/BucketTestUtils.h"
+#include "ledger/LedgerTypeUtils.h"
+#include "ledger/test/LedgerTestUtils.h"
+#include "main/Application.h"
+#include "main/Config.h"
+#include "test/Catch2.h"
+#include "test/test.h"
+#include "util/Fs.h"
+#include "util/Logging.h"
+#include "util/Math.h"
+#include "util/types.h"
+#include <algorithm>
+#include <chrono>
+#include <fmt/format.h>
+#include <fstream>
+#include <medida/meter.h>
+#include <medida/metrics_registry.h>
+#include <medida/timer.h>
+
+// Lookup benchmarks for BucketListDB: a BucketList of a given depth and entry
+// type mix is built, then point lookups (SearchableLiveBucketListSnapshot::
+// load), bulk prefetches (loadKeys), miss-heavy point lookups and raw index
+// scans (LiveBucketIndex::scan on the deepest bucket) are timed, both with
+// the page cache warmed up and with the bucket files dropped from it before
+// every lookup or batch.
+//
+// Every workload reports p50/p99 latency, the bloom filter false positive
+// rate, the LiveBucketIndex cache hit rate and the bytes read per lookup, as
+// counted in /proc/self/io. The latter only sees reads through read(2), so
+// with memory-mapped buckets only the bytes fetched from storage are shown.
+//
+// A second benchmark grows the hot archive BucketList under sustained
+// eviction and restoration, see HotArchiveBench.
+//
+// Run with `stellar-core test '[bucketlistdbbench]'` and
+// `stellar-core test '[hotarchivebench]'`.
+
+namespace stellar
+{
+
+using namespace BucketTestUtils;
+
+namespace
+{
+
+using BenchClock = std::chrono::steady_clock;
+
+size_t const LOOKUPS = 2000;
+size_t const BATCH_SIZE = 500;
+
+// Share of absent keys in the miss-heavy workload, in percent
+uint32_t const MISS_HEAVY_PERCENT = 90;
+
+struct IOCounters
+{
+    // Bytes returned by read(2) and friends, page cache hits included
+    uint64_t mReadBytes{0};
+    // Bytes actually fetched from storage
+    uint64_t mStorageBytes{0};
+};
+
+IOCounters
+getIOCounters()
+{
+    IOCounters res;
+#ifdef __linux__
+    std::ifstream in("/proc/self/io");
+    std::string name;
+    uint64_t value;
+    while (in >> name >> value)
+    {
+        if (name == "rchar:")
+        {
+            res.mReadBytes = value;
+        }
+        else if (name == "read_bytes:")
+        {
+            res.mStorageBytes = value;
+        }
+    }
+#endif
+    return res;
+}
+
+int64_t
+getElapsedNs(BenchClock::time_point start)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               BenchClock::now() - start)
+        .count();
+}
+
+double
+getPercentileUs(std::vector<int64_t>& ns, double p)
+{
+    std::sort(ns.begin(), ns.end());
+    return ns.at(static_cast<size_t>(p * (ns.size() - 1))) / 1000.0;
+}
+
+class BucketListDBBench
+{
+    VirtualClock mClock;
+    std::shared_ptr<BucketTestApplication> mApp;
+    UnorderedSet<LedgerKey> mGeneratedKeys;
+    std::vector<LedgerKey> mPresentKeys;
+    std::vector<LedgerKey> mAbsentKeys;
+
+    // Counters sampled before each workload
+    struct Sample
+    {
+        IOCounters mIO;
+        int64_t mBloomLookups;
+        int64_t mBloomMisses;
+        int64_t mCacheHits;
+        int64_t mCacheMisses;
+    };
+
+    BucketManager&
+    getBM() const
+    {
+        return mApp->getBucketManager();
+    }
+
+    Sample
+    sample() const
+    {
+        auto& bm = getBM();
+        return {getIOCounters(), bm.getBloomLookupMeter<LiveBucket>().count(),
+                bm.getBloomMissMeter<LiveBucket>().count(),
+                bm.getCacheHitMeter().count(), bm.getCacheMissMeter().count()};
+    }
+
+    void
+    dropPageCache() const
+    {
+        auto& bl = getBM().getLiveBucketList();
+        for (uint32_t i = 0; i < LiveBucketList::kNumLevels; ++i)
+        {
+            for (auto const& b :
+                 {bl.getLevel(i).getCurr(), bl.getLevel(i).getSnap()})
+            {
+                if (!b->isEmpty())
+                {
+                    fs::adviseDontNeed(b->getFilename().string());
+                }
+            }
+        }
+    }
+
+    std::vector<LedgerKey>
+    pickKeys(size_t n, uint32_t absentPercent) const
+    {
+        std::vector<LedgerKey> keys;
+        keys.reserve(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            keys.emplace_back(rand_uniform<uint32_t>(1, 100) <= absentPercent
+                                  ? rand_element(mAbsentKeys)
+                                  : rand_element(mPresentKeys));
+        }
+        return keys;
+    }
+
+    // found is the number of lookups that returned an entry, which each
+    // passed one bucket's filter legitimately unless served from the cache
+    void
+    report(std::string const& name, bool cold, std::vector<int64_t>& ns,
+           size_t lookups, size_t found, Sample const& before) const
+    {
+        auto after = sample();
+        auto cacheHits = after.mCacheHits - before.mCacheHits;
+        auto cacheLookups =
+            cacheHits + after.mCacheMisses - before.mCacheMisses;
+        auto bloomLookups = after.mBloomLookups - before.mBloomLookups;
+        auto bloomMisses = after.mBloomMisses - before.mBloomMisses;
+        auto bloomNegatives = std::max<int64_t>(
+            bloomLookups - static_cast<int64_t>(found) + cacheHits, 1);
+
+        LOG_INFO(DEFAULT_LOG,
+                 "{} ({} cache): {} lookups, p50 {:.1f}us, p99 {:.1f}us, bloom "
+                 "false positive rate {:.4f}, index cache hit rate {:.3f}, "
+                 "{:.0f} bytes read/lookup, {:.0f} from storage",
+                 name, cold ? "cold" : "hot", lookups,
+                 getPercentileUs(ns, 0.5), getPercentileUs(ns, 0.99),
+                 static_cast<double>(bloomMisses) / bloomNegatives,
+                 cacheLookups ? static_cast<double>(cacheHits) / cacheLookups
+                              : 0.0,
+                 static_cast<double>(after.mIO.mReadBytes -
+                                     before.mIO.mReadBytes) /
+                     lookups,
+                 static_cast<double>(after.mIO.mStorageBytes -
+                                     before.mIO.mStorageBytes) /
+                     lookups);
+    }
+
+    void
+    runPointLookups(std::string const& name, uint32_t absentPercent,
+                    bool cold) const
+    {
+        auto snapshot = getBM()
+                            .getBucketSnapshotManager()
+                            .copySearchableLiveBucketListSnapshot();
+        auto keys = pickKeys(LOOKUPS, absentPercent);
+        if (!cold)
+        {
+            for (auto const& k : keys)
+            {
+                snapshot->load(k);
+            }
+        }
+
+        std::vector<int64_t> ns;
+        ns.reserve(keys.size());
+        size_t found = 0;
+        auto before = sample();
+        for (auto const& k : keys)
+        {
+            if (cold)
+            {
+                dropPageCache();
+            }
+            auto start = BenchClock::now();
+            found += snapshot->load(k) != nullptr;
+            ns.emplace_back(getElapsedNs(start));
+        }
+        report(name, cold, ns, keys.size(), found, before);
+    }
+
+    void
+    runBulkLoads(bool cold) const
+    {
+        auto snapshot = getBM()
+                            .getBucketSnapshotManager()
+                            .copySearchableLiveBucketListSnapshot();
+        std::vector<LedgerKeySet> batches;
+        for (size_t i = 0; i < LOOKUPS / BATCH_SIZE; ++i)
+        {
+            auto keys = pickKeys(BATCH_SIZE, 0);
+            batches.emplace_back(keys.begin(), keys.end());
+        }
+        if (!cold)
+        {
+            for (auto const& batch : batches)
+            {
+                snapshot->loadKeys(batch, "bench");
+            }
+        }
+
+        // Latencies are per batch, the other figures per key
+        std::vector<int64_t> ns;
+        size_t lookups = 0;
+        size_t found = 0;
+        auto before = sample();
+        for (auto const& batch : batches)
+        {
+            if (cold)
+            {
+                dropPageCache();
+            }
+            auto start = BenchClock::now();
+            found += snapshot->loadKeys(batch, "bench").size();
+            ns.emplace_back(getElapsedNs(start));
+            lookups += batch.size();
+        }
+        report(fmt::format("bulk load of {}", BATCH_SIZE), cold, ns, lookups,
+               found, before);
+    }
+
+    // Times the in-memory search of the deepest bucket's index alone, no
+    // page is read
+    void
+    runIndexScans() const
+    {
+        auto& bl = getBM().getLiveBucketList();
+        std::shared_ptr<LiveBucket> bucket;
+        for (uint32_t i = 0; i < LiveBucketList::kNumLevels && !bucket; ++i)
+        {
+            auto level = LiveBucketList::kNumLevels - 1 - i;
+            for (auto const& b :
+                 {bl.getLevel(level).getSnap(), bl.getLevel(level).getCurr()})
+            {
+                if (!b->isEmpty())
+                {
+                    bucket = b;
+                    break;
+                }
+            }
+        }
+        REQUIRE(bucket);
+
+        auto const& index = bucket->getIndex();
+        auto keys = pickKeys(LOOKUPS, 50);
+        std::vector<int64_t> ns;
+        ns.reserve(keys.size());
+        size_t found = 0;
+        auto before = sample();
+        for (auto const& k : keys)
+        {
+            auto start = BenchClock::now();
+            auto res = index.scan(index.begin(), k, false).first;
+            ns.emplace_back(getElapsedNs(start));
+            found += res.getState() != IndexReturnState::NOT_FOUND;
+        }
+        report("deepest bucket index scan", false, ns, keys.size(), found,
+               before);
+    }
+
+  public:
+    BucketListDBBench(Config const& cfg, uint32_t levels,
+                      size_t entriesPerLedger,
+                      std::unordered_set<LedgerEntryType> const& types)
+        : mApp(createTestApplication<BucketTestApplication>(mClock, cfg))
+    {
+        uint32_t ledger = 0;
+        do
+        {
+            ++ledger;
+            auto entries =
+                LedgerTestUtils::generateValidUniqueLedgerEntriesWithTypes(
+                    types, entriesPerLedger, mGeneratedKeys);
+            auto entriesSize = entries.size();
+            for (size_t i = 0; i < entriesSize; ++i)
+            {
+                auto const& e = entries.at(i);
+                mPresentKeys.emplace_back(LedgerEntryKey(e));
+
+                // Soroban entries must have a TTL
+                if (isSorobanEntry(e.data))
+                {
+                    LedgerEntry ttl;
+                    ttl.data.type(TTL);
+                    ttl.data.ttl().keyHash = getTTLKey(e).ttl().keyHash;
+                    ttl.data.ttl().liveUntilLedgerSeq = ledger + 1'000'000;
+                    ttl.lastModifiedLedgerSeq = ledger;
+                    mGeneratedKeys.insert(LedgerEntryKey(ttl));
+                    entries.push_back(ttl);
+                }
+            }
+
+            mApp->getLedgerManager().setNextLedgerEntryBatchForBucketTesting(
+                entries, {}, {});
+            closeLedger(*mApp);
+        } while (!LiveBucketList::levelShouldSpill(ledger, levels - 1));
+
+        // Keys of the same types that were never written
+        for (auto const& e :
+             LedgerTestUtils::generateValidUniqueLedgerEntriesWithTypes(
+                 types, LOOKUPS, mGeneratedKeys))
+        {
+            mAbsentKeys.emplace_back(LedgerEntryKey(e));
+        }
+
+        LOG_INFO(DEFAULT_LOG, "Built a {}-level BucketList of {} entries",
+                 levels, mPresentKeys.size());
+    }
+
+    void
+    run()
+    {
+        for (bool cold : {false, true})
+        {
+            runPointLookups("point lookup", 0, cold);
+            runBulkLoads(cold);
+            runPointLookups(fmt::format("miss-heavy point lookup ({}% absent)",
+                                        MISS_HEAVY_PERCENT),
+                            MISS_HEAVY_PERCENT, cold);
+        }
+        runIndexScans();
+    }
+};
+
+// Every ledger archives a batch of new persistent entries, restores a share
+// of the entries already archived and archives a share of the restored ones
+// again, as eviction and restoration do on a busy network. Restored entries
+// leave a tombstone (HOT_ARCHIVE_LIVE entry) behind in the hot archive until
+// it reaches the bottom level. Every SAMPLE_INTERVAL ledgers this logs the
+// size of the hot archive, its share of tombstones, the p50/p99 latency of
+// point lookups of archived and of restored keys, the p99 time to add a
+// batch (which waits for merges that haven't finished in time) and the CPU
+// time spent in hot archive merges.
+class HotArchiveBench
+{
+    static uint32_t const SAMPLE_INTERVAL = 256;
+
+    VirtualClock mClock;
+    std::shared_ptr<BucketTestApplication> mApp;
+    UnorderedSet<LedgerKey> mGeneratedKeys;
+    std::vector<LedgerEntry> mArchived;
+    std::vector<LedgerEntry> mRestored;
+    std::vector<int64_t> mAddBatchNs;
+
+    BucketManager&
+    getBM() const
+    {
+        return mApp->getBucketManager();
+    }
+
+    // Removes and returns n random entries of `from`
+    static std::vector<LedgerEntry>
+    takeRandom(std::vector<LedgerEntry>& from, size_t n)
+    {
+        std::vector<LedgerEntry> res;
+        for (size_t i = 0; i < n && !from.empty(); ++i)
+        {
+            auto j = rand_uniform<size_t>(0, from.size() - 1);
+            std::swap(from.at(j), from.back());
+            res.emplace_back(std::move(from.back()));
+            from.pop_back();
+        }
+        return res;
+    }
+
+    std::vector<int64_t>
+    timeLookups(std::vector<LedgerEntry> const& entries, bool archived) const
+    {
+        auto snapshot = getBM()
+                            .getBucketSnapshotManager()
+                            .copySearchableHotArchiveBucketListSnapshot();
+        std::vector<int64_t> ns;
+        ns.reserve(LOOKUPS);
+        for (size_t i = 0; i < LOOKUPS && !entries.empty(); ++i)
+        {
+            auto k = LedgerEntryKey(rand_element(entries));
+            auto start = BenchClock::now();
+            auto res = snapshot->load(k);
+            ns.emplace_back(getElapsedNs(start));
+            REQUIRE(static_cast<bool>(res) == archived);
+        }
+        return ns;
+    }
+
+    void
+    report(uint32_t ledger)
+    {
+        auto& bl = getBM().getHotArchiveBucketList();
+        size_t bytes = 0;
+        size_t archived = 0;
+        size_t tombstones = 0;
+        for (uint32_t i = 0; i < HotArchiveBucketList::kNumLevels; ++i)
+        {
+            for (auto const& b :
+                 {bl.getLevel(i).getCurr(), bl.getLevel(i).getSnap()})
+            {
+                if (!b->isEmpty())
+                {
+                    bytes += b->getSize();
+                    EntryCounts<HotArchiveBucket> counts(b);
+                    archived += counts.nInitOrArchived;
+                    tombstones += counts.nLive;
+                }
+            }
+        }
+
+        auto archivedNs = timeLookups(mArchived, true);
+        auto restoredNs = timeLookups(mRestored, false);
+        auto& mergeCPU = mApp->getMetrics().NewTimer(
+            {"app", "background-archive-merge", "cpu"});
+        LOG_INFO(DEFAULT_LOG,
+                 "ledger {}: hot archive of {:.1f} MB, {} archived entries, "
+                 "{} tombstones ({:.1f}%), archived lookup p50 {:.1f}us p99 "
+                 "{:.1f}us, restored lookup p50 {:.1f}us p99 {:.1f}us, add "
+                 "batch p99 {:.1f}us, {:.0f} ms merging",
+                 ledger, bytes / (1024.0 * 1024.0), archived, tombstones,
+                 100.0 * tombstones /
+                     std::max<size_t>(archived + tombstones, 1),
+                 getPercentileUs(archivedNs, 0.5),
+                 getPercentileUs(archivedNs, 0.99),
+                 getPercentileUs(restoredNs, 0.5),
+                 getPercentileUs(restoredNs, 0.99),
+                 getPercentileUs(mAddBatchNs, 0.99), mergeCPU.sum());
+        mAddBatchNs.clear();
+    }
+
+  public:
+    HotArchiveBench(Config const& cfg)
+        : mApp(createTestApplication<BucketTestApplication>(mClock, cfg))
+    {
+    }
+
+    // Archives evictedPerLedger new entries every ledger, and restores
+    // restorePercent percent as many, of which rearchivePercent percent are
+    // archived again later
+    void
+    run(uint32_t ledgers, size_t evictedPerLedger, uint32_t restorePercent,
+        uint32_t rearchivePercent)
+    {
+        auto header =
+            mApp->getLedgerManager().getLastClosedLedgerHeader().header;
+        header.ledgerVersion = static_cast<uint32_t>(
+            HotArchiveBucket::FIRST_PROTOCOL_SUPPORTING_PERSISTENT_EVICTION);
+        auto restoredPerLedger = evictedPerLedger * restorePercent / 100;
+        auto rearchivedPerLedger = restoredPerLedger * rearchivePercent / 100;
+
+        for (uint32_t i = 1; i <= ledgers; ++i)
+        {
+            ++header.ledgerSeq;
+            // Taken before restoring, so that no key is both archived and
+            // restored in the same batch
+            auto archivedBatch = takeRandom(mRestored, rearchivedPerLedger);
+            auto restoredBatch = takeRandom(mArchived, restoredPerLedger);
+            for (auto& e :
+                 LedgerTestUtils::generateUniquePersistentLedgerEntries(
+                     evictedPerLedger, mGeneratedKeys))
+            {
+                archivedBatch.emplace_back(std::move(e));
+            }
+            std::vector<LedgerKey> restoredKeys;
+            for (auto& e : archivedBatch)
+            {
+                e.lastModifiedLedgerSeq = header.ledgerSeq;
+            }
+            for (auto const& e : restoredBatch)
+            {
+                restoredKeys.emplace_back(LedgerEntryKey(e));
+            }
+
+            auto start = BenchClock::now();
+            addHotArchiveBatchAndUpdateSnapshot(*mApp, header, archivedBatch,
+                                                restoredKeys);
+            mAddBatchNs.emplace_back(getElapsedNs(start));
+
+            mArchived.insert(mArchived.end(), archivedBatch.begin(),
+                             archivedBatch.end());
+            mRestored.insert(mRestored.end(), restoredBatch.begin(),
+                             restoredBatch.end());
+            if (i % SAMPLE_INTERVAL == 0)
+            {
+                report(header.ledgerSeq);
+            }
+        }
+    }
+};
+}
+
+TEST_CASE("BucketListDB lookup benchmark",
+          "[bucket][bucketindex][bucketlistdbbench][bench][!hide]")
+{
+    size_t const entriesPerLedger = 100;
+    auto levels = GENERATE(as<uint32_t>(), 6, 7);
+    auto cacheMb = GENERATE(as<size_t>(), 0, 64);
+
+    Config cfg(getTestConfig());
+    // Index every bucket on disk, as on a large BucketList
+    cfg.BUCKETLIST_DB_INDEX_CUTOFF = 0;
+    cfg.BUCKETLIST_DB_MEMORY_FOR_CACHING = cacheMb;
+    LOG_INFO(DEFAULT_LOG, "{} levels, {} MB index cache", levels, cacheMb);
+
+    SECTION("classic entries")
+    {
+        BucketListDBBench bench(cfg, levels, entriesPerLedger,
+                                {ACCOUNT, TRUSTLINE, OFFER});
+        bench.run();
+    }
+    SECTION("soroban entries")
+    {
+        BucketListDBBench bench(cfg, levels, entriesPerLedger,
+                                {CONTRACT_DATA, CONTRACT_CODE});
+        bench.run();
+    }
+    SECTION("mixed entries")
+    {
+        BucketListDBBench bench(
+            cfg, levels, entriesPerLedger,
+            {ACCOUNT, TRUSTLINE, OFFER, CONTRACT_DATA, CONTRACT_CODE});
+        bench.run();
+    }
+}
+
+TEST_CASE("hot archive growth benchmark",
+          "[bucket][hotarchivebench][bench][!hide]")
+{
+    uint32_t const ledgers = 4096;
+    size_t const evictedPerLedger = 50;
+    uint32_t const rearchivePercent = 20;
+    auto restorePercent = GENERATE(as<uint32_t>(), 0, 25, 75);
+    auto mergeRateMb = GENERATE(as<size_t>(), 0, 8);
+
+    Config cfg(getTestConfig());
+    cfg.BUCKETLIST_DB_INDEX_CUTOFF = 0;
+    cfg.HOT_ARCHIVE_MERGE_RATE = mergeRateMb;
+    LOG_INFO(DEFAULT_LOG,
+             "{}% of evictions restored, hot archive merges limited to {} "
+             "MB/s",
+             restorePercent, mergeRateMb);
+
+    HotArchiveBench bench(cfg);
+    bench.run(ledgers, evictedPerLedger, restorePercent, rearchivePercent);
+}
+}
@@ -1599,7 +1599,20 @@ TEST_CASE_VERSIONS("eviction scan", "[bucketlist][archival]")
         }
     };
 
-    for_versions(20, Config::CURRENT_LEDGER_PROTOCOL_VERSION, cfg, test);
+    SECTION("serial scan")
+    {
+        for_versions(20, Config::CURRENT_LEDGER_PROTOCOL_VERSION, cfg, test);
+    }
+
+    SECTION("parallel scan")
+    {
+        // Index every bucket with small pages so scans are split into many
+        // chunks
+        cfg.BACKGROUND_EVICTION_SCAN_THREADS = 4;
+        cfg.BUCKETLIST_DB_INDEX_CUTOFF = 0;
+        cfg.BUCKETLIST_DB_INDEX_PAGE_SIZE_EXPONENT = 10;
+        for_versions(20, Config::CURRENT_LEDGER_PROTOCOL_VERSION, cfg, test);
+    }
 }
 
 TEST_CASE_VERSIONS("Searchable BucketListDB snapshots", "[bucketlist]")
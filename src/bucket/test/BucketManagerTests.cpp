@@ -16,6 +16,7 @@
 #include "bucket/LiveBucket.h"
 #include "bucket/test/BucketTestUtils.h"
 #include "history/HistoryArchiveManager.h"
+#include "history/HistoryManager.h"
 #include "history/test/HistoryTestsUtils.h"
 #include "ledger/LedgerTxn.h"
 #include "ledger/test/LedgerTestUtils.h"
@@ -81,7 +82,8 @@ clearFutures(Application::pointer app, LiveBucketList& bl)
                 ++finished;
                 cv2.notify_one();
             },
-            "BucketTests: clearFutures");
+            "BucketTests: clearFutures",
+            BackgroundWorkClass::MERGE);
     }
     {
         std::unique_lock<std::mutex> lock(mutex);
@@ -289,6 +291,48 @@ TEST_CASE_VERSIONS("bucketmanager ownership", "[bucket][bucketmanager]")
     });
 }
 
+TEST_CASE("replay batching defers bucket gc", "[bucket][bucketmanager]")
+{
+    VirtualClock clock;
+    Config cfg = getTestConfig();
+    Application::pointer app = createTestApplication(clock, cfg);
+    auto& lm = app->getLedgerManager();
+
+    // Returns the file of a bucket only the BucketManager references
+    auto makeUnreferencedBucket = [&]() {
+        std::vector<LedgerEntry> live(
+            LedgerTestUtils::generateValidUniqueLedgerEntriesWithExclusions(
+                {CONFIG_SETTING, CONTRACT_DATA, CONTRACT_CODE, TTL}, 10));
+        auto b = LiveBucket::fresh(
+            app->getBucketManager(), getAppLedgerVersion(app), {}, live, {},
+            /*countMergeEvents=*/true, clock.getIOContext(),
+            /*doFsync=*/true);
+        auto filename = b->getFilename().string();
+        CHECK(fs::exists(filename));
+        return filename;
+    };
+
+    lm.setReplayBatching(true);
+    auto filename = makeUnreferencedBucket();
+    while (!HistoryManager::isLastLedgerInCheckpoint(
+        lm.getLastClosedLedgerNum() + 1, cfg))
+    {
+        closeLedger(*app);
+        CHECK(fs::exists(filename));
+    }
+
+    // Closing the last ledger of the checkpoint catches up
+    closeLedger(*app);
+    CHECK(!fs::exists(filename));
+
+    // So does ending the batch
+    filename = makeUnreferencedBucket();
+    closeLedger(*app);
+    CHECK(fs::exists(filename));
+    lm.setReplayBatching(false);
+    CHECK(!fs::exists(filename));
+}
+
 TEST_CASE("bucketmanager missing buckets fail", "[bucket][bucketmanager]")
 {
     Config cfg(getTestConfig(0, Config::TESTDB_BUCKET_DB_PERSISTENT));
@@ -4,11 +4,14 @@
 
 #include "bucket/BucketMergeMap.h"
 #include "bucket/test/BucketTestUtils.h"
+#include "crypto/SHA.h"
 #include "ledger/test/LedgerTestUtils.h"
 #include "main/Application.h"
 #include "test/Catch2.h"
 #include "test/TestUtils.h"
 #include "test/test.h"
+#include "util/TmpDir.h"
+#include <fstream>
 
 using namespace stellar;
 
@@ -132,3 +135,57 @@ TEST_CASE("bucket merge map", "[bucket][bucketmergemap]")
     REQUIRE(bmm.forgetAllMergesProducing(out1->getHash()) ==
             UnorderedSet<MergeKey>{});
 }
+
+TEST_CASE("bucket merge map save and load", "[bucket][bucketmergemap]")
+{
+    TmpDir dir("merge-map");
+    auto filename = dir.getName() + "/merges.json";
+
+    MergeKey m1{true, sha256("1a"), sha256("1b"), {sha256("1c")}};
+    MergeKey m2{false, sha256("2a"), sha256("2b"), {}};
+    MergeKey m3{true, sha256("3a"), sha256("3b"), {}};
+    auto out1 = sha256("out1");
+    auto out2 = sha256("out2");
+    auto out3 = sha256("out3");
+
+    BucketMergeMap saved;
+    REQUIRE(!saved.isDirty());
+    saved.recordMerge(m1, out1);
+    saved.recordMerge(m2, out2);
+    saved.recordMerge(m3, out3);
+    REQUIRE(saved.isDirty());
+    saved.save(filename);
+    REQUIRE(!saved.isDirty());
+
+    // Merges whose output is gone are not loaded
+    BucketMergeMap loaded;
+    loaded.load(filename, [&](Hash const& h) { return h != out3; });
+    Hash t;
+    REQUIRE(loaded.findMergeFor(m1, t));
+    REQUIRE(t == out1);
+    REQUIRE(loaded.findMergeFor(m2, t));
+    REQUIRE(t == out2);
+    REQUIRE(!loaded.findMergeFor(m3, t));
+    std::set<Hash> outs;
+    loaded.getOutputsUsingInput(sha256("1c"), outs);
+    REQUIRE(outs == std::set<Hash>{out1});
+
+    SECTION("missing file")
+    {
+        BucketMergeMap bmm;
+        bmm.load(dir.getName() + "/missing.json",
+                 [](Hash const&) { return true; });
+        REQUIRE(!bmm.findMergeFor(m1, t));
+    }
+
+    SECTION("corrupt file")
+    {
+        {
+            std::ofstream out(filename);
+            out << "{\"version\": 1, \"merges\": [";
+        }
+        BucketMergeMap bmm;
+        bmm.load(filename, [](Hash const&) { return true; });
+        REQUIRE(!bmm.findMergeFor(m1, t));
+    }
+}
@@ -15,6 +15,7 @@
 #include "bucket/BucketManager.h"
 #include "bucket/BucketOutputIterator.h"
 #include "bucket/HotArchiveBucket.h"
+#include "bucket/LedgerCmp.h"
 #include "bucket/LiveBucket.h"
 #include "bucket/test/BucketTestUtils.h"
 #include "ledger/LedgerTxn.h"
@@ -275,6 +276,144 @@ TEST_CASE_VERSIONS("merging bucket entries", "[bucket]")
     });
 }
 
+TEST_CASE("partitioned and pipelined merges match serial merges", "[bucket]")
+{
+    auto live = LedgerTestUtils::generateValidUniqueLedgerEntriesWithExclusions(
+        {CONFIG_SETTING}, 1000);
+    std::vector<LedgerEntry> updated;
+    std::vector<LedgerKey> dead;
+    for (size_t i = 0; i < live.size(); ++i)
+    {
+        if (i % 3 == 0)
+        {
+            auto e = live.at(i);
+            ++e.lastModifiedLedgerSeq;
+            updated.emplace_back(e);
+        }
+        else if (i % 3 == 1)
+        {
+            dead.emplace_back(LedgerEntryKey(live.at(i)));
+        }
+    }
+
+    auto doMerge = [&](uint32_t partitions, bool pipelineWrites,
+                       bool keepTombstoneEntries, int instance) {
+        VirtualClock clock;
+        Config cfg(getTestConfig(instance));
+        cfg.BUCKETLIST_DB_INDEX_CUTOFF = 0;
+        cfg.BUCKETLIST_DB_INDEX_PAGE_SIZE_EXPONENT = 10;
+        cfg.BUCKET_MERGE_PARTITIONS = partitions;
+        cfg.BUCKET_MERGE_PIPELINED_WRITES = pipelineWrites;
+        auto app = createTestApplication(clock, cfg);
+        auto& bm = app->getBucketManager();
+        auto vers = getAppLedgerVersion(app);
+
+        auto bOld = LiveBucket::fresh(bm, vers, {}, live, {},
+                                      /*countMergeEvents=*/false,
+                                      clock.getIOContext(),
+                                      /*doFsync=*/true);
+        auto bNew = LiveBucket::fresh(bm, vers, {}, updated, dead,
+                                      /*countMergeEvents=*/false,
+                                      clock.getIOContext(),
+                                      /*doFsync=*/true);
+
+        // Make sure the merge actually gets partitioned
+        if (partitions > 1)
+        {
+            REQUIRE(bOld->getIndexForTesting()
+                        .getMergePartitionKeys(partitions)
+                        .size() == partitions - 1);
+        }
+
+        auto merged = LiveBucket::merge(
+            bm, vers, bOld, bNew, /*shadows=*/{}, keepTombstoneEntries,
+            /*countMergeEvents=*/true, clock.getIOContext(),
+            /*doFsync=*/true);
+        return std::make_pair(merged->getHash(),
+                              bm.readMergeCounters<LiveBucket>());
+    };
+
+    for (bool keepTombstoneEntries : {true, false})
+    {
+        auto serial = doMerge(1, false, keepTombstoneEntries, 0);
+        for (uint32_t partitions : {1, 2, 7})
+        {
+            for (bool pipelineWrites : {false, true})
+            {
+                if (partitions == 1 && !pipelineWrites)
+                {
+                    continue;
+                }
+
+                auto res = doMerge(partitions, pipelineWrites,
+                                   keepTombstoneEntries, 1);
+                REQUIRE(res.first == serial.first);
+                REQUIRE(res.second == serial.second);
+            }
+        }
+    }
+}
+
+TEST_CASE("parallel bucket entry conversion matches serial", "[bucket]")
+{
+    auto entries =
+        LedgerTestUtils::generateValidUniqueLedgerEntriesWithExclusions(
+            {CONFIG_SETTING}, LiveBucket::PARALLEL_CONVERT_MIN_ENTRIES + 1000);
+    std::vector<LedgerEntry> init, live;
+    std::vector<LedgerKey> dead;
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        switch (i % 3)
+        {
+        case 0:
+            init.emplace_back(entries[i]);
+            break;
+        case 1:
+            live.emplace_back(entries[i]);
+            break;
+        default:
+            dead.emplace_back(LedgerEntryKey(entries[i]));
+            break;
+        }
+    }
+
+    for (bool useInit : {false, true})
+    {
+        // Build the expected bucket from small, serially converted batches
+        std::vector<BucketEntry> expected;
+        for (size_t i = 0; i < entries.size(); i += 100)
+        {
+            auto end = std::min(i + 100, entries.size());
+            std::vector<LedgerEntry> initBatch, liveBatch;
+            std::vector<LedgerKey> deadBatch;
+            for (size_t j = i; j < end; ++j)
+            {
+                if (j % 3 == 0)
+                {
+                    initBatch.emplace_back(entries[j]);
+                }
+                else if (j % 3 == 1)
+                {
+                    liveBatch.emplace_back(entries[j]);
+                }
+                else
+                {
+                    deadBatch.emplace_back(LedgerEntryKey(entries[j]));
+                }
+            }
+            auto batch = LiveBucket::convertToBucketEntry(useInit, initBatch,
+                                                          liveBatch, deadBatch);
+            expected.insert(expected.end(), batch.begin(), batch.end());
+        }
+        std::sort(expected.begin(), expected.end(),
+                  BucketEntryIdCmp<LiveBucket>());
+
+        auto converted =
+            LiveBucket::convertToBucketEntry(useInit, init, live, dead);
+        REQUIRE(converted == expected);
+    }
+}
+
 TEST_CASE_VERSIONS("merging hot archive bucket entries", "[bucket][archival]")
 {
     VirtualClock clock;
@@ -22,10 +22,21 @@
 namespace stellar
 {
 
+// Whether the merges the next ledger to close depends on have finished
+static bool
+nextLedgerMergesResolved(Application& app)
+{
+    auto& bl = app.getBucketManager().getLiveBucketList();
+    auto& lm = app.getLedgerManager();
+    bl.resolveAnyReadyFutures();
+    return bl.futuresAllResolved(
+        bl.getMaxMergeLevel(lm.getLastClosedLedgerNum() + 1));
+}
+
 ApplyCheckpointWork::ApplyCheckpointWork(Application& app,
                                          TmpDir const& downloadDir,
                                          LedgerRange const& range,
-                                         OnFailureCallback cb)
+                                         OnFailureCallback cb, bool batchReplay)
     : BasicWork(app,
                 "apply-ledgers-" + fmt::format(FMT_STRING("{}-{}"),
                                                range.mFirst, range.limit()),
@@ -35,6 +46,7 @@ ApplyCheckpointWork::ApplyCheckpointWork(Application& app,
     , mCheckpoint(HistoryManager::checkpointContainingLedger(range.mFirst,
                                                              app.getConfig()))
     , mOnFailure(cb)
+    , mBatchReplay(batchReplay)
 {
     // Ledger range check to enforce application of a single checkpoint
     auto low = HistoryManager::firstLedgerInCheckpointContaining(
@@ -68,6 +80,16 @@ ApplyCheckpointWork::closeFiles()
     mHdrIn.close();
     mTxIn.close();
     mFilesOpen = false;
+    stopReplayBatching();
+}
+
+void
+ApplyCheckpointWork::stopReplayBatching()
+{
+    if (mBatchReplay)
+    {
+        mApp.getLedgerManager().setReplayBatching(false);
+    }
 }
 
 void
@@ -309,6 +331,28 @@ ApplyCheckpointWork::getNextLedgerCloseData()
 #endif
 }
 
+void
+ApplyCheckpointWork::checkAppliedLedger()
+{
+    auto& lm = mApp.getLedgerManager();
+
+    CLOG_DEBUG(History, "{}",
+               xdrToCerealString(lm.getLastClosedLedgerHeader(),
+                                 "LedgerManager LCL"));
+
+    CLOG_DEBUG(History, "{}",
+               xdrToCerealString(mHeaderHistoryEntry, "Replay header"));
+    if (lm.getLastClosedLedgerHeader().hash != mHeaderHistoryEntry.hash)
+    {
+        throw std::runtime_error(fmt::format(
+            FMT_STRING("replay of {:s} produced mismatched ledger hash {:s}"),
+            LedgerManager::ledgerAbbrev(mHeaderHistoryEntry),
+            LedgerManager::ledgerAbbrev(lm.getLastClosedLedgerHeader())));
+    }
+
+    mApp.getLedgerApplyManager().txSetsApplied();
+}
+
 BasicWork::State
 ApplyCheckpointWork::onRun()
 {
@@ -319,25 +363,8 @@ ApplyCheckpointWork::onRun()
 
         if (mConditionalWork->getState() == State::WORK_SUCCESS)
         {
-            auto& lm = mApp.getLedgerManager();
-
-            CLOG_DEBUG(History, "{}",
-                       xdrToCerealString(lm.getLastClosedLedgerHeader(),
-                                         "LedgerManager LCL"));
-
-            CLOG_DEBUG(History, "{}",
-                       xdrToCerealString(mHeaderHistoryEntry, "Replay header"));
-            if (lm.getLastClosedLedgerHeader().hash != mHeaderHistoryEntry.hash)
-            {
-                throw std::runtime_error(fmt::format(
-                    FMT_STRING(
-                        "replay of {:s} produced mismatched ledger hash {:s}"),
-                    LedgerManager::ledgerAbbrev(mHeaderHistoryEntry),
-                    LedgerManager::ledgerAbbrev(
-                        lm.getLastClosedLedgerHeader())));
-            }
-
-            mApp.getLedgerApplyManager().txSetsApplied();
+            mConditionalWork.reset();
+            checkAppliedLedger();
         }
         else
         {
@@ -366,21 +393,24 @@ ApplyCheckpointWork::onRun()
         return State::WORK_RUNNING;
     }
 
-    auto applyLedger = std::make_shared<ApplyLedgerWork>(mApp, *lcd);
+    if (mBatchReplay)
+    {
+        mApp.getLedgerManager().setReplayBatching(true);
+        if (nextLedgerMergesResolved(mApp))
+        {
+            mApp.getLedgerManager().applyLedger(*lcd, /* externalize */ false);
+            checkAppliedLedger();
+            return State::WORK_RUNNING;
+        }
+    }
 
-    auto predicate = [](Application& app) {
-        auto& bl = app.getBucketManager().getLiveBucketList();
-        auto& lm = app.getLedgerManager();
-        bl.resolveAnyReadyFutures();
-        return bl.futuresAllResolved(
-            bl.getMaxMergeLevel(lm.getLastClosedLedgerNum() + 1));
-    };
+    auto applyLedger = std::make_shared<ApplyLedgerWork>(mApp, *lcd);
 
     mConditionalWork = std::make_shared<ConditionalWork>(
         mApp,
         fmt::format(FMT_STRING("apply-ledger-conditional ledger({:d})"),
                     lcd->getLedgerSeq()),
-        predicate, applyLedger, std::chrono::milliseconds(500));
+        nextLedgerMergesResolved, applyLedger, std::chrono::milliseconds(500));
 
     mConditionalWork->startWork(wakeSelfUpCallback());
     return State::WORK_RUNNING;
@@ -394,6 +424,7 @@ ApplyCheckpointWork::shutdown()
     {
         mConditionalWork->shutdown();
     }
+    stopReplayBatching();
     BasicWork::shutdown();
 }
 
@@ -412,6 +443,7 @@ ApplyCheckpointWork::onAbort()
 void
 ApplyCheckpointWork::onFailureRaise()
 {
+    stopReplayBatching();
     if (mOnFailure)
     {
         mOnFailure();
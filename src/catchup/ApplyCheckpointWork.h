@@ -42,6 +42,11 @@ struct LedgerHeaderHistoryEntry;
  * * downloadDir - directory containing ledger and transaction files
  * * range - LedgerRange to apply, must be checkpoint-aligned,
  * and cover at most one checkpoint.
+ * * batchReplay - replay the checkpoint as one batch, for when only the state
+ * at its end matters: LedgerManager defers the per-ledger work that can wait
+ * for the end of the checkpoint (see LedgerManager::setReplayBatching), and
+ * ledgers whose merges are already resolved are applied right away instead of
+ * through an ApplyLedgerWork.
  */
 
 class ApplyCheckpointWork : public BasicWork
@@ -59,6 +64,7 @@ class ApplyCheckpointWork : public BasicWork
 #endif // BUILD_TESTS
     LedgerHeaderHistoryEntry mHeaderHistoryEntry;
     OnFailureCallback mOnFailure;
+    bool const mBatchReplay;
 
     bool mFilesOpen{false};
 
@@ -72,11 +78,16 @@ class ApplyCheckpointWork : public BasicWork
 
     std::shared_ptr<LedgerCloseData> getNextLedgerCloseData();
 
+    // Throws if the last closed ledger isn't the one just replayed
+    void checkAppliedLedger();
+
     void closeFiles();
+    void stopReplayBatching();
 
   public:
     ApplyCheckpointWork(Application& app, TmpDir const& downloadDir,
-                        LedgerRange const& range, OnFailureCallback cb);
+                        LedgerRange const& range, OnFailureCallback cb,
+                        bool batchReplay = false);
     ~ApplyCheckpointWork() = default;
     std::string getStatus() const override;
     void onFailureRaise() override;
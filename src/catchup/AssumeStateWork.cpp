@@ -9,8 +9,8 @@
 #include "crypto/Hex.h"
 #include "history/HistoryArchive.h"
 #include "invariant/InvariantManager.h"
-#include "work/WorkSequence.h"
-#include "work/WorkWithCallback.h"
+#include "main/Application.h"
+#include "util/Logging.h"
 
 namespace stellar
 {
@@ -77,45 +77,44 @@ AssumeStateWork::doWork()
 {
     if (!mWorkSpawned)
     {
-        std::vector<std::shared_ptr<BasicWork>> seq;
+        // Index Bucket files. Neither BucketList depends on the other, so
+        // both are indexed at the same time.
+        mIndexStart = StartupProfiler::Clock::now();
+        addWork<IndexBucketsWork<LiveBucket>>(mLiveBuckets);
+        addWork<IndexBucketsWork<HotArchiveBucket>>(mHotArchiveBuckets);
+        mWorkSpawned = true;
+        return State::WORK_RUNNING;
+    }
 
-        // Index Bucket files
-        seq.push_back(
-            std::make_shared<IndexBucketsWork<LiveBucket>>(mApp, mLiveBuckets));
-        seq.push_back(std::make_shared<IndexBucketsWork<HotArchiveBucket>>(
-            mApp, mHotArchiveBuckets));
+    auto status = checkChildrenStatus();
+    if (status != State::WORK_SUCCESS)
+    {
+        return status;
+    }
+    mApp.getStartupProfiler().record("index-buckets", mIndexStart,
+                                     StartupProfiler::Clock::now());
 
+    try
+    {
         // Add bucket files to BucketList and restart merges
-        auto assumeStateCB = [&has = mHas,
-                              maxProtocolVersion = mMaxProtocolVersion,
-                              restartMerges = mRestartMerges,
-                              &liveBuckets = mLiveBuckets,
-                              &hotArchiveBuckets =
-                                  mHotArchiveBuckets](Application& app) {
-            app.getBucketManager().assumeState(has, maxProtocolVersion,
-                                               restartMerges);
-
-            // Drop bucket references once assume state complete since buckets
-            // now referenced by BucketList
-            liveBuckets.clear();
-            hotArchiveBuckets.clear();
+        mApp.getBucketManager().assumeState(mHas, mMaxProtocolVersion,
+                                            mRestartMerges);
 
-            // Check invariants after state has been assumed
-            app.getInvariantManager().checkAfterAssumeState(has.currentLedger);
+        // Drop bucket references once assume state complete since buckets
+        // now referenced by BucketList
+        mLiveBuckets.clear();
+        mHotArchiveBuckets.clear();
 
-            return true;
-        };
-        auto work = std::make_shared<WorkWithCallback>(mApp, "assume-state",
-                                                       assumeStateCB);
-        seq.push_back(work);
-
-        addWork<WorkSequence>("assume-state-seq", seq, RETRY_NEVER);
-
-        mWorkSpawned = true;
-        return State::WORK_RUNNING;
+        // Check invariants after state has been assumed
+        mApp.getInvariantManager().checkAfterAssumeState(mHas.currentLedger);
+    }
+    catch (std::runtime_error const& e)
+    {
+        CLOG_ERROR(Bucket, "Failed to assume BucketList state: {}", e.what());
+        return State::WORK_FAILURE;
     }
 
-    return checkChildrenStatus();
+    return State::WORK_SUCCESS;
 }
 
 void
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "main/StartupProfiler.h"
 #include "work/Work.h"
 
 namespace stellar
@@ -20,6 +21,7 @@ class AssumeStateWork : public Work
     uint32_t const mMaxProtocolVersion;
     bool mWorkSpawned{false};
     bool const mRestartMerges;
+    StartupProfiler::Clock::time_point mIndexStart;
 
     // Keep strong reference to buckets in HAS so they are not garbage
     // collected during indexing
@@ -3,7 +3,11 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "catchup/CatchupConfiguration.h"
+#include "history/HistoryManager.h"
+#include "ledger/LedgerManager.h"
+#include "util/GlobalChecks.h"
 
+#include <algorithm>
 #include <cassert>
 #include <fmt/format.h>
 
@@ -34,6 +38,44 @@ CatchupConfiguration::resolve(uint32_t remoteCheckpoint) const
     return cfg;
 }
 
+std::vector<CatchupConfiguration>
+CatchupConfiguration::splitIntoRanges(uint32_t parallelism,
+                                      Config const& cfg) const
+{
+    releaseAssert(toLedger() != CatchupConfiguration::CURRENT);
+    uint32_t const init = LedgerManager::GENESIS_LEDGER_SEQ;
+    if (parallelism <= 1 || count() == 0 || toLedger() <= init)
+    {
+        return {*this};
+    }
+
+    // Ledger whose state the first range starts from, as in CatchupRange
+    uint32_t start = init;
+    if (count() < toLedger() - init)
+    {
+        auto first = HistoryManager::firstLedgerInCheckpointContaining(
+            toLedger() - count() + 1, cfg);
+        start = std::max(init, first - 1);
+    }
+
+    uint32_t perRange = (toLedger() - start + parallelism - 1) / parallelism;
+    std::vector<CatchupConfiguration> ranges;
+    while (start < toLedger())
+    {
+        uint32_t end = std::min(
+            toLedger(),
+            HistoryManager::checkpointContainingLedger(start + perRange, cfg));
+        LedgerNumHashPair endPair(end, std::nullopt);
+        if (end == toLedger())
+        {
+            endPair.second = hash();
+        }
+        ranges.emplace_back(endPair, end - start, mode());
+        start = end;
+    }
+    return ranges;
+}
+
 uint32_t
 parseLedger(std::string const& str)
 {
@@ -9,10 +9,13 @@
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <vector>
 
 namespace stellar
 {
 
+class Config;
+
 // Each catchup can be configured by two parameters: destination ledger
 // (and its hash, if known) and count of ledgers to apply.
 // Value of count can be adjusted in different ways during catchup. If applying
@@ -62,6 +65,18 @@ class CatchupConfiguration
      */
     CatchupConfiguration resolve(uint32_t remoteCheckpoint) const;
 
+    /**
+     * Splits the ledgers replayed by this configuration into at most
+     * `parallelism` consecutive ranges of similar length, for replaying
+     * them independently. Each range starts from the state at the end of the
+     * previous one, which is always the last ledger of a checkpoint, so that
+     * it can be restored from buckets. Only the last range keeps the hash of
+     * the destination ledger. Requires a resolved destination ledger and a
+     * fresh database.
+     */
+    std::vector<CatchupConfiguration>
+    splitIntoRanges(uint32_t parallelism, Config const& cfg) const;
+
     uint32_t
     toLedger() const
     {
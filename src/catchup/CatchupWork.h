@@ -76,6 +76,18 @@ class CatchupWork : public Work
         return mCatchupConfiguration;
     }
 
+    // Checkpoint ledger whose bucket state this catchup applied, once it has
+    // applied it
+    std::optional<LedgerHeaderHistoryEntry>
+    getAppliedBucketsLedger() const
+    {
+        if (!mBucketsAppliedEmitted)
+        {
+            return std::nullopt;
+        }
+        return mVerifiedLedgerRangeStart;
+    }
+
     bool
     fatalFailure()
     {
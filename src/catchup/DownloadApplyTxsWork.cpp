@@ -15,11 +15,17 @@
 #include "work/WorkWithCallback.h"
 
 #include <Tracy.hpp>
+#include <algorithm>
+#include <cmath>
 #include <fmt/format.h>
 
 namespace stellar
 {
 
+// Weight of the latest sample in the moving averages of download and apply
+// times
+static constexpr double LOOKAHEAD_EWMA_WEIGHT = 0.2;
+
 DownloadApplyTxsWork::DownloadApplyTxsWork(
     Application& app, TmpDir const& downloadDir, LedgerRange const& range,
     LedgerHeaderHistoryEntry& lastApplied, bool waitForPublish,
@@ -32,7 +38,68 @@ DownloadApplyTxsWork::DownloadApplyTxsWork(
           range.mFirst, app.getConfig()))
     , mWaitForPublish(waitForPublish)
     , mArchive(archive)
+    , mLookahead(std::clamp<size_t>(app.getConfig().MAX_CONCURRENT_SUBPROCESSES,
+                                    MIN_LOOKAHEAD, MAX_LOOKAHEAD))
+{
+}
+
+size_t
+DownloadApplyTxsWork::getLookahead(double downloadSeconds, double applySeconds)
+{
+    if (applySeconds <= 0)
+    {
+        return MAX_LOOKAHEAD;
+    }
+    // One checkpoint applying, enough downloading to finish one per apply,
+    // and one spare to absorb variance in download times
+    double needed = std::ceil(downloadSeconds / applySeconds) + 2;
+    return static_cast<size_t>(std::clamp(
+        needed, double(MIN_LOOKAHEAD), double(MAX_LOOKAHEAD)));
+}
+
+static void
+updateAverage(std::optional<double>& avg, VirtualClock::duration d)
 {
+    double sample = std::chrono::duration<double>(d).count();
+    avg = avg ? *avg + LOOKAHEAD_EWMA_WEIGHT * (sample - *avg) : sample;
+}
+
+void
+DownloadApplyTxsWork::recordDownload(VirtualClock::duration d)
+{
+    updateAverage(mDownloadSeconds, d);
+    updateLookahead();
+}
+
+void
+DownloadApplyTxsWork::recordApply(VirtualClock::duration d)
+{
+    updateAverage(mApplySeconds, d);
+    updateLookahead();
+}
+
+void
+DownloadApplyTxsWork::updateLookahead()
+{
+    if (!mDownloadSeconds || !mApplySeconds)
+    {
+        return;
+    }
+    auto lookahead = getLookahead(*mDownloadSeconds, *mApplySeconds);
+    if (lookahead != mLookahead)
+    {
+        CLOG_DEBUG(History,
+                   "Checkpoint lookahead {} -> {} (download {:.2f}s, apply "
+                   "{:.2f}s)",
+                   mLookahead, lookahead, *mDownloadSeconds, *mApplySeconds);
+        mLookahead = lookahead;
+    }
+}
+
+size_t
+DownloadApplyTxsWork::getMaxBatchSize() const
+{
+    return mLookahead;
 }
 
 std::shared_ptr<BasicWork>
@@ -59,6 +126,8 @@ DownloadApplyTxsWork::yieldMoreWork()
     TmpDir const& dir = mDownloadDir;
     uint32_t checkpoint = mCheckpointToQueue;
     auto getFileWeak = std::weak_ptr<GetAndUnzipRemoteFileWork>(getAndUnzip);
+    std::weak_ptr<DownloadApplyTxsWork> weakSelf(
+        std::static_pointer_cast<DownloadApplyTxsWork>(shared_from_this()));
 
     OnFailureCallback cb = [getFileWeak, checkpoint, &dir]() {
         auto getFile = getFileWeak.lock();
@@ -75,10 +144,46 @@ DownloadApplyTxsWork::yieldMoreWork()
         }
     };
 
+    // Offline catchups only care about the state they end at, so they replay
+    // each checkpoint as a batch
     auto apply = std::make_shared<ApplyCheckpointWork>(
-        mApp, mDownloadDir, LedgerRange::inclusive(low, high), cb);
+        mApp, mDownloadDir, LedgerRange::inclusive(low, high), cb,
+        /* batchReplay */ mWaitForPublish);
+
+    // BatchWork starts the sequence as soon as it is yielded
+    auto downloadStart = mApp.getClock().now();
+    auto downloaded = std::make_shared<WorkWithCallback>(
+        mApp, "downloaded-" + std::to_string(checkpoint),
+        [weakSelf, downloadStart](Application& app) {
+            if (auto self = weakSelf.lock())
+            {
+                self->recordDownload(app.getClock().now() - downloadStart);
+            }
+            return true;
+        });
+
+    // Time the apply itself, not the wait for the previous checkpoint
+    auto applyStart = std::make_shared<VirtualClock::time_point>();
+    auto startApply = std::make_shared<WorkWithCallback>(
+        mApp, "start-" + apply->getName(), [applyStart](Application& app) {
+            *applyStart = app.getClock().now();
+            return true;
+        });
+    auto endApply = std::make_shared<WorkWithCallback>(
+        mApp, "end-" + apply->getName(),
+        [weakSelf, applyStart](Application& app) {
+            if (auto self = weakSelf.lock())
+            {
+                self->recordApply(app.getClock().now() - *applyStart);
+            }
+            return true;
+        });
+    std::vector<std::shared_ptr<BasicWork>> applySeq{startApply, apply,
+                                                     endApply};
+    auto timedApply = std::make_shared<WorkSequence>(
+        mApp, "timed-" + apply->getName(), applySeq, BasicWork::RETRY_NEVER);
 
-    std::vector<std::shared_ptr<BasicWork>> seq{getAndUnzip};
+    std::vector<std::shared_ptr<BasicWork>> seq{getAndUnzip, downloaded};
     std::vector<FileTransferInfo> filesToTransfer{ft};
     std::vector<std::shared_ptr<BasicWork>> optionalDownloads;
 #ifdef BUILD_TESTS
@@ -177,12 +282,13 @@ DownloadApplyTxsWork::yieldMoreWork()
             return res && maybeWaitForMerges(app);
         };
         seq.push_back(std::make_shared<ConditionalWork>(
-            mApp, "conditional-" + apply->getName(), predicate, apply));
+            mApp, "conditional-" + apply->getName(), predicate, timedApply));
     }
     else
     {
         seq.push_back(std::make_shared<ConditionalWork>(
-            mApp, "wait-merges" + apply->getName(), maybeWaitForMerges, apply));
+            mApp, "wait-merges" + apply->getName(), maybeWaitForMerges,
+            timedApply));
     }
 
     for (auto const& ft : filesToTransfer)
@@ -5,9 +5,11 @@
 #pragma once
 
 #include "ledger/LedgerRange.h"
+#include "util/Timer.h"
 #include "util/XDRStream.h"
 #include "work/BatchWork.h"
 #include "xdr/Stellar-ledger.h"
+#include <optional>
 
 namespace medida
 {
@@ -21,6 +23,11 @@ class TmpDir;
 class HistoryArchive;
 struct LedgerHeaderHistoryEntry;
 
+// Downloads and applies the transactions of a range of checkpoints. Checkpoints
+// are applied one at a time, in order, while the following ones download. The
+// number of checkpoints in flight adapts to how long checkpoints take to
+// download versus apply, so that apply does not wait on the network when
+// downloads are slow and downloaded files do not pile up when they are fast.
 class DownloadApplyTxsWork : public BatchWork
 {
     LedgerRange const mRange;
@@ -31,7 +38,25 @@ class DownloadApplyTxsWork : public BatchWork
     bool const mWaitForPublish;
     std::shared_ptr<HistoryArchive> mArchive;
 
+    // Moving averages of the time it takes to download and to apply one
+    // checkpoint, in seconds
+    std::optional<double> mDownloadSeconds;
+    std::optional<double> mApplySeconds;
+    size_t mLookahead;
+
+    void recordDownload(VirtualClock::duration d);
+    void recordApply(VirtualClock::duration d);
+    void updateLookahead();
+
   public:
+    static constexpr size_t MIN_LOOKAHEAD = 2;
+    static constexpr size_t MAX_LOOKAHEAD = 64;
+
+    // Number of checkpoints needed in flight so that, given one checkpoint
+    // takes `downloadSeconds` to download and `applySeconds` to apply, the
+    // next one has downloaded by the time the current one has applied
+    static size_t getLookahead(double downloadSeconds, double applySeconds);
+
     DownloadApplyTxsWork(Application& app, TmpDir const& downloadDir,
                          LedgerRange const& range,
                          LedgerHeaderHistoryEntry& lastApplied,
@@ -45,5 +70,6 @@ class DownloadApplyTxsWork : public BatchWork
     std::shared_ptr<BasicWork> yieldMoreWork() override;
     void resetIter() override;
     void onSuccess() override;
+    size_t getMaxBatchSize() const override;
 };
 }
\ No newline at end of file
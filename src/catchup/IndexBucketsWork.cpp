@@ -6,135 +6,101 @@
 #include "bucket/BucketManager.h"
 #include "bucket/HotArchiveBucket.h"
 #include "bucket/LiveBucket.h"
+#include "main/Application.h"
 #include "util/Fs.h"
+#include "util/IORateLimiter.h"
 #include "util/Logging.h"
 #include "util/UnorderedSet.h"
+#include "util/types.h"
 #include <Tracy.hpp>
+#include <fmt/format.h>
+#include <medida/meter.h>
+#include <medida/metrics_registry.h>
 
 namespace stellar
 {
 template <class BucketT>
 IndexBucketsWork<BucketT>::IndexWork::IndexWork(Application& app,
+                                                IndexBucketsWork& parent,
                                                 std::shared_ptr<BucketT> b)
-    : BasicWork(app, "index-work", BasicWork::RETRY_NEVER), mBucket(b)
+    : BackgroundWork(app, "index-work", BasicWork::RETRY_NEVER,
+                     BackgroundWorkClass::MERGE)
+    , mParent(parent)
+    , mBucket(b)
 {
 }
 
 template <class BucketT>
-BasicWork::State
-IndexBucketsWork<BucketT>::IndexWork::onRun()
+void
+IndexBucketsWork<BucketT>::IndexWork::onReset()
 {
-    if (mState == State::WORK_WAITING)
-    {
-        postWork();
-    }
-
-    return mState;
+    BackgroundWork::onReset();
+    mIndex.reset();
 }
 
 template <class BucketT>
-bool
-IndexBucketsWork<BucketT>::IndexWork::onAbort()
+BasicWork::State
+IndexBucketsWork<BucketT>::IndexWork::runInBackground()
 {
-    return true;
-};
+    auto& bm = mApp.getBucketManager();
+    auto indexFilename = bm.bucketIndexFilename(mBucket->getHash());
 
-template <class BucketT>
-void
-IndexBucketsWork<BucketT>::IndexWork::onReset()
-{
-    mState = BasicWork::State::WORK_WAITING;
+    if (bm.getConfig().BUCKETLIST_DB_PERSIST_INDEX && fs::exists(indexFilename))
+    {
+        try
+        {
+            mIndex = loadIndex<BucketT>(bm, indexFilename, mBucket->getSize());
+        }
+        // If we get an exception from an invalid index file, ignore it and
+        // reindex the Bucket.
+        catch (std::runtime_error&)
+        {
+            CLOG_WARNING(Bucket, "Invalid or corrupt index file: {}",
+                         indexFilename);
+        }
+
+        // If we could not load the index from the file, file is out of date.
+        // Delete and create a new index.
+        if (!mIndex)
+        {
+            CLOG_WARNING(Bucket, "Outdated index file: {}", indexFilename);
+            fs::removeWithLog(indexFilename, /*ignoreEnoent=*/true);
+        }
+        else
+        {
+            CLOG_DEBUG(Bucket, "Loaded index from file: {}", indexFilename);
+        }
+    }
+
+    if (!mIndex)
+    {
+        mIndex = createIndex<BucketT>(
+            bm, mBucket->getFilename(), mBucket->getHash(),
+            mApp.getWorkerIOContext(), nullptr, nullptr,
+            &bm.getIndexBuildRateLimiter());
+    }
+    return mIndex ? State::WORK_SUCCESS : State::WORK_FAILURE;
 }
 
 template <class BucketT>
-void
-IndexBucketsWork<BucketT>::IndexWork::postWork()
+BasicWork::State
+IndexBucketsWork<BucketT>::IndexWork::onBackgroundDone(State result)
 {
-    Application& app = this->mApp;
-    asio::io_context& ctx = app.getWorkerIOContext();
-
-    std::weak_ptr<IndexWork> weak(
-        std::static_pointer_cast<IndexWork>(shared_from_this()));
-    app.postOnBackgroundThread(
-        [&app, &ctx, weak]() {
-            auto self = weak.lock();
-            if (!self || self->isAborting())
-            {
-                return;
-            }
-
-            auto& bm = app.getBucketManager();
-            auto indexFilename =
-                bm.bucketIndexFilename(self->mBucket->getHash());
-
-            if (bm.getConfig().BUCKETLIST_DB_PERSIST_INDEX &&
-                fs::exists(indexFilename))
-            {
-                try
-                {
-                    self->mIndex = loadIndex<BucketT>(bm, indexFilename,
-                                                      self->mBucket->getSize());
-                }
-                // If we get an exception from an invalid index file, ignore it
-                // and reindex the Bucket.
-                catch (std::runtime_error&)
-                {
-                    CLOG_WARNING(Bucket, "Invalid or corrupt index file: {}",
-                                 indexFilename);
-                }
-
-                // If we could not load the index from the file, file is out of
-                // date. Delete and create a new index.
-                if (!self->mIndex)
-                {
-                    CLOG_WARNING(Bucket, "Outdated index file: {}",
-                                 indexFilename);
-                    fs::removeWithLog(indexFilename, /*ignoreEnoent=*/true);
-                }
-                else
-                {
-                    CLOG_DEBUG(Bucket, "Loaded index from file: {}",
-                               indexFilename);
-                }
-            }
-
-            if (!self->mIndex)
-            {
-                self->mIndex = createIndex<BucketT>(
-                    bm, self->mBucket->getFilename(), self->mBucket->getHash(),
-                    ctx, nullptr);
-            }
-
-            app.postOnMainThread(
-                [weak]() {
-                    auto self = weak.lock();
-                    if (self)
-                    {
-                        if (self->mIndex)
-                        {
-                            self->mState = BasicWork::State::WORK_SUCCESS;
-                            if (!self->isAborting())
-                            {
-                                self->mApp.getBucketManager().maybeSetIndex(
-                                    self->mBucket, std::move(self->mIndex));
-                            }
-                        }
-                        else
-                        {
-                            self->mState = BasicWork::State::WORK_FAILURE;
-                        }
-                        self->wakeUp();
-                    }
-                },
-                "IndexWork: finished");
-        },
-        "IndexWork: starting in background");
+    if (result == State::WORK_SUCCESS)
+    {
+        mApp.getBucketManager().maybeSetIndex(mBucket, std::move(mIndex));
+        mParent.onIndexed(mBucket->getSize());
+    }
+    return result;
 }
 
 template <class BucketT>
 IndexBucketsWork<BucketT>::IndexBucketsWork(
     Application& app, std::vector<std::shared_ptr<BucketT>> const& buckets)
-    : Work(app, "index-bucketList", BasicWork::RETRY_NEVER), mBuckets(buckets)
+    : Work(app, "index-bucketList", BasicWork::RETRY_NEVER)
+    , mBuckets(buckets)
+    , mIndexedBytesMeter(app.getMetrics().NewMeter(
+          {"bucketlistDB", "index-build", "bytes"}, "byte"))
 {
 }
 
@@ -147,7 +113,14 @@ IndexBucketsWork<BucketT>::doWork()
         spawnWork();
     }
 
-    return checkChildrenStatus();
+    auto state = checkChildrenStatus();
+    if (state == State::WORK_SUCCESS && mTotalBuckets > 0)
+    {
+        CLOG_INFO(Bucket, "Indexed {} buckets, {}, at {:.1f} MB/s",
+                  mIndexedBuckets, formatSize(mIndexedSize),
+                  megabytesPerSecond());
+    }
+    return state;
 }
 
 template <class BucketT>
@@ -155,6 +128,56 @@ void
 IndexBucketsWork<BucketT>::doReset()
 {
     mWorkSpawned = false;
+    mTotalBuckets = mTotalSize = 0;
+    mIndexedBuckets = mIndexedSize = 0;
+    mLastLoggedPercent = 0;
+}
+
+template <class BucketT>
+void
+IndexBucketsWork<BucketT>::onIndexed(size_t bucketSize)
+{
+    ++mIndexedBuckets;
+    mIndexedSize += bucketSize;
+    mIndexedBytesMeter.Mark(bucketSize);
+
+    // Log every 10% of the bytes to index
+    auto percent = mTotalSize == 0 ? 100 : 100 * mIndexedSize / mTotalSize;
+    if (percent / 10 > mLastLoggedPercent / 10)
+    {
+        mLastLoggedPercent = percent;
+        CLOG_INFO(Bucket,
+                  "Bucket-index: {}/{} in {}/{} files ({}%), {:.1f} MB/s",
+                  formatSize(mIndexedSize), formatSize(mTotalSize),
+                  mIndexedBuckets, mTotalBuckets, percent,
+                  megabytesPerSecond());
+    }
+}
+
+template <class BucketT>
+double
+IndexBucketsWork<BucketT>::megabytesPerSecond() const
+{
+    std::chrono::duration<double> elapsed = mApp.getClock().now() - mStart;
+    if (elapsed.count() <= 0)
+    {
+        return 0;
+    }
+    return static_cast<double>(mIndexedSize) / 1024 / 1024 / elapsed.count();
+}
+
+template <class BucketT>
+std::string
+IndexBucketsWork<BucketT>::getStatus() const
+{
+    if (mWorkSpawned && !isDone() && mTotalSize > 0)
+    {
+        return fmt::format(
+            FMT_STRING("Indexing buckets {:d}% ({:d}/{:d} files, {:.1f} MB/s)"),
+            100 * mIndexedSize / mTotalSize, mIndexedBuckets, mTotalBuckets,
+            megabytesPerSecond());
+    }
+    return Work::getStatus();
 }
 
 template <class BucketT>
@@ -175,9 +198,12 @@ IndexBucketsWork<BucketT>::spawnWork()
             return;
         }
 
-        addWork<IndexWork>(b);
+        ++mTotalBuckets;
+        mTotalSize += b->getSize();
+        addWork<IndexWork>(*this, b);
     };
 
+    mStart = mApp.getClock().now();
     for (auto const& b : mBuckets)
     {
         spawnIndexWork(b);
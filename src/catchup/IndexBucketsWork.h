@@ -4,10 +4,16 @@
 
 #pragma once
 
-#include "work/BasicWork.h"
+#include "util/Timer.h"
+#include "work/BackgroundWork.h"
 #include "work/Work.h"
 #include <memory>
 
+namespace medida
+{
+class Meter;
+}
+
 namespace stellar
 {
 
@@ -15,22 +21,25 @@ class Bucket;
 class LiveBucketIndex;
 class BucketManager;
 
+// Indexes buckets concurrently, one bucket per worker thread. Buckets that
+// need to be read to be indexed share the disk budget of
+// BUCKETLIST_DB_INDEX_BUILD_RATE. Progress and throughput are logged as
+// buckets complete.
 template <class BucketT> class IndexBucketsWork : public Work
 {
-    class IndexWork : public BasicWork
+    class IndexWork : public BackgroundWork
     {
+        IndexBucketsWork& mParent;
         std::shared_ptr<BucketT> mBucket;
         std::unique_ptr<typename BucketT::IndexT const> mIndex;
-        BasicWork::State mState{BasicWork::State::WORK_WAITING};
-
-        void postWork();
 
       public:
-        IndexWork(Application& app, std::shared_ptr<BucketT> b);
+        IndexWork(Application& app, IndexBucketsWork& parent,
+                  std::shared_ptr<BucketT> b);
 
       protected:
-        State onRun() override;
-        bool onAbort() override;
+        State runInBackground() override;
+        State onBackgroundDone(State result) override;
         void onReset() override;
     };
 
@@ -39,10 +48,24 @@ template <class BucketT> class IndexBucketsWork : public Work
     bool mWorkSpawned{false};
     void spawnWork();
 
+    medida::Meter& mIndexedBytesMeter;
+    VirtualClock::time_point mStart;
+    size_t mTotalBuckets{0};
+    size_t mTotalSize{0};
+    size_t mIndexedBuckets{0};
+    size_t mIndexedSize{0};
+    size_t mLastLoggedPercent{0};
+
+    // Called on the main thread as each IndexWork succeeds
+    void onIndexed(size_t bucketSize);
+    double megabytesPerSecond() const;
+
   public:
     IndexBucketsWork(Application& app,
                      std::vector<std::shared_ptr<BucketT>> const& buckets);
 
+    std::string getStatus() const override;
+
   protected:
     State doWork() override;
     void doReset() override;
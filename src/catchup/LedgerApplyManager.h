@@ -77,6 +77,9 @@ class LedgerApplyManager
     // Return state of the CatchupWork object
     virtual BasicWork::State getCatchupWorkState() const = 0;
     virtual bool catchupWorkIsDone() const = 0;
+    // Ledger whose bucket state the current catchup applied, if it did
+    virtual std::optional<LedgerHeaderHistoryEntry>
+    getCatchupAppliedBucketsLedger() const = 0;
     virtual bool isCatchupInitialized() const = 0;
 
     // Emit a log message and set StatusManager HISTORY_CATCHUP status to
@@ -14,9 +14,12 @@
 #include "main/Application.h"
 #include "medida/meter.h"
 #include "medida/metrics_registry.h"
+#include "util/Fs.h"
 #include "util/GlobalChecks.h"
 #include "util/Logging.h"
 #include "util/StatusManager.h"
+#include "util/TmpDir.h"
+#include "util/XDRStream.h"
 #include "work/WorkScheduler.h"
 #include <Tracy.hpp>
 #include <chrono>
@@ -74,11 +77,10 @@ template <typename T>
 T
 findFirstCheckpoint(T begin, T end, HistoryManager const& hm)
 {
-    return std::find_if(begin, end,
-                        [&hm](std::pair<uint32_t, LedgerCloseData> const& kvp) {
-                            return HistoryManager::isFirstLedgerInCheckpoint(
-                                kvp.first, hm.getConfig());
-                        });
+    return std::find_if(begin, end, [&hm](auto const& kvp) {
+        return HistoryManager::isFirstLedgerInCheckpoint(kvp.first,
+                                                         hm.getConfig());
+    });
 }
 
 std::unique_ptr<LedgerApplyManager>
@@ -92,6 +94,8 @@ LedgerApplyManagerImpl::LedgerApplyManagerImpl(Application& app)
     , mCatchupWork(nullptr)
     , mSyncingLedgersSize(
           app.getMetrics().NewCounter({"ledger", "memory", "queued-ledgers"}))
+    , mSpilledLedgers(app.getMetrics().NewMeter(
+          {"ledger", "memory", "spilled-ledgers"}, "ledger"))
     , mLargestLedgerSeqHeard(0)
 {
     releaseAssert(threadIsMain());
@@ -145,7 +149,7 @@ LedgerApplyManagerImpl::processLedger(LedgerCloseData const& ledgerData,
     }
 
     // Always add a newer ledger, maybe apply
-    mSyncingLedgers.emplace(lastReceivedLedgerSeq, ledgerData);
+    bufferLedger(ledgerData);
     mLargestLedgerSeqHeard =
         std::max(mLargestLedgerSeqHeard, lastReceivedLedgerSeq);
 
@@ -318,6 +322,17 @@ LedgerApplyManagerImpl::catchupWorkIsDone() const
     return mCatchupWork && mCatchupWork->isDone();
 }
 
+std::optional<LedgerHeaderHistoryEntry>
+LedgerApplyManagerImpl::getCatchupAppliedBucketsLedger() const
+{
+    releaseAssert(threadIsMain());
+    if (!mCatchupWork)
+    {
+        return std::nullopt;
+    }
+    return mCatchupWork->getAppliedBucketsLedger();
+}
+
 bool
 LedgerApplyManagerImpl::isCatchupInitialized() const
 {
@@ -370,7 +385,7 @@ LedgerApplyManagerImpl::maybeGetNextBufferedLedgerToApply()
         mSyncingLedgers.begin()->first == *mLastQueuedToApply + 1)
     {
         return std::make_optional<LedgerCloseData>(
-            mSyncingLedgers.begin()->second);
+            loadBufferedLedger(mSyncingLedgers.begin()->second));
     }
     else
     {
@@ -385,7 +400,7 @@ LedgerApplyManagerImpl::maybeGetLargestBufferedLedger()
     if (!mSyncingLedgers.empty())
     {
         return std::make_optional<LedgerCloseData>(
-            mSyncingLedgers.crbegin()->second);
+            loadBufferedLedger(mSyncingLedgers.crbegin()->second));
     }
     else
     {
@@ -415,6 +430,133 @@ LedgerApplyManagerImpl::syncMetrics()
     mSyncingLedgersSize.set_count(mSyncingLedgers.size());
 }
 
+std::string
+LedgerApplyManagerImpl::spillFilePath() const
+{
+    return mSpillDir->getName() + "/buffered-ledgers.xdr";
+}
+
+void
+LedgerApplyManagerImpl::bufferLedger(LedgerCloseData const& ledgerData)
+{
+    ZoneScoped;
+    auto seq = ledgerData.getLedgerSeq();
+    if (mSyncingLedgers.find(seq) != mSyncingLedgers.end())
+    {
+        return;
+    }
+
+    BufferedLedger buffered;
+    buffered.mTxSetSize = ledgerData.getTxSet()->encodedSize();
+    buffered.mPreviousLedgerHash =
+        ledgerData.getTxSet()->previousLedgerHash();
+    buffered.mExpectedLedgerHash = ledgerData.getExpectedHash();
+
+    // The ledger right after the last one queued is applied at once, there's
+    // no point in spilling it
+    size_t limit =
+        static_cast<size_t>(mApp.getConfig().BUFFERED_LEDGERS_MEMORY_LIMIT_MB)
+        << 20;
+#ifdef BUILD_TESTS
+    if (mBufferedTxSetsLimit)
+    {
+        limit = *mBufferedTxSetsLimit;
+    }
+#endif
+    bool spill = limit != 0 && seq != *mLastQueuedToApply + 1 &&
+                 mBufferedTxSetsSize + buffered.mTxSetSize > limit;
+#ifdef BUILD_TESTS
+    // Expected results aren't part of StoredDebugTransactionSet either
+    spill = spill && !ledgerData.getExpectedResults();
+#endif
+    if (!spill)
+    {
+        mBufferedTxSetsSize += buffered.mTxSetSize;
+        buffered.mData = std::make_optional<LedgerCloseData>(ledgerData);
+        mSyncingLedgers.emplace(seq, std::move(buffered));
+        return;
+    }
+
+    if (!mSpillOut)
+    {
+        if (!mSpillDir)
+        {
+            mSpillDir = std::make_unique<TmpDir>(
+                mApp.getTmpDirManager().tmpDir("buffered-ledgers"));
+        }
+        mSpillOut = std::make_unique<XDROutputFileStream>(
+            mApp.getClock().getIOContext(), /* fsyncOnClose */ false);
+        mSpillOut->open(spillFilePath());
+        mSpillFileSize = 0;
+    }
+    size_t bytesPut = 0;
+    mSpillOut->writeOne(ledgerData.toXDR(), nullptr, &bytesPut);
+    buffered.mSpillOffset = mSpillFileSize;
+    mSpillFileSize += bytesPut;
+    ++mSpilledLedgersCount;
+    mSpilledLedgers.Mark();
+    mSyncingLedgers.emplace(seq, std::move(buffered));
+    CLOG_DEBUG(Ledger, "Spilled buffered ledger {} ({} bytes)", seq, bytesPut);
+}
+
+LedgerCloseData
+LedgerApplyManagerImpl::loadBufferedLedger(BufferedLedger const& buffered)
+{
+    ZoneScoped;
+    if (!buffered.isSpilled())
+    {
+        return *buffered.mData;
+    }
+
+    mSpillOut->flush();
+    XDRInputFileStream in(0, /*sequential=*/false);
+    in.open(spillFilePath());
+    in.seek(buffered.mSpillOffset);
+    StoredDebugTransactionSet sts;
+    if (!in.readOne(sts))
+    {
+        throw std::runtime_error(
+            fmt::format(FMT_STRING("Could not read back buffered ledger at "
+                                   "offset {:d} of {}"),
+                        buffered.mSpillOffset, spillFilePath()));
+    }
+    auto lcd = LedgerCloseData::toLedgerCloseData(sts);
+    if (!buffered.mExpectedLedgerHash)
+    {
+        return lcd;
+    }
+    return LedgerCloseData(lcd.getLedgerSeq(), lcd.getTxSet(), lcd.getValue(),
+                           buffered.mExpectedLedgerHash);
+}
+
+void
+LedgerApplyManagerImpl::eraseSyncingLedgers(
+    std::map<uint32_t, BufferedLedger>::iterator end)
+{
+    for (auto it = mSyncingLedgers.begin(); it != end; ++it)
+    {
+        if (it->second.isSpilled())
+        {
+            releaseAssert(mSpilledLedgersCount > 0);
+            --mSpilledLedgersCount;
+        }
+        else
+        {
+            releaseAssert(mBufferedTxSetsSize >= it->second.mTxSetSize);
+            mBufferedTxSetsSize -= it->second.mTxSetSize;
+        }
+    }
+    mSyncingLedgers.erase(mSyncingLedgers.begin(), end);
+
+    // Start the spill file afresh once nothing in it is needed anymore
+    if (mSpilledLedgersCount == 0 && mSpillOut)
+    {
+        mSpillOut->close();
+        mSpillOut.reset();
+        fs::removeWithLog(spillFilePath());
+    }
+}
+
 void
 LedgerApplyManagerImpl::updateLastQueuedToApply()
 {
@@ -440,9 +582,9 @@ LedgerApplyManagerImpl::startOnlineCatchup()
     // catchup just before first buffered ledger that way we will have a
     // way to verify history consistency - compare previousLedgerHash of
     // buffered ledger with last one downloaded from history
-    auto const& lcd = mSyncingLedgers.begin()->second;
-    auto firstBufferedLedgerSeq = lcd.getLedgerSeq();
-    auto hash = std::make_optional<Hash>(lcd.getTxSet()->previousLedgerHash());
+    auto firstBufferedLedgerSeq = mSyncingLedgers.begin()->first;
+    auto hash = std::make_optional<Hash>(
+        mSyncingLedgers.begin()->second.mPreviousLedgerHash);
     startCatchup({LedgerNumHashPair(firstBufferedLedgerSeq - 1, hash),
                   getCatchupCount(), CatchupConfiguration::Mode::ONLINE},
                  nullptr);
@@ -458,7 +600,7 @@ LedgerApplyManagerImpl::trimSyncingLedgers()
         // `ledger` if exists, or the first one after `ledger`.
         auto it = mSyncingLedgers.lower_bound(ledger);
         // This erases [begin, it).
-        mSyncingLedgers.erase(mSyncingLedgers.begin(), it);
+        eraseSyncingLedgers(it);
     };
     removeLedgersLessThan(*mLastQueuedToApply + 1);
     if (!mSyncingLedgers.empty())
@@ -499,13 +641,11 @@ LedgerApplyManagerImpl::tryApplySyncingLedgers()
 
     // We can apply multiple ledgers here, which might be slow. This is a rare
     // occurrence so we should be fine.
-    auto it = mSyncingLedgers.cbegin();
-    while (it != mSyncingLedgers.cend())
+    auto it = mSyncingLedgers.begin();
+    while (it != mSyncingLedgers.end())
     {
-        auto const& lcd = it->second;
-
         // we still have a missing ledger
-        if (nextToApply != lcd.getLedgerSeq())
+        if (nextToApply != it->first)
         {
             break;
         }
@@ -522,6 +662,7 @@ LedgerApplyManagerImpl::tryApplySyncingLedgers()
             break;
         }
 
+        auto lcd = loadBufferedLedger(it->second);
         if (mApp.getConfig().parallelLedgerClose())
         {
             // Notify LM that application has started
@@ -548,7 +689,7 @@ LedgerApplyManagerImpl::tryApplySyncingLedgers()
         ++nextToApply;
     }
 
-    mSyncingLedgers.erase(mSyncingLedgers.cbegin(), it);
+    eraseSyncingLedgers(it);
 }
 
 void
@@ -18,7 +18,33 @@ namespace stellar
 {
 
 class Application;
+class TmpDir;
 class Work;
+class XDROutputFileStream;
+
+// A ledger buffered by LedgerApplyManagerImpl. Its data is either held in
+// memory or, once the buffered tx sets exceed
+// BUFFERED_LEDGERS_MEMORY_LIMIT_MB, spilled to a temporary file from which it
+// is read back when applied.
+struct BufferedLedger
+{
+    std::optional<LedgerCloseData> mData;
+    // Offset of the StoredDebugTransactionSet of a spilled ledger in the
+    // spill file
+    size_t mSpillOffset{0};
+    // Encoded size of the tx set, counted against the memory limit while the
+    // ledger is in memory
+    size_t mTxSetSize{0};
+    Hash mPreviousLedgerHash;
+    // Not part of StoredDebugTransactionSet, kept aside for spilled ledgers
+    std::optional<Hash> mExpectedLedgerHash;
+
+    bool
+    isSpilled() const
+    {
+        return !mData;
+    }
+};
 
 class LedgerApplyManagerImpl : public LedgerApplyManager
 {
@@ -46,9 +72,24 @@ class LedgerApplyManagerImpl : public LedgerApplyManager
     // There are two methods that modify mSyncingLedgers
     // (trimSyncingLedgers, tryApplySyncingLedgers) and they both
     // maintain the invariants above.
-    std::map<uint32_t, LedgerCloseData> mSyncingLedgers;
+    std::map<uint32_t, BufferedLedger> mSyncingLedgers;
     medida::Counter& mSyncingLedgersSize;
 
+    // Total size of the tx sets of the in-memory buffered ledgers, and the
+    // spill file holding the others. The file is started afresh whenever no
+    // spilled ledger is left in mSyncingLedgers.
+    size_t mBufferedTxSetsSize{0};
+    size_t mSpilledLedgersCount{0};
+    std::unique_ptr<TmpDir> mSpillDir;
+    std::unique_ptr<XDROutputFileStream> mSpillOut;
+    size_t mSpillFileSize{0};
+    medida::Meter& mSpilledLedgers;
+
+    std::string spillFilePath() const;
+    void bufferLedger(LedgerCloseData const& ledgerData);
+    LedgerCloseData loadBufferedLedger(BufferedLedger const& buffered);
+    void eraseSyncingLedgers(std::map<uint32_t, BufferedLedger>::iterator end);
+
     // These state variables track the flow of ledgers through mSyncingLedgers,
     // they are the variables Q and L in the diagram in LedgerManager.h. See
     // that diagram for details and discussion of the threading model and
@@ -81,6 +122,8 @@ class LedgerApplyManagerImpl : public LedgerApplyManager
 
     BasicWork::State getCatchupWorkState() const override;
     bool catchupWorkIsDone() const override;
+    std::optional<LedgerHeaderHistoryEntry>
+    getCatchupAppliedBucketsLedger() const override;
     bool isCatchupInitialized() const override;
 
     void logAndUpdateCatchupStatus(bool contiguous,
@@ -108,7 +151,7 @@ class LedgerApplyManagerImpl : public LedgerApplyManager
     void fileDownloaded(FileType type, uint32_t num) override;
 
 #ifdef BUILD_TESTS
-    std::map<uint32_t, LedgerCloseData> const&
+    std::map<uint32_t, BufferedLedger> const&
     getBufferedLedgers() const
     {
         return mSyncingLedgers;
@@ -126,6 +169,9 @@ class LedgerApplyManagerImpl : public LedgerApplyManager
         return mCatchupFatalFailure;
     }
 
+    // Overrides BUFFERED_LEDGERS_MEMORY_LIMIT_MB, in bytes
+    std::optional<size_t> mBufferedTxSetsLimit;
+
     std::optional<uint32_t> mMaxExternalizeApplyBuffer;
     uint32_t
     getMaxExternalizeApplyBuffer()
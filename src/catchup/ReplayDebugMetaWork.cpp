@@ -14,12 +14,64 @@
 #include "util/DebugMetaUtils.h"
 #include "util/GlobalChecks.h"
 #include "util/XDRStream.h"
+#include <deque>
+#include <map>
 #include <regex>
 
 namespace stellar
 {
 
-// Helper class to apply ledgers from a single debug meta file
+// Ledgers decoded by one background job
+static constexpr size_t REPLAY_DECODE_BATCH_SIZE = 16;
+// Ledgers read from a meta file ahead of the one being applied, bounding the
+// memory used while decoding runs ahead of apply
+static constexpr size_t REPLAY_MAX_LEDGERS_AHEAD = 256;
+
+ReplayLedger
+decodeForReplay(std::vector<char> const& raw)
+{
+    ZoneScoped;
+    xdr::xdr_get g(raw.data(), raw.data() + raw.size());
+    int32_t v = 0;
+    xdr::xdr_argpack_archive(g, v);
+
+    ReplayLedger ledger;
+    LedgerHeaderHistoryEntry header;
+    if (v == 0)
+    {
+        TransactionSet txSet;
+        xdr::xdr_argpack_archive(g, header, txSet);
+        ledger.mTxSet = TxSetXDRFrame::makeFromWire(txSet);
+    }
+    else if (v == 1 || v == 2)
+    {
+        LedgerCloseMetaExt ext;
+        GeneralizedTransactionSet txSet;
+        xdr::xdr_argpack_archive(g, ext, header, txSet);
+        ledger.mTxSet = TxSetXDRFrame::makeFromWire(txSet);
+    }
+    else
+    {
+        throw std::runtime_error(
+            fmt::format(FMT_STRING("unknown LedgerCloseMeta version {}"), v));
+    }
+    ledger.mHeader = header.header;
+    return ledger;
+}
+
+namespace
+{
+struct ReplayBatch
+{
+    std::vector<std::vector<char>> mRaw;
+    std::vector<ReplayLedger> mLedgers;
+    std::exception_ptr mException;
+};
+}
+
+// Helper class to apply ledgers from a single debug meta file. Records are
+// read from the file on the main thread and decoded in batches on background
+// threads, at most REPLAY_MAX_LEDGERS_AHEAD ledgers ahead of apply.
 class ApplyLedgersFromMetaWork : public Work
 {
     XDRInputFileStream mMetaIn;
@@ -28,6 +80,76 @@ class ApplyLedgersFromMetaWork : public Work
     std::shared_ptr<ApplyLedgerWork> mApplyLedgerWork;
     uint32_t const mTargetLedger;
 
+    bool mAllRead{false};
+    // Ledgers read from the file but not applied yet
+    size_t mLedgersAhead{0};
+    uint64_t mNextBatchToRead{0};
+    uint64_t mNextBatchToApply{0};
+    // Decoded batches not consumed yet, keyed by their position in the file
+    std::map<uint64_t, std::shared_ptr<ReplayBatch>> mDecoded;
+    std::deque<ReplayLedger> mReady;
+    // Bumped on reset, so that results of batches started before are dropped
+    uint64_t mGeneration{0};
+
+    void
+    startDecoding()
+    {
+        std::weak_ptr<ApplyLedgersFromMetaWork> weak(
+            std::static_pointer_cast<ApplyLedgersFromMetaWork>(
+                shared_from_this()));
+        while (!mAllRead && mLedgersAhead + REPLAY_DECODE_BATCH_SIZE <=
+                                REPLAY_MAX_LEDGERS_AHEAD)
+        {
+            auto batch = std::make_shared<ReplayBatch>();
+            std::vector<char> raw;
+            while (batch->mRaw.size() < REPLAY_DECODE_BATCH_SIZE &&
+                   mMetaIn.readRaw(raw))
+            {
+                batch->mRaw.emplace_back(std::move(raw));
+                raw.clear();
+            }
+            if (batch->mRaw.size() < REPLAY_DECODE_BATCH_SIZE)
+            {
+                mAllRead = true;
+            }
+            if (batch->mRaw.empty())
+            {
+                break;
+            }
+
+            mLedgersAhead += batch->mRaw.size();
+            mApp.postOnBackgroundThread(
+                [&app = mApp, weak, generation = mGeneration,
+                 index = mNextBatchToRead++, batch]() {
+                    try
+                    {
+                        for (auto const& raw : batch->mRaw)
+                        {
+                            batch->mLedgers.emplace_back(decodeForReplay(raw));
+                        }
+                    }
+                    catch (...)
+                    {
+                        batch->mException = std::current_exception();
+                    }
+                    batch->mRaw.clear();
+                    app.postOnMainThread(
+                        [weak, generation, index, batch]() {
+                            auto self = weak.lock();
+                            if (!self || self->mGeneration != generation)
+                            {
+                                return;
+                            }
+                            self->mDecoded.emplace(index, batch);
+                            self->wakeUp();
+                        },
+                        "ReplayDebugMeta: decoded ledgers");
+                },
+                "ReplayDebugMeta: decode ledgers",
+                BackgroundWorkClass::APPLY);
+        }
+    }
+
   public:
     ApplyLedgersFromMetaWork(Application& app,
                              std::filesystem::path const& unzippedMetaFile,
@@ -48,6 +170,13 @@ class ApplyLedgersFromMetaWork : public Work
         mMetaIn.close();
         mFileOpen = false;
         mApplyLedgerWork.reset();
+        ++mGeneration;
+        mAllRead = false;
+        mLedgersAhead = 0;
+        mNextBatchToRead = 0;
+        mNextBatchToApply = 0;
+        mDecoded.clear();
+        mReady.clear();
     }
 
     State
@@ -79,31 +208,37 @@ class ApplyLedgersFromMetaWork : public Work
             return BasicWork::State::WORK_SUCCESS;
         }
 
-        // Invariant: ledger close meta can't have gaps, so here reading should
-        // always yield the next ledger
-        LedgerCloseMeta lcm;
-        if (!mMetaIn.readOne(lcm))
+        startDecoding();
+        if (mReady.empty())
         {
-            // Reached the end of the stream, success
-            return BasicWork::State::WORK_SUCCESS;
-        }
-
-        auto getLedgerHeader =
-            [](LedgerCloseMeta const& lcm) -> LedgerHeader const& {
-            switch (lcm.v())
+            auto it = mDecoded.find(mNextBatchToApply);
+            if (it == mDecoded.end())
+            {
+                if (mAllRead && mLedgersAhead == 0)
+                {
+                    // Reached the end of the stream, success
+                    return BasicWork::State::WORK_SUCCESS;
+                }
+                return BasicWork::State::WORK_WAITING;
+            }
+            auto batch = it->second;
+            mDecoded.erase(it);
+            ++mNextBatchToApply;
+            if (batch->mException)
             {
-            case 0:
-                return lcm.v0().ledgerHeader.header;
-            case 1:
-                return lcm.v1().ledgerHeader.header;
-            case 2:
-                return lcm.v2().ledgerHeader.header;
-            default:
-                releaseAssert(false);
+                std::rethrow_exception(batch->mException);
             }
-        };
+            mReady.insert(mReady.end(),
+                          std::make_move_iterator(batch->mLedgers.begin()),
+                          std::make_move_iterator(batch->mLedgers.end()));
+        }
 
-        auto const& lh = getLedgerHeader(lcm);
+        // Invariant: ledger close meta can't have gaps, so here reading should
+        // always yield the next ledger
+        auto ledger = std::move(mReady.front());
+        mReady.pop_front();
+        --mLedgersAhead;
+        auto const& lh = ledger.mHeader;
 
         auto ledgerSeqToApply = lh.ledgerSeq;
         auto lcl = mApp.getLedgerManager().getLastClosedLedgerNum();
@@ -123,21 +258,8 @@ class ApplyLedgersFromMetaWork : public Work
             return BasicWork::State::WORK_FAILURE;
         }
 
-        TxSetXDRFrameConstPtr txSet;
-        if (lcm.v() == 0)
-        {
-            txSet = TxSetXDRFrame::makeFromWire(lcm.v0().txSet);
-        }
-        else if (lcm.v() == 1)
-        {
-            txSet = TxSetXDRFrame::makeFromWire(lcm.v1().txSet);
-        }
-        else
-        {
-            txSet = TxSetXDRFrame::makeFromWire(lcm.v2().txSet);
-        }
-
-        LedgerCloseData ledgerCloseData(ledgerSeqToApply, txSet, lh.scpValue);
+        LedgerCloseData ledgerCloseData(ledgerSeqToApply, ledger.mTxSet,
+                                        lh.scpValue);
 
         releaseAssert(!mApplyLedgerWork);
         mApplyLedgerWork = addWork<ApplyLedgerWork>(ledgerCloseData);
@@ -148,8 +270,11 @@ class ApplyLedgersFromMetaWork : public Work
     onSuccess() override
     {
         // Close the stream just in case Work is kept alive for some time before
-        // it's garbage-collected
+        // it's garbage-collected, and drop batches decoded past the target
         mMetaIn.close();
+        ++mGeneration;
+        mDecoded.clear();
+        mReady.clear();
     }
 };
 
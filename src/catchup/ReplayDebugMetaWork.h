@@ -4,9 +4,11 @@
 
 #pragma once
 
+#include "herder/TxSetFrame.h"
 #include "main/Application.h"
 #include "work/Work.h"
 #include <filesystem>
+#include <vector>
 
 namespace stellar
 {
@@ -14,6 +16,18 @@ namespace stellar
 class CatchupWork;
 class WorkSequence;
 
+// The parts of a LedgerCloseMeta needed to replay its ledger
+struct ReplayLedger
+{
+    LedgerHeader mHeader;
+    TxSetXDRFrameConstPtr mTxSet;
+};
+
+// Decodes only the ledger header and the transaction set of a serialized
+// LedgerCloseMeta. They come first in every version, so the transaction,
+// upgrade and SCP meta making up most of the record are never decoded.
+ReplayLedger decodeForReplay(std::vector<char> const& raw);
+
 class ReplayDebugMetaWork : public Work
 {
     // Target replay ledger
@@ -3,10 +3,12 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "catchup/VerifyLedgerChainWork.h"
+#include "crypto/SHA.h"
 #include "history/FileTransferInfo.h"
 #include "historywork/Progress.h"
 #include "ledger/LedgerManager.h"
 #include "main/Application.h"
+#include "main/Config.h"
 #include "main/ErrorMessages.h"
 #include "util/FileSystemException.h"
 #include "util/GlobalChecks.h"
@@ -14,44 +16,50 @@
 #include "util/XDRStream.h"
 #include "util/types.h"
 #include <Tracy.hpp>
+#include <algorithm>
+#include <exception>
 #include <fmt/format.h>
 #include <fstream>
 
 namespace stellar
 {
 
+// The checks below run on worker threads and append what they find to
+// `errors`, to be logged later in verification order
+
 static HistoryManager::LedgerVerificationStatus
-verifyLedgerHistoryEntry(LedgerHeaderHistoryEntry const& hhe)
+verifyLedgerHistoryEntry(LedgerHeaderHistoryEntry const& hhe,
+                         std::vector<std::string>& errors)
 {
     ZoneScoped;
-    Hash calculated = sha256(xdr::xdr_to_opaque(hhe.header));
+    Hash calculated = xdrSha256(hhe.header);
     if (calculated != hhe.hash)
     {
-        CLOG_ERROR(
-            History,
-            "Bad ledger-header history entry: claimed ledger {} actually "
-            "hashes to {}",
-            LedgerManager::ledgerAbbrev(hhe), hexAbbrev(calculated));
+        errors.emplace_back(fmt::format(
+            FMT_STRING("Bad ledger-header history entry: claimed ledger {} "
+                       "actually hashes to {}"),
+            LedgerManager::ledgerAbbrev(hhe), hexAbbrev(calculated)));
         return HistoryManager::VERIFY_STATUS_ERR_BAD_HASH;
     }
     return HistoryManager::VERIFY_STATUS_OK;
 }
 
 static HistoryManager::LedgerVerificationStatus
-verifyLedgerHistoryLink(Hash const& prev, LedgerHeaderHistoryEntry const& curr)
+verifyLedgerHistoryLink(Hash const& prev, LedgerHeaderHistoryEntry const& curr,
+                        std::vector<std::string>& errors)
 {
-    auto entryResult = verifyLedgerHistoryEntry(curr);
+    auto entryResult = verifyLedgerHistoryEntry(curr, errors);
     if (entryResult != HistoryManager::VERIFY_STATUS_OK)
     {
         return entryResult;
     }
     if (prev != curr.header.previousLedgerHash)
     {
-        CLOG_ERROR(
-            History,
-            "Bad hash-chain: {} wants prev hash {} but actual prev hash is {}",
+        errors.emplace_back(fmt::format(
+            FMT_STRING("Bad hash-chain: {} wants prev hash {} but actual prev "
+                       "hash is {}"),
             LedgerManager::ledgerAbbrev(curr),
-            hexAbbrev(curr.header.previousLedgerHash), hexAbbrev(prev));
+            hexAbbrev(curr.header.previousLedgerHash), hexAbbrev(prev)));
         return HistoryManager::VERIFY_STATUS_ERR_BAD_HASH;
     }
     return HistoryManager::VERIFY_STATUS_OK;
@@ -156,22 +164,54 @@ VerifyLedgerChainWork::onReset()
                                 mRange.last(), mApp.getConfig());
     mChainDisagreesWithLocalState.reset();
     mHasTrustedHash = false;
+
+    ++mScanGeneration;
+    mScans.clear();
+    mScansInFlight = 0;
+    mNextCheckpointToScan = mCurrCheckpoint;
+    mAllScansStarted = mRange.mCount == 0;
 }
 
-HistoryManager::LedgerVerificationStatus
-VerifyLedgerChainWork::verifyHistoryOfSingleCheckpoint()
+struct VerifyLedgerChainWork::CheckpointScan
+{
+    uint32_t mCheckpoint{0};
+    HistoryManager::LedgerVerificationStatus mStatus{
+        HistoryManager::VERIFY_STATUS_OK};
+    // Whatever scanning threw, rethrown when the scan is consumed
+    std::exception_ptr mException;
+    // Errors found while scanning, logged when the scan is consumed so that
+    // they appear in verification order
+    std::vector<std::string> mErrors;
+    // Last disagreement with local state seen in this checkpoint
+    std::optional<HistoryManager::LedgerVerificationStatus>
+        mDisagreesWithLocalState;
+    uint32_t mLedgersVerified{0};
+    // First and last ledgers scanned
+    LedgerHeaderHistoryEntry mFirst;
+    LedgerHeaderHistoryEntry mLast;
+};
+
+void
+VerifyLedgerChainWork::scanCheckpoint(
+    CheckpointScan& scan, Config const& cfg, std::string const& path,
+    LedgerRange const& range, LedgerNumHashPair const& lastClosed,
+    std::optional<LedgerNumHashPair> const& maxPrevVerified)
 {
     ZoneScoped;
-    // When verifying a checkpoint, we rely on the fact that the next checkpoint
-    // has been verified (unless there's 1 checkpoint).
-    // Once the end of the range is reached, ensure that the chain agrees with
-    // trusted hash passed in. If LCL is reached, verify that it agrees with
-    // the chain.
+    // Everything here only depends on this checkpoint's headers; the links to
+    // other checkpoints and to the trusted hash are checked by
+    // verifyHistoryOfSingleCheckpoint.
+    auto fail = [&](HistoryManager::LedgerVerificationStatus status,
+                    std::string error) {
+        scan.mStatus = status;
+        if (!error.empty())
+        {
+            scan.mErrors.emplace_back(std::move(error));
+        }
+    };
 
-    FileTransferInfo ft(mDownloadDir, FileType::HISTORY_FILE_TYPE_LEDGER,
-                        mCurrCheckpoint);
     XDRInputFileStream hdrIn;
-    hdrIn.open(ft.localPath_nogz());
+    hdrIn.open(path);
 
     bool beginCheckpoint = true;
 
@@ -180,12 +220,12 @@ VerifyLedgerChainWork::verifyHistoryOfSingleCheckpoint()
     // stream; `first` will be set to `curr` only on the first iteration, and
     // `prev` will be set to `curr` at the end of the loop to make the previous
     // iteration's `curr` available during the loop.
-    LedgerHeaderHistoryEntry curr;
-    LedgerHeaderHistoryEntry first;
+    LedgerHeaderHistoryEntry& curr = scan.mLast;
+    LedgerHeaderHistoryEntry& first = scan.mFirst;
     LedgerHeaderHistoryEntry prev;
 
     CLOG_DEBUG(History, "Verifying ledger headers from {} for checkpoint {}",
-               ft.localPath_nogz(), mCurrCheckpoint);
+               path, scan.mCheckpoint);
 
     while (hdrIn)
     {
@@ -198,84 +238,89 @@ VerifyLedgerChainWork::verifyHistoryOfSingleCheckpoint()
         }
         catch (xdr::xdr_bad_message_size&)
         {
-            return HistoryManager::VERIFY_STATUS_ERR_BAD_LEDGER_VERSION;
+            return fail(HistoryManager::VERIFY_STATUS_ERR_BAD_LEDGER_VERSION,
+                        "");
         }
 
-        if (curr.header.ledgerVersion >
-            mApp.getConfig().LEDGER_PROTOCOL_VERSION)
+        if (curr.header.ledgerVersion > cfg.LEDGER_PROTOCOL_VERSION)
         {
             // Note that local state does not agree with the archives; depending
             // on the presence of trusted hash
-            mChainDisagreesWithLocalState =
+            scan.mDisagreesWithLocalState =
                 HistoryManager::VERIFY_STATUS_ERR_BAD_LEDGER_VERSION;
         }
 
         // Verify ledger with local state by comparing to LCL
         // When checking against LCL, see if the local node is in a bad state
         // or if the archive is in a bad state (in which case, retry)
-        if (curr.header.ledgerSeq == mLastClosed.first)
+        if (curr.header.ledgerSeq == lastClosed.first)
         {
-            if (sha256(xdr::xdr_to_opaque(curr.header)) != *mLastClosed.second)
+            if (xdrSha256(curr.header) != *lastClosed.second)
             {
-                CLOG_ERROR(History,
-                           "Bad ledger-header history entry: claimed ledger {} "
-                           "does not agree with LCL {}",
-                           LedgerManager::ledgerAbbrev(curr),
-                           LedgerManager::ledgerAbbrev(mLastClosed.first,
-                                                       *mLastClosed.second));
-                mChainDisagreesWithLocalState =
+                scan.mErrors.emplace_back(fmt::format(
+                    FMT_STRING("Bad ledger-header history entry: claimed "
+                               "ledger {} does not agree with LCL {}"),
+                    LedgerManager::ledgerAbbrev(curr),
+                    LedgerManager::ledgerAbbrev(lastClosed.first,
+                                                *lastClosed.second)));
+                scan.mDisagreesWithLocalState =
                     HistoryManager::VERIFY_STATUS_ERR_BAD_HASH;
             }
         }
         // Verify LCL that is just before the first ledger in range
-        else if (curr.header.ledgerSeq == mLastClosed.first + 1)
+        else if (curr.header.ledgerSeq == lastClosed.first + 1)
         {
-            auto lclResult = verifyLedgerHistoryLink(*mLastClosed.second, curr);
+            auto lclResult = verifyLedgerHistoryLink(*lastClosed.second,
+                                                     curr, scan.mErrors);
             if (lclResult != HistoryManager::VERIFY_STATUS_OK)
             {
-                CLOG_ERROR(History,
-                           "Bad ledger-header history entry: claimed ledger {} "
-                           "previous hash does not agree with LCL: {}",
-                           LedgerManager::ledgerAbbrev(curr),
-                           LedgerManager::ledgerAbbrev(mLastClosed.first,
-                                                       *mLastClosed.second));
-                mChainDisagreesWithLocalState = lclResult;
+                scan.mErrors.emplace_back(fmt::format(
+                    FMT_STRING("Bad ledger-header history entry: claimed "
+                               "ledger {} previous hash does not agree with "
+                               "LCL: {}"),
+                    LedgerManager::ledgerAbbrev(curr),
+                    LedgerManager::ledgerAbbrev(lastClosed.first,
+                                                *lastClosed.second)));
+                scan.mDisagreesWithLocalState = lclResult;
             }
         }
-        // If the curr history entry is the same ledger as our mMaxPrevVerified,
+        // If the curr history entry is the same ledger as our maxPrevVerified,
         // verify that the hashes match.
-        if (mMaxPrevVerified &&
-            curr.header.ledgerSeq == mMaxPrevVerified->first &&
-            curr.hash != mMaxPrevVerified->second)
+        if (maxPrevVerified &&
+            curr.header.ledgerSeq == maxPrevVerified->first &&
+            curr.hash != maxPrevVerified->second)
         {
-            CLOG_ERROR(History,
-                       "Checkpoint {} does not agree with trusted "
-                       "checkpoint hash {}",
-                       LedgerManager::ledgerAbbrev(curr),
-                       LedgerManager::ledgerAbbrev(mMaxPrevVerified->first,
-                                                   *mMaxPrevVerified->second));
-            return HistoryManager::VERIFY_STATUS_ERR_BAD_HASH;
+            return fail(
+                HistoryManager::VERIFY_STATUS_ERR_BAD_HASH,
+                fmt::format(
+                    FMT_STRING("Checkpoint {} does not agree with trusted "
+                               "checkpoint hash {}"),
+                    LedgerManager::ledgerAbbrev(curr),
+                    LedgerManager::ledgerAbbrev(maxPrevVerified->first,
+                                                *maxPrevVerified->second)));
         }
 
         if (beginCheckpoint)
         {
             if (!HistoryManager::isFirstLedgerInCheckpoint(
-                    curr.header.ledgerSeq, mApp.getConfig()))
+                    curr.header.ledgerSeq, cfg))
             {
-                CLOG_ERROR(History, "Checkpoint did not start with {} - got {}",
-                           HistoryManager::firstLedgerInCheckpointContaining(
-                               curr.header.ledgerSeq, mApp.getConfig()),
-                           curr.header.ledgerSeq);
-                return HistoryManager::VERIFY_STATUS_ERR_MISSING_ENTRIES;
+                return fail(
+                    HistoryManager::VERIFY_STATUS_ERR_MISSING_ENTRIES,
+                    fmt::format(
+                        FMT_STRING("Checkpoint did not start with {} - got {}"),
+                        HistoryManager::firstLedgerInCheckpointContaining(
+                            curr.header.ledgerSeq, cfg),
+                        curr.header.ledgerSeq));
             }
 
             // At the beginning of checkpoint, we can't verify the link with
             // previous ledger, so at least verify that header content hashes to
             // correct value
-            auto hashResult = verifyLedgerHistoryEntry(curr);
+            auto hashResult = verifyLedgerHistoryEntry(curr, scan.mErrors);
             if (hashResult != HistoryManager::VERIFY_STATUS_OK)
             {
-                return hashResult;
+                return fail(hashResult, "");
             }
 
             // Save first ledger in the checkpoint, in case we use it below in
@@ -288,49 +333,149 @@ VerifyLedgerChainWork::verifyHistoryOfSingleCheckpoint()
             uint32_t expectedSeq = prev.header.ledgerSeq + 1;
             if (curr.header.ledgerSeq < expectedSeq)
             {
-                CLOG_ERROR(
-                    History,
-                    "History chain undershot expected ledger seq {}, got "
-                    "{} instead",
-                    expectedSeq, curr.header.ledgerSeq);
-                return HistoryManager::VERIFY_STATUS_ERR_UNDERSHOT;
+                return fail(
+                    HistoryManager::VERIFY_STATUS_ERR_UNDERSHOT,
+                    fmt::format(
+                        FMT_STRING("History chain undershot expected ledger "
+                                   "seq {}, got {} instead"),
+                        expectedSeq, curr.header.ledgerSeq));
             }
             else if (curr.header.ledgerSeq > expectedSeq)
             {
-                CLOG_ERROR(History,
-                           "History chain overshot expected ledger seq {}, got "
-                           "{} instead",
-                           expectedSeq, curr.header.ledgerSeq);
-                return HistoryManager::VERIFY_STATUS_ERR_OVERSHOT;
+                return fail(
+                    HistoryManager::VERIFY_STATUS_ERR_OVERSHOT,
+                    fmt::format(
+                        FMT_STRING("History chain overshot expected ledger "
+                                   "seq {}, got {} instead"),
+                        expectedSeq, curr.header.ledgerSeq));
             }
-            auto linkResult = verifyLedgerHistoryLink(prev.hash, curr);
+            auto linkResult =
+                verifyLedgerHistoryLink(prev.hash, curr, scan.mErrors);
             if (linkResult != HistoryManager::VERIFY_STATUS_OK)
             {
-                return linkResult;
+                return fail(linkResult, "");
             }
         }
 
-        mApp.getLedgerApplyManager().ledgersVerified();
+        ++scan.mLedgersVerified;
         prev = curr;
 
         // No need to keep verifying if the range is covered
-        if (curr.header.ledgerSeq == mRange.last())
+        if (curr.header.ledgerSeq == range.last())
         {
             break;
         }
     }
 
-    if (curr.header.ledgerSeq != mCurrCheckpoint &&
-        curr.header.ledgerSeq != mRange.last())
+    if (curr.header.ledgerSeq != scan.mCheckpoint &&
+        curr.header.ledgerSeq != range.last())
     {
-        // We can end at mCurrCheckpoint if checkpoint was valid
-        // or at mRange.last() if history chain file was valid and we
-        // reached last ledger in the range. Any other ledger here means
-        // that file is corrupted.
-        CLOG_ERROR(History, "History chain did not end with {} or {} - got {}",
-                   mCurrCheckpoint, mRange.last(), curr.header.ledgerSeq);
-        return HistoryManager::VERIFY_STATUS_ERR_MISSING_ENTRIES;
+        // We can end at the checkpoint if it was valid or at range.last() if
+        // history chain file was valid and we reached last ledger in the
+        // range. Any other ledger here means that file is corrupted.
+        return fail(HistoryManager::VERIFY_STATUS_ERR_MISSING_ENTRIES,
+                    fmt::format(FMT_STRING("History chain did not end with {} "
+                                           "or {} - got {}"),
+                                scan.mCheckpoint, range.last(),
+                                curr.header.ledgerSeq));
     }
+}
+
+void
+VerifyLedgerChainWork::startScans()
+{
+    auto const& cfg = mApp.getConfig();
+    auto minCheckpoint =
+        HistoryManager::checkpointContainingLedger(mRange.mFirst, cfg);
+    // Enough to keep every worker busy while the main thread catches up
+    size_t const maxPending =
+        4 * static_cast<size_t>(std::max(cfg.WORKER_THREADS, 1));
+    std::weak_ptr<VerifyLedgerChainWork> weak(
+        std::static_pointer_cast<VerifyLedgerChainWork>(shared_from_this()));
+
+    while (!mAllScansStarted && mScansInFlight + mScans.size() < maxPending)
+    {
+        uint32_t checkpoint = mNextCheckpointToScan;
+        FileTransferInfo ft(mDownloadDir, FileType::HISTORY_FILE_TYPE_LEDGER,
+                            checkpoint);
+        ++mScansInFlight;
+        mApp.postOnBackgroundThread(
+            [&app = mApp, weak, generation = mScanGeneration, checkpoint,
+             path = ft.localPath_nogz(), range = mRange,
+             lastClosed = mLastClosed, maxPrevVerified = mMaxPrevVerified]() {
+                auto scan = std::make_shared<CheckpointScan>();
+                scan->mCheckpoint = checkpoint;
+                try
+                {
+                    scanCheckpoint(*scan, app.getConfig(), path, range,
+                                   lastClosed, maxPrevVerified);
+                }
+                catch (...)
+                {
+                    scan->mException = std::current_exception();
+                }
+                app.postOnMainThread(
+                    [weak, generation, scan]() {
+                        auto self = weak.lock();
+                        if (!self || self->mScanGeneration != generation)
+                        {
+                            return;
+                        }
+                        --self->mScansInFlight;
+                        self->mScans.emplace(scan->mCheckpoint, scan);
+                        self->wakeUp();
+                    },
+                    "VerifyLedgerChain: scanned checkpoint");
+            },
+            "VerifyLedgerChain: scan checkpoint",
+            BackgroundWorkClass::PUBLISH);
+
+        if (checkpoint == minCheckpoint)
+        {
+            mAllScansStarted = true;
+        }
+        else
+        {
+            mNextCheckpointToScan -=
+                HistoryManager::getCheckpointFrequency(cfg);
+        }
+    }
+}
+
+HistoryManager::LedgerVerificationStatus
+VerifyLedgerChainWork::verifyHistoryOfSingleCheckpoint(
+    CheckpointScan const& scan)
+{
+    ZoneScoped;
+    // When verifying a checkpoint, we rely on the fact that the next checkpoint
+    // has been verified (unless there's 1 checkpoint).
+    // Once the end of the range is reached, ensure that the chain agrees with
+    // trusted hash passed in. If LCL is reached, verify that it agrees with
+    // the chain.
+    releaseAssert(scan.mCheckpoint == mCurrCheckpoint);
+    for (auto const& error : scan.mErrors)
+    {
+        CLOG_ERROR(History, "{}", error);
+    }
+    if (scan.mDisagreesWithLocalState)
+    {
+        mChainDisagreesWithLocalState = scan.mDisagreesWithLocalState;
+    }
+    if (scan.mLedgersVerified > 0)
+    {
+        mApp.getLedgerApplyManager().ledgersVerified(scan.mLedgersVerified);
+    }
+    if (scan.mException)
+    {
+        std::rethrow_exception(scan.mException);
+    }
+    if (scan.mStatus != HistoryManager::VERIFY_STATUS_OK)
+    {
+        return scan.mStatus;
+    }
+
+    LedgerHeaderHistoryEntry const& first = scan.mFirst;
+    LedgerHeaderHistoryEntry const& curr = scan.mLast;
 
     // We just finished scanning a checkpoint. We first grab the _incoming_
     // hash-link our caller (or previous call to this method) saved for us.
@@ -470,12 +615,22 @@ VerifyLedgerChainWork::onRun()
             "Verification undershot first ledger in the range.");
     }
 
+    startScans();
+    auto scanIt = mScans.find(mCurrCheckpoint);
+    if (scanIt == mScans.end())
+    {
+        return BasicWork::State::WORK_WAITING;
+    }
+    auto scan = scanIt->second;
+    mScans.erase(scanIt);
+    startScans();
+
     HistoryManager::LedgerVerificationStatus result;
 
     // Catch FS-related errors to gracefully fail Work instead of crashing
     try
     {
-        result = verifyHistoryOfSingleCheckpoint();
+        result = verifyHistoryOfSingleCheckpoint(*scan);
     }
     catch (FileSystemException&)
     {
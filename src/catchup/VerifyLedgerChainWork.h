@@ -9,17 +9,25 @@
 #include "work/Work.h"
 #include <future>
 #include <iosfwd>
+#include <map>
 #include <vector>
 
 namespace stellar
 {
 
+class Config;
 class TmpDir;
 struct LedgerHeaderHistoryEntry;
 
 // This class verifies ledger chain of a given range by checking the hashes.
 // Note that verification is done starting with the latest checkpoint in the
 // range, and working its way backwards to the beginning of the range.
+//
+// Each checkpoint's headers are first checked on their own (header hashes,
+// links between consecutive headers, agreement with local state) on worker
+// threads, several checkpoints at a time. The links between checkpoints and
+// to the trusted hash are then checked on the main thread, one checkpoint at
+// a time and in the same order as above, so what is trusted is unchanged.
 class VerifyLedgerChainWork : public BasicWork
 {
     TmpDir const& mDownloadDir;
@@ -76,7 +84,23 @@ class VerifyLedgerChainWork : public BasicWork
     std::vector<LedgerNumHashPair> mVerifiedLedgers;
     std::shared_ptr<std::ofstream> mOutputStream;
 
-    HistoryManager::LedgerVerificationStatus verifyHistoryOfSingleCheckpoint();
+    struct CheckpointScan;
+    // Finished scans not yet consumed, keyed by checkpoint
+    std::map<uint32_t, std::shared_ptr<CheckpointScan const>> mScans;
+    uint32_t mNextCheckpointToScan{0};
+    bool mAllScansStarted{false};
+    size_t mScansInFlight{0};
+    // Bumped on reset, so that results of scans started before are dropped
+    uint64_t mScanGeneration{0};
+
+    static void scanCheckpoint(
+        CheckpointScan& scan, Config const& cfg, std::string const& path,
+        LedgerRange const& range, LedgerNumHashPair const& lastClosed,
+        std::optional<LedgerNumHashPair> const& maxPrevVerified);
+    void startScans();
+
+    HistoryManager::LedgerVerificationStatus
+    verifyHistoryOfSingleCheckpoint(CheckpointScan const& scan);
 
   public:
     VerifyLedgerChainWork(
@@ -6,7 +6,11 @@
 #include "catchup/CatchupConfiguration.h"
 #include "catchup/CatchupRange.h"
 #include "catchup/CatchupWork.h"
+#include "catchup/DownloadApplyTxsWork.h"
+#include "crypto/SHA.h"
+#include "history/HistoryManager.h"
 #include "ledger/CheckpointRange.h"
+#include "ledger/LedgerManager.h"
 #include "test/TestUtils.h"
 #include "test/test.h"
 #include "util/Logging.h"
@@ -237,4 +241,69 @@ TEST_CASE("CatchupRange starting on checkpoint boundary still replays it",
     REQUIRE(crange2.getBucketApplyLedger() == 63);
     REQUIRE(crange2.getReplayFirst() == 64);
     REQUIRE(crange2.getReplayCount() == 3);
-}
\ No newline at end of file
+}
+
+TEST_CASE("split CatchupConfiguration into parallel ranges", "[catchup]")
+{
+    VirtualClock clock;
+    auto app = createTestApplication(clock, getTestConfig());
+    auto const& cfg = app->getConfig();
+    auto& historyManager = app->getHistoryManager();
+    auto freq = HistoryManager::getCheckpointFrequency(cfg);
+    uint32_t lcl = LedgerManager::GENESIS_LEDGER_SEQ;
+    Hash hash = sha256("split");
+
+    for (auto const& toLedger : {freq * 10 - 1, freq * 10 + 5})
+    {
+        for (auto const& count : {freq * 3, freq * 7 + 2, maxCount})
+        {
+            for (uint32_t parallelism : {1, 2, 3, 16})
+            {
+                CatchupConfiguration cc{
+                    {toLedger, hash},
+                    count,
+                    CatchupConfiguration::Mode::OFFLINE_BASIC};
+                auto ranges = cc.splitIntoRanges(parallelism, cfg);
+                REQUIRE(!ranges.empty());
+                REQUIRE(ranges.size() <= parallelism);
+
+                // The first range starts where the whole catchup would
+                CatchupRange whole{lcl, cc, historyManager};
+                CatchupRange first{lcl, ranges.front(), historyManager};
+                REQUIRE(first.applyBuckets() == whole.applyBuckets());
+                REQUIRE(first.getReplayFirst() == whole.getReplayFirst());
+
+                // Each following range restores the state the previous one
+                // ended at
+                for (size_t i = 1; i < ranges.size(); ++i)
+                {
+                    auto prevEnd = ranges[i - 1].toLedger();
+                    REQUIRE(HistoryManager::isLastLedgerInCheckpoint(prevEnd,
+                                                                     cfg));
+                    REQUIRE(!ranges[i - 1].hash());
+                    CatchupRange range{lcl, ranges[i], historyManager};
+                    REQUIRE(range.applyBuckets());
+                    REQUIRE(range.getBucketApplyLedger() == prevEnd);
+                    REQUIRE(range.getReplayFirst() == prevEnd + 1);
+                }
+                REQUIRE(ranges.back().toLedger() == toLedger);
+                REQUIRE(ranges.back().hash() == hash);
+            }
+        }
+    }
+}
+
+TEST_CASE("checkpoint lookahead follows download and apply times", "[catchup]")
+{
+    using W = DownloadApplyTxsWork;
+    // Downloads much faster than apply: only keep the next one ready
+    REQUIRE(W::getLookahead(0.1, 10) == 3);
+    // Downloads as slow as apply: one in flight per applying checkpoint
+    REQUIRE(W::getLookahead(5, 5) == 3);
+    // Downloads slower than apply: enough in flight to keep apply busy
+    REQUIRE(W::getLookahead(10, 1) == 12);
+    // Bounded in both directions
+    REQUIRE(W::getLookahead(1000, 1) == W::MAX_LOOKAHEAD);
+    REQUIRE(W::getLookahead(1, 0) == W::MAX_LOOKAHEAD);
+    REQUIRE(W::getLookahead(0, 1) == W::MIN_LOOKAHEAD);
+}
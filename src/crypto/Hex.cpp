@@ -3,27 +3,209 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "crypto/Hex.h"
-#include <sodium.h>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define STELLAR_HEX_SSSE3 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define STELLAR_HEX_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Hex strings are mostly hashes and keys printed to logs and JSON, so these
+// convert 16 bytes at a time where the CPU allows. Like the libsodium functions
+// they replace, none of the paths depend on the data through branches or
+// memory accesses beyond a 16-entry table, as they also see secret values.
 
 namespace stellar
 {
 
-std::string
-binToHex(ByteSlice const& bin)
+namespace
+{
+
+char const HEX_DIGITS[] = "0123456789abcdef";
+
+void
+binToHexScalar(uint8_t const* in, size_t n, char* out)
 {
-    // NB: C++ standard says we can't go modifying the contents of a std::string
-    // just by const_cast'ing away const on .data(), so we use a vector<char> to
-    // write to.
-    if (bin.empty())
-        return "";
-    std::vector<char> hex(bin.size() * 2 + 1, '\0');
-    if (sodium_bin2hex(hex.data(), hex.size(), bin.data(), bin.size()) !=
-        hex.data())
+    for (size_t i = 0; i < n; ++i)
     {
-        throw std::runtime_error(
-            "error in stellar::binToHex(std::vector<uint8_t>)");
+        out[2 * i] = HEX_DIGITS[in[i] >> 4];
+        out[2 * i + 1] = HEX_DIGITS[in[i] & 0x0f];
     }
-    return std::string(hex.begin(), hex.end() - 1);
+}
+
+// Value of hex digit `c`, or 0x100 if it isn't one
+int
+hexValue(unsigned char c)
+{
+    int digit = c - '0';
+    int letter = (c | 0x20) - 'a';
+    // All ones where in range, computed without branches
+    int isDigit = ~((digit | (9 - digit)) >> 8);
+    int isLetter = ~((letter | (5 - letter)) >> 8);
+    return (isDigit & digit) | (isLetter & (letter + 10)) |
+           (~(isDigit | isLetter) & 0x100);
+}
+
+// Returns false if `in` holds anything but hex digits
+bool
+hexToBinScalar(char const* in, size_t n, uint8_t* out)
+{
+    int bad = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        int hi = hexValue(static_cast<unsigned char>(in[2 * i]));
+        int lo = hexValue(static_cast<unsigned char>(in[2 * i + 1]));
+        bad |= (hi | lo) & 0x100;
+        out[i] = static_cast<uint8_t>((hi << 4) | (lo & 0x0f));
+    }
+    return bad == 0;
+}
+
+#ifdef STELLAR_HEX_SSSE3
+bool
+haveSSSE3()
+{
+    static bool const have = __builtin_cpu_supports("ssse3");
+    return have;
+}
+
+// Encodes the first multiple of 16 bytes of `in`, returns how many
+__attribute__((target("ssse3"))) size_t
+binToHexSSSE3(uint8_t const* in, size_t n, char* out)
+{
+    __m128i const digits =
+        _mm_loadu_si128(reinterpret_cast<__m128i const*>(HEX_DIGITS));
+    __m128i const nibble = _mm_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + i));
+        __m128i hi = _mm_shuffle_epi8(
+            digits, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+        __m128i lo = _mm_shuffle_epi8(digits, _mm_and_si128(v, nibble));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i),
+                         _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i + 16),
+                         _mm_unpackhi_epi8(hi, lo));
+    }
+    return i;
+}
+
+// Values of 16 hex digits, with `valid` cleared where there is something else
+__attribute__((target("ssse3"))) __m128i
+hexValuesSSSE3(__m128i c, __m128i& valid)
+{
+    __m128i digit = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+    __m128i letter = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)),
+                                  _mm_set1_epi8('a'));
+    __m128i isDigit =
+        _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    __m128i isLetter =
+        _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+    valid = _mm_and_si128(valid, _mm_or_si128(isDigit, isLetter));
+    return _mm_or_si128(
+        _mm_and_si128(isDigit, digit),
+        _mm_and_si128(isLetter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+}
+
+// Decodes the first multiple of 16 bytes, returns how many, or
+// SIZE_MAX if anything but hex digits was found
+__attribute__((target("ssse3"))) size_t
+hexToBinSSSE3(char const* in, size_t n, uint8_t* out)
+{
+    // Multiplying adjacent bytes by 16 and 1 merges two digits into a byte
+    __m128i const merge = _mm_set1_epi16(0x0110);
+    __m128i valid = _mm_set1_epi8(-1);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        auto p = reinterpret_cast<__m128i const*>(in + 2 * i);
+        __m128i a = hexValuesSSSE3(_mm_loadu_si128(p), valid);
+        __m128i b = hexValuesSSSE3(_mm_loadu_si128(p + 1), valid);
+        __m128i bytes = _mm_packus_epi16(_mm_maddubs_epi16(a, merge),
+                                         _mm_maddubs_epi16(b, merge));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), bytes);
+    }
+    return _mm_movemask_epi8(valid) == 0xffff ? i : SIZE_MAX;
+}
+#endif
+
+#ifdef STELLAR_HEX_NEON
+size_t
+binToHexNeon(uint8_t const* in, size_t n, char* out)
+{
+    uint8x16_t const digits =
+        vld1q_u8(reinterpret_cast<uint8_t const*>(HEX_DIGITS));
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        uint8x16_t v = vld1q_u8(in + i);
+        uint8x16x2_t chars;
+        chars.val[0] = vqtbl1q_u8(digits, vshrq_n_u8(v, 4));
+        chars.val[1] = vqtbl1q_u8(digits, vandq_u8(v, vdupq_n_u8(0x0f)));
+        vst2q_u8(reinterpret_cast<uint8_t*>(out + 2 * i), chars);
+    }
+    return i;
+}
+
+uint8x16_t
+hexValuesNeon(uint8x16_t c, uint8x16_t& valid)
+{
+    uint8x16_t digit = vsubq_u8(c, vdupq_n_u8('0'));
+    uint8x16_t letter =
+        vsubq_u8(vorrq_u8(c, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+    uint8x16_t isDigit = vcleq_u8(digit, vdupq_n_u8(9));
+    uint8x16_t isLetter = vcleq_u8(letter, vdupq_n_u8(5));
+    valid = vandq_u8(valid, vorrq_u8(isDigit, isLetter));
+    return vbslq_u8(isDigit, digit, vaddq_u8(letter, vdupq_n_u8(10)));
+}
+
+size_t
+hexToBinNeon(char const* in, size_t n, uint8_t* out)
+{
+    uint8x16_t valid = vdupq_n_u8(0xff);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        // De-interleaves high and low digits
+        uint8x16x2_t c = vld2q_u8(reinterpret_cast<uint8_t const*>(in + 2 * i));
+        uint8x16_t hi = hexValuesNeon(c.val[0], valid);
+        uint8x16_t lo = hexValuesNeon(c.val[1], valid);
+        vst1q_u8(out + i, vorrq_u8(vshlq_n_u8(hi, 4), lo));
+    }
+    return vminvq_u8(valid) == 0xff ? i : SIZE_MAX;
+}
+#endif
+
+void
+binToHexInto(uint8_t const* in, size_t n, char* out)
+{
+    size_t done = 0;
+#if defined(STELLAR_HEX_SSSE3)
+    if (haveSSSE3())
+    {
+        done = binToHexSSSE3(in, n, out);
+    }
+#elif defined(STELLAR_HEX_NEON)
+    done = binToHexNeon(in, n, out);
+#endif
+    binToHexScalar(in + done, n - done, out + 2 * done);
+}
+}
+
+std::string
+binToHex(ByteSlice const& bin)
+{
+    std::string hex(bin.size() * 2, '\0');
+    binToHexInto(bin.data(), bin.size(), hex.data());
+    return hex;
 }
 
 std::string
@@ -40,14 +222,25 @@ hexAbbrev(ByteSlice const& bin)
 std::vector<uint8_t>
 hexToBin(std::string const& hex)
 {
+    if (hex.size() % 2 != 0)
+    {
+        throw std::runtime_error("error in stellar::hexToBin(std::string)");
+    }
     std::vector<uint8_t> bin(hex.size() / 2, 0);
-    if (!hex.empty())
+    size_t done = 0;
+#if defined(STELLAR_HEX_SSSE3)
+    if (haveSSSE3())
+    {
+        done = hexToBinSSSE3(hex.data(), bin.size(), bin.data());
+    }
+#elif defined(STELLAR_HEX_NEON)
+    done = hexToBinNeon(hex.data(), bin.size(), bin.data());
+#endif
+    if (done == SIZE_MAX ||
+        !hexToBinScalar(hex.data() + 2 * done, bin.size() - done,
+                        bin.data() + done))
     {
-        if (sodium_hex2bin(bin.data(), bin.size(), hex.data(), hex.size(), NULL,
-                           NULL, NULL) != 0)
-        {
-            throw std::runtime_error("error in stellar::hexToBin(std::string)");
-        }
+        throw std::runtime_error("error in stellar::hexToBin(std::string)");
     }
     return bin;
 }
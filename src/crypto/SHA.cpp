@@ -6,6 +6,7 @@
 #include "crypto/ByteSlice.h"
 #include "crypto/CryptoError.h"
 #include "crypto/Curve25519.h"
+#include "crypto/SHA256Accel.h"
 #include "util/NonCopyable.h"
 #include <Tracy.hpp>
 #include <sodium.h>
@@ -19,6 +20,16 @@ sha256(ByteSlice const& bin)
 {
     ZoneScoped;
     uint256 out;
+    crypto_hash_sha256_state state;
+    if (crypto_hash_sha256_init(&state) != 0)
+    {
+        throw CryptoError("error from crypto_hash_sha256_init");
+    }
+    if (sha256AccelUpdate(state, bin.data(), bin.size()) &&
+        sha256AccelFinal(state, out.data()))
+    {
+        return out;
+    }
     if (crypto_hash_sha256(out.data(), bin.data(), bin.size()) != 0)
     {
         throw CryptoError("error from crypto_hash_sha256");
@@ -58,6 +69,10 @@ SHA256::add(ByteSlice const& bin)
     {
         throw std::runtime_error("adding bytes to finished SHA256");
     }
+    if (sha256AccelUpdate(mState, bin.data(), bin.size()))
+    {
+        return;
+    }
     if (crypto_hash_sha256_update(&mState, bin.data(), bin.size()) != 0)
     {
         throw CryptoError("error from crypto_hash_sha256_update");
@@ -74,7 +89,8 @@ SHA256::finish()
     {
         throw std::runtime_error("finishing already-finished SHA256");
     }
-    if (crypto_hash_sha256_final(&mState, out.data()) != 0)
+    if (!sha256AccelFinal(mState, out.data()) &&
+        crypto_hash_sha256_final(&mState, out.data()) != 0)
     {
         throw CryptoError("error from crypto_hash_sha256_final");
     }
@@ -105,6 +121,53 @@ hmacSha256Verify(HmacSha256Mac const& hmac, HmacSha256Key const& key,
                                               bin.size(), key.key.data());
 }
 
+bool
+hmacSha256Equal(HmacSha256Mac const& a, HmacSha256Mac const& b)
+{
+    static_assert(sizeof(a.mac) == crypto_auth_hmacsha256_BYTES,
+                  "unexpected crypto_auth_hmacsha256_BYTES");
+    return 0 == crypto_verify_32(a.mac.data(), b.mac.data());
+}
+
+HmacSha256::HmacSha256(HmacSha256Key const& key)
+{
+    if (crypto_auth_hmacsha256_init(&mState, key.key.data(),
+                                    key.key.size()) != 0)
+    {
+        throw CryptoError("error from crypto_auth_hmacsha256_init");
+    }
+}
+
+void
+HmacSha256::add(ByteSlice const& bin)
+{
+    ZoneScoped;
+    if (mFinished)
+    {
+        throw std::runtime_error("adding bytes to finished HmacSha256");
+    }
+    if (crypto_auth_hmacsha256_update(&mState, bin.data(), bin.size()) != 0)
+    {
+        throw CryptoError("error from crypto_auth_hmacsha256_update");
+    }
+}
+
+HmacSha256Mac
+HmacSha256::finish()
+{
+    HmacSha256Mac out;
+    if (mFinished)
+    {
+        throw std::runtime_error("finishing already-finished HmacSha256");
+    }
+    if (crypto_auth_hmacsha256_final(&mState, out.mac.data()) != 0)
+    {
+        throw CryptoError("error from crypto_auth_hmacsha256_final");
+    }
+    mFinished = true;
+    return out;
+}
+
 // Unsalted HKDF-extract(bytes) == HMAC(<zero>,bytes)
 HmacSha256Key
 hkdfExtract(ByteSlice const& bin)
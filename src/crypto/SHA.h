@@ -6,6 +6,7 @@
 
 #include "crypto/ByteSlice.h"
 #include "crypto/XDRHasher.h"
+#include "sodium/crypto_auth_hmacsha256.h"
 #include "sodium/crypto_hash_sha256.h"
 #include "xdr/Stellar-types.h"
 #include <memory>
@@ -44,18 +45,18 @@ struct XDRSHA256 : XDRHasher<XDRSHA256>
     }
 };
 
-// Equivalent to `sha256(xdr_to_opaque(t))` on any XDR object `t` but
+// Equivalent to `sha256(xdr_to_opaque(t...))` on XDR objects `t...` but
 // without allocating a temporary buffer.
 //
 // NB: This is not an overload of `sha256` to avoid ambiguity when called
 // with xdrpp-provided types like opaque_vec, which will convert to a ByteSlice
 // if demanded, but can also be passed to XDRSHA256.
-template <typename T>
+template <typename... T>
 uint256
-xdrSha256(T const& t)
+xdrSha256(T const&... t)
 {
     XDRSHA256 xs;
-    xdr::archive(xs, t);
+    (xdr::archive(xs, t), ...);
     xs.flush();
     return xs.state.finish();
 }
@@ -67,6 +68,47 @@ HmacSha256Mac hmacSha256(HmacSha256Key const& key, ByteSlice const& bin);
 bool hmacSha256Verify(HmacSha256Mac const& hmac, HmacSha256Key const& key,
                       ByteSlice const& bin);
 
+// Constant-time comparison of two MACs
+bool hmacSha256Equal(HmacSha256Mac const& a, HmacSha256Mac const& b);
+
+// HMAC-SHA256 in incremental mode, for large inputs.
+class HmacSha256
+{
+    crypto_auth_hmacsha256_state mState;
+    bool mFinished{false};
+
+  public:
+    explicit HmacSha256(HmacSha256Key const& key);
+    void add(ByteSlice const& bin);
+    HmacSha256Mac finish();
+};
+
+// Helper for xdrHmacSha256 below.
+struct XDRHmacSha256 : XDRHasher<XDRHmacSha256>
+{
+    HmacSha256 state;
+    explicit XDRHmacSha256(HmacSha256Key const& key) : state(key)
+    {
+    }
+    void
+    hashBytes(unsigned char const* bytes, size_t size)
+    {
+        state.add(ByteSlice(bytes, size));
+    }
+};
+
+// Equivalent to `hmacSha256(key, xdr_to_opaque(t...))` on XDR objects `t...`
+// but without allocating a temporary buffer.
+template <typename... T>
+HmacSha256Mac
+xdrHmacSha256(HmacSha256Key const& key, T const&... t)
+{
+    XDRHmacSha256 xh(key);
+    (xdr::archive(xh, t), ...);
+    xh.flush();
+    return xh.state.finish();
+}
+
 // Unsalted HKDF-extract(bytes) == HMAC(<zero>,bytes)
 HmacSha256Key hkdfExtract(ByteSlice const& bin);
 
@@ -0,0 +1,352 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "crypto/SHA256Accel.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define STELLAR_SHA256_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__linux__) || defined(__APPLE__))
+#define STELLAR_SHA256_ARM 1
+#include <arm_neon.h>
+#ifdef __linux__
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+#endif
+
+namespace stellar
+{
+
+namespace
+{
+
+// Compresses `n` consecutive 64-byte blocks into `state`
+using BlockFn = void (*)(uint32_t* state, unsigned char const* blocks,
+                         size_t n);
+
+#if defined(STELLAR_SHA256_X86) || defined(STELLAR_SHA256_ARM)
+alignas(16) uint32_t const K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+#endif
+
+#ifdef STELLAR_SHA256_X86
+bool
+cpuHasShaNi()
+{
+    unsigned int a, b, c, d;
+    if (!__get_cpuid(1, &a, &b, &c, &d))
+    {
+        return false;
+    }
+    bool ssse3 = c & (1u << 9);
+    bool sse41 = c & (1u << 19);
+    if (!__get_cpuid_count(7, 0, &a, &b, &c, &d))
+    {
+        return false;
+    }
+    bool sha = b & (1u << 29);
+    return ssse3 && sse41 && sha;
+}
+
+// Each group of 4 rounds runs two SHA256RNDS2 on the state kept as ABEF and
+// CDGH, while SHA256MSG1/MSG2 extend the message schedule 4 words at a time.
+__attribute__((target("sha,sse4.1,ssse3"))) void
+compressShaNi(uint32_t* state, unsigned char const* blocks, size_t n)
+{
+    __m128i const byteSwap =
+        _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i tmp = _mm_loadu_si128(reinterpret_cast<__m128i const*>(state));
+    __m128i state1 =
+        _mm_loadu_si128(reinterpret_cast<__m128i const*>(state + 4));
+    tmp = _mm_shuffle_epi32(tmp, 0xB1);               // CDAB
+    state1 = _mm_shuffle_epi32(state1, 0x1B);         // EFGH
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8); // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);      // CDGH
+
+    for (; n > 0; --n, blocks += 64)
+    {
+        __m128i const abefSave = state0;
+        __m128i const cdghSave = state1;
+        __m128i w[4];
+        for (int g = 0; g < 16; ++g)
+        {
+            __m128i& cur = w[g & 3];
+            __m128i& next = w[(g + 1) & 3];
+            __m128i& prev = w[(g + 3) & 3];
+            if (g < 4)
+            {
+                cur = _mm_shuffle_epi8(
+                    _mm_loadu_si128(
+                        reinterpret_cast<__m128i const*>(blocks + 16 * g)),
+                    byteSwap);
+            }
+            __m128i msg = _mm_add_epi32(
+                cur, _mm_load_si128(reinterpret_cast<__m128i const*>(K) + g));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+            if (g >= 3 && g < 15)
+            {
+                next = _mm_add_epi32(next, _mm_alignr_epi8(cur, prev, 4));
+                next = _mm_sha256msg2_epu32(next, cur);
+            }
+            msg = _mm_shuffle_epi32(msg, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+            if (g >= 1 && g < 13)
+            {
+                prev = _mm_sha256msg1_epu32(prev, cur);
+            }
+        }
+        state0 = _mm_add_epi32(state0, abefSave);
+        state1 = _mm_add_epi32(state1, cdghSave);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);       // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1);    // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0); // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8);    // ABEF
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), state1);
+}
+#endif
+
+#ifdef STELLAR_SHA256_ARM
+bool
+cpuHasArmSha2()
+{
+#ifdef __APPLE__
+    // Every 64-bit Apple CPU has the crypto extensions
+    return true;
+#else
+    return getauxval(AT_HWCAP) & HWCAP_SHA2;
+#endif
+}
+
+#ifdef __clang__
+#define STELLAR_ARM_CRYPTO_TARGET __attribute__((target("crypto")))
+#else
+#define STELLAR_ARM_CRYPTO_TARGET __attribute__((target("+crypto")))
+#endif
+
+// Each group of 4 rounds runs SHA256H/SHA256H2 on ABCD and EFGH, while
+// SHA256SU0/SU1 extend the message schedule 4 words at a time.
+STELLAR_ARM_CRYPTO_TARGET void
+compressArmv8(uint32_t* state, unsigned char const* blocks, size_t n)
+{
+    uint32x4_t state0 = vld1q_u32(state);
+    uint32x4_t state1 = vld1q_u32(state + 4);
+
+    for (; n > 0; --n, blocks += 64)
+    {
+        uint32x4_t const abcdSave = state0;
+        uint32x4_t const efghSave = state1;
+        uint32x4_t w[4];
+        for (int i = 0; i < 4; ++i)
+        {
+            w[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(blocks + 16 * i)));
+        }
+        for (int g = 0; g < 16; ++g)
+        {
+            uint32x4_t& cur = w[g & 3];
+            uint32x4_t msg = vaddq_u32(cur, vld1q_u32(K + 4 * g));
+            if (g < 12)
+            {
+                cur = vsha256su1q_u32(vsha256su0q_u32(cur, w[(g + 1) & 3]),
+                                      w[(g + 2) & 3], w[(g + 3) & 3]);
+            }
+            uint32x4_t const abcd = state0;
+            state0 = vsha256hq_u32(state0, state1, msg);
+            state1 = vsha256h2q_u32(state1, abcd, msg);
+        }
+        state0 = vaddq_u32(state0, abcdSave);
+        state1 = vaddq_u32(state1, efghSave);
+    }
+
+    vst1q_u32(state, state0);
+    vst1q_u32(state + 4, state1);
+}
+#endif
+
+BlockFn
+getBlockFn(SHA256Impl impl)
+{
+    switch (impl)
+    {
+#ifdef STELLAR_SHA256_X86
+    case SHA256Impl::SHA_NI:
+        return cpuHasShaNi() ? compressShaNi : nullptr;
+#endif
+#ifdef STELLAR_SHA256_ARM
+    case SHA256Impl::ARMV8:
+        return cpuHasArmSha2() ? compressArmv8 : nullptr;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+SHA256Impl
+fastestImpl()
+{
+    return getSupportedSHA256Impls().back();
+}
+
+// nullptr when the implementation in use is PORTABLE
+std::atomic<BlockFn>&
+activeBlockFn()
+{
+    static std::atomic<BlockFn> fn{getBlockFn(fastestImpl())};
+    return fn;
+}
+
+void
+storeBigEndian32(unsigned char* out, uint32_t x)
+{
+    out[0] = static_cast<unsigned char>(x >> 24);
+    out[1] = static_cast<unsigned char>(x >> 16);
+    out[2] = static_cast<unsigned char>(x >> 8);
+    out[3] = static_cast<unsigned char>(x);
+}
+}
+
+std::string
+sha256ImplName(SHA256Impl impl)
+{
+    switch (impl)
+    {
+    case SHA256Impl::PORTABLE:
+        return "portable";
+    case SHA256Impl::SHA_NI:
+        return "sha-ni";
+    case SHA256Impl::ARMV8:
+        return "armv8";
+    default:
+        throw std::runtime_error("unknown SHA256 implementation");
+    }
+}
+
+std::vector<SHA256Impl>
+getSupportedSHA256Impls()
+{
+    std::vector<SHA256Impl> res{SHA256Impl::PORTABLE};
+    for (auto impl : {SHA256Impl::SHA_NI, SHA256Impl::ARMV8})
+    {
+        if (getBlockFn(impl))
+        {
+            res.emplace_back(impl);
+        }
+    }
+    return res;
+}
+
+SHA256Impl
+getSHA256Impl()
+{
+    auto fn = activeBlockFn().load(std::memory_order_relaxed);
+    for (auto impl : getSupportedSHA256Impls())
+    {
+        if (getBlockFn(impl) == fn)
+        {
+            return impl;
+        }
+    }
+    return SHA256Impl::PORTABLE;
+}
+
+#ifdef BUILD_TESTS
+void
+setSHA256ImplForTesting(SHA256Impl impl)
+{
+    auto fn = getBlockFn(impl);
+    if (impl != SHA256Impl::PORTABLE && !fn)
+    {
+        throw std::runtime_error("SHA256 implementation not supported: " +
+                                 sha256ImplName(impl));
+    }
+    activeBlockFn().store(fn);
+}
+#endif
+
+// Same buffering as libsodium's crypto_hash_sha256_update: `count` is in
+// bits and `buf` holds the partial block
+bool
+sha256AccelUpdate(crypto_hash_sha256_state& state, unsigned char const* in,
+                  size_t size)
+{
+    auto fn = activeBlockFn().load(std::memory_order_relaxed);
+    if (!fn)
+    {
+        return false;
+    }
+    size_t used = (state.count >> 3) & 63;
+    state.count += static_cast<uint64_t>(size) << 3;
+    if (used != 0)
+    {
+        size_t take = std::min(64 - used, size);
+        std::memcpy(state.buf + used, in, take);
+        in += take;
+        size -= take;
+        if (used + take < 64)
+        {
+            return true;
+        }
+        fn(state.state, state.buf, 1);
+    }
+    size_t blocks = size / 64;
+    if (blocks != 0)
+    {
+        fn(state.state, in, blocks);
+        in += blocks * 64;
+        size -= blocks * 64;
+    }
+    std::memcpy(state.buf, in, size);
+    return true;
+}
+
+bool
+sha256AccelFinal(crypto_hash_sha256_state& state, unsigned char* out)
+{
+    auto fn = activeBlockFn().load(std::memory_order_relaxed);
+    if (!fn)
+    {
+        return false;
+    }
+    size_t used = (state.count >> 3) & 63;
+    state.buf[used++] = 0x80;
+    if (used > 56)
+    {
+        std::memset(state.buf + used, 0, 64 - used);
+        fn(state.state, state.buf, 1);
+        used = 0;
+    }
+    std::memset(state.buf + used, 0, 56 - used);
+    storeBigEndian32(state.buf + 56, static_cast<uint32_t>(state.count >> 32));
+    storeBigEndian32(state.buf + 60, static_cast<uint32_t>(state.count));
+    fn(state.state, state.buf, 1);
+    for (size_t i = 0; i < 8; ++i)
+    {
+        storeBigEndian32(out + 4 * i, state.state[i]);
+    }
+    std::memset(&state, 0, sizeof(state));
+    return true;
+}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "sodium/crypto_hash_sha256.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace stellar
+{
+
+// Implementations of the SHA256 compression function. PORTABLE is
+// libsodium's; the others use the SHA extensions of x86 (SHA-NI) or ARMv8
+// CPUs and are only picked when the CPU running us supports them.
+enum class SHA256Impl
+{
+    PORTABLE,
+    SHA_NI,
+    ARMV8
+};
+
+std::string sha256ImplName(SHA256Impl impl);
+
+// Implementations this build and CPU can run, PORTABLE first
+std::vector<SHA256Impl> getSupportedSHA256Impls();
+
+// The implementation used by `sha256`, `SHA256` and everything built on them:
+// the fastest supported one
+SHA256Impl getSHA256Impl();
+
+#ifdef BUILD_TESTS
+// Switch implementations for tests and benchmarks; not safe while other
+// threads are hashing
+void setSHA256ImplForTesting(SHA256Impl impl);
+#endif
+
+// Hash into a libsodium SHA256 state with the accelerated implementation, if
+// any. These return false without touching `state` when the implementation
+// in use is PORTABLE, in which case the caller uses libsodium as usual. The
+// state layout and meaning are libsodium's, so the two can't disagree.
+bool sha256AccelUpdate(crypto_hash_sha256_state& state,
+                       unsigned char const* in, size_t size);
+bool sha256AccelFinal(crypto_hash_sha256_state& state, unsigned char* out);
+}
@@ -17,9 +17,13 @@
 #include "util/Math.h"
 #include "util/RandomEvictionCache.h"
 #include <Tracy.hpp>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <future>
 #include <memory>
 #include <mutex>
+#include <numeric>
 #include <sodium.h>
 #include <type_traits>
 
@@ -40,12 +44,72 @@ namespace stellar
 // to the state of the process; caching its results centrally
 // makes all signature-verification in the program faster and
 // has no effect on correctness.
+//
+// It is used from the main thread, overlay background threads and apply
+// threads at once, so it is split into shards that each have their own
+// mutex. A signature's shard is picked from its cache key.
+
+namespace
+{
+struct VerifySigCacheShard
+{
+    std::mutex mMutex;
+    std::unique_ptr<RandomEvictionCache<Hash, bool>> mCache;
+    uint64_t mHits{0};
+    uint64_t mMisses{0};
 
-static std::mutex gVerifySigCacheMutex;
-static RandomEvictionCache<Hash, bool> gVerifySigCache(0xffff,
-                                                       /* separatePRNG */ true);
-static uint64_t gVerifyCacheHit = 0;
-static uint64_t gVerifyCacheMiss = 0;
+    explicit VerifySigCacheShard(size_t capacity)
+    {
+        resize(capacity);
+    }
+
+    // Must be called with mMutex held, except from the constructor
+    void
+    resize(size_t capacity)
+    {
+        mCache = std::make_unique<RandomEvictionCache<Hash, bool>>(
+            capacity, /* separatePRNG */ true);
+    }
+};
+
+class VerifySigCache
+{
+    std::vector<std::unique_ptr<VerifySigCacheShard>> mShards;
+
+  public:
+    VerifySigCache()
+    {
+        auto shardCapacity = PubKeyUtils::DEFAULT_VERIFY_SIG_CACHE_SIZE /
+                             PubKeyUtils::VERIFY_SIG_CACHE_SHARDS;
+        for (size_t i = 0; i < PubKeyUtils::VERIFY_SIG_CACHE_SHARDS; ++i)
+        {
+            mShards.emplace_back(
+                std::make_unique<VerifySigCacheShard>(shardCapacity));
+        }
+    }
+
+    VerifySigCacheShard&
+    shardFor(Hash const& cacheKey)
+    {
+        return *mShards[shardIndex(cacheKey)];
+    }
+
+    static size_t
+    shardIndex(Hash const& cacheKey)
+    {
+        // Cache keys are BLAKE2 hashes, so any byte is uniform
+        return cacheKey[0] % PubKeyUtils::VERIFY_SIG_CACHE_SHARDS;
+    }
+
+    VerifySigCacheShard&
+    shard(size_t i)
+    {
+        return *mShards[i];
+    }
+};
+
+VerifySigCache gVerifySigCache;
+}
 
 static Hash
 verifySigCacheKey(PublicKey const& key, Signature const& signature,
@@ -317,25 +381,80 @@ SecretKey::fromStrKeySeed(std::string const& strKeySeed)
 void
 PubKeyUtils::clearVerifySigCache()
 {
-    std::lock_guard<std::mutex> guard(gVerifySigCacheMutex);
-    gVerifySigCache.clear();
+    for (size_t i = 0; i < VERIFY_SIG_CACHE_SHARDS; ++i)
+    {
+        auto& shard = gVerifySigCache.shard(i);
+        std::lock_guard<std::mutex> guard(shard.mMutex);
+        shard.mCache->clear();
+    }
 }
 
 void
 PubKeyUtils::maybeSeedVerifySigCache(unsigned int seed)
 {
-    std::lock_guard<std::mutex> guard(gVerifySigCacheMutex);
-    gVerifySigCache.maybeSeed(seed);
+    for (size_t i = 0; i < VERIFY_SIG_CACHE_SHARDS; ++i)
+    {
+        auto& shard = gVerifySigCache.shard(i);
+        std::lock_guard<std::mutex> guard(shard.mMutex);
+        shard.mCache->maybeSeed(seed + static_cast<unsigned int>(i));
+    }
+}
+
+void
+PubKeyUtils::setVerifySigCacheSize(size_t size)
+{
+    auto shardCapacity =
+        std::max<size_t>(1, (size + VERIFY_SIG_CACHE_SHARDS - 1) /
+                                VERIFY_SIG_CACHE_SHARDS);
+    for (size_t i = 0; i < VERIFY_SIG_CACHE_SHARDS; ++i)
+    {
+        auto& shard = gVerifySigCache.shard(i);
+        std::lock_guard<std::mutex> guard(shard.mMutex);
+        if (shard.mCache->maxSize() != shardCapacity)
+        {
+            shard.resize(shardCapacity);
+        }
+    }
+}
+
+size_t
+PubKeyUtils::getVerifySigCacheSize()
+{
+    size_t size = 0;
+    for (size_t i = 0; i < VERIFY_SIG_CACHE_SHARDS; ++i)
+    {
+        auto& shard = gVerifySigCache.shard(i);
+        std::lock_guard<std::mutex> guard(shard.mMutex);
+        size += shard.mCache->maxSize();
+    }
+    return size;
+}
+
+void
+PubKeyUtils::flushVerifySigCacheCounts(std::vector<uint64_t>& hits,
+                                       std::vector<uint64_t>& misses)
+{
+    hits.assign(VERIFY_SIG_CACHE_SHARDS, 0);
+    misses.assign(VERIFY_SIG_CACHE_SHARDS, 0);
+    for (size_t i = 0; i < VERIFY_SIG_CACHE_SHARDS; ++i)
+    {
+        auto& shard = gVerifySigCache.shard(i);
+        std::lock_guard<std::mutex> guard(shard.mMutex);
+        hits[i] = shard.mHits;
+        misses[i] = shard.mMisses;
+        shard.mHits = 0;
+        shard.mMisses = 0;
+    }
 }
 
 void
 PubKeyUtils::flushVerifySigCacheCounts(uint64_t& hits, uint64_t& misses)
 {
-    std::lock_guard<std::mutex> guard(gVerifySigCacheMutex);
-    hits = gVerifyCacheHit;
-    misses = gVerifyCacheMiss;
-    gVerifyCacheHit = 0;
-    gVerifyCacheMiss = 0;
+    std::vector<uint64_t> shardHits, shardMisses;
+    flushVerifySigCacheCounts(shardHits, shardMisses);
+    hits = std::accumulate(shardHits.begin(), shardHits.end(), uint64_t{0});
+    misses =
+        std::accumulate(shardMisses.begin(), shardMisses.end(), uint64_t{0});
 }
 
 std::string
@@ -444,15 +563,16 @@ PubKeyUtils::verifySig(PublicKey const& key, Signature const& signature,
     }
 
     auto cacheKey = verifySigCacheKey(key, signature, bin);
+    auto& shard = gVerifySigCache.shardFor(cacheKey);
 
     {
-        std::lock_guard<std::mutex> guard(gVerifySigCacheMutex);
-        if (gVerifySigCache.exists(cacheKey))
+        std::lock_guard<std::mutex> guard(shard.mMutex);
+        if (shard.mCache->exists(cacheKey))
         {
-            ++gVerifyCacheHit;
+            ++shard.mHits;
             std::string hitStr("hit");
             ZoneText(hitStr.c_str(), hitStr.size());
-            return gVerifySigCache.get(cacheKey);
+            return shard.mCache->get(cacheKey);
         }
     }
 
@@ -461,12 +581,98 @@ PubKeyUtils::verifySig(PublicKey const& key, Signature const& signature,
     bool ok =
         (crypto_sign_verify_detached(signature.data(), bin.data(), bin.size(),
                                      key.ed25519().data()) == 0);
-    std::lock_guard<std::mutex> guard(gVerifySigCacheMutex);
-    ++gVerifyCacheMiss;
-    gVerifySigCache.put(cacheKey, ok);
+    std::lock_guard<std::mutex> guard(shard.mMutex);
+    ++shard.mMisses;
+    shard.mCache->put(cacheKey, ok);
     return ok;
 }
 
+std::vector<bool>
+PubKeyUtils::verifySigs(std::vector<SignatureToVerify> const& sigs,
+                        size_t numThreads)
+{
+    ZoneScoped;
+    std::vector<Hash> cacheKeys(sigs.size());
+    std::vector<uint8_t> valid(sigs.size(), 0);
+    std::vector<std::vector<size_t>> byShard(VERIFY_SIG_CACHE_SHARDS);
+    for (size_t i = 0; i < sigs.size(); ++i)
+    {
+        auto const& sig = sigs[i];
+        releaseAssert(sig.mKey.type() == PUBLIC_KEY_TYPE_ED25519);
+        if (sig.mSignature.size() == 64)
+        {
+            cacheKeys[i] =
+                verifySigCacheKey(sig.mKey, sig.mSignature, sig.mMessage);
+            byShard[VerifySigCache::shardIndex(cacheKeys[i])].push_back(i);
+        }
+    }
+
+    std::vector<size_t> misses;
+    for (size_t s = 0; s < VERIFY_SIG_CACHE_SHARDS; ++s)
+    {
+        if (byShard[s].empty())
+        {
+            continue;
+        }
+        auto& shard = gVerifySigCache.shard(s);
+        std::lock_guard<std::mutex> guard(shard.mMutex);
+        for (auto i : byShard[s])
+        {
+            if (shard.mCache->exists(cacheKeys[i]))
+            {
+                ++shard.mHits;
+                valid[i] = shard.mCache->get(cacheKeys[i]);
+            }
+            else
+            {
+                misses.push_back(i);
+            }
+        }
+    }
+
+    // Every miss is verified by exactly one thread, so threads write
+    // disjoint slots of valid
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        ZoneScopedN("verify signatures worker");
+        for (size_t m = next++; m < misses.size(); m = next++)
+        {
+            auto const& sig = sigs[misses[m]];
+            valid[misses[m]] =
+                crypto_sign_verify_detached(
+                    sig.mSignature.data(), sig.mMessage.data(),
+                    sig.mMessage.size(), sig.mKey.ed25519().data()) == 0;
+        }
+    };
+    numThreads = std::min(numThreads, misses.size());
+    std::vector<std::future<void>> futures;
+    for (size_t t = 1; t < numThreads; ++t)
+    {
+        futures.emplace_back(std::async(std::launch::async, worker));
+    }
+    worker();
+    for (auto& f : futures)
+    {
+        f.get();
+    }
+
+    // Misses were gathered shard by shard, so each shard's run is contiguous
+    for (size_t m = 0; m < misses.size();)
+    {
+        auto s = VerifySigCache::shardIndex(cacheKeys[misses[m]]);
+        auto& shard = gVerifySigCache.shard(s);
+        std::lock_guard<std::mutex> guard(shard.mMutex);
+        for (; m < misses.size() &&
+               VerifySigCache::shardIndex(cacheKeys[misses[m]]) == s;
+             ++m)
+        {
+            ++shard.mMisses;
+            shard.mCache->put(cacheKeys[misses[m]], valid[misses[m]] != 0);
+        }
+    }
+    return {valid.begin(), valid.end()};
+}
+
 PublicKey
 PubKeyUtils::random()
 {
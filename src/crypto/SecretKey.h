@@ -11,6 +11,7 @@
 #include <array>
 #include <functional>
 #include <ostream>
+#include <vector>
 
 namespace stellar
 {
@@ -139,9 +140,41 @@ namespace PubKeyUtils
 bool verifySig(PublicKey const& key, Signature const& signature,
                ByteSlice const& bin);
 
+// A signature of a hash, to be checked with verifySigs
+struct SignatureToVerify
+{
+    PublicKey mKey;
+    Signature mSignature;
+    Hash mMessage;
+};
+
+// Checks a batch of signatures, with the same result as calling verifySig on
+// each of them. The verification cache is consulted and updated once for the
+// whole batch, and the signatures missing from it are verified across
+// numThreads threads. Returns whether each signature is valid, indexed like
+// sigs.
+std::vector<bool> verifySigs(std::vector<SignatureToVerify> const& sigs,
+                             size_t numThreads = 1);
+
+// The verification cache is split into this many independently locked
+// shards
+size_t const VERIFY_SIG_CACHE_SHARDS = 16;
+size_t const DEFAULT_VERIFY_SIG_CACHE_SIZE = 0x10000;
+
 void clearVerifySigCache();
 void maybeSeedVerifySigCache(unsigned int seed);
+
+// Sets the total number of entries the verification cache holds, rounded up
+// to a multiple of VERIFY_SIG_CACHE_SHARDS. Shards whose capacity changes are
+// emptied.
+void setVerifySigCacheSize(size_t size);
+size_t getVerifySigCacheSize();
+
+// Returns the cache hits and misses since the last flush, in total or per
+// shard
 void flushVerifySigCacheCounts(uint64_t& hits, uint64_t& misses);
+void flushVerifySigCacheCounts(std::vector<uint64_t>& hits,
+                               std::vector<uint64_t>& misses);
 
 PublicKey random();
 #ifdef BUILD_TESTS
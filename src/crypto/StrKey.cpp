@@ -7,11 +7,92 @@
 #include "util/SecretValue.h"
 #include "util/crc16.h"
 #include <Tracy.hpp>
+#include <cstring>
 
 namespace stellar
 {
 namespace strKey
 {
+
+namespace
+{
+
+// StrKeys are encoded and decoded a lot for JSON output, so these replace the
+// generic bit-at-a-time base32 code with 5-byte groups. Seeds go through here
+// too, so neither branches nor indexes memory on the data beyond a 32-entry
+// table.
+char const B32_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
+
+void
+encodeB32Group(uint8_t const* in, char* out)
+{
+    uint64_t v = (uint64_t(in[0]) << 32) | (uint64_t(in[1]) << 24) |
+                 (uint64_t(in[2]) << 16) | (uint64_t(in[3]) << 8) | in[4];
+    for (int i = 0; i < 8; ++i)
+    {
+        out[i] = B32_ALPHABET[(v >> (35 - 5 * i)) & 31];
+    }
+}
+
+// Same output as decoder::encode_b32, padding included
+std::string
+encodeB32(uint8_t const* in, size_t size)
+{
+    std::string out(decoder::encoded_size32(size), '=');
+    char* o = out.data();
+    for (; size >= 5; size -= 5, in += 5, o += 8)
+    {
+        encodeB32Group(in, o);
+    }
+    if (size != 0)
+    {
+        uint8_t last[5] = {0};
+        char chars[8];
+        std::memcpy(last, in, size);
+        encodeB32Group(last, chars);
+        std::memcpy(o, chars, (size * 8 + 4) / 5);
+    }
+    return out;
+}
+
+// Value of base32 character `c`, or 0x100 if it isn't one
+int
+b32Value(unsigned char c)
+{
+    int letter = c - 'A';
+    int digit = c - '2';
+    // All ones where in range, computed without branches
+    int isLetter = ~((letter | (25 - letter)) >> 8);
+    int isDigit = ~((digit | (5 - digit)) >> 8);
+    return (isLetter & letter) | (isDigit & (digit + 26)) |
+           (~(isLetter | isDigit) & 0x100);
+}
+
+// Decode base32 whose size is a multiple of 8 and that has no padding. Returns
+// false for anything else, which decoder::decode_b32 handles.
+bool
+decodeB32(std::string const& in, std::vector<uint8_t>& out)
+{
+    out.resize(in.size() / 8 * 5);
+    int bad = 0;
+    for (size_t g = 0; g < in.size() / 8; ++g)
+    {
+        uint64_t v = 0;
+        for (size_t i = 0; i < 8; ++i)
+        {
+            int x = b32Value(static_cast<unsigned char>(in[8 * g + i]));
+            bad |= x;
+            v = (v << 5) | (x & 31);
+        }
+        for (size_t i = 0; i < 5; ++i)
+        {
+            out[5 * g + i] = static_cast<uint8_t>(v >> (32 - 8 * i));
+        }
+    }
+    return (bad & 0x100) == 0;
+}
+}
+
 // Encode a version byte and ByteSlice into StrKey
 SecretValue
 toStrKey(uint8_t ver, ByteSlice const& bin)
@@ -28,9 +109,7 @@ toStrKey(uint8_t ver, ByteSlice const& bin)
     crc >>= 8;
     toEncode.emplace_back(static_cast<uint8_t>(crc & 0xFF));
 
-    std::string res;
-    res = decoder::encode_b32(toEncode);
-    return SecretValue{res};
+    return SecretValue{encodeB32(toEncode.data(), toEncode.size())};
 }
 
 size_t
@@ -52,7 +131,10 @@ fromStrKey(std::string const& strKey, uint8_t& outVersion,
     {
         return false;
     }
-    decoder::decode_b32(strKey, decoded);
+    if (!decodeB32(strKey, decoded))
+    {
+        decoder::decode_b32(strKey, decoded);
+    }
     if (decoded.size() < 3)
     {
         return false;
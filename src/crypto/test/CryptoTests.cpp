@@ -7,20 +7,30 @@
 #include "crypto/KeyUtils.h"
 #include "crypto/Random.h"
 #include "crypto/SHA.h"
+#include "crypto/SHA256Accel.h"
 #include "crypto/SecretKey.h"
 #include "crypto/ShortHash.h"
 #include "crypto/SignerKey.h"
 #include "crypto/StrKey.h"
 #include "ledger/test/LedgerTestUtils.h"
+#include "lib/util/finally.h"
 #include "test/Catch2.h"
 #include "test/test.h"
+#include "util/Decoder.h"
 #include "util/Logging.h"
+#include "util/Math.h"
+#include "util/crc16.h"
 #include "xdr/Stellar-types.h"
+#include <algorithm>
 #include <autocheck/autocheck.hpp>
+#include <atomic>
+#include <chrono>
 #include <map>
+#include <numeric>
 #include <regex>
 #include <sodium.h>
 #include <stdexcept>
+#include <thread>
 
 using namespace stellar;
 
@@ -72,6 +82,56 @@ TEST_CASE("hex tests", "[crypto]")
         20);
 }
 
+TEST_CASE("hex matches libsodium", "[crypto]")
+{
+    // Sizes around the 16 byte blocks converted at once
+    for (size_t size = 0; size < 100; ++size)
+    {
+        auto bytes = randomBytes(size);
+        std::vector<char> expected(size * 2 + 1);
+        sodium_bin2hex(expected.data(), expected.size(), bytes.data(), size);
+        auto enc = binToHex(bytes);
+        REQUIRE(enc == std::string(expected.data()));
+
+        std::string upper(enc);
+        std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+        REQUIRE(hexToBin(upper) == bytes);
+
+        if (size != 0)
+        {
+            REQUIRE_THROWS(hexToBin(enc.substr(1)));
+            for (char bad : {'g', 'G', '/', ':', '@', '`', ' ', '\xff'})
+            {
+                std::string corrupted(enc);
+                corrupted[rand_uniform<size_t>(0, enc.size() - 1)] = bad;
+                REQUIRE_THROWS(hexToBin(corrupted));
+            }
+        }
+    }
+}
+
+TEST_CASE("hex and StrKey bench", "[!hide][hex-bench]")
+{
+    size_t const n = 1000000;
+    auto hash = sha256("hex bench");
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; ++i)
+    {
+        hexToBin256(binToHex(hash));
+    }
+    auto step1 = std::chrono::steady_clock::now();
+    auto key = SecretKey::pseudoRandomForTesting().getPublicKey();
+    for (size_t i = 0; i < n; ++i)
+    {
+        KeyUtils::fromStrKey<PublicKey>(KeyUtils::toStrKey(key));
+    }
+    auto step2 = std::chrono::steady_clock::now();
+    LOG_INFO(DEFAULT_LOG, "hex round trip of a hash: {} per iteration",
+             (step1 - start) / n);
+    LOG_INFO(DEFAULT_LOG, "StrKey round trip of a public key: {} per iteration",
+             (step2 - step1) / n);
+}
+
 static std::map<std::string, std::string> sha256TestVectors = {
     {"", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
 
@@ -120,6 +180,57 @@ TEST_CASE("XDRSHA256 is identical to byte SHA256", "[crypto]")
     }
 }
 
+TEST_CASE("XDRSHA256 of several objects is identical to byte SHA256",
+          "[crypto]")
+{
+    Hash networkID = sha256("network");
+    for (size_t i = 0; i < 100; ++i)
+    {
+        auto entry = LedgerTestUtils::generateValidLedgerEntry(100);
+        auto bytes_hash = sha256(
+            xdr::xdr_to_opaque(networkID, ENVELOPE_TYPE_TX, 0, entry));
+        auto stream_hash = xdrSha256(networkID, ENVELOPE_TYPE_TX, 0, entry);
+        CHECK(bytes_hash == stream_hash);
+    }
+}
+
+TEST_CASE("SHA256 implementations agree", "[crypto]")
+{
+    auto original = getSHA256Impl();
+    auto restore = gsl::finally([&]() { setSHA256ImplForTesting(original); });
+    for (auto impl : getSupportedSHA256Impls())
+    {
+        LOG_INFO(DEFAULT_LOG, "checking SHA256 implementation {}",
+                 sha256ImplName(impl));
+        setSHA256ImplForTesting(impl);
+        for (auto const& pair : sha256TestVectors)
+        {
+            CHECK(binToHex(sha256(pair.first)) == pair.second);
+        }
+        for (size_t len : {0, 1, 55, 56, 63, 64, 65, 119, 120, 128, 1000,
+                           4096, 100000})
+        {
+            auto bytes = randomBytes(len);
+            uint256 expected;
+            REQUIRE(crypto_hash_sha256(expected.data(), bytes.data(),
+                                       bytes.size()) == 0);
+            CHECK(sha256(bytes) == expected);
+
+            // Split the input at arbitrary points to exercise buffering
+            SHA256 h;
+            size_t pos = 0;
+            while (pos < len)
+            {
+                size_t step =
+                    std::min(len - pos, rand_uniform<size_t>(0, 150));
+                h.add(ByteSlice(bytes.data() + pos, step));
+                pos += step;
+            }
+            CHECK(h.finish() == expected);
+        }
+    }
+}
+
 TEST_CASE("SHA256 bytes bench", "[!hide][sha-bytes-bench]")
 {
     shortHash::initialize();
@@ -157,6 +268,31 @@ TEST_CASE("SHA256 XDR bench", "[!hide][sha-xdr-bench]")
     }
 }
 
+TEST_CASE("SHA256 implementations bench", "[!hide][sha-impl-bench]")
+{
+    auto original = getSHA256Impl();
+    auto restore = gsl::finally([&]() { setSHA256ImplForTesting(original); });
+    // Large buffers like bucket files, and small ones like transactions
+    for (size_t size : {size_t(64 * 1024 * 1024), size_t(256)})
+    {
+        auto bytes = randomBytes(size);
+        size_t const total = size_t(1) << 30;
+        for (auto impl : getSupportedSHA256Impls())
+        {
+            setSHA256ImplForTesting(impl);
+            auto start = std::chrono::steady_clock::now();
+            for (size_t done = 0; done < total; done += size)
+            {
+                sha256(bytes);
+            }
+            std::chrono::duration<double> secs =
+                std::chrono::steady_clock::now() - start;
+            LOG_INFO(DEFAULT_LOG, "SHA256 {}, {} byte inputs: {:.2f} GB/s",
+                     sha256ImplName(impl), size, total / secs.count() / 1e9);
+        }
+    }
+}
+
 static std::map<std::string, std::string> blake2TestVectors = {
     {"", "0e5751c026e543b2e8ab2eb06099daa1d1e5df47778f7787faab45cdf12fe3a8"},
 
@@ -254,6 +390,24 @@ TEST_CASE("HMAC test vector", "[crypto]")
     auto v = hmacSha256(k, s);
     REQUIRE(h == v.mac);
     REQUIRE(hmacSha256Verify(v, k, s));
+
+    HmacSha256 stateful(k);
+    stateful.add(s);
+    REQUIRE(hmacSha256Equal(stateful.finish(), v));
+}
+
+TEST_CASE("XDRHmacSha256 is identical to byte HMAC", "[crypto]")
+{
+    HmacSha256Key k;
+    k.key[0] = 'k';
+    for (uint64_t i = 0; i < 1000; ++i)
+    {
+        auto entry = LedgerTestUtils::generateValidLedgerEntry(100);
+        auto bytes_mac = hmacSha256(k, xdr::xdr_to_opaque(i, entry));
+        auto stream_mac = xdrHmacSha256(k, i, entry);
+        CHECK(hmacSha256Equal(bytes_mac, stream_mac));
+        CHECK(bytes_mac.mac == stream_mac.mac);
+    }
 }
 
 TEST_CASE("HKDF test vector", "[crypto]")
@@ -296,6 +450,155 @@ TEST_CASE("sign tests", "[crypto]")
     CHECK(!PubKeyUtils::verifySig(pk, sig, msg));
 }
 
+TEST_CASE("batch signature verification", "[crypto]")
+{
+    std::vector<PubKeyUtils::SignatureToVerify> sigs;
+    std::vector<bool> expected;
+    for (int i = 0; i < 64; ++i)
+    {
+        auto sk = SecretKey::pseudoRandomForTesting();
+        auto msg = sha256(std::to_string(i));
+        sigs.push_back({sk.getPublicKey(), sk.sign(msg), msg});
+        expected.push_back(true);
+        switch (i % 4)
+        {
+        case 1:
+            sigs.back().mSignature[4] ^= 1;
+            expected.back() = false;
+            break;
+        case 2:
+            sigs.back().mMessage = sha256("other");
+            expected.back() = false;
+            break;
+        case 3:
+            sigs.back().mSignature.resize(10);
+            expected.back() = false;
+            break;
+        default:
+            break;
+        }
+    }
+
+    auto check = [&](size_t numThreads) {
+        REQUIRE(PubKeyUtils::verifySigs(sigs, numThreads) == expected);
+        for (size_t i = 0; i < sigs.size(); ++i)
+        {
+            REQUIRE(PubKeyUtils::verifySig(sigs[i].mKey, sigs[i].mSignature,
+                                           sigs[i].mMessage) == expected[i]);
+        }
+    };
+
+    SECTION("one thread")
+    {
+        PubKeyUtils::clearVerifySigCache();
+        check(1);
+    }
+    SECTION("several threads")
+    {
+        PubKeyUtils::clearVerifySigCache();
+        check(4);
+    }
+    SECTION("cached")
+    {
+        uint64_t hits, misses;
+        PubKeyUtils::clearVerifySigCache();
+        PubKeyUtils::flushVerifySigCacheCounts(hits, misses);
+        PubKeyUtils::verifySigs(sigs);
+        PubKeyUtils::flushVerifySigCacheCounts(hits, misses);
+        REQUIRE(misses == sigs.size() - sigs.size() / 4);
+        check(4);
+        PubKeyUtils::flushVerifySigCacheCounts(hits, misses);
+        REQUIRE(misses == 0);
+    }
+    SECTION("empty")
+    {
+        REQUIRE(PubKeyUtils::verifySigs({}, 4).empty());
+    }
+}
+
+TEST_CASE("sharded signature cache", "[crypto]")
+{
+    auto originalSize = PubKeyUtils::getVerifySigCacheSize();
+
+    SECTION("size is rounded up to whole shards")
+    {
+        PubKeyUtils::setVerifySigCacheSize(1);
+        REQUIRE(PubKeyUtils::getVerifySigCacheSize() ==
+                PubKeyUtils::VERIFY_SIG_CACHE_SHARDS);
+        PubKeyUtils::setVerifySigCacheSize(1000);
+        REQUIRE(PubKeyUtils::getVerifySigCacheSize() ==
+                PubKeyUtils::VERIFY_SIG_CACHE_SHARDS * 63);
+    }
+
+    SECTION("concurrent verification")
+    {
+        std::vector<PubKeyUtils::SignatureToVerify> sigs;
+        for (int i = 0; i < 256; ++i)
+        {
+            auto sk = SecretKey::pseudoRandomForTesting();
+            auto msg = sha256(std::to_string(i));
+            sigs.push_back({sk.getPublicKey(), sk.sign(msg), msg});
+        }
+
+        uint64_t hits, misses;
+        PubKeyUtils::clearVerifySigCache();
+        PubKeyUtils::flushVerifySigCacheCounts(hits, misses);
+
+        // Every thread verifies every signature, each starting at a
+        // different offset
+        size_t const numThreads = 4;
+        std::vector<std::thread> threads;
+        std::atomic<bool> allValid{true};
+        for (size_t t = 0; t < numThreads; ++t)
+        {
+            threads.emplace_back([&, t]() {
+                for (size_t j = 0; j < sigs.size(); ++j)
+                {
+                    auto const& sig = sigs[(j + t * 64) % sigs.size()];
+                    if (!PubKeyUtils::verifySig(sig.mKey, sig.mSignature,
+                                                sig.mMessage))
+                    {
+                        allValid = false;
+                    }
+                }
+            });
+        }
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+        REQUIRE(allValid);
+
+        std::vector<uint64_t> shardHits, shardMisses;
+        PubKeyUtils::flushVerifySigCacheCounts(shardHits, shardMisses);
+        REQUIRE(shardHits.size() == PubKeyUtils::VERIFY_SIG_CACHE_SHARDS);
+        REQUIRE(shardMisses.size() == PubKeyUtils::VERIFY_SIG_CACHE_SHARDS);
+        auto totalHits = std::accumulate(shardHits.begin(), shardHits.end(),
+                                         uint64_t{0});
+        auto totalMisses = std::accumulate(shardMisses.begin(),
+                                           shardMisses.end(), uint64_t{0});
+        REQUIRE(totalHits + totalMisses == numThreads * sigs.size());
+        REQUIRE(totalMisses >= sigs.size());
+        // 256 random keys hit every one of the 16 shards
+        for (auto m : shardMisses)
+        {
+            REQUIRE(m > 0);
+        }
+
+        // Everything is cached now
+        for (auto const& sig : sigs)
+        {
+            REQUIRE(PubKeyUtils::verifySig(sig.mKey, sig.mSignature,
+                                           sig.mMessage));
+        }
+        PubKeyUtils::flushVerifySigCacheCounts(hits, misses);
+        REQUIRE(hits == sigs.size());
+        REQUIRE(misses == 0);
+    }
+
+    PubKeyUtils::setVerifySigCacheSize(originalSize);
+}
+
 TEST_CASE("sign and verify benchmarking", "[crypto-bench][bench][!hide]")
 {
     size_t signPerSec = 0, verifyPerSec = 0;
@@ -365,6 +668,19 @@ TEST_CASE("StrKey tests", "[crypto]")
         REQUIRE(decoded == in);
     }
 
+    // check against the generic base32 encoder
+    for (size_t size = 0; size < 100; size++)
+    {
+        std::vector<uint8_t> in(input(size));
+        std::vector<uint8_t> raw{static_cast<uint8_t>(version << 3)};
+        raw.insert(raw.end(), in.begin(), in.end());
+        uint16_t crc = crc16((char*)raw.data(), (int)raw.size());
+        raw.emplace_back(static_cast<uint8_t>(crc & 0xFF));
+        raw.emplace_back(static_cast<uint8_t>(crc >> 8));
+        REQUIRE(strKey::toStrKey(version, in).value ==
+                decoder::encode_b32(raw));
+    }
+
     // basic corruption check on a fixed size
     size_t n_corrupted = 0;
     size_t n_detected = 0;
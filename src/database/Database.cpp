@@ -22,6 +22,7 @@
 #include "herder/HerderPersistence.h"
 #include "herder/Upgrades.h"
 #include "history/HistoryManager.h"
+#include "ledger/LedgerHeaderRing.h"
 #include "ledger/LedgerHeaderUtils.h"
 #include "ledger/LedgerTxn.h"
 #include "main/PersistentState.h"
@@ -81,6 +82,10 @@ static int const MIN_POSTGRESQL_VERSION =
     (10000 * MIN_POSTGRESQL_MAJOR_VERSION) +
     (100 * MIN_POSTGRESQL_MINOR_VERSION);
 
+// Name of the in-memory database the offers table is attached as, with
+// SQLITE_IN_MEMORY_OFFERS
+static char const* const OFFERS_SCHEMA = "offersmem";
+
 #ifdef USE_POSTGRES
 static std::string
 badPgVersion(int vers)
@@ -184,6 +189,10 @@ Database::Database(Application& app)
     , mStatementsSize(
           app.getMetrics().NewCounter({"database", "memory", "statements"}))
 {
+    mLedgerHeaderRing = std::make_unique<LedgerHeaderRing>(
+        LedgerHeaderRing::CHECKPOINTS_KEPT *
+            HistoryManager::getCheckpointFrequency(app.getConfig()),
+        app.getMetrics());
     registerDrivers();
 
     CLOG_INFO(
@@ -192,12 +201,22 @@ Database::Database(Application& app)
     open();
 }
 
+Database::~Database()
+{
+}
+
 void
 Database::open()
 {
     mSession.session().open(mApp.getConfig().DATABASE.value);
     DatabaseConfigureSessionOp op(mSession.session());
     doDatabaseTypeSpecificOperation(mSession, op);
+    if (offersInMemory())
+    {
+        // Only the main session ever touches offers with SQLite
+        mSession.session() << "ATTACH DATABASE ':memory:' AS "
+                           << OFFERS_SCHEMA;
+    }
 }
 
 void
@@ -399,6 +418,36 @@ Database::isSqlite() const
            std::string::npos;
 }
 
+bool
+Database::offersInMemory() const
+{
+    return isSqlite() && mApp.getConfig().SQLITE_IN_MEMORY_OFFERS;
+}
+
+std::string
+Database::getOffersSchemaPrefix() const
+{
+    return offersInMemory() ? std::string(OFFERS_SCHEMA) + "." : "";
+}
+
+bool
+Database::mustRebuildOffers()
+{
+    if (offersInMemory())
+    {
+        return true;
+    }
+    if (!isSqlite())
+    {
+        return false;
+    }
+    int tables = 0;
+    getRawSession() << "SELECT COUNT(*) FROM main.sqlite_master WHERE "
+                       "type = 'table' AND name = 'offers';",
+        soci::into(tables);
+    return tables == 0;
+}
+
 std::string
 Database::getSimpleCollationClause() const
 {
@@ -542,6 +591,12 @@ Database::getPool()
     return *mPool;
 }
 
+LedgerHeaderRing&
+Database::getLedgerHeaderRing()
+{
+    return *mLedgerHeaderRing;
+}
+
 StatementContext
 Database::getPreparedStatement(std::string const& query,
                                SessionWrapper& session)
@@ -11,6 +11,7 @@
 #include "util/NonCopyable.h"
 #include "util/Timer.h"
 #include <functional>
+#include <memory>
 #include <set>
 #include <soci.h>
 #include <string>
@@ -26,6 +27,7 @@ class Counter;
 namespace stellar
 {
 class Application;
+class LedgerHeaderRing;
 using PreparedStatementCache =
     std::map<std::string, std::shared_ptr<soci::statement>>;
 
@@ -123,6 +125,7 @@ class Database : NonMovableOrCopyable
     Application& mApp;
     medida::Meter& mQueryMeter;
     SessionWrapper mSession;
+    std::unique_ptr<LedgerHeaderRing> mLedgerHeaderRing;
 
     std::unique_ptr<soci::connection_pool> mPool;
 
@@ -149,9 +152,7 @@ class Database : NonMovableOrCopyable
     // if there is a connection error, this will throw.
     Database(Application& app);
 
-    virtual ~Database()
-    {
-    }
+    virtual ~Database();
 
     // Return a helper object that borrows, from the Database, a prepared
     // statement handle for the provided query. The prepared statement handle
@@ -191,6 +192,21 @@ class Database : NonMovableOrCopyable
     // defaults are correct already).
     std::string getSimpleCollationClause() const;
 
+    // Return true if the offers table lives in an in-memory database attached
+    // to the main session rather than in the database itself, see
+    // SQLITE_IN_MEMORY_OFFERS.
+    bool offersInMemory() const;
+
+    // The schema to create the offers table in, with a trailing dot, or
+    // nothing for the main database. Queries don't need it: SQLite finds the
+    // table in the attached database when the main one has none.
+    std::string getOffersSchemaPrefix() const;
+
+    // Return true if the offers table has to be rebuilt from the BucketList
+    // before use, because it is in memory or was left out of the database by
+    // a previous run with it in memory.
+    bool mustRebuildOffers();
+
     // Call `op` back with the specific database backend subtype in use.
     template <typename T>
     T doDatabaseTypeSpecificOperation(SessionWrapper& session,
@@ -222,6 +238,10 @@ class Database : NonMovableOrCopyable
     // Access the optional SOCI connection pool available for worker
     // threads. Throws an error if !canUsePool().
     soci::connection_pool& getPool();
+
+    // Recent ledger headers, kept in sync with the ledgerheaders table by
+    // LedgerHeaderUtils
+    LedgerHeaderRing& getLedgerHeaderRing();
 };
 
 template <typename T>
@@ -8,11 +8,12 @@ namespace stellar
 {
 namespace DatabaseUtils
 {
-void
+DeletedEntries
 deleteOldEntriesHelper(soci::session& sess, uint32_t ledgerSeq, uint32_t count,
                        std::string const& tableName,
                        std::string const& ledgerSeqColumn)
 {
+    DeletedEntries res;
     uint32_t curMin = 0;
     soci::indicator gotMin;
     soci::statement st = (sess.prepare << "SELECT MIN(" << ledgerSeqColumn
@@ -26,9 +27,14 @@ deleteOldEntriesHelper(soci::session& sess, uint32_t ledgerSeq, uint32_t count,
             std::min<uint64>(static_cast<uint64>(curMin) + count, ledgerSeq);
         // safe to cast down as it's at most ledgerSeq
         uint64 m = static_cast<uint32>(m64);
-        sess << "DELETE FROM " << tableName << " WHERE " << ledgerSeqColumn
-             << " <= " << m;
+        soci::statement del = (sess.prepare << "DELETE FROM " << tableName
+                                            << " WHERE " << ledgerSeqColumn
+                                            << " <= " << m);
+        del.execute(true);
+        res.mRows = static_cast<uint64_t>(del.get_affected_rows());
+        res.mLedgersLeft = static_cast<uint32_t>(ledgerSeq - m);
     }
+    return res;
 }
 }
 }
\ No newline at end of file
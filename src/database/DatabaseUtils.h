@@ -5,13 +5,30 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "Database.h"
+#include <algorithm>
 
 namespace stellar
 {
 namespace DatabaseUtils
 {
-void deleteOldEntriesHelper(soci::session& sess, uint32_t ledgerSeq,
-                            uint32_t count, std::string const& tableName,
-                            std::string const& ledgerSeqColumn);
+struct DeletedEntries
+{
+    uint64_t mRows{0};
+    // Number of ledgers <= ledgerSeq that may still have entries
+    uint32_t mLedgersLeft{0};
+
+    void
+    add(DeletedEntries const& other)
+    {
+        mRows += other.mRows;
+        mLedgersLeft = std::max(mLedgersLeft, other.mLedgersLeft);
+    }
+};
+
+// Deletes the entries of the `count` oldest ledgers, stopping at ledgerSeq
+DeletedEntries deleteOldEntriesHelper(soci::session& sess, uint32_t ledgerSeq,
+                                      uint32_t count,
+                                      std::string const& tableName,
+                                      std::string const& ledgerSeqColumn);
 }
 }
@@ -11,6 +11,7 @@
 #include "lib/util/stdrandom.h"
 #include "main/Application.h"
 #include "main/Config.h"
+#include "main/PersistentState.h"
 #include "test/Catch2.h"
 #include "test/TestUtils.h"
 #include "test/test.h"
@@ -358,3 +359,62 @@ TEST_CASE("schema test", "[db]")
     auto dbv = db.getDBSchemaVersion();
     REQUIRE(dbv == SCHEMA_VERSION);
 }
+
+TEST_CASE("persistent state batch upsert", "[db]")
+{
+    Config const& cfg = getTestConfig(0, Config::TESTDB_IN_MEMORY);
+
+    VirtualClock clock;
+    Application::pointer app = createTestApplication(clock, cfg);
+
+    auto& ps = app->getPersistentState();
+    auto& sess = app->getDatabase().getSession();
+    auto check = [&](std::string const& lcl, std::string const& has) {
+        REQUIRE(ps.getState(PersistentState::kLastClosedLedger, sess) == lcl);
+        REQUIRE(ps.getState(PersistentState::kHistoryArchiveState, sess) ==
+                has);
+    };
+
+    // Rows that exist are replaced, others are inserted
+    ps.setStates({{PersistentState::kLastClosedLedger, "lcl1"},
+                  {PersistentState::kHistoryArchiveState, "has1"}},
+                 sess);
+    check("lcl1", "has1");
+
+    ps.setState(PersistentState::kLastClosedLedger, "lcl2", sess);
+    check("lcl2", "has1");
+
+    ps.setStates({{PersistentState::kLastClosedLedger, "lcl3"},
+                  {PersistentState::kHistoryArchiveState, "has3"}},
+                 sess);
+    check("lcl3", "has3");
+}
+
+TEST_CASE("sqlite in-memory offers", "[db]")
+{
+    Config cfg = getTestConfig(0, Config::TESTDB_BUCKET_DB_PERSISTENT);
+    cfg.SQLITE_IN_MEMORY_OFFERS = true;
+
+    VirtualClock clock;
+    Application::pointer app = createTestApplication(clock, cfg);
+
+    auto& db = app->getDatabase();
+    REQUIRE(db.offersInMemory());
+    REQUIRE(db.mustRebuildOffers());
+
+    auto countTables = [&](std::string const& schema) {
+        int tables = 0;
+        db.getRawSession() << "SELECT COUNT(*) FROM " << schema
+                           << ".sqlite_master WHERE type = 'table' AND "
+                              "name = 'offers';",
+            soci::into(tables);
+        return tables;
+    };
+    REQUIRE(countTables("main") == 0);
+    REQUIRE(countTables("offersmem") == 1);
+
+    // Unqualified queries find the in-memory table
+    int offers = -1;
+    db.getRawSession() << "SELECT COUNT(*) FROM offers;", soci::into(offers);
+    REQUIRE(offers == 0);
+}
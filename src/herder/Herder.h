@@ -146,6 +146,15 @@ class Herder
 
     // We are learning about a new envelope.
     virtual EnvelopeStatus recvSCPEnvelope(SCPEnvelope const& envelope) = 0;
+    // Same as recvSCPEnvelope, for an envelope whose signature has already
+    // been verified, e.g. on the overlay thread.
+    virtual EnvelopeStatus
+    recvVerifiedSCPEnvelope(SCPEnvelope const& envelope) = 0;
+
+    // Returns false if envelopes for `slotIndex` are too old to be accepted.
+    // Safe to call from any thread. The bound is updated whenever the
+    // tracked slot changes, so recvSCPEnvelope still has to check the slot.
+    virtual bool isSCPSlotAboveMinimum(uint64_t slotIndex) const = 0;
 
     virtual bool isTracking() const = 0;
 
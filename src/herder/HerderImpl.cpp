@@ -5,6 +5,7 @@
 #include "herder/HerderImpl.h"
 #include "bucket/BucketManager.h"
 #include "bucket/BucketSnapshotManager.h"
+#include "bucket/SearchableBucketList.h"
 #include "crypto/Hex.h"
 #include "crypto/KeyUtils.h"
 #include "crypto/SHA.h"
@@ -17,6 +18,7 @@
 #include "herder/TxSetFrame.h"
 #include "herder/TxSetUtils.h"
 #include "ledger/LedgerManager.h"
+#include "ledger/LedgerTypeUtils.h"
 #include "lib/json/json.h"
 #include "main/Application.h"
 #include "main/Config.h"
@@ -38,6 +40,7 @@
 #include "medida/counter.h"
 #include "medida/meter.h"
 #include "medida/metrics_registry.h"
+#include "medida/timer.h"
 #include "util/Decoder.h"
 #include "util/XDRStream.h"
 #include "xdr/Stellar-internal.h"
@@ -50,6 +53,10 @@
 #include <ctime>
 #include <fmt/format.h>
 
+#ifdef BUILD_TESTS
+#include "simulation/LoadGenerator.h"
+#endif
+
 using namespace std;
 namespace stellar
 {
@@ -155,6 +162,14 @@ HerderImpl::setTrackingSCPState(uint64_t index, StellarValue const& value,
     {
         setState(Herder::HERDER_SYNCING_STATE);
     }
+    mMinSCPSlotToAccept = getMinLedgerSeqToRemember();
+    mCheckpointSCPSlot = getMostRecentCheckpointSeq();
+}
+
+bool
+HerderImpl::isSCPSlotAboveMinimum(uint64_t slotIndex) const
+{
+    return slotIndex >= mMinSCPSlotToAccept || slotIndex == mCheckpointSCPSlot;
 }
 
 uint32
@@ -258,6 +273,9 @@ HerderImpl::newSlotExternalized(bool synchronous, StellarValue const& value)
     {
         eraseBelow(minSlotToRemember);
     }
+    // Slots before the last closed ledger are only kept around to answer
+    // peers and the /scp endpoint, serialized envelopes are enough for that
+    getSCP().compactSlots(mLedgerManager.getLastClosedLedgerNum());
     mPendingEnvelopes.forceRebuildQuorum();
 
     // Process new ready messages for the next slot
@@ -333,17 +351,31 @@ HerderImpl::processExternalized(uint64 slotIndex, StellarValue const& value,
         }
     }
 
+    // A prefetch for a tx set that lost is only wasting IO now
+    if (value.txSetHash != mCandidatePrefetchTxSetHash)
+    {
+        ++*mCandidatePrefetchGeneration;
+    }
 
-
-
-
-
+    // When the value applies on top of LCL, hand over the frame its tx set
+    // was validated with during this round, so applying doesn't have to
+    // prepare it again.
+    ApplicableTxSetFrameConstPtr applicableTxSet;
+    auto const& lcl = mLedgerManager.getLastClosedLedgerHeader();
+    if (slotIndex == lcl.header.ledgerSeq + 1 &&
+        value.closeTime >= lcl.header.scpValue.closeTime)
+    {
+        applicableTxSet = mHerderSCPDriver.getValidatedTxSet(
+            value.txSetHash, lcl,
+            value.closeTime - lcl.header.scpValue.closeTime);
+    }
 
     // tell the LedgerManager that this value got externalized
     // LedgerManager will perform the proper action based on its internal
     // state: apply, trigger catchup, etc
     LedgerCloseData ledgerData(static_cast<uint32_t>(slotIndex),
-                               externalizedSet, value);
+                               externalizedSet, value, std::nullopt,
+                               applicableTxSet);
 
     // Only dump the most recent externalized tx set. Ledger sequence on a
     // written tx set shall only strictly move forward; it may have gaps with
@@ -787,6 +819,19 @@ HerderImpl::getMinLedgerSeqToRemember() const
 
 Herder::EnvelopeStatus
 HerderImpl::recvSCPEnvelope(SCPEnvelope const& envelope)
+{
+    return recvSCPEnvelope(envelope, /* signatureVerified */ false);
+}
+
+Herder::EnvelopeStatus
+HerderImpl::recvVerifiedSCPEnvelope(SCPEnvelope const& envelope)
+{
+    return recvSCPEnvelope(envelope, /* signatureVerified */ true);
+}
+
+Herder::EnvelopeStatus
+HerderImpl::recvSCPEnvelope(SCPEnvelope const& envelope,
+                            bool signatureVerified)
 {
     ZoneScoped;
     if (mApp.getConfig().MANUAL_CLOSE)
@@ -857,7 +902,11 @@ HerderImpl::recvSCPEnvelope(SCPEnvelope const& envelope)
     }
 
     // **** from this point, we have to check signatures
-    if (!verifyEnvelope(envelope))
+    if (signatureVerified)
+    {
+        mSCPMetrics.mEnvelopeValidSig.Mark();
+    }
+    else if (!verifyEnvelope(envelope))
     {
         std::string txt("DISCARDED - bad envelope");
         ZoneText(txt.c_str(), txt.size());
@@ -1048,6 +1097,83 @@ HerderImpl::sendSCPStateToPeer(uint32 ledgerSeq, Peer::pointer peer)
     }
 }
 
+void
+HerderImpl::prefetchCandidateTxSet(ApplicableTxSetFrameConstPtr txSet)
+{
+    ZoneScoped;
+    auto const& cfg = mApp.getConfig();
+    if (!cfg.PREFETCH_CANDIDATE_TX_SET || cfg.PREFETCH_BATCH_SIZE == 0 ||
+        cfg.allBucketsInMemory())
+    {
+        return;
+    }
+#ifdef BUILD_TESTS
+    if (cfg.MODE_USES_IN_MEMORY_LEDGER)
+    {
+        return;
+    }
+#endif
+    if (txSet->getContentsHash() == mCandidatePrefetchTxSetHash)
+    {
+        return;
+    }
+    mCandidatePrefetchTxSetHash = txSet->getContentsHash();
+    auto generation = ++*mCandidatePrefetchGeneration;
+
+    // Like the apply-time prefetch, Soroban entries are left out: they don't
+    // come from disk.
+    auto snapshot = mApp.getBucketManager()
+                        .getBucketSnapshotManager()
+                        .copySearchableLiveBucketListSnapshot();
+    mApp.postOnBackgroundThread(
+        [txSet, snapshot, generation,
+         current = mCandidatePrefetchGeneration,
+         batchSize = cfg.PREFETCH_BATCH_SIZE]() {
+            ZoneScopedN("candidate tx set prefetch");
+            try
+            {
+                LedgerKeySet batch;
+                UnorderedSet<LedgerKey> txKeys;
+                for (auto const& phase : txSet->getPhases())
+                {
+                    for (auto const& tx : phase)
+                    {
+                        if (*current != generation)
+                        {
+                            return;
+                        }
+                        txKeys.clear();
+                        tx->insertKeysForFeeProcessing(txKeys);
+                        tx->insertKeysForTxApply(txKeys);
+                        for (auto const& key : txKeys)
+                        {
+                            if (!isSorobanEntry(key) && key.type() != TTL)
+                            {
+                                batch.insert(key);
+                            }
+                        }
+                        if (batch.size() >= batchSize)
+                        {
+                            snapshot->loadKeys(batch, "candidatePrefetch");
+                            batch.clear();
+                        }
+                    }
+                }
+                if (!batch.empty() && *current == generation)
+                {
+                    snapshot->loadKeys(batch, "candidatePrefetch");
+                }
+            }
+            catch (std::exception const& e)
+            {
+                CLOG_DEBUG(Herder, "Candidate tx set prefetch failed: {}",
+                           e.what());
+            }
+        },
+        "candidate tx set prefetch",
+        BackgroundWorkClass::APPLY);
+}
+
 void
 HerderImpl::processSCPQueue()
 {
@@ -1414,12 +1540,14 @@ HerderImpl::triggerNextLedger(uint32_t ledgerSeqToTrigger,
     }
 
     // our first choice for this round's set is all the tx we have collected
-    // during last few ledger closes
+    // during last few ledger closes (for the classic phase, only the ones
+    // that can make it into the set, see getNominationCandidates)
     // Since we are not currently applying, it is safe to use read-only LCL, as
     // it's guaranteed to be up-to-date
     auto lcl = mLedgerManager.getLastClosedLedgerHeader();
     PerPhaseTransactionList txPhases;
-    txPhases.emplace_back(mTransactionQueue.getTransactions(lcl.header));
+    txPhases.emplace_back(
+        mTransactionQueue.getNominationCandidates(lcl.header));
 
     if (protocolVersionStartsFrom(lcl.header.ledgerVersion,
                                   SOROBAN_PROTOCOL_VERSION))
@@ -1492,7 +1620,7 @@ HerderImpl::triggerNextLedger(uint32_t ledgerSeqToTrigger,
 
     // New proposed tx set must be valid, so we explicitly populate tx set
     // validity cache so SCP can re-use the result.
-    mHerderSCPDriver.cacheValidTxSet(*applicableProposedSet, lcl,
+    mHerderSCPDriver.cacheValidTxSet(applicableProposedSet, lcl,
                                      upperBoundCloseTimeOffset);
 
     if (protocolVersionStartsFrom(lcl.header.ledgerVersion,
@@ -1668,6 +1796,8 @@ HerderImpl::getJsonTransitiveQuorumIntersectionInfo(bool fullKeys) const
         static_cast<Json::UInt64>(mLastQuorumMapIntersectionState->mNumNodes);
     ret["last_check_ledger"] = static_cast<Json::UInt64>(
         mLastQuorumMapIntersectionState->mLastCheckLedger);
+    ret["last_check_duration_ms"] = static_cast<Json::UInt64>(
+        mLastQuorumMapIntersectionState->mLastCheckDuration.count());
     if (mLastQuorumMapIntersectionState->enjoysQuorunIntersection())
     {
         Json::Value critical;
@@ -1990,10 +2120,12 @@ HerderImpl::checkAndMaybeReanalyzeQuorumMap()
             try
             {
                 ZoneScoped;
+                auto start = std::chrono::steady_clock::now();
                 bool ok = false;
                 std::pair<std::vector<PublicKey>, std::vector<PublicKey>> split;
                 auto qic = QuorumIntersectionChecker::create(
-                    qmap, cfg, hState->mInterruptFlag, seed);
+                    qmap, cfg, hState->mInterruptFlag, seed, /*quiet=*/false,
+                    hState->mCache);
                 ok = qic->networkEnjoysQuorumIntersection();
                 split = qic->getPotentialSplit();
                 std::set<std::set<PublicKey>> critical;
@@ -2008,15 +2140,19 @@ HerderImpl::checkAndMaybeReanalyzeQuorumMap()
                                   std::optional<Config> const& config) -> bool {
                         auto checker = QuorumIntersectionChecker::create(
                             qSetMap, config, hState->mInterruptFlag, seed,
-                            /*quiet=*/true);
+                            /*quiet=*/true, hState->mCache);
                         return checker->networkEnjoysQuorumIntersection();
                     };
                     critical = QuorumIntersectionChecker::
                         getIntersectionCriticalGroups(
                             toQuorumIntersectionMap(qmap), cfg, cb);
                 }
+                auto duration =
+                    std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - start);
                 app.postOnMainThread(
-                    [ok, curr, ledger, nNodes, split, critical, hState, &app] {
+                    [ok, curr, ledger, nNodes, split, critical, duration,
+                     hState, &app] {
                         hState->reset(app);
 
                         hState->mNumNodes = nNodes;
@@ -2024,6 +2160,9 @@ HerderImpl::checkAndMaybeReanalyzeQuorumMap()
                         hState->mLastCheckQuorumMapHash = curr;
                         hState->mPotentialSplit = split;
                         hState->mIntersectionCriticalNodes = critical;
+                        hState->mLastCheckDuration = duration;
+                        hState->mMetrics.NewTimer({"scp", "qic", "check"})
+                            .Update(duration);
                         if (ok)
                         {
                             hState->mLastGoodLedger = ledger;
@@ -2048,7 +2187,8 @@ HerderImpl::checkAndMaybeReanalyzeQuorumMap()
                                      "QuorumIntersectionChecker rust error");
             }
         };
-        mApp.postOnBackgroundThread(worker, "QuorumIntersectionChecker");
+        mApp.postOnBackgroundThread(worker, "QuorumIntersectionChecker",
+                                    BackgroundWorkClass::SCP);
     }
 }
 
@@ -2430,6 +2570,16 @@ HerderImpl::updateTransactionQueue(TxSetXDRFrameConstPtr externalizedTxSet,
     auto txsPerPhase =
         externalizedTxSet->createTransactionFrames(mApp.getNetworkID());
 
+#ifdef BUILD_TESTS
+    if (auto loadGenerator = mApp.getLoadGeneratorIfCreated())
+    {
+        for (auto const& txs : txsPerPhase)
+        {
+            loadGenerator->txsIncluded(txs);
+        }
+    }
+#endif
+
     auto lhhe = mLedgerManager.getLastClosedLedgerHeader();
 
     auto updateQueue = [&](auto& queue, auto const& applied, bool isSoroban) {
@@ -13,6 +13,7 @@
 #include "util/Timer.h"
 #include "util/UnorderedMap.h"
 #include "util/XDROperators.h"
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <vector>
@@ -97,6 +98,12 @@ class HerderImpl : public Herder
                            bool isLatestSlot);
     void emitEnvelope(SCPEnvelope const& envelope);
 
+    // Starts loading the entries `txSet` touches from the BucketList in the
+    // background when PREFETCH_CANDIDATE_TX_SET is set, to warm the caches
+    // before the tx set is externalized. The entries themselves are dropped.
+    // Prefetching for a different tx set, or externalizing one, stops it.
+    void prefetchCandidateTxSet(ApplicableTxSetFrameConstPtr txSet);
+
 #ifdef BUILD_TESTS
     TransactionQueue::AddResult
     recvTransaction(TransactionFrameBasePtr tx, bool submittedFromSelf,
@@ -108,6 +115,9 @@ class HerderImpl : public Herder
 #endif
 
     EnvelopeStatus recvSCPEnvelope(SCPEnvelope const& envelope) override;
+    EnvelopeStatus
+    recvVerifiedSCPEnvelope(SCPEnvelope const& envelope) override;
+    bool isSCPSlotAboveMinimum(uint64_t slotIndex) const override;
 #ifdef BUILD_TESTS
     EnvelopeStatus recvSCPEnvelope(SCPEnvelope const& envelope,
                                    const SCPQuorumSet& qset,
@@ -357,6 +367,21 @@ class HerderImpl : public Herder
     // Herder) On startup, this variable is set to LCL
     ConsensusData mTrackingSCP;
 
+    // Lowest slot recvSCPEnvelope accepts envelopes for, and the checkpoint
+    // slot it accepts regardless, copied on every mTrackingSCP update for
+    // isSCPSlotAboveMinimum
+    std::atomic<uint32_t> mMinSCPSlotToAccept{0};
+    std::atomic<uint32_t> mCheckpointSCPSlot{0};
+
+    // Tx set the last candidate prefetch was started for, and a counter the
+    // background prefetch checks to stop early once it is superseded
+    Hash mCandidatePrefetchTxSetHash;
+    std::shared_ptr<std::atomic<uint64_t>> mCandidatePrefetchGeneration{
+        std::make_shared<std::atomic<uint64_t>>(0)};
+
+    EnvelopeStatus recvSCPEnvelope(SCPEnvelope const& envelope,
+                                   bool signatureVerified);
+
     uint32_t mMaxTxSize{0};
 };
 }
@@ -19,6 +19,11 @@ class session;
 
 namespace stellar
 {
+namespace DatabaseUtils
+{
+struct DeletedEntries;
+}
+
 class Application;
 class Database;
 class XDROutputFileStream;
@@ -36,6 +41,10 @@ class HerderPersistence
                                 std::vector<SCPEnvelope> const& envs,
                                 QuorumTracker::QuorumMap const& qmap) = 0;
 
+    // Blocks until everything passed to saveSCPHistory so far is in the
+    // database. Rethrows the first error hit writing it in the background.
+    virtual void flush() = 0;
+
     static size_t copySCPHistoryToStream(soci::session& sess,
                                          uint32_t ledgerSeq,
                                          uint32_t ledgerCount,
@@ -47,7 +56,7 @@ class HerderPersistence
                                         Hash const& qSetHash);
 
     static void dropAll(Database& db);
-    static void deleteOldEntries(soci::session& sess, uint32_t ledgerSeq,
-                                 uint32_t count);
+    static DatabaseUtils::DeletedEntries
+    deleteOldEntries(soci::session& sess, uint32_t ledgerSeq, uint32_t count);
 };
 }
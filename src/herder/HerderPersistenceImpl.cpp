@@ -7,11 +7,16 @@
 #include "database/Database.h"
 #include "database/DatabaseUtils.h"
 #include "herder/Herder.h"
+#include "history/HistoryManager.h"
 #include "main/Application.h"
+#include "main/Config.h"
 #include "scp/Slot.h"
 #include "util/Decoder.h"
 #include "util/XDRStream.h"
 #include <Tracy.hpp>
+#include <medida/histogram.h>
+#include <medida/metrics_registry.h>
+#include <medida/timer.h>
 
 #include <optional>
 #include <soci.h>
@@ -26,7 +31,14 @@ HerderPersistence::create(Application& app)
     return std::make_unique<HerderPersistenceImpl>(app);
 }
 
-HerderPersistenceImpl::HerderPersistenceImpl(Application& app) : mApp(app)
+HerderPersistenceImpl::HerderPersistenceImpl(Application& app)
+    : mApp(app)
+    , mBackgroundWrites(app.getConfig().BACKGROUND_SCP_HISTORY_WRITES &&
+                        app.getDatabase().canUsePool())
+    , mBackgroundWriteTime(
+          app.getMetrics().NewTimer({"scp", "history", "write"}))
+    , mBackgroundBatchSize(
+          app.getMetrics().NewHistogram({"scp", "history", "batch"}))
 {
 }
 
@@ -46,11 +58,125 @@ HerderPersistenceImpl::saveSCPHistory(uint32_t seq,
         return;
     }
 
-    auto usedQSets = UnorderedMap<Hash, SCPQuorumSetPtr>{};
-    auto& db = mApp.getDatabase();
-    auto& sess = db.getSession();
+    // Quorum sets are looked up here, as the herder belongs to the main thread
+    SCPHistoryWrite w;
+    w.mSeq = seq;
+    w.mEnvelopes = envs;
+    for (auto const& e : envs)
+    {
+        auto const& qHash =
+            Slot::getCompanionQuorumSetHashFromStatement(e.statement);
+        w.mQuorumSets.insert(
+            std::make_pair(qHash, mApp.getHerder().getQSet(qHash)));
+    }
+    for (auto const& p : qmap)
+    {
+        if (!p.second.mQuorumSet)
+        {
+            // skip node if we don't have its quorum set
+            continue;
+        }
+        auto qSetH = xdrSha256(*(p.second.mQuorumSet));
+        w.mQuorumSets.insert(std::make_pair(qSetH, p.second.mQuorumSet));
+        w.mQuorumInfo.emplace_back(p.first, qSetH);
+    }
+
+    if (!mBackgroundWrites)
+    {
+        std::vector<SCPHistoryWrite> writes;
+        writes.emplace_back(std::move(w));
+        writeSCPHistory(mApp.getDatabase().getSession(), writes);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mError)
+        {
+            std::rethrow_exception(mError);
+        }
+        mQueued.emplace_back(std::move(w));
+        if (!mWriting)
+        {
+            mWriting = true;
+            mApp.postOnBackgroundThread([this]() { writeQueued(); },
+                                        "HerderPersistence: writeQueued",
+                                        BackgroundWorkClass::SCP);
+        }
+    }
+
+    if (HistoryManager::isLastLedgerInCheckpoint(seq, mApp.getConfig()))
+    {
+        flush();
+    }
+}
+
+void
+HerderPersistenceImpl::flush()
+{
+    ZoneScoped;
+    std::unique_lock<std::mutex> lock(mMutex);
+    // A background task is always pending while anything is queued
+    mCV.wait(lock, [this] { return mError || !mWriting; });
+    if (mError)
+    {
+        std::rethrow_exception(mError);
+    }
+}
 
+void
+HerderPersistenceImpl::writeQueued()
+{
+    ZoneScoped;
+    SessionWrapper sess("scpHistory", mApp.getDatabase().getPool());
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (!mQueued.empty())
+    {
+        std::vector<SCPHistoryWrite> batch;
+        batch.swap(mQueued);
+        lock.unlock();
+        try
+        {
+            auto timer = mBackgroundWriteTime.TimeScope();
+            writeSCPHistory(sess, batch);
+        }
+        catch (...)
+        {
+            lock.lock();
+            mError = std::current_exception();
+            break;
+        }
+        mBackgroundBatchSize.Update(batch.size());
+        lock.lock();
+    }
+    lock.unlock();
+
+    mApp.getDatabase().clearPreparedStatementCache(sess, false);
+    lock.lock();
+    mWriting = false;
+    mCV.notify_all();
+}
+
+void
+HerderPersistenceImpl::writeSCPHistory(
+    SessionWrapper& sess, std::vector<SCPHistoryWrite> const& writes)
+{
+    ZoneScoped;
     soci::transaction txscope(sess.session());
+    for (auto const& w : writes)
+    {
+        writeSCPHistoryEntry(sess, w);
+    }
+    txscope.commit();
+}
+
+void
+HerderPersistenceImpl::writeSCPHistoryEntry(SessionWrapper& sess,
+                                            SCPHistoryWrite const& w)
+{
+    auto const seq = w.mSeq;
+    auto const& envs = w.mEnvelopes;
+    auto& db = mApp.getDatabase();
 
     {
         auto prepClean = db.getPreparedStatement(
@@ -71,11 +197,6 @@ HerderPersistenceImpl::saveSCPHistory(uint32_t seq,
     std::vector<std::string> envelopes;
     for (auto const& e : envs)
     {
-        auto const& qHash =
-            Slot::getCompanionQuorumSetHashFromStatement(e.statement);
-        usedQSets.insert(
-            std::make_pair(qHash, mApp.getHerder().getQSet(qHash)));
-
         std::string nodeIDStrKey = KeyUtils::toStrKey(e.statement.nodeID);
 
         auto envelopeBytes(xdr::xdr_to_opaque(e));
@@ -112,17 +233,8 @@ HerderPersistenceImpl::saveSCPHistory(uint32_t seq,
     }
 
     // save quorum information
-    for (auto const& p : qmap)
+    for (auto const& [nodeID, qSetH] : w.mQuorumInfo)
     {
-        auto const& nodeID = p.first;
-        if (!p.second.mQuorumSet)
-        {
-            // skip node if we don't have its quorum set
-            continue;
-        }
-        auto qSetH = xdrSha256(*(p.second.mQuorumSet));
-        usedQSets.insert(std::make_pair(qSetH, p.second.mQuorumSet));
-
         std::string nodeIDStrKey = KeyUtils::toStrKey(nodeID);
         std::string qSetHHex(binToHex(qSetH));
 
@@ -156,7 +268,7 @@ HerderPersistenceImpl::saveSCPHistory(uint32_t seq,
         }
     }
     // save quorum sets
-    for (auto const& p : usedQSets)
+    for (auto const& p : w.mQuorumSets)
     {
         std::string qSetH = binToHex(p.first);
 
@@ -225,8 +337,6 @@ HerderPersistenceImpl::saveSCPHistory(uint32_t seq,
             }
         }
     }
-
-    txscope.commit();
 }
 
 size_t
@@ -409,14 +519,15 @@ HerderPersistence::dropAll(Database& db)
                           "PRIMARY KEY (nodeid))";
 }
 
-void
+DatabaseUtils::DeletedEntries
 HerderPersistence::deleteOldEntries(soci::session& sess, uint32_t ledgerSeq,
                                     uint32_t count)
 {
     ZoneScoped;
-    DatabaseUtils::deleteOldEntriesHelper(sess, ledgerSeq, count, "scphistory",
-                                          "ledgerseq");
-    DatabaseUtils::deleteOldEntriesHelper(sess, ledgerSeq, count, "scpquorums",
-                                          "lastledgerseq");
+    auto res = DatabaseUtils::deleteOldEntriesHelper(
+        sess, ledgerSeq, count, "scphistory", "ledgerseq");
+    res.add(DatabaseUtils::deleteOldEntriesHelper(
+        sess, ledgerSeq, count, "scpquorums", "lastledgerseq"));
+    return res;
 }
 }
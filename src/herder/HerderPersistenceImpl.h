@@ -5,11 +5,30 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "herder/HerderPersistence.h"
+#include "util/HashOfHash.h"
+#include "util/UnorderedMap.h"
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+
+namespace medida
+{
+class Histogram;
+class Timer;
+}
 
 namespace stellar
 {
 class Application;
+class SessionWrapper;
 
+// With BACKGROUND_SCP_HISTORY_WRITES, saveSCPHistory only queues its input.
+// A single background task at a time writes everything queued since the last
+// batch in one transaction, in the order it was queued, so the database
+// always holds a prefix of the queued writes. The queue is drained before
+// saveSCPHistory returns for the last ledger of a checkpoint, so a checkpoint
+// is never queued for publishing ahead of its SCP messages.
 class HerderPersistenceImpl : public HerderPersistence
 {
 
@@ -20,7 +39,34 @@ class HerderPersistenceImpl : public HerderPersistence
     void saveSCPHistory(uint32_t seq, std::vector<SCPEnvelope> const& envs,
                         QuorumTracker::QuorumMap const& qmap) override;
 
+    void flush() override;
+
   private:
+    // Everything one saveSCPHistory call writes, with the quorum sets already
+    // resolved on the main thread
+    struct SCPHistoryWrite
+    {
+        uint32_t mSeq;
+        std::vector<SCPEnvelope> mEnvelopes;
+        std::vector<std::pair<NodeID, Hash>> mQuorumInfo;
+        UnorderedMap<Hash, SCPQuorumSetPtr> mQuorumSets;
+    };
+
     Application& mApp;
+    bool const mBackgroundWrites;
+
+    medida::Timer& mBackgroundWriteTime;
+    medida::Histogram& mBackgroundBatchSize;
+
+    std::mutex mMutex;
+    std::condition_variable mCV;
+    std::vector<SCPHistoryWrite> mQueued;
+    bool mWriting{false};
+    std::exception_ptr mError;
+
+    void writeSCPHistory(SessionWrapper& sess,
+                         std::vector<SCPHistoryWrite> const& writes);
+    void writeSCPHistoryEntry(SessionWrapper& sess, SCPHistoryWrite const& w);
+    void writeQueued();
 };
 }
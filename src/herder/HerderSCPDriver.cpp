@@ -759,8 +759,15 @@ HerderSCPDriver::combineCandidates(uint64_t slotIndex,
             auto const& sv = *it;
             auto cTxSet = mPendingEnvelopes.getTxSet(sv.txSetHash);
             releaseAssert(cTxSet);
-            // Only valid applicable tx sets should be combined.
-            auto cApplicableTxSet = cTxSet->prepareForApply(mApp, lcl.header);
+            // Only valid applicable tx sets should be combined, so they
+            // have normally been prepared already during validation.
+            auto cApplicableTxSet =
+                getValidatedTxSet(sv.txSetHash, lcl,
+                                  sv.closeTime - lcl.header.scpValue.closeTime);
+            if (!cApplicableTxSet)
+            {
+                cApplicableTxSet = cTxSet->prepareForApply(mApp, lcl.header);
+            }
             releaseAssert(cApplicableTxSet);
             if (cTxSet->previousLedgerHash() == lcl.hash)
             {
@@ -784,6 +791,9 @@ HerderSCPDriver::combineCandidates(uint64_t slotIndex,
                 "No highest candidate transaction set found");
         }
         comp = *highest;
+        // This is the tx set every node combining the same candidates picks,
+        // so it is most likely the one that gets externalized
+        mHerder.prefetchCandidateTxSet(highestApplicableTxSet);
     }
     comp.upgrades.clear();
     for (auto const& upgrade : upgrades)
@@ -1279,31 +1289,48 @@ HerderSCPDriver::wrapStellarValue(StellarValue const& sv)
 }
 
 void
-HerderSCPDriver::cacheValidTxSet(ApplicableTxSetFrame const& txSet,
+HerderSCPDriver::cacheValidTxSet(ApplicableTxSetFrameConstPtr txSet,
                                  LedgerHeaderHistoryEntry const& lcl,
                                  uint64_t closeTimeOffset) const
 {
-    auto key = TxSetValidityKey{lcl.hash, txSet.getContentsHash(),
+    releaseAssert(txSet);
+    auto key = TxSetValidityKey{lcl.hash, txSet->getContentsHash(),
                                 closeTimeOffset, closeTimeOffset};
-    bool* pRes = mTxSetValidCache.maybeGet(key);
+    auto* pRes = mTxSetValidCache.maybeGet(key);
     if (pRes == nullptr)
     {
 #ifdef SCP_DEBUGGING
-        releaseAssert(txSet.checkValid(mApp, closeTimeOffset, closeTimeOffset));
+        releaseAssert(
+            txSet->checkValid(mApp, closeTimeOffset, closeTimeOffset));
 #endif
-        mTxSetValidCache.put(key, true);
+        mTxSetValidCache.put(key, TxSetValidity{true, std::move(txSet)});
     }
     else
     {
-        if (!*pRes)
+        if (!pRes->mValid)
         {
             throw std::runtime_error(fmt::format(
                 FMT_STRING("Inconsistent txSet validity for tx set {}"),
-                hexAbbrev(txSet.getContentsHash())));
+                hexAbbrev(txSet->getContentsHash())));
         }
     }
 }
 
+ApplicableTxSetFrameConstPtr
+HerderSCPDriver::getValidatedTxSet(Hash const& txSetHash,
+                                   LedgerHeaderHistoryEntry const& lcl,
+                                   uint64_t closeTimeOffset) const
+{
+    auto key =
+        TxSetValidityKey{lcl.hash, txSetHash, closeTimeOffset, closeTimeOffset};
+    auto* pRes = mTxSetValidCache.maybeGet(key, /* countAccess */ false);
+    if (pRes == nullptr || !pRes->mValid)
+    {
+        return nullptr;
+    }
+    return pRes->mApplicableTxSet;
+}
+
 bool
 HerderSCPDriver::checkAndCacheTxSetValid(TxSetXDRFrame const& txSet,
                                          LedgerHeaderHistoryEntry const& lcl,
@@ -1312,7 +1339,7 @@ HerderSCPDriver::checkAndCacheTxSetValid(TxSetXDRFrame const& txSet,
     auto key = TxSetValidityKey{lcl.hash, txSet.getContentsHash(),
                                 closeTimeOffset, closeTimeOffset};
 
-    bool* pRes = mTxSetValidCache.maybeGet(key);
+    auto* pRes = mTxSetValidCache.maybeGet(key);
     if (pRes == nullptr)
     {
         // The invariant here is that we only validate tx sets nominated
@@ -1340,12 +1367,13 @@ HerderSCPDriver::checkAndCacheTxSetValid(TxSetXDRFrame const& txSet,
                                               closeTimeOffset);
         }
 
-        mTxSetValidCache.put(key, res);
+        mTxSetValidCache.put(
+            key, TxSetValidity{res, res ? applicableTxSet : nullptr});
         return res;
     }
     else
     {
-        return *pRes;
+        return pRes->mValid;
     }
 }
 size_t
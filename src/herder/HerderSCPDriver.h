@@ -153,11 +153,28 @@ class HerderSCPDriver : public SCPDriver
       public:
         size_t operator()(TxSetValidityKey const& key) const;
     };
-    void cacheValidTxSet(ApplicableTxSetFrame const& txSet,
+    // Validity of a tx set for a TxSetValidityKey. Valid tx sets keep the
+    // frame they were validated with, so that combining candidates and
+    // applying the externalized value don't have to prepare it again.
+    struct TxSetValidity
+    {
+        bool mValid;
+        ApplicableTxSetFrameConstPtr mApplicableTxSet;
+    };
+
+    void cacheValidTxSet(ApplicableTxSetFrameConstPtr txSet,
                          LedgerHeaderHistoryEntry const& lcl,
                          uint64_t closeTimeOffset) const;
+
+    // Returns the frame `txSetHash` was found valid with on top of `lcl` for
+    // the given close time offset, or nullptr if it hasn't been validated
+    // (or is invalid). Lookups don't count as cache hits or misses.
+    ApplicableTxSetFrameConstPtr
+    getValidatedTxSet(Hash const& txSetHash,
+                      LedgerHeaderHistoryEntry const& lcl,
+                      uint64_t closeTimeOffset) const;
 #ifdef BUILD_TESTS
-    RandomEvictionCache<TxSetValidityKey, bool, TxSetValidityKeyHash>&
+    RandomEvictionCache<TxSetValidityKey, TxSetValidity, TxSetValidityKeyHash>&
     getTxSetValidityCache()
     {
         return mTxSetValidCache;
@@ -233,7 +250,8 @@ class HerderSCPDriver : public SCPDriver
     std::map<uint64_t, std::map<int, std::unique_ptr<VirtualTimer>>> mSCPTimers;
 
     // validity of txSet
-    mutable RandomEvictionCache<TxSetValidityKey, bool, TxSetValidityKeyHash>
+    mutable RandomEvictionCache<TxSetValidityKey, TxSetValidity,
+                                TxSetValidityKeyHash>
         mTxSetValidCache;
 
     SCPDriver::ValidationLevel
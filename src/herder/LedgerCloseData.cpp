@@ -17,17 +17,17 @@ namespace stellar
 LedgerCloseData::LedgerCloseData(uint32_t ledgerSeq,
                                  TxSetXDRFrameConstPtr txSet,
                                  StellarValue const& v,
-                                 std::optional<Hash> const& expectedLedgerHash)
+                                 std::optional<Hash> const& expectedLedgerHash,
+                                 ApplicableTxSetFrameConstPtr applicableTxSet)
     : mLedgerSeq(ledgerSeq)
     , mTxSet(txSet)
+    , mApplicableTxSet(std::move(applicableTxSet))
     , mValue(v)
     , mExpectedLedgerHash(expectedLedgerHash)
 {
-
-
-
-
     releaseAssert(txSet->getContentsHash() == mValue.txSetHash);
+    releaseAssert(!mApplicableTxSet ||
+                  mApplicableTxSet->getContentsHash() == mValue.txSetHash);
 }
 
 #ifdef BUILD_TESTS
@@ -24,9 +24,13 @@ namespace stellar
 class LedgerCloseData
 {
   public:
+    // `applicableTxSet` is optionally the already prepared frame of `txSet`
+    // for the ledger preceding `ledgerSeq`, which then doesn't need to be
+    // prepared again for apply.
     LedgerCloseData(
         uint32_t ledgerSeq, TxSetXDRFrameConstPtr txSet, StellarValue const& v,
-        std::optional<Hash> const& expectedLedgerHash = std::nullopt);
+        std::optional<Hash> const& expectedLedgerHash = std::nullopt,
+        ApplicableTxSetFrameConstPtr applicableTxSet = nullptr);
 
 #ifdef BUILD_TESTS
     LedgerCloseData(uint32_t ledgerSeq, TxSetXDRFrameConstPtr txSet,
@@ -45,6 +49,11 @@ class LedgerCloseData
     {
         return mTxSet;
     }
+    ApplicableTxSetFrameConstPtr
+    getApplicableTxSet() const
+    {
+        return mApplicableTxSet;
+    }
     StellarValue const&
     getValue() const
     {
@@ -94,6 +103,7 @@ class LedgerCloseData
   private:
     uint32_t mLedgerSeq;
     TxSetXDRFrameConstPtr mTxSet;
+    ApplicableTxSetFrameConstPtr mApplicableTxSet;
     StellarValue mValue;
     std::optional<Hash> mExpectedLedgerHash = std::nullopt;
 #ifdef BUILD_TESTS
@@ -7,13 +7,21 @@
 #include "herder/TxSetFrame.h"
 #include "transactions/TransactionFrameBase.h"
 #include "util/BitSet.h"
+#include "util/Logging.h"
 
+#include <atomic>
+#include <chrono>
+#include <thread>
 #include <unordered_set>
 
 namespace stellar
 {
 namespace
 {
+// Conflict graph construction is only split across threads when every thread
+// gets at least this many transactions.
+size_t const MIN_TXS_PER_CONFLICT_GRAPH_THREAD = 16;
+
 // Configuration for parallel partitioning of transactions.
 struct ParallelPartitionConfig
 {
@@ -381,8 +389,11 @@ struct ParallelPhaseBuildResult
     TxStageFrameList mStages;
     std::vector<bool> mHadTxNotFittingLane;
     int64_t mTotalInclusionFee = 0;
+    bool mRanOutOfTime = false;
 };
 
+using BuildDeadline = std::optional<std::chrono::steady_clock::time_point>;
+
 ParallelPhaseBuildResult
 buildSurgePricedParallelSorobanPhaseWithStageCount(
     SurgePricingPriorityQueue queue,
@@ -390,17 +401,30 @@ buildSurgePricedParallelSorobanPhaseWithStageCount(
         builderTxForTx,
     TxFrameList const& txFrames, uint32_t stageCount,
     SorobanNetworkConfig const& sorobanCfg,
-    std::shared_ptr<SurgePricingLaneConfig> laneConfig, uint32_t ledgerVersion)
+    std::shared_ptr<SurgePricingLaneConfig> laneConfig, uint32_t ledgerVersion,
+    BuildDeadline deadline)
 {
     ZoneScoped;
     ParallelPartitionConfig partitionCfg(stageCount, sorobanCfg);
 
     std::vector<Stage> stages(partitionCfg.mStageCount, partitionCfg);
+    ParallelPhaseBuildResult result;
 
     // Visit the transactions in the surge pricing queue and try to add them to
     // at least one of the stages.
-    auto visitor = [&stages,
-                    &builderTxForTx](TransactionFrameBaseConstPtr const& tx) {
+    auto visitor = [&stages, &builderTxForTx, &result,
+                    deadline](TransactionFrameBaseConstPtr const& tx) {
+        // Once the time budget is spent, the remaining transactions are
+        // treated as not fitting, which also keeps the phase surge priced.
+        if (!result.mRanOutOfTime && deadline &&
+            std::chrono::steady_clock::now() > *deadline)
+        {
+            result.mRanOutOfTime = true;
+        }
+        if (result.mRanOutOfTime)
+        {
+            return SurgePricingPriorityQueue::VisitTxResult::REJECTED;
+        }
         bool added = false;
         auto builderTxIt = builderTxForTx.find(tx);
         releaseAssert(builderTxIt != builderTxForTx.end());
@@ -424,7 +448,6 @@ buildSurgePricedParallelSorobanPhaseWithStageCount(
         return SurgePricingPriorityQueue::VisitTxResult::REJECTED;
     };
 
-    ParallelPhaseBuildResult result;
     std::vector<Resource> laneLeftUntilLimitUnused;
     queue.popTopTxs(/* allowGaps */ true, visitor, laneLeftUntilLimitUnused,
                     result.mHadTxNotFittingLane, ledgerVersion);
@@ -480,6 +503,182 @@ buildSurgePricedParallelSorobanPhaseWithStageCount(
     return result;
 }
 
+void
+markConflicts(TxFrameList const& txFrames,
+              std::vector<std::unique_ptr<BuilderTx>>& builderTxs)
+{
+    ZoneScoped;
+    UnorderedMap<LedgerKey, std::vector<size_t>> txsWithRoKey;
+    UnorderedMap<LedgerKey, std::vector<size_t>> txsWithRwKey;
+    for (size_t i = 0; i < txFrames.size(); ++i)
+    {
+        auto const& txFrame = txFrames[i];
+        auto const& footprint = txFrame->sorobanResources().footprint;
+        for (auto const& key : footprint.readOnly)
+        {
+            txsWithRoKey[key].push_back(i);
+        }
+        for (auto const& key : footprint.readWrite)
+        {
+            txsWithRwKey[key].push_back(i);
+        }
+    }
+
+    for (auto const& [key, rwTxIds] : txsWithRwKey)
+    {
+        // RW-RW conflicts
+        for (size_t i = 0; i < rwTxIds.size(); ++i)
+        {
+            for (size_t j = i + 1; j < rwTxIds.size(); ++j)
+            {
+                builderTxs[rwTxIds[i]]->mConflictTxs.set(rwTxIds[j]);
+                builderTxs[rwTxIds[j]]->mConflictTxs.set(rwTxIds[i]);
+            }
+        }
+        // RO-RW conflicts
+        auto roIt = txsWithRoKey.find(key);
+        if (roIt != txsWithRoKey.end())
+        {
+            auto const& roTxIds = roIt->second;
+            for (size_t i = 0; i < roTxIds.size(); ++i)
+            {
+                for (size_t j = 0; j < rwTxIds.size(); ++j)
+                {
+                    builderTxs[roTxIds[i]]->mConflictTxs.set(rwTxIds[j]);
+                    builderTxs[rwTxIds[j]]->mConflictTxs.set(roTxIds[i]);
+                }
+            }
+        }
+    }
+}
+
+// Runs `fn(threadId)` for every thread id in [0, threadCount), using the
+// calling thread as thread 0.
+void
+runOnThreads(size_t threadCount, std::function<void(size_t)> const& fn)
+{
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < threadCount; ++t)
+    {
+        threads.emplace_back(fn, t);
+    }
+    fn(0);
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+// Same as `markConflicts`, but split across `threadCount` threads. The
+// footprint keys are sharded by their hash, so that every thread builds the
+// key to transactions map for its own shard, and then every thread marks the
+// conflicts of its own subset of transactions, so no two threads ever write
+// to the same map or `BitSet`.
+void
+markConflictsInParallel(TxFrameList const& txFrames,
+                        std::vector<std::unique_ptr<BuilderTx>>& builderTxs,
+                        size_t threadCount)
+{
+    ZoneScoped;
+    struct KeyTxs
+    {
+        std::vector<size_t> mRoTxIds;
+        std::vector<size_t> mRwTxIds;
+    };
+
+    // For every transaction, the shard of every footprint key (read-only
+    // keys first), and then the transactions that have that key.
+    std::vector<std::vector<size_t>> keyShards(txFrames.size());
+    std::vector<std::vector<KeyTxs const*>> keyTxs(txFrames.size());
+    runOnThreads(threadCount, [&](size_t t) {
+        ZoneScopedN("hash footprint keys");
+        std::hash<LedgerKey> hasher;
+        for (size_t i = t; i < txFrames.size(); i += threadCount)
+        {
+            auto const& footprint = txFrames[i]->sorobanResources().footprint;
+            auto& shards = keyShards[i];
+            shards.reserve(footprint.readOnly.size() +
+                           footprint.readWrite.size());
+            for (auto const& key : footprint.readOnly)
+            {
+                shards.push_back(hasher(key) % threadCount);
+            }
+            for (auto const& key : footprint.readWrite)
+            {
+                shards.push_back(hasher(key) % threadCount);
+            }
+            keyTxs[i].resize(shards.size());
+        }
+    });
+
+    // Elements of `UnorderedMap` are never moved, so `keyTxs` can point at
+    // them while the other keys of the shard are being added.
+    std::vector<UnorderedMap<LedgerKey, KeyTxs>> txsForKey(threadCount);
+    runOnThreads(threadCount, [&](size_t t) {
+        ZoneScopedN("build footprint key shard");
+        auto& shardTxs = txsForKey[t];
+        for (size_t i = 0; i < txFrames.size(); ++i)
+        {
+            auto const& footprint = txFrames[i]->sorobanResources().footprint;
+            auto const& shards = keyShards[i];
+            size_t k = 0;
+            for (auto const& key : footprint.readOnly)
+            {
+                if (shards[k] == t)
+                {
+                    auto& entry = shardTxs[key];
+                    entry.mRoTxIds.push_back(i);
+                    keyTxs[i][k] = &entry;
+                }
+                ++k;
+            }
+            for (auto const& key : footprint.readWrite)
+            {
+                if (shards[k] == t)
+                {
+                    auto& entry = shardTxs[key];
+                    entry.mRwTxIds.push_back(i);
+                    keyTxs[i][k] = &entry;
+                }
+                ++k;
+            }
+        }
+    });
+
+    runOnThreads(threadCount, [&](size_t t) {
+        ZoneScopedN("mark conflicts");
+        for (size_t i = t; i < txFrames.size(); i += threadCount)
+        {
+            auto const& footprint = txFrames[i]->sorobanResources().footprint;
+            auto& conflicts = builderTxs[i]->mConflictTxs;
+            size_t k = 0;
+            // RO-RW conflicts
+            for (; k < footprint.readOnly.size(); ++k)
+            {
+                for (auto rwTxId : keyTxs[i][k]->mRwTxIds)
+                {
+                    conflicts.set(rwTxId);
+                }
+            }
+            // RW-RW and RW-RO conflicts
+            for (; k < keyTxs[i].size(); ++k)
+            {
+                for (auto rwTxId : keyTxs[i][k]->mRwTxIds)
+                {
+                    if (rwTxId != i)
+                    {
+                        conflicts.set(rwTxId);
+                    }
+                }
+                for (auto roTxId : keyTxs[i][k]->mRoTxIds)
+                {
+                    conflicts.set(roTxId);
+                }
+            }
+        }
+    });
+}
+
 } // namespace
 
 TxStageFrameList
@@ -497,6 +696,14 @@ buildSurgePricedParallelSorobanPhase(
     // inclusion fee (a proxy for the transaction set utilization).
     double const MAX_INCLUSION_FEE_TOLERANCE_FOR_STAGE_COUNT = 0.999;
 
+    BuildDeadline deadline;
+    if (cfg.SOROBAN_PHASE_BUILD_TIME_BUDGET_MS > 0)
+    {
+        deadline = std::chrono::steady_clock::now() +
+                   std::chrono::milliseconds(
+                       cfg.SOROBAN_PHASE_BUILD_TIME_BUDGET_MS);
+    }
+
     // Simplify the transactions to the minimum necessary amount of data.
     std::unordered_map<TransactionFrameBaseConstPtr, BuilderTx const*>
         builderTxForTx;
@@ -526,47 +733,16 @@ buildSurgePricedParallelSorobanPhase(
     // This also has the further optimization potential: we could populate the
     // key maps and even the conflicting transactions eagerly in tx queue, thus
     // amortizing the costs across the whole ledger duration.
-    UnorderedMap<LedgerKey, std::vector<size_t>> txsWithRoKey;
-    UnorderedMap<LedgerKey, std::vector<size_t>> txsWithRwKey;
-    for (size_t i = 0; i < txFrames.size(); ++i)
+    size_t const conflictGraphThreads =
+        std::min<size_t>(cfg.SOROBAN_PHASE_BUILD_THREADS,
+                         txFrames.size() / MIN_TXS_PER_CONFLICT_GRAPH_THREAD);
+    if (conflictGraphThreads > 1)
     {
-        auto const& txFrame = txFrames[i];
-        auto const& footprint = txFrame->sorobanResources().footprint;
-        for (auto const& key : footprint.readOnly)
-        {
-            txsWithRoKey[key].push_back(i);
-        }
-        for (auto const& key : footprint.readWrite)
-        {
-            txsWithRwKey[key].push_back(i);
-        }
+        markConflictsInParallel(txFrames, builderTxs, conflictGraphThreads);
     }
-
-    for (auto const& [key, rwTxIds] : txsWithRwKey)
+    else
     {
-        // RW-RW conflicts
-        for (size_t i = 0; i < rwTxIds.size(); ++i)
-        {
-            for (size_t j = i + 1; j < rwTxIds.size(); ++j)
-            {
-                builderTxs[rwTxIds[i]]->mConflictTxs.set(rwTxIds[j]);
-                builderTxs[rwTxIds[j]]->mConflictTxs.set(rwTxIds[i]);
-            }
-        }
-        // RO-RW conflicts
-        auto roIt = txsWithRoKey.find(key);
-        if (roIt != txsWithRoKey.end())
-        {
-            auto const& roTxIds = roIt->second;
-            for (size_t i = 0; i < roTxIds.size(); ++i)
-            {
-                for (size_t j = 0; j < rwTxIds.size(); ++j)
-                {
-                    builderTxs[roTxIds[i]]->mConflictTxs.set(rwTxIds[j]);
-                    builderTxs[rwTxIds[j]]->mConflictTxs.set(roTxIds[i]);
-                }
-            }
-        }
+        markConflicts(txFrames, builderTxs);
     }
 
     // Process the transactions in the surge pricing (decreasing fee) order.
@@ -592,11 +768,11 @@ buildSurgePricedParallelSorobanPhase(
         size_t resultIndex = stageCount - cfg.SOROBAN_PHASE_MIN_STAGE_COUNT;
         threads.emplace_back([queue, &builderTxForTx, txFrames, stageCount,
                               sorobanCfg, laneConfig, resultIndex, &results,
-                              ledgerVersion]() {
+                              ledgerVersion, deadline]() {
             results.at(resultIndex) =
                 buildSurgePricedParallelSorobanPhaseWithStageCount(
                     std::move(queue), builderTxForTx, txFrames, stageCount,
-                    sorobanCfg, laneConfig, ledgerVersion);
+                    sorobanCfg, laneConfig, ledgerVersion, deadline);
         });
     }
     for (auto& thread : threads)
@@ -605,10 +781,19 @@ buildSurgePricedParallelSorobanPhase(
     }
 
     int64_t maxTotalInclusionFee = 0;
+    bool ranOutOfTime = false;
     for (auto const& result : results)
     {
         maxTotalInclusionFee =
             std::max(maxTotalInclusionFee, result.mTotalInclusionFee);
+        ranOutOfTime = ranOutOfTime || result.mRanOutOfTime;
+    }
+    if (ranOutOfTime)
+    {
+        CLOG_WARNING(Herder,
+                     "Parallel Soroban tx set nomination ran out of its {} ms "
+                     "time budget, not all transactions were considered",
+                     cfg.SOROBAN_PHASE_BUILD_TIME_BUDGET_MS);
     }
     maxTotalInclusionFee *= MAX_INCLUSION_FEE_TOLERANCE_FOR_STAGE_COUNT;
     std::optional<size_t> bestResultIndex = std::nullopt;
@@ -12,6 +12,7 @@
 #include "scp/Slot.h"
 #include "util/GlobalChecks.h"
 #include "util/Logging.h"
+#include "util/MemoryAccounting.h"
 #include "util/UnorderedSet.h"
 #include <Tracy.hpp>
 #include <xdrpp/marshal.h>
@@ -28,8 +29,11 @@ PendingEnvelopes::PendingEnvelopes(Application& app, HerderImpl& herder)
     : mApp(app)
     , mHerder(herder)
     , mQsetCache(QSET_CACHE_SIZE)
+    // Tx sets sit on the externalize-to-apply path and can be large, so don't
+    // wait out a full timeout on a slow peer
     , mTxSetFetcher(
-          app, [](Peer::pointer peer, Hash hash) { peer->sendGetTxSet(hash); })
+          app, [](Peer::pointer peer, Hash hash) { peer->sendGetTxSet(hash); },
+          true)
     , mQuorumSetFetcher(app, [](Peer::pointer peer,
                                 Hash hash) { peer->sendGetQuorumSet(hash); })
     , mTxSetCache(TXSET_CACHE_SIZE)
@@ -115,6 +119,7 @@ void
 PendingEnvelopes::addSCPQuorumSet(Hash const& hash, SCPQuorumSet const& q)
 {
     ZoneScoped;
+    MEMORY_ACCOUNTING_SCOPE(PENDING_ENVELOPES);
     putQSet(hash, q);
     mQuorumSetFetcher.recv(hash, mFetchQsetTimer);
 }
@@ -123,6 +128,7 @@ bool
 PendingEnvelopes::recvSCPQuorumSet(Hash const& hash, SCPQuorumSet const& q)
 {
     ZoneScoped;
+    MEMORY_ACCOUNTING_SCOPE(PENDING_ENVELOPES);
     CLOG_TRACE(Herder, "Got SCPQSet {}", hexAbbrev(hash));
 
     auto lastSeenSlotIndex = mQuorumSetFetcher.getLastSeenSlotIndex(hash);
@@ -231,6 +237,7 @@ PendingEnvelopes::addTxSet(Hash const& hash, uint64 lastSeenSlotIndex,
                            TxSetXDRFrameConstPtr txset)
 {
     ZoneScoped;
+    MEMORY_ACCOUNTING_SCOPE(PENDING_ENVELOPES);
     CLOG_TRACE(Herder, "Add TxSet {}", hexAbbrev(hash));
 
     putTxSet(hash, lastSeenSlotIndex, txset);
@@ -241,6 +248,7 @@ bool
 PendingEnvelopes::recvTxSet(Hash const& hash, TxSetXDRFrameConstPtr txset)
 {
     ZoneScoped;
+    MEMORY_ACCOUNTING_SCOPE(PENDING_ENVELOPES);
     CLOG_TRACE(Herder, "Got TxSet {}", hexAbbrev(hash));
 
     auto lastSeenSlotIndex = mTxSetFetcher.getLastSeenSlotIndex(hash);
@@ -283,6 +291,7 @@ Herder::EnvelopeStatus
 PendingEnvelopes::recvSCPEnvelope(SCPEnvelope const& envelope)
 {
     ZoneScoped;
+    MEMORY_ACCOUNTING_SCOPE(PENDING_ENVELOPES);
     auto const& nodeID = envelope.statement.nodeID;
     if (!isNodeDefinitelyInQuorum(nodeID))
     {
@@ -789,40 +798,43 @@ PendingEnvelopes::getJsonInfo(size_t limit)
     return ret;
 }
 
-void
-PendingEnvelopes::rebuildQuorumTrackerState()
+SCPQuorumSetPtr
+PendingEnvelopes::lookupQuorumSet(NodeID const& id)
 {
-    // rebuild quorum information using data sources starting with the
-    // freshest source
-    mQuorumTracker.rebuild([&](NodeID const& id) -> SCPQuorumSetPtr {
-        SCPQuorumSetPtr res;
-        if (id == mHerder.getSCP().getLocalNodeID())
+    // use data sources starting with the freshest source
+    SCPQuorumSetPtr res;
+    if (id == mHerder.getSCP().getLocalNodeID())
+    {
+        res = getQSet(mHerder.getSCP().getLocalNode()->getQuorumSetHash());
+    }
+    else
+    {
+        auto m = mHerder.getSCP().getLatestMessage(id);
+        if (m != nullptr)
         {
-            res = getQSet(mHerder.getSCP().getLocalNode()->getQuorumSetHash());
+            auto h = Slot::getCompanionQuorumSetHashFromStatement(m->statement);
+            res = getQSet(h);
         }
-        else
+        if (res == nullptr)
         {
-            auto m = mHerder.getSCP().getLatestMessage(id);
-            if (m != nullptr)
+            // see if we had some information for that node
+            auto& db = mApp.getDatabase();
+            auto h =
+                HerderPersistence::getNodeQuorumSet(db.getRawSession(), id);
+            if (h)
             {
-                auto h =
-                    Slot::getCompanionQuorumSetHashFromStatement(m->statement);
-                res = getQSet(h);
-            }
-            if (res == nullptr)
-            {
-                // see if we had some information for that node
-                auto& db = mApp.getDatabase();
-                auto h =
-                    HerderPersistence::getNodeQuorumSet(db.getRawSession(), id);
-                if (h)
-                {
-                    res = getQSet(*h);
-                }
+                res = getQSet(*h);
             }
         }
-        return res;
-    });
+    }
+    return res;
+}
+
+void
+PendingEnvelopes::rebuildQuorumTrackerState()
+{
+    mQuorumTracker.rebuild(
+        [&](NodeID const& id) { return lookupQuorumSet(id); });
 }
 
 QuorumTracker::QuorumMap const&
@@ -840,10 +852,11 @@ PendingEnvelopes::envelopeProcessed(SCPEnvelope const& env)
     auto h = Slot::getCompanionQuorumSetHashFromStatement(st);
 
     SCPQuorumSetPtr qset = getQSet(h);
-    if (!mQuorumTracker.expand(id, qset))
+    if (!mRebuildQuorum)
     {
-        // could not expand quorum, queue up a rebuild
-        mRebuildQuorum = true;
+        // a pending rebuild picks up the change anyway
+        mQuorumTracker.update(
+            id, qset, [&](NodeID const& n) { return lookupQuorumSet(n); });
     }
 }
 
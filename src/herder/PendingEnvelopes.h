@@ -201,6 +201,7 @@ class PendingEnvelopes
     bool isNodeDefinitelyInQuorum(NodeID const& node);
 
     void rebuildQuorumTrackerState();
+    SCPQuorumSetPtr lookupQuorumSet(NodeID const& id);
     QuorumTracker::QuorumMap const& getCurrentlyTrackedQuorum() const;
 
     // updates internal state when an envelope was successfully processed
@@ -7,9 +7,12 @@
 #include "herder/QuorumTracker.h"
 #include "herder/RustQuorumCheckerAdaptor.h"
 #include "rust/RustBridge.h"
+#include "util/RandomEvictionCache.h"
 #include "util/TmpDir.h"
 #include <atomic>
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <optional>
 
 namespace medida
@@ -23,6 +26,7 @@ namespace stellar
 class Config;
 class Application;
 class TmpDir;
+class QuorumIntersectionCache;
 
 struct QuorumMapIntersectionState
 {
@@ -42,6 +46,13 @@ struct QuorumMapIntersectionState
     medida::MetricsRegistry& mMetrics;
     std::pair<std::vector<PublicKey>, std::vector<PublicKey>> mPotentialSplit{};
     std::set<std::set<PublicKey>> mIntersectionCriticalNodes{};
+    // Wall-clock time the last completed check took, including the
+    // criticality analysis
+    std::chrono::milliseconds mLastCheckDuration{0};
+
+    // for v1: enumeration results carried over from one check to the next,
+    // survives reset()
+    std::shared_ptr<QuorumIntersectionCache> mCache;
 
     bool
     hasAnyResults() const
@@ -67,17 +78,21 @@ class QuorumIntersectionChecker
 
     using PotentialSplit =
         std::pair<std::vector<PublicKey>, std::vector<PublicKey>>;
-    // for v1 qic
+    // for v1 qic. When a cache is passed, the minimal quorum enumeration of
+    // an SCC is skipped if the same SCC (same members with the same quorum
+    // sets) was already enumerated through that cache.
     static std::shared_ptr<QuorumIntersectionChecker>
     create(QuorumTracker::QuorumMap const& qmap,
            std::optional<stellar::Config> const& cfg,
            std::atomic<bool>& interruptFlag,
-           stellar_default_random_engine::result_type seed, bool quiet = false);
+           stellar_default_random_engine::result_type seed, bool quiet = false,
+           std::shared_ptr<QuorumIntersectionCache> cache = nullptr);
 
     static std::shared_ptr<QuorumIntersectionChecker>
     create(QuorumSetMap const& qmap, std::optional<stellar::Config> const& cfg,
            std::atomic<bool>& interruptFlag,
-           stellar_default_random_engine::result_type seed, bool quiet = false);
+           stellar_default_random_engine::result_type seed, bool quiet = false,
+           std::shared_ptr<QuorumIntersectionCache> cache = nullptr);
 
     static std::set<std::set<NodeID>> getIntersectionCriticalGroups(
         QuorumSetMap const& qmap, std::optional<Config> const& cfg,
@@ -98,4 +113,35 @@ class QuorumIntersectionChecker
     {
     };
 };
+
+// Results of the minimal quorum enumeration over the SCC that has quorums in
+// it, keyed by the contents of that SCC: its members and their quorum sets.
+// The enumeration never looks outside of the SCC, so a quorum map change that
+// doesn't touch the SCC (e.g. a node that nobody depends on changing its
+// qset) reuses the previous result instead of scanning the powerset again.
+// The criticality analysis checks one modified quorum map per candidate group,
+// and those checks are cached the same way.
+//
+// Thread-safe, so it can be shared between the main thread and the checker
+// running in the background.
+class QuorumIntersectionCache
+{
+  public:
+    struct Result
+    {
+        bool mEnjoysQuorumIntersection;
+        QuorumIntersectionChecker::PotentialSplit mPotentialSplit;
+    };
+
+    explicit QuorumIntersectionCache(size_t maxSize);
+
+    std::optional<Result> get(Hash const& sccKey);
+    void put(Hash const& sccKey, Result const& result);
+
+    RandomEvictionCache<Hash, Result>::Counters getCounters() const;
+
+  private:
+    mutable std::mutex mMutex;
+    RandomEvictionCache<Hash, Result> mResults;
+};
 }
@@ -4,12 +4,16 @@
 
 #include "QuorumIntersectionCheckerImpl.h"
 #include "QuorumIntersectionChecker.h"
+#include "crypto/SHA.h"
 #include "herder/HerderUtils.h"
-
 #include "main/Application.h"
 #include "util/GlobalChecks.h"
 #include "util/Logging.h"
 #include "util/Math.h"
+#include <Tracy.hpp>
+#include <algorithm>
+#include <future>
+#include <xdrpp/marshal.h>
 
 namespace
 {
@@ -54,6 +58,16 @@ QBitSet::getSuccessors(BitSet const& nodes, QGraph const& inner)
     return out;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Implementation of SearchState
+////////////////////////////////////////////////////////////////////////////////
+
+SearchState::SearchState(stellar_default_random_engine::result_type seed)
+    : mCachedQuorums(MAX_CACHED_QUORUMS_SIZE, /*separatePRNG=*/true)
+    , mRand(seed)
+{
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Implementation of MinQuorumEnumerator
 ////////////////////////////////////////////////////////////////////////////////
@@ -63,7 +77,7 @@ size_t
 MinQuorumEnumerator::pickSplitNode(
     stellar::stellar_default_random_engine& randEngine) const
 {
-    std::vector<size_t>& inDegrees = mQic.mInDegrees;
+    std::vector<size_t>& inDegrees = mState.mInDegrees;
     inDegrees.assign(mQic.mGraph.size(), 0);
     releaseAssert(!mRemaining.empty());
     size_t maxNode = mRemaining.max();
@@ -114,29 +128,37 @@ MinQuorumEnumerator::maxCommit() const
 
 MinQuorumEnumerator::MinQuorumEnumerator(
     BitSet const& committed, BitSet const& remaining, BitSet const& scanSCC,
-    QuorumIntersectionCheckerImpl const& qic)
+    QuorumIntersectionCheckerImpl const& qic, SearchState& state)
     : mCommitted(committed)
     , mRemaining(remaining)
     , mPerimeter(committed | remaining)
     , mScanSCC(scanSCC)
     , mQic(qic)
+    , mState(state)
 {
 }
 
-bool
-MinQuorumEnumerator::anyMinQuorumHasDisjointQuorum()
+std::optional<bool>
+MinQuorumEnumerator::earlyExit()
 {
     if (mQic.mInterruptFlag)
     {
         throw QuorumIntersectionChecker::InterruptedException();
     }
 
-    mQic.mStats.mCallsStarted++;
+    // Another thread of a parallel enumeration found a disjoint quorum, which
+    // it reports: nothing left to do here.
+    if (mQic.mFoundDisjoint)
+    {
+        return false;
+    }
+
+    mState.mStats.mCallsStarted++;
 
     // Emit a progress meter every million calls.
-    if ((mQic.mStats.mCallsStarted & 0xfffff) == 0)
+    if ((mState.mStats.mCallsStarted & 0xfffff) == 0)
     {
-        mQic.mStats.log();
+        mState.mStats.log();
     }
     if (mQic.mLogTrace)
     {
@@ -150,7 +172,7 @@ MinQuorumEnumerator::anyMinQuorumHasDisjointQuorum()
     // min-quorum they find (if they find any).
     if (mCommitted.count() > maxCommit())
     {
-        mQic.mStats.mEarlyExit1s++;
+        mState.mStats.mEarlyExit1s++;
         if (mQic.mLogTrace)
         {
             CLOG_TRACE(SCP, "early exit 1, with committed={}", mCommitted);
@@ -167,10 +189,10 @@ MinQuorumEnumerator::anyMinQuorumHasDisjointQuorum()
     {
         CLOG_TRACE(SCP, "checking for quorum in committed={}", mCommitted);
     }
-    auto committedQuorum = mQic.contractToMaximalQuorum(mCommitted);
+    auto committedQuorum = mQic.contractToMaximalQuorum(mCommitted, mState);
     if (!committedQuorum.empty())
     {
-        if (mQic.isMinimalQuorum(committedQuorum))
+        if (mQic.isMinimalQuorum(committedQuorum, mState))
         {
             // Found a min-quorum. Examine it to see if
             // there's a disjoint quorum.
@@ -179,7 +201,7 @@ MinQuorumEnumerator::anyMinQuorumHasDisjointQuorum()
                 CLOG_TRACE(SCP, "early exit 3.1: minimal quorum={}",
                            committedQuorum);
             }
-            mQic.mStats.mEarlyExit31s++;
+            mState.mStats.mEarlyExit31s++;
             return hasDisjointQuorum(committedQuorum);
         }
         if (mQic.mLogTrace)
@@ -187,7 +209,7 @@ MinQuorumEnumerator::anyMinQuorumHasDisjointQuorum()
             CLOG_TRACE(SCP, "early exit 3.2: non-minimal quorum={}",
                        committedQuorum);
         }
-        mQic.mStats.mEarlyExit32s++;
+        mState.mStats.mEarlyExit32s++;
         return false;
     }
 
@@ -198,7 +220,7 @@ MinQuorumEnumerator::anyMinQuorumHasDisjointQuorum()
     {
         CLOG_TRACE(SCP, "checking for quorum in perimeter={}", mPerimeter);
     }
-    auto extensionQuorum = mQic.contractToMaximalQuorum(mPerimeter);
+    auto extensionQuorum = mQic.contractToMaximalQuorum(mPerimeter, mState);
     if (!extensionQuorum.empty())
     {
         if (!mCommitted.isSubsetEq(extensionQuorum))
@@ -211,7 +233,7 @@ MinQuorumEnumerator::anyMinQuorumHasDisjointQuorum()
                     "does not extend committed={}",
                     extensionQuorum, mPerimeter, mCommitted);
             }
-            mQic.mStats.mEarlyExit22s++;
+            mState.mStats.mEarlyExit22s++;
             return false;
         }
     }
@@ -223,31 +245,41 @@ MinQuorumEnumerator::anyMinQuorumHasDisjointQuorum()
                        "early exit 2.1: no extension quorum in perimeter={}",
                        mPerimeter);
         }
-        mQic.mStats.mEarlyExit21s++;
+        mState.mStats.mEarlyExit21s++;
         return false;
     }
 
     // Principal termination condition: stop when remainder is empty.
     if (mRemaining.empty())
     {
-        mQic.mStats.mTerminations++;
+        mState.mStats.mTerminations++;
         if (mQic.mLogTrace)
         {
             CLOG_TRACE(SCP, "remainder exhausted");
         }
         return false;
     }
+    return std::nullopt;
+}
+
+bool
+MinQuorumEnumerator::anyMinQuorumHasDisjointQuorum()
+{
+    if (auto res = earlyExit())
+    {
+        return *res;
+    }
 
     // Phase two: recurse into subproblems.
-    size_t split = pickSplitNode(mQic.mRand);
+    size_t split = pickSplitNode(mState.mRand);
     if (mQic.mLogTrace)
     {
         CLOG_TRACE(SCP, "recursing into subproblems, split={}", split);
     }
     mRemaining.unset(split);
     MinQuorumEnumerator childExcludingSplit(mCommitted, mRemaining, mScanSCC,
-                                            mQic);
-    mQic.mStats.mFirstRecursionsTaken++;
+                                            mQic, mState);
+    mState.mStats.mFirstRecursionsTaken++;
     if (childExcludingSplit.anyMinQuorumHasDisjointQuorum())
     {
         if (mQic.mLogTrace)
@@ -259,11 +291,41 @@ MinQuorumEnumerator::anyMinQuorumHasDisjointQuorum()
     }
     mCommitted.set(split);
     MinQuorumEnumerator childIncludingSplit(mCommitted, mRemaining, mScanSCC,
-                                            mQic);
-    mQic.mStats.mSecondRecursionsTaken++;
+                                            mQic, mState);
+    mState.mStats.mSecondRecursionsTaken++;
     return childIncludingSplit.anyMinQuorumHasDisjointQuorum();
 }
 
+bool
+MinQuorumEnumerator::collectSubtrees(
+    size_t depth, std::vector<std::pair<BitSet, BitSet>>& subtrees)
+{
+    if (depth == 0)
+    {
+        subtrees.emplace_back(mCommitted, mRemaining);
+        return false;
+    }
+    if (auto res = earlyExit())
+    {
+        return *res;
+    }
+
+    size_t split = pickSplitNode(mState.mRand);
+    mRemaining.unset(split);
+    MinQuorumEnumerator childExcludingSplit(mCommitted, mRemaining, mScanSCC,
+                                            mQic, mState);
+    mState.mStats.mFirstRecursionsTaken++;
+    if (childExcludingSplit.collectSubtrees(depth - 1, subtrees))
+    {
+        return true;
+    }
+    mCommitted.set(split);
+    MinQuorumEnumerator childIncludingSplit(mCommitted, mRemaining, mScanSCC,
+                                            mQic, mState);
+    mState.mStats.mSecondRecursionsTaken++;
+    return childIncludingSplit.collectSubtrees(depth - 1, subtrees);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Implementation of QuorumIntersectionChecker
 ////////////////////////////////////////////////////////////////////////////////
@@ -271,14 +333,15 @@ MinQuorumEnumerator::anyMinQuorumHasDisjointQuorum()
 QuorumIntersectionCheckerImpl::QuorumIntersectionCheckerImpl(
     QuorumIntersectionChecker::QuorumSetMap const& qmap,
     std::optional<Config> const& cfg, std::atomic<bool>& interruptFlag,
-    stellar_default_random_engine::result_type seed, bool quiet)
+    stellar_default_random_engine::result_type seed, bool quiet,
+    std::shared_ptr<QuorumIntersectionCache> cache)
     : mCfg(cfg)
+    , mState(seed)
     , mLogTrace(Logging::logTrace("SCP"))
     , mQuiet(quiet)
+    , mCache(std::move(cache))
     , mTSC()
     , mInterruptFlag(interruptFlag)
-    , mCachedQuorums(MAX_CACHED_QUORUMS_SIZE, /*separatePRNG=*/true)
-    , mRand(seed)
 {
     buildGraph(qmap);
     // Awkwardly, the graph size is zero when we initialize mTSC. Update it
@@ -295,11 +358,11 @@ QuorumIntersectionCheckerImpl::getPotentialSplit() const
 size_t
 QuorumIntersectionCheckerImpl::getMaxQuorumsFound() const
 {
-    return mStats.mMaxQuorumsSeen;
+    return mState.mStats.mMaxQuorumsSeen;
 }
 
 void
-QuorumIntersectionCheckerImpl::Stats::log() const
+SearchStats::log() const
 {
     CLOG_DEBUG(SCP, "Quorum intersection checker stats:");
     size_t exits = (mEarlyExit1s + mEarlyExit21s + mEarlyExit22s +
@@ -314,6 +377,22 @@ QuorumIntersectionCheckerImpl::Stats::log() const
                mEarlyExit21s, mEarlyExit22s, mEarlyExit31s, mEarlyExit32s);
 }
 
+void
+SearchStats::merge(SearchStats const& other)
+{
+    mCallsStarted += other.mCallsStarted;
+    mFirstRecursionsTaken += other.mFirstRecursionsTaken;
+    mSecondRecursionsTaken += other.mSecondRecursionsTaken;
+    mMaxQuorumsSeen += other.mMaxQuorumsSeen;
+    mMinQuorumsSeen += other.mMinQuorumsSeen;
+    mTerminations += other.mTerminations;
+    mEarlyExit1s += other.mEarlyExit1s;
+    mEarlyExit21s += other.mEarlyExit21s;
+    mEarlyExit22s += other.mEarlyExit22s;
+    mEarlyExit31s += other.mEarlyExit31s;
+    mEarlyExit32s += other.mEarlyExit32s;
+}
+
 // This function is the innermost call in the checker and must be as fast
 // as possible. We spend almost all of our time in here.
 bool
@@ -393,13 +472,14 @@ QuorumIntersectionCheckerImpl::containsQuorumSliceForNode(BitSet const& bs,
 }
 
 bool
-QuorumIntersectionCheckerImpl::isAQuorum(BitSet const& nodes) const
+QuorumIntersectionCheckerImpl::isAQuorum(BitSet const& nodes,
+                                         SearchState& state) const
 {
-    bool* pRes = mCachedQuorums.maybeGet(nodes);
+    bool* pRes = state.mCachedQuorums.maybeGet(nodes);
     if (pRes == nullptr)
     {
-        bool result = !contractToMaximalQuorum(nodes).empty();
-        mCachedQuorums.put(nodes, result);
+        bool result = !contractToMaximalQuorum(nodes, state).empty();
+        state.mCachedQuorums.put(nodes, result);
         return result;
     }
     else
@@ -409,7 +489,8 @@ QuorumIntersectionCheckerImpl::isAQuorum(BitSet const& nodes) const
 }
 
 BitSet
-QuorumIntersectionCheckerImpl::contractToMaximalQuorum(BitSet nodes) const
+QuorumIntersectionCheckerImpl::contractToMaximalQuorum(
+    BitSet nodes, SearchState& state) const
 {
     // Find greatest fixpoint of f(X) = {n ∈ X | containsQuorumSliceForNode(X,
     // n)}
@@ -446,7 +527,7 @@ QuorumIntersectionCheckerImpl::contractToMaximalQuorum(BitSet nodes) const
             }
             if (!filtered.empty())
             {
-                ++mStats.mMaxQuorumsSeen;
+                ++state.mStats.mMaxQuorumsSeen;
             }
             return filtered;
         }
@@ -455,12 +536,13 @@ QuorumIntersectionCheckerImpl::contractToMaximalQuorum(BitSet nodes) const
 }
 
 bool
-QuorumIntersectionCheckerImpl::isMinimalQuorum(BitSet const& nodes) const
+QuorumIntersectionCheckerImpl::isMinimalQuorum(BitSet const& nodes,
+                                               SearchState& state) const
 {
 #ifndef NDEBUG
     // We should only be called with a quorum, such that contracting to its
     // maximum doesn't do anything. This is a slightly expensive check.
-    releaseAssert(contractToMaximalQuorum(nodes) == nodes);
+    releaseAssert(contractToMaximalQuorum(nodes, state) == nodes);
 #endif
 
     BitSet minQ = nodes;
@@ -472,7 +554,7 @@ QuorumIntersectionCheckerImpl::isMinimalQuorum(BitSet const& nodes) const
     for (size_t i = 0; nodes.nextSet(i); ++i)
     {
         minQ.unset(i);
-        if (isAQuorum(minQ))
+        if (isAQuorum(minQ, state))
         {
             // There's a subquorum with i removed: nodes isn't a minq.
             return false;
@@ -482,7 +564,7 @@ QuorumIntersectionCheckerImpl::isMinimalQuorum(BitSet const& nodes) const
     }
     // Tried every possible one-node-less subset, found no subquorums: this one
     // is minimal.
-    mStats.mMinQuorumsSeen++;
+    state.mStats.mMinQuorumsSeen++;
     return true;
 }
 
@@ -490,6 +572,13 @@ void
 QuorumIntersectionCheckerImpl::noteFoundDisjointQuorums(
     BitSet const& nodes, BitSet const& disj) const
 {
+    std::lock_guard<std::mutex> lock(mPotentialSplitMutex);
+    if (mFoundDisjoint)
+    {
+        // Another thread of a parallel enumeration got there first
+        return;
+    }
+    mFoundDisjoint = true;
     mPotentialSplit.first.clear();
     mPotentialSplit.second.clear();
 
@@ -517,7 +606,7 @@ QuorumIntersectionCheckerImpl::noteFoundDisjointQuorums(
 bool
 MinQuorumEnumerator::hasDisjointQuorum(BitSet const& nodes) const
 {
-    BitSet disj = mQic.contractToMaximalQuorum(mScanSCC - nodes);
+    BitSet disj = mQic.contractToMaximalQuorum(mScanSCC - nodes, mState);
     if (!disj.empty())
     {
         mQic.noteFoundDisjointQuorums(nodes, disj);
@@ -591,6 +680,7 @@ QuorumIntersectionCheckerImpl::buildGraph(
     mPubKeyBitNums.clear();
     mBitNumPubKeys.clear();
     mGraph.clear();
+    mBitNumQSets.clear();
 
     for (auto const& pair : qmap)
     {
@@ -618,9 +708,10 @@ QuorumIntersectionCheckerImpl::buildGraph(
             auto qb = convertSCPQuorumSet(*(pair.second));
             qb.log();
             mGraph.emplace_back(qb);
+            mBitNumQSets.emplace_back(pair.second);
         }
     }
-    mStats.mTotalNodes = mPubKeyBitNums.size();
+    mState.mStats.mTotalNodes = mPubKeyBitNums.size();
 }
 
 void
@@ -632,7 +723,7 @@ QuorumIntersectionCheckerImpl::buildSCCs()
         // winds up returning a dangling reference at its site of use.
         return this->mGraph.at(i).mAllSuccessors;
     });
-    mStats.mNumSCCs = mTSC.mSCCs.size();
+    mState.mStats.mNumSCCs = mTSC.mSCCs.size();
 }
 
 std::string
@@ -641,6 +732,30 @@ QuorumIntersectionCheckerImpl::nodeName(size_t node) const
     return toShortString(mCfg, mBitNumPubKeys.at(node));
 }
 
+Hash
+QuorumIntersectionCheckerImpl::sccCacheKey(BitSet const& scc) const
+{
+    // Node numbers depend on the iteration order of the qmap, so the key is
+    // built from the members in NodeID order. A qset refers to nodes outside
+    // of the SCC in the same way no matter what those nodes look like, so the
+    // members' own qsets are all the enumeration depends on.
+    std::vector<size_t> members;
+    for (size_t i = 0; scc.nextSet(i); ++i)
+    {
+        members.emplace_back(i);
+    }
+    std::sort(members.begin(), members.end(), [this](size_t a, size_t b) {
+        return mBitNumPubKeys.at(a) < mBitNumPubKeys.at(b);
+    });
+    SHA256 hasher;
+    for (auto i : members)
+    {
+        hasher.add(xdr::xdr_to_opaque(mBitNumPubKeys.at(i)));
+        hasher.add(xdr::xdr_to_opaque(*mBitNumQSets.at(i)));
+    }
+    return hasher.finish();
+}
+
 bool
 QuorumIntersectionCheckerImpl::networkEnjoysQuorumIntersection() const
 {
@@ -656,10 +771,11 @@ QuorumIntersectionCheckerImpl::networkEnjoysQuorumIntersection() const
     // second stage exhaustive scan if there are _two_ such SCCs with quorums,
     // as they necessarily contain disjoint min-quorums.
     bool foundDisjoint = false;
+    mFoundDisjoint = false;
     BitSet scanSCC;
     for (auto const& scc : mTSC.mSCCs)
     {
-        auto q = contractToMaximalQuorum(scc);
+        auto q = contractToMaximalQuorum(scc, mState);
         if (!q.empty())
         {
             if (scanSCC.empty())
@@ -667,7 +783,7 @@ QuorumIntersectionCheckerImpl::networkEnjoysQuorumIntersection() const
                 // This is the first SCC with a quorum, we'll make it the
                 // scan SCC.
                 scanSCC = scc;
-                mStats.mScanSCCSize = scanSCC.count();
+                mState.mStats.mScanSCCSize = scanSCC.count();
                 CLOG_DEBUG(SCP, "Found scan SCC: {}", scc);
                 CLOG_DEBUG(SCP, "Containing quorum: {}", q);
                 for (size_t i = 0; scanSCC.nextSet(i); ++i)
@@ -679,7 +795,8 @@ QuorumIntersectionCheckerImpl::networkEnjoysQuorumIntersection() const
             {
                 CLOG_DEBUG(SCP, "Found extra SCC: {}", scc);
                 CLOG_DEBUG(SCP, "Containing quorum: {}", q);
-                noteFoundDisjointQuorums(contractToMaximalQuorum(scanSCC), q);
+                noteFoundDisjointQuorums(
+                    contractToMaximalQuorum(scanSCC, mState), q);
                 foundDisjoint = true;
                 break;
             }
@@ -707,18 +824,133 @@ QuorumIntersectionCheckerImpl::networkEnjoysQuorumIntersection() const
         return true;
     }
 
-    // Second stage: scan the scan-SCC powerset, potentially expensive.
+    // Second stage: scan the scan-SCC powerset, potentially expensive. Skip it
+    // if this SCC has been scanned before.
     if (!foundDisjoint)
     {
-        BitSet committed;
-        BitSet remaining = scanSCC;
-        MinQuorumEnumerator mqe(committed, remaining, scanSCC, *this);
-        foundDisjoint = mqe.anyMinQuorumHasDisjointQuorum();
-        mStats.log();
+        Hash key;
+        std::optional<QuorumIntersectionCache::Result> cached;
+        if (mCache)
+        {
+            key = sccCacheKey(scanSCC);
+            cached = mCache->get(key);
+        }
+        if (cached)
+        {
+            CLOG_DEBUG(SCP, "Reusing enumeration result for scan SCC: {}",
+                       scanSCC);
+            mPotentialSplit = cached->mPotentialSplit;
+            return cached->mEnjoysQuorumIntersection;
+        }
+
+        size_t numThreads =
+            mCfg ? mCfg->QUORUM_INTERSECTION_CHECKER_THREADS : 1;
+        if (numThreads > 1)
+        {
+            foundDisjoint =
+                anyMinQuorumHasDisjointQuorumParallel(scanSCC, numThreads);
+        }
+        else
+        {
+            BitSet committed;
+            BitSet remaining = scanSCC;
+            MinQuorumEnumerator mqe(committed, remaining, scanSCC, *this,
+                                    mState);
+            foundDisjoint = mqe.anyMinQuorumHasDisjointQuorum();
+        }
+        mState.mStats.log();
+        if (mCache)
+        {
+            mCache->put(key, {!foundDisjoint, mPotentialSplit});
+        }
     }
     return !foundDisjoint;
 }
 
+bool
+QuorumIntersectionCheckerImpl::anyMinQuorumHasDisjointQuorumParallel(
+    BitSet const& scanSCC, size_t numThreads) const
+{
+    ZoneScoped;
+    // Enough subtrees that threads finishing small ones early always have
+    // more to take, though early exits prune some on the way down.
+    size_t depth = 4;
+    for (size_t n = 1; n < numThreads; n *= 2)
+    {
+        ++depth;
+    }
+    std::vector<std::pair<BitSet, BitSet>> subtrees;
+    MinQuorumEnumerator root(BitSet(), scanSCC, scanSCC, *this, mState);
+    if (root.collectSubtrees(depth, subtrees))
+    {
+        return true;
+    }
+
+    // Threads share scanSCC, which is fine as long as its count() is cached
+    // (an uncached count() writes the cache).
+    releaseAssert(scanSCC.count() == mState.mStats.mScanSCCSize);
+    numThreads = std::min(numThreads, subtrees.size());
+    // SearchStates aren't movable
+    std::vector<std::unique_ptr<SearchState>> states;
+    for (size_t t = 0; t < numThreads; ++t)
+    {
+        states.emplace_back(std::make_unique<SearchState>(mState.mRand()));
+    }
+
+    std::atomic<size_t> next{0};
+    auto worker = [&](SearchState& state) {
+        ZoneScopedN("min quorum enumeration worker");
+        for (size_t i = next++; i < subtrees.size() && !mFoundDisjoint;
+             i = next++)
+        {
+            MinQuorumEnumerator mqe(subtrees[i].first, subtrees[i].second,
+                                    scanSCC, *this, state);
+            mqe.anyMinQuorumHasDisjointQuorum();
+        }
+    };
+    std::vector<std::future<void>> futures;
+    for (size_t t = 1; t < numThreads; ++t)
+    {
+        futures.emplace_back(
+            std::async(std::launch::async, worker, std::ref(*states[t])));
+    }
+    // An interruption makes every thread throw, one of the exceptions is
+    // rethrown here once all threads are done.
+    std::exception_ptr interrupted;
+    try
+    {
+        if (numThreads > 0)
+        {
+            worker(*states[0]);
+        }
+    }
+    catch (QuorumIntersectionChecker::InterruptedException&)
+    {
+        interrupted = std::current_exception();
+    }
+    for (auto& f : futures)
+    {
+        try
+        {
+            f.get();
+        }
+        catch (QuorumIntersectionChecker::InterruptedException&)
+        {
+            interrupted = std::current_exception();
+        }
+    }
+    if (interrupted)
+    {
+        std::rethrow_exception(interrupted);
+    }
+
+    for (auto const& state : states)
+    {
+        mState.mStats.merge(state->mStats);
+    }
+    return mFoundDisjoint;
+}
+
 bool
 pointsToCandidate(SCPQuorumSet const& p, NodeID const& candidate)
 {
@@ -792,6 +1024,10 @@ groupString(std::optional<Config> const& cfg, std::set<NodeID> const& group)
 namespace stellar
 {
 
+// Enough for the criticality analysis of a few hundred candidate groups over a
+// few versions of the quorum map
+static size_t const QUORUM_INTERSECTION_CACHE_SIZE = 4096;
+
 void
 QuorumMapIntersectionState::reset(Application& app)
 {
@@ -805,28 +1041,63 @@ QuorumMapIntersectionState::reset(Application& app)
 
 QuorumMapIntersectionState::QuorumMapIntersectionState(Application& app)
     : mMetrics(app.getMetrics())
+    , mCache(std::make_shared<QuorumIntersectionCache>(
+          QUORUM_INTERSECTION_CACHE_SIZE))
 {
     reset(app);
 }
 
+QuorumIntersectionCache::QuorumIntersectionCache(size_t maxSize)
+    : mResults(maxSize)
+{
+}
+
+std::optional<QuorumIntersectionCache::Result>
+QuorumIntersectionCache::get(Hash const& sccKey)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto* res = mResults.maybeGet(sccKey);
+    if (res == nullptr)
+    {
+        return std::nullopt;
+    }
+    return *res;
+}
+
+void
+QuorumIntersectionCache::put(Hash const& sccKey, Result const& result)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mResults.put(sccKey, result);
+}
+
+RandomEvictionCache<Hash, QuorumIntersectionCache::Result>::Counters
+QuorumIntersectionCache::getCounters() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mResults.getCounters();
+}
+
 std::shared_ptr<QuorumIntersectionChecker>
 QuorumIntersectionChecker::create(
     QuorumTracker::QuorumMap const& qmap, std::optional<Config> const& cfg,
     std::atomic<bool>& interruptFlag,
-    stellar_default_random_engine::result_type seed, bool quiet)
+    stellar_default_random_engine::result_type seed, bool quiet,
+    std::shared_ptr<QuorumIntersectionCache> cache)
 {
     return create(toQuorumIntersectionMap(qmap), cfg, interruptFlag, seed,
-                  quiet);
+                  quiet, std::move(cache));
 }
 
 std::shared_ptr<QuorumIntersectionChecker>
 QuorumIntersectionChecker::create(
     QuorumSetMap const& qmap, std::optional<Config> const& cfg,
     std::atomic<bool>& interruptFlag,
-    stellar_default_random_engine::result_type seed, bool quiet)
+    stellar_default_random_engine::result_type seed, bool quiet,
+    std::shared_ptr<QuorumIntersectionCache> cache)
 {
     return std::make_shared<QuorumIntersectionCheckerImpl>(
-        qmap, cfg, interruptFlag, seed, quiet);
+        qmap, cfg, interruptFlag, seed, quiet, std::move(cache));
 }
 
 std::set<std::set<NodeID>>
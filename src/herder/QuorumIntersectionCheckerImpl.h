@@ -349,6 +349,24 @@
 //
 // Remaining details of the implementation are noted as we go, but the above
 // explanation ought to give you a good idea what you're looking at.
+//
+//
+// Coda: parallel enumeration
+// ==========================
+//
+// The two recursive cases of the enumeration never look at each other's
+// results, only at the graph, so the subtrees of the search can be explored
+// independently. When QUORUM_INTERSECTION_CHECKER_THREADS is above 1, the
+// top levels of the search tree are expanded on the calling thread (running
+// the same early exits as usual), the subtrees left at the split nodes below
+// them become tasks, and a handful of threads take tasks off a shared list
+// until it's empty. There are many more tasks than threads, as subtrees vary
+// wildly in size, so that a thread finishing a small one just takes the next.
+//
+// Everything the search mutates -- stats, the quorum cache, scratch vectors
+// and the PRNG picking split nodes -- lives in a SearchState, of which each
+// thread has its own. The first thread to find a pair of disjoint quorums
+// records it and raises a shared flag that makes the other threads stop.
 
 #include "QuorumIntersectionChecker.h"
 #include "main/Config.h"
@@ -357,7 +375,9 @@
 #include "util/TarjanSCCCalculator.h"
 #include "xdr/Stellar-SCP.h"
 #include "xdr/Stellar-types.h"
+#include <atomic>
 #include <functional>
+#include <mutex>
 #include <optional>
 
 namespace
@@ -394,6 +414,53 @@ struct QBitSet
     static BitSet getSuccessors(BitSet const& nodes, QGraph const& inner);
 };
 
+struct SearchStats
+{
+    size_t mTotalNodes = {0};
+    size_t mNumSCCs = {0};
+    size_t mScanSCCSize = {0};
+    size_t mCallsStarted = {0};
+    size_t mFirstRecursionsTaken = {0};
+    size_t mSecondRecursionsTaken = {0};
+    size_t mMaxQuorumsSeen = {0};
+    size_t mMinQuorumsSeen = {0};
+    size_t mTerminations = {0};
+    size_t mEarlyExit1s = {0};
+    size_t mEarlyExit21s = {0};
+    size_t mEarlyExit22s = {0};
+    size_t mEarlyExit31s = {0};
+    size_t mEarlyExit32s = {0};
+    void log() const;
+
+    // Adds the search counters of other, those of one thread of a parallel
+    // enumeration, to these.
+    void merge(SearchStats const& other);
+};
+
+// The state the search mutates. The checker has one for sequential use, and
+// each thread of a parallel enumeration gets its own.
+struct SearchState
+{
+    // We use our own stats rather than the global metrics, as looking those
+    // up at a fine grain actually becomes problematic CPU-wise.
+    SearchStats mStats;
+
+    static const int MAX_CACHED_QUORUMS_SIZE = 0xffff;
+    stellar::RandomEvictionCache<BitSet, bool, BitSet::HashFunction>
+        mCachedQuorums;
+
+    // This is a temporary structure that's reused very often within the
+    // MinQuorumEnumerators, but never reentrantly / simultaneously. So we
+    // allocate it once here and let the MQEs use it to avoid hammering
+    // on malloc.
+    std::vector<size_t> mInDegrees;
+
+    stellar::stellar_default_random_engine mRand;
+
+    explicit SearchState(
+        stellar::stellar_default_random_engine::result_type seed);
+};
+
 // A MinQuorumEnumerator is responsible to scanning the powerset of the SCC
 // we're considering, in a recursive bottom-up order, with a lot of early exits
 // described above. Each instance of MinQuorumEnumerator represents one call in
@@ -423,9 +490,12 @@ class MinQuorumEnumerator
     // the overall SCC we're considering subsets of.
     BitSet const& mScanSCC;
 
-    // Checker that owns us, contains state of stats, graph, etc.
+    // Checker that owns us, contains the graph, etc.
     QuorumIntersectionCheckerImpl const& mQic;
 
+    // State of the thread we run on.
+    SearchState& mState;
+
     // Select the next node in mRemaining to split recursive cases between.
     size_t
     pickSplitNode(stellar::stellar_default_random_engine& randEngine) const;
@@ -433,13 +503,26 @@ class MinQuorumEnumerator
     // Size limit for mCommitted beyond which we should stop scanning.
     size_t maxCommit() const;
 
+    // The checks a call makes before recursing: returns the result of the
+    // call if one of the early exits (or the termination condition) applies,
+    // or nullopt if the call has to recurse.
+    std::optional<bool> earlyExit();
+
   public:
     MinQuorumEnumerator(BitSet const& committed, BitSet const& remaining,
                         BitSet const& scanSCC,
-                        QuorumIntersectionCheckerImpl const& qic);
+                        QuorumIntersectionCheckerImpl const& qic,
+                        SearchState& state);
 
     bool hasDisjointQuorum(BitSet const& nodes) const;
     bool anyMinQuorumHasDisjointQuorum();
+
+    // Recurses like anyMinQuorumHasDisjointQuorum for depth levels, but
+    // instead of exploring the subtrees left at that depth, appends their
+    // (committed, remaining) sets to subtrees. Returns true if a disjoint
+    // quorum was found on the way down.
+    bool collectSubtrees(size_t depth,
+                         std::vector<std::pair<BitSet, BitSet>>& subtrees);
 };
 
 // Quorum intersection checking is done by establishing a root
@@ -452,29 +535,11 @@ class QuorumIntersectionCheckerImpl : public stellar::QuorumIntersectionChecker
 
     std::optional<stellar::Config> const mCfg;
 
-    struct Stats
-    {
-        size_t mTotalNodes = {0};
-        size_t mNumSCCs = {0};
-        size_t mScanSCCSize = {0};
-        size_t mCallsStarted = {0};
-        size_t mFirstRecursionsTaken = {0};
-        size_t mSecondRecursionsTaken = {0};
-        size_t mMaxQuorumsSeen = {0};
-        size_t mMinQuorumsSeen = {0};
-        size_t mTerminations = {0};
-        size_t mEarlyExit1s = {0};
-        size_t mEarlyExit21s = {0};
-        size_t mEarlyExit22s = {0};
-        size_t mEarlyExit31s = {0};
-        size_t mEarlyExit32s = {0};
-        void log() const;
-    };
-
-    // We use our own stats and a local cached flag to control tracing because
-    // using the global metrics and log-partition lookups at a fine grain
-    // actually becomes problematic CPU-wise.
-    mutable Stats mStats;
+    // State of the sequential parts of the search.
+    mutable SearchState mState;
+
+    // We use a local cached flag to control tracing because log-partition
+    // lookups at a fine grain actually becomes problematic CPU-wise.
     bool mLogTrace;
 
     // When run as a subroutine of criticality-checking, we inhibit
@@ -482,10 +547,13 @@ class QuorumIntersectionCheckerImpl : public stellar::QuorumIntersectionChecker
     bool mQuiet;
 
     // State to capture a counterexample found during search, for later
-    // reporting.
+    // reporting. Only the first counterexample found is recorded, after which
+    // mFoundDisjoint stops the threads of a parallel enumeration.
     mutable std::pair<std::vector<stellar::NodeID>,
                       std::vector<stellar::NodeID>>
         mPotentialSplit;
+    mutable std::mutex mPotentialSplitMutex;
+    mutable std::atomic<bool> mFoundDisjoint{false};
 
     // These are the key state of the checker: the mapping from node public keys
     // to graph node numbers, and the graph of QBitSets itself.
@@ -493,11 +561,9 @@ class QuorumIntersectionCheckerImpl : public stellar::QuorumIntersectionChecker
     std::unordered_map<stellar::NodeID, size_t> mPubKeyBitNums;
     QGraph mGraph;
 
-    // This is a temporary structure that's reused very often within the
-    // MinQuorumEnumerators, but never reentrantly / simultaneously. So we
-    // allocate it once here and let the MQEs use it to avoid hammering
-    // on malloc.
-    mutable std::vector<size_t> mInDegrees;
+    // Original quorum sets by graph node number, to key mCache by
+    std::vector<stellar::SCPQuorumSetPtr> mBitNumQSets;
+    std::shared_ptr<stellar::QuorumIntersectionCache> mCache;
 
     // This just calculates SCCs, from which we extract the first one found with
     // a quorum, which (assuming no other SCCs have quorums) we'll use for the
@@ -515,28 +581,27 @@ class QuorumIntersectionCheckerImpl : public stellar::QuorumIntersectionChecker
 
     bool containsQuorumSlice(BitSet const& bs, QBitSet const& qbs) const;
     bool containsQuorumSliceForNode(BitSet const& bs, size_t node) const;
-    BitSet contractToMaximalQuorum(BitSet nodes) const;
+    BitSet contractToMaximalQuorum(BitSet nodes, SearchState& state) const;
 
-    const int MAX_CACHED_QUORUMS_SIZE = 0xffff;
-    mutable stellar::RandomEvictionCache<BitSet, bool, BitSet::HashFunction>
-        mCachedQuorums;
-    bool isAQuorum(BitSet const& nodes) const;
-    bool isMinimalQuorum(BitSet const& nodes) const;
+    bool isAQuorum(BitSet const& nodes, SearchState& state) const;
+    bool isMinimalQuorum(BitSet const& nodes, SearchState& state) const;
     void noteFoundDisjointQuorums(BitSet const& nodes,
                                   BitSet const& disj) const;
+    bool anyMinQuorumHasDisjointQuorumParallel(BitSet const& scanSCC,
+                                               size_t numThreads) const;
     std::string nodeName(size_t node) const;
+    stellar::Hash sccCacheKey(BitSet const& scc) const;
 
     friend class MinQuorumEnumerator;
 
-    mutable stellar::stellar_default_random_engine mRand;
-
   public:
     QuorumIntersectionCheckerImpl(
         stellar::QuorumIntersectionChecker::QuorumSetMap const& qmap,
         std::optional<stellar::Config> const& cfg,
         std::atomic<bool>& interruptFlag,
         stellar::stellar_default_random_engine::result_type seed,
-        bool quiet = false);
+        bool quiet = false,
+        std::shared_ptr<stellar::QuorumIntersectionCache> cache = nullptr);
     bool networkEnjoysQuorumIntersection() const override;
 
     std::pair<std::vector<stellar::NodeID>, std::vector<stellar::NodeID>>
@@ -7,6 +7,7 @@
 #include "scp/LocalNode.h"
 #include "util/GlobalChecks.h"
 #include <Tracy.hpp>
+#include <map>
 
 namespace stellar
 {
@@ -65,7 +66,7 @@ QuorumTracker::expand(NodeID const& id, SCPQuorumSetPtr qSet)
     // `NodeInfo` entries in `mQuorum` for each of `qNode` mentioned in `qSet`.
 
     releaseAssertOrThrow(nodeInfo.mQuorumSet == nullptr);
-    nodeInfo.mQuorumSet = qSet;
+    setQuorumSet(id, nodeInfo, qSet);
     int newDist = nodeInfo.mDistance + 1;
 
     return LocalNode::forAllNodes(*qSet, [&](NodeID const& qNode) {
@@ -132,12 +133,212 @@ QuorumTracker::expand(NodeID const& id, SCPQuorumSetPtr qSet)
     });
 }
 
+void
+QuorumTracker::setQuorumSet(NodeID const& id, NodeInfo& nodeInfo,
+                            SCPQuorumSetPtr qSet)
+{
+    if (nodeInfo.mQuorumSet)
+    {
+        LocalNode::forAllNodes(*nodeInfo.mQuorumSet, [&](NodeID const& qNode) {
+            auto it = mDependents.find(qNode);
+            if (it != mDependents.end())
+            {
+                it->second.erase(id);
+                if (it->second.empty())
+                {
+                    mDependents.erase(it);
+                }
+            }
+            return true;
+        });
+    }
+    nodeInfo.mQuorumSet = qSet;
+    if (qSet)
+    {
+        LocalNode::forAllNodes(*qSet, [&](NodeID const& qNode) {
+            mDependents[qNode].emplace(id);
+            return true;
+        });
+    }
+}
+
+void
+QuorumTracker::eraseNode(QuorumMap::iterator it)
+{
+    setQuorumSet(it->first, it->second, nullptr);
+    mQuorum.erase(it);
+}
+
+bool
+QuorumTracker::canExpand(NodeInfo const& nodeInfo,
+                         SCPQuorumSet const& qSet) const
+{
+    int newDist = nodeInfo.mDistance + 1;
+    return LocalNode::forAllNodes(qSet, [&](NodeID const& qNode) {
+        auto it = mQuorum.find(qNode);
+        return it == mQuorum.end() || it->second.mDistance < newDist ||
+               !it->second.mQuorumSet;
+    });
+}
+
+void
+QuorumTracker::update(
+    NodeID const& id, SCPQuorumSetPtr qSet,
+    std::function<SCPQuorumSetPtr(NodeID const&)> const& lookup)
+{
+    ZoneScoped;
+
+    releaseAssertOrThrow(qSet);
+    auto it = mQuorum.find(id);
+    if (it == mQuorum.end() || it->second.mQuorumSet == qSet)
+    {
+        return;
+    }
+    auto oldQSet = it->second.mQuorumSet;
+    if (!oldQSet && canExpand(it->second, *qSet))
+    {
+        releaseAssertOrThrow(expand(id, qSet));
+        return;
+    }
+
+    // Collect the affected nodes: the ones reachable from `id` with either
+    // its old or its new quorum set. The shortest paths to any other node
+    // don't go through `id`, so their NodeInfo stays valid.
+    UnorderedMap<NodeID, SCPQuorumSetPtr> affected;
+    std::deque<NodeID> backlog;
+    auto visit = [&](NodeID const& node) {
+        if (node == mLocalNodeID || affected.find(node) != affected.end())
+        {
+            return true;
+        }
+        SCPQuorumSetPtr nodeQSet;
+        if (node == id)
+        {
+            nodeQSet = qSet;
+        }
+        else
+        {
+            auto nodeIt = mQuorum.find(node);
+            nodeQSet = nodeIt != mQuorum.end() ? nodeIt->second.mQuorumSet
+                                               : lookup(node);
+        }
+        affected.emplace(node, nodeQSet);
+        backlog.emplace_back(node);
+        return true;
+    };
+    LocalNode::forAllNodes(*qSet, visit);
+    if (oldQSet)
+    {
+        LocalNode::forAllNodes(*oldQSet, visit);
+    }
+    while (!backlog.empty())
+    {
+        auto nodeQSet = affected.at(backlog.front());
+        backlog.pop_front();
+        if (nodeQSet)
+        {
+            LocalNode::forAllNodes(*nodeQSet, visit);
+        }
+    }
+
+    if (affected.find(id) == affected.end())
+    {
+        setQuorumSet(id, it->second, qSet);
+    }
+    for (auto const& kv : affected)
+    {
+        auto nodeIt = mQuorum.find(kv.first);
+        if (nodeIt != mQuorum.end())
+        {
+            eraseNode(nodeIt);
+        }
+    }
+
+    // Recompute the affected nodes by distance, starting from the edges
+    // that enter them from the rest of the quorum. Affected nodes that are
+    // not reached anymore are left out of the quorum.
+    QuorumMap tentative;
+    std::map<int, std::vector<NodeID>> byDistance;
+    auto relax = [&](NodeID const& node, int dist,
+                     std::set<NodeID> const& closest) {
+        auto res = tentative.emplace(node, NodeInfo{nullptr, dist, closest});
+        auto& nodeInfo = res.first->second;
+        if (!res.second)
+        {
+            if (dist > nodeInfo.mDistance)
+            {
+                return;
+            }
+            if (dist < nodeInfo.mDistance)
+            {
+                nodeInfo.mDistance = dist;
+                nodeInfo.mClosestValidators = closest;
+            }
+            else
+            {
+                nodeInfo.mClosestValidators.insert(closest.begin(),
+                                                   closest.end());
+                return;
+            }
+        }
+        byDistance[dist].emplace_back(node);
+    };
+    for (auto const& kv : affected)
+    {
+        auto depIt = mDependents.find(kv.first);
+        if (depIt == mDependents.end())
+        {
+            continue;
+        }
+        for (auto const& dep : depIt->second)
+        {
+            auto const& depInfo = mQuorum.at(dep);
+            relax(kv.first, depInfo.mDistance + 1,
+                  depInfo.mDistance == 0 ? std::set<NodeID>{kv.first}
+                                         : depInfo.mClosestValidators);
+        }
+    }
+    while (!byDistance.empty())
+    {
+        auto level = byDistance.begin();
+        int dist = level->first;
+        auto nodes = std::move(level->second);
+        byDistance.erase(level);
+        for (auto const& node : nodes)
+        {
+            auto const& nodeInfo = tentative.at(node);
+            if (nodeInfo.mDistance != dist ||
+                mQuorum.find(node) != mQuorum.end())
+            {
+                // Already reached by a shorter path
+                continue;
+            }
+            auto& added = mQuorum.emplace(node, nodeInfo).first->second;
+            auto nodeQSet = affected.at(node);
+            setQuorumSet(node, added, nodeQSet);
+            if (!nodeQSet)
+            {
+                continue;
+            }
+            LocalNode::forAllNodes(*nodeQSet, [&](NodeID const& qNode) {
+                if (affected.find(qNode) != affected.end() &&
+                    mQuorum.find(qNode) == mQuorum.end())
+                {
+                    relax(qNode, dist + 1, added.mClosestValidators);
+                }
+                return true;
+            });
+        }
+    }
+}
+
 void
 QuorumTracker::rebuild(std::function<SCPQuorumSetPtr(NodeID const&)> lookup)
 {
     ZoneScoped;
 
     mQuorum.clear();
+    mDependents.clear();
 
     mQuorum.emplace(mLocalNodeID, NodeInfo{nullptr, 0, {}});
 
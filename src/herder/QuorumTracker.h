@@ -19,8 +19,10 @@ namespace stellar
 // If its associated quorum set is empty (nullptr), it just means
 // that another node has that node in its quorum set
 // but could not explore the quorum further (as we're missing the quorum set)
-// Nodes can be added one by one (calling `expand`, most efficient)
-// or the quorum can be rebuilt from scratch by using a lookup function
+// Nodes can be added one by one (calling `expand`, most efficient),
+// updated in place when their quorum set changes (calling `update`, which only
+// revisits the nodes downstream of the change) or the quorum can be rebuilt
+// from scratch by using a lookup function
 class QuorumTracker : public NonMovableOrCopyable
 {
   public:
@@ -45,6 +47,16 @@ class QuorumTracker : public NonMovableOrCopyable
   private:
     NodeID const mLocalNodeID;
     QuorumMap mQuorum;
+    // For each node in mQuorum, the nodes in mQuorum whose quorum set
+    // contains it
+    UnorderedMap<NodeID, UnorderedSet<NodeID>> mDependents;
+
+    void setQuorumSet(NodeID const& id, NodeInfo& nodeInfo,
+                      SCPQuorumSetPtr qSet);
+    void eraseNode(QuorumMap::iterator it);
+    // returns true if `expand(id, qSet)` would succeed for a node already
+    // in the quorum without a quorum set
+    bool canExpand(NodeInfo const& nodeInfo, SCPQuorumSet const& qSet) const;
 
   public:
     QuorumTracker(NodeID const& localNodeID);
@@ -69,6 +81,15 @@ class QuorumTracker : public NonMovableOrCopyable
     // the nodes in the qset, which are equally close to the external node
     bool expand(NodeID const& id, SCPQuorumSetPtr qSet);
 
+    // updates the quorum after `id` changed its quorum set to `qSet`, unlike
+    // `expand` this never fails: nodes that are no longer reachable are
+    // removed, and `lookup` is used for the quorum sets of nodes that join the
+    // quorum. Only the nodes reachable from `id` before or after the change
+    // are visited, as they are the only ones whose distance to the local
+    // node may change. Does nothing if `id` is not in the quorum.
+    void update(NodeID const& id, SCPQuorumSetPtr qSet,
+                std::function<SCPQuorumSetPtr(NodeID const&)> const& lookup);
+
     // rebuild the transitive quorum given a lookup function
     void rebuild(std::function<SCPQuorumSetPtr(NodeID const&)> lookup);
 
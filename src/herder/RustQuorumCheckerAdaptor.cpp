@@ -9,6 +9,7 @@
 #include "herder/QuorumIntersectionChecker.h"
 #include "medida/meter.h"
 #include "medida/metrics_registry.h"
+#include "medida/timer.h"
 #include "process/ProcessManager.h"
 #include "rust/RustBridge.h"
 #include "scp/LocalNode.h"
@@ -554,8 +555,9 @@ runQuorumIntersectionCheckAsync(
         return;
     }
 
+    auto start = std::chrono::steady_clock::now();
     evt->async_wait([numNodes, ledger, curr, qicOutFile, qicResultJson, hState,
-                     &app](asio::error_code ec) {
+                     start, &app](asio::error_code ec) {
         auto hStateSP = hState.lock();
         if (hStateSP == nullptr)
         {
@@ -595,6 +597,11 @@ runQuorumIntersectionCheckAsync(
                     hStateSP->mNumNodes = numNodes;
                     hStateSP->mLastCheckLedger = ledger;
                     hStateSP->mLastCheckQuorumMapHash = curr;
+                    hStateSP->mLastCheckDuration =
+                        std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::steady_clock::now() - start);
+                    hStateSP->mMetrics.NewTimer({"scp", "qic", "check"})
+                        .Update(hStateSP->mLastCheckDuration);
                     fromQuorumSplitJson(hStateSP->mPotentialSplit,
                                         res["quorum_split"]);
                     fromCriticalGroupsJson(hStateSP->mIntersectionCriticalNodes,
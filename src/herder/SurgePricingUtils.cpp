@@ -141,12 +141,11 @@ SurgePricingPriorityQueue::SurgePricingPriorityQueue(
     : mComparator(isHighestPriority, comparisonSeed)
     , mLaneConfig(settings)
     , mLaneLimits(mLaneConfig->getLaneLimits())
+    , mTotalCount(std::vector<int64_t>(mLaneLimits.at(0).size(), 0))
     , mTxSortedSets(mLaneLimits.size(), TxSortedSet(mComparator))
 {
     releaseAssert(!mLaneLimits.empty());
-    mLaneCurrentCount = std::vector<Resource>(
-        mLaneLimits.size(),
-        Resource(std::vector<int64_t>(mLaneLimits[0].size(), 0)));
+    mLaneCurrentCount = std::vector<Resource>(mLaneLimits.size(), mTotalCount);
 }
 
 std::vector<TransactionFrameBasePtr>
@@ -175,6 +174,49 @@ SurgePricingPriorityQueue::getMostTopTxsWithinLimits(
     return outTxs;
 }
 
+std::vector<TransactionFrameBasePtr>
+SurgePricingPriorityQueue::getTopTxsWithinLimits(
+    std::function<bool(TransactionFrameBasePtr const&)> const& skip,
+    std::vector<bool>& hadTxNotFittingLane, uint32_t ledgerVersion) const
+{
+    ZoneScoped;
+    releaseAssert(mComparator.isGreater());
+
+    std::vector<Resource> laneLeftUntilLimit = mLaneLimits;
+    hadTxNotFittingLane.assign(mLaneLimits.size(), false);
+    std::vector<TransactionFrameBasePtr> outTxs;
+    for (auto it = getTop(); !it.isEnd(); it.advance())
+    {
+        auto tx = *it;
+        if (skip(tx))
+        {
+            continue;
+        }
+        auto res = mLaneConfig->getTxResources(*tx, ledgerVersion);
+        auto lane = mLaneConfig->getLane(*tx);
+        // This mirrors the `allowGaps` branch of `popTopTxs`.
+        if (anyGreater(res, laneLeftUntilLimit[lane]) ||
+            anyGreater(res, laneLeftUntilLimit[GENERIC_LANE]))
+        {
+            auto notFittingLane =
+                anyGreater(res, laneLeftUntilLimit[lane]) ? lane : GENERIC_LANE;
+            if (!hadTxNotFittingLane[notFittingLane])
+            {
+                hadTxNotFittingLane[notFittingLane] = true;
+                outTxs.push_back(tx);
+            }
+            continue;
+        }
+        laneLeftUntilLimit[GENERIC_LANE] -= res;
+        if (lane != GENERIC_LANE)
+        {
+            laneLeftUntilLimit[lane] -= res;
+        }
+        outTxs.push_back(tx);
+    }
+    return outTxs;
+}
+
 void
 SurgePricingPriorityQueue::visitTopTxs(
     std::vector<TransactionFrameBasePtr> const& txs,
@@ -201,8 +243,9 @@ SurgePricingPriorityQueue::add(TransactionFrameBasePtr tx,
     bool inserted = mTxSortedSets[lane].insert(tx).second;
     if (inserted)
     {
-        mLaneCurrentCount[lane] +=
-            mLaneConfig->getTxResources(*tx, ledgerVersion);
+        auto res = mLaneConfig->getTxResources(*tx, ledgerVersion);
+        mLaneCurrentCount[lane] += res;
+        mTotalCount += res;
     }
 }
 
@@ -234,6 +277,7 @@ SurgePricingPriorityQueue::erase(
     auto res = mLaneConfig->getTxResources(*(*iter), ledgerVersion);
     releaseAssert(res <= mLaneCurrentCount[lane]);
     mLaneCurrentCount[lane] -= res;
+    mTotalCount -= res;
     mTxSortedSets[lane].erase(iter);
 }
 
@@ -375,7 +419,7 @@ SurgePricingPriorityQueue::canFitWithEviction(
             txNewResources.toString());
         return std::make_pair(false, 0ll);
     }
-    Resource total = totalResources();
+    auto const& total = totalResources();
 
     if (!total.canAdd(txNewResources) ||
         !(mLaneCurrentCount[lane].canAdd(txNewResources)))
@@ -505,17 +549,13 @@ SurgePricingPriorityQueue::getTop() const
     return SurgePricingPriorityQueue::Iterator(*this, iters);
 }
 
-Resource
+Resource const&
 SurgePricingPriorityQueue::totalResources() const
 {
-    releaseAssert(!mLaneCurrentCount.empty());
-    auto resourceCount = mLaneCurrentCount.begin()->size();
-    Resource res(std::vector<int64_t>(resourceCount, 0));
-    return std::accumulate(mLaneCurrentCount.begin(), mLaneCurrentCount.end(),
-                           res);
+    return mTotalCount;
 }
 
-Resource
+Resource const&
 SurgePricingPriorityQueue::laneResources(size_t lane) const
 {
     releaseAssert(lane < mLaneCurrentCount.size());
@@ -532,6 +572,10 @@ std::vector<SurgePricingPriorityQueue::LaneIter>::iterator
 SurgePricingPriorityQueue::Iterator::getMutableInnerIter() const
 {
     releaseAssert(!isEnd());
+    if (mBest)
+    {
+        return mIters.begin() + *mBest;
+    }
     auto best = mIters.begin();
     for (auto groupIt = std::next(mIters.begin()); groupIt != mIters.end();
          ++groupIt)
@@ -542,6 +586,7 @@ SurgePricingPriorityQueue::Iterator::getMutableInnerIter() const
             best = groupIt;
         }
     }
+    mBest = static_cast<size_t>(best - mIters.begin());
     return best;
 }
 
@@ -567,6 +612,7 @@ void
 SurgePricingPriorityQueue::Iterator::advance()
 {
     auto it = getMutableInnerIter();
+    mBest.reset();
     ++it->second;
     if (it->second == mParent.mTxSortedSets[it->first].end())
     {
@@ -577,7 +623,9 @@ SurgePricingPriorityQueue::Iterator::advance()
 void
 SurgePricingPriorityQueue::Iterator::dropLane()
 {
-    mIters.erase(getMutableInnerIter());
+    auto it = getMutableInnerIter();
+    mBest.reset();
+    mIters.erase(it);
 }
 
 DexLimitingLaneConfig::DexLimitingLaneConfig(Resource Limit,
@@ -4,6 +4,7 @@
 // under the Apache License, Version 2.0. See the COPYING file at the root
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
+#include <optional>
 #include <set>
 
 #include "transactions/TransactionFrameBase.h"
@@ -122,11 +123,24 @@ class SurgePricingPriorityQueue
         std::shared_ptr<SurgePricingLaneConfig> laneConfig,
         std::vector<bool>& hadTxNotFittingLane, uint32_t ledgerVersion);
 
+    // Non-destructive counterpart of `getMostTopTxsWithinLimits` for a
+    // queue that is maintained across calls. Walks this queue from the top
+    // and returns the transactions that fit into its lane limits, ignoring
+    // the ones for which `skip` returns `true`.
+    // `hadTxNotFittingLane` has the same meaning as in
+    // `getMostTopTxsWithinLimits`. For every lane reported as not fitting,
+    // the first transaction that didn't fit is returned as well, so that
+    // running `getMostTopTxsWithinLimits` on the result reports the same
+    // lanes.
+    std::vector<TransactionFrameBasePtr> getTopTxsWithinLimits(
+        std::function<bool(TransactionFrameBasePtr const&)> const& skip,
+        std::vector<bool>& hadTxNotFittingLane, uint32_t ledgerVersion) const;
+
     // Returns total amount of resources in all the transactions in this queue.
-    Resource totalResources() const;
+    Resource const& totalResources() const;
 
     // Returns total amount of resources in the provided lane of the queue.
-    Resource laneResources(size_t lane) const;
+    Resource const& laneResources(size_t lane) const;
 
     // Result of visiting a transaction in the `visitTopTxs`.
     // This serves as a callback output to let the queue know how to process the
@@ -254,6 +268,10 @@ class SurgePricingPriorityQueue
 
         SurgePricingPriorityQueue const& mParent;
         std::vector<LaneIter> mutable mIters;
+        // Index in `mIters` of the current value, found lazily. Eviction
+        // looks at the current value several times per step, and every
+        // lookup would otherwise compare the heads of all the lanes again.
+        std::optional<size_t> mutable mBest;
     };
 
     void erase(Iterator const& it, uint32_t ledgerVersion);
@@ -268,6 +286,8 @@ class SurgePricingPriorityQueue
     std::vector<Resource> const& mLaneLimits;
 
     std::vector<Resource> mLaneCurrentCount;
+    // Sum of `mLaneCurrentCount`, kept up to date on every add and erase
+    Resource mTotalCount;
 
     std::vector<TxSortedSet> mTxSortedSets;
 };
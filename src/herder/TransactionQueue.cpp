@@ -21,6 +21,7 @@
 #include "util/GlobalChecks.h"
 #include "util/HashOfHash.h"
 #include "util/Math.h"
+#include "util/MemoryAccounting.h"
 #include "util/ProtocolVersion.h"
 #include "util/TarjanSCCCalculator.h"
 #include "util/XDROperators.h"
@@ -97,6 +98,7 @@ TransactionQueue::TransactionQueue(Application& app, uint32 pendingDepth,
     : mApp(app)
     , mPendingDepth(pendingDepth)
     , mBannedTransactions(banDepth)
+    , mAccountsByAge(pendingDepth)
     , mBroadcastTimer(app)
 {
     mTxQueueLimiter =
@@ -132,7 +134,9 @@ ClassicTransactionQueue::ClassicTransactionQueue(Application& app,
         app.getMetrics().NewCounter({"herder", "pending-txs", "sum"}),
         app.getMetrics().NewCounter({"herder", "pending-txs", "count"}),
         app.getMetrics().NewCounter({"herder", "pending-txs", "self-sum"}),
-        app.getMetrics().NewCounter({"herder", "pending-txs", "self-count"}));
+        app.getMetrics().NewCounter({"herder", "pending-txs", "self-count"}),
+        app.getMetrics().NewTimer({"herder", "pending-txs", "remove-applied"}),
+        app.getMetrics().NewTimer({"herder", "pending-txs", "shift"}));
     mBroadcastOpCarryover.resize(1,
                                  Resource::makeEmpty(NUM_CLASSIC_TX_RESOURCES));
 }
@@ -438,9 +442,14 @@ TransactionQueue::canAdd(
     }
 
     // Loadgen txs were generated by this local node, and therefore can skip
-    // validation, and be added directly to the queue.
+    // validation, and be added directly to the queue. Transactions from peers
+    // may have been validated against the LCL on the overlay thread already.
+    bool const prevalidated = tx->getPrevalidatedLedgerSeq() ==
+                              mApp.getLedgerManager().getLastClosedLedgerNum();
 #ifdef BUILD_TESTS
-    if (!isLoadgenTx)
+    if (!isLoadgenTx && !prevalidated)
+#else
+    if (!prevalidated)
 #endif
     {
         auto validationResult = tx->checkValid(
@@ -510,6 +519,7 @@ TransactionQueue::prepareDropTransaction(AccountState& as)
 {
     releaseAssert(as.mTransaction);
     mTxQueueLimiter->removeTransaction(as.mTransaction->mTx);
+    removeFromNominationQueue(as.mTransaction->mTx);
     mKnownTxHashes.erase(as.mTransaction->mTx->getFullHash());
     CLOG_DEBUG(Tx, "Dropping {} transaction",
                hexAbbrev(as.mTransaction->mTx->getFullHash()));
@@ -636,6 +646,7 @@ TransactionQueue::tryAdd(TransactionFrameBasePtr tx, bool submittedFromSelf
 )
 {
     ZoneScoped;
+    MEMORY_ACCOUNTING_SCOPE(TRANSACTION_QUEUE);
 
     auto c1 =
         tx->getEnvelope().type() == ENVELOPE_TYPE_TX_FEE_BUMP &&
@@ -683,10 +694,12 @@ TransactionQueue::tryAdd(TransactionFrameBasePtr tx, bool submittedFromSelf
     }
     else
     {
-        // New transaction for this account, insert it and update age
+        // New transaction for this account, insert it and start its age
         stateIter->second.mTransaction = {tx, false, mApp.getClock().now(),
                                           submittedFromSelf};
-        mQueueMetrics->mSizeByAge[stateIter->second.mAge]->inc();
+        stateIter->second.mAgeOrigin = mShifts;
+        mAccountsByAge.front().insert(stateIter->first);
+        mQueueMetrics->mSizeByAge[0]->inc();
     }
 
     // Update fee accounting
@@ -699,6 +712,7 @@ TransactionQueue::tryAdd(TransactionFrameBasePtr tx, bool submittedFromSelf
         txsToEvict, *tx,
         [this](TransactionFrameBasePtr const& txToEvict) { ban({txToEvict}); });
     mTxQueueLimiter->addTransaction(tx);
+    addToNominationQueue(tx);
     mKnownTxHashes[tx->getFullHash()] = tx;
 
     broadcast(false);
@@ -718,26 +732,30 @@ TransactionQueue::dropTransaction(AccountStates::iterator stateIter)
 
     prepareDropTransaction(stateIter->second);
 
-    // Actually erase the transaction to be dropped.
+    // Actually erase the transaction to be dropped, which resets the age.
+    mAccountsByAge[getAge(stateIter->second)].erase(stateIter->first);
     stateIter->second.mTransaction.reset();
 
-    // If the queue for stateIter is now empty, then (1) erase it if it is
-    // not the fee-source for some other transaction or (2) reset the age
-    // otherwise.
+    // If the queue for stateIter is now empty, then erase it if it is not the
+    // fee-source for some other transaction.
     if (stateIter->second.mTotalFees == 0)
     {
         mAccountStates.erase(stateIter);
     }
-    else
-    {
-        stateIter->second.mAge = 0;
-    }
+}
+
+uint32_t
+TransactionQueue::getAge(AccountState const& as) const
+{
+    return as.mTransaction ? static_cast<uint32_t>(mShifts - as.mAgeOrigin)
+                           : 0;
 }
 
 void
 TransactionQueue::removeApplied(Transactions const& appliedTxs)
 {
     ZoneScoped;
+    auto timer = mQueueMetrics->mRemoveAppliedTimer.TimeScope();
 
     auto now = mApp.getClock().now();
     for (auto const& appliedTx : appliedTxs)
@@ -759,9 +777,8 @@ TransactionQueue::removeApplied(Transactions const& appliedTxs)
                 // (2) become invalid.
                 if (transaction->mTx->getSeqNum() <= appliedTx->getSeqNum())
                 {
-                    auto& age = stateIter->second.mAge;
-                    mQueueMetrics->mSizeByAge[age]->dec();
-                    age = 0;
+                    mQueueMetrics->mSizeByAge[getAge(stateIter->second)]
+                        ->dec();
 
                     // update the metric for the time spent for applied
                     // transactions using exact match
@@ -836,7 +853,7 @@ TransactionQueue::ban(Transactions const& banTxs)
             if (transaction &&
                 transaction->mTx->getFullHash() == kv.second->getFullHash())
             {
-                mQueueMetrics->mSizeByAge[stateIter->second.mAge]->dec();
+                mQueueMetrics->mSizeByAge[getAge(stateIter->second)]->dec();
                 // WARNING: stateIter and everything that references it may
                 // be invalid from this point onward and should not be used.
                 dropTransaction(stateIter);
@@ -846,16 +863,17 @@ TransactionQueue::ban(Transactions const& banTxs)
 }
 
 #ifdef BUILD_TESTS
-TransactionQueue::AccountState
+TransactionQueue::AccountInfo
 TransactionQueue::getAccountTransactionQueueInfo(
     AccountID const& accountID) const
 {
     auto i = mAccountStates.find(accountID);
     if (i == std::end(mAccountStates))
     {
-        return AccountState{};
+        return AccountInfo{};
     }
-    return i->second;
+    return AccountInfo{i->second.mTotalFees, getAge(i->second),
+                       i->second.mTransaction};
 }
 
 size_t
@@ -869,62 +887,40 @@ void
 TransactionQueue::shift()
 {
     ZoneScoped;
+    auto timer = mQueueMetrics->mShiftTimer.TimeScope();
     mBannedTransactions.pop_back();
     mBannedTransactions.emplace_front();
     mArbitrageFloodDamping.clear();
+    mLastShiftTime = mApp.getClock().now();
 
-    auto sizes = std::vector<int64_t>{};
-    sizes.resize(mPendingDepth);
+    // Every account with a transaction gets one ledger older, the oldest
+    // ones reach mPendingDepth and their transaction expires
+    ++mShifts;
+    auto expired = std::move(mAccountsByAge.back());
+    mAccountsByAge.pop_back();
+    mAccountsByAge.emplace_front();
 
     auto& bannedFront = mBannedTransactions.front();
-    auto end = std::end(mAccountStates);
-    auto it = std::begin(mAccountStates);
-    while (it != end)
-    {
-        // If mTransactions is empty then mAge is always 0. This can occur
-        // if an account is the fee-source for at least one transaction but
-        // not the sequence-number-source for any transaction in the
-        // TransactionQueue.
-        if (it->second.mTransaction)
-        {
-            ++it->second.mAge;
-        }
-
-        if (mPendingDepth == it->second.mAge)
-        {
-            if (it->second.mTransaction)
-            {
-                // This never invalidates it because
-                //     it->second.mTransaction
-                // otherwise we couldn't have reached this line.
-                prepareDropTransaction(it->second);
-                CLOG_DEBUG(
-                    Tx, "Ban transaction {}",
-                    hexAbbrev(it->second.mTransaction->mTx->getFullHash()));
-                bannedFront.insert(it->second.mTransaction->mTx->getFullHash());
-                mQueueMetrics->mBannedTransactionsCounter.inc();
-                it->second.mTransaction.reset();
-            }
-            if (it->second.mTotalFees == 0)
-            {
-                it = mAccountStates.erase(it);
-            }
-            else
-            {
-                it->second.mAge = 0;
-            }
-        }
-        else
+    for (auto const& accountID : expired)
+    {
+        auto it = mAccountStates.find(accountID);
+        releaseAssert(it != mAccountStates.end() && it->second.mTransaction);
+        // This never erases it because it->second.mTransaction is set.
+        prepareDropTransaction(it->second);
+        CLOG_DEBUG(Tx, "Ban transaction {}",
+                   hexAbbrev(it->second.mTransaction->mTx->getFullHash()));
+        bannedFront.insert(it->second.mTransaction->mTx->getFullHash());
+        mQueueMetrics->mBannedTransactionsCounter.inc();
+        it->second.mTransaction.reset();
+        if (it->second.mTotalFees == 0)
         {
-            sizes[it->second.mAge] +=
-                static_cast<int>(it->second.mTransaction.has_value());
-            ++it;
+            mAccountStates.erase(it);
         }
     }
 
-    for (size_t i = 0; i < sizes.size(); i++)
+    for (size_t i = 0; i < mAccountsByAge.size(); i++)
     {
-        mQueueMetrics->mSizeByAge[i]->set_count(sizes[i]);
+        mQueueMetrics->mSizeByAge[i]->set_count(mAccountsByAge[i].size());
     }
     mTxQueueLimiter->resetEvictionState();
     // pick a new randomizing seed for tie breaking
@@ -962,6 +958,42 @@ TransactionQueue::getTransactions(LedgerHeader const& lcl) const
     return txs;
 }
 
+void
+TransactionQueue::addToNominationQueue(TransactionFrameBasePtr const& tx)
+{
+    if (!mNominationQueue)
+    {
+        return;
+    }
+    auto ledgerVersion = mApp.getLedgerManager()
+                             .getLastClosedLedgerHeader()
+                             .header.ledgerVersion;
+    if (ledgerVersion != mNominationQueueLedgerVersion)
+    {
+        mNominationQueue.reset();
+        return;
+    }
+    mNominationQueue->add(tx, ledgerVersion);
+}
+
+void
+TransactionQueue::removeFromNominationQueue(TransactionFrameBasePtr const& tx)
+{
+    if (!mNominationQueue)
+    {
+        return;
+    }
+    auto ledgerVersion = mApp.getLedgerManager()
+                             .getLastClosedLedgerHeader()
+                             .header.ledgerVersion;
+    if (ledgerVersion != mNominationQueueLedgerVersion)
+    {
+        mNominationQueue.reset();
+        return;
+    }
+    mNominationQueue->erase(tx, ledgerVersion);
+}
+
 TransactionFrameBaseConstPtr
 TransactionQueue::getTx(Hash const& hash) const
 {
@@ -1082,7 +1114,10 @@ SorobanTransactionQueue::SorobanTransactionQueue(Application& app,
         app.getMetrics().NewCounter(
             {"herder", "pending-soroban-txs", "self-sum"}),
         app.getMetrics().NewCounter(
-            {"herder", "pending-soroban-txs", "self-count"}));
+            {"herder", "pending-soroban-txs", "self-count"}),
+        app.getMetrics().NewTimer(
+            {"herder", "pending-soroban-txs", "remove-applied"}),
+        app.getMetrics().NewTimer({"herder", "pending-soroban-txs", "shift"}));
     mBroadcastOpCarryover.resize(1, Resource::makeEmptySoroban());
 }
 
@@ -1213,6 +1248,10 @@ SorobanTransactionQueue::resetAndRebuild()
     // Clear all relevant queue state. mArbitrageFloodDamping and
     // mBannedTransactions cannot be invalidated by a protocol upgrade.
     mAccountStates.clear();
+    for (auto& accounts : mAccountsByAge)
+    {
+        accounts.clear();
+    }
     mKnownTxHashes.clear();
 
     auto lhhe = mApp.getLedgerManager().getLastClosedLedgerHeader();
@@ -1260,6 +1299,17 @@ ClassicTransactionQueue::broadcastSome()
         }
     }
 
+    if (mApp.getConfig().FLOOD_TX_PACING)
+    {
+        // Transactions flooded before the next ledger starts make it into
+        // the same tx set as if they were flooded right away, so there is
+        // no point in flooding them all in the first periods of the ledger
+        opsToFlood = limitTo(
+            opsToFlood,
+            mBroadcastOpCarryover[SurgePricingPriorityQueue::GENERIC_LANE] +
+                getPacedFloodBudget(totalToFlood));
+    }
+
     std::vector<TransactionFrameBasePtr> banningTxs;
     auto ledgerVersion = mApp.getLedgerManager()
                              .getLastClosedLedgerHeader()
@@ -1310,6 +1360,23 @@ ClassicTransactionQueue::broadcastSome()
     return !totalToFlood.isZero();
 }
 
+Resource
+TransactionQueue::getPacedFloodBudget(Resource const& backlog) const
+{
+    int64_t period = getFloodPeriod();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       mApp.getClock().now() - mLastShiftTime)
+                       .count();
+    auto remaining =
+        mApp.getLedgerManager().getExpectedLedgerCloseTime().count() -
+        elapsed;
+    if (remaining <= period)
+    {
+        return backlog;
+    }
+    return bigDivideOrThrow(backlog, period, remaining, Rounding::ROUND_UP);
+}
+
 void
 TransactionQueue::broadcast(bool fromCallback)
 {
@@ -1424,6 +1491,57 @@ TransactionQueue::getInQueueSeqNum(AccountID const& account) const
 }
 #endif
 
+TxFrameList
+ClassicTransactionQueue::getNominationCandidates(LedgerHeader const& lcl)
+{
+    ZoneScoped;
+    releaseAssert(threadIsMain());
+
+    auto& lm = mApp.getLedgerManager();
+    Resource maxOps(
+        {static_cast<uint32_t>(lm.getLastMaxTxSetSizeOps()),
+         static_cast<uint32_t>(mApp.getConfig().getClassicByteAllowance())});
+    if (!mNominationQueue ||
+        mNominationQueueLedgerVersion != lcl.ledgerVersion)
+    {
+        // Use the same lanes the classic phase is surge priced with
+        std::optional<Resource> dexOpsLimit;
+        if (mApp.getConfig().MAX_DEX_TX_OPERATIONS_IN_TX_SET)
+        {
+            dexOpsLimit =
+                Resource({*mApp.getConfig().MAX_DEX_TX_OPERATIONS_IN_TX_SET,
+                          MAX_CLASSIC_BYTE_ALLOWANCE});
+        }
+        mNominationLaneConfig =
+            std::make_shared<DexLimitingLaneConfig>(maxOps, dexOpsLimit);
+        mNominationQueue = std::make_unique<SurgePricingPriorityQueue>(
+            /* isHighestPriority */ true, mNominationLaneConfig,
+            rand_uniform<size_t>(0, std::numeric_limits<size_t>::max()));
+        mNominationQueueLedgerVersion = lcl.ledgerVersion;
+        for (auto const& [accountID, accountState] : mAccountStates)
+        {
+            if (accountState.mTransaction)
+            {
+                mNominationQueue->add(accountState.mTransaction->mTx,
+                                      lcl.ledgerVersion);
+            }
+        }
+    }
+    else
+    {
+        // The tx set size may be upgraded at any ledger
+        mNominationLaneConfig->updateGenericLaneLimit(maxOps);
+    }
+
+    int64_t const startingSeq = getStartingSequenceNumber(lcl.ledgerSeq + 1);
+    std::vector<bool> hadTxNotFittingLane;
+    return mNominationQueue->getTopTxsWithinLimits(
+        [startingSeq](TransactionFrameBasePtr const& tx) {
+            return tx->getSeqNum() == startingSeq;
+        },
+        hadTxNotFittingLane, lcl.ledgerVersion);
+}
+
 size_t
 ClassicTransactionQueue::getMaxQueueSizeOps() const
 {
@@ -107,9 +107,10 @@ class TransactionQueue
      * - mTotalFees: the sum of feeBid() over every transaction for which this
      *   account is the fee-source (this may include transactions that are not
      *   in mTransactions)
-     * - mAge: the number of ledgers that have closed since the last ledger in
-     *   which a transaction in mTransactions was included. This is always 0 if
-     *   mTransactions is empty
+     * - mAgeOrigin: the value of mShifts when the age of the account, the
+     *   number of ledgers that have closed since the last ledger in which a
+     *   transaction in mTransactions was included, was last 0. The age is
+     *   mShifts - mAgeOrigin, and always 0 if mTransactions is empty
      * - mTransactions: the list of transactions for which this account is the
      *   sequence-number-source, ordered by sequence number
      */
@@ -125,7 +126,7 @@ class TransactionQueue
     struct AccountState
     {
         int64_t mTotalFees{0};
-        uint32_t mAge{0};
+        uint64_t mAgeOrigin{0};
         std::optional<TimestampedTx> mTransaction;
     };
 
@@ -166,7 +167,13 @@ class TransactionQueue
     virtual size_t getMaxQueueSizeOps() const = 0;
 
 #ifdef BUILD_TESTS
-    AccountState
+    struct AccountInfo
+    {
+        int64_t mTotalFees{0};
+        uint32_t mAge{0};
+        std::optional<TimestampedTx> mTransaction;
+    };
+    AccountInfo
     getAccountTransactionQueueInfo(AccountID const& accountID) const;
     size_t countBanned(int index) const;
 #endif
@@ -193,6 +200,15 @@ class TransactionQueue
     AccountStates mAccountStates;
     BannedTransactions mBannedTransactions;
 
+    // Number of times the queue was shifted
+    uint64_t mShifts{0};
+    // The accounts with a transaction by age, mAccountsByAge[i] holding those
+    // of age i, so that shift only visits the accounts whose transaction
+    // expires
+    std::deque<UnorderedSet<AccountID>> mAccountsByAge;
+
+    uint32_t getAge(AccountState const& as) const;
+
     // counters
     struct QueueMetrics
     {
@@ -201,7 +217,9 @@ class TransactionQueue
                      medida::Counter& transactionsDelayAccumulator,
                      medida::Counter& transactionsDelayCounter,
                      medida::Counter& transactionsSelfDelayAccumulator,
-                     medida::Counter& transactionsSelfDelayCounter)
+                     medida::Counter& transactionsSelfDelayCounter,
+                     medida::Timer& removeAppliedTimer,
+                     medida::Timer& shiftTimer)
             : mSizeByAge(std::move(sizeByAge))
             , mBannedTransactionsCounter(bannedTransactionsCounter)
             , mTransactionsDelayAccumulator(transactionsDelayAccumulator)
@@ -209,6 +227,8 @@ class TransactionQueue
                   transactionsSelfDelayAccumulator)
             , mTransactionsDelayCounter(transactionsDelayCounter)
             , mTransactionsSelfDelayCounter(transactionsSelfDelayCounter)
+            , mRemoveAppliedTimer(removeAppliedTimer)
+            , mShiftTimer(shiftTimer)
         {
         }
         std::vector<medida::Counter*> mSizeByAge;
@@ -221,6 +241,11 @@ class TransactionQueue
         // Count of transactions delay events
         medida::Counter& mTransactionsDelayCounter;
         medida::Counter& mTransactionsSelfDelayCounter;
+
+        // Time spent removing the applied transactions and shifting the queue
+        // after a ledger closes
+        medida::Timer& mRemoveAppliedTimer;
+        medida::Timer& mShiftTimer;
     };
 
     std::unique_ptr<QueueMetrics> mQueueMetrics;
@@ -230,6 +255,8 @@ class TransactionQueue
     bool mShutdown{false};
     bool mWaiting{false};
     VirtualTimer mBroadcastTimer;
+    // When the queue was last shifted, i.e. when the last ledger closed
+    VirtualClock::time_point mLastShiftTime;
 
     virtual std::pair<Resource, std::optional<Resource>>
     getMaxResourcesToFloodThisPeriod() const = 0;
@@ -237,6 +264,11 @@ class TransactionQueue
     virtual int getFloodPeriod() const = 0;
     virtual bool allowTxBroadcast(TimestampedTx const& tx) = 0;
 
+    // Part of backlog to flood this period so that it is flooded evenly
+    // over the rest of the ledger, all of it once the ledger is expected
+    // to close within a period
+    Resource getPacedFloodBudget(Resource const& backlog) const;
+
     void broadcast(bool fromCallback);
     // broadcasts a single transaction
     enum class BroadcastStatus
@@ -263,6 +295,9 @@ class TransactionQueue
     void prepareDropTransaction(AccountState& as);
     void dropTransaction(AccountStates::iterator stateIter);
 
+    void addToNominationQueue(TransactionFrameBasePtr const& tx);
+    void removeFromNominationQueue(TransactionFrameBasePtr const& tx);
+
     bool isFiltered(TransactionFrameBasePtr tx) const;
 
     std::unique_ptr<TxQueueLimiter> mTxQueueLimiter;
@@ -272,6 +307,16 @@ class TransactionQueue
 
     size_t mBroadcastSeed;
 
+    // Highest fee rate first copy of the queue that is kept up to date as
+    // transactions are added and dropped, so that nomination only has to
+    // walk it instead of sorting every queued transaction. It is only built
+    // by the queues that nominate from it (see
+    // `ClassicTransactionQueue::getNominationCandidates`) and is discarded
+    // whenever the ledger version changes, as resource counts depend on it.
+    std::unique_ptr<SurgePricingPriorityQueue> mNominationQueue;
+    std::shared_ptr<SurgePricingLaneConfig> mNominationLaneConfig;
+    uint32_t mNominationQueueLedgerVersion{0};
+
 #ifdef BUILD_TESTS
   public:
     size_t getQueueSizeOps() const;
@@ -338,6 +383,14 @@ class ClassicTransactionQueue : public TransactionQueue
 
     size_t getMaxQueueSizeOps() const override;
 
+    // Returns the transactions `getTransactions` would return that can make
+    // it into the classic phase of the next tx set, i.e. the top ones by fee
+    // rate within the tx set limits. Transactions that don't fit are left
+    // out, except the first one that doesn't fit each lane, which is kept so
+    // that surge pricing the result yields the same lane base fees as surge
+    // pricing all of `getTransactions`.
+    TxFrameList getNominationCandidates(LedgerHeader const& lcl);
+
   private:
     medida::Counter& mArbTxSeenCounter;
     medida::Counter& mArbTxDroppedCounter;
@@ -5,9 +5,13 @@
 #include "util/asio.h"
 #include "TxSetFrame.h"
 #include "TxSetUtils.h"
+#include "bucket/BucketManager.h"
+#include "bucket/BucketSnapshotManager.h"
+#include "bucket/SearchableBucketList.h"
 #include "crypto/Hex.h"
 #include "crypto/Random.h"
 #include "crypto/SHA.h"
+#include "crypto/SecretKey.h"
 #include "database/Database.h"
 #include "herder/ParallelTxSetBuilder.h"
 #include "herder/SurgePricingUtils.h"
@@ -26,6 +30,8 @@
 
 #include <Tracy.hpp>
 #include <algorithm>
+#include <atomic>
+#include <future>
 #include <list>
 #include <numeric>
 #include <variant>
@@ -35,6 +41,19 @@ namespace stellar
 
 namespace
 {
+// Transaction set validation is only split across threads when every thread
+// gets at least this many transactions to check.
+size_t const MIN_TXS_PER_VALIDATION_THREAD = 32;
+
+void
+logInvalidTx(TransactionFrameBase const& tx,
+             MutableTransactionResultBase const& txResult)
+{
+    CLOG_DEBUG(Herder, "Got bad txSet: tx invalid tx: {} result: {}",
+               xdrToCerealString(tx.getEnvelope(), "TransactionEnvelope"),
+               txResult.getResultCode());
+}
+
 std::string
 getTxSetPhaseName(TxSetPhase phase)
 {
@@ -178,34 +197,50 @@ validateTxSetXDRStructure(GeneralizedTransactionSet const& txSet)
 
 // We want to XOR the tx hash with the set hash.
 // This way people can't predict the order that txs will be applied in
-struct ApplyTxSorter
+Hash
+applyOrderKey(TransactionFrameBasePtr const& tx, Hash const& txSetHash)
 {
-    Hash mSetHash;
-    ApplyTxSorter(Hash h) : mSetHash{std::move(h)}
+    // need to use the hash of whole tx here since multiple txs could
+    // have the same Contents
+    Hash key = tx->getFullHash();
+    for (size_t i = 0; i < key.size(); ++i)
     {
+        key[i] ^= txSetHash[i];
     }
+    return key;
+}
 
-    bool
-    operator()(TransactionFrameBasePtr const& tx1,
-               TransactionFrameBasePtr const& tx2) const
+// Sorts txs by applyOrderKey, computing the key of every tx only once
+void
+sortForApply(TxFrameList& txs, Hash const& txSetHash)
+{
+    std::vector<std::pair<Hash, TransactionFrameBasePtr>> keyed;
+    keyed.reserve(txs.size());
+    for (auto& tx : txs)
+    {
+        auto key = applyOrderKey(tx, txSetHash);
+        keyed.emplace_back(key, std::move(tx));
+    }
+    std::sort(keyed.begin(), keyed.end(),
+              [](auto const& a, auto const& b) { return a.first < b.first; });
+    for (size_t i = 0; i < keyed.size(); ++i)
     {
-        // need to use the hash of whole tx here since multiple txs could
-        // have the same Contents
-        return lessThanXored(tx1->getFullHash(), tx2->getFullHash(), mSetHash);
+        txs[i] = std::move(keyed[i].second);
     }
-};
+}
 
 Hash
 computeNonGeneralizedTxSetContentsHash(TransactionSet const& xdrTxSet)
 {
     ZoneScoped;
-    SHA256 hasher;
-    hasher.add(xdrTxSet.previousLedgerHash);
+    XDRSHA256 hasher;
+    xdr::archive(hasher, xdrTxSet.previousLedgerHash);
     for (auto const& tx : xdrTxSet.txs)
     {
-        hasher.add(xdr::xdr_to_opaque(tx));
+        xdr::archive(hasher, tx);
     }
-    return hasher.finish();
+    hasher.flush();
+    return hasher.state.finish();
 }
 
 // Note: Soroban txs also use this functionality for simplicity, as it's a
@@ -373,8 +408,7 @@ sortedForApplySequential(TxFrameList const& txs, Hash const& txSetHash)
     {
         // randomize each batch using the hash of the transaction set
         // as a way to randomize even more
-        ApplyTxSorter s(txSetHash);
-        std::sort(batch.begin(), batch.end(), s);
+        sortForApply(batch, txSetHash);
         for (auto const& tx : batch)
         {
             retList.push_back(tx);
@@ -388,24 +422,29 @@ TxStageFrameList
 sortedForApplyParallel(TxStageFrameList const& stages, Hash const& txSetHash)
 {
     ZoneScoped;
-    TxStageFrameList sortedStages = stages;
-    ApplyTxSorter sorter(txSetHash);
-    for (auto& stage : sortedStages)
+    std::vector<std::pair<Hash, TxStageFrame>> keyedStages;
+    keyedStages.reserve(stages.size());
+    for (auto stage : stages)
     {
         for (auto& cluster : stage)
         {
-            std::sort(cluster.begin(), cluster.end(), sorter);
+            sortForApply(cluster, txSetHash);
         }
         // There is no need to shuffle clusters in the stage, as they are
         // independent, so the apply order doesn't matter even if the clusters
         // are being applied sequentially.
+        releaseAssert(!stage.empty() && !stage.front().empty());
+        auto key = applyOrderKey(stage.front().front(), txSetHash);
+        keyedStages.emplace_back(key, std::move(stage));
+    }
+    std::sort(keyedStages.begin(), keyedStages.end(),
+              [](auto const& a, auto const& b) { return a.first < b.first; });
+    TxStageFrameList sortedStages;
+    sortedStages.reserve(keyedStages.size());
+    for (auto& [key, stage] : keyedStages)
+    {
+        sortedStages.emplace_back(std::move(stage));
     }
-    std::sort(sortedStages.begin(), sortedStages.end(),
-              [&sorter](auto const& a, auto const& b) {
-                  releaseAssert(!a.empty() && !b.empty());
-                  releaseAssert(!a.front().empty() && !b.front().empty());
-                  return sorter(a.front().front(), b.front().front());
-              });
     return sortedStages;
 }
 
@@ -752,17 +791,18 @@ checkFeeMap(InclusionFeeMap const& feeMap, LedgerHeader const& lclHeader)
 
 } // namespace
 
-TxSetXDRFrame::TxSetXDRFrame(TransactionSet const& xdrTxSet)
+TxSetXDRFrame::TxSetXDRFrame(std::shared_ptr<TransactionSet const> xdrTxSet)
     : mXDRTxSet(xdrTxSet)
-    , mEncodedSize(xdr::xdr_argpack_size(xdrTxSet))
-    , mHash(computeNonGeneralizedTxSetContentsHash(xdrTxSet))
+    , mEncodedSize(xdr::xdr_argpack_size(*xdrTxSet))
+    , mHash(computeNonGeneralizedTxSetContentsHash(*xdrTxSet))
 {
 }
 
-TxSetXDRFrame::TxSetXDRFrame(GeneralizedTransactionSet const& xdrTxSet)
+TxSetXDRFrame::TxSetXDRFrame(
+    std::shared_ptr<GeneralizedTransactionSet const> xdrTxSet)
     : mXDRTxSet(xdrTxSet)
-    , mEncodedSize(xdr::xdr_argpack_size(xdrTxSet))
-    , mHash(xdrSha256(xdrTxSet))
+    , mEncodedSize(xdr::xdr_argpack_size(*xdrTxSet))
+    , mHash(xdrSha256(*xdrTxSet))
 {
 }
 
@@ -770,7 +810,8 @@ TxSetXDRFrameConstPtr
 TxSetXDRFrame::makeFromWire(TransactionSet const& xdrTxSet)
 {
     ZoneScoped;
-    std::shared_ptr<TxSetXDRFrame> txSet(new TxSetXDRFrame(xdrTxSet));
+    std::shared_ptr<TxSetXDRFrame> txSet(new TxSetXDRFrame(
+        std::make_shared<TransactionSet const>(xdrTxSet)));
     return txSet;
 }
 
@@ -778,10 +819,44 @@ TxSetXDRFrameConstPtr
 TxSetXDRFrame::makeFromWire(GeneralizedTransactionSet const& xdrTxSet)
 {
     ZoneScoped;
-    std::shared_ptr<TxSetXDRFrame> txSet(new TxSetXDRFrame(xdrTxSet));
+    std::shared_ptr<TxSetXDRFrame> txSet(new TxSetXDRFrame(
+        std::make_shared<GeneralizedTransactionSet const>(xdrTxSet)));
     return txSet;
 }
 
+TxSetXDRFrameConstPtr
+TxSetXDRFrame::makeFromWire(std::shared_ptr<StellarMessage const> const& msg)
+{
+    ZoneScoped;
+    std::shared_ptr<TxSetXDRFrame> txSet;
+    // The aliasing constructor keeps the whole message alive
+    if (msg->type() == GENERALIZED_TX_SET)
+    {
+        txSet.reset(
+            new TxSetXDRFrame(std::shared_ptr<GeneralizedTransactionSet const>(
+                msg, &msg->generalizedTxSet())));
+    }
+    else
+    {
+        txSet.reset(new TxSetXDRFrame(
+            std::shared_ptr<TransactionSet const>(msg, &msg->txSet())));
+    }
+    return txSet;
+}
+
+TransactionSet const&
+TxSetXDRFrame::legacyXDR() const
+{
+    return *std::get<std::shared_ptr<TransactionSet const>>(mXDRTxSet);
+}
+
+GeneralizedTransactionSet const&
+TxSetXDRFrame::generalizedXDR() const
+{
+    return *std::get<std::shared_ptr<GeneralizedTransactionSet const>>(
+        mXDRTxSet);
+}
+
 TxSetXDRFrameConstPtr
 TxSetXDRFrame::makeFromStoredTxSet(StoredTransactionSet const& storedSet)
 {
@@ -1095,7 +1170,7 @@ TxSetXDRFrame::prepareForApply(Application& app,
     std::vector<TxSetPhaseFrame> phaseFrames;
     if (isGeneralizedTxSet())
     {
-        auto const& xdrTxSet = std::get<GeneralizedTransactionSet>(mXDRTxSet);
+        auto const& xdrTxSet = generalizedXDR();
         if (!validateTxSetXDRStructure(xdrTxSet))
         {
             CLOG_DEBUG(Herder,
@@ -1118,7 +1193,7 @@ TxSetXDRFrame::prepareForApply(Application& app,
     }
     else
     {
-        auto const& xdrTxSet = std::get<TransactionSet>(mXDRTxSet);
+        auto const& xdrTxSet = legacyXDR();
         auto maybePhase = TxSetPhaseFrame::makeFromWireLegacy(
             lclHeader, app.getNetworkID(), xdrTxSet.txs);
         if (!maybePhase)
@@ -1134,7 +1209,8 @@ TxSetXDRFrame::prepareForApply(Application& app,
 bool
 TxSetXDRFrame::isGeneralizedTxSet() const
 {
-    return std::holds_alternative<GeneralizedTransactionSet>(mXDRTxSet);
+    return std::holds_alternative<
+        std::shared_ptr<GeneralizedTransactionSet const>>(mXDRTxSet);
 }
 
 Hash const&
@@ -1148,11 +1224,9 @@ TxSetXDRFrame::previousLedgerHash() const
 {
     if (isGeneralizedTxSet())
     {
-        return std::get<GeneralizedTransactionSet>(mXDRTxSet)
-            .v1TxSet()
-            .previousLedgerHash;
+        return generalizedXDR().v1TxSet().previousLedgerHash;
     }
-    return std::get<TransactionSet>(mXDRTxSet).previousLedgerHash;
+    return legacyXDR().previousLedgerHash;
 }
 
 size_t
@@ -1160,8 +1234,7 @@ TxSetXDRFrame::sizeTxTotal() const
 {
     if (isGeneralizedTxSet())
     {
-        auto const& txSet =
-            std::get<GeneralizedTransactionSet>(mXDRTxSet).v1TxSet();
+        auto const& txSet = generalizedXDR().v1TxSet();
         size_t totalSize = 0;
         for (auto const& phase : txSet.phases)
         {
@@ -1191,7 +1264,7 @@ TxSetXDRFrame::sizeTxTotal() const
     }
     else
     {
-        return std::get<TransactionSet>(mXDRTxSet).txs.size();
+        return legacyXDR().txs.size();
     }
 }
 
@@ -1218,8 +1291,7 @@ TxSetXDRFrame::sizeOpTotalForLogging() const
     };
     if (isGeneralizedTxSet())
     {
-        auto const& txSet =
-            std::get<GeneralizedTransactionSet>(mXDRTxSet).v1TxSet();
+        auto const& txSet = generalizedXDR().v1TxSet();
         size_t totalSize = 0;
         for (auto const& phase : txSet.phases)
         {
@@ -1254,7 +1326,7 @@ TxSetXDRFrame::sizeOpTotalForLogging() const
     }
     else
     {
-        auto const& txs = std::get<TransactionSet>(mXDRTxSet).txs;
+        auto const& txs = legacyXDR().txs;
         return std::accumulate(txs.begin(), txs.end(), 0ull, accumulateTxsFn);
     }
 }
@@ -1265,8 +1337,7 @@ TxSetXDRFrame::createTransactionFrames(Hash const& networkID) const
     PerPhaseTransactionList phaseTxs;
     if (isGeneralizedTxSet())
     {
-        auto const& txSet =
-            std::get<GeneralizedTransactionSet>(mXDRTxSet).v1TxSet();
+        auto const& txSet = generalizedXDR().v1TxSet();
         for (auto const& phase : txSet.phases)
         {
             auto& txs = phaseTxs.emplace_back();
@@ -1306,7 +1377,7 @@ TxSetXDRFrame::createTransactionFrames(Hash const& networkID) const
     else
     {
         auto& txs = phaseTxs.emplace_back();
-        auto const& txSet = std::get<TransactionSet>(mXDRTxSet).txs;
+        auto const& txSet = legacyXDR().txs;
         for (auto const& tx : txSet)
         {
             txs.emplace_back(
@@ -1326,14 +1397,14 @@ void
 TxSetXDRFrame::toXDR(TransactionSet& txSet) const
 {
     releaseAssert(!isGeneralizedTxSet());
-    txSet = std::get<TransactionSet>(mXDRTxSet);
+    txSet = legacyXDR();
 }
 
 void
 TxSetXDRFrame::toXDR(GeneralizedTransactionSet& txSet) const
 {
     releaseAssert(isGeneralizedTxSet());
-    txSet = std::get<GeneralizedTransactionSet>(mXDRTxSet);
+    txSet = generalizedXDR();
 }
 
 void
@@ -1342,13 +1413,12 @@ TxSetXDRFrame::storeXDR(StoredTransactionSet& txSet) const
     if (isGeneralizedTxSet())
     {
         txSet.v(1);
-        txSet.generalizedTxSet() =
-            std::get<GeneralizedTransactionSet>(mXDRTxSet);
+        txSet.generalizedTxSet() = generalizedXDR();
     }
     else
     {
         txSet.v(0);
-        txSet.txSet() = std::get<TransactionSet>(mXDRTxSet);
+        txSet.txSet() = legacyXDR();
     }
 }
 
@@ -1951,15 +2021,67 @@ TxSetPhaseFrame::txsAreValid(Application& app,
                              uint64_t upperBoundCloseTimeOffset) const
 {
     ZoneScoped;
+    auto const lclSeq = app.getLedgerManager().getLastClosedLedgerNum();
+
+    // Every transaction has its own source account and is checked against the
+    // LCL state only, so transactions can be checked in any order. Classic
+    // validation only reads the snapshot it is given, which lets large
+    // classic phases be split across threads. Soroban validation reads the
+    // network config, which is only available on the main thread.
+    size_t const numThreads = std::min<size_t>(
+        app.getConfig().TX_SET_VALIDATION_THREADS,
+        sizeTx() / MIN_TXS_PER_VALIDATION_THREAD);
+    bool parallel = numThreads > 1 && mPhase == TxSetPhase::CLASSIC;
+#ifdef BUILD_TESTS
+    parallel = parallel && !app.getConfig().MODE_USES_IN_MEMORY_LEDGER;
+#endif
+    if (parallel)
+    {
+        // Bucket list snapshots are not thread-safe, so every thread gets its
+        // own. They must all show the LCL state, otherwise validate serially.
+        std::vector<SearchableSnapshotConstPtr> snapshots;
+        auto& snapshotManager =
+            app.getBucketManager().getBucketSnapshotManager();
+        for (size_t t = 0; t < numThreads; ++t)
+        {
+            snapshots.emplace_back(
+                snapshotManager.copySearchableLiveBucketListSnapshot());
+            if (snapshots.back()->getLedgerSeq() != lclSeq)
+            {
+                snapshots.clear();
+                break;
+            }
+        }
+        if (!snapshots.empty())
+        {
+            return txsAreValidInParallel(app, snapshots,
+                                         lowerBoundCloseTimeOffset,
+                                         upperBoundCloseTimeOffset);
+        }
+    }
+
     // This is done so minSeqLedgerGap is validated against the next
     // ledgerSeq, which is what will be used at apply time
 
     // Grab read-only latest ledger state; This is only used to validate tx sets
     // for LCL+1
     LedgerSnapshot ls(app);
-    ls.getLedgerHeader().currentToModify().ledgerSeq =
-        app.getLedgerManager().getLastClosedLedgerNum() + 1;
+    ls.getLedgerHeader().currentToModify().ledgerSeq = lclSeq + 1;
     auto diagnostics = DiagnosticEventManager::createDisabled();
+
+    // Verify the signatures the transactions are most likely checked against
+    // in one batch, so that checkValid finds them in the signature cache. Any
+    // invalid signature is reported by checkValid as usual.
+    {
+        std::vector<PubKeyUtils::SignatureToVerify> sigs;
+        for (auto const& tx : *this)
+        {
+            tx->insertSignaturesToVerify(sigs, /* forApply */ false);
+        }
+        PubKeyUtils::verifySigs(
+            sigs, 1 + app.getConfig().CLASSIC_SIGNATURE_PREVERIFY_THREADS);
+    }
+
     for (auto const& tx : *this)
     {
         auto txResult = tx->checkValid(app.getAppConnector(), ls, 0,
@@ -1967,17 +2089,94 @@ TxSetPhaseFrame::txsAreValid(Application& app,
                                        upperBoundCloseTimeOffset, diagnostics);
         if (!txResult->isSuccess())
         {
-
-            CLOG_DEBUG(
-                Herder, "Got bad txSet: tx invalid tx: {} result: {}",
-                xdrToCerealString(tx->getEnvelope(), "TransactionEnvelope"),
-                txResult->getResultCode());
+            logInvalidTx(*tx, *txResult);
             return false;
         }
     }
     return true;
 }
 
+bool
+TxSetPhaseFrame::txsAreValidInParallel(
+    Application& app, std::vector<SearchableSnapshotConstPtr> const& snapshots,
+    uint64_t lowerBoundCloseTimeOffset,
+    uint64_t upperBoundCloseTimeOffset) const
+{
+    ZoneScoped;
+    std::vector<TransactionFrameBasePtr> txs(begin(), end());
+    auto const ledgerSeq = app.getLedgerManager().getLastClosedLedgerNum() + 1;
+    auto& appConnector = app.getAppConnector();
+
+    // Threads claim transactions through next and stop once any of them
+    // finds an invalid one. Each keeps the first invalid transaction it saw,
+    // and the one earliest in the phase is logged.
+    std::atomic<size_t> next{0};
+    std::atomic<bool> foundInvalid{false};
+    std::vector<std::pair<size_t, MutableTxResultPtr>> invalid(
+        snapshots.size(), {txs.size(), nullptr});
+    auto worker = [&](size_t t) {
+        ZoneScopedN("tx set validation worker");
+        LedgerSnapshot ls(snapshots[t]);
+        ls.getLedgerHeader().currentToModify().ledgerSeq = ledgerSeq;
+        auto diagnostics = DiagnosticEventManager::createDisabled();
+        for (size_t i = next++; i < txs.size() && !foundInvalid; i = next++)
+        {
+            auto txResult = txs[i]->checkValid(
+                appConnector, ls, 0, lowerBoundCloseTimeOffset,
+                upperBoundCloseTimeOffset, diagnostics);
+            if (!txResult->isSuccess())
+            {
+                invalid[t] = {i, txResult};
+                foundInvalid = true;
+                return;
+            }
+        }
+    };
+
+    std::vector<std::future<void>> futures;
+    for (size_t t = 1; t < snapshots.size(); ++t)
+    {
+        futures.emplace_back(std::async(std::launch::async, worker, t));
+    }
+    std::exception_ptr error;
+    try
+    {
+        worker(0);
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+    for (auto& f : futures)
+    {
+        try
+        {
+            f.get();
+        }
+        catch (...)
+        {
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+        }
+    }
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+
+    auto first = std::min_element(
+        invalid.begin(), invalid.end(),
+        [](auto const& a, auto const& b) { return a.first < b.first; });
+    if (first->second)
+    {
+        logInvalidTx(*txs[first->first], *first->second);
+        return false;
+    }
+    return true;
+}
+
 std::optional<Resource>
 TxSetPhaseFrame::getTotalResources(uint32_t ledgerVersion) const
 {
@@ -2071,9 +2270,16 @@ ApplicableTxSetFrame::checkValid(Application& app,
                                  uint64_t upperBoundCloseTimeOffset) const
 {
     // For public-facing methods, always do full validation
-    return checkValidInternal(app, lowerBoundCloseTimeOffset,
-                              upperBoundCloseTimeOffset,
-                              /* txsAreValidated */ false);
+    if (!checkValidInternal(app, lowerBoundCloseTimeOffset,
+                            upperBoundCloseTimeOffset,
+                            /* txsAreValidated */ false))
+    {
+        return false;
+    }
+    // Valid sets are kept around to be applied, sort them now so that
+    // applying one doesn't have to
+    getPhasesInApplyOrder();
+    return true;
 }
 
 // need to make sure every account that is submitting a tx has enough to pay
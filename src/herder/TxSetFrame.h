@@ -125,6 +125,10 @@ class TxSetXDRFrame : public NonMovableOrCopyable
     static TxSetXDRFrameConstPtr makeFromWire(TransactionSet const& xdrTxSet);
     static TxSetXDRFrameConstPtr
     makeFromWire(GeneralizedTransactionSet const& xdrTxSet);
+    // Creates a TxSetXDRFrame from a TX_SET or GENERALIZED_TX_SET message,
+    // sharing ownership of the message instead of copying the set out of it.
+    static TxSetXDRFrameConstPtr
+    makeFromWire(std::shared_ptr<StellarMessage const> const& msg);
 
     static TxSetXDRFrameConstPtr
     makeFromStoredTxSet(StoredTransactionSet const& storedSet);
@@ -196,10 +200,16 @@ class TxSetXDRFrame : public NonMovableOrCopyable
 #endif
 
   private:
-    TxSetXDRFrame(TransactionSet const& xdrTxSet);
-    TxSetXDRFrame(GeneralizedTransactionSet const& xdrTxSet);
+    TxSetXDRFrame(std::shared_ptr<TransactionSet const> xdrTxSet);
+    TxSetXDRFrame(std::shared_ptr<GeneralizedTransactionSet const> xdrTxSet);
+
+    TransactionSet const& legacyXDR() const;
+    GeneralizedTransactionSet const& generalizedXDR() const;
 
-    std::variant<TransactionSet, GeneralizedTransactionSet> mXDRTxSet;
+    // Possibly pointing into the message the set was received in
+    std::variant<std::shared_ptr<TransactionSet const>,
+                 std::shared_ptr<GeneralizedTransactionSet const>>
+        mXDRTxSet;
     size_t mEncodedSize{};
     Hash mHash;
 };
@@ -362,6 +372,11 @@ class TxSetPhaseFrame
 
     bool txsAreValid(Application& app, uint64_t lowerBoundCloseTimeOffset,
                      uint64_t upperBoundCloseTimeOffset) const;
+    bool txsAreValidInParallel(
+        Application& app,
+        std::vector<SearchableSnapshotConstPtr> const& snapshots,
+        uint64_t lowerBoundCloseTimeOffset,
+        uint64_t upperBoundCloseTimeOffset) const;
 
     TxSetPhase mPhase;
 
@@ -519,8 +534,8 @@ class ApplicableTxSetFrame
 
     // The phases with transactions sorted for apply.
     //
-    // This is `mutable` because we want to do the sorting lazily only for the
-    // transaction sets that are actually applied.
+    // This is `mutable` because the sorting is done lazily, either once the
+    // set is found valid or when it is applied.
     mutable std::vector<TxSetPhaseFrame> mApplyOrderPhases;
 
     std::optional<Hash> mContentsHash;
@@ -1305,7 +1305,7 @@ bool
 ConfigUpgradeSetFrame::isValidXDR(ConfigUpgradeSet const& upgradeSetXDR,
                                   ConfigUpgradeSetKey const& key) const
 {
-    if (key.contentHash != sha256(xdr::xdr_to_opaque(upgradeSetXDR)))
+    if (key.contentHash != xdrSha256(upgradeSetXDR))
     {
         CLOG_DEBUG(Herder,
                    "Got bad configUpgradeSet. Does not match hash in key {}",
@@ -4,6 +4,7 @@
 
 #include "bucket/BucketIndexUtils.h"
 #include "herder/HerderImpl.h"
+#include "herder/HerderPersistence.h"
 #include "herder/LedgerCloseData.h"
 #include "herder/test/TestTxSetUtils.h"
 #include "main/Application.h"
@@ -23,6 +24,7 @@
 #include "crypto/SHA.h"
 #include "database/Database.h"
 #include "herder/HerderUtils.h"
+#include "history/HistoryManager.h"
 #include "ledger/LedgerHeaderUtils.h"
 #include "ledger/LedgerManager.h"
 #include "ledger/LedgerTxn.h"
@@ -50,6 +52,8 @@
 #include <algorithm>
 #include <cmath>
 #include <fmt/format.h>
+#include <medida/metrics_registry.h>
+#include <medida/timer.h>
 #include <memory>
 #include <numeric>
 #include <optional>
@@ -2256,12 +2260,25 @@ testSCPDriver(uint32 protocolVersion, uint32_t maxTxSetSize, size_t expectedOps)
         REQUIRE(cache.getCounters().mHits == 0);
         REQUIRE(cache.getCounters().mMisses == 0);
 
+        auto prevLcl = lcl;
         // Triggering next ledger will construct and cache the block
         herder.triggerNextLedger(seq, true);
         // All hits during the whole SCP round
         REQUIRE(cache.getCounters().mHits == 8);
         // One miss from the initial makeTxSetFromTransactions
         REQUIRE(cache.getCounters().mMisses == 1);
+
+        // The frame the externalized tx set was validated with is kept for
+        // reuse, and looking it up doesn't count as a cache access
+        REQUIRE(lcl.header.ledgerSeq == seq);
+        auto const& sv = lcl.header.scpValue;
+        auto validated = herder.getHerderSCPDriver().getValidatedTxSet(
+            sv.txSetHash, prevLcl,
+            sv.closeTime - prevLcl.header.scpValue.closeTime);
+        REQUIRE(validated);
+        REQUIRE(validated->getContentsHash() == sv.txSetHash);
+        REQUIRE(cache.getCounters().mHits == 8);
+        REQUIRE(cache.getCounters().mMisses == 1);
     }
     SECTION("accept qset and txset")
     {
@@ -2844,6 +2861,17 @@ TEST_CASE("SCP checkpoint", "[catchup][herder]")
         REQUIRE(herder.getSCP().getKnownSlotsCount() ==
                 mainNode->getConfig().MAX_SLOTS_TO_REMEMBER + 1);
 
+        // The overlay thread drops envelopes for the same slots
+        auto lcl = mainNode->getLedgerManager().getLastClosedLedgerNum();
+        auto minSlot = lcl - mainNode->getConfig().MAX_SLOTS_TO_REMEMBER + 1;
+        auto checkpoint = HistoryManager::firstLedgerInCheckpointContaining(
+            lcl, mainNode->getConfig());
+        REQUIRE(herder.isSCPSlotAboveMinimum(lcl + 1));
+        REQUIRE(herder.isSCPSlotAboveMinimum(minSlot));
+        REQUIRE(herder.isSCPSlotAboveMinimum(checkpoint));
+        REQUIRE(herder.isSCPSlotAboveMinimum(minSlot - 1) ==
+                (minSlot - 1 == checkpoint));
+
         auto secondCheckpoint =
             HistoryManager::firstLedgerAfterCheckpointContaining(
                 firstCheckpoint, mainNode->getConfig());
@@ -3278,6 +3306,19 @@ TEST_CASE("overlay parallel processing", "[herder][parallel]")
             });
     }
 
+    SECTION("background transaction prevalidation")
+    {
+        simulation =
+            Topologies::core(4, 1, Simulation::OVER_TCP, networkID, [](int i) {
+                auto cfg = getTestConfig(i);
+                cfg.TESTING_UPGRADE_MAX_TX_SET_SIZE = 100;
+                cfg.EXPERIMENTAL_BACKGROUND_TX_SIG_VERIFICATION = true;
+                cfg.EXPERIMENTAL_BACKGROUND_TX_PREVALIDATION = true;
+                cfg.GENESIS_TEST_ACCOUNT_COUNT = 100;
+                return cfg;
+            });
+    }
+
 // Background ledger close requires postgres
 #ifdef USE_POSTGRES
     SECTION("background ledger close")
@@ -4958,6 +4999,85 @@ TEST_CASE("do not flood too many transactions", "[herder][transactionqueue]")
     }
 }
 
+TEST_CASE("flood pacing spreads transactions over the ledger",
+          "[herder][transactionqueue]")
+{
+    auto networkID = sha256(getTestConfig().NETWORK_PASSPHRASE);
+    auto simulation = std::make_shared<Simulation>(
+        Simulation::OVER_LOOPBACK, networkID, [&](int i) {
+            auto cfg = getTestConfig(i);
+            cfg.TESTING_UPGRADE_MAX_TX_SET_SIZE = 500;
+            cfg.NODE_IS_VALIDATOR = false;
+            cfg.FORCE_SCP = false;
+            cfg.FLOOD_TX_PERIOD_MS = 100;
+            cfg.FLOOD_OP_RATE_PER_LEDGER = 2.0;
+            cfg.FLOOD_TX_PACING = true;
+            cfg.GENESIS_TEST_ACCOUNT_COUNT =
+                cfg.TESTING_UPGRADE_MAX_TX_SET_SIZE;
+            return cfg;
+        });
+
+    auto mainKey = SecretKey::fromSeed(sha256("main"));
+    auto otherKey = SecretKey::fromSeed(sha256("other"));
+
+    SCPQuorumSet qset;
+    qset.threshold = 1;
+    qset.validators.push_back(mainKey.getPublicKey());
+
+    simulation->addNode(mainKey, qset);
+    simulation->addNode(otherKey, qset);
+
+    simulation->addPendingConnection(mainKey.getPublicKey(),
+                                     otherKey.getPublicKey());
+    simulation->startAllNodes();
+    simulation->crankForAtLeast(std::chrono::seconds(1), false);
+
+    auto app = simulation->getNode(mainKey.getPublicKey());
+    auto const& cfg = app->getConfig();
+    auto& lm = app->getLedgerManager();
+    auto& herder = static_cast<HerderImpl&>(app->getHerder());
+    auto& tq = herder.getTransactionQueue();
+
+    size_t const numTx = cfg.TESTING_UPGRADE_MAX_TX_SET_SIZE;
+    std::vector<TransactionFrameBasePtr> txs;
+    for (size_t i = 0; i < numTx; ++i)
+    {
+        auto account = txtest::getGenesisAccount(*app, static_cast<int>(i));
+        auto tx = account.tx({payment(account, 1)});
+        REQUIRE(herder.recvTransaction(tx, false).code ==
+                TransactionQueue::AddResultCode::ADD_STATUS_PENDING);
+        txs.emplace_back(tx);
+    }
+
+    size_t numBroadcast = 0;
+    tq.mTxBroadcastedEvent = [&](TransactionFrameBasePtr&) {
+        ++numBroadcast;
+    };
+
+    // The ledger close starts the pacing
+    externalize(cfg.NODE_SEED, lm, herder, {txs[0], txs[1]}, *app);
+    auto const backlog = numTx - 2;
+
+    // Without pacing, 2*(maxOps=500)*(FLOOD_TX_PERIOD_MS=100)/(5*1000)=20
+    // transactions would be flooded every period, flooding the backlog in
+    // half a ledger. Paced, about backlog*100/5000=10 are.
+    auto broadcastPeriod = std::chrono::milliseconds(cfg.FLOOD_TX_PERIOD_MS);
+    simulation->crankForAtLeast(broadcastPeriod + std::chrono::milliseconds(1),
+                                false);
+    REQUIRE(numBroadcast > 0);
+    REQUIRE(numBroadcast < 20);
+
+    // Half a ledger in, about half of the backlog is flooded
+    simulation->crankForAtLeast(std::chrono::milliseconds(2400), false);
+    REQUIRE(numBroadcast > backlog / 4);
+    REQUIRE(numBroadcast < backlog * 3 / 4);
+
+    // All of it is flooded by the time the next ledger is expected
+    simulation->crankForAtLeast(std::chrono::milliseconds(3000), false);
+    REQUIRE(numBroadcast == backlog);
+    simulation->stopAllNodes();
+}
+
 TEST_CASE("do not flood too many transactions with DEX separation",
           "[herder][transactionqueue]")
 {
@@ -5677,6 +5797,65 @@ TEST_CASE("SCP message capture from previous ledger", "[herder]")
     REQUIRE(checkSCPHistoryEntries(C, 2, expectedTypes));
 }
 
+TEST_CASE("SCP history written in the background", "[herder]")
+{
+    VirtualClock clock;
+    auto cfg = getTestConfig(0, Config::TESTDB_BUCKET_DB_PERSISTENT);
+    cfg.BACKGROUND_SCP_HISTORY_WRITES = true;
+    auto app = createTestApplication(clock, cfg);
+    auto& persistence = app->getHerderPersistence();
+
+    auto qSetHash =
+        app->getHerder().getSCP().getLocalNode()->getQuorumSetHash();
+    auto makeEnvelopes = [&](uint32_t seq, size_t count) {
+        std::vector<SCPEnvelope> envs(count);
+        for (auto& env : envs)
+        {
+            env.statement.nodeID =
+                SecretKey::pseudoRandomForTesting().getPublicKey();
+            env.statement.slotIndex = seq;
+            env.statement.pledges.type(SCP_ST_NOMINATE);
+            env.statement.pledges.nominate().quorumSetHash = qSetHash;
+        }
+        return envs;
+    };
+    auto countEntries = [&](uint32_t seq) {
+        int count = 0;
+        app->getDatabase().getRawSession()
+            << "SELECT COUNT(*) FROM scphistory WHERE ledgerseq = :l",
+            soci::into(count), soci::use(seq);
+        return count;
+    };
+
+    SECTION("queued writes are applied in order")
+    {
+        persistence.saveSCPHistory(2, makeEnvelopes(2, 3),
+                                   QuorumTracker::QuorumMap());
+        persistence.saveSCPHistory(3, makeEnvelopes(3, 1),
+                                   QuorumTracker::QuorumMap());
+        // Replaces the first write for ledger 2
+        persistence.saveSCPHistory(2, makeEnvelopes(2, 2),
+                                   QuorumTracker::QuorumMap());
+        persistence.flush();
+        REQUIRE(countEntries(2) == 2);
+        REQUIRE(countEntries(3) == 1);
+        REQUIRE(app->getMetrics()
+                    .NewTimer({"scp", "history", "write"})
+                    .count() >= 1);
+    }
+
+    SECTION("last ledger of a checkpoint drains the queue")
+    {
+        auto checkpoint = HistoryManager::checkpointContainingLedger(2, cfg);
+        persistence.saveSCPHistory(2, makeEnvelopes(2, 1),
+                                   QuorumTracker::QuorumMap());
+        persistence.saveSCPHistory(checkpoint, makeEnvelopes(checkpoint, 2),
+                                   QuorumTracker::QuorumMap());
+        REQUIRE(countEntries(2) == 1);
+        REQUIRE(countEntries(checkpoint) == 2);
+    }
+}
+
 using Topology = std::pair<std::vector<SecretKey>, std::vector<ValidatorEntry>>;
 
 // Generate a Topology with a single org containing 3 validators of HIGH quality
@@ -206,6 +206,65 @@ TEST_CASE("quorum intersection basic 4-node", "[herder][quorumintersection]")
     REQUIRE(networkEnjoysQuorumIntersectionV2Wrapper(qm, cfg));
 }
 
+TEST_CASE("quorum intersection reuses enumeration of unchanged SCC",
+          "[herder][quorumintersection]")
+{
+    QuorumTracker::QuorumMap qm;
+
+    PublicKey pkA = SecretKey::pseudoRandomForTesting().getPublicKey();
+    PublicKey pkB = SecretKey::pseudoRandomForTesting().getPublicKey();
+    PublicKey pkC = SecretKey::pseudoRandomForTesting().getPublicKey();
+    PublicKey pkD = SecretKey::pseudoRandomForTesting().getPublicKey();
+    PublicKey pkE = SecretKey::pseudoRandomForTesting().getPublicKey();
+
+    qm[pkA] = QuorumTracker::NodeInfo{
+        make_shared<QS>(2, VK({pkB, pkC, pkD}), VQ{}), 0};
+    qm[pkB] = QuorumTracker::NodeInfo{
+        make_shared<QS>(2, VK({pkA, pkC, pkD}), VQ{}), 0};
+    qm[pkC] = QuorumTracker::NodeInfo{
+        make_shared<QS>(2, VK({pkA, pkB, pkD}), VQ{}), 0};
+    qm[pkD] = QuorumTracker::NodeInfo{
+        make_shared<QS>(2, VK({pkA, pkB, pkC}), VQ{}), 0};
+
+    Config cfg(getTestConfig());
+    std::atomic<bool> flag{false};
+    auto cache = std::make_shared<QuorumIntersectionCache>(16);
+    auto check = [&]() {
+        auto qic = QuorumIntersectionChecker::create(
+            qm, cfg, flag, getGlobalRandomEngine()(), false, cache);
+        return qic->networkEnjoysQuorumIntersection();
+    };
+
+    REQUIRE(check());
+    REQUIRE(cache->getCounters().mHits == 0);
+    REQUIRE(cache->getCounters().mInserts == 1);
+
+    // A watcher that nobody depends on doesn't change the SCC with quorums
+    qm[pkE] = QuorumTracker::NodeInfo{
+        make_shared<QS>(2, VK({pkA, pkB, pkC}), VQ{}), 0};
+    REQUIRE(check());
+    REQUIRE(cache->getCounters().mHits == 1);
+    REQUIRE(cache->getCounters().mInserts == 1);
+
+    // Changing a member's qset does, and the split found is reused as well
+    for (auto const& pk : {pkA, pkB, pkC, pkD})
+    {
+        auto qs = make_shared<QS>(*qm[pk].mQuorumSet);
+        qs->threshold = 1;
+        qm[pk].mQuorumSet = qs;
+    }
+    REQUIRE(!check());
+    REQUIRE(cache->getCounters().mInserts == 2);
+    auto splitHits = cache->getCounters().mHits;
+
+    auto qic = QuorumIntersectionChecker::create(
+        qm, cfg, flag, getGlobalRandomEngine()(), false, cache);
+    REQUIRE(!qic->networkEnjoysQuorumIntersection());
+    REQUIRE(cache->getCounters().mHits == splitHits + 1);
+    REQUIRE(!qic->getPotentialSplit().first.empty());
+    REQUIRE(!qic->getPotentialSplit().second.empty());
+}
+
 TEST_CASE("quorum non intersection basic 4-node",
           "[herder][quorumintersection]")
 {
@@ -1055,6 +1114,80 @@ TEST_CASE("quorum intersection 6-org 3-node fully-connected",
     REQUIRE(networkEnjoysQuorumIntersectionV2Wrapper(qm, cfg));
 }
 
+TEST_CASE("quorum intersection parallel enumeration",
+          "[herder][quorumintersection]")
+{
+    auto orgs = generateOrgs(8, {3, 3, 3, 3, 2, 2, 2, 2});
+    Config cfg(getTestConfig());
+    cfg = configureShortNames(cfg, orgs);
+    cfg.QUORUM_INTERSECTION_CHECKER_THREADS = 4;
+    std::atomic<bool> flag{false};
+
+    SECTION("core-and-periphery dangling splits")
+    {
+        auto qm = interconnectOrgsBidir(orgs, {{0, 1},
+                                               {0, 2},
+                                               {0, 3},
+                                               {1, 2},
+                                               {1, 3},
+                                               {2, 3},
+                                               {0, 4},
+                                               {1, 5},
+                                               {2, 6},
+                                               {3, 7}});
+        auto qic = QuorumIntersectionChecker::create(
+            qm, cfg, flag, getGlobalRandomEngine()());
+        REQUIRE(!qic->networkEnjoysQuorumIntersection());
+        // The recorded split is a pair of disjoint quorums
+        auto split = qic->getPotentialSplit();
+        REQUIRE(!split.first.empty());
+        REQUIRE(!split.second.empty());
+        for (auto const& n : split.first)
+        {
+            REQUIRE(std::find(split.second.begin(), split.second.end(), n) ==
+                    split.second.end());
+        }
+    }
+
+    SECTION("core-and-periphery balanced intersects")
+    {
+        auto qm = interconnectOrgsBidir(orgs, {{0, 1},
+                                               {0, 2},
+                                               {0, 3},
+                                               {1, 2},
+                                               {1, 3},
+                                               {2, 3},
+                                               {0, 4},
+                                               {1, 4},
+                                               {1, 5},
+                                               {3, 5},
+                                               {2, 6},
+                                               {0, 6},
+                                               {3, 7},
+                                               {2, 7}});
+        auto qic = QuorumIntersectionChecker::create(
+            qm, cfg, flag, getGlobalRandomEngine()());
+        REQUIRE(qic->networkEnjoysQuorumIntersection());
+        REQUIRE(qic->getMaxQuorumsFound() > 0);
+    }
+
+    SECTION("interruption stops all threads")
+    {
+        auto bigOrgs = generateOrgs(16);
+        auto qm = interconnectOrgs(bigOrgs,
+                                   [](size_t i, size_t j) { return true; });
+        auto qic = QuorumIntersectionChecker::create(
+            qm, cfg, flag, getGlobalRandomEngine()());
+        std::thread canceller([&flag]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            flag = true;
+        });
+        REQUIRE_THROWS_AS(qic->networkEnjoysQuorumIntersection(),
+                          QuorumIntersectionChecker::InterruptedException);
+        canceller.join();
+    }
+}
+
 TEST_CASE("quorum intersection scaling test",
           "[herder][quorumintersectionbench][!hide]")
 {
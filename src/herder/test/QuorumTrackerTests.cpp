@@ -350,5 +350,75 @@ TEST_CASE("quorum tracker closest validators", "[quorum][herder]")
             REQUIRE(qt.expand(otherKeys[5], lookup(otherKeys[5])));
             validateRebuildResult();
         }
+        SECTION("update where expand fails")
+        {
+            REQUIRE(qt.expand(otherKeys[2], lookup(otherKeys[2])));
+            REQUIRE(qt.expand(otherKeys[5], lookup(otherKeys[5])));
+            qt.update(otherKeys[1], lookup(otherKeys[1]), lookup);
+            validateRebuildResult();
+        }
+    }
+    // Updating quorum sets in place yields the same result as rebuilding
+    // with the new quorum sets
+    SECTION("update")
+    {
+        qt.rebuild(lookup);
+        std::map<int, SCPQuorumSetPtr> changed;
+        auto changedLookup = [&](NodeID const& node) -> SCPQuorumSetPtr {
+            auto it = std::find(otherKeys.begin(), otherKeys.end(), node);
+            auto idx = static_cast<int>(std::distance(otherKeys.begin(), it));
+            auto changedIt = changed.find(idx);
+            return changedIt != changed.end() ? changedIt->second
+                                              : lookup(node);
+        };
+        auto change = [&](int idx, SCPQuorumSetPtr qSet) {
+            changed[idx] = qSet;
+            qt.update(otherKeys[idx], qSet, changedLookup);
+
+            QuorumTracker expected(localNodeID);
+            expected.rebuild(changedLookup);
+            auto const& actualQuorum = qt.getQuorum();
+            REQUIRE(actualQuorum.size() == expected.getQuorum().size());
+            for (auto const& [node, info] : expected.getQuorum())
+            {
+                auto it = actualQuorum.find(node);
+                REQUIRE(it != actualQuorum.end());
+                REQUIRE(it->second.mDistance == info.mDistance);
+                REQUIRE(it->second.mClosestValidators ==
+                        info.mClosestValidators);
+                REQUIRE(!it->second.mQuorumSet == !info.mQuorumSet);
+                if (info.mQuorumSet)
+                {
+                    REQUIRE(*it->second.mQuorumSet == *info.mQuorumSet);
+                }
+            }
+        };
+
+        SECTION("new path")
+        {
+            // 6 joins the quorum through 1
+            change(1, makeQset({self, 2, 6}, 1));
+            checkRes(otherKeys[6], std::set<NodeID>{otherKeys[1]});
+            // 4 is now only reachable through 5
+            checkRes(otherKeys[4], std::set<NodeID>{otherKeys[2]});
+        }
+        SECTION("removal")
+        {
+            change(2, makeQset({self}, 2));
+            change(1, makeQset({self}, 1));
+            for (int i = 3; i < kKeysCount; i++)
+            {
+                checkRes(otherKeys[i], {}, true);
+            }
+            // and back, through 1 only
+            change(1, makeQset({self, 2, 4, 5}, 1));
+            checkRes(otherKeys[3], std::set<NodeID>{otherKeys[1]});
+        }
+        SECTION("local quorum set")
+        {
+            change(0, makeQset({5}, self));
+            checkRes(otherKeys[5], std::set<NodeID>{otherKeys[5]});
+            checkRes(otherKeys[2], std::set<NodeID>{otherKeys[5]});
+        }
     }
 }
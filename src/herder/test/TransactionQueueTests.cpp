@@ -29,6 +29,9 @@
 #include <chrono>
 #include <fmt/chrono.h>
 #include <lib/catch.hpp>
+#include <medida/counter.h>
+#include <medida/metrics_registry.h>
+#include <medida/timer.h>
 #include <numeric>
 
 using namespace stellar;
@@ -2242,6 +2245,75 @@ TEST_CASE("transaction queue starting sequence boundary",
     }
 }
 
+TEST_CASE("transaction queue nomination candidates",
+          "[herder][transactionqueue]")
+{
+    VirtualClock clock;
+    auto cfg = getTestConfig();
+    cfg.TESTING_UPGRADE_MAX_TX_SET_SIZE = 4;
+    auto app = createTestApplication(clock, cfg);
+    auto const minBalance2 = app->getLedgerManager().getLastMinBalance(2);
+    auto root = app->getRoot();
+
+    ClassicTransactionQueue tq(*app, 4, 10, 4);
+    std::vector<TransactionFrameBasePtr> txs;
+    for (int i = 0; i < 8; ++i)
+    {
+        auto account = root->create(fmt::format("a{}", i), minBalance2);
+        txs.emplace_back(transaction(*app, account, 1, 1, 100 * (i + 1)));
+        REQUIRE(tq.tryAdd(txs.back(), false).code ==
+                TransactionQueue::AddResultCode::ADD_STATUS_PENDING);
+    }
+
+    auto lcl = app->getLedgerManager().getLastClosedLedgerHeader().header;
+    auto check = [&](std::vector<TransactionFrameBasePtr> expected) {
+        auto candidates = tq.getNominationCandidates(lcl);
+        std::sort(candidates.begin(), candidates.end());
+        std::sort(expected.begin(), expected.end());
+        REQUIRE(candidates == expected);
+
+        // Surge pricing the candidates gives the same result as surge
+        // pricing the whole queue
+        auto laneConfig = std::make_shared<DexLimitingLaneConfig>(
+            Resource(4), std::nullopt);
+        std::vector<bool> hadTxNotFittingAll;
+        auto fromAll = SurgePricingPriorityQueue::getMostTopTxsWithinLimits(
+            tq.getTransactions(lcl), laneConfig, hadTxNotFittingAll,
+            lcl.ledgerVersion);
+        std::vector<bool> hadTxNotFittingCandidates;
+        auto fromCandidates =
+            SurgePricingPriorityQueue::getMostTopTxsWithinLimits(
+                candidates, laneConfig, hadTxNotFittingCandidates,
+                lcl.ledgerVersion);
+        std::sort(fromAll.begin(), fromAll.end());
+        std::sort(fromCandidates.begin(), fromCandidates.end());
+        REQUIRE(fromAll == fromCandidates);
+        REQUIRE(hadTxNotFittingAll == hadTxNotFittingCandidates);
+    };
+
+    // 4 highest fee txs and the first one that didn't fit
+    check({txs[7], txs[6], txs[5], txs[4], txs[3]});
+
+    SECTION("banned txs are dropped")
+    {
+        tq.ban({txs[6]});
+        check({txs[7], txs[5], txs[4], txs[3], txs[2]});
+    }
+    SECTION("added txs are picked up")
+    {
+        auto account = root->create("b", minBalance2);
+        auto tx = transaction(*app, account, 1, 1, 650);
+        REQUIRE(tq.tryAdd(tx, false).code ==
+                TransactionQueue::AddResultCode::ADD_STATUS_PENDING);
+        check({txs[7], tx, txs[6], txs[5], txs[4]});
+    }
+    SECTION("everything fits")
+    {
+        tq.ban({txs[0], txs[1], txs[2], txs[3]});
+        check({txs[7], txs[6], txs[5], txs[4]});
+    }
+}
+
 TEST_CASE("transaction queue with fee-bump", "[herder][transactionqueue]")
 {
     VirtualClock clock;
@@ -2877,6 +2949,13 @@ TEST_CASE("remove applied", "[herder][transactionqueue]")
     herder.recvTransaction(tx2, false);
     herder.recvTransaction(tx3, false);
 
+    auto& metrics = app->getMetrics();
+    auto& removeAppliedTimer =
+        metrics.NewTimer({"herder", "pending-txs", "remove-applied"});
+    auto& shiftTimer = metrics.NewTimer({"herder", "pending-txs", "shift"});
+    auto removeAppliedCount = removeAppliedTimer.count();
+    auto shiftCount = shiftTimer.count();
+
     {
         auto const& lcl = lm.getLastClosedLedgerHeader();
         auto ledgerSeq = lcl.header.ledgerSeq + 1;
@@ -2895,9 +2974,23 @@ TEST_CASE("remove applied", "[herder][transactionqueue]")
     }
 
     REQUIRE(tq.getTransactions({}).size() == 1);
+    auto sizeByAge = [&](int age) {
+        return metrics
+            .NewCounter({"herder", "pending-txs",
+                         fmt::format(FMT_STRING("age{:d}"), age)})
+            .count();
+    };
+    REQUIRE(removeAppliedTimer.count() == removeAppliedCount + 1);
+    REQUIRE(shiftTimer.count() == shiftCount + 1);
+    // tx3 is the only one left, a ledger older
+    REQUIRE(sizeByAge(0) == 0);
+    REQUIRE(sizeByAge(1) == 1);
+
     REQUIRE(herder.recvTransaction(tx4, false).code ==
             TransactionQueue::AddResultCode::ADD_STATUS_PENDING);
     REQUIRE(tq.getTransactions({}).size() == 2);
+    REQUIRE(sizeByAge(0) == 1);
+    REQUIRE(sizeByAge(1) == 1);
 }
 
 static UnorderedSet<AssetPair, AssetPairHash>
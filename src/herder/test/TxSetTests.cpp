@@ -3,7 +3,9 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "crypto/SHA.h"
+#include "herder/Herder.h"
 #include "herder/ParallelTxSetBuilder.h"
+#include "herder/TransactionQueue.h"
 #include "herder/TxSetFrame.h"
 #include "herder/test/TestTxSetUtils.h"
 #include "ledger/LedgerManager.h"
@@ -18,10 +20,12 @@
 #include "transactions/MutableTransactionResult.h"
 #include "transactions/TransactionUtils.h"
 #include "transactions/test/SorobanTxTestUtils.h"
+#include "util/Logging.h"
 #include "util/Math.h"
 #include "util/ProtocolVersion.h"
 #include "util/XDRCereal.h"
 #include <algorithm>
+#include <fmt/format.h>
 #include <map>
 namespace stellar
 {
@@ -531,6 +535,18 @@ testGeneralizedTxSetXDRConversion(ProtocolVersion protocolVersion)
         GeneralizedTransactionSet newXdr;
         applicableFrame->toWireTxSetFrame()->toXDR(newXdr);
         REQUIRE(newXdr == txSetXdr);
+
+        // Frames built in place from a message match the copied ones
+        auto msg = std::make_shared<StellarMessage>(
+            txSetFrame->toStellarMessage());
+        auto msgFrame = TxSetXDRFrame::makeFromWire(
+            std::shared_ptr<StellarMessage const>(msg));
+        REQUIRE(msgFrame->getContentsHash() == txSetFrame->getContentsHash());
+        REQUIRE(msgFrame->encodedSize() == txSetFrame->encodedSize());
+        msg.reset();
+        GeneralizedTransactionSet msgXdr;
+        msgFrame->toXDR(msgXdr);
+        REQUIRE(msgXdr == txSetXdr);
     };
 
     {
@@ -1698,6 +1714,62 @@ TEST_CASE("generalized tx set with multiple txs per source account",
     }
 }
 
+TEST_CASE("parallel tx set validation", "[txset]")
+{
+    VirtualClock clock;
+    auto cfg = getTestConfig();
+    cfg.TESTING_UPGRADE_MAX_TX_SET_SIZE = 1000;
+    cfg.TX_SET_VALIDATION_THREADS = 4;
+    Application::pointer app = createTestApplication(clock, cfg);
+    auto root = app->getRoot();
+
+    // Enough transactions for all 4 threads to get a share
+    size_t const numAccounts = 160;
+    std::vector<TestAccount> accounts;
+    std::vector<TransactionFrameBasePtr> createTxs;
+    std::vector<Operation> ops;
+    for (size_t i = 0; i < numAccounts; ++i)
+    {
+        auto sk = getAccount(fmt::format("validator{}", i));
+        ops.emplace_back(createAccount(sk.getPublicKey(), 1'000'000'000));
+        accounts.emplace_back(*app, sk);
+        if (ops.size() == MAX_OPS_PER_TX)
+        {
+            createTxs.emplace_back(root->tx(ops));
+            ops.clear();
+        }
+    }
+    if (!ops.empty())
+    {
+        createTxs.emplace_back(root->tx(ops));
+    }
+    closeLedger(*app, createTxs, /* strictOrder */ true);
+
+    auto check = [&](std::optional<size_t> badTx) {
+        std::vector<TransactionFrameBasePtr> txs;
+        for (size_t i = 0; i < accounts.size(); ++i)
+        {
+            auto seq = accounts[i].getLastSequenceNumber() + 1;
+            if (badTx && *badTx == i)
+            {
+                ++seq;
+            }
+            txs.emplace_back(accounts[i].tx({payment(*root, 1)}, seq));
+        }
+        auto ledgerHash =
+            app->getLedgerManager().getLastClosedLedgerHeader().hash;
+        auto txSet = testtxset::makeNonValidatedTxSetBasedOnLedgerVersion(
+                         txs, *app, ledgerHash)
+                         .second;
+        return txSet->checkValid(*app, 0, 0);
+    };
+
+    REQUIRE(check(std::nullopt));
+    REQUIRE(!check(0));
+    REQUIRE(!check(numAccounts / 2));
+    REQUIRE(!check(numAccounts - 1));
+}
+
 TEST_CASE("generalized tx set fees", "[txset][soroban]")
 {
     VirtualClock clock;
@@ -2316,7 +2388,8 @@ TEST_CASE("txset nomination", "[txset]")
 }
 
 void
-runParallelTxSetBuildingTest(bool variableStageCount)
+runParallelTxSetBuildingTest(bool variableStageCount,
+                             uint32_t buildThreads = 1)
 {
     int const STAGE_COUNT = 4;
     int const CLUSTER_COUNT = 8;
@@ -2329,6 +2402,7 @@ runParallelTxSetBuildingTest(bool variableStageCount)
         static_cast<uint32_t>(PARALLEL_SOROBAN_PHASE_PROTOCOL_VERSION);
     cfg.SOROBAN_PHASE_MIN_STAGE_COUNT = variableStageCount ? 1 : STAGE_COUNT;
     cfg.SOROBAN_PHASE_MAX_STAGE_COUNT = STAGE_COUNT;
+    cfg.SOROBAN_PHASE_BUILD_THREADS = buildThreads;
     // Temporary set the limits override very high in order for the upgrades
     // to pass (with 4 stages we have not enough insns for an upgrade tx to go
     // through).
@@ -2990,6 +3064,11 @@ TEST_CASE("parallel tx set building", "[txset][soroban]")
     {
         runParallelTxSetBuildingTest(false);
     }
+    SECTION("conflict graph built on multiple threads")
+    {
+        runParallelTxSetBuildingTest(true, 2);
+        runParallelTxSetBuildingTest(false, 2);
+    }
 }
 
 TEST_CASE("parallel tx set building benchmark",
@@ -3249,5 +3328,223 @@ TEST_CASE("parallel tx set building benchmark",
     runBenchmark(10, 10, 10);
     runBenchmark(50, 50, 5);
 }
+
+// Measures the nomination-time work on a node's own mempool: selecting the
+// candidates from the transaction queues, building the tx set from them
+// (surge pricing and parallel stage packing) and validating the resulting
+// set like a node receiving it would. The queues are filled with a mix of
+// classic payments and Soroban transactions, a share of which write to a
+// small pool of hot keys and thus conflict with each other.
+TEST_CASE("tx set building and validation benchmark",
+          "[txset][soroban][bench][!hide]")
+{
+    int const ITER_COUNT = 5;
+    int const CLUSTER_COUNT = 4;
+    int const HOT_KEY_COUNT = 16;
+    int const MIN_INSTRUCTIONS_PER_TX = 1'000'000;
+    int const MAX_INSTRUCTIONS_PER_TX = 50'000'000;
+
+    int const queueSize = GENERATE(1000, 4000);
+    // Share of Soroban transactions in the queue and share of those that
+    // write to one of the hot keys, in percent
+    auto const [sorobanPercent, conflictPercent] =
+        GENERATE(table<int, int>(
+            {{0, 0}, {50, 0}, {50, 10}, {100, 0}, {100, 10}, {100, 50}}));
+    int const sorobanCount = queueSize * sorobanPercent / 100;
+    int const classicCount = queueSize - sorobanCount;
+
+    VirtualClock clock;
+    auto cfg = getTestConfig();
+    cfg.GENESIS_TEST_ACCOUNT_COUNT = queueSize;
+    // Let about half of the queue fit in the tx set, so that surge pricing
+    // has to drop transactions. The queues are made large enough to hold
+    // every transaction.
+    cfg.TESTING_UPGRADE_MAX_TX_SET_SIZE = std::max(1, classicCount / 2);
+    cfg.TRANSACTION_QUEUE_SIZE_MULTIPLIER = 4;
+    cfg.SOROBAN_TRANSACTION_QUEUE_SIZE_MULTIPLIER = 4;
+    auto app = createTestApplication(clock, cfg);
+    overrideSorobanNetworkConfigForTest(*app);
+    modifySorobanNetworkConfig(*app, [&](SorobanNetworkConfig& sorobanCfg) {
+        int64_t includedCount = std::max(1, sorobanCount / 2);
+        sorobanCfg.mLedgerMaxTxCount = static_cast<uint32_t>(includedCount);
+        sorobanCfg.mLedgerMaxDependentTxClusters = CLUSTER_COUNT;
+        sorobanCfg.mLedgerMaxInstructions = std::max(
+            sorobanCfg.mTxMaxInstructions,
+            includedCount *
+                (MIN_INSTRUCTIONS_PER_TX + MAX_INSTRUCTIONS_PER_TX) / 2 /
+                CLUSTER_COUNT);
+        // Only the transaction count and instructions should limit the set
+        sorobanCfg.mLedgerMaxTransactionsSizeBytes =
+            includedCount * sorobanCfg.mTxMaxSizeBytes;
+        sorobanCfg.mLedgerMaxDiskReadEntries =
+            includedCount * sorobanCfg.mTxMaxDiskReadEntries;
+        sorobanCfg.mLedgerMaxDiskReadBytes =
+            includedCount * sorobanCfg.mTxMaxDiskReadBytes;
+        sorobanCfg.mLedgerMaxWriteLedgerEntries =
+            includedCount * sorobanCfg.mTxMaxWriteLedgerEntries;
+        sorobanCfg.mLedgerMaxWriteBytes =
+            includedCount * sorobanCfg.mTxMaxWriteBytes;
+    });
+
+    auto& herder = app->getHerder();
+    auto root = app->getRoot();
+    SCAddress contract(SC_ADDRESS_TYPE_CONTRACT);
+    stellar::uniform_int_distribution<uint32_t> feeDistr(100, 10'000);
+    stellar::uniform_int_distribution<uint32_t> insnsDistr(
+        MIN_INSTRUCTIONS_PER_TX, MAX_INSTRUCTIONS_PER_TX);
+    stellar::uniform_int_distribution<int> percentDistr(0, 99);
+    stellar::uniform_int_distribution<uint32_t> hotKeyDistr(0,
+                                                            HOT_KEY_COUNT - 1);
+
+    int accepted = 0;
+    for (int i = 0; i < queueSize; ++i)
+    {
+        auto source = getGenesisAccount(*app, i);
+        TransactionFrameBasePtr tx;
+        if (i < sorobanCount)
+        {
+            SorobanResources resources;
+            resources.instructions = insnsDistr(Catch::rng());
+            resources.diskReadBytes = 1000;
+            resources.writeBytes = 2000;
+            // Hot keys come first, the rest of the keys are unique
+            uint32_t rwKey = percentDistr(Catch::rng()) < conflictPercent
+                                 ? hotKeyDistr(Catch::rng())
+                                 : HOT_KEY_COUNT + 2 * i;
+            resources.footprint.readOnly.emplace_back(contractDataKey(
+                contract, makeU32(HOT_KEY_COUNT + 2 * i + 1),
+                ContractDataDurability::PERSISTENT));
+            resources.footprint.readWrite.emplace_back(
+                contractDataKey(contract, makeU32(rwKey),
+                                ContractDataDurability::PERSISTENT));
+            tx = createUploadWasmTx(
+                *app, source, feeDistr(Catch::rng()),
+                sorobanResourceFee(*app, resources, 2000, 0), resources,
+                /*memo=*/std::nullopt, /*addInvalidOps=*/0,
+                /*wasmSize=*/std::nullopt, /*seq=*/std::nullopt,
+                /*wasmSeed=*/i);
+        }
+        else
+        {
+            tx = transactionFromOperations(
+                *app, source.getSecretKey(), source.nextSequenceNumber(),
+                {payment(root->getPublicKey(), 1)}, feeDistr(Catch::rng()));
+        }
+        if (herder.recvTransaction(tx, false).code ==
+            TransactionQueue::AddResultCode::ADD_STATUS_PENDING)
+        {
+            ++accepted;
+        }
+    }
+
+    auto& lm = app->getLedgerManager();
+    auto lcl = lm.getLastClosedLedgerHeader();
+    auto const& sorobanCfg = lm.getLastClosedSorobanNetworkConfig();
+    auto toMs = [](auto duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    };
+
+    double selectMs = 0;
+    double buildMs = 0;
+    double validateMs = 0;
+    size_t txsIncluded = 0;
+    size_t stageCount = 0;
+    size_t clusterCount = 0;
+    int64_t insnsIncluded = 0;
+    // Instructions of the busiest cluster of each stage, which is what bounds
+    // the stage's duration
+    int64_t insnsCriticalPath = 0;
+    double balanceSum = 0;
+    for (int iter = 0; iter < ITER_COUNT; ++iter)
+    {
+        auto start = std::chrono::steady_clock::now();
+        PerPhaseTransactionList txPhases;
+        txPhases.emplace_back(
+            herder.getTransactionQueue().getNominationCandidates(lcl.header));
+        txPhases.emplace_back(
+            herder.getSorobanTransactionQueue().getTransactions(lcl.header));
+        auto selected = std::chrono::steady_clock::now();
+        PerPhaseTransactionList invalidTxs;
+        invalidTxs.resize(txPhases.size());
+        auto [txSet, applicableTxSet] =
+            makeTxSetFromTransactions(txPhases, *app, 0, 0, invalidTxs);
+        auto built = std::chrono::steady_clock::now();
+
+        // Validate from the wire form, as a node that didn't build the set
+        GeneralizedTransactionSet xdrTxSet;
+        txSet->toXDR(xdrTxSet);
+        auto validationStart = std::chrono::steady_clock::now();
+        auto receivedTxSet = TxSetXDRFrame::makeFromWire(xdrTxSet);
+        auto applicable = receivedTxSet->prepareForApply(*app, lcl.header);
+        REQUIRE(applicable);
+        REQUIRE(applicable->checkValid(*app, 0, 0));
+        auto validated = std::chrono::steady_clock::now();
+
+        selectMs += toMs(selected - start);
+        buildMs += toMs(built - selected);
+        validateMs += toMs(validated - validationStart);
+        txsIncluded += applicableTxSet->sizeTxTotal();
+
+        auto const& sorobanPhase =
+            applicableTxSet->getPhase(TxSetPhase::SOROBAN);
+        if (!sorobanPhase.isParallel())
+        {
+            continue;
+        }
+        for (auto const& stage : sorobanPhase.getParallelStages())
+        {
+            int64_t stageInsns = 0;
+            int64_t maxClusterInsns = 0;
+            for (auto const& cluster : stage)
+            {
+                int64_t clusterInsns = 0;
+                for (auto const& tx : cluster)
+                {
+                    clusterInsns += tx->sorobanResources().instructions;
+                }
+                stageInsns += clusterInsns;
+                maxClusterInsns = std::max(maxClusterInsns, clusterInsns);
+            }
+            ++stageCount;
+            clusterCount += stage.size();
+            insnsIncluded += stageInsns;
+            insnsCriticalPath += maxClusterInsns;
+            if (maxClusterInsns > 0)
+            {
+                balanceSum += static_cast<double>(stageInsns) /
+                              (stage.size() * maxClusterInsns);
+            }
+        }
+    }
+
+    LOG_INFO(DEFAULT_LOG,
+             "queue size {}, soroban {}%, conflicting {}%: {} txs accepted, "
+             "{:.1f} txs included",
+             queueSize, sorobanPercent, conflictPercent, accepted,
+             static_cast<double>(txsIncluded) / ITER_COUNT);
+    LOG_INFO(DEFAULT_LOG,
+             "mean candidate selection {:.3f} ms, tx set building {:.3f} ms, "
+             "validation {:.3f} ms",
+             selectMs / ITER_COUNT, buildMs / ITER_COUNT,
+             validateMs / ITER_COUNT);
+    if (stageCount > 0)
+    {
+        // Utilization is relative to the instructions all the clusters could
+        // run within the ledger limit, balance to the busiest cluster of each
+        // stage
+        LOG_INFO(DEFAULT_LOG,
+                 "{:.2f} stages, {:.2f} clusters per stage, stage balance "
+                 "{:.3f}, instruction utilization {:.3f}, critical path "
+                 "{:.3f} of ledger limit",
+                 static_cast<double>(stageCount) / ITER_COUNT,
+                 static_cast<double>(clusterCount) / stageCount,
+                 balanceSum / stageCount,
+                 static_cast<double>(insnsIncluded) / ITER_COUNT /
+                     (sorobanCfg.ledgerMaxInstructions() *
+                      sorobanCfg.ledgerMaxDependentTxClusters()),
+                 static_cast<double>(insnsCriticalPath) / ITER_COUNT /
+                     sorobanCfg.ledgerMaxInstructions());
+    }
+}
 } // namespace
 } // namespace stellar
@@ -49,6 +49,8 @@ CheckpointBuilder::ensureOpen(uint32_t ledgerSeq)
             mApp.getClock().getIOContext(), /* fsync*/ true);
         mLedgerHeaders->open(ledger.localPath_nogz_dirty());
         mOpen = true;
+        mLedgersSinceSync = 0;
+        mLastSync = std::chrono::steady_clock::now();
     }
     return true;
 }
@@ -61,7 +63,16 @@ CheckpointBuilder::checkpointComplete(uint32_t checkpoint)
     releaseAssert(
         HistoryManager::isLastLedgerInCheckpoint(checkpoint, mApp.getConfig()));
 
-    // This will close and reset the streams
+    // Close the streams, syncing the files together rather than one after
+    // the other, before any of them is renamed
+    fs::DurabilityGroup durability;
+    for (auto* stream : {mLedgerHeaders.get(), mTxs.get(), mTxResults.get()})
+    {
+        if (stream && stream->isOpen())
+        {
+            stream->close(durability);
+        }
+    }
     mLedgerHeaders.reset();
     mTxs.reset();
     mTxResults.reset();
@@ -74,7 +85,7 @@ CheckpointBuilder::checkpointComplete(uint32_t checkpoint)
                       ft.localPath_nogz());
         }
         else if (fs::exists(ft.localPath_nogz_dirty()) &&
-                 !fs::durableRename(
+                 !durability.rename(
                      ft.localPath_nogz_dirty(), ft.localPath_nogz(),
                      getPublishHistoryDir(ft.getType(), mApp.getConfig())
                          .string()))
@@ -94,12 +105,60 @@ CheckpointBuilder::checkpointComplete(uint32_t checkpoint)
     maybeRename(res);
     maybeRename(txs);
     maybeRename(ledger);
+    durability.commit();
 }
 
 CheckpointBuilder::CheckpointBuilder(Application& app) : mApp(app)
 {
 }
 
+bool
+CheckpointBuilder::groupSync() const
+{
+    return mApp.getConfig().CHECKPOINT_FSYNC_INTERVAL_LEDGERS > 1;
+}
+
+void
+CheckpointBuilder::maybeSync()
+{
+    ZoneScoped;
+    if (!groupSync())
+    {
+        return;
+    }
+
+    auto const& cfg = mApp.getConfig();
+    auto now = std::chrono::steady_clock::now();
+    ++mLedgersSinceSync;
+    if (mLedgersSinceSync < cfg.CHECKPOINT_FSYNC_INTERVAL_LEDGERS &&
+        (cfg.CHECKPOINT_FSYNC_INTERVAL_MS.count() == 0 ||
+         now - mLastSync < cfg.CHECKPOINT_FSYNC_INTERVAL_MS))
+    {
+        return;
+    }
+    mLedgersSinceSync = 0;
+    mLastSync = now;
+
+    // fsync duplicates of the handles, which stay valid even if the streams
+    // are closed by then. Closing the streams at the end of the checkpoint
+    // fsyncs them again, before the files are renamed.
+    std::vector<fs::native_handle_t> handles;
+    for (auto* stream : {mTxResults.get(), mTxs.get(), mLedgerHeaders.get()})
+    {
+        handles.emplace_back(fs::duplicateHandle(stream->getHandle()));
+    }
+    mApp.postOnBackgroundThread(
+        [handles]() {
+            for (auto h : handles)
+            {
+                fs::flushFileChanges(h);
+                fs::closeHandle(h);
+            }
+        },
+        "CheckpointBuilder: fsync",
+        BackgroundWorkClass::PUBLISH);
+}
+
 void
 CheckpointBuilder::appendTransactionSet(uint32_t ledgerSeq,
                                         TxSetXDRFrameConstPtr const& txSet,
@@ -145,8 +204,18 @@ CheckpointBuilder::appendTransactionSet(uint32_t ledgerSeq,
         TransactionHistoryResultEntry results;
         results.ledgerSeq = ledgerSeq;
         results.txResultSet = resultSet;
-        mTxResults->durableWriteOne(results);
-        mTxs->durableWriteOne(txSet);
+        if (groupSync())
+        {
+            mTxResults->writeOne(results);
+            mTxResults->flush();
+            mTxs->writeOne(txSet);
+            mTxs->flush();
+        }
+        else
+        {
+            mTxResults->durableWriteOne(results);
+            mTxs->durableWriteOne(txSet);
+        }
     }
 }
 
@@ -172,6 +241,7 @@ CheckpointBuilder::appendLedgerHeader(LedgerHeader const& header,
     lhe.hash = xdrSha256(header);
     mLedgerHeaders->writeOne(lhe);
     mLedgerHeaders->flush();
+    maybeSync();
 }
 
 uint32_t
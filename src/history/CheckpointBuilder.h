@@ -6,6 +6,7 @@
 
 #include "herder/TxSetFrame.h"
 #include "util/XDRStream.h"
+#include <chrono>
 
 namespace stellar
 {
@@ -22,6 +23,10 @@ are first written as temporary "dirty" files and then renamed to their final
 names to mark a successfully constructed checkpoint. Note that tmp files are
 highly durable, and are fsynced on every write. This way on crash all publish
 data is preserved and can be recovered to a valid checkpoint on restart.
+With CHECKPOINT_FSYNC_INTERVAL_LEDGERS > 1 writes are only flushed to the OS
+during ledger close, which survives a crash of the process, and fsynced on a
+background thread once per that many ledgers, so a crash of the machine can
+lose the most recent ledgers.
 
 * All publish files are renamed to their final names _after_ ledger commits.
 This ensures that final checkpoint files are always valid (and do not contain
@@ -58,8 +63,16 @@ class CheckpointBuilder
     bool mOpen{false};
     bool mStartupValidationComplete{false};
     bool mPublishWasDisabled{false};
+    // Ledgers appended since the streams were last fsynced, when fsyncs are
+    // grouped (see CHECKPOINT_FSYNC_INTERVAL_LEDGERS)
+    uint32_t mLedgersSinceSync{0};
+    std::chrono::steady_clock::time_point mLastSync;
 
     bool ensureOpen(uint32_t ledgerSeq);
+    bool groupSync() const;
+    // Called once all of a ledger is appended: fsync the streams on a
+    // background thread if enough ledgers or time went by since the last time
+    void maybeSync();
 
   public:
     CheckpointBuilder(Application& app);
@@ -105,6 +105,16 @@ class FileTransferInfo
     {
         return mLocalPath + ".gz.tmp";
     }
+    std::string
+    localPath_zst() const
+    {
+        return mLocalPath + ".zst";
+    }
+    std::string
+    localPath_zst_tmp() const
+    {
+        return mLocalPath + ".zst.tmp";
+    }
 
     std::string
     baseName_nogz() const
@@ -132,5 +142,10 @@ class FileTransferInfo
     {
         return fs::remoteName(getTypeString(), mHexDigits, "xdr.gz");
     }
+    std::string
+    remoteName_zst() const
+    {
+        return fs::remoteName(getTypeString(), mHexDigits, "xdr.zst");
+    }
 };
 }
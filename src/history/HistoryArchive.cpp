@@ -23,11 +23,13 @@
 #include <Tracy.hpp>
 #include <fmt/format.h>
 
+#include <algorithm>
 #include <cereal/archives/json.hpp>
 #include <cereal/cereal.hpp>
 #include <cereal/types/vector.hpp>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <medida/meter.h>
 #include <medida/metrics_registry.h>
 #include <set>
@@ -328,6 +330,22 @@ HistoryArchiveState::allBuckets() const
     return std::vector<std::string>(buckets.begin(), buckets.end());
 }
 
+bool
+HistoryArchiveState::hasZstdFiles() const
+{
+    return std::find(compressions.begin(), compressions.end(),
+                     HISTORY_ARCHIVE_ZSTD_COMPRESSION) != compressions.end();
+}
+
+void
+HistoryArchiveState::setHasZstdFiles()
+{
+    if (!hasZstdFiles())
+    {
+        compressions.emplace_back(HISTORY_ARCHIVE_ZSTD_COMPRESSION);
+    }
+}
+
 namespace
 {
 
@@ -513,6 +531,12 @@ HistoryArchiveState::prepareForPublish(Application& app)
     {
         prepareBucketList(hotArchiveBuckets, HotArchiveBucketList::kNumLevels);
     }
+
+    // Every file of the checkpoint is published zstd-compressed as well
+    if (app.getConfig().EXPERIMENTAL_ZSTD_HISTORY)
+    {
+        setHasZstdFiles();
+    }
 }
 
 HistoryArchiveState::HistoryArchiveState() : server(STELLAR_CORE_VERSION)
@@ -624,6 +648,50 @@ HistoryArchive::getFileCmd(std::string const& remote,
     return formatString(mConfig.mGetCmd, remote, local);
 }
 
+std::optional<std::string>
+HistoryArchive::getFileUrl(std::string const& remote) const
+{
+    // Anything more elaborate than the common curl invocation (custom headers,
+    // credentials, https, other tools) is left to the command itself
+    std::istringstream in(mConfig.mGetCmd);
+    std::vector<std::string> args{std::istream_iterator<std::string>(in),
+                                  std::istream_iterator<std::string>()};
+    if (args.empty() || args[0] != "curl")
+    {
+        return std::nullopt;
+    }
+
+    std::optional<std::string> urlTemplate;
+    bool writesLocal = false;
+    for (size_t i = 1; i < args.size(); ++i)
+    {
+        auto const& arg = args[i];
+        if (arg == "-s" || arg == "-f" || arg == "-sf" || arg == "-fs" ||
+            arg == "--silent" || arg == "--fail")
+        {
+            continue;
+        }
+        if (arg == "-o" && i + 1 < args.size() && args[i + 1] == "{1}")
+        {
+            writesLocal = true;
+            ++i;
+            continue;
+        }
+        if (!urlTemplate && arg.rfind("http://", 0) == 0 &&
+            arg.find("{0}") != std::string::npos)
+        {
+            urlTemplate = arg;
+            continue;
+        }
+        return std::nullopt;
+    }
+    if (!urlTemplate || !writesLocal)
+    {
+        return std::nullopt;
+    }
+    return formatString(*urlTemplate, remote);
+}
+
 std::string
 HistoryArchive::putFileCmd(std::string const& local,
                            std::string const& remote) const
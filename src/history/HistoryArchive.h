@@ -16,6 +16,7 @@
 
 #include <cereal/cereal.hpp>
 #include <memory>
+#include <optional>
 #include <string>
 #include <system_error>
 
@@ -85,6 +86,10 @@ struct HistoryArchiveState
     static inline unsigned const
         HISTORY_ARCHIVE_STATE_VERSION_WITH_HOT_ARCHIVE = 2;
 
+    // Entry of `compressions` advertising that checkpoint and bucket files are
+    // also published as zstd-compressed `.xdr.zst` files
+    static inline std::string const HISTORY_ARCHIVE_ZSTD_COMPRESSION = "zstd";
+
     struct BucketHashReturnT
     {
         std::vector<std::string> live;
@@ -103,6 +108,9 @@ struct HistoryArchiveState
     uint32_t currentLedger{0};
     std::vector<HistoryStateBucket<LiveBucket>> currentBuckets;
     std::vector<HistoryStateBucket<HotArchiveBucket>> hotArchiveBuckets;
+    // Compressions the archive publishes files in besides gzip. Files
+    // published before one was enabled may only exist gzipped.
+    std::vector<std::string> compressions;
 
     HistoryArchiveState();
 
@@ -158,6 +166,15 @@ struct HistoryArchiveState
         {
             ar(CEREAL_NVP(hotArchiveBuckets));
         }
+        try
+        {
+            ar(CEREAL_NVP(compressions));
+        }
+        catch (cereal::Exception&)
+        {
+            // Only published by archives using a compression besides gzip
+            compressions.clear();
+        }
     }
 
     template <class Archive>
@@ -180,6 +197,10 @@ struct HistoryArchiveState
         {
             ar(CEREAL_NVP(hotArchiveBuckets));
         }
+        if (!compressions.empty())
+        {
+            ar(CEREAL_NVP(compressions));
+        }
     }
 
     // Return true if all futures are in FB_CLEAR state
@@ -212,6 +233,9 @@ struct HistoryArchiveState
     {
         return version >= HISTORY_ARCHIVE_STATE_VERSION_WITH_HOT_ARCHIVE;
     }
+
+    bool hasZstdFiles() const;
+    void setHasZstdFiles();
 };
 
 class HistoryArchive : public std::enable_shared_from_this<HistoryArchive>
@@ -226,11 +250,28 @@ class HistoryArchive : public std::enable_shared_from_this<HistoryArchive>
 
     std::string getFileCmd(std::string const& remote,
                            std::string const& local) const;
+    // URL of `remote` if the get command is a plain
+    // `curl [-s] [-f] http://.../{0} -o {1}` template, nullopt otherwise
+    std::optional<std::string> getFileUrl(std::string const& remote) const;
     std::string putFileCmd(std::string const& local,
                            std::string const& remote) const;
     std::string mkdirCmd(std::string const& remoteDir) const;
 
+    // Whether the last history archive state downloaded from this archive
+    // advertised zstd-compressed files
+    bool
+    hasZstdFiles() const
+    {
+        return mHasZstdFiles;
+    }
+    void
+    setHasZstdFiles(bool hasZstdFiles)
+    {
+        mHasZstdFiles = hasZstdFiles;
+    }
+
   private:
     HistoryArchiveConfiguration mConfig;
+    bool mHasZstdFiles{false};
 };
 }
@@ -5,6 +5,7 @@
 #include "history/HistoryArchiveManager.h"
 #include "history/HistoryArchive.h"
 #include "history/HistoryArchiveReportWork.h"
+#include "history/HttpArchiveClient.h"
 #include "historywork/CheckSingleLedgerHeaderWork.h"
 #include "historywork/GetHistoryArchiveStateWork.h"
 #include "historywork/PutHistoryArchiveStateWork.h"
@@ -268,4 +269,14 @@ HistoryArchiveManager::getWritableHistoryArchives() const
                  });
     return result;
 }
+
+HttpArchiveClient&
+HistoryArchiveManager::getHttpArchiveClient()
+{
+    if (!mHttpArchiveClient)
+    {
+        mHttpArchiveClient = std::make_shared<HttpArchiveClient>(mApp);
+    }
+    return *mHttpArchiveClient;
+}
 }
@@ -13,6 +13,7 @@ namespace stellar
 class Application;
 class Config;
 class HistoryArchive;
+class HttpArchiveClient;
 
 class BasicWork;
 struct LedgerHeaderHistoryEntry;
@@ -54,8 +55,13 @@ class HistoryArchiveManager
     std::vector<std::shared_ptr<HistoryArchive>>
     getWritableHistoryArchives() const;
 
+    // Returns the client used to download files from archives served over
+    // plain HTTP when EXPERIMENTAL_NATIVE_HISTORY_GET is set.
+    HttpArchiveClient& getHttpArchiveClient();
+
   private:
     Application& mApp;
     std::vector<std::shared_ptr<HistoryArchive>> mArchives;
+    std::shared_ptr<HttpArchiveClient> mHttpArchiveClient;
 };
 }
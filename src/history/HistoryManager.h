@@ -376,6 +376,10 @@ class HistoryManager
                      std::vector<std::string> const& originalBuckets,
                      bool success) = 0;
 
+    // Callback from PutRemoteFileWork, indicates that a file of `bytes` bytes
+    // was uploaded to an archive.
+    virtual void historyFileUploaded(uint64_t bytes) = 0;
+
     virtual void
     appendTransactionSet(uint32_t ledgerSeq, TxSetXDRFrameConstPtr const& txSet,
                          TransactionResultSet const& resultSet) = 0;
@@ -11,6 +11,7 @@
 #include "bucket/LiveBucket.h"
 #include "bucket/LiveBucketList.h"
 #include "herder/HerderImpl.h"
+#include "herder/HerderPersistence.h"
 #include <cereal/archives/binary.hpp>
 #include <cereal/cereal.hpp>
 #include <cereal/types/vector.hpp>
@@ -28,6 +29,7 @@
 #include "ledger/LedgerManager.h"
 #include "main/Application.h"
 #include "main/Config.h"
+#include "medida/counter.h"
 #include "medida/meter.h"
 #include "medida/metrics_registry.h"
 #include "transactions/TransactionSQL.h"
@@ -230,6 +232,10 @@ HistoryManagerImpl::HistoryManagerImpl(Application& app)
           app.getMetrics().NewMeter({"history", "publish", "success"}, "event"))
     , mPublishFailure(
           app.getMetrics().NewMeter({"history", "publish", "failure"}, "event"))
+    , mPublishQueueDepth(
+          app.getMetrics().NewCounter({"history", "publish", "queue"}))
+    , mPublishBytes(
+          app.getMetrics().NewMeter({"history", "publish", "bytes"}, "byte"))
     , mEnqueueToPublishTimer(
           app.getMetrics().NewTimer({"history", "publish", "time"}))
     , mCheckpointBuilder(app)
@@ -260,6 +266,7 @@ HistoryManagerImpl::logAndUpdatePublishStatus()
     if (mPublishWork)
     {
         auto qlen = publishQueueLength(mApp.getConfig());
+        mPublishQueueDepth.set_count(qlen);
         stateStr << "Publishing " << qlen << " queued checkpoints"
                  << " [" << getMinLedgerQueuedToPublish(mApp.getConfig()) << "-"
                  << getMaxLedgerQueuedToPublish(mApp.getConfig()) << "]"
@@ -456,6 +463,8 @@ HistoryManagerImpl::takeSnapshotAndPublish(HistoryArchiveState const& has)
     auto allBucketsFromHAS = has.allBuckets();
     auto ledgerSeq = has.currentLedger;
     CLOG_INFO(History, "Activating publish for ledger {}", ledgerSeq);
+    // The snapshot reads SCP messages back from the database
+    mApp.getHerderPersistence().flush();
     auto snap = std::make_shared<StateSnapshot>(mApp, has);
 
     // Phase 1: resolve futures in snapshot
@@ -565,6 +574,7 @@ HistoryManagerImpl::maybeCheckpointComplete(uint32_t lcl)
         throw std::runtime_error(fmt::format(
             "Failed to rename {} to {}", temp.string(), finalizedHAS.string()));
     }
+    updatePublishQueueDepth();
 }
 
 std::vector<HistoryArchiveState>
@@ -700,11 +710,24 @@ HistoryManagerImpl::historyPublished(
     {
         this->mPublishFailure.Mark();
     }
+    updatePublishQueueDepth();
     mPublishWork.reset();
     mApp.postOnMainThread([this]() { this->publishQueuedHistory(); },
                           "HistoryManagerImpl: publishQueuedHistory");
 }
 
+void
+HistoryManagerImpl::historyFileUploaded(uint64_t bytes)
+{
+    mPublishBytes.Mark(bytes);
+}
+
+void
+HistoryManagerImpl::updatePublishQueueDepth()
+{
+    mPublishQueueDepth.set_count(publishQueueLength(mApp.getConfig()));
+}
+
 void
 HistoryManagerImpl::appendTransactionSet(uint32_t ledgerSeq,
                                          TxSetXDRFrameConstPtr const& txSet,
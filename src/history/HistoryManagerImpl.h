@@ -12,6 +12,7 @@
 
 namespace medida
 {
+class Counter;
 class Meter;
 class Timer;
 }
@@ -31,6 +32,10 @@ class HistoryManagerImpl : public HistoryManager
     std::atomic<int> mPublishQueued{0};
     medida::Meter& mPublishSuccess;
     medida::Meter& mPublishFailure;
+    // Checkpoints waiting in the publish queue, including the one being
+    // published
+    medida::Counter& mPublishQueueDepth;
+    medida::Meter& mPublishBytes;
 
     medida::Timer& mEnqueueToPublishTimer;
     UnorderedMap<uint32_t, std::chrono::steady_clock::time_point> mEnqueueTimes;
@@ -40,6 +45,8 @@ class HistoryManagerImpl : public HistoryManager
     bool mPublicationEnabled{true};
 #endif
 
+    void updatePublishQueueDepth();
+
   public:
     HistoryManagerImpl(Application& app);
     ~HistoryManagerImpl() override;
@@ -64,6 +71,7 @@ class HistoryManagerImpl : public HistoryManager
     void historyPublished(uint32_t ledgerSeq,
                           std::vector<std::string> const& originalBuckets,
                           bool success) override;
+    void historyFileUploaded(uint64_t bytes) override;
     void appendTransactionSet(uint32_t ledgerSeq,
                               TxSetXDRFrameConstPtr const& txSet,
                               TransactionResultSet const& resultSet) override;
@@ -0,0 +1,746 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+// ASIO is somewhat particular about when it gets included -- it wants to be the
+// first to include <windows.h> -- so we try to include it before everything
+// else.
+#include "util/asio.h"
+
+#include "history/HttpArchiveClient.h"
+#include "main/Application.h"
+#include "util/GlobalChecks.h"
+#include "util/Logging.h"
+#include "util/Timer.h"
+#include <Tracy.hpp>
+#include <algorithm>
+#include <cctype>
+#include <fmt/format.h>
+#include <fstream>
+#include <medida/meter.h>
+#include <medida/metrics_registry.h>
+#include <sstream>
+
+namespace stellar
+{
+
+// Pooled connections kept per host beyond the active ones
+static constexpr size_t MAX_IDLE_CONNECTIONS_PER_HOST = 8;
+
+struct HttpArchiveClient::Connection
+{
+    explicit Connection(asio::io_context& ioContext) : mSocket(ioContext)
+    {
+    }
+    asio::ip::tcp::socket mSocket;
+    asio::streambuf mBuffer;
+};
+
+struct HttpArchiveClient::Request
+{
+    Url mUrl;
+    // Exactly one of mLocalPath and mSink is set
+    std::string mLocalPath;
+    BodySink mSink;
+    Handler mHandler;
+    std::shared_ptr<Connection> mConnection;
+    bool mReusedConnection{false};
+    bool mGotHeaders{false};
+    bool mKeepAlive{true};
+    bool mDone{false};
+    // Bytes left in the body (Content-Length) or in the current chunk
+    std::optional<size_t> mRemaining;
+    // Bytes of the body handed to the file or sink so far
+    size_t mReceived{0};
+    // Bumped when a download is resumed on a new connection, so that late
+    // callbacks for the abandoned one are ignored
+    size_t mAttempt{0};
+    // mReceived when the download was last resumed, and how many resumes in
+    // a row received nothing
+    size_t mResumedAt{0};
+    size_t mStalledResumes{0};
+    std::ofstream mOut;
+    std::unique_ptr<VirtualTimer> mTimer;
+};
+
+// Whether a callback for `attempt` of `req` comes too late because the
+// download ended or moved to another connection
+static bool
+isStale(HttpArchiveClient::Request const& req, size_t attempt)
+{
+    return req.mDone || req.mAttempt != attempt;
+}
+
+std::optional<HttpArchiveClient::Url>
+HttpArchiveClient::parseUrl(std::string const& url)
+{
+    std::string const scheme = "http://";
+    if (url.rfind(scheme, 0) != 0)
+    {
+        return std::nullopt;
+    }
+    auto hostEnd = url.find('/', scheme.size());
+    if (hostEnd == std::string::npos || hostEnd == scheme.size())
+    {
+        return std::nullopt;
+    }
+    Url res;
+    auto hostPort = url.substr(scheme.size(), hostEnd - scheme.size());
+    auto colon = hostPort.find(':');
+    res.mHost = hostPort.substr(0, colon);
+    res.mPort = colon == std::string::npos ? "80" : hostPort.substr(colon + 1);
+    res.mTarget = url.substr(hostEnd);
+    if (res.mHost.empty() || res.mPort.empty() ||
+        !std::all_of(res.mPort.begin(), res.mPort.end(),
+                     [](char c) { return std::isdigit(c); }))
+    {
+        return std::nullopt;
+    }
+    return res;
+}
+
+HttpArchiveClient::HttpArchiveClient(Application& app)
+    : mApp(app)
+    , mConnectMeter(app.getMetrics().NewMeter(
+          {"history", "http", "connect"}, "connection"))
+    , mReuseMeter(app.getMetrics().NewMeter({"history", "http", "reuse"},
+                                            "connection"))
+    , mResumeMeter(app.getMetrics().NewMeter({"history", "http", "resume"},
+                                             "download"))
+{
+}
+
+std::string
+HttpArchiveClient::hostKey(Url const& url)
+{
+    return url.mHost + ":" + url.mPort;
+}
+
+std::shared_ptr<HttpArchiveClient::Request>
+HttpArchiveClient::get(Url const& url, std::string const& localPath,
+                       Handler handler)
+{
+    auto req = std::make_shared<Request>();
+    req->mUrl = url;
+    req->mLocalPath = localPath;
+    req->mHandler = std::move(handler);
+    return enqueue(std::move(req));
+}
+
+std::shared_ptr<HttpArchiveClient::Request>
+HttpArchiveClient::get(Url const& url, BodySink sink, Handler handler)
+{
+    auto req = std::make_shared<Request>();
+    req->mUrl = url;
+    req->mSink = std::move(sink);
+    req->mHandler = std::move(handler);
+    return enqueue(std::move(req));
+}
+
+std::shared_ptr<HttpArchiveClient::Request>
+HttpArchiveClient::enqueue(std::shared_ptr<Request> req)
+{
+    releaseAssert(threadIsMain());
+    req->mTimer = std::make_unique<VirtualTimer>(mApp);
+
+    auto key = hostKey(req->mUrl);
+    mHosts[key].mQueued.emplace_back(req);
+    pump(key);
+    return req;
+}
+
+void
+HttpArchiveClient::cancel(std::shared_ptr<Request> const& req)
+{
+    releaseAssert(threadIsMain());
+    if (req->mDone)
+    {
+        return;
+    }
+    auto& host = mHosts[hostKey(req->mUrl)];
+    auto it = std::find(host.mQueued.begin(), host.mQueued.end(), req);
+    if (it != host.mQueued.end())
+    {
+        // Not started yet
+        req->mDone = true;
+        host.mQueued.erase(it);
+        return;
+    }
+    finish(req, "cancelled", false);
+}
+
+void
+HttpArchiveClient::pump(std::string const& key)
+{
+    auto& host = mHosts[key];
+    while (!host.mQueued.empty() &&
+           host.mActive < static_cast<size_t>(host.mLimit))
+    {
+        auto req = host.mQueued.front();
+        host.mQueued.pop_front();
+        ++host.mActive;
+        armTimer(req);
+        if (!host.mIdle.empty())
+        {
+            req->mConnection = host.mIdle.back();
+            req->mReusedConnection = true;
+            host.mIdle.pop_back();
+            mReuseMeter.Mark();
+            sendRequest(req);
+        }
+        else
+        {
+            connect(req);
+        }
+    }
+}
+
+void
+HttpArchiveClient::armTimer(std::shared_ptr<Request> const& req)
+{
+    req->mTimer->expires_from_now(INACTIVITY_TIMEOUT);
+    req->mTimer->async_wait(
+        [weak = std::weak_ptr<HttpArchiveClient>(shared_from_this()), req,
+         attempt = req->mAttempt]() {
+            auto self = weak.lock();
+            if (self && !isStale(*req, attempt))
+            {
+                self->resumeOrFail(req, "timed out");
+            }
+        },
+        VirtualTimer::onFailureNoop);
+}
+
+void
+HttpArchiveClient::connect(std::shared_ptr<Request> const& req)
+{
+    ZoneScoped;
+    auto& ioContext = mApp.getClock().getIOContext();
+    req->mConnection = std::make_shared<Connection>(ioContext);
+    req->mReusedConnection = false;
+    mConnectMeter.Mark();
+
+    auto resolver = std::make_shared<asio::ip::tcp::resolver>(ioContext);
+    resolver->async_resolve(
+        req->mUrl.mHost, req->mUrl.mPort,
+        [self = shared_from_this(), req, resolver,
+         attempt = req->mAttempt](
+            asio::error_code const& ec,
+            asio::ip::tcp::resolver::results_type results) {
+            if (isStale(*req, attempt))
+            {
+                return;
+            }
+            if (ec)
+            {
+                self->resumeOrFail(req, "resolve: " + ec.message());
+                return;
+            }
+            asio::async_connect(
+                req->mConnection->mSocket, results,
+                [self, req, attempt](asio::error_code const& ec,
+                                     asio::ip::tcp::endpoint const&) {
+                    if (isStale(*req, attempt))
+                    {
+                        return;
+                    }
+                    if (ec)
+                    {
+                        self->resumeOrFail(req, "connect: " + ec.message());
+                        return;
+                    }
+                    asio::error_code ignored;
+                    std::ignore = req->mConnection->mSocket.set_option(
+                        asio::ip::tcp::no_delay(true), ignored);
+                    self->sendRequest(req);
+                });
+        });
+}
+
+void
+HttpArchiveClient::sendRequest(std::shared_ptr<Request> const& req)
+{
+    // Ask for the rest of the body when resuming
+    auto range = req->mReceived > 0
+                     ? fmt::format(FMT_STRING("Range: bytes={}-\r\n"),
+                                   req->mReceived)
+                     : std::string();
+    auto request = std::make_shared<std::string>(fmt::format(
+        FMT_STRING("GET {} HTTP/1.1\r\nHost: {}\r\nAccept: */*\r\n{}"
+                   "Connection: keep-alive\r\n\r\n"),
+        req->mUrl.mTarget, req->mUrl.mHost, range));
+    asio::async_write(
+        req->mConnection->mSocket, asio::buffer(*request),
+        [self = shared_from_this(), req, request,
+         attempt = req->mAttempt](asio::error_code const& ec, std::size_t) {
+            if (isStale(*req, attempt))
+            {
+                return;
+            }
+            if (ec)
+            {
+                self->retryOrFail(req, "write: " + ec.message());
+                return;
+            }
+            self->readHeaders(req);
+        });
+}
+
+void
+HttpArchiveClient::readHeaders(std::shared_ptr<Request> const& req)
+{
+    auto& conn = *req->mConnection;
+    asio::async_read_until(
+        conn.mSocket, conn.mBuffer, "\r\n\r\n",
+        [self = shared_from_this(), req,
+         attempt = req->mAttempt](asio::error_code const& ec, std::size_t n) {
+            if (isStale(*req, attempt))
+            {
+                return;
+            }
+            if (ec)
+            {
+                self->retryOrFail(req, "read headers: " + ec.message());
+                return;
+            }
+            req->mGotHeaders = true;
+            self->armTimer(req);
+
+            auto& buf = req->mConnection->mBuffer;
+            std::string headers(asio::buffers_begin(buf.data()),
+                                asio::buffers_begin(buf.data()) + n);
+            buf.consume(n);
+
+            std::istringstream in(headers);
+            std::string version, status, line;
+            in >> version >> status;
+            std::getline(in, line);
+            if (version.rfind("HTTP/1.", 0) != 0)
+            {
+                req->mKeepAlive = false;
+                self->finish(req, "invalid response");
+                return;
+            }
+            req->mKeepAlive = version != "HTTP/1.0";
+
+            bool chunked = false;
+            std::string contentRange;
+            while (std::getline(in, line) && line != "\r")
+            {
+                auto colon = line.find(':');
+                if (colon == std::string::npos)
+                {
+                    continue;
+                }
+                std::string name = line.substr(0, colon);
+                std::string value = line.substr(colon + 1);
+                std::transform(name.begin(), name.end(), name.begin(),
+                               ::tolower);
+                std::transform(value.begin(), value.end(), value.begin(),
+                               ::tolower);
+                value.erase(0, value.find_first_not_of(" \t"));
+                value.erase(value.find_last_not_of(" \t\r") + 1);
+                if (name == "content-length")
+                {
+                    try
+                    {
+                        req->mRemaining = std::stoull(value);
+                    }
+                    catch (std::exception const&)
+                    {
+                        req->mKeepAlive = false;
+                        self->finish(req, "invalid content-length");
+                        return;
+                    }
+                }
+                else if (name == "content-range")
+                {
+                    contentRange = value;
+                }
+                else if (name == "transfer-encoding")
+                {
+                    chunked = value.find("chunked") != std::string::npos;
+                }
+                else if (name == "connection")
+                {
+                    if (value == "close")
+                    {
+                        req->mKeepAlive = false;
+                    }
+                    else if (value == "keep-alive")
+                    {
+                        req->mKeepAlive = true;
+                    }
+                }
+            }
+
+            auto error = self->checkResponse(req, status, contentRange);
+            if (!error.empty())
+            {
+                // Don't bother draining the error body
+                req->mKeepAlive = false;
+                self->finish(req, error);
+                return;
+            }
+
+            if (!req->mSink && !req->mOut.is_open())
+            {
+                req->mOut.open(req->mLocalPath, std::ios::out |
+                                                    std::ios::binary |
+                                                    std::ios::trunc);
+                if (!req->mOut)
+                {
+                    req->mKeepAlive = false;
+                    self->finish(req, "could not open " + req->mLocalPath);
+                    return;
+                }
+            }
+
+            if (chunked)
+            {
+                req->mRemaining.reset();
+                self->readChunkHeader(req);
+            }
+            else
+            {
+                if (!req->mRemaining)
+                {
+                    // Body delimited by the end of the connection
+                    req->mKeepAlive = false;
+                }
+                self->readBody(req);
+            }
+        });
+}
+
+bool
+HttpArchiveClient::drainBody(std::shared_ptr<Request> const& req)
+{
+    auto& buf = req->mConnection->mBuffer;
+    auto& remaining = req->mRemaining;
+    size_t n = remaining ? std::min(*remaining, buf.size()) : buf.size();
+    auto data = static_cast<char const*>(buf.data().data());
+    if (req->mSink)
+    {
+        try
+        {
+            req->mSink(data, n);
+        }
+        catch (std::exception const& e)
+        {
+            req->mKeepAlive = false;
+            finish(req, e.what());
+            return false;
+        }
+    }
+    else
+    {
+        req->mOut.write(data, n);
+    }
+    buf.consume(n);
+    req->mReceived += n;
+    if (remaining)
+    {
+        *remaining -= n;
+    }
+    return true;
+}
+
+void
+HttpArchiveClient::readBody(std::shared_ptr<Request> const& req)
+{
+    auto& buf = req->mConnection->mBuffer;
+    if (!drainBody(req))
+    {
+        return;
+    }
+    if (req->mRemaining && *req->mRemaining == 0)
+    {
+        finish(req, "");
+        return;
+    }
+
+    asio::async_read(
+        req->mConnection->mSocket, buf, asio::transfer_at_least(1),
+        [self = shared_from_this(), req,
+         attempt = req->mAttempt](asio::error_code const& ec, std::size_t) {
+            if (isStale(*req, attempt))
+            {
+                return;
+            }
+            if (ec == asio::error::eof && !req->mRemaining)
+            {
+                // End of a body delimited by the end of the connection
+                if (self->drainBody(req))
+                {
+                    self->finish(req, "");
+                }
+                return;
+            }
+            if (ec)
+            {
+                self->resumeOrFail(req, "read body: " + ec.message());
+                return;
+            }
+            self->armTimer(req);
+            self->readBody(req);
+        });
+}
+
+void
+HttpArchiveClient::readChunkHeader(std::shared_ptr<Request> const& req)
+{
+    auto& conn = *req->mConnection;
+    asio::async_read_until(
+        conn.mSocket, conn.mBuffer, "\r\n",
+        [self = shared_from_this(), req,
+         attempt = req->mAttempt](asio::error_code const& ec, std::size_t n) {
+            if (isStale(*req, attempt))
+            {
+                return;
+            }
+            if (ec)
+            {
+                self->resumeOrFail(req, "read chunk: " + ec.message());
+                return;
+            }
+            auto& buf = req->mConnection->mBuffer;
+            std::string line(asio::buffers_begin(buf.data()),
+                             asio::buffers_begin(buf.data()) + n);
+            buf.consume(n);
+            size_t size = 0;
+            try
+            {
+                // Chunk extensions after ';' are ignored by stoull
+                size = std::stoull(line, nullptr, 16);
+            }
+            catch (std::exception const&)
+            {
+                req->mKeepAlive = false;
+                self->finish(req, "invalid chunk size");
+                return;
+            }
+            if (size == 0)
+            {
+                self->readTrailer(req);
+                return;
+            }
+            req->mRemaining = size;
+            self->readChunkData(req);
+        });
+}
+
+void
+HttpArchiveClient::readChunkData(std::shared_ptr<Request> const& req)
+{
+    auto& buf = req->mConnection->mBuffer;
+    if (!drainBody(req))
+    {
+        return;
+    }
+    // Chunk data is followed by CRLF
+    if (*req->mRemaining == 0 && buf.size() >= 2)
+    {
+        buf.consume(2);
+        readChunkHeader(req);
+        return;
+    }
+
+    asio::async_read(
+        req->mConnection->mSocket, buf, asio::transfer_at_least(1),
+        [self = shared_from_this(), req,
+         attempt = req->mAttempt](asio::error_code const& ec, std::size_t) {
+            if (isStale(*req, attempt))
+            {
+                return;
+            }
+            if (ec)
+            {
+                self->resumeOrFail(req, "read chunk: " + ec.message());
+                return;
+            }
+            self->armTimer(req);
+            self->readChunkData(req);
+        });
+}
+
+void
+HttpArchiveClient::readTrailer(std::shared_ptr<Request> const& req)
+{
+    auto& conn = *req->mConnection;
+    asio::async_read_until(
+        conn.mSocket, conn.mBuffer, "\r\n",
+        [self = shared_from_this(), req,
+         attempt = req->mAttempt](asio::error_code const& ec, std::size_t n) {
+            if (isStale(*req, attempt))
+            {
+                return;
+            }
+            if (ec)
+            {
+                self->resumeOrFail(req, "read trailer: " + ec.message());
+                return;
+            }
+            req->mConnection->mBuffer.consume(n);
+            if (n == 2)
+            {
+                // Empty line ends the message
+                self->finish(req, "");
+            }
+            else
+            {
+                self->readTrailer(req);
+            }
+        });
+}
+
+void
+HttpArchiveClient::retryOrFail(std::shared_ptr<Request> const& req,
+                               std::string const& error)
+{
+    if (req->mReusedConnection && !req->mGotHeaders)
+    {
+        CLOG_DEBUG(History, "Pooled connection to {} went away, reconnecting",
+                   hostKey(req->mUrl));
+        asio::error_code ignored;
+        std::ignore = req->mConnection->mSocket.close(ignored);
+        connect(req);
+        return;
+    }
+    resumeOrFail(req, error);
+}
+
+void
+HttpArchiveClient::resumeOrFail(std::shared_ptr<Request> const& req,
+                                std::string const& error)
+{
+    if (req->mReceived > req->mResumedAt)
+    {
+        req->mStalledResumes = 0;
+    }
+    if (req->mReceived == 0 ||
+        req->mStalledResumes >= MAX_RESUMES_WITHOUT_PROGRESS)
+    {
+        finish(req, error);
+        return;
+    }
+
+    CLOG_DEBUG(History, "Download of {} from {} failed after {} bytes: {}, "
+               "resuming",
+               req->mUrl.mTarget, hostKey(req->mUrl), req->mReceived, error);
+    mResumeMeter.Mark();
+    ++req->mStalledResumes;
+    req->mResumedAt = req->mReceived;
+    ++req->mAttempt;
+    asio::error_code ignored;
+    std::ignore = req->mConnection->mSocket.close(ignored);
+    req->mGotHeaders = false;
+    req->mKeepAlive = true;
+    req->mRemaining.reset();
+    armTimer(req);
+    connect(req);
+}
+
+std::string
+HttpArchiveClient::checkResponse(std::shared_ptr<Request> const& req,
+                                 std::string const& status,
+                                 std::string const& contentRange)
+{
+    if (req->mReceived == 0)
+    {
+        return status == "200" ? "" : "HTTP status " + status;
+    }
+
+    if (status == "206")
+    {
+        // Content-Range: bytes <first>-<last>/<total>
+        auto expected = fmt::format(FMT_STRING("bytes {}-"), req->mReceived);
+        if (contentRange.rfind(expected, 0) != 0)
+        {
+            return "unexpected content-range '" + contentRange + "'";
+        }
+        return "";
+    }
+    if (status == "200" && !req->mSink)
+    {
+        // The server ignored the Range header and sends the whole file again
+        CLOG_DEBUG(History, "{} does not support range requests, restarting {}",
+                   hostKey(req->mUrl), req->mUrl.mTarget);
+        req->mOut.close();
+        req->mReceived = 0;
+        req->mResumedAt = 0;
+        return "";
+    }
+    return "HTTP status " + status + " when resuming";
+}
+
+void
+HttpArchiveClient::finish(std::shared_ptr<Request> const& req,
+                          std::string const& error, bool notify)
+{
+    if (req->mDone)
+    {
+        return;
+    }
+    req->mDone = true;
+    req->mTimer->cancel();
+    if (req->mOut.is_open())
+    {
+        req->mOut.close();
+    }
+
+    auto key = hostKey(req->mUrl);
+    auto& host = mHosts[key];
+    releaseAssert(host.mActive > 0);
+    --host.mActive;
+
+    bool ok = error.empty() && !req->mOut.fail();
+    if (ok && req->mKeepAlive &&
+        host.mIdle.size() < MAX_IDLE_CONNECTIONS_PER_HOST)
+    {
+        host.mIdle.emplace_back(std::move(req->mConnection));
+    }
+    else if (req->mConnection)
+    {
+        asio::error_code ignored;
+        std::ignore = req->mConnection->mSocket.close(ignored);
+        req->mConnection.reset();
+    }
+
+    if (notify)
+    {
+        // Additive increase, multiplicative decrease
+        if (ok)
+        {
+            host.mLimit = std::min(MAX_CONNECTIONS_PER_HOST,
+                                   host.mLimit + 1.0 / host.mLimit);
+        }
+        else
+        {
+            host.mLimit = std::max(1.0, host.mLimit / 2);
+            CLOG_DEBUG(History, "Download of {} from {} failed: {}",
+                       req->mUrl.mTarget, key, error);
+        }
+        auto handler = std::move(req->mHandler);
+        handler(ok ? "" : (error.empty() ? "write failed" : error));
+    }
+    pump(key);
+}
+
+#ifdef BUILD_TESTS
+double
+HttpArchiveClient::getConnectionLimit(Url const& url) const
+{
+    auto it = mHosts.find(hostKey(url));
+    return it == mHosts.end() ? INITIAL_CONNECTIONS_PER_HOST
+                              : it->second.mLimit;
+}
+
+size_t
+HttpArchiveClient::getIdleConnectionCount(Url const& url) const
+{
+    auto it = mHosts.find(hostKey(url));
+    return it == mHosts.end() ? 0 : it->second.mIdle.size();
+}
+#endif
+}
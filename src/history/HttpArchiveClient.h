@@ -0,0 +1,145 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/NonCopyable.h"
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace medida
+{
+class Meter;
+}
+
+namespace stellar
+{
+
+class Application;
+
+/**
+ * In-process HTTP/1.1 client for downloading files from history archives
+ * served over plain HTTP, used instead of spawning one `curl` per file.
+ *
+ * Connections are kept alive and pooled per host. The number of concurrent
+ * connections to a host adapts to how the host behaves: it grows by about one
+ * for every window of successful downloads and is halved on every failure,
+ * between 1 and MAX_CONNECTIONS_PER_HOST. Downloads beyond that limit wait
+ * for a free connection.
+ *
+ * A download interrupted after part of the body arrived is resumed on a new
+ * connection with a Range request for the rest, as long as resuming keeps
+ * making progress. Servers that ignore the Range header restart file downloads
+ * from scratch. Callers still verify the complete file.
+ *
+ * Must only be used from the main thread; all I/O runs on the main IO context.
+ */
+class HttpArchiveClient
+    : public std::enable_shared_from_this<HttpArchiveClient>,
+      private NonMovableOrCopyable
+{
+  public:
+    struct Url
+    {
+        std::string mHost;
+        std::string mPort;
+        std::string mTarget;
+    };
+
+    // Parse `http://host[:port]/path`. Returns nullopt for anything else,
+    // including https URLs.
+    static std::optional<Url> parseUrl(std::string const& url);
+
+    // Called on the main thread when a download ends, with an empty `error`
+    // on success.
+    using Handler = std::function<void(std::string const& error)>;
+
+    // Receives each block of a response body as it arrives. Throwing fails
+    // the download with the exception's message as the error.
+    using BodySink = std::function<void(char const* data, size_t size)>;
+
+    struct Request;
+
+    static constexpr double INITIAL_CONNECTIONS_PER_HOST = 4;
+    static constexpr double MAX_CONNECTIONS_PER_HOST = 32;
+    // A download fails if no data arrives for this long
+    static constexpr std::chrono::seconds INACTIVITY_TIMEOUT{30};
+    // A download fails after this many resumes in a row that received nothing
+    static constexpr size_t MAX_RESUMES_WITHOUT_PROGRESS = 3;
+
+    explicit HttpArchiveClient(Application& app);
+
+    // Download `url` into `localPath`, overwriting it. The returned request
+    // can be passed to `cancel`.
+    std::shared_ptr<Request> get(Url const& url, std::string const& localPath,
+                                 Handler handler);
+
+    // Download `url`, handing the body to `sink` instead of writing it to a
+    // file. The sink is never called for a failed response, but may have seen
+    // part of the body when the download fails midway.
+    std::shared_ptr<Request> get(Url const& url, BodySink sink,
+                                 Handler handler);
+
+    // Abort a download; its handler is not called.
+    void cancel(std::shared_ptr<Request> const& request);
+
+#ifdef BUILD_TESTS
+    double getConnectionLimit(Url const& url) const;
+    size_t getIdleConnectionCount(Url const& url) const;
+#endif
+
+  private:
+    struct Connection;
+    struct Host
+    {
+        std::vector<std::shared_ptr<Connection>> mIdle;
+        std::deque<std::shared_ptr<Request>> mQueued;
+        size_t mActive{0};
+        double mLimit{INITIAL_CONNECTIONS_PER_HOST};
+    };
+
+    Application& mApp;
+    std::map<std::string, Host> mHosts;
+    medida::Meter& mConnectMeter;
+    medida::Meter& mReuseMeter;
+    medida::Meter& mResumeMeter;
+
+    static std::string hostKey(Url const& url);
+
+    std::shared_ptr<Request> enqueue(std::shared_ptr<Request> req);
+    void pump(std::string const& key);
+    void connect(std::shared_ptr<Request> const& req);
+    void sendRequest(std::shared_ptr<Request> const& req);
+    void readHeaders(std::shared_ptr<Request> const& req);
+    void readBody(std::shared_ptr<Request> const& req);
+    void readChunkHeader(std::shared_ptr<Request> const& req);
+    void readChunkData(std::shared_ptr<Request> const& req);
+    void readTrailer(std::shared_ptr<Request> const& req);
+    // Hand the buffered part of the body to the request's file or sink.
+    // Returns false if that failed, in which case the request is finished.
+    bool drainBody(std::shared_ptr<Request> const& req);
+    void armTimer(std::shared_ptr<Request> const& req);
+    // Retry once on a fresh connection if a pooled one turns out to have been
+    // closed by the server, otherwise fail the download
+    void retryOrFail(std::shared_ptr<Request> const& req,
+                     std::string const& error);
+    // Continue a download that failed after receiving part of its body with a
+    // Range request on a fresh connection, otherwise fail it
+    void resumeOrFail(std::shared_ptr<Request> const& req,
+                      std::string const& error);
+    // Check the status line and headers of a response, returning an error
+    // if the body should not be read
+    std::string checkResponse(std::shared_ptr<Request> const& req,
+                              std::string const& status,
+                              std::string const& contentRange);
+    void finish(std::shared_ptr<Request> const& req, std::string const& error,
+                bool notify = true);
+};
+}
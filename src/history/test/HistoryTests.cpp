@@ -2,15 +2,22 @@
 // under the Apache License, Version 2.0. See the COPYING file at the root
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
+// ASIO is somewhat particular about when it gets included -- it wants to be the
+// first to include <windows.h> -- so we try to include it before everything
+// else.
+#include "util/asio.h"
+
 #include "bucket/BucketManager.h"
 #include "bucket/test/BucketTestUtils.h"
 #include "catchup/LedgerApplyManagerImpl.h"
 #include "catchup/test/CatchupWorkTests.h"
+#include "crypto/Random.h"
 #include "herder/HerderPersistence.h"
 #include "history/CheckpointBuilder.h"
 #include "history/FileTransferInfo.h"
 #include "history/HistoryArchiveManager.h"
 #include "history/HistoryManagerImpl.h"
+#include "history/HttpArchiveClient.h"
 #include "history/test/HistoryTestsUtils.h"
 #include "historywork/GetHistoryArchiveStateWork.h"
 #include "historywork/GunzipFileWork.h"
@@ -35,6 +42,9 @@
 #include "historywork/VerifyTxResultsWork.h"
 #include <fmt/format.h>
 #include <lib/catch.hpp>
+#include <medida/counter.h>
+#include <medida/meter.h>
+#include <medida/metrics_registry.h>
 
 using namespace stellar;
 using namespace historytestutils;
@@ -164,6 +174,7 @@ TEST_CASE("History bucket verification", "[history][catchup]")
      * verification was successful. **/
 
     Config cfg(getTestConfig());
+    cfg.BUCKET_VERIFY_PIPELINED_HASHING = GENERATE(false, true);
     VirtualClock clock;
     auto cg = std::make_shared<TmpDirHistoryConfigurator>();
     cg->configure(cfg, true);
@@ -340,6 +351,64 @@ TEST_CASE("History bucket verification", "[history][catchup]")
     }
 }
 
+TEST_CASE("History bucket cache", "[history][catchup]")
+{
+    Config cfg(getTestConfig());
+    TmpDirManager cacheDirManager("bucket-cache-" + binToHex(randomBytes(8)));
+    auto cacheDir = cacheDirManager.tmpDir("cache");
+    cfg.BUCKET_CACHE_DIR = cacheDir.getName();
+    VirtualClock clock;
+    auto cg = std::make_shared<TmpDirHistoryConfigurator>();
+    cg->configure(cfg, true);
+    Application::pointer app = createTestApplication(clock, cfg);
+    REQUIRE(app->getHistoryArchiveManager().initializeHistoryArchive(
+        cg->getArchiveDirName()));
+
+    auto bucketGenerator = TestBucketGenerator{
+        *app, app->getHistoryArchiveManager().getHistoryArchive(
+                  cg->getArchiveDirName())};
+    auto& wm = app->getWorkScheduler();
+    std::map<std::string, std::shared_ptr<LiveBucket>> buckets;
+    std::map<std::string, std::shared_ptr<HotArchiveBucket>> hotBuckets;
+    auto tmpDir = app->getTmpDirManager().tmpDir("bucket-cache-test");
+
+    // Download a bucket from the archive once, then move it from the archive
+    // to the cache
+    std::vector<std::string> liveHashes{
+        bucketGenerator.generateBucket<LiveBucket>(
+            TestBucketState::CONTENTS_AND_HASH_OK)};
+    auto download = wm.executeWork<DownloadBucketsWork>(
+        buckets, hotBuckets, liveHashes, std::vector<std::string>(), tmpDir);
+    REQUIRE(download->getState() == BasicWork::State::WORK_SUCCESS);
+
+    auto cached = cacheDir.getName() + "/bucket-" + liveHashes[0] + ".xdr";
+    std::filesystem::copy_file(buckets.at(liveHashes[0])->getFilename(),
+                               cached);
+    FileTransferInfo ft(tmpDir, FileType::HISTORY_FILE_TYPE_BUCKET,
+                        liveHashes[0]);
+    std::filesystem::remove(cg->getArchiveDirName() + "/" + ft.remoteName());
+
+    SECTION("bucket in cache")
+    {
+        buckets.clear();
+        auto fromCache = wm.executeWork<DownloadBucketsWork>(
+            buckets, hotBuckets, liveHashes, std::vector<std::string>(),
+            tmpDir);
+        REQUIRE(fromCache->getState() == BasicWork::State::WORK_SUCCESS);
+        REQUIRE(buckets.count(liveHashes[0]) == 1);
+        // The cache is left alone
+        REQUIRE(std::filesystem::exists(cached));
+    }
+    SECTION("corrupt bucket in cache")
+    {
+        std::ofstream(cached, std::ios::app) << "garbage";
+        auto fromCache = wm.executeWork<DownloadBucketsWork>(
+            buckets, hotBuckets, liveHashes, std::vector<std::string>(),
+            tmpDir);
+        REQUIRE(fromCache->getState() == BasicWork::State::WORK_FAILURE);
+    }
+}
+
 TEST_CASE("Ledger chain verification", "[ledgerheaderverification]")
 {
     Config cfg(getTestConfig(0));
@@ -617,6 +686,26 @@ TEST_CASE("History publish", "[history][publish]")
     catchupSimulation.ensureOfflineCatchupPossible(checkpointLedger);
 }
 
+TEST_CASE("History publish keeps gzipped buckets", "[history][publish]")
+{
+    CatchupSimulation catchupSimulation{};
+    auto checkpointLedger = catchupSimulation.getLastCheckpointLedger(2);
+    catchupSimulation.ensureOfflineCatchupPossible(checkpointLedger);
+
+    // Gzipped buckets stay next to their bucket for later publishes, and go
+    // away with it
+    auto const& bucketDir =
+        catchupSimulation.getApp().getBucketManager().getBucketDir();
+    auto gzipped = fs::findfiles(bucketDir, [](std::string const& name) {
+        return name.size() > 3 && name.substr(name.size() - 3) == ".gz";
+    });
+    REQUIRE(!gzipped.empty());
+    for (auto const& name : gzipped)
+    {
+        REQUIRE(fs::exists(bucketDir + "/" + name.substr(0, name.size() - 3)));
+    }
+}
+
 void
 validateCheckpointFiles(Application& app, uint32_t ledger, bool isFinalized)
 {
@@ -1683,6 +1772,12 @@ TEST_CASE("persist publish queue", "[history][publish][acceptance]")
             app1->getMaintainer().performMaintenance(50000);
         }
 
+        auto& metrics = app1->getMetrics();
+        REQUIRE(metrics.NewMeter({"history", "publish", "bytes"}, "byte")
+                    .count() > 0);
+        REQUIRE(metrics.NewCounter({"history", "publish", "queue"}).count() ==
+                HistoryManager::publishQueueLength(hm1.getConfig()));
+
         // Verify old history got trimmed
         XDROutputFileStream out(app1->getClock().getIOContext(), true);
         // Ledgers to add to genesis, maintenance keeps at least one checkpoint
@@ -1933,6 +2028,26 @@ TEST_CASE("Change ordering of buffered ledgers", "[history][catchup]")
     }
 }
 
+TEST_CASE("Catchup with buffered ledgers spilled to disk", "[history][catchup]")
+{
+    CatchupSimulation catchupSimulation{};
+
+    auto checkpointLedger = catchupSimulation.getLastCheckpointLedger(1);
+    catchupSimulation.ensureOnlineCatchupPossible(checkpointLedger, 15);
+
+    auto app = catchupSimulation.createCatchupApplication(
+        std::numeric_limits<uint32_t>::max(), Config::TESTDB_DEFAULT, "app2");
+    auto& lam =
+        static_cast<LedgerApplyManagerImpl&>(app->getLedgerApplyManager());
+    // Spill every ledger that isn't applied right away
+    lam.mBufferedTxSetsLimit = 1;
+    auto& spilled = app->getMetrics().NewMeter(
+        {"ledger", "memory", "spilled-ledgers"}, "ledger");
+
+    REQUIRE(catchupSimulation.catchupOnline(app, checkpointLedger, 5));
+    REQUIRE(spilled.count() > 0);
+}
+
 TEST_CASE("Introduce and fix gap without starting catchup",
           "[history][catchup]")
 {
@@ -2038,6 +2153,7 @@ TEST_CASE("CheckpointBuilder", "[history][publish]")
     VirtualClock clock;
     auto cfg = getTestConfig(0, Config::TESTDB_BUCKET_DB_PERSISTENT);
     TmpDirHistoryConfigurator().configure(cfg, true);
+    cfg.CHECKPOINT_FSYNC_INTERVAL_LEDGERS = GENERATE(1, 4);
 
     auto app = createTestApplication(clock, cfg);
     releaseAssert(app->getLedgerManager().getLastClosedLedgerNum() ==
@@ -2106,3 +2222,240 @@ TEST_CASE("CheckpointBuilder", "[history][publish]")
         validateCheckpointFiles(*app, ledgerSeq, true);
     }
 }
+
+TEST_CASE("history archive get command as URL", "[history]")
+{
+    auto urlFor = [](std::string const& getCmd) {
+        HistoryArchiveConfiguration cfg;
+        cfg.mName = "test";
+        cfg.mGetCmd = getCmd;
+        return HistoryArchive(cfg).getFileUrl("ledger/00/00/3f/l.xdr.gz");
+    };
+
+    REQUIRE(urlFor("curl -sf http://example.com/prd/{0} -o {1}") ==
+            "http://example.com/prd/ledger/00/00/3f/l.xdr.gz");
+    REQUIRE(urlFor("curl --silent --fail -o {1} http://example.com:8080/{0}") ==
+            "http://example.com:8080/ledger/00/00/3f/l.xdr.gz");
+    REQUIRE(!urlFor("curl -sf https://example.com/{0} -o {1}"));
+    REQUIRE(!urlFor("curl -sf -H 'Auth: x' http://example.com/{0} -o {1}"));
+    REQUIRE(!urlFor("wget -q http://example.com/{0} -O {1}"));
+    REQUIRE(!urlFor("cp /var/archive/{0} {1}"));
+    REQUIRE(!urlFor(""));
+
+    auto url = HttpArchiveClient::parseUrl("http://example.com:8080/a/b");
+    REQUIRE(url);
+    REQUIRE(url->mHost == "example.com");
+    REQUIRE(url->mPort == "8080");
+    REQUIRE(url->mTarget == "/a/b");
+    REQUIRE(HttpArchiveClient::parseUrl("http://example.com/")->mPort == "80");
+    REQUIRE(!HttpArchiveClient::parseUrl("http://example.com"));
+    REQUIRE(!HttpArchiveClient::parseUrl("https://example.com/a"));
+}
+
+TEST_CASE("HTTP archive client", "[history]")
+{
+    VirtualClock clock(VirtualClock::REAL_TIME);
+    auto app = createTestApplication(clock, getTestConfig());
+    auto tmpDir = app->getTmpDirManager().tmpDir("http-archive-client");
+    auto& client = app->getHistoryArchiveManager().getHttpArchiveClient();
+
+    // Serves canned responses, in order, to every request on every connection
+    std::vector<std::string> responses = {
+        "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello",
+        "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+        "3\r\nabc\r\n2\r\nde\r\n0\r\n\r\n",
+        "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n"};
+    size_t nextResponse = 0;
+    size_t accepted = 0;
+    asio::ip::tcp::acceptor acceptor(
+        clock.getIOContext(),
+        asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+    std::function<void(std::shared_ptr<asio::ip::tcp::socket>,
+                       std::shared_ptr<asio::streambuf>)>
+        serve = [&](std::shared_ptr<asio::ip::tcp::socket> socket,
+                    std::shared_ptr<asio::streambuf> buf) {
+            asio::async_read_until(
+                *socket, *buf, "\r\n\r\n",
+                [&, socket, buf](asio::error_code const& ec, std::size_t n) {
+                    if (ec)
+                    {
+                        return;
+                    }
+                    buf->consume(n);
+                    auto response = std::make_shared<std::string>(
+                        responses.at(nextResponse++));
+                    asio::async_write(*socket, asio::buffer(*response),
+                                      [&, socket, buf, response](
+                                          asio::error_code const& writeEc,
+                                          std::size_t) {
+                                          if (!writeEc)
+                                          {
+                                              serve(socket, buf);
+                                          }
+                                      });
+                });
+        };
+    auto socket = std::make_shared<asio::ip::tcp::socket>(clock.getIOContext());
+    acceptor.async_accept(*socket, [&](asio::error_code const& ec) {
+        if (!ec)
+        {
+            ++accepted;
+            serve(socket, std::make_shared<asio::streambuf>());
+        }
+    });
+
+    auto base = fmt::format("http://127.0.0.1:{}/",
+                            acceptor.local_endpoint().port());
+    auto download = [&](std::string const& name) {
+        std::optional<std::string> result;
+        client.get(*HttpArchiveClient::parseUrl(base + name),
+                   tmpDir.getName() + "/" + name,
+                   [&](std::string const& error) { result = error; });
+        auto deadline = clock.now() + std::chrono::seconds(10);
+        while (!result && clock.now() < deadline)
+        {
+            clock.crank(false);
+        }
+        REQUIRE(result);
+        return *result;
+    };
+    auto contents = [&](std::string const& name) {
+        std::ifstream in(tmpDir.getName() + "/" + name);
+        return std::string(std::istreambuf_iterator<char>(in), {});
+    };
+
+    auto url = *HttpArchiveClient::parseUrl(base + "a");
+    auto limit = client.getConnectionLimit(url);
+
+    REQUIRE(download("a").empty());
+    REQUIRE(contents("a") == "hello");
+    REQUIRE(client.getIdleConnectionCount(url) == 1);
+    REQUIRE(client.getConnectionLimit(url) > limit);
+
+    // Same connection, chunked body
+    REQUIRE(download("b").empty());
+    REQUIRE(contents("b") == "abcde");
+    REQUIRE(accepted == 1);
+
+    limit = client.getConnectionLimit(url);
+    REQUIRE(download("missing") == "HTTP status 404");
+    REQUIRE(client.getConnectionLimit(url) == limit / 2);
+    REQUIRE(client.getIdleConnectionCount(url) == 0);
+}
+
+TEST_CASE("HTTP archive client resumes interrupted downloads", "[history]")
+{
+    VirtualClock clock(VirtualClock::REAL_TIME);
+    auto app = createTestApplication(clock, getTestConfig());
+    auto tmpDir = app->getTmpDirManager().tmpDir("http-archive-resume");
+    auto& client = app->getHistoryArchiveManager().getHttpArchiveClient();
+    auto& resumes =
+        app->getMetrics().NewMeter({"history", "http", "resume"}, "download");
+    auto resumesBefore = resumes.count();
+
+    // Answers one request per connection with the next canned response, then
+    // closes the connection, cutting short any body still expected
+    std::vector<std::string> responses;
+    std::vector<std::string> requests;
+    asio::ip::tcp::acceptor acceptor(
+        clock.getIOContext(),
+        asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+    std::function<void()> accept = [&]() {
+        auto socket =
+            std::make_shared<asio::ip::tcp::socket>(clock.getIOContext());
+        acceptor.async_accept(*socket, [&, socket](asio::error_code const& ec) {
+            if (ec)
+            {
+                return;
+            }
+            accept();
+            auto buf = std::make_shared<asio::streambuf>();
+            asio::async_read_until(
+                *socket, *buf, "\r\n\r\n",
+                [&, socket, buf](asio::error_code const& readEc, std::size_t) {
+                    if (readEc || requests.size() >= responses.size())
+                    {
+                        return;
+                    }
+                    requests.emplace_back(
+                        asio::buffers_begin(buf->data()),
+                        asio::buffers_end(buf->data()));
+                    auto response = std::make_shared<std::string>(
+                        responses.at(requests.size() - 1));
+                    asio::async_write(
+                        *socket, asio::buffer(*response),
+                        [socket, response](asio::error_code const&,
+                                           std::size_t) {
+                            asio::error_code ignored;
+                            std::ignore = socket->close(ignored);
+                        });
+                });
+        });
+    };
+    accept();
+
+    auto base = fmt::format("http://127.0.0.1:{}/",
+                            acceptor.local_endpoint().port());
+    auto path = tmpDir.getName() + "/file";
+    std::optional<std::string> result;
+    client.get(*HttpArchiveClient::parseUrl(base + "file"), path,
+               [&](std::string const& error) { result = error; });
+    auto wait = [&]() {
+        auto deadline = clock.now() + std::chrono::seconds(10);
+        while (!result && clock.now() < deadline)
+        {
+            clock.crank(false);
+        }
+        REQUIRE(result);
+    };
+    auto contents = [&]() {
+        std::ifstream in(path);
+        return std::string(std::istreambuf_iterator<char>(in), {});
+    };
+
+    SECTION("server supports ranges")
+    {
+        responses = {"HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\nhello",
+                     "HTTP/1.1 206 Partial Content\r\nContent-Length: 5\r\n"
+                     "Content-Range: bytes 5-9/10\r\n\r\nworld"};
+        wait();
+        REQUIRE(result->empty());
+        REQUIRE(contents() == "helloworld");
+        REQUIRE(requests.size() == 2);
+        REQUIRE(requests[0].find("Range:") == std::string::npos);
+        REQUIRE(requests[1].find("Range: bytes=5-\r\n") != std::string::npos);
+        REQUIRE(resumes.count() == resumesBefore + 1);
+    }
+    SECTION("server ignores ranges")
+    {
+        responses = {"HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\nhello",
+                     "HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\n"
+                     "helloworld"};
+        wait();
+        REQUIRE(result->empty());
+        REQUIRE(contents() == "helloworld");
+    }
+    SECTION("server sends the wrong range")
+    {
+        responses = {"HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\nhello",
+                     "HTTP/1.1 206 Partial Content\r\nContent-Length: 5\r\n"
+                     "Content-Range: bytes 0-4/10\r\n\r\nhello"};
+        wait();
+        REQUIRE(*result == "unexpected content-range 'bytes 0-4/10'");
+    }
+    SECTION("resuming makes no progress")
+    {
+        responses = {"HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\nhello"};
+        for (size_t i = 0; i < HttpArchiveClient::MAX_RESUMES_WITHOUT_PROGRESS;
+             ++i)
+        {
+            responses.emplace_back("HTTP/1.1 206 Partial Content\r\n"
+                                   "Content-Length: 5\r\n"
+                                   "Content-Range: bytes 5-9/10\r\n\r\n");
+        }
+        wait();
+        REQUIRE(!result->empty());
+        REQUIRE(requests.size() ==
+                HttpArchiveClient::MAX_RESUMES_WITHOUT_PROGRESS + 1);
+    }
+}
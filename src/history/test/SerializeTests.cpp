@@ -16,7 +16,8 @@ TEST_CASE("Serialization round trip", "[history]")
         "stellar-history.testnet.6714239.json",
         "stellar-history.livenet.15686975.json",
         "stellar-history.testnet.6714239.networkPassphrase.json",
-        "stellar-history.testnet.6714239.networkPassphrase.v2.json"};
+        "stellar-history.testnet.6714239.networkPassphrase.v2.json",
+        "stellar-history.testnet.6714239.networkPassphrase.v2.zstd.json"};
     for (size_t i = 0; i < testFiles.size(); i++)
     {
         std::string fnPath = "testdata/";
@@ -41,3 +42,21 @@ TEST_CASE("Serialization round trip", "[history]")
         }
     }
 }
+
+TEST_CASE("Serialization of advertised compressions", "[history]")
+{
+    HistoryArchiveState has;
+    REQUIRE(!has.hasZstdFiles());
+    REQUIRE(has.toString().find("compressions") == std::string::npos);
+
+    has.setHasZstdFiles();
+    has.setHasZstdFiles();
+    REQUIRE(has.compressions ==
+            std::vector<std::string>{
+                HistoryArchiveState::HISTORY_ARCHIVE_ZSTD_COMPRESSION});
+
+    HistoryArchiveState roundTrip;
+    roundTrip.fromString(has.toString());
+    REQUIRE(roundTrip.hasZstdFiles());
+    REQUIRE(roundTrip.toString() == has.toString());
+}
@@ -107,7 +107,9 @@ template <typename BucketT>
 std::pair<std::shared_ptr<BasicWork>, std::function<bool(Application&)>>
 DownloadBucketsWork::prepareWorkForBucketType(
     std::string const& hash, FileTransferInfo const& ft,
-    OnFailureCallback const& failureCb, BucketState<BucketT>& state)
+    OnFailureCallback const& failureCb,
+    std::function<std::optional<uint256>()> const& knownHashCb,
+    BucketState<BucketT>& state)
 {
     std::weak_ptr<DownloadBucketsWork> weakSelf(
         std::static_pointer_cast<DownloadBucketsWork>(
@@ -120,7 +122,7 @@ DownloadBucketsWork::prepareWorkForBucketType(
 
     auto verifyWork = std::make_shared<VerifyBucketWork<BucketT>>(
         mApp, ft.localPath_nogz(), hexToBin256(hash), indexIter->second,
-        failureCb);
+        failureCb, knownHashCb, /*compress=*/true);
 
     auto adoptBucketCb = [weakSelf, ft, hash, currId](Application& app) {
         // C++17 does not support templated lambdas, so we have to manually
@@ -148,6 +150,48 @@ DownloadBucketsWork::prepareWorkForBucketType(
     return {verifyWork, adoptBucketCb};
 }
 
+std::optional<std::filesystem::path>
+DownloadBucketsWork::findCachedBucket(std::string const& hash) const
+{
+    auto const& dir = mApp.getConfig().BUCKET_CACHE_DIR;
+    if (dir.empty())
+    {
+        return std::nullopt;
+    }
+    auto path = std::filesystem::path(dir) / ("bucket-" + hash + ".xdr");
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(path, ec))
+    {
+        return std::nullopt;
+    }
+    return path;
+}
+
+bool
+DownloadBucketsWork::linkCachedBucket(std::filesystem::path const& cached,
+                                      std::string const& dest)
+{
+    // The link (or copy) is what gets adopted into the bucket directory, so
+    // the cache itself is never modified
+    std::error_code ec;
+    std::filesystem::remove(dest, ec);
+    std::filesystem::create_hard_link(cached, dest, ec);
+    if (ec)
+    {
+        // Most likely the cache is on another filesystem
+        ec.clear();
+        std::filesystem::copy_file(cached, dest, ec);
+    }
+    if (ec)
+    {
+        CLOG_WARNING(History, "Failed to take bucket {} from cache: {}",
+                     cached.string(), ec.message());
+        return false;
+    }
+    CLOG_DEBUG(History, "Took bucket {} from cache", cached.string());
+    return true;
+}
+
 std::shared_ptr<BasicWork>
 DownloadBucketsWork::yieldMoreWork()
 {
@@ -159,7 +203,8 @@ DownloadBucketsWork::yieldMoreWork()
 
     // Every Bucket we need to download goes through three steps each, which are
     // all handled by a separate work:
-    // 1. Download the bucket file from the archive and unzip it (getFileWork)
+    // 1. Download the bucket file from the archive and unzip it, or take it
+    // from BUCKET_CACHE_DIR (getFileWork)
     // 2. Verify and index the bucket file (verifyWork)
     // 3. Once verified, pass the Bucket to the BucketManager to be adopted and
     // tracked (adoptWork) First, we iterate through all the live buckets, then
@@ -171,22 +216,52 @@ DownloadBucketsWork::yieldMoreWork()
 
     auto const ft = FileTransferInfo(mDownloadDir,
                                      FileType::HISTORY_FILE_TYPE_BUCKET, hash);
-    auto getFileWork =
-        std::make_shared<GetAndUnzipRemoteFileWork>(mApp, ft, mArchive);
 
-    auto getFileWeakPtr = std::weak_ptr<GetAndUnzipRemoteFileWork>(getFileWork);
-    OnFailureCallback failureCb = [getFileWeakPtr, hash]() {
-        auto getFile = getFileWeakPtr.lock();
-        if (getFile)
-        {
-            auto ar = getFile->getArchive();
-            if (ar)
+    std::shared_ptr<BasicWork> getFileWork;
+    OnFailureCallback failureCb;
+    std::function<std::optional<uint256>()> knownHashCb;
+    auto cached = findCachedBucket(hash);
+    if (cached)
+    {
+        getFileWork = std::make_shared<WorkWithCallback>(
+            mApp, "link-cached-bucket-" + hash,
+            [cached = *cached, ft](Application&) {
+                return linkCachedBucket(cached, ft.localPath_nogz());
+            });
+        failureCb = [cached = *cached]() {
+            CLOG_INFO(History, "Bucket {} from BUCKET_CACHE_DIR",
+                      cached.string());
+        };
+        knownHashCb = []() -> std::optional<uint256> { return std::nullopt; };
+    }
+    else
+    {
+        auto getAndUnzip =
+            std::make_shared<GetAndUnzipRemoteFileWork>(mApp, ft, mArchive);
+        getFileWork = getAndUnzip;
+
+        auto getFileWeakPtr =
+            std::weak_ptr<GetAndUnzipRemoteFileWork>(getAndUnzip);
+        failureCb = [getFileWeakPtr, hash]() {
+            auto getFile = getFileWeakPtr.lock();
+            if (getFile)
             {
-                CLOG_INFO(History, "Bucket {} from archive {}", hash,
-                          ar->getName());
+                auto ar = getFile->getArchive();
+                if (ar)
+                {
+                    CLOG_INFO(History, "Bucket {} from archive {}", hash,
+                              ar->getName());
+                }
             }
-        }
-    };
+        };
+
+        // Set if the bucket was hashed while it was downloaded, see
+        // EXPERIMENTAL_STREAMING_HISTORY_GET
+        knownHashCb = [getFileWeakPtr]() -> std::optional<uint256> {
+            auto getFile = getFileWeakPtr.lock();
+            return getFile ? getFile->getUnzippedHash() : std::nullopt;
+        };
+    }
 
     std::shared_ptr<BasicWork> verifyWork;
     std::function<bool(Application&)> adoptBucketCb;
@@ -194,14 +269,14 @@ DownloadBucketsWork::yieldMoreWork()
     if (isHotHash)
     {
         std::tie(verifyWork, adoptBucketCb) =
-            prepareWorkForBucketType<HotArchiveBucket>(hash, ft, failureCb,
-                                                       mHotBucketsState);
+            prepareWorkForBucketType<HotArchiveBucket>(
+                hash, ft, failureCb, knownHashCb, mHotBucketsState);
     }
     else
     {
         std::tie(verifyWork, adoptBucketCb) =
-            prepareWorkForBucketType<LiveBucket>(hash, ft, failureCb,
-                                                 mLiveBucketsState);
+            prepareWorkForBucketType<LiveBucket>(
+                hash, ft, failureCb, knownHashCb, mLiveBucketsState);
     }
 
     auto adoptWork = std::make_shared<WorkWithCallback>(
@@ -227,11 +302,13 @@ template std::pair<std::shared_ptr<BasicWork>,
                    std::function<bool(Application&)>>
 DownloadBucketsWork::prepareWorkForBucketType<LiveBucket>(
     std::string const&, FileTransferInfo const&, OnFailureCallback const&,
+    std::function<std::optional<uint256>()> const&,
     DownloadBucketsWork::BucketState<LiveBucket>&);
 
 template std::pair<std::shared_ptr<BasicWork>,
                    std::function<bool(Application&)>>
 DownloadBucketsWork::prepareWorkForBucketType<HotArchiveBucket>(
     std::string const&, FileTransferInfo const&, OnFailureCallback const&,
+    std::function<std::optional<uint256>()> const&,
     DownloadBucketsWork::BucketState<HotArchiveBucket>&);
 }
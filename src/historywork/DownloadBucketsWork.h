@@ -8,6 +8,9 @@
 #include "historywork/Progress.h"
 #include "util/TmpDir.h"
 #include "work/BatchWork.h"
+#include <filesystem>
+#include <functional>
+#include <optional>
 
 namespace stellar
 {
@@ -50,6 +53,13 @@ class DownloadBucketsWork : public BatchWork
     TmpDir const& mDownloadDir;
     std::shared_ptr<HistoryArchive> mArchive;
 
+    // Path of the bucket in BUCKET_CACHE_DIR, if it is there
+    std::optional<std::filesystem::path>
+    findCachedBucket(std::string const& hash) const;
+    // Hard-link (or copy) a bucket from BUCKET_CACHE_DIR to `dest`
+    static bool linkCachedBucket(std::filesystem::path const& cached,
+                                 std::string const& dest);
+
     template <typename BucketT>
     static void onSuccessCb(Application& app, FileTransferInfo const& ft,
                             std::string const& hash, int currId,
@@ -62,6 +72,8 @@ class DownloadBucketsWork : public BatchWork
     prepareWorkForBucketType(std::string const& hash,
                              FileTransferInfo const& ft,
                              OnFailureCallback const& failureCb,
+                             std::function<std::optional<uint256>()> const&
+                                 knownHashCb,
                              BucketState<BucketT>& state);
 
   public:
@@ -24,6 +24,7 @@ DownloadVerifyTxResultsWork::DownloadVerifyTxResultsWork(
     , mRange(range)
     , mCurrCheckpoint(range.mFirst)
     , mArchive(archive)
+    , mNextToVerify(range.mFirst)
 {
 }
 
@@ -36,7 +37,7 @@ DownloadVerifyTxResultsWork::getStatus() const
             fmt::format(FMT_STRING("Downloading and verifying {:s} files"),
                         typeString(FileType::HISTORY_FILE_TYPE_RESULTS));
         return fmtProgress(mApp, task, mRange.getLedgerRange(),
-                           mCurrCheckpoint);
+                           mNextToVerify);
     }
     return BatchWork::getStatus();
 }
@@ -51,6 +52,20 @@ void
 DownloadVerifyTxResultsWork::resetIter()
 {
     mCurrCheckpoint = mRange.mFirst;
+    mNextToVerify = mRange.mFirst;
+    mVerifiedAhead.clear();
+}
+
+void
+DownloadVerifyTxResultsWork::onVerified(uint32_t checkpoint)
+{
+    mVerifiedAhead.insert(checkpoint);
+    auto freq = HistoryManager::getCheckpointFrequency(mApp.getConfig());
+    while (!mVerifiedAhead.empty() && *mVerifiedAhead.begin() == mNextToVerify)
+    {
+        mVerifiedAhead.erase(mVerifiedAhead.begin());
+        mNextToVerify += freq;
+    }
 }
 
 std::shared_ptr<BasicWork>
@@ -65,8 +80,9 @@ DownloadVerifyTxResultsWork::yieldMoreWork()
     FileTransferInfo ft(mDownloadDir, FileType::HISTORY_FILE_TYPE_RESULTS,
                         mCurrCheckpoint);
     auto w1 = std::make_shared<GetAndUnzipRemoteFileWork>(mApp, ft, mArchive);
-    auto w2 = std::make_shared<VerifyTxResultsWork>(mApp, mDownloadDir,
-                                                    mCurrCheckpoint);
+    auto w2 = std::make_shared<VerifyTxResultsWork>(
+        mApp, mDownloadDir, mCurrCheckpoint,
+        [this](uint32_t checkpoint) { onVerified(checkpoint); });
     std::vector<std::shared_ptr<BasicWork>> seq{w1, w2};
     auto w3 = std::make_shared<WorkSequence>(
         mApp,
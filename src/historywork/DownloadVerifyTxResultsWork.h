@@ -6,6 +6,7 @@
 #include "ledger/CheckpointRange.h"
 #include "util/TmpDir.h"
 #include "work/BatchWork.h"
+#include <set>
 
 namespace medida
 {
@@ -17,6 +18,10 @@ namespace stellar
 
 class HistoryArchive;
 
+// Downloads and verifies the results of a range of checkpoints, several at a
+// time. Verifications run in parallel on worker threads and may finish out
+// of order; progress only counts the checkpoints verified without gaps from
+// the start of the range.
 class DownloadVerifyTxResultsWork : public BatchWork
 {
     TmpDir const& mDownloadDir;
@@ -24,6 +29,12 @@ class DownloadVerifyTxResultsWork : public BatchWork
     uint32_t mCurrCheckpoint;
     std::shared_ptr<HistoryArchive> mArchive;
 
+    // First checkpoint not verified yet, and the ones verified after it
+    uint32_t mNextToVerify;
+    std::set<uint32_t> mVerifiedAhead;
+
+    void onVerified(uint32_t checkpoint);
+
   public:
     DownloadVerifyTxResultsWork(
         Application& app, CheckpointRange range, TmpDir const& downloadDir,
@@ -5,8 +5,11 @@
 #include "historywork/GetAndUnzipRemoteFileWork.h"
 #include "catchup/LedgerApplyManager.h"
 #include "history/HistoryArchive.h"
+#include "history/HistoryArchiveManager.h"
 #include "historywork/GetRemoteFileWork.h"
 #include "historywork/GunzipFileWork.h"
+#include "historywork/UnzstdFileWork.h"
+#include "main/Application.h"
 #include "util/Fs.h"
 #include "util/GlobalChecks.h"
 #include "util/Logging.h"
@@ -31,9 +34,9 @@ GetAndUnzipRemoteFileWork::GetAndUnzipRemoteFileWork(
 std::string
 GetAndUnzipRemoteFileWork::getStatus() const
 {
-    if (mGunzipFileWork)
+    if (mUnzipFileWork)
     {
-        return mGunzipFileWork->getStatus();
+        return mUnzipFileWork->getStatus();
     }
     else if (mGetRemoteFileWork)
     {
@@ -48,8 +51,20 @@ GetAndUnzipRemoteFileWork::doReset()
     fs::removeWithLog(mFt.localPath_nogz());
     fs::removeWithLog(mFt.localPath_gz());
     fs::removeWithLog(mFt.localPath_gz_tmp());
+    if (mZstd)
+    {
+        // The previous attempt at the zstd copy failed. Files published
+        // before the archive enabled zstd only exist gzipped, so retry with
+        // the gzipped copy.
+        CLOG_DEBUG(History, "Failed to get {}, retrying with {}",
+                   mFt.remoteName_zst(), mFt.remoteName());
+        fs::removeWithLog(mFt.localPath_zst());
+        fs::removeWithLog(mFt.localPath_zst_tmp());
+        mZstdFailed = true;
+    }
     mGetRemoteFileWork.reset();
-    mGunzipFileWork.reset();
+    mUnzipFileWork.reset();
+    mZstd = false;
 }
 
 void
@@ -84,26 +99,14 @@ BasicWork::State
 GetAndUnzipRemoteFileWork::doWork()
 {
     ZoneScoped;
-    if (mGunzipFileWork)
+    if (mUnzipFileWork)
     {
         // Download completed, unzipping started
         releaseAssert(mGetRemoteFileWork);
         releaseAssert(mGetRemoteFileWork->getState() == State::WORK_SUCCESS);
-        auto state = mGunzipFileWork->getState();
-        if (state == State::WORK_SUCCESS && !fs::exists(mFt.localPath_nogz()))
+        auto state = mUnzipFileWork->getState();
+        if (state == State::WORK_SUCCESS && !checkUnzippedFile())
         {
-            if (mLogErrorOnFailure)
-            {
-                CLOG_ERROR(History,
-                           "Downloading and unzipping {}: .nogz not found",
-                           mFt.remoteName());
-            }
-            else
-            {
-                CLOG_WARNING(History,
-                             "Downloading and unzipping {}: .nogz not found",
-                             mFt.remoteName());
-            }
             return State::WORK_FAILURE;
         }
         return state;
@@ -114,100 +117,162 @@ GetAndUnzipRemoteFileWork::doWork()
         auto state = mGetRemoteFileWork->getState();
         if (state == State::WORK_SUCCESS)
         {
+            if (mGetRemoteFileWork->getUnzippedHash())
+            {
+                // Already gunzipped while downloading
+                return checkUnzippedFile() ? State::WORK_SUCCESS
+                                           : State::WORK_FAILURE;
+            }
             if (!validateFile())
             {
                 return State::WORK_FAILURE;
             }
-            mGunzipFileWork = addWork<GunzipFileWork>(mFt.localPath_gz(), false,
-                                                      BasicWork::RETRY_NEVER);
+            if (mZstd)
+            {
+                mUnzipFileWork = addWork<UnzstdFileWork>(
+                    mFt.localPath_zst(), false, BasicWork::RETRY_NEVER);
+            }
+            else
+            {
+                mUnzipFileWork = addWork<GunzipFileWork>(
+                    mFt.localPath_gz(), false, BasicWork::RETRY_NEVER);
+            }
             return State::WORK_RUNNING;
         }
         return state;
     }
     else
     {
-        CLOG_DEBUG(History, "Downloading and unzipping {}", mFt.remoteName());
-        mGetRemoteFileWork =
-            addWork<GetRemoteFileWork>(mFt.remoteName(), mFt.localPath_gz_tmp(),
-                                       mArchive, BasicWork::RETRY_NEVER);
+        auto archive = mArchive;
+        if (mApp.getConfig().EXPERIMENTAL_ZSTD_HISTORY && !mZstdFailed)
+        {
+            if (!archive)
+            {
+                archive = mApp.getHistoryArchiveManager()
+                              .selectRandomReadableHistoryArchive();
+            }
+            mZstd = archive->hasZstdFiles();
+        }
+
+        if (mZstd)
+        {
+            CLOG_DEBUG(History, "Downloading and unzipping {}",
+                       mFt.remoteName_zst());
+            mGetRemoteFileWork = addWork<GetRemoteFileWork>(
+                mFt.remoteName_zst(), mFt.localPath_zst_tmp(), archive,
+                BasicWork::RETRY_NEVER);
+        }
+        else
+        {
+            CLOG_DEBUG(History, "Downloading and unzipping {}",
+                       mFt.remoteName());
+            mGetRemoteFileWork = addWork<GetRemoteFileWork>(
+                mFt.remoteName(), mFt.localPath_gz_tmp(), archive,
+                BasicWork::RETRY_NEVER, mFt.localPath_nogz());
+        }
         return State::WORK_RUNNING;
     }
 }
 
+bool
+GetAndUnzipRemoteFileWork::checkUnzippedFile()
+{
+    if (fs::exists(mFt.localPath_nogz()))
+    {
+        return true;
+    }
+    if (mLogErrorOnFailure)
+    {
+        CLOG_ERROR(History, "Downloading and unzipping {}: .nogz not found",
+                   mFt.remoteName());
+    }
+    else
+    {
+        CLOG_WARNING(History, "Downloading and unzipping {}: .nogz not found",
+                     mFt.remoteName());
+    }
+    return false;
+}
+
 bool
 GetAndUnzipRemoteFileWork::validateFile()
 {
     ZoneScoped;
-    if (!fs::exists(mFt.localPath_gz_tmp()))
+    auto remoteName = mZstd ? mFt.remoteName_zst() : mFt.remoteName();
+    auto localPath = mZstd ? mFt.localPath_zst() : mFt.localPath_gz();
+    auto localPathTmp =
+        mZstd ? mFt.localPath_zst_tmp() : mFt.localPath_gz_tmp();
+    std::string const ext = mZstd ? ".zst" : ".gz";
+
+    if (!fs::exists(localPathTmp))
     {
         if (mLogErrorOnFailure)
         {
             CLOG_ERROR(History,
                        "Downloading and unzipping {}: .tmp file not found",
-                       mFt.remoteName());
+                       remoteName);
         }
         else
         {
             CLOG_WARNING(History,
                          "Downloading and unzipping {}: .tmp file not found",
-                         mFt.remoteName());
+                         remoteName);
         }
         return false;
     }
 
-    CLOG_TRACE(History, "Downloading and unzipping {}: renaming .gz.tmp to .gz",
-               mFt.remoteName());
-    if (fs::exists(mFt.localPath_gz()) &&
-        std::remove(mFt.localPath_gz().c_str()))
+    CLOG_TRACE(History, "Downloading and unzipping {}: renaming {}.tmp to {}",
+               remoteName, ext, ext);
+    if (fs::exists(localPath) && std::remove(localPath.c_str()))
     {
         if (mLogErrorOnFailure)
         {
             CLOG_ERROR(History,
-                       "Downloading and unzipping {}: failed to remove .gz",
-                       mFt.remoteName());
+                       "Downloading and unzipping {}: failed to remove {}",
+                       remoteName, ext);
         }
         else
         {
             CLOG_WARNING(History,
-                         "Downloading and unzipping {}: failed to remove .gz",
-                         mFt.remoteName());
+                         "Downloading and unzipping {}: failed to remove {}",
+                         remoteName, ext);
         }
         return false;
     }
 
-    if (std::rename(mFt.localPath_gz_tmp().c_str(), mFt.localPath_gz().c_str()))
+    if (std::rename(localPathTmp.c_str(), localPath.c_str()))
     {
         if (mLogErrorOnFailure)
         {
             CLOG_ERROR(
                 History,
-                "Downloading and unzipping {}: failed to rename .gz.tmp to .gz",
-                mFt.remoteName());
+                "Downloading and unzipping {}: failed to rename {}.tmp to {}",
+                remoteName, ext, ext);
         }
         else
         {
             CLOG_WARNING(
                 History,
-                "Downloading and unzipping {}: failed to rename .gz.tmp to .gz",
-                mFt.remoteName());
+                "Downloading and unzipping {}: failed to rename {}.tmp to {}",
+                remoteName, ext, ext);
         }
         return false;
     }
 
-    CLOG_TRACE(History, "Downloading and unzipping {}: renamed .gz.tmp to .gz",
-               mFt.remoteName());
+    CLOG_TRACE(History, "Downloading and unzipping {}: renamed {}.tmp to {}",
+               remoteName, ext, ext);
 
-    if (!fs::exists(mFt.localPath_gz()))
+    if (!fs::exists(localPath))
     {
         if (mLogErrorOnFailure)
         {
-            CLOG_ERROR(History, "Downloading and unzipping {}: .gz not found",
-                       mFt.remoteName());
+            CLOG_ERROR(History, "Downloading and unzipping {}: {} not found",
+                       remoteName, ext);
         }
         else
         {
-            CLOG_WARNING(History, "Downloading and unzipping {}: .gz not found",
-                         mFt.remoteName());
+            CLOG_WARNING(History, "Downloading and unzipping {}: {} not found",
+                         remoteName, ext);
         }
         return false;
     }
@@ -225,4 +290,15 @@ GetAndUnzipRemoteFileWork::getArchive() const
     }
     return nullptr;
 }
+
+std::optional<uint256>
+GetAndUnzipRemoteFileWork::getUnzippedHash() const
+{
+    if (mGetRemoteFileWork &&
+        mGetRemoteFileWork->getState() == BasicWork::State::WORK_SUCCESS)
+    {
+        return mGetRemoteFileWork->getUnzippedHash();
+    }
+    return std::nullopt;
+}
 }
@@ -6,6 +6,8 @@
 
 #include "history/FileTransferInfo.h"
 #include "work/Work.h"
+#include "xdr/Stellar-types.h"
+#include <optional>
 
 namespace stellar
 {
@@ -16,18 +18,25 @@ class GetRemoteFileWork;
 class GetAndUnzipRemoteFileWork : public Work
 {
     std::shared_ptr<GetRemoteFileWork> mGetRemoteFileWork;
-    std::shared_ptr<BasicWork> mGunzipFileWork;
+    std::shared_ptr<BasicWork> mUnzipFileWork;
 
     FileTransferInfo mFt;
     std::shared_ptr<HistoryArchive> const mArchive;
     bool mLogErrorOnFailure;
+    // Whether this attempt downloads the zstd copy of the file
+    bool mZstd{false};
+    // Set once downloading the zstd copy failed, so that retries use gzip
+    bool mZstdFailed{false};
 
     bool validateFile();
+    bool checkUnzippedFile();
 
   public:
     // Passing `nullptr` for the archive argument will cause the work to
     // select a new readable history archive at random each time it runs /
-    // retries.
+    // retries. With EXPERIMENTAL_ZSTD_HISTORY the `.zst` copy of the file is
+    // downloaded if the archive advertises one, falling back to the `.gz` copy
+    // on the next retry if that fails.
     GetAndUnzipRemoteFileWork(Application& app, FileTransferInfo ft,
                               std::shared_ptr<HistoryArchive> archive = nullptr,
                               size_t retry = BasicWork::RETRY_A_LOT,
@@ -35,6 +44,9 @@ class GetAndUnzipRemoteFileWork : public Work
     ~GetAndUnzipRemoteFileWork() = default;
     std::string getStatus() const override;
     std::shared_ptr<HistoryArchive> getArchive() const;
+    // Hash of the unzipped file, if it was computed while downloading it
+    // (see EXPERIMENTAL_STREAMING_HISTORY_GET)
+    std::optional<uint256> getUnzippedHash() const;
 
   protected:
     void doReset() override;
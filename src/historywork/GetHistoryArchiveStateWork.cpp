@@ -60,6 +60,10 @@ GetHistoryArchiveStateWork::doWork()
                 CLOG_ERROR(History, "{}", UPGRADE_STELLAR_CORE);
                 return State::WORK_FAILURE;
             }
+            if (archive)
+            {
+                archive->setHasZstdFiles(mState.hasZstdFiles());
+            }
         }
         else if (state == State::WORK_FAILURE && archive)
         {
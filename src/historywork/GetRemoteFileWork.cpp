@@ -3,25 +3,83 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "historywork/GetRemoteFileWork.h"
+#include "crypto/SHA.h"
 #include "fmt/format.h"
 #include "history/HistoryArchive.h"
 #include "history/HistoryArchiveManager.h"
 #include "history/HistoryManager.h"
 #include "main/Application.h"
+#include "main/Config.h"
 #include "util/Fs.h"
 #include "util/GlobalChecks.h"
+#include "util/GunzipStream.h"
 #include "util/Logging.h"
+#include <fstream>
 
 namespace stellar
 {
+
+#ifdef USE_ZLIB
+namespace
+{
+// Gunzips a download into a file, hashing the decompressed bytes on the way
+struct StreamingGunzip
+{
+    std::string const mPath;
+    std::ofstream mOut;
+    SHA256 mHasher;
+    GunzipStream mGunzip;
+    size_t mCompressedBytes{0};
+
+    explicit StreamingGunzip(std::string const& path)
+        : mPath(path)
+        , mOut(path, std::ios::out | std::ios::binary | std::ios::trunc)
+        , mGunzip([this](char const* data, size_t size) {
+            mHasher.add(ByteSlice(data, size));
+            if (!mOut.write(data, size))
+            {
+                throw std::runtime_error("failed to write " + mPath);
+            }
+        })
+    {
+        if (!mOut)
+        {
+            throw std::runtime_error("could not open " + mPath);
+        }
+    }
+
+    void
+    add(char const* data, size_t size)
+    {
+        mCompressedBytes += size;
+        mGunzip.add(data, size);
+    }
+
+    uint256
+    finish()
+    {
+        mGunzip.finish();
+        mOut.close();
+        if (mOut.fail())
+        {
+            throw std::runtime_error("failed to write " + mPath);
+        }
+        return mHasher.finish();
+    }
+};
+}
+#endif
+
 GetRemoteFileWork::GetRemoteFileWork(Application& app,
                                      std::string const& remote,
                                      std::string const& local,
                                      std::shared_ptr<HistoryArchive> archive,
-                                     size_t maxRetries)
+                                     size_t maxRetries,
+                                     std::string const& unzipTo)
     : RunCommandWork(app, std::string("get-remote-file ") + remote, maxRetries)
     , mRemote(remote)
     , mLocal(local)
+    , mUnzipTo(unzipTo)
     , mArchive(archive)
     , mFailuresPerSecond(
           app.getMetrics().NewMeter({"history", "get", "failure"}, "failure"))
@@ -30,8 +88,8 @@ GetRemoteFileWork::GetRemoteFileWork(Application& app,
 {
 }
 
-CommandInfo
-GetRemoteFileWork::getCommand()
+void
+GetRemoteFileWork::selectArchive()
 {
     mCurrentArchive = mArchive;
     if (!mCurrentArchive)
@@ -44,6 +102,136 @@ GetRemoteFileWork::getCommand()
     }
     releaseAssert(mCurrentArchive);
     releaseAssert(mCurrentArchive->hasGetCmd());
+}
+
+bool
+GetRemoteFileWork::maybeStartHttpDownload()
+{
+    auto const& cfg = mApp.getConfig();
+    bool streaming = false;
+#ifdef USE_ZLIB
+    streaming = cfg.EXPERIMENTAL_STREAMING_HISTORY_GET && !mUnzipTo.empty();
+#endif
+    if (!cfg.EXPERIMENTAL_NATIVE_HISTORY_GET && !streaming)
+    {
+        return false;
+    }
+    auto fileUrl = mCurrentArchive->getFileUrl(mRemote);
+    auto url = fileUrl ? HttpArchiveClient::parseUrl(*fileUrl) : std::nullopt;
+    if (!url)
+    {
+        return false;
+    }
+
+    CLOG_DEBUG(History, "Downloading file: url: {}", *fileUrl);
+    std::weak_ptr<GetRemoteFileWork> weak(
+        std::static_pointer_cast<GetRemoteFileWork>(shared_from_this()));
+    auto& client = mApp.getHistoryArchiveManager().getHttpArchiveClient();
+#ifdef USE_ZLIB
+    if (streaming)
+    {
+        std::shared_ptr<StreamingGunzip> stream;
+        try
+        {
+            stream = std::make_shared<StreamingGunzip>(mUnzipTo);
+        }
+        catch (std::exception const& e)
+        {
+            mHttpError = e.what();
+            return true;
+        }
+        mHttpRequest = client.get(
+            *url,
+            [stream](char const* data, size_t size) {
+                stream->add(data, size);
+            },
+            [weak, stream](std::string const& error) {
+                auto self = weak.lock();
+                if (!self || self->isDone())
+                {
+                    return;
+                }
+                std::string err = error;
+                if (err.empty())
+                {
+                    try
+                    {
+                        self->mUnzippedHash = stream->finish();
+                        self->mStreamedBytes = stream->mCompressedBytes;
+                    }
+                    catch (std::exception const& e)
+                    {
+                        err = e.what();
+                    }
+                }
+                self->mHttpError = err;
+                self->wakeUp();
+            });
+        return true;
+    }
+#endif
+    if (!cfg.EXPERIMENTAL_NATIVE_HISTORY_GET)
+    {
+        return false;
+    }
+    mHttpRequest = client.get(
+        *url, mLocal, [weak](std::string const& error) {
+            auto self = weak.lock();
+            if (self && !self->isDone())
+            {
+                self->mHttpError = error;
+                self->wakeUp();
+            }
+        });
+    return true;
+}
+
+BasicWork::State
+GetRemoteFileWork::onRun()
+{
+    if (!mStarted)
+    {
+        mStarted = true;
+        selectArchive();
+        if (maybeStartHttpDownload() && !mHttpError)
+        {
+            return State::WORK_WAITING;
+        }
+    }
+
+    if (mHttpRequest || mHttpError)
+    {
+        if (!mHttpError)
+        {
+            return State::WORK_WAITING;
+        }
+        if (!mHttpError->empty())
+        {
+            CLOG_DEBUG(History, "Downloading {} failed: {}", mRemote,
+                       *mHttpError);
+            return State::WORK_FAILURE;
+        }
+        return State::WORK_SUCCESS;
+    }
+    return RunCommandWork::onRun();
+}
+
+bool
+GetRemoteFileWork::onAbort()
+{
+    if (mHttpRequest)
+    {
+        mApp.getHistoryArchiveManager().getHttpArchiveClient().cancel(
+            mHttpRequest);
+        return true;
+    }
+    return RunCommandWork::onAbort();
+}
+
+CommandInfo
+GetRemoteFileWork::getCommand()
+{
+    releaseAssert(mCurrentArchive);
     auto cmdLine = mCurrentArchive->getFileCmd(mRemote, mLocal);
     CLOG_DEBUG(History, "Downloading file: cmd: {}", cmdLine);
 
@@ -53,7 +241,21 @@ GetRemoteFileWork::getCommand()
 void
 GetRemoteFileWork::onReset()
 {
+    if (mHttpRequest)
+    {
+        mApp.getHistoryArchiveManager().getHttpArchiveClient().cancel(
+            mHttpRequest);
+        mHttpRequest.reset();
+    }
+    mHttpError.reset();
+    mUnzippedHash.reset();
+    mStreamedBytes = 0;
+    mStarted = false;
     fs::removeWithLog(mLocal);
+    if (!mUnzipTo.empty())
+    {
+        fs::removeWithLog(mUnzipTo);
+    }
     RunCommandWork::onReset();
 }
 
@@ -61,7 +263,7 @@ void
 GetRemoteFileWork::onSuccess()
 {
     releaseAssert(mCurrentArchive);
-    mBytesPerSecond.Mark(fs::size(mLocal));
+    mBytesPerSecond.Mark(mUnzippedHash ? mStreamedBytes : fs::size(mLocal));
     RunCommandWork::onSuccess();
 }
 
@@ -81,4 +283,10 @@ GetRemoteFileWork::getCurrentArchive() const
 {
     return mCurrentArchive;
 }
+
+std::optional<uint256> const&
+GetRemoteFileWork::getUnzippedHash() const
+{
+    return mUnzippedHash;
+}
 }
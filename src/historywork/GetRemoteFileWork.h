@@ -4,24 +4,47 @@
 
 #pragma once
 
+#include "history/HttpArchiveClient.h"
 #include "historywork/RunCommandWork.h"
 #include "medida/medida.h"
+#include "xdr/Stellar-types.h"
+#include <optional>
 
 namespace stellar
 {
 
 class HistoryArchive;
 
+// Downloads a file from a history archive by running the archive's `get`
+// command, or with the in-process HttpArchiveClient when
+// EXPERIMENTAL_NATIVE_HISTORY_GET is set and the archive allows it.
+//
+// Given an `unzipTo` path, in-process downloads made with
+// EXPERIMENTAL_STREAMING_HISTORY_GET set are gunzipped and hashed as they
+// arrive and only the decompressed file is written, to `unzipTo` instead of
+// `local`. Callers tell the two outcomes apart with `getUnzippedHash`.
 class GetRemoteFileWork : public RunCommandWork
 {
     std::string const mRemote;
     std::string const mLocal;
+    std::string const mUnzipTo;
     std::shared_ptr<HistoryArchive> const mArchive;
     std::shared_ptr<HistoryArchive> mCurrentArchive;
     CommandInfo getCommand() override;
     medida::Meter& mFailuresPerSecond;
     medida::Meter& mBytesPerSecond;
 
+    bool mStarted{false};
+    std::shared_ptr<HttpArchiveClient::Request> mHttpRequest;
+    // Set once the in-process download ends, empty on success
+    std::optional<std::string> mHttpError;
+    // Set when the download was gunzipped in process
+    std::optional<uint256> mUnzippedHash;
+    size_t mStreamedBytes{0};
+
+    void selectArchive();
+    bool maybeStartHttpDownload();
+
   public:
     // Passing `nullptr` for the archive argument will cause the work to
     // select a new readable history archive at random each time it runs /
@@ -29,11 +52,16 @@ class GetRemoteFileWork : public RunCommandWork
     GetRemoteFileWork(Application& app, std::string const& remote,
                       std::string const& local,
                       std::shared_ptr<HistoryArchive> archive = nullptr,
-                      size_t maxRetries = BasicWork::RETRY_A_LOT);
+                      size_t maxRetries = BasicWork::RETRY_A_LOT,
+                      std::string const& unzipTo = "");
     ~GetRemoteFileWork() = default;
     std::shared_ptr<HistoryArchive> getCurrentArchive() const;
+    // Hash of the decompressed file, if it was gunzipped in process
+    std::optional<uint256> const& getUnzippedHash() const;
 
   protected:
+    BasicWork::State onRun() override;
+    bool onAbort() override;
     void onReset() override;
     void onSuccess() override;
     void onFailureRaise() override;
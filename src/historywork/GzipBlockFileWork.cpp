@@ -0,0 +1,94 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#ifdef USE_ZLIB
+
+#include "historywork/GzipBlockFileWork.h"
+#include "util/BufferedFileReader.h"
+#include "util/Fs.h"
+#include "util/Logging.h"
+#include <Tracy.hpp>
+
+#include <cstdio>
+#include <stdexcept>
+#include <zlib.h>
+
+namespace stellar
+{
+
+GzipBlockFileWork::GzipBlockFileWork(Application& app,
+                                     std::string const& filenameNoGz)
+    : BackgroundWork(app, std::string("gzip-block-file ") + filenameNoGz,
+                     BasicWork::RETRY_A_LOT, BackgroundWorkClass::PUBLISH)
+    , mFilenameNoGz(filenameNoGz)
+{
+    fs::checkNoGzipSuffix(mFilenameNoGz);
+}
+
+void
+GzipBlockFileWork::onReset()
+{
+    BackgroundWork::onReset();
+    std::string filenameGz = mFilenameNoGz + ".gz";
+    fs::removeWithLog(filenameGz);
+}
+
+BasicWork::State
+GzipBlockFileWork::runInBackground()
+{
+    ZoneScoped;
+    // Like the output of a command, the result is only renamed into place
+    // once complete
+    std::string filenameGz = mFilenameNoGz + ".gz";
+    std::string tmp = filenameGz + ".tmp";
+    try
+    {
+        BufferedFileReader in(BufferedFileReader::DEFAULT_BUFFER_SIZE,
+                              /*sequential=*/true);
+        in.open(mFilenameNoGz);
+        auto out = gzopen(tmp.c_str(), "wb");
+        if (!out)
+        {
+            throw std::runtime_error("failed to open " + tmp);
+        }
+        bool ok = true;
+        try
+        {
+            while (auto n = in.ensure(1))
+            {
+                if (isAborting() ||
+                    gzwrite(out, in.data(), static_cast<unsigned>(n)) !=
+                        static_cast<int>(n))
+                {
+                    ok = false;
+                    break;
+                }
+                in.advance(n);
+            }
+        }
+        catch (...)
+        {
+            gzclose(out);
+            throw;
+        }
+        if (gzclose(out) != Z_OK || !ok)
+        {
+            throw std::runtime_error("failed to write " + tmp);
+        }
+        if (std::rename(tmp.c_str(), filenameGz.c_str()))
+        {
+            throw std::runtime_error("failed to rename " + tmp);
+        }
+    }
+    catch (std::exception const& e)
+    {
+        CLOG_ERROR(History, "Failed to gzip {}: {}", mFilenameNoGz, e.what());
+        std::remove(tmp.c_str());
+        return State::WORK_FAILURE;
+    }
+    return State::WORK_SUCCESS;
+}
+}
+
+#endif
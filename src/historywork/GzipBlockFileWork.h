@@ -0,0 +1,31 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#pragma once
+
+#ifdef USE_ZLIB
+
+#include "work/BackgroundWork.h"
+
+namespace stellar
+{
+
+// Gzips the original bytes of a block-compressed file (see
+// BlockCompressedFile) to <file>.gz in process, where GzipFileWork would
+// compress the stored ones. Keeps the input file.
+class GzipBlockFileWork : public BackgroundWork
+{
+    std::string const mFilenameNoGz;
+
+  public:
+    GzipBlockFileWork(Application& app, std::string const& filenameNoGz);
+    ~GzipBlockFileWork() = default;
+
+  protected:
+    State runInBackground() override;
+    void onReset() override;
+};
+}
+
+#endif
@@ -9,6 +9,9 @@
 #include "historywork/PutRemoteFileWork.h"
 #include "work/WorkSequence.h"
 #include <Tracy.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <map>
 
 namespace stellar
 {
@@ -32,7 +35,24 @@ PutFilesWork::doWork()
     ZoneScoped;
     if (!mChildrenSpawned)
     {
-        for (auto const& f : mSnapshot->differingHASFiles(mRemoteState))
+        // Start with the largest files: after a spill the deep-level buckets
+        // take far longer to upload than everything else, and starting them
+        // last would leave them running alone at the end.
+        auto files = mSnapshot->differingHASFiles(mRemoteState);
+        std::map<std::string, uintmax_t> sizes;
+        for (auto const& f : files)
+        {
+            std::error_code ec;
+            auto size = std::filesystem::file_size(f->localPath_gz(), ec);
+            sizes[f->localPath_gz()] = ec ? 0 : size;
+        }
+        std::stable_sort(files.begin(), files.end(),
+                         [&sizes](auto const& a, auto const& b) {
+                             return sizes.at(a->localPath_gz()) >
+                                    sizes.at(b->localPath_gz());
+                         });
+
+        for (auto const& f : files)
         {
             auto mkdir = std::make_shared<MakeRemoteDirWork>(
                 mApp, f->remoteDir(), mArchive);
@@ -40,6 +60,11 @@ PutFilesWork::doWork()
                 mApp, f->localPath_gz(), f->remoteName(), mArchive);
 
             std::vector<std::shared_ptr<BasicWork>> seq{mkdir, putFile};
+            if (mApp.getConfig().EXPERIMENTAL_ZSTD_HISTORY)
+            {
+                seq.emplace_back(std::make_shared<PutRemoteFileWork>(
+                    mApp, f->localPath_zst(), f->remoteName_zst(), mArchive));
+            }
             // Each inner step will retry a lot, so retry the sequence once
             // in case of an unexpected failure
             addWork<WorkSequence>("mkdir-and-put-file-" + f->localPath_gz(),
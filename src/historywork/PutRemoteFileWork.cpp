@@ -4,8 +4,10 @@
 
 #include "historywork/PutRemoteFileWork.h"
 #include "history/HistoryArchive.h"
+#include "history/HistoryManager.h"
 #include "main/Application.h"
 #include "util/GlobalChecks.h"
+#include <filesystem>
 
 namespace stellar
 {
@@ -28,4 +30,16 @@ PutRemoteFileWork::getCommand()
     auto cmdLine = mArchive->putFileCmd(mLocal, mRemote);
     return CommandInfo{cmdLine, std::string()};
 }
+
+void
+PutRemoteFileWork::onSuccess()
+{
+    std::error_code ec;
+    auto bytes = std::filesystem::file_size(mLocal, ec);
+    if (!ec)
+    {
+        mApp.getHistoryManager().historyFileUploaded(bytes);
+    }
+    RunCommandWork::onSuccess();
+}
 }
@@ -23,5 +23,8 @@ class PutRemoteFileWork : public RunCommandWork
                       std::string const& remote,
                       std::shared_ptr<HistoryArchive> archive);
     ~PutRemoteFileWork() = default;
+
+  protected:
+    void onSuccess() override;
 };
 }
@@ -7,11 +7,15 @@
 #include "history/HistoryArchiveManager.h"
 #include "history/StateSnapshot.h"
 #include "historywork/GetHistoryArchiveStateWork.h"
+#include "historywork/GzipBlockFileWork.h"
 #include "historywork/GzipFileWork.h"
 #include "historywork/PutFilesWork.h"
 #include "historywork/PutHistoryArchiveStateWork.h"
+#include "historywork/ZstdFileWork.h"
 #include "main/Application.h"
+#include "util/BlockCompressedFile.h"
 #include "util/Fs.h"
+#include "util/Logging.h"
 #include "work/WorkSequence.h"
 #include <Tracy.hpp>
 #include <fmt/format.h>
@@ -22,10 +26,19 @@ namespace stellar
 void
 PutSnapshotFilesWork::cleanup()
 {
-    // Delete `gz` files produced by this work
+    // Delete `gz` and `zst` files produced by this work, except for gzipped
+    // buckets: they are named by hash, so they stay next to their bucket for
+    // the next publish that needs them, and are garbage-collected with it.
     for (auto const& f : mFilesToUpload)
     {
-        fs::removeWithLog(f.second.localPath_gz());
+        if (f.second.getType() != FileType::HISTORY_FILE_TYPE_BUCKET)
+        {
+            fs::removeWithLog(f.second.localPath_gz());
+        }
+        if (mApp.getConfig().EXPERIMENTAL_ZSTD_HISTORY)
+        {
+            fs::removeWithLog(f.second.localPath_zst());
+        }
     }
 }
 
@@ -49,7 +62,7 @@ PutSnapshotFilesWork::doWork()
         return WorkUtils::getWorkStatus(mUploadSeqs);
     }
 
-    if (!mGzipFilesWorks.empty())
+    if (mGzipWorksCreated)
     {
         if (WorkUtils::getWorkStatus(mGzipFilesWorks) == State::WORK_SUCCESS)
         {
@@ -111,6 +124,7 @@ PutSnapshotFilesWork::doReset()
 
     mGetStateWorks.clear();
     mGzipFilesWorks.clear();
+    mGzipWorksCreated = false;
     mUploadSeqs.clear();
     mFilesToUpload.clear();
 }
@@ -132,11 +146,39 @@ PutSnapshotFilesWork::createGzipWorks()
         {
             if (mFilesToUpload.emplace(f->localPath_nogz(), *f).second)
             {
-                mGzipFilesWorks.emplace_back(
-                    addWork<GzipFileWork>(f->localPath_nogz(), true));
+                // Gzipped files are only ever renamed into place once
+                // complete, so a gzipped bucket from an earlier publish can
+                // be reused as is
+                if (f->getType() == FileType::HISTORY_FILE_TYPE_BUCKET &&
+                    fs::exists(f->localPath_gz()))
+                {
+                    CLOG_DEBUG(History, "Reusing gzipped bucket {}",
+                               f->localPath_gz());
+                }
+#ifdef USE_ZLIB
+                // Archives get the original bytes of block-compressed
+                // buckets
+                else if (f->getType() == FileType::HISTORY_FILE_TYPE_BUCKET &&
+                         BlockCompressedFile::readTable(f->localPath_nogz()))
+                {
+                    mGzipFilesWorks.emplace_back(
+                        addWork<GzipBlockFileWork>(f->localPath_nogz()));
+                }
+#endif
+                else
+                {
+                    mGzipFilesWorks.emplace_back(
+                        addWork<GzipFileWork>(f->localPath_nogz(), true));
+                }
+                if (mApp.getConfig().EXPERIMENTAL_ZSTD_HISTORY)
+                {
+                    mGzipFilesWorks.emplace_back(
+                        addWork<ZstdFileWork>(f->localPath_nogz(), true));
+                }
             }
         }
     }
+    mGzipWorksCreated = true;
 }
 
 std::string
@@ -147,7 +189,7 @@ PutSnapshotFilesWork::getStatus() const
         return fmt::format(FMT_STRING("{}:uploading files"), getName());
     }
 
-    if (!mGzipFilesWorks.empty())
+    if (mGzipWorksCreated)
     {
         return fmt::format(FMT_STRING("{}:zipping files"), getName());
     }
@@ -22,6 +22,7 @@ class PutSnapshotFilesWork : public Work
     // Keep track of each step
     std::list<std::shared_ptr<GetHistoryArchiveStateWork>> mGetStateWorks;
     std::list<std::shared_ptr<BasicWork>> mGzipFilesWorks;
+    bool mGzipWorksCreated{false};
     std::list<std::shared_ptr<BasicWork>> mUploadSeqs;
     UnorderedMap<std::string, FileTransferInfo> mFilesToUpload;
 
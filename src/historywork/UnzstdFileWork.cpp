@@ -0,0 +1,44 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "historywork/UnzstdFileWork.h"
+#include "util/Fs.h"
+
+namespace stellar
+{
+
+UnzstdFileWork::UnzstdFileWork(Application& app, std::string const& filenameZst,
+                               bool keepExisting, size_t maxRetries)
+    : RunCommandWork(app, std::string("unzstd-file ") + filenameZst, maxRetries)
+    , mFilenameZst(filenameZst)
+    , mKeepExisting(keepExisting)
+{
+    fs::checkZstdSuffix(mFilenameZst);
+}
+
+CommandInfo
+UnzstdFileWork::getCommand()
+{
+    std::string cmdLine, outFile;
+    cmdLine = "zstd -d -q ";
+    if (mKeepExisting)
+    {
+        cmdLine += "-c ";
+        outFile = mFilenameZst.substr(0, mFilenameZst.size() - 4);
+    }
+    else
+    {
+        cmdLine += "-f --rm ";
+    }
+    cmdLine += mFilenameZst;
+    return CommandInfo{cmdLine, outFile};
+}
+
+void
+UnzstdFileWork::onReset()
+{
+    std::string filenameNoZst = mFilenameZst.substr(0, mFilenameZst.size() - 4);
+    fs::removeWithLog(filenameNoZst);
+}
+}
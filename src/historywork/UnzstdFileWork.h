@@ -0,0 +1,28 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#pragma once
+
+#include "historywork/RunCommandWork.h"
+
+namespace stellar
+{
+
+// Decompresses <file>.zst to <file> with the `zstd` tool
+class UnzstdFileWork : public RunCommandWork
+{
+    std::string const mFilenameZst;
+    bool const mKeepExisting;
+    CommandInfo getCommand() override;
+
+  public:
+    UnzstdFileWork(Application& app, std::string const& filenameZst,
+                   bool keepExisting = false,
+                   size_t maxRetries = Work::RETRY_NEVER);
+    ~UnzstdFileWork() = default;
+
+  protected:
+    void onReset() override;
+};
+}
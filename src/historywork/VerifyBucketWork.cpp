@@ -3,12 +3,16 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "historywork/VerifyBucketWork.h"
+#include "bucket/BucketIndexUtils.h"
+#include "bucket/HotArchiveBucketIndex.h"
 #include "bucket/LiveBucketIndex.h"
 #include "crypto/Hex.h"
 #include "crypto/SHA.h"
 #include "history/HistoryArchive.h"
 #include "main/Application.h"
 #include "main/ErrorMessages.h"
+#include "util/BlockCompressedFile.h"
+#include "util/BufferedFileReader.h"
 #include "util/Fs.h"
 #include "util/Logging.h"
 #include <fmt/format.h>
@@ -17,20 +21,44 @@
 #include <medida/meter.h>
 #include <medida/metrics_registry.h>
 
-#include <fstream>
+#include <future>
 
 namespace stellar
 {
 
+namespace
+{
+// Hashes the file at path, reading it in large blocks
+uint256
+hashFile(std::string const& path)
+{
+    ZoneScoped;
+    BufferedFileReader in(BufferedFileReader::DEFAULT_BUFFER_SIZE,
+                          /*sequential=*/true);
+    in.open(path);
+
+    // Block-compressed buckets are hashed by their original bytes
+    SHA256 hasher;
+    while (auto n = in.ensure(1))
+    {
+        hasher.add(ByteSlice(in.data(), n));
+        in.advance(n);
+    }
+    return hasher.finish();
+}
+}
+
 template <typename BucketT>
 VerifyBucketWork<BucketT>::VerifyBucketWork(
     Application& app, std::string const& bucketFile, uint256 const& hash,
     std::unique_ptr<typename BucketT::IndexT const>& index,
-    OnFailureCallback failureCb)
+    OnFailureCallback failureCb, KnownHashCallback knownHashCb, bool compress)
     : BasicWork(app, "verify-bucket-hash-" + bucketFile, BasicWork::RETRY_NEVER)
     , mBucketFile(bucketFile)
     , mHash(hash)
     , mIndex(index)
+    , mKnownHashCb(knownHashCb)
+    , mCompress(compress)
     , mOnFailure(failureCb)
 {
 }
@@ -58,7 +86,7 @@ void
 VerifyBucketWork<BucketT>::spawnVerifier()
 {
     std::string filename = mBucketFile;
-    if (auto size = fs::size(filename);
+    if (auto size = BlockCompressedFile::originalSize(filename);
         size > HistoryArchiveState::MAX_HISTORY_ARCHIVE_BUCKET_SIZE)
     {
         CLOG_WARNING(History,
@@ -74,10 +102,16 @@ VerifyBucketWork<BucketT>::spawnVerifier()
 
     uint256 hash = mHash;
     Application& app = this->mApp;
+    bool const pipelinedHashing =
+        app.getConfig().BUCKET_VERIFY_PIPELINED_HASHING;
+    std::optional<uint256> knownHash =
+        mKnownHashCb ? mKnownHashCb() : std::nullopt;
+    bool const compress = mCompress;
     std::weak_ptr<VerifyBucketWork> weak(
         std::static_pointer_cast<VerifyBucketWork>(shared_from_this()));
     app.postOnBackgroundThread(
-        [&app, filename, weak, hash]() {
+        [&app, filename, weak, hash, pipelinedHashing, knownHash,
+         compress]() {
             SHA256 hasher;
             asio::error_code ec;
 
@@ -95,20 +129,38 @@ VerifyBucketWork<BucketT>::spawnVerifier()
                 CLOG_INFO(History, "Verifying and indexing bucket {}",
                           binToHex(hash));
 
-                index =
-                    createIndex<BucketT>(app.getBucketManager(), filename, hash,
-                                         app.getWorkerIOContext(), &hasher);
+                // Both passes read the same file, so the slower one mostly
+                // reads from the page cache
+                std::future<uint256> hashFuture;
+                if (pipelinedHashing && !knownHash)
+                {
+                    hashFuture =
+                        std::async(std::launch::async, hashFile, filename);
+                }
+
+                index = createIndex<BucketT>(
+                    app.getBucketManager(), filename, hash,
+                    app.getWorkerIOContext(),
+                    pipelinedHashing || knownHash ? nullptr : &hasher);
+                uint256 vHash = knownHash          ? *knownHash
+                                : pipelinedHashing ? hashFuture.get()
+                                                   : hasher.finish();
                 if (self->isAborting())
                 {
                     return;
                 }
                 releaseAssertOrThrow(index);
 
-                uint256 vHash = hasher.finish();
                 if (vHash == hash)
                 {
                     CLOG_DEBUG(History, "Verified hash ({}) for {}",
                                hexAbbrev(hash), filename);
+                    if (compress)
+                    {
+                        maybeCompressBucketFile(
+                            app.getBucketManager(), filename,
+                            index->getPageSize(), app.getWorkerIOContext());
+                    }
                 }
                 else
                 {
@@ -149,7 +201,8 @@ VerifyBucketWork<BucketT>::spawnVerifier()
                 },
                 "VerifyBucket: finish");
         },
-        "VerifyBucket: start in background");
+        "VerifyBucket: start in background",
+        BackgroundWorkClass::PUBLISH);
 }
 
 template <typename BucketT>
@@ -7,6 +7,8 @@
 #include "bucket/BucketUtils.h"
 #include "work/Work.h"
 #include "xdr/Stellar-types.h"
+#include <functional>
+#include <optional>
 
 namespace medida
 {
@@ -29,15 +31,25 @@ template <typename BucketT> class VerifyBucketWork : public BasicWork
     bool mDone{false};
     std::error_code mEc;
     std::unique_ptr<typename BucketT::IndexT const>& mIndex;
+    std::function<std::optional<uint256>()> mKnownHashCb;
+    bool const mCompress;
     void spawnVerifier();
 
     OnFailureCallback mOnFailure;
 
   public:
+    // Returns the hash of the bucket file if it was already computed, e.g.
+    // while downloading it, so that only the index needs to read the file
+    using KnownHashCallback = std::function<std::optional<uint256>()>;
+
+    // If `compress`, a verified bucket file that isn't adopted yet is
+    // compressed per BUCKETLIST_DB_COMPRESS_BUCKETS once indexed
     VerifyBucketWork(Application& app, std::string const& bucketFile,
                      uint256 const& hash,
                      std::unique_ptr<typename BucketT::IndexT const>& index,
-                     OnFailureCallback failureCb);
+                     OnFailureCallback failureCb,
+                     KnownHashCallback knownHashCb = nullptr,
+                     bool compress = false);
     ~VerifyBucketWork() = default;
 
   protected:
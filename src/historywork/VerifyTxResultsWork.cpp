@@ -3,6 +3,7 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "historywork/VerifyTxResultsWork.h"
+#include "crypto/SHA.h"
 #include "history/FileTransferInfo.h"
 #include "history/HistoryUtils.h"
 #include "ledger/LedgerManager.h"
@@ -16,72 +17,48 @@
 namespace stellar
 {
 
-VerifyTxResultsWork::VerifyTxResultsWork(Application& app,
-                                         TmpDir const& downloadDir,
-                                         uint32_t checkpoint)
-    : BasicWork(app, "verify-results-" + std::to_string(checkpoint),
-                RETRY_NEVER)
+VerifyTxResultsWork::VerifyTxResultsWork(
+    Application& app, TmpDir const& downloadDir, uint32_t checkpoint,
+    std::function<void(uint32_t)> onVerified)
+    : BackgroundWork(app, "verify-results-" + std::to_string(checkpoint),
+                     RETRY_NEVER, BackgroundWorkClass::PUBLISH)
     , mDownloadDir(downloadDir)
     , mCheckpoint(checkpoint)
+    , mOnVerified(std::move(onVerified))
 {
 }
 
 void
 VerifyTxResultsWork::onReset()
 {
+    BackgroundWork::onReset();
     mHdrIn.close();
     mResIn.close();
     mTxResultEntry = {};
-    mDone = false;
-    mEc = asio::error_code();
     mLastSeenLedger = 0;
 }
 
 BasicWork::State
-VerifyTxResultsWork::onRun()
+VerifyTxResultsWork::runInBackground()
 {
-    if (mDone)
+    ZoneScoped;
+    auto verified = verifyTxResultsOfCheckpoint();
+    CLOG_TRACE(History, "Transaction results verification for checkpoint {}{}",
+               mCheckpoint,
+               (verified ? " successful"
+                         : (" failed: " +
+                            std::string(POSSIBLY_CORRUPTED_HISTORY))));
+    return verified ? State::WORK_SUCCESS : State::WORK_FAILURE;
+}
+
+BasicWork::State
+VerifyTxResultsWork::onBackgroundDone(State result)
+{
+    if (result == State::WORK_SUCCESS && mOnVerified)
     {
-        return mEc ? State::WORK_FAILURE : State::WORK_SUCCESS;
+        mOnVerified(mCheckpoint);
     }
-
-    std::weak_ptr<VerifyTxResultsWork> weak(
-        std::static_pointer_cast<VerifyTxResultsWork>(shared_from_this()));
-    auto verify = [weak, checkpoint = mCheckpoint]() {
-        auto self = weak.lock();
-        if (self && !self->isAborting())
-        {
-            ZoneScoped;
-            asio::error_code ec;
-            auto verified = self->verifyTxResultsOfCheckpoint();
-            CLOG_TRACE(History,
-                       "Transaction results verification for checkpoint {}{}",
-                       checkpoint,
-                       (verified ? " successful"
-                                 : (" failed: " +
-                                    std::string(POSSIBLY_CORRUPTED_HISTORY))));
-            if (!verified)
-            {
-                ec = std::make_error_code(std::errc::io_error);
-            }
-
-            // Wake up call is posted back on the main thread
-            self->mApp.postOnMainThread(
-                [weak, ec]() {
-                    auto self = weak.lock();
-                    if (self)
-                    {
-                        self->mEc = ec;
-                        self->mDone = true;
-                        self->wakeUp();
-                    }
-                },
-                "VerifyTxResults: finish");
-        }
-    };
-
-    mApp.postOnBackgroundThread(verify, "VerifyTxResults: start in background");
-    return State::WORK_WAITING;
+    return result;
 }
 
 bool
@@ -101,11 +78,10 @@ VerifyTxResultsWork::verifyTxResultsOfCheckpoint()
         while (mHdrIn && mHdrIn.readOne(curr))
         {
             auto ledgerSeq = curr.header.ledgerSeq;
-            auto txResultEntry = getCurrentTxResultSet(ledgerSeq);
-            auto resultSetHash =
-                sha256(xdr::xdr_to_opaque(txResultEntry.txResultSet));
+            auto const& txResultSet = getCurrentTxResultSet(ledgerSeq);
+            auto resultSetHash = xdrSha256(txResultSet);
             auto genesis = ledgerSeq == LedgerManager::GENESIS_LEDGER_SEQ &&
-                           txResultEntry.txResultSet.results.empty();
+                           txResultSet.results.empty();
 
             if (!genesis && resultSetHash != curr.header.txSetResultHash)
             {
@@ -138,13 +114,10 @@ VerifyTxResultsWork::verifyTxResultsOfCheckpoint()
     return true;
 }
 
-TransactionHistoryResultEntry
+TransactionResultSet const&
 VerifyTxResultsWork::getCurrentTxResultSet(uint32_t ledger)
 {
     ZoneScoped;
-    TransactionHistoryResultEntry trs;
-    trs.ledgerSeq = ledger;
-
     auto validateFn = [this](uint32_t readLedger) {
         auto low = HistoryManager::firstLedgerInCheckpointContaining(
             mCheckpoint, mApp.getConfig());
@@ -167,9 +140,9 @@ VerifyTxResultsWork::getCurrentTxResultSet(uint32_t ledger)
     if (foundEntry)
     {
         CLOG_DEBUG(History, "Loaded tx result set for ledger {}", ledger);
-        trs.txResultSet = mTxResultEntry.txResultSet;
+        // Hashed in place rather than copied out, result sets can be large
+        return mTxResultEntry.txResultSet;
     }
-
-    return trs;
+    return mEmptyResultSet;
 }
 }
@@ -6,41 +6,41 @@
 
 #include "util/TmpDir.h"
 #include "util/XDRStream.h"
-#include "work/BasicWork.h"
+#include "work/BackgroundWork.h"
 #include "xdr/Stellar-types.h"
+#include <functional>
 
 namespace stellar
 {
 /*
  * Verify transaction results for a checkpoint. This work requires
- * downloaded ledger header and transaction result files.
+ * downloaded ledger header and transaction result files, which are read and
+ * hashed on a worker thread. onVerified, if set, is called on the main thread
+ * with the checkpoint once it's verified.
  * */
-class VerifyTxResultsWork : public BasicWork
+class VerifyTxResultsWork : public BackgroundWork
 {
     TmpDir const& mDownloadDir;
     uint32_t const mCheckpoint;
+    std::function<void(uint32_t)> const mOnVerified;
     TransactionHistoryResultEntry mTxResultEntry;
+    TransactionResultSet const mEmptyResultSet;
     XDRInputFileStream mHdrIn;
     XDRInputFileStream mResIn;
-    bool mDone{false};
-    asio::error_code mEc;
-    uint32_t mLastSeenLedger;
+    uint32_t mLastSeenLedger{0};
 
-    TransactionHistoryResultEntry getCurrentTxResultSet(uint32_t ledger);
+    // Results of ledger, which stay valid until the next call
+    TransactionResultSet const& getCurrentTxResultSet(uint32_t ledger);
     bool verifyTxResultsOfCheckpoint();
 
   public:
     VerifyTxResultsWork(Application& app, TmpDir const& downloadDir,
-                        uint32_t checkpoint);
+                        uint32_t checkpoint,
+                        std::function<void(uint32_t)> onVerified = nullptr);
 
   protected:
-    BasicWork::State onRun() override;
+    State runInBackground() override;
+    State onBackgroundDone(State result) override;
     void onReset() override;
-
-    bool
-    onAbort() override
-    {
-        return true;
-    };
 };
 }
@@ -0,0 +1,46 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "historywork/ZstdFileWork.h"
+#include "util/Fs.h"
+
+namespace stellar
+{
+
+ZstdFileWork::ZstdFileWork(Application& app, std::string const& filenameNoZst,
+                           bool keepExisting)
+    : RunCommandWork(app, std::string("zstd-file ") + filenameNoZst,
+                     BasicWork::RETRY_A_LOT)
+    , mFilenameNoZst(filenameNoZst)
+    , mKeepExisting(keepExisting)
+{
+    fs::checkNoZstdSuffix(mFilenameNoZst);
+}
+
+void
+ZstdFileWork::onReset()
+{
+    std::string filenameZst = mFilenameNoZst + ".zst";
+    fs::removeWithLog(filenameZst);
+}
+
+CommandInfo
+ZstdFileWork::getCommand()
+{
+    std::string cmdLine = "zstd -q ";
+    std::string outFile;
+    if (mKeepExisting)
+    {
+        cmdLine += "-c ";
+        outFile = mFilenameNoZst + ".zst";
+    }
+    else
+    {
+        cmdLine += "-f --rm ";
+    }
+    cmdLine += mFilenameNoZst;
+
+    return CommandInfo{cmdLine, outFile};
+}
+}
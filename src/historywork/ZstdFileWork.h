@@ -0,0 +1,27 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#pragma once
+
+#include "historywork/RunCommandWork.h"
+
+namespace stellar
+{
+
+// Compresses a file to <file>.zst with the `zstd` tool
+class ZstdFileWork : public RunCommandWork
+{
+    std::string const mFilenameNoZst;
+    bool const mKeepExisting;
+    CommandInfo getCommand() override;
+
+  public:
+    ZstdFileWork(Application& app, std::string const& filenameNoZst,
+                 bool keepExisting = false);
+    ~ZstdFileWork() = default;
+
+  protected:
+    void onReset() override;
+};
+}
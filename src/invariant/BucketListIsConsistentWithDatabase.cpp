@@ -5,8 +5,10 @@
 #include "invariant/BucketListIsConsistentWithDatabase.h"
 #include "bucket/BucketInputIterator.h"
 #include "bucket/BucketManager.h"
+#include "bucket/LedgerCmp.h"
 #include "bucket/LiveBucket.h"
 #include "bucket/LiveBucketList.h"
+#include "crypto/Hex.h"
 #include "database/Database.h"
 #include "history/HistoryArchive.h"
 #include "invariant/InvariantManager.h"
@@ -14,14 +16,23 @@
 #include "ledger/LedgerRange.h"
 #include "ledger/LedgerTxn.h"
 #include "ledger/LedgerTxnEntry.h"
+#include "lib/json/json.h"
 #include "main/Application.h"
 #include "main/PersistentState.h"
-#include "medida/timer.h"
+#include "util/Fs.h"
+#include "util/Logging.h"
 #include "util/XDRCereal.h"
-#include <chrono>
-#include <fmt/chrono.h>
+#include "util/types.h"
+#include <atomic>
+#include <filesystem>
 #include <fmt/format.h>
+#include <fstream>
+#include <future>
+#include <limits>
 #include <map>
+#include <mutex>
+#include <optional>
+#include <set>
 
 namespace stellar
 {
@@ -84,6 +95,192 @@ checkDbEntryCounts(Application& app, LedgerRange const& range,
 
     return msg;
 }
+
+// checkEntireBucketlist splits the offer key space into this many ranges by
+// the first byte of the seller's key, and checks them independently
+uint32_t constexpr SELF_CHECK_SHARDS = 64;
+
+char const* SELF_CHECK_PROGRESS_FILE = "self-check-progress.json";
+
+uint32_t
+getSelfCheckShard(LedgerKey const& key)
+{
+    return key.offer().sellerID.ed25519()[0] * SELF_CHECK_SHARDS / 256;
+}
+
+// The smallest offer key in the shard
+LedgerKey
+getSelfCheckShardLowerBound(uint32_t shard)
+{
+    LedgerKey key(OFFER);
+    key.offer().sellerID.ed25519()[0] =
+        static_cast<uint8_t>((shard * 256 + SELF_CHECK_SHARDS - 1) /
+                             SELF_CHECK_SHARDS);
+    key.offer().offerID = std::numeric_limits<int64_t>::min();
+    return key;
+}
+
+// Adds the offers of the shard found in the bucket to newest, unless newest
+// already has a version of them from a newer bucket. DEADENTRYs are added as
+// std::nullopt.
+void
+loadSelfCheckShard(std::shared_ptr<LiveBucket> const& bucket, uint32_t shard,
+                   std::map<LedgerKey, std::optional<LedgerEntry>>& newest)
+{
+    auto lowerBound = getSelfCheckShardLowerBound(shard);
+    BucketInputIterator<LiveBucket> iter(bucket);
+    if (bucket->isIndexed())
+    {
+        // Skip straight to the shard rather than reading the whole bucket
+        auto range = bucket->getRangeForType(OFFER);
+        if (!range)
+        {
+            return;
+        }
+        auto pos = range->first;
+        if (auto offset =
+                bucket->getIndex().getMergePartitionOffset(lowerBound))
+        {
+            pos = std::max(pos, *offset);
+        }
+        iter.seek(pos);
+    }
+
+    LedgerEntryIdCmp cmp;
+    for (; iter; ++iter)
+    {
+        auto const& be = *iter;
+        auto key = be.type() == DEADENTRY ? be.deadEntry()
+                                          : LedgerEntryKey(be.liveEntry());
+        if (cmp(key, lowerBound))
+        {
+            continue;
+        }
+        // Entries are sorted by key, so nothing past this one is in the shard
+        if (key.type() != OFFER || getSelfCheckShard(key) != shard)
+        {
+            break;
+        }
+
+        if (be.type() == DEADENTRY)
+        {
+            newest.emplace(key, std::nullopt);
+        }
+        else
+        {
+            newest.emplace(key, be.liveEntry());
+        }
+    }
+}
+
+std::string
+checkSelfCheckShard(std::vector<std::shared_ptr<LiveBucket>> const& buckets,
+                    uint32_t shard,
+                    std::map<LedgerKey, LedgerEntry> const& dbOffers)
+{
+    std::map<LedgerKey, std::optional<LedgerEntry>> newest;
+    for (auto const& bucket : buckets)
+    {
+        loadSelfCheckShard(bucket, shard, newest);
+    }
+
+    for (auto const& [key, entry] : newest)
+    {
+        auto fromDb = dbOffers.find(key);
+        if (!entry)
+        {
+            if (fromDb != dbOffers.end())
+            {
+                std::string s = "Entry with type DEADENTRY found in database ";
+                s += xdrToCerealString(fromDb->second, "db");
+                return s;
+            }
+        }
+        else if (fromDb == dbOffers.end())
+        {
+            std::string s{
+                "Inconsistent state between objects (not found in database): "};
+            s += xdrToCerealString(*entry, "live");
+            return s;
+        }
+        else if (!(fromDb->second == *entry))
+        {
+            std::string s{"Inconsistent state between objects: "};
+            s += xdrToCerealString(fromDb->second, "db");
+            s += xdrToCerealString(*entry, "live");
+            return s;
+        }
+    }
+
+    for (auto const& [key, entry] : dbOffers)
+    {
+        auto live = newest.find(key);
+        if (live == newest.end() || !live->second)
+        {
+            std::string s{"Entry found in database but not in bucket list: "};
+            s += xdrToCerealString(entry, "db");
+            return s;
+        }
+    }
+    return {};
+}
+
+// Returns the shards an earlier run recorded as checked, if it ran against
+// the ledger with the given hash
+std::set<uint32_t>
+loadSelfCheckProgress(std::string const& path, std::string const& lclHash)
+{
+    std::set<uint32_t> completed;
+    if (!fs::exists(path))
+    {
+        return completed;
+    }
+
+    std::ifstream in(path);
+    Json::Value progress;
+    Json::Reader reader;
+    if (!reader.parse(in, progress) || !progress.isObject() ||
+        progress["hash"].asString() != lclHash ||
+        progress["shards"].asUInt() != SELF_CHECK_SHARDS)
+    {
+        CLOG_INFO(Ledger, "Ignoring self-check progress in {}", path);
+        return completed;
+    }
+    for (auto const& shard : progress["completed"])
+    {
+        completed.insert(shard.asUInt());
+    }
+    return completed;
+}
+
+void
+saveSelfCheckProgress(std::string const& path, uint32_t ledger,
+                      std::string const& lclHash,
+                      std::set<uint32_t> const& completed)
+{
+    Json::Value progress;
+    progress["ledger"] = ledger;
+    progress["hash"] = lclHash;
+    progress["shards"] = SELF_CHECK_SHARDS;
+    progress["completed"] = Json::Value(Json::arrayValue);
+    for (auto shard : completed)
+    {
+        progress["completed"].append(shard);
+    }
+
+    auto tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath);
+        out.exceptions(std::ios::failbit | std::ios::badbit);
+        out << Json::StyledWriter().write(progress);
+    }
+    auto dir = std::filesystem::path(path).parent_path().string();
+    if (!fs::durableRename(tmpPath, path, dir))
+    {
+        throw std::runtime_error("Failed to save self-check progress to " +
+                                 path);
+    }
+}
 }
 
 std::shared_ptr<Invariant>
@@ -111,52 +308,124 @@ BucketListIsConsistentWithDatabase::checkEntireBucketlist()
     auto& lm = mApp.getLedgerManager();
     auto& bm = mApp.getBucketManager();
     HistoryArchiveState has = lm.getLastClosedLedgerHAS();
-    std::map<LedgerKey, LedgerEntry> bucketLedgerMap =
-        bm.loadCompleteLedgerState(has);
-    uint64_t offerCount = 0;
-    medida::Timer timer(std::chrono::microseconds(1));
 
+    // Newest bucket first, so that the first version of a key seen while
+    // going through the buckets in order is the current one
+    std::vector<std::shared_ptr<LiveBucket>> buckets;
+    for (auto const& hsb : has.currentBuckets)
     {
-        LedgerTxn ltx(mApp.getLedgerTxnRoot());
-        for (auto const& pair : bucketLedgerMap)
+        for (auto const& hash : {hsb.curr, hsb.snap})
         {
-            // Don't check entry types supported by BucketListDB, since they
-            // won't exist in SQL
-            if (!LiveBucketIndex::typeNotSupported(pair.first.type()))
+            auto bucketHash = hexToBin256(hash);
+            if (isZero(bucketHash))
             {
                 continue;
             }
-
-            ++offerCount;
-            std::string s;
-            timer.Time([&]() { s = checkAgainstDatabase(ltx, pair.second); });
-            if (!s.empty())
+            auto bucket = bm.getBucketByHash<LiveBucket>(bucketHash);
+            if (!bucket)
             {
-                throw std::runtime_error(s);
+                throw std::runtime_error("missing bucket: " + hash);
             }
+            buckets.emplace_back(bucket);
+        }
+    }
 
-            if ((offerCount & 0x7ffff) == 0)
+    // Shards checked by an earlier, interrupted run against the same ledger
+    // are skipped
+    auto progressPath = (std::filesystem::path(bm.getBucketDir()) /
+                         SELF_CHECK_PROGRESS_FILE)
+                            .string();
+    auto lclHash = binToHex(lm.getLastClosedLedgerHeader().hash);
+    auto completed = loadSelfCheckProgress(progressPath, lclHash);
+    std::vector<uint32_t> pending;
+    for (uint32_t shard = 0; shard < SELF_CHECK_SHARDS; ++shard)
+    {
+        if (completed.find(shard) == completed.end())
+        {
+            pending.emplace_back(shard);
+        }
+    }
+    if (!completed.empty())
+    {
+        CLOG_INFO(Ledger,
+                  "Resuming bucket-vs-DB consistency check at ledger {}, {} "
+                  "of {} offer key ranges left",
+                  has.currentLedger, pending.size(), SELF_CHECK_SHARDS);
+    }
+
+    // Offers are the only entries stored in SQL, and there are few enough of
+    // them to load in one go
+    std::vector<std::map<LedgerKey, LedgerEntry>> dbOffers(SELF_CHECK_SHARDS);
+    {
+        LedgerTxn ltx(mApp.getLedgerTxnRoot());
+        for (auto const& accountOffers : ltx.loadAllOffers())
+        {
+            for (auto const& offer : accountOffers.second)
             {
-                using namespace std::chrono;
-                nanoseconds ns = timer.duration_unit() *
-                                 static_cast<nanoseconds::rep>(timer.mean());
-                microseconds us = duration_cast<microseconds>(ns);
-                CLOG_INFO(Ledger,
-                          "Checked bucket-vs-DB consistency for "
-                          "{} entries (mean {}/entry)",
-                          offerCount, us);
+                auto const& le = offer.current();
+                auto key = LedgerEntryKey(le);
+                auto shard = getSelfCheckShard(key);
+                if (completed.find(shard) == completed.end())
+                {
+                    dbOffers.at(shard).emplace(key, le);
+                }
             }
         }
     }
 
-    auto range = LedgerRange::inclusive(LedgerManager::GENESIS_LEDGER_SEQ,
-                                        has.currentLedger);
+    // Shards are independent, workers take the next pending one until none is
+    // left or one fails
+    std::mutex mutex;
+    std::vector<std::string> errors;
+    std::atomic<size_t> next{0};
+    auto checkShards = [&]() {
+        for (size_t i = next++; i < pending.size(); i = next++)
+        {
+            auto shard = pending.at(i);
+            std::string error;
+            try
+            {
+                error = checkSelfCheckShard(buckets, shard, dbOffers.at(shard));
+            }
+            catch (std::exception const& e)
+            {
+                error = e.what();
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error.empty())
+            {
+                errors.emplace_back(error);
+                next = pending.size();
+                return;
+            }
+            completed.insert(shard);
+            saveSelfCheckProgress(progressPath, has.currentLedger, lclHash,
+                                  completed);
+            CLOG_INFO(Ledger,
+                      "Checked bucket-vs-DB consistency for {} of {} offer "
+                      "key ranges",
+                      completed.size(), SELF_CHECK_SHARDS);
+        }
+    };
 
-    auto s = checkDbEntryCounts(mApp, range, offerCount);
-    if (!s.empty())
+    auto numWorkers = static_cast<size_t>(
+        std::max(mApp.getConfig().WORKER_THREADS, 1));
+    std::vector<std::future<void>> workers;
+    for (size_t i = 1; i < numWorkers; ++i)
+    {
+        workers.emplace_back(std::async(std::launch::async, checkShards));
+    }
+    checkShards();
+    for (auto& worker : workers)
+    {
+        worker.get();
+    }
+    if (!errors.empty())
     {
-        throw std::runtime_error(s);
+        throw std::runtime_error(errors.front());
     }
+    fs::removeWithLog(progressPath);
 
     if (mApp.getPersistentState().getState(PersistentState::kDBBackend,
                                            mApp.getDatabase().getSession()) !=
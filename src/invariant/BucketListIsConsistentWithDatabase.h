@@ -42,6 +42,10 @@ class BucketListIsConsistentWithDatabase : public Invariant
 
     // Secondary entrypoint to database-vs-bucket consistency checking, designed
     // to be run offline via self-check. Throws an exception on any error.
+    // The offer key space is checked as independent key ranges on
+    // WORKER_THREADS threads, and the ranges checked are recorded in the
+    // bucket directory so that an interrupted check resumes where it stopped
+    // if the LCL hasn't changed.
     void checkEntireBucketlist();
 
   private:
@@ -36,6 +36,9 @@ class InvariantManager
     virtual Json::Value getJsonInfo() = 0;
     virtual std::vector<std::string> getEnabledInvariants() const = 0;
     virtual bool isBucketApplyInvariantEnabled() const = 0;
+    // Invariants are all enabled before the application starts, so this is
+    // safe to call from any thread
+    virtual bool isOperationApplyInvariantEnabled() const = 0;
 
     virtual void
     checkOnBucketApply(std::shared_ptr<LiveBucket const> bucket,
@@ -50,6 +53,25 @@ class InvariantManager
                           LedgerTxnDelta const& ltxDelta,
                           std::vector<ContractEvent> const& events) = 0;
 
+    // Checks the invariant on a random sample of rate of the operations
+    // applied, rather than on all of them. Throws if the invariant isn't
+    // enabled.
+    virtual void setSampleRate(std::string const& name, double rate) = 0;
+
+    // Moves the checks on operation apply to a background thread, which may
+    // fall at most maxLagLedgers ledgers behind ledger commit
+    virtual void enableAsyncChecks(uint32_t maxLagLedgers) = 0;
+
+    // Called once the ledger ledgerSeq is committed. With async checks, blocks
+    // while the background thread is too far behind and throws
+    // InvariantDoesNotHold if an invariant failed on an earlier ledger.
+    virtual void checkOnLedgerCommit(uint32_t ledgerSeq) = 0;
+
+    // Blocks until every async check queued so far has run, then throws
+    // InvariantDoesNotHold if any of them failed. Does nothing unless async
+    // checks are enabled.
+    virtual void waitForAsyncChecks() = 0;
+
     virtual void registerInvariant(std::shared_ptr<Invariant> invariant) = 0;
 
     virtual void enableInvariant(std::string const& name) = 0;
@@ -12,13 +12,16 @@
 #include "ledger/LedgerTxn.h"
 #include "main/Application.h"
 #include "main/ErrorMessages.h"
+#include "util/GlobalChecks.h"
 #include "util/Logging.h"
+#include "util/Math.h"
 #include "util/ProtocolVersion.h"
 #include "util/XDRCereal.h"
 #include <fmt/format.h>
 
 #include "medida/counter.h"
 #include "medida/metrics_registry.h"
+#include "medida/timer.h"
 
 #include <memory>
 #include <numeric>
@@ -34,16 +37,52 @@ InvariantManager::create(Application& app)
 }
 
 InvariantManagerImpl::InvariantManagerImpl(medida::MetricsRegistry& registry)
-    : mInvariantFailureCount(
+    : mMetrics(registry)
+    , mInvariantFailureCount(
           registry.NewCounter({"ledger", "invariant", "failure"}))
+    , mSampleEngine(getGlobalRandomEngine()())
+    , mAsyncLag(registry.NewCounter({"ledger", "invariant", "async-lag"}))
+    , mAsyncBlockedTime(
+          registry.NewTimer({"ledger", "invariant", "async-blocked"}))
 {
 }
 
+InvariantManagerImpl::~InvariantManagerImpl()
+{
+    if (!mAsyncThread.joinable())
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mAsyncMutex);
+        mAsyncStopping = true;
+    }
+    mAsyncCV.notify_all();
+    mAsyncThread.join();
+    if (mAsyncError)
+    {
+        try
+        {
+            std::rethrow_exception(mAsyncError);
+        }
+        catch (std::exception const& e)
+        {
+            CLOG_ERROR(Invariant, "Async invariant check failed: {}",
+                       e.what());
+        }
+        catch (...)
+        {
+            CLOG_ERROR(Invariant, "Async invariant check failed");
+        }
+    }
+}
+
 Json::Value
 InvariantManagerImpl::getJsonInfo()
 {
     Json::Value failures;
 
+    std::lock_guard<std::mutex> lock(mFailureMutex);
     for (auto const& fi : mFailureInformation)
     {
         auto& fail = failures[fi.first];
@@ -77,11 +116,20 @@ InvariantManagerImpl::isBucketApplyInvariantEnabled() const
     });
 }
 
+bool
+InvariantManagerImpl::isOperationApplyInvariantEnabled() const
+{
+    // Every invariant is checked on operation apply
+    return !mEnabled.empty();
+}
+
 void
 InvariantManagerImpl::checkOnBucketApply(
     std::shared_ptr<LiveBucket const> bucket, uint32_t ledger, uint32_t level,
     bool isCurr, std::unordered_set<LedgerKey> const& shadowedKeys)
 {
+    // Invariants aren't meant to be called concurrently
+    waitForAsyncChecks();
     uint32_t oldestLedger =
         isCurr ? LiveBucketList::oldestLedgerInCurr(ledger, level)
                : LiveBucketList::oldestLedgerInSnap(ledger, level);
@@ -110,6 +158,7 @@ InvariantManagerImpl::checkOnBucketApply(
 void
 InvariantManagerImpl::checkAfterAssumeState(uint32_t newestLedger)
 {
+    waitForAsyncChecks();
     for (auto invariant : mEnabled)
     {
         auto result = invariant->checkAfterAssumeState(newestLedger);
@@ -131,8 +180,214 @@ InvariantManagerImpl::checkOnOperationApply(
     Operation const& operation, OperationResult const& opres,
     LedgerTxnDelta const& ltxDelta, std::vector<ContractEvent> const& events)
 {
-    for (auto invariant : mEnabled)
+    auto invariants = sampleOperationInvariants();
+    if (invariants.empty())
+    {
+        return;
+    }
+    if (!mAsync)
+    {
+        checkOperation(invariants, operation, opres, ltxDelta, events);
+        return;
+    }
+
+    // The entries of the delta may be shared with LedgerTxns that keep on
+    // changing once the operation is applied, so the copy is deep
+    AsyncCheck check{std::move(invariants), operation, opres, {}, events};
+    check.mDelta.header = ltxDelta.header;
+    check.mDelta.entry.reserve(ltxDelta.entry.size());
+    for (auto const& [key, entryDelta] : ltxDelta.entry)
+    {
+        auto& copy = check.mDelta.entry[key];
+        if (entryDelta.current)
+        {
+            copy.current =
+                std::make_shared<InternalLedgerEntry>(*entryDelta.current);
+        }
+        if (entryDelta.previous)
+        {
+            copy.previous =
+                std::make_shared<InternalLedgerEntry>(*entryDelta.previous);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mAsyncMutex);
+        mAsyncQueue.emplace_back(std::move(check));
+    }
+    mAsyncCV.notify_all();
+}
+
+void
+InvariantManagerImpl::setSampleRate(std::string const& name, double rate)
+{
+    if (!(rate >= 0.0 && rate <= 1.0))
+    {
+        throw std::invalid_argument(fmt::format(
+            FMT_STRING("Invalid sample rate {} for invariant '{}', must be "
+                       "between 0 and 1"),
+            rate, name));
+    }
+    for (size_t i = 0; i < mEnabled.size(); ++i)
+    {
+        if (mEnabled.at(i)->getName() == name)
+        {
+            mSampling.at(i).mRate = rate;
+            CLOG_INFO(Invariant,
+                      "Checking invariant '{}' on {:.2f}% of operations",
+                      name, rate * 100);
+            return;
+        }
+    }
+    throw std::invalid_argument(fmt::format(
+        FMT_STRING("Can't set the sample rate of invariant '{}', which isn't "
+                   "enabled"),
+        name));
+}
+
+void
+InvariantManagerImpl::enableAsyncChecks(uint32_t maxLagLedgers)
+{
+    releaseAssert(!mAsync);
+    mAsync = true;
+    mMaxAsyncLagLedgers = maxLagLedgers;
+    mAsyncThread = std::thread([this]() { runAsyncChecks(); });
+    CLOG_INFO(Invariant,
+              "Checking invariants on operation apply in the background, at "
+              "most {} ledgers behind",
+              maxLagLedgers);
+}
+
+void
+InvariantManagerImpl::checkOnLedgerCommit(uint32_t ledgerSeq)
+{
+    if (!mAsync)
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mAsyncMutex);
+    mAsyncQueue.emplace_back(std::nullopt);
+    ++mAsyncPendingLedgers;
+    mAsyncLag.set_count(mAsyncPendingLedgers);
+    mAsyncCV.notify_all();
+
+    auto caughtUp = [this] {
+        return mAsyncError || mAsyncPendingLedgers <= mMaxAsyncLagLedgers;
+    };
+    if (!caughtUp())
+    {
+        CLOG_DEBUG(Invariant,
+                   "Waiting for async invariant checks at ledger {}, {} "
+                   "ledgers behind",
+                   ledgerSeq, mAsyncPendingLedgers);
+        auto blocked = mAsyncBlockedTime.TimeScope();
+        mAsyncCV.wait(lock, caughtUp);
+    }
+    if (mAsyncError)
+    {
+        std::rethrow_exception(mAsyncError);
+    }
+}
+
+void
+InvariantManagerImpl::waitForAsyncChecks()
+{
+    if (!mAsync)
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mAsyncMutex);
+    mAsyncCV.wait(lock, [this] {
+        return mAsyncQueue.empty() && !mAsyncCheckRunning;
+    });
+    if (mAsyncError)
+    {
+        std::rethrow_exception(mAsyncError);
+    }
+}
+
+void
+InvariantManagerImpl::runAsyncChecks()
+{
+    std::unique_lock<std::mutex> lock(mAsyncMutex);
+    while (true)
+    {
+        // Everything queued is still checked when stopping
+        mAsyncCV.wait(lock, [this] {
+            return mAsyncStopping || !mAsyncQueue.empty();
+        });
+        if (mAsyncQueue.empty())
+        {
+            return;
+        }
+
+        auto check = std::move(mAsyncQueue.front());
+        mAsyncQueue.pop_front();
+        if (!check)
+        {
+            --mAsyncPendingLedgers;
+            mAsyncLag.set_count(mAsyncPendingLedgers);
+            mAsyncCV.notify_all();
+            continue;
+        }
+
+        mAsyncCheckRunning = true;
+        lock.unlock();
+        std::exception_ptr error;
+        try
+        {
+            checkOperation(check->mInvariants, check->mOperation,
+                           check->mResult, check->mDelta, check->mEvents);
+        }
+        catch (...)
+        {
+            // Surfaced on the apply path by the next checkOnLedgerCommit
+            error = std::current_exception();
+        }
+        check.reset();
+        lock.lock();
+        mAsyncCheckRunning = false;
+        if (error && !mAsyncError)
+        {
+            mAsyncError = error;
+        }
+        mAsyncCV.notify_all();
+    }
+}
+
+std::vector<size_t>
+InvariantManagerImpl::sampleOperationInvariants()
+{
+    std::vector<size_t> res;
+    res.reserve(mEnabled.size());
+    for (size_t i = 0; i < mEnabled.size(); ++i)
     {
+        auto& sampling = mSampling.at(i);
+        if (sampling.mRate >= 1.0 ||
+            mSampleDistribution(mSampleEngine) < sampling.mRate)
+        {
+            res.emplace_back(i);
+        }
+        else
+        {
+            sampling.mSkipped.inc();
+        }
+    }
+    return res;
+}
+
+void
+InvariantManagerImpl::checkOperation(std::vector<size_t> const& invariants,
+                                     Operation const& operation,
+                                     OperationResult const& opres,
+                                     LedgerTxnDelta const& ltxDelta,
+                                     std::vector<ContractEvent> const& events)
+{
+    for (auto i : invariants)
+    {
+        auto const& invariant = mEnabled.at(i);
         if (protocolVersionIsBefore(ltxDelta.header.current.ledgerVersion,
                                     ProtocolVersion::V_8) &&
             invariant->getName() != "EventsAreConsistentWithEntryDiffs")
@@ -140,8 +395,12 @@ InvariantManagerImpl::checkOnOperationApply(
             continue;
         }
 
-        auto result = invariant->checkOnOperationApply(operation, opres,
-                                                       ltxDelta, events);
+        std::string result;
+        {
+            auto timer = mSampling.at(i).mCheckTime.TimeScope();
+            result = invariant->checkOnOperationApply(operation, opres,
+                                                      ltxDelta, events);
+        }
         if (result.empty())
         {
             continue;
@@ -203,6 +462,9 @@ InvariantManagerImpl::enableInvariant(std::string const& invPattern)
             {
                 enabledSome = true;
                 mEnabled.push_back(inv.second);
+                mSampling.push_back(
+                    {1.0, mMetrics.NewTimer({"invariant", name, "check"}),
+                     mMetrics.NewCounter({"invariant", name, "skipped"})});
                 CLOG_INFO(Invariant, "Enabled invariant '{}'", name);
             }
             else
@@ -242,7 +504,10 @@ InvariantManagerImpl::onInvariantFailure(std::shared_ptr<Invariant> invariant,
                                          uint32_t ledger)
 {
     mInvariantFailureCount.inc();
-    mFailureInformation[invariant->getName()] = {ledger, message};
+    {
+        std::lock_guard<std::mutex> lock(mFailureMutex);
+        mFailureInformation[invariant->getName()] = {ledger, message};
+    }
     handleInvariantFailure(invariant, message);
 }
 
@@ -5,13 +5,23 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "invariant/InvariantManager.h"
+#include "ledger/LedgerTxn.h"
+#include "util/Math.h"
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <map>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <thread>
 #include <vector>
 
 namespace medida
 {
 class MetricsRegistry;
 class Counter;
+class Timer;
 }
 
 namespace stellar
@@ -19,24 +29,65 @@ namespace stellar
 
 class InvariantManagerImpl : public InvariantManager
 {
+    medida::MetricsRegistry& mMetrics;
     std::map<std::string, std::shared_ptr<Invariant>> mInvariants;
     std::vector<std::shared_ptr<Invariant>> mEnabled;
     medida::Counter& mInvariantFailureCount;
 
+    // Sampling of the checks on operation apply, parallel to mEnabled
+    struct InvariantSampling
+    {
+        double mRate;
+        medida::Timer& mCheckTime;
+        medida::Counter& mSkipped;
+    };
+    std::vector<InvariantSampling> mSampling;
+    stellar_default_random_engine mSampleEngine;
+    std::uniform_real_distribution<double> mSampleDistribution{0.0, 1.0};
+
     struct InvariantFailureInformation
     {
         uint32_t lastFailedOnLedger;
         std::string lastFailedWithMessage;
     };
+    // Failures may be reported from the async check thread
+    std::mutex mFailureMutex;
     std::map<std::string, InvariantFailureInformation> mFailureInformation;
 
+    // Copy of everything checkOnOperationApply looks at, owned by the queue
+    struct AsyncCheck
+    {
+        std::vector<size_t> mInvariants;
+        Operation mOperation;
+        OperationResult mResult;
+        LedgerTxnDelta mDelta;
+        std::vector<ContractEvent> mEvents;
+    };
+
+    // Async mode: operations are queued in apply order, with std::nullopt
+    // marking the end of a ledger, and checked on mAsyncThread
+    bool mAsync{false};
+    uint32_t mMaxAsyncLagLedgers{0};
+    medida::Counter& mAsyncLag;
+    medida::Timer& mAsyncBlockedTime;
+    std::mutex mAsyncMutex;
+    std::condition_variable mAsyncCV;
+    std::deque<std::optional<AsyncCheck>> mAsyncQueue;
+    uint32_t mAsyncPendingLedgers{0};
+    bool mAsyncCheckRunning{false};
+    bool mAsyncStopping{false};
+    std::exception_ptr mAsyncError;
+    std::thread mAsyncThread;
+
   public:
     InvariantManagerImpl(medida::MetricsRegistry& registry);
+    ~InvariantManagerImpl() override;
 
     virtual Json::Value getJsonInfo() override;
 
     virtual std::vector<std::string> getEnabledInvariants() const override;
     bool isBucketApplyInvariantEnabled() const override;
+    bool isOperationApplyInvariantEnabled() const override;
 
     virtual void
     checkOnOperationApply(Operation const& operation,
@@ -44,6 +95,11 @@ class InvariantManagerImpl : public InvariantManager
                           LedgerTxnDelta const& ltxDelta,
                           std::vector<ContractEvent> const& events) override;
 
+    void setSampleRate(std::string const& name, double rate) override;
+    void enableAsyncChecks(uint32_t maxLagLedgers) override;
+    void checkOnLedgerCommit(uint32_t ledgerSeq) override;
+    void waitForAsyncChecks() override;
+
     virtual void checkOnBucketApply(
         std::shared_ptr<LiveBucket const> bucket, uint32_t ledger,
         uint32_t level, bool isCurr,
@@ -62,6 +118,15 @@ class InvariantManagerImpl : public InvariantManager
 #endif // BUILD_TESTS
 
   private:
+    // Indices in mEnabled of the invariants to check on the next operation
+    std::vector<size_t> sampleOperationInvariants();
+    void checkOperation(std::vector<size_t> const& invariants,
+                        Operation const& operation,
+                        OperationResult const& opres,
+                        LedgerTxnDelta const& ltxDelta,
+                        std::vector<ContractEvent> const& events);
+    void runAsyncChecks();
+
     void onInvariantFailure(std::shared_ptr<Invariant> invariant,
                             std::string const& message, uint32_t ledger);
 
@@ -12,6 +12,9 @@
 #include "ledger/LedgerTxn.h"
 #include "ledger/test/LedgerTestUtils.h"
 #include "main/Application.h"
+#include "medida/counter.h"
+#include "medida/metrics_registry.h"
+#include "medida/timer.h"
 #include "test/Catch2.h"
 #include "test/TestAccount.h"
 #include "test/TestUtils.h"
@@ -224,6 +227,121 @@ TEST_CASE("onOperationApply fail succeed", "[invariant]")
     }
 }
 
+TEST_CASE("onOperationApply sampling", "[invariant]")
+{
+    VirtualClock clock;
+    Config cfg = getTestConfig();
+    cfg.INVARIANT_CHECKS = {};
+    Application::pointer app = createTestApplication(clock, cfg);
+    auto& im = app->getInvariantManager();
+    auto name = TestInvariant::toString(0, true);
+    im.registerInvariant<TestInvariant>(0, true);
+
+    REQUIRE_THROWS_AS(im.setSampleRate(name, 0.5), std::invalid_argument);
+    im.enableInvariant(name);
+    REQUIRE_THROWS_AS(im.setSampleRate(name, 1.5), std::invalid_argument);
+
+    auto& checkTime = app->getMetrics().NewTimer({"invariant", name, "check"});
+    auto& skipped =
+        app->getMetrics().NewCounter({"invariant", name, "skipped"});
+    OperationResult res;
+    LedgerTxn ltx(app->getLedgerTxnRoot());
+    auto delta = ltx.getDelta();
+
+    SECTION("never")
+    {
+        im.setSampleRate(name, 0.0);
+        for (int i = 0; i < 10; ++i)
+        {
+            REQUIRE_NOTHROW(im.checkOnOperationApply({}, res, delta, {}));
+        }
+        REQUIRE(skipped.count() == 10);
+        REQUIRE(checkTime.count() == 0);
+    }
+    SECTION("sometimes")
+    {
+        im.setSampleRate(name, 0.5);
+        int failures = 0;
+        for (int i = 0; i < 100; ++i)
+        {
+            try
+            {
+                im.checkOnOperationApply({}, res, delta, {});
+            }
+            catch (InvariantDoesNotHold&)
+            {
+                ++failures;
+            }
+        }
+        REQUIRE(failures > 0);
+        REQUIRE(failures < 100);
+        REQUIRE(skipped.count() == static_cast<int64_t>(100 - failures));
+        REQUIRE(checkTime.count() == static_cast<uint64_t>(failures));
+    }
+    SECTION("always")
+    {
+        REQUIRE_THROWS_AS(im.checkOnOperationApply({}, res, delta, {}),
+                          InvariantDoesNotHold);
+        REQUIRE(skipped.count() == 0);
+        REQUIRE(checkTime.count() == 1);
+    }
+}
+
+TEST_CASE("onOperationApply async", "[invariant]")
+{
+    VirtualClock clock;
+    Config cfg = getTestConfig();
+    Application::pointer app = createTestApplication(clock, cfg);
+    auto& im = app->getInvariantManager();
+
+    OperationResult res;
+    SECTION("Fail")
+    {
+        im.registerInvariant<TestInvariant>(0, true);
+        im.enableInvariant(TestInvariant::toString(0, true));
+        im.enableAsyncChecks(1);
+
+        {
+            LedgerTxn ltx(app->getLedgerTxnRoot());
+            REQUIRE_NOTHROW(
+                im.checkOnOperationApply({}, res, ltx.getDelta(), {}));
+        }
+        // The failure is reported no later than one ledger after the one it
+        // happened in
+        bool reported = false;
+        for (uint32_t ledger = 2; ledger < 4 && !reported; ++ledger)
+        {
+            try
+            {
+                im.checkOnLedgerCommit(ledger);
+            }
+            catch (InvariantDoesNotHold&)
+            {
+                reported = true;
+            }
+        }
+        REQUIRE(reported);
+        REQUIRE_THROWS_AS(im.waitForAsyncChecks(), InvariantDoesNotHold);
+        REQUIRE(im.getJsonInfo().isMember(TestInvariant::toString(0, true)));
+    }
+    SECTION("Succeed")
+    {
+        im.registerInvariant<TestInvariant>(0, false);
+        im.enableInvariant(TestInvariant::toString(0, false));
+        im.enableAsyncChecks(1);
+
+        for (uint32_t ledger = 2; ledger < 10; ++ledger)
+        {
+            LedgerTxn ltx(app->getLedgerTxnRoot());
+            REQUIRE_NOTHROW(
+                im.checkOnOperationApply({}, res, ltx.getDelta(), {}));
+            REQUIRE_NOTHROW(im.checkOnLedgerCommit(ledger));
+        }
+        REQUIRE_NOTHROW(im.waitForAsyncChecks());
+        REQUIRE(im.getJsonInfo().empty());
+    }
+}
+
 TEST_CASE_VERSIONS("EventsAreConsistentWithEntryDiffs invariant", "[invariant]")
 {
     auto invariantTest = [](bool enableInvariant) {
@@ -0,0 +1,251 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/asio.h"
+#include "ledger/DebugMetaWriter.h"
+#include "ledger/MetaStreamWriter.h"
+#include "util/GlobalChecks.h"
+#include "util/Logging.h"
+#include "util/XDRStream.h"
+#include <Tracy.hpp>
+#include <medida/counter.h>
+#include <medida/meter.h>
+#include <medida/metrics_registry.h>
+#include <medida/timer.h>
+#include <stdexcept>
+
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace stellar
+{
+
+#ifdef USE_ZLIB
+// Window bits for gzip encoding with the largest window
+static constexpr int GZIP_WINDOW_BITS = 15 + 16;
+#endif
+
+DebugMetaWriter::DebugMetaWriter(asio::io_context& ctx,
+                                 medida::MetricsRegistry& registry)
+    : mCtx(ctx)
+    , mWriteTime(registry.NewTimer({"ledger", "meta-debug", "write"}))
+    , mCloseTime(registry.NewTimer({"ledger", "meta-debug", "close-segment"}))
+    , mBlockedTime(registry.NewTimer({"ledger", "meta-debug", "blocked"}))
+    , mBytesWritten(
+          registry.NewMeter({"ledger", "meta-debug", "bytes-written"}, "byte"))
+    , mPendingBytesCounter(
+          registry.NewCounter({"ledger", "meta-debug", "pending-bytes"}))
+{
+#ifdef USE_ZLIB
+    mZStream = std::make_unique<z_stream_s>();
+    if (deflateInit2(mZStream.get(), Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                     GZIP_WINDOW_BITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        throw std::runtime_error("failed to initialize zlib");
+    }
+#endif
+    mThread = std::thread([this] { run(); });
+}
+
+DebugMetaWriter::~DebugMetaWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mCV.notify_all();
+    mThread.join();
+    closeSegment();
+#ifdef USE_ZLIB
+    deflateEnd(mZStream.get());
+#endif
+}
+
+void
+DebugMetaWriter::write(LedgerCloseMeta const& meta)
+{
+    ZoneScoped;
+    Item item;
+    auto size = serializeLedgerCloseMeta(meta, item.mData, 4);
+    releaseAssertOrThrow(size < 0x80000000);
+    auto sz = static_cast<uint32_t>(size);
+    auto& buf = item.mData;
+    buf[0] = static_cast<char>((sz >> 24) & 0xFF) | '\x80';
+    buf[1] = static_cast<char>((sz >> 16) & 0xFF);
+    buf[2] = static_cast<char>((sz >> 8) & 0xFF);
+    buf[3] = static_cast<char>(sz & 0xFF);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    // A meta larger than the limit still goes through once nothing else is
+    // pending
+    auto hasRoom = [&] {
+        return mPendingBytes == 0 ||
+               mPendingBytes + buf.size() <= MAX_PENDING_BYTES;
+    };
+    if (!hasRoom())
+    {
+        auto blocked = mBlockedTime.TimeScope();
+        mCV.wait(lock, hasRoom);
+    }
+    mPendingBytes += buf.size();
+    mPendingBytesCounter.set_count(mPendingBytes);
+    mPending.emplace_back(std::move(item));
+    lock.unlock();
+    mCV.notify_all();
+}
+
+void
+DebugMetaWriter::rotate(std::filesystem::path const& path,
+                        std::function<void()> onRotated)
+{
+    Item item;
+    item.mPath = path;
+    item.mOnRotated = std::move(onRotated);
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mPending.emplace_back(std::move(item));
+    }
+    mCV.notify_all();
+}
+
+void
+DebugMetaWriter::drain()
+{
+    ZoneScoped;
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCV.wait(lock, [this] { return mPending.empty() && !mBusy; });
+}
+
+void
+DebugMetaWriter::writeMeta(std::vector<char> const& data)
+{
+    ZoneScoped;
+    if (!mOut)
+    {
+        return;
+    }
+    auto timer = mWriteTime.TimeScope();
+    try
+    {
+        char const* out = data.data();
+        size_t size = data.size();
+#ifdef USE_ZLIB
+        auto& strm = *mZStream;
+        deflateReset(&strm);
+        mCompressed.resize(deflateBound(&strm, data.size()));
+        // zlib never writes through next_in
+        strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(out));
+        strm.avail_in = static_cast<uInt>(size);
+        strm.next_out = reinterpret_cast<Bytef*>(mCompressed.data());
+        strm.avail_out = static_cast<uInt>(mCompressed.size());
+        if (deflate(&strm, Z_FINISH) != Z_STREAM_END)
+        {
+            throw std::runtime_error("failed to compress debug metadata");
+        }
+        out = mCompressed.data();
+        size = strm.total_out;
+#endif
+        mOut->writeBytes(out, size);
+        mOut->flush();
+        mBytesWritten.Mark(size);
+    }
+    catch (std::exception const& e)
+    {
+        CLOG_WARNING(Ledger, "Failed to write debug metadata to '{}': {}",
+                     mPath.string(), e.what());
+        closeSegment();
+    }
+}
+
+void
+DebugMetaWriter::closeSegment()
+{
+    ZoneScoped;
+    if (!mOut)
+    {
+        return;
+    }
+    CLOG_DEBUG(Ledger, "closing meta-debug file {}", mPath.string());
+    auto timer = mCloseTime.TimeScope();
+    try
+    {
+        // Calls fsync
+        mOut->close();
+    }
+    catch (std::exception const& e)
+    {
+        CLOG_WARNING(Ledger, "Failed to close debug metadata stream: {}",
+                     e.what());
+    }
+    mOut.reset();
+    mPath.clear();
+}
+
+void
+DebugMetaWriter::openSegment(std::filesystem::path const& path)
+{
+    ZoneScoped;
+    releaseAssert(!mOut);
+    auto out =
+        std::make_unique<OutputFileStream>(mCtx, /*fsyncOnClose=*/true);
+    try
+    {
+        out->open(path.string());
+    }
+    catch (std::exception const& e)
+    {
+        CLOG_WARNING(Ledger, "Failed to open debug metadata stream '{}': {}",
+                     path.string(), e.what());
+        return;
+    }
+    CLOG_DEBUG(Ledger, "Streaming debug metadata to '{}'", path.string());
+    mOut = std::move(out);
+    mPath = path;
+}
+
+void
+DebugMetaWriter::run()
+{
+    ZoneScopedN("debug meta writer");
+    std::unique_lock<std::mutex> lock(mMutex);
+    for (;;)
+    {
+        mCV.wait(lock, [this] { return mStopping || !mPending.empty(); });
+        if (mPending.empty())
+        {
+            // Stopping, and everything queued has been done
+            return;
+        }
+
+        auto item = std::move(mPending.front());
+        mPending.pop_front();
+        mBusy = true;
+        lock.unlock();
+
+        if (item.mData.empty())
+        {
+            closeSegment();
+            if (!item.mPath.empty())
+            {
+                openSegment(item.mPath);
+            }
+            if (item.mOnRotated)
+            {
+                item.mOnRotated();
+            }
+        }
+        else
+        {
+            writeMeta(item.mData);
+        }
+
+        lock.lock();
+        mPendingBytes -= item.mData.size();
+        mPendingBytesCounter.set_count(mPendingBytes);
+        mBusy = false;
+        mCV.notify_all();
+    }
+}
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/NonCopyable.h"
+#include "xdr/Stellar-ledger.h"
+
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct z_stream_s;
+
+namespace asio
+{
+class io_context;
+}
+
+namespace medida
+{
+class Counter;
+class Meter;
+class MetricsRegistry;
+class Timer;
+}
+
+namespace stellar
+{
+
+class OutputFileStream;
+
+// Writes the METADATA_DEBUG_LEDGERS meta segments on a dedicated thread, so
+// that the live meta stream and ledger close don't wait on them.
+//
+// Each meta is serialized on the calling thread, framed as
+// XDROutputFileStream::writeOne frames it. When built with zlib, the writer
+// thread then compresses it into a gzip member of its own and segments are
+// named .xdr.gz; concatenated members are a valid gzip file, and a crash
+// loses at most the ledger being written. Without zlib segments are plain
+// XDR, to be gzipped once closed.
+//
+// Every ledger is flushed to the OS as soon as it is written, in case of a
+// crash later in the ledger close, but segments are only fsynced when they
+// are closed. At most MAX_PENDING_BYTES of serialized meta may be queued;
+// past that, write blocks until the writer catches up.
+//
+// Write errors are logged and drop the current segment: the next one starts
+// afresh at the next rotation.
+class DebugMetaWriter : public NonMovableOrCopyable
+{
+  public:
+    static constexpr size_t MAX_PENDING_BYTES = 64 * 1024 * 1024;
+#ifdef USE_ZLIB
+    static constexpr bool GZIP_SEGMENTS = true;
+#else
+    static constexpr bool GZIP_SEGMENTS = false;
+#endif
+
+    DebugMetaWriter(asio::io_context& ctx, medida::MetricsRegistry& registry);
+    // Closes the current segment after writing out everything queued
+    ~DebugMetaWriter();
+
+    // Queues meta for the current segment, dropped if there's none
+    void write(LedgerCloseMeta const& meta);
+
+    // Queues the close of the current segment, if any, and the opening of a
+    // segment at path, unless it's empty. onRotated, if set, is called on the
+    // writer thread once both are done, whether they succeeded or not.
+    void rotate(std::filesystem::path const& path,
+                std::function<void()> onRotated = nullptr);
+
+    // Blocks until everything queued so far has been done
+    void drain();
+
+  private:
+    struct Item
+    {
+        // Framed meta, or empty for a rotation
+        std::vector<char> mData;
+        std::filesystem::path mPath;
+        std::function<void()> mOnRotated;
+    };
+
+    asio::io_context& mCtx;
+
+    medida::Timer& mWriteTime;
+    medida::Timer& mCloseTime;
+    medida::Timer& mBlockedTime;
+    medida::Meter& mBytesWritten;
+    medida::Counter& mPendingBytesCounter;
+
+    std::mutex mMutex;
+    std::condition_variable mCV;
+    std::deque<Item> mPending;
+    size_t mPendingBytes{0};
+    bool mBusy{false};
+    bool mStopping{false};
+    std::thread mThread;
+
+    // Only used by the writer thread
+    std::unique_ptr<OutputFileStream> mOut;
+    std::filesystem::path mPath;
+    std::vector<char> mCompressed;
+#ifdef USE_ZLIB
+    std::unique_ptr<z_stream_s> mZStream;
+#endif
+
+    void writeMeta(std::vector<char> const& data);
+    void closeSegment();
+    void openSegment(std::filesystem::path const& path);
+    void run();
+};
+}
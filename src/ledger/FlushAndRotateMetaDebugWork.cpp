@@ -4,6 +4,7 @@
 
 #include "ledger/FlushAndRotateMetaDebugWork.h"
 #include "bucket/BucketManager.h"
+#include "ledger/DebugMetaWriter.h"
 #include "util/DebugMetaUtils.h"
 #include "util/Fs.h"
 #include "util/GlobalChecks.h"
@@ -20,97 +21,55 @@ using namespace metautils;
 
 FlushAndRotateMetaDebugWork::FlushAndRotateMetaDebugWork(
     Application& app, std::filesystem::path const& metaDebugPath,
-    std::unique_ptr<XDROutputFileStream> metaDebugFile, uint32_t ledgersToKeep)
+    uint32_t ledgersToKeep)
     : Work(app, "flush and rotate meta-debug", BasicWork::RETRY_NEVER)
     , mMetaDebugPath(metaDebugPath)
-    , mMetaDebugFile(std::move(metaDebugFile))
     , mLedgersToKeep(ledgersToKeep)
 {
 }
 
+void
+FlushAndRotateMetaDebugWork::segmentClosed()
+{
+    mSegmentClosed = true;
+    wakeUp();
+}
+
 BasicWork::State
 FlushAndRotateMetaDebugWork::doWork()
 {
-    // Step 1: transfer ownership of mMetaDebugFile to background thread
-    // and flush/fsync it. When that completes, it will post an action
-    // back to the main thread that unblocks this work to continue with
-    // gzip'ing and rotating.
-    if (mMetaDebugFile)
+    // Step 1: wait for the writer thread to close (and fsync) the segment.
+    if (!mSegmentClosed)
     {
-        std::weak_ptr<FlushAndRotateMetaDebugWork> weak =
-            std::static_pointer_cast<FlushAndRotateMetaDebugWork>(
-                shared_from_this());
-
-        // This is a little silly, but we have ownership of a non-copyable
-        // unique_ptr here, and we want to transfer that ownership into a
-        // closure held by a std::function -- which unfortunately requires
-        // its body to be copy-constructable. So we double-indirect through
-        // something copy-constructble: a shared_ptr<unique_ptr<...>>.
-        using OwnedStream = std::unique_ptr<XDROutputFileStream>;
-        auto file = std::make_shared<OwnedStream>(std::move(mMetaDebugFile));
-        mApp.postOnBackgroundThread(
-            [weak, file]() {
-                auto self = weak.lock();
-                if (!self || self->isAborting())
-                {
-                    return;
-                }
-
-                // First close() here, which will call fsync(), which blocks.
-                CLOG_DEBUG(Ledger, "closing meta-debug file {}",
-                           self->mMetaDebugPath.string());
-                try
-                {
-                    (*file)->close();
-                }
-                catch (std::runtime_error& e)
-                {
-                    // If we fail to close here, we're going to just eat the
-                    // error and carry on to trying to gzip. Hopefully this
-                    // doesn't cause a filehandle leak or something similarly
-                    // horrible.
-                    CLOG_WARNING(Ledger,
-                                 "Failed to close debug metadata stream: {}",
-                                 e.what());
-                }
-
-                // Then post back to main thread.
-                self->mApp.postOnMainThread(
-                    [weak]() {
-                        auto self = weak.lock();
-                        if (self)
-                        {
-                            self->wakeUp();
-                        }
-                    },
-                    "wake up gzip and rotate meta-debug");
-            },
-            "close and fsync meta-debug");
         return BasicWork::State::WORK_WAITING;
     }
 
-    // Step 2: wait for the creation and completion of mGzipFileWork.
-    if (!mGzipFileWork)
-    {
-        CLOG_DEBUG(Ledger, "compressing meta-debug file {}",
-                   mMetaDebugPath.string());
-        mGzipFileWork = addWork<GzipFileWork>(mMetaDebugPath.string());
-        return BasicWork::State::WORK_RUNNING;
-    }
-    if (!mGzipFileWork->isDone())
-    {
-        return mGzipFileWork->getState();
-    }
-    if (mGzipFileWork->getState() == State::WORK_SUCCESS)
+    // Step 2: unless the segment was compressed as it was written, wait for
+    // the creation and completion of mGzipFileWork.
+    if (!DebugMetaWriter::GZIP_SEGMENTS)
     {
-        CLOG_DEBUG(Ledger, "compressed meta-debug file {}",
-                   mMetaDebugPath.string());
-    }
-    else
-    {
-        CLOG_ERROR(Ledger, "failed to compress meta-debug file {}",
-                   mMetaDebugPath.string());
-        return State::WORK_FAILURE;
+        if (!mGzipFileWork)
+        {
+            CLOG_DEBUG(Ledger, "compressing meta-debug file {}",
+                       mMetaDebugPath.string());
+            mGzipFileWork = addWork<GzipFileWork>(mMetaDebugPath.string());
+            return BasicWork::State::WORK_RUNNING;
+        }
+        if (!mGzipFileWork->isDone())
+        {
+            return mGzipFileWork->getState();
+        }
+        if (mGzipFileWork->getState() == State::WORK_SUCCESS)
+        {
+            CLOG_DEBUG(Ledger, "compressed meta-debug file {}",
+                       mMetaDebugPath.string());
+        }
+        else
+        {
+            CLOG_ERROR(Ledger, "failed to compress meta-debug file {}",
+                       mMetaDebugPath.string());
+            return State::WORK_FAILURE;
+        }
     }
 
     // Step 3: synchronously rotate the meta files in the directory, whether
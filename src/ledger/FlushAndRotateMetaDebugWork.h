@@ -5,26 +5,29 @@
 #pragma once
 
 #include "historywork/GzipFileWork.h"
-#include "util/XDRStream.h"
 #include <filesystem>
 
 namespace stellar
 {
 
+// Finishes up a meta-debug segment once DebugMetaWriter has closed it:
+// gzips it if it wasn't compressed in process, and trims old segments.
 class FlushAndRotateMetaDebugWork : public Work
 {
     std::filesystem::path mMetaDebugPath;
-    std::unique_ptr<XDROutputFileStream> mMetaDebugFile;
+    bool mSegmentClosed{false};
     std::shared_ptr<GzipFileWork> mGzipFileWork;
     uint32_t mLedgersToKeep;
 
   public:
-    FlushAndRotateMetaDebugWork(
-        Application& app, std::filesystem::path const& metaDebugPath,
-        std::unique_ptr<XDROutputFileStream> metaDebugFile,
-        uint32_t ledgersToKeep);
+    FlushAndRotateMetaDebugWork(Application& app,
+                                std::filesystem::path const& metaDebugPath,
+                                uint32_t ledgersToKeep);
     ~FlushAndRotateMetaDebugWork() = default;
 
+    // Called on the main thread once the writer has closed the segment
+    void segmentClosed();
+
   protected:
     BasicWork::State doWork() override;
 };
@@ -3,11 +3,21 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "ledger/InMemorySorobanState.h"
+#include "bucket/LiveBucketList.h"
 #include "bucket/SearchableBucketList.h"
 #include "ledger/LedgerTypeUtils.h"
 #include "ledger/SorobanMetrics.h"
+#include "rust/RustBridge.h"
+#include "transactions/TransactionUtils.h"
 #include "util/GlobalChecks.h"
+#include "util/MemoryAccounting.h"
+#include "util/XDRCereal.h"
+#include <Tracy.hpp>
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <fmt/format.h>
+#include <future>
 
 namespace stellar
 {
@@ -30,6 +40,27 @@ contractCodeSizeForRent(LedgerEntry const& ledgerEntry,
     return ledgerEntrySizeForRent(ledgerEntry, xdr::xdr_size(ledgerEntry),
                                   ledgerVersionForSize, sorobanConfig);
 }
+
+// Estimates the memory used by a node based hash container, not counting
+// anything its elements own. Each node holds an element, a next pointer and a
+// cached hash code, and every bucket is one pointer.
+template <typename Container>
+size_t
+containerOverheadBytes(Container const& c)
+{
+    return c.size() *
+               (sizeof(typename Container::value_type) + 2 * sizeof(void*)) +
+           c.bucket_count() * sizeof(void*);
+}
+
+// Estimates the memory used by a red-black tree set, whose nodes hold an
+// element, three pointers and a color.
+template <typename Set>
+size_t
+treeOverheadBytes(Set const& s)
+{
+    return s.size() * (sizeof(typename Set::value_type) + 4 * sizeof(void*));
+}
 } // namespace
 
 bool
@@ -47,31 +78,170 @@ TTLData::isDefault() const
     }
 }
 
+uint256
+InMemorySorobanState::getKeyHash(LedgerKey const& ledgerKey)
+{
+    switch (ledgerKey.type())
+    {
+    case CONTRACT_DATA:
+    case CONTRACT_CODE:
+        return getTTLKey(ledgerKey).ttl().keyHash;
+    case TTL:
+        return ledgerKey.ttl().keyHash;
+    default:
+        throw std::runtime_error(
+            "InMemorySorobanState::getKeyHash: invalid key type");
+    }
+}
+
+size_t
+InMemorySorobanState::getShardIndex(uint256 const& keyHash)
+{
+    static_assert((NUM_SHARDS & (NUM_SHARDS - 1)) == 0);
+    // std::hash<uint256> only uses the leading bytes of the hash, so shard on
+    // the last byte to keep the in-shard bucket distribution uniform.
+    return keyHash.back() & (NUM_SHARDS - 1);
+}
+
+InMemorySorobanState::InMemorySorobanState(bool indexTTLs)
+{
+    for (auto& shard : mShards)
+    {
+        shard.mIndexTTLs = indexTTLs;
+    }
+}
+
+InMemorySorobanState::Shard&
+InMemorySorobanState::getShard(uint256 const& keyHash)
+{
+    return mShards[getShardIndex(keyHash)];
+}
+
+InMemorySorobanState::Shard const&
+InMemorySorobanState::getShard(uint256 const& keyHash) const
+{
+    return mShards[getShardIndex(keyHash)];
+}
+
 void
-InMemorySorobanState::updateContractDataTTL(
-    std::unordered_set<InternalContractDataMapEntry,
-                       InternalContractDataEntryHash>::iterator dataIt,
-    TTLData newTtlData)
+InMemorySorobanState::Shard::updateContractDataTTL(
+    InternalContractDataSet::iterator dataIt, TTLData newTtlData)
 {
     // Since entries are immutable, we must erase and re-insert
     auto ledgerEntryPtr = dataIt->get().ledgerEntry;
+    auto keyHash = dataIt->getKeyHash();
+    auto sizeBytes = dataIt->get().sizeBytes;
+    reindexTTL(keyHash, dataIt->get().ttlData, newTtlData);
     mContractDataEntries.erase(dataIt);
-    mContractDataEntries.emplace(
-        InternalContractDataMapEntry(std::move(ledgerEntryPtr), newTtlData));
+    mContractDataEntries.emplace(std::move(ledgerEntryPtr), keyHash,
+                                 newTtlData, sizeBytes);
 }
 
 void
-InMemorySorobanState::updateTTL(LedgerEntry const& ttlEntry)
+InMemorySorobanState::Shard::reindexTTL(uint256 const& keyHash,
+                                        TTLData oldTtlData, TTLData newTtlData)
+{
+    if (!mIndexTTLs)
+    {
+        return;
+    }
+    if (!oldTtlData.isDefault())
+    {
+        auto erased = mTTLIndex.erase({oldTtlData.liveUntilLedgerSeq, keyHash});
+        releaseAssertOrThrow(erased == 1);
+    }
+    if (!newTtlData.isDefault())
+    {
+        auto inserted =
+            mTTLIndex.emplace(newTtlData.liveUntilLedgerSeq, keyHash).second;
+        releaseAssertOrThrow(inserted);
+    }
+}
+
+TTLData
+InMemorySorobanState::Shard::takePendingTTL(uint256 const& keyHash)
+{
+    auto ttlIt = mPendingTTLs.find(keyHash);
+    if (ttlIt == mPendingTTLs.end())
+    {
+        // TTL hasn't arrived yet, initialize to 0 (will be updated later)
+        return TTLData();
+    }
+
+    // Found orphaned TTL - adopt it and remove from temporary storage
+    auto ttlData = ttlIt->second;
+    mPendingTTLs.erase(ttlIt);
+    return ttlData;
+}
+
+std::optional<TTLData>
+InMemorySorobanState::Shard::findTTL(uint256 const& keyHash) const
+{
+    // Since the TTL key is the hash of the associated LedgerKey, we don't know
+    // which map it could belong in, so check both.
+    auto dataIt =
+        mContractDataEntries.find(InternalContractDataMapEntry(keyHash));
+    if (dataIt != mContractDataEntries.end())
+    {
+        return dataIt->get().ttlData;
+    }
+
+    auto codeIt = mContractCodeEntries.find(keyHash);
+    if (codeIt != mContractCodeEntries.end())
+    {
+        return codeIt->second.ttlData;
+    }
+
+    return std::nullopt;
+}
+
+std::shared_ptr<LedgerEntry const>
+InMemorySorobanState::Shard::findEntry(uint256 const& keyHash) const
+{
+    auto dataIt =
+        mContractDataEntries.find(InternalContractDataMapEntry(keyHash));
+    if (dataIt != mContractDataEntries.end())
+    {
+        return dataIt->get().ledgerEntry;
+    }
+
+    auto codeIt = mContractCodeEntries.find(keyHash);
+    if (codeIt != mContractCodeEntries.end())
+    {
+        return codeIt->second.ledgerEntry;
+    }
+
+    return nullptr;
+}
+
+bool
+InMemorySorobanState::Shard::hasTTL(uint256 const& keyHash) const
+{
+    // Check if this is a pending TTL
+    if (mPendingTTLs.find(keyHash) != mPendingTTLs.end())
+    {
+        return true;
+    }
+
+    // Only return true if TTL has been set (non-zero). During initialization,
+    // entries may exist with default constructed TTLs
+    auto ttlData = findTTL(keyHash);
+    return ttlData && !ttlData->isDefault();
+}
+
+void
+InMemorySorobanState::Shard::updateTTL(LedgerEntry const& ttlEntry)
 {
     releaseAssertOrThrow(ttlEntry.data.type() == TTL);
 
-    auto lk = LedgerEntryKey(ttlEntry);
+    auto const& keyHash = ttlEntry.data.ttl().keyHash;
     auto newTtlData = TTLData(ttlEntry.data.ttl().liveUntilLedgerSeq,
                               ttlEntry.lastModifiedLedgerSeq);
 
     // TTL updates can apply to either ContractData or ContractCode entries.
     // First check if this TTL belongs to a stored ContractData entry.
-    auto dataIt = mContractDataEntries.find(InternalContractDataMapEntry(lk));
+    auto dataIt =
+        mContractDataEntries.find(InternalContractDataMapEntry(keyHash));
     if (dataIt != mContractDataEntries.end())
     {
         updateContractDataTTL(dataIt, newTtlData);
@@ -80,63 +250,54 @@ InMemorySorobanState::updateTTL(LedgerEntry const& ttlEntry)
     {
         // Since we're updating a TTL that exists, if we get here it must belong
         // to a contract code entry.
-        auto codeIt = mContractCodeEntries.find(lk.ttl().keyHash);
+        auto codeIt = mContractCodeEntries.find(keyHash);
         releaseAssertOrThrow(codeIt != mContractCodeEntries.end());
+        reindexTTL(keyHash, codeIt->second.ttlData, newTtlData);
         codeIt->second.ttlData = newTtlData;
     }
 }
 
 void
-InMemorySorobanState::updateContractData(LedgerEntry const& ledgerEntry)
+InMemorySorobanState::Shard::updateContractData(LedgerEntry const& ledgerEntry,
+                                                uint256 const& keyHash)
 {
     releaseAssertOrThrow(ledgerEntry.data.type() == CONTRACT_DATA);
 
     // Entry must already exist since this is an update
-    auto lk = LedgerEntryKey(ledgerEntry);
-    auto dataIt = mContractDataEntries.find(InternalContractDataMapEntry(lk));
+    auto dataIt =
+        mContractDataEntries.find(InternalContractDataMapEntry(keyHash));
     releaseAssertOrThrow(dataIt != mContractDataEntries.end());
     releaseAssertOrThrow(dataIt->get().ledgerEntry != nullptr);
 
-    uint32_t oldSize = xdr::xdr_size(*dataIt->get().ledgerEntry);
     uint32_t newSize = xdr::xdr_size(ledgerEntry);
-    updateStateSizeOnEntryUpdate(oldSize, newSize, /*isContractCode=*/false);
+    updateStateSizeOnEntryUpdate(dataIt->get().sizeBytes, newSize,
+                                 /*isContractCode=*/false);
 
     // Preserve the existing TTL while updating the data
     auto preservedTTL = dataIt->get().ttlData;
     mContractDataEntries.erase(dataIt);
-    mContractDataEntries.emplace(
-        InternalContractDataMapEntry(ledgerEntry, preservedTTL));
+    mContractDataEntries.emplace(ledgerEntry, keyHash, preservedTTL, newSize);
 }
 
 void
-InMemorySorobanState::createContractDataEntry(LedgerEntry const& ledgerEntry)
+InMemorySorobanState::Shard::createContractDataEntry(
+    LedgerEntry const& ledgerEntry, uint256 const& keyHash)
 {
     releaseAssertOrThrow(ledgerEntry.data.type() == CONTRACT_DATA);
 
     // Verify entry doesn't already exist
-    auto dataIt = mContractDataEntries.find(
-        InternalContractDataMapEntry(LedgerEntryKey(ledgerEntry)));
+    auto dataIt =
+        mContractDataEntries.find(InternalContractDataMapEntry(keyHash));
     releaseAssertOrThrow(dataIt == mContractDataEntries.end());
 
     // Check if we've already seen this entry's TTL (can happen during
     // initialization when TTL is written before the data)
-    auto ttlKey = getTTLKey(LedgerEntryKey(ledgerEntry));
-    auto ttlData = TTLData();
+    auto ttlData = takePendingTTL(keyHash);
 
-    auto ttlIt = mPendingTTLs.find(ttlKey);
-    if (ttlIt != mPendingTTLs.end())
-    {
-        // Found orphaned TTL - adopt it and remove from temporary storage
-        ttlData = TTLData(ttlIt->second.data.ttl().liveUntilLedgerSeq,
-                          ttlIt->second.lastModifiedLedgerSeq);
-        mPendingTTLs.erase(ttlIt);
-    }
-    // else: TTL hasn't arrived yet, initialize to 0 (will be updated later)
-
-    updateStateSizeOnEntryUpdate(0, xdr::xdr_size(ledgerEntry),
-                                 /*isContractCode=*/false);
-    mContractDataEntries.emplace(
-        InternalContractDataMapEntry(ledgerEntry, ttlData));
+    uint32_t size = xdr::xdr_size(ledgerEntry);
+    updateStateSizeOnEntryUpdate(0, size, /*isContractCode=*/false);
+    reindexTTL(keyHash, TTLData(), ttlData);
+    mContractDataEntries.emplace(ledgerEntry, keyHash, ttlData, size);
 }
 
 bool
@@ -147,17 +308,18 @@ InMemorySorobanState::isInMemoryType(LedgerKey const& ledgerKey)
 }
 
 void
-InMemorySorobanState::createTTL(LedgerEntry const& ttlEntry)
+InMemorySorobanState::Shard::createTTL(LedgerEntry const& ttlEntry)
 {
     releaseAssertOrThrow(ttlEntry.data.type() == TTL);
 
-    auto lk = LedgerEntryKey(ttlEntry);
+    auto const& keyHash = ttlEntry.data.ttl().keyHash;
     auto newTtlData = TTLData(ttlEntry.data.ttl().liveUntilLedgerSeq,
                               ttlEntry.lastModifiedLedgerSeq);
 
     // Check if the corresponding ContractData entry already exists
     // (can happen during initialization when entries arrive out of order)
-    auto dataIt = mContractDataEntries.find(InternalContractDataMapEntry(lk));
+    auto dataIt =
+        mContractDataEntries.find(InternalContractDataMapEntry(keyHash));
     if (dataIt != mContractDataEntries.end())
     {
         // ContractData exists but has no TTL yet - update it
@@ -169,33 +331,33 @@ InMemorySorobanState::createTTL(LedgerEntry const& ttlEntry)
     {
         // Check if this TTL belongs to a ContractCode entry that hasn't arrived
         // yet
-        auto codeIt = mContractCodeEntries.find(lk.ttl().keyHash);
+        auto codeIt = mContractCodeEntries.find(keyHash);
         if (codeIt != mContractCodeEntries.end())
         {
             // ContractCode exists but has no TTL yet - update it
             // Verify TTL hasn't been set yet (should be default initialized)
             releaseAssertOrThrow(codeIt->second.ttlData.isDefault());
+            reindexTTL(keyHash, codeIt->second.ttlData, newTtlData);
             codeIt->second.ttlData = newTtlData;
         }
         else
         {
             // No ContractData or ContractCode yet - store TTL for later
-            auto [_, inserted] = mPendingTTLs.emplace(lk, ttlEntry);
+            auto [_, inserted] = mPendingTTLs.emplace(keyHash, newTtlData);
             releaseAssertOrThrow(inserted);
         }
     }
 }
 
 void
-InMemorySorobanState::deleteContractData(LedgerKey const& ledgerKey)
+InMemorySorobanState::Shard::deleteContractData(uint256 const& keyHash)
 {
-    releaseAssertOrThrow(ledgerKey.type() == CONTRACT_DATA);
-    auto it =
-        mContractDataEntries.find(InternalContractDataMapEntry(ledgerKey));
+    auto it = mContractDataEntries.find(InternalContractDataMapEntry(keyHash));
     releaseAssertOrThrow(it != mContractDataEntries.end());
     releaseAssertOrThrow(it->get().ledgerEntry != nullptr);
-    updateStateSizeOnEntryUpdate(xdr::xdr_size(*it->get().ledgerEntry), 0,
+    updateStateSizeOnEntryUpdate(it->get().sizeBytes, 0,
                                  /*isContractCode=*/false);
+    reindexTTL(keyHash, it->get().ttlData, TTLData());
     mContractDataEntries.erase(it);
 }
 
@@ -206,9 +368,10 @@ InMemorySorobanState::get(LedgerKey const& ledgerKey) const
     {
     case CONTRACT_DATA:
     {
-        auto it =
-            mContractDataEntries.find(InternalContractDataMapEntry(ledgerKey));
-        if (it == mContractDataEntries.end())
+        auto keyHash = getKeyHash(ledgerKey);
+        auto const& entries = getShard(keyHash).mContractDataEntries;
+        auto it = entries.find(InternalContractDataMapEntry(keyHash));
+        if (it == entries.end())
         {
             return nullptr;
         }
@@ -216,10 +379,10 @@ InMemorySorobanState::get(LedgerKey const& ledgerKey) const
     }
     case CONTRACT_CODE:
     {
-        auto ttlKey = getTTLKey(ledgerKey);
-        auto keyHash = ttlKey.ttl().keyHash;
-        auto it = mContractCodeEntries.find(keyHash);
-        if (it == mContractCodeEntries.end())
+        auto keyHash = getKeyHash(ledgerKey);
+        auto const& entries = getShard(keyHash).mContractCodeEntries;
+        auto it = entries.find(keyHash);
+        if (it == entries.end())
         {
             return nullptr;
         }
@@ -233,16 +396,102 @@ InMemorySorobanState::get(LedgerKey const& ledgerKey) const
     }
 }
 
+std::optional<uint32_t>
+InMemorySorobanState::getContractCodeSizeForRent(
+    LedgerKey const& ledgerKey) const
+{
+    releaseAssertOrThrow(ledgerKey.type() == CONTRACT_CODE);
+    auto keyHash = getKeyHash(ledgerKey);
+    auto const& entries = getShard(keyHash).mContractCodeEntries;
+    auto it = entries.find(keyHash);
+    if (it == entries.end())
+    {
+        return std::nullopt;
+    }
+    return it->second.sizeBytes;
+}
+
+bool
+InMemorySorobanState::hasTTLIndex() const
+{
+    return mShards.front().mIndexTTLs;
+}
+
+std::vector<std::shared_ptr<LedgerEntry const>>
+InMemorySorobanState::getExpiredEntries(uint32_t ledgerSeq, size_t limit) const
+{
+    ZoneScoped;
+    releaseAssertOrThrow(hasTTLIndex());
+
+    // Merge the expired prefixes of the shard indexes, smallest first
+    using IndexIter = std::set<std::pair<uint32_t, uint256>>::const_iterator;
+    std::vector<std::pair<IndexIter, IndexIter>> ranges;
+    for (auto const& shard : mShards)
+    {
+        auto end = shard.mTTLIndex.lower_bound({ledgerSeq, uint256{}});
+        if (shard.mTTLIndex.begin() != end)
+        {
+            ranges.emplace_back(shard.mTTLIndex.begin(), end);
+        }
+    }
+    auto later = [](auto const& a, auto const& b) {
+        return *b.first < *a.first;
+    };
+    std::make_heap(ranges.begin(), ranges.end(), later);
+
+    std::vector<std::shared_ptr<LedgerEntry const>> res;
+    while (!ranges.empty() && res.size() < limit)
+    {
+        std::pop_heap(ranges.begin(), ranges.end(), later);
+        auto& range = ranges.back();
+        auto const& keyHash = range.first->second;
+        auto entry = getShard(keyHash).findEntry(keyHash);
+        releaseAssertOrThrow(entry);
+        res.emplace_back(std::move(entry));
+        if (++range.first == range.second)
+        {
+            ranges.pop_back();
+        }
+        else
+        {
+            std::push_heap(ranges.begin(), ranges.end(), later);
+        }
+    }
+    return res;
+}
+
 void
-InMemorySorobanState::createContractCodeEntry(
-    LedgerEntry const& ledgerEntry, SorobanNetworkConfig const& sorobanConfig,
-    uint32_t ledgerVersion)
+InMemorySorobanState::checkEvictedEntries(std::vector<LedgerKey> const& keys,
+                                          uint32_t ledgerSeq) const
 {
-    releaseAssertOrThrow(ledgerEntry.data.type() == CONTRACT_CODE);
+    ZoneScoped;
+    releaseAssertOrThrow(hasTTLIndex());
+    releaseAssertOrThrow(mLastClosedLedgerSeq < ledgerSeq);
+    for (auto const& key : keys)
+    {
+        releaseAssertOrThrow(key.type() == CONTRACT_DATA ||
+                             key.type() == CONTRACT_CODE);
+        auto keyHash = getKeyHash(key);
+        auto const& shard = getShard(keyHash);
+        auto ttlData = shard.findTTL(keyHash);
+        if (!ttlData || ttlData->isDefault() ||
+            ttlData->liveUntilLedgerSeq >= ledgerSeq ||
+            shard.mTTLIndex.count({ttlData->liveUntilLedgerSeq, keyHash}) == 0)
+        {
+            throw std::runtime_error(fmt::format(
+                FMT_STRING("InMemorySorobanState: evicted entry {} is not "
+                           "expired at ledger {} in the TTL index"),
+                xdrToCerealString(key, "LedgerKey"), ledgerSeq));
+        }
+    }
+}
 
-    // Get the TTL key hash
-    auto ttlKey = getTTLKey(LedgerEntryKey(ledgerEntry));
-    auto keyHash = ttlKey.ttl().keyHash;
+void
+InMemorySorobanState::Shard::createContractCodeEntry(
+    LedgerEntry const& ledgerEntry, uint256 const& keyHash,
+    SorobanNetworkConfig const& sorobanConfig, uint32_t ledgerVersion)
+{
+    releaseAssertOrThrow(ledgerEntry.data.type() == CONTRACT_CODE);
 
     // Verify entry doesn't already exist
     auto codeIt = mContractCodeEntries.find(keyHash);
@@ -250,21 +499,12 @@ InMemorySorobanState::createContractCodeEntry(
 
     // Check if we've already seen this entry's TTL (can happen during
     // initialization when TTL is written before the code)
-    auto ttlData = TTLData();
-
-    auto ttlIt = mPendingTTLs.find(ttlKey);
-    if (ttlIt != mPendingTTLs.end())
-    {
-        // Found orphaned TTL - adopt it and remove from temporary storage
-        ttlData = TTLData(ttlIt->second.data.ttl().liveUntilLedgerSeq,
-                          ttlIt->second.lastModifiedLedgerSeq);
-        mPendingTTLs.erase(ttlIt);
-    }
-    // else: TTL hasn't arrived yet, initialize to 0 (will be updated later)
+    auto ttlData = takePendingTTL(keyHash);
 
     uint32_t entrySize =
         contractCodeSizeForRent(ledgerEntry, sorobanConfig, ledgerVersion);
     updateStateSizeOnEntryUpdate(0, entrySize, /*isContractCode=*/true);
+    reindexTTL(keyHash, TTLData(), ttlData);
 
     mContractCodeEntries.emplace(
         keyHash,
@@ -273,13 +513,11 @@ InMemorySorobanState::createContractCodeEntry(
 }
 
 void
-InMemorySorobanState::updateContractCode(
-    LedgerEntry const& ledgerEntry, SorobanNetworkConfig const& sorobanConfig,
-    uint32_t ledgerVersion)
+InMemorySorobanState::Shard::updateContractCode(
+    LedgerEntry const& ledgerEntry, uint256 const& keyHash,
+    SorobanNetworkConfig const& sorobanConfig, uint32_t ledgerVersion)
 {
     releaseAssertOrThrow(ledgerEntry.data.type() == CONTRACT_CODE);
-    auto ttlKey = getTTLKey(LedgerEntryKey(ledgerEntry));
-    auto keyHash = ttlKey.ttl().keyHash;
 
     // Entry must already exist since this is an update
     auto codeIt = mContractCodeEntries.find(keyHash);
@@ -300,16 +538,13 @@ InMemorySorobanState::updateContractCode(
 }
 
 void
-InMemorySorobanState::deleteContractCode(LedgerKey const& ledgerKey)
+InMemorySorobanState::Shard::deleteContractCode(uint256 const& keyHash)
 {
-    releaseAssertOrThrow(ledgerKey.type() == CONTRACT_CODE);
-
-    auto ttlKey = getTTLKey(ledgerKey);
-    auto keyHash = ttlKey.ttl().keyHash;
     auto it = mContractCodeEntries.find(keyHash);
     releaseAssertOrThrow(it != mContractCodeEntries.end());
     updateStateSizeOnEntryUpdate(it->second.sizeBytes, 0,
                                  /*isContractCode=*/true);
+    reindexTTL(keyHash, it->second.ttlData, TTLData());
     mContractCodeEntries.erase(it);
 }
 
@@ -317,42 +552,22 @@ bool
 InMemorySorobanState::hasTTL(LedgerKey const& ledgerKey) const
 {
     releaseAssertOrThrow(ledgerKey.type() == TTL);
-
-    // Check if this is a pending TTL
-    if (mPendingTTLs.find(ledgerKey) != mPendingTTLs.end())
-    {
-        return true;
-    }
-
-    // Check if this is a ContractData TTL (stored with the data)
-    auto dataIt =
-        mContractDataEntries.find(InternalContractDataMapEntry(ledgerKey));
-    if (dataIt != mContractDataEntries.end())
-    {
-        // Only return true if TTL has been set (non-zero)
-        // During initialization, entries may exist with default constructed
-        // TTLs
-        return !dataIt->get().ttlData.isDefault();
-    }
-
-    // Check if this is a ContractCode TTL (stored with the code)
-    auto codeIt = mContractCodeEntries.find(ledgerKey.ttl().keyHash);
-    if (codeIt != mContractCodeEntries.end())
-    {
-        // Only return true if TTL has been set (non-zero)
-        // During initialization, entries may exist with default constructed
-        // TTLs
-        return !codeIt->second.ttlData.isDefault();
-    }
-
-    return false;
+    auto const& keyHash = ledgerKey.ttl().keyHash;
+    return getShard(keyHash).hasTTL(keyHash);
 }
 
 bool
 InMemorySorobanState::isEmpty() const
 {
-    return mContractDataEntries.empty() && mContractCodeEntries.empty() &&
-           mPendingTTLs.empty();
+    for (auto const& shard : mShards)
+    {
+        if (!shard.mContractDataEntries.empty() ||
+            !shard.mContractCodeEntries.empty() || !shard.mPendingTTLs.empty())
+        {
+            return false;
+        }
+    }
+    return true;
 }
 
 uint32_t
@@ -361,129 +576,266 @@ InMemorySorobanState::getLedgerSeq() const
     return mLastClosedLedgerSeq;
 }
 
+size_t
+InMemorySorobanState::getContractDataEntryCount() const
+{
+    size_t count = 0;
+    for (auto const& shard : mShards)
+    {
+        count += shard.mContractDataEntries.size();
+    }
+    return count;
+}
+
+size_t
+InMemorySorobanState::getContractCodeEntryCount() const
+{
+    size_t count = 0;
+    for (auto const& shard : mShards)
+    {
+        count += shard.mContractCodeEntries.size();
+    }
+    return count;
+}
+
 std::shared_ptr<LedgerEntry const>
 InMemorySorobanState::getTTL(LedgerKey const& ledgerKey) const
 {
     releaseAssertOrThrow(ledgerKey.type() == TTL);
+    auto const& keyHash = ledgerKey.ttl().keyHash;
+    auto const& shard = getShard(keyHash);
 
     // This should never be called when we are mid-update
-    releaseAssertOrThrow(mPendingTTLs.empty());
-
-    auto constructTTLEntry = [&ledgerKey](TTLData const& ttlData) {
-        releaseAssertOrThrow(!ttlData.isDefault());
-        auto ttlEntry = std::make_shared<LedgerEntry>();
-        ttlEntry->data.type(TTL);
-        ttlEntry->data.ttl().keyHash = ledgerKey.ttl().keyHash;
-        ttlEntry->data.ttl().liveUntilLedgerSeq = ttlData.liveUntilLedgerSeq;
-        ttlEntry->lastModifiedLedgerSeq = ttlData.lastModifiedLedgerSeq;
-        return ttlEntry;
-    };
+    releaseAssertOrThrow(shard.mPendingTTLs.empty());
 
-    // Since the TTL key is the hash of the associated LedgerKey, we don't know
-    // which map it could belong in, so check both.
-    auto dataIt =
-        mContractDataEntries.find(InternalContractDataMapEntry(ledgerKey));
-    if (dataIt != mContractDataEntries.end())
+    auto ttlData = shard.findTTL(keyHash);
+    if (!ttlData)
     {
-        return constructTTLEntry(dataIt->get().ttlData);
+        return nullptr;
     }
 
-    auto codeIt = mContractCodeEntries.find(ledgerKey.ttl().keyHash);
-    if (codeIt != mContractCodeEntries.end())
+    releaseAssertOrThrow(!ttlData->isDefault());
+    auto ttlEntry = std::make_shared<LedgerEntry>();
+    ttlEntry->data.type(TTL);
+    ttlEntry->data.ttl().keyHash = keyHash;
+    ttlEntry->data.ttl().liveUntilLedgerSeq = ttlData->liveUntilLedgerSeq;
+    ttlEntry->lastModifiedLedgerSeq = ttlData->lastModifiedLedgerSeq;
+    return ttlEntry;
+}
+
+void
+InMemorySorobanState::loadBucketEntry(
+    Shard& shard, BucketEntry const& be, uint256 const& keyHash,
+    std::unordered_set<LedgerKey>& deletedKeys,
+    SorobanNetworkConfig const& sorobanConfig, uint32_t ledgerVersion)
+{
+    // Check if entry is a DEADENTRY and add it to deletedKeys. Otherwise,
+    // check if the entry is shadowed by a DEADENTRY.
+    if (be.type() == DEADENTRY)
     {
-        return constructTTLEntry(codeIt->second.ttlData);
+        deletedKeys.insert(be.deadEntry());
+        return;
     }
 
-    return nullptr;
+    releaseAssertOrThrow(be.type() == LIVEENTRY || be.type() == INITENTRY);
+    auto const& le = be.liveEntry();
+    auto lk = LedgerEntryKey(le);
+    if (deletedKeys.find(lk) != deletedKeys.end())
+    {
+        return;
+    }
+
+    switch (lk.type())
+    {
+    case CONTRACT_DATA:
+        if (shard.mContractDataEntries.find(InternalContractDataMapEntry(
+                keyHash)) == shard.mContractDataEntries.end())
+        {
+            shard.createContractDataEntry(le, keyHash);
+        }
+        break;
+    case TTL:
+        if (!shard.hasTTL(keyHash))
+        {
+            shard.createTTL(le);
+        }
+        break;
+    case CONTRACT_CODE:
+        if (shard.mContractCodeEntries.find(keyHash) ==
+            shard.mContractCodeEntries.end())
+        {
+            shard.createContractCodeEntry(le, keyHash, sorobanConfig,
+                                          ledgerVersion);
+        }
+        break;
+    default:
+        throw std::runtime_error(
+            "InMemorySorobanState::loadBucketEntry: invalid entry type");
+    }
 }
 
 void
 InMemorySorobanState::initializeStateFromSnapshot(
     SearchableSnapshotConstPtr snap, SorobanNetworkConfig const* sorobanConfig,
-    uint32_t ledgerVersion)
+    uint32_t ledgerVersion, uint32_t numThreads)
 {
-    releaseAssertOrThrow(mContractDataEntries.empty());
-    releaseAssertOrThrow(mContractCodeEntries.empty());
-    releaseAssertOrThrow(mPendingTTLs.empty());
+    MEMORY_ACCOUNTING_SCOPE(SOROBAN_STATE);
+    releaseAssertOrThrow(isEmpty());
 
     if (protocolVersionStartsFrom(ledgerVersion, SOROBAN_PROTOCOL_VERSION))
     {
         releaseAssertOrThrow(sorobanConfig != nullptr);
-        // Check if entry is a DEADENTRY and add it to deletedKeys. Otherwise,
-        // check if the entry is shadowed by a DEADENTRY.
-        std::unordered_set<LedgerKey> deletedKeys;
-        auto shouldAddToMap = [&deletedKeys](BucketEntry const& be,
-                                             LedgerEntryType expectedType) {
-            if (be.type() == DEADENTRY)
-            {
-                deletedKeys.insert(be.deadEntry());
-                return false;
-            }
-
-            releaseAssertOrThrow(be.type() == LIVEENTRY ||
-                                 be.type() == INITENTRY);
-            auto lk = LedgerEntryKey(be.liveEntry());
-            releaseAssertOrThrow(lk.type() == expectedType);
-            return deletedKeys.find(lk) == deletedKeys.end();
+        auto getBucketEntryKeyHash = [](BucketEntry const& be) {
+            return getKeyHash(be.type() == DEADENTRY
+                                  ? be.deadEntry()
+                                  : LedgerEntryKey(be.liveEntry()));
         };
+        std::array<LedgerEntryType, 3> const types = {CONTRACT_DATA, TTL,
+                                                      CONTRACT_CODE};
 
-        auto contractDataHandler = [this,
-                                    &shouldAddToMap](BucketEntry const& be) {
-            if (!shouldAddToMap(be, CONTRACT_DATA))
-            {
+        if (numThreads <= 1)
+        {
+            std::unordered_set<LedgerKey> deletedKeys;
+            auto handler = [&](BucketEntry const& be) {
+                auto keyHash = getBucketEntryKeyHash(be);
+                loadBucketEntry(getShard(keyHash), be, keyHash, deletedKeys,
+                                *sorobanConfig, ledgerVersion);
                 return Loop::INCOMPLETE;
+            };
+            for (auto type : types)
+            {
+                snap->scanForEntriesOfType(type, handler);
             }
-
-            auto lk = LedgerEntryKey(be.liveEntry());
-            if (!get(lk))
+        }
+        else
+        {
+            // Every entry of each level, split by shard. Levels are scanned in
+            // parallel, then each shard merges its entries newest level first.
+            // Keys never span shards, so this matches a serial load.
+            using ShardEntries = std::vector<std::pair<BucketEntry, uint256>>;
+            std::vector<std::array<ShardEntries, NUM_SHARDS>> levelEntries(
+                LiveBucketList::kNumLevels);
+            auto collect = [&](BucketEntry const& be, uint32_t level) {
+                releaseAssert(level < levelEntries.size());
+                auto keyHash = getBucketEntryKeyHash(be);
+                levelEntries[level][getShardIndex(keyHash)].emplace_back(
+                    be, keyHash);
+            };
+            for (auto type : types)
             {
-                createContractDataEntry(be.liveEntry());
+                snap->scanForEntriesOfTypeByLevel(type, numThreads, collect);
             }
 
-            return Loop::INCOMPLETE;
-        };
-
-        auto ttlHandler = [this, &shouldAddToMap](BucketEntry const& be) {
-            if (!shouldAddToMap(be, TTL))
+            std::atomic<size_t> nextShard{0};
+            auto worker = [&]() {
+                // Accounting scopes are per thread
+                MEMORY_ACCOUNTING_SCOPE(SOROBAN_STATE);
+                for (auto i = nextShard++; i < NUM_SHARDS; i = nextShard++)
+                {
+                    std::unordered_set<LedgerKey> deletedKeys;
+                    for (auto& shards : levelEntries)
+                    {
+                        for (auto const& [be, keyHash] : shards[i])
+                        {
+                            loadBucketEntry(mShards[i], be, keyHash,
+                                            deletedKeys, *sorobanConfig,
+                                            ledgerVersion);
+                        }
+                        ShardEntries().swap(shards[i]);
+                    }
+                }
+            };
+
+            auto const numWorkers = std::min<size_t>(numThreads, NUM_SHARDS);
+            std::vector<std::future<void>> futures;
+            for (size_t i = 1; i < numWorkers; ++i)
             {
-                return Loop::INCOMPLETE;
+                futures.emplace_back(std::async(std::launch::async, worker));
             }
 
-            auto lk = LedgerEntryKey(be.liveEntry());
-            if (!hasTTL(lk))
+            // Wait for every shard before rethrowing any failure, so no worker
+            // outlives the entries it references.
+            std::exception_ptr error;
+            try
             {
-                createTTL(be.liveEntry());
+                worker();
             }
-
-            return Loop::INCOMPLETE;
-        };
-
-        auto contractCodeHandler = [this, &shouldAddToMap, &sorobanConfig,
-                                    ledgerVersion](BucketEntry const& be) {
-            if (!shouldAddToMap(be, CONTRACT_CODE))
+            catch (...)
             {
-                return Loop::INCOMPLETE;
+                error = std::current_exception();
+                nextShard = NUM_SHARDS;
             }
-
-            auto lk = LedgerEntryKey(be.liveEntry());
-            if (!get(lk))
+            for (auto& f : futures)
             {
-                createContractCodeEntry(be.liveEntry(), *sorobanConfig,
-                                        ledgerVersion);
+                f.wait();
             }
-
-            return Loop::INCOMPLETE;
-        };
-
-        snap->scanForEntriesOfType(CONTRACT_DATA, contractDataHandler);
-        snap->scanForEntriesOfType(TTL, ttlHandler);
-        snap->scanForEntriesOfType(CONTRACT_CODE, contractCodeHandler);
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+            for (auto& f : futures)
+            {
+                f.get();
+            }
+        }
     }
 
     mLastClosedLedgerSeq = snap->getLedgerSeq();
     checkUpdateInvariants();
 }
 
+void
+InMemorySorobanState::applyShardUpdate(
+    Shard& shard, ShardUpdate const& update,
+    SorobanNetworkConfig const& sorobanConfig, uint32_t ledgerVersion)
+{
+    for (auto const& [entry, keyHash] : update.mInitEntries)
+    {
+        if (entry->data.type() == CONTRACT_DATA)
+        {
+            shard.createContractDataEntry(*entry, keyHash);
+        }
+        else if (entry->data.type() == CONTRACT_CODE)
+        {
+            shard.createContractCodeEntry(*entry, keyHash, sorobanConfig,
+                                          ledgerVersion);
+        }
+        else
+        {
+            shard.createTTL(*entry);
+        }
+    }
+
+    for (auto const& [entry, keyHash] : update.mLiveEntries)
+    {
+        if (entry->data.type() == CONTRACT_DATA)
+        {
+            shard.updateContractData(*entry, keyHash);
+        }
+        else if (entry->data.type() == CONTRACT_CODE)
+        {
+            shard.updateContractCode(*entry, keyHash, sorobanConfig,
+                                     ledgerVersion);
+        }
+        else
+        {
+            shard.updateTTL(*entry);
+        }
+    }
+
+    for (auto const& [key, keyHash] : update.mDeadEntries)
+    {
+        if (key->type() == CONTRACT_DATA)
+        {
+            shard.deleteContractData(keyHash);
+        }
+        else
+        {
+            shard.deleteContractCode(keyHash);
+        }
+    }
+}
+
 void
 InMemorySorobanState::updateState(std::vector<LedgerEntry> const& initEntries,
                                   std::vector<LedgerEntry> const& liveEntries,
@@ -491,6 +843,7 @@ InMemorySorobanState::updateState(std::vector<LedgerEntry> const& initEntries,
                                   LedgerHeader const& lh,
                                   SorobanNetworkConfig const* sorobanConfig)
 {
+    MEMORY_ACCOUNTING_SCOPE(SOROBAN_STATE);
     // After initialization, we must apply every ledger in order to the
     // in-memory state with no gaps.
     releaseAssertOrThrow(mLastClosedLedgerSeq + 1 == lh.ledgerSeq);
@@ -501,50 +854,76 @@ InMemorySorobanState::updateState(std::vector<LedgerEntry> const& initEntries,
     {
         releaseAssertOrThrow(sorobanConfig != nullptr);
         uint32_t ledgerVersion = lh.ledgerVersion;
-        for (auto const& entry : initEntries)
-        {
-            if (entry.data.type() == CONTRACT_DATA)
-            {
-                createContractDataEntry(entry);
-            }
-            else if (entry.data.type() == CONTRACT_CODE)
+
+        // Partition the changes by shard, preserving their relative order.
+        std::array<ShardUpdate, NUM_SHARDS> updates;
+        size_t numChanges = 0;
+        auto partitionEntries = [&](std::vector<LedgerEntry> const& entries,
+                                    auto member) {
+            for (auto const& entry : entries)
             {
-                createContractCodeEntry(entry, *sorobanConfig, ledgerVersion);
+                auto type = entry.data.type();
+                if (type != CONTRACT_DATA && type != CONTRACT_CODE &&
+                    type != TTL)
+                {
+                    continue;
+                }
+
+                auto keyHash = type == TTL
+                                   ? entry.data.ttl().keyHash
+                                   : getKeyHash(LedgerEntryKey(entry));
+                (updates[getShardIndex(keyHash)].*member)
+                    .emplace_back(&entry, keyHash);
+                ++numChanges;
             }
-            else if (entry.data.type() == TTL)
+        };
+        partitionEntries(initEntries, &ShardUpdate::mInitEntries);
+        partitionEntries(liveEntries, &ShardUpdate::mLiveEntries);
+
+        for (auto const& key : deadEntries)
+        {
+            // No need to evict TTLs, they are stored with their associated
+            // entry
+            if (key.type() != CONTRACT_DATA && key.type() != CONTRACT_CODE)
             {
-                createTTL(entry);
+                continue;
             }
+
+            auto keyHash = getKeyHash(key);
+            updates[getShardIndex(keyHash)].mDeadEntries.emplace_back(&key,
+                                                                      keyHash);
+            ++numChanges;
         }
 
-        for (auto const& entry : liveEntries)
+        if (numChanges < PARALLEL_UPDATE_MIN_ENTRIES)
         {
-            if (entry.data.type() == CONTRACT_DATA)
-            {
-                updateContractData(entry);
-            }
-            else if (entry.data.type() == CONTRACT_CODE)
+            for (size_t i = 0; i < NUM_SHARDS; ++i)
             {
-                updateContractCode(entry, *sorobanConfig, ledgerVersion);
+                applyShardUpdate(mShards[i], updates[i], *sorobanConfig,
+                                 ledgerVersion);
             }
-            else if (entry.data.type() == TTL)
+        }
+        else
+        {
+            std::vector<std::future<void>> futures;
+            for (size_t i = 0; i < NUM_SHARDS; ++i)
             {
-                updateTTL(entry);
+                futures.emplace_back(std::async(
+                    std::launch::async, &InMemorySorobanState::applyShardUpdate,
+                    std::ref(mShards[i]), std::cref(updates[i]),
+                    std::cref(*sorobanConfig), ledgerVersion));
             }
-        }
 
-        for (auto const& key : deadEntries)
-        {
-            if (key.type() == CONTRACT_DATA)
+            // Wait for every shard before rethrowing any failure, so no worker
+            // outlives the updates it references.
+            for (auto& f : futures)
             {
-                deleteContractData(key);
+                f.wait();
             }
-            else if (key.type() == CONTRACT_CODE)
+            for (auto& f : futures)
             {
-                deleteContractCode(key);
+                f.get();
             }
-            // No need to evict TTLs, they are stored with their associated
-            // entry
         }
     }
 
@@ -553,42 +932,121 @@ InMemorySorobanState::updateState(std::vector<LedgerEntry> const& initEntries,
 
 void
 InMemorySorobanState::recomputeContractCodeSize(
-    SorobanNetworkConfig const& sorobanConfig, uint32_t ledgerVersion)
+    SorobanNetworkConfig const& sorobanConfig, uint32_t ledgerVersion,
+    uint32_t numThreads)
 {
-    for (auto& [_, entry] : mContractCodeEntries)
+    ZoneScoped;
+    // See contractCodeSizeForRent. The cost params are the same for every
+    // entry, so they're serialized once and shared by all the workers.
+    uint32_t ledgerVersionForSize =
+        std::max(ledgerVersion, static_cast<uint32_t>(ProtocolVersion::V_23));
+    auto const cpuCostParams = toCxxBuf(sorobanConfig.cpuCostParams());
+    auto const memCostParams = toCxxBuf(sorobanConfig.memCostParams());
+
+    std::atomic<size_t> nextShard{0};
+    auto worker = [&]() {
+        for (auto i = nextShard++; i < NUM_SHARDS; i = nextShard++)
+        {
+            auto& shard = mShards[i];
+            for (auto& [_, entry] : shard.mContractCodeEntries)
+            {
+                auto const& le = *entry.ledgerEntry;
+                uint32_t newSize = contractCodeEntrySizeForRent(
+                    le.data.contractCode(), xdr::xdr_size(le),
+                    ledgerVersionForSize, cpuCostParams, memCostParams);
+                shard.updateStateSizeOnEntryUpdate(entry.sizeBytes, newSize,
+                                                   /*isContractCode=*/true);
+                entry.sizeBytes = newSize;
+            }
+        }
+    };
+
+    auto const numWorkers =
+        std::min<size_t>(std::max<uint32_t>(numThreads, 1), NUM_SHARDS);
+    std::vector<std::future<void>> futures;
+    for (size_t i = 1; i < numWorkers; ++i)
     {
-        uint32_t newSize = contractCodeSizeForRent(
-            *entry.ledgerEntry, sorobanConfig, ledgerVersion);
-        updateStateSizeOnEntryUpdate(entry.sizeBytes, newSize,
-                                     /*isContractCode=*/true);
-        entry.sizeBytes = newSize;
+        futures.emplace_back(std::async(std::launch::async, worker));
+    }
+
+    // Wait for every shard before rethrowing any failure, so no worker
+    // outlives the params it references.
+    std::exception_ptr error;
+    try
+    {
+        worker();
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+        nextShard = NUM_SHARDS;
+    }
+    for (auto& f : futures)
+    {
+        f.wait();
+    }
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+    for (auto& f : futures)
+    {
+        f.get();
     }
 }
 
 uint64_t
 InMemorySorobanState::getSize() const
 {
-    releaseAssertOrThrow(mContractCodeStateSize >= 0);
-    releaseAssertOrThrow(mContractDataStateSize >= 0);
-    return static_cast<uint64_t>(mContractCodeStateSize +
-                                 mContractDataStateSize);
+    int64_t size = 0;
+    for (auto const& shard : mShards)
+    {
+        releaseAssertOrThrow(shard.mContractCodeStateSize >= 0);
+        releaseAssertOrThrow(shard.mContractDataStateSize >= 0);
+        size += shard.mContractCodeStateSize + shard.mContractDataStateSize;
+    }
+    return static_cast<uint64_t>(size);
 }
 
 void
 InMemorySorobanState::reportMetrics(SorobanMetrics& metrics) const
 {
-    metrics.mContractCodeStateSize.set_count(mContractCodeStateSize);
-    metrics.mContractDataStateSize.set_count(mContractDataStateSize);
-    metrics.mContractCodeEntryCount.set_count(mContractCodeEntries.size());
-    metrics.mContractDataEntryCount.set_count(mContractDataEntries.size());
+    int64_t contractCodeStateSize = 0;
+    int64_t contractDataStateSize = 0;
+    size_t overheadBytes = 0;
+    for (auto const& shard : mShards)
+    {
+        contractCodeStateSize += shard.mContractCodeStateSize;
+        contractDataStateSize += shard.mContractDataStateSize;
+
+        // Every stored LedgerEntry lives in its own make_shared block, next to
+        // a control block of two counters.
+        size_t numEntries = shard.mContractDataEntries.size() +
+                            shard.mContractCodeEntries.size();
+        overheadBytes += containerOverheadBytes(shard.mContractDataEntries) +
+                         containerOverheadBytes(shard.mContractCodeEntries) +
+                         containerOverheadBytes(shard.mPendingTTLs) +
+                         treeOverheadBytes(shard.mTTLIndex) +
+                         numEntries * (sizeof(LedgerEntry) + 16);
+    }
+    auto contractCodeEntries = getContractCodeEntryCount();
+    auto contractDataEntries = getContractDataEntryCount();
+
+    metrics.mContractCodeStateSize.set_count(contractCodeStateSize);
+    metrics.mContractDataStateSize.set_count(contractDataStateSize);
+    metrics.mContractCodeEntryCount.set_count(contractCodeEntries);
+    metrics.mContractDataEntryCount.set_count(contractDataEntries);
+    metrics.mInMemoryStateOverheadBytes.set_count(overheadBytes);
     TracyPlot("soroban.in-memory-state.contract-code-size",
-              static_cast<int64_t>(mContractCodeStateSize));
+              contractCodeStateSize);
     TracyPlot("soroban.in-memory-state.contract-data-size",
-              static_cast<int64_t>(mContractDataStateSize));
+              contractDataStateSize);
     TracyPlot("soroban.in-memory-state.contract-code-entries",
-              static_cast<int64_t>(mContractCodeEntries.size()));
+              static_cast<int64_t>(contractCodeEntries));
     TracyPlot("soroban.in-memory-state.contract-data-entries",
-              static_cast<int64_t>(mContractDataEntries.size()));
+              static_cast<int64_t>(contractDataEntries));
+    TracyPlot("soroban.in-memory-state.overhead-bytes",
+              static_cast<int64_t>(overheadBytes));
 }
 
 void
@@ -600,13 +1058,21 @@ InMemorySorobanState::manuallyAdvanceLedgerHeader(LedgerHeader const& lh)
 void
 InMemorySorobanState::checkUpdateInvariants() const
 {
-    // No TTLs should be orphaned after finishing an update
-    releaseAssertOrThrow(mPendingTTLs.empty());
+    // No TTLs should be orphaned after finishing an update, and every entry
+    // has its TTL by then, so the index covers all of them
+    for (auto const& shard : mShards)
+    {
+        releaseAssertOrThrow(shard.mPendingTTLs.empty());
+        releaseAssertOrThrow(!shard.mIndexTTLs ||
+                             shard.mTTLIndex.size() ==
+                                 shard.mContractDataEntries.size() +
+                                     shard.mContractCodeEntries.size());
+    }
 }
+
 void
-InMemorySorobanState::updateStateSizeOnEntryUpdate(uint32_t oldEntrySize,
-                                                   uint32_t newEntrySize,
-                                                   bool isContractCode)
+InMemorySorobanState::Shard::updateStateSizeOnEntryUpdate(
+    uint32_t oldEntrySize, uint32_t newEntrySize, bool isContractCode)
 {
     int64_t sizeDelta =
         static_cast<int64_t>(newEntrySize) - static_cast<int64_t>(oldEntrySize);
@@ -635,12 +1101,13 @@ InMemorySorobanState::updateStateSizeOnEntryUpdate(uint32_t oldEntrySize,
 void
 InMemorySorobanState::clearForTesting()
 {
-    mContractDataEntries.clear();
-    mContractCodeEntries.clear();
-    mPendingTTLs.clear();
+    for (auto& shard : mShards)
+    {
+        auto indexTTLs = shard.mIndexTTLs;
+        shard = Shard();
+        shard.mIndexTTLs = indexTTLs;
+    }
     mLastClosedLedgerSeq = 0;
-    mContractCodeStateSize = 0;
-    mContractDataStateSize = 0;
 }
 #endif
 }
@@ -4,11 +4,14 @@
 // under the Apache License, Version 2.0. See the COPYING file at the root
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
+#include <array>
 #include <cstddef>
 #include <memory>
 #include <optional>
+#include <set>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "bucket/BucketSnapshotManager.h"
 #include "ledger/LedgerHashUtils.h"
@@ -47,14 +50,20 @@ struct TTLData
 
 // ContractDataMapEntryT stores a ContractData LedgerEntry and its TTL. TTL is
 // stored directly with the data to avoid an additional lookup and save memory.
+// The serialized size of the entry is computed once when it is stored, so
+// updating or deleting it doesn't have to serialize the old entry again.
 struct ContractDataMapEntryT
 {
     std::shared_ptr<LedgerEntry const> const ledgerEntry;
     TTLData const ttlData;
+    uint32_t const sizeBytes;
 
     explicit ContractDataMapEntryT(
-        std::shared_ptr<LedgerEntry const>&& ledgerEntry, TTLData ttlData)
-        : ledgerEntry(std::move(ledgerEntry)), ttlData(ttlData)
+        std::shared_ptr<LedgerEntry const>&& ledgerEntry, TTLData ttlData,
+        uint32_t sizeBytes)
+        : ledgerEntry(std::move(ledgerEntry))
+        , ttlData(ttlData)
+        , sizeBytes(sizeBytes)
     {
     }
 };
@@ -81,21 +90,21 @@ struct ContractCodeMapEntryT
     }
 };
 
-// InternalContractDataMapEntry provides a memory-efficient map
-// implementation.
+// InternalContractDataMapEntry is a ContractData entry and its TTL, stored
+// inline in the node of an unordered_set.
 //
 // Soroban keys can be quite large (often dominating LedgerEntry size), so
 // storing them twice in a traditional key-value map would be wasteful. Instead,
 // we use std::unordered_set since LedgerEntry contains both key and value data.
 //
-// Since C++17's unordered_set doesn't support heterogeneous lookup (searching
-// with a different type than stored), we use polymorphism to enable key-only
-// lookups without constructing full entries. This will be simplified when we
-// upgrade to C++20.
-//
 // We index entries by their TTL key (SHA256 hash of the ContractData key)
 // rather than the full ContractData key. This lets us look up both ContractData
-// entries and their TTLs with one index.
+// entries and their TTLs with one index. The TTL key is stored with the entry,
+// so hashing and comparing entries never has to rehash the ContractData key.
+//
+// Since C++17's unordered_set doesn't support heterogeneous lookup (searching
+// with a different type than stored), lookups use a key-only entry. It holds
+// no LedgerEntry, so constructing one doesn't allocate.
 //
 // Logical map structure:
 //     TTLKey -> <std::shared_ptr<LedgerEntry>, liveUntilLedgerSeq>
@@ -103,155 +112,92 @@ struct ContractCodeMapEntryT
 class InternalContractDataMapEntry
 {
   private:
-    // Abstract base class for polymorphic entry handling.
-    // This allows QueryKey and ValueEntry to be used interchangeably in the
-    // set.
-    struct AbstractEntry
-    {
-        virtual ~AbstractEntry() = default;
-
-        // Returns the TTL key (SHA256 hash) that indexes this entry.
-        // For ContractData entries, this is getTTLKey(ledgerKey).ttl().keyHash
-        // For TTL queries, this is directly the keyHash from the TTL key
-        virtual uint256 copyKey() const = 0;
-
-        // Computes hash for unordered_set storage.
-        // Note: This returns size_t for STL compatibility, not the uint256 key
-        virtual size_t hash() const = 0;
-
-        // Returns the stored data. Only valid for ValueEntry instances.
-        virtual ContractDataMapEntryT const& get() const = 0;
-
-        // Equality comparison based on TTL keys
-        virtual bool
-        operator==(AbstractEntry const& other) const
-        {
-            return copyKey() == other.copyKey();
-        }
-    };
-
-    // ValueEntry stores actual ContractData entries in the map.
-    // Contains both the LedgerEntry and its TTL information.
-    struct ValueEntry : public AbstractEntry
-    {
-      private:
-        ContractDataMapEntryT entry;
-
-      public:
-        ValueEntry(std::shared_ptr<LedgerEntry const>&& ledgerEntry,
-                   TTLData ttlData)
-            : entry(std::move(ledgerEntry), ttlData)
-        {
-        }
-
-        uint256
-        copyKey() const override
-        {
-            auto ttlKey = getTTLKey(LedgerEntryKey(*entry.ledgerEntry));
-            return ttlKey.ttl().keyHash;
-        }
-
-        size_t
-        hash() const override
-        {
-            return std::hash<uint256>{}(copyKey());
-        }
-
-        ContractDataMapEntryT const&
-        get() const override
-        {
-            return entry;
-        }
-    };
-
-    // QueryKey is a lightweight key-only entry used for map lookups.
-    struct QueryKey : public AbstractEntry
-    {
-      private:
-        uint256 const ledgerKeyHash;
-
-      public:
-        explicit QueryKey(uint256 const& ledgerKeyHash)
-            : ledgerKeyHash(ledgerKeyHash)
-        {
-        }
-
-        uint256
-        copyKey() const override
-        {
-            return ledgerKeyHash;
-        }
-
-        size_t
-        hash() const override
-        {
-            return std::hash<uint256>{}(ledgerKeyHash);
-        }
-
-        // Should never be called - QueryKey is only for lookups
-        ContractDataMapEntryT const&
-        get() const override
-        {
-            throw std::runtime_error(
-                "QueryKey::get() called - this is a logic error");
-        }
-    };
-
-    std::unique_ptr<AbstractEntry> impl;
+    uint256 mKeyHash;
+    ContractDataMapEntryT mEntry;
 
   public:
-    // Creates a ValueEntry from a LedgerEntry (copies the entry)
+    // Creates an entry from a LedgerEntry (copies the entry). keyHash must be
+    // the TTL key hash of the entry and sizeBytes its serialized size.
     InternalContractDataMapEntry(LedgerEntry const& ledgerEntry,
-                                 TTLData ttlData)
-        : impl(std::make_unique<ValueEntry>(
-              std::make_shared<LedgerEntry const>(ledgerEntry), ttlData))
+                                 uint256 const& keyHash, TTLData ttlData,
+                                 uint32_t sizeBytes)
+        : mKeyHash(keyHash)
+        , mEntry(std::make_shared<LedgerEntry const>(ledgerEntry), ttlData,
+                 sizeBytes)
     {
     }
 
-    // Creates a ValueEntry from a shared_ptr (avoids copying)
+    // Creates an entry from a shared_ptr (avoids copying)
     InternalContractDataMapEntry(
-        std::shared_ptr<LedgerEntry const>&& ledgerEntry, TTLData ttlData)
-        : impl(std::make_unique<ValueEntry>(std::move(ledgerEntry), ttlData))
+        std::shared_ptr<LedgerEntry const>&& ledgerEntry,
+        uint256 const& keyHash, TTLData ttlData, uint32_t sizeBytes)
+        : mKeyHash(keyHash)
+        , mEntry(std::move(ledgerEntry), ttlData, sizeBytes)
+    {
+    }
+
+    // Creates a key-only entry for lookups directly from a TTL key hash.
+    explicit InternalContractDataMapEntry(uint256 const& ttlKeyHash)
+        : mKeyHash(ttlKeyHash), mEntry(nullptr, TTLData(), 0)
     {
     }
 
-    // Creates a QueryKey for lookups. Accepts both CONTRACT_DATA and TTL keys.
-    // For CONTRACT_DATA keys, converts to TTL key hash.
-    // For TTL keys, uses the hash directly.
+    // Creates a key-only entry for lookups. Accepts both CONTRACT_DATA and TTL
+    // keys. For CONTRACT_DATA keys, converts to TTL key hash. For TTL keys,
+    // uses the hash directly.
     explicit InternalContractDataMapEntry(LedgerKey const& ledgerKey)
+        : InternalContractDataMapEntry(toTTLKeyHash(ledgerKey))
     {
-        if (ledgerKey.type() == CONTRACT_DATA)
-        {
-            auto ttlKey = getTTLKey(ledgerKey);
-            impl = std::make_unique<QueryKey>(ttlKey.ttl().keyHash);
-        }
-        else if (ledgerKey.type() == TTL)
-        {
-            impl = std::make_unique<QueryKey>(ledgerKey.ttl().keyHash);
-        }
-        else
-        {
-            throw std::runtime_error(
-                "Invalid ledger key type for contract data map entry");
-        }
     }
 
     size_t
     hash() const
     {
-        return impl->hash();
+        return std::hash<uint256>{}(mKeyHash);
     }
 
     bool
     operator==(InternalContractDataMapEntry const& other) const
     {
-        return impl->operator==(*other.impl);
+        return mKeyHash == other.mKeyHash;
+    }
+
+    uint256 const&
+    getKeyHash() const
+    {
+        return mKeyHash;
     }
 
+    // Returns the stored data. Must not be called on a key-only entry.
     ContractDataMapEntryT const&
     get() const
     {
-        return impl->get();
+        if (!mEntry.ledgerEntry)
+        {
+            throw std::runtime_error(
+                "InternalContractDataMapEntry::get() called on a lookup key - "
+                "this is a logic error");
+        }
+        return mEntry;
+    }
+
+  private:
+    static uint256
+    toTTLKeyHash(LedgerKey const& ledgerKey)
+    {
+        if (ledgerKey.type() == CONTRACT_DATA)
+        {
+            return getTTLKey(ledgerKey).ttl().keyHash;
+        }
+        else if (ledgerKey.type() == TTL)
+        {
+            return ledgerKey.ttl().keyHash;
+        }
+        else
+        {
+            throw std::runtime_error(
+                "Invalid ledger key type for contract data map entry");
+        }
     }
 };
 
@@ -264,6 +210,10 @@ struct InternalContractDataEntryHash
     }
 };
 
+using InternalContractDataSet =
+    std::unordered_set<InternalContractDataMapEntry,
+                       InternalContractDataEntryHash>;
+
 // InMemorySorobanState provides an efficient in-memory map for Soroban contract
 // state.
 //
@@ -278,104 +228,191 @@ struct InternalContractDataEntryHash
 //   stored with the ContractData/ContractCode entry
 // - During initialization, TTLs may arrive before their corresponding data
 //   entries, so mPendingTTLs temporarily holds these orphaned TTLs
+// - Entries are split into NUM_SHARDS independent shards by their TTL key
+//   hash. An entry, its TTL and any pending TTL for it always live in the same
+//   shard, so shards can be updated independently of each other.
+// - Optionally, each shard also keeps its entries ordered by TTL, so that the
+//   expired ones can be found without scanning the whole state. The
+//   BucketList eviction scan still decides what gets evicted, as the protocol
+//   requires, and the index is only used to check its results.
 //
-// This class is NOT thread-safe by default. While multiple threads may call
-// const methods concurrently, there is no synchronization or locks. It is the
-// caller's responsibility to ensure that no thread is reading state when any
-// non-const function is called.
+// Concurrency: const methods never take locks and may be called concurrently
+// from any number of threads, e.g. the parallel Soroban apply threads, which
+// read contract data, code and TTLs directly from this state. The state is
+// only modified between ledger applies (via updateState and friends), and it
+// is the caller's responsibility to ensure that no thread is reading state
+// when any non-const function is called.
 class InMemorySorobanState : public NonMovableOrCopyable
 {
-#ifdef BUILD_TESTS
   public:
+    // Must be a power of two.
+    static constexpr size_t NUM_SHARDS = 16;
+
+    // updateState only updates shards in parallel when a ledger changes at
+    // least this many entries, below that the cost of spawning the workers
+    // dominates.
+    static constexpr size_t PARALLEL_UPDATE_MIN_ENTRIES = 1024;
+
+#ifndef BUILD_TESTS
+  private:
 #endif
 
-    // Primary storage for ContractData entries with embedded TTL information.
-    // Uses unordered_set with custom entries to save memory vs traditional map.
-    std::unordered_set<InternalContractDataMapEntry,
-                       InternalContractDataEntryHash>
-        mContractDataEntries;
+    struct Shard
+    {
+        // Primary storage for ContractData entries with embedded TTL
+        // information. Uses unordered_set with custom entries to save memory
+        // vs traditional map.
+        InternalContractDataSet mContractDataEntries;
+
+        // Storage for ContractCode entries. Maps from TTL key hash to entry,
+        // ttl struct. Unlike ContractData, we use a map here because the key
+        // size is dominated by LedgerEntry size, so there's no real need for
+        // extra complexity.
+        std::unordered_map<uint256, ContractCodeMapEntryT> mContractCodeEntries;
+
+        // Temporary storage for orphaned TTLs that arrive before their
+        // corresponding data entries during initialization, keyed by TTL key
+        // hash. After initialization, this should be empty.
+        std::unordered_map<uint256, TTLData> mPendingTTLs;
+
+        // Size of the entries stored in this shard in bytes as defined by the
+        // protocol. Note, that these are int64 and not uint64 even though we
+        // store this in ledger as uint64 - neither of the type limits is
+        // realistically reachable, but signed int makes math simpler and
+        // safer.
+        int64_t mContractCodeStateSize = 0;
+        int64_t mContractDataStateSize = 0;
+
+        // If set, mTTLIndex holds the TTL key hash of every ContractData and
+        // ContractCode entry of this shard that has a TTL, ordered by
+        // liveUntilLedgerSeq and then by key hash.
+        bool mIndexTTLs = false;
+        std::set<std::pair<uint32_t, uint256>> mTTLIndex;
+
+        // Moves keyHash in mTTLIndex from oldTtlData to newTtlData. Default
+        // TTLs are not indexed.
+        void reindexTTL(uint256 const& keyHash, TTLData oldTtlData,
+                        TTLData newTtlData);
+
+        // Returns the ContractData or ContractCode entry for the given key
+        // hash, or nullptr if neither exists.
+        std::shared_ptr<LedgerEntry const>
+        findEntry(uint256 const& keyHash) const;
+
+        void updateStateSizeOnEntryUpdate(uint32_t oldEntrySize,
+                                          uint32_t newEntrySize,
+                                          bool isContractCode);
+
+        // Helper to update an existing ContractData entry's TTL without
+        // changing data
+        void updateContractDataTTL(InternalContractDataSet::iterator dataIt,
+                                   TTLData newTtlData);
+
+        // Removes and returns the pending TTL for the given key hash, or a
+        // default TTLData if there is none.
+        TTLData takePendingTTL(uint256 const& keyHash);
+
+        // Returns the TTL of the ContractData or ContractCode entry for the
+        // given key hash, or nullopt if neither exists.
+        std::optional<TTLData> findTTL(uint256 const& keyHash) const;
+
+        // Returns true if a non-default TTL, pending or not, exists for the
+        // given key hash.
+        bool hasTTL(uint256 const& keyHash) const;
+
+        // Creates new TTL entry. Throws if a non-zero TTL value at the key
+        // already exists. LedgerEntry must be of type TTL.
+        void createTTL(LedgerEntry const& ttlEntry);
+
+        // Update the TTL of an existing ContractData or ContractCode entry.
+        // Throws if the key does not exist. LedgerEntry must be of type TTL.
+        // We don't know if a TTL maps to a ContractData or ContractCode entry,
+        // so we will check both mContractDataEntries and mContractCodeEntries.
+        void updateTTL(LedgerEntry const& ttlEntry);
+
+        // Creates new ContractData entry. Throws if key already exists.
+        void createContractDataEntry(LedgerEntry const& ledgerEntry,
+                                     uint256 const& keyHash);
+
+        // Updates an existing ContractData entry. Throws if the key does
+        // not exist. LedgerEntry must be of type CONTRACT_DATA.
+        void updateContractData(LedgerEntry const& ledgerEntry,
+                                uint256 const& keyHash);
+
+        // Note: since we store TTLs with there associated entry, there is no
+        // explicit evictTTL function.
+
+        // Evicts a ContractData entry from the map.
+        void deleteContractData(uint256 const& keyHash);
+
+        // Creates new ContractCode entry. Throws if key already exists.
+        void createContractCodeEntry(LedgerEntry const& ledgerEntry,
+                                     uint256 const& keyHash,
+                                     SorobanNetworkConfig const& sorobanConfig,
+                                     uint32_t ledgerVersion);
 
-    // Storage for ContractCode entries. Maps from TTL key hash to entry, ttl
-    // struct. Unlike ContractData, we use a map here because the key size is
-    // dominated by LedgerEntry size, so there's no real need for extra
-    // complexity.
-    std::unordered_map<uint256, ContractCodeMapEntryT> mContractCodeEntries;
+        // Updates an existing ContractCode entry. Throws if the key does
+        // not exist. LedgerEntry must be of type CONTRACT_CODE.
+        void updateContractCode(LedgerEntry const& ledgerEntry,
+                                uint256 const& keyHash,
+                                SorobanNetworkConfig const& sorobanConfig,
+                                uint32_t ledgerVersion);
 
-    // Temporary storage for orphaned TTLs that arrive before their
-    // corresponding data entries during initialization. After initialization,
-    // this should be empty.
-    std::unordered_map<LedgerKey, LedgerEntry> mPendingTTLs;
+        // Evicts a ContractCode entry from the map.
+        void deleteContractCode(uint256 const& keyHash);
+    };
+
+    // Pending changes to a single shard from one ledger close, in the same
+    // relative order as they were passed to updateState.
+    struct ShardUpdate
+    {
+        using EntryChanges =
+            std::vector<std::pair<LedgerEntry const*, uint256>>;
+        EntryChanges mInitEntries;
+        EntryChanges mLiveEntries;
+        std::vector<std::pair<LedgerKey const*, uint256>> mDeadEntries;
+    };
+
+    std::array<Shard, NUM_SHARDS> mShards;
 
     // ledgerSeq which the InMemorySorobanState currently "snapshots".
     uint32_t mLastClosedLedgerSeq = 0;
 
-    // Total size of the in-memory state in bytes as defined by the protocol (
-    // including using the in-memory module size for the ContractCode entries).
-    // Note, that these are int64 and not uint64 even though we store this in
-    // ledger as uint64 - neither of the type limits is realistically
-    // reachable, but signed int makes math simpler and safer.
-    int64_t mContractCodeStateSize = 0;
-    int64_t mContractDataStateSize = 0;
-
-    // Helper to update an existing ContractData entry's TTL without changing
-    // data
-    void updateContractDataTTL(
-        std::unordered_set<InternalContractDataMapEntry,
-                           InternalContractDataEntryHash>::iterator dataIt,
-        TTLData newTtlData);
+    // Returns the TTL key hash that indexes the given key. LedgerKey must be
+    // of type CONTRACT_DATA, CONTRACT_CODE or TTL.
+    static uint256 getKeyHash(LedgerKey const& ledgerKey);
+
+    static size_t getShardIndex(uint256 const& keyHash);
+    Shard& getShard(uint256 const& keyHash);
+    Shard const& getShard(uint256 const& keyHash) const;
+
+    static void applyShardUpdate(Shard& shard, ShardUpdate const& update,
+                                 SorobanNetworkConfig const& sorobanConfig,
+                                 uint32_t ledgerVersion);
+
+    // Adds an entry read from the BucketList during initialization to the
+    // shard of keyHash, unless a newer version of its key was already loaded
+    // or deleted. Buckets must be loaded newest first. deletedKeys holds the
+    // keys of the DEADENTRYs loaded into the shard so far.
+    static void loadBucketEntry(Shard& shard, BucketEntry const& be,
+                                uint256 const& keyHash,
+                                std::unordered_set<LedgerKey>& deletedKeys,
+                                SorobanNetworkConfig const& sorobanConfig,
+                                uint32_t ledgerVersion);
 
     // Should be called after initialization/updates finish to check consistency
     // invariants.
     void checkUpdateInvariants() const;
 
-    void updateStateSizeOnEntryUpdate(uint32_t oldEntrySize,
-                                      uint32_t newEntrySize,
-                                      bool isContractCode);
-
     // Returns the TTL entry for the given key, or nullptr if not found.
     // LedgerKey must be of type TTL.
     std::shared_ptr<LedgerEntry const> getTTL(LedgerKey const& ledgerKey) const;
 
-    // Creates new TTL entry. Throws if a non-zero TTL value at the key already
-    // exists. LedgerEntry must be of type TTL.
-    void createTTL(LedgerEntry const& ttlEntry);
-
-    // Creates new ContractData entry. Throws if key already exists.
-    void createContractDataEntry(LedgerEntry const& ledgerEntry);
-
-    // Update the TTL of an existing ContractData or ContractCode entry. Throws
-    // if the key does not exist. LedgerEntry must be of type TTL. We don't know
-    // if a TTL maps to a ContractData or ContractCode entry, so we will check
-    // both mContractDataEntries and mContractCodeEntries.
-    void updateTTL(LedgerEntry const& ttlEntry);
-
-    // Updates an existing ContractData entry. Throws if the key does
-    // not exist. LedgerEntry must be of type CONTRACT_DATA.
-    void updateContractData(LedgerEntry const& ledgerEntry);
-
-    // Note: since we store TTLs with there associated entry, there is no
-    // explicit evictTTL function.
-
-    // Evicts a ContractData entry from the map. LedgerKey must be of type
-    // CONTRACT_DATA.
-    void deleteContractData(LedgerKey const& ledgerKey);
-
-    // Creates new ContractCode entry. Throws if key already exists.
-    void createContractCodeEntry(LedgerEntry const& ledgerEntry,
-                                 SorobanNetworkConfig const& sorobanConfig,
-                                 uint32_t ledgerVersion);
-
-    // Updates an existing ContractCode entry. Throws if the key does
-    // not exist. LedgerEntry must be of type CONTRACT_CODE.
-    void updateContractCode(LedgerEntry const& ledgerEntry,
-                            SorobanNetworkConfig const& sorobanConfig,
-                            uint32_t ledgerVersion);
-
-    // Evicts a ContractCode entry from the map. LedgerKey must be of type
-    // CONTRACT_CODE.
-    void deleteContractCode(LedgerKey const& ledgerKey);
-
   public:
+    // With indexTTLs, entries are also indexed by liveUntilLedgerSeq, which
+    // getExpiredEntries and checkEvictedEntries need.
+    explicit InMemorySorobanState(bool indexTTLs = false);
+
     // These following functions are read-only and may be called concurrently so
     // long as no updates are occurring.
     static bool isInMemoryType(LedgerKey const& ledgerKey);
@@ -388,6 +425,9 @@ class InMemorySorobanState : public NonMovableOrCopyable
 
     uint32_t getLedgerSeq() const;
 
+    size_t getContractDataEntryCount() const;
+    size_t getContractCodeEntryCount() const;
+
     // Returns the total size of the in-memory Soroban state to be used for the
     // rent fee computation purposes.
     // Note, that this size depends on in-memory cost for ContractCode entries.
@@ -401,17 +441,46 @@ class InMemorySorobanState : public NonMovableOrCopyable
     // Returns the entry for the given key, or nullptr if not found.
     std::shared_ptr<LedgerEntry const> get(LedgerKey const& ledgerKey) const;
 
+    // Returns the size for rent computed when the ContractCode entry for the
+    // given key was stored, or nullopt if not found. LedgerKey must be of type
+    // CONTRACT_CODE.
+    std::optional<uint32_t>
+    getContractCodeSizeForRent(LedgerKey const& ledgerKey) const;
+
+    bool hasTTLIndex() const;
+
+    // Returns up to limit ContractData and ContractCode entries that are
+    // expired at ledgerSeq, i.e. whose liveUntilLedgerSeq is below it, in
+    // order of liveUntilLedgerSeq and then of TTL key hash. Takes
+    // O(limit * log(entries)). Throws if there is no TTL index.
+    std::vector<std::shared_ptr<LedgerEntry const>>
+    getExpiredEntries(uint32_t ledgerSeq, size_t limit) const;
+
+    // Throws unless every given key is a stored ContractData or ContractCode
+    // entry that the TTL index has as expired at ledgerSeq. Used to check the
+    // entries the BucketList eviction scan picked for ledgerSeq, before they
+    // are removed from this state.
+    void checkEvictedEntries(std::vector<LedgerKey> const& keys,
+                             uint32_t ledgerSeq) const;
+
     // The following functions are not read-only and must never be called
     // concurrently. It is the caller's responsibility to ensure that no thread
     // is reading state when these functions are called.
 
-    // Initialize the map from a bucket list snapshot
+    // Initialize the map from a bucket list snapshot. With numThreads > 1,
+    // bucket levels are scanned in parallel and then merged into the shards
+    // in parallel, newest level first, giving the same state as a serial
+    // load.
     void initializeStateFromSnapshot(SearchableSnapshotConstPtr snap,
                                      SorobanNetworkConfig const* sorobanConfig,
-                                     uint32_t ledgerVersion);
+                                     uint32_t ledgerVersion,
+                                     uint32_t numThreads = 1);
 
     // Update the map with entries from a ledger close. ledgerSeq must be
-    // exactly mLastClosedLedgerSeq + 1.
+    // exactly mLastClosedLedgerSeq + 1. Within each shard, init entries are
+    // applied first, then live entries, then dead entries, each in the order
+    // given. Since an entry never affects another shard, the result is the
+    // same whether or not shards are updated in parallel.
     void updateState(std::vector<LedgerEntry> const& initEntries,
                      std::vector<LedgerEntry> const& liveEntries,
                      std::vector<LedgerKey> const& deadEntries,
@@ -422,12 +491,14 @@ class InMemorySorobanState : public NonMovableOrCopyable
     void manuallyAdvanceLedgerHeader(LedgerHeader const& lh);
 
     // Recomputes the size of all the stored ContractCode entries and updates
-    // the state size accordingly.
+    // the state size accordingly. With numThreads > 1, shards are recomputed
+    // in parallel.
     // Note, that while this should be *reasonably* fast to be done every once
     // in a while during the protocol upgrades, we shouldn't call this 'just in
     // case' in order to avoid unnecessary performance overhead.
     void recomputeContractCodeSize(SorobanNetworkConfig const& sorobanConfig,
-                                   uint32_t ledgerVersion);
+                                   uint32_t ledgerVersion,
+                                   uint32_t numThreads = 1);
 
 #ifdef BUILD_TESTS
     void clearForTesting();
@@ -0,0 +1,405 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "ledger/IndexedLedgerCloseMeta.h"
+#include "ledger/MetaStreamWriter.h"
+#include "util/GlobalChecks.h"
+#include "xdrpp/marshal.h"
+#include <Tracy.hpp>
+#include <fmt/format.h>
+
+#include <map>
+#include <stdexcept>
+#include <tuple>
+
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace stellar
+{
+namespace IndexedLedgerCloseMeta
+{
+
+namespace
+{
+size_t constexpr HEADER_SIZE = 5 * 4;
+size_t constexpr DIRECTORY_ENTRY_SIZE = 6 * 4 + 32;
+
+// Changes are grouped by entry type, then contract
+using GroupKey = std::tuple<int32_t, bool, Hash>;
+using Groups = std::map<GroupKey, std::vector<LedgerEntryChange const*>>;
+
+size_t
+padded(size_t size)
+{
+    return (size + 3) & ~size_t(3);
+}
+
+GroupKey
+groupOf(LedgerEntryChange const& change)
+{
+    SCAddress const* contract = nullptr;
+    LedgerEntryType type;
+    if (change.type() == LEDGER_ENTRY_REMOVED)
+    {
+        auto const& key = change.removed();
+        type = key.type();
+        if (type == CONTRACT_DATA)
+        {
+            contract = &key.contractData().contract;
+        }
+    }
+    else
+    {
+        LedgerEntry const* entry = nullptr;
+        switch (change.type())
+        {
+        case LEDGER_ENTRY_CREATED:
+            entry = &change.created();
+            break;
+        case LEDGER_ENTRY_UPDATED:
+            entry = &change.updated();
+            break;
+        case LEDGER_ENTRY_STATE:
+            entry = &change.state();
+            break;
+        case LEDGER_ENTRY_RESTORED:
+            entry = &change.restored();
+            break;
+        default:
+            releaseAssert(false);
+        }
+        type = entry->data.type();
+        if (type == CONTRACT_DATA)
+        {
+            contract = &entry->data.contractData().contract;
+        }
+    }
+
+    if (contract && contract->type() == SC_ADDRESS_TYPE_CONTRACT)
+    {
+        return {type, true, contract->contractId()};
+    }
+    return {type, false, Hash{}};
+}
+
+void
+addChanges(Groups& groups, LedgerEntryChanges const& changes)
+{
+    for (auto const& change : changes)
+    {
+        groups[groupOf(change)].emplace_back(&change);
+    }
+}
+
+template <typename OpMetaT>
+void
+addOperations(Groups& groups, xdr::xvector<OpMetaT> const& operations)
+{
+    for (auto const& op : operations)
+    {
+        addChanges(groups, op.changes);
+    }
+}
+
+void
+addTxMeta(Groups& groups, TransactionMeta const& m)
+{
+    switch (m.v())
+    {
+    case 0:
+        addOperations(groups, m.operations());
+        break;
+    case 1:
+        addChanges(groups, m.v1().txChanges);
+        addOperations(groups, m.v1().operations);
+        break;
+    case 2:
+        addChanges(groups, m.v2().txChangesBefore);
+        addOperations(groups, m.v2().operations);
+        addChanges(groups, m.v2().txChangesAfter);
+        break;
+    case 3:
+        addChanges(groups, m.v3().txChangesBefore);
+        addOperations(groups, m.v3().operations);
+        addChanges(groups, m.v3().txChangesAfter);
+        break;
+    case 4:
+        addChanges(groups, m.v4().txChangesBefore);
+        addOperations(groups, m.v4().operations);
+        addChanges(groups, m.v4().txChangesAfter);
+        break;
+    default:
+        releaseAssert(false);
+    }
+}
+
+template <typename MetaT>
+void
+addLedger(Groups& groups, MetaT const& m)
+{
+    for (auto const& tx : m.txProcessing)
+    {
+        addChanges(groups, tx.feeProcessing);
+        addTxMeta(groups, tx.txApplyProcessing);
+        if constexpr (std::is_same_v<std::decay_t<decltype(tx)>,
+                                     TransactionResultMetaV1>)
+        {
+            addChanges(groups, tx.postTxApplyFeeProcessing);
+        }
+    }
+    for (auto const& upgrade : m.upgradesProcessing)
+    {
+        addChanges(groups, upgrade.changes);
+    }
+}
+
+Groups
+groupChanges(LedgerCloseMeta const& meta)
+{
+    Groups groups;
+    switch (meta.v())
+    {
+    case 0:
+        addLedger(groups, meta.v0());
+        break;
+    case 1:
+        addLedger(groups, meta.v1());
+        break;
+    case 2:
+        addLedger(groups, meta.v2());
+        break;
+    default:
+        releaseAssert(false);
+    }
+    return groups;
+}
+
+uint32_t
+ledgerSeqOf(LedgerCloseMeta const& meta)
+{
+    switch (meta.v())
+    {
+    case 0:
+        return meta.v0().ledgerHeader.header.ledgerSeq;
+    case 1:
+        return meta.v1().ledgerHeader.header.ledgerSeq;
+    case 2:
+        return meta.v2().ledgerHeader.header.ledgerSeq;
+    default:
+        releaseAssert(false);
+    }
+    return 0;
+}
+
+// Serializes the changes as a LedgerEntryChanges
+std::vector<char>
+serializeChanges(std::vector<LedgerEntryChange const*> const& changes)
+{
+    size_t size = 4;
+    for (auto c : changes)
+    {
+        size += xdr::xdr_size(*c);
+    }
+    std::vector<char> res(size);
+    xdr::xdr_put p(res.data(), res.data() + size);
+    xdr::xdr_argpack_archive(p, static_cast<uint32_t>(changes.size()));
+    for (auto c : changes)
+    {
+        xdr::xdr_argpack_archive(p, *c);
+    }
+    return res;
+}
+
+std::vector<char>
+compress(char const* data, size_t size)
+{
+    ZoneScoped;
+#ifdef USE_ZLIB
+    auto len = compressBound(static_cast<uLong>(size));
+    std::vector<char> res(len);
+    // Sections are compressed on ledger close, favor speed
+    auto err = compress2(reinterpret_cast<Bytef*>(res.data()), &len,
+                         reinterpret_cast<Bytef const*>(data),
+                         static_cast<uLong>(size), Z_BEST_SPEED);
+    if (err != Z_OK)
+    {
+        throw std::runtime_error(
+            fmt::format(FMT_STRING("Failed to compress meta: {}"), err));
+    }
+    res.resize(len);
+    return res;
+#else
+    throw std::runtime_error("Meta compression requires zlib");
+#endif
+}
+
+std::vector<char>
+decompress(char const* data, size_t size, size_t rawSize)
+{
+    ZoneScoped;
+#ifdef USE_ZLIB
+    std::vector<char> res(rawSize);
+    auto len = static_cast<uLongf>(rawSize);
+    auto err = uncompress(reinterpret_cast<Bytef*>(res.data()), &len,
+                          reinterpret_cast<Bytef const*>(data),
+                          static_cast<uLong>(size));
+    if (err != Z_OK || len != rawSize)
+    {
+        throw std::runtime_error("Malformed compressed meta section");
+    }
+    return res;
+#else
+    throw std::runtime_error("Meta compression requires zlib");
+#endif
+}
+
+uint32_t
+checkedSize(size_t size)
+{
+    releaseAssertOrThrow(size < 0x80000000);
+    return static_cast<uint32_t>(size);
+}
+}
+
+bool
+supportsCompression()
+{
+#ifdef USE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+size_t
+serialize(LedgerCloseMeta const& meta, Compression compression,
+          std::vector<char>& buf, size_t offset)
+{
+    ZoneScoped;
+    releaseAssert(offset % 4 == 0);
+    auto groups = groupChanges(meta);
+    std::vector<Section> sections(1 + groups.size());
+    auto dataOffset =
+        offset + HEADER_SIZE + sections.size() * DIRECTORY_ENTRY_SIZE;
+
+    // The meta itself is serialized in place, unless it is compressed
+    auto& metaSection = sections.front();
+    metaSection.kind = SectionKind::LEDGER_CLOSE_META;
+    if (compression == Compression::NONE)
+    {
+        auto size = serializeLedgerCloseMeta(meta, buf, dataOffset);
+        metaSection.size = metaSection.rawSize = checkedSize(size);
+    }
+    else
+    {
+        std::vector<char> raw;
+        auto size = serializeLedgerCloseMeta(meta, raw, 0);
+        auto stored = compress(raw.data(), size);
+        metaSection.rawSize = checkedSize(size);
+        metaSection.size = checkedSize(stored.size());
+        buf.resize(dataOffset);
+        buf.insert(buf.end(), stored.begin(), stored.end());
+    }
+    buf.resize(dataOffset + padded(metaSection.size));
+
+    size_t i = 1;
+    for (auto const& [key, changes] : groups)
+    {
+        auto& section = sections[i++];
+        section.kind = SectionKind::LEDGER_ENTRY_CHANGES;
+        section.entryType = static_cast<LedgerEntryType>(std::get<0>(key));
+        if (std::get<1>(key))
+        {
+            section.contractID = std::get<2>(key);
+        }
+        section.offset = checkedSize(buf.size() - dataOffset);
+
+        auto raw = serializeChanges(changes);
+        section.rawSize = checkedSize(raw.size());
+        if (compression != Compression::NONE)
+        {
+            raw = compress(raw.data(), raw.size());
+        }
+        section.size = checkedSize(raw.size());
+        buf.insert(buf.end(), raw.begin(), raw.end());
+        buf.resize(buf.size() + padded(raw.size()) - raw.size());
+    }
+
+    xdr::xdr_put p(buf.data() + offset, buf.data() + dataOffset);
+    xdr::xdr_argpack_archive(p, MAGIC, VERSION, ledgerSeqOf(meta),
+                             static_cast<uint32_t>(compression),
+                             static_cast<uint32_t>(sections.size()));
+    for (auto const& s : sections)
+    {
+        xdr::xdr_argpack_archive(
+            p, static_cast<uint32_t>(s.kind),
+            static_cast<int32_t>(s.entryType),
+            static_cast<uint32_t>(s.contractID.has_value()),
+            s.contractID.value_or(Hash{}), s.offset, s.size, s.rawSize);
+    }
+    return checkedSize(buf.size() - offset);
+}
+
+Directory
+readDirectory(char const* data, size_t size)
+{
+    ZoneScoped;
+    xdr::xdr_get g(data, data + size);
+    uint32_t magic, version, compression, numSections;
+    Directory dir;
+    xdr::xdr_argpack_archive(g, magic, version, dir.ledgerSeq, compression,
+                             numSections);
+    if (magic != MAGIC || version != VERSION ||
+        compression > static_cast<uint32_t>(Compression::ZLIB))
+    {
+        throw std::runtime_error("Not an indexed LedgerCloseMeta record");
+    }
+    dir.compression = static_cast<Compression>(compression);
+    if (numSections > (size - HEADER_SIZE) / DIRECTORY_ENTRY_SIZE)
+    {
+        throw std::runtime_error("Truncated indexed LedgerCloseMeta record");
+    }
+    dir.dataOffset = HEADER_SIZE + numSections * DIRECTORY_ENTRY_SIZE;
+
+    for (uint32_t i = 0; i < numSections; ++i)
+    {
+        auto& s = dir.sections.emplace_back();
+        uint32_t kind, hasContract;
+        int32_t entryType;
+        Hash contractID;
+        xdr::xdr_argpack_archive(g, kind, entryType, hasContract, contractID,
+                                 s.offset, s.size, s.rawSize);
+        if (kind > static_cast<uint32_t>(SectionKind::LEDGER_ENTRY_CHANGES) ||
+            dir.dataOffset + s.offset + s.size > size)
+        {
+            throw std::runtime_error(
+                "Malformed indexed LedgerCloseMeta directory");
+        }
+        s.kind = static_cast<SectionKind>(kind);
+        s.entryType = static_cast<LedgerEntryType>(entryType);
+        if (hasContract)
+        {
+            s.contractID = contractID;
+        }
+    }
+    return dir;
+}
+
+std::vector<char>
+readSection(char const* data, size_t size, Directory const& dir,
+            Section const& section)
+{
+    auto begin = data + dir.dataOffset + section.offset;
+    releaseAssertOrThrow(dir.dataOffset + section.offset + section.size <=
+                         size);
+    if (dir.compression == Compression::NONE)
+    {
+        return std::vector<char>(begin, begin + section.size);
+    }
+    return decompress(begin, section.size, section.rawSize);
+}
+}
+}
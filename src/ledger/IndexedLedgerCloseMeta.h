@@ -0,0 +1,99 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "xdr/Stellar-ledger.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace stellar
+{
+
+// Indexed meta stream format, written to METADATA_OUTPUT_STREAM when
+// METADATA_OUTPUT_STREAM_INDEXED is set. Each ledger is one record, framed
+// with an XDR record mark like the plain stream, holding a directory of
+// sections followed by the sections themselves:
+//
+//   uint32 magic ("LCMI")
+//   uint32 version (1)
+//   uint32 ledgerSeq
+//   uint32 compression (0 none, 1 zlib)
+//   uint32 numSections
+//   numSections directory entries of
+//     uint32 kind (0 LedgerCloseMeta, 1 LedgerEntryChanges)
+//     int32 entryType (LedgerEntryType of the changes)
+//     uint32 hasContract
+//     opaque contractID[32] (contract of CONTRACT_DATA changes, if any)
+//     uint32 offset (from the end of the directory)
+//     uint32 size (as stored)
+//     uint32 rawSize (decompressed)
+//   the sections, each padded to a multiple of 4 bytes
+//
+// All integers are big-endian, so the header and directory can be read as
+// XDR. The first section is always the complete LedgerCloseMeta. It is
+// followed by one LedgerEntryChanges section per entry type, split by
+// contract for CONTRACT_DATA. These sections hold every change to entries of
+// that type (and contract) anywhere in the meta, in the order they appear in
+// it. A consumer that only cares about some entry types or contracts reads
+// the directory and then reads and decodes only the matching sections.
+// Sections are compressed one by one, so a section can be decompressed
+// without the others.
+namespace IndexedLedgerCloseMeta
+{
+uint32_t constexpr MAGIC = 0x4c434d49;
+uint32_t constexpr VERSION = 1;
+
+enum class SectionKind : uint32_t
+{
+    LEDGER_CLOSE_META = 0,
+    LEDGER_ENTRY_CHANGES = 1
+};
+
+enum class Compression : uint32_t
+{
+    NONE = 0,
+    ZLIB = 1
+};
+
+struct Section
+{
+    SectionKind kind{SectionKind::LEDGER_CLOSE_META};
+    LedgerEntryType entryType{ACCOUNT};
+    std::optional<Hash> contractID;
+    uint32_t offset{0};
+    uint32_t size{0};
+    uint32_t rawSize{0};
+};
+
+struct Directory
+{
+    uint32_t ledgerSeq{0};
+    Compression compression{Compression::NONE};
+    std::vector<Section> sections;
+    // Size of the header and directory, where the sections start
+    size_t dataOffset{0};
+};
+
+// True if this build can write and read compressed sections
+bool supportsCompression();
+
+// Serializes meta into buf, starting at offset (which must be a multiple of
+// 4), resizing buf to fit, and returns the size of the record.
+size_t serialize(LedgerCloseMeta const& meta, Compression compression,
+                 std::vector<char>& buf, size_t offset);
+
+// Reads the header and directory of the record in [data, data + size),
+// without its record mark. Throws std::runtime_error if it's malformed.
+Directory readDirectory(char const* data, size_t size);
+
+// Returns the decompressed XDR of a section of the record read by
+// readDirectory
+std::vector<char> readSection(char const* data, size_t size,
+                              Directory const& dir, Section const& section);
+}
+}
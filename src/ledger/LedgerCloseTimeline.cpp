@@ -0,0 +1,155 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "ledger/LedgerCloseTimeline.h"
+#include "util/GlobalChecks.h"
+#include <algorithm>
+#include <json/json.h>
+
+namespace stellar
+{
+
+namespace
+{
+Json::Int64
+toMicros(LedgerCloseTimeline::Clock::duration d)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+}
+
+LedgerCloseTimeline::LedgerCloseTimeline(size_t maxLedgers)
+    : mMaxLedgers(maxLedgers)
+{
+    releaseAssert(mMaxLedgers > 0);
+}
+
+LedgerCloseTimeline::Span::Span(LedgerCloseTimeline& timeline,
+                                std::string name)
+    : mTimeline(timeline), mName(std::move(name)), mStart(Clock::now())
+{
+}
+
+LedgerCloseTimeline::Span::~Span()
+{
+    mTimeline.record(std::move(mName), mStart, Clock::now());
+}
+
+void
+LedgerCloseTimeline::startLedger(uint32_t ledgerSeq)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mCurrent.emplace();
+    mCurrent->mLedgerSeq = ledgerSeq;
+    mCurrent->mStart = Clock::now();
+    mCurrent->mThreads.emplace_back(std::this_thread::get_id());
+}
+
+void
+LedgerCloseTimeline::finishLedger()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mCurrent)
+    {
+        return;
+    }
+    mCurrent->mDuration = Clock::now() - mCurrent->mStart;
+    mFinished.emplace_back(std::move(*mCurrent));
+    mCurrent.reset();
+    while (mFinished.size() > mMaxLedgers)
+    {
+        mFinished.pop_front();
+    }
+}
+
+void
+LedgerCloseTimeline::record(std::string&& name, Clock::time_point start,
+                            Clock::time_point end)
+{
+    auto id = std::this_thread::get_id();
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mCurrent)
+    {
+        return;
+    }
+
+    // Threads are numbered in the order they first record a span in this
+    // ledger, after the thread that started it, which is always 0
+    auto& threads = mCurrent->mThreads;
+    auto it = std::find(threads.begin(), threads.end(), id);
+    auto thread = static_cast<size_t>(it - threads.begin());
+    if (it == threads.end())
+    {
+        threads.emplace_back(id);
+    }
+    mCurrent->mSpans.push_back({std::move(name), thread, start, end - start});
+}
+
+std::vector<LedgerCloseTimeline::Ledger>
+LedgerCloseTimeline::getLast(size_t count) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    count = std::min(count, mFinished.size());
+    return {mFinished.end() - count, mFinished.end()};
+}
+
+Json::Value
+LedgerCloseTimeline::getJson(size_t count) const
+{
+    Json::Value res;
+    res["ledgers"] = Json::arrayValue;
+    for (auto const& ledger : getLast(count))
+    {
+        Json::Value l;
+        l["ledger"] = ledger.mLedgerSeq;
+        l["duration_us"] = toMicros(ledger.mDuration);
+        l["spans"] = Json::arrayValue;
+        for (auto const& span : ledger.mSpans)
+        {
+            Json::Value s;
+            s["name"] = span.mName;
+            s["thread"] = static_cast<Json::UInt64>(span.mThread);
+            s["start_us"] = toMicros(span.mStart - ledger.mStart);
+            s["duration_us"] = toMicros(span.mDuration);
+            l["spans"].append(s);
+        }
+        res["ledgers"].append(l);
+    }
+    return res;
+}
+
+Json::Value
+LedgerCloseTimeline::getChromeTraceJson(size_t count) const
+{
+    // Every ledger is a complete ("X") event on thread 0 with its spans
+    // nested inside it
+    Json::Value res;
+    res["traceEvents"] = Json::arrayValue;
+    auto addEvent = [&](std::string const& name, size_t thread,
+                        Clock::time_point start, Clock::duration duration,
+                        uint32_t ledgerSeq) {
+        Json::Value e;
+        e["name"] = name;
+        e["ph"] = "X";
+        e["pid"] = 0;
+        e["tid"] = static_cast<Json::UInt64>(thread);
+        e["ts"] = toMicros(start.time_since_epoch());
+        e["dur"] = toMicros(duration);
+        e["args"]["ledger"] = ledgerSeq;
+        res["traceEvents"].append(e);
+    };
+
+    for (auto const& ledger : getLast(count))
+    {
+        addEvent("ledger " + std::to_string(ledger.mLedgerSeq), 0,
+                 ledger.mStart, ledger.mDuration, ledger.mLedgerSeq);
+        for (auto const& span : ledger.mSpans)
+        {
+            addEvent(span.mName, span.mThread, span.mStart, span.mDuration,
+                     ledger.mLedgerSeq);
+        }
+    }
+    return res;
+}
+}
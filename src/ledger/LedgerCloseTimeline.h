@@ -0,0 +1,93 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/NonCopyable.h"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Json
+{
+class Value;
+}
+
+namespace stellar
+{
+
+// Records how long each phase of a ledger close takes. applyLedger starts a
+// timeline for each ledger, and phases record themselves with Span, possibly
+// from several threads at once. The timelines of the last maxLedgers closed
+// ledgers are kept for the `ledgertimeline` HTTP command, either as plain
+// JSON or in the Chrome trace event format, which chrome://tracing and
+// Perfetto can load.
+//
+// Spans recorded while no ledger is being closed are dropped. A timeline
+// that is started but never finished, e.g. because applyLedger threw, is
+// discarded by the next startLedger.
+class LedgerCloseTimeline : public NonMovableOrCopyable
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit LedgerCloseTimeline(size_t maxLedgers);
+
+    // Records the time between its construction and destruction as a span
+    // named name in the ledger being closed.
+    class Span : public NonMovableOrCopyable
+    {
+        LedgerCloseTimeline& mTimeline;
+        std::string mName;
+        Clock::time_point const mStart;
+
+      public:
+        Span(LedgerCloseTimeline& timeline, std::string name);
+        ~Span();
+    };
+
+    void startLedger(uint32_t ledgerSeq);
+    void finishLedger();
+
+    // Returns the timelines of the last count closed ledgers, oldest first.
+    // Span start times are relative to the start of their ledger.
+    Json::Value getJson(size_t count) const;
+
+    // Same as getJson, in the Chrome trace event format
+    Json::Value getChromeTraceJson(size_t count) const;
+
+  private:
+    struct SpanRecord
+    {
+        std::string mName;
+        size_t mThread;
+        Clock::time_point mStart;
+        Clock::duration mDuration;
+    };
+
+    struct Ledger
+    {
+        uint32_t mLedgerSeq;
+        Clock::time_point mStart;
+        Clock::duration mDuration{};
+        std::vector<SpanRecord> mSpans;
+        std::vector<std::thread::id> mThreads;
+    };
+
+    size_t const mMaxLedgers;
+    mutable std::mutex mMutex;
+    std::optional<Ledger> mCurrent;
+    std::deque<Ledger> mFinished;
+
+    void record(std::string&& name, Clock::time_point start,
+                Clock::time_point end);
+    std::vector<Ledger> getLast(size_t count) const;
+};
+}
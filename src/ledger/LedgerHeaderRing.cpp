@@ -0,0 +1,77 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "ledger/LedgerHeaderRing.h"
+#include "util/GlobalChecks.h"
+#include <medida/meter.h>
+#include <medida/metrics_registry.h>
+
+namespace stellar
+{
+
+LedgerHeaderRing::LedgerHeaderRing(size_t capacity,
+                                   medida::MetricsRegistry& registry)
+    : mEntries(capacity)
+    , mHits(registry.NewMeter({"ledger", "header-ring", "hit"}, "header"))
+    , mMisses(registry.NewMeter({"ledger", "header-ring", "miss"}, "header"))
+{
+    releaseAssert(capacity > 0);
+}
+
+void
+LedgerHeaderRing::add(LedgerHeader const& header, Hash const& hash)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto& entry = mEntries[header.ledgerSeq % mEntries.size()];
+    if (entry.mHeader)
+    {
+        mSeqByHash.erase(entry.mHash);
+    }
+    entry.mHash = hash;
+    entry.mHeader = std::make_shared<LedgerHeader const>(header);
+    mSeqByHash[hash] = header.ledgerSeq;
+}
+
+std::shared_ptr<LedgerHeader>
+LedgerHeaderRing::get(uint32_t seq)
+{
+    auto const& entry = mEntries[seq % mEntries.size()];
+    if (!entry.mHeader || entry.mHeader->ledgerSeq != seq)
+    {
+        return nullptr;
+    }
+    return std::make_shared<LedgerHeader>(*entry.mHeader);
+}
+
+std::shared_ptr<LedgerHeader>
+LedgerHeaderRing::getBySequence(uint32_t seq)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto res = get(seq);
+    (res ? mHits : mMisses).Mark();
+    return res;
+}
+
+std::shared_ptr<LedgerHeader>
+LedgerHeaderRing::getByHash(Hash const& hash)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::shared_ptr<LedgerHeader> res;
+    auto it = mSeqByHash.find(hash);
+    if (it != mSeqByHash.end())
+    {
+        res = get(it->second);
+    }
+    (res ? mHits : mMisses).Mark();
+    return res;
+}
+
+void
+LedgerHeaderRing::clear()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mEntries.assign(mEntries.size(), Entry{});
+    mSeqByHash.clear();
+}
+}
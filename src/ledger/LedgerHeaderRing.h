@@ -0,0 +1,66 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/HashOfHash.h"
+#include "util/NonCopyable.h"
+#include "util/UnorderedMap.h"
+#include "xdr/Stellar-ledger.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace medida
+{
+class Meter;
+class MetricsRegistry;
+}
+
+namespace stellar
+{
+
+// Keeps the headers of the most recently stored ledgers in memory, so that
+// LedgerHeaderUtils can load them without a database round trip. Headers are
+// added as they are stored at ledger close; each one overwrites the header
+// stored `capacity` ledgers before it.
+//
+// Lookups may come from the main thread, the apply thread and the threads
+// reading through the database connection pool, so all accesses are
+// synchronized.
+class LedgerHeaderRing : public NonMovableOrCopyable
+{
+  public:
+    // Number of checkpoints worth of headers kept
+    static constexpr uint32_t CHECKPOINTS_KEPT = 2;
+
+    LedgerHeaderRing(size_t capacity, medida::MetricsRegistry& registry);
+
+    void add(LedgerHeader const& header, Hash const& hash);
+
+    // Return copies of the header, or nullptr if it isn't kept
+    std::shared_ptr<LedgerHeader> getBySequence(uint32_t seq);
+    std::shared_ptr<LedgerHeader> getByHash(Hash const& hash);
+
+    void clear();
+
+  private:
+    struct Entry
+    {
+        Hash mHash;
+        std::shared_ptr<LedgerHeader const> mHeader;
+    };
+
+    std::mutex mMutex;
+    std::vector<Entry> mEntries;
+    UnorderedMap<Hash, uint32_t> mSeqByHash;
+
+    medida::Meter& mHits;
+    medida::Meter& mMisses;
+
+    // Must be called with mMutex held
+    std::shared_ptr<LedgerHeader> get(uint32_t seq);
+};
+}
@@ -8,6 +8,7 @@
 #include "database/Database.h"
 #include "database/DatabaseUtils.h"
 #include "history/CheckpointBuilder.h"
+#include "ledger/LedgerHeaderRing.h"
 #include "util/Decoder.h"
 #include "util/GlobalChecks.h"
 #include "util/Logging.h"
@@ -52,7 +53,8 @@ storeInDatabase(Database& db, LedgerHeader const& header, SessionWrapper& sess)
     }
 
     auto headerBytes(xdr::xdr_to_opaque(header));
-    std::string hash(binToHex(sha256(headerBytes))),
+    auto headerHash = sha256(headerBytes);
+    std::string hash(binToHex(headerHash)),
         prevHash(binToHex(header.previousLedgerHash)),
         bucketListHash(binToHex(header.bucketListHash));
 
@@ -82,6 +84,7 @@ storeInDatabase(Database& db, LedgerHeader const& header, SessionWrapper& sess)
     {
         throw std::runtime_error("Could not update data in SQL");
     }
+    db.getLedgerHeaderRing().add(header, headerHash);
 }
 
 LedgerHeader
@@ -107,6 +110,10 @@ std::shared_ptr<LedgerHeader>
 loadByHash(Database& db, Hash const& hash)
 {
     ZoneScoped;
+    if (auto lh = db.getLedgerHeaderRing().getByHash(hash))
+    {
+        return lh;
+    }
     std::shared_ptr<LedgerHeader> lhPtr;
 
     std::string hash_s(binToHex(hash));
@@ -163,6 +170,10 @@ std::shared_ptr<LedgerHeader>
 loadBySequence(Database& db, soci::session& sess, uint32_t seq)
 {
     ZoneScoped;
+    if (auto lh = db.getLedgerHeaderRing().getBySequence(seq))
+    {
+        return lh;
+    }
     std::shared_ptr<LedgerHeader> lhPtr;
 
     std::string headerEncoded;
@@ -189,12 +200,12 @@ loadBySequence(Database& db, soci::session& sess, uint32_t seq)
     return lhPtr;
 }
 
-void
+DatabaseUtils::DeletedEntries
 deleteOldEntries(soci::session& sess, uint32_t ledgerSeq, uint32_t count)
 {
     ZoneScoped;
-    DatabaseUtils::deleteOldEntriesHelper(sess, ledgerSeq, count,
-                                          "ledgerheaders", "ledgerseq");
+    return DatabaseUtils::deleteOldEntriesHelper(sess, ledgerSeq, count,
+                                                 "ledgerheaders", "ledgerseq");
 }
 
 size_t
@@ -232,6 +243,7 @@ copyToStream(soci::session& sess, uint32_t ledgerSeq, uint32_t ledgerCount,
 void
 dropAll(Database& db)
 {
+    db.getLedgerHeaderRing().clear();
     std::string coll = db.getSimpleCollationClause();
 
     db.getRawSession() << "DROP TABLE IF EXISTS ledgerheaders;";
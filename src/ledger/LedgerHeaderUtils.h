@@ -5,6 +5,7 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "database/Database.h"
+#include "database/DatabaseUtils.h"
 #include "xdr/Stellar-ledger.h"
 
 namespace stellar
@@ -30,7 +31,8 @@ std::shared_ptr<LedgerHeader> loadBySequence(Database& db, soci::session& sess,
 
 uint32_t loadMaxLedgerSeq(Database& db);
 
-void deleteOldEntries(soci::session& sess, uint32_t ledgerSeq, uint32_t count);
+DatabaseUtils::DeletedEntries
+deleteOldEntries(soci::session& sess, uint32_t ledgerSeq, uint32_t count);
 
 size_t copyToStream(soci::session& sess, uint32_t ledgerSeq,
                     uint32_t ledgerCount, CheckpointBuilder& checkpointBuilder);
@@ -19,6 +19,7 @@ namespace stellar
 class LedgerCloseData;
 class Database;
 class SorobanMetrics;
+class LedgerCloseTimeline;
 class InMemorySorobanState;
 
 // This diagram provides a schematic of the flow of (logical) ledgers coming in
@@ -268,6 +269,10 @@ class LedgerManager
     // used most of the time.
     virtual SorobanNetworkConfig const&
     getLastClosedSorobanNetworkConfig() const = 0;
+    // Same as above, but shares ownership of the config, which stays valid
+    // after the next ledger closes.
+    virtual std::shared_ptr<SorobanNetworkConfig const>
+    getLastClosedSorobanNetworkConfigPtr() const = 0;
     virtual SorobanNetworkConfig const& getSorobanNetworkConfigForApply() = 0;
 
     virtual bool hasLastClosedSorobanNetworkConfig() const = 0;
@@ -333,6 +338,12 @@ class LedgerManager
                                  CompleteConstLedgerStatePtr newLedgerState,
                                  bool upgradeApplied) = 0;
 
+    // While set, applying a ledger that doesn't end a checkpoint defers
+    // starting queued history publishes and forgetting unreferenced buckets,
+    // which replay only needs once per checkpoint. Clearing it does the
+    // deferred work. Every ledger is still committed on its own.
+    virtual void setReplayBatching(bool batching) = 0;
+
     virtual void assertSetupPhase() const = 0;
 #ifdef BUILD_TESTS
     void
@@ -348,6 +359,7 @@ class LedgerManager
     virtual void manuallyAdvanceLedgerHeader(LedgerHeader const& header) = 0;
 
     virtual SorobanMetrics& getSorobanMetrics() = 0;
+    virtual LedgerCloseTimeline const& getCloseTimeline() const = 0;
     virtual ::rust::Box<rust_bridge::SorobanModuleCache> getModuleCache() = 0;
 
     virtual ~LedgerManager()
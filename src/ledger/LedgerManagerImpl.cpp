@@ -32,6 +32,7 @@
 #include "main/Application.h"
 #include "main/Config.h"
 #include "main/ErrorMessages.h"
+#include "main/StartupProfiler.h"
 #include "rust/RustBridge.h"
 #include "transactions/MutableTransactionResult.h"
 #include "transactions/OperationFrame.h"
@@ -43,9 +44,12 @@
 #include "util/DebugMetaUtils.h"
 #include "util/Fs.h"
 #include "util/GlobalChecks.h"
+#include "util/HdrHistogram.h"
 #include "util/LogSlowExecution.h"
 #include "util/Logging.h"
+#include "util/NonCopyable.h"
 #include "util/ProtocolVersion.h"
+#include "util/Thread.h"
 #include "util/XDRCereal.h"
 #include "util/XDRStream.h"
 #include "util/types.h"
@@ -74,9 +78,13 @@
 #include <Tracy.hpp>
 
 #include "LedgerManagerImpl.h"
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <future>
 #include <memory>
 #include <mutex>
+#include <numeric>
 #include <optional>
 #include <regex>
 #include <sstream>
@@ -156,6 +164,168 @@ mergeOpInTx(std::vector<Operation> const& ops)
     }
     return false;
 }
+
+// Fee processing is only split across threads when every thread gets at least
+// this many transactions to charge.
+size_t const MIN_TXS_PER_FEE_PROCESSING_THREAD = 32;
+
+// Number of applied ledgers whose close timeline is kept for the
+// `ledgertimeline` command
+size_t const LEDGER_CLOSE_TIMELINE_SIZE = 64;
+
+// The transactions of a ledger sharing a fee source account, in apply order,
+// along with that account as each of them finds it.
+struct FeeSourceGroup
+{
+    LedgerEntry mFeeSource;
+    std::vector<size_t> mTxIndices;
+};
+
+// Charges the fees of txs in parallel. Transactions are grouped by fee source
+// account and groups are spread across numThreads threads, each of which
+// charges its transactions in apply order against a private copy of the fee
+// source. The resulting results and fee meta match what charging each
+// transaction in its own nested LedgerTxn would produce, and are returned
+// indexed like txs. Finally, the fee sources and fee pool in ltx are updated
+// once per group.
+void
+processFeesInParallel(std::vector<TransactionFrameBasePtr> const& txs,
+                      std::vector<std::optional<int64_t>> const& baseFees,
+                      AbstractLedgerTxn& ltx, size_t numThreads,
+                      std::vector<MutableTxResultPtr>& results,
+                      std::vector<LedgerEntryChanges>& changes)
+{
+    ZoneScoped;
+    auto const header = ltx.loadHeader().current();
+
+    std::vector<FeeSourceGroup> groups;
+    UnorderedMap<AccountID, size_t> groupIndex;
+    for (size_t i = 0; i < txs.size(); ++i)
+    {
+        auto feeSourceID = txs[i]->getFeeSourceID();
+        auto [it, inserted] = groupIndex.emplace(feeSourceID, groups.size());
+        if (inserted)
+        {
+            auto feeSource = loadAccountWithoutRecord(ltx, feeSourceID);
+            if (!feeSource)
+            {
+                throw std::runtime_error("Unexpected database state");
+            }
+            groups.emplace_back();
+            groups.back().mFeeSource = feeSource.current();
+        }
+        groups[it->second].mTxIndices.push_back(i);
+    }
+
+    // Hand every group to the thread with the fewest transactions so far
+    std::vector<std::vector<size_t>> threadGroups(numThreads);
+    std::vector<size_t> threadLoad(numThreads, 0);
+    for (size_t g = 0; g < groups.size(); ++g)
+    {
+        auto t = static_cast<size_t>(
+            std::min_element(threadLoad.begin(), threadLoad.end()) -
+            threadLoad.begin());
+        threadGroups[t].push_back(g);
+        threadLoad[t] += groups[g].mTxIndices.size();
+    }
+
+    results.resize(txs.size());
+    changes.resize(txs.size());
+    // Every transaction belongs to exactly one group, so threads write
+    // disjoint slots of results and changes.
+    auto worker = [&](std::vector<size_t> const& groupIndices) {
+        ZoneScopedN("fee processing worker");
+        for (auto g : groupIndices)
+        {
+            auto& feeSource = groups[g].mFeeSource;
+            for (auto i : groups[g].mTxIndices)
+            {
+                auto& txChanges = changes[i];
+                txChanges.emplace_back(LEDGER_ENTRY_STATE);
+                txChanges.back().state() = feeSource;
+
+                results[i] =
+                    txs[i]->processFeeSeqNum(feeSource, header, baseFees[i]);
+                feeSource.lastModifiedLedgerSeq = header.ledgerSeq;
+
+                txChanges.emplace_back(LEDGER_ENTRY_UPDATED);
+                txChanges.back().updated() = feeSource;
+            }
+        }
+    };
+
+    std::vector<std::future<void>> futures;
+    for (size_t t = 1; t < numThreads; ++t)
+    {
+        futures.emplace_back(std::async(std::launch::async, worker,
+                                        std::cref(threadGroups[t])));
+    }
+    worker(threadGroups[0]);
+    for (auto& f : futures)
+    {
+        f.get();
+    }
+
+    int64_t feePool = 0;
+    for (auto const& res : results)
+    {
+        feePool += res->getFeeCharged();
+    }
+    for (auto const& group : groups)
+    {
+        auto feeSource = ltx.load(LedgerEntryKey(group.mFeeSource));
+        feeSource.current() = group.mFeeSource;
+    }
+    ltx.loadHeader().current().feePool += feePool;
+}
+
+// Verifies the source account signatures of txs on numThreads helper threads
+// while the caller applies txs in order. Helpers work through txs from the
+// front, so apply mostly finds the signatures it checks in the signature
+// verification cache. Apply itself is unchanged, so results and meta are
+// identical to applying without preverifying. The destructor stops the
+// helpers and waits for them.
+class SignaturePreverifier : public NonMovableOrCopyable
+{
+    std::vector<TransactionFrameBasePtr> const& mTxs;
+    std::atomic<size_t> mNext{0};
+    std::atomic<bool> mStopping{false};
+    std::vector<std::future<void>> mHelpers;
+
+    void
+    run()
+    {
+        ZoneScopedN("signature preverify worker");
+        std::vector<PubKeyUtils::SignatureToVerify> sigs;
+        for (size_t i = mNext++; i < mTxs.size() && !mStopping; i = mNext++)
+        {
+            sigs.clear();
+            mTxs[i]->insertSignaturesToVerify(sigs, /* forApply */ true);
+            PubKeyUtils::verifySigs(sigs);
+        }
+    }
+
+  public:
+    SignaturePreverifier(std::vector<TransactionFrameBasePtr> const& txs,
+                         size_t numThreads)
+        : mTxs(txs)
+    {
+        for (size_t t = 0; t < numThreads; ++t)
+        {
+            mHelpers.emplace_back(
+                std::async(std::launch::async, [this] { run(); }));
+        }
+    }
+
+    ~SignaturePreverifier()
+    {
+        mStopping = true;
+        for (auto& f : mHelpers)
+        {
+            f.wait();
+        }
+    }
+};
 }
 
 std::unique_ptr<LedgerManager>
@@ -191,8 +361,8 @@ LedgerManager::ledgerAbbrev(LedgerHeaderHistoryEntry const& he)
 }
 
 LedgerManagerImpl::LedgerApplyMetrics::LedgerApplyMetrics(
-    medida::MetricsRegistry& registry)
-    : mSorobanMetrics(registry)
+    medida::MetricsRegistry& registry, HdrMetricsRegistry& hdrRegistry)
+    : mSorobanMetrics(registry, hdrRegistry)
     , mTransactionApply(registry.NewTimer({"ledger", "transaction", "apply"}))
     , mTransactionCount(
           registry.NewHistogram({"ledger", "transaction", "count"}))
@@ -211,18 +381,24 @@ LedgerManagerImpl::LedgerApplyMetrics::LedgerApplyMetrics(
           registry.NewCounter({"ledger", "apply-soroban", "success"}))
     , mSorobanTransactionApplyFailed(
           registry.NewCounter({"ledger", "apply-soroban", "failure"}))
-    , mMetaStreamBytes(
-          registry.NewMeter({"ledger", "metastream", "bytes"}, "byte"))
-    , mMetaStreamWriteTime(registry.NewTimer({"ledger", "metastream", "write"}))
+    , mSorobanThreadUtilization(registry.NewHistogram(
+          {"ledger", "apply-soroban", "thread-utilization"}))
+    , mSorobanClusterWallTime(
+          registry.NewTimer({"ledger", "apply-soroban", "cluster-wall"}))
+    , mSorobanClusterCPUTime(
+          registry.NewTimer({"ledger", "apply-soroban", "cluster-cpu"}))
 {
 }
 
 LedgerManagerImpl::ApplyState::ApplyState(Application& app)
-    : mMetrics(app.getMetrics())
+    : mMetrics(app.getMetrics(), app.getHdrMetrics())
     , mAppConnector(app.getAppConnector())
     , mModuleCache(::rust_bridge::new_module_cache())
     , mModuleCacheProtocols(getModuleCacheProtocols())
     , mNumCompilationThreads(app.getConfig().COMPILATION_THREADS)
+    , mNumSorobanStateLoadThreads(app.getConfig().SOROBAN_STATE_LOAD_THREADS)
+    , mNumaNode(app.getConfig().APPLY_NUMA_NODE)
+    , mInMemorySorobanState(app.getConfig().SOROBAN_STATE_TTL_INDEX)
 {
 }
 
@@ -383,6 +559,7 @@ LedgerManagerImpl::LedgerManagerImpl(Application& app)
     , mLastClose(mApp.getClock().now())
     , mCatchupDuration(
           app.getMetrics().NewTimer({"ledger", "catchup", "duration"}))
+    , mCloseTimeline(LEDGER_CLOSE_TIMELINE_SIZE)
     , mState(LM_BOOTING_STATE)
 {
     setupLedgerCloseMetaStream();
@@ -558,6 +735,8 @@ LedgerManagerImpl::loadLastKnownLedger(bool restoreBucketlist)
 {
     ZoneScoped;
     mApplyState.assertSetupPhase();
+    auto& profiler = mApp.getStartupProfiler();
+    auto loadStart = StartupProfiler::Clock::now();
 
     // Step 1. Load LCL state from the DB and extract latest ledger hash
     string lastLedger = mApp.getPersistentState().getState(
@@ -610,21 +789,26 @@ LedgerManagerImpl::loadLastKnownLedger(bool restoreBucketlist)
                    missing.size(), mApp.getBucketManager().getBucketDir());
         throw std::runtime_error("Bucket directory is corrupt");
     }
+    profiler.record("load-lcl", loadStart, StartupProfiler::Clock::now());
 
     // Only restart merges in full startup mode. Many modes in core
     // (standalone offline commands, in-memory setup) do not need to
     // spin up expensive merge processes.
-    auto assumeStateWork = mApp.getWorkScheduler().executeWork<AssumeStateWork>(
-        has, latestLedgerHeader->ledgerVersion, restoreBucketlist);
-    if (assumeStateWork->getState() == BasicWork::State::WORK_SUCCESS)
     {
-        CLOG_INFO(Ledger, "Assumed bucket-state for LCL: {}",
-                  ledgerAbbrev(*latestLedgerHeader));
-    }
-    else
-    {
-        // Work should only fail during graceful shutdown
-        releaseAssertOrThrow(mApp.isStopping());
+        StartupProfiler::Phase phase(profiler, "assume-state");
+        auto assumeStateWork =
+            mApp.getWorkScheduler().executeWork<AssumeStateWork>(
+                has, latestLedgerHeader->ledgerVersion, restoreBucketlist);
+        if (assumeStateWork->getState() == BasicWork::State::WORK_SUCCESS)
+        {
+            CLOG_INFO(Ledger, "Assumed bucket-state for LCL: {}",
+                      ledgerAbbrev(*latestLedgerHeader));
+        }
+        else
+        {
+            // Work should only fail during graceful shutdown
+            releaseAssertOrThrow(mApp.isStopping());
+        }
     }
 
     // Step 4. Restore LedgerManager's LCL state
@@ -643,11 +827,14 @@ LedgerManagerImpl::loadLastKnownLedger(bool restoreBucketlist)
     // Prime module cache with LCL state, not apply-state. This is acceptable
     // here because we just started and there is no apply-state yet and no apply
     // thread to hold such state.
+    StartupProfiler::Phase phase(profiler, "soroban-state");
     auto const& snapshot = mLastClosedLedgerState->getBucketSnapshot();
-    mApplyState.compileAllContractsInLedger(snapshot,
-                                            latestLedgerHeader->ledgerVersion);
-    mApplyState.populateInMemorySorobanState(snapshot,
-                                             latestLedgerHeader->ledgerVersion);
+    mApplyState.compileAndPopulateSorobanState(
+        snapshot,
+        mApp.getBucketManager()
+            .getBucketSnapshotManager()
+            .copySearchableLiveBucketListSnapshot(),
+        latestLedgerHeader->ledgerVersion);
     mApplyState.markEndOfSetupPhase();
 }
 
@@ -776,6 +963,14 @@ LedgerManagerImpl::getLastClosedSorobanNetworkConfig() const
     return mLastClosedLedgerState->getSorobanConfig();
 }
 
+std::shared_ptr<SorobanNetworkConfig const>
+LedgerManagerImpl::getLastClosedSorobanNetworkConfigPtr() const
+{
+    releaseAssert(threadIsMain());
+    releaseAssert(hasLastClosedSorobanNetworkConfig());
+    return mLastClosedLedgerState->getSorobanConfigPtr();
+}
+
 SorobanNetworkConfig const&
 LedgerManagerImpl::getSorobanNetworkConfigForApply()
 {
@@ -833,7 +1028,9 @@ LedgerManagerImpl::mutateSorobanNetworkConfigForApply(
         mApp.getBucketManager()
             .getBucketSnapshotManager()
             .copySearchableLiveBucketListSnapshot(),
-        mApplyState.getSorobanNetworkConfigForCommit(/*skipPhaseCheck*/ true),
+        std::make_shared<SorobanNetworkConfig const>(
+            mApplyState.getSorobanNetworkConfigForCommit(
+                /*skipPhaseCheck*/ true)),
         getLastClosedLedgerHeader(), getLastClosedLedgerHAS());
 }
 
@@ -849,6 +1046,15 @@ LedgerManagerImpl::getLastClosedLedgerCloseMeta()
     return mLastLedgerCloseMeta;
 }
 
+void
+LedgerManagerImpl::drainMetaDebugForTesting()
+{
+    if (mMetaDebugWriter)
+    {
+        mMetaDebugWriter->drain();
+    }
+}
+
 void
 LedgerManagerImpl::storeCurrentLedgerForTest(LedgerHeader const& header)
 {
@@ -891,6 +1097,12 @@ LedgerManagerImpl::getSorobanMetrics()
     return mApplyState.getMetrics().mSorobanMetrics;
 }
 
+LedgerCloseTimeline const&
+LedgerManagerImpl::getCloseTimeline() const
+{
+    return mCloseTimeline;
+}
+
 std::unique_ptr<LedgerTxnRoot>
 LedgerManagerImpl::createLedgerTxnRoot(Application& app, size_t entryCacheSize,
                                        size_t prefetchBatchSize
@@ -913,10 +1125,8 @@ LedgerManagerImpl::createLedgerTxnRoot(Application& app, size_t entryCacheSize,
 ::rust::Box<rust_bridge::SorobanModuleCache>
 LedgerManagerImpl::getModuleCache()
 {
-    // There should not be any compilation running when
-    // anyone calls this function. It is accessed from
-    // transactions during apply only.
-    releaseAssert(!mApplyState.isCompilationRunning());
+    // It is accessed from transactions during apply only. A background
+    // rebuild may be running, but it doesn't touch the current cache.
     return mApplyState.getModuleCache()->shallow_clone();
 }
 
@@ -940,8 +1150,12 @@ LedgerManagerImpl::ApplyState::handleUpgradeAffectingSorobanInMemoryStateSize(
     SorobanNetworkConfig currentConfig;
     currentConfig.loadFromLedger(upgradeLtx);
     auto upgradeLedgerVersion = upgradeLtx.loadHeader().current().ledgerVersion;
-    mInMemorySorobanState.recomputeContractCodeSize(currentConfig,
-                                                    upgradeLedgerVersion);
+    {
+        auto timer = mMetrics.mSorobanMetrics.mContractCodeSizeRecomputeTime
+                         .TimeScope();
+        mInMemorySorobanState.recomputeContractCodeSize(
+            currentConfig, upgradeLedgerVersion, mNumSorobanStateLoadThreads);
+    }
 
     // We need to record the updated size, but only when we're in p23+, as
     // before that we store BL size instead.
@@ -964,16 +1178,58 @@ LedgerManagerImpl::ApplyState::finishPendingCompilation()
         (int64)mCompiler->getContractsCompiled());
     getMetrics().mSorobanMetrics.mModuleCacheRebuildTime.Update(
         mCompiler->getCompileTime());
+
+    // Bring the new cache up to date with the ledgers applied while it was
+    // being built
+    for (auto const& change : mPendingModuleCacheChanges)
+    {
+        if (change.mWasm.empty())
+        {
+            ::rust::Slice<uint8_t const> slice{change.mHash.data(),
+                                               change.mHash.size()};
+            newCache->evict_contract_code(slice);
+            getMetrics().mSorobanMetrics.mModuleCacheNumEntries.dec();
+        }
+        else
+        {
+            auto slice = rust::Slice<const uint8_t>(change.mWasm.data(),
+                                                    change.mWasm.size());
+            newCache->compile(change.mLedgerVersion, slice);
+            getMetrics().mSorobanMetrics.mModuleCacheNumEntries.inc();
+        }
+    }
+    mPendingModuleCacheChanges.clear();
+
     mModuleCache.swap(newCache);
     mCompiler.reset();
 }
 
 void
-LedgerManagerImpl::ApplyState::compileAllContractsInLedger(
-    SearchableSnapshotConstPtr snap, uint32_t minLedgerVersion)
+LedgerManagerImpl::ApplyState::maybeFinishPendingCompilation()
+{
+    if (mCompiler && mCompiler->isFinished())
+    {
+        finishPendingCompilation();
+    }
+}
+
+void
+LedgerManagerImpl::ApplyState::compileAndPopulateSorobanState(
+    SearchableSnapshotConstPtr snap, SearchableSnapshotConstPtr compileSnap,
+    uint32_t ledgerVersion)
 {
     assertSetupPhase();
-    startCompilingAllContracts(snap, minLedgerVersion);
+    releaseAssert(snap != compileSnap);
+    releaseAssert(snap->getLedgerSeq() == compileSnap->getLedgerSeq());
+    // A rebuild still running from before a reset is superseded by this
+    // compilation
+    if (mCompiler)
+    {
+        mCompiler.reset();
+        mPendingModuleCacheChanges.clear();
+    }
+    startCompilingAllContracts(compileSnap, ledgerVersion);
+    populateInMemorySorobanState(snap, ledgerVersion);
     finishPendingCompilation();
 }
 
@@ -982,8 +1238,11 @@ LedgerManagerImpl::ApplyState::populateInMemorySorobanState(
     SearchableSnapshotConstPtr snap, uint32_t ledgerVersion)
 {
     assertSetupPhase();
+    // The loading threads inherit the memory preference
+    NumaMemoryScope numaScope(mNumaNode);
     mInMemorySorobanState.initializeStateFromSnapshot(
-        snap, mSorobanNetworkConfig.get(), ledgerVersion);
+        snap, mSorobanNetworkConfig.get(), ledgerVersion,
+        mNumSorobanStateLoadThreads);
 }
 
 void
@@ -1055,6 +1314,9 @@ LedgerManagerImpl::ApplyState::startCompilingAllContracts(
             versions.push_back(v);
         }
     }
+    // The new module cache is built by the compilation threads, which
+    // inherit the memory preference
+    NumaMemoryScope numaScope(mNumaNode);
     mCompiler = std::make_unique<SharedModuleCacheCompiler>(
         snap, mNumCompilationThreads, versions);
     mCompiler->start();
@@ -1074,6 +1336,13 @@ LedgerManagerImpl::ApplyState::maybeRebuildModuleCache(
 {
     assertCommittingPhase();
 
+    // A previous rebuild is still compiling in the background. It will reset
+    // the arena when it lands.
+    if (mCompiler)
+    {
+        return;
+    }
+
     // There is (currently) a grow-only arena underlying the module cache, so as
     // entries are uploaded and evicted that arena will still grow. To cap this
     // growth, we periodically rebuild the module cache from scratch.
@@ -1248,26 +1517,25 @@ LedgerManagerImpl::emitNextMeta()
     ZoneScoped;
 
     releaseAssert(mNextMetaToEmit);
-    releaseAssert(mMetaStream || mMetaDebugStream);
-    auto timer = LogSlowExecution("MetaStream write",
-                                  LogSlowExecution::Mode::AUTOMATIC_RAII,
-                                  "took", std::chrono::milliseconds(100));
-    auto streamWrite =
-        mApplyState.getMetrics().mMetaStreamWriteTime.TimeScope();
-    if (mMetaStream)
+    releaseAssert(mMetaStream || mMetaDebugWriter);
+    if (mMetaDebugWriter)
     {
-        size_t written = 0;
-        mMetaStream->writeOne(mNextMetaToEmit->getXDR(), nullptr, &written);
-        mMetaStream->flush();
-        mApplyState.getMetrics().mMetaStreamBytes.Mark(written);
+        // The writer flushes every ledger in case there's a crash later in
+        // commit, to preserve the meta for problematic ledgers that is vital
+        // for diagnostics.
+        mMetaDebugWriter->write(mNextMetaToEmit->getXDR());
     }
-    if (mMetaDebugStream)
+    if (mMetaStreamWriter)
     {
-        mMetaDebugStream->writeOne(mNextMetaToEmit->getXDR());
-        // Flush debug meta in case there's a crash later in commit (in which
-        // case we'd lose the data in internal buffers). This way we preserve
-        // the meta for problematic ledgers that is vital for diagnostics.
-        mMetaDebugStream->flush();
+        mMetaStreamWriter->enqueue(mNextMetaToEmit->getXDR());
+        if (!mApp.getConfig().EXPERIMENTAL_PIPELINED_LEDGER_COMMIT)
+        {
+            // The meta has to reach the stream before the ledger commits
+            auto timer = LogSlowExecution(
+                "MetaStream write", LogSlowExecution::Mode::AUTOMATIC_RAII,
+                "took", std::chrono::milliseconds(100));
+            mMetaStreamWriter->drain();
+        }
     }
     mNextMetaToEmit.reset();
 }
@@ -1378,18 +1646,16 @@ LedgerManagerImpl::advanceLedgerStateAndPublish(
     releaseAssert(threadIsMain());
     advanceLastClosedLedgerState(newLedgerState);
 
-    // Maybe kick off publishing on complete checkpoint files
-    auto& hm = mApp.getHistoryManager();
-    hm.publishQueuedHistory();
-    hm.logAndUpdatePublishStatus();
-
-    // Clean up unreferenced buckets post-apply
+    // Checkpoints are only queued for publishing on their last ledger, so a
+    // replay batch catches up on both at that point
+    if (mReplayBatching &&
+        !HistoryManager::isLastLedgerInCheckpoint(ledgerSeq, mApp.getConfig()))
     {
-        // Ledger state might be updated at the same time, so protect GC
-        // call with state mutex
-        std::lock_guard<std::recursive_mutex> guard(mLedgerStateMutex);
-        mApp.getBucketManager().forgetUnreferencedBuckets(
-            getLastClosedLedgerHAS());
+        mPostApplyWorkDeferred = true;
+    }
+    else
+    {
+        publishHistoryAndForgetBuckets();
     }
 
     // Maybe set LedgerManager into synced state, maybe let
@@ -1408,6 +1674,39 @@ LedgerManagerImpl::advanceLedgerStateAndPublish(
     CLOG_INFO(Ledger, "Ledger close complete: {}", ledgerSeq);
 }
 
+void
+LedgerManagerImpl::publishHistoryAndForgetBuckets()
+{
+    ZoneScoped;
+    releaseAssert(threadIsMain());
+    mPostApplyWorkDeferred = false;
+
+    // Maybe kick off publishing on complete checkpoint files
+    auto& hm = mApp.getHistoryManager();
+    hm.publishQueuedHistory();
+    hm.logAndUpdatePublishStatus();
+
+    // Clean up unreferenced buckets post-apply
+    {
+        // Ledger state might be updated at the same time, so protect GC
+        // call with state mutex
+        std::lock_guard<std::recursive_mutex> guard(mLedgerStateMutex);
+        mApp.getBucketManager().forgetUnreferencedBuckets(
+            getLastClosedLedgerHAS());
+    }
+}
+
+void
+LedgerManagerImpl::setReplayBatching(bool batching)
+{
+    releaseAssert(threadIsMain());
+    mReplayBatching = batching;
+    if (!batching && mPostApplyWorkDeferred && !mApp.isStopping())
+    {
+        publishHistoryAndForgetBuckets();
+    }
+}
+
 // This is the main entrypoint for the apply thread (and/or synchronous
 // application happening on the main thread -- it can happen on either).
 // It is called from the LedgerApplyManager and will post its results
@@ -1421,13 +1720,11 @@ LedgerManagerImpl::applyLedger(LedgerCloseData const& ledgerData,
         return;
     }
 
-    // Complete any pending wasm-module-compilation before closing the ledger.
-    // This might or might-not exist, depending on whether we triggered a
-    // compilation in the previous ledger-apply.
-    if (mApplyState.isCompilationRunning())
-    {
-        mApplyState.finishPendingCompilation();
-    }
+    // Swap in the module cache rebuilt in the background, if one was
+    // triggered by an earlier ledger-apply and has finished compiling. If it
+    // hasn't, this ledger applies with the current cache, which holds the same
+    // set of contracts, rather than stalling.
+    mApplyState.maybeFinishPendingCompilation();
 
 #ifdef BUILD_TESTS
     mLastLedgerTxMeta.clear();
@@ -1463,6 +1760,7 @@ LedgerManagerImpl::applyLedger(LedgerCloseData const& ledgerData,
                header.current().ledgerSeq);
 
     ZoneValue(static_cast<int64_t>(header.current().ledgerSeq));
+    mCloseTimeline.startLedger(header.current().ledgerSeq);
 
     auto now = mApp.getClock().now();
     mApplyState.getMetrics().mLedgerAgeClosed.Update(now - mLastClose);
@@ -1514,7 +1812,14 @@ LedgerManagerImpl::applyLedger(LedgerCloseData const& ledgerData,
     header.current().scpValue = sv;
 
     maybeResetLedgerCloseMetaDebugStream(header.current().ledgerSeq);
-    auto applicableTxSet = txSet->prepareForApply(mApp, prevHeader);
+    // Herder passes the frame it validated the tx set with when it had one
+    // for the current LCL; txSet->previousLedgerHash() matching prevHash was
+    // checked above, so it is the same frame prepareForApply would build.
+    auto applicableTxSet = ledgerData.getApplicableTxSet();
+    if (!applicableTxSet)
+    {
+        applicableTxSet = txSet->prepareForApply(mApp, prevHeader);
+    }
 
     if (applicableTxSet == nullptr)
     {
@@ -1532,7 +1837,7 @@ LedgerManagerImpl::applyLedger(LedgerCloseData const& ledgerData,
     // the ledger entries modified by each tx during tx processing in a
     // LedgerCloseMeta, for streaming to attached clients (typically: horizon).
     std::unique_ptr<LedgerCloseMetaFrame> ledgerCloseMeta;
-    if (mMetaStream || mMetaDebugStream)
+    if (mMetaStream || mMetaDebugWriter)
     {
         if (mNextMetaToEmit)
         {
@@ -1582,12 +1887,25 @@ LedgerManagerImpl::applyLedger(LedgerCloseData const& ledgerData,
 #endif
     {
         // first, prefetch source accounts for txset, then charge fees
-        prefetchTxSourceIds(mApp.getLedgerTxnRoot(), *applicableTxSet,
-                            mApp.getConfig());
+        {
+            LedgerCloseTimeline::Span span(mCloseTimeline, "prefetch");
+            prefetchTxSourceIds(mApp.getLedgerTxnRoot(), *applicableTxSet,
+                                mApp.getConfig());
+            // The keys needed to apply transactions load in the background
+            // while fees are charged
+            prefetchTransactionData(mApp.getLedgerTxnRoot(), *applicableTxSet,
+                                    mApp.getConfig());
+        }
         // Subtle: after this call, `header` is invalidated, and is not safe
         // to use
-        auto const mutableTxResults = processFeesSeqNums(
-            *applicableTxSet, ltx, ledgerCloseMeta, ledgerData);
+        std::vector<MutableTxResultPtr> mutableTxResults;
+        {
+            LedgerCloseTimeline::Span span(mCloseTimeline, "fees");
+            mutableTxResults = processFeesSeqNums(
+                *applicableTxSet, ltx, ledgerCloseMeta, ledgerData,
+                mApp.getConfig().FEE_PROCESSING_THREADS);
+        }
+        LedgerCloseTimeline::Span span(mCloseTimeline, "apply transactions");
         txResultSet = applyTransactions(*applicableTxSet, mutableTxResults, ltx,
                                         ledgerCloseMeta);
     }
@@ -1607,6 +1925,11 @@ LedgerManagerImpl::applyLedger(LedgerCloseData const& ledgerData,
     // transactions and are beginning to commit ledger phase.
     mApplyState.markStartOfCommitting();
     bool upgradeApplied = false;
+    std::optional<LedgerCloseTimeline::Span> upgradesSpan;
+    if (!sv.upgrades.empty())
+    {
+        upgradesSpan.emplace(mCloseTimeline, "upgrades");
+    }
     for (size_t i = 0; i < sv.upgrades.size(); i++)
     {
         LedgerUpgrade lupgrade;
@@ -1657,15 +1980,34 @@ LedgerManagerImpl::applyLedger(LedgerCloseData const& ledgerData,
         }
     }
 
+    upgradesSpan.reset();
+
     auto maybeNewVersion = ltx.loadHeader().current().ledgerVersion;
     auto ledgerSeq = ltx.loadHeader().current().ledgerSeq;
     if (protocolVersionStartsFrom(maybeNewVersion, SOROBAN_PROTOCOL_VERSION))
     {
-        updateSorobanNetworkConfigForCommit(ltx);
+        // Config settings only change through upgrades: the eviction iterator
+        // and the state size window are written through the in-memory config
+        // itself while sealing. So the config only needs to be parsed from the
+        // ledger again when an upgrade touched a setting or the protocol
+        // version, which the rent fee computation depends on.
+        if (!mApplyState.hasSorobanNetworkConfigForCommit() ||
+            maybeNewVersion != initialLedgerVers ||
+            ltx.hasConfigSettingChangesWithoutSealing())
+        {
+            updateSorobanNetworkConfigForCommit(ltx);
+        }
+        else
+        {
+            publishSorobanMetrics();
+        }
     }
 
+    std::optional<LedgerCloseTimeline::Span> sealSpan;
+    sealSpan.emplace(mCloseTimeline, "seal");
     auto appliedLedgerState = sealLedgerTxnAndStoreInBucketsAndDB(
         ltx, ledgerCloseMeta, initialLedgerVers);
+    sealSpan.reset();
 
     if (ledgerData.getExpectedHash() &&
         *ledgerData.getExpectedHash() !=
@@ -1674,7 +2016,7 @@ LedgerManagerImpl::applyLedger(LedgerCloseData const& ledgerData,
         throw std::runtime_error("Local node's ledger corrupted during close");
     }
 
-    if (mMetaStream || mMetaDebugStream)
+    if (mMetaStream || mMetaDebugWriter)
     {
         releaseAssert(ledgerCloseMeta);
         ledgerCloseMeta->ledgerHeader() =
@@ -1684,6 +2026,7 @@ LedgerManagerImpl::applyLedger(LedgerCloseData const& ledgerData,
         // member variable: if we throw while committing below, we will at worst
         // emit duplicate meta, when retrying.
         mNextMetaToEmit = std::move(ledgerCloseMeta);
+        LedgerCloseTimeline::Span span(mCloseTimeline, "emit meta");
         emitNextMeta();
     }
 
@@ -1729,7 +2072,22 @@ LedgerManagerImpl::applyLedger(LedgerCloseData const& ledgerData,
     hm.maybeQueueHistoryCheckpoint(ledgerSeq, maybeNewVersion);
 
     // step 2
-    ltx.commit();
+    {
+        LedgerCloseTimeline::Span span(mCloseTimeline, "commit");
+        ltx.commit();
+    }
+
+    // Invariants checked in the background report failures on earlier
+    // ledgers here
+    try
+    {
+        mApp.getInvariantManager().checkOnLedgerCommit(ledgerSeq);
+    }
+    catch (InvariantDoesNotHold& e)
+    {
+        printErrorAndAbort("Invariant failure while applying operations: ",
+                           e.what());
+    }
 
 #ifdef BUILD_TESTS
     mLatestTxResultSet = txResultSet;
@@ -1777,6 +2135,7 @@ LedgerManagerImpl::applyLedger(LedgerCloseData const& ledgerData,
     std::chrono::duration<double> ledgerTimeSeconds = ledgerTime.Stop();
     CLOG_DEBUG(Perf, "Applied ledger {} in {} seconds", ledgerSeq,
                ledgerTimeSeconds.count());
+    mCloseTimeline.finishLedger();
     FrameMark;
 }
 
@@ -1813,8 +2172,12 @@ LedgerManagerImpl::setLastClosedLedger(
     // case we will prime the tx-apply-state's soroban module cache using
     // a snapshot _from_ the LCL state.
     auto const& snapshot = mLastClosedLedgerState->getBucketSnapshot();
-    mApplyState.compileAllContractsInLedger(snapshot, ledgerVersion);
-    mApplyState.populateInMemorySorobanState(snapshot, ledgerVersion);
+    mApplyState.compileAndPopulateSorobanState(
+        snapshot,
+        mApp.getBucketManager()
+            .getBucketSnapshotManager()
+            .copySearchableLiveBucketListSnapshot(),
+        ledgerVersion);
     mApplyState.markEndOfSetupPhase();
 }
 
@@ -1870,6 +2233,17 @@ LedgerManagerImpl::setupLedgerCloseMetaStream()
                       cfg.METADATA_OUTPUT_STREAM);
             mMetaStream->open(cfg.METADATA_OUTPUT_STREAM);
         }
+        auto format = MetaStreamFormat::XDR;
+        if (cfg.METADATA_OUTPUT_STREAM_INDEXED)
+        {
+            format = cfg.METADATA_OUTPUT_STREAM_COMPRESS
+                         ? MetaStreamFormat::INDEXED_ZLIB
+                         : MetaStreamFormat::INDEXED;
+        }
+        mMetaStreamWriter = std::make_unique<MetaStreamWriter>(
+            *mMetaStream, cfg.METADATA_OUTPUT_STREAM_MAX_PENDING_LEDGERS,
+            cfg.METADATA_OUTPUT_STREAM_ABORT_WHEN_BEHIND, format,
+            mApp.getMetrics());
     }
 }
 void
@@ -1879,53 +2253,54 @@ LedgerManagerImpl::maybeResetLedgerCloseMetaDebugStream(uint32_t ledgerSeq)
 
     if (mApp.getConfig().METADATA_DEBUG_LEDGERS != 0)
     {
-        if (mMetaDebugStream)
+        if (!mMetaDebugWriter)
         {
-            if (!metautils::isDebugSegmentBoundary(ledgerSeq))
-            {
-                // If we've got a stream open and aren't at a reset boundary,
-                // just return -- keep streaming into it.
-                return;
-            }
-
-            // If we have an open stream and there is already a flush-and-rotate
-            // work _running_ (measured by the existence of a shared_ptr at the
-            // end of the weak_ptr), we're in a slightly awkward position since
-            // we can't synchronously close the stream (that would fsync) and we
-            // can't asynchronously close the stream either (that would race
-            // against the running work that is presumably flushing-and-rotating
-            // the _previous_ stream). So we just skip an iteration of launching
-            // flush-and-rotate work, and try again on the next boundary.
-            auto existing = mFlushAndRotateMetaDebugWork.lock();
-            if (existing && !existing->isDone())
-            {
-                CLOG_DEBUG(Ledger,
-                           "Skipping flush-and-rotate of {} since work already "
-                           "running",
-                           mMetaDebugPath.string());
-                return;
-            }
+            mMetaDebugWriter = std::make_unique<DebugMetaWriter>(
+                getMetaIOContext(mApp), mApp.getMetrics());
+        }
+        if (!mMetaDebugPath.empty() &&
+            !metautils::isDebugSegmentBoundary(ledgerSeq))
+        {
+            // If we've got a segment open and aren't at a reset boundary,
+            // just return -- keep streaming into it.
+            return;
+        }
 
-            // If we are resetting and already have a stream, hand it off to the
-            // flush-and-rotate work to finish up with.
-            mFlushAndRotateMetaDebugWork =
+        // If we are resetting and already have a segment, the writer closes
+        // it on its thread and flush-and-rotate work finishes up with it once
+        // it's closed. The work is scheduled right away so that it's running
+        // until old segments are trimmed.
+        std::function<void()> onRotated;
+        if (!mMetaDebugPath.empty())
+        {
+            std::weak_ptr<FlushAndRotateMetaDebugWork> weak =
                 mApp.getWorkScheduler()
                     .scheduleWork<FlushAndRotateMetaDebugWork>(
-                        mMetaDebugPath, std::move(mMetaDebugStream),
+                        mMetaDebugPath,
                         mApp.getConfig().METADATA_DEBUG_LEDGERS);
-            mMetaDebugPath.clear();
+            onRotated = [&app = mApp, weak]() {
+                app.postOnMainThread(
+                    [weak]() {
+                        auto work = weak.lock();
+                        if (work)
+                        {
+                            work->segmentClosed();
+                        }
+                    },
+                    "meta-debug segment closed");
+            };
         }
+        auto closedPath = mMetaDebugPath;
+        mMetaDebugPath.clear();
 
-        // From here on we're starting a new stream, whether it's the first
-        // such stream or a replacement for the one we just handed off to
-        // flush-and-rotate. Either way, we should not have an existing one!
-        releaseAssert(!mMetaDebugStream);
-        auto tmpStream =
-            std::make_unique<XDROutputFileStream>(getMetaIOContext(mApp),
-                                                  /*fsyncOnClose=*/true);
-
+        // From here on we're starting a new segment, whether it's the first
+        // such segment or a replacement for the one we just closed.
         auto metaDebugPath = metautils::getMetaDebugFilePath(
             mApp.getBucketManager().getBucketDir(), ledgerSeq);
+        if (DebugMetaWriter::GZIP_SEGMENTS)
+        {
+            metaDebugPath += ".gz";
+        }
         releaseAssert(metaDebugPath.has_parent_path());
         try
         {
@@ -1944,12 +2319,6 @@ LedgerManagerImpl::maybeResetLedgerCloseMetaDebugStream(uint32_t ledgerSeq)
                                            });
                 if (files.empty())
                 {
-                    CLOG_DEBUG(Ledger, "Streaming debug metadata to '{}'",
-                               metaDebugPath.string());
-                    tmpStream->open(metaDebugPath.string());
-
-                    // If we get to this line, the stream is open.
-                    mMetaDebugStream = std::move(tmpStream);
                     mMetaDebugPath = metaDebugPath;
                 }
             }
@@ -1966,6 +2335,11 @@ LedgerManagerImpl::maybeResetLedgerCloseMetaDebugStream(uint32_t ledgerSeq)
                          "Failed to open debug metadata stream '{}': {}",
                          metaDebugPath.string(), e.what());
         }
+
+        if (!closedPath.empty() || !mMetaDebugPath.empty())
+        {
+            mMetaDebugWriter->rotate(mMetaDebugPath, std::move(onRotated));
+        }
     }
 }
 
@@ -2009,7 +2383,8 @@ LedgerManagerImpl::maybeLoadSorobanNetworkConfig(uint32_t ledgerVersion)
             mApp.getBucketManager()
                 .getBucketSnapshotManager()
                 .copySearchableLiveBucketListSnapshot(),
-            mApplyState.getSorobanNetworkConfigForCommit(),
+            std::make_shared<SorobanNetworkConfig const>(
+                mApplyState.getSorobanNetworkConfigForCommit()),
             getLastClosedLedgerHeader(), getLastClosedLedgerHAS());
     }
 }
@@ -2036,10 +2411,15 @@ LedgerManagerImpl::advanceBucketListSnapshotAndMakeLedgerState(
 
     if (mApplyState.hasSorobanNetworkConfigForCommit())
     {
+        // The apply config keeps being updated in place (eviction iterator,
+        // state size window) so readers get their own immutable copy, shared
+        // by everyone that looks at this ledger.
         return std::make_shared<CompleteConstLedgerState const>(
             bm.getBucketSnapshotManager()
                 .copySearchableLiveBucketListSnapshot(),
-            mApplyState.getSorobanNetworkConfigForCommit(), lcl, has);
+            std::make_shared<SorobanNetworkConfig const>(
+                mApplyState.getSorobanNetworkConfigForCommit()),
+            lcl, has);
     }
     else
     {
@@ -2075,7 +2455,7 @@ std::vector<MutableTxResultPtr>
 LedgerManagerImpl::processFeesSeqNums(
     ApplicableTxSetFrame const& txSet, AbstractLedgerTxn& ltxOuter,
     std::unique_ptr<LedgerCloseMetaFrame> const& ledgerCloseMeta,
-    LedgerCloseData const& ledgerData)
+    LedgerCloseData const& ledgerData, uint32_t numThreads)
 {
     ZoneScoped;
     std::vector<MutableTxResultPtr> txResults;
@@ -2088,6 +2468,35 @@ LedgerManagerImpl::processFeesSeqNums(
         auto header = ltx.loadHeader().current();
         std::map<AccountID, SequenceNumber> accToMaxSeq;
 
+        // Before protocol 10 fee processing also consumes sequence numbers
+        // and transactions cache their source accounts, so older ledgers are
+        // always charged one transaction at a time.
+        auto const numTxs = txSet.sizeTxTotal();
+        size_t const feeThreads = std::min<size_t>(
+            numThreads, numTxs / MIN_TXS_PER_FEE_PROCESSING_THREAD);
+        std::vector<MutableTxResultPtr> parallelResults;
+        std::vector<LedgerEntryChanges> parallelChanges;
+        bool const parallel =
+            feeThreads > 1 && protocolVersionStartsFrom(header.ledgerVersion,
+                                                        ProtocolVersion::V_10);
+        if (parallel)
+        {
+            std::vector<TransactionFrameBasePtr> txs;
+            std::vector<std::optional<int64_t>> baseFees;
+            txs.reserve(numTxs);
+            baseFees.reserve(numTxs);
+            for (auto const& phase : txSet.getPhasesInApplyOrder())
+            {
+                for (auto const& tx : phase)
+                {
+                    txs.emplace_back(tx);
+                    baseFees.emplace_back(txSet.getTxBaseFee(tx));
+                }
+            }
+            processFeesInParallel(txs, baseFees, ltx, feeThreads,
+                                  parallelResults, parallelChanges);
+        }
+
 #ifdef BUILD_TESTS
         // If we have expected results, we assign them to the mutable tx results
         // here.
@@ -2108,9 +2517,27 @@ LedgerManagerImpl::processFeesSeqNums(
         {
             for (auto const& tx : phase)
             {
-                LedgerTxn ltxTx(ltx);
-                txResults.push_back(
-                    tx->processFeeSeqNum(ltxTx, txSet.getTxBaseFee(tx)));
+                if (parallel)
+                {
+                    txResults.push_back(std::move(parallelResults[index]));
+                    if (ledgerCloseMeta)
+                    {
+                        ledgerCloseMeta->pushTxFeeProcessing(
+                            parallelChanges[index]);
+                    }
+                }
+                else
+                {
+                    LedgerTxn ltxTx(ltx);
+                    txResults.push_back(
+                        tx->processFeeSeqNum(ltxTx, txSet.getTxBaseFee(tx)));
+                    if (ledgerCloseMeta)
+                    {
+                        ledgerCloseMeta->pushTxFeeProcessing(
+                            ltxTx.getChanges());
+                    }
+                    ltxTx.commit();
+                }
 #ifdef BUILD_TESTS
                 if (expectedResultsIter)
                 {
@@ -2125,9 +2552,8 @@ LedgerManagerImpl::processFeesSeqNums(
                 }
 #endif // BUILD_TESTS
 
-                if (protocolVersionStartsFrom(
-                        ltxTx.loadHeader().current().ledgerVersion,
-                        ProtocolVersion::V_19))
+                if (protocolVersionStartsFrom(header.ledgerVersion,
+                                              ProtocolVersion::V_19))
                 {
                     auto res =
                         accToMaxSeq.emplace(tx->getSourceID(), tx->getSeqNum());
@@ -2142,13 +2568,7 @@ LedgerManagerImpl::processFeesSeqNums(
                         mergeSeen = true;
                     }
                 }
-
-                if (ledgerCloseMeta)
-                {
-                    ledgerCloseMeta->pushTxFeeProcessing(ltxTx.getChanges());
-                }
                 ++index;
-                ltxTx.commit();
             }
         }
         if (protocolVersionStartsFrom(ltx.loadHeader().current().ledgerVersion,
@@ -2220,15 +2640,21 @@ LedgerManagerImpl::prefetchTransactionData(AbstractLedgerTxnParent& ltx,
     ZoneScoped;
     if (config.PREFETCH_BATCH_SIZE > 0 && !config.allBucketsInMemory())
     {
-        UnorderedSet<LedgerKey> keysToPreFetch;
-        for (auto const& phase : txSet.getPhases())
+        // Keys are queued in apply order, so the first transactions can
+        // apply while the keys of later ones are still loading
+        std::vector<LedgerKey> keysToPreFetch;
+        UnorderedSet<LedgerKey> txKeys;
+        for (auto const& phase : txSet.getPhasesInApplyOrder())
         {
             for (auto const& tx : phase)
             {
-                tx->insertKeysForTxApply(keysToPreFetch);
+                txKeys.clear();
+                tx->insertKeysForTxApply(txKeys);
+                keysToPreFetch.insert(keysToPreFetch.end(), txKeys.begin(),
+                                      txKeys.end());
             }
         }
-        ltx.prefetch(keysToPreFetch);
+        ltx.prefetchInBackground(keysToPreFetch);
     }
 }
 
@@ -2240,6 +2666,7 @@ LedgerManagerImpl::applyThread(
     SorobanNetworkConfig const& sorobanConfig, ParallelLedgerInfo ledgerInfo,
     Hash sorobanBasePrngSeed)
 {
+    LedgerCloseTimeline::Span span(mCloseTimeline, "soroban cluster");
     for (auto const& txBundle : cluster)
     {
         // Apply timer
@@ -2285,31 +2712,65 @@ LedgerManagerImpl::applySorobanStageClustersInParallel(
     ParallelLedgerInfo const& ledgerInfo)
 {
 
+    auto const numClusters = stage.numClusters();
     std::vector<std::unique_ptr<ThreadParallelApplyLedgerState>> threadStates;
-    std::vector<std::future<std::unique_ptr<ThreadParallelApplyLedgerState>>>
-        threadFutures;
-
-    auto liveSnapshot = app.copySearchableLiveBucketListSnapshot();
-
-    for (size_t i = 0; i < stage.numClusters(); ++i)
+    for (size_t i = 0; i < numClusters; ++i)
     {
-        auto const& cluster = stage.getCluster(i);
-        auto threadStatePtr = std::make_unique<ThreadParallelApplyLedgerState>(
-            app, globalState, cluster);
-        threadFutures.emplace_back(std::async(
-            std::launch::async, &LedgerManagerImpl::applyThread, this,
-            std::ref(app), std::move(threadStatePtr), std::cref(cluster),
-            std::cref(config), std::cref(sorobanConfig), ledgerInfo,
-            sorobanBasePrngSeed));
+        threadStates.emplace_back(
+            std::make_unique<ThreadParallelApplyLedgerState>(
+                app, globalState, stage.getCluster(i)));
     }
 
-    for (auto& threadFuture : threadFutures)
-    {
-        releaseAssert(threadFuture.valid());
-        auto futureResult = threadFuture.get();
-        threadStates.emplace_back(std::move(futureResult));
+    // Clusters are handed out to the apply threads largest first, so the
+    // longest ones start right away and the short ones fill in around them.
+    // Transactions within a cluster depend on each other and share one thread
+    // state, so a cluster always runs on a single thread.
+    std::vector<size_t> order(numClusters);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return stage.getCluster(a).size() > stage.getCluster(b).size();
+    });
+
+    if (!mParallelApplyThreadPool)
+    {
+        mParallelApplyThreadPool = std::make_unique<ParallelApplyThreadPool>(
+            config.SOROBAN_APPLY_PIN_THREADS);
+    }
+    // Each stage uses as many threads as it has clusters, up to the core
+    // budget of this node
+    size_t threadBudget = config.SOROBAN_APPLY_THREADS;
+    if (threadBudget == 0)
+    {
+        threadBudget = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t const numThreads = std::min<size_t>(numClusters, threadBudget);
+    auto& metrics = mApplyState.getMetrics();
+    auto start = ParallelApplyThreadPool::Clock::now();
+    auto busyTimes = mParallelApplyThreadPool->run(
+        numClusters, numThreads, [&](size_t task) {
+            auto i = order[task];
+            auto clusterStart = ParallelApplyThreadPool::Clock::now();
+            auto cpuStart = currentThreadCPUTime();
+            threadStates[i] = applyThread(
+                app, std::move(threadStates[i]), stage.getCluster(i), config,
+                sorobanConfig, ledgerInfo, sorobanBasePrngSeed);
+            // CPU time well below wall time means the cluster waited, on
+            // I/O, locks or a busy core
+            metrics.mSorobanClusterWallTime.Update(
+                ParallelApplyThreadPool::Clock::now() - clusterStart);
+            metrics.mSorobanClusterCPUTime.Update(currentThreadCPUTime() -
+                                                  cpuStart);
+        });
+    auto elapsed = ParallelApplyThreadPool::Clock::now() - start;
+
+    if (elapsed.count() > 0)
+    {
+        for (auto const& busy : busyTimes)
+        {
+            metrics.mSorobanThreadUtilization.Update(
+                100 * busy.count() / elapsed.count());
+        }
     }
-    threadFutures.clear();
     return threadStates;
 }
 
@@ -2385,11 +2846,14 @@ LedgerManagerImpl::applySorobanStages(AppConnector& app, AbstractLedgerTxn& ltx,
     // LedgerTxn is not passed into applySorobanStage, so there's no risk
     // of the header being updated while we apply the stages.
     auto const& header = ltx.loadHeader().current();
-    for (auto const& stage : stages)
+    for (size_t i = 0; i < stages.size(); ++i)
     {
-        applySorobanStage(app, header, globalParState, stage,
+        LedgerCloseTimeline::Span span(mCloseTimeline,
+                                       "soroban stage " + std::to_string(i));
+        applySorobanStage(app, header, globalParState, stages[i],
                           sorobanBasePrngSeed);
     }
+    LedgerCloseTimeline::Span span(mCloseTimeline, "soroban commit");
     globalParState.commitChangesToLedgerTxn(ltx);
 }
 
@@ -2400,7 +2864,10 @@ LedgerManagerImpl::processResultAndMeta(
     TransactionFrameBase const& tx, MutableTransactionResultBase const& result,
     TransactionResultSet& txResultSet)
 {
-    TransactionResultPair resultPair;
+    // Gather the TransactionResultPair into the TxResultSet for hashing into
+    // the ledger header, building it in place. It is only copied when meta
+    // is emitted.
+    auto& resultPair = txResultSet.results.emplace_back();
     resultPair.transactionHash = tx.getContentsHash();
     resultPair.result = result.getXDR();
 
@@ -2421,10 +2888,6 @@ LedgerManagerImpl::processResultAndMeta(
         mApplyState.getMetrics().mTransactionApplyFailed.inc();
     }
 
-    // First gather the TransactionResultPair into the TxResultSet
-    // for hashing into the ledger header.
-    txResultSet.results.emplace_back(resultPair);
-
     if (ledgerCloseMeta)
     {
         auto metaXDR = txMetaBuilder.finalize(result.isSuccess());
@@ -2433,7 +2896,7 @@ LedgerManagerImpl::processResultAndMeta(
 #endif
 
         ledgerCloseMeta->setTxProcessingMetaAndResultPair(
-            std::move(metaXDR), std::move(resultPair), txIndex);
+            std::move(metaXDR), TransactionResultPair(resultPair), txIndex);
     }
     else
     {
@@ -2473,7 +2936,6 @@ LedgerManagerImpl::applyTransactions(
     TransactionResultSet txResultSet;
     txResultSet.results.reserve(numTxs);
 
-    prefetchTransactionData(mApp.getLedgerTxnRoot(), txSet, mApp.getConfig());
     auto phases = txSet.getPhasesInApplyOrder();
 
     Hash sorobanBasePrngSeed = txSet.getContentsHash();
@@ -2583,7 +3045,17 @@ LedgerManagerImpl::applySequentialPhase(
     std::unique_ptr<LedgerCloseMetaFrame> const& ledgerCloseMeta,
     TransactionResultSet& txResultSet)
 {
-    for (auto const& tx : phase)
+    std::vector<TransactionFrameBasePtr> txs(phase.begin(), phase.end());
+    std::optional<SignaturePreverifier> preverifier;
+    auto const preverifyThreads =
+        mApp.getConfig().CLASSIC_SIGNATURE_PREVERIFY_THREADS;
+    if (preverifyThreads > 0 && txs.size() > 1)
+    {
+        preverifier.emplace(txs, std::min<size_t>(preverifyThreads,
+                                                  txs.size() - 1));
+    }
+
+    for (auto const& tx : txs)
     {
         ZoneNamedN(txZone, "applyTransaction", true);
         auto& mutableTxResult = *mutableTxResults.at(index);
@@ -2702,8 +3174,6 @@ LedgerManagerImpl::storePersistentStateAndLedgerHeaderInDB(
     Hash hash = xdrSha256(header);
     releaseAssert(!isZero(hash));
     auto& sess = mApp.getLedgerTxnRoot().getSession();
-    mApp.getPersistentState().setState(PersistentState::kLastClosedLedger,
-                                       binToHex(hash), sess);
 
     if (mApp.getConfig().ARTIFICIALLY_DELAY_LEDGER_CLOSE_FOR_TESTING.count() >
         0)
@@ -2731,8 +3201,11 @@ LedgerManagerImpl::storePersistentStateAndLedgerHeaderInDB(
                                   mApp.getConfig().NETWORK_PASSPHRASE);
     }
 
-    mApp.getPersistentState().setState(PersistentState::kHistoryArchiveState,
-                                       has.toString(), sess);
+    // Both states go in one statement, saving a round trip per ledger
+    mApp.getPersistentState().setStates(
+        {{PersistentState::kLastClosedLedger, binToHex(hash)},
+         {PersistentState::kHistoryArchiveState, has.toString()}},
+        sess);
     LedgerHeaderUtils::storeInDatabase(mApp.getDatabase(), header, sess);
     if (appendToCheckpoint)
     {
@@ -2770,6 +3243,8 @@ LedgerManagerImpl::sealLedgerTxnAndTransferEntriesToBucketList(
                     ltxEvictions, lh.ledgerSeq, keys, initialLedgerVers,
                     mApplyState.getSorobanNetworkConfigForCommit());
 
+            mApplyState.checkEvictedState(lh.ledgerSeq, evictedState);
+
             if (protocolVersionStartsFrom(
                     initialLedgerVers,
                     LiveBucket::FIRST_PROTOCOL_SUPPORTING_PERSISTENT_EVICTION))
@@ -2886,6 +3361,33 @@ LedgerManagerImpl::sealLedgerTxnAndStoreInBucketsAndDB(
     return res;
 }
 
+void
+LedgerManagerImpl::ApplyState::checkEvictedState(
+    uint32_t ledgerSeq, EvictedStateVectors const& evictedState) const
+{
+    ZoneScoped;
+    assertCommittingPhase();
+    if (!mInMemorySorobanState.hasTTLIndex())
+    {
+        return;
+    }
+
+    // Evicted TTLs are stored with their entries
+    std::vector<LedgerKey> keys;
+    for (auto const& key : evictedState.deletedKeys)
+    {
+        if (key.type() != TTL)
+        {
+            keys.emplace_back(key);
+        }
+    }
+    for (auto const& entry : evictedState.archivedEntries)
+    {
+        keys.emplace_back(LedgerEntryKey(entry));
+    }
+    mInMemorySorobanState.checkEvictedEntries(keys, ledgerSeq);
+}
+
 void
 LedgerManagerImpl::ApplyState::evictFromModuleCache(
     uint32_t ledgerVersion, EvictedStateVectors const& evictedState)
@@ -2918,6 +3420,11 @@ LedgerManagerImpl::ApplyState::evictFromModuleCache(
             ::rust::Slice<uint8_t const> slice{hash.data(), hash.size()};
             mModuleCache->evict_contract_code(slice);
             getMetrics().mSorobanMetrics.mModuleCacheNumEntries.dec();
+            if (mCompiler)
+            {
+                mPendingModuleCacheChanges.push_back(
+                    {ledgerVersion, hash, {}});
+            }
         }
     }
 }
@@ -2947,6 +3454,10 @@ LedgerManagerImpl::ApplyState::addAnyContractsToModuleCache(
                         getMetrics()
                             .mSorobanMetrics.mModuleCompilationTime.TimeScope();
                     mModuleCache->compile(v, slice);
+                    if (mCompiler)
+                    {
+                        mPendingModuleCacheChanges.push_back({v, {}, wasm});
+                    }
                 }
             }
         }
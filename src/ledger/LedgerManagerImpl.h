@@ -6,10 +6,14 @@
 #include "util/asio.h"
 
 #include "history/HistoryManager.h"
+#include "ledger/DebugMetaWriter.h"
 #include "ledger/InMemorySorobanState.h"
 #include "ledger/LedgerCloseMetaFrame.h"
+#include "ledger/LedgerCloseTimeline.h"
 #include "ledger/LedgerManager.h"
+#include "ledger/MetaStreamWriter.h"
 #include "ledger/NetworkConfig.h"
+#include "ledger/ParallelApplyThreadPool.h"
 #include "ledger/SharedModuleCacheCompiler.h"
 #include "ledger/SorobanMetrics.h"
 #include "main/ApplicationImpl.h"
@@ -43,6 +47,7 @@ namespace stellar
 class AbstractLedgerTxn;
 class Application;
 class Database;
+class HdrMetricsRegistry;
 class LedgerTxnHeader;
 class BasicWork;
 class ParallelLedgerInfo;
@@ -59,8 +64,9 @@ class LedgerManagerImpl : public LedgerManager
   protected:
     Application& mApp;
     std::unique_ptr<XDROutputFileStream> mMetaStream;
-    std::unique_ptr<XDROutputFileStream> mMetaDebugStream;
-    std::weak_ptr<BasicWork> mFlushAndRotateMetaDebugWork;
+    // Writes METADATA_DEBUG_LEDGERS segments, mMetaDebugPath is that of the
+    // current one if any
+    std::unique_ptr<DebugMetaWriter> mMetaDebugWriter;
     std::filesystem::path mMetaDebugPath;
 
   private:
@@ -78,9 +84,11 @@ class LedgerManagerImpl : public LedgerManager
         medida::Counter& mTransactionApplyFailed;
         medida::Counter& mSorobanTransactionApplySucceeded;
         medida::Counter& mSorobanTransactionApplyFailed;
-        medida::Meter& mMetaStreamBytes;
-        medida::Timer& mMetaStreamWriteTime;
-        LedgerApplyMetrics(medida::MetricsRegistry& registry);
+        medida::Histogram& mSorobanThreadUtilization;
+        medida::Timer& mSorobanClusterWallTime;
+        medida::Timer& mSorobanClusterCPUTime;
+        LedgerApplyMetrics(medida::MetricsRegistry& registry,
+                           HdrMetricsRegistry& hdrRegistry);
     };
 
     // LedgerManager thread model is as follows. There is a "primary apply
@@ -95,8 +103,9 @@ class LedgerManagerImpl : public LedgerManager
     // only execute transactions based on read-only state snapshots and never
     // commit changes. Soroban thread changes are accumulated and applied by the
     // primary apply thread. The primary apply thread is long lasting between
-    // ledgers. Soroban threads are short lived, spawned during ledger
-    // application and joined before committing state and advancing the ledger
+    // ledgers. Soroban threads belong to a pool that also lives across ledgers;
+    // they are handed the clusters of each stage and are done with them
+    // before the primary apply thread commits state and advances the ledger
     // header.
     //
     // ApplyState is the encapsulation used to store any state needed by the
@@ -169,12 +178,32 @@ class LedgerManagerImpl : public LedgerManager
         // progress.
         std::unique_ptr<SharedModuleCacheCompiler> mCompiler;
 
+        // A contract compiled into, or evicted from, mModuleCache while
+        // mCompiler is running. The compiler builds its cache from an older
+        // snapshot, so these are replayed onto that cache, in order, before it
+        // replaces mModuleCache. mWasm is empty for evictions.
+        struct ModuleCacheChange
+        {
+            uint32_t mLedgerVersion;
+            Hash mHash;
+            xdr::xvector<uint8_t> mWasm;
+        };
+        std::vector<ModuleCacheChange> mPendingModuleCacheChanges;
+
         // Protocol versions to compile each contract for in the module cache.
         std::vector<uint32_t> mModuleCacheProtocols;
 
         // Number of threads to use for compilation (cached from config).
         size_t const mNumCompilationThreads;
 
+        // Number of threads to load mInMemorySorobanState on (cached from
+        // config).
+        uint32_t const mNumSorobanStateLoadThreads;
+
+        // NUMA node whose memory mInMemorySorobanState and the module cache
+        // are built in (cached from config).
+        std::optional<uint32_t> const mNumaNode;
+
         // In-memory map of live Soroban state for the current ledger.
         InMemorySorobanState mInMemorySorobanState;
 
@@ -251,10 +280,10 @@ class LedgerManagerImpl : public LedgerManager
         // Finishes a compilation started by `startCompilingAllContracts`.
         void finishPendingCompilation();
 
-        // Equivalent to calling `startCompilingAllContracts` followed by
-        // `finishPendingCompilation`.
-        void compileAllContractsInLedger(SearchableSnapshotConstPtr snap,
-                                         uint32_t minLedgerVersion);
+        // Finishes a pending compilation if it's done, without blocking.
+        // Until then mModuleCache, which holds the same set of contracts, stays
+        // in use.
+        void maybeFinishPendingCompilation();
 
         // Estimates the size of the arena underlying the module cache's shared
         // wasmi engine, from metrics, and rebuilds if it has likely built up a
@@ -268,6 +297,11 @@ class LedgerManagerImpl : public LedgerManager
         void evictFromModuleCache(uint32_t ledgerVersion,
                                   EvictedStateVectors const& evictedState);
 
+        // If the in-memory Soroban state has a TTL index, throws unless every
+        // entry in evictedState is expired at ledgerSeq according to it.
+        void checkEvictedState(uint32_t ledgerSeq,
+                               EvictedStateVectors const& evictedState) const;
+
         // Adds all contracts in the provided set of LEs to the module cache.
         // This should be called as entries are added to the live bucketlist.
         void addAnyContractsToModuleCache(uint32_t ledgerVersion,
@@ -278,6 +312,16 @@ class LedgerManagerImpl : public LedgerManager
         void populateInMemorySorobanState(SearchableSnapshotConstPtr snap,
                                           uint32_t ledgerVersion);
 
+        // Compiles all contracts in the ledger and populates the in-memory
+        // Soroban state. Both read the whole BucketList, so contracts are
+        // compiled on auxiliary threads while the in-memory state is populated
+        // from snap on this one. Bucket snapshots can't be read from several
+        // threads at once, so the compilation reads compileSnap, a separate
+        // copy of the same state.
+        void compileAndPopulateSorobanState(
+            SearchableSnapshotConstPtr snap,
+            SearchableSnapshotConstPtr compileSnap, uint32_t ledgerVersion);
+
         void handleUpgradeAffectingSorobanInMemoryStateSize(
             AbstractLedgerTxn& upgradeLtx);
 
@@ -317,16 +361,40 @@ class LedgerManagerImpl : public LedgerManager
 
     medida::Timer& mCatchupDuration;
 
+    // Per-phase timings of the last few ledgers applied, served by the
+    // `ledgertimeline` HTTP command
+    LedgerCloseTimeline mCloseTimeline;
+
+    // Runs the clusters of parallel Soroban apply stages. Created on first use
+    // and only used by the primary apply thread.
+    std::unique_ptr<ParallelApplyThreadPool> mParallelApplyThreadPool;
+
     std::unique_ptr<LedgerCloseMetaFrame> mNextMetaToEmit;
 
+    // Writes meta to mMetaStream on a dedicated thread. Only non-nullptr while
+    // streaming to METADATA_OUTPUT_STREAM. With
+    // EXPERIMENTAL_PIPELINED_LEDGER_COMMIT the write of the last closed ledger
+    // may still be running while the next ledger applies.
+    std::unique_ptr<MetaStreamWriter> mMetaStreamWriter;
+
     // Use in the context of parallel ledger apply to indicate background thread
     // is currently closing a ledger or has ledgers queued to apply.
     bool mCurrentlyApplyingLedger{false};
 
+    // See setReplayBatching. Only accessed from the main thread.
+    bool mReplayBatching{false};
+    bool mPostApplyWorkDeferred{false};
+
+    // Starts any queued history publishes and forgets the buckets the last
+    // closed ledger no longer references.
+    void publishHistoryAndForgetBuckets();
+
+    // Charges fees for every transaction in txSet. With numThreads > 1, large
+    // transaction sets are charged in parallel, grouped by fee source.
     static std::vector<MutableTxResultPtr> processFeesSeqNums(
         ApplicableTxSetFrame const& txSet, AbstractLedgerTxn& ltxOuter,
         std::unique_ptr<LedgerCloseMetaFrame> const& ledgerCloseMeta,
-        LedgerCloseData const& ledgerData);
+        LedgerCloseData const& ledgerData, uint32_t numThreads);
 
     void processResultAndMeta(
         std::unique_ptr<LedgerCloseMetaFrame> const& ledgerCloseMeta,
@@ -493,6 +561,8 @@ class LedgerManagerImpl : public LedgerManager
     uint32_t getLastClosedLedgerNum() const override;
     SorobanNetworkConfig const&
     getLastClosedSorobanNetworkConfig() const override;
+    std::shared_ptr<SorobanNetworkConfig const>
+    getLastClosedSorobanNetworkConfigPtr() const override;
     SorobanNetworkConfig const& getSorobanNetworkConfigForApply() override;
 
     bool hasLastClosedSorobanNetworkConfig() const override;
@@ -514,6 +584,8 @@ class LedgerManagerImpl : public LedgerManager
     getModuleCacheForTesting() override;
     void rebuildInMemorySorobanStateForTesting(uint32_t ledgerVersion) override;
     uint64_t getSorobanInMemoryStateSizeForTesting() override;
+    // Waits for the debug meta queued so far to be written
+    void drainMetaDebugForTesting();
 #endif
 
     uint64_t secondsSinceLastLedgerClose() const override;
@@ -542,6 +614,7 @@ class LedgerManagerImpl : public LedgerManager
     void ledgerCloseComplete(uint32_t lcl, bool calledViaExternalize,
                              LedgerCloseData const& ledgerData,
                              bool queueRebuildNeeded);
+    void setReplayBatching(bool batching) override;
     void
     setLastClosedLedger(LedgerHeaderHistoryEntry const& lastClosed) override;
 
@@ -551,6 +624,7 @@ class LedgerManagerImpl : public LedgerManager
     void maybeResetLedgerCloseMetaDebugStream(uint32_t ledgerSeq);
 
     SorobanMetrics& getSorobanMetrics() override;
+    LedgerCloseTimeline const& getCloseTimeline() const override;
     SearchableSnapshotConstPtr getLastClosedSnapshot() const override;
     virtual bool
     isApplying() const override
@@ -287,14 +287,15 @@ CompleteConstLedgerState::checkInvariant() const
 
 CompleteConstLedgerState::CompleteConstLedgerState(
     SearchableSnapshotConstPtr searchableSnapshot,
-    SorobanNetworkConfig const& sorobanConfig,
+    std::shared_ptr<SorobanNetworkConfig const> sorobanConfig,
     LedgerHeaderHistoryEntry const& lastClosedLedgerHeader,
     HistoryArchiveState const& lastClosedHistoryArchiveState)
     : mBucketSnapshot(searchableSnapshot)
-    , mSorobanConfig(sorobanConfig)
+    , mSorobanConfig(std::move(sorobanConfig))
     , mLastClosedLedgerHeader(lastClosedLedgerHeader)
     , mLastClosedHistoryArchiveState(lastClosedHistoryArchiveState)
 {
+    releaseAssert(mSorobanConfig);
     checkInvariant();
 }
 
@@ -318,13 +319,21 @@ CompleteConstLedgerState::getBucketSnapshot() const
 SorobanNetworkConfig const&
 CompleteConstLedgerState::getSorobanConfig() const
 {
-    return mSorobanConfig.value();
+    releaseAssert(mSorobanConfig);
+    return *mSorobanConfig;
+}
+
+std::shared_ptr<SorobanNetworkConfig const>
+CompleteConstLedgerState::getSorobanConfigPtr() const
+{
+    releaseAssert(mSorobanConfig);
+    return mSorobanConfig;
 }
 
 bool
 CompleteConstLedgerState::hasSorobanConfig() const
 {
-    return mSorobanConfig.has_value();
+    return static_cast<bool>(mSorobanConfig);
 }
 
 LedgerHeaderHistoryEntry const&
@@ -190,12 +190,14 @@ class LedgerSnapshot : public NonMovableOrCopyable
 // All member objects are immutable. Getters return const references;
 // however, these references should not be assumed to have long lifetimes.
 // A new ledger closure may cause LedgerManager to replace the current
-// CompleteConstLedgerState instance.
+// CompleteConstLedgerState instance. The Soroban config is shared rather than
+// copied, callers that need it past the next ledger close should hold on to
+// getSorobanConfigPtr() instead.
 class CompleteConstLedgerState : public NonMovableOrCopyable
 {
   private:
     SearchableSnapshotConstPtr const mBucketSnapshot;
-    std::optional<SorobanNetworkConfig const> const mSorobanConfig;
+    std::shared_ptr<SorobanNetworkConfig const> const mSorobanConfig;
     LedgerHeaderHistoryEntry const mLastClosedLedgerHeader;
     HistoryArchiveState const mLastClosedHistoryArchiveState;
 
@@ -204,7 +206,7 @@ class CompleteConstLedgerState : public NonMovableOrCopyable
   public:
     CompleteConstLedgerState(
         SearchableSnapshotConstPtr searchableSnapshot,
-        SorobanNetworkConfig const& sorobanConfig,
+        std::shared_ptr<SorobanNetworkConfig const> sorobanConfig,
         LedgerHeaderHistoryEntry const& lastClosedLedgerHeader,
         HistoryArchiveState const& lastClosedHistoryArchiveState);
     CompleteConstLedgerState(
@@ -214,6 +216,7 @@ class CompleteConstLedgerState : public NonMovableOrCopyable
 
     SearchableSnapshotConstPtr getBucketSnapshot() const;
     SorobanNetworkConfig const& getSorobanConfig() const;
+    std::shared_ptr<SorobanNetworkConfig const> getSorobanConfigPtr() const;
     bool hasSorobanConfig() const;
     LedgerHeaderHistoryEntry const& getLastClosedLedgerHeader() const;
     HistoryArchiveState const& getLastClosedHistoryArchiveState() const;
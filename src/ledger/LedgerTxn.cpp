@@ -15,8 +15,12 @@
 #include "ledger/LedgerTxnImpl.h"
 #include "ledger/LedgerTypeUtils.h"
 #include "main/Application.h"
+#include "medida/meter.h"
+#include "medida/metrics_registry.h"
 #include "transactions/TransactionUtils.h"
 #include "util/GlobalChecks.h"
+#include "util/MemoryAccounting.h"
+#include "util/PoolAllocator.h"
 #include "util/UnorderedSet.h"
 #include "util/types.h"
 #include "xdr/Stellar-ledger-entries.h"
@@ -24,6 +28,7 @@
 #include <soci.h>
 
 #include <algorithm>
+#include <chrono>
 #include <stdexcept>
 
 namespace stellar
@@ -540,6 +545,7 @@ LedgerTxn::Impl::throwIfErasingConfig(InternalLedgerKey const& key) const
 void
 LedgerTxn::commit() noexcept
 {
+    MEMORY_ACCOUNTING_SCOPE(LEDGER_TXN);
     getImpl()->commit();
     mImpl.reset();
 }
@@ -560,7 +566,17 @@ LedgerTxn::commitChild(EntryIterator iter,
                        RestoredEntries const& restoredEntries,
                        LedgerTxnConsistency cons) noexcept
 {
-    getImpl()->commitChild(std::move(iter), restoredEntries, cons);
+    getImpl()->commitChild(std::move(iter), restoredEntries, cons,
+                           /* mayAdopt */ true);
+}
+
+void
+LedgerTxn::commitChildSubset(EntryIterator iter,
+                             RestoredEntries const& restoredEntries,
+                             LedgerTxnConsistency cons) noexcept
+{
+    getImpl()->commitChild(std::move(iter), restoredEntries, cons,
+                           /* mayAdopt */ false);
 }
 
 static LedgerTxnConsistency
@@ -580,7 +596,7 @@ joinConsistencyLevels(LedgerTxnConsistency c1, LedgerTxnConsistency c2)
 void
 LedgerTxn::Impl::commitChild(EntryIterator iter,
                              RestoredEntries const& restoredEntries,
-                             LedgerTxnConsistency cons) noexcept
+                             LedgerTxnConsistency cons, bool mayAdopt) noexcept
 {
     // Assignment of xdrpp objects does not have the strong exception safety
     // guarantee, so use std::unique_ptr<...>::swap to achieve it
@@ -595,10 +611,22 @@ LedgerTxn::Impl::commitChild(EntryIterator iter,
     }
     try
     {
-        for (; (bool)iter; ++iter)
+        // Children are discarded once committed, so when this LedgerTxn has
+        // recorded nothing (as a transaction's has when its first operation
+        // commits) the child's whole entry map can be taken over instead.
+        auto childLtx = mayAdopt ? dynamic_cast<LedgerTxn*>(mChild) : nullptr;
+        if (childLtx && mEntry.empty())
         {
-            updateEntry(iter.key(), /* keyHint */ nullptr, iter.entryPtr(),
-                        /* effectiveActive */ false);
+            adoptChildEntries(*childLtx->getImpl());
+        }
+        else
+        {
+            for (; (bool)iter; ++iter)
+            {
+                updateEntry(iter.key(), /* keyHint */ nullptr,
+                            iter.entryPtr(),
+                            /* effectiveActive */ false);
+            }
         }
 
         // We will show that the following update procedure leaves the self
@@ -698,6 +726,7 @@ LedgerTxn::Impl::commitChild(EntryIterator iter,
 LedgerTxnEntry
 LedgerTxn::create(InternalLedgerEntry const& entry)
 {
+    MEMORY_ACCOUNTING_SCOPE(LEDGER_TXN);
     return getImpl()->create(*this, entry);
 }
 
@@ -713,7 +742,7 @@ LedgerTxn::Impl::create(LedgerTxn& self, InternalLedgerEntry const& entry)
         throw std::runtime_error("Key already exists");
     }
 
-    auto current = std::make_shared<InternalLedgerEntry>(entry);
+    auto current = makePooledShared<InternalLedgerEntry>(entry);
     auto impl = LedgerTxnEntry::makeSharedImpl(self, *current);
 
     // Set the key to active before constructing the LedgerTxnEntry, as this
@@ -737,6 +766,7 @@ LedgerTxn::Impl::create(LedgerTxn& self, InternalLedgerEntry const& entry)
 void
 LedgerTxn::createWithoutLoading(InternalLedgerEntry const& entry)
 {
+    MEMORY_ACCOUNTING_SCOPE(LEDGER_TXN);
     getImpl()->createWithoutLoading(entry);
 }
 
@@ -759,13 +789,14 @@ LedgerTxn::Impl::createWithoutLoading(InternalLedgerEntry const& entry)
     // INIT instead, the key would've been annihilated.
     updateEntry(
         key, /* keyHint */ nullptr,
-        LedgerEntryPtr::Init(std::make_shared<InternalLedgerEntry>(entry)),
+        LedgerEntryPtr::Init(makePooledShared<InternalLedgerEntry>(entry)),
         /* effectiveActive */ false);
 }
 
 void
 LedgerTxn::updateWithoutLoading(InternalLedgerEntry const& entry)
 {
+    MEMORY_ACCOUNTING_SCOPE(LEDGER_TXN);
     getImpl()->updateWithoutLoading(entry);
 }
 
@@ -784,7 +815,7 @@ LedgerTxn::Impl::updateWithoutLoading(InternalLedgerEntry const& entry)
 
     updateEntry(
         key, /* keyHint */ nullptr,
-        LedgerEntryPtr::Live(std::make_shared<InternalLedgerEntry>(entry)),
+        LedgerEntryPtr::Live(makePooledShared<InternalLedgerEntry>(entry)),
         /* effectiveActive */ false);
 }
 
@@ -829,6 +860,7 @@ LedgerTxn::Impl::deactivateHeader()
 void
 LedgerTxn::erase(InternalLedgerKey const& key)
 {
+    MEMORY_ACCOUNTING_SCOPE(LEDGER_TXN);
     getImpl()->erase(key);
 }
 
@@ -864,6 +896,7 @@ void
 LedgerTxn::markRestoredFromHotArchive(LedgerEntry const& ledgerEntry,
                                       LedgerEntry const& ttlEntry)
 {
+    MEMORY_ACCOUNTING_SCOPE(LEDGER_TXN);
     getImpl()->markRestoredFromHotArchive(ledgerEntry, ttlEntry);
 }
 
@@ -895,6 +928,7 @@ LedgerTxn::Impl::markRestoredFromHotArchive(LedgerEntry const& ledgerEntry,
 LedgerTxnEntry
 LedgerTxn::restoreFromLiveBucketList(LedgerEntry const& entry, uint32_t ttl)
 {
+    MEMORY_ACCOUNTING_SCOPE(LEDGER_TXN);
     return getImpl()->restoreFromLiveBucketList(*this, entry, ttl);
 }
 
@@ -944,6 +978,7 @@ LedgerTxn::Impl::restoreFromLiveBucketList(LedgerTxn& self,
 void
 LedgerTxn::eraseWithoutLoading(InternalLedgerKey const& key)
 {
+    MEMORY_ACCOUNTING_SCOPE(LEDGER_TXN);
     getImpl()->eraseWithoutLoading(key);
 }
 
@@ -1071,18 +1106,18 @@ LedgerTxn::Impl::getBestOfferSlow(Asset const& buying, Asset const& selling,
         mParent.getBestOfferSlow(buying, selling, worseThan, exclude);
     if (selfBest && !parentBest)
     {
-        return std::make_shared<LedgerEntry const>(selfBest->ledgerEntry());
+        return makePooledShared<LedgerEntry const>(selfBest->ledgerEntry());
     }
     else if (parentBest && !selfBest)
     {
-        return std::make_shared<LedgerEntry const>(*parentBest);
+        return makePooledShared<LedgerEntry const>(*parentBest);
     }
     else if (parentBest && selfBest)
     {
         return isBetterOffer(selfBest->ledgerEntry(), *parentBest)
-                   ? std::make_shared<LedgerEntry const>(
+                   ? makePooledShared<LedgerEntry const>(
                          selfBest->ledgerEntry())
-                   : std::make_shared<LedgerEntry const>(*parentBest);
+                   : makePooledShared<LedgerEntry const>(*parentBest);
     }
     return nullptr;
 }
@@ -1137,7 +1172,7 @@ LedgerTxn::Impl::getBestOffer(Asset const& buying, Asset const& selling)
             {
                 throw std::runtime_error("invalid order book state");
             }
-            selfBest = std::make_shared<LedgerEntry const>(
+            selfBest = makePooledShared<LedgerEntry const>(
                 entryIter->second->ledgerEntry());
         }
     }
@@ -1248,7 +1283,7 @@ LedgerTxn::Impl::getBestOffer(Asset const& buying, Asset const& selling,
             {
                 throw std::runtime_error("invalid order book state");
             }
-            selfBest = std::make_shared<LedgerEntry const>(
+            selfBest = makePooledShared<LedgerEntry const>(
                 entryIter->second->ledgerEntry());
         }
     }
@@ -1658,6 +1693,35 @@ LedgerTxn::Impl::getAllTTLKeysWithoutSealing() const
     return result;
 }
 
+bool
+LedgerTxn::hasConfigSettingChangesWithoutSealing() const
+{
+    return getImpl()->hasConfigSettingChangesWithoutSealing();
+}
+
+bool
+LedgerTxn::Impl::hasConfigSettingChangesWithoutSealing() const
+{
+    throwIfNotExactConsistency();
+    for (auto const& [k, v] : mEntry)
+    {
+        if (k.type() != InternalLedgerEntryType::LEDGER_ENTRY ||
+            k.ledgerKey().type() != CONFIG_SETTING)
+        {
+            continue;
+        }
+
+        // lastModifiedLedgerSeq is only updated on sealing, so an entry that
+        // was loaded but not modified is still equal to its parent's version
+        auto previous = mParent.getNewestVersion(k);
+        if (v.isDeleted() || !previous || !(*previous == *v.get()))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 std::shared_ptr<InternalLedgerEntry const>
 LedgerTxn::getNewestVersion(InternalLedgerKey const& key) const
 {
@@ -1812,6 +1876,7 @@ LedgerTxn::Impl::getPoolShareTrustLinesByAccountAndAsset(
 LedgerTxnEntry
 LedgerTxn::load(InternalLedgerKey const& key)
 {
+    MEMORY_ACCOUNTING_SCOPE(LEDGER_TXN);
     return getImpl()->load(*this, key);
 }
 
@@ -1839,7 +1904,7 @@ LedgerTxn::Impl::load(LedgerTxn& self, InternalLedgerKey const& key)
     else
     {
         currentEntryPtr = LedgerEntryPtr::Live(
-            std::make_shared<InternalLedgerEntry>(*newest.first));
+            makePooledShared<InternalLedgerEntry>(*newest.first));
     }
 
     releaseAssert(currentEntryPtr.has_value());
@@ -2084,6 +2149,7 @@ LedgerTxn::Impl::loadPoolShareTrustLinesByAccountAndAsset(
 ConstLedgerTxnEntry
 LedgerTxn::loadWithoutRecord(InternalLedgerKey const& key)
 {
+    MEMORY_ACCOUNTING_SCOPE(LEDGER_TXN);
     return getImpl()->loadWithoutRecord(*this, key);
 }
 
@@ -2227,6 +2293,7 @@ LedgerTxn::Impl::getPrefetchHitRate() const
 uint32_t
 LedgerTxn::prefetch(UnorderedSet<LedgerKey> const& keys)
 {
+    MEMORY_ACCOUNTING_SCOPE(LEDGER_TXN);
     return getImpl()->prefetch(keys);
 }
 
@@ -2236,6 +2303,19 @@ LedgerTxn::Impl::prefetch(UnorderedSet<LedgerKey> const& keys)
     return mParent.prefetch(keys);
 }
 
+void
+LedgerTxn::prefetchInBackground(std::vector<LedgerKey> const& keys)
+{
+    MEMORY_ACCOUNTING_SCOPE(LEDGER_TXN);
+    getImpl()->prefetchInBackground(keys);
+}
+
+void
+LedgerTxn::Impl::prefetchInBackground(std::vector<LedgerKey> const& keys)
+{
+    mParent.prefetchInBackground(keys);
+}
+
 void
 LedgerTxn::Impl::maybeUpdateLastModified() noexcept
 {
@@ -2351,6 +2431,32 @@ LedgerTxn::Impl::updateEntryIfRecorded(InternalLedgerKey const& key,
     }
 }
 
+void
+LedgerTxn::Impl::adoptChildEntries(Impl& child)
+{
+    // The result is the same as recording every child entry with updateEntry
+    // into an empty mEntry: each is inserted as is, and live offers enter the
+    // order book (which is empty, like mEntry), none of them being active.
+    mEntry.swap(child.mEntry);
+    mHasOfferEntries = child.mHasOfferEntries;
+    if (!mHasOfferEntries)
+    {
+        return;
+    }
+    for (auto const& kv : mEntry)
+    {
+        auto const& key = kv.first;
+        if (key.type() != InternalLedgerEntryType::LEDGER_ENTRY ||
+            key.ledgerKey().type() != OFFER || kv.second.isDeleted())
+        {
+            continue;
+        }
+        auto const& oe = kv.second->ledgerEntry().data.offer();
+        auto& ob = mMultiOrderBook[oe.buying][oe.selling];
+        ob.emplace(OfferDescriptor{oe.price, oe.offerID}, key.ledgerKey());
+    }
+}
+
 void
 LedgerTxn::Impl::updateEntry(InternalLedgerKey const& key,
                              EntryMap::iterator const* keyHint,
@@ -2400,6 +2506,8 @@ LedgerTxn::Impl::updateEntry(InternalLedgerKey const& key,
         return;
     }
 
+    mHasOfferEntries = true;
+
     // this iterator should not be used directly: use keyHint instead
     EntryMap::iterator localIterDoNotUse;
     if (!keyHint)
@@ -2605,6 +2713,7 @@ LedgerTxn::Impl::EntryIteratorImpl::clone() const
 
 // Implementation of LedgerTxnRoot ------------------------------------------
 size_t const LedgerTxnRoot::Impl::MIN_BEST_OFFERS_BATCH_SIZE = 5;
+size_t const LedgerTxnRoot::Impl::MAX_RETAINED_BEST_OFFERS = 100000;
 
 LedgerTxnRoot::LedgerTxnRoot(Application& app,
                              InMemorySorobanState const& inMemorySorobanState,
@@ -2645,6 +2754,21 @@ LedgerTxnRoot::Impl::Impl(Application& app,
     , mBestOfferDebuggingEnabled(bestOfferDebuggingEnabled)
 #endif
 {
+    for (auto t : xdr::xdr_traits<LedgerEntryType>::enum_values())
+    {
+        auto const& label = xdr::xdr_traits<LedgerEntryType>::enum_name(
+            static_cast<LedgerEntryType>(t));
+        size_t i = static_cast<size_t>(t);
+        if (i >= mEntryCacheHits.size())
+        {
+            mEntryCacheHits.resize(i + 1);
+            mEntryCacheMisses.resize(i + 1);
+        }
+        mEntryCacheHits[i] = &app.getMetrics().NewMeter(
+            {"ledger-entry-cache", label, "hit"}, "entry");
+        mEntryCacheMisses[i] = &app.getMetrics().NewMeter(
+            {"ledger-entry-cache", label, "miss"}, "entry");
+    }
 }
 
 LedgerTxnRoot::~LedgerTxnRoot()
@@ -2653,6 +2777,7 @@ LedgerTxnRoot::~LedgerTxnRoot()
 
 LedgerTxnRoot::Impl::~Impl()
 {
+    discardPendingPrefetches();
     if (mChild)
     {
         mChild->rollback();
@@ -2738,6 +2863,7 @@ LedgerTxnRoot::commitChild(EntryIterator iter,
                            RestoredEntries const& restoredEntries,
                            LedgerTxnConsistency cons) noexcept
 {
+    MEMORY_ACCOUNTING_SCOPE(LEDGER_TXN);
     mImpl->commitChild(std::move(iter), restoredEntries, cons);
 }
 
@@ -2814,11 +2940,36 @@ LedgerTxnRoot::Impl::commitChild(EntryIterator iter,
     auto childHeader = std::make_unique<LedgerHeader>(mChild->getHeader());
 
     auto bleca = BulkLedgerEntryChangeAccumulator();
+    std::vector<LedgerEntry> upsertedOffers;
+    UnorderedSet<int64_t> changedOfferIDs;
+    std::vector<std::pair<LedgerKey, std::shared_ptr<LedgerEntry const>>>
+        cachedChanges;
     [[maybe_unused]] int64_t counter{0};
     try
     {
         while ((bool)iter)
         {
+            auto const& key = iter.key();
+            if (key.type() == InternalLedgerEntryType::LEDGER_ENTRY &&
+                mEntryCache.exists(key.ledgerKey(), false))
+            {
+                cachedChanges.emplace_back(
+                    key.ledgerKey(),
+                    iter.entryExists()
+                        ? std::make_shared<LedgerEntry const>(
+                              iter.entry().ledgerEntry())
+                        : nullptr);
+            }
+            if (key.type() == InternalLedgerEntryType::LEDGER_ENTRY &&
+                key.ledgerKey().type() == OFFER)
+            {
+                changedOfferIDs.emplace(key.ledgerKey().offer().offerID);
+                if (iter.entryExists())
+                {
+                    upsertedOffers.emplace_back(iter.entry().ledgerEntry());
+                }
+            }
+
             if (bleca.accumulate(iter))
             {
                 ++counter;
@@ -2852,9 +3003,13 @@ LedgerTxnRoot::Impl::commitChild(EntryIterator iter,
             "unknown fatal error during commit to LedgerTxnRoot");
     }
 
-    // Clearing the cache does not throw
-    mBestOffers.clear();
-    mEntryCache.clear();
+    // Neither updating nor clearing the caches throws. Anything still being
+    // prefetched was loaded from the state before this commit.
+    updateBestOffersOnCommit(upsertedOffers, changedOfferIDs);
+    discardPendingPrefetches();
+    auto seq = childHeader->ledgerSeq;
+    bool keepCache = seq == mHeader->ledgerSeq || seq == mHeader->ledgerSeq + 1;
+    updateEntryCacheOnCommit(cachedChanges, keepCache);
 
     // std::unique_ptr<...>::reset does not throw
     mTransaction.reset();
@@ -2871,6 +3026,96 @@ LedgerTxnRoot::Impl::commitChild(EntryIterator iter,
     mSearchableBucketListSnapshot.reset();
 }
 
+void
+LedgerTxnRoot::Impl::updateEntryCacheOnCommit(
+    std::vector<std::pair<LedgerKey, std::shared_ptr<LedgerEntry const>>> const&
+        changes,
+    bool keep) noexcept
+{
+    ZoneScoped;
+    try
+    {
+        if (!keep)
+        {
+            mEntryCache.clear();
+            return;
+        }
+        for (auto const& [key, entry] : changes)
+        {
+            mEntryCache.put(key, {entry, LoadType::IMMEDIATE});
+        }
+    }
+    catch (...)
+    {
+        mEntryCache.clear();
+    }
+}
+
+void
+LedgerTxnRoot::Impl::updateBestOffersOnCommit(
+    std::vector<LedgerEntry> const& upsertedOffers,
+    UnorderedSet<int64_t> const& changedOfferIDs) noexcept
+{
+    ZoneScoped;
+    try
+    {
+        // Removing an offer keeps a cached list the best prefix of what's
+        // left, whether or not the offer was in it
+        size_t numCached = 0;
+        for (auto& [_, cached] : mBestOffers)
+        {
+            auto& offers = cached->bestOffers;
+            if (!changedOfferIDs.empty())
+            {
+                offers.erase(
+                    std::remove_if(offers.begin(), offers.end(),
+                                   [&](LedgerEntry const& le) {
+                                       return changedOfferIDs.count(
+                                                  le.data.offer().offerID) > 0;
+                                   }),
+                    offers.end());
+            }
+            numCached += offers.size();
+        }
+
+        if (mBestOffers.size() + numCached + upsertedOffers.size() >
+            MAX_RETAINED_BEST_OFFERS)
+        {
+            mBestOffers.clear();
+            return;
+        }
+
+        // An offer belongs in a cached list if it's better than the worst
+        // offer loaded so far, or if every offer for the pair is loaded.
+        // Otherwise it's picked up by a later load from the database.
+        for (auto const& le : upsertedOffers)
+        {
+            auto const& oe = le.data.offer();
+            auto it = mBestOffers.find(BestOffersKey{oe.buying, oe.selling});
+            if (it == mBestOffers.end())
+            {
+                continue;
+            }
+
+            auto& cached = *it->second;
+            auto& offers = cached.bestOffers;
+            if (cached.allLoaded ||
+                (!offers.empty() && isBetterOffer(le, offers.back())))
+            {
+                auto pos = std::upper_bound(
+                    offers.begin(), offers.end(), le,
+                    static_cast<bool (*)(LedgerEntry const&,
+                                         LedgerEntry const&)>(isBetterOffer));
+                offers.insert(pos, le);
+            }
+        }
+    }
+    catch (...)
+    {
+        mBestOffers.clear();
+    }
+}
+
 uint64_t
 LedgerTxnRoot::countOffers(LedgerRange const& ledgers) const
 {
@@ -2919,6 +3164,7 @@ LedgerTxnRoot::dropOffers()
 uint32_t
 LedgerTxnRoot::prefetch(UnorderedSet<LedgerKey> const& keys)
 {
+    MEMORY_ACCOUNTING_SCOPE(LEDGER_TXN);
     return mImpl->prefetch(keys);
 }
 
@@ -2968,6 +3214,8 @@ LedgerTxnRoot::Impl::prefetch(UnorderedSet<LedgerKey> const& keys)
         }
     };
 
+    absorbPendingPrefetches(nullptr);
+
     LedgerKeySet keysToSearch;
     for (auto const& key : keys)
     {
@@ -2980,6 +3228,168 @@ LedgerTxnRoot::Impl::prefetch(UnorderedSet<LedgerKey> const& keys)
     return total;
 }
 
+void
+LedgerTxnRoot::prefetchInBackground(std::vector<LedgerKey> const& keys)
+{
+    MEMORY_ACCOUNTING_SCOPE(LEDGER_TXN);
+    mImpl->prefetchInBackground(keys);
+}
+
+void
+LedgerTxnRoot::Impl::prefetchInBackground(std::vector<LedgerKey> const& keys)
+{
+    ZoneScoped;
+#ifdef BUILD_TESTS
+    if (mApp.getConfig().MODE_USES_IN_MEMORY_LEDGER)
+    {
+        return;
+    }
+#endif
+
+    if (mApp.getConfig().allBucketsInMemory())
+    {
+        return;
+    }
+
+    for (auto const& key : keys)
+    {
+        if (isSorobanEntry(key) || key.type() == TTL)
+        {
+            throw std::runtime_error(
+                "Soroban keys cannot be prefetched from disk");
+        }
+    }
+
+    // Only one background prefetch runs at a time
+    discardPendingPrefetches();
+
+    UnorderedSet<LedgerKey> seen;
+    std::vector<LedgerKeySet> batches;
+    size_t const batchSize = std::max<size_t>(mBulkLoadBatchSize, 1);
+    for (auto const& key : keys)
+    {
+        if (mEntryCache.exists(key, false) || !seen.insert(key).second)
+        {
+            continue;
+        }
+        if (batches.empty() || batches.back().size() >= batchSize)
+        {
+            batches.emplace_back();
+        }
+        batches.back().insert(key);
+    }
+    if (batches.empty())
+    {
+        return;
+    }
+
+    // Bucket list snapshots are not thread-safe, so the loader gets its own.
+    // It has to show the same state as the one loads at root go to, and
+    // otherwise the keys are prefetched right away.
+    auto snapshot = mApp.getBucketManager()
+                        .getBucketSnapshotManager()
+                        .copySearchableLiveBucketListSnapshot();
+    if (snapshot->getLedgerSeq() !=
+        getSearchableLiveBucketListSnapshot().getLedgerSeq())
+    {
+        prefetch(seen);
+        return;
+    }
+
+    std::vector<std::promise<std::vector<LedgerEntry>>> promises(
+        batches.size());
+    for (size_t i = 0; i < batches.size(); ++i)
+    {
+        mPendingPrefetches.push_back({batches[i], promises[i].get_future()});
+    }
+    mPrefetchLoader = std::async(
+        std::launch::async,
+        [snapshot, batches = std::move(batches),
+         promises = std::move(promises)]() mutable {
+            ZoneScopedN("background prefetch");
+            for (size_t i = 0; i < batches.size(); ++i)
+            {
+                try
+                {
+                    promises[i].set_value(
+                        snapshot->loadKeys(batches[i], "prefetch"));
+                }
+                catch (...)
+                {
+                    promises[i].set_exception(std::current_exception());
+                }
+            }
+        });
+}
+
+void
+LedgerTxnRoot::Impl::absorbPendingPrefetches(LedgerKey const* waitFor) const
+{
+    ZoneScoped;
+    size_t numToWaitFor = 0;
+    if (waitFor)
+    {
+        for (size_t i = 0; i < mPendingPrefetches.size(); ++i)
+        {
+            if (mPendingPrefetches[i].mKeys.count(*waitFor) != 0)
+            {
+                numToWaitFor = i + 1;
+                break;
+            }
+        }
+    }
+
+    try
+    {
+        for (size_t numAbsorbed = 0; !mPendingPrefetches.empty();
+             ++numAbsorbed)
+        {
+            auto& batch = mPendingPrefetches.front();
+            if (numAbsorbed >= numToWaitFor &&
+                batch.mEntries.wait_for(std::chrono::seconds(0)) !=
+                    std::future_status::ready)
+            {
+                break;
+            }
+
+            auto entries = batch.mEntries.get();
+            for (auto const& [key, entry] :
+                 populateLoadedEntries(batch.mKeys, entries))
+            {
+                // The entry may have been loaded since its batch was queued
+                if (!mEntryCache.exists(key, false))
+                {
+                    putInEntryCache(key, entry, LoadType::PREFETCH);
+                }
+            }
+            mPendingPrefetches.pop_front();
+        }
+    }
+    catch (std::exception& e)
+    {
+        discardPendingPrefetches();
+        printErrorAndAbort("fatal error when prefetching ledger entries in "
+                           "LedgerTxnRoot: ",
+                           e.what());
+    }
+
+    if (mPendingPrefetches.empty() && mPrefetchLoader.valid())
+    {
+        mPrefetchLoader.get();
+    }
+}
+
+void
+LedgerTxnRoot::Impl::discardPendingPrefetches() const noexcept
+{
+    if (mPrefetchLoader.valid())
+    {
+        mPrefetchLoader.wait();
+        mPrefetchLoader = std::future<void>();
+    }
+    mPendingPrefetches.clear();
+}
+
 double
 LedgerTxnRoot::getPrefetchHitRate() const
 {
@@ -3085,7 +3495,7 @@ LedgerTxnRoot::Impl::getBestOfferSlow(Asset const& buying, Asset const& selling,
 
             if (exclude.find(le.data.offer().offerID) == exclude.end())
             {
-                return std::make_shared<LedgerEntry const>(le);
+                return makePooledShared<LedgerEntry const>(le);
             }
         }
 
@@ -3314,7 +3724,7 @@ LedgerTxnRoot::Impl::getBestOffer(Asset const& buying, Asset const& selling,
             populateEntryCacheFromBestOffers(iter, lastOfferIter);
         }
 
-        auto le = std::make_shared<LedgerEntry const>(*iter);
+        auto le = makePooledShared<LedgerEntry const>(*iter);
         putInEntryCache(LedgerEntryKey(*iter), le, LoadType::IMMEDIATE);
 
         return le;
@@ -3358,7 +3768,7 @@ LedgerTxnRoot::Impl::getOffersByAccountAndAsset(AccountID const& account,
         auto key = LedgerEntryKey(offer);
         res.emplace(key, offer);
 
-        auto le = std::make_shared<LedgerEntry const>(offer);
+        auto le = makePooledShared<LedgerEntry const>(offer);
         putInEntryCache(key, le, LoadType::IMMEDIATE);
 
         auto const& oe = offer.data.offer();
@@ -3412,7 +3822,7 @@ LedgerTxnRoot::Impl::getPoolShareTrustLinesByAccountAndAsset(
         auto key = LedgerEntryKey(tl);
         res.emplace(key, tl);
 
-        auto le = std::make_shared<LedgerEntry const>(tl);
+        auto le = makePooledShared<LedgerEntry const>(tl);
         putInEntryCache(key, le, LoadType::IMMEDIATE);
     }
 
@@ -3489,6 +3899,7 @@ LedgerTxnRoot::Impl::getRestoredLiveBucketListKeys() const
 std::shared_ptr<InternalLedgerEntry const>
 LedgerTxnRoot::getNewestVersion(InternalLedgerKey const& key) const
 {
+    MEMORY_ACCOUNTING_SCOPE(LEDGER_TXN);
     return mImpl->getNewestVersion(key);
 }
 
@@ -3526,7 +3937,7 @@ LedgerTxnRoot::Impl::getNewestVersion(InternalLedgerKey const& gkey) const
 
         if (entry)
         {
-            return std::make_shared<InternalLedgerEntry const>(*entry);
+            return makePooledShared<InternalLedgerEntry const>(*entry);
         }
         else
         {
@@ -3535,16 +3946,23 @@ LedgerTxnRoot::Impl::getNewestVersion(InternalLedgerKey const& gkey) const
     }
     else
     {
+        if (!mPendingPrefetches.empty())
+        {
+            absorbPendingPrefetches(&key);
+        }
+
         if (mEntryCache.exists(key))
         {
             std::string zoneTxt("hit");
             ZoneText(zoneTxt.c_str(), zoneTxt.size());
+            mEntryCacheHits[key.type()]->Mark();
             return getFromEntryCache(key);
         }
         else
         {
             std::string zoneTxt("miss");
             ZoneText(zoneTxt.c_str(), zoneTxt.size());
+            mEntryCacheMisses[key.type()]->Mark();
             ++mPrefetchMisses;
         }
 
@@ -3580,7 +3998,7 @@ LedgerTxnRoot::Impl::getNewestVersion(InternalLedgerKey const& gkey) const
         putInEntryCache(key, entry, LoadType::IMMEDIATE);
         if (entry)
         {
-            return std::make_shared<InternalLedgerEntry const>(*entry);
+            return makePooledShared<InternalLedgerEntry const>(*entry);
         }
         else
         {
@@ -3649,7 +4067,7 @@ LedgerTxnRoot::Impl::getFromEntryCache(LedgerKey const& key) const
 
         if (cached.entry)
         {
-            return std::make_shared<InternalLedgerEntry const>(*cached.entry);
+            return makePooledShared<InternalLedgerEntry const>(*cached.entry);
         }
         else
         {
@@ -8,6 +8,7 @@
 #include "ledger/InternalLedgerEntry.h"
 #include "ledger/LedgerTxnEntry.h"
 #include "ledger/LedgerTxnHeader.h"
+#include "util/PoolAllocator.h"
 #include "util/UnorderedMap.h"
 #include "util/UnorderedSet.h"
 #include "util/types.h"
@@ -373,7 +374,7 @@ struct LedgerTxnDelta
         LedgerHeader previous;
     };
 
-    UnorderedMap<InternalLedgerKey, EntryDelta> entry;
+    PooledUnorderedMap<InternalLedgerKey, EntryDelta> entry;
     HeaderDelta header;
 };
 
@@ -517,6 +518,14 @@ class AbstractLedgerTxnParent
     // as these are stored in-memory and should not be loaded from disk.
     virtual uint32_t prefetch(UnorderedSet<LedgerKey> const& keys) = 0;
 
+    // Like prefetch, but keys are loaded in batches on a background thread,
+    // in the given order, and this returns immediately. A load of a key that
+    // is still being prefetched waits for its batch. Entries prefetched before
+    // the root commits are dropped. Will throw when called on anything other
+    // than a (real or stub) root LedgerTxn. Throws if any key is a Soroban
+    // key.
+    virtual void prefetchInBackground(std::vector<LedgerKey> const& keys) = 0;
+
     // prepares to increase the capacity of pending changes by up to "s" changes
     virtual void prepareNewObjects(size_t s) = 0;
 
@@ -666,6 +675,11 @@ class AbstractLedgerTxn : public AbstractLedgerTxnParent
     // modified.
     virtual LedgerKeySet getAllTTLKeysWithoutSealing() const = 0;
 
+    // Returns true if any CONFIG_SETTING entry has been created, updated or
+    // deleted. Entries that were only loaded don't count. Does not seal the
+    // AbstractLedgerTxn.
+    virtual bool hasConfigSettingChangesWithoutSealing() const = 0;
+
     // forAllWorstBestOffers allows a parent AbstractLedgerTxn to process the
     // worst best offers (an offer is a worst best offer if every better offer
     // in any parent AbstractLedgerTxn has already been loaded). This function
@@ -736,6 +750,13 @@ class LedgerTxn : public AbstractLedgerTxn
   protected:
     LedgerHeader const& getHeader() const override;
 
+    // Like commitChild, for an iter that only ranges over some of the child's
+    // entries: unlike commitChild, this never takes over the child's entries
+    // wholesale.
+    void commitChildSubset(EntryIterator iter,
+                           RestoredEntries const& restoredEntries,
+                           LedgerTxnConsistency cons) noexcept;
+
   public:
     // WARNING: use useTransaction flag with caution. It does not start a SQL
     // transaction, which uses the strongest SERIALIZABLE level isolation.
@@ -799,6 +820,7 @@ class LedgerTxn : public AbstractLedgerTxn
                        std::vector<LedgerEntry>& liveEntries,
                        std::vector<LedgerKey>& deadEntries) override;
     LedgerKeySet getAllTTLKeysWithoutSealing() const override;
+    bool hasConfigSettingChangesWithoutSealing() const override;
 
     UnorderedMap<LedgerKey, LedgerEntry>
     getRestoredHotArchiveKeys() const override;
@@ -847,6 +869,7 @@ class LedgerTxn : public AbstractLedgerTxn
 
     double getPrefetchHitRate() const override;
     uint32_t prefetch(UnorderedSet<LedgerKey> const& keys) override;
+    void prefetchInBackground(std::vector<LedgerKey> const& keys) override;
     void prepareNewObjects(size_t s) override;
     SessionWrapper& getSession() const override;
 
@@ -945,6 +968,7 @@ class LedgerTxnRoot : public AbstractLedgerTxnParent
     void rollbackChild() noexcept override;
 
     uint32_t prefetch(UnorderedSet<LedgerKey> const& keys) override;
+    void prefetchInBackground(std::vector<LedgerKey> const& keys) override;
 
     double getPrefetchHitRate() const override;
     void prepareNewObjects(size_t s) override;
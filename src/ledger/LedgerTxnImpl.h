@@ -9,6 +9,8 @@
 #include "ledger/LedgerTxn.h"
 #include "util/RandomEvictionCache.h"
 #include "util/UnorderedSet.h"
+#include <deque>
+#include <future>
 #include <list>
 #include <optional>
 #ifdef USE_POSTGRES
@@ -18,6 +20,11 @@
 #include <sstream>
 #endif
 
+namespace medida
+{
+class Meter;
+}
+
 namespace stellar
 {
 
@@ -89,16 +96,20 @@ class LedgerTxn::Impl
 {
     class EntryIteratorImpl;
 
-    typedef UnorderedMap<InternalLedgerKey, LedgerEntryPtr> EntryMap;
+    typedef UnorderedFlatMap<InternalLedgerKey, LedgerEntryPtr> EntryMap;
 
     AbstractLedgerTxnParent& mParent;
     AbstractLedgerTxn* mChild;
     std::unique_ptr<LedgerHeader> mHeader;
     std::shared_ptr<LedgerTxnHeader::Impl> mActiveHeader;
     EntryMap mEntry;
+    // Whether an offer was ever recorded in mEntry, so that adopting a
+    // child's entries only looks for offers if there may be some.
+    bool mHasOfferEntries{false};
 
     RestoredEntries mRestoredEntries;
-    UnorderedMap<InternalLedgerKey, std::shared_ptr<EntryImplBase>> mActive;
+    PooledUnorderedMap<InternalLedgerKey, std::shared_ptr<EntryImplBase>>
+        mActive;
     bool const mShouldUpdateLastModified;
     bool mIsSealed;
     LedgerTxnConsistency mConsistency;
@@ -313,6 +324,12 @@ class LedgerTxn::Impl
     // removeFromOrderBookIfExists has the strong exception safety guarantee
     void removeFromOrderBookIfExists(LedgerEntry const& le);
 
+    // Takes over the entries of child, which is committing, when nothing is
+    // recorded here: none of them can conflict with ours, so the entry map is
+    // swapped in instead of being merged entry by entry. Only offers need
+    // any per-entry work, to enter the order book.
+    void adoptChildEntries(Impl& child);
+
     // updateEntryIfRecorded and updateEntry have the strong exception safety
     // guarantee
     void updateEntryIfRecorded(InternalLedgerKey const& key,
@@ -339,8 +356,10 @@ class LedgerTxn::Impl
 
     void commit() noexcept;
 
+    // When iter ranges over all of the child's entries, mayAdopt allows
+    // taking them over with adoptChildEntries.
     void commitChild(EntryIterator iter, RestoredEntries const& restoredEntries,
-                     LedgerTxnConsistency cons) noexcept;
+                     LedgerTxnConsistency cons, bool mayAdopt) noexcept;
 
     // create has the basic exception safety guarantee. If it throws an
     // exception, then
@@ -456,6 +475,7 @@ class LedgerTxn::Impl
     UnorderedMap<LedgerKey, LedgerEntry> getRestoredLiveBucketListKeys() const;
 
     LedgerKeySet getAllTTLKeysWithoutSealing() const;
+    bool hasConfigSettingChangesWithoutSealing() const;
 
     // getNewestVersion has the basic exception safety guarantee. If it throws
     // an exception, then
@@ -546,6 +566,7 @@ class LedgerTxn::Impl
     void unsealHeader(LedgerTxn& self, std::function<void(LedgerHeader&)> f);
 
     uint32_t prefetch(UnorderedSet<LedgerKey> const& keys);
+    void prefetchInBackground(std::vector<LedgerKey> const& keys);
 
     double getPrefetchHitRate() const;
 
@@ -639,6 +660,10 @@ class LedgerTxnRoot::Impl
         BestOffers;
 
     static size_t const MIN_BEST_OFFERS_BATCH_SIZE;
+
+    // mBestOffers is kept across commits while it holds at most this many
+    // asset pairs and offers combined, and cleared otherwise.
+    static size_t const MAX_RETAINED_BEST_OFFERS;
     size_t const mMaxBestOffersBatchSize;
 
     Application& mApp;
@@ -647,11 +672,24 @@ class LedgerTxnRoot::Impl
 
     std::unique_ptr<LedgerHeader> mHeader;
     mutable EntryCache mEntryCache;
+    // Loads that mEntryCache served and missed, indexed by LedgerEntryType
+    std::vector<medida::Meter*> mEntryCacheHits;
+    std::vector<medida::Meter*> mEntryCacheMisses;
     mutable BestOffers mBestOffers;
     mutable uint64_t mPrefetchHits{0};
     mutable uint64_t mPrefetchMisses{0};
     mutable SearchableSnapshotConstPtr mSearchableBucketListSnapshot;
 
+    // Batches of keys being prefetched in the background, in the order they
+    // are loaded, along with the entries that were found for them
+    struct PendingPrefetch
+    {
+        LedgerKeySet mKeys;
+        std::future<std::vector<LedgerEntry>> mEntries;
+    };
+    mutable std::deque<PendingPrefetch> mPendingPrefetches;
+    mutable std::future<void> mPrefetchLoader;
+
     size_t mBulkLoadBatchSize;
     std::unique_ptr<soci::transaction> mTransaction;
     AbstractLedgerTxn* mChild;
@@ -692,7 +730,12 @@ class LedgerTxnRoot::Impl
     //    database operations are SELECTs, which only populate the cache
     //    with fresh data from the DB.
     //
-    //  - On LedgerTxnRoot::commitChild, the cache is cleared.
+    //  - On LedgerTxnRoot::commitChild, the cached entries the commit changed
+    //    are replaced with their new state, so that entries loaded in one
+    //    ledger, such as hot accounts, are still cached in the next. A commit
+    //    that moves the header anywhere but to the same or the next ledger,
+    //    as happens once catchup has applied buckets, clears the cache
+    //    instead.
     //
     //  - It is therefore always kept in exact correspondence with the
     //    database for the keyset that it has entries for. It's a precise
@@ -702,6 +745,12 @@ class LedgerTxnRoot::Impl
     void putInEntryCache(LedgerKey const& key,
                          std::shared_ptr<LedgerEntry const> const& entry,
                          LoadType type) const;
+    // Applies the new state of the cached entries a commit changed, null for
+    // the ones it erased, or clears the cache if keep is false
+    void updateEntryCacheOnCommit(
+        std::vector<std::pair<LedgerKey, std::shared_ptr<LedgerEntry const>>>
+            const& changes,
+        bool keep) noexcept;
 
     BestOffersEntryPtr getFromBestOffers(Asset const& buying,
                                          Asset const& selling) const;
@@ -715,8 +764,26 @@ class LedgerTxnRoot::Impl
         std::deque<LedgerEntry>::const_iterator iter,
         std::deque<LedgerEntry>::const_iterator const& end);
 
+    // Brings mBestOffers up to date with the offers changed by a commit, so
+    // the best offers loaded in one ledger don't have to be reloaded from the
+    // database in the next. Every cached list stays the exact best prefix of
+    // the offers for its asset pair. upsertedOffers holds the new state of
+    // the offers in changedOfferIDs that still exist.
+    void updateBestOffersOnCommit(
+        std::vector<LedgerEntry> const& upsertedOffers,
+        UnorderedSet<int64_t> const& changedOfferIDs) noexcept;
+
     bool areEntriesMissingInCacheForOffer(OfferEntry const& oe);
 
+    // Moves the background prefetch batches that have finished loading into
+    // the entry cache, in order. If waitFor is in a batch that hasn't, waits
+    // for it first.
+    void absorbPendingPrefetches(LedgerKey const* waitFor) const;
+
+    // Waits for the background prefetch loader and drops everything it
+    // loaded
+    void discardPendingPrefetches() const noexcept;
+
     SearchableLiveBucketListSnapshot const&
     getSearchableLiveBucketListSnapshot() const;
 
@@ -816,6 +883,12 @@ class LedgerTxnRoot::Impl
     // prefetched. Throws if any key is a Soroban key.
     uint32_t prefetch(UnorderedSet<LedgerKey> const& keys);
 
+    // Starts loading keys, in batches of mBulkLoadBatchSize, on a background
+    // thread from a snapshot of the bucket list. Finished batches are moved
+    // into the entry cache by the next load or prefetch. Throws if any key is
+    // a Soroban key.
+    void prefetchInBackground(std::vector<LedgerKey> const& keys);
+
     double getPrefetchHitRate() const;
 
     void prepareNewObjects(size_t s);
@@ -664,11 +664,17 @@ LedgerTxnRoot::Impl::dropOffers()
     mEntryCache.clear();
     mBestOffers.clear();
 
-    getSession().session() << "DROP TABLE IF EXISTS offers;";
+    auto schema = mApp.getDatabase().getOffersSchemaPrefix();
+    if (!schema.empty())
+    {
+        // A table left in the main database would hide the in-memory one
+        getSession().session() << "DROP TABLE IF EXISTS main.offers;";
+    }
+    getSession().session() << "DROP TABLE IF EXISTS " << schema << "offers;";
 
     std::string coll = mApp.getDatabase().getSimpleCollationClause();
     mApp.getDatabase().getRawSession()
-        << "CREATE TABLE offers"
+        << "CREATE TABLE " << schema << "offers"
         << "("
         << "sellerid         VARCHAR(56) " << coll << "NOT NULL,"
         << "offerid          BIGINT           NOT NULL CHECK (offerid >= "
@@ -686,11 +692,11 @@ LedgerTxnRoot::Impl::dropOffers()
            "PRIMARY KEY      (offerid)"
            ");";
     mApp.getDatabase().getRawSession()
-        << "CREATE INDEX bestofferindex ON offers "
-           "(sellingasset,buyingasset,price,offerid);";
+        << "CREATE INDEX " << schema << "bestofferindex ON offers "
+        << "(sellingasset,buyingasset,price,offerid);";
     mApp.getDatabase().getRawSession()
-        << "CREATE INDEX offerbyseller ON offers "
-           "(sellerid);";
+        << "CREATE INDEX " << schema << "offerbyseller ON offers "
+        << "(sellerid);";
     if (!mApp.getDatabase().isSqlite())
     {
         mApp.getDatabase().getRawSession() << "ALTER TABLE offers "
@@ -33,7 +33,7 @@ getTTLKey(LedgerKey const& e)
     releaseAssert(e.type() == CONTRACT_CODE || e.type() == CONTRACT_DATA);
     LedgerKey k;
     k.type(TTL);
-    k.ttl().keyHash = sha256(xdr::xdr_to_opaque(e));
+    k.ttl().keyHash = xdrSha256(e);
     return k;
 }
 
@@ -59,17 +59,29 @@ ledgerEntrySizeForRent(LedgerEntry const& entry, uint32_t entryXdrSize,
     if (protocolVersionStartsFrom(ledgerVersion, ProtocolVersion::V_23) &&
         isCodeEntry)
     {
-        uint32_t memorySize = rust_bridge::contract_code_memory_size_for_rent(
-            Config::CURRENT_LEDGER_PROTOCOL_VERSION, ledgerVersion,
-            toCxxBuf(entry.data.contractCode()),
+        entrySizeForRent = contractCodeEntrySizeForRent(
+            entry.data.contractCode(), entryXdrSize, ledgerVersion,
             toCxxBuf(sorobanConfig.cpuCostParams()),
             toCxxBuf(sorobanConfig.memCostParams()));
-        uint64_t totalSize = static_cast<uint64_t>(entrySizeForRent) +
-                             static_cast<uint64_t>(memorySize);
-        entrySizeForRent = static_cast<uint32_t>(std::min(
-            totalSize,
-            static_cast<uint64_t>(std::numeric_limits<uint32_t>::max())));
     }
     return entrySizeForRent;
 }
+
+uint32_t
+contractCodeEntrySizeForRent(ContractCodeEntry const& code,
+                             uint32_t entryXdrSize, uint32_t ledgerVersion,
+                             CxxBuf const& cpuCostParams,
+                             CxxBuf const& memCostParams)
+{
+    releaseAssert(
+        protocolVersionStartsFrom(ledgerVersion, ProtocolVersion::V_23));
+    uint32_t memorySize = rust_bridge::contract_code_memory_size_for_rent(
+        Config::CURRENT_LEDGER_PROTOCOL_VERSION, ledgerVersion,
+        toCxxBuf(code), cpuCostParams, memCostParams);
+    uint64_t totalSize = static_cast<uint64_t>(entryXdrSize) +
+                         static_cast<uint64_t>(memorySize);
+    return static_cast<uint32_t>(
+        std::min(totalSize,
+                 static_cast<uint64_t>(std::numeric_limits<uint32_t>::max())));
+}
 };
@@ -12,6 +12,7 @@
 #include "util/XDROperators.h"
 #include "util/types.h"
 
+struct CxxBuf;
 namespace stellar
 {
 bool isLive(LedgerEntry const& e, uint32_t cutoffLedger);
@@ -89,4 +90,13 @@ isPersistentEntry(T const& e)
 uint32_t ledgerEntrySizeForRent(LedgerEntry const& entry, uint32_t entryXdrSize,
                                 uint32_t ledgerVersion,
                                 SorobanNetworkConfig const& sorobanConfig);
+
+// Same as ledgerEntrySizeForRent for a ContractCode entry in protocol 23+,
+// with the cost params already serialized, so that sizing many entries
+// against the same config serializes them only once.
+uint32_t contractCodeEntrySizeForRent(ContractCodeEntry const& code,
+                                      uint32_t entryXdrSize,
+                                      uint32_t ledgerVersion,
+                                      CxxBuf const& cpuCostParams,
+                                      CxxBuf const& memCostParams);
 }
@@ -0,0 +1,454 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "ledger/MetaStreamWriter.h"
+#include "ledger/IndexedLedgerCloseMeta.h"
+#include "util/FileSystemException.h"
+#include "util/GlobalChecks.h"
+#include "util/Logging.h"
+#include "util/XDRStream.h"
+#include "xdrpp/marshal.h"
+#include <Tracy.hpp>
+#include <algorithm>
+#include <atomic>
+#include <fmt/format.h>
+#include <future>
+#include <medida/counter.h>
+#include <medida/meter.h>
+#include <medida/metrics_registry.h>
+#include <medida/timer.h>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <poll.h>
+#include <sys/uio.h>
+#endif
+
+namespace stellar
+{
+
+namespace
+{
+// Ledgers with fewer transactions are serialized on the calling thread
+size_t constexpr TXS_PER_CHUNK = 64;
+
+// Serializes txProcessing in chunks of TXS_PER_CHUNK transactions, in
+// parallel, into one buffer per chunk
+template <typename TxMetaT>
+std::vector<std::vector<char>>
+serializeTxProcessingChunks(xdr::xvector<TxMetaT> const& txProcessing)
+{
+    ZoneScoped;
+    auto numChunks = (txProcessing.size() + TXS_PER_CHUNK - 1) / TXS_PER_CHUNK;
+    std::vector<std::vector<char>> chunks(numChunks);
+    std::atomic<size_t> nextChunk{0};
+    auto worker = [&]() {
+        for (size_t c = nextChunk++; c < numChunks; c = nextChunk++)
+        {
+            auto begin = c * TXS_PER_CHUNK;
+            auto end = std::min(begin + TXS_PER_CHUNK, txProcessing.size());
+            size_t size = 0;
+            for (auto i = begin; i < end; ++i)
+            {
+                size += xdr::xdr_size(txProcessing[i]);
+            }
+            auto& chunk = chunks[c];
+            chunk.resize(size);
+            xdr::xdr_put p(chunk.data(), chunk.data() + size);
+            for (auto i = begin; i < end; ++i)
+            {
+                xdr::xdr_argpack_archive(p, txProcessing[i]);
+            }
+        }
+    };
+
+    auto numWorkers = std::min<size_t>(
+        numChunks, std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::future<void>> futures;
+    for (size_t i = 1; i < numWorkers; ++i)
+    {
+        futures.emplace_back(std::async(std::launch::async, worker));
+    }
+    std::exception_ptr error;
+    try
+    {
+        worker();
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+        nextChunk = numChunks;
+    }
+    for (auto& f : futures)
+    {
+        f.wait();
+    }
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+    for (auto& f : futures)
+    {
+        f.get();
+    }
+    return chunks;
+}
+
+// Serializes the arm of a LedgerCloseMeta: the fields preceding txProcessing,
+// txProcessing and the fields following it. The field lists must follow the
+// XDR definition, which the tests check against xdr_to_opaque.
+template <typename MetaT, typename PrefixF, typename SuffixF>
+size_t
+serializeMetaArm(int32_t v, MetaT const& m, std::vector<char>& buf,
+                 size_t offset, PrefixF&& prefix, SuffixF&& suffix)
+{
+    auto chunks = serializeTxProcessingChunks(m.txProcessing);
+    size_t txProcessingSize = 4;
+    for (auto const& chunk : chunks)
+    {
+        txProcessingSize += chunk.size();
+    }
+
+    auto prefixSize = 4 + prefix([](auto const&... fields) {
+                          return (xdr::xdr_size(fields) + ...);
+                      });
+    auto suffixSize = suffix([](auto const&... fields) {
+        return (xdr::xdr_size(fields) + ...);
+    });
+    auto size = prefixSize + txProcessingSize + suffixSize;
+    buf.resize(offset + size);
+
+    auto at = offset;
+    {
+        auto end = at + prefixSize + 4;
+        xdr::xdr_put p(buf.data() + at, buf.data() + end);
+        xdr::xdr_argpack_archive(p, v);
+        prefix([&](auto const&... fields) {
+            xdr::xdr_argpack_archive(p, fields...);
+            return size_t(0);
+        });
+        xdr::xdr_argpack_archive(
+            p, static_cast<uint32_t>(m.txProcessing.size()));
+        at = end;
+    }
+    for (auto const& chunk : chunks)
+    {
+        std::copy(chunk.begin(), chunk.end(), buf.begin() + at);
+        at += chunk.size();
+    }
+    {
+        xdr::xdr_put p(buf.data() + at, buf.data() + at + suffixSize);
+        suffix([&](auto const&... fields) {
+            xdr::xdr_argpack_archive(p, fields...);
+            return size_t(0);
+        });
+    }
+    return size;
+}
+}
+
+size_t
+serializeLedgerCloseMeta(LedgerCloseMeta const& meta, std::vector<char>& buf,
+                         size_t offset)
+{
+    ZoneScoped;
+    releaseAssert(offset % 4 == 0);
+    auto serial = [&]() {
+        auto size = xdr::xdr_size(meta);
+        buf.resize(offset + size);
+        xdr::xdr_put p(buf.data() + offset, buf.data() + offset + size);
+        xdr::xdr_argpack_archive(p, meta);
+        return size;
+    };
+
+    switch (meta.v())
+    {
+    case 1:
+    {
+        auto const& m = meta.v1();
+        if (m.txProcessing.size() <= TXS_PER_CHUNK)
+        {
+            return serial();
+        }
+        return serializeMetaArm(
+            meta.v(), m, buf, offset,
+            [&](auto&& f) { return f(m.ext, m.ledgerHeader, m.txSet); },
+            [&](auto&& f) {
+                return f(m.upgradesProcessing, m.scpInfo,
+                         m.totalByteSizeOfLiveSorobanState, m.evictedKeys,
+                         m.unused);
+            });
+    }
+    case 2:
+    {
+        auto const& m = meta.v2();
+        if (m.txProcessing.size() <= TXS_PER_CHUNK)
+        {
+            return serial();
+        }
+        return serializeMetaArm(
+            meta.v(), m, buf, offset,
+            [&](auto&& f) { return f(m.ext, m.ledgerHeader, m.txSet); },
+            [&](auto&& f) {
+                return f(m.upgradesProcessing, m.scpInfo,
+                         m.totalByteSizeOfLiveSorobanState, m.evictedKeys);
+            });
+    }
+    default:
+        // Only replayed from old history, never large enough to matter
+        return serial();
+    }
+}
+
+MetaStreamWriter::MetaStreamWriter(OutputFileStream& out,
+                                   size_t maxPendingLedgers,
+                                   bool abortWhenBehind,
+                                   MetaStreamFormat format,
+                                   medida::MetricsRegistry& registry)
+    : mOut(out)
+    , mMaxPendingLedgers(maxPendingLedgers)
+    , mAbortWhenBehind(abortWhenBehind)
+    , mFormat(format)
+    , mBytesWritten(
+          registry.NewMeter({"ledger", "metastream", "bytes"}, "byte"))
+    , mWriteTime(registry.NewTimer({"ledger", "metastream", "write"}))
+    , mBlockedTime(registry.NewTimer({"ledger", "metastream", "blocked"}))
+    , mQueueDepth(registry.NewCounter({"ledger", "metastream", "queue-depth"}))
+{
+    releaseAssert(mMaxPendingLedgers > 0);
+    mThread = std::thread([this]() { run(); });
+}
+
+MetaStreamWriter::~MetaStreamWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mCV.notify_all();
+    mThread.join();
+    if (mError)
+    {
+        try
+        {
+            std::rethrow_exception(mError);
+        }
+        catch (std::exception const& e)
+        {
+            CLOG_ERROR(Ledger, "Meta stream write failed: {}", e.what());
+        }
+        catch (...)
+        {
+            CLOG_ERROR(Ledger, "Meta stream write failed");
+        }
+    }
+}
+
+void
+MetaStreamWriter::enqueue(LedgerCloseMeta const& meta)
+{
+    ZoneScoped;
+    std::vector<char> buf;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!mFree.empty())
+        {
+            buf = std::move(mFree.back());
+            mFree.pop_back();
+        }
+    }
+
+    size_t size = 0;
+    switch (mFormat)
+    {
+    case MetaStreamFormat::XDR:
+        size = serializeLedgerCloseMeta(meta, buf, 4);
+        break;
+    case MetaStreamFormat::INDEXED:
+        size = IndexedLedgerCloseMeta::serialize(
+            meta, IndexedLedgerCloseMeta::Compression::NONE, buf, 4);
+        break;
+    case MetaStreamFormat::INDEXED_ZLIB:
+        size = IndexedLedgerCloseMeta::serialize(
+            meta, IndexedLedgerCloseMeta::Compression::ZLIB, buf, 4);
+        break;
+    }
+    releaseAssertOrThrow(size < 0x80000000);
+    auto sz = static_cast<uint32_t>(size);
+    buf[0] = static_cast<char>((sz >> 24) & 0xFF) | '\x80';
+    buf[1] = static_cast<char>((sz >> 16) & 0xFF);
+    buf[2] = static_cast<char>((sz >> 8) & 0xFF);
+    buf[3] = static_cast<char>(sz & 0xFF);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    auto hasRoom = [this] {
+        return mError || mPending.size() + mNumWriting < mMaxPendingLedgers;
+    };
+    if (!hasRoom())
+    {
+        if (mAbortWhenBehind)
+        {
+            throw std::runtime_error(fmt::format(
+                FMT_STRING("Meta stream consumer is {:d} ledgers behind"),
+                mPending.size() + mNumWriting));
+        }
+        auto blocked = mBlockedTime.TimeScope();
+        mCV.wait(lock, hasRoom);
+    }
+    if (mError)
+    {
+        std::rethrow_exception(mError);
+    }
+
+    mPending.emplace_back(std::move(buf));
+    mQueueDepth.set_count(mPending.size() + mNumWriting);
+    lock.unlock();
+    mCV.notify_all();
+}
+
+void
+MetaStreamWriter::drain()
+{
+    ZoneScoped;
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCV.wait(lock, [this] {
+        return mError || (mPending.empty() && mNumWriting == 0);
+    });
+    if (mError)
+    {
+        std::rethrow_exception(mError);
+    }
+}
+
+size_t
+MetaStreamWriter::getQueueDepth()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mPending.size() + mNumWriting;
+}
+
+void
+MetaStreamWriter::writeBuffers(std::vector<std::vector<char>> const& buffers)
+{
+    ZoneScoped;
+#ifdef _WIN32
+    for (auto const& buf : buffers)
+    {
+        mOut.writeBytes(buf.data(), buf.size());
+    }
+    mOut.flush();
+#else
+    // Anything written through the stream's own buffer has to reach the
+    // descriptor first.
+    mOut.flush();
+    int fd = mOut.getHandle();
+
+    std::vector<iovec> iov;
+    iov.reserve(buffers.size());
+    for (auto const& buf : buffers)
+    {
+        iov.push_back({const_cast<char*>(buf.data()), buf.size()});
+    }
+
+    size_t next = 0;
+    while (next < iov.size())
+    {
+        auto count = static_cast<int>(
+            std::min<size_t>(iov.size() - next, static_cast<size_t>(IOV_MAX)));
+        ssize_t n = ::writev(fd, iov.data() + next, count);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                pollfd pfd{fd, POLLOUT, 0};
+                ::poll(&pfd, 1, -1);
+                continue;
+            }
+            FileSystemException::failWith(
+                std::string("MetaStreamWriter: writev failed: ") +
+                std::strerror(errno));
+        }
+
+        // Skip the buffers that were written completely and advance into a
+        // partially written one.
+        auto written = static_cast<size_t>(n);
+        while (next < iov.size() && written >= iov[next].iov_len)
+        {
+            written -= iov[next].iov_len;
+            ++next;
+        }
+        if (written > 0)
+        {
+            iov[next].iov_base =
+                static_cast<char*>(iov[next].iov_base) + written;
+            iov[next].iov_len -= written;
+        }
+    }
+#endif
+}
+
+void
+MetaStreamWriter::run()
+{
+    ZoneScopedN("meta stream writer");
+    std::unique_lock<std::mutex> lock(mMutex);
+    for (;;)
+    {
+        mCV.wait(lock, [this] { return mStopping || !mPending.empty(); });
+        if (mPending.empty())
+        {
+            // Stopping, and everything queued has been written
+            return;
+        }
+
+        std::vector<std::vector<char>> batch;
+        while (!mPending.empty())
+        {
+            batch.emplace_back(std::move(mPending.front()));
+            mPending.pop_front();
+        }
+        mNumWriting = batch.size();
+        lock.unlock();
+
+        size_t bytes = 0;
+        try
+        {
+            auto timer = mWriteTime.TimeScope();
+            writeBuffers(batch);
+            for (auto const& buf : batch)
+            {
+                bytes += buf.size();
+            }
+        }
+        catch (...)
+        {
+            lock.lock();
+            mError = std::current_exception();
+            mNumWriting = 0;
+            mCV.notify_all();
+            return;
+        }
+        mBytesWritten.Mark(bytes);
+
+        lock.lock();
+        for (auto& buf : batch)
+        {
+            if (mFree.size() < mMaxPendingLedgers)
+            {
+                buf.clear();
+                mFree.emplace_back(std::move(buf));
+            }
+        }
+        mNumWriting = 0;
+        mQueueDepth.set_count(mPending.size());
+        mCV.notify_all();
+    }
+}
+}
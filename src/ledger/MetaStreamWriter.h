@@ -0,0 +1,106 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/NonCopyable.h"
+#include "xdr/Stellar-ledger.h"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace medida
+{
+class Counter;
+class Meter;
+class MetricsRegistry;
+class Timer;
+}
+
+namespace stellar
+{
+
+class OutputFileStream;
+
+enum class MetaStreamFormat
+{
+    // Plain LedgerCloseMeta, see serializeLedgerCloseMeta
+    XDR,
+    // See IndexedLedgerCloseMeta, uncompressed or with zlib sections
+    INDEXED,
+    INDEXED_ZLIB
+};
+
+// Serializes meta into buf, starting at offset (which must be a multiple of
+// 4), resizing buf to fit, and returns the size of the serialized meta. Output
+// is byte-for-byte the same as xdr::xdr_to_opaque(meta). XDR structures are
+// serialized as the concatenation of their fields, so the transaction metas of
+// ledgers with many transactions are serialized on several threads into
+// per-chunk buffers that are then copied into place.
+size_t serializeLedgerCloseMeta(LedgerCloseMeta const& meta,
+                                std::vector<char>& buf, size_t offset);
+
+// Writes LedgerCloseMeta to METADATA_OUTPUT_STREAM on a dedicated thread.
+// Each meta is serialized once (see serializeLedgerCloseMeta, or
+// IndexedLedgerCloseMeta in the indexed formats), framed exactly as
+// XDROutputFileStream::writeOne frames it, into a buffer taken from a small
+// pool. The writer thread hands
+// every buffer queued since its last write to the stream in a single writev
+// call, bypassing the stream's own write buffer, and returns the buffers to
+// the pool.
+//
+// At most maxPendingLedgers metas may be queued or in flight. When a consumer
+// falls that far behind, enqueue either blocks until the writer catches up,
+// pushing back on ledger close, or throws if abortWhenBehind is set.
+//
+// While the writer is running, the stream belongs to the writer thread.
+// Callers must call drain() before using it directly. The destructor writes
+// out anything still queued.
+class MetaStreamWriter : public NonMovableOrCopyable
+{
+  public:
+    MetaStreamWriter(OutputFileStream& out, size_t maxPendingLedgers,
+                     bool abortWhenBehind, MetaStreamFormat format,
+                     medida::MetricsRegistry& registry);
+    ~MetaStreamWriter();
+
+    // Serializes meta and queues it for writing. Rethrows the first error hit
+    // by the writer thread.
+    void enqueue(LedgerCloseMeta const& meta);
+
+    // Blocks until everything queued so far has been written. Rethrows the
+    // first error hit by the writer thread.
+    void drain();
+
+    // Number of metas queued or being written
+    size_t getQueueDepth();
+
+  private:
+    OutputFileStream& mOut;
+    size_t const mMaxPendingLedgers;
+    bool const mAbortWhenBehind;
+    MetaStreamFormat const mFormat;
+
+    medida::Meter& mBytesWritten;
+    medida::Timer& mWriteTime;
+    medida::Timer& mBlockedTime;
+    medida::Counter& mQueueDepth;
+
+    std::mutex mMutex;
+    std::condition_variable mCV;
+    std::deque<std::vector<char>> mPending;
+    std::vector<std::vector<char>> mFree;
+    size_t mNumWriting{0};
+    bool mStopping{false};
+    std::exception_ptr mError;
+    std::thread mThread;
+
+    void writeBuffers(std::vector<std::vector<char>> const& buffers);
+    void run();
+};
+}
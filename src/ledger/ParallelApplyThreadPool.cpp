@@ -0,0 +1,136 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "ledger/ParallelApplyThreadPool.h"
+#include "util/GlobalChecks.h"
+#include "util/Logging.h"
+#include "util/Thread.h"
+#include <Tracy.hpp>
+#include <algorithm>
+
+namespace stellar
+{
+
+ParallelApplyThreadPool::ParallelApplyThreadPool(bool pinThreads)
+    : mPinThreads(pinThreads)
+{
+}
+
+ParallelApplyThreadPool::~ParallelApplyThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mWorkCV.notify_all();
+    for (auto& t : mThreads)
+    {
+        t.join();
+    }
+}
+
+std::vector<ParallelApplyThreadPool::Clock::duration>
+ParallelApplyThreadPool::run(size_t numTasks, size_t numThreads,
+                             std::function<void(size_t)> const& task)
+{
+    ZoneScoped;
+    releaseAssert(numThreads > 0);
+    numThreads = std::min(numThreads, numTasks);
+    if (numThreads == 0)
+    {
+        return {};
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        // New threads start out having seen every job so far
+        while (mThreads.size() + 1 < numThreads)
+        {
+            mThreads.emplace_back(&ParallelApplyThreadPool::workerMain, this,
+                                  mThreads.size(), mGeneration);
+        }
+        mTask = &task;
+        mNumTasks = numTasks;
+        mNumHelpers = numThreads - 1;
+        mNumRunning = mNumHelpers;
+        mNextTask = 0;
+        mBusyTime.assign(numThreads, Clock::duration::zero());
+        mError = nullptr;
+        ++mGeneration;
+    }
+    mWorkCV.notify_all();
+
+    auto busy = runTasks();
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mBusyTime[0] = busy;
+    mDoneCV.wait(lock, [this] { return mNumRunning == 0; });
+    mTask = nullptr;
+    if (mError)
+    {
+        std::rethrow_exception(mError);
+    }
+    return mBusyTime;
+}
+
+ParallelApplyThreadPool::Clock::duration
+ParallelApplyThreadPool::runTasks()
+{
+    auto busy = Clock::duration::zero();
+    for (size_t i = mNextTask++; i < mNumTasks; i = mNextTask++)
+    {
+        auto start = Clock::now();
+        try
+        {
+            (*mTask)(i);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (!mError)
+            {
+                mError = std::current_exception();
+            }
+        }
+        busy += Clock::now() - start;
+    }
+    return busy;
+}
+
+void
+ParallelApplyThreadPool::workerMain(size_t index, uint64_t generation)
+{
+    if (mPinThreads && !pinCurrentThreadToCPU(index + 1))
+    {
+        CLOG_WARNING(Ledger, "Unable to pin parallel apply thread {} to a CPU",
+                     index);
+    }
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    for (;;)
+    {
+        mWorkCV.wait(lock, [&] {
+            return mStopping || mGeneration != generation;
+        });
+        if (mStopping)
+        {
+            return;
+        }
+        generation = mGeneration;
+        if (index >= mNumHelpers)
+        {
+            continue;
+        }
+
+        lock.unlock();
+        auto busy = runTasks();
+        lock.lock();
+        mBusyTime[index + 1] = busy;
+        if (--mNumRunning == 0)
+        {
+            mDoneCV.notify_all();
+        }
+    }
+}
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/NonCopyable.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace stellar
+{
+
+// Threads that run the clusters of parallel Soroban apply stages. They live as
+// long as the pool, so no threads are started or joined per stage.
+//
+// run() hands out tasks dynamically: the calling thread and the pool threads
+// each claim the next unclaimed task whenever they finish one, so a thread
+// that gets a short task moves straight on to the next instead of idling
+// until the stage ends. The pool grows to the largest number of threads
+// asked for.
+//
+// With pinThreads, pool thread i is pinned to the (i + 1)-th CPU the process
+// may run on, leaving the first one to the calling thread, so that the
+// scheduler doesn't migrate apply threads, and their caches, between cores in
+// the middle of a stage. Pool threads inherit the CPUs and NUMA memory
+// preference of the thread that starts them, so with APPLY_NUMA_NODE they,
+// and the CPUs they are pinned to, stay on the node of the apply thread.
+class ParallelApplyThreadPool : public NonMovableOrCopyable
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit ParallelApplyThreadPool(bool pinThreads = false);
+    ~ParallelApplyThreadPool();
+
+    // Runs task(i) for every i in [0, numTasks), claimed in increasing order,
+    // on up to numThreads threads including the calling thread, and returns
+    // once all of them are done. Returns how long each thread that took part
+    // spent running tasks, the calling thread first. Once every task has run,
+    // rethrows the first exception thrown by any of them.
+    std::vector<Clock::duration>
+    run(size_t numTasks, size_t numThreads,
+        std::function<void(size_t)> const& task);
+
+  private:
+    bool const mPinThreads;
+    std::mutex mMutex;
+    std::condition_variable mWorkCV;
+    std::condition_variable mDoneCV;
+    std::vector<std::thread> mThreads;
+    bool mStopping{false};
+
+    // The job being run. mGeneration is bumped for every job, the first
+    // mNumHelpers pool threads take part in it and mNumRunning of them haven't
+    // finished yet.
+    uint64_t mGeneration{0};
+    std::function<void(size_t)> const* mTask{nullptr};
+    size_t mNumTasks{0};
+    size_t mNumHelpers{0};
+    size_t mNumRunning{0};
+    std::atomic<size_t> mNextTask{0};
+    std::vector<Clock::duration> mBusyTime;
+    std::exception_ptr mError;
+
+    Clock::duration runTasks();
+    void workerMain(size_t index, uint64_t generation);
+};
+}
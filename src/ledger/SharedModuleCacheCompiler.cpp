@@ -11,7 +11,6 @@
 #include "xdr/Stellar-ledger-entries.h"
 #include <chrono>
 #include <cstddef>
-#include <unordered_set>
 
 namespace stellar
 {
@@ -144,31 +143,14 @@ SharedModuleCacheCompiler::start()
 
     mThreads.emplace_back(std::thread([this]() {
         ZoneScopedN("load wasm contracts");
-        std::unordered_set<Hash> seenContracts;
-        this->mSnap->scanForEntriesOfType(
-            CONTRACT_CODE, [&](BucketEntry const& entry) {
-                Hash h;
-                switch (entry.type())
-                {
-                case INITENTRY:
-                case LIVEENTRY:
-                    h = entry.liveEntry().data.contractCode().hash;
-                    if (seenContracts.find(h) == seenContracts.end())
-                    {
-                        this->pushWasm(
-                            entry.liveEntry().data.contractCode().code);
-                    }
-                    break;
-                case DEADENTRY:
-                    h = entry.deadEntry().contractCode().hash;
-                    break;
-                default:
-                    break;
-                }
-                seenContracts.insert(h);
+        size_t nContracts = 0;
+        this->mSnap->scanForLiveEntriesOfType(
+            CONTRACT_CODE, [&](LedgerEntry const& entry) {
+                this->pushWasm(entry.data.contractCode().code);
+                ++nContracts;
                 return Loop::INCOMPLETE;
             });
-        this->setFinishedLoading(seenContracts.size());
+        this->setFinishedLoading(nContracts);
     }));
 
     for (auto thread = 1; thread < this->mNumThreads; ++thread)
@@ -210,6 +192,13 @@ SharedModuleCacheCompiler::wait()
     return mModuleCache->shallow_clone();
 }
 
+bool
+SharedModuleCacheCompiler::isFinished()
+{
+    std::unique_lock lock(mMutex);
+    return isFinishedCompiling(lock);
+}
+
 size_t
 SharedModuleCacheCompiler::getBytesCompiled()
 {
@@ -61,6 +61,9 @@ class SharedModuleCacheCompiler : NonMovableOrCopyable
     ~SharedModuleCacheCompiler();
     void start();
     ::rust::Box<stellar::rust_bridge::SorobanModuleCache> wait();
+    // Returns true once every contract has been compiled, so wait() won't
+    // block.
+    bool isFinished();
     size_t getBytesCompiled();
     std::chrono::nanoseconds getCompileTime();
     size_t getContractsCompiled();
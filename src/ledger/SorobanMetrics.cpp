@@ -1,4 +1,5 @@
 #include "ledger/SorobanMetrics.h"
+#include "util/HdrHistogram.h"
 
 #include "medida/meter.h"
 #include "medida/metrics_registry.h"
@@ -6,7 +7,8 @@
 
 namespace stellar
 {
-SorobanMetrics::SorobanMetrics(medida::MetricsRegistry& metrics)
+SorobanMetrics::SorobanMetrics(medida::MetricsRegistry& metrics,
+                               HdrMetricsRegistry& hdrMetrics)
     : /* ledger-wide metrics */
     mLedgerTxCount(metrics.NewHistogram({"soroban", "ledger", "tx-count"}))
     , mLedgerCpuInsn(metrics.NewHistogram({"soroban", "ledger", "cpu-insn"}))
@@ -56,11 +58,11 @@ SorobanMetrics::SorobanMetrics(medida::MetricsRegistry& metrics)
           metrics.NewMeter({"soroban", "host-fn-op", "cpu-insn"}, "insn"))
     , mHostFnOpMemByte(
           metrics.NewMeter({"soroban", "host-fn-op", "mem-byte"}, "byte"))
-    , mHostFnOpInvokeTimeNsecs(
-          metrics.NewTimer({"soroban", "host-fn-op", "invoke-time-nsecs"}))
+    , mHostFnOpInvokeTimeNsecs(hdrMetrics.NewTimer(
+          {"soroban", "host-fn-op", "invoke-time-nsecs"}))
     , mHostFnOpCpuInsnExclVm(metrics.NewMeter(
           {"soroban", "host-fn-op", "cpu-insn-excl-vm"}, "insn"))
-    , mHostFnOpInvokeTimeNsecsExclVm(metrics.NewTimer(
+    , mHostFnOpInvokeTimeNsecsExclVm(hdrMetrics.NewTimer(
           {"soroban", "host-fn-op", "invoke-time-nsecs-excl-vm"}))
     , mHostFnOpInvokeTimeFsecsCpuInsnRatio(metrics.NewHistogram(
           {"soroban", "host-fn-op", "invoke-time-fsecs-cpu-insn-ratio"}))
@@ -81,7 +83,7 @@ SorobanMetrics::SorobanMetrics(medida::MetricsRegistry& metrics)
           metrics.NewMeter({"soroban", "host-fn-op", "success"}, "call"))
     , mHostFnOpFailure(
           metrics.NewMeter({"soroban", "host-fn-op", "failure"}, "call"))
-    , mHostFnOpExec(metrics.NewTimer({"soroban", "host-fn-op", "exec"}))
+    , mHostFnOpExec(hdrMetrics.NewTimer({"soroban", "host-fn-op", "exec"}))
     /* ExtendFootprintTTLOp metrics */
     , mExtFpTtlOpReadLedgerByte(metrics.NewMeter(
           {"soroban", "ext-fprint-ttl-op", "read-ledger-byte"}, "byte"))
@@ -153,6 +155,10 @@ SorobanMetrics::SorobanMetrics(medida::MetricsRegistry& metrics)
           {"soroban", "in-memory-state", "contract-code-entries"}))
     , mContractDataEntryCount(metrics.NewCounter(
           {"soroban", "in-memory-state", "contract-data-entries"}))
+    , mInMemoryStateOverheadBytes(metrics.NewCounter(
+          {"soroban", "in-memory-state", "overhead-bytes"}))
+    , mContractCodeSizeRecomputeTime(metrics.NewTimer(
+          {"soroban", "in-memory-state", "code-size-recompute-time"}))
 
 {
 }
@@ -21,6 +21,8 @@ class MetricsRegistry;
 
 namespace stellar
 {
+class HdrMetricsRegistry;
+class HdrTimer;
 
 class SorobanMetrics
 {
@@ -68,9 +70,11 @@ class SorobanMetrics
     medida::Meter& mHostFnOpEmitEventByte;
     medida::Meter& mHostFnOpCpuInsn;
     medida::Meter& mHostFnOpMemByte;
-    medida::Timer& mHostFnOpInvokeTimeNsecs;
+    // Recorded for every invocation, possibly from several apply threads at
+    // once, so lock-free
+    HdrTimer& mHostFnOpInvokeTimeNsecs;
     medida::Meter& mHostFnOpCpuInsnExclVm;
-    medida::Timer& mHostFnOpInvokeTimeNsecsExclVm;
+    HdrTimer& mHostFnOpInvokeTimeNsecsExclVm;
     medida::Histogram& mHostFnOpInvokeTimeFsecsCpuInsnRatio;
     medida::Histogram& mHostFnOpInvokeTimeFsecsCpuInsnRatioExclVm;
     medida::Histogram& mHostFnOpDeclaredInsnsUsageRatio;
@@ -80,7 +84,7 @@ class SorobanMetrics
     medida::Meter& mHostFnOpMaxEmitEventByte;
     medida::Meter& mHostFnOpSuccess;
     medida::Meter& mHostFnOpFailure;
-    medida::Timer& mHostFnOpExec;
+    HdrTimer& mHostFnOpExec;
 
     // `ExtendFootprintTTLOp` metrics
     medida::Meter& mExtFpTtlOpReadLedgerByte;
@@ -124,8 +128,11 @@ class SorobanMetrics
     medida::Counter& mContractDataStateSize;
     medida::Counter& mContractCodeEntryCount;
     medida::Counter& mContractDataEntryCount;
+    medida::Counter& mInMemoryStateOverheadBytes;
+    medida::Timer& mContractCodeSizeRecomputeTime;
 
-    SorobanMetrics(medida::MetricsRegistry& metrics);
+    SorobanMetrics(medida::MetricsRegistry& metrics,
+                   HdrMetricsRegistry& hdrMetrics);
 
     void accumulateModelledCpuInsns(uint64_t insnsCount,
                                     uint64_t insnsExclVmCount,
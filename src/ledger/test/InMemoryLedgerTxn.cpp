@@ -200,7 +200,7 @@ InMemoryLedgerTxn::commitChild(EntryIterator iter,
         auto filteredIter = getFilteredEntryIterator(iter);
         updateLedgerKeyMap(filteredIter);
 
-        LedgerTxn::commitChild(filteredIter, restoredEntries, cons);
+        LedgerTxn::commitChildSubset(filteredIter, restoredEntries, cons);
         mTransaction->commit();
         mTransaction.reset();
     }
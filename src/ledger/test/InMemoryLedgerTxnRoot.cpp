@@ -145,6 +145,11 @@ InMemoryLedgerTxnRoot::prefetch(UnorderedSet<LedgerKey> const&)
     return 0;
 }
 
+void
+InMemoryLedgerTxnRoot::prefetchInBackground(std::vector<LedgerKey> const&)
+{
+}
+
 void InMemoryLedgerTxnRoot::prepareNewObjects(size_t)
 {
 }
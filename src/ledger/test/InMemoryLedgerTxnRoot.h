@@ -79,6 +79,7 @@ class InMemoryLedgerTxnRoot : public AbstractLedgerTxnParent
     void dropOffers() override;
     double getPrefetchHitRate() const override;
     uint32_t prefetch(UnorderedSet<LedgerKey> const& keys) override;
+    void prefetchInBackground(std::vector<LedgerKey> const& keys) override;
 
     void prepareNewObjects(size_t s) override;
     SessionWrapper& getSession() const override;
@@ -11,7 +11,11 @@
 #include "history/HistoryArchiveManager.h"
 #include "history/test/HistoryTestsUtils.h"
 #include "ledger/FlushAndRotateMetaDebugWork.h"
+#include "ledger/DebugMetaWriter.h"
+#include "ledger/IndexedLedgerCloseMeta.h"
+#include "ledger/LedgerManagerImpl.h"
 #include "ledger/LedgerTxn.h"
+#include "ledger/MetaStreamWriter.h"
 #include "ledger/test/LedgerTestUtils.h"
 #include "main/Application.h"
 #include "main/ApplicationUtils.h"
@@ -22,17 +26,23 @@
 #include "test/test.h"
 #include "transactions/test/SorobanTxTestUtils.h"
 #include "util/DebugMetaUtils.h"
+#include "util/GunzipStream.h"
 #include "util/Logging.h"
 #include "util/MetaUtils.h"
 #include "util/ProtocolVersion.h"
 #include "util/XDRCereal.h"
+#include "util/XDRJson.h"
 #include "util/XDRStream.h"
 #include "work/WorkScheduler.h"
 #include "xdr/Stellar-ledger.h"
 #include "xdr/Stellar-transaction.h"
+#include "xdrpp/marshal.h"
 #include <fmt/format.h>
 #include <fstream>
 #include <iterator>
+#include <medida/counter.h>
+#include <medida/metrics_registry.h>
+#include <medida/timer.h>
 
 using namespace stellar;
 
@@ -196,6 +206,58 @@ TEST_CASE("LedgerCloseMetaStream file descriptor - LIVE_NODE",
     }
 }
 
+TEST_CASE("pipelined ledger commit streams meta in order",
+          "[ledgerclosemeta]")
+{
+    TmpDirManager tdm(std::string("metatest-pipelined-") +
+                      binToHex(randomBytes(8)));
+    TmpDir td = tdm.tmpDir("meta-ok");
+    std::string metaPath = td.getName() + "/stream.xdr";
+
+    uint32_t lastClosedLedger = 0;
+    {
+        Config cfg = getTestConfig();
+        cfg.METADATA_OUTPUT_STREAM = metaPath;
+        cfg.EXPERIMENTAL_PIPELINED_LEDGER_COMMIT = true;
+        cfg.METADATA_OUTPUT_STREAM_MAX_PENDING_LEDGERS = GENERATE(1, 4);
+        VirtualClock clock;
+        auto app = createTestApplication(clock, cfg);
+        for (int i = 0; i < 10; ++i)
+        {
+            txtest::closeLedger(*app);
+        }
+        lastClosedLedger = app->getLedgerManager().getLastClosedLedgerNum();
+
+        // The write of the last ledger's meta is finished when the
+        // application shuts down
+    }
+
+    XDRInputFileStream in;
+    in.open(metaPath);
+    LedgerCloseMeta lcm;
+    // We don't stream meta for the genesis ledger
+    uint32_t expectedSeq = 2;
+    while (in.readOne(lcm))
+    {
+        uint32_t ledgerSeq = 0;
+        switch (lcm.v())
+        {
+        case 0:
+            ledgerSeq = lcm.v0().ledgerHeader.header.ledgerSeq;
+            break;
+        case 1:
+            ledgerSeq = lcm.v1().ledgerHeader.header.ledgerSeq;
+            break;
+        default:
+            ledgerSeq = lcm.v2().ledgerHeader.header.ledgerSeq;
+            break;
+        }
+        REQUIRE(ledgerSeq == expectedSeq);
+        ++expectedSeq;
+    }
+    REQUIRE(expectedSeq == lastClosedLedger + 1);
+}
+
 TEST_CASE("METADATA_DEBUG_LEDGERS works", "[metadebug]")
 {
     VirtualClock clock;
@@ -248,6 +310,7 @@ TEST_CASE("METADATA_DEBUG_LEDGERS works", "[metadebug]")
     {
         // Generate just enough meta to not triggers garbage collection
         closeLedgers(cfg.METADATA_DEBUG_LEDGERS);
+        static_cast<LedgerManagerImpl&>(lm).drainMetaDebugForTesting();
         app->gracefulStop();
 
         // Verify presence of the latest debug tx set
@@ -277,6 +340,82 @@ TEST_CASE("METADATA_DEBUG_LEDGERS works", "[metadebug]")
     }
 }
 
+TEST_CASE("debug meta writer rotates segments", "[metadebug]")
+{
+    VirtualClock clock;
+    medida::MetricsRegistry registry;
+    TmpDirManager tdm(std::string("metadebug-") + binToHex(randomBytes(8)));
+    TmpDir td = tdm.tmpDir("segments");
+    auto suffix = DebugMetaWriter::GZIP_SEGMENTS ? ".xdr.gz" : ".xdr";
+    std::filesystem::path first = td.getName() + "/first" + suffix;
+    std::filesystem::path second = td.getName() + "/second" + suffix;
+
+    auto makeMeta = [](uint32_t seq) {
+        LedgerCloseMeta lcm(1);
+        lcm.v1().ledgerHeader.header.ledgerSeq = seq;
+        lcm.v1().totalByteSizeOfLiveSorobanState = seq * 1000;
+        return lcm;
+    };
+
+    // Reads back the ledger sequence numbers of the metas of a segment
+    auto readSegment = [&](std::filesystem::path const& path) {
+        std::ifstream in(path, std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(in)),
+                         std::istreambuf_iterator<char>());
+#ifdef USE_ZLIB
+        std::string unzipped;
+        GunzipStream gunzip([&](char const* d, size_t size) {
+            unzipped.append(d, size);
+        });
+        gunzip.add(data.data(), data.size());
+        gunzip.finish();
+        data = std::move(unzipped);
+#endif
+        std::vector<uint32_t> seqs;
+        size_t pos = 0;
+        while (pos < data.size())
+        {
+            REQUIRE(pos + 4 <= data.size());
+            auto p = reinterpret_cast<uint8_t const*>(data.data()) + pos;
+            uint32_t sz = (uint32_t(p[0] & 0x7f) << 24) |
+                          (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) |
+                          uint32_t(p[3]);
+            REQUIRE(pos + 4 + sz <= data.size());
+            LedgerCloseMeta lcm;
+            xdr::xdr_get g(p + 4, p + 4 + sz);
+            xdr::xdr_argpack_archive(g, lcm);
+            REQUIRE(lcm == makeMeta(lcm.v1().ledgerHeader.header.ledgerSeq));
+            seqs.emplace_back(lcm.v1().ledgerHeader.header.ledgerSeq);
+            pos += 4 + sz;
+        }
+        return seqs;
+    };
+
+    bool rotated = false;
+    {
+        DebugMetaWriter writer(clock.getIOContext(), registry);
+        // Nothing is written before the first segment is opened
+        writer.write(makeMeta(1));
+        writer.rotate(first);
+        writer.write(makeMeta(2));
+        writer.write(makeMeta(3));
+        writer.rotate(second, [&] { rotated = true; });
+        writer.write(makeMeta(4));
+        writer.drain();
+        REQUIRE(rotated);
+        REQUIRE(readSegment(first) == std::vector<uint32_t>{2, 3});
+        // Every ledger is flushed as soon as it's written
+        REQUIRE(readSegment(second) == std::vector<uint32_t>{4});
+        writer.write(makeMeta(5));
+    }
+    REQUIRE(readSegment(second) == std::vector<uint32_t>{4, 5});
+    REQUIRE(registry.NewTimer({"ledger", "meta-debug", "write"}).count() == 4);
+    REQUIRE(registry.NewTimer({"ledger", "meta-debug", "close-segment"})
+                .count() == 2);
+    REQUIRE(registry.NewCounter({"ledger", "meta-debug", "pending-bytes"})
+                .count() == 0);
+}
+
 TEST_CASE_VERSIONS("meta stream contains reasonable meta", "[ledgerclosemeta]")
 {
     auto test = [&](Config cfg, bool isSoroban,
@@ -524,6 +663,8 @@ TEST_CASE_VERSIONS("meta stream contains reasonable meta", "[ledgerclosemeta]")
                     isSoroban ? "-soroban" : "");
                 normalizeMeta(lcm);
                 std::string have = xdrToCerealString(lcm, "LedgerCloseMeta");
+                // The streaming writer produces the same text
+                REQUIRE(xdrToJson(lcm, "LedgerCloseMeta") == have);
                 if (getenv("GENERATE_TEST_LEDGER_CLOSE_META"))
                 {
                     std::ofstream outJson(refJsonPath);
@@ -579,3 +720,165 @@ TEST_CASE_VERSIONS("meta stream contains reasonable meta", "[ledgerclosemeta]")
         }
     }
 }
+
+TEST_CASE("parallel meta serialization matches xdr", "[ledgerclosemeta]")
+{
+    auto entries = LedgerTestUtils::generateValidLedgerEntries(20);
+    auto keys = LedgerTestUtils::generateValidLedgerEntryKeysWithExclusions(
+        {}, 5);
+    auto makeChanges = [&](size_t i) {
+        LedgerEntryChanges changes;
+        auto& change = changes.emplace_back();
+        change.type(LEDGER_ENTRY_CREATED);
+        change.created() = entries[i % entries.size()];
+        return changes;
+    };
+    auto check = [&](LedgerCloseMeta const& meta) {
+        std::vector<char> buf;
+        auto size = serializeLedgerCloseMeta(meta, buf, 4);
+        REQUIRE(size == buf.size() - 4);
+        auto expected = xdr::xdr_to_opaque(meta);
+        REQUIRE(std::equal(buf.begin() + 4, buf.end(), expected.begin(),
+                           expected.end()));
+    };
+
+    // Above and below the size serialized on the calling thread, with a
+    // partial last chunk
+    for (size_t numTxs : {3, 1000})
+    {
+        SECTION(fmt::format("v1 with {} txs", numTxs))
+        {
+            LedgerCloseMeta meta;
+            meta.v(1);
+            auto& m = meta.v1();
+            m.ext.v(1);
+            m.ext.v1().sorobanFeeWrite1KB = 1234;
+            m.ledgerHeader.header.ledgerSeq = 42;
+            m.txSet.v(1);
+            m.txSet.v1TxSet().previousLedgerHash[0] = 1;
+            for (size_t i = 0; i < numTxs; ++i)
+            {
+                auto& tx = m.txProcessing.emplace_back();
+                tx.result.transactionHash[0] = static_cast<uint8_t>(i);
+                tx.feeProcessing = makeChanges(i);
+                tx.txApplyProcessing.v(3);
+                tx.txApplyProcessing.v3().txChangesBefore = makeChanges(i + 1);
+            }
+            m.upgradesProcessing.emplace_back().changes = makeChanges(0);
+            m.scpInfo.emplace_back();
+            m.totalByteSizeOfLiveSorobanState = 5678;
+            m.evictedKeys.assign(keys.begin(), keys.end());
+            m.unused.emplace_back(entries[0]);
+            check(meta);
+        }
+        SECTION(fmt::format("v2 with {} txs", numTxs))
+        {
+            LedgerCloseMeta meta;
+            meta.v(2);
+            auto& m = meta.v2();
+            m.ledgerHeader.header.ledgerSeq = 42;
+            for (size_t i = 0; i < numTxs; ++i)
+            {
+                auto& tx = m.txProcessing.emplace_back();
+                tx.result.transactionHash[0] = static_cast<uint8_t>(i);
+                tx.feeProcessing = makeChanges(i);
+                tx.txApplyProcessing.v(4);
+                tx.txApplyProcessing.v4().txChangesAfter = makeChanges(i + 2);
+                tx.postTxApplyFeeProcessing = makeChanges(i + 3);
+            }
+            m.upgradesProcessing.emplace_back().changes = makeChanges(0);
+            m.totalByteSizeOfLiveSorobanState = 5678;
+            m.evictedKeys.assign(keys.begin(), keys.end());
+            check(meta);
+        }
+    }
+}
+
+TEST_CASE("indexed meta groups changes by type and contract",
+          "[ledgerclosemeta]")
+{
+    auto entries = LedgerTestUtils::generateValidUniqueLedgerEntriesWithTypes(
+        {ACCOUNT, TRUSTLINE, CONTRACT_DATA}, 30);
+    Hash contractA, contractB;
+    contractA[0] = 1;
+    contractB[0] = 2;
+    size_t numContractData = 0;
+    for (auto& e : entries)
+    {
+        if (e.data.type() == CONTRACT_DATA)
+        {
+            auto& addr = e.data.contractData().contract;
+            addr.type(SC_ADDRESS_TYPE_CONTRACT);
+            addr.contractId() = numContractData++ % 2 ? contractA : contractB;
+        }
+    }
+
+    LedgerCloseMeta meta;
+    meta.v(2);
+    auto& m = meta.v2();
+    m.ledgerHeader.header.ledgerSeq = 42;
+    // Expected changes of each section, in order
+    std::map<std::pair<LedgerEntryType, std::optional<Hash>>,
+             LedgerEntryChanges>
+        expected;
+    auto makeChanges = [&](size_t i) {
+        LedgerEntryChanges changes;
+        auto const& e = entries[i % entries.size()];
+        auto& change = changes.emplace_back();
+        change.type(LEDGER_ENTRY_UPDATED);
+        change.updated() = e;
+        std::optional<Hash> contract;
+        if (e.data.type() == CONTRACT_DATA)
+        {
+            contract = e.data.contractData().contract.contractId();
+        }
+        expected[{e.data.type(), contract}].emplace_back(change);
+        return changes;
+    };
+    for (size_t i = 0; i < 100; ++i)
+    {
+        auto& tx = m.txProcessing.emplace_back();
+        tx.feeProcessing = makeChanges(i);
+        tx.txApplyProcessing.v(4);
+        tx.txApplyProcessing.v4().operations.emplace_back().changes =
+            makeChanges(i + 1);
+        tx.postTxApplyFeeProcessing = makeChanges(i + 2);
+    }
+
+    auto compression = GENERATE(IndexedLedgerCloseMeta::Compression::NONE,
+                                IndexedLedgerCloseMeta::Compression::ZLIB);
+    if (compression == IndexedLedgerCloseMeta::Compression::ZLIB &&
+        !IndexedLedgerCloseMeta::supportsCompression())
+    {
+        return;
+    }
+
+    std::vector<char> buf;
+    auto size = IndexedLedgerCloseMeta::serialize(meta, compression, buf, 4);
+    REQUIRE(size == buf.size() - 4);
+    REQUIRE(size % 4 == 0);
+    auto data = buf.data() + 4;
+    auto dir = IndexedLedgerCloseMeta::readDirectory(data, size);
+    REQUIRE(dir.ledgerSeq == 42);
+    REQUIRE(dir.compression == compression);
+    REQUIRE(dir.sections.size() == 1 + expected.size());
+
+    auto const& first = dir.sections.front();
+    REQUIRE(first.kind ==
+            IndexedLedgerCloseMeta::SectionKind::LEDGER_CLOSE_META);
+    auto metaXdr = IndexedLedgerCloseMeta::readSection(data, size, dir, first);
+    auto expectedXdr = xdr::xdr_to_opaque(meta);
+    REQUIRE(std::equal(metaXdr.begin(), metaXdr.end(), expectedXdr.begin(),
+                       expectedXdr.end()));
+
+    for (size_t i = 1; i < dir.sections.size(); ++i)
+    {
+        auto const& s = dir.sections[i];
+        REQUIRE(s.kind ==
+                IndexedLedgerCloseMeta::SectionKind::LEDGER_ENTRY_CHANGES);
+        LedgerEntryChanges changes;
+        xdr::xdr_from_opaque(
+            IndexedLedgerCloseMeta::readSection(data, size, dir, s), changes);
+        REQUIRE(changes == expected.at({s.entryType, s.contractID}));
+    }
+}
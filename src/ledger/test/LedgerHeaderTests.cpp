@@ -4,8 +4,10 @@
 
 #include "util/asio.h"
 #include "crypto/Hex.h"
+#include "crypto/SHA.h"
 #include "herder/Herder.h"
 #include "herder/LedgerCloseData.h"
+#include "ledger/LedgerHeaderRing.h"
 #include "ledger/LedgerManager.h"
 #include "ledger/LedgerTxn.h"
 #include "ledger/LedgerTxnHeader.h"
@@ -17,6 +19,8 @@
 #include "util/Logging.h"
 #include "util/Timer.h"
 #include "xdrpp/marshal.h"
+#include <medida/meter.h>
+#include <medida/metrics_registry.h>
 
 #include "main/Config.h"
 
@@ -94,6 +98,37 @@ TEST_CASE("ledgerheader", "[ledger]")
     }
 }
 
+TEST_CASE("ledger header ring", "[ledger]")
+{
+    medida::MetricsRegistry registry;
+    LedgerHeaderRing ring(4, registry);
+    std::vector<Hash> hashes;
+    for (uint32_t seq = 1; seq <= 6; ++seq)
+    {
+        LedgerHeader header;
+        header.ledgerSeq = seq;
+        hashes.emplace_back(xdrSha256(header));
+        ring.add(header, hashes.back());
+    }
+
+    // The first two headers were overwritten
+    REQUIRE(!ring.getBySequence(1));
+    REQUIRE(!ring.getByHash(hashes[1]));
+    for (uint32_t seq = 3; seq <= 6; ++seq)
+    {
+        REQUIRE(ring.getBySequence(seq)->ledgerSeq == seq);
+        REQUIRE(ring.getByHash(hashes[seq - 1])->ledgerSeq == seq);
+    }
+    REQUIRE(registry.NewMeter({"ledger", "header-ring", "hit"}, "header")
+                .count() == 8);
+    REQUIRE(registry.NewMeter({"ledger", "header-ring", "miss"}, "header")
+                .count() == 2);
+
+    ring.clear();
+    REQUIRE(!ring.getBySequence(6));
+    REQUIRE(!ring.getByHash(hashes[5]));
+}
+
 TEST_CASE_VERSIONS("base reserve", "[ledger]")
 {
     Config const& cfg = getTestConfig();
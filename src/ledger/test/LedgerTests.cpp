@@ -3,12 +3,22 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "herder/Herder.h"
+#include "ledger/LedgerCloseMetaFrame.h"
+#include "ledger/LedgerCloseTimeline.h"
 #include "ledger/LedgerManager.h"
 #include "ledger/LedgerTxn.h"
 #include "main/Application.h"
+#include "test/TestAccount.h"
+#include "test/TestUtils.h"
+#include "test/TxTests.h"
 #include "test/test.h"
+#include "xdrpp/marshal.h"
+#include <fmt/format.h>
+#include <json/json.h>
 
 #include <lib/catch.hpp>
+#include <set>
+#include <thread>
 
 using namespace stellar;
 
@@ -45,3 +55,203 @@ TEST_CASE("cannot close ledger with unsupported ledger version", "[ledger]")
     }
     REQUIRE_THROWS_AS(applyEmptyLedger(), std::runtime_error);
 }
+
+TEST_CASE("parallel fee processing matches serial", "[ledger]")
+{
+    // Closes the same ledger with the given number of fee processing threads
+    // and returns its meta
+    auto closeWithFeeThreads = [](uint32_t feeThreads) {
+        VirtualClock clock;
+        auto cfg = getTestConfig();
+        cfg.TESTING_UPGRADE_MAX_TX_SET_SIZE = 1000;
+        cfg.FEE_PROCESSING_THREADS = feeThreads;
+        auto app = createTestApplication(clock, cfg);
+        auto root = app->getRoot();
+
+        std::vector<TestAccount> accounts;
+        for (int i = 0; i < 20; ++i)
+        {
+            accounts.emplace_back(
+                root->create(fmt::format("acc{}", i), 10'000'000'000));
+        }
+        txtest::closeLedger(*app);
+
+        // Several transactions per fee source, including fee bumps paying
+        // for another account's transaction
+        std::vector<TransactionFrameBasePtr> txs;
+        for (size_t i = 0; i < accounts.size(); ++i)
+        {
+            auto& acc = accounts[i];
+            for (int j = 0; j < 5; ++j)
+            {
+                txs.emplace_back(acc.tx({txtest::payment(*root, 1000)}));
+            }
+            auto inner = acc.tx({txtest::payment(*root, 1000)});
+            txs.emplace_back(txtest::feeBump(
+                *app, accounts[(i + 1) % accounts.size()], inner, 400));
+        }
+        REQUIRE(txs.size() == 120);
+
+        auto results = txtest::closeLedger(*app, txs);
+        REQUIRE(results.results.size() == txs.size());
+        auto const& meta =
+            app->getLedgerManager().getLastClosedLedgerCloseMeta();
+        REQUIRE(meta);
+        return xdr::xdr_to_opaque(meta->getXDR());
+    };
+
+    auto serial = closeWithFeeThreads(1);
+    REQUIRE(closeWithFeeThreads(4) == serial);
+}
+
+TEST_CASE("signature preverification matches serial", "[ledger]")
+{
+    // Closes the same ledger with the given number of preverify threads and
+    // returns its meta
+    auto closeWithPreverifyThreads = [](uint32_t threads) {
+        VirtualClock clock;
+        auto cfg = getTestConfig();
+        cfg.TESTING_UPGRADE_MAX_TX_SET_SIZE = 1000;
+        cfg.CLASSIC_SIGNATURE_PREVERIFY_THREADS = threads;
+        auto app = createTestApplication(clock, cfg);
+        auto root = app->getRoot();
+
+        std::vector<TestAccount> accounts;
+        for (int i = 0; i < 20; ++i)
+        {
+            accounts.emplace_back(
+                root->create(fmt::format("acc{}", i), 10'000'000'000));
+        }
+        txtest::closeLedger(*app);
+
+        // Plain payments, payments with an operation sourced from (and
+        // signed by) another account, ones missing that signature and fee
+        // bumps
+        std::vector<TransactionFrameBasePtr> txs;
+        for (size_t i = 0; i < accounts.size(); ++i)
+        {
+            auto& acc = accounts[i];
+            auto& other = accounts[(i + 1) % accounts.size()];
+            txs.emplace_back(acc.tx({txtest::payment(*root, 1000)}));
+
+            auto opSourced = acc.tx({txtest::payment(*root, 1000),
+                                     other.op(txtest::payment(*root, 10))});
+            if (i % 2 == 0)
+            {
+                opSourced->addSignature(other.getSecretKey());
+            }
+            txs.emplace_back(opSourced);
+
+            auto inner = acc.tx({txtest::payment(*root, 1000)});
+            txs.emplace_back(txtest::feeBump(*app, other, inner, 400));
+        }
+
+        // Keep the transactions missing a signature in the ledger
+        auto results = txtest::closeLedger(*app, txs, /* strictOrder */ true);
+        REQUIRE(results.results.size() == txs.size());
+        auto const& meta =
+            app->getLedgerManager().getLastClosedLedgerCloseMeta();
+        REQUIRE(meta);
+        return xdr::xdr_to_opaque(meta->getXDR());
+    };
+
+    auto serial = closeWithPreverifyThreads(0);
+    REQUIRE(closeWithPreverifyThreads(1) == serial);
+    REQUIRE(closeWithPreverifyThreads(4) == serial);
+}
+
+TEST_CASE("ledger close timeline", "[ledger]")
+{
+    VirtualClock clock;
+    auto app = createTestApplication(clock, getTestConfig());
+    auto root = app->getRoot();
+    auto acc = root->create("acc", 10'000'000'000);
+    txtest::closeLedger(*app);
+    txtest::closeLedger(*app, {acc.tx({txtest::payment(*root, 1000)})});
+
+    auto const& timeline = app->getLedgerManager().getCloseTimeline();
+    auto lcl = app->getLedgerManager().getLastClosedLedgerNum();
+
+    SECTION("json")
+    {
+        auto res = timeline.getJson(2);
+        REQUIRE(res["ledgers"].size() == 2);
+        auto const& last = res["ledgers"][1];
+        REQUIRE(last["ledger"].asUInt() == lcl);
+        REQUIRE(res["ledgers"][0]["ledger"].asUInt() == lcl - 1);
+
+        std::set<std::string> names;
+        for (auto const& span : last["spans"])
+        {
+            names.insert(span["name"].asString());
+            REQUIRE(span["start_us"].asInt64() >= 0);
+            REQUIRE(span["start_us"].asInt64() +
+                        span["duration_us"].asInt64() <=
+                    last["duration_us"].asInt64());
+        }
+        for (auto const& name :
+             {"prefetch", "fees", "apply transactions", "seal", "commit"})
+        {
+            REQUIRE(names.count(name) == 1);
+        }
+
+        // Asking for more ledgers than were applied returns all of them;
+        // the genesis ledger is never applied
+        REQUIRE(timeline.getJson(1000)["ledgers"].size() == lcl - 1);
+        REQUIRE(timeline.getJson(0)["ledgers"].empty());
+    }
+
+    SECTION("chrome trace")
+    {
+        auto res = timeline.getChromeTraceJson(1);
+        auto const& events = res["traceEvents"];
+        auto numSpans = timeline.getJson(1)["ledgers"][0]["spans"].size();
+        REQUIRE(events.size() == numSpans + 1);
+        REQUIRE(events[0]["name"].asString() ==
+                "ledger " + std::to_string(lcl));
+        for (auto const& e : events)
+        {
+            REQUIRE(e["ph"].asString() == "X");
+            REQUIRE(e["args"]["ledger"].asUInt() == lcl);
+        }
+    }
+}
+
+TEST_CASE("ledger close timeline keeps the last ledgers", "[ledger]")
+{
+    LedgerCloseTimeline timeline(3);
+
+    // Spans outside of a ledger are dropped
+    {
+        LedgerCloseTimeline::Span span(timeline, "outside");
+    }
+    REQUIRE(timeline.getJson(10)["ledgers"].empty());
+
+    for (uint32_t seq = 1; seq <= 5; ++seq)
+    {
+        timeline.startLedger(seq);
+        {
+            LedgerCloseTimeline::Span span(timeline, "main");
+        }
+        std::thread([&]() {
+            LedgerCloseTimeline::Span span(timeline, "worker");
+        }).join();
+        timeline.finishLedger();
+    }
+
+    // A ledger that never finishes is not reported
+    timeline.startLedger(6);
+
+    auto res = timeline.getJson(10);
+    REQUIRE(res["ledgers"].size() == 3);
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        auto const& ledger = res["ledgers"][i];
+        REQUIRE(ledger["ledger"].asUInt() == i + 3);
+        REQUIRE(ledger["spans"].size() == 2);
+        REQUIRE(ledger["spans"][0]["name"].asString() == "main");
+        REQUIRE(ledger["spans"][0]["thread"].asUInt() == 0);
+        REQUIRE(ledger["spans"][1]["name"].asString() == "worker");
+        REQUIRE(ledger["spans"][1]["thread"].asUInt() == 1);
+    }
+}
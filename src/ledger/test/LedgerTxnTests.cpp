@@ -12,6 +12,8 @@
 #include "lib/util/stdrandom.h"
 #include "main/Application.h"
 #include "main/Config.h"
+#include "medida/meter.h"
+#include "medida/metrics_registry.h"
 #include "test/Catch2.h"
 #include "test/TestAccount.h"
 #include "test/TestUtils.h"
@@ -1807,6 +1809,49 @@ testAllOffers(
     }
 }
 
+TEST_CASE("LedgerTxn hasConfigSettingChangesWithoutSealing", "[ledgertxn]")
+{
+    VirtualClock clock;
+    auto app = createTestApplication(clock, getTestConfig());
+
+    LedgerKey key(CONFIG_SETTING);
+    key.configSetting().configSettingID =
+        CONFIG_SETTING_CONTRACT_MAX_SIZE_BYTES;
+
+    LedgerTxn ltx1(app->getLedgerTxnRoot());
+    REQUIRE(!ltx1.hasConfigSettingChangesWithoutSealing());
+
+    SECTION("other entries are ignored")
+    {
+        REQUIRE(ltx1.create(
+            LedgerTestUtils::generateValidLedgerEntryWithExclusions(
+                {CONFIG_SETTING})));
+        REQUIRE(!ltx1.hasConfigSettingChangesWithoutSealing());
+    }
+
+    SECTION("loaded entries are not changes")
+    {
+        auto entry = ltx1.load(key);
+        REQUIRE(entry);
+        REQUIRE(!ltx1.hasConfigSettingChangesWithoutSealing());
+    }
+
+    SECTION("updated entries are changes")
+    {
+        {
+            LedgerTxn ltx2(ltx1);
+            auto entry = ltx2.load(key);
+            ++entry.current().data.configSetting().contractMaxSizeBytes();
+            REQUIRE(ltx2.hasConfigSettingChangesWithoutSealing());
+            ltx2.commit();
+        }
+        REQUIRE(ltx1.hasConfigSettingChangesWithoutSealing());
+
+        // Doesn't seal
+        REQUIRE_NOTHROW(ltx1.load(key));
+    }
+}
+
 TEST_CASE("LedgerTxn loadAllOffers", "[ledgertxn]")
 {
     auto runTest = [&](Config::TestDbMode mode) {
@@ -2802,6 +2847,60 @@ TEST_CASE("LedgerTxnRoot prefetch classic entries", "[ledgertxn]")
             REQUIRE(root.prefetch(keysToPrefetch) == keysToPrefetch.size());
             ltx2.commit();
         }
+        SECTION("prefetch in background")
+        {
+            // Several batches, with a duplicate and a key that doesn't exist
+            std::vector<LedgerKey> keys;
+            for (auto const& k : keysToPrefetch)
+            {
+                keys.emplace_back(k);
+                if (keys.size() > (cfg.ENTRY_CACHE_SIZE / 3))
+                {
+                    break;
+                }
+            }
+            keys.emplace_back(keys.front());
+            auto missing =
+                LedgerTestUtils::generateValidLedgerEntryWithExclusions(
+                    {CONFIG_SETTING, CONTRACT_CODE, CONTRACT_DATA, TTL});
+            keys.emplace_back(LedgerEntryKey(missing));
+
+            LedgerTxn ltx2(root);
+            root.prefetchInBackground(keys);
+
+            // Load in reverse, so most loads have to wait for their batch
+            for (auto it = keys.rbegin(); it != keys.rend(); ++it)
+            {
+                auto txle = ltx2.load(*it);
+                if (*it == LedgerEntryKey(missing))
+                {
+                    REQUIRE(!txle);
+                }
+                else
+                {
+                    REQUIRE(txle);
+                    REQUIRE(entrySet.find(txle.current()) != entrySet.end());
+                }
+            }
+            REQUIRE(fabs(ltx2.getPrefetchHitRate() - 1.0f) <
+                    std::numeric_limits<float>::epsilon());
+            ltx2.commit();
+        }
+        SECTION("commit while prefetching in background")
+        {
+            std::vector<LedgerKey> keys(keysToPrefetch.begin(),
+                                        keysToPrefetch.end());
+            root.prefetchInBackground(keys);
+            {
+                LedgerTxn ltx2(root);
+                ltx2.commit();
+            }
+
+            // Nothing loaded before the commit reaches the entry cache
+            LedgerTxn ltx3(root);
+            REQUIRE(ltx3.load(keys.front()));
+            REQUIRE(ltx3.getPrefetchHitRate() == 0);
+        }
     };
 
     SECTION("bucketlist")
@@ -3241,6 +3340,33 @@ TEST_CASE("LedgerTxn in memory order book", "[ledgertxn]")
             }
         }
 
+        SECTION("offers committed into a parent with no entries")
+        {
+            LedgerEntry le1;
+            le1.data.type(OFFER);
+            le1.data.offer() = LedgerTestUtils::generateValidOfferEntry();
+            LedgerEntry le2 = generateOfferWithSameAssets(le1);
+            AssetPair assets{le1.data.offer().buying, le1.data.offer().selling};
+
+            LedgerTxn ltx(app->getLedgerTxnRoot());
+            {
+                // The parent takes over the child's entries as they are
+                LedgerTxn ltxChild(ltx);
+                ltxChild.create(le1);
+                ltxChild.create(le2);
+                ltxChild.commit();
+            }
+            checkOrderBook(ltx, {{assets, {le1, le2}}});
+            REQUIRE(ltx.load(LedgerEntryKey(le1)));
+
+            {
+                LedgerTxn ltxChild(ltx);
+                ltxChild.erase(LedgerEntryKey(le1));
+                ltxChild.commit();
+            }
+            checkOrderBook(ltx, {{assets, {le2}}});
+        }
+
         SECTION("two offers, one asset pair")
         {
             LedgerEntry le1a;
@@ -3791,6 +3917,104 @@ TEST_CASE("LedgerTxn best offers cache eviction", "[ledgertxn]")
     }
 }
 
+TEST_CASE("LedgerTxn best offers cache across commits", "[ledgertxn]")
+{
+    VirtualClock clock;
+    auto cfg = getTestConfig(0, Config::TESTDB_BUCKET_DB_VOLATILE);
+    // Load best offers in small batches, so the cache only holds some of them
+    cfg.PREFETCH_BATCH_SIZE = 5;
+    auto app = createTestApplication(clock, cfg);
+
+    auto buying = autocheck::generator<Asset>()(UINT32_MAX);
+    auto selling = autocheck::generator<Asset>()(UINT32_MAX);
+    while (buying == selling)
+    {
+        selling = autocheck::generator<Asset>()(UINT32_MAX);
+    }
+
+    auto makeOffer = [&](int64_t offerID, int32_t priceN) {
+        LedgerEntry le;
+        le.data.type(OFFER);
+        auto& oe = le.data.offer();
+        oe.offerID = offerID;
+        oe.price = Price{priceN, 1};
+        oe.buying = buying;
+        oe.selling = selling;
+        return le;
+    };
+
+    // Returns the IDs of all offers for the pair, best first
+    auto getOrder = [&](Asset const& b, Asset const& s) {
+        std::vector<int64_t> ids;
+        LedgerTxn ltx(app->getLedgerTxnRoot());
+        while (auto ltxe = ltx.loadBestOffer(b, s))
+        {
+            ids.emplace_back(ltxe.current().data.offer().offerID);
+            ltxe.erase();
+        }
+        return ids;
+    };
+
+    {
+        LedgerTxn ltx(app->getLedgerTxnRoot());
+        for (int32_t i = 1; i <= 20; ++i)
+        {
+            ltx.create(makeOffer(i, 10 * i));
+        }
+        ltx.commit();
+    }
+
+    // Load the first batch into the cache
+    {
+        LedgerTxn ltx(app->getLedgerTxnRoot());
+        REQUIRE(ltx.loadBestOffer(buying, selling)
+                    .current()
+                    .data.offer()
+                    .offerID == 1);
+    }
+
+    std::vector<int64_t> expected;
+    for (int64_t i = 1; i <= 20; ++i)
+    {
+        expected.emplace_back(i);
+    }
+
+    SECTION("new offers")
+    {
+        // One offer inside the cached batch, one after it
+        LedgerTxn ltx(app->getLedgerTxnRoot());
+        ltx.create(makeOffer(21, 25));
+        ltx.create(makeOffer(22, 95));
+        ltx.commit();
+
+        expected.insert(expected.begin() + 2, 21);
+        expected.insert(expected.begin() + 10, 22);
+        REQUIRE(getOrder(buying, selling) == expected);
+    }
+
+    SECTION("modified and deleted offers")
+    {
+        {
+            LedgerTxn ltx(app->getLedgerTxnRoot());
+            auto o1 = ltx.load(LedgerEntryKey(makeOffer(1, 10)));
+            o1.erase();
+            auto o3 = ltx.load(LedgerEntryKey(makeOffer(3, 30)));
+            o3.current().data.offer().price = Price{1000, 1};
+            auto o12 = ltx.load(LedgerEntryKey(makeOffer(12, 120)));
+            o12.current().data.offer().price = Price{1, 1};
+            auto o4 = ltx.load(LedgerEntryKey(makeOffer(4, 40)));
+            std::swap(o4.current().data.offer().buying,
+                      o4.current().data.offer().selling);
+            ltx.commit();
+        }
+
+        expected = {12, 2, 5, 6, 7, 8, 9, 10, 11, 13, 14, 15, 16, 17, 18, 19,
+                    20, 3};
+        REQUIRE(getOrder(buying, selling) == expected);
+        REQUIRE(getOrder(selling, buying) == std::vector<int64_t>{4});
+    }
+}
+
 typedef std::map<std::tuple<AccountID, Asset, Asset>, int64_t> PoolShareUpdates;
 typedef std::map<std::pair<Asset, Asset>, int64_t> LiquidityPoolUpdates;
 
@@ -3979,6 +4203,73 @@ testPoolShareTrustLinesByAccountAndAsset(
     }
 }
 
+TEST_CASE("LedgerTxnRoot entry cache across commits", "[ledgertxn]")
+{
+    VirtualClock clock;
+    auto cfg = getTestConfig(0, Config::TESTDB_BUCKET_DB_VOLATILE);
+    auto app = createTestApplication(clock, cfg);
+    auto& root = app->getLedgerTxnRoot();
+    auto& hits = app->getMetrics().NewMeter(
+        {"ledger-entry-cache", "ACCOUNT", "hit"}, "entry");
+    auto& misses = app->getMetrics().NewMeter(
+        {"ledger-entry-cache", "ACCOUNT", "miss"}, "entry");
+
+    auto le = LedgerTestUtils::generateValidLedgerEntryOfType(ACCOUNT);
+    le.data.account().balance = 100;
+    le.lastModifiedLedgerSeq = 1;
+    auto key = LedgerEntryKey(le);
+    LedgerHeader lh;
+    lh.ledgerVersion = app->getLedgerManager()
+                           .getLastClosedLedgerHeader()
+                           .header.ledgerVersion;
+    lh.ledgerSeq = 2;
+    BucketTestUtils::addLiveBatchAndUpdateSnapshot(*app, lh, {}, {le}, {});
+
+    // Cache the account
+    {
+        LedgerTxn ltx(root);
+        REQUIRE(ltx.load(key));
+    }
+    auto hitsBefore = hits.count();
+    auto missesBefore = misses.count();
+
+    // The BucketList isn't updated below, so the new states of the account
+    // can only come from the cache
+    {
+        LedgerTxn ltx(root);
+        auto ltxe = ltx.load(key);
+        ltxe.current().data.account().balance = 200;
+        ltx.commit();
+    }
+    {
+        LedgerTxn ltx(root);
+        auto ltxe = ltx.load(key);
+        REQUIRE(ltxe.current().data.account().balance == 200);
+        ltxe.erase();
+        ltx.commit();
+    }
+    {
+        LedgerTxn ltx(root);
+        REQUIRE(!ltx.load(key));
+    }
+    REQUIRE(hits.count() == hitsBefore + 3);
+    REQUIRE(misses.count() == missesBefore);
+
+    SECTION("cleared by a commit that skips ledgers")
+    {
+        {
+            LedgerTxn ltx(root);
+            ltx.loadHeader().current().ledgerSeq += 2;
+            ltx.commit();
+        }
+        LedgerTxn ltx(root);
+        auto ltxe = ltx.load(key);
+        REQUIRE(ltxe);
+        REQUIRE(ltxe.current().data.account().balance == 100);
+        REQUIRE(misses.count() == missesBefore + 1);
+    }
+}
+
 TEST_CASE_VERSIONS("LedgerTxn loadPoolShareTrustLinesByAccountAndAsset",
                    "[ledgertxn]")
 {
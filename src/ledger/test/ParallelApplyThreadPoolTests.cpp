@@ -0,0 +1,65 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "ledger/ParallelApplyThreadPool.h"
+#include "test/Catch2.h"
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace stellar;
+
+TEST_CASE("parallel apply thread pool runs every task once", "[ledger]")
+{
+    // Pinning is best-effort, and doesn't change which tasks run
+    bool pinThreads = GENERATE(false, true);
+    ParallelApplyThreadPool pool(pinThreads);
+
+    // Reuse the pool for jobs of different sizes, growing and shrinking the
+    // number of threads taking part
+    for (auto [numTasks, numThreads] :
+         std::vector<std::pair<size_t, size_t>>{
+             {0, 4}, {1, 4}, {10, 4}, {100, 2}, {3, 8}, {50, 1}, {64, 8}})
+    {
+        std::vector<int> runs(numTasks, 0);
+        std::mutex mutex;
+        std::set<std::thread::id> threads;
+        auto busy = pool.run(numTasks, numThreads, [&](size_t i) {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++runs[i];
+            threads.insert(std::this_thread::get_id());
+        });
+
+        REQUIRE(busy.size() == std::min(numTasks, numThreads));
+        REQUIRE(threads.size() <= busy.size());
+        for (auto const& r : runs)
+        {
+            REQUIRE(r == 1);
+        }
+    }
+}
+
+TEST_CASE("parallel apply thread pool rethrows after all tasks ran",
+          "[ledger]")
+{
+    ParallelApplyThreadPool pool;
+    std::atomic<size_t> numRun{0};
+    auto task = [&](size_t i) {
+        ++numRun;
+        if (i % 10 == 3)
+        {
+            throw std::runtime_error("task failed");
+        }
+    };
+    REQUIRE_THROWS_AS(pool.run(40, 4, task), std::runtime_error);
+    REQUIRE(numRun == 40);
+
+    // The pool is still usable afterwards
+    numRun = 0;
+    pool.run(8, 4, [&](size_t) { ++numRun; });
+    REQUIRE(numRun == 8);
+}
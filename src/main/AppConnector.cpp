@@ -8,6 +8,7 @@
 #include "overlay/OverlayManager.h"
 #include "overlay/OverlayMetrics.h"
 #include "overlay/Peer.h"
+#include "overlay/PeerAuth.h"
 #include "util/Timer.h"
 
 namespace stellar
@@ -81,6 +82,12 @@ AppConnector::checkOnOperationApply(Operation const& operation,
                                                      events);
 }
 
+bool
+AppConnector::isOperationApplyInvariantEnabled() const
+{
+    return mApp.getInvariantManager().isOperationApplyInvariantEnabled();
+}
+
 Hash const&
 AppConnector::getNetworkID() const
 {
@@ -97,9 +104,18 @@ AppConnector::postOnMainThread(std::function<void()>&& f, std::string&& message,
 
 void
 AppConnector::postOnOverlayThread(std::function<void()>&& f,
-                                  std::string const& message)
+                                  std::string const& message,
+                                  asio::io_context* ioContext)
+{
+    mApp.postOnOverlayThread(std::move(f), message, ioContext);
+}
+
+void
+AppConnector::postOnBackgroundThread(std::function<void()>&& f,
+                                     std::string jobName,
+                                     BackgroundWorkClass cls)
 {
-    mApp.postOnOverlayThread(std::move(f), message);
+    mApp.postOnBackgroundThread(std::move(f), std::move(jobName), cls);
 }
 
 Config const&
@@ -120,6 +136,12 @@ AppConnector::overlayShuttingDown() const
     return mApp.getOverlayManager().isShuttingDown();
 }
 
+bool
+AppConnector::isSCPSlotAboveMinimum(uint64_t slotIndex) const
+{
+    return mApp.getHerder().isSCPSlotAboveMinimum(slotIndex);
+}
+
 VirtualClock::time_point
 AppConnector::now() const
 {
@@ -147,6 +169,18 @@ AppConnector::checkScheduledAndCache(
     return mApp.getOverlayManager().checkScheduledAndCache(msgTracker);
 }
 
+bool
+AppConnector::isKnownSCPMessage(Hash const& msgID)
+{
+    return mApp.getOverlayManager().isKnownSCPMessage(msgID);
+}
+
+PeerAuth&
+AppConnector::getPeerAuth()
+{
+    return mApp.getOverlayManager().getPeerAuth();
+}
+
 bool
 AppConnector::threadIsType(Application::ThreadType type) const
 {
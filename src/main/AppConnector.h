@@ -18,6 +18,7 @@ class SorobanMetrics;
 class SearchableHotArchiveBucketListSnapshot;
 struct LedgerTxnDelta;
 class CapacityTrackedMessage;
+class PeerAuth;
 
 // Helper class to isolate access to Application; all function helpers must
 // either be called from main or be thread-safe
@@ -41,6 +42,9 @@ class AppConnector
                                OperationResult const& opres,
                                LedgerTxnDelta const& ltxDelta,
                                std::vector<ContractEvent> const& events);
+    // Whether checkOnOperationApply checks anything, so callers can skip
+    // building its arguments
+    bool isOperationApplyInvariantEnabled() const;
     Hash const& getNetworkID() const;
 
     // Thread-safe methods
@@ -49,15 +53,25 @@ class AppConnector
         std::function<void()>&& f, std::string&& message,
         Scheduler::ActionType type = Scheduler::ActionType::NORMAL_ACTION);
     void postOnOverlayThread(std::function<void()>&& f,
-                             std::string const& message);
+                             std::string const& message,
+                             asio::io_context* ioContext = nullptr);
+    void postOnBackgroundThread(std::function<void()>&& f,
+                                std::string jobName, BackgroundWorkClass cls);
     VirtualClock::time_point now() const;
     Config const& getConfig() const;
     rust::Box<rust_bridge::SorobanModuleCache> getModuleCache();
     bool overlayShuttingDown() const;
+    // See Herder::isSCPSlotAboveMinimum
+    bool isSCPSlotAboveMinimum(uint64_t slotIndex) const;
     OverlayMetrics& getOverlayMetrics();
-    // This method is always exclusively called from one thread
+    // Safe to call from any overlay thread
     bool
     checkScheduledAndCache(std::shared_ptr<CapacityTrackedMessage> msgTracker);
+    // Safe to call from any overlay thread
+    bool isKnownSCPMessage(Hash const& msgID);
+    // Only the threadsafe methods of PeerAuth may be called off the main
+    // thread
+    PeerAuth& getPeerAuth();
     SorobanNetworkConfig const& getLastClosedSorobanNetworkConfig() const;
     SorobanNetworkConfig const& getSorobanNetworkConfigForApply() const;
     bool threadIsType(Application::ThreadType type) const;
@@ -72,8 +86,8 @@ class AppConnector
     void
     maybeCopySearchableBucketListSnapshot(SearchableSnapshotConstPtr& snapshot);
 
-    // Get a snapshot of ledger state for use by the overlay thread only. Must
-    // only be called from the overlay thread.
+    // Get a snapshot of ledger state for use by the calling overlay thread
+    // only. Must only be called from an overlay thread.
     SearchableSnapshotConstPtr& getOverlayThreadSnapshot();
 
 #ifdef BUILD_TESTS
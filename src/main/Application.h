@@ -5,6 +5,7 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "main/Config.h"
+#include "util/BackgroundWorkQueue.h"
 #include "xdr/Stellar-ledger-entries.h"
 #include "xdr/Stellar-types.h"
 #include <lib/json/json.h>
@@ -24,6 +25,7 @@ namespace stellar
 {
 
 class VirtualClock;
+class HdrMetricsRegistry;
 class TmpDirManager;
 class LedgerManager;
 class BucketManager;
@@ -42,6 +44,7 @@ class CommandHandler;
 class WorkScheduler;
 class BanManager;
 class StatusManager;
+class StartupProfiler;
 class AbstractLedgerTxnParent;
 class BasicWork;
 enum class LoadGenMode;
@@ -204,6 +207,11 @@ class Application
     // reported through the administrative HTTP interface, see CommandHandler.
     virtual medida::MetricsRegistry& getMetrics() = 0;
 
+    // Get the registry of the lock-free HdrTimers owned by this application,
+    // used instead of medida's timers on hot paths. They are reported along
+    // with the metrics above.
+    virtual HdrMetricsRegistry& getHdrMetrics() = 0;
+
     // Ensure any App-local metrics that are "current state" gauge-like counters
     // reflect the current reality as best as possible.
     virtual void syncOwnMetrics() = 0;
@@ -233,12 +241,15 @@ class Application
     virtual WorkScheduler& getWorkScheduler() = 0;
     virtual BanManager& getBanManager() = 0;
     virtual StatusManager& getStatusManager() = 0;
+    virtual StartupProfiler& getStartupProfiler() = 0;
 
     // Get the worker IO service, served by background threads. Work posted to
     // this io_context will execute in parallel with the calling thread, so use
     // with caution.
     virtual asio::io_context& getWorkerIOContext() = 0;
     virtual asio::io_context& getEvictionIOContext() = 0;
+    // Returns the io_context of one of the overlay threads, round-robin. A
+    // peer's socket is created on it and the peer stays on that thread.
     virtual asio::io_context& getOverlayIOContext() = 0;
     virtual asio::io_context& getLedgerCloseIOContext() = 0;
 
@@ -247,13 +258,18 @@ class Application
         Scheduler::ActionType type = Scheduler::ActionType::NORMAL_ACTION) = 0;
 
     // While both are lower priority than the main thread, eviction threads have
-    // more priority than regular worker background threads
+    // more priority than regular worker background threads. Among themselves,
+    // worker threads start tasks of a more urgent class first.
     virtual void postOnBackgroundThread(std::function<void()>&& f,
-                                        std::string jobName) = 0;
+                                        std::string jobName,
+                                        BackgroundWorkClass cls) = 0;
     virtual void postOnEvictionBackgroundThread(std::function<void()>&& f,
                                                 std::string jobName) = 0;
+    // Runs f on the overlay thread serving ioContext, or on the first overlay
+    // thread if ioContext is null
     virtual void postOnOverlayThread(std::function<void()>&& f,
-                                     std::string jobName) = 0;
+                                     std::string jobName,
+                                     asio::io_context* ioContext = nullptr) = 0;
     virtual void postOnLedgerCloseThread(std::function<void()>&& f,
                                          std::string jobName) = 0;
 
@@ -289,6 +305,8 @@ class Application
 
     // Access the load generator for manual operation.
     virtual LoadGenerator& getLoadGenerator() = 0;
+    // The load generator if it was ever accessed, nullptr otherwise
+    virtual LoadGenerator* getLoadGeneratorIfCreated() = 0;
 
     virtual std::shared_ptr<TestAccount> getRoot() = 0;
 
@@ -41,6 +41,7 @@
 #include "main/ApplicationUtils.h"
 #include "main/CommandHandler.h"
 #include "main/Maintainer.h"
+#include "main/StartupProfiler.h"
 #include "main/StellarCoreVersion.h"
 #include "medida/counter.h"
 #include "medida/meter.h"
@@ -52,8 +53,10 @@
 #include "overlay/OverlayManagerImpl.h"
 #include "process/ProcessManager.h"
 #include "util/GlobalChecks.h"
+#include "util/HdrHistogram.h"
 #include "util/LogSlowExecution.h"
 #include "util/Logging.h"
+#include "util/MemoryAccounting.h"
 #include "util/StatusManager.h"
 #include "util/Thread.h"
 #include "util/TmpDir.h"
@@ -89,12 +92,6 @@ ApplicationImpl::ApplicationImpl(VirtualClock& clock, Config const& cfg)
           mEvictionIOContext
               ? std::make_unique<asio::io_context::work>(*mEvictionIOContext)
               : nullptr)
-    , mOverlayIOContext(mConfig.BACKGROUND_OVERLAY_PROCESSING
-                            ? std::make_unique<asio::io_context>(1)
-                            : nullptr)
-    , mOverlayWork(mOverlayIOContext ? std::make_unique<asio::io_context::work>(
-                                           *mOverlayIOContext)
-                                     : nullptr)
     , mLedgerCloseIOContext(mConfig.parallelLedgerClose()
                                 ? std::make_unique<asio::io_context>(1)
                                 : nullptr)
@@ -114,6 +111,7 @@ ApplicationImpl::ApplicationImpl(VirtualClock& clock, Config const& cfg)
     , mSelfCheckTimer(*this)
     , mMetrics(
           std::make_unique<medida::MetricsRegistry>(cfg.HISTOGRAM_WINDOW_SIZE))
+    , mHdrMetrics(std::make_unique<HdrMetricsRegistry>())
     , mPostOnMainThreadDelay(
           mMetrics->NewTimer({"app", "post-on-main-thread", "delay"}))
     , mPostOnBackgroundThreadDelay(
@@ -122,6 +120,8 @@ ApplicationImpl::ApplicationImpl(VirtualClock& clock, Config const& cfg)
           mMetrics->NewTimer({"app", "post-on-overlay-thread", "delay"}))
     , mPostOnLedgerCloseThreadDelay(
           mMetrics->NewTimer({"app", "post-on-ledger-close-thread", "delay"}))
+    , mBackgroundWork(
+          std::make_unique<BackgroundWorkQueue>(mWorkerIOContext, *mMetrics))
     , mStartedOn(clock.system_now())
 {
 #ifdef SIGQUIT
@@ -135,6 +135,10 @@ ApplicationImpl::ApplicationImpl(VirtualClock& clock, Config const& cfg)
 
     mNetworkID = sha256(mConfig.NETWORK_PASSPHRASE);
 
+    // The signature cache is process-wide, so the most recently created
+    // application decides its size
+    PubKeyUtils::setVerifySigCacheSize(mConfig.SIGNATURE_CACHE_SIZE);
+
     TracyAppInfo(STELLAR_CORE_VERSION.c_str(), STELLAR_CORE_VERSION.size());
     TracyAppInfo(mConfig.NETWORK_PASSPHRASE.c_str(),
                  mConfig.NETWORK_PASSPHRASE.size());
@@ -190,16 +194,52 @@ ApplicationImpl::ApplicationImpl(VirtualClock& clock, Config const& cfg)
     if (mConfig.BACKGROUND_OVERLAY_PROCESSING)
     {
         // Keep priority unchanged as overlay processes time-sensitive tasks
-        mOverlayThread = std::thread{[this]() { mOverlayIOContext->run(); }};
-        mThreadTypes[mOverlayThread->get_id()] = ThreadType::OVERLAY;
+        releaseAssert(mConfig.OVERLAY_THREADS > 0);
+        for (uint32_t i = 0; i < mConfig.OVERLAY_THREADS; ++i)
+        {
+            auto& ioContext = *mOverlayIOContexts.emplace_back(
+                std::make_unique<asio::io_context>(1));
+            mOverlayWork.emplace_back(
+                std::make_unique<asio::io_context::work>(ioContext));
+            auto thread = std::thread{[&ioContext]() { ioContext.run(); }};
+            mThreadTypes[thread.get_id()] = ThreadType::OVERLAY;
+            mOverlayThreads.emplace_back(std::move(thread));
+        }
     }
 
     if (mConfig.parallelLedgerClose())
     {
-        mLedgerCloseThread =
-            std::thread{[this]() { mLedgerCloseIOContext->run(); }};
+        mLedgerCloseThread = std::thread{[this]() {
+            maybeBindApplyThreadToNumaNode();
+            mLedgerCloseIOContext->run();
+        }};
         mThreadTypes[mLedgerCloseThread->get_id()] = ThreadType::APPLY;
     }
+    else
+    {
+        // Ledgers are applied on the main thread
+        maybeBindApplyThreadToNumaNode();
+    }
+}
+
+void
+ApplicationImpl::maybeBindApplyThreadToNumaNode()
+{
+    auto node = mConfig.APPLY_NUMA_NODE;
+    if (!node)
+    {
+        return;
+    }
+    if (bindCurrentThreadToNumaNode(*node))
+    {
+        mApplyThreadOnNumaNode = true;
+        LOG_INFO(DEFAULT_LOG, "Applying ledgers on NUMA node {}", *node);
+    }
+    else
+    {
+        LOG_WARNING(DEFAULT_LOG, "Unable to bind apply thread to NUMA node {}",
+                    *node);
+    }
 }
 
 static void
@@ -208,6 +248,8 @@ maybeRebuildLedger(Application& app, bool applyBuckets)
     auto& ps = app.getPersistentState();
     if (ps.shouldRebuildForOfferTable())
     {
+        StartupProfiler::Phase phase(app.getStartupProfiler(),
+                                     "rebuild-offers");
         app.getDatabase().clearPreparedStatementCache(
             app.getDatabase().getSession(), true);
         soci::transaction tx(app.getDatabase().getRawSession());
@@ -238,6 +280,9 @@ maybeRebuildLedger(Application& app, bool applyBuckets)
 void
 ApplicationImpl::initialize(bool createNewDB, bool forceRebuild)
 {
+    mStartupProfiler = std::make_unique<StartupProfiler>();
+    StartupProfiler::Phase phase(*mStartupProfiler, "initialize");
+
     // Subtle: initialize the bucket manager first before initializing the
     // database. This is needed as some modes in core (such as in-memory) use a
     // small database inside the bucket directory.
@@ -362,6 +407,10 @@ ApplicationImpl::upgradeToCurrentSchemaAndMaybeRebuildLedger(bool applyBuckets,
     }
 
     mDatabase->upgradeToCurrentSchema();
+    if (mDatabase->mustRebuildOffers())
+    {
+        getPersistentState().setRebuildForOfferTable();
+    }
     maybeRebuildLedger(*this, applyBuckets);
 }
 
@@ -489,6 +538,14 @@ ApplicationImpl::getJsonInfo(bool verbose)
         info["status"][counter++] = statusMessage.second;
     }
 
+    info["startup"] = getStartupProfiler().getJson();
+
+    if (getConfig().APPLY_NUMA_NODE)
+    {
+        info["numa"]["apply_node"] = *getConfig().APPLY_NUMA_NODE;
+        info["numa"]["apply_thread_bound"] = mApplyThreadOnNumaNode.load();
+    }
+
     auto& herder = getHerder();
 
     auto& quorumInfo = info["quorum"];
@@ -799,7 +856,11 @@ ApplicationImpl::start()
     mStarted = true;
 
     mLedgerManager->loadLastKnownLedger(/* restoreBucketlist */ true);
-    startServices();
+    {
+        StartupProfiler::Phase phase(*mStartupProfiler, "start-services");
+        startServices();
+    }
+    mStartupProfiler->finish();
 }
 
 void
@@ -883,10 +944,7 @@ ApplicationImpl::joinAllThreads()
     {
         mWork.reset();
     }
-    if (mOverlayWork)
-    {
-        mOverlayWork.reset();
-    }
+    mOverlayWork.clear();
     if (mEvictionWork)
     {
         mEvictionWork.reset();
@@ -898,10 +956,14 @@ ApplicationImpl::joinAllThreads()
         w.join();
     }
 
-    if (mOverlayThread)
+    if (!mOverlayThreads.empty())
     {
-        LOG_INFO(DEFAULT_LOG, "Joining the overlay thread");
-        mOverlayThread->join();
+        LOG_INFO(DEFAULT_LOG, "Joining {} overlay threads",
+                 mOverlayThreads.size());
+        for (auto& t : mOverlayThreads)
+        {
+            t.join();
+        }
     }
 
     if (mEvictionThread)
@@ -1128,6 +1190,12 @@ ApplicationImpl::getLoadGenerator()
     return *mLoadGenerator;
 }
 
+LoadGenerator*
+ApplicationImpl::getLoadGeneratorIfCreated()
+{
+    return mLoadGenerator.get();
+}
+
 std::shared_ptr<TestAccount>
 ApplicationImpl::getRoot()
 {
@@ -1234,6 +1302,12 @@ ApplicationImpl::getMetrics()
     return *mMetrics;
 }
 
+HdrMetricsRegistry&
+ApplicationImpl::getHdrMetrics()
+{
+    return *mHdrMetrics;
+}
+
 bool
 ApplicationImpl::threadIsType(ThreadType type) const
 {
@@ -1248,8 +1322,19 @@ ApplicationImpl::syncOwnMetrics()
     // Flush crypto pure-global-cache stats. They don't belong
     // to a single app instance but first one to flush will claim
     // them.
+    std::vector<uint64_t> shardHits, shardMisses;
+    PubKeyUtils::flushVerifySigCacheCounts(shardHits, shardMisses);
     uint64_t vhit = 0, vmiss = 0;
-    PubKeyUtils::flushVerifySigCacheCounts(vhit, vmiss);
+    for (size_t i = 0; i < shardHits.size(); ++i)
+    {
+        auto shard = fmt::format(FMT_STRING("verify-shard-{:d}"), i);
+        mMetrics->NewMeter({"crypto", shard, "hit"}, "signature")
+            .Mark(shardHits[i]);
+        mMetrics->NewMeter({"crypto", shard, "miss"}, "signature")
+            .Mark(shardMisses[i]);
+        vhit += shardHits[i];
+        vmiss += shardMisses[i];
+    }
     mMetrics->NewMeter({"crypto", "verify", "hit"}, "signature").Mark(vhit);
     mMetrics->NewMeter({"crypto", "verify", "miss"}, "signature").Mark(vmiss);
     mMetrics->NewMeter({"crypto", "verify", "total"}, "signature")
@@ -1265,6 +1350,15 @@ ApplicationImpl::syncOwnMetrics()
     TracyPlot("process.action.queue", qsize);
     mMetrics->NewCounter({"process", "action", "overloaded"})
         .set_count(static_cast<int64_t>(getClock().actionQueueIsOverloaded()));
+    using AT = Scheduler::ActionType;
+    mMetrics->NewCounter({"process", "action", "posted"})
+        .set_count(static_cast<int64_t>(
+            getClock().getPostedActionCount(AT::NORMAL_ACTION)));
+    mMetrics->NewCounter({"process", "action", "posted-droppable"})
+        .set_count(static_cast<int64_t>(
+            getClock().getPostedActionCount(AT::DROPPABLE_ACTION)));
+    mMetrics->NewCounter({"process", "action", "wakeup"})
+        .set_count(static_cast<int64_t>(getClock().getPostWakeupCount()));
 
     // Update overlay inbound-connections and file-handle metrics.
     if (mOverlayManager)
@@ -1272,8 +1366,25 @@ ApplicationImpl::syncOwnMetrics()
         mMetrics->NewCounter({"overlay", "inbound", "live"})
             .set_count(*mOverlayManager->getLiveInboundPeersCounter());
     }
+    mMetrics->NewCounter({"logging", "async", "dropped"})
+        .set_count(static_cast<int64_t>(Logging::getAsyncDroppedCount()));
     mMetrics->NewCounter({"process", "file", "handles"})
         .set_count(fs::getOpenHandleCount());
+
+    if (memoryaccounting::isEnabled())
+    {
+        for (size_t i = 0; i < static_cast<size_t>(MemorySubsystem::COUNT);
+             ++i)
+        {
+            auto subsystem = static_cast<MemorySubsystem>(i);
+            auto name = memoryaccounting::getSubsystemName(subsystem);
+            auto usage = memoryaccounting::getUsage(subsystem);
+            mMetrics->NewCounter({"memory", name, "live-bytes"})
+                .set_count(usage.mLiveBytes);
+            mMetrics->NewCounter({"memory", name, "live-allocations"})
+                .set_count(usage.mLiveAllocations);
+        }
+    }
 }
 
 void
@@ -1297,6 +1408,7 @@ ApplicationImpl::clearMetrics(std::string const& domain)
             kv.second->Process(resetter);
         }
     }
+    mHdrMetrics->clear(domain);
 }
 
 TmpDirManager&
@@ -1407,6 +1519,12 @@ ApplicationImpl::getStatusManager()
     return *mStatusManager;
 }
 
+StartupProfiler&
+ApplicationImpl::getStartupProfiler()
+{
+    return *mStartupProfiler;
+}
+
 asio::io_context&
 ApplicationImpl::getWorkerIOContext()
 {
@@ -1423,8 +1541,9 @@ ApplicationImpl::getEvictionIOContext()
 asio::io_context&
 ApplicationImpl::getOverlayIOContext()
 {
-    releaseAssert(mOverlayIOContext);
-    return *mOverlayIOContext;
+    releaseAssert(!mOverlayIOContexts.empty());
+    auto i = mNextOverlayIOContext.fetch_add(1, std::memory_order_relaxed);
+    return *mOverlayIOContexts[i % mOverlayIOContexts.size()];
 }
 
 asio::io_context&
@@ -1456,11 +1575,12 @@ ApplicationImpl::postOnMainThread(std::function<void()>&& f, std::string&& name,
 
 void
 ApplicationImpl::postOnBackgroundThread(std::function<void()>&& f,
-                                        std::string jobName)
+                                        std::string jobName,
+                                        BackgroundWorkClass cls)
 {
     LogSlowExecution isSlow{std::move(jobName), LogSlowExecution::Mode::MANUAL,
                             "executed after"};
-    asio::post(getWorkerIOContext(), [this, f = std::move(f), isSlow]() {
+    mBackgroundWork->post(cls, [this, f = std::move(f), isSlow]() {
         mPostOnBackgroundThreadDelay.Update(isSlow.checkElapsedTime());
         f();
     });
@@ -1480,12 +1600,17 @@ ApplicationImpl::postOnEvictionBackgroundThread(std::function<void()>&& f,
 
 void
 ApplicationImpl::postOnOverlayThread(std::function<void()>&& f,
-                                     std::string jobName)
+                                     std::string jobName,
+                                     asio::io_context* ioContext)
 {
-    releaseAssert(mOverlayIOContext);
+    releaseAssert(!mOverlayIOContexts.empty());
+    if (!ioContext)
+    {
+        ioContext = mOverlayIOContexts.front().get();
+    }
     LogSlowExecution isSlow{std::move(jobName), LogSlowExecution::Mode::MANUAL,
                             "executed after"};
-    asio::post(*mOverlayIOContext, [this, f = std::move(f), isSlow]() {
+    asio::post(*ioContext, [this, f = std::move(f), isSlow]() {
         mPostOnOverlayThreadDelay.Update(isSlow.checkElapsedTime());
         f();
     });
@@ -1535,6 +1660,17 @@ ApplicationImpl::enableInvariantsFromConfig()
                 "config options to be enabled");
         }
     }
+
+    for (auto const& [name, rate] : mConfig.INVARIANT_CHECK_SAMPLE_RATES)
+    {
+        mInvariantManager->setSampleRate(name, rate);
+    }
+
+    if (mConfig.INVARIANT_CHECKS_ASYNC && !invariants.empty())
+    {
+        mInvariantManager->enableAsyncChecks(
+            mConfig.INVARIANT_CHECKS_ASYNC_MAX_LAG_LEDGERS);
+    }
 }
 
 std::unique_ptr<Herder>
@@ -11,8 +11,10 @@
 #include "util/MetricResetter.h"
 #include "util/Timer.h"
 #include "xdr/Stellar-ledger-entries.h"
+#include <atomic>
 #include <optional>
 #include <thread>
+#include <vector>
 
 namespace medida
 {
@@ -56,6 +58,7 @@ class ApplicationImpl : public Application
     virtual bool isStopping() const override;
     virtual VirtualClock& getClock() override;
     virtual medida::MetricsRegistry& getMetrics() override;
+    virtual HdrMetricsRegistry& getHdrMetrics() override;
     virtual void syncOwnMetrics() override;
     virtual void syncAllMetrics() override;
     virtual void clearMetrics(std::string const& domain) override;
@@ -77,6 +80,7 @@ class ApplicationImpl : public Application
     virtual WorkScheduler& getWorkScheduler() override;
     virtual BanManager& getBanManager() override;
     virtual StatusManager& getStatusManager() override;
+    virtual StartupProfiler& getStartupProfiler() override;
     virtual AppConnector& getAppConnector() override;
 
     virtual asio::io_context& getWorkerIOContext() override;
@@ -87,12 +91,14 @@ class ApplicationImpl : public Application
     virtual void postOnMainThread(std::function<void()>&& f, std::string&& name,
                                   Scheduler::ActionType type) override;
     virtual void postOnBackgroundThread(std::function<void()>&& f,
-                                        std::string jobName) override;
+                                        std::string jobName,
+                                        BackgroundWorkClass cls) override;
     virtual void postOnEvictionBackgroundThread(std::function<void()>&& f,
                                                 std::string jobName) override;
 
-    virtual void postOnOverlayThread(std::function<void()>&& f,
-                                     std::string jobName) override;
+    virtual void
+    postOnOverlayThread(std::function<void()>&& f, std::string jobName,
+                        asio::io_context* ioContext = nullptr) override;
     virtual void postOnLedgerCloseThread(std::function<void()>&& f,
                                          std::string jobName) override;
     virtual void start() override;
@@ -121,6 +127,7 @@ class ApplicationImpl : public Application
     virtual void generateLoad(GeneratedLoadConfig cfg) override;
 
     virtual LoadGenerator& getLoadGenerator() override;
+    virtual LoadGenerator* getLoadGeneratorIfCreated() override;
 
     virtual std::shared_ptr<TestAccount> getRoot() override;
 
@@ -163,8 +170,10 @@ class ApplicationImpl : public Application
     std::unique_ptr<asio::io_context::work> mWork;
     std::unique_ptr<asio::io_context::work> mEvictionWork;
 
-    std::unique_ptr<asio::io_context> mOverlayIOContext;
-    std::unique_ptr<asio::io_context::work> mOverlayWork;
+    // One io_context per overlay thread
+    std::vector<std::unique_ptr<asio::io_context>> mOverlayIOContexts;
+    std::vector<std::unique_ptr<asio::io_context::work>> mOverlayWork;
+    std::atomic<size_t> mNextOverlayIOContext{0};
 
     std::unique_ptr<asio::io_context> mLedgerCloseIOContext;
     std::unique_ptr<asio::io_context::work> mLedgerCloseWork;
@@ -189,6 +198,7 @@ class ApplicationImpl : public Application
     std::unique_ptr<PersistentState> mPersistentState;
     std::unique_ptr<BanManager> mBanManager;
     std::unique_ptr<StatusManager> mStatusManager;
+    std::unique_ptr<StartupProfiler> mStartupProfiler;
     std::unique_ptr<AbstractLedgerTxnParent> mLedgerTxnRoot;
     std::unique_ptr<AppConnector> mAppConnector;
 
@@ -217,8 +227,10 @@ class ApplicationImpl : public Application
 #endif
 
     std::vector<std::thread> mWorkerThreads;
-    std::optional<std::thread> mOverlayThread;
+    std::vector<std::thread> mOverlayThreads;
     std::optional<std::thread> mLedgerCloseThread;
+    // Whether the thread applying ledgers runs on APPLY_NUMA_NODE
+    std::atomic<bool> mApplyThreadOnNumaNode{false};
 
     // Unlike mWorkerThreads (which are low priority), eviction scans require a
     // medium priority thread. In the future, this may become a more general
@@ -245,11 +257,16 @@ class ApplicationImpl : public Application
     VirtualTimer mSelfCheckTimer;
 
     std::unique_ptr<medida::MetricsRegistry> mMetrics;
+    std::unique_ptr<HdrMetricsRegistry> mHdrMetrics;
     medida::Timer& mPostOnMainThreadDelay;
     medida::Timer& mPostOnBackgroundThreadDelay;
     medida::Timer& mPostOnOverlayThreadDelay;
     medida::Timer& mPostOnLedgerCloseThreadDelay;
 
+    // Feeds mWorkerIOContext, so must be destroyed after the worker threads
+    // are joined
+    std::unique_ptr<BackgroundWorkQueue> mBackgroundWork;
+
     VirtualClock::system_time_point mStartedOn;
 
     Hash mNetworkID;
@@ -283,5 +300,6 @@ class ApplicationImpl : public Application
     void upgradeToCurrentSchemaAndMaybeRebuildLedger(bool applyBuckets,
                                                      bool forceRebuild);
     void shutdownLedgerCloseThread();
+    void maybeBindApplyThreadToNumaNode();
 };
 }
@@ -7,6 +7,7 @@
 #include "bucket/LiveBucketList.h"
 #include "catchup/ApplyBucketsWork.h"
 #include "catchup/CatchupConfiguration.h"
+#include "catchup/LedgerApplyManager.h"
 #include "crypto/Hex.h"
 #include "database/Database.h"
 #include "herder/Herder.h"
@@ -28,7 +29,7 @@
 #include "scp/LocalNode.h"
 #include "util/GlobalChecks.h"
 #include "util/Logging.h"
-#include "util/XDRCereal.h"
+#include "util/XDRJson.h"
 #include "util/types.h"
 #include "util/xdrquery/XDRQuery.h"
 #include "work/WorkScheduler.h"
@@ -315,8 +316,8 @@ selfCheck(Config cfg)
     while (clock.crank(true) && !seq2->isDone())
         ;
 
-    // Then we load the entire BL ledger state into memory and check it against
-    // the database. This part is synchronous and should _not_ be run "online",
+    // Then we check the offers in the BL against the database, range by range
+    // of offer keys. This part is synchronous and should _not_ be run "online",
     // it's too expensive; it also can't easily be turned _into_ something you
     // can run online, because it would need to snapshot the database for the
     // duration of the run and, for example, sqlite doesn't support lockless
@@ -324,6 +325,8 @@ selfCheck(Config cfg)
     //
     // What we do instead is register a background thread listening for
     // control-C so at least the user can interrupt this if they get impatient.
+    // The check records its progress as it goes, so running it again picks up
+    // where it was interrupted.
     asio::signal_set stopSignals(app->getWorkerIOContext(), SIGINT);
 #ifdef SIGQUIT
     stopSignals.add(SIGQUIT);
@@ -628,6 +631,8 @@ dumpLedger(Config cfg, std::string const& outputFile,
         accumulators;
 
     std::ofstream ofs(outputFile);
+    // Reused for every entry
+    std::string json;
 
     auto& bm = app->getBucketManager();
     uint64_t entryCount = 0;
@@ -658,7 +663,9 @@ dumpLedger(Config cfg, std::string const& outputFile,
                 }
                 else
                 {
-                    ofs << xdrToCerealString(entry, "entry", true) << std::endl;
+                    json.clear();
+                    xdrToJson(entry, "entry", json, /* compact */ true);
+                    ofs << json << std::endl;
                 }
                 ++entryCount;
                 return !limit || entryCount < *limit;
@@ -709,14 +716,9 @@ dumpWasmBlob(Config cfg, std::string const& hash, std::string const& dir)
                     .copySearchableLiveBucketListSnapshot();
     if (hash == "ALL")
     {
-        snap->scanForEntriesOfType(
-            CONTRACT_CODE, [&](const BucketEntry& entry) {
-                if (entry.type() == INITENTRY || entry.type() == LIVEENTRY)
-                {
-                    auto const& codeEntry =
-                        entry.liveEntry().data.contractCode();
-                    writeBlob(codeEntry);
-                }
+        snap->scanForLiveEntriesOfType(
+            CONTRACT_CODE, [&](LedgerEntry const& entry) {
+                writeBlob(entry.data.contractCode());
                 return Loop::INCOMPLETE;
             });
     }
@@ -980,6 +982,192 @@ catchup(Application::pointer app, CatchupConfiguration cc,
     return synced ? 0 : 3;
 }
 
+namespace
+{
+std::string const SQLITE_PREFIX = "sqlite3://";
+
+// Configuration of the node replaying range `index` of a parallel catchup,
+// other than the last one, with its own database and bucket directory
+Config
+makeParallelCatchupRangeConfig(Config const& cfg, size_t index)
+{
+    auto rangeCfg = cfg;
+    rangeCfg.setNoListen();
+    auto const& db = cfg.DATABASE.value;
+    if (db.rfind(SQLITE_PREFIX, 0) != 0)
+    {
+        throw std::runtime_error("Parallel catchup requires a SQLite database");
+    }
+    if (db != SQLITE_PREFIX + ":memory:")
+    {
+        rangeCfg.DATABASE =
+            SecretValue{fmt::format(FMT_STRING("{}.range-{:d}"), db, index)};
+    }
+    rangeCfg.BUCKET_DIR_PATH = fmt::format(FMT_STRING("{}-range-{:d}"),
+                                           cfg.BUCKET_DIR_PATH, index);
+    return rangeCfg;
+}
+
+void
+removeParallelCatchupRangeState(Config const& rangeCfg)
+{
+    std::error_code ec;
+    auto const& db = rangeCfg.DATABASE.value;
+    if (db != SQLITE_PREFIX + ":memory:")
+    {
+        auto path = db.substr(SQLITE_PREFIX.size());
+        for (auto const& suffix : {"", "-wal", "-shm"})
+        {
+            std::filesystem::remove(path + suffix, ec);
+        }
+    }
+    std::filesystem::remove_all(rangeCfg.BUCKET_DIR_PATH, ec);
+}
+}
+
+int
+parallelCatchup(Config const& cfg, CatchupConfiguration cc,
+                uint32_t parallelism, std::string const& archiveName,
+                Json::Value& catchupInfo)
+{
+    if (cc.toLedger() == CatchupConfiguration::CURRENT)
+    {
+        throw std::runtime_error(
+            "Parallel catchup requires an explicit destination ledger");
+    }
+    if (cfg.METADATA_OUTPUT_STREAM.rfind("fd:", 0) == 0)
+    {
+        throw std::runtime_error(
+            "Parallel catchup can't write metadata to a file descriptor");
+    }
+
+    auto ranges = cc.splitIntoRanges(parallelism, cfg);
+    std::vector<Config> configs;
+    for (size_t i = 0; i < ranges.size(); ++i)
+    {
+        configs.emplace_back(i + 1 == ranges.size()
+                                 ? cfg
+                                 : makeParallelCatchupRangeConfig(cfg, i));
+        if (ranges.size() > 1 && !cfg.METADATA_OUTPUT_STREAM.empty())
+        {
+            configs.back().METADATA_OUTPUT_STREAM =
+                fmt::format(FMT_STRING("{}.range-{:d}"),
+                            cfg.METADATA_OUTPUT_STREAM, i);
+        }
+    }
+
+    for (size_t i = 0; i + 1 < configs.size(); ++i)
+    {
+        removeParallelCatchupRangeState(configs[i]);
+    }
+
+    VirtualClock clock(VirtualClock::REAL_TIME);
+    int result = 0;
+    {
+        // Only the last range runs on the node's own database, the others
+        // start from fresh ones. All nodes share the main thread and the
+        // clock: ledgers are applied concurrently when
+        // EXPERIMENTAL_PARALLEL_LEDGER_APPLY is set, and downloads, merges
+        // and verification run in the background anyway.
+        std::vector<Application::pointer> apps;
+        for (size_t i = 0; i < ranges.size(); ++i)
+        {
+            apps.emplace_back(Application::create(clock, configs[i],
+                                                  i + 1 < ranges.size()));
+        }
+        if (apps.back()->getLedgerManager().getLastClosedLedgerNum() !=
+            LedgerManager::GENESIS_LEDGER_SEQ)
+        {
+            LOG_ERROR(DEFAULT_LOG, "Parallel catchup requires a new database, "
+                                   "run stellar-core new-db first");
+            apps.clear();
+            for (size_t i = 0; i + 1 < configs.size(); ++i)
+            {
+                removeParallelCatchupRangeState(configs[i]);
+            }
+            return 1;
+        }
+
+        for (size_t i = 0; i < ranges.size(); ++i)
+        {
+            auto const& ham = apps[i]->getHistoryArchiveManager();
+            auto archive = ham.getHistoryArchive(archiveName);
+            if (iequals(archiveName, "any"))
+            {
+                archive = ham.selectRandomReadableHistoryArchive();
+            }
+
+            LOG_INFO(DEFAULT_LOG, "Catching up range {} to ledger {} ({})", i,
+                     ranges[i].toLedger(), ranges[i].count());
+            apps[i]->start();
+            apps[i]->getLedgerManager().startCatchup(ranges[i], archive);
+        }
+
+        auto& io = clock.getIOContext();
+        asio::io_context::work mainWork(io);
+        auto done = false;
+        auto synced = false;
+        while (!done && clock.crank(true))
+        {
+            synced = true;
+            for (auto const& app : apps)
+            {
+                auto state = app->getLedgerApplyManager().getCatchupWorkState();
+                if (state == BasicWork::State::WORK_FAILURE ||
+                    state == BasicWork::State::WORK_ABORTED)
+                {
+                    done = true;
+                    synced = false;
+                    break;
+                }
+                synced = synced && state == BasicWork::State::WORK_SUCCESS;
+            }
+            done = done || synced;
+        }
+
+        // Each range must start from the exact state the previous one ended
+        // at, which ties every range to the verified chain of the last one
+        for (size_t i = 1; synced && i < apps.size(); ++i)
+        {
+            auto const& prev =
+                apps[i - 1]->getLedgerManager().getLastClosedLedgerHeader();
+            auto start = apps[i]
+                             ->getLedgerApplyManager()
+                             .getCatchupAppliedBucketsLedger();
+            if (!start || start->header.ledgerSeq != prev.header.ledgerSeq ||
+                start->hash != prev.hash)
+            {
+                LOG_ERROR(DEFAULT_LOG,
+                          "Range {} ended at ledger {} ({}), which is not the "
+                          "state range {} started from",
+                          i - 1, prev.header.ledgerSeq, hexAbbrev(prev.hash),
+                          i);
+                synced = false;
+            }
+        }
+
+        LOG_INFO(DEFAULT_LOG, "*");
+        if (synced)
+        {
+            LOG_INFO(DEFAULT_LOG, "* Parallel catchup finished.");
+        }
+        else
+        {
+            LOG_INFO(DEFAULT_LOG, "* Parallel catchup failed.");
+        }
+        LOG_INFO(DEFAULT_LOG, "*");
+
+        catchupInfo = apps.back()->getJsonInfo(true);
+        result = synced ? 0 : 3;
+    }
+
+    for (size_t i = 0; i + 1 < configs.size(); ++i)
+    {
+        removeParallelCatchupRangeState(configs[i]);
+    }
+    return result;
+}
+
 int
 publish(Application::pointer app)
 {
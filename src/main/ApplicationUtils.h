@@ -54,6 +54,14 @@ void writeCatchupInfo(Json::Value const& catchupInfo,
                       std::string const& outputFile);
 int catchup(Application::pointer app, CatchupConfiguration cc,
             Json::Value& catchupInfo, std::shared_ptr<HistoryArchive> archive);
+// Catches up as `catchup` does, but replays the ledgers in up to
+// `parallelism` disjoint checkpoint ranges at once, each on its own node in
+// this process starting from the bucket state at the beginning of its range.
+// The last range runs on the node configured by `cfg`, the others on scratch
+// databases and bucket directories next to it, removed once done.
+int parallelCatchup(Config const& cfg, CatchupConfiguration cc,
+                    uint32_t parallelism, std::string const& archiveName,
+                    Json::Value& catchupInfo);
 // Reduild ledger state based on the buckets. Ensure ledger state is properly
 // reset before calling this function.
 bool applyBucketsForLCL(Application& app);
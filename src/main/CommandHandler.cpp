@@ -8,7 +8,9 @@
 #include "crypto/KeyUtils.h"
 #include "herder/Herder.h"
 #include "history/HistoryArchiveManager.h"
+#include "ledger/LedgerCloseTimeline.h"
 #include "ledger/LedgerManager.h"
+#include "ledger/LedgerStateSnapshot.h"
 #include "ledger/LedgerTxn.h"
 #include "ledger/NetworkConfig.h"
 #include "lib/http/server.hpp"
@@ -17,20 +19,29 @@
 #include "main/Config.h"
 #include "main/Maintainer.h"
 #include "main/QueryServer.h"
+#include "main/StateImage.h"
 #include "overlay/BanManager.h"
 #include "overlay/OverlayManager.h"
 #include "overlay/SurveyManager.h"
 #include "transactions/MutableTransactionResult.h"
+#include "transactions/SignatureChecker.h"
 #include "transactions/TransactionBridge.h"
 #include "transactions/TransactionUtils.h"
 #include "util/GlobalChecks.h"
+#include "util/HdrHistogram.h"
 #include "util/Logging.h"
+#include "util/MemoryAccounting.h"
+#include "util/Thread.h"
+#include "util/Timer.h"
+#include "util/TraceCapture.h"
 #include <Tracy.hpp>
 #include <fmt/format.h>
 
+#include "medida/counter.h"
+#include "medida/metrics_registry.h"
 #include "medida/reporting/json_reporter.h"
 #include "util/Decoder.h"
-#include "util/XDRCereal.h"
+#include "util/XDRJson.h"
 #include "util/XDRStream.h" // IWYU pragma: keep
 #include "xdr/Stellar-ledger-entries.h"
 #include "xdr/Stellar-transaction.h"
@@ -41,6 +52,8 @@
 #include "test/TestAccount.h"
 #include "test/TxTests.h"
 #endif
+#include <chrono>
+#include <future>
 #include <optional>
 
 using std::placeholders::_1;
@@ -71,6 +84,12 @@ CommandHandler::CommandHandler(Application& app) : mApp(app)
             mServer = std::make_unique<http::server::server>(
                 app.getClock().getIOContext(), ipStr,
                 mApp.getConfig().HTTP_PORT, httpMaxClient);
+            mSnapshotWork =
+                std::make_unique<asio::io_context::work>(mSnapshotIOContext);
+            mSnapshotThread = std::thread{[this]() {
+                runCurrentThreadWithLowPriority();
+                mSnapshotIOContext.run();
+            }};
         }
 
         if (mApp.getConfig().HTTP_QUERY_PORT)
@@ -78,7 +97,11 @@ CommandHandler::CommandHandler(Application& app) : mApp(app)
             mQueryServer = std::make_unique<QueryServer>(
                 ipStr, mApp.getConfig().HTTP_QUERY_PORT, httpMaxClient,
                 mApp.getConfig().QUERY_THREAD_POOL_SIZE,
-                mApp.getBucketManager().getBucketSnapshotManager());
+                mApp.getBucketManager().getBucketSnapshotManager(),
+                mApp.getMetrics(),
+                static_cast<size_t>(mApp.getConfig().QUERY_ENTRY_CACHE_MB)
+                    << 20,
+                std::bind(&CommandHandler::submitTxBatch, this, _1, _2));
         }
     }
 
@@ -99,9 +122,9 @@ CommandHandler::CommandHandler(Application& app) : mApp(app)
         addRoute("bans", &CommandHandler::bans);
         addRoute("connect", &CommandHandler::connect);
         addRoute("droppeer", &CommandHandler::dropPeer);
-        addRoute("peers", &CommandHandler::peers);
-        addRoute("quorum", &CommandHandler::quorum);
-        addRoute("scp", &CommandHandler::scpInfo);
+        addSnapshotRoute("peers", &CommandHandler::peers);
+        addSnapshotRoute("quorum", &CommandHandler::quorum);
+        addSnapshotRoute("scp", &CommandHandler::scpInfo);
         addRoute("stopsurvey", &CommandHandler::stopSurvey);
 #ifndef BUILD_TESTS
         addRoute("getsurveyresult", &CommandHandler::getSurveyResult);
@@ -115,16 +138,22 @@ CommandHandler::CommandHandler(Application& app) : mApp(app)
     }
 
     addRoute("clearmetrics", &CommandHandler::clearMetrics);
-    addRoute("info", &CommandHandler::info);
+    addSnapshotRoute("info", &CommandHandler::info);
     addRoute("ll", &CommandHandler::ll);
     addRoute("logrotate", &CommandHandler::logRotate);
     addRoute("manualclose", &CommandHandler::manualClose);
-    addRoute("metrics", &CommandHandler::metrics);
+    addSnapshotRoute("metrics", &CommandHandler::metrics);
+    addSnapshotRoute("prometheus", &CommandHandler::prometheus,
+                     PrometheusExporter::CONTENT_TYPE);
     addRoute("tx", &CommandHandler::tx);
     addRoute("upgrades", &CommandHandler::upgrades);
     addRoute("dumpproposedsettings", &CommandHandler::dumpProposedSettings);
     addRoute("self-check", &CommandHandler::selfCheck);
-    addRoute("sorobaninfo", &CommandHandler::sorobanInfo);
+    addRoute("stateimage", &CommandHandler::stateImage);
+    addSnapshotRoute("sorobaninfo", &CommandHandler::sorobanInfo);
+    addRoute("ledgertimeline", &CommandHandler::ledgerTimeline);
+    addRoute("memory", &CommandHandler::memory);
+    addRoute("tracecapture", &CommandHandler::traceCapture);
 
 #ifdef BUILD_TESTS
     addRoute("generateload", &CommandHandler::generateLoad);
@@ -139,6 +168,18 @@ CommandHandler::CommandHandler(Application& app) : mApp(app)
 #endif
 }
 
+CommandHandler::~CommandHandler()
+{
+    // Pending renders are dropped, their connections are closed with the
+    // server
+    mSnapshotWork.reset();
+    mSnapshotIOContext.stop();
+    if (mSnapshotThread.joinable())
+    {
+        mSnapshotThread.join();
+    }
+}
+
 void
 CommandHandler::addRoute(std::string const& name, HandlerRoute route)
 {
@@ -147,14 +188,75 @@ CommandHandler::addRoute(std::string const& name, HandlerRoute route)
         name, std::bind(&CommandHandler::safeRouter, this, route, _1, _2));
 }
 
+void
+CommandHandler::addSnapshotRoute(std::string const& name, SnapshotRoute route,
+                                 std::string contentType)
+{
+    auto handler = [this, route](std::string const& params,
+                                 std::string& retStr,
+                                 std::function<void()> done) {
+        SnapshotRenderer render;
+        catchErrors(
+            [&]() {
+                ZoneNamedN(httpZone, "HTTP snapshot", true);
+                render = route(this, params);
+            },
+            retStr);
+        if (!render)
+        {
+            // route threw
+            if (done)
+            {
+                done();
+            }
+            return;
+        }
+
+        // retStr belongs to the connection until done is called
+        auto renderSafely = [render, &retStr]() {
+            catchErrors(
+                [&]() {
+                    ZoneNamedN(httpZone, "HTTP snapshot render", true);
+                    render(retStr);
+                },
+                retStr);
+        };
+        if (!done || !mSnapshotThread.joinable())
+        {
+            renderSafely();
+            if (done)
+            {
+                done();
+            }
+            return;
+        }
+        asio::post(mSnapshotIOContext, [renderSafely, done]() {
+            renderSafely();
+            done();
+        });
+    };
+    mServer->addAsyncRoute(name, handler, std::move(contentType));
+}
+
 void
 CommandHandler::safeRouter(CommandHandler::HandlerRoute route,
                            std::string const& params, std::string& retStr)
+{
+    catchErrors(
+        [&]() {
+            ZoneNamedN(httpZone, "HTTP command handler", true);
+            route(this, params, retStr);
+        },
+        retStr);
+}
+
+void
+CommandHandler::catchErrors(std::function<void()> const& f,
+                            std::string& retStr)
 {
     try
     {
-        ZoneNamedN(httpZone, "HTTP command handler", true);
-        route(this, params, retStr);
+        f();
     }
     catch (std::exception const& e)
     {
@@ -311,8 +413,8 @@ CommandHandler::manualClose(std::string const& params, std::string& retStr)
     retStr = mApp.manualClose(manualLedgerSeq, manualCloseTime);
 }
 
-void
-CommandHandler::peers(std::string const& params, std::string& retStr)
+CommandHandler::SnapshotRenderer
+CommandHandler::peers(std::string const& params)
 {
     ZoneScoped;
     std::map<std::string, std::string> retMap;
@@ -358,17 +460,20 @@ CommandHandler::peers(std::string const& params, std::string& retStr)
     addAuthenticatedPeers(
         "inbound", mApp.getOverlayManager().getInboundAuthenticatedPeers());
 
-    retStr = root.toStyledString();
+    return [root = std::move(root)](std::string& retStr) {
+        retStr = root.toStyledString();
+    };
 }
 
-void
-CommandHandler::info(std::string const& params, std::string& retStr)
+CommandHandler::SnapshotRenderer
+CommandHandler::info(std::string const& params)
 {
     ZoneScoped;
     std::map<std::string, std::string> retMap;
     http::server::server::parseParams(params, retMap);
 
-    retStr = mApp.getJsonInfo(retMap["compact"] == "false").toStyledString();
+    return [root = mApp.getJsonInfo(retMap["compact"] == "false")](
+               std::string& retStr) { retStr = root.toStyledString(); };
 }
 
 static bool
@@ -384,8 +489,8 @@ shouldEnable(std::set<std::string> const& toEnable,
     return true;
 }
 
-void
-CommandHandler::metrics(std::string const& params, std::string& retStr)
+CommandHandler::SnapshotRenderer
+CommandHandler::metrics(std::string const& params)
 {
     ZoneScoped;
 
@@ -408,30 +513,63 @@ CommandHandler::metrics(std::string const& params, std::string& retStr)
 
     mApp.syncAllMetrics();
 
-    auto reportMetrics =
-        [&](std::map<medida::MetricName,
-                     std::shared_ptr<medida::MetricInterface>> const& metrics) {
-            medida::reporting::JsonReporter jr(metrics);
-            retStr = jr.Report();
-        };
-
+    // Metrics are safe to read from any thread, only the sets of metrics to
+    // report are taken here
+    auto metricsToReport = mApp.getMetrics().GetAllMetrics();
+    auto timersToReport = mApp.getHdrMetrics().GetAllTimers();
     if (!toEnable.empty())
     {
-        std::map<medida::MetricName, std::shared_ptr<medida::MetricInterface>>
-            metricsToReport;
-        for (auto const& m : mApp.getMetrics().GetAllMetrics())
+        auto filter = [&](auto& metrics) {
+            for (auto it = metrics.begin(); it != metrics.end();)
+            {
+                it = shouldEnable(toEnable, it->first) ? std::next(it)
+                                                       : metrics.erase(it);
+            }
+        };
+        filter(metricsToReport);
+        filter(timersToReport);
+    }
+
+    return [metricsToReport = std::move(metricsToReport),
+            timersToReport = std::move(timersToReport)](std::string& retStr) {
+        medida::reporting::JsonReporter jr(metricsToReport);
+        retStr = jr.Report();
+        bool reportedAny = !metricsToReport.empty();
+
+        // medida can only report the metrics it owns, so HdrTimers are
+        // spliced into the "metrics" object its report ends with
+        std::string hdrTimers;
+        Json::FastWriter writer;
+        for (auto const& t : timersToReport)
         {
-            if (shouldEnable(toEnable, m.first))
+            Json::Value timer;
+            t.second->toJson(timer);
+            if (reportedAny || !hdrTimers.empty())
             {
-                metricsToReport.emplace(m);
+                hdrTimers += ",";
             }
+            hdrTimers += fmt::format(FMT_STRING("\"{}\":{}"),
+                                     t.first.ToString(), writer.write(timer));
         }
-        reportMetrics(metricsToReport);
-    }
-    else
-    {
-        reportMetrics(mApp.getMetrics().GetAllMetrics());
-    }
+        if (!hdrTimers.empty())
+        {
+            releaseAssert(retStr.size() >= 2 &&
+                          retStr.compare(retStr.size() - 2, 2, "}}") == 0);
+            retStr.insert(retStr.size() - 2, hdrTimers);
+        }
+    };
+}
+
+CommandHandler::SnapshotRenderer
+CommandHandler::prometheus(std::string const& params)
+{
+    ZoneScoped;
+    mApp.syncAllMetrics();
+    return [&exporter = mPrometheusExporter,
+            metrics = mApp.getMetrics().GetAllMetrics(),
+            timers = mApp.getHdrMetrics().GetAllTimers()](std::string& retStr) {
+        retStr = exporter.render(metrics, timers);
+    };
 }
 
 void
@@ -668,8 +806,8 @@ CommandHandler::dumpProposedSettings(std::string const& params,
             return;
         }
 
-        retStr = xdrToCerealString(ptr->toXDR().updatedEntry,
-                                   "ConfigSettingsEntries");
+        retStr =
+            xdrToJson(ptr->toXDR().updatedEntry, "ConfigSettingsEntries");
     }
     else
     {
@@ -692,8 +830,8 @@ CommandHandler::selfCheck(std::string const&, std::string& retStr)
     mApp.scheduleSelfCheck(true);
 }
 
-void
-CommandHandler::quorum(std::string const& params, std::string& retStr)
+CommandHandler::SnapshotRenderer
+CommandHandler::quorum(std::string const& params)
 {
     ZoneScoped;
     std::map<std::string, std::string> retMap;
@@ -726,11 +864,13 @@ CommandHandler::quorum(std::string const& params, std::string& retStr)
         root = mApp.getHerder().getJsonQuorumInfo(
             n, retMap["compact"] == "true", retMap["fullkeys"] == "true", 0);
     }
-    retStr = root.toStyledString();
+    return [root = std::move(root)](std::string& retStr) {
+        retStr = root.toStyledString();
+    };
 }
 
-void
-CommandHandler::scpInfo(std::string const& params, std::string& retStr)
+CommandHandler::SnapshotRenderer
+CommandHandler::scpInfo(std::string const& params)
 {
     ZoneScoped;
     std::map<std::string, std::string> retMap;
@@ -738,33 +878,44 @@ CommandHandler::scpInfo(std::string const& params, std::string& retStr)
     size_t lim = parseOptionalParamOrDefault<size_t>(retMap, "limit", 2);
 
     auto root = mApp.getHerder().getJsonInfo(lim, retMap["fullkeys"] == "true");
-    retStr = root.toStyledString();
+    return [root = std::move(root)](std::string& retStr) {
+        retStr = root.toStyledString();
+    };
 }
 
-void
-CommandHandler::sorobanInfo(std::string const& params, std::string& retStr)
+CommandHandler::SnapshotRenderer
+CommandHandler::sorobanInfo(std::string const& params)
 {
     ZoneScoped;
     auto& lm = mApp.getLedgerManager();
 
-    if (lm.hasLastClosedSorobanNetworkConfig())
+    if (!lm.hasLastClosedSorobanNetworkConfig())
     {
-        std::map<std::string, std::string> retMap;
-        http::server::server::parseParams(params, retMap);
+        return [](std::string& retStr) {
+            retStr = "Soroban is not active in current ledger version";
+        };
+    }
 
-        // Format is the only acceptable param, but it is optional
-        if (retMap.count("format") != retMap.size())
-        {
-            retStr = "Invalid param";
-            return;
-        }
+    std::map<std::string, std::string> retMap;
+    http::server::server::parseParams(params, retMap);
 
-        auto format =
-            parseOptionalParamOrDefault<std::string>(retMap, "format", "basic");
-        if (format == "basic")
-        {
+    // Format is the only acceptable param, but it is optional
+    if (retMap.count("format") != retMap.size())
+    {
+        return [](std::string& retStr) { retStr = "Invalid param"; };
+    }
+
+    auto format =
+        parseOptionalParamOrDefault<std::string>(retMap, "format", "basic");
+    if (format == "basic")
+    {
+        // The config of a closed ledger is never modified
+        auto confPtr = lm.getLastClosedSorobanNetworkConfigPtr();
+        auto ledgerVersion =
+            lm.getLastClosedLedgerHeader().header.ledgerVersion;
+        return [confPtr, ledgerVersion](std::string& retStr) {
             Json::Value res;
-            auto const& conf = lm.getLastClosedSorobanNetworkConfig();
+            auto const& conf = *confPtr;
 
             // Contract size
             res["max_contract_size"] = conf.maxContractSizeBytes();
@@ -798,9 +949,7 @@ CommandHandler::sorobanInfo(std::string const& params, std::string& retStr)
                 conf.txMaxWriteLedgerEntries();
             res["tx"]["max_write_bytes"] = conf.txMaxWriteBytes();
 
-            if (protocolVersionStartsFrom(
-                    lm.getLastClosedLedgerHeader().header.ledgerVersion,
-                    ProtocolVersion::V_23))
+            if (protocolVersionStartsFrom(ledgerVersion, ProtocolVersion::V_23))
             {
                 res["tx"]["max_footprint_size"] = conf.txMaxFootprintEntries();
             }
@@ -864,9 +1013,7 @@ CommandHandler::sorobanInfo(std::string const& params, std::string& retStr)
             archivalInfo["average_bucket_list_size"] =
                 static_cast<Json::UInt64>(conf.getAverageSorobanStateSize());
 
-            if (protocolVersionStartsFrom(
-                    lm.getLastClosedLedgerHeader().header.ledgerVersion,
-                    ProtocolVersion::V_23))
+            if (protocolVersionStartsFrom(ledgerVersion, ProtocolVersion::V_23))
             {
                 res["max_dependent_tx_clusters"] =
                     conf.ledgerMaxDependentTxClusters();
@@ -886,57 +1033,178 @@ CommandHandler::sorobanInfo(std::string const& params, std::string& retStr)
             }
 
             retStr = res.toStyledString();
-        }
-        else if (format == "detailed")
+        };
+    }
+    else if (format == "detailed")
+    {
+        LedgerSnapshot lsg(mApp);
+        xdr::xvector<ConfigSettingEntry> entries;
+        for (auto c : xdr::xdr_traits<ConfigSettingID>::enum_values())
         {
-            LedgerSnapshot lsg(mApp);
-            xdr::xvector<ConfigSettingEntry> entries;
-            for (auto c : xdr::xdr_traits<ConfigSettingID>::enum_values())
+            auto entry =
+                lsg.load(configSettingKey(static_cast<ConfigSettingID>(c)));
+            if (!entry)
             {
-                auto entry =
-                    lsg.load(configSettingKey(static_cast<ConfigSettingID>(c)));
-                if (!entry)
-                {
-                    continue;
-                }
-                entries.emplace_back(entry.current().data.configSetting());
+                continue;
             }
-
-            retStr = xdrToCerealString(entries, "ConfigSettingsEntries");
+            entries.emplace_back(entry.current().data.configSetting());
         }
-        else if (format == "upgrade_xdr")
-        {
-            LedgerSnapshot lsg(mApp);
 
-            ConfigUpgradeSet upgradeSet;
-            for (auto c : xdr::xdr_traits<ConfigSettingID>::enum_values())
+        return [entries = std::move(entries)](std::string& retStr) {
+            retStr = xdrToJson(entries, "ConfigSettingsEntries");
+        };
+    }
+    else if (format == "upgrade_xdr")
+    {
+        LedgerSnapshot lsg(mApp);
+
+        ConfigUpgradeSet upgradeSet;
+        for (auto c : xdr::xdr_traits<ConfigSettingID>::enum_values())
+        {
+            auto configSettingID = static_cast<ConfigSettingID>(c);
+            if (SorobanNetworkConfig::isNonUpgradeableConfigSettingEntry(
+                    configSettingID))
             {
-                auto configSettingID = static_cast<ConfigSettingID>(c);
-                if (SorobanNetworkConfig::isNonUpgradeableConfigSettingEntry(
-                        configSettingID))
-                {
-                    continue;
-                }
-                auto entry = lsg.load(configSettingKey(configSettingID));
-                if (!entry)
-                {
-                    continue;
-                }
-                upgradeSet.updatedEntry.emplace_back(
-                    entry.current().data.configSetting());
+                continue;
             }
+            auto entry = lsg.load(configSettingKey(configSettingID));
+            if (!entry)
+            {
+                continue;
+            }
+            upgradeSet.updatedEntry.emplace_back(
+                entry.current().data.configSetting());
+        }
 
+        return [upgradeSet = std::move(upgradeSet)](std::string& retStr) {
             retStr = decoder::encode_b64(xdr::xdr_to_opaque(upgradeSet));
-        }
-        else
+        };
+    }
+    else
+    {
+        return [](std::string& retStr) { retStr = "Invalid format option"; };
+    }
+}
+
+void
+CommandHandler::ledgerTimeline(std::string const& params, std::string& retStr)
+{
+    ZoneScoped;
+    std::map<std::string, std::string> retMap;
+    http::server::server::parseParams(params, retMap);
+
+    auto count = parseOptionalParamOrDefault<size_t>(retMap, "count", 10);
+    auto format =
+        parseOptionalParamOrDefault<std::string>(retMap, "format", "json");
+    auto const& timeline = mApp.getLedgerManager().getCloseTimeline();
+    if (format == "json")
+    {
+        retStr = timeline.getJson(count).toStyledString();
+    }
+    else if (format == "chrome")
+    {
+        retStr = timeline.getChromeTraceJson(count).toStyledString();
+    }
+    else
+    {
+        retStr = "Invalid format option";
+    }
+}
+
+void
+CommandHandler::memory(std::string const& params, std::string& retStr)
+{
+    ZoneScoped;
+    Json::Value root;
+    root["accounting"] = memoryaccounting::isEnabled();
+    if (memoryaccounting::isEnabled())
+    {
+        auto& subsystems = root["subsystems"];
+        for (size_t i = 0; i < static_cast<size_t>(MemorySubsystem::COUNT);
+             ++i)
         {
-            retStr = "Invalid format option";
+            auto subsystem = static_cast<MemorySubsystem>(i);
+            auto usage = memoryaccounting::getUsage(subsystem);
+            auto& res =
+                subsystems[memoryaccounting::getSubsystemName(subsystem)];
+            res["live_bytes"] = static_cast<Json::Int64>(usage.mLiveBytes);
+            res["live_allocations"] =
+                static_cast<Json::Int64>(usage.mLiveAllocations);
+            res["total_bytes"] = static_cast<Json::UInt64>(usage.mTotalBytes);
+            res["total_allocations"] =
+                static_cast<Json::UInt64>(usage.mTotalAllocations);
         }
     }
-    else
+
+    // The module cache lives on the Rust side, out of reach of the accounting
+    // of C++ allocations
+    auto& metrics = mApp.getMetrics();
+    auto& moduleCache = root["module_cache"];
+    moduleCache["entries"] = static_cast<Json::Int64>(
+        metrics.NewCounter({"soroban", "module-cache", "num-entries"})
+            .count());
+    moduleCache["wasm_bytes"] = static_cast<Json::Int64>(
+        metrics.NewCounter({"soroban", "module-cache", "rebuild-bytes"})
+            .count());
+    retStr = root.toStyledString();
+}
+
+// "tracecapture?file=PATH[&seconds=N]"
+void
+CommandHandler::traceCapture(std::string const& params, std::string& retStr)
+{
+    ZoneScoped;
+    std::map<std::string, std::string> map;
+    http::server::server::parseParams(params, map);
+    auto file = map.find("file");
+    if (file == map.end() || file->second.empty())
     {
-        retStr = "Soroban is not active in current ledger version";
+        throw std::invalid_argument("Must specify a file: "
+                                    "tracecapture?file=PATH[&seconds=N]");
     }
+#ifndef USE_TRACECAPTURE
+    throw std::invalid_argument("Zones aren't recorded in this build, "
+                                "configure it with --enable-tracecapture");
+#else
+    static constexpr uint32_t MAX_SECONDS = 300;
+    auto seconds = parseOptionalParamOrDefault<uint32_t>(map, "seconds", 10);
+    if (seconds == 0 || seconds > MAX_SECONDS)
+    {
+        throw std::invalid_argument(fmt::format(
+            FMT_STRING("seconds must be between 1 and {}"), MAX_SECONDS));
+    }
+
+    tracecapture::start();
+    CLOG_INFO(Perf, "Capturing zones for {} seconds", seconds);
+    if (!mTraceCaptureTimer)
+    {
+        mTraceCaptureTimer = std::make_unique<VirtualTimer>(mApp);
+    }
+    mTraceCaptureTimer->expires_from_now(std::chrono::seconds(seconds));
+    mTraceCaptureTimer->async_wait(
+        [this, path = file->second]() {
+            // Writing a few hundred thousand zones takes a moment
+            mApp.postOnBackgroundThread(
+                [path]() {
+                    try
+                    {
+                        auto count = tracecapture::stopAndWrite(path);
+                        CLOG_INFO(Perf, "Wrote {} zones to trace file '{}'",
+                                  count, path);
+                    }
+                    catch (std::exception const& e)
+                    {
+                        CLOG_WARNING(Perf, "Failed to write trace file: {}",
+                                     e.what());
+                    }
+                },
+                "trace capture");
+        },
+        &VirtualTimer::onFailureNoop);
+    retStr = fmt::format(
+        FMT_STRING("Capturing zones for {} seconds, writing them to {}"),
+        seconds, file->second);
+#endif
 }
 
 // "Must specify a log level: ll?level=<level>&partition=<name>";
@@ -977,6 +1245,59 @@ CommandHandler::ll(std::string const& params, std::string& retStr)
     retStr = root.toStyledString();
 }
 
+namespace
+{
+// How long submitTxBatch waits for the main thread to add its transactions
+constexpr std::chrono::seconds TX_BATCH_TIMEOUT(30);
+
+// The response of the tx command for a transaction that was received
+Json::Value
+addResultToJson(Config const& cfg, TransactionFrameBase const& tx,
+                TransactionQueue::AddResult const& addResult)
+{
+    Json::Value root;
+    root["status"] = TX_STATUS_STRING[static_cast<int>(addResult.code)];
+    if (addResult.code == TransactionQueue::AddResultCode::ADD_STATUS_ERROR)
+    {
+        std::string resultBase64;
+        releaseAssertOrThrow(addResult.txResult);
+
+        auto const& payload = addResult.txResult;
+        auto resultBin = xdr::xdr_to_opaque(payload->getXDR());
+        resultBase64.reserve(decoder::encoded_size64(resultBin.size()) + 1);
+        resultBase64 = decoder::encode_b64(resultBin);
+        root["error"] = resultBase64;
+        if (cfg.ENABLE_DIAGNOSTICS_FOR_TX_SUBMISSION && tx.isSoroban() &&
+            !addResult.mDiagnosticEvents.empty())
+        {
+            auto diagsBin = xdr::xdr_to_opaque(addResult.mDiagnosticEvents);
+            auto diagsBase64 = decoder::encode_b64(diagsBin);
+            root["diagnostic_events"] = diagsBase64;
+        }
+    }
+    return root;
+}
+
+// Checks the signatures of tx against its source account in ls, so that the
+// results are in the signature cache by the time the main thread checks them.
+// Uses the HIGH threshold so that every signature gets checked.
+void
+warmSignatureCache(LedgerSnapshot const& ls, TransactionFrameBase const& tx)
+{
+    auto const& signatures = txbridge::getSignatures(tx.getEnvelope());
+    SignatureChecker signatureChecker(
+        ls.getLedgerHeader().current().ledgerVersion, tx.getContentsHash(),
+        signatures);
+    auto const sourceAccount = ls.getAccount(tx.getFeeSourceID());
+    if (sourceAccount)
+    {
+        tx.checkSignature(
+            signatureChecker, sourceAccount,
+            sourceAccount.current().data.account().thresholds[THRESHOLD_HIGH]);
+    }
+}
+}
+
 void
 CommandHandler::tx(std::string const& params, std::string& retStr)
 {
@@ -1010,30 +1331,7 @@ CommandHandler::tx(std::string const& params, std::string& retStr)
             // Add it to our current set and make sure it is valid.
             auto addResult =
                 mApp.getHerder().recvTransaction(transaction, true);
-
-            root["status"] = TX_STATUS_STRING[static_cast<int>(addResult.code)];
-            if (addResult.code ==
-                TransactionQueue::AddResultCode::ADD_STATUS_ERROR)
-            {
-                std::string resultBase64;
-                releaseAssertOrThrow(addResult.txResult);
-
-                auto const& payload = addResult.txResult;
-                auto resultBin = xdr::xdr_to_opaque(payload->getXDR());
-                resultBase64.reserve(decoder::encoded_size64(resultBin.size()) +
-                                     1);
-                resultBase64 = decoder::encode_b64(resultBin);
-                root["error"] = resultBase64;
-                if (mApp.getConfig().ENABLE_DIAGNOSTICS_FOR_TX_SUBMISSION &&
-                    transaction->isSoroban() &&
-                    !addResult.mDiagnosticEvents.empty())
-                {
-                    auto diagsBin =
-                        xdr::xdr_to_opaque(addResult.mDiagnosticEvents);
-                    auto diagsBase64 = decoder::encode_b64(diagsBin);
-                    root["diagnostic_events"] = diagsBase64;
-                }
-            }
+            root = addResultToJson(mApp.getConfig(), *transaction, addResult);
         }
     }
     else
@@ -1045,6 +1343,101 @@ CommandHandler::tx(std::string const& params, std::string& retStr)
     retStr = Json::FastWriter().write(root);
 }
 
+void
+CommandHandler::submitTxBatch(std::vector<std::string> const& blobs,
+                              std::string& retStr)
+{
+    ZoneScoped;
+    // The main thread would wait for itself
+    releaseAssert(!threadIsMain());
+
+    // Everything but adding to the queue happens on the calling thread,
+    // against a snapshot of the last closed ledger
+    LedgerSnapshot ls(mApp.getBucketManager()
+                          .getBucketSnapshotManager()
+                          .copySearchableLiveBucketListSnapshot());
+    auto ledgerVersion = ls.getLedgerHeader().current().ledgerVersion;
+
+    Json::Value root;
+    auto& results = root["results"];
+    results = Json::Value(Json::arrayValue);
+    std::vector<TransactionFrameBasePtr> txs;
+    std::vector<Json::ArrayIndex> txIndices;
+    for (auto const& blob : blobs)
+    {
+        Json::Value result;
+        try
+        {
+            TransactionEnvelope envelope;
+            std::vector<uint8_t> binBlob;
+            decoder::decode_b64(blob, binBlob);
+            xdr::xdr_from_opaque(binBlob, envelope);
+            if (protocolVersionStartsFrom(ledgerVersion, ProtocolVersion::V_13))
+            {
+                envelope = txbridge::convertForV13(envelope);
+            }
+
+            auto transaction = TransactionFrameBase::makeTransactionFromWire(
+                mApp.getNetworkID(), envelope);
+            if (!transaction)
+            {
+                throw std::invalid_argument("Invalid transaction");
+            }
+            transaction->getFullHash();
+            warmSignatureCache(ls, *transaction);
+
+            txIndices.emplace_back(results.size());
+            txs.emplace_back(transaction);
+        }
+        catch (std::exception const& e)
+        {
+            result["exception"] = e.what();
+        }
+        results.append(result);
+    }
+
+    if (!txs.empty())
+    {
+        auto added = std::make_shared<
+            std::promise<std::vector<TransactionQueue::AddResult>>>();
+        auto addedFuture = added->get_future();
+        mApp.postOnMainThread(
+            [this, txs, added]() {
+                try
+                {
+                    std::vector<TransactionQueue::AddResult> res;
+                    res.reserve(txs.size());
+                    for (auto const& tx : txs)
+                    {
+                        res.emplace_back(
+                            mApp.getHerder().recvTransaction(tx, true));
+                    }
+                    added->set_value(std::move(res));
+                }
+                catch (...)
+                {
+                    added->set_exception(std::current_exception());
+                }
+            },
+            "submitTxBatch");
+
+        if (addedFuture.wait_for(TX_BATCH_TIMEOUT) !=
+            std::future_status::ready)
+        {
+            throw std::runtime_error(
+                "Timed out waiting for transactions to be added");
+        }
+        auto addResults = addedFuture.get();
+        for (size_t i = 0; i < txs.size(); ++i)
+        {
+            results[txIndices[i]] =
+                addResultToJson(mApp.getConfig(), *txs[i], addResults[i]);
+        }
+    }
+
+    retStr = Json::FastWriter().write(root);
+}
+
 void
 CommandHandler::maintenance(std::string const& params, std::string& retStr)
 {
@@ -1065,6 +1458,24 @@ CommandHandler::maintenance(std::string const& params, std::string& retStr)
     }
 }
 
+void
+CommandHandler::stateImage(std::string const& params, std::string& retStr)
+{
+    ZoneScoped;
+    std::map<std::string, std::string> map;
+    http::server::server::parseParams(params, map);
+    auto dir = map.find("dir");
+    if (dir == map.end() || dir->second.empty())
+    {
+        throw std::invalid_argument("Must specify a directory: "
+                                    "stateimage?dir=DIR");
+    }
+    StateImage::write(mApp, dir->second);
+    retStr = fmt::format(FMT_STRING("Wrote state image of ledger {} to {}"),
+                         mApp.getLedgerManager().getLastClosedLedgerNum(),
+                         dir->second);
+}
+
 void
 CommandHandler::clearMetrics(std::string const& params, std::string& retStr)
 {
@@ -1231,6 +1642,8 @@ CommandHandler::generateLoad(std::string const& params, std::string& retStr)
             parseOptionalParam<uint32_t>(map, "maxfeerate");
         cfg.skipLowFeeTxs =
             parseOptionalParamOrDefault<bool>(map, "skiplowfeetxs", false);
+        cfg.poissonArrivals =
+            parseOptionalParamOrDefault<bool>(map, "poissonarrivals", false);
 
         if (cfg.mode == LoadGenMode::MIXED_CLASSIC)
         {
@@ -1468,8 +1881,8 @@ CommandHandler::testTx(std::string const& params, std::string& retStr)
         if (addResult.code == TransactionQueue::AddResultCode::ADD_STATUS_ERROR)
         {
             releaseAssert(addResult.txResult);
-            root["detail"] = xdrToCerealString(
-                addResult.txResult->getResultCode(), "TransactionResultCode");
+            root["detail"] = xdrToJson(addResult.txResult->getResultCode(),
+                                       "TransactionResultCode");
         }
     }
     else
@@ -6,10 +6,14 @@
 
 #include "lib/http/server.hpp"
 #include "main/QueryServer.h"
+#include "util/PrometheusExporter.h"
 #include "util/ProtocolVersion.h"
+#include "util/asio.h"
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 /*
 handler functions for the http commands this server supports
@@ -18,6 +22,7 @@ handler functions for the http commands this server supports
 namespace stellar
 {
 class Application;
+class VirtualTimer;
 
 class CommandHandler
 {
@@ -25,15 +30,46 @@ class CommandHandler
                                std::string&)>
         HandlerRoute;
 
+    // Writes the reply of a read-only route from state captured on the main
+    // thread. It may run on another thread, so it must not use the
+    // Application.
+    typedef std::function<void(std::string&)> SnapshotRenderer;
+
+    // Captures, on the main thread, what a read-only route needs and returns
+    // the renderer of its reply
+    typedef std::function<SnapshotRenderer(CommandHandler*, std::string const&)>
+        SnapshotRoute;
+
     Application& mApp;
     std::unique_ptr<http::server::server> mServer;
     std::unique_ptr<QueryServer> mQueryServer;
 
+    // Renders the replies of snapshot routes requested over HTTP, so that
+    // formatting large replies (metrics, info, peers...) doesn't hold up the
+    // main thread. Not started when HTTP_PORT is unset.
+    asio::io_context mSnapshotIOContext;
+    std::unique_ptr<asio::io_context::work> mSnapshotWork;
+    std::thread mSnapshotThread;
+
+    PrometheusExporter mPrometheusExporter;
+
+    // Ends the running tracecapture
+    std::unique_ptr<VirtualTimer> mTraceCaptureTimer;
+
     void addRoute(std::string const& name, HandlerRoute route);
 
+    // Adds a read-only route: the main thread only runs route, the reply is
+    // rendered on mSnapshotThread. manualCmd renders it right away.
+    void addSnapshotRoute(std::string const& name, SnapshotRoute route,
+                          std::string contentType = "application/json");
+
     void safeRouter(HandlerRoute route, std::string const& params,
                     std::string& retStr);
 
+    // Runs f, replacing retStr with an error if it throws
+    static void catchErrors(std::function<void()> const& f,
+                            std::string& retStr);
+
     void ensureProtocolVersion(std::map<std::string, std::string> const& args,
                                std::string const& argName,
                                ProtocolVersion minVer);
@@ -42,6 +78,7 @@ class CommandHandler
 
   public:
     CommandHandler(Application& app);
+    ~CommandHandler();
 
     std::string manualCmd(std::string const& cmd);
 
@@ -50,25 +87,37 @@ class CommandHandler
     void bans(std::string const& params, std::string& retStr);
     void connect(std::string const& params, std::string& retStr);
     void dropPeer(std::string const& params, std::string& retStr);
-    void info(std::string const& params, std::string& retStr);
+    SnapshotRenderer info(std::string const& params);
     void ll(std::string const& params, std::string& retStr);
     void logRotate(std::string const& params, std::string& retStr);
     void maintenance(std::string const& params, std::string& retStr);
     void manualClose(std::string const& params, std::string& retStr);
-    void metrics(std::string const& params, std::string& retStr);
+    SnapshotRenderer metrics(std::string const& params);
     void clearMetrics(std::string const& params, std::string& retStr);
-    void peers(std::string const& params, std::string& retStr);
+    SnapshotRenderer peers(std::string const& params);
+    SnapshotRenderer prometheus(std::string const& params);
     void selfCheck(std::string const&, std::string& retStr);
-    void quorum(std::string const& params, std::string& retStr);
-    void scpInfo(std::string const& params, std::string& retStr);
+    void stateImage(std::string const& params, std::string& retStr);
+    SnapshotRenderer quorum(std::string const& params);
+    SnapshotRenderer scpInfo(std::string const& params);
     void tx(std::string const& params, std::string& retStr);
+
+    // Like tx for many base64 envelopes at once, answering with a result per
+    // envelope. Decoding and signature checks happen on the calling thread,
+    // which must not be the main thread, leaving only the queue to the main
+    // thread.
+    void submitTxBatch(std::vector<std::string> const& blobs,
+                       std::string& retStr);
     void unban(std::string const& params, std::string& retStr);
     void upgrades(std::string const& params, std::string& retStr);
     void dumpProposedSettings(std::string const& params, std::string& retStr);
     void surveyTopology(std::string const&, std::string& retStr);
     void stopSurvey(std::string const&, std::string& retStr);
     void getSurveyResult(std::string const&, std::string& retStr);
-    void sorobanInfo(std::string const&, std::string& retStr);
+    SnapshotRenderer sorobanInfo(std::string const& params);
+    void ledgerTimeline(std::string const& params, std::string& retStr);
+    void memory(std::string const& params, std::string& retStr);
+    void traceCapture(std::string const& params, std::string& retStr);
     void startSurveyCollecting(std::string const& params, std::string& retStr);
     void stopSurveyCollecting(std::string const& params, std::string& retStr);
     void surveyTopologyTimeSliced(std::string const& params,
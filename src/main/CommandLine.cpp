@@ -27,6 +27,7 @@
 #include "main/ErrorMessages.h"
 #include "main/PersistentState.h"
 #include "main/SettingsUpgradeUtils.h"
+#include "main/StateImage.h"
 #include "main/StellarCoreVersion.h"
 #include "main/dumpxdr.h"
 #include "medida/metrics_registry.h"
@@ -35,6 +36,7 @@
 #include "scp/QuorumSetUtils.h"
 #include "transactions/TransactionUtils.h"
 #include "util/Logging.h"
+#include "util/MemoryAccounting.h"
 #include "util/types.h"
 #include "work/WorkScheduler.h"
 
@@ -45,6 +47,7 @@
 
 #ifdef BUILD_TESTS
 #include "simulation/ApplyLoad.h"
+#include "simulation/ReplayApplyLoad.h"
 #include "test/Fuzzer.h"
 #include "test/TestUtils.h"
 #include "test/fuzz.h"
@@ -55,6 +58,7 @@
 #include <iostream>
 #include <lib/clara.hpp>
 #include <optional>
+#include <thread>
 
 namespace stellar
 {
@@ -283,6 +287,14 @@ disableBucketGCParser(bool& disableBucketGC)
         "keeps all, even old, buckets on disk");
 }
 
+clara::Opt
+parallelRangesParser(uint32_t& parallelRanges)
+{
+    return clara::Opt{parallelRanges, "N"}["--parallel-ranges"](
+        "replay up to N disjoint checkpoint ranges concurrently, each from "
+        "the bucket state at its start; requires a new SQLite database");
+}
+
 clara::Opt
 waitForConsensusParser(bool& waitForConsensus)
 {
@@ -583,6 +595,7 @@ CommandLine::ConfigOption::getConfig(bool logToFile) const
             Logging::setLoggingColor(true);
         }
     }
+    Logging::setAsync(config.LOG_ASYNC_QUEUE_SIZE);
 
     bool consoleLogging =
         !logToFile || config.LOG_FILE_PATH.empty() || mConsoleLog;
@@ -777,6 +790,7 @@ runCatchup(CommandLineArgs const& args)
     bool completeValidation = false;
     bool inMemory = false;
     bool forceUntrusted = false;
+    uint32_t parallelRanges = 1;
     std::string hash;
     std::string stream;
 
@@ -832,7 +846,8 @@ runCatchup(CommandLineArgs const& args)
          validationParser(completeValidation), inMemoryParser(inMemory),
          ledgerHashParser(hash), ledgerHashParser(hash),
          forceUntrustedCatchup(forceUntrusted),
-         metadataOutputStreamParser(stream)},
+         metadataOutputStreamParser(stream),
+         parallelRangesParser(parallelRanges)},
         [&] {
             auto config = configOption.getConfig();
             // Don't call config.setNoListen() here as we might want to
@@ -854,68 +869,73 @@ runCatchup(CommandLineArgs const& args)
 
             maybeSetMetadataOutputStream(config, stream);
 
-            VirtualClock clock(VirtualClock::REAL_TIME);
-            int result;
-            {
-                auto app = Application::create(clock, config, inMemory);
-                auto const& ham = app->getHistoryArchiveManager();
-                auto archivePtr = ham.getHistoryArchive(archive);
-                if (iequals(archive, "any"))
-                {
-                    archivePtr = ham.selectRandomReadableHistoryArchive();
-                }
+            CatchupConfiguration cc =
+                parseCatchup(catchupString, hash, completeValidation);
 
-                CatchupConfiguration cc =
-                    parseCatchup(catchupString, hash, completeValidation);
+            if (!trustedCheckpointHashesFile.empty() && !hash.empty())
+            {
+                throw std::runtime_error(
+                    "Either --trusted-checkpoint-hashes or --trusted-hash "
+                    "should be specified, but not both");
+            }
 
-                if (!trustedCheckpointHashesFile.empty() && !hash.empty())
+            if (!trustedCheckpointHashesFile.empty())
+            {
+                if (!HistoryManager::isLastLedgerInCheckpoint(cc.toLedger(),
+                                                              config))
                 {
                     throw std::runtime_error(
-                        "Either --trusted-checkpoint-hashes or --trusted-hash "
-                        "should be specified, but not both");
+                        "destination ledger is not a checkpoint boundary,"
+                        " but trusted checkpoints file was provided");
                 }
-
-                if (!trustedCheckpointHashesFile.empty())
+                Hash h =
+                    WriteVerifiedCheckpointHashesWork::loadHashFromJsonOutput(
+                        cc.toLedger(), trustedCheckpointHashesFile);
+                if (isZero(h))
                 {
-                    if (!HistoryManager::isLastLedgerInCheckpoint(
-                            cc.toLedger(), app->getConfig()))
-                    {
-                        throw std::runtime_error(
-                            "destination ledger is not a checkpoint boundary,"
-                            " but trusted checkpoints file was provided");
-                    }
-                    Hash h = WriteVerifiedCheckpointHashesWork::
-                        loadHashFromJsonOutput(cc.toLedger(),
-                                               trustedCheckpointHashesFile);
-                    if (isZero(h))
-                    {
-                        throw std::runtime_error("destination ledger not found "
-                                                 "in trusted checkpoints file");
-                    }
-                    LedgerNumHashPair pair;
-                    pair.first = cc.toLedger();
-                    pair.second = std::make_optional<Hash>(h);
-                    LOG_INFO(DEFAULT_LOG, "Found trusted hash {} for ledger {}",
-                             hexAbbrev(h), cc.toLedger());
-                    cc = CatchupConfiguration(pair, cc.count(), cc.mode());
+                    throw std::runtime_error("destination ledger not found "
+                                             "in trusted checkpoints file");
                 }
+                LedgerNumHashPair pair;
+                pair.first = cc.toLedger();
+                pair.second = std::make_optional<Hash>(h);
+                LOG_INFO(DEFAULT_LOG, "Found trusted hash {} for ledger {}",
+                         hexAbbrev(h), cc.toLedger());
+                cc = CatchupConfiguration(pair, cc.count(), cc.mode());
+            }
 
-                if (hash.empty() && !forceUntrusted)
-                {
-                    CLOG_WARNING(
-                        History,
-                        "Unsafe command: use --trusted-checkpoint-hashes or "
-                        "--trusted-hash to ensure catchup integrity. If you "
-                        "want to run untrusted catchup, use "
-                        "--force-untrusted-catchup.");
-                }
+            if (hash.empty() && !forceUntrusted)
+            {
+                CLOG_WARNING(
+                    History,
+                    "Unsafe command: use --trusted-checkpoint-hashes or "
+                    "--trusted-hash to ensure catchup integrity. If you "
+                    "want to run untrusted catchup, use "
+                    "--force-untrusted-catchup.");
+            }
 
-                Json::Value catchupInfo;
-                result = catchup(app, cc, catchupInfo, archivePtr);
-                if (!catchupInfo.isNull())
+            int result;
+            Json::Value catchupInfo;
+            if (parallelRanges > 1)
+            {
+                result = parallelCatchup(config, cc, parallelRanges, archive,
+                                         catchupInfo);
+            }
+            else
+            {
+                VirtualClock clock(VirtualClock::REAL_TIME);
+                auto app = Application::create(clock, config, inMemory);
+                auto const& ham = app->getHistoryArchiveManager();
+                auto archivePtr = ham.getHistoryArchive(archive);
+                if (iequals(archive, "any"))
                 {
-                    writeCatchupInfo(catchupInfo, outputFile);
+                    archivePtr = ham.selectRandomReadableHistoryArchive();
                 }
+                result = catchup(app, cc, catchupInfo, archivePtr);
+            }
+            if (!catchupInfo.isNull())
+            {
+                writeCatchupInfo(catchupInfo, outputFile);
             }
             return result;
         });
@@ -1028,10 +1048,16 @@ runDumpXDR(CommandLineArgs const& args)
 {
     std::string xdr;
     bool compact = false;
+    std::optional<std::string> filterQuery;
+    uint32_t threads = std::max(1u, std::thread::hardware_concurrency());
+    auto threadsParser = clara::Opt{threads, "THREADS"}["--threads"](
+        "number of threads to decode with (default: number of cores)");
 
-    return runWithHelp(args, {compactParser(compact), fileNameParser(xdr)},
+    return runWithHelp(args,
+                       {compactParser(compact), filterQueryParser(filterQuery),
+                        threadsParser, fileNameParser(xdr)},
                        [&] {
-                           dumpXdrStream(xdr, compact);
+                           dumpXdrStream(xdr, compact, filterQuery, threads);
                            return 0;
                        });
 }
@@ -1212,6 +1238,21 @@ runNewDB(CommandLineArgs const& args)
                        });
 }
 
+int
+runInstallStateImage(CommandLineArgs const& args)
+{
+    CommandLine::ConfigOption configOption;
+    std::string dir;
+
+    return runWithHelp(args,
+                       {configurationParser(configOption),
+                        requiredArgParser(dir, "DIR-NAME")},
+                       [&] {
+                           StateImage::install(configOption.getConfig(), dir);
+                           return 0;
+                       });
+}
+
 int
 runUpgradeDB(CommandLineArgs const& args)
 {
@@ -1872,28 +1913,81 @@ applyLoadModeParser(std::string& modeArg, ApplyLoadMode& mode)
             mode = ApplyLoadMode::MIX;
             return "";
         }
+        if (iequals(modeArg, "replay"))
+        {
+            mode = ApplyLoadMode::REPLAY;
+            return "";
+        }
         return "Unrecognized apply-load mode. Please select 'soroban' or "
-               "'classic' or 'mix'.";
+               "'classic' or 'mix' or 'replay'.";
     };
 
     return {
         clara::Opt{modeArg, "MODE"}["--mode"](
-            "set the apply-load mode. Expected modes: soroban, classic, mix. "
-            "Defaults to soroban."),
+            "set the apply-load mode. Expected modes: soroban, classic, mix, "
+            "replay. Defaults to soroban."),
         validateMode};
 }
 
+ParserWithValidation
+pregeneratedLoadModeParser(std::string& modeArg, PregeneratedLoadMode& mode)
+{
+    auto validateMode = [&] {
+        if (iequals(modeArg, "pay"))
+        {
+            mode = PregeneratedLoadMode::PAY;
+            return "";
+        }
+        if (iequals(modeArg, "soroban-upload"))
+        {
+            mode = PregeneratedLoadMode::SOROBAN_UPLOAD;
+            return "";
+        }
+        if (iequals(modeArg, "soroban-invoke"))
+        {
+            mode = PregeneratedLoadMode::SOROBAN_INVOKE;
+            return "";
+        }
+        return "Unrecognized load mode. Please select 'pay' or "
+               "'soroban-upload' or 'soroban-invoke'.";
+    };
+
+    return {clara::Opt{modeArg, "MODE"}["--mode"](
+                "set the kind of transactions to generate. Expected modes: "
+                "pay, soroban-upload, soroban-invoke. Defaults to pay."),
+            validateMode};
+}
+
 int
 runApplyLoad(CommandLineArgs const& args)
 {
     CommandLine::ConfigOption configOption;
     ApplyLoadMode mode{ApplyLoadMode::SOROBAN};
     std::string modeArg = "soroban";
+    std::string metaFile;
+    uint32_t runs = 1;
 
     return runWithHelp(
         args,
-        {configurationParser(configOption), applyLoadModeParser(modeArg, mode)},
+        {configurationParser(configOption), applyLoadModeParser(modeArg, mode),
+         clara::Opt{metaFile, "FILE"}["--meta-file"](
+             "LedgerCloseMeta stream to replay in replay mode"),
+         clara::Opt{runs, "RUNS"}["--runs"](
+             "number of times to replay the ledgers in replay mode")},
         [&] {
+            if (mode == ApplyLoadMode::REPLAY)
+            {
+                if (metaFile.empty())
+                {
+                    throw std::runtime_error(
+                        "--meta-file is required in replay mode");
+                }
+                ReplayApplyLoad replay(configOption.getConfig(), metaFile);
+                replay.benchmark(runs);
+                replay.logResults();
+                return 0;
+            }
+
             auto config = configOption.getConfig();
             config.RUN_STANDALONE = true;
             config.MANUAL_CLOSE = true;
@@ -2000,6 +2094,11 @@ runApplyLoad(CommandLineArgs const& args)
 
                 CLOG_INFO(Perf, "Tx count utilization {}%",
                           al.getTxCountUtilization().mean() / 1000.0);
+                if (memoryaccounting::isEnabled())
+                {
+                    CLOG_INFO(Perf, "Mean allocations per ledger: {}",
+                              al.getLedgerAllocations().mean());
+                }
 
                 // Only log Soroban-specific metrics in Soroban mode
                 if (mode == ApplyLoadMode::SOROBAN)
@@ -2032,22 +2131,27 @@ runGenerateSyntheticLoad(CommandLineArgs const& args)
     CLOG_WARNING(Perf, "This command will run new-db and start a test network "
                        "to generate synthentic load");
     std::string outputFile = "stellar-load-transactions.xdr";
-    uint32_t numTransactions = 1000;
-    uint32_t numAccounts = 100;
+    PregeneratedLoadConfig loadConfig;
+    std::string modeArg = "pay";
     CommandLine::ConfigOption configOption;
 
-    uint32_t offset = 0;
-
     return runWithHelp(
         args,
         {configurationParser(configOption),
          outputFileParser(outputFile).required(),
-         clara::Opt{numTransactions, "NUM-TRANSACTIONS"}["--count"](
+         pregeneratedLoadModeParser(modeArg, loadConfig.mode),
+         clara::Opt{loadConfig.numTransactions, "NUM-TRANSACTIONS"}["--count"](
              "number of transactions to generate"),
-         clara::Opt{numAccounts, "NUM-ACCOUNTS"}["--accounts"](
+         clara::Opt{loadConfig.accounts, "NUM-ACCOUNTS"}["--accounts"](
              "number of test accounts to use"),
-         clara::Opt{offset,
-                    "OFFSET"}["--offset"]("offset for account selection")},
+         clara::Opt{loadConfig.offset,
+                    "OFFSET"}["--offset"]("offset for account selection"),
+         clara::Opt{loadConfig.instances, "NUM-INSTANCES"}["--instances"](
+             "number of contract instances to invoke in soroban-invoke mode"),
+         clara::Opt{loadConfig.conflictPercent,
+                    "PERCENT"}["--conflict-percent"](
+             "percentage of invocations that write the same entries of one "
+             "instance in soroban-invoke mode")},
         [&] {
             try
             {
@@ -2064,8 +2168,7 @@ runGenerateSyntheticLoad(CommandLineArgs const& args)
                                          .header.ledgerVersion ==
                                      Config::CURRENT_LEDGER_PROTOCOL_VERSION);
 
-                generateTransactions(*app, outputFile, numTransactions,
-                                     numAccounts, offset);
+                generateTransactions(*app, outputFile, loadConfig);
 
                 return 0;
             }
@@ -2114,6 +2217,10 @@ handleCommandLine(int argc, char* const* argv)
          {"new-db", "creates or restores the DB to the genesis ledger",
           runNewDB},
          {"new-hist", "initialize history archives", runNewHist},
+         {"install-state-image",
+          "replaces the DB and buckets with a state image written by the "
+          "'stateimage' HTTP command",
+          runInstallStateImage},
          {"offline-info", "return information for an offline instance",
           runOfflineInfo},
          {"print-xdr", "pretty-print one XDR envelope, then quit", runPrintXdr},
@@ -2154,7 +2261,7 @@ handleCommandLine(int argc, char* const* argv)
          {"test", "execute test suite", runTest},
          {"apply-load", "run apply time load test", runApplyLoad},
          {"pregenerate-loadgen-txs",
-          "generate payment transactions XDR file for load testing",
+          "generate transactions XDR file for load testing",
           runGenerateSyntheticLoad},
 #endif
          {"version", "print version information", runVersion}}};
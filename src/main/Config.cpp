@@ -9,9 +9,12 @@
 #include "crypto/KeyUtils.h"
 #include "herder/Herder.h"
 #include "history/HistoryArchive.h"
+#include "ledger/IndexedLedgerCloseMeta.h"
 #include "main/StellarCoreVersion.h"
+#include "overlay/MessageCompression.h"
 #include "scp/LocalNode.h"
 #include "scp/QuorumSetUtils.h"
+#include "util/BlockCompressedFile.h"
 #include "util/Fs.h"
 #include "util/GlobalChecks.h"
 #include "util/Logging.h"
@@ -171,14 +174,46 @@ Config::Config() : NODE_SEED(SecretKey::random())
     MANUAL_CLOSE = false;
     CATCHUP_COMPLETE = false;
     CATCHUP_RECENT = 0;
+    BUFFERED_LEDGERS_MEMORY_LIMIT_MB = 0;
     BACKGROUND_OVERLAY_PROCESSING = true;
+    OVERLAY_THREADS = 1;
     EXPERIMENTAL_PARALLEL_LEDGER_APPLY = false;
+    EXPERIMENTAL_PIPELINED_LEDGER_COMMIT = false;
     EXPERIMENTAL_BACKGROUND_TX_SIG_VERIFICATION = false;
+    EXPERIMENTAL_BACKGROUND_TX_PREVALIDATION = false;
+    EXPERIMENTAL_NATIVE_HISTORY_GET = false;
+    EXPERIMENTAL_STREAMING_HISTORY_GET = false;
+    EXPERIMENTAL_ZSTD_HISTORY = false;
     BUCKETLIST_DB_INDEX_PAGE_SIZE_EXPONENT = 14; // 2^14 == 16 kb
     BUCKETLIST_DB_INDEX_CUTOFF = 20;             // 20 mb
     BUCKETLIST_DB_MEMORY_FOR_CACHING = 0;
+    BUCKETLIST_DB_HOT_ARCHIVE_MEMORY_FOR_CACHING = 0;
     BUCKETLIST_DB_PERSIST_INDEX = true;
+    BUCKETLIST_DB_BATCHED_READS = false;
+    BUCKETLIST_DB_MMAP_BUCKETS = false;
+    BUCKETLIST_DB_COMPRESS_BUCKETS = false;
+    BUCKETLIST_DB_CACHE_FREQUENCY_ADMISSION = false;
+    BUCKETLIST_DB_COMBINED_FILTER_LEVEL = 0;
+    BUCKETLIST_DB_INDEX_MEMORY_BUDGET = 0;
+    BUCKETLIST_DB_INDEX_BUILD_RATE = 0;
+    HOT_ARCHIVE_MERGE_RATE = 0;
+    BUCKET_MERGE_PARTITIONS = 1;
+    BACKGROUND_EVICTION_SCAN_THREADS = 1;
+    FEE_PROCESSING_THREADS = 1;
+    SOROBAN_APPLY_THREADS = 0;
+    SOROBAN_APPLY_PIN_THREADS = false;
+    APPLY_NUMA_NODE = std::nullopt;
+    TX_SET_VALIDATION_THREADS = 1;
+    CLASSIC_SIGNATURE_PREVERIFY_THREADS = 0;
+    SIGNATURE_CACHE_SIZE =
+        static_cast<uint32_t>(PubKeyUtils::DEFAULT_VERIFY_SIG_CACHE_SIZE);
+    SOROBAN_STATE_LOAD_THREADS = 1;
+    SOROBAN_STATE_TTL_INDEX = false;
+    BUCKET_MERGE_PIPELINED_WRITES = false;
+    BUCKET_VERIFY_PIPELINED_HASHING = false;
     PUBLISH_TO_ARCHIVE_DELAY = std::chrono::seconds{0};
+    CHECKPOINT_FSYNC_INTERVAL_LEDGERS = 1;
+    CHECKPOINT_FSYNC_INTERVAL_MS = std::chrono::milliseconds{0};
     // automatic maintenance settings:
     // short and prime with 1 hour which will cause automatic maintenance to
     // rarely conflict with any other scheduled tasks on a machine (that tend to
@@ -227,14 +262,20 @@ Config::Config() : NODE_SEED(SecretKey::random())
             1000,
         CLOSETIME_DRIFT_LIMIT);
     METADATA_OUTPUT_STREAM = "";
+    METADATA_OUTPUT_STREAM_MAX_PENDING_LEDGERS = 4;
+    METADATA_OUTPUT_STREAM_ABORT_WHEN_BEHIND = false;
+    METADATA_OUTPUT_STREAM_INDEXED = false;
+    METADATA_OUTPUT_STREAM_COMPRESS = false;
 
     // Store at least 1 checkpoint plus a buffer worth of debug meta
     METADATA_DEBUG_LEDGERS = 100;
 
     LOG_FILE_PATH = "stellar-core-{datetime:%Y-%m-%d_%H-%M-%S}.log";
     BUCKET_DIR_PATH = "buckets";
+    BUCKET_CACHE_DIR = "";
 
     LOG_COLOR = false;
+    LOG_ASYNC_QUEUE_SIZE = 0;
 
     TESTING_UPGRADE_LEDGER_PROTOCOL_VERSION = LEDGER_PROTOCOL_VERSION;
     TESTING_UPGRADE_DESIRED_FEE = LedgerManager::GENESIS_LEDGER_BASE_FEE;
@@ -246,6 +287,7 @@ Config::Config() : NODE_SEED(SecretKey::random())
 
     QUERY_THREAD_POOL_SIZE = 4;
     QUERY_SNAPSHOT_LEDGERS = 5;
+    QUERY_ENTRY_CACHE_MB = 16;
     HTTP_QUERY_PORT = 0;
     PUBLIC_HTTP_PORT = false;
     HTTP_MAX_CLIENT = 128;
@@ -261,6 +303,7 @@ Config::Config() : NODE_SEED(SecretKey::random())
 
     FLOOD_OP_RATE_PER_LEDGER = 1.0;
     FLOOD_TX_PERIOD_MS = 200;
+    FLOOD_TX_PACING = false;
 
     FLOOD_SOROBAN_RATE_PER_LEDGER = 1.0;
     FLOOD_SOROBAN_TX_PERIOD_MS = 200;
@@ -271,6 +314,7 @@ Config::Config() : NODE_SEED(SecretKey::random())
     FLOOD_DEMAND_PERIOD_MS = std::chrono::milliseconds(200);
     FLOOD_ADVERT_PERIOD_MS = std::chrono::milliseconds(100);
     FLOOD_DEMAND_BACKOFF_DELAY_MS = std::chrono::milliseconds(500);
+    FLOOD_RECORD_LIMIT = 500000;
     EXPERIMENTAL_TX_BATCH_MAX_SIZE = 0;
 
     MAX_BATCH_WRITE_COUNT = 1024;
@@ -286,6 +330,7 @@ Config::Config() : NODE_SEED(SecretKey::random())
     PEER_FLOOD_READING_CAPACITY_BYTES = 0;
     FLOW_CONTROL_SEND_MORE_BATCH_SIZE_BYTES = 0;
     OUTBOUND_TX_QUEUE_BYTE_LIMIT = 1024 * 1024 * 3;
+    PEER_MESSAGE_COMPRESSION_THRESHOLD = 4096;
 
     // WORKER_THREADS: setting this too low risks a form of priority inversion
     // where a long-running background task occupies all worker threads and
@@ -309,6 +354,7 @@ Config::Config() : NODE_SEED(SecretKey::random())
     NODE_IS_VALIDATOR = false;
     QUORUM_INTERSECTION_CHECKER = true;
     USE_QUORUM_INTERSECTION_CHECKER_V2 = false;
+    QUORUM_INTERSECTION_CHECKER_THREADS = 1;
     QUORUM_INTERSECTION_CHECKER_TIME_LIMIT_MS = 5000; // 5 secs
     QUORUM_INTERSECTION_CHECKER_MEMORY_LIMIT_BYTES =
         100 * 1024 * 1024; // 100 MiB
@@ -317,6 +363,9 @@ Config::Config() : NODE_SEED(SecretKey::random())
 
     ENTRY_CACHE_SIZE = 100000;
     PREFETCH_BATCH_SIZE = 1000;
+    PREFETCH_CANDIDATE_TX_SET = false;
+    BACKGROUND_SCP_HISTORY_WRITES = false;
+    SQLITE_IN_MEMORY_OFFERS = false;
 
     HISTOGRAM_WINDOW_SIZE = std::chrono::seconds(30);
 
@@ -344,6 +393,8 @@ Config::Config() : NODE_SEED(SecretKey::random())
     // setting and there aren't many good values for it.
     SOROBAN_PHASE_MIN_STAGE_COUNT = 1;
     SOROBAN_PHASE_MAX_STAGE_COUNT = 4;
+    SOROBAN_PHASE_BUILD_THREADS = 1;
+    SOROBAN_PHASE_BUILD_TIME_BUDGET_MS = 0;
 
     EMIT_CLASSIC_EVENTS = false;
     BACKFILL_STELLAR_ASSET_EVENTS = false;
@@ -356,6 +407,9 @@ Config::Config() : NODE_SEED(SecretKey::random())
     COMMANDS = {};
     REPORT_METRICS = {};
     INVARIANT_CHECKS = {};
+    INVARIANT_CHECK_SAMPLE_RATES = {};
+    INVARIANT_CHECKS_ASYNC = false;
+    INVARIANT_CHECKS_ASYNC_MAX_LAG_LEDGERS = 2;
 
 #ifdef BUILD_TESTS
     TEST_CASES_ENABLED = false;
@@ -1094,6 +1148,15 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
                  [&]() {
                      OUTBOUND_TX_QUEUE_BYTE_LIMIT = readInt<uint32_t>(item, 1);
                  }},
+                {"PEER_MESSAGE_COMPRESSION_KEYS",
+                 [&]() {
+                     // handled below
+                 }},
+                {"PEER_MESSAGE_COMPRESSION_THRESHOLD",
+                 [&]() {
+                     PEER_MESSAGE_COMPRESSION_THRESHOLD =
+                         readInt<uint32_t>(item, 1);
+                 }},
 #ifdef BUILD_TESTS
                 {"TRANSACTION_QUEUE_SIZE_MULTIPLIER_FOR_TESTING",
                  [&]() {
@@ -1125,17 +1188,48 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
                  [&]() { DISABLE_XDR_FSYNC = readBool(item); }},
                 {"METADATA_OUTPUT_STREAM",
                  [&]() { METADATA_OUTPUT_STREAM = readString(item); }},
+                {"METADATA_OUTPUT_STREAM_MAX_PENDING_LEDGERS",
+                 [&]() {
+                     METADATA_OUTPUT_STREAM_MAX_PENDING_LEDGERS =
+                         readInt<uint32_t>(item, 1);
+                 }},
+                {"METADATA_OUTPUT_STREAM_ABORT_WHEN_BEHIND",
+                 [&]() {
+                     METADATA_OUTPUT_STREAM_ABORT_WHEN_BEHIND = readBool(item);
+                 }},
+                {"METADATA_OUTPUT_STREAM_INDEXED",
+                 [&]() { METADATA_OUTPUT_STREAM_INDEXED = readBool(item); }},
+                {"METADATA_OUTPUT_STREAM_COMPRESS",
+                 [&]() { METADATA_OUTPUT_STREAM_COMPRESS = readBool(item); }},
                 {"BACKGROUND_OVERLAY_PROCESSING",
                  [&]() { BACKGROUND_OVERLAY_PROCESSING = readBool(item); }},
+                {"OVERLAY_THREADS",
+                 [&]() { OVERLAY_THREADS = readInt<uint32_t>(item, 1, 64); }},
                 {"EXPERIMENTAL_PARALLEL_LEDGER_APPLY",
                  [&]() {
                      EXPERIMENTAL_PARALLEL_LEDGER_APPLY = readBool(item);
                  }},
+                {"EXPERIMENTAL_PIPELINED_LEDGER_COMMIT",
+                 [&]() {
+                     EXPERIMENTAL_PIPELINED_LEDGER_COMMIT = readBool(item);
+                 }},
                 {"EXPERIMENTAL_BACKGROUND_TX_SIG_VERIFICATION",
                  [&]() {
                      EXPERIMENTAL_BACKGROUND_TX_SIG_VERIFICATION =
                          readBool(item);
                  }},
+                {"EXPERIMENTAL_BACKGROUND_TX_PREVALIDATION",
+                 [&]() {
+                     EXPERIMENTAL_BACKGROUND_TX_PREVALIDATION = readBool(item);
+                 }},
+                {"EXPERIMENTAL_NATIVE_HISTORY_GET",
+                 [&]() { EXPERIMENTAL_NATIVE_HISTORY_GET = readBool(item); }},
+                {"EXPERIMENTAL_STREAMING_HISTORY_GET",
+                 [&]() {
+                     EXPERIMENTAL_STREAMING_HISTORY_GET = readBool(item);
+                 }},
+                {"EXPERIMENTAL_ZSTD_HISTORY",
+                 [&]() { EXPERIMENTAL_ZSTD_HISTORY = readBool(item); }},
                 {"ARTIFICIALLY_DELAY_LEDGER_CLOSE_FOR_TESTING",
                  [&]() {
                      ARTIFICIALLY_DELAY_LEDGER_CLOSE_FOR_TESTING =
@@ -1158,10 +1252,100 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
                  [&]() {
                      BUCKETLIST_DB_MEMORY_FOR_CACHING = readInt<size_t>(item);
                  }},
+                {"BUCKETLIST_DB_HOT_ARCHIVE_MEMORY_FOR_CACHING",
+                 [&]() {
+                     BUCKETLIST_DB_HOT_ARCHIVE_MEMORY_FOR_CACHING =
+                         readInt<size_t>(item);
+                 }},
                 {"BUCKETLIST_DB_INDEX_CUTOFF",
                  [&]() { BUCKETLIST_DB_INDEX_CUTOFF = readInt<size_t>(item); }},
                 {"BUCKETLIST_DB_PERSIST_INDEX",
                  [&]() { BUCKETLIST_DB_PERSIST_INDEX = readBool(item); }},
+                {"BUCKETLIST_DB_BATCHED_READS",
+                 [&]() { BUCKETLIST_DB_BATCHED_READS = readBool(item); }},
+                {"BUCKETLIST_DB_MMAP_BUCKETS",
+                 [&]() { BUCKETLIST_DB_MMAP_BUCKETS = readBool(item); }},
+                {"BUCKETLIST_DB_COMPRESS_BUCKETS",
+                 [&]() { BUCKETLIST_DB_COMPRESS_BUCKETS = readBool(item); }},
+                {"BUCKETLIST_DB_CACHE_FREQUENCY_ADMISSION",
+                 [&]() {
+                     BUCKETLIST_DB_CACHE_FREQUENCY_ADMISSION = readBool(item);
+                 }},
+                {"BUCKETLIST_DB_COMBINED_FILTER_LEVEL",
+                 [&]() {
+                     BUCKETLIST_DB_COMBINED_FILTER_LEVEL = readInt<uint32_t>(
+                         item, 0, LiveBucketList::kNumLevels - 1);
+                 }},
+                {"BUCKETLIST_DB_INDEX_MEMORY_BUDGET",
+                 [&]() {
+                     BUCKETLIST_DB_INDEX_MEMORY_BUDGET = readInt<size_t>(item);
+                 }},
+                {"BUCKETLIST_DB_INDEX_BUILD_RATE",
+                 [&]() {
+                     BUCKETLIST_DB_INDEX_BUILD_RATE = readInt<size_t>(item);
+                 }},
+                {"HOT_ARCHIVE_MERGE_RATE",
+                 [&]() { HOT_ARCHIVE_MERGE_RATE = readInt<size_t>(item); }},
+                {"BUCKET_MERGE_PARTITIONS",
+                 [&]() {
+                     BUCKET_MERGE_PARTITIONS = readInt<uint32_t>(item, 1, 64);
+                 }},
+                {"BACKGROUND_EVICTION_SCAN_THREADS",
+                 [&]() {
+                     BACKGROUND_EVICTION_SCAN_THREADS =
+                         readInt<uint32_t>(item, 1, 64);
+                 }},
+                {"FEE_PROCESSING_THREADS",
+                 [&]() {
+                     FEE_PROCESSING_THREADS = readInt<uint32_t>(item, 1, 64);
+                 }},
+                {"SOROBAN_APPLY_THREADS",
+                 [&]() {
+                     SOROBAN_APPLY_THREADS = readInt<uint32_t>(item, 0, 256);
+                 }},
+                {"SOROBAN_APPLY_PIN_THREADS",
+                 [&]() { SOROBAN_APPLY_PIN_THREADS = readBool(item); }},
+                {"APPLY_NUMA_NODE",
+                 [&]() {
+                     APPLY_NUMA_NODE = readInt<uint32_t>(item, 0, 1023);
+                 }},
+                {"TX_SET_VALIDATION_THREADS",
+                 [&]() {
+                     TX_SET_VALIDATION_THREADS =
+                         readInt<uint32_t>(item, 1, 64);
+                 }},
+                {"SOROBAN_PHASE_BUILD_THREADS",
+                 [&]() {
+                     SOROBAN_PHASE_BUILD_THREADS =
+                         readInt<uint32_t>(item, 1, 64);
+                 }},
+                {"SOROBAN_PHASE_BUILD_TIME_BUDGET_MS",
+                 [&]() {
+                     SOROBAN_PHASE_BUILD_TIME_BUDGET_MS =
+                         readInt<uint32_t>(item);
+                 }},
+                {"CLASSIC_SIGNATURE_PREVERIFY_THREADS",
+                 [&]() {
+                     CLASSIC_SIGNATURE_PREVERIFY_THREADS =
+                         readInt<uint32_t>(item, 0, 64);
+                 }},
+                {"SIGNATURE_CACHE_SIZE",
+                 [&]() {
+                     SIGNATURE_CACHE_SIZE = readInt<uint32_t>(
+                         item, static_cast<uint32_t>(
+                                   PubKeyUtils::VERIFY_SIG_CACHE_SHARDS));
+                 }},
+                {"SOROBAN_STATE_LOAD_THREADS",
+                 [&]() {
+                     SOROBAN_STATE_LOAD_THREADS =
+                         readInt<uint32_t>(item, 1, 64);
+                 }},
+                {"SOROBAN_STATE_TTL_INDEX",
+                 [&]() { SOROBAN_STATE_TTL_INDEX = readBool(item); }},
+                {"BUCKET_MERGE_PIPELINED_WRITES",
+                 [&]() { BUCKET_MERGE_PIPELINED_WRITES = readBool(item); }},
+                {"BUCKET_VERIFY_PIPELINED_HASHING",
+                 [&]() { BUCKET_VERIFY_PIPELINED_HASHING = readBool(item); }},
                 {"METADATA_DEBUG_LEDGERS",
                  [&]() { METADATA_DEBUG_LEDGERS = readInt<uint32_t>(item); }},
                 {"RUN_STANDALONE", [&]() { RUN_STANDALONE = readBool(item); }},
@@ -1173,6 +1357,11 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
                      CATCHUP_RECENT =
                          readInt<uint32_t>(item, 0, UINT32_MAX - 1);
                  }},
+                {"BUFFERED_LEDGERS_MEMORY_LIMIT_MB",
+                 [&]() {
+                     BUFFERED_LEDGERS_MEMORY_LIMIT_MB =
+                         readInt<uint32_t>(item, 0, 1 << 20);
+                 }},
 #ifdef BUILD_TESTS
                 {"CATCHUP_SKIP_KNOWN_RESULTS_FOR_TESTING",
                  [&]() {
@@ -1235,6 +1424,16 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
                      PUBLISH_TO_ARCHIVE_DELAY =
                          std::chrono::seconds(readInt<uint32_t>(item));
                  }},
+                {"CHECKPOINT_FSYNC_INTERVAL_LEDGERS",
+                 [&]() {
+                     CHECKPOINT_FSYNC_INTERVAL_LEDGERS =
+                         readInt<uint32_t>(item, 1);
+                 }},
+                {"CHECKPOINT_FSYNC_INTERVAL_MS",
+                 [&]() {
+                     CHECKPOINT_FSYNC_INTERVAL_MS =
+                         std::chrono::milliseconds(readInt<uint32_t>(item));
+                 }},
                 {"AUTOMATIC_MAINTENANCE_PERIOD",
                  [&]() {
                      AUTOMATIC_MAINTENANCE_PERIOD =
@@ -1252,8 +1451,14 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
                 {"MANUAL_CLOSE", [&]() { MANUAL_CLOSE = readBool(item); }},
                 {"LOG_FILE_PATH", [&]() { LOG_FILE_PATH = readString(item); }},
                 {"LOG_COLOR", [&]() { LOG_COLOR = readBool(item); }},
+                {"LOG_ASYNC_QUEUE_SIZE",
+                 [&]() {
+                     LOG_ASYNC_QUEUE_SIZE = readInt<uint32_t>(item);
+                 }},
                 {"BUCKET_DIR_PATH",
                  [&]() { BUCKET_DIR_PATH = readString(item); }},
+                {"BUCKET_CACHE_DIR",
+                 [&]() { BUCKET_CACHE_DIR = readString(item); }},
                 {"NODE_NAMES",
                  [&]() {
                      auto names = readArray<std::string>(item);
@@ -1316,6 +1521,8 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
                  }},
                 {"FLOOD_TX_PERIOD_MS",
                  [&]() { FLOOD_TX_PERIOD_MS = readInt<int>(item, 1); }},
+                {"FLOOD_TX_PACING",
+                 [&]() { FLOOD_TX_PACING = readBool(item); }},
                 {"FLOOD_SOROBAN_RATE_PER_LEDGER",
                  [&]() {
                      FLOOD_SOROBAN_RATE_PER_LEDGER = readDouble(item);
@@ -1342,6 +1549,8 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
                      FLOOD_DEMAND_BACKOFF_DELAY_MS =
                          std::chrono::milliseconds(readInt<int>(item, 1));
                  }},
+                {"FLOOD_RECORD_LIMIT",
+                 [&]() { FLOOD_RECORD_LIMIT = readInt<uint32_t>(item, 1); }},
                 {"EXPERIMENTAL_TX_BATCH_MAX_SIZE",
                  [&]() {
                      EXPERIMENTAL_TX_BATCH_MAX_SIZE = readInt<size_t>(item, 0);
@@ -1392,6 +1601,10 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
                  [&]() {
                      QUERY_SNAPSHOT_LEDGERS = readInt<uint32_t>(item, 0);
                  }},
+                {"QUERY_ENTRY_CACHE_MB",
+                 [&]() {
+                     QUERY_ENTRY_CACHE_MB = readInt<uint32_t>(item, 0, 4096);
+                 }},
                 {"MAX_CONCURRENT_SUBPROCESSES",
                  [&]() {
                      MAX_CONCURRENT_SUBPROCESSES = readInt<size_t>(item, 1);
@@ -1402,6 +1615,11 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
                  [&]() {
                      USE_QUORUM_INTERSECTION_CHECKER_V2 = readBool(item);
                  }},
+                {"QUORUM_INTERSECTION_CHECKER_THREADS",
+                 [&]() {
+                     QUORUM_INTERSECTION_CHECKER_THREADS =
+                         readInt<uint32_t>(item, 1, 64);
+                 }},
                 {"QUORUM_INTERSECTION_CHECKER_TIME_LIMIT_MS",
                  [&]() {
                      QUORUM_INTERSECTION_CHECKER_TIME_LIMIT_MS =
@@ -1463,14 +1681,49 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
                  }},
                 {"DATABASE",
                  [&]() { DATABASE = SecretValue{readString(item)}; }},
+                {"BACKGROUND_SCP_HISTORY_WRITES",
+                 [&]() { BACKGROUND_SCP_HISTORY_WRITES = readBool(item); }},
+                {"SQLITE_IN_MEMORY_OFFERS",
+                 [&]() { SQLITE_IN_MEMORY_OFFERS = readBool(item); }},
                 {"NETWORK_PASSPHRASE",
                  [&]() { NETWORK_PASSPHRASE = readString(item); }},
                 {"INVARIANT_CHECKS",
                  [&]() { INVARIANT_CHECKS = readArray<std::string>(item); }},
+                {"INVARIANT_CHECK_SAMPLE_RATES",
+                 [&]() {
+                     auto rates = item.second->as_table();
+                     if (!rates)
+                     {
+                         throw std::invalid_argument(
+                             "INVARIANT_CHECK_SAMPLE_RATES must be a table");
+                     }
+                     for (auto const& rate : *rates)
+                     {
+                         auto value = readDouble(rate);
+                         if (value < 0.0 || value > 1.0)
+                         {
+                             throw std::invalid_argument(fmt::format(
+                                 FMT_STRING("invalid sample rate {} for "
+                                            "invariant '{}', must be "
+                                            "between 0 and 1"),
+                                 value, rate.first));
+                         }
+                         INVARIANT_CHECK_SAMPLE_RATES[rate.first] = value;
+                     }
+                 }},
+                {"INVARIANT_CHECKS_ASYNC",
+                 [&]() { INVARIANT_CHECKS_ASYNC = readBool(item); }},
+                {"INVARIANT_CHECKS_ASYNC_MAX_LAG_LEDGERS",
+                 [&]() {
+                     INVARIANT_CHECKS_ASYNC_MAX_LAG_LEDGERS =
+                         readInt<uint32_t>(item);
+                 }},
                 {"ENTRY_CACHE_SIZE",
                  [&]() { ENTRY_CACHE_SIZE = readInt<uint32_t>(item); }},
                 {"PREFETCH_BATCH_SIZE",
                  [&]() { PREFETCH_BATCH_SIZE = readInt<uint32_t>(item); }},
+                {"PREFETCH_CANDIDATE_TX_SET",
+                 [&]() { PREFETCH_CANDIDATE_TX_SET = readBool(item); }},
                 {"MAXIMUM_LEDGER_CLOSETIME_DRIFT",
                  [&]() {
                      MAXIMUM_LEDGER_CLOSETIME_DRIFT = readInt<int64_t>(item, 0);
@@ -1909,6 +2162,40 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
                 "to be enabled");
         }
 
+        if (METADATA_OUTPUT_STREAM_COMPRESS)
+        {
+            if (!METADATA_OUTPUT_STREAM_INDEXED)
+            {
+                throw std::invalid_argument(
+                    "Invalid configuration: METADATA_OUTPUT_STREAM_COMPRESS "
+                    "requires METADATA_OUTPUT_STREAM_INDEXED");
+            }
+            if (!IndexedLedgerCloseMeta::supportsCompression())
+            {
+                throw std::invalid_argument(
+                    "Invalid configuration: METADATA_OUTPUT_STREAM_COMPRESS "
+                    "requires a build with zlib");
+            }
+        }
+
+        if (BUCKETLIST_DB_COMPRESS_BUCKETS)
+        {
+            if (!BlockCompressedFile::supported())
+            {
+                throw std::invalid_argument(
+                    "Invalid configuration: BUCKETLIST_DB_COMPRESS_BUCKETS "
+                    "requires a build with zlib");
+            }
+            // Zstd archives are compressed by an external command, which
+            // would see the compressed bytes
+            if (EXPERIMENTAL_ZSTD_HISTORY)
+            {
+                throw std::invalid_argument(
+                    "Invalid configuration: BUCKETLIST_DB_COMPRESS_BUCKETS "
+                    "can't be combined with EXPERIMENTAL_ZSTD_HISTORY");
+            }
+        }
+
         // Check all loadgen distributions
         verifyLoadGenOpCountForTestingConfigs();
         verifyLoadGenDistribution(
@@ -1962,6 +2249,16 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
 
         parseNodeIDsIntoSet(t, "PREFERRED_PEER_KEYS", PREFERRED_PEER_KEYS);
         parseNodeIDsIntoSet(t, "SURVEYOR_KEYS", SURVEYOR_KEYS);
+        parseNodeIDsIntoSet(t, "PEER_MESSAGE_COMPRESSION_KEYS",
+                            PEER_MESSAGE_COMPRESSION_KEYS);
+
+        if (!PEER_MESSAGE_COMPRESSION_KEYS.empty() &&
+            !MessageCompression::supported())
+        {
+            throw std::invalid_argument(
+                "Invalid configuration: PEER_MESSAGE_COMPRESSION_KEYS "
+                "requires a build with zlib");
+        }
 
         auto autoQSet = generateQuorumSet(validators);
         auto autoQSetStr = toString(autoQSet);
@@ -2174,6 +2471,7 @@ Config::logBasicInfo() const
              "BACKGROUND_OVERLAY_PROCESSING="
              "{}",
              BACKGROUND_OVERLAY_PROCESSING ? "true" : "false");
+    LOG_INFO(DEFAULT_LOG, "OVERLAY_THREADS={}", OVERLAY_THREADS);
     LOG_INFO(DEFAULT_LOG,
              "EXPERIMENTAL_PARALLEL_LEDGER_APPLY="
              "{}",
@@ -203,6 +203,10 @@ class Config : public std::enable_shared_from_this<Config>
     // If you want, say, a week of history, set this to 120000.
     uint32_t CATCHUP_RECENT;
 
+    // Size of the tx sets of the ledgers buffered while out of sync above
+    // which further ones are spilled to disk, 0 to keep them all in memory
+    uint32_t BUFFERED_LEDGERS_MEMORY_LIMIT_MB;
+
 #ifdef BUILD_TESTS
     // Mode for "accelerated" catchup. If set to true, the node will skip
     // application of failed transactions and will not verify signatures of
@@ -290,6 +294,18 @@ class Config : public std::enable_shared_from_this<Config>
     // Timeout before publishing externalized values to archive
     std::chrono::seconds PUBLISH_TO_ARCHIVE_DELAY;
 
+    // Number of ledgers appended to the checkpoint in progress between two
+    // fsyncs of its files. With 1, every append is fsynced during ledger
+    // close; otherwise appends are only written to the OS during ledger close
+    // and fsynced on a background thread, trading ledger close latency for
+    // losing up to this many ledgers on a machine crash.
+    uint32_t CHECKPOINT_FSYNC_INTERVAL_LEDGERS;
+
+    // If non-zero, also fsync the checkpoint in progress on the first ledger
+    // appended this long after the previous fsync. Only used when
+    // CHECKPOINT_FSYNC_INTERVAL_LEDGERS is greater than 1.
+    std::chrono::milliseconds CHECKPOINT_FSYNC_INTERVAL_MS;
+
     // Config parameters that force transaction application during ledger
     // close to sleep for a certain amount of time.
     // The probability that it sleeps for
@@ -463,6 +479,13 @@ class Config : public std::enable_shared_from_this<Config>
     // Byte limit for outbound transaction queue.
     uint32_t OUTBOUND_TX_QUEUE_BYTE_LIMIT;
 
+    // Peers that tx sets and SCP messages of at least
+    // PEER_MESSAGE_COMPRESSION_THRESHOLD bytes are compressed with, both
+    // ways. This is not negotiated: the peers must list each other. Requires
+    // a build with zlib.
+    std::set<PublicKey> PEER_MESSAGE_COMPRESSION_KEYS;
+    uint32_t PEER_MESSAGE_COMPRESSION_THRESHOLD;
+
     // Multiplier for classic transaction queue size (only configurable in test
     // builds)
     uint32_t TRANSACTION_QUEUE_SIZE_MULTIPLIER;
@@ -487,6 +510,11 @@ class Config : public std::enable_shared_from_this<Config>
     // always completely held in memory. If set to 0, caching is disabled.
     size_t BUCKETLIST_DB_MEMORY_FOR_CACHING;
 
+    // Memory used for caching archived entries by the Hot Archive BucketList
+    // when Bucket size is larger than BUCKETLIST_DB_INDEX_CUTOFF, in MB. If set
+    // to 0, the Hot Archive cache is disabled.
+    size_t BUCKETLIST_DB_HOT_ARCHIVE_MEMORY_FOR_CACHING;
+
     // Size, in MB, determining whether a bucket should have an individual
     // key index or a key range index. If bucket size is below this value, range
     // based index will be used. If set to 0, all buckets are range indexed. If
@@ -494,12 +522,147 @@ class Config : public std::enable_shared_from_this<Config>
     // index.
     size_t BUCKETLIST_DB_INDEX_CUTOFF;
 
+    // When set to true, BucketListDB bulk loads gather the file offsets of all
+    // requested keys in a bucket first and hint the OS to read all the
+    // corresponding pages at once, instead of issuing one blocking read per
+    // key. This lets the storage device service the reads concurrently.
+    bool BUCKETLIST_DB_BATCHED_READS;
+
+    // When set to true, bucket files are memory mapped once they are adopted
+    // and BucketListDB point lookups decode pages directly out of the mapping
+    // instead of reading them through a per-snapshot file stream. All
+    // snapshots of a bucket then share the OS page cache without copies.
+    bool BUCKETLIST_DB_MMAP_BUCKETS;
+
+    // When set to true, bucket files large enough to be indexed by pages are
+    // stored block-compressed with zlib once merged or downloaded, one block
+    // per index page. Lookups decompress the blocks of the pages they read.
+    // Requires a build with zlib.
+    bool BUCKETLIST_DB_COMPRESS_BUCKETS;
+
+    // When set to true, the BucketListDB account cache only admits a missed
+    // entry if it has been accessed more frequently than the entry it would
+    // evict, as estimated by a TinyLFU frequency sketch. This keeps hot
+    // accounts cached through one-off scans of many cold accounts.
+    bool BUCKETLIST_DB_CACHE_FREQUENCY_ADMISSION;
+
+    // If non-zero, a single negative lookup filter is kept over every key in
+    // the live BucketList from this level down, and is rebuilt in the
+    // background whenever one of those levels changes. Lookups for keys that
+    // are not in the filter skip all buckets in those levels. 0 disables the
+    // filter.
+    uint32_t BUCKETLIST_DB_COMBINED_FILTER_LEVEL;
+
+    // Memory, in MB, that live BucketList indexes may use in total before
+    // buckets larger than BUCKETLIST_DB_INDEX_CUTOFF stop getting in-memory
+    // indexes. While the indexes of the current BucketList use less than this,
+    // a newly indexed large bucket is held completely in memory if it fits in
+    // the remaining budget. 0 disables promotion, so only
+    // BUCKETLIST_DB_INDEX_CUTOFF decides the index type.
+    size_t BUCKETLIST_DB_INDEX_MEMORY_BUDGET;
+
+    // Disk bandwidth, in MB per second, that the buckets indexed on startup
+    // and after catchup may read in total. Buckets are indexed concurrently,
+    // on all worker threads, sharing this budget. 0 leaves indexing
+    // unthrottled.
+    size_t BUCKETLIST_DB_INDEX_BUILD_RATE;
+
+    // Disk bandwidth, in MB per second, that hot archive merges may write in
+    // total. Hot archive merges also run after those of the live BucketList
+    // on the worker threads. 0 leaves them unthrottled.
+    size_t HOT_ARCHIVE_MERGE_RATE;
+
+    // Number of key-range partitions a large LiveBucket merge without shadows
+    // is split into. Partitions are merged concurrently and concatenated into
+    // the output bucket, which is byte-identical to a serial merge. Partition
+    // boundaries come from the inputs' range indexes, so merges of buckets
+    // below BUCKETLIST_DB_INDEX_CUTOFF are always serial. 1 disables
+    // partitioning.
+    uint32_t BUCKET_MERGE_PARTITIONS;
+
+    // Number of threads the background eviction scan is split across. The
+    // scan region is divided into chunks at index page boundaries, so only
+    // buckets above BUCKETLIST_DB_INDEX_CUTOFF are scanned in parallel.
+    // Results are identical to a serial scan. 1 disables parallel scans.
+    uint32_t BACKGROUND_EVICTION_SCAN_THREADS;
+
+    // Number of threads fees are charged on when closing a ledger with a large
+    // transaction set. Transactions are grouped by fee source account and
+    // each group is charged on a single thread, so results and meta are
+    // identical to charging them one by one. 1 disables parallel fee
+    // processing.
+    uint32_t FEE_PROCESSING_THREADS;
+
+    // Number of threads the clusters of a parallel Soroban apply stage run
+    // on. A stage uses one thread per cluster up to this budget, and threads
+    // that finish a cluster move on to the next one. 0 uses one thread per
+    // core.
+    uint32_t SOROBAN_APPLY_THREADS;
+
+    // Pin each parallel Soroban apply thread to its own CPU, so that the
+    // scheduler doesn't migrate them between cores mid-stage.
+    bool SOROBAN_APPLY_PIN_THREADS;
+
+    // NUMA node to run ledger apply on. The apply thread, and the parallel
+    // Soroban apply threads it starts, are restricted to the CPUs of this
+    // node and prefer its memory, as does loading the in-memory Soroban state
+    // and compiling the module cache. Unset leaves placement to the OS.
+    std::optional<uint32_t> APPLY_NUMA_NODE;
+
+    // Number of threads the transactions of a large proposed classic phase
+    // are validated on, each against its own snapshot of the last closed
+    // ledger. The validity decision is identical to validating them one by
+    // one. 1 disables parallel validation.
+    uint32_t TX_SET_VALIDATION_THREADS;
+
+    // Number of helper threads that verify the signatures of classic
+    // transactions ahead of their sequential apply, warming the signature
+    // verification cache. Apply still checks every signature, so results and
+    // meta are unchanged. 0 disables preverification. Tx set validation
+    // verifies its batch of signatures on this many threads in addition to
+    // the validating one.
+    uint32_t CLASSIC_SIGNATURE_PREVERIFY_THREADS;
+
+    // Number of signature verification results kept in the process-wide
+    // signature cache. The cache is split into independently locked shards.
+    uint32_t SIGNATURE_CACHE_SIZE;
+
+    // Number of threads the in-memory Soroban state is loaded from the
+    // BucketList on at startup and after catchup. Bucket levels are scanned
+    // in parallel and merged per shard, so the loaded state is identical to a
+    // serial load. 1 disables parallel loading.
+    uint32_t SOROBAN_STATE_LOAD_THREADS;
+
+    // If set, the in-memory Soroban state also keeps its entries ordered by
+    // TTL, and every entry evicted by the BucketList eviction scan is checked
+    // to be expired according to that index. Eviction itself is unchanged.
+    bool SOROBAN_STATE_TTL_INDEX;
+
+    // If set, bucket merges only serialize output entries on the merging
+    // thread, while hashing and writing the output file happen on a
+    // dedicated thread. Merge output is identical either way.
+    bool BUCKET_MERGE_PIPELINED_WRITES;
+
+    // If set, buckets downloaded during catchup are hashed on a separate
+    // thread while they are being indexed, instead of hashing each entry as
+    // the indexer reads it.
+    bool BUCKET_VERIFY_PIPELINED_HASHING;
+
     // Enable parallel processing of overlay operations (experimental)
     bool BACKGROUND_OVERLAY_PROCESSING;
 
+    // Number of overlay threads used with BACKGROUND_OVERLAY_PROCESSING. Each
+    // peer is assigned to one of them, round-robin, for its lifetime.
+    uint32_t OVERLAY_THREADS;
+
     // Enable parallel block application (experimental)
     bool EXPERIMENTAL_PARALLEL_LEDGER_APPLY;
 
+    // Write ledger close meta to METADATA_OUTPUT_STREAM on a separate commit
+    // stage, so the stream write of ledger N overlaps with the application
+    // of ledger N+1 (experimental).
+    bool EXPERIMENTAL_PIPELINED_LEDGER_COMMIT;
+
     // Batch transactions for flooding purposes (experimental).
     // Has no effect on non-test builds.
     size_t EXPERIMENTAL_TX_BATCH_MAX_SIZE;
@@ -509,6 +672,32 @@ class Config : public std::enable_shared_from_this<Config>
     // also enabled. (experimental)
     bool EXPERIMENTAL_BACKGROUND_TX_SIG_VERIFICATION;
 
+    // Validate classic transactions received over the network in the
+    // background against the last closed ledger, so that the transaction
+    // queue only has to check them against its own state as long as no
+    // ledger closed in between. Does nothing if
+    // `BACKGROUND_OVERLAY_PROCESSING` is not also enabled. (experimental)
+    bool EXPERIMENTAL_BACKGROUND_TX_PREVALIDATION;
+
+    // Download history files from archives whose `get` command is a plain
+    // `curl http://...` template with an in-process HTTP client that keeps
+    // connections alive, instead of spawning a process per file.
+    // (experimental)
+    bool EXPERIMENTAL_NATIVE_HISTORY_GET;
+
+    // When set to true, compressed history files fetched with the in-process
+    // HTTP client are gunzipped and hashed as they arrive, so only the
+    // decompressed file is written to disk. Requires a build with zlib.
+    // (experimental)
+    bool EXPERIMENTAL_STREAMING_HISTORY_GET;
+
+    // When set to true, published checkpoint and bucket files are also
+    // uploaded zstd-compressed next to the gzipped ones and the published
+    // HistoryArchiveState advertises them, and downloads prefer the zstd copy
+    // from archives whose state advertises it. Requires the `zstd` tool.
+    // (experimental)
+    bool EXPERIMENTAL_ZSTD_HISTORY;
+
     // When set to true, BucketListDB indexes are persisted on-disk so that the
     // BucketList does not need to be reindexed on startup. Defaults to true.
     // This should only be set to false for testing purposes
@@ -521,6 +710,17 @@ class Config : public std::enable_shared_from_this<Config>
     // fees, and scp history in the database
     bool MODE_STORES_HISTORY_MISC;
 
+    // When set, the SCP messages and quorum sets stored with
+    // MODE_STORES_HISTORY_MISC are queued and written in the background on a
+    // separate database connection, several ledgers per transaction, instead
+    // of during ledger close. The queue is drained before the last ledger of
+    // every checkpoint is closed. Ignored with an in-memory database.
+    bool BACKGROUND_SCP_HISTORY_WRITES;
+
+    // Keep the offers table of a SQLite database in memory, rebuilding it
+    // from the BucketList on every start. Ignored with PostgreSQL.
+    bool SQLITE_IN_MEMORY_OFFERS;
+
     // A config parameter that controls whether core automatically catches up
     // when it has buffered enough input; if false an out-of-sync node will
     // remain out-of-sync, buffering ledgers from the network in memory until
@@ -592,6 +792,28 @@ class Config : public std::enable_shared_from_this<Config>
     // in consensus, only a passive "watcher" node.
     std::string METADATA_OUTPUT_STREAM;
 
+    // Maximum number of ledgers of meta that may be queued for, or in the
+    // middle of, being written to METADATA_OUTPUT_STREAM when
+    // EXPERIMENTAL_PIPELINED_LEDGER_COMMIT is set. Must be positive.
+    uint32_t METADATA_OUTPUT_STREAM_MAX_PENDING_LEDGERS;
+
+    // What to do when the METADATA_OUTPUT_STREAM consumer falls
+    // METADATA_OUTPUT_STREAM_MAX_PENDING_LEDGERS behind: if false, ledger close
+    // waits for the consumer to catch up; if true, the node fails with an
+    // error instead.
+    bool METADATA_OUTPUT_STREAM_ABORT_WHEN_BEHIND;
+
+    // Write METADATA_OUTPUT_STREAM in the indexed format described in
+    // IndexedLedgerCloseMeta.h instead of as plain LedgerCloseMeta: each
+    // ledger's meta is preceded by a directory of sections holding its
+    // changes grouped by entry type and contract, so consumers can decode
+    // just the changes they need.
+    bool METADATA_OUTPUT_STREAM_INDEXED;
+
+    // Compress the sections of the indexed format with zlib. Requires
+    // METADATA_OUTPUT_STREAM_INDEXED and a build with zlib.
+    bool METADATA_OUTPUT_STREAM_COMPRESS;
+
     // Number of ledgers worth of transaction metadata to preserve on disk for
     // debugging purposes. These records are automatically maintained and
     // rotated during processing, and are helpful for recovery in case of a
@@ -634,7 +856,14 @@ class Config : public std::enable_shared_from_this<Config>
     std::string VERSION_STR;
     std::string LOG_FILE_PATH;
     bool LOG_COLOR;
+    // Number of messages asynchronous logging can queue, 0 to log
+    // synchronously
+    uint32_t LOG_ASYNC_QUEUE_SIZE;
     std::string BUCKET_DIR_PATH;
+    // Read-only directory of buckets named like those in a buckets directory
+    // (`bucket-<hash>.xdr`), checked before downloading a bucket from an
+    // archive. Empty to always download.
+    std::string BUCKET_CACHE_DIR;
 
     // Ledger protocol version for testing purposes. Defaulted to
     // LEDGER_PROTOCOL_VERSION. Used in the following scenarios: 1. to specify
@@ -667,6 +896,9 @@ class Config : public std::enable_shared_from_this<Config>
     int MAX_BATCH_WRITE_BYTES;
     double FLOOD_OP_RATE_PER_LEDGER;
     int FLOOD_TX_PERIOD_MS;
+    // Spread the classic transactions waiting to be flooded evenly over the
+    // rest of the ledger instead of flooding them at the maximum rate.
+    bool FLOOD_TX_PACING;
     double FLOOD_SOROBAN_RATE_PER_LEDGER;
     int FLOOD_SOROBAN_TX_PERIOD_MS;
     int32_t FLOOD_ARB_TX_BASE_ALLOWANCE;
@@ -675,6 +907,8 @@ class Config : public std::enable_shared_from_this<Config>
     std::chrono::milliseconds FLOOD_DEMAND_PERIOD_MS;
     std::chrono::milliseconds FLOOD_ADVERT_PERIOD_MS;
     std::chrono::milliseconds FLOOD_DEMAND_BACKOFF_DELAY_MS;
+    // Maximum number of flooded messages whose senders are remembered
+    uint32_t FLOOD_RECORD_LIMIT;
     static constexpr size_t const POSSIBLY_PREFERRED_EXTRA = 2;
     static constexpr size_t const REALLY_DEAD_NUM_FAILURES_CUTOFF = 120;
 
@@ -704,6 +938,9 @@ class Config : public std::enable_shared_from_this<Config>
     // Number of ledger snapshots to maintain for querying
     uint32_t QUERY_SNAPSHOT_LEDGERS;
 
+    // Size of the entry cache shared by query threads, 0 to disable
+    uint32_t QUERY_ENTRY_CACHE_MB;
+
     // process-management config
     size_t MAX_CONCURRENT_SUBPROCESSES;
 
@@ -721,6 +958,12 @@ class Config : public std::enable_shared_from_this<Config>
     // checker.
     bool USE_QUORUM_INTERSECTION_CHECKER_V2;
 
+    // (V1 only) Number of threads the minimal quorum enumeration runs on. The
+    // top of the search tree is split into subtrees that threads explore
+    // independently, stopping as soon as one finds disjoint quorums. 1 runs
+    // the enumeration on the checker's thread only.
+    uint32_t QUORUM_INTERSECTION_CHECKER_THREADS;
+
     // (V2 only) Time limit in milliseconds for the quorum intersection checker
     uint64_t QUORUM_INTERSECTION_CHECKER_TIME_LIMIT_MS;
 
@@ -730,6 +973,18 @@ class Config : public std::enable_shared_from_this<Config>
     // Invariants
     std::vector<std::string> INVARIANT_CHECKS;
 
+    // Fraction of operations, between 0 and 1, to check each named invariant
+    // on. Invariants not listed are checked on every operation.
+    std::map<std::string, double> INVARIANT_CHECK_SAMPLE_RATES;
+
+    // Check invariants on operation apply on a background thread rather than
+    // during ledger close. Failures are reported at most
+    // INVARIANT_CHECKS_ASYNC_MAX_LAG_LEDGERS ledgers after the ledger they
+    // happened in: ledger close waits for the checks when they fall further
+    // behind.
+    bool INVARIANT_CHECKS_ASYNC;
+    uint32_t INVARIANT_CHECKS_ASYNC_MAX_LAG_LEDGERS;
+
     std::map<std::string, std::string> VALIDATOR_NAMES;
 
     // Information necessary to compute the weight of a validator for leader
@@ -760,6 +1015,12 @@ class Config : public std::enable_shared_from_this<Config>
     // SQL load. Note that it should be significantly smaller than size of
     // the entry cache
     size_t PREFETCH_BATCH_SIZE;
+    // - PREFETCH_CANDIDATE_TX_SET, when set, loads the entries touched by the
+    // tx set SCP nomination settled on from the BucketList in the
+    // background, before it is externalized. This warms the BucketList
+    // caches (and the OS page cache) for apply; the loaded entries themselves
+    // are discarded.
+    bool PREFETCH_CANDIDATE_TX_SET;
 
     // If set to true, the application will halt when an internal error is
     // encountered during applying a transaction. Otherwise, the
@@ -830,6 +1091,17 @@ class Config : public std::enable_shared_from_this<Config>
     uint32_t SOROBAN_PHASE_MIN_STAGE_COUNT;
     uint32_t SOROBAN_PHASE_MAX_STAGE_COUNT;
 
+    // Number of threads the conflict graph of the Soroban transactions is
+    // built on when nominating a parallel Soroban phase. Every stage count
+    // is evaluated on its own thread regardless. 1 builds the graph
+    // serially.
+    uint32_t SOROBAN_PHASE_BUILD_THREADS;
+
+    // Upper bound on the time spent building a parallel Soroban phase for
+    // nomination. Transactions not considered by then are left out of the
+    // phase. 0 means no limit.
+    uint32_t SOROBAN_PHASE_BUILD_TIME_BUDGET_MS;
+
 #ifdef BUILD_TESTS
     // If set to true, the application will be aware this run is for a test
     // case.  This is used right now in the signal handler to exit() instead of
@@ -3,6 +3,7 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "main/Maintainer.h"
+#include "database/DatabaseUtils.h"
 #include "herder/HerderPersistence.h"
 #include "ledger/LedgerHeaderUtils.h"
 #include "ledger/LedgerManager.h"
@@ -15,11 +16,23 @@
 
 #include <Tracy.hpp>
 #include <fmt/format.h>
+#include <medida/counter.h>
+#include <medida/meter.h>
+#include <medida/metrics_registry.h>
+#include <medida/timer.h>
 
 namespace stellar
 {
 
-Maintainer::Maintainer(Application& app) : mApp{app}, mTimer{mApp}
+Maintainer::Maintainer(Application& app)
+    : mApp{app}
+    , mTimer{mApp}
+    , mBatchTimer{mApp}
+    , mPrunedRows{app.getMetrics().NewMeter({"maintenance", "prune", "rows"},
+                                            "row")}
+    , mPruneBatchTime{
+          app.getMetrics().NewTimer({"maintenance", "prune", "batch"})}
+    , mPruneLag{app.getMetrics().NewCounter({"maintenance", "prune", "lag"})}
 {
 }
 
@@ -67,23 +80,104 @@ Maintainer::tick()
 {
     ZoneScoped;
     releaseAssert(threadIsMain());
-    performMaintenance(mApp.getConfig().AUTOMATIC_MAINTENANCE_COUNT);
+    LOG_INFO(DEFAULT_LOG, "Performing maintenance");
+    bool batchPending = mLedgersToPrune > 0;
+    if (batchPending)
+    {
+        CLOG_WARNING(History,
+                     "Maintenance did not keep up, {} ledgers left to prune "
+                     "from the previous period",
+                     mLedgersToPrune);
+    }
+    mLedgersToPrune = mApp.getConfig().AUTOMATIC_MAINTENANCE_COUNT;
+    if (!batchPending)
+    {
+        pruneBatch();
+    }
     scheduleMaintenance();
 }
 
 void
-Maintainer::performMaintenance(uint32_t count)
+Maintainer::scheduleBatch()
+{
+    mBatchTimer.expires_from_now(BATCH_INTERVAL);
+    mBatchTimer.async_wait([this]() { pruneBatch(); },
+                           VirtualTimer::onFailureNoop);
+}
+
+void
+Maintainer::pruneBatch()
 {
     ZoneScoped;
     releaseAssert(threadIsMain());
+    if (mLedgersToPrune == 0)
+    {
+        return;
+    }
+    if (mApp.getLedgerManager().isApplying())
+    {
+        // Wait for the ledger to close
+        scheduleBatch();
+        return;
+    }
 
-    LOG_INFO(DEFAULT_LOG, "Performing maintenance");
-    auto logSlow = LogSlowExecution(
-        "Performing maintenance", LogSlowExecution::Mode::AUTOMATIC_RAII,
-        "performance issue: check database or perform a large manual "
-        "maintenance followed by database maintenance. Maintenance took",
-        std::chrono::seconds{2});
+    auto lmin = getPruneTarget();
+    auto count = std::min(mBatchSize, mLedgersToPrune);
+    bool parallel = mApp.getConfig().parallelLedgerClose();
+    DatabaseUtils::DeletedEntries deleted;
+    std::chrono::nanoseconds elapsed;
+    {
+        auto timer = mPruneBatchTime.TimeScope();
+        auto& sess = mApp.getDatabase().getRawSession();
+        deleted = HerderPersistence::deleteOldEntries(sess, lmin, count);
+        if (!parallel)
+        {
+            deleted.add(LedgerHeaderUtils::deleteOldEntries(sess, lmin, count));
+        }
+        elapsed = timer.Stop();
+    }
+    if (parallel)
+    {
+        // Headers are deleted on the ledger close thread, between ledgers
+        mApp.postOnLedgerCloseThread(
+            [&db = mApp.getDatabase(), &rows = mPrunedRows, lmin, count]() {
+                auto session = std::make_unique<soci::session>(db.getPool());
+                rows.Mark(
+                    LedgerHeaderUtils::deleteOldEntries(*session, lmin, count)
+                        .mRows);
+            },
+            "maintenance: deleteOldEntries");
+    }
+    mPrunedRows.Mark(deleted.mRows);
+    mPruneLag.set_count(deleted.mLedgersLeft);
+
+    // Size the next batch after this one
+    if (elapsed > TARGET_BATCH_DURATION)
+    {
+        mBatchSize = std::max(mBatchSize / 2, uint32_t{1});
+    }
+    else if (elapsed < TARGET_BATCH_DURATION / 2)
+    {
+        auto maxBatchSize = std::max(
+            mApp.getConfig().AUTOMATIC_MAINTENANCE_COUNT, INITIAL_BATCH_SIZE);
+        mBatchSize = std::min(mBatchSize * 2, maxBatchSize);
+    }
 
+    mLedgersToPrune -= count;
+    if (deleted.mLedgersLeft == 0 && !parallel)
+    {
+        // Caught up
+        mLedgersToPrune = 0;
+    }
+    if (mLedgersToPrune > 0)
+    {
+        scheduleBatch();
+    }
+}
+
+uint32_t
+Maintainer::getPruneTarget() const
+{
     // Calculate the minimum of the LCL and/or any queued checkpoint.
     uint32_t lcl = mApp.getLedgerManager().getLastClosedLedgerNum();
     uint32_t ql = HistoryManager::getMinLedgerQueuedToPublish(mApp.getConfig());
@@ -94,8 +188,23 @@ Maintainer::performMaintenance(uint32_t count)
     // So if qmin is (for example) 0x7f = 127, then we want to keep 64
     // ledgers before that, and therefore can erase 0x3f = 63 and less.
     uint32_t freq = HistoryManager::getCheckpointFrequency(mApp.getConfig());
-    uint32_t lmin = qmin >= freq ? qmin - freq : 0;
+    return qmin >= freq ? qmin - freq : 0;
+}
+
+void
+Maintainer::performMaintenance(uint32_t count)
+{
+    ZoneScoped;
+    releaseAssert(threadIsMain());
+
+    LOG_INFO(DEFAULT_LOG, "Performing maintenance");
+    auto logSlow = LogSlowExecution(
+        "Performing maintenance", LogSlowExecution::Mode::AUTOMATIC_RAII,
+        "performance issue: check database or perform a large manual "
+        "maintenance followed by database maintenance. Maintenance took",
+        std::chrono::seconds{2});
 
+    uint32_t lmin = getPruneTarget();
     CLOG_INFO(History, "Trimming history <= ledger {}", lmin);
 
     // Cleanup SCP history, always from main
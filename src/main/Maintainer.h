@@ -8,27 +8,57 @@
 
 #include <cstdint>
 
+namespace medida
+{
+class Counter;
+class Meter;
+class Timer;
+}
+
 namespace stellar
 {
 
 class Application;
 
+// Automatic maintenance prunes the history tables a few ledgers at a time
+// rather than all at once, so that it never holds the database for long:
+// batches are sized to take about TARGET_BATCH_DURATION, and are spread out
+// to leave room for other work, including closing ledgers.
 class Maintainer
 {
   public:
+    static constexpr std::chrono::milliseconds TARGET_BATCH_DURATION{20};
+    static constexpr std::chrono::milliseconds BATCH_INTERVAL{100};
+    static constexpr uint32_t INITIAL_BATCH_SIZE = 16;
+
     explicit Maintainer(Application& app);
 
     // start automatic maintenance according to app.getConfig()
     void start();
 
-    // removes maximum count entries from tables like scphistory
+    // removes maximum count entries from tables like scphistory, at once
     void performMaintenance(uint32_t count);
 
   private:
     Application& mApp;
     VirtualTimer mTimer;
+    VirtualTimer mBatchTimer;
+
+    // Ledgers left to prune in the current maintenance period, in batches of
+    // mBatchSize ledgers
+    uint32_t mLedgersToPrune{0};
+    uint32_t mBatchSize{INITIAL_BATCH_SIZE};
+
+    medida::Meter& mPrunedRows;
+    medida::Timer& mPruneBatchTime;
+    medida::Counter& mPruneLag;
+
+    // Ledgers up to this one can be deleted
+    uint32_t getPruneTarget() const;
 
     void scheduleMaintenance();
     void tick();
+    void scheduleBatch();
+    void pruneBatch();
 };
 }
@@ -208,6 +208,27 @@ PersistentState::setState(PersistentState::Entry entry,
     updateDb(getStoreStateName(entry), value, session, getDBForEntry(entry));
 }
 
+void
+PersistentState::setStates(
+    std::vector<std::pair<Entry, std::string>> const& states,
+    SessionWrapper& session)
+{
+    ZoneScoped;
+    releaseAssert(threadIsMain() ||
+                  mApp.threadIsType(Application::ThreadType::APPLY));
+    releaseAssert(!states.empty());
+
+    auto tableName = getDBForEntry(states.front().first);
+    std::vector<std::pair<std::string, std::string>> rows;
+    rows.reserve(states.size());
+    for (auto const& [entry, value] : states)
+    {
+        releaseAssert(getDBForEntry(entry) == tableName);
+        rows.emplace_back(getStoreStateName(entry), value);
+    }
+    updateDb(rows, session, tableName);
+}
+
 std::unordered_map<uint32_t, std::string>
 PersistentState::getSCPStateAllSlots(std::string table)
 {
@@ -248,15 +269,19 @@ PersistentState::setSCPStateV1ForSlot(
 {
     releaseAssert(threadIsMain());
 
-    soci::transaction tx(mApp.getDatabase().getRawSession());
-    setSCPStateForSlot(slot, value);
-
+    auto slotIdx = static_cast<uint32>(
+        slot % (mApp.getConfig().MAX_SLOTS_TO_REMEMBER + 1));
+    std::vector<std::pair<std::string, std::string>> rows;
+    rows.reserve(txSets.size() + 1);
+    rows.emplace_back(getStoreStateName(kLastSCPDataXDR, slotIdx), value);
     for (auto const& txSet : txSets)
     {
-        updateDb(getStoreStateNameForTxSet(txSet.first), txSet.second,
-                 mApp.getDatabase().getSession(), kSlotTableName);
+        rows.emplace_back(getStoreStateNameForTxSet(txSet.first),
+                          txSet.second);
     }
-    tx.commit();
+
+    // A single statement, so no transaction is needed to write it atomically
+    updateDb(rows, mApp.getDatabase().getSession(), kSlotTableName);
 }
 
 bool
@@ -292,41 +317,49 @@ PersistentState::setRebuildForOfferTable()
 void
 PersistentState::updateDb(std::string const& entry, std::string const& value,
                           SessionWrapper& sess, std::string const& tableName)
+{
+    updateDb({{entry, value}}, sess, tableName);
+}
+
+void
+PersistentState::updateDb(
+    std::vector<std::pair<std::string, std::string>> const& states,
+    SessionWrapper& sess, std::string const& tableName)
 {
     ZoneScoped;
     releaseAssert(threadIsMain() ||
                   mApp.threadIsType(Application::ThreadType::APPLY));
+    releaseAssert(!states.empty());
+
+    // Both SQLite and Postgres support multi-row upserts, replacing the
+    // UPDATE, SELECT and INSERT round trips each row would otherwise take
+    std::string values;
+    for (size_t i = 0; i < states.size(); ++i)
+    {
+        values += fmt::format(FMT_STRING("{}(:n{}, :v{})"), i == 0 ? "" : ", ",
+                              i, i);
+    }
     auto prep = mApp.getDatabase().getPreparedStatement(
-        fmt::format("UPDATE {} SET state = :v WHERE statename = :n;",
-                    tableName),
+        fmt::format(FMT_STRING("INSERT INTO {} (statename, state) VALUES {} "
+                               "ON CONFLICT (statename) DO UPDATE SET "
+                               "state = excluded.state;"),
+                    tableName, values),
         sess);
 
     auto& st = prep.statement();
-    st.exchange(soci::use(value));
-    st.exchange(soci::use(entry));
+    for (auto const& [entry, value] : states)
+    {
+        st.exchange(soci::use(entry));
+        st.exchange(soci::use(value));
+    }
     st.define_and_bind();
     {
-        ZoneNamedN(updateStoreStateZone, "update storestate", true);
+        auto timer = mApp.getDatabase().getUpsertTimer("state");
         st.execute(true);
     }
-
-    if (st.get_affected_rows() != 1 &&
-        getFromDb(entry, sess, tableName).empty())
+    if (st.get_affected_rows() != static_cast<long long>(states.size()))
     {
-        ZoneNamedN(insertStoreStateZone, "insert storestate", true);
-        auto prep2 = mApp.getDatabase().getPreparedStatement(
-            fmt::format("INSERT INTO {} (statename, state) VALUES (:n, :v);",
-                        tableName),
-            sess);
-        auto& st2 = prep2.statement();
-        st2.exchange(soci::use(entry));
-        st2.exchange(soci::use(value));
-        st2.define_and_bind();
-        st2.execute(true);
-        if (st2.get_affected_rows() != 1)
-        {
-            throw std::runtime_error("Could not insert data in SQL");
-        }
+        throw std::runtime_error("Could not insert data in SQL");
     }
 }
 
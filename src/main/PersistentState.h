@@ -9,6 +9,8 @@
 #include "xdr/Stellar-internal.h"
 #include <string>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace stellar
 {
@@ -43,6 +45,10 @@ class PersistentState
     std::string getState(Entry stateName, SessionWrapper& session);
     void setState(Entry stateName, std::string const& value,
                   SessionWrapper& session);
+    // Same as setState for each entry, in a single statement. The entries
+    // must all be stored in the same table.
+    void setStates(std::vector<std::pair<Entry, std::string>> const& states,
+                   SessionWrapper& session);
 
     // Special methods for SCP state (multiple slots)
     std::unordered_map<uint32_t, std::string>
@@ -79,6 +85,10 @@ class PersistentState
     void setSCPStateForSlot(uint64 slot, std::string const& value);
     void updateDb(std::string const& entry, std::string const& value,
                   SessionWrapper& session, std::string const& tableName);
+    // Inserts or replaces every (statename, state) pair in one round trip
+    void
+    updateDb(std::vector<std::pair<std::string, std::string>> const& states,
+             SessionWrapper& session, std::string const& tableName);
 
     std::string getFromDb(std::string const& entry, SessionWrapper& session,
                           std::string const& tableName);
@@ -0,0 +1,203 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "main/QueryEntryCache.h"
+#include "ledger/LedgerTypeUtils.h"
+#include "medida/meter.h"
+#include "medida/metrics_registry.h"
+#include "xdrpp/marshal.h"
+#include <Tracy.hpp>
+#include <iterator>
+
+namespace stellar
+{
+
+QueryEntryCache::QueryEntryCache(size_t maxBytes,
+                                 medida::MetricsRegistry& metrics)
+    : mMaxBytes(maxBytes)
+    , mHits(metrics.NewMeter({"query", "cache", "hit"}, "key"))
+    , mMisses(metrics.NewMeter({"query", "cache", "miss"}, "key"))
+    , mCoalesced(metrics.NewMeter({"query", "cache", "coalesced"}, "key"))
+{
+}
+
+bool
+QueryEntryCache::advanceTo(uint32_t ledgerSeq)
+{
+    if (ledgerSeq < mLedgerSeq)
+    {
+        return false;
+    }
+    if (ledgerSeq > mLedgerSeq)
+    {
+        // Loads in flight for the old ledger still finish and release their
+        // waiters, but find the ledger changed and cache nothing
+        mLedgerSeq = ledgerSeq;
+        mEntries.clear();
+        mInFlight.clear();
+        mBytes = 0;
+    }
+    return true;
+}
+
+void
+QueryEntryCache::insert(LedgerKeySet const& keys,
+                        std::vector<LedgerEntry> const& found)
+{
+    UnorderedMap<LedgerKey, EntryPtr> loaded;
+    for (auto const& le : found)
+    {
+        loaded.emplace(LedgerEntryKey(le), std::make_shared<LedgerEntry>(le));
+    }
+
+    for (auto const& k : keys)
+    {
+        mInFlight.erase(k);
+        auto iter = loaded.find(k);
+        EntryPtr entry = iter == loaded.end() ? nullptr : iter->second;
+        auto size = xdr::xdr_size(k) + (entry ? xdr::xdr_size(*entry) : 0);
+        // Once full, the cache stays as it is until the next ledger
+        if (mBytes + size <= mMaxBytes)
+        {
+            mEntries.emplace(k, std::move(entry));
+            mBytes += size;
+        }
+    }
+}
+
+std::optional<std::vector<LedgerEntry>>
+QueryEntryCache::load(LedgerKeySet const& keys, uint32_t ledgerSeq,
+                      Loader const& loader)
+{
+    ZoneScoped;
+    std::vector<LedgerEntry> result;
+    LedgerKeySet toLoad;
+    std::vector<std::pair<LedgerKey, std::shared_future<void>>> waits;
+    std::promise<void> loaded;
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (mMaxBytes == 0 || !advanceTo(ledgerSeq))
+        {
+            lock.unlock();
+            return loader(keys);
+        }
+
+        auto ready = loaded.get_future().share();
+        size_t hits = 0;
+        for (auto const& k : keys)
+        {
+            if (auto iter = mEntries.find(k); iter != mEntries.end())
+            {
+                ++hits;
+                if (iter->second)
+                {
+                    result.emplace_back(*iter->second);
+                }
+            }
+            else if (auto flight = mInFlight.find(k); flight != mInFlight.end())
+            {
+                waits.emplace_back(k, flight->second);
+            }
+            else
+            {
+                toLoad.emplace(k);
+                mInFlight.emplace(k, ready);
+            }
+        }
+        mHits.Mark(hits);
+        mMisses.Mark(toLoad.size());
+        mCoalesced.Mark(waits.size());
+    }
+
+    if (!toLoad.empty())
+    {
+        std::optional<std::vector<LedgerEntry>> found;
+        try
+        {
+            found = loader(toLoad);
+        }
+        catch (...)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (mLedgerSeq == ledgerSeq)
+                {
+                    for (auto const& k : toLoad)
+                    {
+                        mInFlight.erase(k);
+                    }
+                }
+            }
+            loaded.set_value();
+            throw;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mLedgerSeq == ledgerSeq)
+            {
+                if (found)
+                {
+                    insert(toLoad, *found);
+                }
+                else
+                {
+                    for (auto const& k : toLoad)
+                    {
+                        mInFlight.erase(k);
+                    }
+                }
+            }
+        }
+        loaded.set_value();
+
+        if (!found)
+        {
+            return std::nullopt;
+        }
+        result.insert(result.end(), std::make_move_iterator(found->begin()),
+                      std::make_move_iterator(found->end()));
+    }
+
+    if (waits.empty())
+    {
+        return result;
+    }
+
+    // Keys whose load failed, or that didn't fit in the cache, are loaded
+    // again here
+    LedgerKeySet retry;
+    for (auto const& [k, ready] : waits)
+    {
+        ready.wait();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (auto const& [k, ready] : waits)
+        {
+            auto iter = mEntries.find(k);
+            if (mLedgerSeq != ledgerSeq || iter == mEntries.end())
+            {
+                retry.emplace(k);
+            }
+            else if (iter->second)
+            {
+                result.emplace_back(*iter->second);
+            }
+        }
+    }
+
+    if (!retry.empty())
+    {
+        auto found = loader(retry);
+        if (!found)
+        {
+            return std::nullopt;
+        }
+        result.insert(result.end(), std::make_move_iterator(found->begin()),
+                      std::make_move_iterator(found->end()));
+    }
+    return result;
+}
+}
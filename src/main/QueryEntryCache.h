@@ -0,0 +1,80 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "ledger/LedgerHashUtils.h" // IWYU pragma: keep
+#include "util/NonCopyable.h"
+#include "util/UnorderedMap.h"
+#include "util/types.h"
+#include "xdr/Stellar-ledger-entries.h"
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace medida
+{
+class Meter;
+class MetricsRegistry;
+}
+
+namespace stellar
+{
+
+// Read-through cache of live BucketList entries shared by the QueryServer's
+// threads. It only holds entries of the newest ledger any thread has asked
+// about and is emptied when a newer one is asked about, so it never needs
+// invalidating within a ledger. Keys that are not found are cached too.
+//
+// When a thread needs keys that another thread is already loading, it waits
+// for that load instead of reading the same buckets again, so a burst of
+// requests for a popular key costs one read.
+class QueryEntryCache : public NonMovableOrCopyable
+{
+  public:
+    // Loads the keys it is passed at the ledger load was called for, or
+    // returns std::nullopt if that ledger isn't available
+    using Loader = std::function<std::optional<std::vector<LedgerEntry>>(
+        LedgerKeySet const&)>;
+
+    QueryEntryCache(size_t maxBytes, medida::MetricsRegistry& metrics);
+
+    // Returns the entries found for keys at ledgerSeq, using loader for
+    // those neither cached nor being loaded by another thread. Ledgers older
+    // than the cached one bypass the cache. Returns std::nullopt if loader
+    // does.
+    std::optional<std::vector<LedgerEntry>>
+    load(LedgerKeySet const& keys, uint32_t ledgerSeq, Loader const& loader);
+
+  private:
+    using EntryPtr = std::shared_ptr<LedgerEntry const>;
+
+    size_t const mMaxBytes;
+
+    std::mutex mMutex;
+    uint32_t mLedgerSeq{0};
+    // Null for keys known not to exist
+    UnorderedMap<LedgerKey, EntryPtr> mEntries;
+    size_t mBytes{0};
+    // Keys being loaded by some thread, ready once that load is done
+    UnorderedMap<LedgerKey, std::shared_future<void>> mInFlight;
+
+    medida::Meter& mHits;
+    medida::Meter& mMisses;
+    medida::Meter& mCoalesced;
+
+    // Drops everything if ledgerSeq is newer than the cached ledger. Returns
+    // false if it is older. Must hold mMutex.
+    bool advanceTo(uint32_t ledgerSeq);
+
+    // Caches the result of loading keys, found being the entries that
+    // exist. Must hold mMutex.
+    void insert(LedgerKeySet const& keys,
+                std::vector<LedgerEntry> const& found);
+};
+}
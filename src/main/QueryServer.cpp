@@ -4,16 +4,23 @@
 
 #include "main/QueryServer.h"
 #include "bucket/BucketSnapshotManager.h"
+#include "bucket/LedgerCmp.h"
 #include "bucket/SearchableBucketList.h"
+#include "crypto/KeyUtils.h"
+#include "crypto/StrKey.h"
 #include "ledger/LedgerTxnImpl.h"
 #include "ledger/LedgerTypeUtils.h"
+#include "medida/metrics_registry.h"
+#include "medida/timer.h"
 #include "util/GlobalChecks.h"
 #include "util/Logging.h"
 #include "util/XDRStream.h" // IWYU pragma: keep
 #include "util/types.h"
 #include "xdr/Stellar-ledger-entries.h"
+#include "xdrpp/marshal.h"
 #include <exception>
 #include <json/json.h>
+#include <limits>
 #include <unordered_map>
 
 using std::placeholders::_1;
@@ -22,6 +29,13 @@ using std::placeholders::_3;
 
 namespace
 {
+// Default and largest number of entries returned by one range or prefix query
+constexpr uint32_t DEFAULT_SCAN_LIMIT = 100;
+constexpr uint32_t MAX_SCAN_LIMIT = 1000;
+
+// Largest number of transactions submitted by one txbatch request
+constexpr size_t MAX_TX_BATCH_SIZE = 1000;
+
 template <typename T>
 std::optional<T>
 parseOptionalParam(std::map<std::string, std::vector<std::string>> const& map,
@@ -59,7 +73,10 @@ namespace stellar
 {
 QueryServer::QueryServer(const std::string& address, unsigned short port,
                          int maxClient, size_t threadPoolSize,
-                         BucketSnapshotManager& bucketSnapshotManager
+                         BucketSnapshotManager& bucketSnapshotManager,
+                         medida::MetricsRegistry& metrics,
+                         size_t entryCacheBytes,
+                         TxBatchSubmitter txBatchSubmitter
 #ifdef BUILD_TESTS
                          ,
                          bool useMainThreadForTesting
@@ -67,6 +84,9 @@ QueryServer::QueryServer(const std::string& address, unsigned short port,
                          )
     : mServer(address, port, maxClient, threadPoolSize)
     , mBucketSnapshotManager(bucketSnapshotManager)
+    , mMetrics(metrics)
+    , mEntryCache(entryCacheBytes, metrics)
+    , mTxBatchSubmitter(std::move(txBatchSubmitter))
 {
     LOG_INFO(DEFAULT_LOG, "Listening on {}:{} for Query requests", address,
              port);
@@ -74,6 +94,13 @@ QueryServer::QueryServer(const std::string& address, unsigned short port,
     mServer.add404(std::bind(&QueryServer::notFound, this, _1, _2, _3));
     addRoute("getledgerentryraw", &QueryServer::getLedgerEntryRaw);
     addRoute("getledgerentry", &QueryServer::getLedgerEntry);
+    addRawRoute("getledgerentryxdr", &QueryServer::getLedgerEntryXDR);
+    addRoute("getledgerentryrange", &QueryServer::getLedgerEntryRange);
+    addRoute("getledgerentryprefix", &QueryServer::getLedgerEntryPrefix);
+    if (mTxBatchSubmitter)
+    {
+        addRoute("txbatch", &QueryServer::submitTxBatch);
+    }
 
 #ifdef BUILD_TESTS
     if (useMainThreadForTesting)
@@ -118,14 +145,42 @@ QueryServer::notFound(std::string const& params, std::string const& body,
 void
 QueryServer::addRoute(std::string const& name, HandlerRoute route)
 {
-    mServer.addRoute(
-        name, std::bind(&QueryServer::safeRouter, this, route, _1, _2, _3));
+    auto& latency = mMetrics.NewTimer({"query", name, "latency"});
+    mServer.addRoute(name, std::bind(&QueryServer::safeRouter, this, route,
+                                     std::ref(latency), _1, _2, _3));
+}
+
+void
+QueryServer::addRawRoute(std::string const& name, HandlerRoute route)
+{
+    auto& latency = mMetrics.NewTimer({"query", name, "latency"});
+    mServer.addRawRoute(name, std::bind(&QueryServer::safeRouter, this, route,
+                                        std::ref(latency), _1, _2, _3));
+}
+
+std::optional<std::vector<LedgerEntry>>
+QueryServer::loadLiveKeys(SearchableLiveBucketListSnapshot const& bl,
+                          LedgerKeySet const& keys, uint32_t ledgerSeq)
+{
+    auto loader = [&](LedgerKeySet const& toLoad) {
+        return bl.loadKeysFromLedger(toLoad, ledgerSeq);
+    };
+
+    // Historical ledgers are rarely hot, and a ledgerSeq newer than bl's
+    // doesn't exist yet, so neither is worth advancing the cache for
+    if (ledgerSeq != bl.getLedgerSeq())
+    {
+        return loader(keys);
+    }
+    return mEntryCache.load(keys, ledgerSeq, loader);
 }
 
 bool
-QueryServer::safeRouter(HandlerRoute route, std::string const& params,
-                        std::string const& body, std::string& retStr)
+QueryServer::safeRouter(HandlerRoute route, medida::Timer& latency,
+                        std::string const& params, std::string const& body,
+                        std::string& retStr)
 {
+    auto timer = latency.TimeScope();
     try
     {
         ZoneNamedN(httpQueryZone, "HTTP query handler", true);
@@ -181,7 +236,7 @@ QueryServer::getLedgerEntryRaw(std::string const& params,
             root["ledgerSeq"] = *snapshotLedger;
 
             auto loadedKeysOp =
-                bl.loadKeysFromLedger(orderedKeys, *snapshotLedger);
+                loadLiveKeys(bl, orderedKeys, *snapshotLedger);
 
             // Return 404 if ledgerSeq not found
             if (!loadedKeysOp)
@@ -195,7 +250,8 @@ QueryServer::getLedgerEntryRaw(std::string const& params,
         // Otherwise default to current ledger
         else
         {
-            loadedKeys = bl.loadKeys(orderedKeys, "query");
+            loadedKeys =
+                loadLiveKeys(bl, orderedKeys, bl.getLedgerSeq()).value();
             root["ledgerSeq"] = bl.getLedgerSeq();
         }
 
@@ -225,38 +281,20 @@ QueryServer::getLedgerEntryRaw(std::string const& params,
 //    Archive
 // 3. Load TTL keys for any live Soroban entries found in 1.
 bool
-QueryServer::getLedgerEntry(std::string const& params, std::string const& body,
-                            std::string& retStr)
+QueryServer::lookupLedgerEntries(std::vector<LedgerKey> const& keys,
+                                 std::optional<uint32_t> snapshotLedger,
+                                 uint32_t& ledgerSeq,
+                                 std::vector<EntryLookup>& results,
+                                 std::string& retStr)
 {
     ZoneScoped;
-    Json::Value root;
-
-    std::map<std::string, std::vector<std::string>> paramMap;
-    httpThreaded::server::server::parsePostParams(body, paramMap);
-
-    auto const keys = paramMap["key"];
-    auto snapshotLedger = parseOptionalParam<uint32_t>(paramMap, "ledgerSeq");
-
-    if (keys.empty())
-    {
-        retStr = "Must specify key in POST body: key=<LedgerKey in base64 "
-                 "XDR format>\n";
-        return false;
-    }
-
     auto& liveBl = mBucketListSnapshots.at(std::this_thread::get_id());
     auto& hotArchiveBl =
         mHotArchiveBucketListSnapshots.at(std::this_thread::get_id());
 
     LedgerKeySet keysToSearch;
-
-    // Keep track of keys in their original order for response ordering
-    std::vector<LedgerKey> inputOrderedKeys;
-
-    for (auto const& key : keys)
+    for (auto const& k : keys)
     {
-        LedgerKey k;
-        fromOpaqueBase64(k, key);
         if (k.type() == TTL)
         {
             retStr = "TTL keys are not allowed\n";
@@ -269,8 +307,6 @@ QueryServer::getLedgerEntry(std::string const& params, std::string const& body,
             retStr = "Duplicate keys\n";
             return false;
         }
-
-        inputOrderedKeys.push_back(k);
     }
 
     mBucketSnapshotManager.maybeCopyLiveAndHotArchiveSnapshots(liveBl,
@@ -278,11 +314,9 @@ QueryServer::getLedgerEntry(std::string const& params, std::string const& body,
 
     std::vector<LedgerEntry> liveEntries;
     std::vector<HotArchiveBucketEntry> archivedEntries;
-    uint32_t ledgerSeq =
-        snapshotLedger ? *snapshotLedger : liveBl->getLedgerSeq();
-    root["ledgerSeq"] = ledgerSeq;
+    ledgerSeq = snapshotLedger ? *snapshotLedger : liveBl->getLedgerSeq();
 
-    auto liveEntriesOp = liveBl->loadKeysFromLedger(keysToSearch, ledgerSeq);
+    auto liveEntriesOp = loadLiveKeys(*liveBl, keysToSearch, ledgerSeq);
 
     // Return 404 if ledgerSeq not found
     if (!liveEntriesOp)
@@ -337,7 +371,7 @@ QueryServer::getLedgerEntry(std::string const& params, std::string const& body,
         // We haven't updated the live snapshot so we know the have a snapshot
         // available for ledgerSeq
         ttlEntries =
-            std::move(liveBl->loadKeysFromLedger(ttlKeys, ledgerSeq).value());
+            std::move(loadLiveKeys(*liveBl, ttlKeys, ledgerSeq).value());
     }
 
     std::unordered_map<LedgerKey, LedgerEntry> ttlMap;
@@ -346,13 +380,13 @@ QueryServer::getLedgerEntry(std::string const& params, std::string const& body,
         ttlMap.emplace(LedgerEntryKey(ttlEntry), ttlEntry);
     }
 
-    // Store key -> formatted response
-    std::unordered_map<LedgerKey, Json::Value> responseEntries;
+    // Store key -> lookup result
+    std::unordered_map<LedgerKey, EntryLookup> found;
 
-    for (auto const& le : liveEntries)
+    for (auto& le : liveEntries)
     {
         LedgerKey lk = LedgerEntryKey(le);
-        Json::Value entry;
+        EntryLookup res;
 
         // Check TTL to set state for Soroban entries
         if (isSorobanEntry(le.data))
@@ -361,70 +395,421 @@ QueryServer::getLedgerEntry(std::string const& params, std::string const& body,
             releaseAssertOrThrow(ttlIter != ttlMap.end());
             if (isLive(ttlIter->second, ledgerSeq))
             {
-                entry["entry"] = toOpaqueBase64(le);
-                entry["state"] = "live";
-                entry["liveUntilLedgerSeq"] =
+                res.state = EntryState::LIVE;
+                res.liveUntilLedgerSeq =
                     ttlIter->second.data.ttl().liveUntilLedgerSeq;
+                res.entry = std::move(le);
             }
             else if (isPersistentEntry(lk))
             {
-                entry["entry"] = toOpaqueBase64(le);
-                entry["state"] = "archived";
-                entry["liveUntilLedgerSeq"] = 0;
+                res.state = EntryState::ARCHIVED;
+                res.liveUntilLedgerSeq = 0;
+                res.entry = std::move(le);
             }
             // Archived temporary entries are considered "not-found"
-            else
-            {
-                entry["state"] = "not-found";
-            }
         }
         else
         {
-            entry["entry"] = toOpaqueBase64(le);
-            entry["state"] = "live";
+            res.state = EntryState::LIVE;
+            res.entry = std::move(le);
         }
 
-        responseEntries[lk] = entry;
+        found.emplace(std::move(lk), std::move(res));
     }
 
-    for (auto const& be : archivedEntries)
+    for (auto& be : archivedEntries)
     {
-        auto const& le = be.archivedEntry();
+        auto& le = be.archivedEntry();
         LedgerKey lk = LedgerEntryKey(le);
 
-        // At this point we've "found" the key and know it's archived, so remove
-        // it from our search set
-        keysToSearch.erase(lk);
+        EntryLookup res;
+        res.state = EntryState::ARCHIVED;
+        // Add placeholder TTL value for archived entries
+        res.liveUntilLedgerSeq = 0;
+        res.entry = std::move(le);
 
-        Json::Value entry;
-        entry["entry"] = toOpaqueBase64(le);
-        entry["state"] = "archived";
+        found.emplace(std::move(lk), std::move(res));
+    }
 
-        // Add placeholder TTL value for archived entries
-        entry["liveUntilLedgerSeq"] = 0;
+    // Any key found in neither BucketList is not-found, which is what a
+    // default EntryLookup says. Results go in the same order as the keys.
+    results.clear();
+    results.reserve(keys.size());
+    for (auto const& key : keys)
+    {
+        auto it = found.find(key);
+        if (it == found.end())
+        {
+            results.emplace_back();
+        }
+        else
+        {
+            results.emplace_back(std::move(it->second));
+        }
+    }
+    return true;
+}
+
+bool
+QueryServer::getLedgerEntry(std::string const& params, std::string const& body,
+                            std::string& retStr)
+{
+    ZoneScoped;
+    Json::Value root;
+
+    std::map<std::string, std::vector<std::string>> paramMap;
+    httpThreaded::server::server::parsePostParams(body, paramMap);
+
+    auto const keys = paramMap["key"];
+    auto snapshotLedger = parseOptionalParam<uint32_t>(paramMap, "ledgerSeq");
+
+    if (keys.empty())
+    {
+        retStr = "Must specify key in POST body: key=<LedgerKey in base64 "
+                 "XDR format>\n";
+        return false;
+    }
 
-        responseEntries[lk] = entry;
+    std::vector<LedgerKey> inputOrderedKeys;
+    inputOrderedKeys.reserve(keys.size());
+    for (auto const& key : keys)
+    {
+        fromOpaqueBase64(inputOrderedKeys.emplace_back(), key);
     }
 
-    // Since we removed entries found in the live BucketList and archived
-    // entries found in the Hot Archive, any remaining keys must be not-found.
-    for (auto const& key : keysToSearch)
+    uint32_t ledgerSeq;
+    std::vector<EntryLookup> results;
+    if (!lookupLedgerEntries(inputOrderedKeys, snapshotLedger, ledgerSeq,
+                             results, retStr))
+    {
+        return false;
+    }
+
+    root["ledgerSeq"] = ledgerSeq;
+    for (auto const& res : results)
     {
         Json::Value entry;
-        entry["state"] = "not-found";
+        if (res.entry)
+        {
+            entry["entry"] = toOpaqueBase64(*res.entry);
+        }
+        switch (res.state)
+        {
+        case EntryState::LIVE:
+            entry["state"] = "live";
+            break;
+        case EntryState::ARCHIVED:
+            entry["state"] = "archived";
+            break;
+        case EntryState::NOT_FOUND:
+            entry["state"] = "not-found";
+            break;
+        }
+        if (res.liveUntilLedgerSeq)
+        {
+            entry["liveUntilLedgerSeq"] = *res.liveUntilLedgerSeq;
+        }
+        root["entries"].append(entry);
+    }
+
+    retStr = Json::FastWriter().write(root);
+    return true;
+}
 
-        responseEntries[key] = entry;
+// The response is, in XDR:
+//
+//   uint32 ledgerSeq;
+//   Result entries<>;
+//
+// where Result is
+//
+//   union Result switch (uint32 state)
+//   {
+//   case 0: // live
+//   case 1: // archived
+//       struct
+//       {
+//           uint32 liveUntilLedgerSeq;
+//           LedgerEntry entry;
+//       } found;
+//   case 2: // not-found
+//       void;
+//   };
+//
+// liveUntilLedgerSeq is 0 for classic and archived entries. This isn't in the
+// protocol XDR, so it is written out by hand here.
+bool
+QueryServer::getLedgerEntryXDR(std::string const& params,
+                               std::string const& body, std::string& retStr)
+{
+    ZoneScoped;
+    std::map<std::string, std::vector<std::string>> paramMap;
+    httpThreaded::server::server::parsePostParams(params, paramMap);
+    auto snapshotLedger = parseOptionalParam<uint32_t>(paramMap, "ledgerSeq");
+
+    // xdr_get wants 4-byte aligned input, which a std::string doesn't promise
+    std::vector<uint8_t> in(body.begin(), body.end());
+    xdr::xvector<LedgerKey> keys;
+    xdr::xdr_from_opaque(in, keys);
+    if (keys.empty())
+    {
+        retStr = "Must specify keys in POST body as an XDR array of "
+                 "LedgerKey\n";
+        return false;
     }
 
-    // Add entries to the response in the same order as the input keys
-    for (auto const& key : inputOrderedKeys)
+    uint32_t ledgerSeq;
+    std::vector<EntryLookup> results;
+    if (!lookupLedgerEntries(keys, snapshotLedger, ledgerSeq, results, retStr))
     {
-        auto it = responseEntries.find(key);
-        releaseAssertOrThrow(it != responseEntries.end());
-        root["entries"].append(it->second);
+        return false;
     }
 
+    size_t size = 8;
+    for (auto const& res : results)
+    {
+        size += 4;
+        if (res.entry)
+        {
+            size += 4 + xdr::xdr_size(*res.entry);
+        }
+    }
+
+    std::vector<uint8_t> out(size);
+    xdr::xdr_put p(out.data(), out.data() + out.size());
+    p(ledgerSeq);
+    p(static_cast<uint32_t>(results.size()));
+    for (auto const& res : results)
+    {
+        p(static_cast<uint32_t>(res.state));
+        if (res.entry)
+        {
+            p(res.liveUntilLedgerSeq.value_or(0));
+            xdr::xdr_argpack_archive(p, *res.entry);
+        }
+    }
+    retStr.assign(out.begin(), out.end());
+    return true;
+}
+
+bool
+QueryServer::scanLedgerEntries(
+    LedgerKey const& start, std::function<bool(LedgerKey const&)> inRange,
+    std::map<std::string, std::vector<std::string>> const& paramMap,
+    std::string& retStr)
+{
+    ZoneScoped;
+    auto snapshotLedger = parseOptionalParam<uint32_t>(paramMap, "ledgerSeq");
+    auto limit = parseOptionalParam<uint32_t>(paramMap, "limit")
+                     .value_or(DEFAULT_SCAN_LIMIT);
+    if (limit == 0 || limit > MAX_SCAN_LIMIT)
+    {
+        retStr = fmt::format(FMT_STRING("limit must be between 1 and {}\n"),
+                             MAX_SCAN_LIMIT);
+        return false;
+    }
+
+    // A page starts after the last key of the previous one
+    std::optional<LedgerKey> cursor;
+    if (auto cursorStr = parseOptionalParam<std::string>(paramMap, "cursor"))
+    {
+        fromOpaqueBase64(cursor.emplace(), *cursorStr);
+    }
+    auto const& from =
+        cursor && LedgerEntryIdCmp{}(start, *cursor) ? *cursor : start;
+
+    auto& snapshotPtr = mBucketListSnapshots.at(std::this_thread::get_id());
+    mBucketSnapshotManager.maybeCopySearchableBucketListSnapshot(snapshotPtr);
+    auto& bl = *snapshotPtr;
+
+    Json::Value root;
+    root["ledgerSeq"] = snapshotLedger ? *snapshotLedger : bl.getLedgerSeq();
+    root["entries"] = Json::arrayValue;
+    std::optional<LedgerKey> last;
+    bool more = false;
+    auto found = bl.scanLiveEntriesInRange(
+        from, inRange, snapshotLedger, [&](LedgerEntry const& le) {
+            auto key = LedgerEntryKey(le);
+            if (cursor && key == *cursor)
+            {
+                return Loop::INCOMPLETE;
+            }
+            if (root["entries"].size() == limit)
+            {
+                more = true;
+                return Loop::COMPLETE;
+            }
+            Json::Value entry;
+            entry["entry"] = toOpaqueBase64(le);
+            root["entries"].append(entry);
+            last = std::move(key);
+            return Loop::INCOMPLETE;
+        });
+
+    // Return 404 if ledgerSeq not found
+    if (!found)
+    {
+        retStr = "Ledger not found\n";
+        return false;
+    }
+
+    if (more)
+    {
+        root["cursor"] = toOpaqueBase64(*last);
+    }
     retStr = Json::FastWriter().write(root);
     return true;
 }
-}
\ No newline at end of file
+
+bool
+QueryServer::getLedgerEntryRange(std::string const& params,
+                                 std::string const& body, std::string& retStr)
+{
+    ZoneScoped;
+    std::map<std::string, std::vector<std::string>> paramMap;
+    httpThreaded::server::server::parsePostParams(body, paramMap);
+
+    auto startStr = parseOptionalParam<std::string>(paramMap, "start");
+    if (!startStr)
+    {
+        retStr = "Must specify start in POST body: start=<LedgerKey in base64 "
+                 "XDR format>\n";
+        return false;
+    }
+    LedgerKey start;
+    fromOpaqueBase64(start, *startStr);
+
+    std::optional<LedgerKey> end;
+    if (auto endStr = parseOptionalParam<std::string>(paramMap, "end"))
+    {
+        fromOpaqueBase64(end.emplace(), *endStr);
+    }
+
+    return scanLedgerEntries(
+        start,
+        [&end](LedgerKey const& k) {
+            return !end || LedgerEntryIdCmp{}(k, *end);
+        },
+        paramMap, retStr);
+}
+
+// The BucketList orders trustlines, offers and data entries by account first
+// and contract data by contract first, so the entries of one owner are
+// contiguous and start at the key with the owner and the smallest value of
+// every other field.
+bool
+QueryServer::getLedgerEntryPrefix(std::string const& params,
+                                  std::string const& body, std::string& retStr)
+{
+    ZoneScoped;
+    std::map<std::string, std::vector<std::string>> paramMap;
+    httpThreaded::server::server::parsePostParams(body, paramMap);
+
+    auto type = parseOptionalParam<std::string>(paramMap, "type");
+    auto owner = parseOptionalParam<std::string>(paramMap, "owner");
+    if (!type || !owner)
+    {
+        retStr = "Must specify type and owner in POST body: "
+                 "type=<trustline|offer|data|contract_data>&owner=<strkey>\n";
+        return false;
+    }
+
+    // Contract data can belong to an account or a contract, everything else
+    // to an account
+    SCAddress address;
+    if (owner->size() && owner->front() == 'C')
+    {
+        uint8_t ver;
+        std::vector<uint8_t> bytes;
+        if (!strKey::fromStrKey(*owner, ver, bytes) ||
+            ver != strKey::STRKEY_CONTRACT ||
+            bytes.size() != address.contractId().size())
+        {
+            retStr = "Invalid owner\n";
+            return false;
+        }
+        address.type(SC_ADDRESS_TYPE_CONTRACT);
+        std::copy(bytes.begin(), bytes.end(), address.contractId().begin());
+    }
+    else
+    {
+        address.type(SC_ADDRESS_TYPE_ACCOUNT);
+        address.accountId() = KeyUtils::fromStrKey<PublicKey>(*owner);
+    }
+
+    LedgerKey start;
+    std::function<bool(LedgerKey const&)> inRange;
+    if (*type == "contract_data")
+    {
+        start.type(CONTRACT_DATA);
+        start.contractData().contract = address;
+        inRange = [address](LedgerKey const& k) {
+            return k.type() == CONTRACT_DATA &&
+                   k.contractData().contract == address;
+        };
+    }
+    else if (address.type() != SC_ADDRESS_TYPE_ACCOUNT)
+    {
+        retStr = "Only contract_data can have a contract owner\n";
+        return false;
+    }
+    else if (*type == "trustline")
+    {
+        start.type(TRUSTLINE);
+        start.trustLine().accountID = address.accountId();
+        inRange = [id = address.accountId()](LedgerKey const& k) {
+            return k.type() == TRUSTLINE && k.trustLine().accountID == id;
+        };
+    }
+    else if (*type == "offer")
+    {
+        start.type(OFFER);
+        start.offer().sellerID = address.accountId();
+        start.offer().offerID = std::numeric_limits<int64_t>::min();
+        inRange = [id = address.accountId()](LedgerKey const& k) {
+            return k.type() == OFFER && k.offer().sellerID == id;
+        };
+    }
+    else if (*type == "data")
+    {
+        start.type(DATA);
+        start.data().accountID = address.accountId();
+        inRange = [id = address.accountId()](LedgerKey const& k) {
+            return k.type() == DATA && k.data().accountID == id;
+        };
+    }
+    else
+    {
+        retStr = "Unsupported type\n";
+        return false;
+    }
+
+    return scanLedgerEntries(start, inRange, paramMap, retStr);
+}
+
+bool
+QueryServer::submitTxBatch(std::string const& params, std::string const& body,
+                           std::string& retStr)
+{
+    ZoneScoped;
+    std::map<std::string, std::vector<std::string>> paramMap;
+    httpThreaded::server::server::parsePostParams(body, paramMap);
+
+    auto const& blobs = paramMap["blob"];
+    if (blobs.empty())
+    {
+        throw std::invalid_argument(
+            "Must specify tx blobs in POST body: blob=<tx in base64 XDR "
+            "format>");
+    }
+    if (blobs.size() > MAX_TX_BATCH_SIZE)
+    {
+        retStr = fmt::format(FMT_STRING("At most {} transactions per batch\n"),
+                             MAX_TX_BATCH_SIZE);
+        return false;
+    }
+
+    mTxBatchSubmitter(blobs, retStr);
+    return true;
+}
+}
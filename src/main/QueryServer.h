@@ -7,11 +7,22 @@
 #include "lib/httpthreaded/server.hpp"
 
 #include "bucket/BucketSnapshotManager.h"
+#include "main/QueryEntryCache.h"
+#include "xdr/Stellar-ledger-entries.h"
 #include <functional>
+#include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <thread>
 #include <unordered_map>
+#include <vector>
+
+namespace medida
+{
+class MetricsRegistry;
+class Timer;
+}
 
 namespace stellar
 {
@@ -20,6 +31,11 @@ class BucketSnapshotManager;
 
 class QueryServer
 {
+  public:
+    // Submits base64 transaction envelopes and writes the response
+    using TxBatchSubmitter = std::function<void(
+        std::vector<std::string> const& blobs, std::string& retStr)>;
+
   private:
     using HandlerRoute = std::function<bool(QueryServer*, std::string const&,
                                             std::string const&, std::string&)>;
@@ -34,13 +50,63 @@ class QueryServer
 
     BucketSnapshotManager& mBucketSnapshotManager;
 
-    bool safeRouter(HandlerRoute route, std::string const& params,
-                    std::string const& body, std::string& retStr);
+    medida::MetricsRegistry& mMetrics;
+
+    QueryEntryCache mEntryCache;
+
+    TxBatchSubmitter mTxBatchSubmitter;
+
+    // Loads keys from the live BucketList at ledgerSeq, going through
+    // mEntryCache when that is the newest ledger bl has
+    std::optional<std::vector<LedgerEntry>>
+    loadLiveKeys(SearchableLiveBucketListSnapshot const& bl,
+                 LedgerKeySet const& keys, uint32_t ledgerSeq);
+
+    // Times `route` in `latency`, turning exceptions into errors
+    bool safeRouter(HandlerRoute route, medida::Timer& latency,
+                    std::string const& params, std::string const& body,
+                    std::string& retStr);
 
     bool notFound(std::string const& params, std::string const& body,
                   std::string& retStr);
 
     void addRoute(std::string const& name, HandlerRoute route);
+    void addRawRoute(std::string const& name, HandlerRoute route);
+
+    // State of a key queried by getLedgerEntry. The values are the ones
+    // getLedgerEntryXDR sends.
+    enum class EntryState : uint32_t
+    {
+        LIVE = 0,
+        ARCHIVED = 1,
+        NOT_FOUND = 2
+    };
+
+    struct EntryLookup
+    {
+        EntryState state{EntryState::NOT_FOUND};
+        // Only set for Soroban entries, 0 when archived
+        std::optional<uint32_t> liveUntilLedgerSeq;
+        // Set unless NOT_FOUND
+        std::optional<LedgerEntry> entry;
+    };
+
+    // Looks up `keys` at `snapshotLedger`, or the current ledger if unset, as
+    // described for getLedgerEntry. On success sets `ledgerSeq` and fills
+    // `results` in the order of `keys`; otherwise sets `retStr` to the error.
+    bool lookupLedgerEntries(std::vector<LedgerKey> const& keys,
+                             std::optional<uint32_t> snapshotLedger,
+                             uint32_t& ledgerSeq,
+                             std::vector<EntryLookup>& results,
+                             std::string& retStr);
+
+    // Shared by getLedgerEntryRange and getLedgerEntryPrefix: scans the live
+    // BucketList from start while inRange holds, honoring the cursor, limit
+    // and ledgerSeq parameters.
+    bool scanLedgerEntries(
+        LedgerKey const& start, std::function<bool(LedgerKey const&)> inRange,
+        std::map<std::string, std::vector<std::string>> const& paramMap,
+        std::string& retStr);
 
 #ifdef BUILD_TESTS
   public:
@@ -53,10 +119,33 @@ class QueryServer
     bool getLedgerEntry(std::string const& params, std::string const& body,
                         std::string& retStr);
 
+    // Same as getLedgerEntry, but the body is an XDR array of LedgerKeys and
+    // the response is XDR as well, with no base64 or JSON in between.
+    bool getLedgerEntryXDR(std::string const& params, std::string const& body,
+                           std::string& retStr);
+
+    // Returns the live entries with keys in a range of the key order used by
+    // the BucketList, a page at a time.
+    bool getLedgerEntryRange(std::string const& params,
+                             std::string const& body, std::string& retStr);
+
+    // Returns the live entries of one type owned by an account or contract,
+    // such as an account's trustlines or a contract's data, a page at a time.
+    bool getLedgerEntryPrefix(std::string const& params,
+                              std::string const& body, std::string& retStr);
+
+    // Submits many transactions in one request, see
+    // CommandHandler::submitTxBatch. Only available when the QueryServer was
+    // given a TxBatchSubmitter.
+    bool submitTxBatch(std::string const& params, std::string const& body,
+                       std::string& retStr);
+
   public:
     QueryServer(const std::string& address, unsigned short port, int maxClient,
                 size_t threadPoolSize,
-                BucketSnapshotManager& bucketSnapshotManager
+                BucketSnapshotManager& bucketSnapshotManager,
+                medida::MetricsRegistry& metrics, size_t entryCacheBytes,
+                TxBatchSubmitter txBatchSubmitter
 #ifdef BUILD_TESTS
                 ,
                 bool useMainThreadForTesting = false
@@ -0,0 +1,82 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "main/StartupProfiler.h"
+#include "util/Logging.h"
+#include <json/json.h>
+
+namespace stellar
+{
+
+namespace
+{
+Json::Int64
+toMillis(StartupProfiler::Clock::duration d)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
+}
+}
+
+StartupProfiler::StartupProfiler() : mStart(Clock::now())
+{
+}
+
+StartupProfiler::Phase::Phase(StartupProfiler& profiler, std::string name)
+    : mProfiler(profiler), mName(std::move(name)), mStart(Clock::now())
+{
+}
+
+StartupProfiler::Phase::~Phase()
+{
+    mProfiler.record(std::move(mName), mStart, Clock::now());
+}
+
+void
+StartupProfiler::record(std::string name, Clock::time_point start,
+                        Clock::time_point end)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mTotal)
+    {
+        return;
+    }
+    LOG_INFO(DEFAULT_LOG, "Startup phase '{}' took {} ms", name,
+             toMillis(end - start));
+    mPhases.emplace_back(PhaseRecord{std::move(name), start, end - start});
+}
+
+void
+StartupProfiler::finish()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mTotal)
+    {
+        mTotal = Clock::now() - mStart;
+        LOG_INFO(DEFAULT_LOG, "Startup took {} ms", toMillis(*mTotal));
+    }
+}
+
+Json::Value
+StartupProfiler::getJson() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    Json::Value res;
+    res["complete"] = mTotal.has_value();
+    if (mTotal)
+    {
+        res["total_ms"] = toMillis(*mTotal);
+    }
+    auto& phases = res["phases"];
+    phases = Json::arrayValue;
+    for (auto const& p : mPhases)
+    {
+        Json::Value phase;
+        phase["name"] = p.mName;
+        phase["start_ms"] = toMillis(p.mStart - mStart);
+        phase["duration_ms"] = toMillis(p.mDuration);
+        phases.append(phase);
+    }
+    return res;
+}
+}
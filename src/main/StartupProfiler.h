@@ -0,0 +1,73 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/NonCopyable.h"
+
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Json
+{
+class Value;
+}
+
+namespace stellar
+{
+
+// Records how long each phase of application startup takes, for the
+// `startup` section of the `info` HTTP command. Phases may overlap and may
+// be recorded from any thread. Phases that end after finish() are dropped,
+// so work shared with normal operation (e.g. catchup indexing buckets)
+// doesn't show up as startup.
+class StartupProfiler : public NonMovableOrCopyable
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    StartupProfiler();
+
+    // Records the time between its construction and destruction as a phase
+    // named name
+    class Phase : public NonMovableOrCopyable
+    {
+        StartupProfiler& mProfiler;
+        std::string mName;
+        Clock::time_point const mStart;
+
+      public:
+        Phase(StartupProfiler& profiler, std::string name);
+        ~Phase();
+    };
+
+    // For phases that don't fit in a scope, such as asynchronous work
+    void record(std::string name, Clock::time_point start,
+                Clock::time_point end);
+
+    // Marks startup as done
+    void finish();
+
+    // Returns the phases recorded so far in the order they ended, with start
+    // times relative to the start of startup, and the total startup time
+    // once finished
+    Json::Value getJson() const;
+
+  private:
+    struct PhaseRecord
+    {
+        std::string mName;
+        Clock::time_point mStart;
+        Clock::duration mDuration;
+    };
+
+    mutable std::mutex mMutex;
+    Clock::time_point const mStart;
+    std::optional<Clock::duration> mTotal;
+    std::vector<PhaseRecord> mPhases;
+};
+}
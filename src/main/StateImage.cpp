@@ -0,0 +1,276 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "main/StateImage.h"
+#include "bucket/BucketManager.h"
+#include "crypto/Hex.h"
+#include "crypto/SHA.h"
+#include "database/Database.h"
+#include "history/HistoryArchive.h"
+#include "ledger/LedgerHeaderUtils.h"
+#include "ledger/LedgerManager.h"
+#include "main/Application.h"
+#include "main/Config.h"
+#include "main/PersistentState.h"
+#include "util/BufferedFileReader.h"
+#include "util/Decoder.h"
+#include "util/Fs.h"
+#include "util/GlobalChecks.h"
+#include "util/Logging.h"
+#include "util/Timer.h"
+#include "util/types.h"
+#include <Tracy.hpp>
+#include <fmt/format.h>
+#include <json/json.h>
+#include <xdrpp/marshal.h>
+
+#include <filesystem>
+#include <fstream>
+#include <future>
+
+namespace stellar
+{
+namespace StateImage
+{
+
+char const* const kDescriptionFile = "state-image.json";
+
+namespace
+{
+namespace stdfs = std::filesystem;
+
+unsigned const STATE_IMAGE_VERSION = 1;
+
+std::string
+bucketBasename(std::string const& hexHash)
+{
+    return "bucket-" + hexHash + ".xdr";
+}
+
+std::string
+indexBasename(std::string const& hexHash)
+{
+    return "bucket-" + hexHash + ".index";
+}
+
+// Hard-links `from` to `to`, or copies it on another filesystem
+void
+linkOrCopy(stdfs::path const& from, stdfs::path const& to)
+{
+    std::error_code ec;
+    stdfs::create_hard_link(from, to, ec);
+    if (ec)
+    {
+        stdfs::copy_file(from, to);
+    }
+}
+
+uint256
+hashFile(std::string const& path)
+{
+    ZoneScoped;
+    BufferedFileReader in(BufferedFileReader::DEFAULT_BUFFER_SIZE,
+                          /*sequential=*/true);
+    in.open(path);
+
+    // Block-compressed buckets are hashed by their original bytes
+    SHA256 hasher;
+    while (auto n = in.ensure(1))
+    {
+        hasher.add(ByteSlice(in.data(), n));
+        in.advance(n);
+    }
+    return hasher.finish();
+}
+
+std::vector<std::string>
+nonEmptyBuckets(HistoryArchiveState const& has)
+{
+    std::vector<std::string> res;
+    for (auto const& hexHash : has.allBuckets())
+    {
+        if (!isZero(hexToBin256(hexHash)))
+        {
+            res.emplace_back(hexHash);
+        }
+    }
+    return res;
+}
+
+struct Description
+{
+    LedgerHeader mHeader;
+    HistoryArchiveState mHAS;
+};
+
+Description
+readDescription(stdfs::path const& dir, Config const& cfg)
+{
+    auto path = dir / kDescriptionFile;
+    std::ifstream in(path);
+    if (!in)
+    {
+        throw std::runtime_error(
+            fmt::format(FMT_STRING("No state image in {}"), dir.string()));
+    }
+    Json::Value root;
+    Json::Reader reader;
+    if (!reader.parse(in, root))
+    {
+        throw std::runtime_error(
+            fmt::format(FMT_STRING("Malformed state image description {}"),
+                        path.string()));
+    }
+    if (root["version"].asUInt() != STATE_IMAGE_VERSION)
+    {
+        throw std::runtime_error(
+            fmt::format(FMT_STRING("Unsupported state image version {}"),
+                        root["version"].asUInt()));
+    }
+    if (root["networkPassphrase"].asString() != cfg.NETWORK_PASSPHRASE)
+    {
+        throw std::runtime_error(
+            "State image is for another network than NETWORK_PASSPHRASE");
+    }
+
+    Description desc;
+    std::vector<uint8_t> headerXdr;
+    decoder::decode_b64(root["ledgerHeader"].asString(), headerXdr);
+    xdr::xdr_from_opaque(headerXdr, desc.mHeader);
+    if (xdrSha256(desc.mHeader) != hexToBin256(root["ledgerHash"].asString()))
+    {
+        throw std::runtime_error("State image ledger header doesn't match its "
+                                 "hash");
+    }
+    desc.mHAS.fromString(root["historyArchiveState"].asString());
+    if (desc.mHAS.currentLedger != desc.mHeader.ledgerSeq ||
+        desc.mHAS.getBucketListHash() != desc.mHeader.bucketListHash)
+    {
+        throw std::runtime_error("State image bucket list doesn't match its "
+                                 "ledger header");
+    }
+    return desc;
+}
+}
+
+void
+write(Application& app, std::string const& dir)
+{
+    ZoneScoped;
+    releaseAssert(threadIsMain());
+    stdfs::path target(dir);
+    if (stdfs::exists(target))
+    {
+        throw std::runtime_error(
+            fmt::format(FMT_STRING("{} already exists"), dir));
+    }
+
+    auto& lm = app.getLedgerManager();
+    auto const& lcl = lm.getLastClosedLedgerHeader();
+    auto has = lm.getLastClosedLedgerHAS();
+    auto& bm = app.getBucketManager();
+    stdfs::path bucketDir(bm.getBucketDir());
+
+    auto tmp = stdfs::path(dir + ".tmp");
+    stdfs::remove_all(tmp);
+    stdfs::create_directories(tmp);
+    for (auto const& hexHash : nonEmptyBuckets(has))
+    {
+        linkOrCopy(bucketDir / bucketBasename(hexHash),
+                   tmp / bucketBasename(hexHash));
+        // Indexes are only present once persisted, the importing node
+        // rebuilds missing ones
+        auto index = bucketDir / indexBasename(hexHash);
+        if (stdfs::exists(index))
+        {
+            linkOrCopy(index, tmp / indexBasename(hexHash));
+        }
+    }
+
+    Json::Value root;
+    root["version"] = STATE_IMAGE_VERSION;
+    root["networkPassphrase"] = app.getConfig().NETWORK_PASSPHRASE;
+    root["ledgerHash"] = binToHex(lcl.hash);
+    root["ledgerHeader"] = decoder::encode_b64(xdr::xdr_to_opaque(lcl.header));
+    root["historyArchiveState"] = has.toString();
+    {
+        std::ofstream out(tmp / kDescriptionFile);
+        out.exceptions(std::ios::failbit | std::ios::badbit);
+        out << root;
+    }
+
+    if (!fs::durableRename(tmp.string(), target.string(),
+                           target.parent_path().string().empty()
+                               ? "."
+                               : target.parent_path().string()))
+    {
+        throw std::runtime_error(
+            fmt::format(FMT_STRING("Failed to rename {} to {}"), tmp.string(),
+                        dir));
+    }
+    CLOG_INFO(History, "Wrote state image of ledger {} to {}",
+              LedgerManager::ledgerAbbrev(lcl), dir);
+}
+
+void
+install(Config cfg, std::string const& dir)
+{
+    ZoneScoped;
+    stdfs::path imageDir(dir);
+    auto desc = readDescription(imageDir, cfg);
+
+    // Single pass over the buckets, hashing them concurrently
+    auto buckets = nonEmptyBuckets(desc.mHAS);
+    std::vector<std::future<uint256>> hashes;
+    for (auto const& hexHash : buckets)
+    {
+        hashes.emplace_back(std::async(
+            std::launch::async, hashFile,
+            (imageDir / bucketBasename(hexHash)).string()));
+    }
+    for (size_t i = 0; i < buckets.size(); ++i)
+    {
+        if (binToHex(hashes[i].get()) != buckets[i])
+        {
+            throw std::runtime_error(fmt::format(
+                FMT_STRING("State image bucket {} doesn't match its hash"),
+                buckets[i]));
+        }
+    }
+    CLOG_INFO(History, "Verified {} buckets of state image of ledger {}",
+              buckets.size(), desc.mHeader.ledgerSeq);
+
+    VirtualClock clock;
+    cfg.setNoListen();
+    // Start from a new database and an empty bucket directory
+    auto app = Application::create(clock, cfg, /* newDB */ true);
+    stdfs::path bucketDir(app->getBucketManager().getBucketDir());
+    for (auto const& hexHash : buckets)
+    {
+        linkOrCopy(imageDir / bucketBasename(hexHash),
+                   bucketDir / bucketBasename(hexHash));
+        auto index = imageDir / indexBasename(hexHash);
+        if (stdfs::exists(index))
+        {
+            linkOrCopy(index, bucketDir / indexBasename(hexHash));
+        }
+    }
+
+    auto& db = app->getDatabase();
+    auto& ps = app->getPersistentState();
+    soci::transaction tx(db.getRawSession());
+    ps.setStates({{PersistentState::kLastClosedLedger,
+                   binToHex(xdrSha256(desc.mHeader))},
+                  {PersistentState::kHistoryArchiveState,
+                   desc.mHAS.toString()}},
+                 db.getSession());
+    LedgerHeaderUtils::storeInDatabase(db, desc.mHeader, db.getSession());
+    ps.setRebuildForOfferTable();
+    tx.commit();
+
+    CLOG_INFO(History, "Installed state image of ledger {}",
+              desc.mHeader.ledgerSeq);
+}
+}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include <string>
+
+namespace stellar
+{
+
+class Application;
+class Config;
+
+// A state image is a copy of the state of a node at its last closed ledger,
+// which a new node can start from instead of assuming the state of a history
+// archive checkpoint and catching up from there: the last closed ledger
+// header, the bucket list state referencing it, and the bucket files with
+// their persisted indexes. Bucket files are immutable, so they are
+// hard-linked into the image when it is on the same filesystem as the bucket
+// directory.
+namespace StateImage
+{
+// Name of the description of the image, in its directory
+extern char const* const kDescriptionFile;
+
+// Writes the image of the last closed ledger of `app` to `dir`, which must
+// not exist. The image is written next to it and renamed into place once
+// complete, so that `dir` only ever holds complete images. Runs on the main
+// thread, where the buckets of the last closed ledger can't be
+// garbage-collected.
+void write(Application& app, std::string const& dir);
+
+// Replaces the database and bucket directory of the node configured by
+// `cfg` with the image in `dir`, after checking that the image is for the
+// network of the node, that its bucket list matches its ledger header and
+// that every bucket file matches its hash. Throws std::runtime_error if any
+// check fails, before anything is replaced. The offer tables are rebuilt
+// from the buckets on the next start of the node, which then loads the
+// indexes of the image instead of rebuilding them.
+void install(Config cfg, std::string const& dir);
+}
+}
@@ -6,20 +6,28 @@
 #include "transactions/SignatureUtils.h"
 #include "transactions/TransactionBridge.h"
 #include "transactions/TransactionUtils.h"
+#include "util/BlockCompressedFile.h"
 #include "util/Decoder.h"
 #include "util/Fs.h"
 #include "util/GlobalChecks.h"
+#include "util/MappedFile.h"
 #include "util/MetaUtils.h"
 #include "util/XDRCereal.h"
+#include "util/XDRJson.h"
 #include "util/XDROperators.h"
 #include "util/XDRStream.h"
 #include "util/types.h"
+#include "util/xdrquery/XDRQuery.h"
 #include "xdr/Stellar-internal.h"
 #include <cereal/archives/json.hpp>
 #include <cereal/cereal.hpp>
+#include <algorithm>
+#include <deque>
 #include <fmt/format.h>
+#include <future>
 #include <iostream>
 #include <regex>
+#include <sstream>
 #include <xdrpp/printer.h>
 
 #if !defined(USE_TERMIOS) && !defined(_WIN32)
@@ -47,62 +55,218 @@ using namespace std::placeholders;
 namespace stellar
 {
 
+namespace
+{
+// Records of a mapped file are split into chunks of about this many bytes,
+// each decoded and printed by one task
+constexpr size_t DUMP_CHUNK_BYTES = 8 * 1024 * 1024;
+
+std::unique_ptr<cereal::JSONOutputArchive>
+makeArrayArchive(std::ostream& out, bool compact)
+{
+    auto archive = std::make_unique<cereal::JSONOutputArchive>(
+        out, compact ? cereal::JSONOutputArchive::Options::NoIndent()
+                     : cereal::JSONOutputArchive::Options::Default());
+    archive->makeArray();
+    return archive;
+}
+
 template <typename T>
 void
-dumpstream(XDRInputFileStream& in, bool compact)
+dumpstream(XDRInputFileStream& in, bool compact,
+           std::optional<std::string> const& filter)
 {
+    std::optional<xdrquery::XDRMatcher> matcher;
+    if (filter)
+    {
+        matcher.emplace(*filter);
+    }
     T tmp;
-    cereal::JSONOutputArchive archive(
-        std::cout, compact ? cereal::JSONOutputArchive::Options::NoIndent()
-                           : cereal::JSONOutputArchive::Options::Default());
-    archive.makeArray();
+    auto archive = makeArrayArchive(std::cout, compact);
     while (in && in.readOne(tmp))
     {
-        archive(tmp);
+        if (!matcher || matcher->matchXDR(tmp))
+        {
+            (*archive)(tmp);
+        }
+    }
+}
+
+// Prints the records in [begin, end) that match filter the way dumpstream
+// does, as the elements of a JSON array but without the brackets around
+// them, so that the output of consecutive chunks can be joined with a comma.
+template <typename T>
+std::string
+dumpChunk(char const* begin, char const* end, bool compact,
+          std::optional<std::string> const& filter)
+{
+    std::optional<xdrquery::XDRMatcher> matcher;
+    if (filter)
+    {
+        matcher.emplace(*filter);
     }
+    std::ostringstream out;
+    {
+        T tmp;
+        auto archive = makeArrayArchive(out, compact);
+        while (begin < end)
+        {
+            auto sz = XDRInputFileStream::getXDRSize(begin);
+            begin += 4;
+            xdr::xdr_get g(begin, begin + sz);
+            xdr::xdr_argpack_archive(g, tmp);
+            begin += sz;
+            if (!matcher || matcher->matchXDR(tmp))
+            {
+                (*archive)(tmp);
+            }
+        }
+    }
+
+    // An empty array is printed as "[]", otherwise the brackets are on their
+    // own lines unless compact
+    auto res = out.str();
+    if (res.size() <= 2)
+    {
+        return {};
+    }
+    size_t bracket = compact ? 1 : 2;
+    return res.substr(bracket, res.size() - 2 * bracket);
 }
 
+// Splits the mapped file at record boundaries and decodes the chunks on up
+// to threads threads at a time, printing them in file order as they finish.
+// Prints exactly what dumpstream would.
+template <typename T>
 void
-dumpXdrStream(std::string const& filename, bool compact)
+dumpMappedFile(MappedFile const& file, bool compact,
+               std::optional<std::string> const& filter, size_t threads)
+{
+    auto const* pos = file.data();
+    auto const* const fileEnd = pos + file.size();
+
+    std::deque<std::future<std::string>> pending;
+    bool first = true;
+    auto printNext = [&]() {
+        auto chunk = pending.front().get();
+        pending.pop_front();
+        if (chunk.empty())
+        {
+            return;
+        }
+        if (!first)
+        {
+            std::cout << (compact ? "," : ",\n");
+        }
+        else if (!compact)
+        {
+            std::cout << "\n";
+        }
+        std::cout << chunk;
+        first = false;
+    };
+
+    std::cout << "[";
+    while (pos < fileEnd)
+    {
+        auto const* chunkBegin = pos;
+        while (pos < fileEnd &&
+               static_cast<size_t>(pos - chunkBegin) < DUMP_CHUNK_BYTES)
+        {
+            if (fileEnd - pos < 4)
+            {
+                throw std::runtime_error("truncated XDR record size");
+            }
+            auto sz = XDRInputFileStream::getXDRSize(pos);
+            if (static_cast<size_t>(fileEnd - pos) - 4 < sz)
+            {
+                throw std::runtime_error("truncated XDR record");
+            }
+            pos += 4 + sz;
+        }
+
+        if (pending.size() >= threads)
+        {
+            printNext();
+        }
+        pending.emplace_back(std::async(std::launch::async, dumpChunk<T>,
+                                        chunkBegin, pos, compact,
+                                        std::cref(filter)));
+    }
+    while (!pending.empty())
+    {
+        printNext();
+    }
+    std::cout << (first || compact ? "]" : "\n]");
+}
+
+template <typename T>
+void
+dumpFile(std::string const& filename, bool compact,
+         std::optional<std::string> const& filter, size_t threads)
+{
+    // Block-compressed buckets are only readable through the stream
+    std::unique_ptr<MappedFile const> mapped;
+    if (!BlockCompressedFile::readTable(filename))
+    {
+        mapped = MappedFile::map(filename, /*sequential=*/true);
+    }
+    if (mapped)
+    {
+        dumpMappedFile<T>(*mapped, compact, filter,
+                          std::max<size_t>(1, threads));
+        return;
+    }
+
+    XDRInputFileStream in;
+    in.open(filename);
+    dumpstream<T>(in, compact, filter);
+}
+}
+
+void
+dumpXdrStream(std::string const& filename, bool compact,
+              std::optional<std::string> const& filter, size_t threads)
 {
     std::regex rx(
         R"(.*\b(debug-tx-set|(?:(ledger|bucket|transactions|results|meta-debug|scp)-.+))\.xdr(?:\.dirty)?$)");
     std::smatch sm;
     if (std::regex_match(filename, sm, rx))
     {
-        XDRInputFileStream in;
-        in.open(filename);
-
         if (sm[1] == "debug-tx-set")
         {
-            dumpstream<StoredDebugTransactionSet>(in, compact);
+            dumpFile<StoredDebugTransactionSet>(filename, compact, filter,
+                                                threads);
         }
         else if (sm.size() == 3)
         {
             auto& m2 = sm[2];
             if (m2 == "ledger")
             {
-                dumpstream<LedgerHeaderHistoryEntry>(in, compact);
+                dumpFile<LedgerHeaderHistoryEntry>(filename, compact, filter,
+                                                   threads);
             }
             else if (m2 == "bucket")
             {
-                dumpstream<BucketEntry>(in, compact);
+                dumpFile<BucketEntry>(filename, compact, filter, threads);
             }
             else if (m2 == "transactions")
             {
-                dumpstream<TransactionHistoryEntry>(in, compact);
+                dumpFile<TransactionHistoryEntry>(filename, compact, filter,
+                                                  threads);
             }
             else if (m2 == "results")
             {
-                dumpstream<TransactionHistoryResultEntry>(in, compact);
+                dumpFile<TransactionHistoryResultEntry>(filename, compact,
+                                                        filter, threads);
             }
             else if (m2 == "meta-debug")
             {
-                dumpstream<LedgerCloseMeta>(in, compact);
+                dumpFile<LedgerCloseMeta>(filename, compact, filter, threads);
             }
             else if (m2 == "scp")
             {
-                dumpstream<SCPHistoryEntry>(in, compact);
+                dumpFile<SCPHistoryEntry>(filename, compact, filter, threads);
             }
             else
             {
@@ -182,7 +346,7 @@ printOneXdr(xdr::opaque_vec<> const& o, std::string const& desc, bool compact)
 {
     T tmp;
     xdr::xdr_from_opaque(o, tmp);
-    std::cout << xdrToCerealString(tmp, desc, compact) << std::endl;
+    std::cout << xdrToJson(tmp, desc, compact) << std::endl;
 }
 
 void
@@ -191,8 +355,7 @@ printTransactionMeta(xdr::opaque_vec<> const& o, bool compact)
     TransactionMeta tmp;
     xdr::xdr_from_opaque(o, tmp);
     normalizeMeta(tmp);
-    std::cout << xdrToCerealString(tmp, "TransactionMeta", compact)
-              << std::endl;
+    std::cout << xdrToJson(tmp, "TransactionMeta", compact) << std::endl;
 }
 
 void
@@ -6,11 +6,16 @@
 
 #include "overlay/StellarXDR.h"
 #include <functional>
+#include <optional>
 #include <vector>
 
 namespace stellar
 {
-void dumpXdrStream(std::string const& filename, bool json);
+// Prints the records of an XDR stream file as a JSON array, keeping only
+// those matching filter if given. Files that can be memory-mapped are decoded
+// on up to threads threads.
+void dumpXdrStream(std::string const& filename, bool compact,
+                   std::optional<std::string> const& filter, size_t threads);
 void printXdr(std::string const& filename, std::string const& filetype,
               bool base64, bool compact, bool rawMode);
 void signtxns(std::vector<TransactionEnvelope>& txenvs, std::string netId,
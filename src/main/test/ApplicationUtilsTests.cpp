@@ -2,6 +2,10 @@
 // under the Apache License, Version 2.0. See the COPYING file at the root
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
+#include "bucket/BucketManager.h"
+#include "bucket/LiveBucketList.h"
+#include "crypto/Hex.h"
+#include "crypto/Random.h"
 #include "history/HistoryArchiveManager.h"
 #include "history/HistoryManagerImpl.h"
 #include "history/test/HistoryTestsUtils.h"
@@ -11,13 +15,18 @@
 #include "main/ApplicationUtils.h"
 #include "main/CommandHandler.h"
 #include "main/Config.h"
+#include "main/StartupProfiler.h"
+#include "main/StateImage.h"
 #include "simulation/Simulation.h"
 #include "test/Catch2.h"
 #include "test/TestUtils.h"
+#include "test/TxTests.h"
 #include "test/test.h"
 #include "transactions/TransactionUtils.h"
+#include "util/TmpDir.h"
 #include <filesystem>
 #include <fstream>
+#include <set>
 
 using namespace stellar;
 using namespace stellar::historytestutils;
@@ -123,6 +132,10 @@ TEST_CASE("offline self-check works", "[applicationutils][selfcheck]")
     // Step 3: run offline self-check on that application's state, see that it's
     // agreeable.
     REQUIRE(selfCheck(chkConfig) == 0);
+    // Progress is only kept for interrupted or failed runs
+    REQUIRE(!fs::exists((std::filesystem::path(chkConfig.BUCKET_DIR_PATH) /
+                         "self-check-progress.json")
+                            .string()));
 
     std::filesystem::path archPath =
         catchupSimulation.getHistoryConfigurator().getArchiveDirName();
@@ -170,6 +183,99 @@ TEST_CASE("application major version numbers", "[applicationutils]")
           std::nullopt);
 }
 
+TEST_CASE("startup phases are reported in info", "[applicationutils]")
+{
+    VirtualClock clock;
+    auto app = createTestApplication(clock, getTestConfig());
+
+    auto startup = app->getJsonInfo(false)["info"]["startup"];
+    REQUIRE(startup["complete"].asBool());
+    REQUIRE(startup["total_ms"].asInt64() >= 0);
+
+    std::set<std::string> names;
+    for (auto const& phase : startup["phases"])
+    {
+        names.emplace(phase["name"].asString());
+        REQUIRE(phase["start_ms"].asInt64() >= 0);
+        REQUIRE(phase["start_ms"].asInt64() <= startup["total_ms"].asInt64());
+    }
+    for (auto name : {"initialize", "load-lcl", "index-buckets",
+                      "assume-state", "soroban-state", "start-services"})
+    {
+        REQUIRE(names.count(name) == 1);
+    }
+
+    // Phases ending after startup are dropped
+    auto count = startup["phases"].size();
+    {
+        StartupProfiler::Phase phase(app->getStartupProfiler(), "late");
+    }
+    REQUIRE(app->getJsonInfo(false)["info"]["startup"]["phases"].size() ==
+            count);
+}
+
+TEST_CASE("state image", "[applicationutils]")
+{
+    TmpDirManager tdm("state-image-" + binToHex(randomBytes(8)));
+    auto tmp = tdm.tmpDir("image");
+    auto imageDir = tmp.getName() + "/image";
+    Config cfg1 = getTestConfig(1, Config::TESTDB_BUCKET_DB_PERSISTENT);
+    Config cfg2 = getTestConfig(2, Config::TESTDB_BUCKET_DB_PERSISTENT);
+
+    LedgerHeaderHistoryEntry lcl;
+    {
+        VirtualClock clock;
+        auto app = createTestApplication(clock, cfg1);
+        for (int i = 0; i < 10; ++i)
+        {
+            txtest::closeLedger(*app);
+        }
+        StateImage::write(*app, imageDir);
+        REQUIRE_THROWS_AS(StateImage::write(*app, imageDir),
+                          std::runtime_error);
+        lcl = app->getLedgerManager().getLastClosedLedgerHeader();
+    }
+
+    SECTION("installed image starts at its ledger")
+    {
+        StateImage::install(cfg2, imageDir);
+        VirtualClock clock;
+        auto app = createTestApplication(clock, cfg2, false);
+        auto const& installed =
+            app->getLedgerManager().getLastClosedLedgerHeader();
+        REQUIRE(installed.hash == lcl.hash);
+        REQUIRE(app->getBucketManager().getLiveBucketList().getHash() ==
+                lcl.header.bucketListHash);
+    }
+
+    SECTION("corrupt bucket is rejected")
+    {
+        std::filesystem::path victim;
+        for (auto const& entry : std::filesystem::directory_iterator(imageDir))
+        {
+            if (entry.path().extension() == ".xdr")
+            {
+                victim = entry.path();
+                break;
+            }
+        }
+        REQUIRE(!victim.empty());
+        {
+            std::ofstream out(victim, std::ios::app | std::ios::binary);
+            out << "garbage";
+        }
+        REQUIRE_THROWS_AS(StateImage::install(cfg2, imageDir),
+                          std::runtime_error);
+    }
+
+    SECTION("image of another network is rejected")
+    {
+        cfg2.NETWORK_PASSPHRASE = "another network";
+        REQUIRE_THROWS_AS(StateImage::install(cfg2, imageDir),
+                          std::runtime_error);
+    }
+}
+
 TEST_CASE("standalone quorum intersection check", "[applicationutils]")
 {
     Config cfg = getTestConfig();
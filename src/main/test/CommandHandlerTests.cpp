@@ -19,9 +19,12 @@
 #include "xdr/Stellar-ledger-entries.h"
 #include "xdr/Stellar-transaction.h"
 #include "xdrpp/marshal.h"
+#include <atomic>
 #include <fmt/format.h>
+#include <json/json.h>
 #include <optional>
 #include <stdexcept>
+#include <thread>
 
 using namespace stellar;
 using namespace stellar::txbridge;
@@ -188,6 +191,38 @@ TEST_CASE_VERSIONS("transaction envelope bridge", "[commandhandler]")
     }
 }
 
+TEST_CASE("txbatch", "[commandhandler]")
+{
+    VirtualClock clock;
+    auto app = createTestApplication(clock, getTestConfig());
+    auto root = app->getRoot();
+
+    auto tx = root->tx({payment(*root, 1)});
+    auto blob = decoder::encode_b64(xdr::xdr_to_opaque(tx->getEnvelope()));
+
+    // submitTxBatch waits on the main thread, so crank it meanwhile
+    std::string retStr;
+    std::atomic<bool> done{false};
+    std::thread submitter([&]() {
+        app->getCommandHandler().submitTxBatch({blob, blob, "garbage"},
+                                               retStr);
+        done = true;
+    });
+    while (!done)
+    {
+        clock.crank(false);
+    }
+    submitter.join();
+
+    Json::Value response;
+    REQUIRE(Json::Reader().parse(retStr, response));
+    auto const& results = response["results"];
+    REQUIRE(results.size() == 3);
+    REQUIRE(results[0]["status"].asString() == "PENDING");
+    REQUIRE(results[1]["status"].asString() == "DUPLICATE");
+    REQUIRE(results[2].isMember("exception"));
+}
+
 TEST_CASE("manualclose", "[commandhandler]")
 {
     auto testManualCloseConfig = [](auto configure, auto issue) {
@@ -573,4 +608,59 @@ TEST_CASE("toggleoverlayonlymode", "[commandhandler]")
         REQUIRE(reader.parse(retStr, root));
         REQUIRE(root["overlay_only_mode"].asBool() == expectedMode);
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("read-only routes render snapshots", "[commandhandler]")
+{
+    VirtualClock clock;
+    auto app = createTestApplication(clock, getTestConfig());
+    auto& ch = app->getCommandHandler();
+
+    auto parse = [](std::string const& retStr) {
+        Json::Value root;
+        REQUIRE(Json::Reader().parse(retStr, root));
+        return root;
+    };
+
+    SECTION("routes answer through manualCmd")
+    {
+        for (auto const& cmd : {"info", "metrics", "metrics?enable=ledger",
+                                "sorobaninfo?format=basic"})
+        {
+            auto root = parse(ch.manualCmd(cmd));
+            REQUIRE(!root.isMember("exception"));
+        }
+        REQUIRE(parse(ch.manualCmd("metrics?enable=ledger"))["metrics"]
+                    .isMember("ledger.ledger.close"));
+    }
+
+    SECTION("renderers use the state they captured")
+    {
+        auto lcl = app->getLedgerManager().getLastClosedLedgerNum();
+        auto renderInfo = ch.info("");
+        std::vector<std::function<void(std::string&)>> renderers = {
+            ch.metrics(""), ch.peers(""), ch.quorum(""), ch.scpInfo(""),
+            ch.sorobanInfo("?format=detailed")};
+
+        closeLedger(*app);
+        REQUIRE(app->getLedgerManager().getLastClosedLedgerNum() == lcl + 1);
+
+        // Rendering doesn't need the main thread
+        std::string infoStr;
+        std::vector<std::string> retStrs(renderers.size());
+        std::thread t([&]() {
+            renderInfo(infoStr);
+            for (size_t i = 0; i < renderers.size(); ++i)
+            {
+                renderers[i](retStrs[i]);
+            }
+        });
+        t.join();
+
+        REQUIRE(parse(infoStr)["info"]["ledger"]["num"].asUInt() == lcl);
+        for (auto const& retStr : retStrs)
+        {
+            parse(retStr);
+        }
+    }
+}
@@ -4,26 +4,37 @@
 
 #include "bucket/BucketIndexUtils.h"
 #include "bucket/BucketManager.h"
+#include "bucket/LedgerCmp.h"
 #include "bucket/test/BucketTestUtils.h"
+#include "crypto/KeyUtils.h"
+#include "crypto/SecretKey.h"
 #include "ledger/LedgerTxnImpl.h"
 #include "ledger/LedgerTypeUtils.h"
 #include "ledger/test/LedgerTestUtils.h"
 #include "lib/catch.hpp"
 #include "main/Application.h"
 #include "main/Config.h"
+#include "main/QueryEntryCache.h"
 #include "main/QueryServer.h"
+#include "medida/meter.h"
+#include "medida/metrics_registry.h"
 #include "test/TestUtils.h"
 #include "test/test.h"
 #include "util/Math.h"
 #include "util/UnorderedSet.h"
 #include "util/types.h"
 #include "xdr/Stellar-ledger-entries.h"
+#include "xdrpp/marshal.h"
 #include <json/json.h>
 
+#include <algorithm>
 #include <cstdint>
+#include <future>
+#include <map>
 #include <memory>
 #include <optional>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -46,7 +57,10 @@ TEST_CASE("getledgerentry", "[queryserver]")
         "127.0.0.1", 0,
         1, // maxClient
         2, // threadPoolSize
-        app->getBucketManager().getBucketSnapshotManager(), true);
+        app->getBucketManager().getBucketSnapshotManager(), app->getMetrics(),
+        size_t(16) << 20, // entryCacheBytes
+        nullptr,          // txBatchSubmitter
+        true);
 
     std::unordered_map<LedgerKey, LedgerEntry> liveEntryMap;
 
@@ -557,4 +571,389 @@ TEST_CASE("getledgerentry", "[queryserver]")
         testKeyOrder({liveKey, newKey}, true);
         testKeyOrder({newKey, liveKey}, false);
     }
+
+    SECTION("xdr endpoint matches json endpoint")
+    {
+        std::vector<LedgerKey> keysToSearch;
+        UnorderedSet<LedgerKey> generatedKeys;
+        for (auto const& [lk, le] : liveEntryMap)
+        {
+            generatedKeys.insert(lk);
+            keysToSearch.push_back(lk);
+        }
+        for (auto const& [lk, le] : archivedEntryMap)
+        {
+            generatedKeys.insert(lk);
+            keysToSearch.push_back(lk);
+        }
+        for (auto const& key :
+             LedgerTestUtils::generateValidUniqueLedgerKeysWithTypes(
+                 {CONTRACT_CODE, CONTRACT_DATA, ACCOUNT}, 5, generatedKeys))
+        {
+            keysToSearch.push_back(key);
+        }
+
+        std::string jsonStr;
+        REQUIRE(qServer->getLedgerEntry(
+            "", buildRequestBody(std::nullopt, keysToSearch), jsonStr));
+        Json::Value root;
+        Json::Reader reader;
+        REQUIRE(reader.parse(jsonStr, root));
+        auto const& entries = root["entries"];
+
+        xdr::xvector<LedgerKey> xdrKeys(keysToSearch.begin(),
+                                        keysToSearch.end());
+        auto body = xdr::xdr_to_opaque(xdrKeys);
+        std::string xdrStr;
+        REQUIRE(qServer->getLedgerEntryXDR(
+            "", std::string(body.begin(), body.end()), xdrStr));
+
+        std::vector<uint8_t> out(xdrStr.begin(), xdrStr.end());
+        xdr::xdr_get g(out.data(), out.data() + out.size());
+        uint32_t ledgerSeq;
+        uint32_t count;
+        g(ledgerSeq);
+        g(count);
+        REQUIRE(ledgerSeq == root["ledgerSeq"].asUInt());
+        REQUIRE(count == keysToSearch.size());
+        REQUIRE(entries.size() == count);
+
+        std::vector<std::string> const stateNames = {"live", "archived",
+                                                     "not-found"};
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint32_t state;
+            g(state);
+            REQUIRE(state < stateNames.size());
+            REQUIRE(entries[i]["state"].asString() == stateNames[state]);
+            if (stateNames[state] == "not-found")
+            {
+                continue;
+            }
+
+            uint32_t liveUntilLedgerSeq;
+            LedgerEntry le;
+            g(liveUntilLedgerSeq);
+            xdr::xdr_argpack_archive(g, le);
+            REQUIRE(LedgerEntryKey(le) == keysToSearch[i]);
+            REQUIRE(toOpaqueBase64(le) == entries[i]["entry"].asString());
+            auto const& jsonTTL = entries[i]["liveUntilLedgerSeq"];
+            REQUIRE(liveUntilLedgerSeq ==
+                    (jsonTTL.isNull() ? 0 : jsonTTL.asUInt()));
+        }
+        g.done();
+    }
+
+    SECTION("xdr endpoint with ledgerSeq")
+    {
+        xdr::xvector<LedgerKey> keys{liveEntryMap.begin()->first};
+        auto body = xdr::xdr_to_opaque(keys);
+        std::string retStr;
+        auto currentLedger = lm.getLastClosedLedgerNum();
+        REQUIRE(!qServer->getLedgerEntryXDR(
+            "?ledgerSeq=" + std::to_string(currentLedger + 1000),
+            std::string(body.begin(), body.end()), retStr));
+        REQUIRE(retStr == "Ledger not found\n");
+
+        REQUIRE(qServer->getLedgerEntryXDR(
+            "?ledgerSeq=" + std::to_string(currentLedger),
+            std::string(body.begin(), body.end()), retStr));
+        std::vector<uint8_t> out(retStr.begin(), retStr.end());
+        xdr::xdr_get g(out.data(), out.data() + out.size());
+        uint32_t ledgerSeq;
+        g(ledgerSeq);
+        REQUIRE(ledgerSeq == currentLedger);
+    }
+}
+
+TEST_CASE("getledgerentryrange and getledgerentryprefix", "[queryserver]")
+{
+    VirtualClock clock;
+    auto cfg = getTestConfig();
+    cfg.QUERY_SNAPSHOT_LEDGERS = 5;
+
+    auto app = createTestApplication<BucketTestUtils::BucketTestApplication>(
+        clock, cfg);
+    auto& lm = app->getLedgerManager();
+    auto qServer = std::make_unique<QueryServer>(
+        "127.0.0.1", 0,
+        1, // maxClient
+        2, // threadPoolSize
+        app->getBucketManager().getBucketSnapshotManager(), app->getMetrics(),
+        size_t(16) << 20, // entryCacheBytes
+        nullptr,          // txBatchSubmitter
+        true);
+
+    // Half of the trustlines belong to owner. Over a few ledgers, some of
+    // owner's are updated or deleted so that versions of the same key are
+    // spread over several buckets.
+    auto owner = SecretKey::pseudoRandomForTesting().getPublicKey();
+    using EntryMap = std::map<LedgerKey, LedgerEntry, LedgerEntryIdCmp>;
+    EntryMap liveTrustlines;
+    std::map<uint32_t, EntryMap> liveTrustlinesAtLedger;
+    UnorderedSet<LedgerKey> generatedKeys;
+    UnorderedSet<LedgerKey> usedKeys;
+    for (auto i = 0; i < 12; ++i)
+    {
+        auto generated =
+            LedgerTestUtils::generateValidUniqueLedgerEntriesWithTypes(
+                {TRUSTLINE}, 10, generatedKeys);
+        std::vector<LedgerEntry> initEntries;
+        for (size_t j = 0; j < generated.size(); ++j)
+        {
+            auto& le = generated[j];
+            if (j % 2 == 0)
+            {
+                le.data.trustLine().accountID = owner;
+            }
+            auto key = LedgerEntryKey(le);
+            if (!usedKeys.insert(key).second)
+            {
+                continue;
+            }
+            initEntries.emplace_back(le);
+            liveTrustlines[key] = le;
+        }
+
+        std::vector<LedgerEntry> liveEntries;
+        std::vector<LedgerKey> deadEntries;
+        for (auto iter = liveTrustlines.begin(); iter != liveTrustlines.end();)
+        {
+            auto const& key = iter->first;
+            bool isNew = std::any_of(
+                initEntries.begin(), initEntries.end(),
+                [&key](auto const& le) { return LedgerEntryKey(le) == key; });
+            if (isNew || !(key.trustLine().accountID == owner) ||
+                rand_uniform(0, 3) != 0)
+            {
+                ++iter;
+            }
+            else if (rand_flip())
+            {
+                deadEntries.emplace_back(key);
+                iter = liveTrustlines.erase(iter);
+            }
+            else
+            {
+                ++iter->second.data.trustLine().balance;
+                liveEntries.emplace_back(iter->second);
+                ++iter;
+            }
+        }
+
+        lm.setNextLedgerEntryBatchForBucketTesting(initEntries, liveEntries,
+                                                   deadEntries);
+        closeLedger(*app);
+        liveTrustlinesAtLedger[lm.getLastClosedLedgerNum()] = liveTrustlines;
+    }
+
+    // Runs a query a page of `limit` entries at a time and returns everything
+    // it found
+    auto queryAll = [&](auto query, std::string const& body,
+                        std::optional<uint32_t> ledgerSeq, uint32_t limit) {
+        std::vector<std::string> found;
+        std::optional<std::string> cursor;
+        do
+        {
+            auto pageBody = body + "&limit=" + std::to_string(limit);
+            if (ledgerSeq)
+            {
+                pageBody += "&ledgerSeq=" + std::to_string(*ledgerSeq);
+            }
+            if (cursor)
+            {
+                pageBody += "&cursor=" + *cursor;
+            }
+            std::string retStr;
+            REQUIRE((qServer.get()->*query)("", pageBody, retStr));
+
+            Json::Value root;
+            Json::Reader reader;
+            REQUIRE(reader.parse(retStr, root));
+            REQUIRE(root["ledgerSeq"].asUInt() ==
+                    ledgerSeq.value_or(lm.getLastClosedLedgerNum()));
+            REQUIRE(root["entries"].size() <= limit);
+            for (auto const& entry : root["entries"])
+            {
+                found.emplace_back(entry["entry"].asString());
+            }
+            cursor.reset();
+            if (root.isMember("cursor"))
+            {
+                REQUIRE(root["entries"].size() == limit);
+                cursor = root["cursor"].asString();
+            }
+        } while (cursor);
+        return found;
+    };
+
+    auto expectedEntries = [&](EntryMap const& entries, bool ownerOnly) {
+        std::vector<std::string> expected;
+        for (auto const& [key, le] : entries)
+        {
+            if (!ownerOnly || key.trustLine().accountID == owner)
+            {
+                expected.emplace_back(toOpaqueBase64(le));
+            }
+        }
+        return expected;
+    };
+
+    auto prefixBody = "type=trustline&owner=" + KeyUtils::toStrKey(owner);
+
+    SECTION("prefix")
+    {
+        auto expected = expectedEntries(liveTrustlines, true);
+        REQUIRE(!expected.empty());
+        for (uint32_t limit : {1, 3, 1000})
+        {
+            REQUIRE(queryAll(&QueryServer::getLedgerEntryPrefix, prefixBody,
+                             std::nullopt, limit) == expected);
+        }
+    }
+
+    SECTION("range")
+    {
+        // From the smallest possible trustline key to the first offer key
+        auto body = "start=" + toOpaqueBase64(LedgerKey(TRUSTLINE)) +
+                    "&end=" + toOpaqueBase64(LedgerKey(OFFER));
+        REQUIRE(queryAll(&QueryServer::getLedgerEntryRange, body, std::nullopt,
+                         7) == expectedEntries(liveTrustlines, false));
+    }
+
+    SECTION("snapshot")
+    {
+        auto oldLedger = lm.getLastClosedLedgerNum() - 3;
+        REQUIRE(queryAll(&QueryServer::getLedgerEntryPrefix, prefixBody,
+                         oldLedger, 2) ==
+                expectedEntries(liveTrustlinesAtLedger.at(oldLedger), true));
+
+        std::string retStr;
+        REQUIRE(!qServer->getLedgerEntryPrefix(
+            "",
+            prefixBody + "&ledgerSeq=" +
+                std::to_string(lm.getLastClosedLedgerNum() + 1000),
+            retStr));
+        REQUIRE(retStr == "Ledger not found\n");
+    }
+
+    SECTION("errors")
+    {
+        std::string retStr;
+        REQUIRE(!qServer->getLedgerEntryRange("", "limit=5", retStr));
+        REQUIRE(!qServer->getLedgerEntryPrefix("", prefixBody + "&limit=0",
+                                               retStr));
+        REQUIRE(!qServer->getLedgerEntryPrefix(
+            "", "type=account&owner=" + KeyUtils::toStrKey(owner), retStr));
+        REQUIRE(retStr == "Unsupported type\n");
+    }
+}
+
+TEST_CASE("query entry cache", "[queryserver]")
+{
+    medida::MetricsRegistry metrics;
+    auto& hits = metrics.NewMeter({"query", "cache", "hit"}, "key");
+    auto& misses = metrics.NewMeter({"query", "cache", "miss"}, "key");
+    auto& coalesced = metrics.NewMeter({"query", "cache", "coalesced"}, "key");
+
+    // Half of the keys exist
+    auto entries = LedgerTestUtils::generateValidUniqueLedgerEntries(20);
+    std::map<LedgerKey, LedgerEntry, LedgerEntryIdCmp> store;
+    LedgerKeySet keys;
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        keys.emplace(LedgerEntryKey(entries[i]));
+        if (i % 2 == 0)
+        {
+            store.emplace(LedgerEntryKey(entries[i]), entries[i]);
+        }
+    }
+
+    size_t loads = 0;
+    QueryEntryCache::Loader loader = [&](LedgerKeySet const& toLoad) {
+        ++loads;
+        std::vector<LedgerEntry> found;
+        for (auto const& k : toLoad)
+        {
+            if (auto iter = store.find(k); iter != store.end())
+            {
+                found.emplace_back(iter->second);
+            }
+        }
+        return std::make_optional(found);
+    };
+
+    auto check = [&](std::optional<std::vector<LedgerEntry>> const& res) {
+        REQUIRE(res);
+        REQUIRE(res->size() == store.size());
+        for (auto const& le : *res)
+        {
+            REQUIRE(store.at(LedgerEntryKey(le)) == le);
+        }
+    };
+
+    QueryEntryCache cache(size_t(1) << 20, metrics);
+
+    SECTION("repeated lookups hit")
+    {
+        check(cache.load(keys, 10, loader));
+        REQUIRE(misses.count() == keys.size());
+        check(cache.load(keys, 10, loader));
+        REQUIRE(loads == 1);
+        REQUIRE(hits.count() == keys.size());
+    }
+
+    SECTION("newer ledger empties the cache")
+    {
+        check(cache.load(keys, 10, loader));
+        store.begin()->second.lastModifiedLedgerSeq = 11;
+        check(cache.load(keys, 11, loader));
+        REQUIRE(loads == 2);
+    }
+
+    SECTION("older ledger bypasses the cache")
+    {
+        check(cache.load(keys, 10, loader));
+        check(cache.load(keys, 9, loader));
+        check(cache.load(keys, 10, loader));
+        REQUIRE(loads == 2);
+    }
+
+    SECTION("full cache still loads")
+    {
+        QueryEntryCache tiny(1, metrics);
+        check(tiny.load(keys, 10, loader));
+        check(tiny.load(keys, 10, loader));
+        REQUIRE(loads == 2);
+    }
+
+    SECTION("concurrent lookups share a load")
+    {
+        std::promise<void> release;
+        auto released = release.get_future().share();
+        std::promise<void> entered;
+        QueryEntryCache::Loader blocking = [&](LedgerKeySet const& toLoad) {
+            entered.set_value();
+            released.wait();
+            return loader(toLoad);
+        };
+
+        std::optional<std::vector<LedgerEntry>> first;
+        std::thread t([&] { first = cache.load(keys, 10, blocking); });
+        entered.get_future().wait();
+
+        std::optional<std::vector<LedgerEntry>> second;
+        std::thread u([&] { second = cache.load(keys, 10, blocking); });
+        while (coalesced.count() < keys.size())
+        {
+            std::this_thread::yield();
+        }
+        release.set_value();
+        t.join();
+        u.join();
+
+        check(first);
+        check(second);
+        REQUIRE(loads == 1);
+    }
 }
@@ -12,28 +12,100 @@
 #include "overlay/OverlayManager.h"
 #include "util/GlobalChecks.h"
 #include "util/Logging.h"
+#include "util/MemoryAccounting.h"
 #include <Tracy.hpp>
+#include <algorithm>
+#include <bitset>
 #include <fmt/format.h>
+#include <functional>
 
 namespace stellar
 {
-Floodgate::FloodRecord::FloodRecord(uint32_t ledger, Peer::pointer peer)
-    : mLedgerSeq(ledger)
+bool
+Floodgate::PeerSlotSet::insert(uint32_t slot)
+{
+    uint64_t* word = &mLow;
+    if (slot >= 64)
+    {
+        size_t i = slot / 64 - 1;
+        if (i >= mHigh.size())
+        {
+            mHigh.resize(i + 1, 0);
+        }
+        word = &mHigh[i];
+    }
+    uint64_t bit = uint64_t(1) << (slot % 64);
+    bool inserted = (*word & bit) == 0;
+    *word |= bit;
+    return inserted;
+}
+
+bool
+Floodgate::PeerSlotSet::contains(uint32_t slot) const
 {
-    if (peer)
-        mPeersTold.insert(peer->toString());
+    uint64_t word = mLow;
+    if (slot >= 64)
+    {
+        size_t i = slot / 64 - 1;
+        if (i >= mHigh.size())
+        {
+            return false;
+        }
+        word = mHigh[i];
+    }
+    return (word >> (slot % 64)) & 1;
+}
+
+size_t
+Floodgate::PeerSlotSet::size() const
+{
+    size_t res = std::bitset<64>(mLow).count();
+    for (auto word : mHigh)
+    {
+        res += std::bitset<64>(word).count();
+    }
+    return res;
 }
 
 Floodgate::Floodgate(Application& app)
     : mApp(app)
     , mFloodMapSize(
           app.getMetrics().NewCounter({"overlay", "memory", "flood-known"}))
+    , mPeerSlotsSize(
+          app.getMetrics().NewCounter({"overlay", "memory", "flood-peers"}))
     , mSendFromBroadcast(app.getMetrics().NewMeter(
           {"overlay", "flood", "broadcast"}, "message"))
     , mMessagesAdvertised(app.getMetrics().NewMeter(
           {"overlay", "flood", "advertised"}, "message"))
+    , mRecordsEvicted(app.getMetrics().NewMeter(
+          {"overlay", "flood", "record-evicted"}, "record"))
     , mShuttingDown(false)
 {
+    releaseAssert(mApp.getConfig().FLOOD_RECORD_LIMIT > 0);
+}
+
+void
+Floodgate::updateSizeMetrics()
+{
+    mFloodMapSize.set_count(mFloodMap.size());
+    mPeerSlotsSize.set_count(mPeerSlots.size());
+    TracyPlot("overlay.memory.flood-known",
+              static_cast<int64_t>(mFloodMap.size()));
+}
+
+void
+Floodgate::eraseRecords(std::deque<Hash> const& hashes, uint32_t ledgerSeq)
+{
+    for (auto const& h : hashes)
+    {
+        // The record may have been forgotten, and possibly re-created for
+        // another ledger, since the hash was bucketed
+        auto it = mFloodMap.find(h);
+        if (it != mFloodMap.end() && it->second.mLedgerSeq == ledgerSeq)
+        {
+            mFloodMap.erase(it);
+        }
+    }
 }
 
 // remove old flood records
@@ -41,18 +113,99 @@ void
 Floodgate::clearBelow(uint32_t maxLedger)
 {
     ZoneScoped;
-    for (auto it = mFloodMap.cbegin(); it != mFloodMap.cend();)
+    auto end = mRecordsByLedger.lower_bound(maxLedger);
+    for (auto it = mRecordsByLedger.begin(); it != end; ++it)
+    {
+        eraseRecords(it->second, it->first);
+    }
+    mRecordsByLedger.erase(mRecordsByLedger.begin(), end);
+
+    // A slot last added to a record older than maxLedger is not in any
+    // remaining record, so it can be given to another peer
+    for (auto it = mPeerSlots.begin(); it != mPeerSlots.end();)
     {
-        if (it->second->mLedgerSeq < maxLedger)
+        if (mSlotLastLedger[it->second] < maxLedger)
         {
-            it = mFloodMap.erase(it);
+            mFreeSlots.emplace_back(it->second);
+            it = mPeerSlots.erase(it);
         }
         else
         {
             ++it;
         }
     }
-    mFloodMapSize.set_count(mFloodMap.size());
+    // Hand out low slots first, they are stored inline
+    std::sort(mFreeSlots.begin(), mFreeSlots.end(), std::greater<uint32_t>());
+    updateSizeMetrics();
+}
+
+void
+Floodgate::evictOldest()
+{
+    // Drop the oldest records one at a time, so that a burst within the
+    // current ledger only costs the oldest of its own records
+    while (!mRecordsByLedger.empty())
+    {
+        auto oldest = mRecordsByLedger.begin();
+        auto& hashes = oldest->second;
+        while (!hashes.empty())
+        {
+            auto it = mFloodMap.find(hashes.front());
+            bool live =
+                it != mFloodMap.end() && it->second.mLedgerSeq == oldest->first;
+            hashes.pop_front();
+            if (live)
+            {
+                mFloodMap.erase(it);
+                mRecordsEvicted.Mark();
+                return;
+            }
+        }
+        mRecordsByLedger.erase(oldest);
+    }
+}
+
+Floodgate::FloodRecord&
+Floodgate::newRecord(Hash const& msgID)
+{
+    MEMORY_ACCOUNTING_SCOPE(FLOODGATE);
+    while (mFloodMap.size() >= mApp.getConfig().FLOOD_RECORD_LIMIT &&
+           !mRecordsByLedger.empty())
+    {
+        evictOldest();
+    }
+    auto ledgerSeq = mApp.getHerder().trackingConsensusLedgerIndex();
+    mRecordsByLedger[ledgerSeq].emplace_back(msgID);
+    auto& record = mFloodMap[msgID];
+    record.mLedgerSeq = ledgerSeq;
+    updateSizeMetrics();
+    return record;
+}
+
+bool
+Floodgate::addPeer(FloodRecord& record, std::string const& peer)
+{
+    MEMORY_ACCOUNTING_SCOPE(FLOODGATE);
+    auto it = mPeerSlots.find(peer);
+    if (it == mPeerSlots.end())
+    {
+        uint32_t slot;
+        if (mFreeSlots.empty())
+        {
+            slot = static_cast<uint32_t>(mSlotLastLedger.size());
+            mSlotLastLedger.emplace_back(0);
+        }
+        else
+        {
+            slot = mFreeSlots.back();
+            mFreeSlots.pop_back();
+        }
+        it = mPeerSlots.emplace(peer, slot).first;
+        mPeerSlotsSize.set_count(mPeerSlots.size());
+    }
+    auto& lastLedger = mSlotLastLedger[it->second];
+    lastLedger = std::max(lastLedger, record.mLedgerSeq);
+    return record.mPeersTold.insert(it->second);
 }
 
 bool
@@ -66,16 +219,16 @@ Floodgate::addRecord(Peer::pointer peer, Hash const& index)
     auto result = mFloodMap.find(index);
     if (result == mFloodMap.end())
     { // we have never seen this message
-        mFloodMap[index] = std::make_shared<FloodRecord>(
-            mApp.getHerder().trackingConsensusLedgerIndex(), peer);
-        mFloodMapSize.set_count(mFloodMap.size());
-        TracyPlot("overlay.memory.flood-known",
-                  static_cast<int64_t>(mFloodMap.size()));
+        auto& record = newRecord(index);
+        if (peer)
+        {
+            addPeer(record, peer->toString());
+        }
         return true;
     }
     else
     {
-        result->second->mPeersTold.insert(peer->toString());
+        addPeer(result->second, peer->toString());
         return false;
     }
 }
@@ -98,21 +251,11 @@ Floodgate::broadcast(std::shared_ptr<StellarMessage const> msg,
     }
     Hash index = xdrBlake2(*msg);
 
-    FloodRecord::pointer fr;
     auto result = mFloodMap.find(index);
-    if (result == mFloodMap.end())
-    { // no one has sent us this message / start from scratch
-        fr = std::make_shared<FloodRecord>(
-            mApp.getHerder().trackingConsensusLedgerIndex(), Peer::pointer());
-        mFloodMap[index] = fr;
-        mFloodMapSize.set_count(mFloodMap.size());
-    }
-    else
-    {
-        fr = result->second;
-    }
+    // no one has sent us this message / start from scratch
+    auto& record =
+        result == mFloodMap.end() ? newRecord(index) : result->second;
     // send it to people that haven't sent it to us
-    auto& peersTold = fr->mPeersTold;
 
     // make a copy, in case peers gets modified
     auto peers = mApp.getOverlayManager().getAuthenticatedPeers();
@@ -122,7 +265,7 @@ Floodgate::broadcast(std::shared_ptr<StellarMessage const> msg,
     {
         bool pullMode = msg->type() == TRANSACTION;
 
-        if (peersTold.insert(peer.second->toString()).second)
+        if (addPeer(record, peer.second->toString()))
         {
             if (pullMode)
             {
@@ -162,7 +305,7 @@ Floodgate::broadcast(std::shared_ptr<StellarMessage const> msg,
         }
     }
     CLOG_TRACE(Overlay, "broadcast {} told {}", hexAbbrev(index),
-               peersTold.size());
+               record.mPeersTold.size());
     return broadcasted;
 }
 
@@ -173,11 +316,12 @@ Floodgate::getPeersKnows(Hash const& h)
     auto record = mFloodMap.find(h);
     if (record != mFloodMap.end())
     {
-        auto& ids = record->second->mPeersTold;
+        auto& slots = record->second.mPeersTold;
         auto const& peers = mApp.getOverlayManager().getAuthenticatedPeers();
         for (auto& p : peers)
         {
-            if (ids.find(p.second->toString()) != ids.end())
+            auto slot = mPeerSlots.find(p.second->toString());
+            if (slot != mPeerSlots.end() && slots.contains(slot->second))
             {
                 res.insert(p.second);
             }
@@ -191,6 +335,10 @@ Floodgate::shutdown()
 {
     mShuttingDown = true;
     mFloodMap.clear();
+    mRecordsByLedger.clear();
+    mPeerSlots.clear();
+    mSlotLastLedger.clear();
+    mFreeSlots.clear();
 }
 
 void
@@ -5,6 +5,9 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "overlay/Peer.h"
+#include "util/HashOfHash.h"
+#include "util/UnorderedMap.h"
+#include <deque>
 #include <map>
 
 /**
@@ -18,11 +21,20 @@
  * All messages are marked with the ledger sequence number to which they
  * relate, and all flood-management information for a given ledger number
  * is purged from the FloodGate when the ledger closes.
+ *
+ * Records live in a flat hash table. Each peer that ever told us about a
+ * live record gets a small slot number, and a record keeps the peers that
+ * know it as a bitset over those slots. Records are also bucketed by ledger,
+ * so purging a ledger only touches its own records. A slot is recycled once
+ * every record that could mention it is gone. At most FLOOD_RECORD_LIMIT
+ * records are kept; past that the oldest records are evicted first, which
+ * at worst makes us send a message to a peer that already has it.
  */
 
 namespace medida
 {
 class Counter;
+class Meter;
 }
 
 namespace stellar
@@ -32,24 +44,52 @@ struct StellarMessage;
 
 class Floodgate
 {
-    class FloodRecord
+    // Set of peer slots. The first 64 slots are stored inline, which covers
+    // every peer of a typically configured node without allocating.
+    class PeerSlotSet
     {
+        uint64_t mLow{0};
+        std::vector<uint64_t> mHigh;
+
       public:
-        typedef std::shared_ptr<FloodRecord> pointer;
+        // returns true if slot was not in the set yet
+        bool insert(uint32_t slot);
+        bool contains(uint32_t slot) const;
+        size_t size() const;
+    };
 
+    struct FloodRecord
+    {
         uint32_t mLedgerSeq;
-        std::set<std::string> mPeersTold;
-
-        FloodRecord(uint32_t ledger, Peer::pointer peer);
+        PeerSlotSet mPeersTold;
     };
 
-    std::map<Hash, FloodRecord::pointer> mFloodMap;
+    UnorderedFlatMap<Hash, FloodRecord> mFloodMap;
+    // ledger -> hashes of the records created for it, oldest first. May hold
+    // hashes of records that were already forgotten or re-created.
+    std::map<uint32_t, std::deque<Hash>> mRecordsByLedger;
+
+    // peer -> slot, for peers that may be in a live record
+    UnorderedMap<std::string, uint32_t> mPeerSlots;
+    // slot -> highest ledger of a record it was added to
+    std::vector<uint32_t> mSlotLastLedger;
+    std::vector<uint32_t> mFreeSlots;
+
     Application& mApp;
     medida::Counter& mFloodMapSize;
+    medida::Counter& mPeerSlotsSize;
     medida::Meter& mSendFromBroadcast;
     medida::Meter& mMessagesAdvertised;
+    medida::Meter& mRecordsEvicted;
     bool mShuttingDown;
 
+    FloodRecord& newRecord(Hash const& msgID);
+    void evictOldest();
+    void eraseRecords(std::deque<Hash> const& hashes, uint32_t ledgerSeq);
+    // adds the peer to the record, returns true if it was not there yet
+    bool addPeer(FloodRecord& record, std::string const& peer);
+    void updateSizeMetrics();
+
   public:
     Floodgate(Application& app);
     // forget data strictly older than `maxLedger`
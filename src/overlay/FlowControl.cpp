@@ -12,6 +12,8 @@
 #include "overlay/OverlayUtils.h"
 #include "util/Logging.h"
 #include <Tracy.hpp>
+#include <algorithm>
+#include <limits>
 
 namespace stellar
 {
@@ -96,6 +98,87 @@ FlowControl::maybeReleaseCapacity(StellarMessage const& msg)
     }
 }
 
+void
+FlowControl::untrackQueuedMessage(StellarMessage const& msg,
+                                  MutexLocker& lockGuard)
+{
+    switch (msg.type())
+    {
+#ifdef BUILD_TESTS
+    case TX_SET:
+#endif
+    case TRANSACTION:
+    {
+        releaseAssert(OverlayManager::isFloodMessage(msg));
+        size_t s = mFlowControlBytesCapacity.getMsgResourceCount(msg);
+        releaseAssert(mTxQueueByteCount >= s);
+        mTxQueueByteCount -= s;
+    }
+    break;
+    case SCP_MESSAGE:
+        break;
+    case FLOOD_DEMAND:
+    {
+        size_t s = msg.floodDemand().txHashes.size();
+        releaseAssert(mDemandQueueTxHashCount >= s);
+        mDemandQueueTxHashCount -= s;
+    }
+    break;
+    case FLOOD_ADVERT:
+    {
+        size_t s = msg.floodAdvert().txHashes.size();
+        releaseAssert(mAdvertQueueTxHashCount >= s);
+        mAdvertQueueTxHashCount -= s;
+    }
+    break;
+    default:
+    {
+        throw std::runtime_error("Unknown message type in untrackQueuedMessage");
+    }
+    }
+}
+
+bool
+FlowControl::isExpired(QueuedOutboundMessage const& msg,
+                       VirtualClock::time_point now,
+                       MutexLocker& lockGuard) const
+{
+    return mLastClosedLedger >= msg.mLedgerSeq + FLOOD_QUEUE_MAX_LEDGERS ||
+           now - msg.mTimeEmplaced > mMaxFloodQueueAge;
+}
+
+void
+FlowControl::shedExpiredMessages(MutexLocker& lockGuard)
+{
+    ZoneScoped;
+    auto now = mAppConnector.now();
+    size_t expired = 0;
+    for (size_t i = 1; i < mOutboundQueues.size(); ++i)
+    {
+        // Queues are FIFO, so expired messages are all at the front, right
+        // after the ones already handed to the socket
+        auto& queue = mOutboundQueues[i];
+        auto begin = std::find_if(queue.begin(), queue.end(),
+                                  [](auto const& m) { return !m.mBeingSent; });
+        auto end = std::find_if(begin, queue.end(), [&](auto const& m) {
+            return !isExpired(m, now, lockGuard);
+        });
+        for (auto it = begin; it != end; ++it)
+        {
+            untrackQueuedMessage(*it->mMessage, lockGuard);
+        }
+        expired += std::distance(begin, end);
+        queue.erase(begin, end);
+    }
+
+    if (expired)
+    {
+        mOverlayMetrics.mOutboundQueueExpired.Mark(expired);
+        CLOG_TRACE(Overlay, "Shed {} expired flood messages to peer {}",
+                   expired, mAppConnector.getConfig().toShortString(mNodeID));
+    }
+}
+
 void
 FlowControl::processSentMessages(
     FloodQueues<ConstStellarMessagePtr> const& sentMessages)
@@ -117,43 +200,7 @@ FlowControl::processSentMessages(
                 continue;
             }
 
-            auto& front = queue.front();
-            switch (front.mMessage->type())
-            {
-#ifdef BUILD_TESTS
-            case TX_SET:
-#endif
-            case TRANSACTION:
-            {
-                releaseAssert(OverlayManager::isFloodMessage(*front.mMessage));
-                size_t s = mFlowControlBytesCapacity.getMsgResourceCount(
-                    *front.mMessage);
-                releaseAssert(mTxQueueByteCount >= s);
-                mTxQueueByteCount -= s;
-            }
-            break;
-            case SCP_MESSAGE:
-                break;
-            case FLOOD_DEMAND:
-            {
-                size_t s = front.mMessage->floodDemand().txHashes.size();
-                releaseAssert(mDemandQueueTxHashCount >= s);
-                mDemandQueueTxHashCount -= s;
-            }
-            break;
-            case FLOOD_ADVERT:
-            {
-                size_t s = front.mMessage->floodAdvert().txHashes.size();
-                releaseAssert(mAdvertQueueTxHashCount >= s);
-                mAdvertQueueTxHashCount -= s;
-            }
-            break;
-            default:
-            {
-                throw std::runtime_error(
-                    "Unknown message type in processSentMessages");
-            }
-            }
+            untrackQueuedMessage(*queue.front().mMessage, guard);
             queue.pop_front();
         }
     }
@@ -168,11 +215,26 @@ FlowControl::getNextBatchToSend()
     MutexLocker guard(mFlowControlMutex);
     std::vector<QueuedOutboundMessage> batchToSend;
 
-    int sent = 0;
-    for (auto& queue : mOutboundQueues)
-    {
-        for (auto& outboundMsg : queue)
+    // Don't spend peer capacity on messages nobody needs anymore
+    shedExpiredMessages(guard);
+
+    // Position of the next message to look at, and whether the peer ran out
+    // of capacity for the queue
+    std::array<size_t, 4> next{};
+    std::array<bool, 4> blocked{};
+    auto sendFrom = [&](size_t i, size_t maxCount) {
+        auto& queue = mOutboundQueues[i];
+        size_t count = 0;
+        while (count < maxCount && !blocked[i] && next[i] < queue.size())
         {
+            auto& outboundMsg = queue[next[i]];
+            if (outboundMsg.mBeingSent)
+            {
+                // Already sent
+                ++next[i];
+                continue;
+            }
+
             auto const& msg = *(outboundMsg.mMessage);
             // Can't send _current_ message
             if (!hasOutboundCapacity(msg, guard))
@@ -186,18 +248,14 @@ FlowControl::getNextBatchToSend()
                 mNoOutboundCapacity =
                     std::make_optional<VirtualClock::time_point>(
                         mAppConnector.now());
+                blocked[i] = true;
                 break;
             }
 
-            if (outboundMsg.mBeingSent)
-            {
-                // Already sent
-                continue;
-            }
-
             batchToSend.push_back(outboundMsg);
             outboundMsg.mBeingSent = true;
-            ++sent;
+            ++next[i];
+            ++count;
 
             mFlowControlCapacity.lockOutboundCapacity(msg);
             mFlowControlBytesCapacity.lockOutboundCapacity(msg);
@@ -205,7 +263,24 @@ FlowControl::getNextBatchToSend()
             // Do not pop messages here, cleanup after the call to async_write
             // (its write handler invokes processSentMessages)
         }
-    }
+        return count;
+    };
+
+    // SCP goes out ahead of everything else, so that tx floods don't delay
+    // consensus. The flood queues then take turns, each sending up to its
+    // weight per round, so that neither a backlog of transactions nor one of
+    // demands or adverts can starve the others.
+    size_t sent = sendFrom(0, std::numeric_limits<size_t>::max());
+    size_t sentInRound = 0;
+    do
+    {
+        sentInRound = 0;
+        for (size_t i = 1; i < mOutboundQueues.size(); ++i)
+        {
+            sentInRound += sendFrom(i, FLOOD_QUEUE_WEIGHTS[i]);
+        }
+        sent += sentInRound;
+    } while (sentInRound > 0);
 
     CLOG_TRACE(Overlay, "{} Peer {}: send next flood batch of {}",
                mAppConnector.getConfig().toShortString(
@@ -464,7 +539,14 @@ FlowControl::addMsgAndMaybeTrimQueue(std::shared_ptr<StellarMessage const> msg)
     }
     auto& queue = mOutboundQueues[msgQInd];
 
-    queue.emplace_back(QueuedOutboundMessage{msg, mAppConnector.now()});
+    auto& lm = mAppConnector.getLedgerManager();
+    mLastClosedLedger = lm.getLastClosedLedgerNum();
+    mMaxFloodQueueAge =
+        lm.getExpectedLedgerCloseTime() * FLOOD_QUEUE_MAX_LEDGERS;
+
+    queue.emplace_back(
+        QueuedOutboundMessage{msg, mAppConnector.now(), mLastClosedLedger});
+    shedExpiredMessages(guard);
 
     size_t dropped = 0;
 
@@ -9,6 +9,7 @@
 #include "overlay/FlowControlCapacity.h"
 #include "util/ThreadAnnotations.h"
 #include "util/Timer.h"
+#include <array>
 #include <optional>
 
 namespace stellar
@@ -46,6 +47,8 @@ class FlowControl
     {
         ConstStellarMessagePtr mMessage;
         VirtualClock::time_point mTimeEmplaced;
+        // Last closed ledger when the message was queued
+        uint32_t mLedgerSeq{0};
         // Is the message currently being sent (for async write flows)
         bool mBeingSent{false};
     };
@@ -103,6 +106,13 @@ class FlowControl
         mNoOutboundCapacity GUARDED_BY(mFlowControlMutex);
     FlowControlMetrics mMetrics GUARDED_BY(mFlowControlMutex);
 
+    // Deadlines for flood messages, refreshed by the main thread every time a
+    // message is queued, so that the background thread can shed without
+    // touching ledger state
+    uint32_t mLastClosedLedger GUARDED_BY(mFlowControlMutex){0};
+    std::chrono::milliseconds mMaxFloodQueueAge GUARDED_BY(mFlowControlMutex){
+        0};
+
     bool hasOutboundCapacity(StellarMessage const& msg,
                              MutexLocker& lockGuard) const
         REQUIRES(mFlowControlMutex);
@@ -110,8 +120,29 @@ class FlowControl
         REQUIRES(mFlowControlMutex);
     bool canRead(MutexLocker const& lockGuard) const
         REQUIRES(mFlowControlMutex);
+    // Update queue byte and hash counts for a message leaving the queue
+    void untrackQueuedMessage(StellarMessage const& msg,
+                              MutexLocker& lockGuard)
+        REQUIRES(mFlowControlMutex);
+    bool isExpired(QueuedOutboundMessage const& msg,
+                   VirtualClock::time_point now,
+                   MutexLocker& lockGuard) const REQUIRES(mFlowControlMutex);
+    // Drop flood messages that have outlived their deadline from the front of
+    // the transaction, demand and advert queues
+    void shedExpiredMessages(MutexLocker& lockGuard)
+        REQUIRES(mFlowControlMutex);
 
   public:
+    // Flood messages are dropped from outbound queues once they have been
+    // queued for FLOOD_QUEUE_MAX_LEDGERS ledger closes, or for that many
+    // expected ledger close times, whichever comes first. SCP messages are
+    // never shed this way.
+    static constexpr uint32_t FLOOD_QUEUE_MAX_LEDGERS = 2;
+    // Number of messages the transaction, demand and advert queues may
+    // send in each round of the outbound scheduler, indexed by priority. SCP
+    // messages are always sent first.
+    static constexpr std::array<size_t, 4> FLOOD_QUEUE_WEIGHTS = {0, 4, 1, 1};
+
     FlowControl(AppConnector& connector, bool useBackgoundThread);
     virtual ~FlowControl() = default;
 
@@ -50,9 +50,9 @@ Hmac::checkAuthenticatedMessage(AuthenticatedMessage const& msg,
         errorMsg = "receive mac key is zero";
         return false;
     }
-    if (!hmacSha256Verify(
-            msg.v0().mac, mRecvMacKey,
-            xdr::xdr_to_opaque(msg.v0().sequence, msg.v0().message)))
+    if (!hmacSha256Equal(msg.v0().mac,
+                         xdrHmacSha256(mRecvMacKey, msg.v0().sequence,
+                                       msg.v0().message)))
     {
         errorMsg = "unexpected MAC";
         return false;
@@ -73,8 +73,7 @@ Hmac::setAuthenticatedMessageBody(AuthenticatedMessage& aMsg,
     if (msg.type() != HELLO && msg.type() != ERROR_MSG)
     {
         aMsg.v0().sequence = mSendMacSeq;
-        aMsg.v0().mac =
-            hmacSha256(mSendMacKey, xdr::xdr_to_opaque(mSendMacSeq, msg));
+        aMsg.v0().mac = xdrHmacSha256(mSendMacKey, mSendMacSeq, msg);
         mSendMacSeq++;
     }
 }
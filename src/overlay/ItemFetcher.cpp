@@ -14,8 +14,9 @@
 namespace stellar
 {
 
-ItemFetcher::ItemFetcher(Application& app, AskPeer askPeer)
-    : mApp(app), mAskPeer(askPeer)
+ItemFetcher::ItemFetcher(Application& app, AskPeer askPeer,
+                         bool hedgeRequests)
+    : mApp(app), mAskPeer(askPeer), mHedgeRequests(hedgeRequests)
 {
 }
 
@@ -28,7 +29,7 @@ ItemFetcher::fetch(Hash const& itemHash, const SCPEnvelope& envelope)
     if (entryIt == mTrackers.end())
     { // not being tracked
         TrackerPtr tracker =
-            std::make_shared<Tracker>(mApp, itemHash, mAskPeer);
+            std::make_shared<Tracker>(mApp, itemHash, mAskPeer, mHedgeRequests);
         mTrackers[itemHash] = tracker;
 
         tracker->listen(envelope);
@@ -40,9 +40,12 @@ class ItemFetcher : private NonMovableOrCopyable
     using TrackerPtr = std::shared_ptr<Tracker>;
 
     /**
-     * Create ItemFetcher that fetches data using @p askPeer delegate.
+     * Create ItemFetcher that fetches data using @p askPeer delegate. If
+     * @p hedgeRequests is set, trackers ask a second peer when the first one
+     * is slow to reply (@see Tracker).
      */
-    explicit ItemFetcher(Application& app, AskPeer askPeer);
+    explicit ItemFetcher(Application& app, AskPeer askPeer,
+                         bool hedgeRequests = false);
 
     /**
      * Fetch data identified by @p hash and needed by @p envelope. Multiple
@@ -100,5 +103,6 @@ class ItemFetcher : private NonMovableOrCopyable
 
   private:
     AskPeer mAskPeer;
+    bool const mHedgeRequests;
 };
 }
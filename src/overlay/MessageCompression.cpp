@@ -0,0 +1,124 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "overlay/MessageCompression.h"
+#include <Tracy.hpp>
+#include <fmt/format.h>
+
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace stellar
+{
+namespace MessageCompression
+{
+
+namespace
+{
+// Size of the uncompressed size at the start of a compressed frame's body
+size_t const SIZE_PREFIX = 4;
+}
+
+bool
+supported()
+{
+#ifdef USE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool
+isCompressible(MessageType type)
+{
+    switch (type)
+    {
+    case TX_SET:
+    case GENERALIZED_TX_SET:
+    case SCP_MESSAGE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool
+isCompressedFrame(uint8_t const* header)
+{
+    return (header[0] & (COMPRESSED_FRAME_FLAG >> 24)) != 0;
+}
+
+xdr::msg_ptr
+compress(xdr::msg_ptr const& frame)
+{
+    ZoneScoped;
+#ifdef USE_ZLIB
+    auto rawSize = static_cast<uLong>(frame->size());
+    auto len = compressBound(rawSize);
+    auto res = xdr::message_t::alloc(SIZE_PREFIX + len);
+    auto out = reinterpret_cast<Bytef*>(res->data());
+    // The default level gets most of the size reduction of the highest
+    // levels for a fraction of their CPU time, which matters as every
+    // compressed message is compressed on the overlay thread sending it
+    auto err = compress2(out + SIZE_PREFIX, &len,
+                         reinterpret_cast<Bytef const*>(frame->data()),
+                         rawSize, Z_DEFAULT_COMPRESSION);
+    if (err != Z_OK)
+    {
+        throw std::runtime_error(
+            fmt::format(FMT_STRING("Failed to compress message: {}"), err));
+    }
+    if (SIZE_PREFIX + len >= frame->size())
+    {
+        return nullptr;
+    }
+    for (size_t i = 0; i < SIZE_PREFIX; ++i)
+    {
+        out[i] = static_cast<Bytef>(rawSize >> (8 * (SIZE_PREFIX - 1 - i)));
+    }
+    // shrink() rewrites the record mark, flag the frame after it
+    res->shrink(SIZE_PREFIX + len);
+    res->raw_data()[0] |= static_cast<char>(COMPRESSED_FRAME_FLAG >> 24);
+    return res;
+#else
+    throw std::runtime_error("Message compression requires zlib");
+#endif
+}
+
+std::vector<uint8_t>
+decompress(uint8_t const* data, size_t size, size_t maxSize)
+{
+    ZoneScoped;
+#ifdef USE_ZLIB
+    if (size < SIZE_PREFIX)
+    {
+        throw CompressionError("Malformed compressed message");
+    }
+    size_t rawSize = 0;
+    for (size_t i = 0; i < SIZE_PREFIX; ++i)
+    {
+        rawSize = (rawSize << 8) | data[i];
+    }
+    if (rawSize > maxSize)
+    {
+        throw CompressionError(fmt::format(
+            FMT_STRING("Compressed message too large: {}"), rawSize));
+    }
+    std::vector<uint8_t> res(rawSize);
+    auto len = static_cast<uLongf>(rawSize);
+    auto err = uncompress(res.data(), &len, data + SIZE_PREFIX,
+                          static_cast<uLong>(size - SIZE_PREFIX));
+    if (err != Z_OK || len != rawSize)
+    {
+        throw CompressionError("Malformed compressed message");
+    }
+    return res;
+#else
+    throw CompressionError("Message compression requires zlib");
+#endif
+}
+}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "xdr/Stellar-overlay.h"
+#include "xdrpp/message.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stellar
+{
+
+class CompressionError : public std::runtime_error
+{
+  public:
+    CompressionError(std::string const& msg) : std::runtime_error(msg)
+    {
+    }
+};
+
+// Compression of large messages with the peers listed in
+// PEER_MESSAGE_COMPRESSION_KEYS. This is not part of the overlay protocol: a
+// compressed message is an ordinary frame flagged by an otherwise unused bit
+// of its record mark, and only sent to peers configured to accept it. Its
+// body is the uncompressed size, followed by the zlib-compressed XDR of the
+// AuthenticatedMessage, so the MAC is checked on the original message.
+namespace MessageCompression
+{
+// Record mark bit flagging a compressed frame. Frames are never larger than
+// MAX_MESSAGE_SIZE, so it is never part of a length.
+static uint32_t const COMPRESSED_FRAME_FLAG = 0x40000000;
+
+// True if this build can compress and decompress messages
+bool supported();
+
+// Message types that are worth compressing: tx sets, and SCP envelopes,
+// which make up the replies to GET_SCP_STATE
+bool isCompressible(MessageType type);
+
+// True if the frame with the given 4-byte record mark is compressed
+bool isCompressedFrame(uint8_t const* header);
+
+// Returns frame compressed, or nullptr if compressing doesn't make it
+// smaller. Throws if this build can't compress.
+xdr::msg_ptr compress(xdr::msg_ptr const& frame);
+
+// Returns the original body of a compressed frame's body. Throws
+// CompressionError if it is malformed or larger than maxSize.
+std::vector<uint8_t> decompress(uint8_t const* data, size_t size,
+                                size_t maxSize);
+}
+}
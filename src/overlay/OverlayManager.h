@@ -210,13 +210,21 @@ class OverlayManager
     }
 
     // Is message already referenced by the scheduler
-    // This method is always called from one thread, therefore no cache
-    // synchorization is needed
+    // This method may be called from several overlay threads at once
     virtual bool
     checkScheduledAndCache(std::shared_ptr<CapacityTrackedMessage> tracker) = 0;
 
-    // Get a snapshot of ledger state for use by the overlay thread only. Caller
-    // is responsible for updating the snapshot as needed.
+    // Has Herder already accepted the SCP message with hash `msgID`? Copies of
+    // such messages only need floodgate bookkeeping. This method may be called
+    // from several overlay threads at once
+    virtual bool isKnownSCPMessage(Hash const& msgID) = 0;
+
+    // Record that Herder accepted the SCP message with hash `msgID` for
+    // `slotIndex`. Forgotten along with the slot in clearLedgersBelow
+    virtual void rememberSCPMessage(uint64_t slotIndex, Hash const& msgID) = 0;
+
+    // Get a snapshot of ledger state for use by the calling overlay thread
+    // only. Caller is responsible for updating the snapshot as needed.
     virtual SearchableSnapshotConstPtr& getOverlayThreadSnapshot() = 0;
 };
 }
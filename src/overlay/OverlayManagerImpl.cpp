@@ -674,7 +674,8 @@ OverlayManagerImpl::triggerPeerResolution()
 
     mResolvedPeers = task->get_future();
     mApp.postOnBackgroundThread(bind(&task_t::operator(), task),
-                                "OverlayManager: resolve peer IPs");
+                                "OverlayManager: resolve peer IPs",
+                                BackgroundWorkClass::SCP);
 }
 
 std::pair<std::vector<PeerBareAddress>, bool>
@@ -1077,6 +1078,11 @@ void
 OverlayManagerImpl::clearLedgersBelow(uint32_t ledgerSeq, uint32_t lclSeq)
 {
     mFloodGate.clearBelow(ledgerSeq);
+    {
+        MutexLocker guard(mKnownSCPMessagesMutex);
+        mKnownSCPMessages.erase(mKnownSCPMessages.begin(),
+                                mKnownSCPMessages.lower_bound(ledgerSeq));
+    }
     mSurveyManager->clearOldLedgers(lclSeq);
     for (auto const& peer : getAuthenticatedPeers())
     {
@@ -1647,6 +1653,7 @@ OverlayManagerImpl::checkScheduledAndCache(
         return false;
     }
     auto index = tracker->maybeGetHash().value();
+    MutexLocker guard(mScheduledMessagesMutex);
     if (mScheduledMessages.exists(index))
     {
         if (mScheduledMessages.get(index).lock())
@@ -1659,6 +1666,29 @@ OverlayManagerImpl::checkScheduledAndCache(
     return false;
 }
 
+bool
+OverlayManagerImpl::isKnownSCPMessage(Hash const& msgID)
+{
+    MutexLocker guard(mKnownSCPMessagesMutex);
+    return std::any_of(mKnownSCPMessages.begin(), mKnownSCPMessages.end(),
+                       [&](auto const& slot) {
+                           return slot.second.find(msgID) != slot.second.end();
+                       });
+}
+
+void
+OverlayManagerImpl::rememberSCPMessage(uint64_t slotIndex, Hash const& msgID)
+{
+    releaseAssert(threadIsMain());
+    MutexLocker guard(mKnownSCPMessagesMutex);
+    auto& known = mKnownSCPMessages[slotIndex];
+    // Past the cap, further copies simply take the regular path
+    if (known.size() < MAX_KNOWN_SCP_MESSAGES_PER_SLOT)
+    {
+        known.emplace(msgID);
+    }
+}
+
 void
 OverlayManagerImpl::recvTransaction(TransactionFrameBasePtr transaction,
                                     Peer::pointer peer, Hash const& index)
@@ -1783,6 +1813,7 @@ OverlayManagerImpl::shutdown()
     mInboundPeers.shutdown();
     mOutboundPeers.shutdown();
     mTxDemandsManager.shutdown();
+    mPeerManager.flush();
 
     // Switch overlay to "shutting down" state _after_ shutting down peers to
     // allow graceful connection drop
@@ -1884,14 +1915,16 @@ SearchableSnapshotConstPtr&
 OverlayManagerImpl::getOverlayThreadSnapshot()
 {
     releaseAssert(mApp.threadIsType(Application::ThreadType::OVERLAY));
-    if (!mOverlayThreadSnapshot)
+    MutexLocker guard(mOverlayThreadSnapshotsMutex);
+    auto& snapshot = mOverlayThreadSnapshots[std::this_thread::get_id()];
+    if (!snapshot)
     {
         // Create a new snapshot
-        mOverlayThreadSnapshot = mApp.getBucketManager()
-                                     .getBucketSnapshotManager()
-                                     .copySearchableLiveBucketListSnapshot();
+        snapshot = mApp.getBucketManager()
+                       .getBucketSnapshotManager()
+                       .copySearchableLiveBucketListSnapshot();
     }
-    return mOverlayThreadSnapshot;
+    return snapshot;
 }
 
 }
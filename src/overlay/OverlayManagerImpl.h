@@ -19,9 +19,14 @@
 
 #include "medida/metrics_registry.h"
 #include "util/RandomEvictionCache.h"
+#include "util/ThreadAnnotations.h"
+#include "util/UnorderedMap.h"
+#include "util/UnorderedSet.h"
 
 #include <future>
+#include <map>
 #include <set>
+#include <thread>
 #include <vector>
 
 namespace medida
@@ -195,11 +200,23 @@ class OverlayManagerImpl : public OverlayManager
     std::future<ResolvedPeers> mResolvedPeers;
     bool mResolvingPeersWithBackoff;
     int mResolvingPeersRetryCount;
+    // Shared by all overlay threads
+    Mutex mScheduledMessagesMutex;
     RandomEvictionCache<Hash, std::weak_ptr<CapacityTrackedMessage>>
-        mScheduledMessages;
+        mScheduledMessages GUARDED_BY(mScheduledMessagesMutex);
 
-    // Snapshot of ledger state for use ONLY by the overlay thread
-    SearchableSnapshotConstPtr mOverlayThreadSnapshot;
+    // Hashes of SCP messages accepted by Herder, by slot; shared by all overlay
+    // threads
+    static constexpr size_t MAX_KNOWN_SCP_MESSAGES_PER_SLOT = 4096;
+    Mutex mKnownSCPMessagesMutex;
+    std::map<uint64_t, UnorderedSet<Hash>>
+        mKnownSCPMessages GUARDED_BY(mKnownSCPMessagesMutex);
+
+    // Snapshots of ledger state for use ONLY by the overlay threads, one per
+    // thread. Entries are never erased, so references handed out stay valid.
+    Mutex mOverlayThreadSnapshotsMutex;
+    UnorderedMap<std::thread::id, SearchableSnapshotConstPtr>
+        mOverlayThreadSnapshots GUARDED_BY(mOverlayThreadSnapshotsMutex);
 
     void triggerPeerResolution();
     std::pair<std::vector<PeerBareAddress>, bool>
@@ -236,5 +253,7 @@ class OverlayManagerImpl : public OverlayManager
 
     bool checkScheduledAndCache(
         std::shared_ptr<CapacityTrackedMessage> tracker) override;
+    bool isKnownSCPMessage(Hash const& msgID) override;
+    void rememberSCPMessage(uint64_t slotIndex, Hash const& msgID) override;
 };
 }
@@ -1,11 +1,37 @@
 #include "overlay/OverlayMetrics.h"
 #include "main/Application.h"
+#include "util/HdrHistogram.h"
 
 #include "medida/metrics_registry.h"
+#include <algorithm>
+#include <cctype>
 
 namespace stellar
 {
 
+namespace
+{
+// SCP_MESSAGE -> scp-message
+std::string
+metricName(int32_t type)
+{
+    std::string res = xdr::xdr_traits<MessageType>::enum_name(
+        static_cast<MessageType>(type));
+    std::transform(res.begin(), res.end(), res.begin(), [](char c) {
+        return c == '_' ? '-' : static_cast<char>(std::tolower(c));
+    });
+    return res;
+}
+
+HdrTimer&
+getByType(std::vector<HdrTimer*> const& timers, MessageType type,
+          HdrTimer& other)
+{
+    auto i = static_cast<size_t>(type);
+    return i < timers.size() && timers[i] ? *timers[i] : other;
+}
+}
+
 OverlayMetrics::OverlayMetrics(Application& app)
     : mMessageRead(
           app.getMetrics().NewMeter({"overlay", "message", "read"}, "message"))
@@ -17,6 +43,10 @@ OverlayMetrics::OverlayMetrics(Application& app)
           app.getMetrics().NewMeter({"overlay", "async", "read"}, "call"))
     , mAsyncWrite(
           app.getMetrics().NewMeter({"overlay", "async", "write"}, "call"))
+    , mAsyncWriteMessages(app.getMetrics().NewHistogram(
+          {"overlay", "async", "write-messages"}))
+    , mAsyncWriteBuffers(app.getMetrics().NewHistogram(
+          {"overlay", "async", "write-buffers"}))
     , mByteRead(app.getMetrics().NewMeter({"overlay", "byte", "read"}, "byte"))
     , mByteWrite(
           app.getMetrics().NewMeter({"overlay", "byte", "write"}, "byte"))
@@ -34,9 +64,15 @@ OverlayMetrics::OverlayMetrics(Application& app)
           app.getMetrics().NewTimer({"overlay", "connection", "read-throttle"}))
     , mConnectionFloodThrottle(app.getMetrics().NewTimer(
           {"overlay", "connection", "flood-throttle"}))
+    , mHandshakeLatencyTimer(
+          app.getMetrics().NewTimer({"overlay", "handshake", "latency"}))
+    , mHandshakeCryptoTimer(
+          app.getMetrics().NewTimer({"overlay", "handshake", "crypto"}))
 
     , mItemFetcherNextPeer(app.getMetrics().NewMeter(
           {"overlay", "item-fetcher", "next-peer"}, "item-fetcher"))
+    , mItemFetcherHedge(app.getMetrics().NewMeter(
+          {"overlay", "item-fetcher", "hedge"}, "item-fetcher"))
 
     , mRecvErrorTimer(app.getMetrics().NewTimer({"overlay", "recv", "error"}))
     , mRecvHelloTimer(app.getMetrics().NewTimer({"overlay", "recv", "hello"}))
@@ -88,9 +124,9 @@ OverlayMetrics::OverlayMetrics(Application& app)
           app.getMetrics().NewTimer({"overlay", "recv", "tx-batch"}))
 
     , mMessageDelayInWriteQueueTimer(
-          app.getMetrics().NewTimer({"overlay", "delay", "write-queue"}))
+          app.getHdrMetrics().NewTimer({"overlay", "delay", "write-queue"}))
     , mMessageDelayInAsyncWriteTimer(
-          app.getMetrics().NewTimer({"overlay", "delay", "async-write"}))
+          app.getHdrMetrics().NewTimer({"overlay", "delay", "async-write"}))
     , mOutboundQueueDelaySCP(
           app.getMetrics().NewTimer({"overlay", "outbound-queue", "scp"}))
     , mOutboundQueueDelayTxs(
@@ -108,6 +144,8 @@ OverlayMetrics::OverlayMetrics(Application& app)
           {"overlay", "outbound-queue", "drop-advert"}, "message"))
     , mOutboundQueueDropDemand(app.getMetrics().NewMeter(
           {"overlay", "outbound-queue", "drop-demand"}, "message"))
+    , mOutboundQueueExpired(app.getMetrics().NewMeter(
+          {"overlay", "outbound-queue", "expired"}, "message"))
     , mSendErrorMeter(
           app.getMetrics().NewMeter({"overlay", "send", "error"}, "message"))
     , mSendHelloMeter(
@@ -176,12 +214,54 @@ OverlayMetrics::OverlayMetrics(Application& app)
           {"overlay", "flood", "unique-recv"}, "byte"))
     , mDuplicateFloodBytesRecv(app.getMetrics().NewMeter(
           {"overlay", "flood", "duplicate-recv"}, "byte"))
+    , mRecvSCPKnownDuplicate(app.getMetrics().NewMeter(
+          {"overlay", "flood", "known-scp"}, "message"))
+    , mSendCompressedMeter(app.getMetrics().NewMeter(
+          {"overlay", "compressed", "send"}, "message"))
+    , mRecvCompressedMeter(app.getMetrics().NewMeter(
+          {"overlay", "compressed", "recv"}, "message"))
+    , mCompressionSavedBytes(app.getMetrics().NewMeter(
+          {"overlay", "compressed", "saved"}, "byte"))
     , mUniqueFetchBytesRecv(app.getMetrics().NewMeter(
           {"overlay", "fetch", "unique-recv"}, "byte"))
     , mDuplicateFetchBytesRecv(app.getMetrics().NewMeter(
           {"overlay", "fetch", "duplicate-recv"}, "byte"))
     , mTxBatchSizeHistogram(
           app.getMetrics().NewHistogram({"overlay", "flood", "tx-batch-size"}))
+    , mRecvDelayOther(
+          app.getHdrMetrics().NewTimer({"overlay", "recv-delay", "other"}))
+    , mSendDelayOther(
+          app.getHdrMetrics().NewTimer({"overlay", "send-delay", "other"}))
+{
+    for (auto type : xdr::xdr_traits<MessageType>::enum_values())
+    {
+        if (type < 0)
+        {
+            continue;
+        }
+        auto i = static_cast<size_t>(type);
+        if (i >= mRecvDelayByType.size())
+        {
+            mRecvDelayByType.resize(i + 1, nullptr);
+            mSendDelayByType.resize(i + 1, nullptr);
+        }
+        auto name = metricName(type);
+        mRecvDelayByType[i] =
+            &app.getHdrMetrics().NewTimer({"overlay", "recv-delay", name});
+        mSendDelayByType[i] =
+            &app.getHdrMetrics().NewTimer({"overlay", "send-delay", name});
+    }
+}
+
+HdrTimer&
+OverlayMetrics::getRecvDelayTimer(MessageType type)
+{
+    return getByType(mRecvDelayByType, type, mRecvDelayOther);
+}
+
+HdrTimer&
+OverlayMetrics::getSendDelayTimer(MessageType type)
 {
+    return getByType(mSendDelayByType, type, mSendDelayOther);
 }
 }
@@ -7,6 +7,9 @@
 // This structure just exists to cache frequently-accessed, overlay-wide
 // (non-peer-specific) metrics.
 
+#include "xdr/Stellar-overlay.h"
+#include <vector>
+
 namespace medida
 {
 class Timer;
@@ -19,6 +22,7 @@ namespace stellar
 {
 
 class Application;
+class HdrTimer;
 
 // OverlayMetrics is a thread-safe struct
 struct OverlayMetrics
@@ -29,6 +33,8 @@ struct OverlayMetrics
     medida::Meter& mMessageDrop;
     medida::Meter& mAsyncRead;
     medida::Meter& mAsyncWrite;
+    medida::Histogram& mAsyncWriteMessages;
+    medida::Histogram& mAsyncWriteBuffers;
     medida::Meter& mByteRead;
     medida::Meter& mByteWrite;
     medida::Meter& mErrorRead;
@@ -38,8 +44,11 @@ struct OverlayMetrics
     medida::Timer& mConnectionLatencyTimer;
     medida::Timer& mConnectionReadThrottle;
     medida::Timer& mConnectionFloodThrottle;
+    medida::Timer& mHandshakeLatencyTimer;
+    medida::Timer& mHandshakeCryptoTimer;
 
     medida::Meter& mItemFetcherNextPeer;
+    medida::Meter& mItemFetcherHedge;
 
     medida::Timer& mRecvErrorTimer;
     medida::Timer& mRecvHelloTimer;
@@ -81,8 +90,9 @@ struct OverlayMetrics
     medida::Timer& mRecvFloodDemandTimer;
     medida::Timer& mRecvTxBatchTimer;
 
-    medida::Timer& mMessageDelayInWriteQueueTimer;
-    medida::Timer& mMessageDelayInAsyncWriteTimer;
+    // Recorded for every message sent, so lock-free
+    HdrTimer& mMessageDelayInWriteQueueTimer;
+    HdrTimer& mMessageDelayInAsyncWriteTimer;
 
     medida::Timer& mOutboundQueueDelaySCP;
     medida::Timer& mOutboundQueueDelayTxs;
@@ -92,6 +102,7 @@ struct OverlayMetrics
     medida::Meter& mOutboundQueueDropTxs;
     medida::Meter& mOutboundQueueDropAdvert;
     medida::Meter& mOutboundQueueDropDemand;
+    medida::Meter& mOutboundQueueExpired;
 
     medida::Meter& mSendErrorMeter;
     medida::Meter& mSendHelloMeter;
@@ -133,8 +144,27 @@ struct OverlayMetrics
 
     medida::Meter& mUniqueFloodBytesRecv;
     medida::Meter& mDuplicateFloodBytesRecv;
+    medida::Meter& mRecvSCPKnownDuplicate;
+    medida::Meter& mSendCompressedMeter;
+    medida::Meter& mRecvCompressedMeter;
+    medida::Meter& mCompressionSavedBytes;
     medida::Meter& mUniqueFetchBytesRecv;
     medida::Meter& mDuplicateFetchBytesRecv;
     medida::Histogram& mTxBatchSizeHistogram;
+
+    // Time between receiving a message off the wire and starting to process
+    // it on the main thread, which includes background processing and the
+    // wait in the scheduler queue
+    HdrTimer& getRecvDelayTimer(MessageType type);
+    // Time between queueing a message for sending, in flow control if it is
+    // flow-controlled, and its write completing
+    HdrTimer& getSendDelayTimer(MessageType type);
+
+  private:
+    // Indexed by MessageType, null for values that are not message types
+    std::vector<HdrTimer*> mRecvDelayByType;
+    std::vector<HdrTimer*> mSendDelayByType;
+    HdrTimer& mRecvDelayOther;
+    HdrTimer& mSendDelayOther;
 };
 }
@@ -19,6 +19,7 @@
 #include "main/Config.h"
 #include "main/ErrorMessages.h"
 #include "overlay/FlowControl.h"
+#include "overlay/MessageCompression.h"
 #include "overlay/OverlayManager.h"
 #include "overlay/OverlayMetrics.h"
 #include "overlay/PeerAuth.h"
@@ -26,9 +27,12 @@
 #include "overlay/SurveyDataManager.h"
 #include "overlay/SurveyManager.h"
 #include "overlay/TxAdverts.h"
+#include "transactions/EventManager.h"
+#include "transactions/MutableTransactionResult.h"
 #include "transactions/SignatureChecker.h"
 #include "transactions/TransactionBridge.h"
 #include "util/GlobalChecks.h"
+#include "util/HdrHistogram.h"
 #include "util/Logging.h"
 #include "util/ProtocolVersion.h"
 #include "util/finally.h"
@@ -101,6 +105,53 @@ populateSignatureCache(AppConnector& app, TransactionFrameBaseConstPtr tx)
             sourceAccount.current().data.account().thresholds[THRESHOLD_HIGH]);
     }
 }
+
+// Validate classic transaction `tx` against the overlay thread's snapshot of
+// the last closed ledger, the way the transaction queue would, and record the
+// ledger on the frame if it is valid. The queue then skips this validation as
+// long as that ledger is still the last closed one. This function requires
+// that background prevalidation is enabled and the current thread is the
+// overlay thread.
+void
+prevalidateTransaction(AppConnector& app, TransactionFrameBaseConstPtr tx)
+{
+    ZoneScoped;
+    releaseAssert(app.getConfig().EXPERIMENTAL_BACKGROUND_TX_PREVALIDATION &&
+                  app.threadIsType(Application::ThreadType::OVERLAY));
+
+    // Soroban validation needs the network config, which is only available on
+    // the main thread
+    if (tx->isSoroban() || !tx->XDRProvidesValidFee())
+    {
+        return;
+    }
+#ifdef BUILD_TESTS
+    if (app.getConfig().MODE_USES_IN_MEMORY_LEDGER)
+    {
+        return;
+    }
+#endif
+
+    auto& snapshot = app.getOverlayThreadSnapshot();
+    app.maybeCopySearchableBucketListSnapshot(snapshot);
+    LedgerSnapshot ls(snapshot);
+    auto const lclSeq = snapshot->getLedgerSeq();
+    auto const ledgerVersion = ls.getLedgerHeader().current().ledgerVersion;
+    if (protocolVersionStartsFrom(ledgerVersion, ProtocolVersion::V_19))
+    {
+        ls.getLedgerHeader().currentToModify().ledgerSeq = lclSeq + 1;
+    }
+
+    // The queue allows transactions to be valid up to some time after the
+    // last close. That allowance only grows until the next close, so a
+    // transaction valid without it is valid when it reaches the queue.
+    auto diagnosticEvents = DiagnosticEventManager::createDisabled();
+    auto result = tx->checkValid(app, ls, 0, 0, 0, diagnosticEvents);
+    if (result->isSuccess())
+    {
+        tx->setPrevalidatedLedgerSeq(lclSeq);
+    }
+}
 } // namespace
 
 static constexpr VirtualClock::time_point PING_NOT_SENT =
@@ -134,18 +185,20 @@ Peer::Peer(Application& app, PeerRole role)
 }
 
 CapacityTrackedMessage::CapacityTrackedMessage(std::weak_ptr<Peer> peer,
-                                               StellarMessage const& msg)
-    : mWeakPeer(peer), mMsg(msg)
+                                               StellarMessage msg)
+    : mWeakPeer(peer)
+    , mMsg(std::make_shared<StellarMessage const>(std::move(msg)))
 {
     auto self = mWeakPeer.lock();
     if (!self)
     {
         throw std::runtime_error("Invalid peer");
     }
-    self->beginMessageProcessing(mMsg);
-    if (mMsg.type() == SCP_MESSAGE || mMsg.type() == TRANSACTION)
+    mReceivedTime = self->mAppConnector.now();
+    self->beginMessageProcessing(*mMsg);
+    if (mMsg->type() == SCP_MESSAGE || mMsg->type() == TRANSACTION)
     {
-        mMaybeHash = xdrBlake2(msg);
+        mMaybeHash = xdrBlake2(*mMsg);
     }
 
     auto populateTxMap = [&](StellarMessage const& msg, Hash const& hash) {
@@ -163,19 +216,27 @@ CapacityTrackedMessage::CapacityTrackedMessage(std::weak_ptr<Peer> peer,
     bool const checkTxSig = self->mAppConnector.getConfig()
                                 .EXPERIMENTAL_BACKGROUND_TX_SIG_VERIFICATION &&
                             self->useBackgroundThread();
+    bool const prevalidateTx =
+        self->mAppConnector.getConfig()
+            .EXPERIMENTAL_BACKGROUND_TX_PREVALIDATION &&
+        self->useBackgroundThread();
 
-    if (mMsg.type() == TRANSACTION)
+    if (mMsg->type() == TRANSACTION)
     {
-        auto const txn = populateTxMap(mMsg, mMaybeHash.value());
+        auto const txn = populateTxMap(*mMsg, mMaybeHash.value());
         if (checkTxSig)
         {
             populateSignatureCache(self->mAppConnector, txn);
         }
+        if (prevalidateTx)
+        {
+            prevalidateTransaction(self->mAppConnector, txn);
+        }
     }
 #ifdef BUILD_TESTS
-    else if (mMsg.type() == TX_SET && OverlayManager::isFloodMessage(mMsg))
+    else if (mMsg->type() == TX_SET && OverlayManager::isFloodMessage(*mMsg))
     {
-        for (auto const& tx : mMsg.txSet().txs)
+        for (auto const& tx : mMsg->txSet().txs)
         {
             StellarMessage txMsg;
             txMsg.type(TRANSACTION);
@@ -185,9 +246,17 @@ CapacityTrackedMessage::CapacityTrackedMessage(std::weak_ptr<Peer> peer,
             {
                 populateSignatureCache(self->mAppConnector, txn);
             }
+            if (prevalidateTx)
+            {
+                prevalidateTransaction(self->mAppConnector, txn);
+            }
         }
     }
 #endif
+    else if (mMsg->type() == TX_SET || mMsg->type() == GENERALIZED_TX_SET)
+    {
+        mTxSet = TxSetXDRFrame::makeFromWire(mMsg);
+    }
 }
 
 std::optional<Hash>
@@ -203,7 +272,7 @@ CapacityTrackedMessage::~CapacityTrackedMessage()
     {
         if (self)
         {
-            self->endMessageProcessing(mMsg);
+            self->endMessageProcessing(*mMsg);
         }
     }
     catch (std::exception const& e)
@@ -218,7 +287,7 @@ CapacityTrackedMessage::~CapacityTrackedMessage()
 StellarMessage const&
 CapacityTrackedMessage::getMessage() const
 {
-    return mMsg;
+    return *mMsg;
 }
 
 void
@@ -470,6 +539,7 @@ Peer::getJsonInfo(bool compact) const
             mPeerMetrics.mPullLatency.GetSnapshot().get75thPercentile());
         res["pull_mode"]["demand_timeouts"] =
             static_cast<Json::UInt64>(mPeerMetrics.mDemandTimeouts);
+        res["pull_mode"]["demands"] = mDemandStats.getJsonInfo();
         res["message_read"] =
             static_cast<Json::UInt64>(mPeerMetrics.mMessageRead);
         res["message_write"] =
@@ -490,6 +560,10 @@ Peer::getJsonInfo(bool compact) const
         res["message_delay_in_async_write_p75"] = static_cast<Json::UInt64>(
             mPeerMetrics.mMessageDelayInAsyncWriteTimer.GetSnapshot()
                 .get75thPercentile());
+        res["recv_delay_p75"] = static_cast<Json::UInt64>(
+            mPeerMetrics.mRecvDelayTimer.GetSnapshot().get75thPercentile());
+        res["send_delay_p75"] = static_cast<Json::UInt64>(
+            mPeerMetrics.mSendDelayTimer.GetSnapshot().get75thPercentile());
 
         res["unique_flood_message_recv"] =
             static_cast<Json::UInt64>(mPeerMetrics.mUniqueFloodMessageRecv);
@@ -546,6 +620,13 @@ Peer::clearBelow(uint32_t seq)
     }
 }
 
+PeerDemandStats&
+Peer::getDemandStats()
+{
+    releaseAssert(threadIsMain());
+    return mDemandStats;
+}
+
 void
 Peer::connectHandler(asio::error_code const& error)
 {
@@ -581,7 +662,8 @@ Peer::maybeExecuteInBackground(std::string const& jobName,
         !mAppConnector.threadIsType(Application::ThreadType::OVERLAY))
     {
         mAppConnector.postOnOverlayThread(
-            [self = shared_from_this(), f]() { f(self); }, jobName);
+            [self = shared_from_this(), f]() { f(self); }, jobName,
+            mOverlayIOContext);
     }
     else
     {
@@ -915,7 +997,9 @@ Peer::sendAuthenticatedMessage(
             ZoneNamedN(xdrZone, "XDR serialize", true);
             xdrBytes = xdr::xdr_to_msg(amsg);
         }
-        self->sendMessage(std::move(xdrBytes), msg);
+        xdrBytes = self->maybeCompress(std::move(xdrBytes), msg->type());
+        self->sendMessage(std::move(xdrBytes), msg,
+                          timePlaced.value_or(self->mAppConnector.now()));
         if (timePlaced)
         {
             self->mFlowControl->updateMsgMetrics(msg, *timePlaced);
@@ -927,6 +1011,41 @@ Peer::sendAuthenticatedMessage(
     maybeExecuteInBackground("sendAuthenticatedMessage", cb);
 }
 
+// Frames of messages we accept never have the compression flag in their length
+static_assert(MAX_MESSAGE_SIZE < MessageCompression::COMPRESSED_FRAME_FLAG);
+
+xdr::msg_ptr
+Peer::maybeCompress(xdr::msg_ptr&& xdrBytes, MessageType type)
+{
+    if (!mCompressionEnabled || !MessageCompression::isCompressible(type) ||
+        xdrBytes->size() <
+            mAppConnector.getConfig().PEER_MESSAGE_COMPRESSION_THRESHOLD)
+    {
+        return std::move(xdrBytes);
+    }
+    auto compressed = MessageCompression::compress(xdrBytes);
+    if (!compressed)
+    {
+        return std::move(xdrBytes);
+    }
+    mOverlayMetrics.mSendCompressedMeter.Mark();
+    mOverlayMetrics.mCompressionSavedBytes.Mark(xdrBytes->size() -
+                                                compressed->size());
+    return compressed;
+}
+
+std::vector<uint8_t>
+Peer::decompressFrame(uint8_t const* data, size_t size)
+{
+    if (!mCompressionEnabled)
+    {
+        throw CompressionError("unexpected compressed message");
+    }
+    auto res = MessageCompression::decompress(data, size, MAX_MESSAGE_SIZE);
+    mOverlayMetrics.mRecvCompressedMeter.Mark();
+    return res;
+}
+
 bool
 Peer::isConnected(RecursiveLockGuard const& stateGuard) const
 {
@@ -1011,9 +1130,10 @@ Peer::recvAuthenticatedMessage(AuthenticatedMessage&& msg)
     // messages in the background.
 
     // Start tracking capacity here, so read throttling is applied
-    // appropriately. Flow control might not be started at that time
+    // appropriately. Flow control might not be started at that time. The
+    // message is moved into the tracker, `msg` must not be used after this.
     auto msgTracker = std::make_shared<CapacityTrackedMessage>(
-        shared_from_this(), msg.v0().message);
+        shared_from_this(), std::move(msg.v0().message));
 
     std::string cat;
     Scheduler::ActionType type = Scheduler::ActionType::NORMAL_ACTION;
@@ -1074,13 +1194,39 @@ Peer::recvAuthenticatedMessage(AuthenticatedMessage&& msg)
         return true;
     }
 
-    // Verify SCP signatures when in the background
-    if (useBackgroundThread() && msg.v0().message.type() == SCP_MESSAGE)
+    // Copies of SCP envelopes Herder already accepted arrive from most peers;
+    // they only need the floodgate to learn that this peer has them, so skip
+    // signature verification and Herder for those.
+    if (msgTracker->getMessage().type() == SCP_MESSAGE &&
+        mAppConnector.isKnownSCPMessage(msgTracker->maybeGetHash().value()))
+    {
+        msgTracker->setKnownSCPDuplicate();
+    }
+    // Verify SCP signatures when in the background, skipping envelopes for
+    // slots Herder no longer accepts. The main thread drops the envelopes
+    // that fail either check without handing them to Herder.
+    else if (useBackgroundThread() &&
+             msgTracker->getMessage().type() == SCP_MESSAGE)
+    {
+        auto& envelope = msgTracker->getMessage().envelope();
+        bool accepted =
+            mAppConnector.isSCPSlotAboveMinimum(envelope.statement.slotIndex) &&
+            PubKeyUtils::verifySig(
+                envelope.statement.nodeID, envelope.signature,
+                xdr::xdr_to_opaque(mNetworkID, ENVELOPE_TYPE_SCP,
+                                   envelope.statement));
+        msgTracker->setSCPEnvelopeAccepted(accepted);
+    }
+    // Likewise verify the auth cert of a HELLO and derive the MAC keys of the
+    // session, so that a burst of reconnecting peers doesn't tie up the main
+    // thread with handshake crypto
+    else if (useBackgroundThread() &&
+             msgTracker->getMessage().type() == HELLO &&
+             getState(guard) < GOT_HELLO)
     {
-        auto& envelope = msg.v0().message.envelope();
-        PubKeyUtils::verifySig(envelope.statement.nodeID, envelope.signature,
-                               xdr::xdr_to_opaque(mNetworkID, ENVELOPE_TYPE_SCP,
-                                                  envelope.statement));
+        auto t = mOverlayMetrics.mHandshakeCryptoTimer.TimeScope();
+        msgTracker->setHelloAuth(mAppConnector.getPeerAuth().authenticateHello(
+            msgTracker->getMessage().hello(), mSendNonce, mRole));
     }
 
     // Subtle: move `msgTracker` shared_ptr into the lambda, to ensure
@@ -1107,6 +1253,10 @@ Peer::recvMessage(std::shared_ptr<CapacityTrackedMessage> msgTracker)
 
     auto const& stellarMsg = msgTracker->getMessage();
 
+    auto recvDelay = mAppConnector.now() - msgTracker->getReceivedTime();
+    mOverlayMetrics.getRecvDelayTimer(stellarMsg.type()).Update(recvDelay);
+    mPeerMetrics.mRecvDelayTimer.Update(recvDelay);
+
     // No need to hold the lock for the whole duration of the function, just
     // need to check state for a potential early exit. If the peer gets dropped
     // after, we'd still process the message, but that's harmless.
@@ -1216,7 +1366,7 @@ Peer::recvRawMessage(std::shared_ptr<CapacityTrackedMessage> msgTracker)
     case HELLO:
     {
         auto t = mOverlayMetrics.mRecvHelloTimer.TimeScope();
-        this->recvHello(stellarMsg.hello());
+        this->recvHello(stellarMsg.hello(), msgTracker->getHelloAuth());
     }
     break;
 
@@ -1294,7 +1444,7 @@ Peer::recvRawMessage(std::shared_ptr<CapacityTrackedMessage> msgTracker)
 #endif
         {
             auto t = mOverlayMetrics.mRecvTxSetTimer.TimeScope();
-            recvTxSet(stellarMsg);
+            recvTxSet(*msgTracker);
         }
     }
     break;
@@ -1302,7 +1452,7 @@ Peer::recvRawMessage(std::shared_ptr<CapacityTrackedMessage> msgTracker)
     case GENERALIZED_TX_SET:
     {
         auto t = mOverlayMetrics.mRecvTxSetTimer.TimeScope();
-        recvGeneralizedTxSet(stellarMsg);
+        recvGeneralizedTxSet(*msgTracker);
     }
     break;
 
@@ -1473,20 +1623,22 @@ Peer::recvGetTxSet(StellarMessage const& msg)
 }
 
 void
-Peer::recvTxSet(StellarMessage const& msg)
+Peer::recvTxSet(CapacityTrackedMessage const& msg)
 {
     ZoneScoped;
     releaseAssert(threadIsMain());
-    auto frame = TxSetXDRFrame::makeFromWire(msg.txSet());
+    auto const& frame = msg.getTxSet();
+    releaseAssert(frame);
     mAppConnector.getHerder().recvTxSet(frame->getContentsHash(), frame);
 }
 
 void
-Peer::recvGeneralizedTxSet(StellarMessage const& msg)
+Peer::recvGeneralizedTxSet(CapacityTrackedMessage const& msg)
 {
     ZoneScoped;
     releaseAssert(threadIsMain());
-    auto frame = TxSetXDRFrame::makeFromWire(msg.generalizedTxSet());
+    auto const& frame = msg.getTxSet();
+    releaseAssert(frame);
     mAppConnector.getHerder().recvTxSet(frame->getContentsHash(), frame);
 }
 
@@ -1604,6 +1756,18 @@ Peer::recvSCPMessage(CapacityTrackedMessage const& msg)
     ZoneScoped;
     releaseAssert(threadIsMain());
     SCPEnvelope const& envelope = msg.getMessage().envelope();
+    releaseAssert(msg.maybeGetHash());
+    auto const& msgID = msg.maybeGetHash().value();
+
+    if (msg.isKnownSCPDuplicate())
+    {
+        // Herder has this envelope already, just note that this peer has it
+        // too so that we don't send it back
+        mOverlayMetrics.mRecvSCPKnownDuplicate.Mark();
+        mAppConnector.getOverlayManager().recvFloodedMsgID(shared_from_this(),
+                                                           msgID);
+        return;
+    }
 
     auto type = msg.getMessage().envelope().statement.pledges.type();
     auto t = (type == SCP_ST_PREPARE
@@ -1634,17 +1798,30 @@ Peer::recvSCPMessage(CapacityTrackedMessage const& msg)
     }
     ZoneText(codeStr.c_str(), codeStr.size());
 
+    auto accepted = msg.getSCPEnvelopeAccepted();
+    if (accepted && !*accepted)
+    {
+        // Herder would discard this envelope, so it's neither processed nor
+        // added to the floodmap
+        return;
+    }
+
     // add it to the floodmap so that this peer gets credit for it
-    releaseAssert(msg.maybeGetHash());
-    mAppConnector.getOverlayManager().recvFloodedMsgID(
-        shared_from_this(), msg.maybeGetHash().value());
+    mAppConnector.getOverlayManager().recvFloodedMsgID(shared_from_this(),
+                                                       msgID);
 
-    auto res = mAppConnector.getHerder().recvSCPEnvelope(envelope);
+    auto res = accepted
+                   ? mAppConnector.getHerder().recvVerifiedSCPEnvelope(envelope)
+                   : mAppConnector.getHerder().recvSCPEnvelope(envelope);
     if (res == Herder::ENVELOPE_STATUS_DISCARDED)
     {
         // the message was discarded, remove it from the floodmap as well
-        mAppConnector.getOverlayManager().forgetFloodedMsg(
-            msg.maybeGetHash().value());
+        mAppConnector.getOverlayManager().forgetFloodedMsg(msgID);
+    }
+    else
+    {
+        mAppConnector.getOverlayManager().rememberSCPMessage(
+            envelope.statement.slotIndex, msgID);
     }
 }
 
@@ -1738,7 +1915,7 @@ Peer::updatePeerRecordAfterAuthentication()
 }
 
 void
-Peer::recvHello(Hello const& elo)
+Peer::recvHello(Hello const& elo, std::optional<HelloAuth> const& auth)
 {
     ZoneScoped;
     releaseAssert(threadIsMain());
@@ -1752,7 +1929,14 @@ Peer::recvHello(Hello const& elo)
     }
 
     auto& peerAuth = mAppConnector.getOverlayManager().getPeerAuth();
-    if (!peerAuth.verifyRemoteAuthCert(elo.peerID, elo.cert))
+    auto helloAuth = auth;
+    if (!helloAuth)
+    {
+        auto t = mOverlayMetrics.mHandshakeCryptoTimer.TimeScope();
+        helloAuth = peerAuth.authenticateHello(elo, mSendNonce, mRole);
+    }
+    if (peerAuth.isRemoteAuthCertExpired(elo.cert) ||
+        !helloAuth->mCertSignatureValid)
     {
         drop("failed to verify auth cert",
              Peer::DropDirection::WE_DROPPED_REMOTE);
@@ -1770,11 +1954,12 @@ Peer::recvHello(Hello const& elo)
     mRemoteVersion = elo.versionStr;
     mPeerID = elo.peerID;
     mFlowControl->setPeerID(mPeerID);
+    mCompressionEnabled =
+        mAppConnector.getConfig().PEER_MESSAGE_COMPRESSION_KEYS.count(
+            mPeerID) != 0;
     mRecvNonce = elo.nonce;
-    mHmac.setSendMackey(peerAuth.getSendingMacKey(elo.cert.pubkey, mSendNonce,
-                                                  mRecvNonce, mRole));
-    mHmac.setRecvMackey(peerAuth.getReceivingMacKey(elo.cert.pubkey, mSendNonce,
-                                                    mRecvNonce, mRole));
+    mHmac.setSendMackey(helloAuth->mSendingMacKey);
+    mHmac.setRecvMackey(helloAuth->mReceivingMacKey);
 
     setState(guard, GOT_HELLO);
 
@@ -1918,6 +2103,8 @@ Peer::recvAuth(StellarMessage const& msg)
         sendErrorAndDrop(ERR_LOAD, "peer rejected");
         return;
     }
+    mOverlayMetrics.mHandshakeLatencyTimer.Update(mAppConnector.now() -
+                                                  mCreationTime);
 
     if (msg.auth().flags != AUTH_MSG_FLAG_FLOW_CONTROL_BYTES_REQUESTED)
     {
@@ -2079,6 +2266,12 @@ Peer::PeerMetrics::PeerMetrics(VirtualClock::time_point connectedTime)
     , mPullLatency(medida::Timer(PEER_METRICS_DURATION_UNIT,
                                  PEER_METRICS_RATE_UNIT,
                                  PEER_METRICS_WINDOW_SIZE))
+    , mRecvDelayTimer(medida::Timer(PEER_METRICS_DURATION_UNIT,
+                                    PEER_METRICS_RATE_UNIT,
+                                    PEER_METRICS_WINDOW_SIZE))
+    , mSendDelayTimer(medida::Timer(PEER_METRICS_DURATION_UNIT,
+                                    PEER_METRICS_RATE_UNIT,
+                                    PEER_METRICS_WINDOW_SIZE))
     , mDemandTimeouts(0)
     , mUniqueFloodBytesRecv(0)
     , mDuplicateFloodBytesRecv(0)
@@ -11,6 +11,7 @@
 #include "medida/timer.h"
 #include "overlay/Hmac.h"
 #include "overlay/PeerBareAddress.h"
+#include "overlay/PeerDemandStats.h"
 #include "transactions/TransactionFrameBase.h"
 #include "util/NonCopyable.h"
 #include "util/ThreadAnnotations.h"
@@ -42,6 +43,15 @@ struct OverlayMetrics;
 class FlowControl;
 class TxAdverts;
 class CapacityTrackedMessage;
+class TxSetXDRFrame;
+
+// Outcome of the crypto of a HELLO, see PeerAuth::authenticateHello
+struct HelloAuth
+{
+    bool mCertSignatureValid{false};
+    HmacSha256Key mSendingMacKey;
+    HmacSha256Key mReceivingMacKey;
+};
 
 // Peer class represents a connected peer (either inbound or outbound)
 //
@@ -139,6 +149,11 @@ class Peer : public std::enable_shared_from_this<Peer>,
 
         medida::Timer mPullLatency;
 
+        // Same as OverlayMetrics::getRecvDelayTimer and getSendDelayTimer,
+        // for all message types
+        medida::Timer mRecvDelayTimer;
+        medida::Timer mSendDelayTimer;
+
         std::atomic<uint64_t> mDemandTimeouts;
         std::atomic<uint64_t> mUniqueFloodBytesRecv;
         std::atomic<uint64_t> mDuplicateFloodBytesRecv;
@@ -162,6 +177,9 @@ class Peer : public std::enable_shared_from_this<Peer>,
 
     struct TimestampedMessage
     {
+        // When the message was first queued for sending, which is earlier
+        // than mEnqueuedTime for messages that waited in flow control
+        VirtualClock::time_point mQueuedTime;
         VirtualClock::time_point mEnqueuedTime;
         VirtualClock::time_point mIssuedTime;
         VirtualClock::time_point mCompletedTime;
@@ -203,6 +221,15 @@ class Peer : public std::enable_shared_from_this<Peer>,
 #endif
 
     Hmac mHmac;
+    // Set once HELLO was received, if the peer is listed in
+    // PEER_MESSAGE_COMPRESSION_KEYS. Read on the overlay thread to compress
+    // outgoing messages and accept compressed ones.
+    std::atomic<bool> mCompressionEnabled{false};
+    // Overlay thread this peer's socket is bound to when background
+    // processing is enabled. All of the peer's overlay work is posted there,
+    // so messages from one peer are processed and handed to the main thread in
+    // the order they were received.
+    asio::io_context* mOverlayIOContext{nullptr};
     // Does local node have capacity to read from this peer
     bool canRead() const;
     // helper method to acknowledge that some bytes were received
@@ -232,6 +259,10 @@ class Peer : public std::enable_shared_from_this<Peer>,
     }
 
     bool recvAuthenticatedMessage(AuthenticatedMessage&& msg);
+    // Returns the original body of a compressed frame received from this
+    // peer. Throws CompressionError if we don't compress with this peer, or
+    // the frame is malformed.
+    std::vector<uint8_t> decompressFrame(uint8_t const* data, size_t size);
     // These exist mostly to be overridden in TCPPeer and callable via
     // shared_ptr<Peer> as a captured shared_from_this().
     virtual void connectHandler(asio::error_code const& ec);
@@ -269,6 +300,7 @@ class Peer : public std::enable_shared_from_this<Peer>,
     VirtualTimer mDelayedExecutionTimer;
 
     std::shared_ptr<TxAdverts> mTxAdverts;
+    PeerDemandStats mDemandStats;
     QueryInfo mQSetQueryInfo;
     QueryInfo mTxSetQueryInfo;
     bool mPeersReceived{false};
@@ -286,7 +318,8 @@ class Peer : public std::enable_shared_from_this<Peer>,
     void updatePeerRecordAfterAuthentication();
     void recvAuth(StellarMessage const& msg);
     void recvDontHave(StellarMessage const& msg);
-    void recvHello(Hello const& elo);
+    // `auth` is the crypto of the HELLO if an overlay thread already did it
+    void recvHello(Hello const& elo, std::optional<HelloAuth> const& auth);
     void recvPeers(StellarMessage const& msg);
     void recvSurveyRequestMessage(StellarMessage const& msg);
     void recvSurveyResponseMessage(StellarMessage const& msg);
@@ -295,8 +328,8 @@ class Peer : public std::enable_shared_from_this<Peer>,
     void recvSendMore(StellarMessage const& msg);
 
     void recvGetTxSet(StellarMessage const& msg);
-    void recvTxSet(StellarMessage const& msg);
-    void recvGeneralizedTxSet(StellarMessage const& msg);
+    void recvTxSet(CapacityTrackedMessage const& msg);
+    void recvGeneralizedTxSet(CapacityTrackedMessage const& msg);
     void recvTransaction(CapacityTrackedMessage const& msgTracker);
 #ifdef BUILD_TESTS
     void recvTxBatch(CapacityTrackedMessage const& msgTracker);
@@ -325,8 +358,10 @@ class Peer : public std::enable_shared_from_this<Peer>,
     // put in a reused/non-owned buffer without having to buffer/queue
     // messages somewhere else. The async write request will point _into_
     // this owned buffer. This is really the best we can do.
+    // `queuedTime` is when the message was first queued for sending.
     virtual void sendMessage(xdr::msg_ptr&& xdrBytes,
-                             std::shared_ptr<StellarMessage const> msg) = 0;
+                             std::shared_ptr<StellarMessage const> msg,
+                             VirtualClock::time_point queuedTime) = 0;
     virtual void scheduleRead() = 0;
     virtual void
     connected()
@@ -343,6 +378,9 @@ class Peer : public std::enable_shared_from_this<Peer>,
     void sendAuthenticatedMessage(
         std::shared_ptr<StellarMessage const> msg,
         std::optional<VirtualClock::time_point> timePlaced = std::nullopt);
+    // Returns the frame of a message of the given type, compressed if
+    // compression is enabled and the frame is large enough to be worth it
+    xdr::msg_ptr maybeCompress(xdr::msg_ptr&& xdrBytes, MessageType type);
     void beginMessageProcessing(StellarMessage const& msg);
     void endMessageProcessing(StellarMessage const& msg);
 
@@ -427,6 +465,8 @@ class Peer : public std::enable_shared_from_this<Peer>,
     Hash popAdvert();
     // Clear pull mode state below `ledgerSeq`
     void clearBelow(uint32_t ledgerSeq);
+    // How quickly and reliably this peer answers our demands
+    PeerDemandStats& getDemandStats();
 
     /* The following functions can be called from background thread, so they
      * must be thread-safe */
@@ -473,7 +513,7 @@ class Peer : public std::enable_shared_from_this<Peer>,
     sendXdrMessageForTesting(xdr::msg_ptr xdrBytes,
                              std::shared_ptr<StellarMessage const> msg)
     {
-        sendMessage(std::move(xdrBytes), msg);
+        sendMessage(std::move(xdrBytes), msg, mAppConnector.now());
     }
 
     std::string
@@ -524,20 +564,72 @@ class Peer : public std::enable_shared_from_this<Peer>,
 class CapacityTrackedMessage : private NonMovableOrCopyable
 {
     std::weak_ptr<Peer> const mWeakPeer;
-    StellarMessage const mMsg;
+    std::shared_ptr<StellarMessage const> const mMsg;
+    VirtualClock::time_point mReceivedTime;
     std::optional<Hash> mMaybeHash;
     // xdrBlake2 -> txFrame (with pre-populated hashes)
     std::unordered_map<Hash, TransactionFrameBasePtr> mTxsMap;
+    // Whether the SCP envelope passed the checks done on the overlay thread,
+    // if they were done
+    std::optional<bool> mSCPEnvelopeAccepted;
+    // Whether this is a copy of an SCP envelope Herder already accepted
+    bool mKnownSCPDuplicate{false};
+    // Crypto of a HELLO, if done on the overlay thread
+    std::optional<HelloAuth> mHelloAuth;
+    // Frame of a TX_SET or GENERALIZED_TX_SET message, sharing the message
+    // and hashed on the thread that received it
+    std::shared_ptr<TxSetXDRFrame const> mTxSet;
 
   public:
-    CapacityTrackedMessage(std::weak_ptr<Peer> peer, StellarMessage const& msg);
+    CapacityTrackedMessage(std::weak_ptr<Peer> peer, StellarMessage msg);
     StellarMessage const& getMessage() const;
     ~CapacityTrackedMessage();
     std::optional<Hash> maybeGetHash() const;
+    // When the message was read off the wire
+    VirtualClock::time_point
+    getReceivedTime() const
+    {
+        return mReceivedTime;
+    }
+    std::optional<bool>
+    getSCPEnvelopeAccepted() const
+    {
+        return mSCPEnvelopeAccepted;
+    }
+    void
+    setSCPEnvelopeAccepted(bool accepted)
+    {
+        mSCPEnvelopeAccepted = accepted;
+    }
+    bool
+    isKnownSCPDuplicate() const
+    {
+        return mKnownSCPDuplicate;
+    }
+    void
+    setKnownSCPDuplicate()
+    {
+        mKnownSCPDuplicate = true;
+    }
+    std::optional<HelloAuth> const&
+    getHelloAuth() const
+    {
+        return mHelloAuth;
+    }
+    void
+    setHelloAuth(HelloAuth const& auth)
+    {
+        mHelloAuth = auth;
+    }
     std::unordered_map<Hash, TransactionFrameBasePtr> const&
     getTxMap() const
     {
         return mTxsMap;
     }
+    std::shared_ptr<TxSetXDRFrame const> const&
+    getTxSet() const
+    {
+        return mTxSet;
+    }
 };
 }
@@ -11,6 +11,7 @@
 #include "main/Config.h"
 #include "util/Logging.h"
 #include "xdrpp/marshal.h"
+#include <Tracy.hpp>
 
 namespace stellar
 {
@@ -26,8 +27,8 @@ makeAuthCert(Application& app, Curve25519Public const& pub)
     cert.pubkey = pub;
     cert.expiration = app.timeNow() + expirationLimit;
 
-    auto hash = sha256(xdr::xdr_to_opaque(
-        app.getNetworkID(), ENVELOPE_TYPE_AUTH, cert.expiration, cert.pubkey));
+    auto hash = xdrSha256(app.getNetworkID(), ENVELOPE_TYPE_AUTH,
+                          cert.expiration, cert.pubkey);
     CLOG_DEBUG(Overlay, "PeerAuth signing cert hash: {}", hexAbbrev(hash));
     cert.sig = app.getConfig().NODE_SEED.sign(hash);
     return cert;
@@ -53,33 +54,71 @@ PeerAuth::getAuthCert()
 }
 
 bool
-PeerAuth::verifyRemoteAuthCert(NodeID const& remoteNode, AuthCert const& cert)
+PeerAuth::isRemoteAuthCertExpired(AuthCert const& cert)
 {
     if (cert.expiration < mApp.timeNow())
     {
         CLOG_DEBUG(Overlay, "PeerAuth cert expired: expired= {}, now={}",
                    cert.expiration, mApp.timeNow());
-        return false;
+        return true;
     }
-    auto hash = sha256(xdr::xdr_to_opaque(
-        mApp.getNetworkID(), ENVELOPE_TYPE_AUTH, cert.expiration, cert.pubkey));
+    return false;
+}
+
+bool
+PeerAuth::verifyRemoteAuthCertSignature(NodeID const& remoteNode,
+                                        AuthCert const& cert) const
+{
+    auto hash = xdrSha256(mApp.getNetworkID(), ENVELOPE_TYPE_AUTH,
+                          cert.expiration, cert.pubkey);
 
     CLOG_DEBUG(Overlay, "PeerAuth verifying cert hash: {}", hexAbbrev(hash));
     return PubKeyUtils::verifySig(remoteNode, cert.sig, hash);
 }
 
+bool
+PeerAuth::verifyRemoteAuthCert(NodeID const& remoteNode, AuthCert const& cert)
+{
+    return !isRemoteAuthCertExpired(cert) &&
+           verifyRemoteAuthCertSignature(remoteNode, cert);
+}
+
+HelloAuth
+PeerAuth::authenticateHello(Hello const& hello, uint256 const& localNonce,
+                            Peer::PeerRole role)
+{
+    ZoneScoped;
+    HelloAuth res;
+    res.mCertSignatureValid =
+        verifyRemoteAuthCertSignature(hello.peerID, hello.cert);
+    if (res.mCertSignatureValid)
+    {
+        res.mSendingMacKey = getSendingMacKey(hello.cert.pubkey, localNonce,
+                                              hello.nonce, role);
+        res.mReceivingMacKey = getReceivingMacKey(
+            hello.cert.pubkey, localNonce, hello.nonce, role);
+    }
+    return res;
+}
+
 HmacSha256Key
 PeerAuth::getSharedKey(Curve25519Public const& remotePublic,
                        Peer::PeerRole role)
 {
     auto key = PeerSharedKeyId{remotePublic, role};
-    if (mSharedKeyCache.exists(key))
     {
-        return mSharedKeyCache.get(key);
+        std::lock_guard<std::mutex> guard(mSharedKeyCacheMutex);
+        if (mSharedKeyCache.exists(key))
+        {
+            return mSharedKeyCache.get(key);
+        }
     }
+    // Derived without the lock, two threads racing on a key both derive the
+    // same value
     auto value =
         curve25519DeriveSharedKey(mECDHSecretKey, mECDHPublicKey, remotePublic,
                                   role == Peer::WE_CALLED_REMOTE);
+    std::lock_guard<std::mutex> guard(mSharedKeyCacheMutex);
     mSharedKeyCache.put(key, value);
     return value;
 }
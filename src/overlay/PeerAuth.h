@@ -4,6 +4,7 @@
 #include "overlay/PeerSharedKeyId.h"
 #include "util/RandomEvictionCache.h"
 #include "xdr/Stellar-types.h"
+#include <mutex>
 
 // Copyright 2015 Stellar Development Foundation and contributors. Licensed
 // under the Apache License, Version 2.0. See the COPYING file at the root
@@ -29,6 +30,7 @@ class PeerAuth
     Curve25519Public mECDHPublicKey;
     AuthCert mCert;
 
+    std::mutex mSharedKeyCacheMutex;
     RandomEvictionCache<PeerSharedKeyId, HmacSha256Key> mSharedKeyCache;
 
     HmacSha256Key getSharedKey(Curve25519Public const& remotePublic,
@@ -37,8 +39,22 @@ class PeerAuth
   public:
     PeerAuth(Application& app);
 
+    // Main thread only
     AuthCert getAuthCert();
     bool verifyRemoteAuthCert(NodeID const& remoteNode, AuthCert const& cert);
+    bool isRemoteAuthCertExpired(AuthCert const& cert);
+
+    // The rest is threadsafe, so that overlay threads can do the crypto of
+    // the handshakes of the peers they read from.
+
+    bool verifyRemoteAuthCertSignature(NodeID const& remoteNode,
+                                       AuthCert const& cert) const;
+
+    // Verifies the signature of the auth cert of `hello` and, if it's valid,
+    // derives the MAC keys of the session it starts. The expiration of the
+    // cert is left to the caller, on the main thread.
+    HelloAuth authenticateHello(Hello const& hello, uint256 const& localNonce,
+                                Peer::PeerRole role);
 
     HmacSha256Key getSendingMacKey(Curve25519Public const& remotePublic,
                                    uint256 const& localNonce,
@@ -0,0 +1,70 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "overlay/PeerDemandStats.h"
+#include <algorithm>
+#include <json/json.h>
+
+namespace stellar
+{
+
+// Keeps a peer that never delivers from getting an infinite score, so peers
+// stay comparable
+constexpr double MIN_SUCCESS_RATE = 0.05;
+
+void
+PeerDemandStats::recordFulfilled(VirtualClock::duration latency)
+{
+    double ms = std::chrono::duration<double, std::milli>(latency).count();
+    mLatencyMs = mLatencyMs ? *mLatencyMs + EWMA_ALPHA * (ms - *mLatencyMs)
+                            : ms;
+    mSuccessRate += EWMA_ALPHA * (1.0 - mSuccessRate);
+    ++mFulfilled;
+}
+
+void
+PeerDemandStats::recordTimeout()
+{
+    mSuccessRate -= EWMA_ALPHA * mSuccessRate;
+    ++mTimeouts;
+}
+
+std::optional<std::chrono::milliseconds>
+PeerDemandStats::getLatency() const
+{
+    if (!mLatencyMs)
+    {
+        return std::nullopt;
+    }
+    return std::chrono::milliseconds(static_cast<int64_t>(*mLatencyMs));
+}
+
+double
+PeerDemandStats::getSuccessRate() const
+{
+    return mSuccessRate;
+}
+
+double
+PeerDemandStats::getScore(std::chrono::milliseconds defaultLatency) const
+{
+    double latency =
+        mLatencyMs ? *mLatencyMs : static_cast<double>(defaultLatency.count());
+    return latency / std::max(mSuccessRate, MIN_SUCCESS_RATE);
+}
+
+Json::Value
+PeerDemandStats::getJsonInfo() const
+{
+    Json::Value res;
+    if (mLatencyMs)
+    {
+        res["latency_ewma_ms"] = static_cast<Json::UInt64>(*mLatencyMs);
+    }
+    res["success_rate"] = mSuccessRate;
+    res["fulfilled"] = static_cast<Json::UInt64>(mFulfilled);
+    res["timeouts"] = static_cast<Json::UInt64>(mTimeouts);
+    return res;
+}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/Timer.h"
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+namespace Json
+{
+class Value;
+}
+
+namespace stellar
+{
+
+// How well a peer responds to pull-mode demands: an exponentially weighted
+// moving average of the time it takes to deliver a demanded transaction, and
+// of the rate at which it delivers before we give up and demand from someone
+// else. TxDemandsManager uses these to decide which peers to demand from first
+// and how long to wait for them. Must only be used from the main thread.
+class PeerDemandStats
+{
+  public:
+    // Weight of a new sample in both averages
+    static constexpr double EWMA_ALPHA = 0.2;
+
+    // A demanded transaction arrived after `latency`
+    void recordFulfilled(VirtualClock::duration latency);
+    // A demand was retried with another peer before this peer delivered
+    void recordTimeout();
+
+    std::optional<std::chrono::milliseconds> getLatency() const;
+    double getSuccessRate() const;
+
+    // Expected time to get a transaction from this peer, counting retries
+    // elsewhere: lower is better. Peers without latency samples yet are
+    // assumed to answer in `defaultLatency`.
+    double getScore(std::chrono::milliseconds defaultLatency) const;
+
+    Json::Value getJsonInfo() const;
+
+  private:
+    std::optional<double> mLatencyMs;
+    double mSuccessRate{1.0};
+    uint64_t mFulfilled{0};
+    uint64_t mTimeouts{0};
+};
+}
@@ -85,82 +85,162 @@ PeerManager::PeerManager(Application& app)
           *this, RandomPeerSource::maxFailures(MAX_FAILURES, true)))
     , mInboundPeersToSend(std::make_unique<RandomPeerSource>(
           *this, RandomPeerSource::maxFailures(MAX_FAILURES, false)))
+    , mFlushTimer(app)
 {
 }
 
-std::vector<PeerBareAddress>
-PeerManager::loadRandomPeers(PeerQuery const& query, size_t size)
+PeerManager::~PeerManager()
+{
+    mFlushTimer.cancel();
+}
+
+void
+PeerManager::ensureLoaded()
 {
+    if (mLoaded)
+    {
+        return;
+    }
     ZoneScoped;
-    // BATCH_SIZE should always be bigger, so it should win anyway
-    size = std::max(size, BATCH_SIZE);
+    mLoaded = true;
 
-    // if we ever start removing peers from db, we may need to enable this
-    // soci::transaction sqltx(mApp.getDatabase().getSession());
-    // mApp.getDatabase().setCurrentTransactionReadOnly();
+    std::string sql =
+        "SELECT ip, port, nextattempt, numfailures, type FROM peers";
+    try
+    {
+        std::string ip;
+        int port;
+        PeerRecord record;
+
+        auto prep = mApp.getDatabase().getPreparedStatement(
+            sql, mApp.getDatabase().getSession());
+        auto& st = prep.statement();
+
+        st.exchange(into(ip));
+        st.exchange(into(port));
+        st.exchange(into(record.mNextAttempt));
+        st.exchange(into(record.mNumFailures));
+        st.exchange(into(record.mType));
 
-    std::vector<std::string> conditions;
-    if (query.mUseNextAttempt)
+        st.define_and_bind();
+        {
+            auto timer = mApp.getDatabase().getSelectTimer("peer");
+            st.execute(true);
+        }
+        while (st.got_data())
+        {
+            if (!ip.empty() && port > 0)
+            {
+                putPeer(PeerBareAddress{ip, static_cast<unsigned short>(port)},
+                        record);
+            }
+            st.fetch();
+        }
+    }
+    catch (soci_error& err)
     {
-        conditions.push_back("nextattempt <= :nextattempt");
+        CLOG_ERROR(Overlay, "PeerManager::ensureLoaded error: {}", err.what());
     }
-    if (query.mMaxNumFailures.has_value())
+    CLOG_DEBUG(Overlay, "Loaded {} peers", mPeers.size());
+}
+
+void
+PeerManager::putPeer(PeerBareAddress const& address, PeerRecord const& peer)
+{
+    auto it = mPeers.find(address);
+    if (it != mPeers.end())
     {
-        conditions.push_back("numfailures <= :maxFailures");
+        erasePeer(it);
     }
-    if (query.mTypeFilter == PeerTypeFilter::ANY_OUTBOUND)
+    mPeers.emplace(address, peer);
+    if (peer.mType >= 0 &&
+        static_cast<size_t>(peer.mType) < mPeersByType.size())
     {
-        conditions.push_back("type != :inboundType");
+        mPeersByType[peer.mType].emplace(
+            VirtualClock::tmToSystemPoint(peer.mNextAttempt), address);
     }
-    else
+}
+
+void
+PeerManager::erasePeer(std::map<PeerBareAddress, PeerRecord>::iterator it)
+{
+    auto const& peer = it->second;
+    if (peer.mType >= 0 &&
+        static_cast<size_t>(peer.mType) < mPeersByType.size())
     {
-        conditions.push_back("type = :type");
+        mPeersByType[peer.mType].erase(std::make_pair(
+            VirtualClock::tmToSystemPoint(peer.mNextAttempt), it->first));
     }
-    releaseAssert(!conditions.empty());
-    std::string where = conditions[0];
-    for (size_t i = 1; i < conditions.size(); i++)
+    mPeers.erase(it);
+}
+
+void
+PeerManager::scheduleFlush()
+{
+    if (mFlushPending)
     {
-        where += " AND " + conditions[i];
+        return;
     }
+    mFlushPending = true;
+    mFlushTimer.expires_from_now(FLUSH_INTERVAL);
+    mFlushTimer.async_wait([this]() { flush(); },
+                           &VirtualTimer::onFailureNoop);
+}
 
-    std::tm nextAttempt =
-        VirtualClock::systemPointToTm(mApp.getClock().system_now());
-    size_t maxNumFailures{0};
-    int exactType = static_cast<int>(query.mTypeFilter);
-    int inboundType = static_cast<int>(PeerType::INBOUND);
+std::vector<PeerBareAddress>
+PeerManager::loadRandomPeers(PeerQuery const& query, size_t size)
+{
+    ZoneScoped;
+    ensureLoaded();
+    // BATCH_SIZE should always be bigger, so it should win anyway
+    size = std::max(size, BATCH_SIZE);
 
-    auto bindToStatement = [&](soci::statement& st) {
-        if (query.mUseNextAttempt)
-        {
-            st.exchange(soci::use(nextAttempt));
-        }
-        if (query.mMaxNumFailures.has_value())
-        {
-            maxNumFailures = *query.mMaxNumFailures;
-            st.exchange(soci::use(maxNumFailures));
-        }
-        if (query.mTypeFilter == PeerTypeFilter::ANY_OUTBOUND)
-        {
-            st.exchange(soci::use(inboundType));
-        }
-        else
-        {
-            st.exchange(soci::use(exactType));
-        }
-    };
+    std::vector<PeerType> types;
+    switch (query.mTypeFilter)
+    {
+    case PeerTypeFilter::INBOUND_ONLY:
+        types = {PeerType::INBOUND};
+        break;
+    case PeerTypeFilter::OUTBOUND_ONLY:
+        types = {PeerType::OUTBOUND};
+        break;
+    case PeerTypeFilter::PREFERRED_ONLY:
+        types = {PeerType::PREFERRED};
+        break;
+    case PeerTypeFilter::ANY_OUTBOUND:
+        types = {PeerType::OUTBOUND, PeerType::PREFERRED};
+        break;
+    }
 
+    // Next attempts are stored with a resolution of seconds
+    auto now = VirtualClock::tmToSystemPoint(
+        VirtualClock::systemPointToTm(mApp.getClock().system_now()));
     auto result = std::vector<PeerBareAddress>{};
-    size_t count = countPeers(where, bindToStatement);
-    if (count == 0)
+    for (auto type : types)
     {
-        return result;
+        for (auto const& [nextAttempt, address] :
+             mPeersByType[static_cast<size_t>(type)])
+        {
+            if (query.mUseNextAttempt && nextAttempt > now)
+            {
+                // Sorted by next attempt, none of the following are due
+                break;
+            }
+            if (query.mMaxNumFailures.has_value() &&
+                mPeers.at(address).mNumFailures > *query.mMaxNumFailures)
+            {
+                continue;
+            }
+            result.emplace_back(address);
+        }
     }
 
-    size_t maxOffset = count > size ? count - size : 0;
-    size_t offset = rand_uniform<size_t>(0, maxOffset);
-    result = loadPeers(size, offset, where, bindToStatement);
     stellar::shuffle(std::begin(result), std::end(result),
                      getGlobalRandomEngine());
+    if (result.size() > size)
+    {
+        result.resize(size);
+    }
     return result;
 }
 
@@ -170,40 +250,23 @@ PeerManager::removePeersWithManyFailures(size_t minNumFailures,
 {
     ZoneScoped;
     releaseAssert(threadIsMain());
-    try
+    ensureLoaded();
+    for (auto it = mPeers.begin(); it != mPeers.end();)
     {
-        auto& db = mApp.getDatabase();
-        auto sql = std::string{
-            "DELETE FROM peers WHERE numfailures >= :minNumFailures"};
-        if (address)
+        auto next = std::next(it);
+        // A given address removes the peers on all ports of its IP
+        if (it->second.mNumFailures >= minNumFailures &&
+            (!address || it->first.getIP() == address->getIP()))
         {
-            sql += " AND ip = :ip";
-        }
-
-        auto prep =
-            db.getPreparedStatement(sql, mApp.getDatabase().getSession());
-        auto& st = prep.statement();
-
-        st.exchange(use(minNumFailures));
-
-        std::string ip;
-        if (address)
-        {
-            ip = address->getIP();
-            st.exchange(use(ip));
-        }
-        st.define_and_bind();
-
-        {
-            auto timer = db.getDeleteTimer("peer");
-            st.execute(true);
+            mDirtyPeers.erase(it->first);
+            mRemovedPeers.insert(it->first);
+            erasePeer(it);
         }
+        it = next;
     }
-    catch (soci_error& err)
+    if (!mRemovedPeers.empty())
     {
-        CLOG_ERROR(Overlay,
-                   "PeerManager::removePeersWithManyFailures error: {}",
-                   err.what());
+        scheduleFlush();
     }
 }
 
@@ -231,97 +294,95 @@ std::pair<PeerRecord, bool>
 PeerManager::load(PeerBareAddress const& address)
 {
     ZoneScoped;
-    auto result = PeerRecord{};
-    auto inDatabase = false;
-
-    try
+    ensureLoaded();
+    auto it = mPeers.find(address);
+    if (it != mPeers.end())
     {
-        auto prep = mApp.getDatabase().getPreparedStatement(
-            "SELECT numfailures, nextattempt, type FROM peers "
-            "WHERE ip = :v1 AND port = :v2",
-            mApp.getDatabase().getSession());
-        auto& st = prep.statement();
-        st.exchange(into(result.mNumFailures));
-        st.exchange(into(result.mNextAttempt));
-        st.exchange(into(result.mType));
-        std::string ip = address.getIP();
-        st.exchange(use(ip));
-        int port = address.getPort();
-        st.exchange(use(port));
-        st.define_and_bind();
-        {
-            auto timer = mApp.getDatabase().getSelectTimer("peer");
-            st.execute(true);
-            inDatabase = st.got_data();
-
-            if (!inDatabase)
-            {
-                result.mNextAttempt =
-                    VirtualClock::systemPointToTm(mApp.getClock().system_now());
-                result.mType = static_cast<int>(PeerType::INBOUND);
-            }
-        }
-    }
-    catch (soci_error& err)
-    {
-        CLOG_ERROR(Overlay, "PeerManager::load error: {} on {}", err.what(),
-                   address.toString());
+        return std::make_pair(it->second, true);
     }
 
-    return std::make_pair(result, inDatabase);
+    auto result = PeerRecord{};
+    result.mNextAttempt =
+        VirtualClock::systemPointToTm(mApp.getClock().system_now());
+    result.mType = static_cast<int>(PeerType::INBOUND);
+    return std::make_pair(result, false);
 }
 
 void
-PeerManager::store(PeerBareAddress const& address, PeerRecord const& peerRecord,
-                   bool inDatabase)
+PeerManager::store(PeerBareAddress const& address, PeerRecord const& peerRecord)
 {
     ZoneScoped;
-    std::string query;
+    ensureLoaded();
+    putPeer(address, peerRecord);
+    mRemovedPeers.erase(address);
+    mDirtyPeers.insert(address);
+    scheduleFlush();
+}
 
-    if (inDatabase)
-    {
-        query = "UPDATE peers SET "
-                "nextattempt = :v1, "
-                "numfailures = :v2, "
-                "type = :v3 "
-                "WHERE ip = :v4 AND port = :v5";
-    }
-    else
+void
+PeerManager::flush()
+{
+    ZoneScoped;
+    mFlushPending = false;
+    if (mDirtyPeers.empty() && mRemovedPeers.empty())
     {
-        query = "INSERT INTO peers "
-                "(nextattempt, numfailures, type, ip,  port) "
-                "VALUES "
-                "(:v1,         :v2,        :v3,  :v4, :v5)";
+        return;
     }
 
+    auto& db = mApp.getDatabase();
     try
     {
-        auto prep = mApp.getDatabase().getPreparedStatement(
-            query, mApp.getDatabase().getSession());
-        auto& st = prep.statement();
-        st.exchange(use(peerRecord.mNextAttempt));
-        st.exchange(use(peerRecord.mNumFailures));
-        st.exchange(use(peerRecord.mType));
-        std::string ip = address.getIP();
-        st.exchange(use(ip));
-        int port = address.getPort();
-        st.exchange(use(port));
-        st.define_and_bind();
+        soci::transaction tx(db.getRawSession());
+        for (auto const& address : mRemovedPeers)
         {
-            auto timer = mApp.getDatabase().getUpdateTimer("peer");
+            auto prep = db.getPreparedStatement(
+                "DELETE FROM peers WHERE ip = :v1 AND port = :v2",
+                db.getSession());
+            auto& st = prep.statement();
+            std::string ip = address.getIP();
+            st.exchange(use(ip));
+            int port = address.getPort();
+            st.exchange(use(port));
+            st.define_and_bind();
+            auto timer = db.getDeleteTimer("peer");
+            st.execute(true);
+        }
+        for (auto const& address : mDirtyPeers)
+        {
+            auto const& peerRecord = mPeers.at(address);
+            auto prep = db.getPreparedStatement(
+                "INSERT INTO peers "
+                "(nextattempt, numfailures, type, ip,  port) "
+                "VALUES "
+                "(:v1,         :v2,        :v3,  :v4, :v5) "
+                "ON CONFLICT (ip, port) DO UPDATE SET "
+                "nextattempt = excluded.nextattempt, "
+                "numfailures = excluded.numfailures, "
+                "type = excluded.type",
+                db.getSession());
+            auto& st = prep.statement();
+            st.exchange(use(peerRecord.mNextAttempt));
+            st.exchange(use(peerRecord.mNumFailures));
+            st.exchange(use(peerRecord.mType));
+            std::string ip = address.getIP();
+            st.exchange(use(ip));
+            int port = address.getPort();
+            st.exchange(use(port));
+            st.define_and_bind();
+            auto timer = db.getUpsertTimer("peer");
             st.execute(true);
-            if (st.get_affected_rows() != 1)
-            {
-                CLOG_ERROR(Overlay, "PeerManager::store failed on {}",
-                           address.toString());
-            }
         }
+        tx.commit();
     }
     catch (soci_error& err)
     {
-        CLOG_ERROR(Overlay, "PeerManager::store error: {} on {}", err.what(),
-                   address.toString());
+        // Keep the changes, they are written again on the next flush
+        CLOG_ERROR(Overlay, "PeerManager::flush error: {}", err.what());
+        scheduleFlush();
+        return;
     }
+    mDirtyPeers.clear();
+    mRemovedPeers.clear();
 }
 
 void
@@ -417,7 +478,7 @@ PeerManager::ensureExists(PeerBareAddress const& address)
     if (!peer.second)
     {
         CLOG_TRACE(Overlay, "Learned peer {}", address.toString());
-        store(address, peer.first, peer.second);
+        store(address, peer.first);
     }
 }
 
@@ -476,7 +537,7 @@ PeerManager::update(PeerBareAddress const& address, PeerType observedType,
     TypeUpdate typeUpdate =
         getTypeUpdate(peer.first, observedType, preferredTypeKnown);
     update(peer.first, typeUpdate);
-    store(address, peer.first, peer.second);
+    store(address, peer.first);
 }
 
 void
@@ -485,7 +546,7 @@ PeerManager::update(PeerBareAddress const& address, BackOffUpdate backOff)
     ZoneScoped;
     auto peer = load(address);
     update(peer.first, backOff, mApp);
-    store(address, peer.first, peer.second);
+    store(address, peer.first);
 }
 
 void
@@ -498,84 +559,7 @@ PeerManager::update(PeerBareAddress const& address, PeerType observedType,
         getTypeUpdate(peer.first, observedType, preferredTypeKnown);
     update(peer.first, typeUpdate);
     update(peer.first, backOff, mApp);
-    store(address, peer.first, peer.second);
-}
-
-size_t
-PeerManager::countPeers(std::string const& where,
-                        std::function<void(soci::statement&)> const& bind)
-{
-    ZoneScoped;
-    size_t count = 0;
-
-    try
-    {
-        std::string sql = "SELECT COUNT(*) FROM peers WHERE " + where;
-
-        auto prep = mApp.getDatabase().getPreparedStatement(
-            sql, mApp.getDatabase().getSession());
-        auto& st = prep.statement();
-
-        bind(st);
-        st.exchange(into(count));
-
-        st.define_and_bind();
-        st.execute(true);
-    }
-    catch (soci_error& err)
-    {
-        CLOG_ERROR(Overlay, "countPeers error: {}", err.what());
-    }
-
-    return count;
-}
-
-std::vector<PeerBareAddress>
-PeerManager::loadPeers(size_t limit, size_t offset, std::string const& where,
-                       std::function<void(soci::statement&)> const& bind)
-{
-    ZoneScoped;
-    auto result = std::vector<PeerBareAddress>{};
-
-    try
-    {
-        std::string sql = "SELECT ip, port "
-                          "FROM peers WHERE " +
-                          where + " LIMIT :limit OFFSET :offset";
-
-        auto prep = mApp.getDatabase().getPreparedStatement(
-            sql, mApp.getDatabase().getSession());
-        auto& st = prep.statement();
-
-        bind(st);
-        st.exchange(use(limit));
-        st.exchange(use(offset));
-
-        std::string ip;
-        int lport;
-        st.exchange(into(ip));
-        st.exchange(into(lport));
-
-        st.define_and_bind();
-        {
-            auto timer = mApp.getDatabase().getSelectTimer("peer");
-            st.execute(true);
-        }
-        while (st.got_data())
-        {
-            if (!ip.empty() && lport > 0)
-            {
-                result.emplace_back(ip, static_cast<unsigned short>(lport));
-            }
-            st.fetch();
-        }
-    }
-    catch (soci_error& err)
-    {
-        CLOG_ERROR(Overlay, "loadPeers error: {}", err.what());
-    }
-
-    return result;
+    store(address, peer.first);
 }
 
 void
@@ -589,56 +573,18 @@ std::vector<std::pair<PeerBareAddress, PeerRecord>>
 PeerManager::loadAllPeers()
 {
     ZoneScoped;
-    std::vector<std::pair<PeerBareAddress, PeerRecord>> result;
-    std::string sql =
-        "SELECT ip, port, nextattempt, numfailures, type FROM peers";
-
-    try
-    {
-        std::string ip;
-        int port;
-        PeerRecord record;
-
-        auto prep = mApp.getDatabase().getPreparedStatement(
-            sql, mApp.getDatabase().getSession());
-        auto& st = prep.statement();
-
-        st.exchange(into(ip));
-        st.exchange(into(port));
-        st.exchange(into(record.mNextAttempt));
-        st.exchange(into(record.mNumFailures));
-        st.exchange(into(record.mType));
-
-        st.define_and_bind();
-        {
-            auto timer = mApp.getDatabase().getSelectTimer("peer");
-            st.execute(true);
-        }
-        while (st.got_data())
-        {
-            PeerBareAddress pba{ip, static_cast<unsigned short>(port)};
-            result.emplace_back(std::make_pair(pba, record));
-            st.fetch();
-        }
-    }
-    catch (soci_error& err)
-    {
-        CLOG_ERROR(Overlay, "loadPeers error: {}", err.what());
-    }
-
-    return result;
+    ensureLoaded();
+    return {mPeers.begin(), mPeers.end()};
 }
 
 void
 PeerManager::storePeers(
     std::vector<std::pair<PeerBareAddress, PeerRecord>> peers)
 {
-    soci::transaction tx(mApp.getDatabase().getRawSession());
     for (auto const& peer : peers)
     {
-        store(peer.first, peer.second, /* inDatabase */ false);
+        store(peer.first, peer.second);
     }
-    tx.commit();
 }
 
 const char* PeerManager::kSQLCreateStatement =
@@ -7,12 +7,10 @@
 #include "overlay/PeerBareAddress.h"
 #include "util/Timer.h"
 
+#include <array>
 #include <functional>
-
-namespace soci
-{
-class statement;
-}
+#include <map>
+#include <set>
 
 namespace stellar
 {
@@ -58,6 +56,11 @@ PeerAddress toXdr(PeerBareAddress const& address);
 
 /**
  * Maintain list of know peers in database.
+ *
+ * The peers table is loaded into memory on first use and indexed by type and
+ * next attempt time, so that connection management never waits on the
+ * database. Changes are written behind: they are batched and flushed in a
+ * single transaction a few seconds after the first one, and on shutdown.
  */
 class PeerManager
 {
@@ -78,7 +81,11 @@ class PeerManager
 
     static void dropAll(Database& db);
 
+    // How long changes wait in memory before being written to the database
+    static constexpr std::chrono::seconds FLUSH_INTERVAL{5};
+
     explicit PeerManager(Application& app);
+    ~PeerManager();
 
     /**
      * Ensure that given peer is stored in database.
@@ -107,18 +114,17 @@ class PeerManager
                 bool preferredTypeKnown, BackOffUpdate backOff);
 
     /**
-     * Load PeerRecord data for peer with given address. If not available in
-     * database, create default one. Second value in pair is true when data
-     * was loaded from database, false otherwise.
+     * Load PeerRecord data for peer with given address. If not known, create
+     * default one. Second value in pair is true when the peer was known,
+     * false otherwise.
      */
     std::pair<PeerRecord, bool> load(PeerBareAddress const& address);
 
     /**
-     * Store PeerRecord data into database. If inDatabase is true, uses UPDATE
-     * query, uses INSERT otherwise.
+     * Store PeerRecord data, inserting or replacing the peer's record. The
+     * database is updated on the next flush.
      */
-    void store(PeerBareAddress const& address, PeerRecord const& PeerRecord,
-               bool inDatabase);
+    void store(PeerBareAddress const& address, PeerRecord const& PeerRecord);
 
     /**
      * Load size random peers matching query from database.
@@ -140,15 +146,20 @@ class PeerManager
                                                 PeerBareAddress const& address);
 
     /**
-     * Load all peers from the database.
+     * Load all known peers.
      */
     std::vector<std::pair<PeerBareAddress, PeerRecord>> loadAllPeers();
 
     /**
-     * Store peers in the database.
+     * Store peers.
      */
     void storePeers(std::vector<std::pair<PeerBareAddress, PeerRecord>>);
 
+    /**
+     * Write pending changes to the database.
+     */
+    void flush();
+
   private:
     static const char* kSQLCreateStatement;
 
@@ -156,11 +167,24 @@ class PeerManager
     std::unique_ptr<RandomPeerSource> mOutboundPeersToSend;
     std::unique_ptr<RandomPeerSource> mInboundPeersToSend;
 
-    size_t countPeers(std::string const& where,
-                      std::function<void(soci::statement&)> const& bind);
-    std::vector<PeerBareAddress>
-    loadPeers(size_t limit, size_t offset, std::string const& where,
-              std::function<void(soci::statement&)> const& bind);
+    // In-memory copy of the peers table, loaded on first use
+    bool mLoaded{false};
+    std::map<PeerBareAddress, PeerRecord> mPeers;
+    // Peers of each PeerType, ordered by next attempt
+    using AttemptIndex =
+        std::set<std::pair<VirtualClock::system_time_point, PeerBareAddress>>;
+    std::array<AttemptIndex, 3> mPeersByType;
+
+    // Changes not written to the database yet
+    std::set<PeerBareAddress> mDirtyPeers;
+    std::set<PeerBareAddress> mRemovedPeers;
+    VirtualTimer mFlushTimer;
+    bool mFlushPending{false};
+
+    void ensureLoaded();
+    void putPeer(PeerBareAddress const& address, PeerRecord const& peer);
+    void erasePeer(std::map<PeerBareAddress, PeerRecord>::iterator it);
+    void scheduleFlush();
 
     void update(PeerRecord& peer, TypeUpdate type);
     void update(PeerRecord& peer, BackOffUpdate backOff, Application& app);
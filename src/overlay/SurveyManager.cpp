@@ -594,12 +594,12 @@ SurveyManager::processTimeSlicedTopologyResponse(NodeID const& surveyedPeerID,
 
 bool
 SurveyManager::populateSurveyResponseMessage(
-    SurveyRequestMessage const& request, SurveyResponseBody const& body,
-    SurveyResponseMessage& response) const
+    SecretKey const& nodeSeed, SurveyRequestMessage const& request,
+    SurveyResponseBody const& body, SurveyResponseMessage& response)
 {
     response.ledgerNum = request.ledgerNum;
     response.surveyorPeerID = request.surveyorPeerID;
-    response.surveyedPeerID = mApp.getConfig().NODE_SEED.getPublicKey();
+    response.surveyedPeerID = nodeSeed.getPublicKey();
     response.commandType = TIME_SLICED_SURVEY_TOPOLOGY;
 
     try
@@ -615,6 +615,30 @@ SurveyManager::populateSurveyResponseMessage(
     return true;
 }
 
+std::optional<StellarMessage>
+SurveyManager::createTimeSlicedSurveyResponse(
+    SecretKey const& nodeSeed, TimeSlicedSurveyRequestMessage const& request,
+    SurveyResponseBody const& body)
+{
+    StellarMessage newMsg;
+    newMsg.type(TIME_SLICED_SURVEY_RESPONSE);
+    auto& signedResponse = newMsg.signedTimeSlicedSurveyResponseMessage();
+
+    auto& outerResponse = signedResponse.response;
+    outerResponse.nonce = request.nonce;
+
+    auto& innerResponse = outerResponse.response;
+    if (!populateSurveyResponseMessage(nodeSeed, request.request, body,
+                                       innerResponse))
+    {
+        return std::nullopt;
+    }
+
+    auto sigBody = xdr::xdr_to_opaque(outerResponse);
+    signedResponse.responseSignature = nodeSeed.sign(sigBody);
+    return newMsg;
+}
+
 void
 SurveyManager::processTimeSlicedTopologyRequest(
     TimeSlicedSurveyRequestMessage const& request)
@@ -637,23 +661,31 @@ SurveyManager::processTimeSlicedTopologyRequest(
         return;
     }
 
-    StellarMessage newMsg;
-    newMsg.type(TIME_SLICED_SURVEY_RESPONSE);
-    auto& signedResponse = newMsg.signedTimeSlicedSurveyResponseMessage();
-
-    auto& outerResponse = signedResponse.response;
-    outerResponse.nonce = request.nonce;
-
-    auto& innerResponse = outerResponse.response;
-    if (!populateSurveyResponseMessage(request.request, body, innerResponse))
-    {
-        return;
-    }
-
-    auto sigBody = xdr::xdr_to_opaque(outerResponse);
-    signedResponse.responseSignature = mApp.getConfig().NODE_SEED.sign(sigBody);
-
-    broadcast(newMsg);
+    // The survey data is frozen for the reporting phase, so only the
+    // encryption and signature are left, which a busy hub answering many
+    // requests would rather not spend main thread time on. The config
+    // outlives the worker threads.
+    std::weak_ptr<SurveyManager> weak = shared_from_this();
+    auto const& nodeSeed = mApp.getConfig().NODE_SEED;
+    auto& app = mApp;
+    mApp.postOnBackgroundThread(
+        [weak, &app, &nodeSeed, request, body = std::move(body)]() {
+            auto msg = createTimeSlicedSurveyResponse(nodeSeed, request, body);
+            if (!msg)
+            {
+                return;
+            }
+            app.postOnMainThread(
+                [weak, msg = std::move(*msg)]() {
+                    auto self = weak.lock();
+                    if (self)
+                    {
+                        self->broadcast(msg);
+                    }
+                },
+                "SurveyManager: broadcast response");
+        },
+        "SurveyManager: seal response", BackgroundWorkClass::SCP);
 }
 
 void
@@ -94,14 +94,28 @@ class SurveyManager : public std::enable_shared_from_this<SurveyManager>,
     void sendTopologyRequest(NodeID const& nodeToSurvey);
     void processTimeSlicedTopologyResponse(NodeID const& surveyedPeerID,
                                            SurveyResponseBody const& body);
+    // Fills in the response to `request` on the main thread, then encrypts
+    // and signs it on a background thread and broadcasts it back on the main
+    // thread
     void processTimeSlicedTopologyRequest(
         TimeSlicedSurveyRequestMessage const& request);
 
-    // Populate `response` with the data from the other parameters.  Returns
-    // `false` on encryption failure.
-    bool populateSurveyResponseMessage(SurveyRequestMessage const& request,
-                                       SurveyResponseBody const& body,
-                                       SurveyResponseMessage& response) const;
+    // Populate `response` with the data from the other parameters, as the
+    // node of `nodeSeed`. Returns `false` on encryption failure. This is
+    // threadsafe.
+    static bool
+    populateSurveyResponseMessage(SecretKey const& nodeSeed,
+                                  SurveyRequestMessage const& request,
+                                  SurveyResponseBody const& body,
+                                  SurveyResponseMessage& response);
+
+    // Builds the signed response of the node of `nodeSeed` to `request`.
+    // Returns `nullopt` on encryption failure. This is threadsafe.
+    static std::optional<StellarMessage>
+    createTimeSlicedSurveyResponse(
+        SecretKey const& nodeSeed,
+        TimeSlicedSurveyRequestMessage const& request,
+        SurveyResponseBody const& body);
 
     // Populate `request` with the data from the other parameters
     void populateSurveyRequestMessage(NodeID const& nodeToSurvey,
@@ -8,11 +8,14 @@
 #include "main/Application.h"
 #include "main/Config.h"
 #include "main/ErrorMessages.h"
+#include "medida/histogram.h"
 #include "medida/meter.h"
 #include "overlay/FlowControl.h"
+#include "overlay/MessageCompression.h"
 #include "overlay/OverlayManager.h"
 #include "overlay/OverlayMetrics.h"
 #include "util/GlobalChecks.h"
+#include "util/HdrHistogram.h"
 #include "util/LogSlowExecution.h"
 #include "util/Logging.h"
 #include "xdrpp/marshal.h"
@@ -45,6 +48,11 @@ TCPPeer::TCPPeer(Application& app, Peer::PeerRole role,
     {
         (*mLiveInboundPeersCounter)++;
     }
+    if (useBackgroundThread())
+    {
+        mOverlayIOContext = &static_cast<asio::io_context&>(
+            asio::query(mSocket->get_executor(), asio::execution::context));
+    }
 }
 
 TCPPeer::pointer
@@ -177,7 +185,7 @@ TCPPeer::accept(Application& app, shared_ptr<TCPPeer::SocketType> socket)
                         result->startRead();
                     }
                 },
-                "TCPPeer::accept startRead");
+                "TCPPeer::accept startRead", result->mOverlayIOContext);
         }
         else
         {
@@ -224,11 +232,13 @@ TCPPeer::~TCPPeer()
 
 void
 TCPPeer::sendMessage(xdr::msg_ptr&& xdrBytes,
-                     std::shared_ptr<StellarMessage const> msgPtr)
+                     std::shared_ptr<StellarMessage const> msgPtr,
+                     VirtualClock::time_point queuedTime)
 {
     releaseAssert(!threadIsMain() || !useBackgroundThread());
 
     TimestampedMessage msg;
+    msg.mQueuedTime = queuedTime;
     msg.mEnqueuedTime = mAppConnector.now();
     msg.mMessage = std::move(xdrBytes);
     msg.mMsgPtr = msgPtr;
@@ -311,21 +321,33 @@ TCPPeer::messageSender()
     // completed, at which point we'll clear mWriteBuffers and remove the entire
     // snapshot worth of corresponding messages from mWriteQueue (though it may
     // have grown a bit in the meantime -- we remove only a prefix).
+    //
+    // asio hands at most 64 buffers to each writev, so a batch of small flood
+    // messages referenced in place would still take a syscall per 64 of them.
+    // Runs of messages up to COALESCE_MAX_MESSAGE_SIZE are therefore copied
+    // into mWriteCoalesced and covered by a single buffer each, while larger
+    // messages are written from where they are.
     releaseAssert(mThreadVars.getWriteBuffers().empty());
-    auto now = mAppConnector.now();
+    auto& queue = mThreadVars.getWriteQueue();
+    auto& buffers = mThreadVars.getWriteBuffers();
+    auto& coalesced = mThreadVars.getWriteCoalesced();
+    releaseAssert(coalesced.empty());
     size_t expected_length = 0;
+    size_t coalescedLength = 0;
+    size_t numMessages = 0;
     size_t maxQueueSize = mAppConnector.getConfig().MAX_BATCH_WRITE_COUNT;
     releaseAssert(maxQueueSize > 0);
     size_t const maxTotalBytes =
         mAppConnector.getConfig().MAX_BATCH_WRITE_BYTES;
-    for (auto& tsm : mThreadVars.getWriteQueue())
+    for (auto const& tsm : queue)
     {
-        tsm.mIssuedTime = now;
         size_t sz = tsm.mMessage->raw_size();
-        mThreadVars.getWriteBuffers().emplace_back(tsm.mMessage->raw_data(),
-                                                   sz);
         expected_length += sz;
-        mEnqueueTimeOfLastWrite = tsm.mEnqueuedTime;
+        if (sz <= COALESCE_MAX_MESSAGE_SIZE)
+        {
+            coalescedLength += sz;
+        }
+        ++numMessages;
         // check if we reached any limit
         if (expected_length >= maxTotalBytes)
             break;
@@ -333,16 +355,51 @@ TCPPeer::messageSender()
             break;
     }
 
-    CLOG_DEBUG(Overlay, "messageSender {} - b:{} n:{}/{}", mIPAddress,
-               expected_length, mThreadVars.getWriteBuffers().size(),
-               mThreadVars.getWriteQueue().size());
+    // buffers point into coalesced, which must not reallocate below
+    coalesced.reserve(coalescedLength);
+    auto now = mAppConnector.now();
+    bool lastCoalesced = false;
+    for (size_t i = 0; i < numMessages; ++i)
+    {
+        auto& tsm = queue[i];
+        tsm.mIssuedTime = now;
+        char const* data = tsm.mMessage->raw_data();
+        size_t sz = tsm.mMessage->raw_size();
+        if (sz > COALESCE_MAX_MESSAGE_SIZE)
+        {
+            buffers.emplace_back(data, sz);
+            lastCoalesced = false;
+        }
+        else
+        {
+            auto start = coalesced.size();
+            coalesced.insert(coalesced.end(), data, data + sz);
+            if (lastCoalesced)
+            {
+                buffers.back() = asio::const_buffer(buffers.back().data(),
+                                                    buffers.back().size() + sz);
+            }
+            else
+            {
+                buffers.emplace_back(coalesced.data() + start, sz);
+            }
+            lastCoalesced = true;
+        }
+        mEnqueueTimeOfLastWrite = tsm.mEnqueuedTime;
+    }
+
+    CLOG_DEBUG(Overlay, "messageSender {} - b:{} n:{}/{} buffers:{}",
+               mIPAddress, expected_length, numMessages, queue.size(),
+               buffers.size());
     mOverlayMetrics.mAsyncWrite.Mark();
+    mOverlayMetrics.mAsyncWriteMessages.Update(numMessages);
+    mOverlayMetrics.mAsyncWriteBuffers.Update(buffers.size());
     mPeerMetrics.mAsyncWrite++;
     auto self = static_pointer_cast<TCPPeer>(shared_from_this());
     asio::async_write(
-        *(mSocket.get()), mThreadVars.getWriteBuffers(),
-        [self, expected_length](asio::error_code const& ec,
-                                std::size_t length) {
+        *(mSocket.get()), buffers,
+        [self, expected_length, numMessages](asio::error_code const& ec,
+                                             std::size_t length) {
             releaseAssert(!threadIsMain() || !self->useBackgroundThread());
             if (expected_length != length)
             {
@@ -350,11 +407,10 @@ TCPPeer::messageSender()
                            Peer::DropDirection::WE_DROPPED_REMOTE);
                 return;
             }
-            self->writeHandler(ec, length,
-                               self->mThreadVars.getWriteBuffers().size());
+            self->writeHandler(ec, length, numMessages);
 
             // Walk through a _prefix_ of the write queue
-            // _corresponding_ to the write buffers we just sent.
+            // _corresponding_ to the messages we just sent.
             // While walking, record the sent-time in metrics, but
             // also advance iterator 'i' so we wind up with an
             // iterator range to erase from the front of the write
@@ -362,7 +418,7 @@ TCPPeer::messageSender()
             auto now = self->mAppConnector.now();
             auto i = self->mThreadVars.getWriteQueue().begin();
             FloodQueues<ConstStellarMessagePtr> sentMessages{};
-            while (!self->mThreadVars.getWriteBuffers().empty())
+            for (size_t n = 0; n < numMessages; ++n)
             {
                 i->mCompletedTime = now;
                 i->recordWriteTiming(self->mOverlayMetrics, self->mPeerMetrics);
@@ -373,7 +429,19 @@ TCPPeer::messageSender()
                         .emplace_back(i->mMsgPtr);
                 }
                 ++i;
-                self->mThreadVars.getWriteBuffers().pop_back();
+            }
+            self->mThreadVars.getWriteBuffers().clear();
+
+            // Keep the coalescing buffer around for the next batch, unless a
+            // large burst grew it
+            auto& coalesced = self->mThreadVars.getWriteCoalesced();
+            if (coalesced.capacity() > BUFSZ)
+            {
+                std::vector<char>().swap(coalesced);
+            }
+            else
+            {
+                coalesced.clear();
             }
 
             // Erase the messages from the write queue that we
@@ -404,6 +472,13 @@ TCPPeer::TimestampedMessage::recordWriteTiming(OverlayMetrics& metrics,
     metrics.mMessageDelayInAsyncWriteTimer.Update(wdelay);
     peerMetrics.mMessageDelayInWriteQueueTimer.Update(qdelay);
     peerMetrics.mMessageDelayInAsyncWriteTimer.Update(wdelay);
+
+    auto sendDelay = mCompletedTime - mQueuedTime;
+    if (mMsgPtr)
+    {
+        metrics.getSendDelayTimer(mMsgPtr->type()).Update(sendDelay);
+    }
+    peerMetrics.mSendDelayTimer.Update(sendDelay);
 }
 
 void
@@ -525,7 +600,7 @@ TCPPeer::scheduleRead()
 
     if (useBackgroundThread())
     {
-        mAppConnector.postOnOverlayThread(cb, taskName);
+        mAppConnector.postOnOverlayThread(cb, taskName, mOverlayIOContext);
     }
     else
     {
@@ -664,7 +739,8 @@ TCPPeer::getIncomingMsgLength()
     auto const& header = mThreadVars.getIncomingHeader();
     releaseAssert(header.size() == HDRSZ);
     size_t length = static_cast<size_t>(header[0]);
-    length &= 0x7f; // clear the XDR 'continuation' bit
+    // clear the XDR 'continuation' bit and the compression flag
+    length &= 0x7f & ~(MessageCompression::COMPRESSED_FRAME_FLAG >> 24);
     length <<= 8;
     length |= header[1];
     length <<= 8;
@@ -771,9 +847,15 @@ TCPPeer::recvMessage()
 
     try
     {
-        xdr::xdr_get g(mThreadVars.getIncomingBody().data(),
-                       mThreadVars.getIncomingBody().data() +
-                           mThreadVars.getIncomingBody().size());
+        auto const* body = &mThreadVars.getIncomingBody();
+        std::vector<uint8_t> decompressed;
+        if (MessageCompression::isCompressedFrame(
+                mThreadVars.getIncomingHeader().data()))
+        {
+            decompressed = decompressFrame(body->data(), body->size());
+            body = &decompressed;
+        }
+        xdr::xdr_get g(body->data(), body->data() + body->size());
         AuthenticatedMessage am;
         xdr::xdr_argpack_archive(g, am);
 
@@ -790,6 +872,12 @@ TCPPeer::recvMessage()
         CLOG_ERROR(Overlay, "{} - Crypto error: {}", mIPAddress, e.what());
         errorMsg = "crypto error";
     }
+    catch (CompressionError const& e)
+    {
+        CLOG_ERROR(Overlay, "{} - recvMessage got a bad compressed message: {}",
+                   mIPAddress, e.what());
+        errorMsg = e.what();
+    }
 
     if (!errorMsg.empty())
     {
@@ -24,6 +24,9 @@ class TCPPeer : public Peer
   public:
     typedef asio::buffered_read_stream<asio::ip::tcp::socket> SocketType;
     static constexpr size_t BUFSZ = 0x40000; // 256KB
+    // Outbound messages up to this size are copied into a shared buffer
+    // rather than written in place, see messageSender
+    static constexpr size_t COALESCE_MAX_MESSAGE_SIZE = 0x1000; // 4KB
 
   private:
     // Helper class which provides invariance for various data structures;
@@ -32,6 +35,7 @@ class TCPPeer : public Peer
     {
         std::deque<TimestampedMessage> mWriteQueue;
         std::vector<asio::const_buffer> mWriteBuffers;
+        std::vector<char> mWriteCoalesced;
         bool const mUseBackgroundThread;
         bool mWriting{false};
         std::vector<uint8_t> mIncomingHeader;
@@ -54,6 +58,12 @@ class TCPPeer : public Peer
             releaseAssert(!threadIsMain() || !mUseBackgroundThread);
             return mWriteBuffers;
         }
+        std::vector<char>&
+        getWriteCoalesced()
+        {
+            releaseAssert(!threadIsMain() || !mUseBackgroundThread);
+            return mWriteCoalesced;
+        }
         std::vector<uint8_t>&
         getIncomingHeader()
         {
@@ -90,7 +100,8 @@ class TCPPeer : public Peer
 
     bool recvMessage();
     void sendMessage(xdr::msg_ptr&& xdrBytes,
-                     std::shared_ptr<StellarMessage const> msgPtr) override;
+                     std::shared_ptr<StellarMessage const> msgPtr,
+                     VirtualClock::time_point queuedTime) override;
 
     void messageSender();
 
@@ -15,21 +15,28 @@
 #include "util/Logging.h"
 #include "util/Math.h"
 #include <Tracy.hpp>
+#include <algorithm>
 
 namespace stellar
 {
 
 std::chrono::milliseconds const Tracker::MS_TO_WAIT_FOR_FETCH_REPLY{1500};
 int const Tracker::MAX_REBUILD_FETCH_LIST = 10;
+std::chrono::milliseconds const Tracker::MIN_HEDGE_DELAY{200};
+std::chrono::milliseconds const Tracker::MAX_HEDGE_DELAY{750};
 
-Tracker::Tracker(Application& app, Hash const& hash, AskPeer& askPeer)
+Tracker::Tracker(Application& app, Hash const& hash, AskPeer& askPeer,
+                 bool hedgeRequests)
     : mAskPeer(askPeer)
     , mApp(app)
+    , mHedgeRequests(hedgeRequests)
     , mNumListRebuild(0)
     , mTimer(app)
+    , mHedgeTimer(app)
     , mItemHash(hash)
     , mTryNextPeer(
           app.getOverlayManager().getOverlayMetrics().mItemFetcherNextPeer)
+    , mHedge(app.getOverlayManager().getOverlayMetrics().mItemFetcherHedge)
     , mFetchTime("fetch-" + hexAbbrev(hash), LogSlowExecution::Mode::MANUAL)
 {
     releaseAssert(mAskPeer);
@@ -72,7 +79,9 @@ Tracker::clearEnvelopesBelow(uint64 slotIndex, uint64 slotToKeep)
     }
 
     mTimer.cancel();
+    mHedgeTimer.cancel();
     mLastAskedPeer = nullptr;
+    mHedgePeer = nullptr;
 
     return false;
 }
@@ -80,28 +89,41 @@ Tracker::clearEnvelopesBelow(uint64 slotIndex, uint64 slotToKeep)
 void
 Tracker::doesntHave(Peer::pointer peer)
 {
-    if (mLastAskedPeer == peer)
+    if (mHedgePeer && mHedgePeer == peer)
+    {
+        CLOG_TRACE(Overlay, "Hedge peer does not have {}",
+                   hexAbbrev(mItemHash));
+        mHedgePeer.reset();
+    }
+    else if (mLastAskedPeer && mLastAskedPeer == peer)
     {
         CLOG_TRACE(Overlay, "Does not have {}", hexAbbrev(mItemHash));
-        tryNextPeer();
+        if (mHedgePeer)
+        {
+            // The hedge request is still outstanding, keep waiting for it
+            // until the current timeout
+            mLastAskedPeer = std::move(mHedgePeer);
+            mHedgePeer.reset();
+        }
+        else
+        {
+            tryNextPeer();
+        }
     }
 }
 
-void
-Tracker::tryNextPeer()
+std::chrono::milliseconds
+Tracker::getHedgeDelay(std::chrono::milliseconds ping)
 {
-    ZoneScoped;
-    // will be called by some timer or when we get a
-    // response saying they don't have it
-    CLOG_TRACE(Overlay, "tryNextPeer {} last: {}", hexAbbrev(mItemHash),
-               (mLastAskedPeer ? mLastAskedPeer->toString() : "<none>"));
-
-    if (mLastAskedPeer)
-    {
-        mTryNextPeer.Mark();
-        mLastAskedPeer.reset();
-    }
+    // A healthy peer answers in a little over one round trip; give it a few
+    // before paying for a duplicate request
+    return std::clamp(ping * 3, MIN_HEDGE_DELAY, MAX_HEDGE_DELAY);
+}
 
+Peer::pointer
+Tracker::pickNextPeer(bool& peerWithEnvelope)
+{
+    ZoneScoped;
     // canAskPeer is best effort and send happens asynchronously; in the worst
     // case, we'll place something in the queue that will subsequently be
     // discarded due to a peer drop.
@@ -165,8 +187,8 @@ Tracker::tryNextPeer()
         }
     }
 
-    bool peerWithEnvelopeSelected = !newPeersWithEnvelope.empty();
-    if (peerWithEnvelopeSelected)
+    peerWithEnvelope = !newPeersWithEnvelope.empty();
+    if (peerWithEnvelope)
     {
         procPeers(newPeersWithEnvelope, true);
     }
@@ -180,10 +202,33 @@ Tracker::tryNextPeer()
     }
 
     // pick a random element from the candidate list
-    if (!candidates.empty())
+    if (candidates.empty())
     {
-        mLastAskedPeer = rand_element(candidates);
+        return nullptr;
     }
+    return rand_element(candidates);
+}
+
+void
+Tracker::tryNextPeer()
+{
+    ZoneScoped;
+    // will be called by some timer or when we get a
+    // response saying they don't have it
+    CLOG_TRACE(Overlay, "tryNextPeer {} last: {}", hexAbbrev(mItemHash),
+               (mLastAskedPeer ? mLastAskedPeer->toString() : "<none>"));
+
+    if (mLastAskedPeer)
+    {
+        mTryNextPeer.Mark();
+        mLastAskedPeer.reset();
+    }
+    // a hedge request still outstanding at this point timed out as well
+    mHedgeTimer.cancel();
+    mHedgePeer.reset();
+
+    bool peerWithEnvelopeSelected = false;
+    mLastAskedPeer = pickNextPeer(peerWithEnvelopeSelected);
 
     std::chrono::milliseconds nextTry;
     if (!mLastAskedPeer)
@@ -206,6 +251,14 @@ Tracker::tryNextPeer()
                    mLastAskedPeer->toString());
         mAskPeer(mLastAskedPeer, mItemHash);
         nextTry = MS_TO_WAIT_FOR_FETCH_REPLY;
+
+        if (mHedgeRequests)
+        {
+            mHedgeTimer.expires_from_now(
+                getHedgeDelay(mLastAskedPeer->getPing()));
+            mHedgeTimer.async_wait([this]() { this->hedge(); },
+                                   VirtualTimer::onFailureNoop);
+        }
     }
 
     mTimer.expires_from_now(nextTry);
@@ -213,6 +266,34 @@ Tracker::tryNextPeer()
                       VirtualTimer::onFailureNoop);
 }
 
+void
+Tracker::hedge()
+{
+    ZoneScoped;
+    if (!mLastAskedPeer || mHedgePeer)
+    {
+        return;
+    }
+
+    bool peerWithEnvelope = false;
+    auto peer = pickNextPeer(peerWithEnvelope);
+    if (!peer)
+    {
+        CLOG_TRACE(Overlay, "No peer to hedge {} with", hexAbbrev(mItemHash));
+        return;
+    }
+
+    // Whichever of the two replies first wins; the late reply is dropped
+    // once the item is no longer tracked
+    mHedgePeer = peer;
+    mPeersAsked[mHedgePeer] = peerWithEnvelope;
+    mHedge.Mark();
+    CLOG_TRACE(Overlay, "Hedging {} with {} (waiting on {})",
+               hexAbbrev(mItemHash), mHedgePeer->toString(),
+               mLastAskedPeer->toString());
+    mAskPeer(mHedgePeer, mItemHash);
+}
+
 static std::function<bool(std::pair<Hash, SCPEnvelope> const&)>
 matchEnvelope(SCPEnvelope const& env)
 {
@@ -262,6 +343,8 @@ void
 Tracker::cancel()
 {
     mTimer.cancel();
+    mHedgeTimer.cancel();
+    mHedgePeer.reset();
     mLastSeenSlotIndex = 0;
 }
 
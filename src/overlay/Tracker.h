@@ -14,6 +14,11 @@
  *
  * For asking a AskPeer delegate is used.
  *
+ * When created with hedging enabled, Tracker does not wait for the full
+ * timeout on a slow peer: after a short delay derived from that peer's ping it
+ * asks a second, low latency peer for the same data. Whichever reply arrives
+ * first resolves the item, the other one is ignored.
+ *
  * Tracker keeps list of envelopes that requires given data set to be
  * fully resolved. When data is received each envelope is resend to Herder
  * so it can check if it has all required data and then process envelope.
@@ -43,25 +48,46 @@ class Tracker
     AskPeer mAskPeer;
     Application& mApp;
     Peer::pointer mLastAskedPeer;
+    // second peer asked while mLastAskedPeer is still outstanding
+    Peer::pointer mHedgePeer;
+    bool const mHedgeRequests;
     int mNumListRebuild;
     // keep track of which peer we asked, and if we thought if it had the data
     // or not at the time
     std::map<Peer::pointer, bool> mPeersAsked;
     VirtualTimer mTimer;
+    VirtualTimer mHedgeTimer;
     std::vector<std::pair<Hash, SCPEnvelope>> mWaitingEnvelopes;
     Hash mItemHash;
     medida::Meter& mTryNextPeer;
+    medida::Meter& mHedge;
     uint64 mLastSeenSlotIndex{0};
     LogSlowExecution mFetchTime;
 
+    /**
+     * Pick a peer that was not asked yet, preferring peers that know about
+     * the item and then peers with the lowest latency. Sets
+     * @p peerWithEnvelope if the returned peer is known to have the item.
+     */
+    Peer::pointer pickNextPeer(bool& peerWithEnvelope);
+
+    /**
+     * Ask one more peer while the last asked peer has not replied yet.
+     */
+    void hedge();
+
   public:
     static std::chrono::milliseconds const MS_TO_WAIT_FOR_FETCH_REPLY;
     static int const MAX_REBUILD_FETCH_LIST;
+    static std::chrono::milliseconds const MIN_HEDGE_DELAY;
+    static std::chrono::milliseconds const MAX_HEDGE_DELAY;
     /**
      * Create Tracker that tracks data identified by @p hash. @p askPeer
-     * delegate is used to fetch the data.
+     * delegate is used to fetch the data. If @p hedgeRequests is set, a
+     * second peer is asked when the first one is slow to reply.
      */
-    explicit Tracker(Application& app, Hash const& hash, AskPeer& askPeer);
+    explicit Tracker(Application& app, Hash const& hash, AskPeer& askPeer,
+                     bool hedgeRequests = false);
     virtual ~Tracker();
 
     /**
@@ -122,7 +148,7 @@ class Tracker
     void discard(const SCPEnvelope& env);
 
     /**
-     * Stop the timer, stop requesting the item as we have it.
+     * Stop the timers, stop requesting the item as we have it.
      */
     void cancel();
 
@@ -156,12 +182,25 @@ class Tracker
         mLastSeenSlotIndex = 0;
     }
 
+    /**
+     * Delay before asking a second peer, given the ping of the first one.
+     */
+    static std::chrono::milliseconds
+    getHedgeDelay(std::chrono::milliseconds ping);
+
 #ifdef BUILD_TESTS
     Peer::pointer
     getLastAskedPeer()
     {
         return mLastAskedPeer;
     }
+
+    Peer::pointer
+    getHedgePeer()
+    {
+        return mHedgePeer;
+    }
+
 #endif
 };
 }
@@ -21,6 +21,15 @@ TxAdverts::TxAdverts(Application& app)
 void
 TxAdverts::flushAdvert()
 {
+    // Hashes are queued as soon as we learn about a transaction, so the peer
+    // often advertises the same transaction to us before the batch goes out.
+    // It already has those, don't send them back.
+    mOutgoingTxHashes.erase(std::remove_if(mOutgoingTxHashes.begin(),
+                                           mOutgoingTxHashes.end(),
+                                           [this](Hash const& hash) {
+                                               return seenAdvert(hash);
+                                           }),
+                            mOutgoingTxHashes.end());
     if (mOutgoingTxHashes.size() > 0)
     {
         auto msg = std::make_shared<StellarMessage>();
@@ -24,6 +24,10 @@ namespace stellar
 // longer than 2 seconds between re-issuing demands.
 constexpr std::chrono::seconds MAX_DELAY_DEMAND{2};
 
+// When a peer's latency is known, wait this many times its average latency
+// before demanding from someone else
+constexpr int RETRY_LATENCY_MULTIPLIER = 3;
+
 TxDemandsManager::TxDemandsManager(Application& app)
     : mApp(app), mDemandTimer(app)
 {
@@ -67,6 +71,43 @@ TxDemandsManager::retryDelayDemand(int numAttemptsMade) const
     return std::min(res, std::chrono::milliseconds(MAX_DELAY_DEMAND));
 }
 
+std::chrono::milliseconds
+TxDemandsManager::retryDelayDemand(int numAttemptsMade, Peer::pointer peer)
+{
+    // The delay always grows with the number of attempts, as in the linear
+    // backoff, so a transaction nobody has is not demanded too often
+    auto res = retryDelayDemand(numAttemptsMade + 1);
+    auto latency = peer->getDemandStats().getLatency();
+    if (latency)
+    {
+        auto adaptive = std::max(RETRY_LATENCY_MULTIPLIER * *latency,
+                                 mApp.getConfig().FLOOD_DEMAND_PERIOD_MS);
+        res = std::min(res, adaptive * (numAttemptsMade + 1));
+    }
+    return res;
+}
+
+void
+TxDemandsManager::sortByDemandScore(std::vector<Peer::pointer>& peers)
+{
+    auto defaultLatency = mApp.getConfig().FLOOD_DEMAND_BACKOFF_DELAY_MS;
+    std::vector<std::pair<double, Peer::pointer>> scored;
+    scored.reserve(peers.size());
+    for (auto& peer : peers)
+    {
+        scored.emplace_back(peer->getDemandStats().getScore(defaultLatency),
+                            std::move(peer));
+    }
+    // Stable, so peers with the same score keep their random order
+    std::stable_sort(
+        scored.begin(), scored.end(),
+        [](auto const& a, auto const& b) { return a.first < b.first; });
+    for (size_t i = 0; i < peers.size(); ++i)
+    {
+        peers[i] = std::move(scored[i].second);
+    }
+}
+
 TxDemandsManager::DemandStatus
 TxDemandsManager::demandStatus(Hash const& txHash, Peer::pointer peer) const
 {
@@ -93,8 +134,7 @@ TxDemandsManager::demandStatus(Hash const& txHash, Peer::pointer peer) const
     if (numDemanded < MAX_RETRY_COUNT)
     {
         // Check if it's been a while since our last demand
-        if ((mApp.getClock().now() - lastDemanded) >=
-            retryDelayDemand(numDemanded))
+        if ((mApp.getClock().now() - lastDemanded) >= it->second.retryDelay)
         {
             return DemandStatus::DEMAND;
         }
@@ -154,8 +194,11 @@ TxDemandsManager::demand()
     }
 
     // We randomize peers here to avoid biasing demand pressure to any one
-    // particular peer
+    // particular peer, then let the peers that answer fastest go first: a
+    // transaction advertised by several peers is demanded from the one
+    // expected to deliver it soonest.
     auto peers = mApp.getOverlayManager().getRandomAuthenticatedPeers();
+    sortByDemandScore(peers);
 
     UnorderedMap<Peer::pointer, std::pair<TxDemandVector, std::list<Hash>>>
         demandMap;
@@ -193,10 +236,21 @@ TxDemandsManager::demand()
                     {
                         om.mDemandTimeouts.Mark();
                         ++(peer->getPeerMetrics().mDemandTimeouts);
+                        auto lastPeer =
+                            mDemandHistoryMap[txHash].lastPeer.lock();
+                        if (lastPeer)
+                        {
+                            lastPeer->getDemandStats().recordTimeout();
+                        }
+                    }
+                    {
+                        auto& history = mDemandHistoryMap[txHash];
+                        history.retryDelay = retryDelayDemand(
+                            static_cast<int>(history.peers.size()), peer);
+                        history.peers.emplace(peer->getPeerID(), now);
+                        history.lastDemanded = now;
+                        history.lastPeer = peer;
                     }
-                    mDemandHistoryMap[txHash].peers.emplace(peer->getPeerID(),
-                                                            now);
-                    mDemandHistoryMap[txHash].lastDemanded = now;
                     addedNewDemand = true;
                     break;
                 case DemandStatus::RETRY_LATER:
@@ -256,6 +310,7 @@ TxDemandsManager::recordTxPullLatency(Hash const& hash,
             auto delta = now - peerIt->second;
             om.mPeerTxPullLatency.Update(delta);
             peer->getPeerMetrics().mPullLatency.Update(delta);
+            peer->getDemandStats().recordFulfilled(delta);
             CLOG_DEBUG(
                 Overlay,
                 "Pulled transaction {} in {} milliseconds from peer {}",
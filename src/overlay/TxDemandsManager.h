@@ -48,6 +48,10 @@ class TxDemandsManager : private NonMovableOrCopyable
         VirtualClock::time_point firstDemanded;
         VirtualClock::time_point lastDemanded;
         UnorderedMap<NodeID, VirtualClock::time_point> peers;
+        // Peer demanded last, and how long to wait for it before demanding
+        // from someone else
+        std::weak_ptr<Peer> lastPeer;
+        std::chrono::milliseconds retryDelay{0};
         bool latencyRecorded{false};
     };
     enum class DemandStatus
@@ -77,5 +81,15 @@ class TxDemandsManager : private NonMovableOrCopyable
 
     // Compute delay between demand retries, with linear backoff
     std::chrono::milliseconds retryDelayDemand(int numAttemptsMade) const;
+
+    // Compute how long to wait for `peer` to answer a demand after
+    // `numAttemptsMade` earlier attempts: the linear backoff, shortened
+    // for peers known to answer quickly
+    std::chrono::milliseconds retryDelayDemand(int numAttemptsMade,
+                                               Peer::pointer peer);
+
+    // Order peers so that the ones expected to deliver soonest are demanded
+    // from first
+    void sortByDemandScore(std::vector<Peer::pointer>& peers);
 };
 }
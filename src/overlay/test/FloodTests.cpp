@@ -11,10 +11,12 @@
 #include "ledger/LedgerTxnEntry.h"
 #include "main/Application.h"
 #include "main/Config.h"
+#include "overlay/Floodgate.h"
 #include "overlay/OverlayManager.h"
 #include "overlay/OverlayMetrics.h"
 #include "overlay/PeerDoor.h"
 #include "overlay/TCPPeer.h"
+#include "overlay/test/LoopbackPeer.h"
 #include "overlay/test/OverlayTestUtils.h"
 #include "simulation/Simulation.h"
 #include "simulation/Topologies.h"
@@ -559,4 +561,73 @@ TEST_CASE("Flooding", "[flood][overlay][acceptance]")
         }
     }
 }
+
+TEST_CASE("floodgate records", "[flood][overlay]")
+{
+    VirtualClock clock;
+    auto cfg = getTestConfig(0);
+    cfg.FLOOD_RECORD_LIMIT = 3;
+    auto app = createTestApplication(clock, cfg);
+    auto app1 = createTestApplication(clock, getTestConfig(1));
+    auto app2 = createTestApplication(clock, getTestConfig(2));
+
+    LoopbackPeerConnection conn1(*app, *app1);
+    LoopbackPeerConnection conn2(*app, *app2);
+    testutil::crankSome(clock);
+    Peer::pointer p1 = conn1.getInitiator();
+    Peer::pointer p2 = conn2.getInitiator();
+    REQUIRE(p1->isAuthenticatedForTesting());
+    REQUIRE(p2->isAuthenticatedForTesting());
+
+    Floodgate gate(*app);
+    auto getHash = [](int i) { return sha256(std::to_string(i)); };
+    using PeerSet = std::set<Peer::pointer>;
+
+    REQUIRE(gate.addRecord(p1, getHash(0)));
+    REQUIRE(!gate.addRecord(p2, getHash(0)));
+    REQUIRE(!gate.addRecord(p1, getHash(0)));
+    REQUIRE(gate.addRecord(p2, getHash(1)));
+    REQUIRE(gate.getPeersKnows(getHash(0)) == PeerSet{p1, p2});
+    REQUIRE(gate.getPeersKnows(getHash(1)) == PeerSet{p2});
+    REQUIRE(gate.getPeersKnows(getHash(2)).empty());
+
+    SECTION("oldest records are evicted past the limit")
+    {
+        REQUIRE(gate.addRecord(p1, getHash(2)));
+        REQUIRE(gate.addRecord(p1, getHash(3)));
+        REQUIRE(gate.getPeersKnows(getHash(0)).empty());
+        REQUIRE(gate.getPeersKnows(getHash(1)) == PeerSet{p2});
+        REQUIRE(gate.getPeersKnows(getHash(3)) == PeerSet{p1});
+
+        // An evicted message looks new again
+        REQUIRE(gate.addRecord(p2, getHash(0)));
+        REQUIRE(gate.getPeersKnows(getHash(0)) == PeerSet{p2});
+        REQUIRE(gate.getPeersKnows(getHash(1)).empty());
+    }
+    SECTION("forget and clear")
+    {
+        gate.forgetRecord(getHash(0));
+        REQUIRE(gate.getPeersKnows(getHash(0)).empty());
+        REQUIRE(gate.addRecord(p2, getHash(0)));
+        REQUIRE(gate.getPeersKnows(getHash(0)) == PeerSet{p2});
+
+        auto ledgerSeq = app->getHerder().trackingConsensusLedgerIndex();
+        gate.clearBelow(ledgerSeq);
+        REQUIRE(gate.getPeersKnows(getHash(1)) == PeerSet{p2});
+
+        gate.clearBelow(ledgerSeq + 1);
+        REQUIRE(gate.getPeersKnows(getHash(0)).empty());
+        REQUIRE(gate.getPeersKnows(getHash(1)).empty());
+
+        // Peer slots were recycled, and must not leak into new records
+        REQUIRE(gate.addRecord(p2, getHash(1)));
+        REQUIRE(gate.getPeersKnows(getHash(1)) == PeerSet{p2});
+        REQUIRE(!gate.addRecord(p1, getHash(1)));
+        REQUIRE(gate.getPeersKnows(getHash(1)) == PeerSet{p1, p2});
+    }
+
+    testutil::shutdownWorkScheduler(*app2);
+    testutil::shutdownWorkScheduler(*app1);
+    testutil::shutdownWorkScheduler(*app);
+}
 }
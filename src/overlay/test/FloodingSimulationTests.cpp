@@ -0,0 +1,305 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "crypto/SHA.h"
+#include "herder/Herder.h"
+#include "ledger/LedgerManager.h"
+#include "main/Application.h"
+#include "overlay/OverlayManager.h"
+#include "overlay/OverlayMetrics.h"
+#include "overlay/test/OverlayTestUtils.h"
+#include "simulation/Simulation.h"
+#include "simulation/Topologies.h"
+#include "simulation/TxGenerator.h"
+#include "test/Catch2.h"
+#include "test/test.h"
+#include "util/Logging.h"
+#include "util/Math.h"
+
+#include <algorithm>
+#include <chrono>
+
+// Measures the cost of flooding transactions through the overlay of large
+// in-process networks, so that changes to TxAdverts, Floodgate or FlowControl
+// can be compared. Transactions are submitted at a fixed rate to random nodes
+// running in overlay-only mode (no validation or apply) and the simulation
+// reports, per node and per transaction:
+// - bytes sent, net of the background traffic measured over an idle period
+//   of the same length,
+// - the share of flooded bytes received more than once and of pulled
+//   transactions that were already known,
+// - advert and demand messages and hashes,
+// - how long each transaction took to reach every other node, sampled every
+//   POLL_PERIOD of virtual time.
+//
+// Run with `stellar-core test '[floodsim]'`.
+
+using namespace stellar;
+using namespace stellar::overlaytestutils;
+
+namespace
+{
+
+auto const POLL_PERIOD = std::chrono::milliseconds(10);
+
+// How long transactions get to reach every node once all are submitted
+auto const DRAIN_PERIOD = std::chrono::seconds(5);
+
+struct FloodCounters
+{
+    uint64_t mBytesSent{0};
+    uint64_t mTxMessagesSent{0};
+    uint64_t mAdvertsSent{0};
+    uint64_t mHashesAdvertised{0};
+    uint64_t mDemandsSent{0};
+    uint64_t mHashesDemanded{0};
+    uint64_t mUniqueFloodBytes{0};
+    uint64_t mDuplicateFloodBytes{0};
+    uint64_t mPulledRelevant{0};
+    uint64_t mPulledIrrelevant{0};
+
+    FloodCounters
+    operator-(FloodCounters const& other) const
+    {
+        FloodCounters res;
+        res.mBytesSent = mBytesSent - other.mBytesSent;
+        res.mTxMessagesSent = mTxMessagesSent - other.mTxMessagesSent;
+        res.mAdvertsSent = mAdvertsSent - other.mAdvertsSent;
+        res.mHashesAdvertised = mHashesAdvertised - other.mHashesAdvertised;
+        res.mDemandsSent = mDemandsSent - other.mDemandsSent;
+        res.mHashesDemanded = mHashesDemanded - other.mHashesDemanded;
+        res.mUniqueFloodBytes = mUniqueFloodBytes - other.mUniqueFloodBytes;
+        res.mDuplicateFloodBytes =
+            mDuplicateFloodBytes - other.mDuplicateFloodBytes;
+        res.mPulledRelevant = mPulledRelevant - other.mPulledRelevant;
+        res.mPulledIrrelevant = mPulledIrrelevant - other.mPulledIrrelevant;
+        return res;
+    }
+};
+
+FloodCounters
+getFloodCounters(Simulation& simulation)
+{
+    FloodCounters res;
+    for (auto const& node : simulation.getNodes())
+    {
+        auto& om = node->getOverlayManager().getOverlayMetrics();
+        res.mBytesSent += om.mByteWrite.count();
+        res.mTxMessagesSent += om.mSendTransactionMeter.count();
+        res.mAdvertsSent += om.mSendFloodAdvertMeter.count();
+        res.mHashesAdvertised += getAdvertisedHashCount(node);
+        res.mDemandsSent += om.mSendFloodDemandMeter.count();
+        res.mHashesDemanded += om.mMessagesDemanded.count();
+        res.mUniqueFloodBytes += om.mUniqueFloodBytesRecv.count();
+        res.mDuplicateFloodBytes += om.mDuplicateFloodBytesRecv.count();
+        res.mPulledRelevant += om.mPulledRelevantTxs.count();
+        res.mPulledIrrelevant += om.mPulledIrrelevantTxs.count();
+    }
+    return res;
+}
+
+double
+ratio(uint64_t num, uint64_t denom)
+{
+    return denom == 0 ? 0.0 : static_cast<double>(num) / denom;
+}
+
+int64_t
+getPercentile(std::vector<int64_t> const& sorted, double p)
+{
+    if (sorted.empty())
+    {
+        return 0;
+    }
+    return sorted[static_cast<size_t>(p * (sorted.size() - 1))];
+}
+
+void
+runFloodSimulation(std::string const& name, Simulation::pointer simulation,
+                   uint32_t nTxs, uint32_t txRate)
+{
+    simulation->startAllNodes();
+    simulation->crankUntil(
+        [&]() { return simulation->haveAllExternalized(3, 1); },
+        10 * simulation->getExpectedLedgerCloseTime(), false);
+
+    auto nodes = simulation->getNodes();
+    for (auto& node : nodes)
+    {
+        node->setRunInOverlayOnlyMode(true);
+    }
+
+    auto& clock = nodes[0]->getClock();
+    VirtualClock::duration interval = std::chrono::seconds(1);
+    interval /= txRate;
+    auto submitPeriod = interval * nTxs;
+
+    // Background traffic (SCP, peer management) over a period as long as the
+    // one transactions are submitted over
+    auto idleStart = getFloodCounters(*simulation);
+    simulation->crankForAtLeast(submitPeriod, false);
+    auto background = getFloodCounters(*simulation) - idleStart;
+
+    // Every transaction has its own source account so that the queues accept
+    // them all, accounts don't need to exist in overlay-only mode
+    TxGenerator txGenerator(*nodes[0]);
+    std::vector<Hash> hashes;
+    std::vector<VirtualClock::time_point> submittedAt;
+    // Nodes each transaction hasn't reached yet
+    std::vector<std::vector<Application::pointer>> pending;
+    std::vector<int64_t> latenciesMs;
+
+    auto poll = [&]() {
+        auto now = clock.now();
+        for (size_t i = 0; i < pending.size(); ++i)
+        {
+            auto& waiting = pending[i];
+            auto it = std::remove_if(
+                waiting.begin(), waiting.end(), [&](auto const& node) {
+                    return node->getHerder().getTx(hashes[i]) != nullptr;
+                });
+            for (auto reached = it; reached != waiting.end(); ++reached)
+            {
+                latenciesMs.emplace_back(
+                    std::chrono::duration_cast<std::chrono::milliseconds>(
+                        now - submittedAt[i])
+                        .count());
+            }
+            waiting.erase(it, waiting.end());
+        }
+    };
+
+    auto floodStart = getFloodCounters(*simulation);
+    auto start = clock.now();
+    uint32_t submitted = 0;
+    while (submitted < nTxs)
+    {
+        while (submitted < nTxs && start + submitted * interval <= clock.now())
+        {
+            auto origin = rand_element(nodes);
+            auto ledgerNum =
+                origin->getLedgerManager().getLastClosedLedgerNum() + 1;
+            auto tx = txGenerator
+                          .paymentTransaction(nTxs, 0, ledgerNum, submitted,
+                                              1, std::nullopt)
+                          .second;
+            auto res = origin->getHerder().recvTransaction(tx, true);
+            REQUIRE(res.code ==
+                    TransactionQueue::AddResultCode::ADD_STATUS_PENDING);
+
+            hashes.emplace_back(tx->getFullHash());
+            submittedAt.emplace_back(clock.now());
+            pending.emplace_back();
+            for (auto const& node : nodes)
+            {
+                if (node != origin)
+                {
+                    pending.back().emplace_back(node);
+                }
+            }
+            ++submitted;
+        }
+        simulation->crankForAtLeast(POLL_PERIOD, false);
+        poll();
+    }
+
+    auto drainEnd = clock.now() + DRAIN_PERIOD;
+    auto remaining = [&]() {
+        size_t res = 0;
+        for (auto const& waiting : pending)
+        {
+            res += waiting.size();
+        }
+        return res;
+    };
+    while (remaining() > 0 && clock.now() < drainEnd)
+    {
+        simulation->crankForAtLeast(POLL_PERIOD, false);
+        poll();
+    }
+    auto elapsed = clock.now() - start;
+    auto flood = getFloodCounters(*simulation) - floodStart;
+
+    // Scale the background traffic to the time the flood took
+    auto backgroundBytes = static_cast<double>(background.mBytesSent) *
+                           elapsed.count() / submitPeriod.count();
+    auto perNodeTx = static_cast<double>(nodes.size()) * nTxs;
+    auto perNodeSecond = nodes.size() *
+                         std::chrono::duration<double>(submitPeriod).count();
+    auto targets = (nodes.size() - 1) * static_cast<size_t>(nTxs);
+    std::sort(latenciesMs.begin(), latenciesMs.end());
+
+    CLOG_INFO(Overlay, "{}: {} nodes, {} connections, {} txs at {} tx/s", name,
+              nodes.size(), numberOfSimulationConnections(simulation), nTxs,
+              txRate);
+    CLOG_INFO(Overlay,
+              "{}: {:.0f} bytes sent per node per tx, {:.0f} background "
+              "bytes per node per second",
+              name,
+              std::max(flood.mBytesSent - backgroundBytes, 0.0) / perNodeTx,
+              background.mBytesSent / perNodeSecond);
+    CLOG_INFO(Overlay,
+              "{}: duplicate flood bytes received {:.4f}, already known "
+              "pulled txs {:.4f}",
+              name,
+              ratio(flood.mDuplicateFloodBytes,
+                    flood.mDuplicateFloodBytes + flood.mUniqueFloodBytes),
+              ratio(flood.mPulledIrrelevant,
+                    flood.mPulledIrrelevant + flood.mPulledRelevant));
+    CLOG_INFO(Overlay,
+              "{}: per node per tx, {:.3f} tx messages, {:.3f} adverts "
+              "carrying {:.3f} hashes, {:.3f} demands carrying {:.3f} hashes",
+              name, flood.mTxMessagesSent / perNodeTx,
+              flood.mAdvertsSent / perNodeTx,
+              flood.mHashesAdvertised / perNodeTx,
+              flood.mDemandsSent / perNodeTx,
+              flood.mHashesDemanded / perNodeTx);
+    CLOG_INFO(Overlay,
+              "{}: reached {:.4f} of nodes, propagation latency p50 {}ms, "
+              "p90 {}ms, p99 {}ms, max {}ms",
+              name, ratio(latenciesMs.size(), targets),
+              getPercentile(latenciesMs, 0.5), getPercentile(latenciesMs, 0.9),
+              getPercentile(latenciesMs, 0.99),
+              latenciesMs.empty() ? 0 : latenciesMs.back());
+
+    REQUIRE(!latenciesMs.empty());
+}
+}
+
+TEST_CASE("transaction flooding at scale", "[overlay][floodsim][!hide]")
+{
+    int const numValidators = 10;
+    int const numWatchers = 100;
+    uint32_t const nTxs = 1000;
+    uint32_t const txRate = GENERATE(as<uint32_t>(), 50, 200);
+
+    auto networkID = sha256(getTestConfig().NETWORK_PASSPHRASE);
+    auto confGen = [&](int i) {
+        auto cfg = getTestConfig(i);
+        cfg.TESTING_UPGRADE_MAX_TX_SET_SIZE = 10000;
+        // Index 0 is the simulation's idle app, validators come first
+        if (i > numValidators)
+        {
+            cfg.NODE_IS_VALIDATOR = false;
+            cfg.FORCE_SCP = false;
+        }
+        return cfg;
+    };
+
+    SECTION("random")
+    {
+        auto simulation = Topologies::randomGraph(
+            numValidators, numWatchers, 2, 0.75, Simulation::OVER_LOOPBACK,
+            networkID, confGen);
+        runFloodSimulation("random", simulation, nTxs, txRate);
+    }
+    SECTION("tiered")
+    {
+        // Watchers only connect to the validators, which are fully meshed
+        auto simulation = Topologies::hierarchicalQuorumSimplified(
+            numValidators, numWatchers, Simulation::OVER_LOOPBACK, networkID,
+            confGen, 3);
+        runFloodSimulation("tiered", simulation, nTxs, txRate);
+    }
+}
@@ -484,4 +484,97 @@ TEST_CASE("next peer strategy", "[overlay][ItemFetcher]")
         }
     }
 }
+
+TEST_CASE("hedged fetch", "[overlay][ItemFetcher]")
+{
+    auto networkID = sha256(getTestConfig().NETWORK_PASSPHRASE);
+    auto sim =
+        std::make_shared<Simulation>(Simulation::OVER_LOOPBACK, networkID);
+
+    auto cfgMain = getTestConfig(1);
+    auto cfg1 = getTestConfig(2);
+    auto cfg2 = getTestConfig(3);
+
+    SIMULATION_CREATE_NODE(Main);
+    SIMULATION_CREATE_NODE(Node1);
+    SIMULATION_CREATE_NODE(Node2);
+    sim->addNode(vMainSecretKey, cfgMain.QUORUM_SET, &cfgMain);
+    sim->addNode(vNode1SecretKey, cfg1.QUORUM_SET, &cfg1);
+    sim->addNode(vNode2SecretKey, cfg2.QUORUM_SET, &cfg2);
+    sim->addPendingConnection(vMainNodeID, vNode1NodeID);
+    sim->addPendingConnection(vMainNodeID, vNode2NodeID);
+    sim->startAllNodes();
+    auto peer1 =
+        sim->getLoopbackConnection(vMainNodeID, vNode1NodeID)->getInitiator();
+    auto peer2 =
+        sim->getLoopbackConnection(vMainNodeID, vNode2NodeID)->getInitiator();
+
+    auto app = sim->getNode(vMainNodeID);
+
+    std::vector<Peer::pointer> asked;
+    ItemFetcher itemFetcher(
+        *app, [&](Peer::pointer peer, Hash) { asked.emplace_back(peer); },
+        true);
+
+    sim->crankUntil(
+        [&]() {
+            return peer1->isAuthenticatedForTesting() &&
+                   peer2->isAuthenticatedForTesting();
+        },
+        std::chrono::seconds{3}, false);
+
+    auto& hedgeMeter = app->getMetrics().NewMeter(
+        {"overlay", "item-fetcher", "hedge"}, "item-fetcher");
+    auto hedgesBefore = hedgeMeter.count();
+
+    auto hundredEnvelope = makeEnvelope(100);
+    auto hundred = sha256(ByteSlice("100"));
+    itemFetcher.fetch(hundred, hundredEnvelope);
+    auto tracker = itemFetcher.getTracker(hundred);
+    REQUIRE(tracker);
+    REQUIRE(asked.size() == 1);
+    REQUIRE(!tracker->getHedgePeer());
+
+    // The second peer is asked well before the first request times out
+    sim->crankUntil([&]() { return asked.size() == 2; },
+                    Tracker::MS_TO_WAIT_FOR_FETCH_REPLY, false);
+    REQUIRE(asked[0] != asked[1]);
+    REQUIRE(tracker->getLastAskedPeer() == asked[0]);
+    REQUIRE(tracker->getHedgePeer() == asked[1]);
+    REQUIRE(hedgeMeter.count() == hedgesBefore + 1);
+
+    SECTION("first reply cancels the other request")
+    {
+        // what recv does once either peer answers
+        tracker->cancel();
+        REQUIRE(!tracker->getHedgePeer());
+        sim->crankForAtLeast(Tracker::MS_TO_WAIT_FOR_FETCH_REPLY * 2, false);
+        REQUIRE(asked.size() == 2);
+        REQUIRE(hedgeMeter.count() == hedgesBefore + 1);
+    }
+    SECTION("first peer does not have the item")
+    {
+        itemFetcher.doesntHave(hundred, asked[0]);
+        // keep waiting on the hedge request instead of asking again
+        REQUIRE(asked.size() == 2);
+        REQUIRE(tracker->getLastAskedPeer() == asked[1]);
+        REQUIRE(!tracker->getHedgePeer());
+    }
+    SECTION("hedge peer does not have the item")
+    {
+        itemFetcher.doesntHave(hundred, asked[1]);
+        REQUIRE(asked.size() == 2);
+        REQUIRE(tracker->getLastAskedPeer() == asked[0]);
+        REQUIRE(!tracker->getHedgePeer());
+    }
+    SECTION("hedge delay follows ping")
+    {
+        REQUIRE(Tracker::getHedgeDelay(std::chrono::milliseconds{0}) ==
+                Tracker::MIN_HEDGE_DELAY);
+        REQUIRE(Tracker::getHedgeDelay(std::chrono::milliseconds{100}) ==
+                std::chrono::milliseconds{300});
+        REQUIRE(Tracker::getHedgeDelay(std::chrono::seconds{1}) ==
+                Tracker::MAX_HEDGE_DELAY);
+    }
+}
 }
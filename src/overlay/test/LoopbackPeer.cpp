@@ -7,6 +7,7 @@
 #include "main/Application.h"
 #include "medida/meter.h"
 #include "medida/timer.h"
+#include "overlay/MessageCompression.h"
 #include "overlay/OverlayManager.h"
 #include "overlay/OverlayMetrics.h"
 #include "overlay/StellarXDR.h"
@@ -97,7 +98,8 @@ LoopbackPeer::scheduleRead()
 }
 
 void
-LoopbackPeer::sendMessage(xdr::msg_ptr&& msg, ConstStellarMessagePtr msgPtr)
+LoopbackPeer::sendMessage(xdr::msg_ptr&& msg, ConstStellarMessagePtr msgPtr,
+                          VirtualClock::time_point queuedTime)
 {
     if (mRemote.expired())
     {
@@ -264,7 +266,18 @@ LoopbackPeer::recvMessage(xdr::msg_ptr const& msg)
         AuthenticatedMessage am;
         {
             ZoneNamedN(xdrZone, "XDR deserialize", true);
-            xdr::xdr_from_msg(msg, am);
+            if (MessageCompression::isCompressedFrame(
+                    reinterpret_cast<uint8_t const*>(msg->raw_data())))
+            {
+                auto body = decompressFrame(
+                    reinterpret_cast<uint8_t const*>(msg->data()),
+                    msg->size());
+                xdr::xdr_from_opaque(body, am);
+            }
+            else
+            {
+                xdr::xdr_from_msg(msg, am);
+            }
         }
         recvAuthenticatedMessage(std::move(am));
     }
@@ -275,6 +288,12 @@ LoopbackPeer::recvMessage(xdr::msg_ptr const& msg)
              Peer::DropDirection::WE_DROPPED_REMOTE);
         return;
     }
+    catch (CompressionError const& e)
+    {
+        CLOG_ERROR(Overlay, "received bad compressed message {}", e.what());
+        drop(e.what(), Peer::DropDirection::WE_DROPPED_REMOTE);
+        return;
+    }
 }
 
 void
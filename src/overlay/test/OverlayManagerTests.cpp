@@ -47,7 +47,8 @@ class PeerStub : public Peer
     {
     }
     virtual void
-    sendMessage(xdr::msg_ptr&& xdrBytes, ConstStellarMessagePtr msgPtr) override
+    sendMessage(xdr::msg_ptr&& xdrBytes, ConstStellarMessagePtr msgPtr,
+                VirtualClock::time_point queuedTime) override
     {
     }
     virtual void
@@ -165,6 +166,7 @@ class OverlayManagerTests
             pm.storeConfigPeers();
         }
 
+        pm.getPeerManager().flush();
         rowset<row> rs = app->getDatabase().getRawSession().prepare
                          << "SELECT ip,port,type FROM peers ORDER BY ip, port";
 
@@ -213,6 +215,7 @@ class OverlayManagerTests
         pm.mResolvedPeers.wait();
         pm.tick();
 
+        pm.getPeerManager().flush();
         rowset<row> rs = app->getDatabase().getRawSession().prepare
                          << "SELECT ip,port,type FROM peers ORDER BY ip, port";
 
@@ -7,6 +7,7 @@
 #include "main/Application.h"
 #include "main/Config.h"
 #include "overlay/BanManager.h"
+#include "overlay/MessageCompression.h"
 #include "overlay/OverlayManagerImpl.h"
 #include "overlay/Peer.h"
 #include "overlay/PeerManager.h"
@@ -18,6 +19,7 @@
 #include "test/Catch2.h"
 #include "test/TestUtils.h"
 #include "test/test.h"
+#include "util/HdrHistogram.h"
 #include "util/Logging.h"
 #include "util/ProtocolVersion.h"
 #include "util/Timer.h"
@@ -1083,6 +1085,146 @@ TEST_CASE("outbound queue filtering", "[overlay][flowcontrol]")
             REQUIRE(demandQueue.size() == 10);
         }
     }
+    SECTION("expired flood messages")
+    {
+        auto& expired = node->getMetrics().NewMeter(
+            {"overlay", "outbound-queue", "expired"}, "message");
+        auto expiredBefore = expired.count();
+
+        StellarMessage tx, adv;
+        tx.type(TRANSACTION);
+        adv.type(FLOOD_ADVERT);
+        adv.floodAdvert().txHashes.push_back(xdrSha256(tx));
+        for (int i = 0; i < 3; ++i)
+        {
+            peer->getFlowControl()->addToQueueAndMaybeTrimForTesting(
+                std::make_shared<StellarMessage const>(tx));
+            peer->getFlowControl()->addToQueueAndMaybeTrimForTesting(
+                std::make_shared<StellarMessage const>(adv));
+        }
+        auto bytesBefore =
+            peer->getFlowControl()->getTxQueueByteCountForTesting();
+
+        SECTION("by ledger")
+        {
+            txQueue[0].mLedgerSeq -= FlowControl::FLOOD_QUEUE_MAX_LEDGERS;
+            advertQueue[0].mLedgerSeq -= FlowControl::FLOOD_QUEUE_MAX_LEDGERS;
+            advertQueue[1].mLedgerSeq -= FlowControl::FLOOD_QUEUE_MAX_LEDGERS;
+        }
+        SECTION("by age")
+        {
+            auto maxAge = node->getLedgerManager().getExpectedLedgerCloseTime() *
+                          FlowControl::FLOOD_QUEUE_MAX_LEDGERS;
+            txQueue[0].mTimeEmplaced -= maxAge + std::chrono::seconds(1);
+            advertQueue[0].mTimeEmplaced -= maxAge + std::chrono::seconds(1);
+            advertQueue[1].mTimeEmplaced -= maxAge + std::chrono::seconds(1);
+        }
+
+        peer->getFlowControl()->addToQueueAndMaybeTrimForTesting(
+            std::make_shared<StellarMessage const>(tx));
+        REQUIRE(txQueue.size() == 3);
+        REQUIRE(advertQueue.size() == 1);
+        REQUIRE(expired.count() == expiredBefore + 3);
+        REQUIRE(peer->getFlowControl()->getTxQueueByteCountForTesting() ==
+                bytesBefore);
+    }
+    SECTION("weighted scheduling")
+    {
+        StellarMessage tx, adv, dem;
+        tx.type(TRANSACTION);
+        adv.type(FLOOD_ADVERT);
+        dem.type(FLOOD_DEMAND);
+        adv.floodAdvert().txHashes.push_back(xdrSha256(tx));
+        dem.floodDemand().txHashes.push_back(xdrSha256(tx));
+        for (int i = 0; i < 10; ++i)
+        {
+            peer->getFlowControl()->addToQueueAndMaybeTrimForTesting(
+                std::make_shared<StellarMessage const>(tx));
+        }
+        for (int i = 0; i < 2; ++i)
+        {
+            peer->getFlowControl()->addToQueueAndMaybeTrimForTesting(
+                std::make_shared<StellarMessage const>(adv));
+            peer->getFlowControl()->addToQueueAndMaybeTrimForTesting(
+                std::make_shared<StellarMessage const>(dem));
+        }
+        peer->getFlowControl()->addToQueueAndMaybeTrimForTesting(
+            constructSCPMsg(envs[0]));
+
+        auto batch = peer->getFlowControl()->getNextBatchToSend();
+        std::vector<MessageType> types;
+        for (auto const& item : batch)
+        {
+            types.push_back(item.mMessage->type());
+        }
+
+        // SCP first, then 4 txs for every demand and advert
+        std::vector<MessageType> expected = {SCP_MESSAGE};
+        for (int round = 0; round < 2; ++round)
+        {
+            expected.insert(expected.end(), 4, TRANSACTION);
+            expected.push_back(FLOOD_DEMAND);
+            expected.push_back(FLOOD_ADVERT);
+        }
+        expected.insert(expected.end(), 2, TRANSACTION);
+        REQUIRE(types == expected);
+        REQUIRE(std::all_of(scpQueue.begin(), scpQueue.end(),
+                            [](auto const& m) { return m.mBeingSent; }));
+    }
+}
+
+TEST_CASE("copies of known SCP messages skip Herder", "[overlay][flood]")
+{
+    auto networkID = sha256(getTestConfig().NETWORK_PASSPHRASE);
+    auto simulation =
+        std::make_shared<Simulation>(Simulation::OVER_LOOPBACK, networkID);
+
+    auto validatorAKey = SecretKey::fromSeed(sha256("validator-A"));
+    auto validatorBKey = SecretKey::fromSeed(sha256("validator-B"));
+
+    SCPQuorumSet qset;
+    qset.threshold = 2;
+    qset.validators.push_back(validatorAKey.getPublicKey());
+    qset.validators.push_back(validatorBKey.getPublicKey());
+
+    auto nodeA = simulation->addNode(validatorAKey, qset);
+    auto nodeB = simulation->addNode(validatorBKey, qset);
+    simulation->addPendingConnection(validatorAKey.getPublicKey(),
+                                     validatorBKey.getPublicKey());
+    simulation->startAllNodes();
+
+    simulation->crankUntil(
+        [&]() { return simulation->haveAllExternalized(3, 1); },
+        4 * simulation->getExpectedLedgerCloseTime(), false);
+
+    auto conn = simulation->getLoopbackConnection(
+        validatorAKey.getPublicKey(), validatorBKey.getPublicKey());
+    REQUIRE(conn);
+
+    // Envelopes A already sent to B, and B accepted
+    auto lcl = nodeA->getLedgerManager().getLastClosedLedgerNum();
+    HerderImpl& herderA = *static_cast<HerderImpl*>(&nodeA->getHerder());
+    auto envs = herderA.getSCP().getLatestMessagesSend(lcl);
+    REQUIRE(!envs.empty());
+
+    StellarMessage msg;
+    msg.type(SCP_MESSAGE);
+    msg.envelope() = envs.front();
+    REQUIRE(nodeB->getOverlayManager().isKnownSCPMessage(xdrBlake2(msg)));
+
+    auto& knownSCP =
+        nodeB->getOverlayManager().getOverlayMetrics().mRecvSCPKnownDuplicate;
+    auto knownBefore = knownSCP.count();
+
+    conn->getInitiator()->sendAuthenticatedMessageForTesting(
+        std::make_shared<StellarMessage const>(msg));
+    simulation->crankUntil([&]() { return knownSCP.count() > knownBefore; },
+                           std::chrono::seconds(2), false);
+    REQUIRE(conn->getAcceptor()->isAuthenticatedForTesting());
+
+    // Forgotten once the slot is cleared
+    nodeB->getOverlayManager().clearLedgersBelow(lcl + 1, lcl);
+    REQUIRE(!nodeB->getOverlayManager().isKnownSCPMessage(xdrBlake2(msg)));
 }
 
 TEST_CASE("reject non preferred peer", "[overlay][connections]")
@@ -1694,6 +1836,135 @@ TEST_CASE("reject peers with incompatible overlay versions",
     }
 }
 
+#ifdef USE_ZLIB
+TEST_CASE("compressed messages between peers", "[overlay][connections]")
+{
+    VirtualClock clock;
+    auto cfg1 = getTestConfig(0);
+    auto cfg2 = getTestConfig(1);
+    cfg1.PEER_MESSAGE_COMPRESSION_KEYS.emplace(cfg2.NODE_SEED.getPublicKey());
+    cfg2.PEER_MESSAGE_COMPRESSION_KEYS.emplace(cfg1.NODE_SEED.getPublicKey());
+    cfg1.PEER_MESSAGE_COMPRESSION_THRESHOLD = 1;
+    cfg2.PEER_MESSAGE_COMPRESSION_THRESHOLD = 1;
+
+    // Mostly zeros, so that it compresses well
+    StellarMessage txSetMsg;
+    txSetMsg.type(GENERALIZED_TX_SET);
+    txSetMsg.generalizedTxSet().v(1);
+    txSetMsg.generalizedTxSet().v1TxSet().phases.resize(2);
+    auto txSetPtr = std::make_shared<StellarMessage const>(txSetMsg);
+
+    auto test = [&](bool expectCompression, bool expectDrop) {
+        auto app1 = createTestApplication(clock, cfg1);
+        auto app2 = createTestApplication(clock, cfg2);
+        LoopbackPeerConnection conn(*app1, *app2);
+        testutil::crankSome(clock);
+        REQUIRE(conn.getInitiator()->isAuthenticatedForTesting());
+        REQUIRE(conn.getAcceptor()->isAuthenticatedForTesting());
+
+        auto& sent = app1->getOverlayManager()
+                         .getOverlayMetrics()
+                         .mSendCompressedMeter;
+        auto& received = app2->getOverlayManager()
+                             .getOverlayMetrics()
+                             .mRecvCompressedMeter;
+        auto sentBefore = sent.count();
+        auto receivedBefore = received.count();
+        conn.getInitiator()->sendMessage(txSetPtr);
+        testutil::crankSome(clock);
+        REQUIRE(sent.count() == sentBefore + (expectCompression ? 1 : 0));
+        if (expectDrop)
+        {
+            REQUIRE(!conn.getAcceptor()->isConnectedForTesting());
+            REQUIRE(conn.getAcceptor()->getDropReason() ==
+                    "unexpected compressed message");
+        }
+        else
+        {
+            REQUIRE(conn.getAcceptor()->isAuthenticatedForTesting());
+            REQUIRE(received.count() ==
+                    receivedBefore + (expectCompression ? 1 : 0));
+        }
+
+        testutil::shutdownWorkScheduler(*app2);
+        testutil::shutdownWorkScheduler(*app1);
+    };
+
+    SECTION("peers list each other")
+    {
+        test(true, false);
+    }
+    SECTION("peers don't list each other")
+    {
+        cfg1.PEER_MESSAGE_COMPRESSION_KEYS.clear();
+        cfg2.PEER_MESSAGE_COMPRESSION_KEYS.clear();
+        test(false, false);
+    }
+    SECTION("message below the threshold")
+    {
+        cfg1.PEER_MESSAGE_COMPRESSION_THRESHOLD = MAX_MESSAGE_SIZE;
+        test(false, false);
+    }
+    SECTION("receiver doesn't list the sender")
+    {
+        cfg2.PEER_MESSAGE_COMPRESSION_KEYS.clear();
+        test(true, true);
+    }
+}
+
+TEST_CASE("compressed message round trip", "[overlay]")
+{
+    StellarMessage msg;
+    msg.type(GENERALIZED_TX_SET);
+    msg.generalizedTxSet().v(1);
+    msg.generalizedTxSet().v1TxSet().phases.resize(2);
+    auto frame = xdr::xdr_to_msg(msg);
+    auto header = [](xdr::msg_ptr const& m) {
+        return reinterpret_cast<uint8_t const*>(m->raw_data());
+    };
+    auto body = [](xdr::msg_ptr const& m) {
+        return reinterpret_cast<uint8_t const*>(m->data());
+    };
+    REQUIRE(!MessageCompression::isCompressedFrame(header(frame)));
+
+    auto compressed = MessageCompression::compress(frame);
+    REQUIRE(compressed);
+    REQUIRE(MessageCompression::isCompressedFrame(header(compressed)));
+    REQUIRE(compressed->size() < frame->size());
+    auto res = MessageCompression::decompress(
+        body(compressed), compressed->size(), MAX_MESSAGE_SIZE);
+    REQUIRE(res == std::vector<uint8_t>(body(frame),
+                                        body(frame) + frame->size()));
+
+    SECTION("too large")
+    {
+        REQUIRE_THROWS_AS(
+            MessageCompression::decompress(body(compressed),
+                                           compressed->size(),
+                                           frame->size() - 1),
+            CompressionError);
+    }
+    SECTION("truncated")
+    {
+        REQUIRE_THROWS_AS(MessageCompression::decompress(
+                              body(compressed), compressed->size() / 2,
+                              MAX_MESSAGE_SIZE),
+                          CompressionError);
+    }
+    SECTION("missing size")
+    {
+        REQUIRE_THROWS_AS(MessageCompression::decompress(
+                              body(compressed), 3, MAX_MESSAGE_SIZE),
+                          CompressionError);
+    }
+    SECTION("incompressible")
+    {
+        auto small = xdr::xdr_to_msg(uint32_t(1));
+        REQUIRE(!MessageCompression::compress(small));
+    }
+}
+#endif
+
 TEST_CASE("reject peers who dont handshake quickly", "[overlay][connections]")
 {
     auto test = [](unsigned short authenticationTimeout) {
@@ -2262,11 +2533,11 @@ TEST_CASE("database is purged at overlay start", "[overlay]")
     Herder& herder = app->getHerder();
     herder.setMaxTxSize(herder.getMaxClassicTxSize());
 
-    peerManager.store(localhost(1), record(118), false);
-    peerManager.store(localhost(2), record(119), false);
-    peerManager.store(localhost(3), record(120), false);
-    peerManager.store(localhost(4), record(121), false);
-    peerManager.store(localhost(5), record(122), false);
+    peerManager.store(localhost(1), record(118));
+    peerManager.store(localhost(2), record(119));
+    peerManager.store(localhost(3), record(120));
+    peerManager.store(localhost(4), record(121));
+    peerManager.store(localhost(5), record(122));
 
     // Herder depends on LM state for close time, so initialize it manually
     // since we aren't actually starting app.
@@ -2319,7 +2590,7 @@ TEST_CASE("peer numfailures resets after good connection",
 
     auto& om = app1->getOverlayManager();
     auto& peerManager = om.getPeerManager();
-    peerManager.store(localhost(cfg2.PEER_PORT), record(119), false);
+    peerManager.store(localhost(cfg2.PEER_PORT), record(119));
     REQUIRE(peerManager.load(localhost(cfg2.PEER_PORT)).second);
 
     simulation->crankForAtLeast(std::chrono::seconds{4}, true);
@@ -2359,7 +2630,7 @@ TEST_CASE("peer is purged from database after few failures",
 
     auto& om = app1->getOverlayManager();
     auto& peerManager = om.getPeerManager();
-    peerManager.store(localhost(cfg2.PEER_PORT), record(119), false);
+    peerManager.store(localhost(cfg2.PEER_PORT), record(119));
     REQUIRE(peerManager.load(localhost(cfg2.PEER_PORT)).second);
 
     simulation->crankForAtLeast(std::chrono::seconds{5}, true);
@@ -3156,4 +3427,31 @@ TEST_CASE("background signature verification with missing account",
 
     s->stopAllNodes();
 }
+
+TEST_CASE("peers sharded across overlay threads", "[overlay][connections]")
+{
+    Hash networkID = sha256(getTestConfig().NETWORK_PASSPHRASE);
+    auto simulation = Topologies::core(
+        4, 0.75, Simulation::OVER_TCP, networkID, [](int i) {
+            Config cfg = getTestConfig(i);
+            cfg.BACKGROUND_OVERLAY_PROCESSING = true;
+            cfg.OVERLAY_THREADS = 2;
+            return cfg;
+        });
+    simulation->startAllNodes();
+    simulation->crankUntil(
+        [&] { return simulation->haveAllExternalized(4, 1); },
+        5 * simulation->getExpectedLedgerCloseTime(), false);
+
+    for (auto const& node : simulation->getNodes())
+    {
+        REQUIRE(node->getOverlayManager().getAuthenticatedPeersCount() == 3);
+
+        // Per-type delays are tracked on both the receive and send paths
+        auto& metrics = node->getOverlayManager().getOverlayMetrics();
+        REQUIRE(metrics.getRecvDelayTimer(SCP_MESSAGE).count() > 0);
+        REQUIRE(metrics.getSendDelayTimer(SCP_MESSAGE).count() > 0);
+        REQUIRE(metrics.getRecvDelayTimer(HELLO).count() >= 3);
+    }
+}
 }
@@ -53,11 +53,18 @@ TEST_CASE("toXdr", "[overlay][PeerManager]")
 
             auto storedPr = loadedPR.first;
             storedPr.mType = static_cast<int>(peerType);
-            pm.store(address, storedPr, false);
+            pm.store(address, storedPr);
 
             auto actualPR = pm.load(address);
             REQUIRE(actualPR.second);
             REQUIRE(actualPR.first == storedPr);
+
+            // Written behind, a fresh PeerManager only sees it once flushed
+            REQUIRE(!PeerManager(*app).load(address).second);
+            pm.flush();
+            auto reloadedPR = PeerManager(*app).load(address);
+            REQUIRE(reloadedPR.second);
+            REQUIRE(reloadedPR.first == storedPr);
         };
 
         SECTION("inbound")
@@ -277,7 +284,7 @@ TEST_CASE("loadRandomPeers", "[overlay][PeerManager]")
                     PeerRecord{VirtualClock::systemPointToTm(time), numFailures,
                                static_cast<int>(type)};
                 peerRecords[port] = peerRecord;
-                peerManager.store(localhost(port), peerRecord, false);
+                peerManager.store(localhost(port), peerRecord);
                 port++;
             }
         }
@@ -374,7 +381,7 @@ TEST_CASE("getPeersToSend", "[overlay][PeerManager]")
         {
             peerManager.store(
                 localhost(port++),
-                PeerRecord{{}, 11, static_cast<int>(PeerType::INBOUND)}, false);
+                PeerRecord{{}, 11, static_cast<int>(PeerType::INBOUND)});
         }
         for (auto i = 0; i < normalOutboundCount; i++)
         {
@@ -384,8 +391,7 @@ TEST_CASE("getPeersToSend", "[overlay][PeerManager]")
         {
             peerManager.store(
                 localhost(port++),
-                PeerRecord{{}, 11, static_cast<int>(PeerType::OUTBOUND)},
-                false);
+                PeerRecord{{}, 11, static_cast<int>(PeerType::OUTBOUND)});
         }
     };
 
@@ -487,17 +493,17 @@ TEST_CASE("RandomPeerSource::nextAttemptCutoff also limits maxFailures",
 
     auto now = VirtualClock::systemPointToTm(clock.system_now());
     peerManager.store(localhost(1),
-                      {now, 0, static_cast<int>(PeerType::INBOUND)}, false);
+                      {now, 0, static_cast<int>(PeerType::INBOUND)});
     peerManager.store(localhost(2),
-                      {now, 0, static_cast<int>(PeerType::OUTBOUND)}, false);
+                      {now, 0, static_cast<int>(PeerType::OUTBOUND)});
     peerManager.store(localhost(3),
-                      {now, 120, static_cast<int>(PeerType::INBOUND)}, false);
+                      {now, 120, static_cast<int>(PeerType::INBOUND)});
     peerManager.store(localhost(4),
-                      {now, 120, static_cast<int>(PeerType::OUTBOUND)}, false);
+                      {now, 120, static_cast<int>(PeerType::OUTBOUND)});
     peerManager.store(localhost(5),
-                      {now, 121, static_cast<int>(PeerType::INBOUND)}, false);
+                      {now, 121, static_cast<int>(PeerType::INBOUND)});
     peerManager.store(localhost(6),
-                      {now, 121, static_cast<int>(PeerType::OUTBOUND)}, false);
+                      {now, 121, static_cast<int>(PeerType::OUTBOUND)});
 
     auto peers = randomPeerSource.getRandomPeers(
         50, [](PeerBareAddress const&) { return true; });
@@ -517,11 +523,11 @@ TEST_CASE("purge peer table", "[overlay][PeerManager]")
         return PeerRecord{{}, numFailures, static_cast<int>(PeerType::INBOUND)};
     };
 
-    peerManager.store(localhost(1), record(1), false);
-    peerManager.store(localhost(2), record(2), false);
-    peerManager.store(localhost(3), record(3), false);
-    peerManager.store(localhost(4), record(4), false);
-    peerManager.store(localhost(5), record(5), false);
+    peerManager.store(localhost(1), record(1));
+    peerManager.store(localhost(2), record(2));
+    peerManager.store(localhost(3), record(3));
+    peerManager.store(localhost(4), record(4));
+    peerManager.store(localhost(5), record(5));
 
     peerManager.removePeersWithManyFailures(3);
     REQUIRE(peerManager.load(localhost(1)).second);
@@ -4,6 +4,7 @@
 
 #include "main/Application.h"
 #include "main/Config.h"
+#include "medida/histogram.h"
 #include "overlay/OverlayManager.h"
 #include "overlay/PeerBareAddress.h"
 #include "overlay/PeerDoor.h"
@@ -138,6 +139,63 @@ TEST_CASE("TCPPeer can communicate", "[overlay]")
     s->stopAllNodes();
 }
 
+TEST_CASE("TCPPeer coalesces queued messages", "[overlay]")
+{
+    Hash networkID = sha256(getTestConfig().NETWORK_PASSPHRASE);
+    // Send from the main thread, so that all messages are queued before the
+    // first write completes
+    Simulation::ConfigGen cfgGen = [](int i) {
+        auto cfg = getTestConfig(i);
+        cfg.BACKGROUND_OVERLAY_PROCESSING = false;
+        return cfg;
+    };
+
+    Simulation::pointer s =
+        std::make_shared<Simulation>(Simulation::OVER_TCP, networkID, cfgGen);
+
+    auto v10SecretKey = SecretKey::fromSeed(sha256("v10"));
+    auto v11SecretKey = SecretKey::fromSeed(sha256("v11"));
+
+    SCPQuorumSet n0_qset;
+    n0_qset.threshold = 1;
+    n0_qset.validators.push_back(v10SecretKey.getPublicKey());
+    auto n0 = s->addNode(v10SecretKey, n0_qset);
+
+    SCPQuorumSet n1_qset;
+    n1_qset.threshold = 1;
+    n1_qset.validators.push_back(v11SecretKey.getPublicKey());
+    auto n1 = s->addNode(v11SecretKey, n1_qset);
+
+    s->addPendingConnection(v10SecretKey.getPublicKey(),
+                            v11SecretKey.getPublicKey());
+    s->startAllNodes();
+    s->crankForAtLeast(std::chrono::seconds(1), false);
+
+    auto p0 = n0->getOverlayManager().getConnectedPeer(
+        PeerBareAddress{"127.0.0.1", n1->getConfig().PEER_PORT});
+    REQUIRE(p0);
+    REQUIRE(p0->isAuthenticatedForTesting());
+    s->stopOverlayTick();
+
+    auto& metrics0 = n0->getOverlayManager().getOverlayMetrics();
+    auto& msgRead = n1->getOverlayManager().getOverlayMetrics().mMessageRead;
+    auto prevMsgRead = msgRead.count();
+
+    // Everything queued behind the first write goes out in the next one,
+    // covered by a single buffer
+    int const numMessages = 200;
+    for (int i = 0; i < numMessages; ++i)
+    {
+        p0->sendGetTxSet(sha256(std::to_string(i)));
+    }
+    s->crankForAtLeast(std::chrono::seconds(1), false);
+
+    REQUIRE(msgRead.count() >= prevMsgRead + numMessages);
+    REQUIRE(metrics0.mAsyncWriteMessages.max() > 64);
+    REQUIRE(metrics0.mAsyncWriteBuffers.max() < 64);
+    s->stopAllNodes();
+}
+
 TEST_CASE("TCPPeer read malformed messages", "[overlay]")
 {
     Hash networkID = sha256(getTestConfig().NETWORK_PASSPHRASE);
@@ -3,7 +3,9 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "ledger/LedgerManager.h"
+#include "lib/json/json.h"
 #include "main/Application.h"
+#include "overlay/PeerDemandStats.h"
 #include "overlay/TxAdverts.h"
 #include "test/Catch2.h"
 #include "test/TestUtils.h"
@@ -109,6 +111,38 @@ TEST_CASE("advert queue", "[flood][pullmode][acceptance]")
             testutil::crankFor(clock, std::chrono::seconds(1));
             REQUIRE(flushed);
         }
+        SECTION("skip hashes the peer advertised meanwhile")
+        {
+            std::vector<Hash> sent;
+            pullMode.start([&](std::shared_ptr<StellarMessage const> msg) {
+                flushed = true;
+                auto const& hashes = msg->floodAdvert().txHashes;
+                sent.insert(sent.end(), hashes.begin(), hashes.end());
+            });
+            pullMode.queueOutgoingAdvert(getHash(0));
+            pullMode.queueOutgoingAdvert(getHash(1));
+            pullMode.queueOutgoingAdvert(getHash(2));
+
+            TxAdvertVector incoming;
+            incoming.push_back(getHash(1));
+            pullMode.queueIncomingAdvert(incoming,
+                                         LedgerManager::GENESIS_LEDGER_SEQ);
+
+            testutil::crankFor(clock, std::chrono::seconds(1));
+            REQUIRE(flushed);
+            REQUIRE(sent == std::vector<Hash>{getHash(0), getHash(2)});
+
+            // Nothing is sent if the peer already has every queued hash
+            flushed = false;
+            pullMode.queueOutgoingAdvert(getHash(3));
+            incoming.clear();
+            incoming.push_back(getHash(3));
+            pullMode.queueIncomingAdvert(incoming,
+                                         LedgerManager::GENESIS_LEDGER_SEQ);
+            testutil::crankFor(clock, std::chrono::seconds(1));
+            REQUIRE(!flushed);
+            REQUIRE(pullMode.outgoingSize() == 0);
+        }
         SECTION("ensure outgoing queue is capped")
         {
             VirtualClock clock2;
@@ -130,4 +164,49 @@ TEST_CASE("advert queue", "[flood][pullmode][acceptance]")
         }
     }
 }
+
+TEST_CASE("peer demand stats", "[flood][pullmode]")
+{
+    using namespace std::chrono_literals;
+    auto const defaultLatency = 500ms;
+
+    PeerDemandStats fast;
+    PeerDemandStats slow;
+    PeerDemandStats unknown;
+    REQUIRE(!unknown.getLatency());
+    REQUIRE(unknown.getSuccessRate() == 1.0);
+    REQUIRE(unknown.getScore(defaultLatency) == 500.0);
+
+    fast.recordFulfilled(100ms);
+    REQUIRE(fast.getLatency() == 100ms);
+    fast.recordFulfilled(200ms);
+    REQUIRE(fast.getLatency() == 120ms);
+
+    slow.recordFulfilled(800ms);
+    REQUIRE(fast.getScore(defaultLatency) < unknown.getScore(defaultLatency));
+    REQUIRE(unknown.getScore(defaultLatency) < slow.getScore(defaultLatency));
+
+    SECTION("timeouts make a peer less attractive")
+    {
+        for (int i = 0; i < 10; ++i)
+        {
+            fast.recordTimeout();
+        }
+        REQUIRE(fast.getSuccessRate() < 0.2);
+        REQUIRE(fast.getLatency() == 120ms);
+        REQUIRE(fast.getScore(defaultLatency) > slow.getScore(defaultLatency));
+
+        // ...until it delivers again
+        for (int i = 0; i < 10; ++i)
+        {
+            fast.recordFulfilled(120ms);
+        }
+        REQUIRE(fast.getScore(defaultLatency) < slow.getScore(defaultLatency));
+
+        auto json = fast.getJsonInfo();
+        REQUIRE(json["latency_ewma_ms"].asUInt64() == 120);
+        REQUIRE(json["fulfilled"].asUInt64() == 12);
+        REQUIRE(json["timeouts"].asUInt64() == 10);
+    }
+}
 }
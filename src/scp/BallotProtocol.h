@@ -162,6 +162,12 @@ class BallotProtocol
 
     std::vector<SCPEnvelope> getExternalizingState() const;
 
+    bool
+    isExternalized() const
+    {
+        return mPhase == SCP_PHASE_EXTERNALIZE;
+    }
+
     // returns all values referenced by a statement
     static std::set<Value> getStatementValues(SCPStatement const& st);
 
@@ -0,0 +1,169 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "scp/CompiledQuorumSet.h"
+#include <Tracy.hpp>
+#include <algorithm>
+
+namespace stellar
+{
+
+bool
+CompiledQuorumSet::isQuorumSlice(BitSet const& nodes) const
+{
+    return isQuorumSlice(0, nodes);
+}
+
+bool
+CompiledQuorumSet::isVBlocking(BitSet const& nodes) const
+{
+    return isVBlocking(0, nodes);
+}
+
+bool
+CompiledQuorumSet::isQuorumSlice(size_t group, BitSet const& nodes) const
+{
+    auto const& g = mGroups[group];
+    // Like LocalNode::isQuorumSliceInternal, a threshold of 0 is never met
+    if (g.mThreshold == 0)
+    {
+        return false;
+    }
+    size_t count = g.mValidators.intersectionCount(nodes);
+    for (size_t i = 0; i < g.mNumInner && count < g.mThreshold; ++i)
+    {
+        if (isQuorumSlice(g.mFirstInner + i, nodes))
+        {
+            ++count;
+        }
+    }
+    return count >= g.mThreshold;
+}
+
+bool
+CompiledQuorumSet::isVBlocking(size_t group, BitSet const& nodes) const
+{
+    auto const& g = mGroups[group];
+    // There is no v-blocking set for {\empty}
+    if (g.mThreshold == 0)
+    {
+        return false;
+    }
+    // At least one blocking member is needed even if the threshold can't be
+    // met at all, like in LocalNode::isVBlockingInternal
+    int64_t leftTillBlock = 1 + static_cast<int64_t>(g.mMembers) -
+                            static_cast<int64_t>(g.mThreshold);
+    size_t needed = static_cast<size_t>(std::max<int64_t>(leftTillBlock, 1));
+    size_t count = g.mValidators.intersectionCount(nodes);
+    for (size_t i = 0; i < g.mNumInner && count < needed; ++i)
+    {
+        if (isVBlocking(g.mFirstInner + i, nodes))
+        {
+            ++count;
+        }
+    }
+    return count >= needed;
+}
+
+QuorumSetCompiler::QuorumSetCompiler() : mCache(CACHE_SIZE)
+{
+}
+
+CompiledQuorumSetPtr
+QuorumSetCompiler::compile(Hash const& qSetHash, SCPQuorumSet const& qSet)
+{
+    auto cached = mCache.maybeGet(qSetHash);
+    if (cached)
+    {
+        return *cached;
+    }
+    auto res = compile(qSet);
+    mCache.put(qSetHash, res);
+    return res;
+}
+
+CompiledQuorumSetPtr
+QuorumSetCompiler::compile(SCPQuorumSet const& qSet)
+{
+    ZoneScoped;
+    auto res = std::make_shared<CompiledQuorumSet>();
+    res->mGroups.resize(1);
+    compileGroup(qSet, *res, 0);
+    return res;
+}
+
+void
+QuorumSetCompiler::compileGroup(SCPQuorumSet const& qSet,
+                                CompiledQuorumSet& out, size_t group)
+{
+    // A BitSet counts a validator listed twice only once, where the walk over
+    // the XDR counts it twice; repeats become singleton inner groups so that
+    // results match for quorum sets that are not sane as well
+    BitSet validators;
+    std::vector<size_t> repeats;
+    for (auto const& v : qSet.validators)
+    {
+        auto i = indexOf(v);
+        if (validators.get(i))
+        {
+            repeats.emplace_back(i);
+        }
+        else
+        {
+            validators.set(i);
+        }
+    }
+
+    // Groups are appended as they are compiled, so refer to them by position
+    // rather than by reference
+    size_t firstInner = out.mGroups.size();
+    size_t numInner = qSet.innerSets.size() + repeats.size();
+    out.mGroups[group].mThreshold = qSet.threshold;
+    out.mGroups[group].mValidators = validators;
+    out.mGroups[group].mMembers =
+        qSet.validators.size() + qSet.innerSets.size();
+    out.mGroups[group].mFirstInner = firstInner;
+    out.mGroups[group].mNumInner = numInner;
+    out.mGroups.resize(firstInner + numInner);
+
+    for (size_t i = 0; i < qSet.innerSets.size(); ++i)
+    {
+        compileGroup(qSet.innerSets[i], out, firstInner + i);
+    }
+    for (size_t i = 0; i < repeats.size(); ++i)
+    {
+        auto& single = out.mGroups[firstInner + qSet.innerSets.size() + i];
+        single.mThreshold = 1;
+        single.mValidators.set(repeats[i]);
+        single.mMembers = 1;
+    }
+}
+
+size_t
+QuorumSetCompiler::indexOf(NodeID const& nodeID)
+{
+    return mIndices.emplace(nodeID, mIndices.size()).first->second;
+}
+
+std::optional<size_t>
+QuorumSetCompiler::findIndex(NodeID const& nodeID) const
+{
+    auto it = mIndices.find(nodeID);
+    if (it == mIndices.end())
+    {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+void
+QuorumSetCompiler::maybeReset()
+{
+    if (mIndices.size() > MAX_INDEXED_NODES)
+    {
+        mIndices.clear();
+        mCache.clear();
+    }
+}
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "crypto/SecretKey.h"
+#include "scp/SCPDriver.h"
+#include "util/BitSet.h"
+#include "util/HashOfHash.h"
+#include "util/NonCopyable.h"
+#include "util/RandomEvictionCache.h"
+#include "util/UnorderedMap.h"
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace stellar
+{
+
+/**
+ * A quorum set compiled for fast evaluation. Every node is replaced by a
+ * dense index assigned by a QuorumSetCompiler, and the nested sets are
+ * flattened into groups, each a threshold over a BitSet of validators and a
+ * range of inner groups. Testing a set of nodes, given as a BitSet over the
+ * same indices, then costs a few word-wise intersections per group instead of
+ * a NodeID lookup per validator.
+ */
+class CompiledQuorumSet
+{
+  public:
+    // Same results as LocalNode::isQuorumSlice and LocalNode::isVBlocking on
+    // the quorum set this was compiled from
+    bool isQuorumSlice(BitSet const& nodes) const;
+    bool isVBlocking(BitSet const& nodes) const;
+
+  private:
+    friend class QuorumSetCompiler;
+
+    struct Group
+    {
+        uint32 mThreshold{0};
+        BitSet mValidators;
+        // Number of validators and inner sets in the original quorum set
+        size_t mMembers{0};
+        // Inner groups are mGroups[mFirstInner, mFirstInner + mNumInner)
+        size_t mFirstInner{0};
+        size_t mNumInner{0};
+    };
+
+    // mGroups[0] is the top level
+    std::vector<Group> mGroups;
+
+    bool isQuorumSlice(size_t group, BitSet const& nodes) const;
+    bool isVBlocking(size_t group, BitSet const& nodes) const;
+};
+
+using CompiledQuorumSetPtr = std::shared_ptr<CompiledQuorumSet const>;
+
+/**
+ * Compiles quorum sets with node indices shared by all of them, and caches
+ * the results by quorum set hash.
+ */
+class QuorumSetCompiler : private NonMovableOrCopyable
+{
+  public:
+    QuorumSetCompiler();
+
+    // `qSetHash` must be the hash of `qSet`
+    CompiledQuorumSetPtr compile(Hash const& qSetHash,
+                                 SCPQuorumSet const& qSet);
+    // Compile without caching, for quorum sets built on the fly
+    CompiledQuorumSetPtr compile(SCPQuorumSet const& qSet);
+
+    // Index of `nodeID` if it is in any quorum set compiled since the last
+    // reset. Nodes without an index can't count towards any compiled set.
+    std::optional<size_t> findIndex(NodeID const& nodeID) const;
+
+    // Forget all indices and compiled quorum sets once too many nodes were
+    // indexed. Quorum sets compiled before must not be used afterwards, so
+    // this is only called between slots.
+    void maybeReset();
+
+  private:
+    static constexpr size_t CACHE_SIZE = 1000;
+    static constexpr size_t MAX_INDEXED_NODES = 100000;
+
+    UnorderedMap<NodeID, size_t> mIndices;
+    RandomEvictionCache<Hash, CompiledQuorumSetPtr> mCache;
+
+    size_t indexOf(NodeID const& nodeID);
+    void compileGroup(SCPQuorumSet const& qSet, CompiledQuorumSet& out,
+                      size_t group);
+};
+}
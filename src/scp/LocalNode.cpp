@@ -237,6 +237,85 @@ LocalNode::isQuorum(
     return isQuorumSlice(qSet, pNodes);
 }
 
+bool
+LocalNode::isVBlocking(CompiledQuorumSet const& qSet,
+                       QuorumSetCompiler const& compiler,
+                       std::map<NodeID, SCPEnvelopeWrapperPtr> const& map,
+                       std::function<bool(SCPStatement const&)> const& filter)
+{
+    ZoneScoped;
+    BitSet nodes;
+    for (auto const& it : map)
+    {
+        if (filter(it.second->getStatement()))
+        {
+            auto index = compiler.findIndex(it.first);
+            if (index)
+            {
+                nodes.set(*index);
+            }
+        }
+    }
+    return qSet.isVBlocking(nodes);
+}
+
+bool
+LocalNode::isQuorum(
+    CompiledQuorumSet const& qSet, QuorumSetCompiler const& compiler,
+    std::map<NodeID, SCPEnvelopeWrapperPtr> const& map,
+    std::function<CompiledQuorumSetPtr(SCPStatement const&)> const& qfun,
+    std::function<bool(SCPStatement const&)> const& filter)
+{
+    ZoneScoped;
+    struct Member
+    {
+        std::optional<size_t> mIndex;
+        CompiledQuorumSetPtr mQSet;
+    };
+    std::vector<Member> members;
+    BitSet nodes;
+    for (auto const& it : map)
+    {
+        auto const& st = it.second->getStatement();
+        if (filter(st))
+        {
+            auto index = compiler.findIndex(it.first);
+            if (index)
+            {
+                nodes.set(*index);
+            }
+            members.emplace_back(Member{index, qfun(st)});
+        }
+    }
+
+    // Remove nodes whose slice is not satisfied by the remaining ones until
+    // none is left to remove. Removing a node can only make other slices
+    // fail, so this reaches the same set as the uncompiled version.
+    bool removed;
+    do
+    {
+        removed = false;
+        for (size_t i = 0; i < members.size();)
+        {
+            auto const& m = members[i];
+            if (m.mQSet && m.mQSet->isQuorumSlice(nodes))
+            {
+                ++i;
+                continue;
+            }
+            if (m.mIndex)
+            {
+                nodes.unset(*m.mIndex);
+            }
+            std::swap(members[i], members.back());
+            members.pop_back();
+            removed = true;
+        }
+    } while (removed);
+
+    return qSet.isQuorumSlice(nodes);
+}
+
 std::vector<NodeID>
 LocalNode::findClosestVBlocking(
     SCPQuorumSet const& qset,
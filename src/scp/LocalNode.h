@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "lib/json/json-forwards.h"
+#include "scp/CompiledQuorumSet.h"
 #include "scp/SCPDriver.h"
 #include "util/HashOfHash.h"
 
@@ -78,6 +79,20 @@ class LocalNode
         std::function<bool(SCPStatement const&)> const& filter =
             [](SCPStatement const&) { return true; });
 
+    // Same as the two above, on quorum sets compiled by `compiler`. `qfun`
+    // returns nullptr for a node whose quorum set is unknown.
+    static bool isVBlocking(
+        CompiledQuorumSet const& qSet, QuorumSetCompiler const& compiler,
+        std::map<NodeID, SCPEnvelopeWrapperPtr> const& map,
+        std::function<bool(SCPStatement const&)> const& filter =
+            [](SCPStatement const&) { return true; });
+    static bool isQuorum(
+        CompiledQuorumSet const& qSet, QuorumSetCompiler const& compiler,
+        std::map<NodeID, SCPEnvelopeWrapperPtr> const& map,
+        std::function<CompiledQuorumSetPtr(SCPStatement const&)> const& qfun,
+        std::function<bool(SCPStatement const&)> const& filter =
+            [](SCPStatement const&) { return true; });
+
     // computes the distance to the set of v-blocking sets given
     // a set of nodes that agree (but can fail)
     // excluded, if set will be skipped altogether
@@ -19,7 +19,6 @@
 
 namespace stellar
 {
-using namespace std::placeholders;
 
 NominationProtocol::NominationProtocol(Slot& slot)
     : mSlot(slot), mRoundNumber(0), mNominationStarted(false), mTimerExpCount(0)
@@ -138,11 +137,51 @@ NominationProtocol::recordEnvelope(SCPEnvelopeWrapperPtr env)
     }
     else
     {
+        indexStatement(oldp->second->getStatement(), false);
         oldp->second = env;
     }
+    indexStatement(st, true);
     mSlot.recordStatement(env->getStatement());
 }
 
+void
+NominationProtocol::indexStatement(SCPStatement const& st, bool add)
+{
+    auto const& nom = st.pledges.nominate();
+    auto update = [&](Value const& v, std::set<NodeID> ValueNodes::*nodes) {
+        if (add)
+        {
+            (mValueIndex[v].*nodes).emplace(st.nodeID);
+            return;
+        }
+        auto it = mValueIndex.find(v);
+        if (it != mValueIndex.end())
+        {
+            (it->second.*nodes).erase(st.nodeID);
+            if (it->second.mVoted.empty() && it->second.mAccepted.empty())
+            {
+                mValueIndex.erase(it);
+            }
+        }
+    };
+    for (auto const& v : nom.votes)
+    {
+        update(v, &ValueNodes::mVoted);
+    }
+    for (auto const& v : nom.accepted)
+    {
+        update(v, &ValueNodes::mAccepted);
+    }
+}
+
+NominationProtocol::ValueNodes const&
+NominationProtocol::getValueNodes(Value const& v) const
+{
+    static ValueNodes const empty;
+    auto it = mValueIndex.find(v);
+    return it == mValueIndex.end() ? empty : it->second;
+}
+
 void
 NominationProtocol::emitNomination()
 {
@@ -188,16 +227,6 @@ NominationProtocol::emitNomination()
     }
 }
 
-bool
-NominationProtocol::acceptPredicate(Value const& v, SCPStatement const& st)
-{
-    auto const& nom = st.pledges.nominate();
-    bool res;
-    res = (std::find(nom.accepted.begin(), nom.accepted.end(), v) !=
-           nom.accepted.end());
-    return res;
-}
-
 void
 NominationProtocol::applyAll(SCPNomination const& nom,
                              std::function<void(Value const&)> processor)
@@ -220,10 +249,25 @@ void
 NominationProtocol::updateRoundLeaders()
 {
     ZoneScoped;
-    SCPQuorumSet myQSet = mSlot.getLocalNode()->getQuorumSet();
-
     auto localID = mSlot.getLocalNode()->getNodeID();
-    normalizeQSet(myQSet, &localID); // excludes self
+    auto const& qSetHash = mSlot.getLocalNode()->getQuorumSetHash();
+    if (mNodeWeights.empty() || qSetHash != mLocalQSetHash)
+    {
+        mLocalQSetHash = qSetHash;
+        mNormalizedLocalQSet = mSlot.getLocalNode()->getQuorumSet();
+        normalizeQSet(mNormalizedLocalQSet, &localID); // excludes self
+        mNodeWeights.clear();
+        mNodePriorities.clear();
+        auto& driver = mSlot.getSCPDriver();
+        mNodeWeights.emplace(localID, driver.getNodeWeight(
+                                          localID, mNormalizedLocalQSet, true));
+        LocalNode::forAllNodes(mNormalizedLocalQSet, [&](NodeID const& cur) {
+            mNodeWeights.emplace(
+                cur, driver.getNodeWeight(cur, mNormalizedLocalQSet, false));
+            return true;
+        });
+    }
+    auto const& myQSet = mNormalizedLocalQSet;
 
     size_t maxLeaderCount = 1; // includes self
     // note that node IDs here are unique ("sane"), so we can count by
@@ -239,10 +283,10 @@ NominationProtocol::updateRoundLeaders()
         std::set<NodeID> newRoundLeaders;
 
         newRoundLeaders.insert(localID);
-        uint64 topPriority = getNodePriority(localID, myQSet);
+        uint64 topPriority = getNodePriority(localID);
 
         LocalNode::forAllNodes(myQSet, [&](NodeID const& cur) {
-            uint64 w = getNodePriority(cur, myQSet);
+            uint64 w = getNodePriority(cur);
             if (w > topPriority)
             {
                 topPriority = w;
@@ -300,23 +344,48 @@ NominationProtocol::hashNode(bool isPriority, NodeID const& nodeID)
         mSlot.getSlotIndex(), mPreviousValue, isPriority, mRoundNumber, nodeID);
 }
 
+void
+NominationProtocol::maybeResetRoundHashes()
+{
+    if (mHashesRound != mRoundNumber)
+    {
+        mHashesRound = mRoundNumber;
+        mNodePriorities.clear();
+        mValueHashes.clear();
+    }
+}
+
 uint64
 NominationProtocol::hashValue(Value const& value)
 {
     ZoneScoped;
     dbgAssert(!mPreviousValue.empty());
-    return mSlot.getSCPDriver().computeValueHash(
-        mSlot.getSlotIndex(), mPreviousValue, mRoundNumber, value);
+    maybeResetRoundHashes();
+    auto it = mValueHashes.find(value);
+    if (it == mValueHashes.end())
+    {
+        it = mValueHashes
+                 .emplace(value, mSlot.getSCPDriver().computeValueHash(
+                                     mSlot.getSlotIndex(), mPreviousValue,
+                                     mRoundNumber, value))
+                 .first;
+    }
+    return it->second;
 }
 
 uint64
-NominationProtocol::getNodePriority(NodeID const& nodeID,
-                                    SCPQuorumSet const& qset)
+NominationProtocol::getNodePriority(NodeID const& nodeID)
 {
     ZoneScoped;
+    maybeResetRoundHashes();
+    auto it = mNodePriorities.find(nodeID);
+    if (it != mNodePriorities.end())
+    {
+        return it->second;
+    }
+
     uint64 res;
-    uint64 w = mSlot.getSCPDriver().getNodeWeight(
-        nodeID, qset, nodeID == mSlot.getLocalNode()->getNodeID());
+    uint64 w = mNodeWeights.at(nodeID);
 
     // if w > 0; w is inclusive here as
     // 0 <= hashNode <= UINT64_MAX
@@ -328,6 +397,7 @@ NominationProtocol::getNodePriority(NodeID const& nodeID,
     {
         res = 0;
     }
+    mNodePriorities.emplace(nodeID, res);
     return res;
 }
 
@@ -416,15 +486,14 @@ NominationProtocol::processEnvelope(SCPEnvelopeWrapperPtr envelope)
             { // v is already accepted
                 continue;
             }
+            auto const& nodes = getValueNodes(v);
             if (mSlot.federatedAccept(
-                    [&v](SCPStatement const& st) -> bool {
-                        auto const& nom = st.pledges.nominate();
-                        bool res;
-                        res = (std::find(nom.votes.begin(), nom.votes.end(),
-                                         v) != nom.votes.end());
-                        return res;
+                    [&nodes](SCPStatement const& st) {
+                        return nodes.mVoted.count(st.nodeID) != 0;
+                    },
+                    [&nodes](SCPStatement const& st) {
+                        return nodes.mAccepted.count(st.nodeID) != 0;
                     },
-                    std::bind(&NominationProtocol::acceptPredicate, v, _1),
                     mLatestNominations))
             {
                 auto vl = validateValue(v);
@@ -457,9 +526,11 @@ NominationProtocol::processEnvelope(SCPEnvelopeWrapperPtr envelope)
             {
                 continue;
             }
+            auto const& nodes = getValueNodes(a->getValue());
             if (mSlot.federatedRatify(
-                    std::bind(&NominationProtocol::acceptPredicate,
-                              a->getValue(), _1),
+                    [&nodes](SCPStatement const& st) {
+                        return nodes.mAccepted.count(st.nodeID) != 0;
+                    },
                     mLatestNominations))
             {
                 mCandidates.emplace(a);
@@ -551,7 +622,12 @@ NominationProtocol::nominate(ValueWrapperPtr value, Value const& previousValue,
 
     mNominationStarted = true;
 
-    mPreviousValue = previousValue;
+    if (mPreviousValue != previousValue)
+    {
+        mPreviousValue = previousValue;
+        mNodePriorities.clear();
+        mValueHashes.clear();
+    }
 
     mRoundNumber++;
     updateRoundLeaders();
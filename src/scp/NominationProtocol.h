@@ -6,7 +6,9 @@
 
 #include "lib/json/json-forwards.h"
 #include "scp/SCP.h"
+#include "util/UnorderedMap.h"
 #include <functional>
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
@@ -26,6 +28,16 @@ class NominationProtocol
     ValueWrapperPtrSet mCandidates;                             // Z
     std::map<NodeID, SCPEnvelopeWrapperPtr> mLatestNominations; // N
 
+    // nodes whose latest nomination votes for or accepts a value
+    struct ValueNodes
+    {
+        std::set<NodeID> mVoted;
+        std::set<NodeID> mAccepted;
+    };
+    // index of mLatestNominations by value, maintained by recordEnvelope so
+    // that federated voting on a value doesn't search every statement
+    std::map<Value, ValueNodes> mValueIndex;
+
     SCPEnvelopeWrapperPtr mLastEnvelope; // last envelope emitted by this node
 
     // nodes from quorum set that have the highest priority this round
@@ -40,6 +52,19 @@ class NominationProtocol
     // the value from the previous slot
     Value mPreviousValue;
 
+    // The local quorum set, normalized without the local node, and the
+    // weights of its nodes: these only change with the local quorum set.
+    Hash mLocalQSetHash;
+    SCPQuorumSet mNormalizedLocalQSet;
+    UnorderedMap<NodeID, uint64> mNodeWeights;
+
+    // Node priorities and value hashes of round mHashesRound, as leaders and
+    // the values they nominate are ranked many times per round
+    int32 mHashesRound{0};
+    UnorderedMap<NodeID, uint64> mNodePriorities;
+    std::map<Value, uint64> mValueHashes;
+    void maybeResetRoundHashes();
+
     bool isNewerStatement(NodeID const& nodeID, SCPNomination const& st);
 
     // returns true if 'p' is a subset of 'v'
@@ -54,12 +79,12 @@ class NominationProtocol
     bool isSane(SCPStatement const& st);
 
     void recordEnvelope(SCPEnvelopeWrapperPtr env);
+    void indexStatement(SCPStatement const& st, bool add);
+    // nodes voting for or accepting `v` (empty if none)
+    ValueNodes const& getValueNodes(Value const& v) const;
 
     void emitNomination();
 
-    // returns true if v is in the accepted list from the statement
-    static bool acceptPredicate(Value const& v, SCPStatement const& st);
-
     // applies 'processor' to all values from the passed in nomination
     static void applyAll(SCPNomination const& nom,
                          std::function<void(Value const&)> processor);
@@ -74,7 +99,7 @@ class NominationProtocol
     // computes Gi(K, prevValue, mRoundNumber, value)
     uint64 hashValue(Value const& value);
 
-    uint64 getNodePriority(NodeID const& nodeID, SCPQuorumSet const& qset);
+    uint64 getNodePriority(NodeID const& nodeID);
 
     // returns the highest value that we don't have yet, that we should
     // vote for, extracted from a nomination.
@@ -10,6 +10,7 @@
 #include "util/Logging.h"
 #include "util/XDROperators.h"
 #include "xdrpp/marshal.h"
+#include <Tracy.hpp>
 
 #include <algorithm>
 #include <lib/json/json.h>
@@ -30,6 +31,11 @@ SCP::EnvelopeState
 SCP::receiveEnvelope(SCPEnvelopeWrapperPtr envelope)
 {
     uint64 slotIndex = envelope->getStatement().slotIndex;
+    if (getCompactSlot(slotIndex))
+    {
+        // the slot is done, there is nothing left to update
+        return SCP::EnvelopeState::INVALID;
+    }
     return getSlot(slotIndex, true)->processEnvelope(envelope, false);
 }
 
@@ -38,6 +44,10 @@ SCP::nominate(uint64 slotIndex, ValueWrapperPtr value,
               Value const& previousValue)
 {
     dbgAssert(isValidator());
+    if (getCompactSlot(slotIndex))
+    {
+        return false;
+    }
     return getSlot(slotIndex, true)->nominate(value, previousValue, false);
 }
 
@@ -84,6 +94,108 @@ SCP::purgeSlots(uint64 maxSlotIndex, uint64 slotToKeep)
             it = mKnownSlots.erase(it);
         }
     }
+    auto cit = mCompactSlots.begin();
+    while (cit != mCompactSlots.end() && cit->first < maxSlotIndex)
+    {
+        if (cit->first == slotToKeep)
+        {
+            cit++;
+        }
+        else
+        {
+            cit = mCompactSlots.erase(cit);
+        }
+    }
+    // No quorum evaluation is in progress between slots
+    mQuorumSetCompiler.maybeReset();
+}
+
+void
+SCP::compactSlots(uint64 maxSlotIndex)
+{
+    ZoneScoped;
+    auto it = mKnownSlots.begin();
+    while (it != mKnownSlots.end() && it->first < maxSlotIndex)
+    {
+        auto const& slot = *it->second;
+        if (!slot.isExternalized())
+        {
+            it++;
+            continue;
+        }
+
+        std::set<NodeID> externalizing;
+        for (auto const& e : slot.getExternalizingState())
+        {
+            externalizing.emplace(e.statement.nodeID);
+        }
+
+        CompactSlot compact;
+        xdr::xvector<SCPEnvelope> envs;
+        slot.processCurrentState(
+            [&](SCPEnvelope const& e) {
+                auto const& st = e.statement;
+                compact.mExternalizing.push_back(
+                    st.pledges.type() != SCP_ST_NOMINATE &&
+                    externalizing.find(st.nodeID) != externalizing.end());
+                envs.emplace_back(e);
+                return true;
+            },
+            true);
+        compact.mEnvelopes =
+            std::make_shared<xdr::opaque_vec<> const>(xdr::xdr_to_opaque(envs));
+        compact.mFullyValidated = slot.isFullyValidated();
+        compact.mGotVBlocking = slot.gotVBlocking();
+
+        mCompactSlots.emplace(it->first, std::move(compact));
+        it = mKnownSlots.erase(it);
+    }
+}
+
+SCP::CompactSlot const*
+SCP::getCompactSlot(uint64 slotIndex) const
+{
+    auto it = mCompactSlots.find(slotIndex);
+    return it == mCompactSlots.end() ? nullptr : &it->second;
+}
+
+std::vector<SCPEnvelope>
+SCP::decodeEnvelopes(CompactSlot const& slot)
+{
+    xdr::xvector<SCPEnvelope> envs;
+    xdr::xdr_from_opaque(*slot.mEnvelopes, envs);
+    return std::move(envs);
+}
+
+Json::Value
+SCP::getCompactSlotJsonInfo(CompactSlot const& slot, bool fullKeys) const
+{
+    Json::Value ret;
+    int count = 0;
+    for (auto const& e : decodeEnvelopes(slot))
+    {
+        ret["statements"][count++] = envToStr(e, fullKeys);
+    }
+    ret["validated"] = slot.mFullyValidated;
+    ret["compacted"] = true;
+    return ret;
+}
+
+std::vector<uint64>
+SCP::getKnownSlotIndexes() const
+{
+    std::vector<uint64> res;
+    res.reserve(mKnownSlots.size() + mCompactSlots.size());
+    for (auto const& s : mKnownSlots)
+    {
+        res.emplace_back(s.first);
+    }
+    for (auto const& s : mCompactSlots)
+    {
+        res.emplace_back(s.first);
+    }
+    std::sort(res.begin(), res.end());
+    return res;
 }
 
 std::shared_ptr<LocalNode>
@@ -116,11 +228,19 @@ Json::Value
 SCP::getJsonInfo(size_t limit, bool fullKeys)
 {
     Json::Value ret;
-    auto it = mKnownSlots.rbegin();
-    while (it != mKnownSlots.rend() && limit-- != 0)
+    auto indexes = getKnownSlotIndexes();
+    auto it = indexes.rbegin();
+    while (it != indexes.rend() && limit-- != 0)
     {
-        auto& slot = *(it->second);
-        ret[std::to_string(slot.getSlotIndex())] = slot.getJsonInfo(fullKeys);
+        auto& v = ret[std::to_string(*it)];
+        if (auto compact = getCompactSlot(*it))
+        {
+            v = getCompactSlotJsonInfo(*compact, fullKeys);
+        }
+        else
+        {
+            v = getSlot(*it, false)->getJsonInfo(fullKeys);
+        }
         it++;
     }
 
@@ -247,6 +367,10 @@ SCP::isValidator()
 bool
 SCP::isSlotFullyValidated(uint64 slotIndex)
 {
+    if (auto compact = getCompactSlot(slotIndex))
+    {
+        return compact->mFullyValidated;
+    }
     auto slot = getSlot(slotIndex, false);
     if (slot)
     {
@@ -261,6 +385,10 @@ SCP::isSlotFullyValidated(uint64 slotIndex)
 bool
 SCP::gotVBlocking(uint64 slotIndex)
 {
+    if (auto compact = getCompactSlot(slotIndex))
+    {
+        return compact->mGotVBlocking;
+    }
     auto slot = getSlot(slotIndex, false);
     if (slot)
     {
@@ -275,7 +403,7 @@ SCP::gotVBlocking(uint64 slotIndex)
 size_t
 SCP::getKnownSlotsCount() const
 {
-    return mKnownSlots.size();
+    return mKnownSlots.size() + mCompactSlots.size();
 }
 
 size_t
@@ -292,6 +420,21 @@ SCP::getCumulativeStatemtCount() const
 std::vector<SCPEnvelope>
 SCP::getLatestMessagesSend(uint64 slotIndex)
 {
+    if (auto compact = getCompactSlot(slotIndex))
+    {
+        std::vector<SCPEnvelope> res;
+        if (compact->mFullyValidated)
+        {
+            for (auto& e : decodeEnvelopes(*compact))
+            {
+                if (e.statement.nodeID == getLocalNodeID())
+                {
+                    res.emplace_back(std::move(e));
+                }
+            }
+        }
+        return res;
+    }
     auto slot = getSlot(slotIndex, false);
     if (slot)
     {
@@ -306,6 +449,7 @@ SCP::getLatestMessagesSend(uint64 slotIndex)
 void
 SCP::setStateFromEnvelope(uint64 slotIndex, SCPEnvelopeWrapperPtr e)
 {
+    mCompactSlots.erase(slotIndex);
     auto slot = getSlot(slotIndex, true);
     slot->setStateFromEnvelope(e);
 }
@@ -313,7 +457,7 @@ SCP::setStateFromEnvelope(uint64 slotIndex, SCPEnvelopeWrapperPtr e)
 bool
 SCP::empty() const
 {
-    return mKnownSlots.empty();
+    return mKnownSlots.empty() && mCompactSlots.empty();
 }
 
 void
@@ -321,6 +465,22 @@ SCP::processCurrentState(uint64 slotIndex,
                          std::function<bool(SCPEnvelope const&)> const& f,
                          bool forceSelf)
 {
+    if (auto compact = getCompactSlot(slotIndex))
+    {
+        for (auto const& e : decodeEnvelopes(*compact))
+        {
+            // only return messages for self if the slot is fully validated
+            if (forceSelf || !(e.statement.nodeID == getLocalNodeID()) ||
+                compact->mFullyValidated)
+            {
+                if (!f(e))
+                {
+                    return;
+                }
+            }
+        }
+        return;
+    }
     auto slot = getSlot(slotIndex, false);
     if (slot)
     {
@@ -332,10 +492,12 @@ void
 SCP::processSlotsAscendingFrom(uint64 startingSlot,
                                std::function<bool(uint64)> const& f)
 {
-    for (auto iter = mKnownSlots.lower_bound(startingSlot);
-         iter != mKnownSlots.end(); ++iter)
+    auto indexes = getKnownSlotIndexes();
+    for (auto iter =
+             std::lower_bound(indexes.begin(), indexes.end(), startingSlot);
+         iter != indexes.end(); ++iter)
     {
-        if (!f(iter->first))
+        if (!f(*iter))
         {
             break;
         }
@@ -346,11 +508,12 @@ void
 SCP::processSlotsDescendingFrom(uint64 startingSlot,
                                 std::function<bool(uint64)> const& f)
 {
-    auto iter = mKnownSlots.upper_bound(startingSlot);
-    while (iter != mKnownSlots.begin())
+    auto indexes = getKnownSlotIndexes();
+    auto iter = std::upper_bound(indexes.begin(), indexes.end(), startingSlot);
+    while (iter != indexes.begin())
     {
         --iter;
-        if (!f(iter->first))
+        if (!f(*iter))
         {
             break;
         }
@@ -393,6 +556,19 @@ SCP::isNewerNominationOrBallotSt(SCPStatement const& oldSt,
 std::vector<SCPEnvelope>
 SCP::getExternalizingState(uint64 slotIndex)
 {
+    if (auto compact = getCompactSlot(slotIndex))
+    {
+        std::vector<SCPEnvelope> res;
+        auto envs = decodeEnvelopes(*compact);
+        for (size_t i = 0; i < envs.size(); i++)
+        {
+            if (compact->mExternalizing[i])
+            {
+                res.emplace_back(std::move(envs[i]));
+            }
+        }
+        return res;
+    }
     auto slot = getSlot(slotIndex, false);
     if (slot)
     {
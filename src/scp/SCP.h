@@ -4,13 +4,16 @@
 // under the Apache License, Version 2.0. See the COPYING file at the root
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
+#include <algorithm>
 #include <chrono>
 #include <functional>
 #include <map>
 #include <memory>
 #include <set>
+#include <vector>
 
 #include "lib/json/json-forwards.h"
+#include "scp/CompiledQuorumSet.h"
 #include "scp/SCPDriver.h"
 
 namespace stellar
@@ -68,6 +71,13 @@ class SCP
     // returns the local node descriptor
     std::shared_ptr<LocalNode> getLocalNode();
 
+    // compiles and caches quorum sets for quorum and v-blocking checks
+    QuorumSetCompiler&
+    getQuorumSetCompiler()
+    {
+        return mQuorumSetCompiler;
+    }
+
     Json::Value getJsonInfo(size_t limit, bool fullKeys = false);
 
     // Enum used to categorize nodes for getJsonQuorumInfo.
@@ -89,6 +99,12 @@ class SCP
     // than the specified `maxSlotIndex` except for slotToKeep slot.
     void purgeSlots(uint64 maxSlotIndex, uint64 slotToKeep);
 
+    // Replaces the externalized slots whose slotIndex is smaller than
+    // `maxSlotIndex` with a serialized copy of their latest envelopes. These
+    // slots keep answering the state queries below, but no longer process
+    // envelopes nor keep their statement history.
+    void compactSlots(uint64 maxSlotIndex);
+
     // Returns whether the local node is a validator.
     bool isValidator();
 
@@ -129,7 +145,7 @@ class SCP
                                     std::function<bool(uint64)> const& f);
 
     // returns the latest message from a node
-    // or nullptr if not found
+    // or nullptr if not found (compacted slots are not searched)
     SCPEnvelope const* getLatestMessage(NodeID const& id);
 
     bool isNewerNominationOrBallotSt(SCPStatement const& oldSt,
@@ -150,10 +166,37 @@ class SCP
     uint64
     getHighestKnownSlotIndex()
     {
-        return mKnownSlots.empty() ? 0 : mKnownSlots.rbegin()->first;
+        uint64 res = mKnownSlots.empty() ? 0 : mKnownSlots.rbegin()->first;
+        if (!mCompactSlots.empty())
+        {
+            res = std::max(res, mCompactSlots.rbegin()->first);
+        }
+        return res;
     }
 
   private:
+    // What is left of a slot after compactSlots
+    struct CompactSlot
+    {
+        // XDR of the latest envelopes of the slot, as visited by
+        // processCurrentState with forceSelf, shared with whoever decodes it
+        std::shared_ptr<xdr::opaque_vec<> const> mEnvelopes;
+        // whether each envelope is part of the externalizing state
+        std::vector<bool> mExternalizing;
+        bool mFullyValidated;
+        bool mGotVBlocking;
+    };
+
+    std::map<uint64, CompactSlot> mCompactSlots;
+
+    CompactSlot const* getCompactSlot(uint64 slotIndex) const;
+    static std::vector<SCPEnvelope> decodeEnvelopes(CompactSlot const& slot);
+    Json::Value getCompactSlotJsonInfo(CompactSlot const& slot,
+                                       bool fullKeys) const;
+
+    // indexes of all the live and compacted slots, in ascending order
+    std::vector<uint64> getKnownSlotIndexes() const;
+
     // Calculate the state of the node for the given slot index.
     QuorumInfoNodeState getState(NodeID const& node, uint64 slotIndex);
 
@@ -163,6 +206,7 @@ class SCP
   protected:
     std::shared_ptr<LocalNode> mLocalNode;
     std::map<uint64, std::shared_ptr<Slot>> mKnownSlots;
+    QuorumSetCompiler mQuorumSetCompiler;
 
     // Slot getter
     std::shared_ptr<Slot> getSlot(uint64 slotIndex, bool create);
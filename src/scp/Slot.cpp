@@ -335,6 +335,27 @@ Slot::getQuorumSetFromStatement(SCPStatement const& st)
     return res;
 }
 
+CompiledQuorumSetPtr
+Slot::getCompiledLocalQuorumSet()
+{
+    auto localNode = getLocalNode();
+    return mSCP.getQuorumSetCompiler().compile(localNode->getQuorumSetHash(),
+                                               localNode->getQuorumSet());
+}
+
+CompiledQuorumSetPtr
+Slot::getCompiledQuorumSetFromStatement(SCPStatement const& st)
+{
+    auto& compiler = mSCP.getQuorumSetCompiler();
+    if (st.pledges.type() == SCP_ST_EXTERNALIZE)
+    {
+        return compiler.compile(*LocalNode::getSingletonQSet(st.nodeID));
+    }
+    auto h = getCompanionQuorumSetHashFromStatement(st);
+    auto qSet = getSCPDriver().getQSet(h);
+    return qSet ? compiler.compile(h, *qSet) : nullptr;
+}
+
 Json::Value
 Slot::getJsonInfo(bool fullKeys)
 {
@@ -397,9 +418,12 @@ bool
 Slot::federatedAccept(StatementPredicate voted, StatementPredicate accepted,
                       std::map<NodeID, SCPEnvelopeWrapperPtr> const& envs)
 {
+    auto qSet = getCompiledLocalQuorumSet();
+    auto const& compiler = mSCP.getQuorumSetCompiler();
+
     // Checks if the nodes that claimed to accept the statement form a
     // v-blocking set
-    if (LocalNode::isVBlocking(getLocalNode()->getQuorumSet(), envs, accepted))
+    if (LocalNode::isVBlocking(*qSet, compiler, envs, accepted))
     {
         return true;
     }
@@ -413,8 +437,8 @@ Slot::federatedAccept(StatementPredicate voted, StatementPredicate accepted,
     };
 
     if (LocalNode::isQuorum(
-            getLocalNode()->getQuorumSet(), envs,
-            std::bind(&Slot::getQuorumSetFromStatement, this, _1),
+            *qSet, compiler, envs,
+            std::bind(&Slot::getCompiledQuorumSetFromStatement, this, _1),
             ratifyFilter))
     {
         return true;
@@ -428,8 +452,8 @@ Slot::federatedRatify(StatementPredicate voted,
                       std::map<NodeID, SCPEnvelopeWrapperPtr> const& envs)
 {
     return LocalNode::isQuorum(
-        getLocalNode()->getQuorumSet(), envs,
-        std::bind(&Slot::getQuorumSetFromStatement, this, _1), voted);
+        *getCompiledLocalQuorumSet(), mSCP.getQuorumSetCompiler(), envs,
+        std::bind(&Slot::getCompiledQuorumSetFromStatement, this, _1), voted);
 }
 
 std::shared_ptr<LocalNode>
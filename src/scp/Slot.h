@@ -105,6 +105,12 @@ class Slot : public std::enable_shared_from_this<Slot>
     // returns messages that helped this slot externalize
     std::vector<SCPEnvelope> getExternalizingState() const;
 
+    bool
+    isExternalized() const
+    {
+        return mBallotProtocol.isExternalized();
+    }
+
     // records the statement in the historical record for this slot
     void recordStatement(SCPStatement const& st);
 
@@ -178,6 +184,12 @@ class Slot : public std::enable_shared_from_this<Slot>
     // statement (singleton for externalize)
     SCPQuorumSetPtr getQuorumSetFromStatement(SCPStatement const& st);
 
+    // compiled forms of the local quorum set and of the quorum set of a
+    // statement, for quorum and v-blocking checks
+    CompiledQuorumSetPtr getCompiledLocalQuorumSet();
+    CompiledQuorumSetPtr
+    getCompiledQuorumSetFromStatement(SCPStatement const& st);
+
     // wraps a statement in an envelope (sign it, etc)
     SCPEnvelope createEnvelope(SCPStatement const& statement);
 
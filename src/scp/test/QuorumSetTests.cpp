@@ -6,8 +6,11 @@
 #include "crypto/SHA.h"
 #include "crypto/SecretKey.h"
 #include "main/Config.h"
+#include "scp/CompiledQuorumSet.h"
+#include "scp/LocalNode.h"
 #include "scp/QuorumSetUtils.h"
 #include "test/Catch2.h"
+#include "util/Math.h"
 #include "xdr/Stellar-SCP.h"
 #include <algorithm>
 
@@ -247,4 +250,64 @@ TEST_CASE("sane quorum set", "[scp][quorumset]")
         check(qSet, false, qSet);
     }
 }
+
+TEST_CASE("compiled quorum set", "[scp][quorumset]")
+{
+    std::vector<NodeID> keys;
+    for (auto i = 0; i < 16; i++)
+    {
+        keys.push_back(
+            SecretKey::fromSeed(sha256("NODE_SEED_" + std::to_string(i)))
+                .getPublicKey());
+    }
+
+    // Random nesting, thresholds (including 0 and unreachable ones) and
+    // repeated validators, none of which sane quorum sets would have
+    std::function<SCPQuorumSet(int)> randomQSet = [&](int depth) {
+        SCPQuorumSet qSet;
+        auto numValidators = rand_uniform<size_t>(0, 5);
+        for (size_t i = 0; i < numValidators; i++)
+        {
+            qSet.validators.push_back(rand_element(keys));
+        }
+        if (depth > 0)
+        {
+            auto numInner = rand_uniform<size_t>(0, 3);
+            for (size_t i = 0; i < numInner; i++)
+            {
+                qSet.innerSets.push_back(randomQSet(depth - 1));
+            }
+        }
+        qSet.threshold = rand_uniform<uint32>(
+            0, static_cast<uint32>(numValidators + qSet.innerSets.size() + 1));
+        return qSet;
+    };
+
+    for (int i = 0; i < 1000; i++)
+    {
+        QuorumSetCompiler compiler;
+        auto qSet = randomQSet(3);
+        auto compiled = compiler.compile(qSet);
+
+        std::vector<NodeID> nodes;
+        BitSet nodeBits;
+        for (auto const& k : keys)
+        {
+            if (rand_flip())
+            {
+                nodes.push_back(k);
+                auto index = compiler.findIndex(k);
+                if (index)
+                {
+                    nodeBits.set(*index);
+                }
+            }
+        }
+
+        REQUIRE(compiled->isQuorumSlice(nodeBits) ==
+                LocalNode::isQuorumSlice(qSet, nodes));
+        REQUIRE(compiled->isVBlocking(nodeBits) ==
+                LocalNode::isVBlocking(qSet, nodes));
+    }
+}
 }
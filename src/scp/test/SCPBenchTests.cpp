@@ -0,0 +1,292 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "crypto/SHA.h"
+#include "crypto/SecretKey.h"
+#include "lib/util/stdrandom.h"
+#include "scp/SCP.h"
+#include "test/Catch2.h"
+#include "util/Logging.h"
+#include "util/Math.h"
+#include "xdrpp/marshal.h"
+#include <Tracy.hpp>
+#include <algorithm>
+#include <chrono>
+#include <map>
+
+// Throughput benchmarks for the SCP library on its own: a single SCP instance
+// is fed the envelopes every other validator of a synthetic network would
+// send for a slot, with no overlay, herder or signature checks in the way.
+//
+// Run with `stellar-core test '[scpbench]'`. Allocations are not counted here;
+// build with --enable-tracy-memory-tracking and look at the "scp bench" zones
+// to see them.
+
+namespace stellar
+{
+
+namespace
+{
+
+using BenchClock = std::chrono::steady_clock;
+
+class BenchSCP : public SCPDriver
+{
+  public:
+    SCP mSCP;
+    SCPQuorumSetPtr mQSet;
+    Hash mQSetHash;
+    size_t mEmitted{0};
+    std::map<uint64, BenchClock::time_point> mExternalizedAt;
+
+    BenchSCP(NodeID const& nodeID, SCPQuorumSet const& qSet)
+        : mSCP(*this, nodeID, true, qSet)
+        , mQSet(std::make_shared<SCPQuorumSet>(qSet))
+        , mQSetHash(sha256(xdr::xdr_to_opaque(qSet)))
+    {
+    }
+
+    void
+    signEnvelope(SCPEnvelope&) override
+    {
+    }
+
+    SCPQuorumSetPtr
+    getQSet(Hash const& qSetHash) override
+    {
+        return qSetHash == mQSetHash ? mQSet : SCPQuorumSetPtr();
+    }
+
+    void
+    emitEnvelope(SCPEnvelope const& envelope) override
+    {
+        ++mEmitted;
+    }
+
+    SCPDriver::ValidationLevel
+    validateValue(uint64 slotIndex, Value const& value,
+                  bool nomination) override
+    {
+        return SCPDriver::kFullyValidatedValue;
+    }
+
+    Hash
+    getHashOf(std::vector<xdr::opaque_vec<>> const& vals) const override
+    {
+        SHA256 hasher;
+        for (auto const& v : vals)
+        {
+            hasher.add(v);
+        }
+        return hasher.finish();
+    }
+
+    ValueWrapperPtr
+    combineCandidates(uint64 slotIndex,
+                      ValueWrapperPtrSet const& candidates) override
+    {
+        return *candidates.begin();
+    }
+
+    // Timers never fire: every slot externalizes in the first round
+    void
+    setupTimer(uint64 slotIndex, int timerID, std::chrono::milliseconds timeout,
+               std::function<void()> cb) override
+    {
+    }
+
+    void
+    stopTimer(uint64 slotIndex, int timerID) override
+    {
+    }
+
+    std::chrono::milliseconds
+    computeTimeout(uint32 roundNumber, bool isNomination) override
+    {
+        return std::chrono::seconds(1);
+    }
+
+    void
+    valueExternalized(uint64 slotIndex, Value const& value) override
+    {
+        mExternalizedAt.emplace(slotIndex, BenchClock::now());
+    }
+};
+
+// Quorum set shapes for a network of `n` validators, after the ones in
+// simulation/Topologies.cpp
+enum class Shape
+{
+    // One flat set with a 2/3 + 1 threshold, like Topologies::core
+    FLAT,
+    // Organizations of 3 validators that need 2 of them, and 2/3 + 1 of the
+    // organizations, like the tier 1 of the public network
+    ORGS
+};
+
+size_t
+bftThreshold(size_t n)
+{
+    return 1 + (2 * n) / 3;
+}
+
+SCPQuorumSet
+makeQSet(Shape shape, std::vector<SecretKey> const& keys)
+{
+    SCPQuorumSet qSet;
+    if (shape == Shape::FLAT)
+    {
+        for (auto const& k : keys)
+        {
+            qSet.validators.emplace_back(k.getPublicKey());
+        }
+        qSet.threshold = static_cast<uint32>(bftThreshold(keys.size()));
+        return qSet;
+    }
+
+    size_t const orgSize = 3;
+    for (size_t i = 0; i < keys.size(); i += orgSize)
+    {
+        SCPQuorumSet org;
+        for (size_t j = i; j < std::min(i + orgSize, keys.size()); ++j)
+        {
+            org.validators.emplace_back(keys[j].getPublicKey());
+        }
+        org.threshold =
+            static_cast<uint32>(bftThreshold(org.validators.size()));
+        qSet.innerSets.emplace_back(org);
+    }
+    qSet.threshold = static_cast<uint32>(bftThreshold(qSet.innerSets.size()));
+    return qSet;
+}
+
+SCPEnvelopeWrapperPtr
+makeEnvelope(SCPDriver& driver, SecretKey const& key, uint64 slotIndex,
+             SCPStatement st)
+{
+    SCPEnvelope env;
+    env.statement = std::move(st);
+    env.statement.nodeID = key.getPublicKey();
+    env.statement.slotIndex = slotIndex;
+    return driver.wrapEnvelope(env);
+}
+
+// Everything a peer sends for `slotIndex` when the network agrees on `value`
+// in the first ballot, from nomination to confirming the commit
+std::vector<std::vector<SCPEnvelopeWrapperPtr>>
+makeSlotEnvelopes(BenchSCP& scp, std::vector<SecretKey> const& peers,
+                  uint64 slotIndex, Value const& value)
+{
+    SCPBallot ballot(1, value);
+    std::vector<std::vector<SCPEnvelopeWrapperPtr>> phases(3);
+    for (auto const& k : peers)
+    {
+        SCPStatement nom;
+        nom.pledges.type(SCP_ST_NOMINATE);
+        nom.pledges.nominate().quorumSetHash = scp.mQSetHash;
+        nom.pledges.nominate().votes.emplace_back(value);
+        nom.pledges.nominate().accepted.emplace_back(value);
+        phases[0].emplace_back(makeEnvelope(scp, k, slotIndex, nom));
+
+        SCPStatement prep;
+        prep.pledges.type(SCP_ST_PREPARE);
+        auto& p = prep.pledges.prepare();
+        p.quorumSetHash = scp.mQSetHash;
+        p.ballot = ballot;
+        p.prepared.activate() = ballot;
+        phases[1].emplace_back(makeEnvelope(scp, k, slotIndex, prep));
+
+        SCPStatement conf;
+        conf.pledges.type(SCP_ST_CONFIRM);
+        auto& c = conf.pledges.confirm();
+        c.quorumSetHash = scp.mQSetHash;
+        c.ballot = ballot;
+        c.nPrepared = 1;
+        c.nCommit = 1;
+        c.nH = 1;
+        phases[2].emplace_back(makeEnvelope(scp, k, slotIndex, conf));
+    }
+    for (auto& phase : phases)
+    {
+        stellar::shuffle(phase.begin(), phase.end(), getGlobalRandomEngine());
+    }
+    return phases;
+}
+
+void
+runBench(Shape shape, size_t nodes, uint64 slots)
+{
+    std::vector<SecretKey> keys;
+    for (size_t i = 0; i < nodes; ++i)
+    {
+        keys.emplace_back(SecretKey::pseudoRandomForTesting());
+    }
+    auto qSet = makeQSet(shape, keys);
+    BenchSCP scp(keys[0].getPublicKey(), qSet);
+    std::vector<SecretKey> peers(keys.begin() + 1, keys.end());
+
+    size_t received = 0;
+    BenchClock::duration busy{0};
+    BenchClock::duration totalLatency{0};
+    BenchClock::duration maxLatency{0};
+    Value prev = xdr::xdr_to_opaque(sha256("genesis"));
+    for (uint64 slot = 1; slot <= slots; ++slot)
+    {
+        Value value = xdr::xdr_to_opaque(sha256(std::to_string(slot)));
+        auto phases = makeSlotEnvelopes(scp, peers, slot, value);
+
+        ZoneNamedN(slotZone, "scp bench slot", true);
+        auto start = BenchClock::now();
+        scp.mSCP.nominate(slot, scp.wrapValue(value), prev);
+        for (auto const& phase : phases)
+        {
+            for (auto const& env : phase)
+            {
+                scp.mSCP.receiveEnvelope(env);
+                ++received;
+            }
+        }
+        auto end = BenchClock::now();
+        busy += end - start;
+
+        auto it = scp.mExternalizedAt.find(slot);
+        REQUIRE(it != scp.mExternalizedAt.end());
+        auto latency = it->second - start;
+        totalLatency += latency;
+        maxLatency = std::max(maxLatency, latency);
+
+        prev = value;
+        scp.mSCP.purgeSlots(slot, slot);
+    }
+
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    auto secs = std::chrono::duration<double>(busy).count();
+    LOG_INFO(DEFAULT_LOG,
+             "{} {} validators: {} envelopes in {:.3f}s, {:.0f} envelopes/sec, "
+             "{} emitted",
+             shape == Shape::FLAT ? "flat" : "orgs", nodes, received, secs,
+             received / secs, scp.mEmitted);
+    LOG_INFO(DEFAULT_LOG,
+             "{} {} validators: externalize latency mean {}us, max {}us",
+             shape == Shape::FLAT ? "flat" : "orgs", nodes,
+             duration_cast<microseconds>(totalLatency / slots).count(),
+             duration_cast<microseconds>(maxLatency).count());
+}
+}
+
+TEST_CASE("SCP envelope throughput", "[scp][scpbench][bench][!hide]")
+{
+    uint64 const slots = 20;
+    auto nodes = GENERATE(as<size_t>(), 10, 50, 100, 200, 400);
+    SECTION("flat quorum set")
+    {
+        runBench(Shape::FLAT, nodes, slots);
+    }
+    SECTION("organizations")
+    {
+        runBench(Shape::ORGS, nodes, slots);
+    }
+}
+}
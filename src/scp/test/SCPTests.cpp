@@ -3326,4 +3326,77 @@ TEST_CASE("nomination tests core5", "[scp][nominationprotocol]")
         testTimeouts(scp, test);
     }
 }
+
+TEST_CASE("compacted slots", "[scp]")
+{
+    setupValues();
+    SIMULATION_CREATE_NODE(0);
+    SIMULATION_CREATE_NODE(1);
+    SIMULATION_CREATE_NODE(2);
+
+    SCPQuorumSet qSet;
+    qSet.threshold = 2;
+    qSet.validators.push_back(v0NodeID);
+    qSet.validators.push_back(v1NodeID);
+    qSet.validators.push_back(v2NodeID);
+
+    uint256 qSetHash = sha256(xdr::xdr_to_opaque(qSet));
+
+    TestSCP scp(v0SecretKey.getPublicKey(), qSet);
+    scp.storeQuorumSet(std::make_shared<SCPQuorumSet>(qSet));
+
+    // slot 0 externalizes from the others, slot 1 is still going
+    SCPBallot b(1, xValue);
+    scp.receiveEnvelope(makeExternalize(v1SecretKey, qSetHash, 0, b, 1));
+    scp.receiveEnvelope(makeExternalize(v2SecretKey, qSetHash, 0, b, 1));
+    REQUIRE(scp.mExternalizedValues.size() == 1);
+    REQUIRE(scp.bumpState(1, xValue));
+
+    auto getState = [&](uint64 slotIndex, bool forceSelf) {
+        std::vector<SCPEnvelope> res;
+        scp.mSCP.processCurrentState(
+            slotIndex,
+            [&](SCPEnvelope const& e) {
+                res.emplace_back(e);
+                return true;
+            },
+            forceSelf);
+        return res;
+    };
+    auto state = getState(0, false);
+    auto sent = scp.mSCP.getLatestMessagesSend(0);
+    auto externalizing = scp.mSCP.getExternalizingState(0);
+    REQUIRE(state.size() == 3);
+    REQUIRE(sent.size() == 1);
+    REQUIRE(externalizing.size() == 3);
+
+    scp.mSCP.compactSlots(2);
+
+    REQUIRE(scp.mSCP.getKnownSlotsCount() == 2);
+    REQUIRE(scp.mSCP.isSlotFullyValidated(0));
+    REQUIRE(getState(0, false) == state);
+    REQUIRE(scp.mSCP.getLatestMessagesSend(0) == sent);
+    REQUIRE(scp.mSCP.getExternalizingState(0) == externalizing);
+
+    std::vector<uint64> slots;
+    scp.mSCP.processSlotsAscendingFrom(0, [&](uint64 i) {
+        slots.emplace_back(i);
+        return true;
+    });
+    REQUIRE(slots == std::vector<uint64>{0, 1});
+
+    auto info = scp.mSCP.getJsonInfo(2);
+    REQUIRE(info["0"]["compacted"].asBool());
+    REQUIRE(info["0"]["statements"].size() == 3);
+    REQUIRE(!info["1"].isMember("compacted"));
+
+    // compacted slots don't take new envelopes
+    auto late = makeExternalize(v1SecretKey, qSetHash, 0, b, 2);
+    REQUIRE(scp.mSCP.receiveEnvelope(scp.wrapEnvelope(late)) ==
+            SCP::EnvelopeState::INVALID);
+
+    scp.mSCP.purgeSlots(1, 1);
+    REQUIRE(scp.mSCP.getKnownSlotsCount() == 1);
+    REQUIRE(getState(0, true).empty());
+}
 }
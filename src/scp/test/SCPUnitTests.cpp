@@ -202,9 +202,9 @@ class NominationTestHandler : public NominationProtocol
     }
 
     uint64
-    getNodePriority(NodeID const& nodeID, SCPQuorumSet const& qset)
+    getNodePriority(NodeID const& nodeID)
     {
-        return NominationProtocol::getNodePriority(nodeID, qset);
+        return NominationProtocol::getNodePriority(nodeID);
     }
 };
 
@@ -20,6 +20,7 @@
 #include "bucket/BucketSnapshotManager.h"
 #include "util/GlobalChecks.h"
 #include "util/Logging.h"
+#include "util/MemoryAccounting.h"
 #include "util/XDRCereal.h"
 #include "xdrpp/printer.h"
 #include <crypto/SHA.h>
@@ -28,6 +29,19 @@ namespace stellar
 {
 namespace
 {
+// Total number of allocations made so far, across all subsystems
+uint64_t
+totalAllocations()
+{
+    uint64_t res = 0;
+    for (size_t i = 0; i < static_cast<size_t>(MemorySubsystem::COUNT); ++i)
+    {
+        res += memoryaccounting::getUsage(static_cast<MemorySubsystem>(i))
+                   .mTotalAllocations;
+    }
+    return res;
+}
+
 SorobanUpgradeConfig
 getUpgradeConfig(Config const& cfg)
 {
@@ -179,9 +193,12 @@ ApplyLoad::ApplyLoad(Application& app, ApplyLoadMode mode)
           {"soroban", "benchmark", "read-entry"}))
     , mWriteEntryUtilization(mApp.getMetrics().NewHistogram(
           {"soroban", "benchmark", "write-entry"}))
+    , mLedgerAllocations(mApp.getMetrics().NewHistogram(
+          {"soroban", "benchmark", "ledger-allocations"}))
     , mMode(mode)
     , mTxGenerator(app, mTotalHotArchiveEntries)
 {
+    releaseAssert(mMode != ApplyLoadMode::REPLAY);
     setup();
 }
 
@@ -767,7 +784,13 @@ ApplyLoad::benchmark()
             100000.0);
     }
 
+    auto allocationsBefore = totalAllocations();
     closeLedger(txs);
+    if (memoryaccounting::isEnabled())
+    {
+        mLedgerAllocations.Update(
+            static_cast<int64_t>(totalAllocations() - allocationsBefore));
+    }
 }
 
 double
@@ -824,5 +847,10 @@ ApplyLoad::getWriteEntryUtilization()
 {
     return mWriteEntryUtilization;
 }
+medida::Histogram const&
+ApplyLoad::getLedgerAllocations()
+{
+    return mLedgerAllocations;
+}
 
 }
@@ -16,7 +16,10 @@ enum class ApplyLoadMode
 {
     SOROBAN,
     CLASSIC,
-    MIX
+    MIX,
+    // Replays recorded ledgers with ReplayApplyLoad instead of generating
+    // load
+    REPLAY
 };
 
 class ApplyLoad
@@ -48,6 +51,11 @@ class ApplyLoad
     medida::Histogram const& getReadEntryUtilization();
     medida::Histogram const& getWriteEntryUtilization();
 
+    // Number of heap allocations made while closing each ledger in
+    // benchmark(), including building the tx set. Only populated when built
+    // with --enable-memory-accounting.
+    medida::Histogram const& getLedgerAllocations();
+
     // Returns LedgerKey for pre-populated archived state at the given index.
     static LedgerKey getKeyForArchivedEntry(uint64_t index);
     static uint32_t calculateRequiredHotArchiveEntries(Config const& cfg);
@@ -91,6 +99,7 @@ class ApplyLoad
     medida::Histogram& mWriteByteUtilization;
     medida::Histogram& mReadEntryUtilization;
     medida::Histogram& mWriteEntryUtilization;
+    medida::Histogram& mLedgerAllocations;
 
     ApplyLoadMode mMode;
     TxGenerator mTxGenerator;
@@ -176,6 +176,37 @@ LoadGenerator::getMode(std::string const& mode)
     }
 }
 
+std::string
+LoadGenerator::getModeName(LoadGenMode mode)
+{
+    switch (mode)
+    {
+    case LoadGenMode::PAY:
+        return "pay";
+    case LoadGenMode::PRETEND:
+        return "pretend";
+    case LoadGenMode::MIXED_CLASSIC:
+        return "mixed_classic";
+    case LoadGenMode::SOROBAN_UPLOAD:
+        return "soroban_upload";
+    case LoadGenMode::SOROBAN_INVOKE_SETUP:
+        return "soroban_invoke_setup";
+    case LoadGenMode::SOROBAN_INVOKE:
+        return "soroban_invoke";
+    case LoadGenMode::SOROBAN_UPGRADE_SETUP:
+        return "upgrade_setup";
+    case LoadGenMode::SOROBAN_CREATE_UPGRADE:
+        return "create_upgrade";
+    case LoadGenMode::MIXED_CLASSIC_SOROBAN:
+        return "mixed_classic_soroban";
+    case LoadGenMode::PAY_PREGENERATED:
+        return "pay_pregenerated";
+    case LoadGenMode::SOROBAN_INVOKE_APPLY_LOAD:
+        return "SOROBAN_INVOKE_APPLY_LOAD";
+    }
+    releaseAssert(false);
+}
+
 unsigned short
 LoadGenerator::chooseOpCount(Config const& cfg) const
 {
@@ -185,8 +216,7 @@ LoadGenerator::chooseOpCount(Config const& cfg) const
 }
 
 int64_t
-LoadGenerator::getTxPerStep(uint32_t txRate, std::chrono::seconds spikeInterval,
-                            uint32_t spikeSize)
+LoadGenerator::getTxPerStep(GeneratedLoadConfig const& cfg)
 {
     if (!mStartTime)
     {
@@ -198,15 +228,33 @@ LoadGenerator::getTxPerStep(uint32_t txRate, std::chrono::seconds spikeInterval,
     auto now = mApp.getClock().now();
     auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
         now - *mStartTime);
-    auto txs =
-        bigDivideOrThrow(elapsed.count(), txRate, 1000, Rounding::ROUND_DOWN);
-    if (spikeInterval.count() > 0)
+    int64_t txs;
+    if (cfg.poissonArrivals)
+    {
+        // Draw the number of arrivals since the last step
+        auto sinceLastStep = elapsed - mPoissonArrivalsElapsed;
+        if (cfg.txRate > 0 && sinceLastStep.count() > 0)
+        {
+            std::poisson_distribution<int64_t> arrivals(
+                static_cast<double>(cfg.txRate) * sinceLastStep.count() /
+                1000);
+            mPoissonArrivals += arrivals(getGlobalRandomEngine());
+            mPoissonArrivalsElapsed = elapsed;
+        }
+        txs = mPoissonArrivals;
+    }
+    else
+    {
+        txs = bigDivideOrThrow(elapsed.count(), cfg.txRate, 1000,
+                               Rounding::ROUND_DOWN);
+    }
+    if (cfg.spikeInterval.count() > 0)
     {
         txs += bigDivideOrThrow(
                    std::chrono::duration_cast<std::chrono::seconds>(elapsed)
                        .count(),
-                   1, spikeInterval.count(), Rounding::ROUND_DOWN) *
-               spikeSize;
+                   1, cfg.spikeInterval.count(), Rounding::ROUND_DOWN) *
+               cfg.spikeSize;
     }
 
     if (txs <= mTotalSubmitted)
@@ -261,6 +309,11 @@ LoadGenerator::reset()
     mPreLoadgenApplySorobanSuccess = 0;
     mPreLoadgenApplySorobanFailure = 0;
     mTransactionsAppliedAtTheStart = 0;
+
+    mPoissonArrivals = 0;
+    mPoissonArrivalsElapsed = std::chrono::milliseconds(0);
+    mPendingInclusion.clear();
+    mInclusionLatency = nullptr;
 }
 
 // Reset Soroban persistent state
@@ -419,6 +472,10 @@ LoadGenerator::start(GeneratedLoadConfig& cfg)
     mStartTime =
         std::make_unique<VirtualClock::time_point>(mApp.getClock().now());
 
+    mInclusionLatency = &mApp.getHdrMetrics().NewTimer(
+        {"loadgen", "inclusion-latency", getModeName(cfg.mode)});
+    mInclusionLatency->Clear();
+
     releaseAssert(mPreLoadgenApplySorobanSuccess == 0);
     releaseAssert(mPreLoadgenApplySorobanFailure == 0);
     mPreLoadgenApplySorobanSuccess =
@@ -428,10 +485,17 @@ LoadGenerator::start(GeneratedLoadConfig& cfg)
 
     if (cfg.mode == LoadGenMode::PAY_PREGENERATED)
     {
-        if (!mPreloadedTransactionsFile)
+        if (!mPreloadedTransactionsMapping && !mPreloadedTransactionsFile)
         {
-            mPreloadedTransactionsFile = XDRInputFileStream();
-            mPreloadedTransactionsFile->open(cfg.preloadedTransactionsFile);
+            mPreloadedTransactionsMapping =
+                MappedFile::map(cfg.preloadedTransactionsFile.string(),
+                                /* sequential */ true);
+            if (!mPreloadedTransactionsMapping)
+            {
+                mPreloadedTransactionsFile = XDRInputFileStream();
+                mPreloadedTransactionsFile->open(
+                    cfg.preloadedTransactionsFile);
+            }
         }
 
         // Preload all accounts
@@ -584,45 +648,7 @@ Json::Value
 GeneratedLoadConfig::getStatus() const
 {
     Json::Value ret;
-    std::string modeStr;
-    switch (mode)
-    {
-    case LoadGenMode::PAY:
-        modeStr = "pay";
-        break;
-    case LoadGenMode::PRETEND:
-        modeStr = "pretend";
-        break;
-    case LoadGenMode::MIXED_CLASSIC:
-        modeStr = "mixed_classic";
-        break;
-    case LoadGenMode::SOROBAN_UPLOAD:
-        modeStr = "soroban_upload";
-        break;
-    case LoadGenMode::SOROBAN_INVOKE_SETUP:
-        modeStr = "soroban_invoke_setup";
-        break;
-    case LoadGenMode::SOROBAN_INVOKE:
-        modeStr = "soroban_invoke";
-        break;
-    case LoadGenMode::SOROBAN_UPGRADE_SETUP:
-        modeStr = "upgrade_setup";
-        break;
-    case LoadGenMode::SOROBAN_CREATE_UPGRADE:
-        modeStr = "create_upgrade";
-        break;
-    case LoadGenMode::MIXED_CLASSIC_SOROBAN:
-        modeStr = "mixed_classic_soroban";
-        break;
-    case LoadGenMode::PAY_PREGENERATED:
-        modeStr = "pay_pregenerated";
-        break;
-    case LoadGenMode::SOROBAN_INVOKE_APPLY_LOAD:
-        modeStr = "SOROBAN_INVOKE_APPLY_LOAD";
-        break;
-    }
-
-    ret["mode"] = modeStr;
+    ret["mode"] = LoadGenerator::getModeName(mode);
 
     if (isSorobanSetup())
     {
@@ -690,7 +716,7 @@ LoadGenerator::generateLoad(GeneratedLoadConfig cfg)
         return;
     }
 
-    auto txPerStep = getTxPerStep(cfg.txRate, cfg.spikeInterval, cfg.spikeSize);
+    auto txPerStep = getTxPerStep(cfg);
     auto submitScope = mStepTimer.TimeScope();
 
     uint64_t now = mApp.timeNow();
@@ -935,9 +961,56 @@ LoadGenerator::submitTx(GeneratedLoadConfig const& cfg,
         std::tie(from, tx) = generateTx();
     }
 
+    releaseAssert(mInclusionLatency);
+    mPendingInclusion.emplace(tx->getFullHash(),
+                              PendingInclusion{mApp.getClock().now(),
+                                               mInclusionLatency});
     return true;
 }
 
+void
+LoadGenerator::txsIncluded(TxFrameList const& txs)
+{
+    ZoneScoped;
+    if (mPendingInclusion.empty())
+    {
+        return;
+    }
+
+    auto now = mApp.getClock().now();
+    for (auto const& tx : txs)
+    {
+        auto it = mPendingInclusion.find(tx->getFullHash());
+        if (it != mPendingInclusion.end())
+        {
+            it->second.mLatency->Update(now - it->second.mSubmitted);
+            mPendingInclusion.erase(it);
+        }
+    }
+}
+
+void
+LoadGenerator::logInclusionLatency(GeneratedLoadConfig const& cfg) const
+{
+    if (!mInclusionLatency)
+    {
+        return;
+    }
+    auto snap = mInclusionLatency->GetSnapshot();
+    if (snap.count() == 0)
+    {
+        return;
+    }
+    auto millis = [&](double q) {
+        return static_cast<double>(snap.getValueAtQuantile(q)) / 1e6;
+    };
+    CLOG_INFO(LoadGen,
+              "Inclusion latency of {} {} transactions: p50 {:.1f}ms, p99 "
+              "{:.1f}ms, p99.9 {:.1f}ms",
+              snap.count(), getModeName(cfg.mode), millis(0.5), millis(0.99),
+              millis(0.999));
+}
+
 uint64_t
 LoadGenerator::getNextAvailableAccount(uint32_t ledgerNum)
 {
@@ -1270,6 +1343,7 @@ LoadGenerator::waitTillComplete(GeneratedLoadConfig cfg)
     if (classicIsDone && sorobanIsDone && cfg.isDone())
     {
         // Check whether run met the minimum success rate for soroban invoke
+        logInclusionLatency(cfg);
         if (checkMinimumSorobanSuccess(cfg))
         {
             CLOG_INFO(LoadGen, "Load generation complete.");
@@ -1412,9 +1486,34 @@ LoadGenerator::execute(TransactionFrameBasePtr txf, LoadGenMode mode,
     switch (mode)
     {
     case LoadGenMode::PAY:
-    case LoadGenMode::PAY_PREGENERATED:
         txm.mNativePayment.Mark(txf->getNumOperations());
         break;
+    case LoadGenMode::PAY_PREGENERATED:
+        // Pre-generated files may hold Soroban setup and load as well
+        if (txf->isSoroban())
+        {
+            auto const& hf = txf->getRawOperations()
+                                 .front()
+                                 .body.invokeHostFunctionOp()
+                                 .hostFunction;
+            switch (hf.type())
+            {
+            case HOST_FUNCTION_TYPE_UPLOAD_CONTRACT_WASM:
+                txm.mSorobanUploadTxs.Mark();
+                break;
+            case HOST_FUNCTION_TYPE_INVOKE_CONTRACT:
+                txm.mSorobanInvokeTxs.Mark();
+                break;
+            default:
+                txm.mSorobanSetupInvokeTxs.Mark();
+                break;
+            }
+        }
+        else
+        {
+            txm.mNativePayment.Mark(txf->getNumOperations());
+        }
+        break;
     case LoadGenMode::PRETEND:
         txm.mPretendOps.Mark(txf->getNumOperations());
         break;
@@ -1796,8 +1895,28 @@ LoadGenerator::readTransactionFromFile(GeneratedLoadConfig const& cfg)
 
     // Read the next transaction from the file
     TransactionEnvelope txEnv;
-    releaseAssert(mPreloadedTransactionsFile);
-    if (!mPreloadedTransactionsFile->readOne(txEnv))
+    bool read;
+    if (mPreloadedTransactionsMapping)
+    {
+        auto const* data = mPreloadedTransactionsMapping->data();
+        auto size = mPreloadedTransactionsMapping->size();
+        // A page the size of a record mark only covers the record starting at
+        // the offset
+        read = XDRInputFileStream::scanPageFromMemory(
+            data, size, mPreloadedTransactionsOffset, /* pageSize */ 4,
+            [&](char const* body, size_t sz) {
+                xdr::xdr_get g(body, body + sz);
+                xdr::xdr_argpack_archive(g, txEnv);
+                mPreloadedTransactionsOffset = (body - data) + sz;
+                return true;
+            });
+    }
+    else
+    {
+        releaseAssert(mPreloadedTransactionsFile);
+        read = mPreloadedTransactionsFile->readOne(txEnv);
+    }
+    if (!read)
     {
         throw std::runtime_error("LoadGenerator: End of file reached, more "
                                  "transactions are needed");
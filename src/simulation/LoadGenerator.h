@@ -10,6 +10,9 @@
 #include "simulation/TxGenerator.h"
 #include "test/TestAccount.h"
 #include "test/TxTests.h"
+#include "herder/TxSetFrame.h"
+#include "util/HdrHistogram.h"
+#include "util/MappedFile.h"
 #include "util/NonCopyable.h"
 #include "xdr/Stellar-types.h"
 #include <vector>
@@ -132,6 +135,10 @@ struct GeneratedLoadConfig
     // The number of transactions a spike injects on top of the
     // steady rate.
     uint32_t spikeSize = 0;
+    // When true, transactions arrive as a Poisson process of rate txRate
+    // rather than at a steady rate, so that the gaps between them are
+    // exponentially distributed. Spikes are still injected on top.
+    bool poissonArrivals = false;
     // When present, generate the transaction fees randomly with the fee rate up
     // to this value.
     std::optional<uint32_t> maxGeneratedFeeRate;
@@ -161,6 +168,7 @@ class LoadGenerator
     LoadGenerator(Application& app);
 
     static LoadGenMode getMode(std::string const& mode);
+    static std::string getModeName(LoadGenMode mode);
 
     // Returns true if loadgen has submitted all required TXs
     bool isDone(GeneratedLoadConfig const& cfg) const;
@@ -211,6 +219,12 @@ class LoadGenerator
 
     void stop();
 
+    // Records the inclusion latency of the transactions this generator
+    // submitted that are among txs, which the last closed ledger included.
+    // Latencies are timed per load mode by the HdrTimers
+    // loadgen.inclusion-latency.<mode>, which are cleared when a run starts.
+    void txsIncluded(TxFrameList const& txs);
+
   private:
     struct TxMetrics
     {
@@ -265,9 +279,28 @@ class LoadGenerator
     std::unordered_set<uint64_t> mAccountsInUse;
     std::unordered_set<uint64_t> mAccountsAvailable;
 
+    // Pre-generated transactions are decoded straight from a mapping of the
+    // file, or read through a stream where the file can't be mapped
+    std::unique_ptr<MappedFile const> mPreloadedTransactionsMapping;
+    size_t mPreloadedTransactionsOffset = 0;
     std::optional<XDRInputFileStream> mPreloadedTransactionsFile;
     uint32_t mCurrPreloadedTransaction = 0;
 
+    // Arrivals drawn so far with poissonArrivals, and the time since the
+    // start of the run they cover
+    int64_t mPoissonArrivals = 0;
+    std::chrono::milliseconds mPoissonArrivalsElapsed{0};
+
+    // Submission time of every transaction not yet included in a ledger,
+    // along with the latency timer of the run that submitted it
+    struct PendingInclusion
+    {
+        VirtualClock::time_point mSubmitted;
+        HdrTimer* mLatency;
+    };
+    UnorderedMap<Hash, PendingInclusion> mPendingInclusion;
+    HdrTimer* mInclusionLatency{nullptr};
+
     // Get an account ID not currently in use.
     uint64_t getNextAvailableAccount(uint32_t ledgerNum);
 
@@ -313,8 +346,9 @@ class LoadGenerator
 
     void reset();
     void resetSorobanState();
-    int64_t getTxPerStep(uint32_t txRate, std::chrono::seconds spikeInterval,
-                         uint32_t spikeSize);
+    int64_t getTxPerStep(GeneratedLoadConfig const& cfg);
+
+    void logInclusionLatency(GeneratedLoadConfig const& cfg) const;
 
     // Schedule a callback to generateLoad() STEP_MSECS milliseconds from now.
     void scheduleLoadGeneration(GeneratedLoadConfig cfg);
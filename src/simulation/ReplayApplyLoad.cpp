@@ -0,0 +1,237 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "simulation/ReplayApplyLoad.h"
+#include "bucket/BucketManager.h"
+#include "bucket/LiveBucketList.h"
+#include "crypto/SHA.h"
+#include "herder/LedgerCloseData.h"
+#include "ledger/LedgerCloseTimeline.h"
+#include "ledger/LedgerManager.h"
+#include "main/Application.h"
+#include "util/GlobalChecks.h"
+#include "util/Logging.h"
+#include "util/TmpDir.h"
+#include "util/XDRStream.h"
+#include <algorithm>
+#include <fmt/format.h>
+#include <json/json.h>
+#include <numeric>
+
+namespace stellar
+{
+
+namespace
+{
+namespace stdfs = std::filesystem;
+
+std::string const SQLITE_PREFIX = "sqlite3://";
+
+stdfs::path
+getSqlitePath(Config const& cfg)
+{
+    auto const& db = cfg.DATABASE.value;
+    if (db.rfind(SQLITE_PREFIX, 0) != 0 || db == SQLITE_PREFIX + ":memory:")
+    {
+        throw std::runtime_error(
+            "Replaying ledgers requires an on-disk SQLite database");
+    }
+    return db.substr(SQLITE_PREFIX.size());
+}
+
+// Copies the bucket directory, hard-linking the files when possible. The
+// lock file and temporary files of the node are left out.
+void
+copyBucketDir(stdfs::path const& from, stdfs::path const& to)
+{
+    stdfs::create_directories(to);
+    for (auto it = stdfs::recursive_directory_iterator(from);
+         it != stdfs::recursive_directory_iterator(); ++it)
+    {
+        auto rel = stdfs::relative(it->path(), from);
+        if (it.depth() == 0 && (rel == BucketManager::kLockFilename ||
+                                rel == "tmp"))
+        {
+            it.disable_recursion_pending();
+            continue;
+        }
+
+        auto target = to / rel;
+        if (it->is_directory())
+        {
+            stdfs::create_directories(target);
+            continue;
+        }
+        std::error_code ec;
+        stdfs::create_hard_link(it->path(), target, ec);
+        if (ec)
+        {
+            stdfs::copy_file(it->path(), target);
+        }
+    }
+}
+
+void
+copyDatabase(stdfs::path const& from, stdfs::path const& to)
+{
+    stdfs::copy_file(from, to);
+    // A database that wasn't closed cleanly keeps recent writes in its WAL
+    auto wal = stdfs::path(from.string() + "-wal");
+    if (stdfs::exists(wal))
+    {
+        stdfs::copy_file(wal, to.string() + "-wal");
+    }
+}
+
+int64_t
+getPercentile(std::vector<int64_t> const& sorted, double p)
+{
+    auto i = static_cast<size_t>(p * (sorted.size() - 1));
+    return sorted[i];
+}
+}
+
+ReplayApplyLoad::ReplayApplyLoad(Config const& cfg,
+                                 stdfs::path const& metaFile)
+    : mConfig(cfg)
+{
+    getSqlitePath(mConfig);
+
+    XDRInputFileStream in;
+    in.open(metaFile.string());
+    std::vector<char> raw;
+    while (in.readRaw(raw))
+    {
+        mLedgers.emplace_back(decodeForReplay(raw));
+    }
+    if (mLedgers.empty())
+    {
+        throw std::runtime_error("No ledgers to replay in " +
+                                 metaFile.string());
+    }
+    CLOG_INFO(Perf, "Loaded ledgers {} to {} for replay",
+              mLedgers.front().mHeader.ledgerSeq,
+              mLedgers.back().mHeader.ledgerSeq);
+}
+
+void
+ReplayApplyLoad::benchmark(size_t runs)
+{
+    TmpDirManager tdm(mConfig.BUCKET_DIR_PATH + "-replay");
+    for (size_t i = 0; i < runs; ++i)
+    {
+        CLOG_INFO(Perf, "Starting replay run {} of {}", i + 1, runs);
+        auto workDir = tdm.tmpDir("run");
+        runOnce(workDir.getName());
+    }
+}
+
+void
+ReplayApplyLoad::runOnce(stdfs::path const& workDir)
+{
+    auto bucketDir = workDir / "buckets";
+    auto dbPath = workDir / "stellar.db";
+    copyBucketDir(mConfig.BUCKET_DIR_PATH, bucketDir);
+    copyDatabase(getSqlitePath(mConfig), dbPath);
+
+    Config cfg = mConfig;
+    cfg.BUCKET_DIR_PATH = bucketDir.string();
+    cfg.DATABASE = SecretValue{SQLITE_PREFIX + dbPath.string()};
+    cfg.setNoListen();
+    cfg.AUTOMATIC_SELF_CHECK_PERIOD = std::chrono::seconds::zero();
+
+    VirtualClock clock(VirtualClock::REAL_TIME);
+    auto app = Application::create(clock, cfg, /* newDB */ false);
+    app->start();
+
+    auto& lm = app->getLedgerManager();
+    bool diverged = false;
+    size_t applied = 0;
+    for (auto const& ledger : mLedgers)
+    {
+        auto ledgerSeq = ledger.mHeader.ledgerSeq;
+        auto lcl = lm.getLastClosedLedgerNum();
+        if (ledgerSeq <= lcl)
+        {
+            continue;
+        }
+        if (ledgerSeq > lcl + 1)
+        {
+            throw std::runtime_error(fmt::format(
+                FMT_STRING("Can't replay ledger {} on top of ledger {}"),
+                ledgerSeq, lcl));
+        }
+
+        // Resolve merges between ledgers so that the time they take doesn't
+        // depend on how long earlier ledgers took, like in the other
+        // apply-load modes
+        auto& bl = app->getBucketManager().getLiveBucketList();
+        bl.resolveAllFutures();
+        releaseAssert(bl.futuresAllResolved());
+
+        lm.applyLedger(LedgerCloseData(ledgerSeq, ledger.mTxSet,
+                                       ledger.mHeader.scpValue));
+        ++applied;
+
+        auto timeline = lm.getCloseTimeline().getJson(1)["ledgers"][0];
+        mPhaseDurations["ledger"].emplace_back(
+            timeline["duration_us"].asInt64());
+        // Phases recorded several times in a ledger, e.g. once per thread,
+        // are summed up
+        std::map<std::string, int64_t> phases;
+        for (auto const& span : timeline["spans"])
+        {
+            phases[span["name"].asString()] += span["duration_us"].asInt64();
+        }
+        for (auto const& [name, duration] : phases)
+        {
+            mPhaseDurations[name].emplace_back(duration);
+        }
+
+        if (!diverged &&
+            lm.getLastClosedLedgerHeader().hash != xdrSha256(ledger.mHeader))
+        {
+            diverged = true;
+            CLOG_WARNING(Perf,
+                         "Ledger {} differs from the recorded one, the state "
+                         "replayed on doesn't match the recording",
+                         ledgerSeq);
+        }
+    }
+
+    if (applied == 0)
+    {
+        throw std::runtime_error(fmt::format(
+            FMT_STRING("No recorded ledger follows ledger {}"),
+            lm.getLastClosedLedgerNum()));
+    }
+    CLOG_INFO(Perf, "Replayed {} ledgers", applied);
+}
+
+std::map<std::string, std::vector<int64_t>> const&
+ReplayApplyLoad::getPhaseDurations() const
+{
+    return mPhaseDurations;
+}
+
+void
+ReplayApplyLoad::logResults() const
+{
+    for (auto const& [name, durations] : mPhaseDurations)
+    {
+        auto sorted = durations;
+        std::sort(sorted.begin(), sorted.end());
+        auto mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) /
+                    sorted.size();
+        CLOG_INFO(Perf,
+                  "{}: count {}, min {:.3f} ms, mean {:.3f} ms, p50 {:.3f} ms, "
+                  "p90 {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms",
+                  name, sorted.size(), sorted.front() / 1000.0, mean / 1000.0,
+                  getPercentile(sorted, 0.5) / 1000.0,
+                  getPercentile(sorted, 0.9) / 1000.0,
+                  getPercentile(sorted, 0.99) / 1000.0,
+                  sorted.back() / 1000.0);
+    }
+}
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "catchup/ReplayDebugMetaWork.h"
+#include "main/Config.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace stellar
+{
+
+// Benchmarks applying recorded ledgers, so that apply time improvements can
+// be measured on real traffic instead of synthetic load. The transaction sets
+// of the ledgers are read from a LedgerCloseMeta stream (such as a meta-debug
+// file or a METADATA_OUTPUT_STREAM capture) and applied on top of the state
+// of a node that is at the ledger preceding the first one to apply.
+//
+// Every run works on its own copy of the node's state, so the same ledgers
+// can be applied any number of times and the node's state is left untouched.
+// Bucket files are hard-linked into the copy when possible since they are
+// never modified.
+class ReplayApplyLoad
+{
+  public:
+    // cfg is the configuration of the node whose state is replayed on, which
+    // must use a SQLite database
+    ReplayApplyLoad(Config const& cfg, std::filesystem::path const& metaFile);
+
+    // Applies all the recorded ledgers once per run
+    void benchmark(size_t runs);
+
+    // Duration in microseconds of each phase of every ledger applied so far,
+    // keyed by the phase name. The whole ledger close is under "ledger".
+    std::map<std::string, std::vector<int64_t>> const&
+    getPhaseDurations() const;
+
+    // Logs the distribution of each phase's duration
+    void logResults() const;
+
+  private:
+    Config const mConfig;
+    std::vector<ReplayLedger> mLedgers;
+    std::map<std::string, std::vector<int64_t>> mPhaseDurations;
+
+    void runOnce(std::filesystem::path const& workDir);
+};
+}
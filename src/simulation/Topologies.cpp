@@ -4,6 +4,8 @@
 
 #include "simulation/Topologies.h"
 #include "crypto/SHA.h"
+#include "util/Math.h"
+#include <set>
 
 namespace stellar
 {
@@ -191,6 +193,54 @@ Topologies::branchedcycle(int nNodes, double quorumThresoldFraction,
     return simulation;
 }
 
+Simulation::pointer
+Topologies::randomGraph(int nNodes, int numWatchers, int extraConnections,
+                        double quorumThresoldFraction, Simulation::Mode mode,
+                        Hash const& networkID, Simulation::ConfigGen confGen,
+                        Simulation::QuorumSetAdjuster qSetAdjust)
+{
+    auto simulation =
+        Topologies::separate(nNodes, quorumThresoldFraction, mode, networkID,
+                             numWatchers, confGen, qSetAdjust);
+
+    auto nodes = simulation->getNodeIDs();
+    int total = static_cast<int>(nodes.size());
+    assert(total == nNodes + numWatchers);
+    stellar::shuffle(nodes.begin(), nodes.end(), getGlobalRandomEngine());
+
+    set<std::pair<int, int>> connected;
+    auto connect = [&](int from, int to) {
+        if (from == to ||
+            !connected.emplace(min(from, to), max(from, to)).second)
+        {
+            return false;
+        }
+        simulation->addPendingConnection(nodes[from], nodes[to]);
+        return true;
+    };
+
+    for (int from = 0; from < total; from++)
+    {
+        connect(from, (from + 1) % total);
+    }
+    // Give up on a node's extra connections rather than loop forever on
+    // graphs too small to fit them
+    for (int from = 0; from < total; from++)
+    {
+        for (int i = 0, attempts = 0;
+             i < extraConnections && attempts < 10 * extraConnections;
+             attempts++)
+        {
+            if (connect(from, rand_uniform(0, total - 1)))
+            {
+                i++;
+            }
+        }
+    }
+
+    return simulation;
+}
+
 Simulation::pointer
 Topologies::hierarchicalQuorum(
     int nBranches, Simulation::Mode mode, Hash const& networkID,
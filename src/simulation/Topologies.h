@@ -48,6 +48,16 @@ class Topologies
              Simulation::ConfigGen confGen = nullptr,
              Simulation::QuorumSetAdjuster qSetAdjust = nullptr);
 
+    // nNodes with same qSet plus numWatchers watchers, connected at random:
+    // a cycle through all the nodes in random order keeps the graph connected
+    // and every node initiates extraConnections more connections to random
+    // other nodes
+    static Simulation::pointer
+    randomGraph(int nNodes, int numWatchers, int extraConnections,
+                double quorumThresoldFraction, Simulation::Mode mode,
+                Hash const& networkID, Simulation::ConfigGen confGen = nullptr,
+                Simulation::QuorumSetAdjuster qSetAdjust = nullptr);
+
     // multi-tier quorum (core4 + mid-tier nodes that depend on 2 nodes of
     // core4) mid-tier connected round-robin to core4
     static Simulation::pointer hierarchicalQuorum(
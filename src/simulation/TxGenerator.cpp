@@ -553,7 +553,10 @@ TxGenerator::invokeSorobanLoadTransaction(
     // A tx created using this method may be discarded when creating the txSet,
     // so we need to refresh the TestAccount sequence number to avoid a
     // txBAD_SEQ.
-    account->loadSequenceNumber();
+    if (!mPregenerating)
+    {
+        account->loadSequenceNumber();
+    }
 
     auto tx = sorobanTransactionFrameFromOps(mApp.getNetworkID(), *account,
                                              {op}, {}, resources,
@@ -857,6 +860,12 @@ TxGenerator::reset()
     mAccounts.clear();
 }
 
+void
+TxGenerator::setPregenerating(bool pregenerating)
+{
+    mPregenerating = pregenerating;
+}
+
 TxGenerator::TestAccountPtr
 TxGenerator::getAccount(uint64_t accountId) const
 {
@@ -198,6 +198,11 @@ class TxGenerator
 
     void reset();
 
+    // Transactions written to pre-generated load files are not applied by
+    // this node, so source account sequence numbers must keep advancing
+    // locally rather than be reloaded from the ledger.
+    void setPregenerating(bool pregenerating);
+
     TestAccountPtr getAccount(uint64_t accountId) const;
     void addAccount(uint64_t accountId, TestAccountPtr account);
 
@@ -226,6 +231,8 @@ class TxGenerator
     // index of next entry to autorestore. LedgerKey can be derived from index
     // using ApplyLoad::getKeyForArchivedEntry.
     uint32_t mNextKeyToRestore{};
+
+    bool mPregenerating{false};
 };
 
 }
@@ -12,9 +12,11 @@
 #include "simulation/LoadGenerator.h"
 #include "simulation/Topologies.h"
 #include "test/Catch2.h"
+#include "test/TestUtils.h"
 #include "test/test.h"
 #include "transactions/test/SorobanTxTestUtils.h"
 #include "util/Math.h"
+#include "util/XDRStream.h"
 #include "util/finally.h"
 #include <fmt/format.h>
 
@@ -154,8 +156,11 @@ TEST_CASE("generate load with unique accounts", "[loadgen]")
         app.getConfig().LOADGEN_PREGENERATED_TRANSACTIONS_FILE;
     auto cleanup = gsl::finally([&]() { std::remove(fileName.c_str()); });
 
-    generateTransactions(app, fileName, nTxs, nAccounts,
-                         /* offset */ nAccounts);
+    PregeneratedLoadConfig pregeneratedCfg;
+    pregeneratedCfg.numTransactions = nTxs;
+    pregeneratedCfg.accounts = nAccounts;
+    pregeneratedCfg.offset = nAccounts;
+    generateTransactions(app, fileName, pregeneratedCfg);
 
     auto& loadGen = app.getLoadGenerator();
 
@@ -197,6 +202,28 @@ TEST_CASE("generate load with unique accounts", "[loadgen]")
             300 * simulation->getExpectedLedgerCloseTime(), false);
         REQUIRE(getSuccessfulTxCount() == nTxs);
     }
+    SECTION("poisson arrivals")
+    {
+        uint32_t const nTxs = 1000;
+
+        auto cfg = GeneratedLoadConfig::txLoad(LoadGenMode::PAY, nAccounts,
+                                               nTxs, /* txRate */ 50);
+        cfg.poissonArrivals = true;
+        loadGen.generateLoad(cfg);
+        simulation->crankUntil(
+            [&]() {
+                return app.getMetrics()
+                           .NewMeter({"loadgen", "run", "complete"}, "run")
+                           .count() == 1;
+            },
+            100 * simulation->getExpectedLedgerCloseTime(), false);
+        REQUIRE(getSuccessfulTxCount() == nTxs);
+        // Every submitted transaction got included in an externalized set
+        auto& latency = app.getHdrMetrics().NewTimer(
+            {"loadgen", "inclusion-latency", "pay"});
+        REQUIRE(latency.count() == nTxs);
+        REQUIRE(latency.GetSnapshot().getValueAtQuantile(0.5) > 0);
+    }
     SECTION("invalid loadgen parameters")
     {
         uint32 numAccounts = 100;
@@ -236,6 +263,101 @@ TEST_CASE("generate load with unique accounts", "[loadgen]")
     }
 }
 
+TEST_CASE("pregenerated soroban load file", "[loadgen][soroban]")
+{
+    uint32_t const nAccounts = 10;
+    uint32_t const nInstances = 3;
+    uint32_t const nTxs = 30;
+
+    VirtualClock clock;
+    auto cfg = getTestConfig();
+    cfg.GENESIS_TEST_ACCOUNT_COUNT = nAccounts;
+    auto app = createTestApplication(clock, cfg);
+
+    std::string fileName = cfg.LOADGEN_PREGENERATED_TRANSACTIONS_FILE;
+    auto cleanup = gsl::finally([&]() { std::remove(fileName.c_str()); });
+
+    PregeneratedLoadConfig loadCfg;
+    loadCfg.mode = PregeneratedLoadMode::SOROBAN_INVOKE;
+    loadCfg.numTransactions = nTxs;
+    loadCfg.accounts = nAccounts;
+    loadCfg.instances = nInstances;
+
+    auto generate = [&]() {
+        generateTransactions(*app, fileName, loadCfg);
+        std::vector<TransactionEnvelope> envs;
+        XDRInputFileStream in;
+        in.open(fileName);
+        TransactionEnvelope env;
+        while (in.readOne(env))
+        {
+            envs.emplace_back(env);
+        }
+        REQUIRE(envs.size() == 1 + nInstances + nTxs);
+
+        std::map<AccountID, SequenceNumber> lastSeqNums;
+        for (size_t i = 0; i < envs.size(); ++i)
+        {
+            auto const& tx = envs[i].v1().tx;
+            auto source = toAccountID(tx.sourceAccount);
+            REQUIRE(source == txtest::getAccount("TestAccount-" +
+                                                 std::to_string(i % nAccounts))
+                                  .getPublicKey());
+            auto it = lastSeqNums.find(source);
+            if (it != lastSeqNums.end())
+            {
+                REQUIRE(tx.seqNum == it->second + 1);
+            }
+            lastSeqNums[source] = tx.seqNum;
+
+            auto const& hf =
+                tx.operations.at(0).body.invokeHostFunctionOp().hostFunction;
+            if (i == 0)
+            {
+                REQUIRE(hf.type() == HOST_FUNCTION_TYPE_UPLOAD_CONTRACT_WASM);
+            }
+            else if (i <= nInstances)
+            {
+                REQUIRE(hf.type() == HOST_FUNCTION_TYPE_CREATE_CONTRACT);
+            }
+            else
+            {
+                REQUIRE(hf.type() == HOST_FUNCTION_TYPE_INVOKE_CONTRACT);
+            }
+        }
+        return envs;
+    };
+
+    // Number of invocations of the first instance
+    auto countConflicting = [&](std::vector<TransactionEnvelope> const& envs) {
+        auto const& firstInstance = envs.at(1)
+                                        .v1()
+                                        .tx.ext.sorobanData()
+                                        .resources.footprint.readWrite.back()
+                                        .contractData()
+                                        .contract;
+        return static_cast<size_t>(std::count_if(
+            envs.begin() + 1 + nInstances, envs.end(), [&](auto const& env) {
+                return env.v1()
+                           .tx.operations.at(0)
+                           .body.invokeHostFunctionOp()
+                           .hostFunction.invokeContract()
+                           .contractAddress == firstInstance;
+            }));
+    };
+
+    SECTION("no conflicts")
+    {
+        loadCfg.conflictPercent = 0;
+        REQUIRE(countConflicting(generate()) == 0);
+    }
+    SECTION("all conflicts")
+    {
+        loadCfg.conflictPercent = 100;
+        REQUIRE(countConflicting(generate()) == nTxs);
+    }
+}
+
 TEST_CASE("modify soroban network config", "[loadgen][soroban]")
 {
     Hash networkID = sha256(getTestConfig().NETWORK_PASSPHRASE);
@@ -1560,6 +1560,18 @@ TransactionFuzzer::initialize()
 #ifdef BUILD_TESTS
     mApp->getInvariantManager().snapshotForFuzzer();
 #endif // BUILD_TESTS
+
+    // Every input starts from the state above. Rather than loading it back
+    // from the database for each of them, load it once into a LedgerTxn that
+    // inputs are applied on top of: rolling back their LedgerTxn is all it
+    // takes to restore the state.
+    resetTxInternalState(*mApp);
+    mSnapshot = std::make_unique<LedgerTxn>(mApp->getLedgerTxnRoot());
+    mSnapshot->load(accountKey(mSourceAccountID));
+    for (size_t i = 0; i < FuzzUtils::NUM_VALIDATED_LEDGER_KEYS; ++i)
+    {
+        mSnapshot->load(mStoredLedgerKeys[i]);
+    }
 }
 
 void
@@ -1971,6 +1983,7 @@ TransactionFuzzer::reduceTrustLineLimitsAfterSetup(AbstractLedgerTxn& ltxOuter)
 void
 TransactionFuzzer::shutdown()
 {
+    mSnapshot.reset();
     exit(1);
 }
 
@@ -2018,7 +2031,7 @@ TransactionFuzzer::inject(std::string const& filename)
     LOG_TRACE(DEFAULT_LOG, "{}",
               xdrToCerealString(ops, fmt::format("Fuzz ops ({})", ops.size())));
 
-    LedgerTxn ltx(mApp->getLedgerTxnRoot());
+    LedgerTxn ltx(*mSnapshot);
     applyFuzzOperations(ltx, mSourceAccountID, ops.begin(), ops.end(), *mApp);
 }
 
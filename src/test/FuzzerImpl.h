@@ -61,6 +61,9 @@ class TransactionFuzzer : public Fuzzer
     PublicKey mSourceAccountID;
     FuzzUtils::StoredLedgerKeys mStoredLedgerKeys;
     FuzzUtils::StoredPoolIDs mStoredPoolIDs;
+    // Holds the setup entries in memory. Inputs are applied in children of
+    // it that are rolled back, so it is never modified.
+    std::unique_ptr<LedgerTxn> mSnapshot;
 };
 
 class OverlayFuzzer : public Fuzzer
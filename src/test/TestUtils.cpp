@@ -3,6 +3,7 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "TestUtils.h"
+#include "crypto/SHA.h"
 #include "herder/TxSetFrame.h"
 #include "ledger/LedgerStateSnapshot.h"
 #include "ledger/test/LedgerTestUtils.h"
@@ -11,6 +12,7 @@
 #include "test/TxTests.h"
 #include "test/test.h"
 #include "transactions/test/SorobanTxTestUtils.h"
+#include "util/Math.h"
 #include "util/ProtocolVersion.h"
 #include "work/WorkScheduler.h"
 #include "xdrpp/marshal.h"
@@ -482,43 +484,125 @@ appProtocolVersionStartsFrom(Application& app, ProtocolVersion fromVersion)
 
 void
 generateTransactions(Application& app, std::filesystem::path const& outputFile,
-                     uint32_t numTransactions, uint32_t accounts,
-                     uint32_t offset)
+                     PregeneratedLoadConfig const& cfg)
 {
-    // Create a TxGenerator for generating payment transactions
+    if (cfg.accounts == 0)
+    {
+        throw std::runtime_error("Number of accounts must be greater than 0");
+    }
+    bool const invoke = cfg.mode == PregeneratedLoadMode::SOROBAN_INVOKE;
+    if (invoke && cfg.instances == 0)
+    {
+        throw std::runtime_error("Number of instances must be greater than 0");
+    }
+    if (cfg.conflictPercent > 100)
+    {
+        throw std::runtime_error("Conflict percentage must be at most 100");
+    }
+
     TxGenerator txgen(app);
+    txgen.setPregenerating(true);
 
     // Open the output file for writing
     std::remove(outputFile.string().c_str());
     XDROutputFileStream out(app.getClock().getIOContext(), true);
     out.open(outputFile.string());
 
-    if (accounts == 0)
+    uint32_t written = 0;
+    auto nextSourceAccount = [&]() -> uint64_t {
+        return (written % cfg.accounts) + cfg.offset;
+    };
+    auto write = [&](TransactionFrameBaseConstPtr const& tx) {
+        out.writeOne(tx->getEnvelope());
+        ++written;
+    };
+
+    std::vector<TxGenerator::ContractInstance> instances;
+    uint64_t contractOverheadBytes = 0;
+    if (invoke)
     {
-        throw std::runtime_error("Number of accounts must be greater than 0");
+        LOG_INFO(DEFAULT_LOG,
+                 "Generating setup transactions for {} contract instances...",
+                 cfg.instances);
+
+        auto wasm = rust_bridge::get_test_wasm_loadgen();
+        xdr::opaque_vec<> wasmBytes;
+        wasmBytes.assign(wasm.data.begin(), wasm.data.end());
+        LedgerKey codeKey(CONTRACT_CODE);
+        codeKey.contractCode().hash = sha256(wasmBytes);
+        // Same estimate as LoadGenerator's SOROBAN_INVOKE_SETUP
+        contractOverheadBytes = wasmBytes.size() + 160;
+
+        write(txgen
+                  .createUploadWasmTransaction(0, nextSourceAccount(),
+                                               wasmBytes, codeKey,
+                                               std::nullopt)
+                  .second);
+        for (uint32_t i = 0; i < cfg.instances; ++i)
+        {
+            auto salt = sha256("pregenerated" + std::to_string(i));
+            auto tx = txgen
+                          .createContractTransaction(
+                              0, nextSourceAccount(), codeKey,
+                              contractOverheadBytes, salt, std::nullopt)
+                          .second;
+            auto const& instanceKey =
+                tx->sorobanResources().footprint.readWrite.back();
+
+            TxGenerator::ContractInstance instance;
+            instance.readOnlyKeys.emplace_back(codeKey);
+            instance.readOnlyKeys.emplace_back(instanceKey);
+            instance.contractID = instanceKey.contractData().contract;
+            instances.emplace_back(instance);
+            write(tx);
+        }
     }
 
     LOG_INFO(DEFAULT_LOG,
-             "Generating {} payment transactions using {} accounts with offset "
-             "{}...",
-             numTransactions, accounts, offset);
+             "Generating {} transactions using {} accounts with offset {}...",
+             cfg.numTransactions, cfg.accounts, cfg.offset);
 
-    // Loop through accounts to create payment transactions
-    for (uint32_t i = 0; i < numTransactions; i++)
+    for (uint32_t i = 0; i < cfg.numTransactions; i++)
     {
-        uint64_t sourceAccountId = (i % accounts) + offset;
-
-        // Create a payment transaction
-        auto [account, tx] = txgen.paymentTransaction(
-            accounts, offset, 0, sourceAccountId, 1, std::nullopt);
-
-        // Convert to TransactionEnvelope and write to output
-        TransactionEnvelope txEnv = tx->getEnvelope();
-        out.writeOne(txEnv);
+        auto sourceAccountId = nextSourceAccount();
+        TransactionFrameBaseConstPtr tx;
+        switch (cfg.mode)
+        {
+        case PregeneratedLoadMode::PAY:
+            tx = txgen
+                     .paymentTransaction(cfg.accounts, cfg.offset, 0,
+                                         sourceAccountId, 1, std::nullopt)
+                     .second;
+            break;
+        case PregeneratedLoadMode::SOROBAN_UPLOAD:
+            tx = txgen
+                     .sorobanRandomWasmTransaction(
+                         0, sourceAccountId,
+                         txgen.generateFee(std::nullopt, /* opsCnt */ 1))
+                     .second;
+            break;
+        case PregeneratedLoadMode::SOROBAN_INVOKE:
+        {
+            // Invocations of the same instance write the same entries
+            size_t instanceIdx = 0;
+            if (instances.size() > 1 &&
+                rand_uniform<uint32_t>(1, 100) > cfg.conflictPercent)
+            {
+                instanceIdx = 1 + sourceAccountId % (instances.size() - 1);
+            }
+            tx = txgen
+                     .invokeSorobanLoadTransaction(
+                         0, sourceAccountId, instances[instanceIdx],
+                         contractOverheadBytes, std::nullopt)
+                     .second;
+            break;
+        }
+        }
+        write(tx);
     }
 
     out.close();
-    LOG_INFO(DEFAULT_LOG, "Generated {} transactions in {}", numTransactions,
+    LOG_INFO(DEFAULT_LOG, "Generated {} transactions in {}", written,
              outputFile);
 }
 }
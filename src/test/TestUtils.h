@@ -138,8 +138,35 @@ bool appProtocolVersionStartsFrom(Application& app,
 // Large enough fee to cover most of the Soroban transactions.
 constexpr uint32_t DEFAULT_TEST_RESOURCE_FEE = 1'000'000;
 
+// Kind of transactions written by generateTransactions
+enum class PregeneratedLoadMode
+{
+    PAY,
+    SOROBAN_UPLOAD,
+    SOROBAN_INVOKE
+};
+
+struct PregeneratedLoadConfig
+{
+    PregeneratedLoadMode mode = PregeneratedLoadMode::PAY;
+    uint32_t numTransactions = 1000;
+    uint32_t accounts = 100;
+    uint32_t offset = 0;
+
+    // SOROBAN_INVOKE only. The file starts with 1 + instances setup
+    // transactions (the Wasm upload, then one contract creation per instance),
+    // followed by numTransactions invocations. Invocations go to the first
+    // instance with probability conflictPercent / 100, so that they all write
+    // the same entries, and are otherwise spread over the remaining instances
+    // by source account.
+    uint32_t instances = 1;
+    uint32_t conflictPercent = 0;
+};
+
+// Writes transactions for LoadGenerator's PAY_PREGENERATED mode. The source
+// account of the i-th transaction is always (i % accounts) + offset. Soroban
+// footprints and resources follow the LOADGEN_* settings of app's config.
 void generateTransactions(Application& app,
                           std::filesystem::path const& outputFile,
-                          uint32_t numTransactions, uint32_t accounts,
-                          uint32_t offset);
+                          PregeneratedLoadConfig const& cfg);
 }
@@ -69,6 +69,7 @@ class ExtendFootprintTTLApplyHelper : virtual public LedgerAccessHelper
     ExtendFootprintTTLOpFrame const& mOpFrame;
 
     SorobanResources const& mResources;
+    SorobanFootprintTTLKeys const& mFootprintTTLKeys;
     SorobanNetworkConfig const& mSorobanConfig;
     Config const& mAppConfig;
 
@@ -86,6 +87,7 @@ class ExtendFootprintTTLApplyHelper : virtual public LedgerAccessHelper
         , mOpMeta(opMeta)
         , mOpFrame(opFrame)
         , mResources(mOpFrame.mParentTx.sorobanResources())
+        , mFootprintTTLKeys(mOpFrame.mParentTx.sorobanFootprintTTLKeys())
         , mSorobanConfig(app.getSorobanNetworkConfigForApply())
         , mAppConfig(app.getConfig())
         , mMetrics(app.getSorobanMetrics())
@@ -113,9 +115,11 @@ class ExtendFootprintTTLApplyHelper : virtual public LedgerAccessHelper
         uint32_t newLiveUntilLedgerSeq =
             getLedgerSeq() + mOpFrame.mExtendFootprintTTLOp.extendTo;
         auto ledgerVersion = getLedgerVersion();
-        for (auto const& lk : footprint.readOnly)
+        for (size_t i = 0; i < footprint.readOnly.size(); ++i)
         {
-            auto ttlKey = getTTLKey(lk);
+            auto const& lk = footprint.readOnly[i];
+            // Only Soroban entries are allowed in the footprint
+            auto const& ttlKey = mFootprintTTLKeys.readOnly[i].value();
 
             auto ttlLeOpt = getLedgerEntryOpt(ttlKey);
 
@@ -136,41 +140,45 @@ class ExtendFootprintTTLApplyHelper : virtual public LedgerAccessHelper
                 continue;
             }
 
-            auto entryOpt = getLedgerEntryOpt(lk);
+            // Load the ContractCode/ContractData entry for fee calculation,
+            // without copying it out.
+            bool withinLimits = false;
+            bool exists = withLedgerEntry(lk, [&](LedgerEntry const& entryLe) {
+                uint32_t entrySize =
+                    static_cast<uint32_t>(xdr::xdr_size(entryLe));
+
+                if (!validateContractLedgerEntry(
+                        lk, entrySize, mSorobanConfig, mAppConfig,
+                        mOpFrame.mParentTx, mDiagnosticEvents))
+                {
+                    innerResult(mRes).code(
+                        EXTEND_FOOTPRINT_TTL_RESOURCE_LIMIT_EXCEEDED);
+                    return;
+                }
+
+                if (!checkReadBytesResourceLimit(entrySize))
+                {
+                    return;
+                }
+
+                withinLimits = true;
+                rustEntryRentChanges.emplace_back(
+                    createEntryRentChangeWithoutModification(
+                        entryLe,
+                        getEntrySizeForRent(lk, entryLe, entrySize,
+                                            mSorobanConfig),
+                        /*entryLiveUntilLedger=*/currLiveUntilLedgerSeq,
+                        /*newLiveUntilLedger=*/newLiveUntilLedgerSeq));
+            });
             // We checked for TTLEntry existence above
-            releaseAssertOrThrow(entryOpt);
-
-            // Load the ContractCode/ContractData entry for fee calculation.
-
-            auto const& entryLe = *entryOpt;
-
-            uint32_t entrySize = static_cast<uint32_t>(xdr::xdr_size(entryLe));
-
-            if (!validateContractLedgerEntry(lk, entrySize, mSorobanConfig,
-                                             mAppConfig, mOpFrame.mParentTx,
-                                             mDiagnosticEvents))
-            {
-                innerResult(mRes).code(
-                    EXTEND_FOOTPRINT_TTL_RESOURCE_LIMIT_EXCEEDED);
-                return false;
-            }
-
-            if (!checkReadBytesResourceLimit(entrySize))
+            releaseAssertOrThrow(exists);
+            if (!withinLimits)
             {
                 return false;
             }
 
             // We already checked that the TTLEntry exists in the logic above
             auto ttlLe = *ttlLeOpt;
-
-            rustEntryRentChanges.emplace_back(
-                createEntryRentChangeWithoutModification(
-                    entryLe, entrySize,
-                    /*entryLiveUntilLedger=*/
-                    ttlLe.data.ttl().liveUntilLedgerSeq,
-                    /*newLiveUntilLedger=*/newLiveUntilLedgerSeq, ledgerVersion,
-                    mSorobanConfig));
-
             ttlLe.data.ttl().liveUntilLedgerSeq = newLiveUntilLedgerSeq;
 
             upsertLedgerEntry(ttlKey, ttlLe);
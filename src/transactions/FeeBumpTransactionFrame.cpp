@@ -56,6 +56,12 @@ FeeBumpTransactionFrame::sorobanResources() const
     return mInnerTx->sorobanResources();
 }
 
+SorobanFootprintTTLKeys const&
+FeeBumpTransactionFrame::sorobanFootprintTTLKeys() const
+{
+    return mInnerTx->sorobanFootprintTTLKeys();
+}
+
 SorobanTransactionData::_ext_t const&
 FeeBumpTransactionFrame::getResourcesExt() const
 {
@@ -509,8 +515,17 @@ FeeBumpTransactionFrame::getContentsHash() const
 {
     if (isZero(mContentsHash))
     {
-        mContentsHash = sha256(xdr::xdr_to_opaque(
-            mNetworkID, ENVELOPE_TYPE_TX_FEE_BUMP, mEnvelope.feeBump().tx));
+        CachedTxHashes hashes;
+        auto const& fullHash = getFullHash();
+        if (!getCachedTxHashes(fullHash, mNetworkID, hashes))
+        {
+            hashes.mNetworkID = mNetworkID;
+            hashes.mContentsHash = xdrSha256(
+                mNetworkID, ENVELOPE_TYPE_TX_FEE_BUMP, mEnvelope.feeBump().tx);
+            hashes.mSize = static_cast<uint32_t>(xdr::xdr_size(mEnvelope));
+            putCachedTxHashes(fullHash, hashes);
+        }
+        mContentsHash = hashes.mContentsHash;
     }
     return mContentsHash;
 }
@@ -520,11 +535,23 @@ FeeBumpTransactionFrame::getFullHash() const
 {
     if (isZero(mFullHash))
     {
-        mFullHash = sha256(xdr::xdr_to_opaque(mEnvelope));
+        mFullHash = xdrSha256(mEnvelope);
     }
     return mFullHash;
 }
 
+uint32_t
+FeeBumpTransactionFrame::getPrevalidatedLedgerSeq() const
+{
+    return mPrevalidatedLedgerSeq;
+}
+
+void
+FeeBumpTransactionFrame::setPrevalidatedLedgerSeq(uint32_t ledgerSeq) const
+{
+    mPrevalidatedLedgerSeq = ledgerSeq;
+}
+
 Hash const&
 FeeBumpTransactionFrame::getInnerFullHash() const
 {
@@ -609,6 +636,25 @@ FeeBumpTransactionFrame::insertKeysForTxApply(
     mInnerTx->insertKeysForTxApply(keys);
 }
 
+void
+FeeBumpTransactionFrame::insertSignaturesToVerify(
+    std::vector<PubKeyUtils::SignatureToVerify>& sigs, bool forApply) const
+{
+    // The outer signatures are only checked on validation
+    if (!forApply)
+    {
+        auto feeSourceID = getFeeSourceID();
+        for (auto const& sig : mEnvelope.feeBump().signatures)
+        {
+            if (SignatureUtils::doesHintMatch(feeSourceID.ed25519(), sig.hint))
+            {
+                sigs.push_back({feeSourceID, sig.signature, getContentsHash()});
+            }
+        }
+    }
+    mInnerTx->insertSignaturesToVerify(sigs, forApply);
+}
+
 MutableTxResultPtr
 FeeBumpTransactionFrame::processFeeSeqNum(AbstractLedgerTxn& ltx,
                                           std::optional<int64_t> baseFee) const
@@ -620,7 +666,18 @@ FeeBumpTransactionFrame::processFeeSeqNum(AbstractLedgerTxn& ltx,
     {
         throw std::runtime_error("Unexpected database state");
     }
-    auto& acc = feeSource.current().data.account();
+
+    auto res = processFeeSeqNum(feeSource.current(), header, baseFee);
+    header.feePool += res->getFeeCharged();
+    return res;
+}
+
+MutableTxResultPtr
+FeeBumpTransactionFrame::processFeeSeqNum(LedgerEntry& feeSource,
+                                          LedgerHeader const& header,
+                                          std::optional<int64_t> baseFee) const
+{
+    auto& acc = feeSource.data.account();
 
     auto fee = getFee(header, baseFee, true);
     if (fee > 0)
@@ -630,7 +687,6 @@ FeeBumpTransactionFrame::processFeeSeqNum(AbstractLedgerTxn& ltx,
         // are respected. In this case, we allow it to fall below that since it
         // will be caught later in commonValid.
         stellar::addBalance(acc.balance, -fee);
-        header.feePool += fee;
     }
 
     int64_t innerFeeCharged = mInnerTx->getFee(header, baseFee, true);
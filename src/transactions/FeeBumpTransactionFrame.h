@@ -28,6 +28,7 @@ class FeeBumpTransactionFrame : public TransactionFrameBase
     Hash const& mNetworkID;
     mutable Hash mContentsHash;
     mutable Hash mFullHash;
+    mutable uint32_t mPrevalidatedLedgerSeq{0};
 
     bool checkSignature(SignatureChecker& signatureChecker,
                         LedgerEntryWrapper const& account,
@@ -127,6 +128,8 @@ class FeeBumpTransactionFrame : public TransactionFrameBase
     Hash const& getContentsHash() const override;
     Hash const& getFullHash() const override;
     Hash const& getInnerFullHash() const;
+    uint32_t getPrevalidatedLedgerSeq() const override;
+    void setPrevalidatedLedgerSeq(uint32_t ledgerSeq) const override;
 
     uint32_t getNumOperations() const override;
     std::vector<std::shared_ptr<OperationFrame const>> const&
@@ -146,10 +149,16 @@ class FeeBumpTransactionFrame : public TransactionFrameBase
     void
     insertKeysForFeeProcessing(UnorderedSet<LedgerKey>& keys) const override;
     void insertKeysForTxApply(UnorderedSet<LedgerKey>& keys) const override;
+    void
+    insertSignaturesToVerify(std::vector<PubKeyUtils::SignatureToVerify>& sigs,
+                             bool forApply) const override;
 
     MutableTxResultPtr
     processFeeSeqNum(AbstractLedgerTxn& ltx,
                      std::optional<int64_t> baseFee) const override;
+    MutableTxResultPtr
+    processFeeSeqNum(LedgerEntry& feeSource, LedgerHeader const& header,
+                     std::optional<int64_t> baseFee) const override;
 
     std::shared_ptr<StellarMessage const> toStellarMessage() const override;
 
@@ -160,6 +169,7 @@ class FeeBumpTransactionFrame : public TransactionFrameBase
 
     bool isSoroban() const override;
     SorobanResources const& sorobanResources() const override;
+    SorobanFootprintTTLKeys const& sorobanFootprintTTLKeys() const override;
     SorobanTransactionData::_ext_t const& getResourcesExt() const override;
     virtual int64 declaredSorobanResourceFee() const override;
     virtual bool XDRProvidesValidFee() const override;
@@ -7,6 +7,7 @@
 #include "rust/RustVecXdrMarshal.h"
 #include "TransactionUtils.h"
 #include "util/GlobalChecks.h"
+#include "util/HdrHistogram.h"
 #include "util/Logging.h"
 #include "util/ProtocolVersion.h"
 #include "xdr/Stellar-ledger-entries.h"
@@ -101,6 +102,71 @@ maybePopulateOutputDiagnosticEvents(Config const& cfg,
     }
 }
 
+// Serialized XDR goes to the Soroban host in CxxBufs, each owning a byte
+// vector. Every thread that applies transactions keeps the vectors of its
+// previous invocations and serializes into them again, so marshalling an
+// invocation only allocates when an entry outgrows the buffer it reuses.
+class CxxBufPool
+{
+    // Bound what each thread holds onto between invocations
+    static constexpr size_t MAX_POOLED_BUFFERS = 256;
+    static constexpr size_t MAX_POOLED_BUFFER_CAPACITY = 64 * 1024;
+
+    std::vector<std::unique_ptr<std::vector<uint8_t>>> mFree;
+
+  public:
+    CxxBuf
+    emptyBuf()
+    {
+        if (mFree.empty())
+        {
+            return CxxBuf{std::make_unique<std::vector<uint8_t>>()};
+        }
+        CxxBuf buf{std::move(mFree.back())};
+        mFree.pop_back();
+        return buf;
+    }
+
+    template <typename T>
+    CxxBuf
+    toCxxBuf(T const& t)
+    {
+        auto buf = emptyBuf();
+        auto& bytes = *buf.data;
+        bytes.resize(xdr::xdr_size(t));
+        xdr::xdr_put p(bytes.data(), bytes.data() + bytes.size());
+        xdr_argpack_archive(p, t);
+        return buf;
+    }
+
+    void
+    release(CxxBuf& buf)
+    {
+        if (buf.data && mFree.size() < MAX_POOLED_BUFFERS &&
+            buf.data->capacity() <= MAX_POOLED_BUFFER_CAPACITY)
+        {
+            buf.data->clear();
+            mFree.emplace_back(std::move(buf.data));
+        }
+    }
+
+    void
+    release(rust::Vec<CxxBuf>& bufs)
+    {
+        for (auto& buf : bufs)
+        {
+            release(buf);
+        }
+    }
+};
+
+CxxBufPool&
+getCxxBufPool()
+{
+    thread_local CxxBufPool pool;
+    return pool;
+}
+
 } // namespace
 
 // Metrics for host function execution
@@ -235,7 +301,7 @@ struct HostFunctionMetrics
         }
     }
 
-    medida::TimerContext
+    HdrTimerContext
     getExecTimer()
     {
         return mMetrics.mHostFnOpExec.TimeScope();
@@ -253,6 +319,7 @@ class InvokeHostFunctionApplyHelper : virtual LedgerAccessHelper
     Hash const& mSorobanBasePrngSeed;
 
     SorobanResources const& mResources;
+    SorobanFootprintTTLKeys const& mFootprintTTLKeys;
     SorobanNetworkConfig const& mSorobanConfig;
     Config const& mAppConfig;
 
@@ -262,6 +329,8 @@ class InvokeHostFunctionApplyHelper : virtual LedgerAccessHelper
     HostFunctionMetrics mMetrics;
     SearchableHotArchiveSnapshotConstPtr mHotArchive;
     DiagnosticEventManager& mDiagnosticEvents;
+    // Helpers are created and destroyed on the applying thread
+    CxxBufPool& mBufPool;
 
     InvokeHostFunctionApplyHelper(
         AppConnector& app, Hash const& sorobanBasePrngSeed,
@@ -275,11 +344,13 @@ class InvokeHostFunctionApplyHelper : virtual LedgerAccessHelper
         , mOpFrame(opFrame)
         , mSorobanBasePrngSeed(sorobanBasePrngSeed)
         , mResources(mOpFrame.mParentTx.sorobanResources())
+        , mFootprintTTLKeys(mOpFrame.mParentTx.sorobanFootprintTTLKeys())
         , mSorobanConfig(app.getSorobanNetworkConfigForApply())
         , mAppConfig(app.getConfig())
         , mMetrics(app.getSorobanMetrics())
         , mHotArchive(app.copySearchableHotArchiveBucketListSnapshot())
         , mDiagnosticEvents(mOpMeta.getDiagnosticEventManager())
+        , mBufPool(getCxxBufPool())
     {
         mMetrics.mDeclaredCpuInsn = mResources.instructions;
         auto const& footprint = mResources.footprint;
@@ -291,6 +362,12 @@ class InvokeHostFunctionApplyHelper : virtual LedgerAccessHelper
         mTtlEntryCxxBufs.reserve(footprintLength);
     }
 
+    virtual ~InvokeHostFunctionApplyHelper()
+    {
+        mBufPool.release(mLedgerEntryCxxBufs);
+        mBufPool.release(mTtlEntryCxxBufs);
+    }
+
     virtual CxxLedgerInfo getLedgerInfo() = 0;
 
     // Helper called on all archived keys in the footprint. Returns false if
@@ -335,7 +412,9 @@ class InvokeHostFunctionApplyHelper : virtual LedgerAccessHelper
     // result code and diagnostic events. Returns true
     // if no failure occurred.
     bool
-    addReads(xdr::xvector<LedgerKey> const& footprintKeys, bool isReadOnly)
+    addReads(xdr::xvector<LedgerKey> const& footprintKeys,
+             std::vector<std::optional<LedgerKey>> const& ttlKeys,
+             bool isReadOnly)
     {
         auto ledgerSeq = getLedgerSeq();
         auto ledgerVersion = getLedgerVersion();
@@ -354,7 +433,7 @@ class InvokeHostFunctionApplyHelper : virtual LedgerAccessHelper
             // For soroban entries, check if the entry is expired before loading
             if (isSorobanEntry(lk))
             {
-                auto ttlKey = getTTLKey(lk);
+                auto const& ttlKey = *ttlKeys[i];
 
                 // handleArchivedEntry may need to load the TTL key to write the
                 // restored TTL, so make sure any TTL ltxe destructs before
@@ -424,20 +503,22 @@ class InvokeHostFunctionApplyHelper : virtual LedgerAccessHelper
 
             if (!isSorobanEntry(lk) || sorobanEntryLive)
             {
-                auto entryOpt = getLedgerEntryOpt(lk);
-                if (entryOpt)
+                // Serialize the entry where it lives: footprints routinely
+                // name large read-only entries, copying them first would
+                // double the marshalling cost.
+                CxxBuf leBuf;
+                if (withLedgerEntry(lk, [&](LedgerEntry const& le) {
+                        leBuf = mBufPool.toCxxBuf(le);
+                    }))
                 {
-                    auto leBuf = toCxxBuf(*entryOpt);
                     entrySize = static_cast<uint32_t>(leBuf.data->size());
 
                     // For entry types that don't have an ttlEntry (i.e.
                     // Accounts), the rust host expects an "empty" CxxBuf such
                     // that the buffer has a non-null pointer that points to an
                     // empty byte vector
-                    auto ttlBuf =
-                        ttlEntry
-                            ? toCxxBuf(*ttlEntry)
-                            : CxxBuf{std::make_unique<std::vector<uint8_t>>()};
+                    auto ttlBuf = ttlEntry ? mBufPool.toCxxBuf(*ttlEntry)
+                                           : mBufPool.emptyBuf();
 
                     mLedgerEntryCxxBufs.emplace_back(std::move(leBuf));
                     mTtlEntryCxxBufs.emplace_back(std::move(ttlBuf));
@@ -483,14 +564,15 @@ class InvokeHostFunctionApplyHelper : virtual LedgerAccessHelper
     bool
     addFootprint()
     {
-        if (!addReads(mResources.footprint.readOnly,
+        if (!addReads(mResources.footprint.readOnly, mFootprintTTLKeys.readOnly,
                       /*isReadOnly=*/true))
         {
             // Error code set in addReads
             return false;
         }
 
-        if (!addReads(mResources.footprint.readWrite, /*isReadOnly=*/false))
+        if (!addReads(mResources.footprint.readWrite,
+                      mFootprintTTLKeys.readWrite, /*isReadOnly=*/false))
         {
             // Error code set in addReads
             return false;
@@ -505,27 +587,29 @@ class InvokeHostFunctionApplyHelper : virtual LedgerAccessHelper
         authEntryCxxBufs.reserve(mOpFrame.mInvokeHostFunction.auth.size());
         for (auto const& authEntry : mOpFrame.mInvokeHostFunction.auth)
         {
-            authEntryCxxBufs.emplace_back(toCxxBuf(authEntry));
+            authEntryCxxBufs.emplace_back(mBufPool.toCxxBuf(authEntry));
         }
+        auto hostFnBuf =
+            mBufPool.toCxxBuf(mOpFrame.mInvokeHostFunction.hostFunction);
+        auto sourceAccountBuf = mBufPool.toCxxBuf(mOpFrame.getSourceID());
+        auto basePrngSeedBuf = mBufPool.emptyBuf();
+        basePrngSeedBuf.data->assign(mSorobanBasePrngSeed.begin(),
+                                     mSorobanBasePrngSeed.end());
 
         out.success = false;
         try
         {
-            CxxBuf basePrngSeedBuf{};
-            basePrngSeedBuf.data = std::make_unique<std::vector<uint8_t>>();
-            basePrngSeedBuf.data->assign(mSorobanBasePrngSeed.begin(),
-                                         mSorobanBasePrngSeed.end());
             auto moduleCache = mApp.getModuleCache();
 
+            // The resources are passed by value and owned by the host, the
+            // other buffers come back to the pool below
             out = rust_bridge::invoke_host_function(
                 mAppConfig.CURRENT_LEDGER_PROTOCOL_VERSION,
                 mAppConfig.ENABLE_SOROBAN_DIAGNOSTIC_EVENTS,
-                mResources.instructions,
-                toCxxBuf(mOpFrame.mInvokeHostFunction.hostFunction),
-                toCxxBuf(mResources), mAutoRestoredRwEntryIndices,
-                toCxxBuf(mOpFrame.getSourceID()), authEntryCxxBufs,
-                getLedgerInfo(), mLedgerEntryCxxBufs, mTtlEntryCxxBufs,
-                basePrngSeedBuf,
+                mResources.instructions, hostFnBuf, toCxxBuf(mResources),
+                mAutoRestoredRwEntryIndices, sourceAccountBuf,
+                authEntryCxxBufs, getLedgerInfo(), mLedgerEntryCxxBufs,
+                mTtlEntryCxxBufs, basePrngSeedBuf,
                 mSorobanConfig.rustBridgeRentFeeConfiguration(), *moduleCache);
             mMetrics.mCpuInsn = out.cpu_insns;
             mMetrics.mMemByte = out.mem_bytes;
@@ -544,6 +628,10 @@ class InvokeHostFunctionApplyHelper : virtual LedgerAccessHelper
             CLOG_DEBUG(Tx, "Exception caught while invoking host fn: {}",
                        e.what());
         }
+        mBufPool.release(authEntryCxxBufs);
+        mBufPool.release(hostFnBuf);
+        mBufPool.release(sourceAccountBuf);
+        mBufPool.release(basePrngSeedBuf);
 
         if (!out.success)
         {
@@ -653,8 +741,10 @@ class InvokeHostFunctionApplyHelper : virtual LedgerAccessHelper
         // NB: The entries that haven't been touched are passed through
         // from host, so this should never result in removing an entry
         // that hasn't been removed by host explicitly.
-        for (auto const& lk : mResources.footprint.readWrite)
+        auto const& readWrite = mResources.footprint.readWrite;
+        for (size_t i = 0; i < readWrite.size(); ++i)
         {
+            auto const& lk = readWrite[i];
             if (createdAndModifiedKeys.find(lk) == createdAndModifiedKeys.end())
             {
                 if (eraseLedgerEntryIfExists(lk))
@@ -662,7 +752,7 @@ class InvokeHostFunctionApplyHelper : virtual LedgerAccessHelper
                     releaseAssertOrThrow(isSorobanEntry(lk));
 
                     // Also delete associated ttlEntry
-                    auto ttlLK = getTTLKey(lk);
+                    auto const& ttlLK = *mFootprintTTLKeys.readWrite[i];
                     releaseAssertOrThrow(eraseLedgerEntryIfExists(ttlLK));
                 }
             }
@@ -940,7 +1030,7 @@ class InvokeHostFunctionParallelApplyHelper
             // In the auto restore case, we need to restore the entry and meter
             // disk reads. The host will take care of rent fees, and write fees
             // will be metered after the host returns.
-            auto leBuf = toCxxBuf(le);
+            auto leBuf = mBufPool.toCxxBuf(le);
             auto entrySize = static_cast<uint32>(leBuf.data->size());
             auto keySize = static_cast<uint32>(xdr::xdr_size(lk));
 
@@ -973,7 +1063,7 @@ class InvokeHostFunctionParallelApplyHelper
             }
 
             // Restore the entry to the live BucketList
-            auto ttlKey = getTTLKey(lk);
+            auto const& ttlKey = *mFootprintTTLKeys.readWrite[index];
             LedgerEntry ttlEntry;
             if (isHotArchiveEntry)
             {
@@ -999,7 +1089,7 @@ class InvokeHostFunctionParallelApplyHelper
 
             // Finally, add the entries to the Cxx buffer as if they were live.
             mLedgerEntryCxxBufs.emplace_back(std::move(leBuf));
-            auto ttlBuf = toCxxBuf(ttlEntry.data.ttl());
+            auto ttlBuf = mBufPool.toCxxBuf(ttlEntry.data.ttl());
             mTtlEntryCxxBufs.emplace_back(std::move(ttlBuf));
             mAutoRestoredRwEntryIndices.push_back(index);
 
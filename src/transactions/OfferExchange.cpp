@@ -1378,29 +1378,38 @@ getPoolID(Asset const& x, Asset const& y, int32_t feeBps)
     return xdrSha256(lpp);
 }
 
-static bool
-exchangeWithPool(AbstractLedgerTxn& ltxOuter, Asset const& toPoolAsset,
-                 int64_t maxSendToPool, int64_t& toPool,
-                 Asset const& fromPoolAsset, int64_t maxReceiveFromPool,
-                 int64_t& fromPool, RoundingType round,
-                 int64_t maxOffersToCross)
+// An exchange with a constant product pool that has been computed but not
+// done yet
+struct PoolExchange
 {
-    LedgerTxn ltx(ltxOuter);
+    PoolID poolID;
+    ExchangedQuantities quantities;
+};
 
+// Computes the exchange with the liquidity pool for the asset pair, if there is
+// one that can be used. The pool is loaded without being recorded, so the
+// order book can be tried from ltx right after and the exchange done with
+// applyPoolExchange without computing it again.
+static std::optional<PoolExchange>
+computePoolExchange(AbstractLedgerTxn& ltx, Asset const& toPoolAsset,
+                    int64_t maxSendToPool, Asset const& fromPoolAsset,
+                    int64_t maxReceiveFromPool, RoundingType round,
+                    int64_t maxOffersToCross)
+{
     if (protocolVersionIsBefore(ltx.loadHeader().current().ledgerVersion,
                                 ProtocolVersion::V_18))
     {
         // Only exchange with pools starting at protocol version 18
-        return false;
+        return std::nullopt;
     }
     if (isPoolTradingDisabled(ltx.loadHeader().current()))
     {
-        return false;
+        return std::nullopt;
     }
     if (round == RoundingType::NORMAL)
     {
         // Only exchange with pools for path payments
-        return false;
+        return std::nullopt;
     }
     if (maxOffersToCross == 0)
     {
@@ -1408,23 +1417,20 @@ exchangeWithPool(AbstractLedgerTxn& ltxOuter, Asset const& toPoolAsset,
         // liquidity pool
         // note that this condition can only happen in path payment when
         // performing subsequent hops
-        return false;
+        return std::nullopt;
     }
 
     int32_t const feeBps = LIQUIDITY_POOL_FEE_V18;
-    auto poolID = getPoolID(toPoolAsset, fromPoolAsset, feeBps);
-    auto lp = loadLiquidityPool(ltx, poolID);
+    PoolExchange res;
+    res.poolID = getPoolID(toPoolAsset, fromPoolAsset, feeBps);
+    auto lp = ltx.loadWithoutRecord(liquidityPoolKey(res.poolID));
     if (!lp)
     {
-        return false;
+        return std::nullopt;
     }
 
-    auto cp = [&lp]() -> auto&
-    {
-        return lp.current().data.liquidityPool().body.constantProduct();
-    };
-
-    if (cp().reserveA <= 0 || cp().reserveB <= 0)
+    auto const& cp = lp.current().data.liquidityPool().body.constantProduct();
+    if (cp.reserveA <= 0 || cp.reserveB <= 0)
     {
         // It is possible to have reserveA = reserveB = 0, specifically when a
         // pool share trust line exists but no deposits have been made. It
@@ -1432,39 +1438,23 @@ exchangeWithPool(AbstractLedgerTxn& ltxOuter, Asset const& toPoolAsset,
         //      reserveA = 0 && reserveB != 0
         //      reserveA < 0 || reserveB < 0
         // but for safety we disallow trading with the pool in those cases.
-        return false;
+        return std::nullopt;
     }
 
-    bool res = false;
-    if (toPoolAsset == cp().params.assetA &&
-        fromPoolAsset == cp().params.assetB)
+    auto& q = res.quantities;
+    bool exchanged = false;
+    if (toPoolAsset == cp.params.assetA && fromPoolAsset == cp.params.assetB)
     {
-        res = exchangeWithPool(cp().reserveA, maxSendToPool, toPool,
-                               cp().reserveB, maxReceiveFromPool, fromPool,
-                               feeBps, round);
-        if (res)
-        {
-            if (!addBalance(cp().reserveA, toPool) ||
-                !addBalance(cp().reserveB, -fromPool))
-            {
-                throw std::runtime_error("could not update reserves");
-            }
-        }
+        exchanged = exchangeWithPool(cp.reserveA, maxSendToPool, q.sheepSend,
+                                     cp.reserveB, maxReceiveFromPool,
+                                     q.wheatReceived, feeBps, round);
     }
-    else if (fromPoolAsset == cp().params.assetA &&
-             toPoolAsset == cp().params.assetB)
+    else if (fromPoolAsset == cp.params.assetA &&
+             toPoolAsset == cp.params.assetB)
     {
-        res = exchangeWithPool(cp().reserveB, maxSendToPool, toPool,
-                               cp().reserveA, maxReceiveFromPool, fromPool,
-                               feeBps, round);
-        if (res)
-        {
-            if (!addBalance(cp().reserveA, -fromPool) ||
-                !addBalance(cp().reserveB, toPool))
-            {
-                throw std::runtime_error("could not update reserves");
-            }
-        }
+        exchanged = exchangeWithPool(cp.reserveB, maxSendToPool, q.sheepSend,
+                                     cp.reserveA, maxReceiveFromPool,
+                                     q.wheatReceived, feeBps, round);
     }
     else
     {
@@ -1472,11 +1462,36 @@ exchangeWithPool(AbstractLedgerTxn& ltxOuter, Asset const& toPoolAsset,
         throw std::runtime_error("Invalid liquidity pool assets");
     }
 
-    if (res)
+    if (!exchanged)
     {
-        ltx.commit();
+        return std::nullopt;
     }
-    return res;
+    return std::make_optional(res);
+}
+
+// Does an exchange computed by computePoolExchange from the same state of
+// ltxOuter
+static void
+applyPoolExchange(AbstractLedgerTxn& ltxOuter, Asset const& toPoolAsset,
+                  PoolExchange const& exchange)
+{
+    LedgerTxn ltx(ltxOuter);
+    auto lp = loadLiquidityPool(ltx, exchange.poolID);
+    releaseAssertOrThrow(lp);
+    auto& cp = lp.current().data.liquidityPool().body.constantProduct();
+
+    auto toPool = exchange.quantities.sheepSend;
+    auto fromPool = exchange.quantities.wheatReceived;
+    bool updated = toPoolAsset == cp.params.assetA
+                       ? addBalance(cp.reserveA, toPool) &&
+                             addBalance(cp.reserveB, -fromPool)
+                       : addBalance(cp.reserveA, -fromPool) &&
+                             addBalance(cp.reserveB, toPool);
+    if (!updated)
+    {
+        throw std::runtime_error("could not update reserves");
+    }
+    ltx.commit();
 }
 
 static ConvertResult
@@ -1645,7 +1660,8 @@ shouldConvertWithOffers(std::optional<ExchangedQuantities> const& poolExchange,
     return true;
 }
 
-// returns true if converting with offers, false otherwise
+// returns true if converting with offers, false otherwise, in which case
+// poolExchange is the exchange to do with the liquidity pool instead
 static bool
 maybeConvertWithOffers(
     AbstractLedgerTxn& ltxOuter, Asset const& sheep, int64_t maxSheepSend,
@@ -1653,21 +1669,13 @@ maybeConvertWithOffers(
     int64_t& wheatReceived, RoundingType round,
     std::function<OfferFilterResult(LedgerTxnEntry const&)> filter,
     std::vector<ClaimAtom>& offerTrail, int64_t maxOffersToCross,
-    ConvertResult& convertRes)
+    ConvertResult& convertRes, std::optional<PoolExchange>& poolExchange)
 {
     // Compute the exchange from the liquidity pool but don't actually do the
     // exchange
-    std::optional<ExchangedQuantities> poolExchange;
-    {
-        LedgerTxn ltxExchangeWithPool(ltxOuter); // Always rolls back
-        ExchangedQuantities res;
-        if (exchangeWithPool(ltxExchangeWithPool, sheep, maxSheepSend,
-                             res.sheepSend, wheat, maxWheatReceive,
-                             res.wheatReceived, round, maxOffersToCross))
-        {
-            poolExchange = std::make_optional<ExchangedQuantities>(res);
-        }
-    }
+    poolExchange = computePoolExchange(ltxOuter, sheep, maxSheepSend, wheat,
+                                       maxWheatReceive, round,
+                                       maxOffersToCross);
 
     // Maybe use the order book
     {
@@ -1680,7 +1688,12 @@ maybeConvertWithOffers(
             wheat, maxWheatReceive, bookExchange.wheatReceived, round, filter,
             tempOfferTrail, maxOffersToCross);
 
-        if (shouldConvertWithOffers(poolExchange, bookExchange, res))
+        std::optional<ExchangedQuantities> poolQuantities;
+        if (poolExchange)
+        {
+            poolQuantities = poolExchange->quantities;
+        }
+        if (shouldConvertWithOffers(poolQuantities, bookExchange, res))
         {
             convertRes = res;
             sheepSend = bookExchange.sheepSend;
@@ -1711,12 +1724,13 @@ convertWithOffersAndPools(
     sheepSend = 0;
     wheatReceived = 0;
 
+    std::optional<PoolExchange> poolExchange;
     {
         ConvertResult convertRes;
         if (maybeConvertWithOffers(ltxOuter, sheep, maxSheepSend, sheepSend,
                                    wheat, maxWheatReceive, wheatReceived, round,
                                    filter, offerTrail, maxOffersToCross,
-                                   convertRes))
+                                   convertRes, poolExchange))
         {
             return convertRes;
         }
@@ -1725,17 +1739,17 @@ convertWithOffersAndPools(
     // Ensure that there were no side effects from maybeConvertWithOffers (this
     // should be a no-op)
     offerTrail.clear();
-    sheepSend = 0;
-    wheatReceived = 0;
 
-    // Compute the exchange from the liquidity pool and actually do the exchange
-    exchangeWithPool(ltxOuter, sheep, maxSheepSend, sheepSend, wheat,
-                     maxWheatReceive, wheatReceived, round, maxOffersToCross);
+    // The order book is only passed over for a pool exchange, which was
+    // computed from the same state of ltxOuter
+    releaseAssertOrThrow(poolExchange);
+    applyPoolExchange(ltxOuter, sheep, *poolExchange);
+    sheepSend = poolExchange->quantities.sheepSend;
+    wheatReceived = poolExchange->quantities.wheatReceived;
 
     ClaimAtom atom(CLAIM_ATOM_TYPE_LIQUIDITY_POOL);
-    atom.liquidityPool() =
-        ClaimLiquidityAtom(getPoolID(sheep, wheat, LIQUIDITY_POOL_FEE_V18),
-                           wheat, wheatReceived, sheep, sheepSend);
+    atom.liquidityPool() = ClaimLiquidityAtom(
+        poolExchange->poolID, wheat, wheatReceived, sheep, sheepSend);
     offerTrail.emplace_back(atom);
     return ConvertResult::eOK;
 }
@@ -103,13 +103,15 @@ getReadWriteKeysForStage(ApplyStage const& stage)
 
     for (auto const& txBundle : stage)
     {
-        for (auto const& lk :
-             txBundle.getTx()->sorobanResources().footprint.readWrite)
+        auto const& tx = *txBundle.getTx();
+        auto const& readWrite = tx.sorobanResources().footprint.readWrite;
+        auto const& ttlKeys = tx.sorobanFootprintTTLKeys().readWrite;
+        for (size_t i = 0; i < readWrite.size(); ++i)
         {
-            res.emplace(lk);
-            if (isSorobanEntry(lk))
+            res.emplace(readWrite[i]);
+            if (ttlKeys[i])
             {
-                res.emplace(getTTLKey(lk));
+                res.emplace(*ttlKeys[i]);
             }
         }
     }
@@ -239,14 +241,13 @@ UnorderedSet<LedgerKey>
 buildRoTTLSet(TxBundle const& txBundle)
 {
     UnorderedSet<LedgerKey> isReadOnlyTTLSet;
-    for (auto const& ro :
-         txBundle.getTx()->sorobanResources().footprint.readOnly)
+    for (auto const& ttlKey :
+         txBundle.getTx()->sorobanFootprintTTLKeys().readOnly)
     {
-        if (!isSorobanEntry(ro))
+        if (ttlKey)
         {
-            continue;
+            isReadOnlyTTLSet.emplace(*ttlKey);
         }
-        isReadOnlyTTLSet.emplace(getTTLKey(ro));
     }
     return isReadOnlyTTLSet;
 }
@@ -286,6 +287,19 @@ PreV23LedgerAccessHelper::getLedgerEntryOpt(LedgerKey const& key)
     return std::nullopt;
 }
 
+bool
+PreV23LedgerAccessHelper::withLedgerEntry(
+    LedgerKey const& key, std::function<void(LedgerEntry const&)> const& f)
+{
+    auto ltxe = mLtx.loadWithoutRecord(key);
+    if (ltxe)
+    {
+        f(ltxe.current());
+        return true;
+    }
+    return false;
+}
+
 uint32_t
 PreV23LedgerAccessHelper::getLedgerVersion()
 {
@@ -298,6 +312,15 @@ PreV23LedgerAccessHelper::getLedgerSeq()
     return mLtx.loadHeader().current().ledgerSeq;
 }
 
+uint32_t
+PreV23LedgerAccessHelper::getEntrySizeForRent(
+    LedgerKey const& key, LedgerEntry const& entry, uint32_t entryXdrSize,
+    SorobanNetworkConfig const& sorobanConfig)
+{
+    return ledgerEntrySizeForRent(entry, entryXdrSize, getLedgerVersion(),
+                                  sorobanConfig);
+}
+
 bool
 PreV23LedgerAccessHelper::upsertLedgerEntry(LedgerKey const& key,
                                             LedgerEntry const& entry)
@@ -342,6 +365,13 @@ ParallelLedgerAccessHelper::getLedgerEntryOpt(LedgerKey const& key)
     return mOpState.getLiveEntryOpt(key);
 }
 
+bool
+ParallelLedgerAccessHelper::withLedgerEntry(
+    LedgerKey const& key, std::function<void(LedgerEntry const&)> const& f)
+{
+    return mOpState.withLiveEntry(key, f);
+}
+
 uint32_t
 ParallelLedgerAccessHelper::getLedgerSeq()
 {
@@ -356,6 +386,27 @@ ParallelLedgerAccessHelper::getLedgerVersion()
     return mLedgerInfo.getLedgerVersion();
 }
 
+uint32_t
+ParallelLedgerAccessHelper::getEntrySizeForRent(
+    LedgerKey const& key, LedgerEntry const& entry, uint32_t entryXdrSize,
+    SorobanNetworkConfig const& sorobanConfig)
+{
+    if (key.type() == CONTRACT_CODE)
+    {
+        // The in-memory state recomputes code sizes on every upgrade that
+        // affects them, so they match the config this ledger applies with
+        if (auto size = mOpState.getStoredContractCodeSizeForRent(key))
+        {
+            dbgAssert(*size == ledgerEntrySizeForRent(entry, entryXdrSize,
+                                                      getLedgerVersion(),
+                                                      sorobanConfig));
+            return *size;
+        }
+    }
+    return ledgerEntrySizeForRent(entry, entryXdrSize, getLedgerVersion(),
+                                  sorobanConfig);
+}
+
 bool
 ParallelLedgerAccessHelper::upsertLedgerEntry(LedgerKey const& key,
                                               LedgerEntry const& entry)
@@ -566,21 +617,25 @@ ThreadParallelApplyLedgerState::collectClusterFootprintEntriesFromGlobal(
         }
     };
 
-    for (auto const& txBundle : cluster)
-    {
-        auto const& footprint = txBundle.getTx()->sorobanResources().footprint;
-        for (auto const& keys : {footprint.readWrite, footprint.readOnly})
+    auto fetchKeys = [&](xdr::xvector<LedgerKey> const& keys,
+                         std::vector<std::optional<LedgerKey>> const& ttlKeys) {
+        for (size_t i = 0; i < keys.size(); ++i)
         {
-            for (auto const& key : keys)
+            fetchFromGlobal(keys[i]);
+            if (ttlKeys[i])
             {
-                fetchFromGlobal(key);
-                if (isSorobanEntry(key))
-                {
-                    auto ttlKey = getTTLKey(key);
-                    fetchFromGlobal(ttlKey);
-                }
+                fetchFromGlobal(*ttlKeys[i]);
             }
         }
+    };
+
+    for (auto const& txBundle : cluster)
+    {
+        auto const& tx = *txBundle.getTx();
+        auto const& footprint = tx.sorobanResources().footprint;
+        auto const& ttlKeys = tx.sorobanFootprintTTLKeys();
+        fetchKeys(footprint.readWrite, ttlKeys.readWrite);
+        fetchKeys(footprint.readOnly, ttlKeys.readOnly);
     }
 }
 
@@ -604,17 +659,15 @@ void
 ThreadParallelApplyLedgerState::flushRoTTLBumpsInTxWriteFootprint(
     const TxBundle& txBundle)
 {
-    auto const& readWrite =
-        txBundle.getTx()->sorobanResources().footprint.readWrite;
-
-    for (auto const& lk : readWrite)
+    for (auto const& ttlKeyOpt :
+         txBundle.getTx()->sorobanFootprintTTLKeys().readWrite)
     {
-        if (!isSorobanEntry(lk))
+        if (!ttlKeyOpt)
         {
             continue;
         }
 
-        auto const& ttlKey = getTTLKey(lk);
+        auto const& ttlKey = *ttlKeyOpt;
         auto b = mRoTTLBumps.find(ttlKey);
         if (b != mRoTTLBumps.end())
         {
@@ -663,11 +716,26 @@ ThreadParallelApplyLedgerState::getRestoredEntries() const
 
 std::optional<LedgerEntry>
 ThreadParallelApplyLedgerState::getLiveEntryOpt(LedgerKey const& key) const
+{
+    std::optional<LedgerEntry> res;
+    withLiveEntry(key, [&](LedgerEntry const& le) { res = le; });
+    return res;
+}
+
+bool
+ThreadParallelApplyLedgerState::withLiveEntry(
+    LedgerKey const& key,
+    std::function<void(LedgerEntry const&)> const& f) const
 {
     auto it0 = mThreadEntryMap.find(key);
     if (it0 != mThreadEntryMap.end())
     {
-        return it0->second.mLedgerEntry;
+        auto const& entryOpt = it0->second.mLedgerEntry;
+        if (entryOpt)
+        {
+            f(*entryOpt);
+        }
+        return entryOpt.has_value();
     }
     // Invariant check: If an entry was restored from the live state, then it's
     // possible that the thread entry map does not have that key (because live
@@ -696,7 +764,11 @@ ThreadParallelApplyLedgerState::getLiveEntryOpt(LedgerKey const& key) const
         res = mLiveSnapshot->load(key);
     }
 
-    return res ? std::make_optional(*res) : std::nullopt;
+    if (res)
+    {
+        f(*res);
+    }
+    return static_cast<bool>(res);
 }
 
 void
@@ -788,6 +860,19 @@ ThreadParallelApplyLedgerState::commitChangesFromSuccessfulOp(
     mThreadRestoredEntries.addRestoresFrom(res.getRestoredEntries());
 }
 
+std::optional<uint32_t>
+ThreadParallelApplyLedgerState::getStoredContractCodeSizeForRent(
+    LedgerKey const& key) const
+{
+    // Anything in the thread map may have been changed during this ledger,
+    // the in-memory state only has the entries as of its start
+    if (mThreadEntryMap.find(key) != mThreadEntryMap.end())
+    {
+        return std::nullopt;
+    }
+    return mInMemorySorobanState.getContractCodeSizeForRent(key);
+}
+
 bool
 ThreadParallelApplyLedgerState::entryWasRestored(LedgerKey const& key) const
 {
@@ -831,6 +916,24 @@ OpParallelApplyLedgerState::getLiveEntryOpt(LedgerKey const& key) const
     }
 }
 
+bool
+OpParallelApplyLedgerState::withLiveEntry(
+    LedgerKey const& key,
+    std::function<void(LedgerEntry const&)> const& f) const
+{
+    auto entryIter = mOpEntryMap.find(key);
+    if (entryIter != mOpEntryMap.end())
+    {
+        auto const& entryOpt = entryIter->second;
+        if (entryOpt)
+        {
+            f(*entryOpt);
+        }
+        return entryOpt.has_value();
+    }
+    return mThreadState.withLiveEntry(key, f);
+}
+
 bool
 OpParallelApplyLedgerState::upsertEntry(LedgerKey const& key,
                                         LedgerEntry const& entry,
@@ -897,6 +1000,17 @@ OpParallelApplyLedgerState::eraseEntryIfExists(LedgerKey const& key)
     return liveEntryExistedAlready;
 }
 
+std::optional<uint32_t>
+OpParallelApplyLedgerState::getStoredContractCodeSizeForRent(
+    LedgerKey const& key) const
+{
+    if (mOpEntryMap.find(key) != mOpEntryMap.end())
+    {
+        return std::nullopt;
+    }
+    return mThreadState.getStoredContractCodeSizeForRent(key);
+}
+
 bool
 OpParallelApplyLedgerState::entryWasRestored(LedgerKey const& key) const
 {
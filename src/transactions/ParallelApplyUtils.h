@@ -9,6 +9,7 @@
 #include "ledger/LedgerTypeUtils.h"
 #include "transactions/ParallelApplyStage.h"
 #include "transactions/TransactionFrameBase.h"
+#include <functional>
 #include <unordered_set>
 
 namespace stellar
@@ -148,6 +149,15 @@ class ThreadParallelApplyLedgerState
     RestoredEntries const& getRestoredEntries() const;
 
     std::optional<LedgerEntry> getLiveEntryOpt(LedgerKey const& key) const;
+    // Calls f on the live entry for key, if there is one, without copying it.
+    // Returns false if there is no live entry.
+    bool withLiveEntry(LedgerKey const& key,
+                       std::function<void(LedgerEntry const&)> const& f) const;
+    // Returns the size for rent the in-memory state holds for the
+    // ContractCode entry for key, unless the entry may have changed during
+    // this ledger.
+    std::optional<uint32_t>
+    getStoredContractCodeSizeForRent(LedgerKey const& key) const;
     bool entryWasRestored(LedgerKey const& key) const;
 
     void setEffectsDeltaFromSuccessfulOp(ParallelTxReturnVal const& res,
@@ -183,7 +193,9 @@ class GlobalParallelApplyLedgerState
     // CONTRACT_DATA, CONTRACT_CODE, and TTL entries. For these entry types,
     // only mInMemorySorobanState should be queried. If the in-memory state
     // returns null for a key, it does NOT indicate a "cache miss," rather the
-    // key does not exist as part of the live state.
+    // key does not exist as part of the live state. This is shared by all
+    // apply threads and read directly, without copying or locking, since it
+    // is not modified until the ledger close has finished applying.
     InMemorySorobanState const& mInMemorySorobanState;
 
     // Contains restorations that happened during each stage of the parallel
@@ -269,6 +281,10 @@ class OpParallelApplyLedgerState
   public:
     OpParallelApplyLedgerState(ThreadParallelApplyLedgerState const& parent);
     std::optional<LedgerEntry> getLiveEntryOpt(LedgerKey const& key) const;
+    bool withLiveEntry(LedgerKey const& key,
+                       std::function<void(LedgerEntry const&)> const& f) const;
+    std::optional<uint32_t>
+    getStoredContractCodeSizeForRent(LedgerKey const& key) const;
 
     // Upsert the entry and sets the lastModifiedLedgerSeq to the given ledger
     // sequence number.
@@ -295,6 +311,13 @@ class LedgerAccessHelper
     virtual std::optional<LedgerEntry>
     getLedgerEntryOpt(LedgerKey const& key) = 0;
 
+    // withLedgerEntry calls f on the entry if it exists, without copying it
+    // out first, and returns whether it exists. The entry is only valid for
+    // the duration of the call.
+    virtual bool
+    withLedgerEntry(LedgerKey const& key,
+                    std::function<void(LedgerEntry const&)> const& f) = 0;
+
     // upsert returns true if the entry was created, false if it was updated.
     // "created" here is interpreted narrowly to mean there was no
     // populated/non-null entry in any parent level of the ledger state; a
@@ -311,6 +334,13 @@ class LedgerAccessHelper
 
     virtual uint32_t getLedgerVersion() = 0;
     virtual uint32_t getLedgerSeq() = 0;
+
+    // Returns the size to charge rent for of entry, the current entry for
+    // key, whose XDR size is entryXdrSize.
+    virtual uint32_t
+    getEntrySizeForRent(LedgerKey const& key, LedgerEntry const& entry,
+                        uint32_t entryXdrSize,
+                        SorobanNetworkConfig const& sorobanConfig) = 0;
 };
 
 class PreV23LedgerAccessHelper : virtual public LedgerAccessHelper
@@ -321,11 +351,18 @@ class PreV23LedgerAccessHelper : virtual public LedgerAccessHelper
     AbstractLedgerTxn& mLtx;
 
     std::optional<LedgerEntry> getLedgerEntryOpt(LedgerKey const& key) override;
+    bool
+    withLedgerEntry(LedgerKey const& key,
+                    std::function<void(LedgerEntry const&)> const& f) override;
     bool upsertLedgerEntry(LedgerKey const& key,
                            LedgerEntry const& entry) override;
     bool eraseLedgerEntryIfExists(LedgerKey const& key) override;
     uint32_t getLedgerVersion() override;
     uint32_t getLedgerSeq() override;
+    uint32_t
+    getEntrySizeForRent(LedgerKey const& key, LedgerEntry const& entry,
+                        uint32_t entryXdrSize,
+                        SorobanNetworkConfig const& sorobanConfig) override;
 };
 
 class ParallelLedgerAccessHelper : virtual public LedgerAccessHelper
@@ -340,10 +377,19 @@ class ParallelLedgerAccessHelper : virtual public LedgerAccessHelper
     OpParallelApplyLedgerState mOpState;
 
     std::optional<LedgerEntry> getLedgerEntryOpt(LedgerKey const& key) override;
+    bool
+    withLedgerEntry(LedgerKey const& key,
+                    std::function<void(LedgerEntry const&)> const& f) override;
     bool upsertLedgerEntry(LedgerKey const& key,
                            LedgerEntry const& entry) override;
     bool eraseLedgerEntryIfExists(LedgerKey const& key) override;
     uint32_t getLedgerVersion() override;
     uint32_t getLedgerSeq() override;
+    // Reuses the size the in-memory state computed for unchanged ContractCode
+    // entries, instead of parsing their Wasm again across the Rust bridge.
+    uint32_t
+    getEntrySizeForRent(LedgerKey const& key, LedgerEntry const& entry,
+                        uint32_t entryXdrSize,
+                        SorobanNetworkConfig const& sorobanConfig) override;
 };
 }
\ No newline at end of file
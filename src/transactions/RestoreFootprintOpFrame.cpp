@@ -65,6 +65,7 @@ class RestoreFootprintApplyHelper : virtual public LedgerAccessHelper
     RestoreFootprintOpFrame const& mOpFrame;
 
     SorobanResources const& mResources;
+    SorobanFootprintTTLKeys const& mFootprintTTLKeys;
     SorobanNetworkConfig const& mSorobanConfig;
     Config const& mAppConfig;
 
@@ -82,6 +83,7 @@ class RestoreFootprintApplyHelper : virtual public LedgerAccessHelper
         , mOpMeta(opMeta)
         , mOpFrame(opFrame)
         , mResources(mOpFrame.mParentTx.sorobanResources())
+        , mFootprintTTLKeys(mOpFrame.mParentTx.sorobanFootprintTTLKeys())
         , mSorobanConfig(app.getSorobanNetworkConfigForApply())
         , mAppConfig(app.getConfig())
         , mMetrics(app.getSorobanMetrics())
@@ -116,10 +118,12 @@ class RestoreFootprintApplyHelper : virtual public LedgerAccessHelper
         rustEntryRentChanges.reserve(footprint.readWrite.size());
         auto& diagnosticEvents = mOpMeta.getDiagnosticEventManager();
 
-        for (auto const& lk : footprint.readWrite)
+        for (size_t i = 0; i < footprint.readWrite.size(); ++i)
         {
+            auto const& lk = footprint.readWrite[i];
             std::optional<LedgerEntry> hotArchiveEntryOpt = std::nullopt;
-            auto ttlKey = getTTLKey(lk);
+            // Only Soroban entries are allowed in the footprint
+            auto const& ttlKey = mFootprintTTLKeys.readWrite[i].value();
             auto ttlLeOpt = getLedgerEntryOpt(ttlKey);
             if (!ttlLeOpt)
             {
@@ -167,7 +171,7 @@ class RestoreFootprintApplyHelper : virtual public LedgerAccessHelper
                 // We checked for TTLEntry existence above
                 releaseAssertOrThrow(entryLeOpt);
 
-                entry = *entryLeOpt;
+                entry = std::move(*entryLeOpt);
                 entrySize = static_cast<uint32>(xdr::xdr_size(entry));
             }
 
@@ -210,10 +214,10 @@ class RestoreFootprintApplyHelper : virtual public LedgerAccessHelper
 
             rustEntryRentChanges.emplace_back(
                 createEntryRentChangeWithoutModification(
-                    entry, entrySize,
+                    entry,
+                    getEntrySizeForRent(lk, entry, entrySize, mSorobanConfig),
                     /*entryLiveUntilLedger=*/std::nullopt,
-                    /*newLiveUntilLedger=*/restoredLiveUntilLedger,
-                    ledgerVersion, mSorobanConfig));
+                    /*newLiveUntilLedger=*/restoredLiveUntilLedger));
 
             restoreEntry(lk, entry, ttlKey, ttlLeOpt, restoredLiveUntilLedger);
         }
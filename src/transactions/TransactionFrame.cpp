@@ -113,6 +113,41 @@ TransactionFrame::TransactionFrame(Hash const& networkID,
     {
         mOperations.push_back(OperationFrame::makeHelper(ops[i], *this, i));
     }
+    mSorobanFootprintTTLKeys = computeSorobanFootprintTTLKeys();
+}
+
+SorobanFootprintTTLKeys
+TransactionFrame::computeSorobanFootprintTTLKeys() const
+{
+    ZoneScoped;
+    SorobanFootprintTTLKeys ttlKeys;
+    // Soroban transactions without Soroban data are invalid, and never
+    // applied
+    if (!isSoroban() || mEnvelope.type() != ENVELOPE_TYPE_TX ||
+        mEnvelope.v1().tx.ext.v() != 1)
+    {
+        return ttlKeys;
+    }
+
+    auto compute = [](xdr::xvector<LedgerKey> const& keys,
+                      std::vector<std::optional<LedgerKey>>& res) {
+        res.reserve(keys.size());
+        for (auto const& lk : keys)
+        {
+            if (isSorobanEntry(lk))
+            {
+                res.emplace_back(getTTLKey(lk));
+            }
+            else
+            {
+                res.emplace_back(std::nullopt);
+            }
+        }
+    };
+    auto const& footprint = sorobanResources().footprint;
+    compute(footprint.readOnly, ttlKeys.readOnly);
+    compute(footprint.readWrite, ttlKeys.readWrite);
+    return ttlKeys;
 }
 
 Hash const&
@@ -126,6 +161,16 @@ TransactionFrame::getFullHash() const
     return (mFullHash);
 }
 
+Hash
+TransactionFrame::computeContentsHash() const
+{
+    if (mEnvelope.type() == ENVELOPE_TYPE_TX_V0)
+    {
+        return xdrSha256(mNetworkID, ENVELOPE_TYPE_TX, 0, mEnvelope.v0().tx);
+    }
+    return xdrSha256(mNetworkID, ENVELOPE_TYPE_TX, mEnvelope.v1().tx);
+}
+
 Hash const&
 TransactionFrame::getContentsHash() const
 {
@@ -138,16 +183,7 @@ TransactionFrame::getContentsHash() const
 
     if (isZero(mContentsHash))
     {
-        if (mEnvelope.type() == ENVELOPE_TYPE_TX_V0)
-        {
-            mContentsHash = sha256(xdr::xdr_to_opaque(
-                mNetworkID, ENVELOPE_TYPE_TX, 0, mEnvelope.v0().tx));
-        }
-        else
-        {
-            mContentsHash = sha256(xdr::xdr_to_opaque(
-                mNetworkID, ENVELOPE_TYPE_TX, mEnvelope.v1().tx));
-        }
+        loadCachedHashes();
     }
 #ifdef _DEBUG
     releaseAssert(isZero(oldHash) || (oldHash == mContentsHash));
@@ -155,6 +191,34 @@ TransactionFrame::getContentsHash() const
     return (mContentsHash);
 }
 
+uint32_t
+TransactionFrame::getPrevalidatedLedgerSeq() const
+{
+    return mPrevalidatedLedgerSeq;
+}
+
+void
+TransactionFrame::setPrevalidatedLedgerSeq(uint32_t ledgerSeq) const
+{
+    mPrevalidatedLedgerSeq = ledgerSeq;
+}
+
+void
+TransactionFrame::loadCachedHashes() const
+{
+    CachedTxHashes hashes;
+    auto const& fullHash = getFullHash();
+    if (!getCachedTxHashes(fullHash, mNetworkID, hashes))
+    {
+        hashes.mNetworkID = mNetworkID;
+        hashes.mContentsHash = computeContentsHash();
+        hashes.mSize = static_cast<uint32_t>(xdr::xdr_size(mEnvelope));
+        putCachedTxHashes(fullHash, hashes);
+    }
+    mContentsHash = hashes.mContentsHash;
+    mSize = hashes.mSize;
+}
+
 TransactionEnvelope const&
 TransactionFrame::getEnvelope() const
 {
@@ -174,6 +238,9 @@ TransactionFrame::clearCached() const
     Hash zero;
     mContentsHash = zero;
     mFullHash = zero;
+    mSize = 0;
+    // Tests may have changed the footprint
+    mSorobanFootprintTTLKeys = computeSorobanFootprintTTLKeys();
 }
 #endif
 
@@ -500,6 +567,13 @@ TransactionFrame::sorobanResources() const
     return mEnvelope.v1().tx.ext.sorobanData().resources;
 }
 
+SorobanFootprintTTLKeys const&
+TransactionFrame::sorobanFootprintTTLKeys() const
+{
+    releaseAssertOrThrow(isSoroban());
+    return mSorobanFootprintTTLKeys;
+}
+
 SorobanTransactionData::_ext_t const&
 TransactionFrame::getResourcesExt() const
 {
@@ -1539,9 +1613,20 @@ TransactionFrame::processFeeSeqNum(AbstractLedgerTxn& ltx,
         throw std::runtime_error("Unexpected database state");
     }
 
-    auto& acc = sourceAccount.current().data.account();
+    auto res = processFeeSeqNum(sourceAccount.current(), header.current(),
+                                baseFee);
+    header.current().feePool += res->getFeeCharged();
+    return res;
+}
+
+MutableTxResultPtr
+TransactionFrame::processFeeSeqNum(LedgerEntry& feeSource,
+                                   LedgerHeader const& header,
+                                   std::optional<int64_t> baseFee) const
+{
+    auto& acc = feeSource.data.account();
 
-    int64_t fee = getFee(header.current(), baseFee, true);
+    int64_t fee = getFee(header, baseFee, true);
 
     if (fee > 0)
     {
@@ -1550,11 +1635,9 @@ TransactionFrame::processFeeSeqNum(AbstractLedgerTxn& ltx,
         // are respected. In this case, we allow it to fall below that since it
         // will be caught later in commonValid.
         stellar::addBalance(acc.balance, -fee);
-        header.current().feePool += fee;
     }
     // in v10 we update sequence numbers during apply
-    if (protocolVersionIsBefore(header.current().ledgerVersion,
-                                ProtocolVersion::V_10))
+    if (protocolVersionIsBefore(header.ledgerVersion, ProtocolVersion::V_10))
     {
         if (acc.seqNum + 1 != getSeqNum())
         {
@@ -1759,6 +1842,33 @@ TransactionFrame::insertKeysForTxApply(UnorderedSet<LedgerKey>& keys) const
     }
 }
 
+void
+TransactionFrame::insertSignaturesToVerify(
+    std::vector<PubKeyUtils::SignatureToVerify>& sigs, bool forApply) const
+{
+    // May run alongside apply, so the cached contents hash is left alone
+    auto const& signatures = getSignatures(mEnvelope);
+    auto const hash = computeContentsHash();
+    auto addMaster = [&](AccountID const& id) {
+        for (auto const& sig : signatures)
+        {
+            if (SignatureUtils::doesHintMatch(id.ed25519(), sig.hint))
+            {
+                sigs.push_back({id, sig.signature, hash});
+            }
+        }
+    };
+
+    addMaster(getSourceID());
+    for (auto const& op : mOperations)
+    {
+        if (!(getSourceID() == op->getSourceID()))
+        {
+            addMaster(op->getSourceID());
+        }
+    }
+}
+
 #ifdef BUILD_TESTS
 bool
 TransactionFrame::apply(AppConnector& app, AbstractLedgerTxn& ltx,
@@ -2088,19 +2198,27 @@ TransactionFrame::applyOperations(SignatureChecker& signatureChecker,
             if (success)
             {
                 auto ledgerSeq = ltxOp.loadHeader().current().ledgerSeq;
-                auto delta = ltxOp.getDelta();
                 auto& opEventManager = opMeta.getEventManager();
-                if (protocolVersionIsBefore(ledgerVersion,
+                bool const reconcile =
+                    protocolVersionIsBefore(ledgerVersion,
                                             ProtocolVersion::V_8) &&
                     opEventManager.isEnabled() &&
-                    opResult.tr().type() != INFLATION)
+                    opResult.tr().type() != INFLATION;
+                // The delta copies every entry the operation touched, so it
+                // is only built when something reads it
+                if (reconcile || app.isOperationApplyInvariantEnabled())
                 {
-                    reconcileEvents(getSourceID(), op->getOperation(), delta,
-                                    opMeta.getEventManager());
+                    auto delta = ltxOp.getDelta();
+                    if (reconcile)
+                    {
+                        reconcileEvents(getSourceID(), op->getOperation(),
+                                        delta, opMeta.getEventManager());
+                    }
+
+                    app.checkOnOperationApply(op->getOperation(), opResult,
+                                              delta,
+                                              opEventManager.getEvents());
                 }
-
-                app.checkOnOperationApply(op->getOperation(), opResult, delta,
-                                          opEventManager.getEvents());
                 opMeta.setLedgerChanges(ltxOp, ledgerSeq);
             }
 
@@ -2339,7 +2457,17 @@ uint32_t
 TransactionFrame::getSize() const
 {
     ZoneScoped;
+#ifdef BUILD_TESTS
+    // Tests modify envelopes in place without always clearing the cached
+    // values
     return static_cast<uint32_t>(xdr::xdr_size(mEnvelope));
+#else
+    if (mSize == 0)
+    {
+        loadCachedHashes();
+    }
+    return mSize;
+#endif
 }
 
 bool
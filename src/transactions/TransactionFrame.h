@@ -71,11 +71,23 @@ class TransactionFrame : public TransactionFrameBase
     Hash const& mNetworkID;     // used to change the way we compute signatures
     mutable Hash mContentsHash; // the hash of the contents
     mutable Hash mFullHash;     // the hash of the contents and the sig.
+    mutable uint32_t mSize{0};  // the size of the envelope
+    mutable uint32_t mPrevalidatedLedgerSeq{0};
 
     std::vector<std::shared_ptr<OperationFrame const>> mOperations;
 
+#ifdef BUILD_TESTS
+    mutable
+#endif
+        SorobanFootprintTTLKeys mSorobanFootprintTTLKeys;
+    SorobanFootprintTTLKeys computeSorobanFootprintTTLKeys() const;
+
     LedgerTxnEntry loadSourceAccount(AbstractLedgerTxn& ltx,
                                      LedgerTxnHeader const& header) const;
+    Hash computeContentsHash() const;
+    // Sets the contents hash and size, from the process-wide cache if
+    // another frame already computed them
+    void loadCachedHashes() const;
     friend class LedgerTxnReadOnly;
 
     enum ValidationType
@@ -164,6 +176,8 @@ class TransactionFrame : public TransactionFrameBase
 
     Hash const& getFullHash() const override;
     Hash const& getContentsHash() const override;
+    uint32_t getPrevalidatedLedgerSeq() const override;
+    void setPrevalidatedLedgerSeq(uint32_t ledgerSeq) const override;
     TransactionEnvelope const& getEnvelope() const override;
 
     std::vector<std::shared_ptr<OperationFrame const>> const&
@@ -242,11 +256,17 @@ class TransactionFrame : public TransactionFrameBase
     void
     insertKeysForFeeProcessing(UnorderedSet<LedgerKey>& keys) const override;
     void insertKeysForTxApply(UnorderedSet<LedgerKey>& keys) const override;
+    void
+    insertSignaturesToVerify(std::vector<PubKeyUtils::SignatureToVerify>& sigs,
+                             bool forApply) const override;
 
     // collect fee, consume sequence number
     MutableTxResultPtr
     processFeeSeqNum(AbstractLedgerTxn& ltx,
                      std::optional<int64_t> baseFee) const override;
+    MutableTxResultPtr
+    processFeeSeqNum(LedgerEntry& feeSource, LedgerHeader const& header,
+                     std::optional<int64_t> baseFee) const override;
 
     // preApply runs all pre-application steps that are common between
     // parallelApply and (sequential) apply:
@@ -327,6 +347,7 @@ class TransactionFrame : public TransactionFrameBase
 
     bool isSoroban() const override;
     SorobanResources const& sorobanResources() const override;
+    SorobanFootprintTTLKeys const& sorobanFootprintTTLKeys() const override;
     SorobanTransactionData::_ext_t const& getResourcesExt() const override;
 
     static FeePair computeSorobanResourceFee(
@@ -5,10 +5,44 @@
 #include "transactions/TransactionFrameBase.h"
 #include "transactions/FeeBumpTransactionFrame.h"
 #include "transactions/TransactionFrame.h"
+#include "util/RandomEvictionCache.h"
+#include <mutex>
 
 namespace stellar
 {
 
+namespace
+{
+// Enough for several ledgers worth of queued and applied transactions
+size_t const TX_HASH_CACHE_SIZE = 0x10000;
+
+std::mutex gTxHashCacheMutex;
+RandomEvictionCache<Hash, CachedTxHashes> gTxHashCache(TX_HASH_CACHE_SIZE,
+                                                       /* separatePRNG */ true);
+}
+
+bool
+getCachedTxHashes(Hash const& fullHash, Hash const& networkID,
+                  CachedTxHashes& hashes)
+{
+    std::lock_guard<std::mutex> lock(gTxHashCacheMutex);
+    auto cached = gTxHashCache.maybeGet(fullHash);
+    // The contents hash depends on the network, which tests vary
+    if (!cached || cached->mNetworkID != networkID)
+    {
+        return false;
+    }
+    hashes = *cached;
+    return true;
+}
+
+void
+putCachedTxHashes(Hash const& fullHash, CachedTxHashes const& hashes)
+{
+    std::lock_guard<std::mutex> lock(gTxHashCacheMutex);
+    gTxHashCache.put(fullHash, hashes);
+}
+
 TransactionFrameBasePtr
 TransactionFrameBase::makeTransactionFromWire(Hash const& networkID,
                                               TransactionEnvelope const& env)
@@ -6,12 +6,14 @@
 
 #include <optional>
 
+#include "crypto/SecretKey.h"
 #include "ledger/LedgerHashUtils.h"
 #include "ledger/LedgerStateSnapshot.h"
 #include "ledger/NetworkConfig.h"
 #include "main/Config.h"
 #include "overlay/StellarXDR.h"
 #include "util/TxResource.h"
+#include "util/UnorderedMap.h"
 #include "util/UnorderedSet.h"
 #include "util/types.h"
 #include <optional>
@@ -46,7 +48,8 @@ using TransactionFrameBaseConstPtr =
 // Tracks entry updates within an operation during parallel apply phases. If the
 // transaction succeeds, the thread's ParallelApplyEntryMap should be updated
 // with the entries from the OpModifiedEntryMap.
-using OpModifiedEntryMap = UnorderedMap<LedgerKey, std::optional<LedgerEntry>>;
+using OpModifiedEntryMap =
+    UnorderedFlatMap<LedgerKey, std::optional<LedgerEntry>>;
 
 // Used to track the current state of an entry during parallel apply phases. Can
 // be updated by successful transactions.
@@ -78,12 +81,23 @@ struct ParallelApplyEntry
     }
 };
 
+// TTL keys of the entries in a Soroban transaction's footprint, parallel to
+// footprint.readOnly and footprint.readWrite: the TTL key of each ContractData
+// and ContractCode key, nullopt for classic keys. Computed once, when the
+// frame is created, so that apply doesn't hash footprint keys every time it
+// looks up their TTLs.
+struct SorobanFootprintTTLKeys
+{
+    std::vector<std::optional<LedgerKey>> readOnly;
+    std::vector<std::optional<LedgerKey>> readWrite;
+};
+
 // This is a map of all entries that will be read and/or written during parallel
 // apply phases: there is one such "global" map which disjoint per-thread maps
 // get split off of, modified during applyThread, and merged back into. Once all
 // threads return, the updates from each threads entry map should be commited to
 // LedgerTxn.
-using ParallelApplyEntryMap = UnorderedMap<LedgerKey, ParallelApplyEntry>;
+using ParallelApplyEntryMap = UnorderedFlatMap<LedgerKey, ParallelApplyEntry>;
 
 // Returned by each parallel transaction. It will contain the entries modified
 // by the transaction, the success status of the transaction, and the keys
@@ -126,6 +140,24 @@ class ParallelTxReturnVal
     RestoredEntries mRestoredEntries;
 };
 
+// What a frame computes about its envelope on top of the full hash
+struct CachedTxHashes
+{
+    Hash mNetworkID;
+    Hash mContentsHash;
+    uint32_t mSize;
+};
+
+// Frames built from the same envelope, e.g. when a transaction is flooded,
+// queued and then decoded again with every tx set that contains it, share
+// the hashes the first of them computed through a process-wide cache keyed
+// by the full hash of the envelope's wire form. Transactions received from
+// peers are usually hashed on the overlay background thread. Safe to call
+// from any thread.
+bool getCachedTxHashes(Hash const& fullHash, Hash const& networkID,
+                       CachedTxHashes& hashes);
+void putCachedTxHashes(Hash const& fullHash, CachedTxHashes const& hashes);
+
 class TransactionFrameBase
 {
   public:
@@ -193,6 +225,13 @@ class TransactionFrameBase
     virtual Hash const& getContentsHash() const = 0;
     virtual Hash const& getFullHash() const = 0;
 
+    // The last closed ledger this transaction was found valid against
+    // before reaching the transaction queue, or 0. Transactions received
+    // from peers are validated on the overlay thread, which sets this before
+    // handing the frame to the main thread.
+    virtual uint32_t getPrevalidatedLedgerSeq() const = 0;
+    virtual void setPrevalidatedLedgerSeq(uint32_t ledgerSeq) const = 0;
+
     virtual uint32_t getNumOperations() const = 0;
     virtual std::vector<std::shared_ptr<OperationFrame const>> const&
     getOperationFrames() const = 0;
@@ -212,10 +251,30 @@ class TransactionFrameBase
     insertKeysForFeeProcessing(UnorderedSet<LedgerKey>& keys) const = 0;
     virtual void insertKeysForTxApply(UnorderedSet<LedgerKey>& keys) const = 0;
 
+    // Adds the signatures that would be checked against the master keys of
+    // the source accounts when the transaction is validated, or applied if
+    // forApply is set, to sigs. Verifying them ahead of time with
+    // PubKeyUtils::verifySigs fills the signature verification cache without
+    // changing the outcome of the real checks. This may run on another thread
+    // while the transaction is applied. Signatures of other signers are left
+    // to the real checks.
+    virtual void insertSignaturesToVerify(
+        std::vector<PubKeyUtils::SignatureToVerify>& sigs,
+        bool forApply) const = 0;
+
     virtual MutableTxResultPtr
     processFeeSeqNum(AbstractLedgerTxn& ltx,
                      std::optional<int64_t> baseFee) const = 0;
 
+    // Same as above, but works on feeSource, a copy of the fee source account
+    // entry, instead of on a LedgerTxn. The header is not modified: the
+    // caller must add the fee charged in the returned result to the fee pool.
+    // Does not access any state shared between transactions, so it may be
+    // called for different transactions on different threads.
+    virtual MutableTxResultPtr
+    processFeeSeqNum(LedgerEntry& feeSource, LedgerHeader const& header,
+                     std::optional<int64_t> baseFee) const = 0;
+
     // After this transaction has been applied
     virtual void
     processPostApply(AppConnector& app, AbstractLedgerTxn& ltx,
@@ -234,6 +293,7 @@ class TransactionFrameBase
 
     virtual bool isSoroban() const = 0;
     virtual SorobanResources const& sorobanResources() const = 0;
+    virtual SorobanFootprintTTLKeys const& sorobanFootprintTTLKeys() const = 0;
     virtual SorobanTransactionData::_ext_t const& getResourcesExt() const = 0;
     virtual int64 declaredSorobanResourceFee() const = 0;
     virtual bool XDRProvidesValidFee() const = 0;
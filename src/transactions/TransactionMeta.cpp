@@ -340,6 +340,16 @@ processOpLedgerEntryChanges(
 
     return result;
 }
+
+// Placeholder meta for the operations of a disabled TransactionMetaBuilder.
+// It is shared by all threads and must never be written to.
+template <typename T>
+T&
+disabledOperationMeta()
+{
+    static T meta;
+    return meta;
+}
 } // namespace
 
 void
@@ -957,32 +967,44 @@ TransactionMetaBuilder::TransactionMetaBuilder(bool metaEnabled,
     size_t numOperations = operationFrames.size();
     mOperationMetaBuilders.reserve(numOperations);
 
+    // Disabled operation builders never touch their meta, so rather than
+    // allocating XDR that is thrown away they all share one placeholder.
     switch (mTransactionMeta.mTransactionMeta.v())
     {
     case 2:
     case 3:
     {
         auto& opMeta = mOperationMetas.emplace<xdr::xvector<OperationMeta>>();
-        opMeta.resize(numOperations);
+        if (metaEnabled)
+        {
+            opMeta.resize(numOperations);
+        }
         for (size_t i = 0; i < numOperations; ++i)
         {
             mOperationMetaBuilders.emplace_back(OperationMetaBuilder(
-                app.getConfig(), metaEnabled, opMeta[i], *operationFrames[i],
-                protocolVersion, app.getNetworkID(), app.getConfig(),
-                mDiagnosticEventManager));
+                app.getConfig(), metaEnabled,
+                metaEnabled ? opMeta[i]
+                            : disabledOperationMeta<OperationMeta>(),
+                *operationFrames[i], protocolVersion, app.getNetworkID(),
+                app.getConfig(), mDiagnosticEventManager));
         }
         break;
     }
     case 4:
     {
         auto& opMeta = mOperationMetas.emplace<xdr::xvector<OperationMetaV2>>();
-        opMeta.resize(numOperations);
+        if (metaEnabled)
+        {
+            opMeta.resize(numOperations);
+        }
         for (size_t i = 0; i < numOperations; ++i)
         {
             mOperationMetaBuilders.emplace_back(OperationMetaBuilder(
-                app.getConfig(), metaEnabled, opMeta[i], *operationFrames[i],
-                protocolVersion, app.getNetworkID(), app.getConfig(),
-                mDiagnosticEventManager));
+                app.getConfig(), metaEnabled,
+                metaEnabled ? opMeta[i]
+                            : disabledOperationMeta<OperationMetaV2>(),
+                *operationFrames[i], protocolVersion, app.getNetworkID(),
+                app.getConfig(), mDiagnosticEventManager));
         }
         break;
     }
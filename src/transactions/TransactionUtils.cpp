@@ -2206,12 +2206,21 @@ createEntryRentChangeWithoutModification(
     LedgerEntry const& entry, uint32_t entrySize,
     std::optional<uint32_t> entryLiveUntilLedger, uint32_t newLiveUntilLedger,
     uint32_t ledgerVersion, SorobanNetworkConfig const& sorobanConfig)
+{
+    return createEntryRentChangeWithoutModification(
+        entry,
+        ledgerEntrySizeForRent(entry, entrySize, ledgerVersion, sorobanConfig),
+        entryLiveUntilLedger, newLiveUntilLedger);
+}
+
+CxxLedgerEntryRentChange
+createEntryRentChangeWithoutModification(
+    LedgerEntry const& entry, uint32_t entrySizeForRent,
+    std::optional<uint32_t> entryLiveUntilLedger, uint32_t newLiveUntilLedger)
 {
     CxxLedgerEntryRentChange rustChange{};
     rustChange.is_persistent = !isTemporaryEntry(entry.data);
     rustChange.is_code_entry = isContractCodeEntry(entry.data);
-    uint32_t entrySizeForRent =
-        ledgerEntrySizeForRent(entry, entrySize, ledgerVersion, sorobanConfig);
 
     if (entryLiveUntilLedger)
     {
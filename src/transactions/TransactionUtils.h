@@ -374,4 +374,9 @@ CxxLedgerEntryRentChange createEntryRentChangeWithoutModification(
     LedgerEntry const& entry, uint32_t entrySize,
     std::optional<uint32_t> entryLiveUntilLedger, uint32_t newLiveUntilLedger,
     uint32_t ledgerVersion, SorobanNetworkConfig const& sorobanConfig);
+
+// Same as above, for an entry whose size for rent is already known.
+CxxLedgerEntryRentChange createEntryRentChangeWithoutModification(
+    LedgerEntry const& entry, uint32_t entrySizeForRent,
+    std::optional<uint32_t> entryLiveUntilLedger, uint32_t newLiveUntilLedger);
 }
@@ -7295,6 +7295,8 @@ TEST_CASE("multiple version of same key in a single eviction scan",
     cfg.OVERRIDE_EVICTION_PARAMS_FOR_TESTING = true;
     cfg.TESTING_STARTING_EVICTION_SCAN_LEVEL = 1;
     cfg.TESTING_MAX_ENTRIES_TO_ARCHIVE = 100;
+    // Also check every eviction against the TTL index
+    cfg.SOROBAN_STATE_TTL_INDEX = true;
 
     SorobanTest test(cfg, false);
     ContractStorageTestClient client(test);
@@ -225,6 +225,18 @@ TransactionTestFrame::getFullHash() const
     return mTransactionFrame->getFullHash();
 }
 
+uint32_t
+TransactionTestFrame::getPrevalidatedLedgerSeq() const
+{
+    return mTransactionFrame->getPrevalidatedLedgerSeq();
+}
+
+void
+TransactionTestFrame::setPrevalidatedLedgerSeq(uint32_t ledgerSeq) const
+{
+    mTransactionFrame->setPrevalidatedLedgerSeq(ledgerSeq);
+}
+
 uint32_t
 TransactionTestFrame::getNumOperations() const
 {
@@ -312,6 +324,13 @@ TransactionTestFrame::insertKeysForTxApply(UnorderedSet<LedgerKey>& keys) const
     mTransactionFrame->insertKeysForTxApply(keys);
 }
 
+void
+TransactionTestFrame::insertSignaturesToVerify(
+    std::vector<PubKeyUtils::SignatureToVerify>& sigs, bool forApply) const
+{
+    mTransactionFrame->insertSignaturesToVerify(sigs, forApply);
+}
+
 void
 TransactionTestFrame::preParallelApply(
     AppConnector& app, AbstractLedgerTxn& ltx, TransactionMetaBuilder& meta,
@@ -341,6 +360,16 @@ TransactionTestFrame::processFeeSeqNum(AbstractLedgerTxn& ltx,
     return mTransactionTxResult->clone();
 }
 
+MutableTxResultPtr
+TransactionTestFrame::processFeeSeqNum(LedgerEntry& feeSource,
+                                       LedgerHeader const& header,
+                                       std::optional<int64_t> baseFee) const
+{
+    mTransactionTxResult =
+        mTransactionFrame->processFeeSeqNum(feeSource, header, baseFee);
+    return mTransactionTxResult->clone();
+}
+
 void
 TransactionTestFrame::processPostApply(
     AppConnector& app, AbstractLedgerTxn& ltx, TransactionMetaBuilder& meta,
@@ -384,6 +413,12 @@ TransactionTestFrame::sorobanResources() const
     return mTransactionFrame->sorobanResources();
 }
 
+SorobanFootprintTTLKeys const&
+TransactionTestFrame::sorobanFootprintTTLKeys() const
+{
+    return mTransactionFrame->sorobanFootprintTTLKeys();
+}
+
 SorobanTransactionData::_ext_t const&
 TransactionTestFrame::getResourcesExt() const
 {
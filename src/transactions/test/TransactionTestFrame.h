@@ -105,6 +105,8 @@ class TransactionTestFrame : public TransactionFrameBase
 
     Hash const& getContentsHash() const override;
     Hash const& getFullHash() const override;
+    uint32_t getPrevalidatedLedgerSeq() const override;
+    void setPrevalidatedLedgerSeq(uint32_t ledgerSeq) const override;
 
     uint32_t getNumOperations() const override;
     std::vector<std::shared_ptr<OperationFrame const>> const&
@@ -127,6 +129,9 @@ class TransactionTestFrame : public TransactionFrameBase
     void
     insertKeysForFeeProcessing(UnorderedSet<LedgerKey>& keys) const override;
     void insertKeysForTxApply(UnorderedSet<LedgerKey>& keys) const override;
+    void
+    insertSignaturesToVerify(std::vector<PubKeyUtils::SignatureToVerify>& sigs,
+                             bool forApply) const override;
 
     void preParallelApply(AppConnector& app, AbstractLedgerTxn& ltx,
                           TransactionMetaBuilder& meta,
@@ -149,6 +154,9 @@ class TransactionTestFrame : public TransactionFrameBase
     MutableTxResultPtr
     processFeeSeqNum(AbstractLedgerTxn& ltx,
                      std::optional<int64_t> baseFee) const override;
+    MutableTxResultPtr
+    processFeeSeqNum(LedgerEntry& feeSource, LedgerHeader const& header,
+                     std::optional<int64_t> baseFee) const override;
 
     void
     processPostApply(AppConnector& app, AbstractLedgerTxn& ltx,
@@ -165,6 +173,7 @@ class TransactionTestFrame : public TransactionFrameBase
 
     bool isSoroban() const override;
     SorobanResources const& sorobanResources() const override;
+    SorobanFootprintTTLKeys const& sorobanFootprintTTLKeys() const override;
     SorobanTransactionData::_ext_t const& getResourcesExt() const override;
     int64 declaredSorobanResourceFee() const override;
     bool XDRProvidesValidFee() const override;
@@ -2477,6 +2477,49 @@ TEST_CASE_VERSIONS("txenvelope", "[tx][envelope]")
     }
 }
 
+TEST_CASE("frames share cached transaction hashes", "[tx][envelope]")
+{
+    VirtualClock clock;
+    auto app = createTestApplication(clock, getTestConfig());
+    auto root = app->getRoot();
+    auto const& networkID = app->getNetworkID();
+    Hash otherNetworkID = sha256("other network");
+
+    auto tx = root->tx({payment(root->getPublicKey(), 1)});
+    auto const& env = tx->getEnvelope();
+    auto expected =
+        sha256(xdr::xdr_to_opaque(networkID, ENVELOPE_TYPE_TX, env.v1().tx));
+    auto expectedOther = sha256(
+        xdr::xdr_to_opaque(otherNetworkID, ENVELOPE_TYPE_TX, env.v1().tx));
+
+    // Every frame gets the hash of its own network, whichever frame filled
+    // the cache first
+    for (int i = 0; i < 2; ++i)
+    {
+        auto frame =
+            TransactionFrameBase::makeTransactionFromWire(networkID, env);
+        REQUIRE(frame->getContentsHash() == expected);
+        auto other =
+            TransactionFrameBase::makeTransactionFromWire(otherNetworkID, env);
+        REQUIRE(other->getContentsHash() == expectedOther);
+        REQUIRE(other->getFullHash() == frame->getFullHash());
+    }
+
+    CachedTxHashes hashes;
+    REQUIRE(getCachedTxHashes(tx->getFullHash(), otherNetworkID, hashes));
+    REQUIRE(hashes.mContentsHash == expectedOther);
+    REQUIRE(hashes.mSize == xdr::xdr_size(env));
+
+    auto fb = feeBump(*app, *root, tx, 1000);
+    auto const& fbEnv = fb->getEnvelope();
+    auto fbFrame =
+        TransactionFrameBase::makeTransactionFromWire(networkID, fbEnv);
+    REQUIRE(fbFrame->getContentsHash() ==
+            sha256(xdr::xdr_to_opaque(networkID, ENVELOPE_TYPE_TX_FEE_BUMP,
+                                      fbEnv.feeBump().tx)));
+    REQUIRE(fbFrame->getContentsHash() == fb->getContentsHash());
+}
+
 TEST_CASE("soroban txs not allowed before protocol upgrade",
           "[tx][envelope][soroban]")
 {
@@ -0,0 +1,93 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/BackgroundWorkQueue.h"
+#include "medida/counter.h"
+#include "medida/metrics_registry.h"
+#include "medida/timer.h"
+#include "util/GlobalChecks.h"
+#include "util/Thread.h"
+#include <Tracy.hpp>
+
+namespace stellar
+{
+
+std::string
+backgroundWorkClassName(BackgroundWorkClass cls)
+{
+    switch (cls)
+    {
+    case BackgroundWorkClass::APPLY:
+        return "apply";
+    case BackgroundWorkClass::SCP:
+        return "scp";
+    case BackgroundWorkClass::MERGE:
+        return "merge";
+    case BackgroundWorkClass::ARCHIVE_MERGE:
+        return "archive-merge";
+    case BackgroundWorkClass::PUBLISH:
+        return "publish";
+    default:
+        releaseAssert(false);
+    }
+}
+
+BackgroundWorkQueue::BackgroundWorkQueue(asio::io_context& ioContext,
+                                         medida::MetricsRegistry& metrics)
+    : mIOContext(ioContext)
+{
+    for (size_t i = 0; i < NUM_CLASSES; ++i)
+    {
+        auto cls = static_cast<BackgroundWorkClass>(i);
+        auto type = "background-" + backgroundWorkClassName(cls);
+        mQueueDepth[i] = &metrics.NewCounter({"app", type, "queue"});
+        mCPUTime[i] = &metrics.NewTimer({"app", type, "cpu"});
+    }
+}
+
+void
+BackgroundWorkQueue::post(BackgroundWorkClass cls, std::function<void()>&& f)
+{
+    auto i = static_cast<size_t>(cls);
+    releaseAssert(i < NUM_CLASSES);
+    {
+        std::lock_guard<std::mutex> guard(mMutex);
+        mQueues[i].emplace_back(std::move(f));
+    }
+    mQueueDepth[i]->inc();
+    // One handler per task, so every task gets a turn even though a handler
+    // may run a task posted after its own
+    asio::post(mIOContext, [this]() { runOne(); });
+}
+
+size_t
+BackgroundWorkQueue::size(BackgroundWorkClass cls) const
+{
+    std::lock_guard<std::mutex> guard(mMutex);
+    return mQueues[static_cast<size_t>(cls)].size();
+}
+
+void
+BackgroundWorkQueue::runOne()
+{
+    ZoneScoped;
+    std::function<void()> f;
+    size_t i = 0;
+    {
+        std::lock_guard<std::mutex> guard(mMutex);
+        while (i < NUM_CLASSES && mQueues[i].empty())
+        {
+            ++i;
+        }
+        releaseAssert(i < NUM_CLASSES);
+        f = std::move(mQueues[i].front());
+        mQueues[i].pop_front();
+    }
+    mQueueDepth[i]->dec();
+
+    auto start = currentThreadCPUTime();
+    f();
+    mCPUTime[i]->Update(currentThreadCPUTime() - start);
+}
+}
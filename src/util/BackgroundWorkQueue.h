@@ -0,0 +1,80 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/asio.h"
+#include "util/NonCopyable.h"
+#include <array>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace medida
+{
+class Counter;
+class MetricsRegistry;
+class Timer;
+}
+
+namespace stellar
+{
+
+// Classes of work run on the shared worker threads, most urgent first. When a
+// worker thread frees up it takes the oldest task of the most urgent class
+// that has any, so that a backlog of merges can't delay work the next ledger
+// close depends on.
+enum class BackgroundWorkClass
+{
+    // Work a ledger close is, or soon will be, waiting for
+    APPLY,
+    // Consensus, herder and overlay work
+    SCP,
+    // Bucket merges and indexing
+    MERGE,
+    // Hot archive merges, which only read and write archived state and can
+    // wait behind those of the live BucketList
+    ARCHIVE_MERGE,
+    // Publishing, catchup verification and debug output
+    PUBLISH,
+    NUM_CLASSES
+};
+
+std::string backgroundWorkClassName(BackgroundWorkClass cls);
+
+// Prioritizing front end to the worker io_context. Tasks posted here are held
+// in a queue per class, and each one posts a handler to the io_context that
+// runs whichever queued task is most urgent at the time. Anything posted to
+// the io_context directly still runs, in between, in the order it came.
+//
+// Tasks can't be preempted, so a long task of a lower class still holds on to
+// its thread; priorities only decide which task starts next.
+class BackgroundWorkQueue : NonMovableOrCopyable
+{
+  public:
+    BackgroundWorkQueue(asio::io_context& ioContext,
+                        medida::MetricsRegistry& metrics);
+
+    // Safe to call from any thread
+    void post(BackgroundWorkClass cls, std::function<void()>&& f);
+
+    size_t size(BackgroundWorkClass cls) const;
+
+  private:
+    static constexpr size_t NUM_CLASSES =
+        static_cast<size_t>(BackgroundWorkClass::NUM_CLASSES);
+
+    asio::io_context& mIOContext;
+    mutable std::mutex mMutex;
+    std::array<std::deque<std::function<void()>>, NUM_CLASSES> mQueues;
+
+    // Per class: tasks waiting, and CPU time of each task run
+    std::array<medida::Counter*, NUM_CLASSES> mQueueDepth;
+    std::array<medida::Timer*, NUM_CLASSES> mCPUTime;
+
+    void runOne();
+};
+}
@@ -32,11 +32,33 @@ BinaryFuseFilter<T>::BinaryFuseFilter(
 template <typename T>
 bool
 BinaryFuseFilter<T>::contains(LedgerKey const& key) const
+{
+    return mFilter.contain(hashKey(key));
+}
+
+template <typename T>
+uint64_t
+BinaryFuseFilter<T>::hashKey(LedgerKey const& key) const
 {
     SipHash24 hasher(mHashSeed.data());
     auto keybuf = xdr::xdr_to_opaque(key);
     hasher.update(keybuf.data(), keybuf.size());
-    return mFilter.contain(hasher.digest());
+    return hasher.digest();
+}
+
+template <typename T>
+void
+BinaryFuseFilter<T>::containsHashes(std::vector<uint64_t> const& keyHashes,
+                                    std::vector<bool>& result) const
+{
+    mFilter.contain_batch(keyHashes, result);
+}
+
+template <typename T>
+size_t
+BinaryFuseFilter<T>::getMemoryUsage() const
+{
+    return mFilter.size_in_bytes() + sizeof(mHashSeed);
 }
 
 template <typename T>
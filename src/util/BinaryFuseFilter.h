@@ -43,6 +43,20 @@ template <typename T> class BinaryFuseFilter : public NonMovableOrCopyable
 
     bool contains(LedgerKey const& key) const;
 
+    // Returns the digest of key that this filter is probed with. Hashing
+    // depends on the filter's seed, so digests can't be shared between
+    // filters.
+    uint64_t hashKey(LedgerKey const& key) const;
+
+    // Batched version of contains for keys already digested with hashKey.
+    // Sets result[i] to whether keyHashes[i] may be in the filter. Probing
+    // many keys at once lets their memory accesses overlap.
+    void containsHashes(std::vector<uint64_t> const& keyHashes,
+                        std::vector<bool>& result) const;
+
+    // Returns the number of bytes of memory used by the filter
+    size_t getMemoryUsage() const;
+
     bool operator==(BinaryFuseFilter<T> const& other) const;
 
     template <class Archive>
@@ -0,0 +1,323 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/BlockCompressedFile.h"
+#include "util/FileSystemException.h"
+#include "util/GlobalChecks.h"
+#include <Tracy.hpp>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace stellar
+{
+namespace BlockCompressedFile
+{
+
+namespace
+{
+size_t constexpr HEADER_SIZE = 2 * 4;
+size_t constexpr DIRECTORY_ENTRY_SIZE = 2 * 8;
+size_t constexpr TRAILER_SIZE = 8 + 2 * 4;
+
+uint64_t
+getUint(unsigned char const* p, size_t n)
+{
+    uint64_t res = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        res = (res << 8) | p[i];
+    }
+    return res;
+}
+
+void
+putUint(std::vector<char>& out, uint64_t v, size_t n)
+{
+    for (size_t i = n; i-- > 0;)
+    {
+        out.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+    }
+}
+
+void
+readFully(ReadAt const& readAt, char* dst, size_t len, size_t offset)
+{
+    if (readAt(dst, len, offset) != len)
+    {
+        throw std::runtime_error("Truncated block-compressed file");
+    }
+}
+
+[[noreturn]] void
+malformed()
+{
+    throw std::runtime_error("Malformed block-compressed file");
+}
+}
+
+bool
+supported()
+{
+#ifdef USE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::shared_ptr<Table const>
+readTable(ReadAt const& readAt, size_t fileSize)
+{
+    ZoneScoped;
+    unsigned char header[HEADER_SIZE];
+    if (fileSize < HEADER_SIZE ||
+        readAt(reinterpret_cast<char*>(header), HEADER_SIZE, 0) !=
+            HEADER_SIZE ||
+        getUint(header, 4) != MAGIC)
+    {
+        return nullptr;
+    }
+    if (getUint(header + 4, 4) != VERSION)
+    {
+        throw std::runtime_error(
+            fmt::format(FMT_STRING("Unsupported block-compressed file "
+                                   "version {}"),
+                        getUint(header + 4, 4)));
+    }
+    if (fileSize < HEADER_SIZE + TRAILER_SIZE)
+    {
+        malformed();
+    }
+
+    unsigned char trailer[TRAILER_SIZE];
+    readFully(readAt, reinterpret_cast<char*>(trailer), TRAILER_SIZE,
+              fileSize - TRAILER_SIZE);
+    auto rawSize = getUint(trailer, 8);
+    auto numBlocks = static_cast<size_t>(getUint(trailer + 8, 4));
+    if (getUint(trailer + 12, 4) != MAGIC ||
+        numBlocks > (fileSize - HEADER_SIZE - TRAILER_SIZE) /
+                        DIRECTORY_ENTRY_SIZE)
+    {
+        malformed();
+    }
+
+    auto dirOffset = fileSize - TRAILER_SIZE - numBlocks * DIRECTORY_ENTRY_SIZE;
+    std::vector<unsigned char> dir(numBlocks * DIRECTORY_ENTRY_SIZE);
+    readFully(readAt, reinterpret_cast<char*>(dir.data()), dir.size(),
+              dirOffset);
+
+    auto table = std::make_shared<Table>();
+    table->rawSize = rawSize;
+    table->rawOffsets.reserve(numBlocks + 1);
+    table->offsets.reserve(numBlocks + 1);
+    for (size_t i = 0; i < numBlocks; ++i)
+    {
+        auto entry = dir.data() + i * DIRECTORY_ENTRY_SIZE;
+        table->rawOffsets.emplace_back(getUint(entry, 8));
+        table->offsets.emplace_back(getUint(entry + 8, 8));
+    }
+    table->rawOffsets.emplace_back(rawSize);
+    table->offsets.emplace_back(dirOffset);
+
+    // Blocks are non-empty and back to back in both files
+    if (numBlocks == 0 ? rawSize != 0 || dirOffset != HEADER_SIZE
+                       : table->rawOffsets[0] != 0 ||
+                             table->offsets[0] != HEADER_SIZE)
+    {
+        malformed();
+    }
+    for (size_t i = 0; i < numBlocks; ++i)
+    {
+        if (table->rawOffsets[i] >= table->rawOffsets[i + 1] ||
+            table->offsets[i] >= table->offsets[i + 1])
+        {
+            malformed();
+        }
+    }
+    return table;
+}
+
+std::shared_ptr<Table const>
+readTable(std::string const& path)
+{
+    std::ifstream in(path, std::ifstream::binary);
+    if (!in)
+    {
+        FileSystemException::failWithErrno("failed to open " + path + ": ");
+    }
+    in.seekg(0, std::ios::end);
+    auto fileSize = static_cast<size_t>(in.tellg());
+    return readTable(
+        [&in](char* dst, size_t len, size_t offset) {
+            in.clear();
+            in.seekg(offset);
+            in.read(dst, len);
+            return static_cast<size_t>(in.gcount());
+        },
+        fileSize);
+}
+
+size_t
+originalSize(std::string const& path)
+{
+    auto table = readTable(path);
+    return table ? static_cast<size_t>(table->rawSize) : fs::size(path);
+}
+
+Reader::Reader(std::shared_ptr<Table const> table)
+    : mTable(std::move(table)), mCached(std::numeric_limits<size_t>::max())
+{
+    if (!supported())
+    {
+        throw std::runtime_error(
+            "Reading block-compressed files requires a build with zlib");
+    }
+}
+
+void
+Reader::load(ReadAt const& readAt, size_t block)
+{
+    ZoneScoped;
+    auto const& t = *mTable;
+    auto size = static_cast<size_t>(t.offsets[block + 1] - t.offsets[block]);
+    mCompressed.resize(size);
+    readFully(readAt, mCompressed.data(), size,
+              static_cast<size_t>(t.offsets[block]));
+
+    mCached = std::numeric_limits<size_t>::max();
+#ifdef USE_ZLIB
+    auto rawSize =
+        static_cast<size_t>(t.rawOffsets[block + 1] - t.rawOffsets[block]);
+    mBlock.resize(rawSize);
+    auto len = static_cast<uLongf>(rawSize);
+    auto err = uncompress(reinterpret_cast<Bytef*>(mBlock.data()), &len,
+                          reinterpret_cast<Bytef const*>(mCompressed.data()),
+                          static_cast<uLong>(size));
+    if (err != Z_OK || len != rawSize)
+    {
+        malformed();
+    }
+    mCached = block;
+#else
+    releaseAssert(false);
+#endif
+}
+
+size_t
+Reader::read(ReadAt const& readAt, char* dst, size_t len, size_t offset)
+{
+    auto const& t = *mTable;
+    size_t done = 0;
+    while (done < len && offset < t.rawSize)
+    {
+        auto it = std::upper_bound(t.rawOffsets.begin(), t.rawOffsets.end(),
+                                   static_cast<uint64_t>(offset));
+        auto block = static_cast<size_t>(it - t.rawOffsets.begin()) - 1;
+        if (block != mCached)
+        {
+            load(readAt, block);
+        }
+        auto within = offset - static_cast<size_t>(t.rawOffsets[block]);
+        auto n = std::min(len - done, mBlock.size() - within);
+        std::memcpy(dst + done, mBlock.data() + within, n);
+        done += n;
+        offset += n;
+    }
+    return done;
+}
+
+Writer::Writer(asio::io_context& ctx, bool fsyncOnClose)
+    : mOut(ctx, fsyncOnClose)
+{
+}
+
+void
+Writer::open(std::string const& path)
+{
+    mOut.open(path);
+    std::vector<char> header;
+    putUint(header, MAGIC, 4);
+    putUint(header, VERSION, 4);
+    mOut.writeBytes(header.data(), header.size());
+    mOffset = header.size();
+}
+
+void
+Writer::write(char const* data, size_t size)
+{
+    mPending.insert(mPending.end(), data, data + size);
+}
+
+void
+Writer::endBlock()
+{
+    ZoneScoped;
+    if (mPending.empty())
+    {
+        return;
+    }
+#ifdef USE_ZLIB
+    auto len = compressBound(static_cast<uLong>(mPending.size()));
+    mCompressed.resize(len);
+    // Buckets are compressed as they are merged, favor speed
+    auto err = compress2(reinterpret_cast<Bytef*>(mCompressed.data()), &len,
+                         reinterpret_cast<Bytef const*>(mPending.data()),
+                         static_cast<uLong>(mPending.size()), Z_BEST_SPEED);
+    if (err != Z_OK)
+    {
+        throw std::runtime_error(
+            fmt::format(FMT_STRING("Failed to compress block: {}"), err));
+    }
+    mOut.writeBytes(mCompressed.data(), len);
+    mRawOffsets.emplace_back(mRawSize);
+    mOffsets.emplace_back(mOffset);
+    mRawSize += mPending.size();
+    mOffset += len;
+    mPending.clear();
+#else
+    throw std::runtime_error(
+        "Writing block-compressed files requires a build with zlib");
+#endif
+}
+
+void
+Writer::close(fs::DurabilityGroup* group)
+{
+    ZoneScoped;
+    endBlock();
+    if (mRawOffsets.size() > std::numeric_limits<uint32_t>::max())
+    {
+        throw std::runtime_error("Too many blocks in block-compressed file");
+    }
+    std::vector<char> dir;
+    dir.reserve(mRawOffsets.size() * DIRECTORY_ENTRY_SIZE + TRAILER_SIZE);
+    for (size_t i = 0; i < mRawOffsets.size(); ++i)
+    {
+        putUint(dir, mRawOffsets[i], 8);
+        putUint(dir, mOffsets[i], 8);
+    }
+    putUint(dir, mRawSize, 8);
+    putUint(dir, mRawOffsets.size(), 4);
+    putUint(dir, MAGIC, 4);
+    mOut.writeBytes(dir.data(), dir.size());
+    if (group)
+    {
+        mOut.close(*group);
+    }
+    else
+    {
+        mOut.close();
+    }
+}
+}
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/XDRStream.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace stellar
+{
+
+// Block-compressed file format, used for local bucket files when
+// BUCKETLIST_DB_COMPRESS_BUCKETS is set. The original file is cut into
+// blocks, each compressed on its own with zlib, so that any range of the
+// original file can be read by decompressing only the blocks covering it:
+//
+//   uint32 magic ("SBKZ")
+//   uint32 version (1)
+//   the compressed blocks, back to back
+//   numBlocks directory entries of
+//     uint64 rawOffset (of the block in the original file)
+//     uint64 offset (of the compressed block in this file)
+//   uint64 rawSize (of the original file)
+//   uint32 numBlocks
+//   uint32 magic
+//
+// All integers are big-endian. Files written by XDROutputFileStream start
+// with a record mark, which has its high bit set, so they can't be mistaken
+// for block-compressed files. BufferedFileReader recognizes the format on
+// open and reads through it transparently, so offsets and sizes seen by its
+// users are always those of the original file.
+namespace BlockCompressedFile
+{
+uint32_t constexpr MAGIC = 0x53424b5a;
+uint32_t constexpr VERSION = 1;
+
+// Reads up to `len` bytes at `offset` of the stored file, returning the
+// number of bytes read
+using ReadAt = std::function<size_t(char* dst, size_t len, size_t offset)>;
+
+struct Table
+{
+    uint64_t rawSize{0};
+    // Per block, followed by rawSize and the offset of the directory, so that
+    // block i spans [rawOffsets[i], rawOffsets[i + 1]) of the original file
+    std::vector<uint64_t> rawOffsets;
+    std::vector<uint64_t> offsets;
+
+    size_t
+    numBlocks() const
+    {
+        return rawOffsets.size() - 1;
+    }
+};
+
+// True if this build can write and read block-compressed files
+bool supported();
+
+// Returns nullptr if the stored file of `fileSize` bytes isn't
+// block-compressed. Throws if it is but is malformed.
+std::shared_ptr<Table const> readTable(ReadAt const& readAt, size_t fileSize);
+std::shared_ptr<Table const> readTable(std::string const& path);
+
+// Size of the original file, whether or not the file at path is
+// block-compressed
+size_t originalSize(std::string const& path);
+
+// Reads ranges of the original file, keeping the last decompressed block
+class Reader
+{
+    std::shared_ptr<Table const> mTable;
+    size_t mCached;
+    std::vector<char> mBlock;
+    std::vector<char> mCompressed;
+
+    void load(ReadAt const& readAt, size_t block);
+
+  public:
+    // Throws if this build can't read block-compressed files
+    explicit Reader(std::shared_ptr<Table const> table);
+
+    Table const&
+    table() const
+    {
+        return *mTable;
+    }
+
+    // Like ReadAt, but at an offset of the original file
+    size_t read(ReadAt const& readAt, char* dst, size_t len, size_t offset);
+};
+
+// Writes a block-compressed file. The caller decides where blocks end, the
+// bytes written since the last `endBlock` make up the next block.
+class Writer
+{
+    OutputFileStream mOut;
+    std::vector<char> mPending;
+    std::vector<char> mCompressed;
+    uint64_t mRawSize{0};
+    uint64_t mOffset{0};
+    std::vector<uint64_t> mRawOffsets;
+    std::vector<uint64_t> mOffsets;
+
+  public:
+    Writer(asio::io_context& ctx, bool fsyncOnClose);
+
+    void open(std::string const& path);
+    void write(char const* data, size_t size);
+    // Compresses and writes the pending bytes, if any, as a block
+    void endBlock();
+    // Ends the last block and writes the directory. With a group, leaves
+    // syncing the file to it, like OutputFileStream::close.
+    void close(fs::DurabilityGroup* group = nullptr);
+};
+}
+}
@@ -0,0 +1,379 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/BufferedFileReader.h"
+#include "util/BlockCompressedFile.h"
+#include "util/FileSystemException.h"
+#include "util/Fs.h"
+#include "util/GlobalChecks.h"
+#include "util/Logging.h"
+#include <Tracy.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace stellar
+{
+
+namespace
+{
+size_t
+roundUp(size_t n)
+{
+    return (n + BufferedFileReader::ALIGNMENT - 1) /
+           BufferedFileReader::ALIGNMENT * BufferedFileReader::ALIGNMENT;
+}
+
+#ifndef _WIN32
+// Reads until `len` bytes or the end of the file
+size_t
+preadFully(int fd, char* dst, size_t len, size_t offset)
+{
+    size_t done = 0;
+    while (done < len)
+    {
+        auto res = ::pread(fd, dst + done, len - done,
+                           static_cast<off_t>(offset + done));
+        if (res == 0)
+        {
+            break;
+        }
+        if (res < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            FileSystemException::failWithErrno(
+                "BufferedFileReader: pread failed: ");
+        }
+        done += static_cast<size_t>(res);
+    }
+    return done;
+}
+#endif
+}
+
+void
+BufferedFileReader::AlignedDelete::operator()(char* p) const
+{
+    ::operator delete[](p, std::align_val_t(ALIGNMENT));
+}
+
+BufferedFileReader::AlignedBuffer
+BufferedFileReader::allocate(size_t size)
+{
+    return AlignedBuffer(static_cast<char*>(
+        ::operator new[](size, std::align_val_t(ALIGNMENT))));
+}
+
+BufferedFileReader::BufferedFileReader(size_t bufferSize, bool sequential)
+    : mBufferSize(roundUp(std::max<size_t>(bufferSize, 2 * ALIGNMENT)))
+    , mSequential(sequential)
+{
+}
+
+BufferedFileReader::BufferedFileReader(BufferedFileReader&& other) noexcept
+    : mBufferSize(other.mBufferSize)
+    , mSequential(other.mSequential)
+    , mFileSize(other.mFileSize)
+    , mBlocks(std::move(other.mBlocks))
+    , mBuf(std::move(other.mBuf))
+    , mCapacity(std::exchange(other.mCapacity, 0))
+    , mBufStart(std::exchange(other.mBufStart, 0))
+    , mBufLen(std::exchange(other.mBufLen, 0))
+    , mBufPos(std::exchange(other.mBufPos, 0))
+    , mAhead(std::move(other.mAhead))
+    , mAheadOffset(other.mAheadOffset)
+    , mAheadRead(std::move(other.mAheadRead))
+#ifdef _WIN32
+    , mIn(std::move(other.mIn))
+#else
+    , mFd(std::exchange(other.mFd, -1))
+#endif
+{
+}
+
+BufferedFileReader&
+BufferedFileReader::operator=(BufferedFileReader&& other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        mBufferSize = other.mBufferSize;
+        mSequential = other.mSequential;
+        mFileSize = other.mFileSize;
+        mBlocks = std::move(other.mBlocks);
+        mBuf = std::move(other.mBuf);
+        mCapacity = std::exchange(other.mCapacity, 0);
+        mBufStart = std::exchange(other.mBufStart, 0);
+        mBufLen = std::exchange(other.mBufLen, 0);
+        mBufPos = std::exchange(other.mBufPos, 0);
+        mAhead = std::move(other.mAhead);
+        mAheadOffset = other.mAheadOffset;
+        mAheadRead = std::move(other.mAheadRead);
+#ifdef _WIN32
+        mIn = std::move(other.mIn);
+#else
+        mFd = std::exchange(other.mFd, -1);
+#endif
+    }
+    return *this;
+}
+
+BufferedFileReader::~BufferedFileReader()
+{
+    close();
+}
+
+void
+BufferedFileReader::open(
+    std::string const& path,
+    std::shared_ptr<BlockCompressedFile::Table const> blocks)
+{
+    ZoneScoped;
+    if (isOpen())
+    {
+        FileSystemException::failWith("BufferedFileReader: " + path +
+                                      " opened twice");
+    }
+#ifdef _WIN32
+    mIn.open(path, std::ifstream::binary);
+    if (!mIn)
+    {
+        FileSystemException::failWithErrno("failed to open " + path + ": ");
+    }
+    mFileSize = fs::size(mIn);
+#else
+    while ((mFd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC)) == -1)
+    {
+        if (errno != EINTR)
+        {
+            FileSystemException::failWithErrno("failed to open " + path +
+                                               ": ");
+        }
+    }
+    auto end = ::lseek(mFd, 0, SEEK_END);
+    mFileSize = end < 0 ? 0 : static_cast<size_t>(end);
+#ifdef POSIX_FADV_SEQUENTIAL
+    if (mSequential)
+    {
+        // Best-effort, doubles the kernel's own readahead window
+        posix_fadvise(mFd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+#endif
+#endif
+    mBufStart = mBufLen = mBufPos = 0;
+
+    try
+    {
+        if (!blocks)
+        {
+            blocks = BlockCompressedFile::readTable(
+                [this](char* dst, size_t len, size_t offset) {
+                    return readRaw(dst, len, offset);
+                },
+                mFileSize);
+        }
+        if (blocks)
+        {
+            mBlocks = std::make_unique<BlockCompressedFile::Reader>(blocks);
+            mFileSize = static_cast<size_t>(blocks->rawSize);
+        }
+    }
+    catch (...)
+    {
+        close();
+        throw;
+    }
+}
+
+void
+BufferedFileReader::close()
+{
+    waitReadAhead();
+#ifdef _WIN32
+    if (mIn.is_open())
+    {
+        mIn.close();
+    }
+#else
+    if (mFd != -1)
+    {
+        ::close(mFd);
+        mFd = -1;
+    }
+#endif
+    mBlocks.reset();
+    mBufStart = mBufLen = mBufPos = 0;
+}
+
+bool
+BufferedFileReader::isOpen() const
+{
+#ifdef _WIN32
+    return mIn.is_open();
+#else
+    return mFd != -1;
+#endif
+}
+
+void
+BufferedFileReader::seek(size_t pos)
+{
+    if (pos >= mBufStart && pos <= mBufStart + mBufLen)
+    {
+        mBufPos = pos - mBufStart;
+    }
+    else
+    {
+        mBufStart = pos;
+        mBufLen = mBufPos = 0;
+    }
+}
+
+void
+BufferedFileReader::advance(size_t n)
+{
+    releaseAssert(n <= mBufLen - mBufPos);
+    mBufPos += n;
+}
+
+size_t
+BufferedFileReader::readAt(char* dst, size_t len, size_t offset)
+{
+    if (mBlocks)
+    {
+        return mBlocks->read(
+            [this](char* d, size_t l, size_t o) { return readRaw(d, l, o); },
+            dst, len, offset);
+    }
+    return readRaw(dst, len, offset);
+}
+
+size_t
+BufferedFileReader::readRaw(char* dst, size_t len, size_t offset)
+{
+#ifdef _WIN32
+    mIn.clear();
+    mIn.seekg(offset);
+    mIn.read(dst, len);
+    if (mIn.bad())
+    {
+        FileSystemException::failWith("BufferedFileReader: read failed");
+    }
+    return static_cast<size_t>(mIn.gcount());
+#else
+    return preadFully(mFd, dst, len, offset);
+#endif
+}
+
+void
+BufferedFileReader::fill(size_t n, bool greedy)
+{
+    ZoneScoped;
+    if (!isOpen())
+    {
+        return;
+    }
+
+    // Keep the unconsumed bytes, at the front of the buffer
+    auto tail = mBufLen - mBufPos;
+    auto want = greedy ? std::max(n, mBufferSize) : n;
+    if (want > mCapacity)
+    {
+        auto capacity = roundUp(want);
+        auto buf = allocate(capacity);
+        if (tail > 0)
+        {
+            std::memcpy(buf.get(), mBuf.get() + mBufPos, tail);
+        }
+        mBuf = std::move(buf);
+        mCapacity = capacity;
+    }
+    else if (tail > 0 && mBufPos > 0)
+    {
+        std::memmove(mBuf.get(), mBuf.get() + mBufPos, tail);
+    }
+    mBufStart += mBufPos;
+    mBufPos = 0;
+    mBufLen = tail;
+
+    auto end = mBufStart + mBufLen;
+    auto target = want;
+    if (mAheadRead.valid())
+    {
+        auto offset = mAheadOffset;
+        auto got = waitReadAhead();
+        if (offset == end && got <= mCapacity - mBufLen)
+        {
+            std::memcpy(mBuf.get() + mBufLen, mAhead.get(), got);
+            mBufLen += got;
+            end += got;
+            // Don't block on filling the rest of the buffer, the next chunk
+            // is read ahead again below
+            target = n;
+        }
+    }
+    if (mBufLen < target)
+    {
+        auto got = readAt(mBuf.get() + mBufLen, target - mBufLen, end);
+        mBufLen += got;
+        end += got;
+    }
+
+    // Blocks are decompressed as they are read, and the reader doesn't keep
+    // more than one of them
+    if (greedy && mSequential && !mBlocks && end < mFileSize)
+    {
+        startReadAhead(end);
+    }
+}
+
+void
+BufferedFileReader::startReadAhead(size_t offset)
+{
+#ifndef _WIN32
+    // Half a buffer, so that it fits after the unconsumed tail of the
+    // current one in the common case of records much smaller than buffers
+    auto len = mBufferSize / 2;
+    if (!mAhead)
+    {
+        mAhead = allocate(len);
+    }
+    mAheadOffset = offset;
+    mAheadRead = std::async(std::launch::async,
+                            [fd = mFd, dst = mAhead.get(), len, offset]() {
+                                return preadFully(fd, dst, len, offset);
+                            });
+#endif
+}
+
+size_t
+BufferedFileReader::waitReadAhead()
+{
+    if (!mAheadRead.valid())
+    {
+        return 0;
+    }
+    try
+    {
+        return mAheadRead.get();
+    }
+    catch (std::exception const& e)
+    {
+        // The range is read again synchronously, which reports the error
+        CLOG_DEBUG(Fs, "Read-ahead failed: {}", e.what());
+        return 0;
+    }
+}
+}
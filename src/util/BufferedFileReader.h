@@ -0,0 +1,141 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include <cstddef>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <string>
+
+namespace stellar
+{
+
+namespace BlockCompressedFile
+{
+struct Table;
+class Reader;
+}
+
+// Reads a file through a large, page-aligned buffer, exposing the buffered
+// bytes so that callers can decode them in place instead of copying them out
+// one record at a time.
+//
+// Sequential readers advise the kernel of their access pattern and read the
+// next chunk of the file on a background thread while the current one is
+// being consumed. Other readers only read as much as they ask for, so that
+// random lookups don't pull whole buffers from disk.
+//
+// Block-compressed files (see BlockCompressedFile) are read as the original
+// file they hold, one decompressed block at a time and without reading ahead.
+//
+// Not thread-safe, but movable: a pending background read only refers to the
+// file descriptor and to a buffer the reader owns, not to the reader itself.
+class BufferedFileReader
+{
+  public:
+    static constexpr size_t ALIGNMENT = 4096;
+    static constexpr size_t DEFAULT_BUFFER_SIZE = size_t(1) << 20;
+
+    explicit BufferedFileReader(size_t bufferSize = DEFAULT_BUFFER_SIZE,
+                                bool sequential = false);
+    BufferedFileReader(BufferedFileReader&& other) noexcept;
+    BufferedFileReader& operator=(BufferedFileReader&& other) noexcept;
+    BufferedFileReader(BufferedFileReader const&) = delete;
+    BufferedFileReader& operator=(BufferedFileReader const&) = delete;
+    ~BufferedFileReader();
+
+    // Throws FileSystemException if the file can't be opened. The block table
+    // of a block-compressed file is read from the file unless given.
+    void open(std::string const& path,
+              std::shared_ptr<BlockCompressedFile::Table const> blocks =
+                  nullptr);
+    void close();
+    bool isOpen() const;
+
+    // Size of the file when it was opened, or of the original file if it is
+    // block-compressed
+    size_t
+    size() const
+    {
+        return mFileSize;
+    }
+
+    size_t
+    pos() const
+    {
+        return mBufStart + mBufPos;
+    }
+
+    // Seeking within the buffered bytes doesn't read anything
+    void seek(size_t pos);
+
+    // Makes at least `n` bytes from the current position available at
+    // `data()`, and returns the number of bytes available, which is less than
+    // `n` only at the end of the file. When `greedy`, fills the whole buffer
+    // (and starts reading ahead, for sequential readers) rather than reading
+    // just `n` bytes.
+    size_t
+    ensure(size_t n, bool greedy = true)
+    {
+        auto avail = mBufLen - mBufPos;
+        if (avail >= n)
+        {
+            return avail;
+        }
+        fill(n, greedy);
+        return mBufLen - mBufPos;
+    }
+
+    char const*
+    data() const
+    {
+        return mBuf.get() + mBufPos;
+    }
+
+    // Consumes `n` of the bytes made available by `ensure`
+    void advance(size_t n);
+
+  private:
+    struct AlignedDelete
+    {
+        void operator()(char* p) const;
+    };
+    using AlignedBuffer = std::unique_ptr<char[], AlignedDelete>;
+
+    size_t mBufferSize;
+    bool mSequential;
+    size_t mFileSize{0};
+    std::unique_ptr<BlockCompressedFile::Reader> mBlocks;
+
+    AlignedBuffer mBuf;
+    size_t mCapacity{0};
+    // File offset of mBuf[0]
+    size_t mBufStart{0};
+    size_t mBufLen{0};
+    size_t mBufPos{0};
+
+    // Background read of the chunk of the file following the buffer
+    AlignedBuffer mAhead;
+    size_t mAheadOffset{0};
+    std::future<size_t> mAheadRead;
+
+#ifdef _WIN32
+    std::ifstream mIn;
+#else
+    int mFd{-1};
+#endif
+
+    static AlignedBuffer allocate(size_t size);
+    size_t readAt(char* dst, size_t len, size_t offset);
+    // Reads the stored bytes, as opposed to the original ones
+    size_t readRaw(char* dst, size_t len, size_t offset);
+    void fill(size_t n, bool greedy);
+    void startReadAhead(size_t offset);
+    // Returns the size of the pending background read, or 0 if there is
+    // none or it failed
+    size_t waitReadAhead();
+};
+}
@@ -0,0 +1,332 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/Decoder.h"
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define STELLAR_B64_SSSE3 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define STELLAR_B64_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Base64 carries every transaction submitted to /tx and every key and entry
+// of the query server, so it converts whole blocks of 12 bytes / 16 chars
+// (SSSE3) or 48 bytes / 64 chars (NEON) at a time, and 3 bytes / 4 chars
+// otherwise. Decoding only takes the fast path over groups of 4 characters
+// of the alphabet: anything else (padding, whitespace, garbage) is left to
+// the generic decoder, starting at a group boundary where it has no bits
+// pending.
+
+namespace stellar
+{
+namespace decoder
+{
+namespace
+{
+
+char const B64_ALPHABET[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Value of every character, or -1 if it isn't in the alphabet
+std::array<int8_t, 256> const B64_VALUES = [] {
+    std::array<int8_t, 256> values;
+    values.fill(-1);
+    for (int i = 0; i < 64; ++i)
+    {
+        values[static_cast<unsigned char>(B64_ALPHABET[i])] =
+            static_cast<int8_t>(i);
+    }
+    return values;
+}();
+
+void
+encodeB64Scalar(uint8_t const* in, size_t n, char* out)
+{
+    size_t i = 0;
+    for (; i + 3 <= n; i += 3)
+    {
+        uint32_t v = (uint32_t(in[i]) << 16) | (uint32_t(in[i + 1]) << 8) |
+                     in[i + 2];
+        *out++ = B64_ALPHABET[v >> 18];
+        *out++ = B64_ALPHABET[(v >> 12) & 0x3f];
+        *out++ = B64_ALPHABET[(v >> 6) & 0x3f];
+        *out++ = B64_ALPHABET[v & 0x3f];
+    }
+    if (i < n)
+    {
+        uint32_t v = uint32_t(in[i]) << 16;
+        if (i + 1 < n)
+        {
+            v |= uint32_t(in[i + 1]) << 8;
+        }
+        *out++ = B64_ALPHABET[v >> 18];
+        *out++ = B64_ALPHABET[(v >> 12) & 0x3f];
+        *out++ = i + 1 < n ? B64_ALPHABET[(v >> 6) & 0x3f] : '=';
+        *out++ = '=';
+    }
+}
+
+// Decodes groups of 4 characters of the alphabet, returns how many
+// characters it decoded
+size_t
+decodeB64Scalar(char const* in, size_t n, uint8_t* out)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        auto value = [&](size_t j) {
+            return B64_VALUES[static_cast<unsigned char>(in[i + j])];
+        };
+        int32_t a = value(0);
+        int32_t b = value(1);
+        int32_t c = value(2);
+        int32_t d = value(3);
+        if ((a | b | c | d) < 0)
+        {
+            break;
+        }
+        uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+        *out++ = static_cast<uint8_t>(v >> 16);
+        *out++ = static_cast<uint8_t>(v >> 8);
+        *out++ = static_cast<uint8_t>(v);
+    }
+    return i;
+}
+
+#ifdef STELLAR_B64_SSSE3
+bool
+haveSSSE3()
+{
+    static bool const have = __builtin_cpu_supports("ssse3");
+    return have;
+}
+
+// Encodes blocks of 12 bytes, reading 16 at a time, returns how many bytes
+// it encoded
+__attribute__((target("ssse3"))) size_t
+encodeB64SSSE3(uint8_t const* in, size_t n, char* out)
+{
+    // Spreads each 3 bytes over a 32 bit lane, as b1 b0 b2 b1
+    __m128i const spread =
+        _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    // Offset from each 6 bit value to its character, by range
+    __m128i const offsets =
+        _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                      '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 12)
+    {
+        __m128i v = _mm_shuffle_epi8(
+            _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + i)),
+            spread);
+        // Moves the 4 values of each lane to their own byte
+        __m128i ac =
+            _mm_mulhi_epu16(_mm_and_si128(v, _mm_set1_epi32(0x0fc0fc00)),
+                            _mm_set1_epi32(0x04000040));
+        __m128i bd =
+            _mm_mullo_epi16(_mm_and_si128(v, _mm_set1_epi32(0x003f03f0)),
+                            _mm_set1_epi32(0x01000010));
+        __m128i values = _mm_or_si128(ac, bd);
+        // 0 for A-Z, 1 for a-z, 2-11 for digits, 12 for + and 13 for /
+        __m128i range = _mm_subs_epu8(values, _mm_set1_epi8(51));
+        __m128i isUpper = _mm_cmpgt_epi8(_mm_set1_epi8(26), values);
+        range = _mm_or_si128(range, _mm_and_si128(isUpper, _mm_set1_epi8(13)));
+        __m128i chars =
+            _mm_add_epi8(values, _mm_shuffle_epi8(offsets, range));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i / 3 * 4), chars);
+    }
+    return i;
+}
+
+// Whether c, taken as unsigned, is at most max
+__attribute__((target("ssse3"))) __m128i
+atMost(__m128i c, char max)
+{
+    return _mm_cmpeq_epi8(_mm_min_epu8(c, _mm_set1_epi8(max)), c);
+}
+
+// Values of 16 characters, with `valid` cleared where they aren't in the
+// alphabet
+__attribute__((target("ssse3"))) __m128i
+b64ValuesSSSE3(__m128i c, __m128i& valid)
+{
+    __m128i upper = _mm_sub_epi8(c, _mm_set1_epi8('A'));
+    __m128i lower = _mm_sub_epi8(c, _mm_set1_epi8('a'));
+    __m128i digit = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+    __m128i isUpper = atMost(upper, 25);
+    __m128i isLower = atMost(lower, 25);
+    __m128i isDigit = atMost(digit, 9);
+    __m128i isPlus = _mm_cmpeq_epi8(c, _mm_set1_epi8('+'));
+    __m128i isSlash = _mm_cmpeq_epi8(c, _mm_set1_epi8('/'));
+    valid = _mm_and_si128(
+        valid, _mm_or_si128(_mm_or_si128(isUpper, isLower),
+                            _mm_or_si128(isDigit, _mm_or_si128(isPlus,
+                                                               isSlash))));
+    __m128i v = _mm_and_si128(isUpper, upper);
+    v = _mm_or_si128(v, _mm_and_si128(isLower, _mm_add_epi8(
+                                                   lower, _mm_set1_epi8(26))));
+    v = _mm_or_si128(v, _mm_and_si128(isDigit, _mm_add_epi8(
+                                                   digit, _mm_set1_epi8(52))));
+    v = _mm_or_si128(v, _mm_and_si128(isPlus, _mm_set1_epi8(62)));
+    return _mm_or_si128(v, _mm_and_si128(isSlash, _mm_set1_epi8(63)));
+}
+
+// Decodes blocks of 16 characters of the alphabet, writing 16 bytes for
+// every 12 decoded, returns how many characters it decoded
+__attribute__((target("ssse3"))) size_t
+decodeB64SSSE3(char const* in, size_t n, uint8_t* out)
+{
+    // The 24 bits of each 4 values are in the low 3 bytes of a lane, the
+    // first one highest
+    __m128i const gather =
+        _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    size_t i = 0;
+    // The last block may write up to 4 bytes past the 3 per 4 characters
+    // of the input, so the input has to hold at least 8 characters more
+    for (; i + 24 <= n; i += 16)
+    {
+        __m128i valid = _mm_set1_epi8(-1);
+        __m128i values = b64ValuesSSSE3(
+            _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + i)), valid);
+        if (_mm_movemask_epi8(valid) != 0xffff)
+        {
+            break;
+        }
+        // a * 64 + b and c * 64 + d, then ab * 4096 + cd
+        __m128i pairs =
+            _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+        __m128i lanes = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i / 4 * 3),
+                         _mm_shuffle_epi8(lanes, gather));
+    }
+    return i;
+}
+#endif
+
+#ifdef STELLAR_B64_NEON
+uint8x16x4_t
+loadAlphabetNeon()
+{
+    auto p = reinterpret_cast<uint8_t const*>(B64_ALPHABET);
+    return {{vld1q_u8(p), vld1q_u8(p + 16), vld1q_u8(p + 32),
+             vld1q_u8(p + 48)}};
+}
+
+// Encodes blocks of 48 bytes, returns how many bytes it encoded
+size_t
+encodeB64Neon(uint8_t const* in, size_t n, char* out)
+{
+    uint8x16x4_t const alphabet = loadAlphabetNeon();
+    uint8x16_t const low6 = vdupq_n_u8(0x3f);
+    size_t i = 0;
+    for (; i + 48 <= n; i += 48)
+    {
+        // De-interleaves the first, second and third byte of each group
+        uint8x16x3_t b = vld3q_u8(in + i);
+        uint8x16x4_t chars;
+        chars.val[0] = vshrq_n_u8(b.val[0], 2);
+        chars.val[1] = vandq_u8(
+            vorrq_u8(vshlq_n_u8(b.val[0], 4), vshrq_n_u8(b.val[1], 4)), low6);
+        chars.val[2] = vandq_u8(
+            vorrq_u8(vshlq_n_u8(b.val[1], 2), vshrq_n_u8(b.val[2], 6)), low6);
+        chars.val[3] = vandq_u8(b.val[2], low6);
+        for (auto& c : chars.val)
+        {
+            c = vqtbl4q_u8(alphabet, c);
+        }
+        vst4q_u8(reinterpret_cast<uint8_t*>(out + i / 3 * 4), chars);
+    }
+    return i;
+}
+
+uint8x16_t
+b64ValuesNeon(uint8x16_t c, uint8x16_t& valid)
+{
+    uint8x16_t upper = vsubq_u8(c, vdupq_n_u8('A'));
+    uint8x16_t lower = vsubq_u8(c, vdupq_n_u8('a'));
+    uint8x16_t digit = vsubq_u8(c, vdupq_n_u8('0'));
+    uint8x16_t isUpper = vcleq_u8(upper, vdupq_n_u8(25));
+    uint8x16_t isLower = vcleq_u8(lower, vdupq_n_u8(25));
+    uint8x16_t isDigit = vcleq_u8(digit, vdupq_n_u8(9));
+    uint8x16_t isPlus = vceqq_u8(c, vdupq_n_u8('+'));
+    uint8x16_t isSlash = vceqq_u8(c, vdupq_n_u8('/'));
+    valid = vandq_u8(valid, vorrq_u8(vorrq_u8(isUpper, isLower),
+                                     vorrq_u8(isDigit,
+                                              vorrq_u8(isPlus, isSlash))));
+    uint8x16_t v = vandq_u8(isUpper, upper);
+    v = vorrq_u8(v, vandq_u8(isLower, vaddq_u8(lower, vdupq_n_u8(26))));
+    v = vorrq_u8(v, vandq_u8(isDigit, vaddq_u8(digit, vdupq_n_u8(52))));
+    v = vorrq_u8(v, vandq_u8(isPlus, vdupq_n_u8(62)));
+    return vorrq_u8(v, vandq_u8(isSlash, vdupq_n_u8(63)));
+}
+
+// Decodes blocks of 64 characters of the alphabet, returns how many
+// characters it decoded
+size_t
+decodeB64Neon(char const* in, size_t n, uint8_t* out)
+{
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64)
+    {
+        // De-interleaves the 4 characters of each group
+        uint8x16x4_t c = vld4q_u8(reinterpret_cast<uint8_t const*>(in + i));
+        uint8x16_t valid = vdupq_n_u8(0xff);
+        uint8x16_t a = b64ValuesNeon(c.val[0], valid);
+        uint8x16_t b = b64ValuesNeon(c.val[1], valid);
+        uint8x16_t d2 = b64ValuesNeon(c.val[2], valid);
+        uint8x16_t d3 = b64ValuesNeon(c.val[3], valid);
+        if (vminvq_u8(valid) != 0xff)
+        {
+            break;
+        }
+        uint8x16x3_t bytes;
+        bytes.val[0] = vorrq_u8(vshlq_n_u8(a, 2), vshrq_n_u8(b, 4));
+        bytes.val[1] = vorrq_u8(vshlq_n_u8(b, 4), vshrq_n_u8(d2, 2));
+        bytes.val[2] = vorrq_u8(vshlq_n_u8(d2, 6), d3);
+        vst3q_u8(out + i / 4 * 3, bytes);
+    }
+    return i;
+}
+#endif
+}
+
+void
+encodeB64Into(uint8_t const* in, size_t n, char* out)
+{
+    size_t done = 0;
+#if defined(STELLAR_B64_SSSE3)
+    if (haveSSSE3())
+    {
+        done = encodeB64SSSE3(in, n, out);
+    }
+#elif defined(STELLAR_B64_NEON)
+    done = encodeB64Neon(in, n, out);
+#endif
+    encodeB64Scalar(in + done, n - done, out + done / 3 * 4);
+}
+
+size_t
+decodeB64Groups(char const* in, size_t n, uint8_t* out)
+{
+    size_t done = 0;
+#if defined(STELLAR_B64_SSSE3)
+    if (haveSSSE3())
+    {
+        done = decodeB64SSSE3(in, n, out);
+    }
+#elif defined(STELLAR_B64_NEON)
+    done = decodeB64Neon(in, n, out);
+#endif
+    return done +
+           decodeB64Scalar(in + done, n - done, out + done / 4 * 3);
+}
+}
+}
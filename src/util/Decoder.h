@@ -4,6 +4,7 @@
 // under the Apache License, Version 2.0. See the COPYING file at the root
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
+#include <cstdint>
 #include <iterator>
 #include <lib/util/basen.h>
 #include <string>
@@ -24,6 +25,14 @@ inline size_t constexpr encoded_size64(size_t rawsize)
     return ((rawsize + 2) / 3 * 4);
 }
 
+// Writes the encoded_size64(n) characters of the padded base64 of `in`
+void encodeB64Into(uint8_t const* in, size_t n, char* out);
+
+// Decodes the longest prefix of `in` made of groups of 4 characters of the
+// base64 alphabet, returns its length. `out` must have room for 3 bytes per
+// 4 characters of `in`.
+size_t decodeB64Groups(char const* in, size_t n, uint8_t* out);
+
 template <class T>
 inline std::string
 encode_b32(T const& v)
@@ -39,8 +48,18 @@ inline std::string
 encode_b64(T const& v)
 {
     std::string res;
-    res.reserve(encoded_size64(v.size() * sizeof(typename T::value_type)) + 1);
-    bn::encode_b64(v.begin(), v.end(), std::back_inserter(res));
+    if constexpr (sizeof(typename T::value_type) == 1)
+    {
+        res.resize(encoded_size64(v.size()));
+        encodeB64Into(reinterpret_cast<uint8_t const*>(v.data()), v.size(),
+                      res.data());
+    }
+    else
+    {
+        res.reserve(
+            encoded_size64(v.size() * sizeof(typename T::value_type)) + 1);
+        bn::encode_b64(v.begin(), v.end(), std::back_inserter(res));
+    }
     return res;
 }
 
@@ -53,13 +72,29 @@ decode_b32(V const& v, T& out)
     bn::decode_b32(v.begin(), v.end(), std::back_inserter(out));
 }
 
+// Like bn::decode_b64, skips whitespace and characters outside the alphabet
 template <class V, class T>
 inline void
 decode_b64(V const& v, T& out)
 {
     out.clear();
-    out.reserve(v.size() * sizeof(typename T::value_type));
-    bn::decode_b64(v.begin(), v.end(), std::back_inserter(out));
+    if constexpr (sizeof(typename V::value_type) == 1 &&
+                  sizeof(typename T::value_type) == 1)
+    {
+        // Padding, whitespace or anything else ends the groups, the rest
+        // goes through the generic decoder
+        out.resize(v.size() / 4 * 3);
+        auto done =
+            decodeB64Groups(reinterpret_cast<char const*>(v.data()), v.size(),
+                            reinterpret_cast<uint8_t*>(out.data()));
+        out.resize(done / 4 * 3);
+        bn::decode_b64(v.begin() + done, v.end(), std::back_inserter(out));
+    }
+    else
+    {
+        out.reserve(v.size() * sizeof(typename T::value_type));
+        bn::decode_b64(v.begin(), v.end(), std::back_inserter(out));
+    }
 }
 
 template <class Iter1, class Iter2>
@@ -0,0 +1,101 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/FrequencySketch.h"
+#include <algorithm>
+
+namespace stellar
+{
+
+namespace
+{
+size_t
+roundUpToPowerOfTwo(size_t n)
+{
+    size_t res = 1;
+    while (res < n)
+    {
+        res <<= 1;
+    }
+    return res;
+}
+
+// Derives an independent row index from the item hash. Callers typically pass
+// std::hash values, which are not guaranteed to be well mixed, so each row
+// applies a different seed followed by a 64-bit finalizer.
+uint64_t
+rowHash(uint64_t hash, size_t row)
+{
+    static constexpr uint64_t SEEDS[] = {
+        0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL, 0x9ae16a3b2f90404fULL,
+        0xcbf29ce484222325ULL};
+    uint64_t h = hash + SEEDS[row];
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+}
+
+FrequencySketch::FrequencySketch(size_t capacity)
+    : mWidthMask(roundUpToPowerOfTwo(4 * std::max<size_t>(capacity, 16)) - 1)
+    , mSampleSize(10 * static_cast<uint64_t>(std::max<size_t>(capacity, 1)))
+    , mCounters(new std::atomic<uint8_t>[ROWS * (mWidthMask + 1)]())
+{
+}
+
+std::atomic<uint8_t>&
+FrequencySketch::counter(size_t row, uint64_t hash) const
+{
+    auto col = rowHash(hash, row) & mWidthMask;
+    return mCounters[row * (mWidthMask + 1) + col];
+}
+
+void
+FrequencySketch::increment(uint64_t hash)
+{
+    for (size_t row = 0; row < ROWS; ++row)
+    {
+        auto& c = counter(row, hash);
+        auto v = c.load(std::memory_order_relaxed);
+        while (v < MAX_COUNT &&
+               !c.compare_exchange_weak(v, static_cast<uint8_t>(v + 1),
+                                       std::memory_order_relaxed))
+        {
+        }
+    }
+
+    // Only the thread that hits the sample size ages the sketch
+    if (mAdditions.fetch_add(1, std::memory_order_relaxed) + 1 == mSampleSize)
+    {
+        age();
+    }
+}
+
+uint8_t
+FrequencySketch::frequency(uint64_t hash) const
+{
+    uint8_t res = MAX_COUNT;
+    for (size_t row = 0; row < ROWS; ++row)
+    {
+        res = std::min(res, counter(row, hash).load(std::memory_order_relaxed));
+    }
+    return res;
+}
+
+void
+FrequencySketch::age()
+{
+    auto const size = ROWS * (mWidthMask + 1);
+    for (size_t i = 0; i < size; ++i)
+    {
+        auto v = mCounters[i].load(std::memory_order_relaxed);
+        mCounters[i].store(static_cast<uint8_t>(v >> 1),
+                           std::memory_order_relaxed);
+    }
+    mAdditions.store(mSampleSize / 2, std::memory_order_relaxed);
+}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/NonCopyable.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace stellar
+{
+
+// Approximate access frequency counter used as a TinyLFU cache admission
+// filter. This is a count-min sketch with 4 rows of saturating 4-bit counters
+// (stored one per byte), with 4 counters per row for each item the cache can
+// hold to keep collisions rare. Once the number of recorded accesses reaches
+// 10x the expected number of cached items, all counters are halved so that the
+// sketch tracks recent popularity rather than all-time popularity.
+//
+// The sketch is thread safe. Counters are updated with relaxed atomics, so a
+// concurrent increment may occasionally be lost, which only makes estimates
+// slightly less accurate.
+class FrequencySketch : public NonMovableOrCopyable
+{
+    static constexpr size_t ROWS = 4;
+    static constexpr uint8_t MAX_COUNT = 15;
+
+    size_t const mWidthMask;
+    uint64_t const mSampleSize;
+    std::unique_ptr<std::atomic<uint8_t>[]> mCounters;
+    std::atomic<uint64_t> mAdditions{0};
+
+    std::atomic<uint8_t>& counter(size_t row, uint64_t hash) const;
+    void age();
+
+  public:
+    // capacity is the maximum number of items held by the cache this sketch
+    // filters for.
+    explicit FrequencySketch(size_t capacity);
+
+    // Records an access to the item with the given hash
+    void increment(uint64_t hash);
+
+    // Returns the estimated access count of the item with the given hash,
+    // between 0 and 15.
+    uint8_t frequency(uint64_t hash) const;
+};
+}
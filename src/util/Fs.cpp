@@ -8,6 +8,7 @@
 #include "util/GlobalChecks.h"
 #include "util/Logging.h"
 #include <Tracy.hpp>
+#include <algorithm>
 #include <cstdint>
 #include <filesystem>
 #include <fmt/format.h>
@@ -105,6 +106,25 @@ flushFileChanges(native_handle_t fh)
     }
 }
 
+native_handle_t
+duplicateHandle(native_handle_t h)
+{
+    HANDLE dup;
+    if (!::DuplicateHandle(::GetCurrentProcess(), h, ::GetCurrentProcess(),
+                           &dup, 0, FALSE, DUPLICATE_SAME_ACCESS))
+    {
+        FileSystemException::failWithGetLastError(
+            "fs::duplicateHandle() failed on DuplicateHandle(): ");
+    }
+    return dup;
+}
+
+void
+closeHandle(native_handle_t h)
+{
+    ::CloseHandle(h);
+}
+
 native_handle_t
 openFileToWrite(std::string const& path)
 {
@@ -148,6 +168,17 @@ fdOpen(native_handle_t h)
     return res;
 }
 
+void
+adviseWillNeed(std::string const& path,
+               std::vector<std::pair<size_t, size_t>> const& ranges)
+{
+}
+
+void
+adviseDontNeed(std::string const& path)
+{
+}
+
 bool
 durableRename(std::string const& src, std::string const& dst,
               std::string const& dir)
@@ -235,6 +266,24 @@ flushFileChanges(native_handle_t fd)
     }
 }
 
+native_handle_t
+duplicateHandle(native_handle_t fd)
+{
+    int dup = ::dup(fd);
+    if (dup == -1)
+    {
+        FileSystemException::failWithErrno(
+            "fs::duplicateHandle() failed on dup(): ");
+    }
+    return dup;
+}
+
+void
+closeHandle(native_handle_t fd)
+{
+    ::close(fd);
+}
+
 native_handle_t
 openFileToWrite(std::string const& path)
 {
@@ -253,17 +302,51 @@ openFileToWrite(std::string const& path)
     return fd;
 }
 
-bool
-durableRename(std::string const& src, std::string const& dst,
-              std::string const& dir)
+void
+adviseWillNeed(std::string const& path,
+               std::vector<std::pair<size_t, size_t>> const& ranges)
 {
     ZoneScoped;
-    std::error_code ec;
-    std::filesystem::rename(src.c_str(), dst.c_str(), ec);
-    if (ec)
+#ifdef POSIX_FADV_WILLNEED
+    int fd;
+    while ((fd = ::open(path.c_str(), O_RDONLY)) == -1)
     {
-        return false;
+        if (errno != EINTR)
+        {
+            return;
+        }
+    }
+    for (auto const& [offset, len] : ranges)
+    {
+        // posix_fadvise only initiates readahead, it does not wait for it
+        posix_fadvise(fd, static_cast<off_t>(offset), static_cast<off_t>(len),
+                      POSIX_FADV_WILLNEED);
     }
+    ::close(fd);
+#endif
+}
+
+void
+adviseDontNeed(std::string const& path)
+{
+    ZoneScoped;
+#ifdef POSIX_FADV_DONTNEED
+    int fd;
+    while ((fd = ::open(path.c_str(), O_RDONLY)) == -1)
+    {
+        if (errno != EINTR)
+        {
+            return;
+        }
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+#endif
+}
+
+static void
+syncDirectory(std::string const& dir)
+{
     int dfd;
     while ((dfd = open(dir.c_str(), O_RDONLY)) == -1)
     {
@@ -292,10 +375,106 @@ durableRename(std::string const& src, std::string const& dst,
         FileSystemException::failWithErrno(
             std::string("Failed to close directory ") + dir + " :");
     }
+}
+
+bool
+durableRename(std::string const& src, std::string const& dst,
+              std::string const& dir)
+{
+    ZoneScoped;
+    std::error_code ec;
+    std::filesystem::rename(src.c_str(), dst.c_str(), ec);
+    if (ec)
+    {
+        return false;
+    }
+    syncDirectory(dir);
     return true;
 }
 #endif
 
+DurabilityGroup::DurabilityGroup(bool enabled) : mEnabled(enabled)
+{
+}
+
+DurabilityGroup::~DurabilityGroup()
+{
+    for (auto h : mFiles)
+    {
+        closeHandle(h);
+    }
+}
+
+void
+DurabilityGroup::addFile(native_handle_t h)
+{
+    if (mEnabled)
+    {
+        mFiles.emplace_back(duplicateHandle(h));
+    }
+}
+
+void
+DurabilityGroup::syncFiles()
+{
+    ZoneScoped;
+#ifdef SYNC_FILE_RANGE_WRITE
+    // Start writeback of every file before waiting on any of them, so that
+    // the device gets all the writes queued at once
+    for (auto h : mFiles)
+    {
+        sync_file_range(h, 0, 0, SYNC_FILE_RANGE_WRITE);
+    }
+#endif
+    while (!mFiles.empty())
+    {
+        flushFileChanges(mFiles.back());
+        closeHandle(mFiles.back());
+        mFiles.pop_back();
+    }
+}
+
+bool
+DurabilityGroup::rename(std::string const& src, std::string const& dst,
+                        std::string const& dir)
+{
+    ZoneScoped;
+    // A durable rename must never expose a file whose content isn't durable
+    syncFiles();
+#ifdef _WIN32
+    // Renames are written through, there is no directory to sync later
+    if (mEnabled)
+    {
+        return durableRename(src, dst, dir);
+    }
+#endif
+    std::error_code ec;
+    std::filesystem::rename(src, dst, ec);
+    if (ec)
+    {
+        return false;
+    }
+    if (mEnabled && std::find(mDirs.begin(), mDirs.end(), dir) == mDirs.end())
+    {
+        mDirs.emplace_back(dir);
+    }
+    return true;
+}
+
+void
+DurabilityGroup::commit()
+{
+    ZoneScoped;
+    syncFiles();
+#ifndef _WIN32
+    for (auto const& dir : mDirs)
+    {
+        syncDirectory(dir);
+    }
+#endif
+    mDirs.clear();
+}
+
 namespace stdfs = std::filesystem;
 
 bool
@@ -409,6 +588,26 @@ checkNoGzipSuffix(std::string const& filename)
     }
 }
 
+void
+checkZstdSuffix(std::string const& filename)
+{
+    static const std::string suf(".zst");
+    if (std::filesystem::path(filename).extension().string() != suf)
+    {
+        throw std::runtime_error("filename does not end in .zst");
+    }
+}
+
+void
+checkNoZstdSuffix(std::string const& filename)
+{
+    static const std::string suf(".zst");
+    if (std::filesystem::path(filename).extension().string() == suf)
+    {
+        throw std::runtime_error("filename ends in .zst");
+    }
+}
+
 size_t
 size(std::ifstream& ifs)
 {
@@ -4,6 +4,7 @@
 // under the Apache License, Version 2.0. See the COPYING file at the root
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
+#include "util/NonCopyable.h"
 #include "util/asio.h"
 
 #include <filesystem>
@@ -47,18 +48,76 @@ void unlockFile(std::string const& path);
 // Call fsync() on POSIX or FlushFileBuffers() on Win32.
 void flushFileChanges(native_handle_t h);
 
+// Duplicate a native handle, so that the file stays open through the copy
+// after `h` is closed. The copy must be released with closeHandle.
+native_handle_t duplicateHandle(native_handle_t h);
+
+// Close a native handle obtained from duplicateHandle.
+void closeHandle(native_handle_t h);
+
 // Open a native handle (fd or HANDLE) for writing.
 native_handle_t openFileToWrite(std::string const& path);
 
 // creates a FILE* based off h - caller is responsible for closing it
 FILE* fdOpen(native_handle_t h);
 
+// Hint to the OS that the given (offset, length) byte ranges of the file at
+// path will be read soon, so that all of them can be queued to the device at
+// once. This is best-effort: errors are ignored. No-op on Win32.
+void adviseWillNeed(std::string const& path,
+                    std::vector<std::pair<size_t, size_t>> const& ranges);
+
+// Hint to the OS that the cached pages of the file at path won't be needed
+// anymore, dropping the clean ones from the page cache. Used to measure reads
+// against a cold cache. This is best-effort: errors are ignored. No-op on
+// Win32.
+void adviseDontNeed(std::string const& path);
+
 // On POSIX, do rename(src, dst) then open dir and fsync() it
 // too: a necessary second step for ensuring durability.
 // On Win32, do MoveFileExA with MOVEFILE_WRITE_THROUGH.
 bool durableRename(std::string const& src, std::string const& dst,
                    std::string const& dir);
 
+// Makes a group of file writes and renames durable together rather than one
+// at a time: the files' writeback is started all at once before waiting on
+// any of them, and each directory files were renamed into is fsynced once,
+// when the group is committed. Renames take effect immediately but are only
+// durable once the group is committed. Files added to the group are synced
+// before any rename, so that a durable rename never exposes a file whose
+// content isn't durable.
+//
+// A disabled group (for DISABLE_XDR_FSYNC) syncs nothing and renames files
+// with a plain rename.
+class DurabilityGroup : public NonMovableOrCopyable
+{
+    bool const mEnabled;
+    std::vector<native_handle_t> mFiles;
+    std::vector<std::string> mDirs;
+
+  public:
+    explicit DurabilityGroup(bool enabled = true);
+    // Files that are still pending are closed without syncing them
+    ~DurabilityGroup();
+
+    // Syncs a duplicate of h, so h may be closed before the group is
+    // committed
+    void addFile(native_handle_t h);
+
+    // Syncs the pending files now, for example to keep them out of a
+    // critical section that renames them
+    void syncFiles();
+
+    // Renames src to dst, where dir is the directory of dst. Returns false if
+    // the rename failed, like durableRename.
+    bool rename(std::string const& src, std::string const& dst,
+                std::string const& dir);
+
+    // Syncs the pending files, then the directories of the renames since the
+    // last commit
+    void commit();
+};
+
 // Return whether a path exists.
 bool exists(std::string const& path);
 
@@ -108,6 +167,10 @@ void checkGzipSuffix(std::string const& filename);
 
 void checkNoGzipSuffix(std::string const& filename);
 
+void checkZstdSuffix(std::string const& filename);
+
+void checkNoZstdSuffix(std::string const& filename);
+
 // returns the maximum number of connections that can be done at the same time
 int64_t getMaxHandles();
 
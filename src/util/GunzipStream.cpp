@@ -0,0 +1,94 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#ifdef USE_ZLIB
+
+#include "util/GunzipStream.h"
+#include <Tracy.hpp>
+#include <fmt/format.h>
+#include <stdexcept>
+#include <zlib.h>
+
+namespace stellar
+{
+
+static constexpr size_t GUNZIP_BUFFER_SIZE = 256 * 1024;
+// Window bits for gzip-only decoding with the largest window
+static constexpr int GZIP_WINDOW_BITS = 15 + 16;
+
+GunzipStream::GunzipStream(Output output)
+    : mOutput(std::move(output))
+    , mStream(std::make_unique<z_stream_s>())
+    , mBuffer(GUNZIP_BUFFER_SIZE)
+{
+    if (inflateInit2(mStream.get(), GZIP_WINDOW_BITS) != Z_OK)
+    {
+        throw std::runtime_error("failed to initialize zlib");
+    }
+}
+
+GunzipStream::~GunzipStream()
+{
+    inflateEnd(mStream.get());
+}
+
+void
+GunzipStream::add(char const* data, size_t size)
+{
+    ZoneScoped;
+    auto& strm = *mStream;
+    // zlib never writes through next_in
+    strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    strm.avail_in = static_cast<uInt>(size);
+    bool more = size > 0;
+    while (more)
+    {
+        if (strm.avail_in > 0)
+        {
+            mInMember = true;
+        }
+        strm.next_out = reinterpret_cast<Bytef*>(mBuffer.data());
+        strm.avail_out = static_cast<uInt>(mBuffer.size());
+        int res = inflate(&strm, Z_NO_FLUSH);
+        // Z_BUF_ERROR only means no progress was possible without more input
+        if (res != Z_OK && res != Z_STREAM_END && res != Z_BUF_ERROR)
+        {
+            throw std::runtime_error(fmt::format(
+                FMT_STRING("invalid gzip data: {}"),
+                strm.msg ? strm.msg : std::to_string(res)));
+        }
+
+        size_t produced = mBuffer.size() - strm.avail_out;
+        if (produced > 0)
+        {
+            mDecompressedSize += produced;
+            mOutput(mBuffer.data(), produced);
+        }
+
+        if (res == Z_STREAM_END)
+        {
+            // Another member may follow
+            mInMember = false;
+            inflateReset(&strm);
+            more = strm.avail_in > 0;
+        }
+        else
+        {
+            // A full output buffer may mean zlib holds more pending output
+            more = strm.avail_in > 0 || strm.avail_out == 0;
+        }
+    }
+}
+
+void
+GunzipStream::finish()
+{
+    if (mInMember)
+    {
+        throw std::runtime_error("truncated gzip data");
+    }
+}
+}
+
+#endif
@@ -0,0 +1,53 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#ifdef USE_ZLIB
+
+#include "util/NonCopyable.h"
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+struct z_stream_s;
+
+namespace stellar
+{
+
+// Incrementally decompresses gzip data (possibly several concatenated gzip
+// members, as `gzip -d` accepts), handing each block of decompressed output
+// to a callback as soon as it is available.
+class GunzipStream : private NonMovableOrCopyable
+{
+  public:
+    using Output = std::function<void(char const* data, size_t size)>;
+
+    explicit GunzipStream(Output output);
+    ~GunzipStream();
+
+    // Throws std::runtime_error if the input is not valid gzip data, or
+    // whatever `output` throws
+    void add(char const* data, size_t size);
+
+    // Throws std::runtime_error if the input ended in the middle of a member
+    void finish();
+
+    size_t
+    getDecompressedSize() const
+    {
+        return mDecompressedSize;
+    }
+
+  private:
+    Output mOutput;
+    std::unique_ptr<z_stream_s> mStream;
+    std::vector<char> mBuffer;
+    bool mInMember{false};
+    size_t mDecompressedSize{0};
+};
+}
+
+#endif
@@ -0,0 +1,352 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/HdrHistogram.h"
+#include "lib/json/json.h"
+#include "util/GlobalChecks.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace stellar
+{
+
+namespace
+{
+std::atomic<size_t> gNextStripe{0};
+thread_local size_t const gStripe =
+    gNextStripe.fetch_add(1, std::memory_order_relaxed) %
+    HdrHistogram::STRIPE_COUNT;
+
+uint32_t
+mostSignificantBit(uint64_t value)
+{
+    uint32_t res = 0;
+    while (value >>= 1)
+    {
+        ++res;
+    }
+    return res;
+}
+}
+
+HdrHistogram::Stripe::Stripe()
+{
+    clear();
+}
+
+void
+HdrHistogram::Stripe::clear()
+{
+    for (auto& c : mCounts)
+    {
+        c.store(0, std::memory_order_relaxed);
+    }
+    mCount.store(0, std::memory_order_relaxed);
+    mSum.store(0, std::memory_order_relaxed);
+    mMin.store(std::numeric_limits<uint64_t>::max(),
+               std::memory_order_relaxed);
+    mMax.store(0, std::memory_order_relaxed);
+}
+
+HdrHistogram::HdrHistogram()
+{
+    for (auto& s : mStripes)
+    {
+        s.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+HdrHistogram::~HdrHistogram()
+{
+    for (auto& s : mStripes)
+    {
+        delete s.load(std::memory_order_relaxed);
+    }
+}
+
+size_t
+HdrHistogram::getBucketIndex(uint64_t value)
+{
+    size_t constexpr halfCount = SUB_BUCKET_COUNT / 2;
+    value = std::min(value, MAX_VALUE);
+    if (value < SUB_BUCKET_COUNT)
+    {
+        return static_cast<size_t>(value);
+    }
+    // Keep the top SUB_BUCKET_BITS - 1 bits below the most significant one
+    auto shift = mostSignificantBit(value) - (SUB_BUCKET_BITS - 1);
+    auto top = static_cast<size_t>(value >> shift);
+    return SUB_BUCKET_COUNT + (shift - 1) * halfCount + (top - halfCount);
+}
+
+uint64_t
+HdrHistogram::getBucketUpperBound(size_t index)
+{
+    size_t constexpr halfCount = SUB_BUCKET_COUNT / 2;
+    releaseAssert(index < BUCKET_COUNT);
+    if (index < SUB_BUCKET_COUNT)
+    {
+        return index;
+    }
+    auto j = index - SUB_BUCKET_COUNT;
+    auto shift = j / halfCount + 1;
+    uint64_t top = j % halfCount + halfCount;
+    return ((top + 1) << shift) - 1;
+}
+
+HdrHistogram::Stripe&
+HdrHistogram::getStripe()
+{
+    auto& slot = mStripes[gStripe];
+    auto stripe = slot.load(std::memory_order_acquire);
+    if (stripe == nullptr)
+    {
+        auto fresh = std::make_unique<Stripe>();
+        if (slot.compare_exchange_strong(stripe, fresh.get(),
+                                         std::memory_order_acq_rel))
+        {
+            stripe = fresh.release();
+        }
+    }
+    return *stripe;
+}
+
+void
+HdrHistogram::record(uint64_t value)
+{
+    auto& stripe = getStripe();
+    stripe.mCounts[getBucketIndex(value)].fetch_add(
+        1, std::memory_order_relaxed);
+    stripe.mCount.fetch_add(1, std::memory_order_relaxed);
+    stripe.mSum.fetch_add(value, std::memory_order_relaxed);
+
+    auto min = stripe.mMin.load(std::memory_order_relaxed);
+    while (value < min && !stripe.mMin.compare_exchange_weak(
+                              min, value, std::memory_order_relaxed))
+    {
+    }
+    auto max = stripe.mMax.load(std::memory_order_relaxed);
+    while (value > max && !stripe.mMax.compare_exchange_weak(
+                              max, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+HdrHistogram::Snapshot
+HdrHistogram::getSnapshot() const
+{
+    Snapshot res;
+    res.mCounts.resize(BUCKET_COUNT, 0);
+    auto min = std::numeric_limits<uint64_t>::max();
+    for (auto const& s : mStripes)
+    {
+        auto stripe = s.load(std::memory_order_acquire);
+        if (stripe == nullptr)
+        {
+            continue;
+        }
+        for (size_t i = 0; i < BUCKET_COUNT; ++i)
+        {
+            res.mCounts[i] +=
+                stripe->mCounts[i].load(std::memory_order_relaxed);
+        }
+        res.mSum += stripe->mSum.load(std::memory_order_relaxed);
+        min = std::min(min, stripe->mMin.load(std::memory_order_relaxed));
+        res.mMax =
+            std::max(res.mMax, stripe->mMax.load(std::memory_order_relaxed));
+    }
+    // Count from the buckets rather than the stripes' counters, so that
+    // quantiles are consistent with the count when values are recorded
+    // concurrently
+    for (auto c : res.mCounts)
+    {
+        res.mCount += c;
+    }
+    res.mMin = res.mCount == 0 ? 0 : std::min(min, res.mMax);
+    return res;
+}
+
+void
+HdrHistogram::clear()
+{
+    for (auto const& s : mStripes)
+    {
+        auto stripe = s.load(std::memory_order_acquire);
+        if (stripe != nullptr)
+        {
+            stripe->clear();
+        }
+    }
+}
+
+double
+HdrHistogram::Snapshot::mean() const
+{
+    return mCount == 0 ? 0.0 : static_cast<double>(mSum) / mCount;
+}
+
+double
+HdrHistogram::Snapshot::stdDev() const
+{
+    if (mCount < 2)
+    {
+        return 0.0;
+    }
+    // Estimated from the middle of the buckets, the sum of squares of
+    // nanosecond durations would overflow
+    auto m = mean();
+    double sq = 0.0;
+    uint64_t lower = 0;
+    for (size_t i = 0; i < mCounts.size(); ++i)
+    {
+        auto upper = getBucketUpperBound(i);
+        if (mCounts[i] != 0)
+        {
+            auto d = (static_cast<double>(lower) + upper) / 2 - m;
+            sq += d * d * mCounts[i];
+        }
+        lower = upper + 1;
+    }
+    return std::sqrt(sq / (mCount - 1));
+}
+
+uint64_t
+HdrHistogram::Snapshot::getValueAtQuantile(double q) const
+{
+    if (mCount == 0)
+    {
+        return 0;
+    }
+    q = std::clamp(q, 0.0, 1.0);
+    auto target = std::max<uint64_t>(
+        1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(mCount))));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < mCounts.size(); ++i)
+    {
+        seen += mCounts[i];
+        if (seen >= target)
+        {
+            return std::clamp(getBucketUpperBound(i), mMin, mMax);
+        }
+    }
+    return mMax;
+}
+
+HdrTimerContext::HdrTimerContext(HdrTimer& timer)
+    : mTimer(&timer), mStart(std::chrono::steady_clock::now())
+{
+}
+
+HdrTimerContext::HdrTimerContext(HdrTimerContext&& other)
+    : mTimer(other.mTimer), mStart(other.mStart)
+{
+    other.mTimer = nullptr;
+}
+
+HdrTimerContext::~HdrTimerContext()
+{
+    Stop();
+}
+
+void
+HdrTimerContext::Stop()
+{
+    if (mTimer != nullptr)
+    {
+        mTimer->Update(std::chrono::steady_clock::now() - mStart);
+        mTimer = nullptr;
+    }
+}
+
+void
+HdrTimer::Update(std::chrono::nanoseconds duration)
+{
+    mHistogram.record(
+        static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0)));
+}
+
+HdrTimerContext
+HdrTimer::TimeScope()
+{
+    return HdrTimerContext(*this);
+}
+
+uint64_t
+HdrTimer::count() const
+{
+    return mHistogram.getSnapshot().count();
+}
+
+HdrHistogram::Snapshot
+HdrTimer::GetSnapshot() const
+{
+    return mHistogram.getSnapshot();
+}
+
+void
+HdrTimer::Clear()
+{
+    mHistogram.clear();
+}
+
+void
+HdrTimer::toJson(Json::Value& res) const
+{
+    auto snap = mHistogram.getSnapshot();
+    auto ms = [](double ns) { return ns / 1000000.0; };
+    auto quantile = [&](double q) {
+        return ms(static_cast<double>(snap.getValueAtQuantile(q)));
+    };
+    res["type"] = "hdr-timer";
+    res["count"] = static_cast<Json::UInt64>(snap.count());
+    res["duration_unit"] = "ms";
+    res["min"] = ms(static_cast<double>(snap.min()));
+    res["max"] = ms(static_cast<double>(snap.max()));
+    res["mean"] = ms(snap.mean());
+    res["stddev"] = ms(snap.stdDev());
+    res["sum"] = ms(static_cast<double>(snap.sum()));
+    res["median"] = quantile(0.5);
+    res["75%"] = quantile(0.75);
+    res["95%"] = quantile(0.95);
+    res["98%"] = quantile(0.98);
+    res["99%"] = quantile(0.99);
+    res["99.9%"] = quantile(0.999);
+    res["99.99%"] = quantile(0.9999);
+    res["100%"] = ms(static_cast<double>(snap.max()));
+}
+
+HdrTimer&
+HdrMetricsRegistry::NewTimer(medida::MetricName const& name)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto& timer = mTimers[name];
+    if (!timer)
+    {
+        timer = std::make_shared<HdrTimer>();
+    }
+    return *timer;
+}
+
+std::map<medida::MetricName, std::shared_ptr<HdrTimer>>
+HdrMetricsRegistry::GetAllTimers() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mTimers;
+}
+
+void
+HdrMetricsRegistry::clear(std::string const& domain)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (auto const& kv : mTimers)
+    {
+        if (domain.empty() || kv.first.domain() == domain)
+        {
+            kv.second->Clear();
+        }
+    }
+}
+}
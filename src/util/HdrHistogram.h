@@ -0,0 +1,172 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "medida/metric_name.h"
+#include "util/NonCopyable.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Json
+{
+class Value;
+}
+
+namespace stellar
+{
+
+// High dynamic range histogram of non-negative integer values. Values are
+// counted in log-linear buckets: exactly below 2^SUB_BUCKET_BITS and with a
+// relative bucket width of 2^(1-SUB_BUCKET_BITS) above, so quantiles are
+// accurate to about 1.5% over the whole range instead of depending on what a
+// sampling reservoir happened to keep. Values above MAX_VALUE are counted as
+// MAX_VALUE.
+//
+// Recording is lock-free: every thread records into its own stripe of
+// counters, allocated the first time the thread records, and the stripes are
+// only merged when a snapshot is taken.
+class HdrHistogram : public NonMovableOrCopyable
+{
+  public:
+    static constexpr uint32_t SUB_BUCKET_BITS = 7;
+    static constexpr uint32_t MAX_VALUE_BITS = 42;
+    static constexpr uint64_t MAX_VALUE = (uint64_t(1) << MAX_VALUE_BITS) - 1;
+    static constexpr size_t SUB_BUCKET_COUNT = size_t(1) << SUB_BUCKET_BITS;
+    static constexpr size_t BUCKET_COUNT =
+        SUB_BUCKET_COUNT +
+        (MAX_VALUE_BITS - SUB_BUCKET_BITS) * (SUB_BUCKET_COUNT / 2);
+    // Threads are spread over the stripes round-robin, threads sharing a
+    // stripe still record without locking
+    static constexpr size_t STRIPE_COUNT = 8;
+
+    // Merged state of all the stripes at the time it was taken
+    class Snapshot
+    {
+        std::vector<uint64_t> mCounts;
+        uint64_t mCount{0};
+        uint64_t mSum{0};
+        uint64_t mMin{0};
+        uint64_t mMax{0};
+
+        friend class HdrHistogram;
+
+      public:
+        uint64_t
+        count() const
+        {
+            return mCount;
+        }
+        uint64_t
+        sum() const
+        {
+            return mSum;
+        }
+        uint64_t
+        min() const
+        {
+            return mMin;
+        }
+        uint64_t
+        max() const
+        {
+            return mMax;
+        }
+        double mean() const;
+        double stdDev() const;
+
+        // Smallest recorded value such that at least a fraction q of the
+        // values are lower or equal, up to the bucket resolution
+        uint64_t getValueAtQuantile(double q) const;
+    };
+
+    HdrHistogram();
+    ~HdrHistogram();
+
+    void record(uint64_t value);
+    Snapshot getSnapshot() const;
+    // Not synchronized with concurrent recording, values recorded while
+    // clearing may be partially kept
+    void clear();
+
+    static size_t getBucketIndex(uint64_t value);
+    // Largest value counted in a bucket
+    static uint64_t getBucketUpperBound(size_t index);
+
+  private:
+    struct Stripe
+    {
+        std::array<std::atomic<uint64_t>, BUCKET_COUNT> mCounts;
+        std::atomic<uint64_t> mCount;
+        std::atomic<uint64_t> mSum;
+        std::atomic<uint64_t> mMin;
+        std::atomic<uint64_t> mMax;
+
+        Stripe();
+        void clear();
+    };
+
+    std::array<std::atomic<Stripe*>, STRIPE_COUNT> mStripes;
+
+    Stripe& getStripe();
+};
+
+// Times durations in nanoseconds in an HdrHistogram. Mirrors the parts of
+// medida::Timer's interface the hot paths use, so that it can replace it.
+class HdrTimer;
+
+class HdrTimerContext
+{
+    HdrTimer* mTimer;
+    std::chrono::steady_clock::time_point mStart;
+
+  public:
+    explicit HdrTimerContext(HdrTimer& timer);
+    HdrTimerContext(HdrTimerContext&& other);
+    HdrTimerContext(HdrTimerContext const&) = delete;
+    HdrTimerContext& operator=(HdrTimerContext const&) = delete;
+    HdrTimerContext& operator=(HdrTimerContext&&) = delete;
+    ~HdrTimerContext();
+
+    void Stop();
+};
+
+class HdrTimer : public NonMovableOrCopyable
+{
+    HdrHistogram mHistogram;
+
+  public:
+    void Update(std::chrono::nanoseconds duration);
+    HdrTimerContext TimeScope();
+    uint64_t count() const;
+    HdrHistogram::Snapshot GetSnapshot() const;
+    void Clear();
+
+    // Same fields as medida's JSON reporter produces for timers, in
+    // milliseconds, minus the rates
+    void toJson(Json::Value& res) const;
+};
+
+// Owns the HdrTimers of an application, the equivalent of
+// medida::MetricsRegistry. They are reported through the administrative HTTP
+// interface along with medida's metrics.
+class HdrMetricsRegistry : public NonMovableOrCopyable
+{
+    mutable std::mutex mMutex;
+    std::map<medida::MetricName, std::shared_ptr<HdrTimer>> mTimers;
+
+  public:
+    HdrTimer& NewTimer(medida::MetricName const& name);
+    std::map<medida::MetricName, std::shared_ptr<HdrTimer>>
+    GetAllTimers() const;
+    void clear(std::string const& domain);
+};
+}
@@ -0,0 +1,58 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/IORateLimiter.h"
+#include <Tracy.hpp>
+
+#include <algorithm>
+#include <thread>
+
+namespace stellar
+{
+
+IORateLimiter::IORateLimiter(size_t bytesPerSecond)
+    : mBytesPerSecond(static_cast<double>(bytesPerSecond))
+    , mAvailable(static_cast<double>(bytesPerSecond))
+    , mLastRefill(Clock::now())
+{
+}
+
+bool
+IORateLimiter::isLimited() const
+{
+    return mBytesPerSecond > 0;
+}
+
+void
+IORateLimiter::consume(size_t bytes)
+{
+    if (!isLimited() || bytes == 0)
+    {
+        return;
+    }
+
+    std::chrono::duration<double> wait{0};
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto now = Clock::now();
+        std::chrono::duration<double> elapsed = now - mLastRefill;
+        mLastRefill = now;
+        mAvailable = std::min(mBytesPerSecond,
+                              mAvailable + elapsed.count() * mBytesPerSecond);
+        // Readers that come later queue up behind the debt of earlier ones,
+        // so the budget is shared out in the order bytes were read
+        mAvailable -= static_cast<double>(bytes);
+        if (mAvailable < 0)
+        {
+            wait = std::chrono::duration<double>(-mAvailable / mBytesPerSecond);
+        }
+    }
+
+    if (wait.count() > 0)
+    {
+        ZoneScopedN("IORateLimiter wait");
+        std::this_thread::sleep_for(wait);
+    }
+}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/NonCopyable.h"
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+namespace stellar
+{
+
+// Token bucket shared by the threads reading through a common disk budget.
+// Readers report the bytes they read, and are put to sleep once the bytes
+// reported by all of them exceed the budget, until the budget catches up.
+// Up to a second's worth of unused budget accumulates, so short reads after
+// an idle period aren't delayed.
+//
+// A limiter of 0 bytes per second never delays anything. Thread safe.
+class IORateLimiter : public NonMovableOrCopyable
+{
+    using Clock = std::chrono::steady_clock;
+
+    double const mBytesPerSecond;
+    std::mutex mMutex;
+    // Unused budget, in bytes. Negative while readers are waiting to pay
+    // off reads they already made.
+    double mAvailable;
+    Clock::time_point mLastRefill;
+
+  public:
+    explicit IORateLimiter(size_t bytesPerSecond);
+
+    bool isLimited() const;
+
+    // Charges `bytes` to the budget, sleeping until they're covered by it
+    void consume(size_t bytes);
+};
+}
@@ -10,6 +10,7 @@
 #include <chrono>
 #include <fmt/chrono.h>
 #include <fstream>
+#include <spdlog/async.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/sinks/stdout_sinks.h>
@@ -36,6 +37,16 @@ bool Logging::mColor = false;
 std::string Logging::mLastPattern;
 std::string Logging::mLastFilenamePattern;
 bool Logging::mLogToConsole = true;
+size_t Logging::mAsyncQueueSize = 0;
+
+namespace
+{
+// Writes out the messages of asynchronous loggers; replaced, once everything
+// queued is written, whenever logging is reinitialized
+std::shared_ptr<spdlog::details::thread_pool> gAsyncPool;
+// Messages dropped by the pools that came before gAsyncPool
+uint64_t gAsyncDroppedBefore = 0;
+}
 #endif
 
 // Right now this is hard-coded to log messages at least as important as INFO
@@ -166,10 +177,25 @@ Logging::init(bool truncate)
                 make_shared<basic_file_sink_mt>(filename, /*truncate=*/false));
         }
 
+        if (mAsyncQueueSize > 0)
+        {
+            gAsyncPool = make_shared<spdlog::details::thread_pool>(
+                mAsyncQueueSize, 1);
+        }
         auto makeLogger =
             [&](std::string const& name) -> shared_ptr<spdlog::logger> {
-            auto logger =
-                make_shared<spdlog::logger>(name, sinks.begin(), sinks.end());
+            shared_ptr<spdlog::logger> logger;
+            if (gAsyncPool)
+            {
+                logger = make_shared<spdlog::async_logger>(
+                    name, sinks.begin(), sinks.end(), gAsyncPool,
+                    spdlog::async_overflow_policy::overrun_oldest);
+            }
+            else
+            {
+                logger = make_shared<spdlog::logger>(name, sinks.begin(),
+                                                     sinks.end());
+            }
             spdlog::register_logger(logger);
             return logger;
         };
@@ -210,6 +236,12 @@ Logging::deinit()
 #include "util/LogPartitions.def"
 #undef LOG_PARTITION
         spdlog::drop_all();
+        if (gAsyncPool)
+        {
+            // Destroying the pool waits for its queue to be written out
+            gAsyncDroppedBefore += gAsyncPool->overrun_counter();
+            gAsyncPool.reset();
+        }
         mInitialized = false;
     }
 #endif
@@ -277,6 +309,32 @@ Logging::setLoggingColor(bool color)
 #endif
 }
 
+void
+Logging::setAsync(size_t queueSize)
+{
+#if defined(USE_SPDLOG)
+    std::lock_guard<std::recursive_mutex> guard(mLogMutex);
+    if (queueSize != mAsyncQueueSize)
+    {
+        mAsyncQueueSize = queueSize;
+        deinit();
+        init();
+    }
+#endif
+}
+
+uint64_t
+Logging::getAsyncDroppedCount()
+{
+#if defined(USE_SPDLOG)
+    std::lock_guard<std::recursive_mutex> guard(mLogMutex);
+    return gAsyncDroppedBefore +
+           (gAsyncPool ? gAsyncPool->overrun_counter() : 0);
+#else
+    return 0;
+#endif
+}
+
 void
 Logging::setLogLevel(LogLevel level, const char* partition)
 {
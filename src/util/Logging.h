@@ -168,6 +168,7 @@ class Logging
     static std::string mLastPattern;
     static std::string mLastFilenamePattern;
     static bool mLogToConsole;
+    static size_t mAsyncQueueSize;
 #define LOG_PARTITION(name) static LogPtr name##LogPtr;
 #include "util/LogPartitions.def"
 #undef LOG_PARTITION
@@ -180,6 +181,12 @@ class Logging
     static void setLoggingToFile(std::string const& filename);
     static void setLoggingToConsole(bool console);
     static void setLoggingColor(bool color);
+    // With a nonzero queue size, logging threads only format messages and
+    // queue them for a dedicated thread to write out. When the queue is full
+    // the oldest message is dropped rather than blocking the logging thread.
+    static void setAsync(size_t queueSize);
+    // Messages dropped by asynchronous logging since startup
+    static uint64_t getAsyncDroppedCount();
     static void setLogLevel(LogLevel level, const char* partition);
     static LogLevel getLLfromString(std::string const& levelName);
     static LogLevel getLogLevel(std::string const& partition);
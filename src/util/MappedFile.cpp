@@ -0,0 +1,90 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/MappedFile.h"
+#include "util/Logging.h"
+#include <Tracy.hpp>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace stellar
+{
+
+MappedFile::MappedFile(char const* data, size_t size)
+    : mData(data), mSize(size)
+{
+}
+
+#ifdef _WIN32
+
+MappedFile::~MappedFile()
+{
+}
+
+std::unique_ptr<MappedFile const>
+MappedFile::map(std::string const& path, bool sequential)
+{
+    return nullptr;
+}
+
+#else
+
+MappedFile::~MappedFile()
+{
+    if (mData)
+    {
+        ::munmap(const_cast<char*>(mData), mSize);
+    }
+}
+
+std::unique_ptr<MappedFile const>
+MappedFile::map(std::string const& path, bool sequential)
+{
+    ZoneScoped;
+    int fd;
+    while ((fd = ::open(path.c_str(), O_RDONLY)) == -1)
+    {
+        if (errno != EINTR)
+        {
+            CLOG_WARNING(Fs, "Failed to open {} for mapping: {}", path,
+                         strerror(errno));
+            return nullptr;
+        }
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        ::close(fd);
+        return nullptr;
+    }
+
+    auto size = static_cast<size_t>(st.st_size);
+    void* addr = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping holds its own reference to the file
+    ::close(fd);
+    if (addr == MAP_FAILED)
+    {
+        CLOG_WARNING(Fs, "Failed to map {}: {}", path, strerror(errno));
+        return nullptr;
+    }
+
+    // Point lookups touch a single page at a time, so readahead around each
+    // fault would mostly pull in data that is never read. Sequential readers
+    // on the other hand benefit from aggressive readahead.
+    ::madvise(addr, size, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+
+    return std::unique_ptr<MappedFile const>(
+        new MappedFile(static_cast<char const*>(addr), size));
+}
+
+#endif
+}
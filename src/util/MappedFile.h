@@ -0,0 +1,50 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/NonCopyable.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace stellar
+{
+
+// Read-only memory mapping of an entire file. Only meant for files that never
+// change while mapped (such as content-addressed bucket files), since the
+// mapping reflects any modification made to the underlying file.
+//
+// The mapping is thread safe to read from and is unmapped on destruction.
+class MappedFile : public NonMovableOrCopyable
+{
+    char const* mData{nullptr};
+    size_t mSize{0};
+
+    MappedFile(char const* data, size_t size);
+
+  public:
+    ~MappedFile();
+
+    // Maps the file at path. Returns nullptr if the file is empty or cannot be
+    // mapped (e.g. on platforms without mmap support), in which case callers
+    // should fall back to regular reads. By default the mapping is advised for
+    // random access; set sequential for files that are read once front to
+    // back.
+    static std::unique_ptr<MappedFile const> map(std::string const& path,
+                                                 bool sequential = false);
+
+    char const*
+    data() const
+    {
+        return mData;
+    }
+
+    size_t
+    size() const
+    {
+        return mSize;
+    }
+};
+}
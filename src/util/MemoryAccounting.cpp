@@ -0,0 +1,313 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/MemoryAccounting.h"
+#include "util/GlobalChecks.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+
+namespace stellar
+{
+
+namespace
+{
+size_t constexpr SUBSYSTEM_COUNT = static_cast<size_t>(MemorySubsystem::COUNT);
+
+// Own cache line per subsystem so that threads working in different
+// subsystems don't contend
+struct alignas(64) Counters
+{
+    std::atomic<int64_t> mLiveBytes{0};
+    std::atomic<int64_t> mLiveAllocations{0};
+    std::atomic<uint64_t> mTotalBytes{0};
+    std::atomic<uint64_t> mTotalAllocations{0};
+};
+
+Counters gCounters[SUBSYSTEM_COUNT];
+thread_local MemorySubsystem gCurrentSubsystem = MemorySubsystem::OTHER;
+}
+
+namespace memoryaccounting
+{
+bool
+isEnabled()
+{
+#ifdef USE_MEMORY_ACCOUNTING
+    return true;
+#else
+    return false;
+#endif
+}
+
+char const*
+getSubsystemName(MemorySubsystem subsystem)
+{
+    switch (subsystem)
+    {
+    case MemorySubsystem::OTHER:
+        return "other";
+    case MemorySubsystem::LEDGER_TXN:
+        return "ledger-txn";
+    case MemorySubsystem::SOROBAN_STATE:
+        return "soroban-state";
+    case MemorySubsystem::BUCKET_INDEX:
+        return "bucket-index";
+    case MemorySubsystem::FLOODGATE:
+        return "floodgate";
+    case MemorySubsystem::TRANSACTION_QUEUE:
+        return "transaction-queue";
+    case MemorySubsystem::PENDING_ENVELOPES:
+        return "pending-envelopes";
+    default:
+        throw std::runtime_error("Unknown memory subsystem");
+    }
+}
+
+MemoryUsage
+getUsage(MemorySubsystem subsystem)
+{
+    auto i = static_cast<size_t>(subsystem);
+    releaseAssert(i < SUBSYSTEM_COUNT);
+    auto const& counters = gCounters[i];
+    MemoryUsage res;
+    res.mLiveBytes = counters.mLiveBytes.load(std::memory_order_relaxed);
+    res.mLiveAllocations =
+        counters.mLiveAllocations.load(std::memory_order_relaxed);
+    res.mTotalBytes = counters.mTotalBytes.load(std::memory_order_relaxed);
+    res.mTotalAllocations =
+        counters.mTotalAllocations.load(std::memory_order_relaxed);
+    return res;
+}
+
+Scope::Scope(MemorySubsystem subsystem) : mPrevious(gCurrentSubsystem)
+{
+    gCurrentSubsystem = subsystem;
+}
+
+Scope::~Scope()
+{
+    gCurrentSubsystem = mPrevious;
+}
+}
+}
+
+#ifdef USE_MEMORY_ACCOUNTING
+
+#ifdef __has_feature
+#if __has_feature(address_sanitizer)
+#error "ASAN and USE_MEMORY_ACCOUNTING are mutually exclusive"
+#endif
+#elif defined(__SANITIZE_ADDRESS__)
+#error "ASAN and USE_MEMORY_ACCOUNTING are mutually exclusive"
+#endif
+
+namespace
+{
+using stellar::gCounters;
+using stellar::gCurrentSubsystem;
+
+// Precedes every allocation. mOffset is the distance from the start of the
+// underlying malloc'ed block to the pointer handed out, which is larger than
+// the header for over-aligned allocations.
+struct alignas(16) AllocationHeader
+{
+    uint64_t mSize;
+    uint32_t mOffset;
+    stellar::MemorySubsystem mSubsystem;
+};
+static_assert(sizeof(AllocationHeader) == 16);
+
+void*
+accountedAllocate(std::size_t size, std::size_t alignment) noexcept
+{
+    std::size_t offset = std::max(alignment, sizeof(AllocationHeader));
+    void* block;
+    if (alignment <= alignof(std::max_align_t))
+    {
+        block = std::malloc(size + offset);
+    }
+    else
+    {
+        // aligned_alloc requires a size that is a multiple of the alignment
+        auto total = (size + offset + alignment - 1) / alignment * alignment;
+        block = std::aligned_alloc(alignment, total);
+    }
+    if (block == nullptr)
+    {
+        return nullptr;
+    }
+
+    auto ptr = static_cast<char*>(block) + offset;
+    auto header = reinterpret_cast<AllocationHeader*>(ptr) - 1;
+    header->mSize = size;
+    header->mOffset = static_cast<uint32_t>(offset);
+    header->mSubsystem = gCurrentSubsystem;
+
+    auto& counters = gCounters[static_cast<size_t>(gCurrentSubsystem)];
+    auto sz = static_cast<int64_t>(size);
+    counters.mLiveBytes.fetch_add(sz, std::memory_order_relaxed);
+    counters.mLiveAllocations.fetch_add(1, std::memory_order_relaxed);
+    counters.mTotalBytes.fetch_add(size, std::memory_order_relaxed);
+    counters.mTotalAllocations.fetch_add(1, std::memory_order_relaxed);
+    return ptr;
+}
+
+void
+accountedFree(void* ptr) noexcept
+{
+    if (ptr == nullptr)
+    {
+        return;
+    }
+    auto header = static_cast<AllocationHeader*>(ptr) - 1;
+    auto& counters = gCounters[static_cast<size_t>(header->mSubsystem)];
+    counters.mLiveBytes.fetch_sub(static_cast<int64_t>(header->mSize),
+                                  std::memory_order_relaxed);
+    counters.mLiveAllocations.fetch_sub(1, std::memory_order_relaxed);
+    std::free(static_cast<char*>(ptr) - header->mOffset);
+}
+
+void*
+accountedNew(std::size_t size, std::size_t alignment)
+{
+    auto ptr = accountedAllocate(size, alignment);
+    if (ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+}
+
+// All the replaceable forms of operator new and delete must go through the
+// same functions, as memory allocated by one form may be released by another.
+
+void*
+operator new(std::size_t size)
+{
+    return accountedNew(size, alignof(std::max_align_t));
+}
+
+void*
+operator new[](std::size_t size)
+{
+    return accountedNew(size, alignof(std::max_align_t));
+}
+
+void*
+operator new(std::size_t size, std::nothrow_t const&) noexcept
+{
+    return accountedAllocate(size, alignof(std::max_align_t));
+}
+
+void*
+operator new[](std::size_t size, std::nothrow_t const&) noexcept
+{
+    return accountedAllocate(size, alignof(std::max_align_t));
+}
+
+void*
+operator new(std::size_t size, std::align_val_t alignment)
+{
+    return accountedNew(size, static_cast<std::size_t>(alignment));
+}
+
+void*
+operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return accountedNew(size, static_cast<std::size_t>(alignment));
+}
+
+void*
+operator new(std::size_t size, std::align_val_t alignment,
+             std::nothrow_t const&) noexcept
+{
+    return accountedAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void*
+operator new[](std::size_t size, std::align_val_t alignment,
+               std::nothrow_t const&) noexcept
+{
+    return accountedAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void
+operator delete(void* ptr) noexcept
+{
+    accountedFree(ptr);
+}
+
+void
+operator delete[](void* ptr) noexcept
+{
+    accountedFree(ptr);
+}
+
+void
+operator delete(void* ptr, std::size_t) noexcept
+{
+    accountedFree(ptr);
+}
+
+void
+operator delete[](void* ptr, std::size_t) noexcept
+{
+    accountedFree(ptr);
+}
+
+void
+operator delete(void* ptr, std::nothrow_t const&) noexcept
+{
+    accountedFree(ptr);
+}
+
+void
+operator delete[](void* ptr, std::nothrow_t const&) noexcept
+{
+    accountedFree(ptr);
+}
+
+void
+operator delete(void* ptr, std::align_val_t) noexcept
+{
+    accountedFree(ptr);
+}
+
+void
+operator delete[](void* ptr, std::align_val_t) noexcept
+{
+    accountedFree(ptr);
+}
+
+void
+operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    accountedFree(ptr);
+}
+
+void
+operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    accountedFree(ptr);
+}
+
+void
+operator delete(void* ptr, std::align_val_t, std::nothrow_t const&) noexcept
+{
+    accountedFree(ptr);
+}
+
+void
+operator delete[](void* ptr, std::align_val_t, std::nothrow_t const&) noexcept
+{
+    accountedFree(ptr);
+}
+
+#endif // USE_MEMORY_ACCOUNTING
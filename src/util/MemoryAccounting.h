@@ -0,0 +1,76 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include <cstdint>
+
+namespace stellar
+{
+
+// Subsystems heap allocations can be attributed to. Allocations made outside
+// of any MEMORY_ACCOUNTING_SCOPE are attributed to OTHER.
+enum class MemorySubsystem : uint8_t
+{
+    OTHER = 0,
+    LEDGER_TXN,
+    SOROBAN_STATE,
+    BUCKET_INDEX,
+    FLOODGATE,
+    TRANSACTION_QUEUE,
+    PENDING_ENVELOPES,
+    COUNT
+};
+
+struct MemoryUsage
+{
+    // Allocations made in the subsystem that haven't been freed yet, wherever
+    // they are freed from
+    int64_t mLiveBytes{0};
+    int64_t mLiveAllocations{0};
+    // All the allocations made in the subsystem since startup
+    uint64_t mTotalBytes{0};
+    uint64_t mTotalAllocations{0};
+};
+
+// Accounting of C++ heap allocations per subsystem, compiled in by configuring
+// with --enable-memory-accounting. When compiled in, the global operator new
+// and delete prefix every allocation with a small header recording its size
+// and the subsystem of the innermost MEMORY_ACCOUNTING_SCOPE active on the
+// allocating thread, so that frees are attributed to the subsystem the memory
+// was allocated in. Allocations made by Rust code or directly with malloc are
+// not seen.
+namespace memoryaccounting
+{
+bool isEnabled();
+
+char const* getSubsystemName(MemorySubsystem subsystem);
+
+// Always zero when accounting isn't compiled in
+MemoryUsage getUsage(MemorySubsystem subsystem);
+
+// Attributes the allocations made by the current thread to a subsystem for
+// the lifetime of the scope
+class Scope
+{
+    MemorySubsystem const mPrevious;
+
+  public:
+    explicit Scope(MemorySubsystem subsystem);
+    ~Scope();
+    Scope(Scope const&) = delete;
+    Scope& operator=(Scope const&) = delete;
+};
+}
+}
+
+#ifdef USE_MEMORY_ACCOUNTING
+#define MEMORY_ACCOUNTING_CONCAT_(a, b) a##b
+#define MEMORY_ACCOUNTING_CONCAT(a, b) MEMORY_ACCOUNTING_CONCAT_(a, b)
+#define MEMORY_ACCOUNTING_SCOPE(subsystem)                                     \
+    stellar::memoryaccounting::Scope MEMORY_ACCOUNTING_CONCAT(                 \
+        memoryAccountingScope, __LINE__)(stellar::MemorySubsystem::subsystem)
+#else
+#define MEMORY_ACCOUNTING_SCOPE(subsystem)
+#endif
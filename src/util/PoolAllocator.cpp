@@ -0,0 +1,111 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/PoolAllocator.h"
+#include "util/GlobalChecks.h"
+
+namespace stellar
+{
+
+namespace
+{
+constexpr size_t NUM_SIZE_CLASSES =
+    SmallBlockPool::MAX_BLOCK_SIZE / SmallBlockPool::SIZE_CLASS_BYTES;
+
+static_assert(SmallBlockPool::SIZE_CLASS_BYTES >= sizeof(void*));
+static_assert(SmallBlockPool::SIZE_CLASS_BYTES %
+                  alignof(std::max_align_t) ==
+              0);
+
+// Free blocks are linked through their first bytes
+struct FreeBlock
+{
+    FreeBlock* next;
+};
+
+size_t
+getSizeClass(size_t size)
+{
+    releaseAssert(size != 0 && size <= SmallBlockPool::MAX_BLOCK_SIZE);
+    return (size - 1) / SmallBlockPool::SIZE_CLASS_BYTES;
+}
+
+size_t
+getClassBytes(size_t sizeClass)
+{
+    return (sizeClass + 1) * SmallBlockPool::SIZE_CLASS_BYTES;
+}
+
+struct ThreadCache
+{
+    FreeBlock* mFree[NUM_SIZE_CLASSES]{};
+    size_t mCachedBytes{0};
+
+    ~ThreadCache();
+};
+
+// Objects with static storage duration may release pooled memory after the
+// thread's cache has been destroyed. This flag is trivially destructible, so
+// it remains readable until the thread exits.
+thread_local bool gCacheDestroyed = false;
+thread_local ThreadCache gCache;
+
+ThreadCache::~ThreadCache()
+{
+    for (size_t i = 0; i < NUM_SIZE_CLASSES; ++i)
+    {
+        while (mFree[i])
+        {
+            auto next = mFree[i]->next;
+            ::operator delete(mFree[i]);
+            mFree[i] = next;
+        }
+    }
+    mCachedBytes = 0;
+    gCacheDestroyed = true;
+}
+}
+
+void*
+SmallBlockPool::allocate(size_t size)
+{
+    auto sizeClass = getSizeClass(size);
+    if (!gCacheDestroyed)
+    {
+        auto& head = gCache.mFree[sizeClass];
+        if (head)
+        {
+            auto block = head;
+            head = block->next;
+            gCache.mCachedBytes -= getClassBytes(sizeClass);
+            return block;
+        }
+    }
+
+    return ::operator new(getClassBytes(sizeClass));
+}
+
+void
+SmallBlockPool::deallocate(void* p, size_t size) noexcept
+{
+    auto sizeClass = getSizeClass(size);
+    auto classBytes = getClassBytes(sizeClass);
+    if (gCacheDestroyed || gCache.mCachedBytes + classBytes > MAX_CACHED_BYTES)
+    {
+        ::operator delete(p);
+        return;
+    }
+
+    auto block = static_cast<FreeBlock*>(p);
+    block->next = gCache.mFree[sizeClass];
+    gCache.mFree[sizeClass] = block;
+    gCache.mCachedBytes += classBytes;
+}
+
+size_t
+SmallBlockPool::getCachedBytes()
+{
+    return gCacheDestroyed ? 0 : gCache.mCachedBytes;
+}
+}
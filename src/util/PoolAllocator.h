@@ -0,0 +1,111 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/UnorderedMap.h"
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace stellar
+{
+
+// Thread local cache of freed small allocations. Blocks are grouped into size
+// classes of SIZE_CLASS_BYTES, and a freed block is kept on its thread's free
+// list so that the next allocation of the same class on that thread reuses it
+// instead of going to malloc. Blocks are ordinary heap allocations, so a block
+// may be freed on a different thread than it was allocated on. At most
+// MAX_CACHED_BYTES are cached per thread; beyond that, blocks are returned to
+// the heap.
+class SmallBlockPool
+{
+  public:
+    static constexpr size_t SIZE_CLASS_BYTES = 16;
+    static constexpr size_t MAX_BLOCK_SIZE = 1024;
+    static constexpr size_t MAX_CACHED_BYTES = 16 * 1024 * 1024;
+
+    static void* allocate(size_t size);
+    static void deallocate(void* p, size_t size) noexcept;
+
+    // Returns the number of bytes currently cached by the calling thread
+    static size_t getCachedBytes();
+};
+
+// Standard allocator that serves single small objects from SmallBlockPool and
+// falls back to std::allocator for arrays and large or over-aligned types. It
+// is stateless, so it can be used for node based containers and with
+// std::allocate_shared.
+template <class T> class PoolAllocator
+{
+    static constexpr bool
+    usePool(size_t n)
+    {
+        return n == 1 && sizeof(T) <= SmallBlockPool::MAX_BLOCK_SIZE &&
+               alignof(T) <= alignof(std::max_align_t);
+    }
+
+  public:
+    using value_type = T;
+
+    PoolAllocator() noexcept = default;
+    template <class U> PoolAllocator(PoolAllocator<U> const&) noexcept
+    {
+    }
+
+    T*
+    allocate(size_t n)
+    {
+        if (usePool(n))
+        {
+            return static_cast<T*>(SmallBlockPool::allocate(sizeof(T)));
+        }
+        return std::allocator<T>().allocate(n);
+    }
+
+    void
+    deallocate(T* p, size_t n) noexcept
+    {
+        if (usePool(n))
+        {
+            SmallBlockPool::deallocate(p, sizeof(T));
+            return;
+        }
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <class U>
+    bool
+    operator==(PoolAllocator<U> const&) const noexcept
+    {
+        return true;
+    }
+
+    template <class U>
+    bool
+    operator!=(PoolAllocator<U> const&) const noexcept
+    {
+        return false;
+    }
+};
+
+// Same as std::make_shared, but the object and its control block are
+// allocated from SmallBlockPool
+template <class T, class... Args>
+std::shared_ptr<T>
+makePooledShared(Args&&... args)
+{
+    return std::allocate_shared<T>(PoolAllocator<std::remove_const_t<T>>(),
+                                   std::forward<Args>(args)...);
+}
+
+// UnorderedMap whose nodes are allocated from SmallBlockPool, for maps that
+// are filled and cleared at a high rate
+template <class KeyT, class ValT, class Hasher = std::hash<KeyT>>
+using PooledUnorderedMap =
+    UnorderedMap<KeyT, ValT, Hasher,
+                 PoolAllocator<std::pair<KeyT const, ValT>>>;
+}
@@ -0,0 +1,367 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/PrometheusExporter.h"
+#include "util/HdrHistogram.h"
+#include "medida/buckets.h"
+#include "medida/counter.h"
+#include "medida/histogram.h"
+#include "medida/meter.h"
+#include "medida/metric_processor.h"
+#include "medida/stats/snapshot.h"
+#include "medida/timer.h"
+#include <Tracy.hpp>
+#include <fmt/format.h>
+
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace stellar
+{
+
+char const* const PrometheusExporter::CONTENT_TYPE =
+    "text/plain; version=0.0.4; charset=utf-8";
+
+namespace
+{
+double constexpr NANOS_PER_SECOND = 1e9;
+
+// The quantiles of the JSON reports
+std::array<double, 6> constexpr MEDIDA_QUANTILES = {0.5,  0.75, 0.95,
+                                                    0.98, 0.99, 0.999};
+std::array<double, 7> constexpr HDR_QUANTILES = {0.5,  0.75,  0.95,  0.98,
+                                                 0.99, 0.999, 0.9999};
+
+uint64_t
+mix(uint64_t h, uint64_t v)
+{
+    return (h ^ v) * 0x100000001b3ULL;
+}
+
+uint64_t
+mix(uint64_t h, double v)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return mix(h, bits);
+}
+
+void
+appendValue(std::string& out, double v)
+{
+    if (std::isnan(v))
+    {
+        out += "NaN";
+    }
+    else if (std::isinf(v))
+    {
+        out += v > 0 ? "+Inf" : "-Inf";
+    }
+    else
+    {
+        out += fmt::format(FMT_STRING("{}"), v);
+    }
+}
+
+void
+appendSample(std::string& out, std::string const& name, double v)
+{
+    out += name;
+    out += ' ';
+    appendValue(out, v);
+    out += '\n';
+}
+
+void
+appendQuantile(std::string& out, std::string const& name, double q, double v)
+{
+    out += fmt::format(FMT_STRING("{}{{quantile=\"{}\"}} "), name, q);
+    appendValue(out, v);
+    out += '\n';
+}
+
+void
+appendType(std::string& out, std::string const& name, char const* type)
+{
+    out += fmt::format(FMT_STRING("# TYPE {} {}\n"), name, type);
+}
+
+// Converts v, in unit, to seconds. Multiplying before dividing keeps round
+// values round.
+double
+toSeconds(double v, std::chrono::nanoseconds unit)
+{
+    return v * static_cast<double>(unit.count()) / NANOS_PER_SECOND;
+}
+
+// Computes the fingerprint of a metric and, if it differs from the cached
+// one, renders it into the entry
+class EntryRenderer : public medida::MetricProcessor
+{
+    medida::MetricName const& mMetricName;
+    uint64_t mFingerprint{0};
+    bool mRender{false};
+    std::string mText;
+
+    // Called once the fingerprint is known, returns whether to render
+    bool
+    check(uint64_t fingerprint)
+    {
+        mRender = mRender || fingerprint != mFingerprint;
+        mFingerprint = fingerprint;
+        return mRender;
+    }
+
+    void
+    appendSummary(std::string const& name, medida::stats::Snapshot const& snap,
+                  std::chrono::nanoseconds unit, double sum, uint64_t count)
+    {
+        appendType(mText, name, "summary");
+        for (auto q : MEDIDA_QUANTILES)
+        {
+            appendQuantile(mText, name, q, toSeconds(snap.getValue(q), unit));
+        }
+        appendSample(mText, name + "_sum", toSeconds(sum, unit));
+        appendSample(mText, name + "_count", static_cast<double>(count));
+    }
+
+    // Only computed when rendering
+    std::string
+    name() const
+    {
+        return PrometheusExporter::toPrometheusName(mMetricName);
+    }
+
+  public:
+    EntryRenderer(medida::MetricName const& name, uint64_t fingerprint,
+                  bool force)
+        : mMetricName(name)
+        , mFingerprint(fingerprint)
+        , mRender(force)
+    {
+    }
+
+    bool
+    rendered() const
+    {
+        return mRender;
+    }
+
+    uint64_t
+    fingerprint() const
+    {
+        return mFingerprint;
+    }
+
+    std::string&
+    text()
+    {
+        return mText;
+    }
+
+    void
+    Process(medida::Counter& counter) override
+    {
+        auto v = counter.count();
+        if (check(mix(0, static_cast<uint64_t>(v))))
+        {
+            auto name = this->name();
+            appendType(mText, name, "gauge");
+            appendSample(mText, name, static_cast<double>(v));
+        }
+    }
+
+    void
+    Process(medida::Meter& meter) override
+    {
+        auto v = meter.count();
+        if (check(mix(1, v)))
+        {
+            auto name = this->name() + "_total";
+            appendType(mText, name, "counter");
+            appendSample(mText, name, static_cast<double>(v));
+        }
+    }
+
+    void
+    Process(medida::Histogram& histogram) override
+    {
+        auto count = histogram.count();
+        auto sum = histogram.sum();
+        if (check(mix(mix(2, count), sum)))
+        {
+            // Histograms have no unit, a 1s unit leaves their values alone
+            appendSummary(name(), histogram.GetSnapshot(),
+                          std::chrono::seconds(1), sum, count);
+        }
+    }
+
+    void
+    Process(medida::Timer& timer) override
+    {
+        auto count = timer.count();
+        auto sum = timer.sum();
+        if (check(mix(mix(3, count), sum)))
+        {
+            appendSummary(name() + "_seconds", timer.GetSnapshot(),
+                          timer.duration_unit(), sum, count);
+        }
+    }
+
+    void
+    Process(medida::Buckets& buckets) override
+    {
+        // Each bucket counts the values up to its boundary, the last one is
+        // unbounded
+        std::vector<std::pair<double, std::shared_ptr<medida::Timer>>> all;
+        buckets.forBuckets([&](auto b) { all.emplace_back(b); });
+        uint64_t fingerprint = 4;
+        for (auto const& b : all)
+        {
+            fingerprint = mix(fingerprint, b.second->count());
+        }
+        if (!check(fingerprint))
+        {
+            return;
+        }
+
+        auto name = this->name() + "_seconds";
+        auto unit = buckets.boundary_unit();
+        appendType(mText, name, "histogram");
+        uint64_t cumulative = 0;
+        double sum = 0;
+        for (size_t i = 0; i < all.size(); ++i)
+        {
+            auto const& timer = *all[i].second;
+            cumulative += timer.count();
+            sum += toSeconds(timer.sum(), timer.duration_unit());
+            mText += name;
+            if (i + 1 == all.size())
+            {
+                mText += "_bucket{le=\"+Inf\"} ";
+            }
+            else
+            {
+                mText += "_bucket{le=\"";
+                appendValue(mText, toSeconds(all[i].first, unit));
+                mText += "\"} ";
+            }
+            mText += std::to_string(cumulative);
+            mText += '\n';
+        }
+        appendSample(mText, name + "_sum", sum);
+        appendSample(mText, name + "_count", static_cast<double>(cumulative));
+    }
+};
+
+void
+renderHdrTimer(std::string& out, std::string const& name,
+               HdrHistogram::Snapshot const& snap)
+{
+    auto seconds = [](uint64_t ns) {
+        return static_cast<double>(ns) / NANOS_PER_SECOND;
+    };
+    appendType(out, name, "summary");
+    for (auto q : HDR_QUANTILES)
+    {
+        appendQuantile(out, name, q, seconds(snap.getValueAtQuantile(q)));
+    }
+    appendSample(out, name + "_sum", seconds(snap.sum()));
+    appendSample(out, name + "_count", static_cast<double>(snap.count()));
+}
+}
+
+std::string
+PrometheusExporter::toPrometheusName(medida::MetricName const& name)
+{
+    auto res = "stellar_core_" + name.ToString();
+    for (auto& c : res)
+    {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_' &&
+            c != ':')
+        {
+            c = '_';
+        }
+    }
+    return res;
+}
+
+std::string
+PrometheusExporter::render(Metrics const& metrics, HdrTimers const& timers)
+{
+    ZoneScoped;
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto now = std::chrono::steady_clock::now();
+    size_t rendered = 0;
+    size_t size = 0;
+
+    // Entries are moved to new maps so that those of removed metrics go away
+    std::map<medida::MetricName, Entry> metricEntries;
+    for (auto const& [name, metric] : metrics)
+    {
+        auto& entry = metricEntries[name];
+        auto it = mMetricEntries.find(name);
+        bool cached = it != mMetricEntries.end();
+        if (cached)
+        {
+            entry = std::move(it->second);
+        }
+        EntryRenderer r(name, entry.mFingerprint,
+                        !cached || now - entry.mRenderedAt > MAX_AGE);
+        metric->Process(r);
+        if (r.rendered())
+        {
+            entry.mFingerprint = r.fingerprint();
+            entry.mRenderedAt = now;
+            entry.mText = std::move(r.text());
+            ++rendered;
+        }
+        size += entry.mText.size();
+    }
+
+    std::map<medida::MetricName, Entry> hdrTimerEntries;
+    for (auto const& [name, timer] : timers)
+    {
+        auto& entry = hdrTimerEntries[name];
+        auto it = mHdrTimerEntries.find(name);
+        bool cached = it != mHdrTimerEntries.end();
+        if (cached)
+        {
+            entry = std::move(it->second);
+        }
+        auto snap = timer->GetSnapshot();
+        auto fingerprint = mix(mix(5, snap.count()), snap.sum());
+        if (!cached || fingerprint != entry.mFingerprint ||
+            now - entry.mRenderedAt > MAX_AGE)
+        {
+            entry.mFingerprint = fingerprint;
+            entry.mRenderedAt = now;
+            entry.mText.clear();
+            renderHdrTimer(entry.mText, toPrometheusName(name) + "_seconds",
+                           snap);
+            ++rendered;
+        }
+        size += entry.mText.size();
+    }
+
+    mMetricEntries.swap(metricEntries);
+    mHdrTimerEntries.swap(hdrTimerEntries);
+    mLastRenderedCount = rendered;
+
+    std::string out;
+    out.reserve(size);
+    for (auto const& kv : mMetricEntries)
+    {
+        out += kv.second.mText;
+    }
+    for (auto const& kv : mHdrTimerEntries)
+    {
+        out += kv.second.mText;
+    }
+    return out;
+}
+}
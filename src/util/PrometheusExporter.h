@@ -0,0 +1,81 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "medida/metric_name.h"
+#include "util/NonCopyable.h"
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace medida
+{
+class MetricInterface;
+}
+
+namespace stellar
+{
+class HdrTimer;
+
+// Renders medida metrics and HdrTimers in the Prometheus text exposition
+// format, for the "prometheus" command:
+//  - counters (which stellar-core also uses as gauges) as gauges,
+//  - meters as counters named <name>_total,
+//  - timers as summaries in seconds named <name>_seconds,
+//  - histograms as summaries,
+//  - buckets as histograms in seconds named <name>_seconds.
+// Names are prefixed with stellar_core_, with characters Prometheus doesn't
+// allow replaced by _.
+//
+// The text of every metric is cached along with a fingerprint of its state
+// (its count and sum, or value), and only rendered again when the fingerprint
+// changes or the text is older than MAX_AGE. Most metrics don't change between
+// two scrapes, so a scrape mostly copies cached text. MAX_AGE bounds how stale
+// the quantiles of idle timers and histograms get, as medida expires their
+// samples after 30 seconds.
+class PrometheusExporter : public NonMovableOrCopyable
+{
+  public:
+    static constexpr std::chrono::seconds MAX_AGE{30};
+    static char const* const CONTENT_TYPE;
+
+    using Metrics =
+        std::map<medida::MetricName, std::shared_ptr<medida::MetricInterface>>;
+    using HdrTimers = std::map<medida::MetricName, std::shared_ptr<HdrTimer>>;
+
+    // Renders all of metrics and timers, dropping the cached text of metrics
+    // that are no longer there. Thread-safe.
+    std::string render(Metrics const& metrics, HdrTimers const& timers);
+
+    static std::string toPrometheusName(medida::MetricName const& name);
+
+#ifdef BUILD_TESTS
+    // Number of metrics whose text the last call to render produced again
+    size_t
+    getLastRenderedCount() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mLastRenderedCount;
+    }
+#endif
+
+  private:
+    struct Entry
+    {
+        uint64_t mFingerprint{0};
+        std::chrono::steady_clock::time_point mRenderedAt;
+        std::string mText;
+    };
+
+    mutable std::mutex mMutex;
+    std::map<medida::MetricName, Entry> mMetricEntries;
+    std::map<medida::MetricName, Entry> mHdrTimerEntries;
+    size_t mLastRenderedCount{0};
+};
+}
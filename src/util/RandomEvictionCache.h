@@ -28,6 +28,7 @@ class RandomEvictionCache : public NonMovableOrCopyable
         uint64_t mInserts{0};
         uint64_t mUpdates{0};
         uint64_t mEvicts{0};
+        uint64_t mRejects{0};
     };
 
   private:
@@ -61,15 +62,12 @@ class RandomEvictionCache : public NonMovableOrCopyable
     bool const mSeparatePRNG{false};
     stellar_default_random_engine mRandEngine;
 
-    // Randomly pick two elements and evict the less-recently-used one.
-    void
-    evictOne()
+    // Randomly pick two elements and return the less-recently-used one. Must
+    // not be called on an empty cache.
+    MapValueType*&
+    pickVictim()
     {
         size_t sz = mValuePtrs.size();
-        if (sz == 0)
-        {
-            return;
-        }
         auto getRandIndex = [&]() {
             if (mSeparatePRNG)
             {
@@ -79,14 +77,29 @@ class RandomEvictionCache : public NonMovableOrCopyable
         };
         MapValueType*& vp1 = mValuePtrs.at(getRandIndex());
         MapValueType*& vp2 = mValuePtrs.at(getRandIndex());
-        MapValueType*& victim =
-            (vp1->second.mLastAccess < vp2->second.mLastAccess ? vp1 : vp2);
+        return vp1->second.mLastAccess < vp2->second.mLastAccess ? vp1 : vp2;
+    }
+
+    void
+    evict(MapValueType*& victim)
+    {
         mValueMap.erase(victim->first);
         std::swap(victim, mValuePtrs.back());
         mValuePtrs.pop_back();
         ++mCounters.mEvicts;
     }
 
+    // Randomly pick two elements and evict the less-recently-used one.
+    void
+    evictOne()
+    {
+        if (mValuePtrs.empty())
+        {
+            return;
+        }
+        evict(pickVictim());
+    }
+
   public:
     explicit RandomEvictionCache(size_t maxSize)
         : mMaxSize(maxSize), mSeparatePRNG(false)
@@ -96,10 +109,17 @@ class RandomEvictionCache : public NonMovableOrCopyable
     }
 
     RandomEvictionCache(size_t maxSize, bool separatePRNG)
+        : RandomEvictionCache(maxSize, separatePRNG, maxSize + 1)
+    {
+    }
+
+    // Only reserves room for reserveSize entries upfront, for caches whose
+    // maxSize is much larger than what they usually hold
+    RandomEvictionCache(size_t maxSize, bool separatePRNG, size_t reserveSize)
         : mMaxSize(maxSize), mSeparatePRNG(separatePRNG)
     {
-        mValueMap.reserve(maxSize + 1);
-        mValuePtrs.reserve(maxSize + 1);
+        mValueMap.reserve(reserveSize);
+        mValuePtrs.reserve(reserveSize);
     }
 
     void
@@ -162,6 +182,60 @@ class RandomEvictionCache : public NonMovableOrCopyable
         }
     }
 
+    // Like `put`, but when inserting a new key into a full cache, the eviction
+    // victim is picked first and `admit(victimKey)` decides whether the new
+    // key is worth more than the victim. If not, the cache is left unchanged
+    // and the rejection is counted. Updates to existing keys are always
+    // applied. Returns true if the value was stored.
+    template <typename AdmitFn>
+    bool
+    put(K const& k, V const& v, AdmitFn&& admit)
+    {
+        if (mValuePtrs.size() < mMaxSize ||
+            mValueMap.find(k) != mValueMap.end())
+        {
+            put(k, v);
+            return true;
+        }
+
+        if (mMaxSize == 0)
+        {
+            ++mCounters.mRejects;
+            return false;
+        }
+
+        MapValueType*& victim = pickVictim();
+        if (!admit(victim->first))
+        {
+            ++mCounters.mRejects;
+            return false;
+        }
+
+        evict(victim);
+        put(k, v);
+        return true;
+    }
+
+    // Randomly picks two elements and evicts the less-recently-used one if
+    // `pred(victimKey)` holds. Returns the evicted value, if any.
+    template <typename Pred>
+    std::optional<V>
+    evictOneIf(Pred&& pred)
+    {
+        if (mValuePtrs.empty())
+        {
+            return std::nullopt;
+        }
+        MapValueType*& victim = pickVictim();
+        if (!pred(victim->first))
+        {
+            return std::nullopt;
+        }
+        std::optional<V> res = std::move(victim->second.mValue);
+        evict(victim);
+        return res;
+    }
+
     // `exists` offers strong exception safety guarantee.
     bool
     exists(K const& k, bool countMisses = true)
@@ -212,21 +286,28 @@ class RandomEvictionCache : public NonMovableOrCopyable
 
     // `maybeGet` offers basic exception safety guarantee.
     // Returns a pointer to the value if the key exists,
-    // and returns a nullptr otherwise.
+    // and returns a nullptr otherwise. Pass `false` for countAccess to keep
+    // the lookup out of the hit and miss counters.
     V*
-    maybeGet(K const& k)
+    maybeGet(K const& k, bool countAccess = true)
     {
         auto it = mValueMap.find(k);
         if (it != mValueMap.end())
         {
             auto& cacheVal = it->second;
-            ++mCounters.mHits;
+            if (countAccess)
+            {
+                ++mCounters.mHits;
+            }
             cacheVal.mLastAccess = ++mGeneration;
             return &cacheVal.mValue;
         }
         else
         {
-            ++mCounters.mMisses;
+            if (countAccess)
+            {
+                ++mCounters.mMisses;
+            }
             return nullptr;
         }
     }
@@ -0,0 +1,286 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/NonCopyable.h"
+#include "util/RandomEvictionCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace stellar
+{
+
+// A RandomEvictionCache that can be used from several threads at once. Keys
+// are spread over shards by hash, each with its own mutex, so that threads
+// only contend when they hit the same shard.
+//
+// Capacity is shared by all shards: the cache holds at most maxSize entries
+// and, if a size function is given, at most maxBytes bytes of them in total.
+// When a put goes over either limit, entries are evicted from the shard it
+// went to, by the same least-recent-out-of-2-random-choices rule, until the
+// cache is back under them. This may evict the entry just added, if its shard
+// holds nothing else, so small caches get fewer shards: at least
+// MIN_SHARD_SIZE entries' worth each.
+//
+// Values are returned by copy, as a reference would outlive the shard lock;
+// cache cheap-to-copy values such as shared_ptrs.
+template <typename K, typename V, typename Hash = std::hash<K>>
+class ShardedRandomEvictionCache : public NonMovableOrCopyable
+{
+  public:
+    static constexpr size_t DEFAULT_NUM_SHARDS = 16;
+    static constexpr size_t MIN_SHARD_SIZE = 1024;
+
+    using Counters = typename RandomEvictionCache<K, V, Hash>::Counters;
+    // Returns how many bytes an entry counts for against maxBytes
+    using SizeFn = std::function<size_t(K const&, V const&)>;
+
+  private:
+    struct Value
+    {
+        V mValue;
+        size_t mBytes;
+    };
+
+    struct Shard
+    {
+        std::mutex mMutex;
+        // Never evicts on its own, all evictions go through evictOneIf so
+        // that mSize and mBytes stay accurate
+        RandomEvictionCache<K, Value, Hash> mCache{
+            std::numeric_limits<size_t>::max(), /* separatePRNG */ true,
+            /* reserveSize */ 0};
+        uint64_t mRejects{0};
+    };
+
+    size_t const mMaxSize;
+    size_t const mMaxBytes;
+    SizeFn const mSizeFn;
+    std::vector<std::unique_ptr<Shard>> mShards;
+
+    std::atomic<size_t> mSize{0};
+    std::atomic<size_t> mBytes{0};
+
+    Shard&
+    shardFor(K const& k)
+    {
+        // Mix the hash, std::hash of integers is the identity
+        uint64_t h = static_cast<uint64_t>(Hash{}(k)) * 0x9E3779B97F4A7C15ULL;
+        return *mShards[(h >> 32) % mShards.size()];
+    }
+
+    bool
+    overLimits() const
+    {
+        return mSize.load() > mMaxSize || mBytes.load() > mMaxBytes;
+    }
+
+    // Must be called with shard.mMutex held
+    void
+    forget(Value const& value)
+    {
+        --mSize;
+        mBytes -= value.mBytes;
+    }
+
+    // Must be called with shard.mMutex held
+    void
+    insert(Shard& shard, K const& k, V const& v)
+    {
+        Value value{v, mSizeFn ? mSizeFn(k, v) : 0};
+        if (auto existing = shard.mCache.maybeGet(k, /* countAccess */ false))
+        {
+            forget(*existing);
+        }
+        ++mSize;
+        mBytes += value.mBytes;
+        shard.mCache.put(k, value);
+    }
+
+    // Must be called with shard.mMutex held
+    void
+    shrink(Shard& shard)
+    {
+        while (overLimits())
+        {
+            auto victim =
+                shard.mCache.evictOneIf([](K const&) { return true; });
+            if (!victim)
+            {
+                break;
+            }
+            forget(*victim);
+        }
+    }
+
+  public:
+    explicit ShardedRandomEvictionCache(
+        size_t maxSize, size_t numShards = DEFAULT_NUM_SHARDS)
+        : ShardedRandomEvictionCache(maxSize,
+                                     std::numeric_limits<size_t>::max(),
+                                     nullptr, numShards)
+    {
+    }
+
+    ShardedRandomEvictionCache(size_t maxSize, size_t maxBytes, SizeFn sizeFn,
+                               size_t numShards = DEFAULT_NUM_SHARDS)
+        : mMaxSize(maxSize), mMaxBytes(maxBytes), mSizeFn(std::move(sizeFn))
+    {
+        numShards = std::clamp<size_t>(maxSize / MIN_SHARD_SIZE, 1,
+                                       std::max<size_t>(1, numShards));
+        for (size_t i = 0; i < numShards; ++i)
+        {
+            mShards.emplace_back(std::make_unique<Shard>());
+        }
+    }
+
+    void
+    maybeSeed(unsigned int seed)
+    {
+        for (size_t i = 0; i < mShards.size(); ++i)
+        {
+            std::lock_guard<std::mutex> lock(mShards[i]->mMutex);
+            mShards[i]->mCache.maybeSeed(seed + static_cast<unsigned int>(i));
+        }
+    }
+
+    size_t
+    maxSize() const
+    {
+        return mMaxSize;
+    }
+
+    size_t
+    maxBytes() const
+    {
+        return mMaxBytes;
+    }
+
+    size_t
+    size() const
+    {
+        return mSize.load();
+    }
+
+    size_t
+    bytes() const
+    {
+        return mBytes.load();
+    }
+
+    // Sums the counters of all shards
+    Counters
+    getCounters() const
+    {
+        Counters res;
+        for (auto const& shard : mShards)
+        {
+            std::lock_guard<std::mutex> lock(shard->mMutex);
+            auto const& c = shard->mCache.getCounters();
+            res.mHits += c.mHits;
+            res.mMisses += c.mMisses;
+            res.mInserts += c.mInserts;
+            res.mUpdates += c.mUpdates;
+            res.mEvicts += c.mEvicts;
+            res.mRejects += shard->mRejects;
+        }
+        return res;
+    }
+
+    void
+    put(K const& k, V const& v)
+    {
+        auto& shard = shardFor(k);
+        std::lock_guard<std::mutex> lock(shard.mMutex);
+        insert(shard, k, v);
+        shrink(shard);
+    }
+
+    // Like RandomEvictionCache::put with an admission function: when a new
+    // key comes into a full cache, `admit(victimKey)` decides whether it
+    // replaces the victim picked from its shard. Returns true if the value was
+    // stored.
+    template <typename AdmitFn>
+    bool
+    put(K const& k, V const& v, AdmitFn&& admit)
+    {
+        auto& shard = shardFor(k);
+        std::lock_guard<std::mutex> lock(shard.mMutex);
+        if (mSize.load() >= mMaxSize &&
+            !shard.mCache.exists(k, /* countMisses */ false))
+        {
+            auto victim = shard.mCache.evictOneIf(admit);
+            if (!victim)
+            {
+                ++shard.mRejects;
+                return false;
+            }
+            forget(*victim);
+        }
+        insert(shard, k, v);
+        shrink(shard);
+        return shard.mCache.exists(k, /* countMisses */ false);
+    }
+
+    bool
+    exists(K const& k, bool countMisses = true)
+    {
+        auto& shard = shardFor(k);
+        std::lock_guard<std::mutex> lock(shard.mMutex);
+        return shard.mCache.exists(k, countMisses);
+    }
+
+    std::optional<V>
+    maybeGet(K const& k, bool countAccess = true)
+    {
+        auto& shard = shardFor(k);
+        std::lock_guard<std::mutex> lock(shard.mMutex);
+        auto res = shard.mCache.maybeGet(k, countAccess);
+        if (!res)
+        {
+            return std::nullopt;
+        }
+        return res->mValue;
+    }
+
+    void
+    erase_if(std::function<bool(V const&)> const& f)
+    {
+        for (auto& shard : mShards)
+        {
+            std::lock_guard<std::mutex> lock(shard->mMutex);
+            shard->mCache.erase_if([&](Value const& value) {
+                if (!f(value.mValue))
+                {
+                    return false;
+                }
+                forget(value);
+                return true;
+            });
+        }
+    }
+
+    void
+    clear()
+    {
+        for (auto& shard : mShards)
+        {
+            std::lock_guard<std::mutex> lock(shard->mMutex);
+            shard->mCache.erase_if([&](Value const& value) {
+                forget(value);
+                return true;
+            });
+        }
+    }
+};
+}
@@ -8,11 +8,19 @@
 #ifdef _WIN32
 #include <Windows.h>
 #else
+#include <time.h>
 #include <unistd.h>
 #endif
-#if defined(__APPLE__)
+#if defined(__APPLE__) || defined(__linux__)
 #include <pthread.h>
 #endif
+#if defined(__linux__)
+#include <fstream>
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <string>
+#include <sys/syscall.h>
+#endif
 
 namespace stellar
 {
@@ -116,4 +124,201 @@ runCurrentThreadWithMediumPriority()
 }
 
 #endif
+
+std::chrono::nanoseconds
+currentThreadCPUTime()
+{
+#if defined(_WIN32)
+    FILETIME creation, exit, kernel, user;
+    if (!::GetThreadTimes(::GetCurrentThread(), &creation, &exit, &kernel,
+                          &user))
+    {
+        return std::chrono::nanoseconds::zero();
+    }
+    auto ticks = [](FILETIME const& ft) {
+        return (static_cast<uint64_t>(ft.dwHighDateTime) << 32) |
+               ft.dwLowDateTime;
+    };
+    // FILETIME counts 100ns intervals
+    return std::chrono::nanoseconds((ticks(kernel) + ticks(user)) * 100);
+#elif defined(CLOCK_THREAD_CPUTIME_ID)
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+    {
+        return std::chrono::nanoseconds::zero();
+    }
+    return std::chrono::seconds(ts.tv_sec) +
+           std::chrono::nanoseconds(ts.tv_nsec);
+#else
+    return std::chrono::nanoseconds::zero();
+#endif
+}
+
+bool
+pinCurrentThreadToCPU(size_t n)
+{
+#if defined(__linux__)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+    {
+        return false;
+    }
+    auto count = static_cast<size_t>(CPU_COUNT(&allowed));
+    if (count == 0)
+    {
+        return false;
+    }
+    n %= count;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    {
+        if (CPU_ISSET(cpu, &allowed) && n-- == 0)
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) ==
+                   0;
+        }
+    }
+    return false;
+#else
+    return false;
+#endif
+}
+
+#if defined(__linux__)
+namespace
+{
+// Size of the node masks passed to the memory policy system calls, enough
+// for any machine we run on
+size_t constexpr NUMA_MASK_BITS = 1024;
+size_t constexpr BITS_PER_LONG = 8 * sizeof(unsigned long);
+
+// The kernel ignores the last bit of the maxnode it is given
+unsigned long constexpr NUMA_MAX_NODE = NUMA_MASK_BITS + 1;
+
+bool
+setMemoryPolicy(int mode, std::vector<unsigned long> const& nodes)
+{
+    return syscall(SYS_set_mempolicy, mode,
+                   nodes.empty() ? nullptr : nodes.data(),
+                   nodes.empty() ? 0 : NUMA_MAX_NODE) == 0;
+}
+
+bool
+preferNumaNodeMemory(uint32_t node)
+{
+    if (node >= NUMA_MASK_BITS)
+    {
+        return false;
+    }
+    std::vector<unsigned long> nodes(NUMA_MASK_BITS / BITS_PER_LONG, 0);
+    nodes[node / BITS_PER_LONG] |= 1UL << (node % BITS_PER_LONG);
+    return setMemoryPolicy(MPOL_PREFERRED, nodes);
+}
+
+// Reads the CPUs of `node` from sysfs, in the "0-7,16-23" list format
+bool
+getNumaNodeCPUs(uint32_t node, cpu_set_t& cpus)
+{
+    std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) +
+                     "/cpulist");
+    std::string list;
+    if (!in || !std::getline(in, list))
+    {
+        return false;
+    }
+    CPU_ZERO(&cpus);
+    size_t pos = 0;
+    while (pos < list.size())
+    {
+        auto end = list.find(',', pos);
+        if (end == std::string::npos)
+        {
+            end = list.size();
+        }
+        auto range = list.substr(pos, end - pos);
+        pos = end + 1;
+        if (range.empty())
+        {
+            continue;
+        }
+        try
+        {
+            auto dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos
+                           ? first
+                           : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu)
+            {
+                CPU_SET(cpu, &cpus);
+            }
+        }
+        catch (std::exception const&)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+}
+#endif
+
+bool
+bindCurrentThreadToNumaNode(uint32_t node)
+{
+#if defined(__linux__)
+    cpu_set_t nodeCPUs;
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (!getNumaNodeCPUs(node, nodeCPUs) ||
+        sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+    {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_AND(&set, &nodeCPUs, &allowed);
+    if (CPU_COUNT(&set) == 0 ||
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+    {
+        return false;
+    }
+    return preferNumaNodeMemory(node);
+#else
+    return false;
+#endif
+}
+
+NumaMemoryScope::NumaMemoryScope(std::optional<uint32_t> node)
+{
+#if defined(__linux__)
+    if (!node)
+    {
+        return;
+    }
+    mPreviousNodes.assign(NUMA_MASK_BITS / BITS_PER_LONG, 0);
+    if (syscall(SYS_get_mempolicy, &mPreviousMode, mPreviousNodes.data(),
+                NUMA_MAX_NODE, nullptr, 0) != 0)
+    {
+        return;
+    }
+    if (mPreviousMode == MPOL_DEFAULT)
+    {
+        mPreviousNodes.clear();
+    }
+    mActive = preferNumaNodeMemory(*node);
+#endif
+}
+
+NumaMemoryScope::~NumaMemoryScope()
+{
+#if defined(__linux__)
+    if (mActive && !setMemoryPolicy(mPreviousMode, mPreviousNodes))
+    {
+        LOG_DEBUG(DEFAULT_LOG, "Unable to restore NUMA memory policy");
+    }
+#endif
+}
 }
@@ -5,8 +5,11 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include <chrono>
+#include <cstdint>
 #include <future>
+#include <optional>
 #include <thread>
+#include <vector>
 
 namespace stellar
 {
@@ -14,6 +17,40 @@ namespace stellar
 void runCurrentThreadWithLowPriority();
 void runCurrentThreadWithMediumPriority();
 
+// CPU time used by the calling thread so far, or zero where the platform
+// doesn't tell
+std::chrono::nanoseconds currentThreadCPUTime();
+
+// Pins the calling thread to the n-th (modulo their number) of the CPUs it is
+// allowed to run on. Returns false where the platform doesn't support it or
+// the CPU can't be used.
+bool pinCurrentThreadToCPU(size_t n);
+
+// Restricts the calling thread to the CPUs of NUMA node `node` it is allowed
+// to run on, and makes it prefer that node's memory for its allocations.
+// Threads it starts afterwards inherit both. Returns false where the platform
+// doesn't support it or the node has no usable CPU.
+bool bindCurrentThreadToNumaNode(uint32_t node);
+
+// While in scope, the calling thread, and threads it starts, prefer the
+// memory of NUMA node `node` for their allocations; the previous preference
+// is restored on exit. Does nothing without a node or where the platform
+// doesn't support it.
+class NumaMemoryScope
+{
+  public:
+    explicit NumaMemoryScope(std::optional<uint32_t> node);
+    ~NumaMemoryScope();
+
+    NumaMemoryScope(NumaMemoryScope const&) = delete;
+    NumaMemoryScope& operator=(NumaMemoryScope const&) = delete;
+
+  private:
+    bool mActive{false};
+    int mPreviousMode{0};
+    std::vector<unsigned long> mPreviousNodes;
+};
+
 template <typename T>
 bool
 futureIsReady(std::future<T> const& fut)
@@ -259,12 +259,7 @@ VirtualClock::shutdown()
         getIOContext().stop();
 
         // Clear pending queue for the scheduler
-        {
-            std::lock_guard<std::mutex> guard(mPendingActionQueueMutex);
-            mPendingActionQueue =
-                std::queue<std::tuple<std::function<void()>, std::string,
-                                      Scheduler::ActionType>>();
-        }
+        clearPendingActions();
 
         // Clear scheduler queues
         mActionScheduler->shutdown();
@@ -398,18 +393,7 @@ VirtualClock::crank(bool block)
 
     // Transfer any pending actions to the scheduler, counting them as
     // "progress" also.
-    {
-        std::lock_guard<std::mutex> guard(mPendingActionQueueMutex);
-        while (!mPendingActionQueue.empty())
-        {
-            auto& f = mPendingActionQueue.front();
-            mActionScheduler->enqueue(std::move(std::get<1>(f)),
-                                      std::move(std::get<0>(f)),
-                                      std::get<2>(f));
-            mPendingActionQueue.pop();
-            progressCount++;
-        }
-    }
+    progressCount += transferPendingActions();
 
     if (block && progressCount == 0)
     {
@@ -429,12 +413,17 @@ VirtualClock::postAction(std::function<void()>&& f, std::string&& name,
         return;
     }
 
-    bool queueWasEmpty = false;
+    auto action =
+        new PendingAction{std::move(f), std::move(name), type, nullptr};
+    mPendingActionCount.fetch_add(1, std::memory_order_relaxed);
+    mPostedActions[static_cast<size_t>(type)].fetch_add(
+        1, std::memory_order_relaxed);
+    auto head = mPendingActions.load(std::memory_order_relaxed);
+    do
     {
-        std::lock_guard<std::mutex> lock(mPendingActionQueueMutex);
-        queueWasEmpty = mPendingActionQueue.empty();
-        mPendingActionQueue.emplace(std::move(f), std::move(name), type);
-    }
+        action->mNext = head;
+    } while (!mPendingActions.compare_exchange_weak(
+        head, action, std::memory_order_release, std::memory_order_relaxed));
 
     // The pending queue is emptied by the main thread just before the main
     // thread potentially blocks waiting for real IO events, on a call to
@@ -453,21 +442,71 @@ VirtualClock::postAction(std::function<void()>&& f, std::string&& name,
     // If we inject this at any point in the main thread's crank cycle other
     // than the brief window between it emptying the pending queue and doing a
     // blocking mIOContext.run_one call, it's pointless but also harmless.
-    if (queueWasEmpty)
+    if (head == nullptr)
     {
+        mPostWakeups.fetch_add(1, std::memory_order_relaxed);
         asio::post(mIOContext, []() {});
     }
 }
 
 size_t
-VirtualClock::getActionQueueSize() const
+VirtualClock::transferPendingActions()
 {
-    size_t pending = 0;
+    auto head = mPendingActions.exchange(nullptr, std::memory_order_acquire);
+    // Reverse the stack into posting order
+    PendingAction* first = nullptr;
+    while (head)
+    {
+        auto next = head->mNext;
+        head->mNext = first;
+        first = head;
+        head = next;
+    }
+    size_t n = 0;
+    while (first)
     {
-        std::lock_guard<std::mutex> guard(mPendingActionQueueMutex);
-        pending = mPendingActionQueue.size();
+        std::unique_ptr<PendingAction> action(first);
+        first = action->mNext;
+        mActionScheduler->enqueue(std::move(action->mName),
+                                  std::move(action->mAction), action->mType);
+        ++n;
     }
-    return pending + mActionScheduler->size();
+    mPendingActionCount.fetch_sub(n, std::memory_order_relaxed);
+    return n;
+}
+
+void
+VirtualClock::clearPendingActions()
+{
+    auto head = mPendingActions.exchange(nullptr, std::memory_order_acquire);
+    size_t n = 0;
+    while (head)
+    {
+        std::unique_ptr<PendingAction> action(head);
+        head = action->mNext;
+        ++n;
+    }
+    mPendingActionCount.fetch_sub(n, std::memory_order_relaxed);
+}
+
+size_t
+VirtualClock::getActionQueueSize() const
+{
+    return mPendingActionCount.load(std::memory_order_relaxed) +
+           mActionScheduler->size();
+}
+
+uint64_t
+VirtualClock::getPostedActionCount(Scheduler::ActionType type) const
+{
+    return mPostedActions[static_cast<size_t>(type)].load(
+        std::memory_order_relaxed);
+}
+
+uint64_t
+VirtualClock::getPostWakeupCount() const
+{
+    return mPostWakeups.load(std::memory_order_relaxed);
 }
 
 bool
@@ -492,6 +531,7 @@ VirtualClock::~VirtualClock()
 {
     mDestructing = true;
     cancelAllEvents();
+    clearPendingActions();
 }
 
 size_t
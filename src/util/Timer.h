@@ -11,6 +11,7 @@
 #include "util/NonCopyable.h"
 #include "util/Scheduler.h"
 
+#include <atomic>
 #include <chrono>
 #include <ctime>
 #include <functional>
@@ -148,11 +149,11 @@ class VirtualClock
     // fair real-time-slicing) multiple streams of callbacks competing for main
     // thread (real) time. Only the main thread ever accesses the Scheduler.
     //
-    // The second is a simple "pending actions" queue that is protected by a
-    // short-duration mutex. This is a threadsafe _submission_ point for adding
-    // actions to the Scheduler -- any thread can enqueue, and only the main
-    // thread will dequeue (immediately re-enqueueing into the Scheduler for
-    // further time-slicing / load-shedding).
+    // The second is a simple "pending actions" queue, a lock-free stack that
+    // any thread can push onto. This is a threadsafe _submission_ point for
+    // adding actions to the Scheduler -- only the main thread takes actions
+    // off, all at once, and immediately re-enqueues them into the Scheduler
+    // in posting order for further time-slicing / load-shedding.
     //
     // The third is a priority queue of VirtualClockEvents, which is the part of
     // the VirtualClock that manages the progress of virtual time and the
@@ -160,10 +161,22 @@ class VirtualClock
     std::chrono::steady_clock::time_point mLastDispatchStart;
     std::unique_ptr<Scheduler> mActionScheduler;
 
-    mutable std::mutex mPendingActionQueueMutex;
-    std::queue<
-        std::tuple<std::function<void()>, std::string, Scheduler::ActionType>>
-        mPendingActionQueue;
+    struct PendingAction
+    {
+        std::function<void()> mAction;
+        std::string mName;
+        Scheduler::ActionType mType;
+        PendingAction* mNext{nullptr};
+    };
+    // Most recently posted first
+    std::atomic<PendingAction*> mPendingActions{nullptr};
+    std::atomic<size_t> mPendingActionCount{0};
+    std::atomic<uint64_t> mPostedActions[2]{};
+    std::atomic<uint64_t> mPostWakeups{0};
+
+    // Move all pending actions to the Scheduler, returns how many there were
+    size_t transferPendingActions();
+    void clearPendingActions();
 
     using PrQueue =
         std::priority_queue<std::shared_ptr<VirtualClockEvent>,
@@ -225,6 +238,12 @@ class VirtualClock
                     Scheduler::ActionType type);
 
     size_t getActionQueueSize() const;
+
+    // Totals since startup of actions posted through postAction, by type, and
+    // of the wakeups that took. A wakeup is only needed when posting to an
+    // empty pending queue, so a burst of posts costs one.
+    uint64_t getPostedActionCount(Scheduler::ActionType type) const;
+    uint64_t getPostWakeupCount() const;
     bool actionQueueIsOverloaded() const;
     Scheduler::ActionType currentSchedulerActionType() const;
 };
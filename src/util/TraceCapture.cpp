@@ -0,0 +1,213 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/TraceCapture.h"
+#include "lib/json/json.h"
+#include "util/GlobalChecks.h"
+
+#include <chrono>
+#include <fmt/format.h>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace stellar
+{
+
+namespace tracecapture
+{
+std::atomic<bool> gActive{false};
+
+namespace
+{
+struct Event
+{
+    Location const* mLocation;
+    int64_t mStartNs;
+    int64_t mEndNs;
+};
+
+// Only written by its thread, but read by the thread writing the capture
+struct ThreadBuffer
+{
+    uint32_t const mThreadIndex;
+    std::string const mThreadName;
+
+    ThreadBuffer(uint32_t threadIndex, std::string threadName)
+        : mThreadIndex(threadIndex), mThreadName(std::move(threadName))
+    {
+    }
+
+    std::mutex mMutex;
+    std::vector<Event> mEvents;
+    // Oldest event once mEvents is full
+    size_t mNext{0};
+};
+
+// Guards the start and stop of captures and gBuffers
+std::mutex gMutex;
+// Buffers of all the threads that recorded a zone, as long as they're alive
+// or their zones haven't been written
+std::vector<std::shared_ptr<ThreadBuffer>> gBuffers;
+uint32_t gNextThreadIndex{0};
+int64_t gStartNs{0};
+
+thread_local std::shared_ptr<ThreadBuffer> gThreadBuffer;
+
+ThreadBuffer&
+getThreadBuffer()
+{
+    if (!gThreadBuffer)
+    {
+        std::lock_guard<std::mutex> lock(gMutex);
+        auto index = gNextThreadIndex++;
+        auto name = threadIsMain() ? std::string("main")
+                                   : fmt::format("thread {}", index);
+        gThreadBuffer = std::make_shared<ThreadBuffer>(index, std::move(name));
+        gBuffers.emplace_back(gThreadBuffer);
+    }
+    return *gThreadBuffer;
+}
+
+int64_t
+nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+std::string
+quoted(char const* str)
+{
+    return Json::valueToQuotedString(str ? str : "");
+}
+}
+
+void
+start()
+{
+    std::lock_guard<std::mutex> lock(gMutex);
+    if (gActive.load())
+    {
+        throw std::runtime_error("a trace capture is already running");
+    }
+    // Drop the buffers of the threads that exited since the last capture
+    std::vector<std::shared_ptr<ThreadBuffer>> alive;
+    for (auto& buffer : gBuffers)
+    {
+        if (buffer.use_count() > 1)
+        {
+            std::lock_guard<std::mutex> bufferLock(buffer->mMutex);
+            buffer->mEvents.clear();
+            buffer->mNext = 0;
+            alive.emplace_back(std::move(buffer));
+        }
+    }
+    gBuffers = std::move(alive);
+    gStartNs = nowNs();
+    gActive.store(true);
+}
+
+size_t
+stopAndWrite(std::string const& path)
+{
+    std::vector<std::pair<std::shared_ptr<ThreadBuffer>, std::vector<Event>>>
+        threads;
+    int64_t startNs;
+    {
+        std::lock_guard<std::mutex> lock(gMutex);
+        if (!gActive.exchange(false))
+        {
+            throw std::runtime_error("no trace capture is running");
+        }
+        startNs = gStartNs;
+        for (auto const& buffer : gBuffers)
+        {
+            std::lock_guard<std::mutex> bufferLock(buffer->mMutex);
+            auto const& events = buffer->mEvents;
+            if (events.empty())
+            {
+                continue;
+            }
+            auto next = events.begin() + buffer->mNext;
+            std::vector<Event> ordered(next, events.end());
+            ordered.insert(ordered.end(), events.begin(), next);
+            threads.emplace_back(buffer, std::move(ordered));
+        }
+    }
+
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if (!out)
+    {
+        throw std::runtime_error(
+            fmt::format("failed to open trace file '{}'", path));
+    }
+    out << "{\"traceEvents\":[";
+    char const* sep = "\n";
+    size_t written = 0;
+    for (auto const& [buffer, events] : threads)
+    {
+        out << sep
+            << fmt::format(
+                   "{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,"
+                   "\"tid\":{},\"args\":{{\"name\":{}}}}}",
+                   buffer->mThreadIndex,
+                   quoted(buffer->mThreadName.c_str()));
+        sep = ",\n";
+        for (auto const& e : events)
+        {
+            auto const& loc = *e.mLocation;
+            out << sep
+                << fmt::format(
+                       "{{\"name\":{},\"ph\":\"X\",\"pid\":0,\"tid\":{},"
+                       "\"ts\":{:.3f},\"dur\":{:.3f},"
+                       "\"args\":{{\"file\":{},\"line\":{}}}}}",
+                       quoted(loc.mName ? loc.mName : loc.mFunction),
+                       buffer->mThreadIndex, (e.mStartNs - startNs) / 1e3,
+                       (e.mEndNs - e.mStartNs) / 1e3, quoted(loc.mFile),
+                       loc.mLine);
+        }
+        written += events.size();
+    }
+    out << "\n]}\n";
+    out.close();
+    if (!out)
+    {
+        throw std::runtime_error(
+            fmt::format("failed to write trace file '{}'", path));
+    }
+    return written;
+}
+
+int64_t
+Zone::now()
+{
+    return nowNs();
+}
+
+void
+Zone::record(Location const* location, int64_t startNs, int64_t endNs)
+{
+    if (!isActive())
+    {
+        return;
+    }
+    auto& buffer = getThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mMutex);
+    Event e{location, startNs, endNs};
+    if (buffer.mEvents.size() < EVENTS_PER_THREAD)
+    {
+        buffer.mEvents.emplace_back(e);
+    }
+    else
+    {
+        buffer.mEvents[buffer.mNext] = e;
+        buffer.mNext = (buffer.mNext + 1) % EVENTS_PER_THREAD;
+    }
+}
+}
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include <Tracy.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace stellar
+{
+
+// Capture of the Tracy zones of a running node, for builds without Tracy.
+// Builds configured with --enable-tracecapture are given this header ahead of
+// every source file, which turns ZoneScoped, ZoneScopedN and ZoneNamedN into
+// Zones: while no capture is running a zone costs a relaxed atomic load.
+// While one is running, every zone that ends is recorded into a ring buffer
+// of the thread it ran on, keeping the last EVENTS_PER_THREAD zones of each
+// thread, and stopping the capture writes them out in the Chrome trace event
+// format, which chrome://tracing and Perfetto load. Zones that began before
+// the capture started are recorded, those still open when it stops are not.
+// Other builds leave the zone macros to Tracy.
+//
+// Plots, messages and zone texts are not captured.
+namespace tracecapture
+{
+static constexpr size_t EVENTS_PER_THREAD = 1 << 16;
+
+// Where a zone is defined, static for each zone
+struct Location
+{
+    // Name given to the zone, null to name it after mFunction
+    char const* mName;
+    char const* mFunction;
+    char const* mFile;
+    uint32_t mLine;
+};
+
+extern std::atomic<bool> gActive;
+
+inline bool
+isActive()
+{
+    return gActive.load(std::memory_order_relaxed);
+}
+
+// Starts a capture, throws if one is already running
+void start();
+
+// Stops the running capture and writes the zones it recorded to path,
+// returning how many were written. Throws if no capture is running, or if
+// path can't be written.
+size_t stopAndWrite(std::string const& path);
+
+class Zone
+{
+    Location const* mLocation{nullptr};
+    int64_t mStartNs{0};
+
+    static int64_t now();
+    static void record(Location const* location, int64_t startNs,
+                       int64_t endNs);
+
+  public:
+    explicit Zone(Location const* location, bool active = true)
+    {
+        if (active && isActive())
+        {
+            mLocation = location;
+            mStartNs = now();
+        }
+    }
+
+    ~Zone()
+    {
+        if (mLocation)
+        {
+            record(mLocation, mStartNs, now());
+        }
+    }
+
+    Zone(Zone const&) = delete;
+    Zone& operator=(Zone const&) = delete;
+};
+}
+}
+
+#ifdef USE_TRACECAPTURE
+#undef ZoneNamedN
+#undef ZoneScoped
+#undef ZoneScopedN
+#define TRACE_CAPTURE_CONCAT_(a, b) a##b
+#define TRACE_CAPTURE_CONCAT(a, b) TRACE_CAPTURE_CONCAT_(a, b)
+#define ZoneNamedN(varname, name, active)                                      \
+    static constexpr stellar::tracecapture::Location TRACE_CAPTURE_CONCAT(     \
+        traceCaptureLocation, __LINE__){name, TracyFunction, TracyFile,        \
+                                        static_cast<uint32_t>(TracyLine)};     \
+    stellar::tracecapture::Zone varname(                                       \
+        &TRACE_CAPTURE_CONCAT(traceCaptureLocation, __LINE__), active)
+#define ZoneScoped ZoneNamedN(traceCaptureZone, nullptr, true)
+#define ZoneScopedN(name) ZoneNamedN(traceCaptureZone, name, true)
+#endif
@@ -4,10 +4,752 @@
 
 #pragma once
 #include "util/RandHasher.h"
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 namespace stellar
 {
+template <class KeyT, class ValT, class Hasher = std::hash<KeyT>,
+          class Alloc = std::allocator<std::pair<KeyT const, ValT>>>
+using UnorderedMap = std::unordered_map<KeyT, ValT, RandHasher<KeyT, Hasher>,
+                                        std::equal_to<KeyT>, Alloc>;
+
+// Open addressing hash map in the style of SwissTable, for maps on hot paths
+// that are filled, probed and cleared at a high rate. Entries are stored
+// inline in a single slot array alongside one control byte per slot. The
+// control byte of a full slot holds 7 bits of the key's hash, so a lookup
+// filters a group of 8 slots with a few word operations and only compares
+// keys whose hash bits match. Groups are probed quadratically and the table
+// is kept at most 7/8 full.
+//
+// The interface is the subset of std::unordered_map used by callers, with two
+// differences, as in other flat maps:
+//   - Inserting (including operator[] on a new key) may rehash, which
+//     invalidates all iterators and references. Erasing only invalidates
+//     iterators and references to the erased entry.
+//   - value_type is std::pair<KeyT, ValT>. Keys must never be modified
+//     through an iterator.
+// Keys are hashed with RandHasher, like UnorderedMap.
 template <class KeyT, class ValT, class Hasher = std::hash<KeyT>>
-using UnorderedMap = std::unordered_map<KeyT, ValT, RandHasher<KeyT, Hasher>>;
+class UnorderedFlatMap
+{
+  public:
+    using key_type = KeyT;
+    using mapped_type = ValT;
+    using value_type = std::pair<KeyT, ValT>;
+    using size_type = size_t;
+    using hasher = RandHasher<KeyT, Hasher>;
+
+  private:
+    using AllocT = std::allocator<value_type>;
+    using AllocTraits = std::allocator_traits<AllocT>;
+
+    static constexpr size_t GROUP_SIZE = 8;
+    static constexpr size_t MIN_CAPACITY = GROUP_SIZE;
+    static constexpr int8_t EMPTY = -128;
+    static constexpr int8_t DELETED = -2;
+    static constexpr uint64_t LSBS = 0x0101010101010101ULL;
+    static constexpr uint64_t MSBS = 0x8080808080808080ULL;
+    static constexpr size_t NPOS = SIZE_MAX;
+
+    // Control bytes are EMPTY, DELETED, or the low 7 bits of the hash of the
+    // key in a full slot
+    std::unique_ptr<int8_t[]> mCtrl{};
+    value_type* mSlots{nullptr};
+    size_t mCapacity{0};
+    size_t mSize{0};
+    size_t mDeleted{0};
+
+    static size_t
+    maxLoad(size_t capacity)
+    {
+        return capacity - capacity / 8;
+    }
+
+    static uint64_t
+    loadGroup(int8_t const* ctrl)
+    {
+        uint64_t word = 0;
+        for (size_t i = 0; i < GROUP_SIZE; ++i)
+        {
+            word |= static_cast<uint64_t>(static_cast<uint8_t>(ctrl[i]))
+                    << (8 * i);
+        }
+        return word;
+    }
+
+    // Each of the following returns a mask with the high bit of byte i set if
+    // slot i of the group matches. matchHash may report false positives, but
+    // only for full slots, so candidates are always confirmed by comparing
+    // keys.
+    static uint64_t
+    matchHash(uint64_t group, uint8_t h2)
+    {
+        auto x = group ^ (LSBS * h2);
+        return (x - LSBS) & ~x & MSBS;
+    }
+
+    static uint64_t
+    matchEmpty(uint64_t group)
+    {
+        return group & ~(group << 6) & MSBS;
+    }
+
+    static uint64_t
+    matchEmptyOrDeleted(uint64_t group)
+    {
+        return group & ~(group << 7) & MSBS;
+    }
+
+    static size_t
+    lowestMatch(uint64_t mask)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, mask);
+        return index / 8;
+#else
+        return static_cast<size_t>(__builtin_ctzll(mask)) / 8;
+#endif
+    }
+
+    static size_t
+    hashKey(KeyT const& key)
+    {
+        return hasher()(key);
+    }
+
+    static uint8_t
+    h2(size_t hash)
+    {
+        return static_cast<uint8_t>(hash & 0x7F);
+    }
+
+    size_t
+    firstGroup(size_t hash) const
+    {
+        return (hash >> 7) & (mCapacity / GROUP_SIZE - 1);
+    }
+
+    // Triangular probing visits every group when the number of groups is a
+    // power of two
+    size_t
+    nextGroup(size_t group, size_t step) const
+    {
+        return (group + step) & (mCapacity / GROUP_SIZE - 1);
+    }
+
+    size_t
+    findIndex(KeyT const& key, size_t hash) const
+    {
+        if (mCapacity == 0)
+        {
+            return NPOS;
+        }
+
+        auto group = firstGroup(hash);
+        for (size_t step = 1;; ++step)
+        {
+            auto const base = group * GROUP_SIZE;
+            auto const word = loadGroup(&mCtrl[base]);
+            for (auto mask = matchHash(word, h2(hash)); mask != 0;
+                 mask &= mask - 1)
+            {
+                auto i = base + lowestMatch(mask);
+                if (mSlots[i].first == key)
+                {
+                    return i;
+                }
+            }
+
+            // An insert would have stopped at the first group with a free
+            // slot, so the key can't be in later groups
+            if (matchEmpty(word) != 0)
+            {
+                return NPOS;
+            }
+            group = nextGroup(group, step);
+        }
+    }
+
+    size_t
+    findFreeSlot(size_t hash) const
+    {
+        auto group = firstGroup(hash);
+        for (size_t step = 1;; ++step)
+        {
+            auto const base = group * GROUP_SIZE;
+            auto mask = matchEmptyOrDeleted(loadGroup(&mCtrl[base]));
+            if (mask != 0)
+            {
+                return base + lowestMatch(mask);
+            }
+            group = nextGroup(group, step);
+        }
+    }
+
+    static size_t
+    capacityFor(size_t numEntries)
+    {
+        size_t capacity = MIN_CAPACITY;
+        while (maxLoad(capacity) < numEntries)
+        {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    void
+    rehash(size_t newCapacity)
+    {
+        if (newCapacity > PTRDIFF_MAX / sizeof(value_type))
+        {
+            throw std::length_error("UnorderedFlatMap too large");
+        }
+
+        auto newCtrl = std::make_unique<int8_t[]>(newCapacity);
+        std::fill(newCtrl.get(), newCtrl.get() + newCapacity, EMPTY);
+
+        AllocT alloc;
+        auto newSlots = AllocTraits::allocate(alloc, newCapacity);
+
+        UnorderedFlatMap rehashed;
+        rehashed.mCtrl = std::move(newCtrl);
+        rehashed.mSlots = newSlots;
+        rehashed.mCapacity = newCapacity;
+
+        // If moving an entry can throw, entries are copied instead and this
+        // map is left untouched on failure
+        for (size_t i = 0; i < mCapacity; ++i)
+        {
+            if (mCtrl[i] >= 0)
+            {
+                auto hash = hashKey(mSlots[i].first);
+                auto slot = rehashed.findFreeSlot(hash);
+                AllocTraits::construct(alloc, &rehashed.mSlots[slot],
+                                       std::move_if_noexcept(mSlots[i]));
+                rehashed.mCtrl[slot] = h2(hash);
+                ++rehashed.mSize;
+            }
+        }
+
+        swap(rehashed);
+    }
+
+    // Returns a free slot for a new entry with the given hash, growing the
+    // table if needed
+    size_t
+    prepareInsert(size_t hash)
+    {
+        if (mSize + mDeleted + 1 > maxLoad(mCapacity))
+        {
+            // Reclaim deleted slots without growing if the table is mostly
+            // tombstones
+            auto newCapacity =
+                mCapacity == 0
+                    ? MIN_CAPACITY
+                    : (mSize + 1 > maxLoad(mCapacity) / 2 ? mCapacity * 2
+                                                          : mCapacity);
+            rehash(newCapacity);
+        }
+        return findFreeSlot(hash);
+    }
+
+    void
+    commitInsert(size_t slot, size_t hash)
+    {
+        if (mCtrl[slot] == DELETED)
+        {
+            --mDeleted;
+        }
+        mCtrl[slot] = h2(hash);
+        ++mSize;
+    }
+
+    template <class... Args>
+    std::pair<size_t, bool>
+    tryEmplaceIndex(KeyT const& key, Args&&... args)
+    {
+        auto hash = hashKey(key);
+        auto i = findIndex(key, hash);
+        if (i != NPOS)
+        {
+            return {i, false};
+        }
+
+        auto slot = prepareInsert(hash);
+        AllocT alloc;
+        AllocTraits::construct(alloc, &mSlots[slot],
+                               std::forward<Args>(args)...);
+        commitInsert(slot, hash);
+        return {slot, true};
+    }
+
+    void
+    eraseIndex(size_t i)
+    {
+        AllocT alloc;
+        AllocTraits::destroy(alloc, &mSlots[i]);
+        --mSize;
+
+        // Lookups stop at the first group with an empty slot. If this group
+        // already has one, no probe sequence continues past it and the slot
+        // can be marked empty rather than deleted.
+        auto base = i - i % GROUP_SIZE;
+        if (matchEmpty(loadGroup(&mCtrl[base])) != 0)
+        {
+            mCtrl[i] = EMPTY;
+        }
+        else
+        {
+            mCtrl[i] = DELETED;
+            ++mDeleted;
+        }
+    }
+
+    void
+    destroyAll()
+    {
+        AllocT alloc;
+        for (size_t i = 0; i < mCapacity; ++i)
+        {
+            if (mCtrl[i] >= 0)
+            {
+                AllocTraits::destroy(alloc, &mSlots[i]);
+            }
+        }
+    }
+
+    void
+    release()
+    {
+        if (mSlots)
+        {
+            destroyAll();
+            AllocT alloc;
+            AllocTraits::deallocate(alloc, mSlots, mCapacity);
+        }
+        mCtrl.reset();
+        mSlots = nullptr;
+        mCapacity = 0;
+        mSize = 0;
+        mDeleted = 0;
+    }
+
+    template <bool IsConst> class IteratorImpl
+    {
+        friend class UnorderedFlatMap;
+
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = UnorderedFlatMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer =
+            std::conditional_t<IsConst, value_type const*, value_type*>;
+        using reference =
+            std::conditional_t<IsConst, value_type const&, value_type&>;
+
+      private:
+        using CtrlT = int8_t const*;
+        using SlotT = pointer;
+
+        CtrlT mCtrl{nullptr};
+        SlotT mSlots{nullptr};
+        size_t mIndex{0};
+        size_t mCapacity{0};
+
+        IteratorImpl(CtrlT ctrl, SlotT slots, size_t index, size_t capacity)
+            : mCtrl(ctrl), mSlots(slots), mIndex(index), mCapacity(capacity)
+        {
+        }
+
+        void
+        skipFree()
+        {
+            while (mIndex < mCapacity && mCtrl[mIndex] < 0)
+            {
+                ++mIndex;
+            }
+        }
+
+      public:
+        IteratorImpl() = default;
+
+        template <bool C = IsConst, typename = std::enable_if_t<C>>
+        IteratorImpl(IteratorImpl<false> const& other)
+            : mCtrl(other.mCtrl)
+            , mSlots(other.mSlots)
+            , mIndex(other.mIndex)
+            , mCapacity(other.mCapacity)
+        {
+        }
+
+        reference
+        operator*() const
+        {
+            return mSlots[mIndex];
+        }
+
+        pointer
+        operator->() const
+        {
+            return &mSlots[mIndex];
+        }
+
+        IteratorImpl&
+        operator++()
+        {
+            ++mIndex;
+            skipFree();
+            return *this;
+        }
+
+        IteratorImpl
+        operator++(int)
+        {
+            auto res = *this;
+            ++(*this);
+            return res;
+        }
+
+        bool
+        operator==(IteratorImpl const& other) const
+        {
+            return mIndex == other.mIndex;
+        }
+
+        bool
+        operator!=(IteratorImpl const& other) const
+        {
+            return mIndex != other.mIndex;
+        }
+
+        friend class IteratorImpl<true>;
+    };
+
+  public:
+    using iterator = IteratorImpl<false>;
+    using const_iterator = IteratorImpl<true>;
+
+    UnorderedFlatMap() = default;
+
+    UnorderedFlatMap(UnorderedFlatMap const& other)
+    {
+        if (other.mSize == 0)
+        {
+            return;
+        }
+
+        // Same layout as other, so no entry has to be rehashed
+        UnorderedFlatMap copy;
+        copy.mCtrl = std::make_unique<int8_t[]>(other.mCapacity);
+        std::fill(copy.mCtrl.get(), copy.mCtrl.get() + other.mCapacity, EMPTY);
+        AllocT alloc;
+        copy.mSlots = AllocTraits::allocate(alloc, other.mCapacity);
+        copy.mCapacity = other.mCapacity;
+        for (size_t i = 0; i < other.mCapacity; ++i)
+        {
+            if (other.mCtrl[i] >= 0)
+            {
+                AllocTraits::construct(alloc, &copy.mSlots[i],
+                                       other.mSlots[i]);
+                copy.mCtrl[i] = other.mCtrl[i];
+                ++copy.mSize;
+            }
+            else if (other.mCtrl[i] == DELETED)
+            {
+                copy.mCtrl[i] = DELETED;
+                ++copy.mDeleted;
+            }
+        }
+        swap(copy);
+    }
+
+    UnorderedFlatMap(UnorderedFlatMap&& other) noexcept
+    {
+        swap(other);
+    }
+
+    UnorderedFlatMap&
+    operator=(UnorderedFlatMap const& other)
+    {
+        if (this != &other)
+        {
+            UnorderedFlatMap copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    UnorderedFlatMap&
+    operator=(UnorderedFlatMap&& other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            swap(other);
+        }
+        return *this;
+    }
+
+    ~UnorderedFlatMap()
+    {
+        release();
+    }
+
+    void
+    swap(UnorderedFlatMap& other) noexcept
+    {
+        std::swap(mCtrl, other.mCtrl);
+        std::swap(mSlots, other.mSlots);
+        std::swap(mCapacity, other.mCapacity);
+        std::swap(mSize, other.mSize);
+        std::swap(mDeleted, other.mDeleted);
+    }
+
+    iterator
+    begin()
+    {
+        iterator it(mCtrl.get(), mSlots, 0, mCapacity);
+        it.skipFree();
+        return it;
+    }
+
+    iterator
+    end()
+    {
+        return iterator(mCtrl.get(), mSlots, mCapacity, mCapacity);
+    }
+
+    const_iterator
+    begin() const
+    {
+        const_iterator it(mCtrl.get(), mSlots, 0, mCapacity);
+        it.skipFree();
+        return it;
+    }
+
+    const_iterator
+    end() const
+    {
+        return const_iterator(mCtrl.get(), mSlots, mCapacity, mCapacity);
+    }
+
+    const_iterator
+    cbegin() const
+    {
+        return begin();
+    }
+
+    const_iterator
+    cend() const
+    {
+        return end();
+    }
+
+    size_t
+    size() const
+    {
+        return mSize;
+    }
+
+    bool
+    empty() const
+    {
+        return mSize == 0;
+    }
+
+    // Destroys all entries, keeping the allocated capacity
+    void
+    clear()
+    {
+        if (mCapacity != 0)
+        {
+            destroyAll();
+            std::fill(mCtrl.get(), mCtrl.get() + mCapacity, EMPTY);
+        }
+        mSize = 0;
+        mDeleted = 0;
+    }
+
+    void
+    reserve(size_t numEntries)
+    {
+        auto capacity = capacityFor(numEntries);
+        if (capacity > mCapacity)
+        {
+            rehash(capacity);
+        }
+    }
+
+    iterator
+    find(KeyT const& key)
+    {
+        auto i = findIndex(key, hashKey(key));
+        return i == NPOS ? end() : iterator(mCtrl.get(), mSlots, i, mCapacity);
+    }
+
+    const_iterator
+    find(KeyT const& key) const
+    {
+        auto i = findIndex(key, hashKey(key));
+        return i == NPOS ? end()
+                         : const_iterator(mCtrl.get(), mSlots, i, mCapacity);
+    }
+
+    size_t
+    count(KeyT const& key) const
+    {
+        return findIndex(key, hashKey(key)) == NPOS ? 0 : 1;
+    }
+
+    ValT&
+    at(KeyT const& key)
+    {
+        auto i = findIndex(key, hashKey(key));
+        if (i == NPOS)
+        {
+            throw std::out_of_range("UnorderedFlatMap::at");
+        }
+        return mSlots[i].second;
+    }
+
+    ValT const&
+    at(KeyT const& key) const
+    {
+        auto i = findIndex(key, hashKey(key));
+        if (i == NPOS)
+        {
+            throw std::out_of_range("UnorderedFlatMap::at");
+        }
+        return mSlots[i].second;
+    }
+
+    template <class... Args>
+    std::pair<iterator, bool>
+    try_emplace(KeyT const& key, Args&&... args)
+    {
+        auto [i, inserted] = tryEmplaceIndex(
+            key, std::piecewise_construct, std::forward_as_tuple(key),
+            std::forward_as_tuple(std::forward<Args>(args)...));
+        return {iterator(mCtrl.get(), mSlots, i, mCapacity), inserted};
+    }
+
+    template <class... Args>
+    std::pair<iterator, bool>
+    try_emplace(KeyT&& key, Args&&... args)
+    {
+        auto [i, inserted] =
+            tryEmplaceIndex(key, std::piecewise_construct,
+                            std::forward_as_tuple(std::move(key)),
+                            std::forward_as_tuple(std::forward<Args>(args)...));
+        return {iterator(mCtrl.get(), mSlots, i, mCapacity), inserted};
+    }
+
+    std::pair<iterator, bool>
+    insert(value_type const& kv)
+    {
+        auto [i, inserted] = tryEmplaceIndex(kv.first, kv);
+        return {iterator(mCtrl.get(), mSlots, i, mCapacity), inserted};
+    }
+
+    std::pair<iterator, bool>
+    insert(value_type&& kv)
+    {
+        auto [i, inserted] = tryEmplaceIndex(kv.first, std::move(kv));
+        return {iterator(mCtrl.get(), mSlots, i, mCapacity), inserted};
+    }
+
+    template <class InputIt>
+    void
+    insert(InputIt first, InputIt last)
+    {
+        for (; first != last; ++first)
+        {
+            insert(*first);
+        }
+    }
+
+    // Like std::unordered_map::emplace, does nothing if the key exists
+    template <class K, class V>
+    std::pair<iterator, bool>
+    emplace(K&& key, V&& val)
+    {
+        return try_emplace(std::forward<K>(key), std::forward<V>(val));
+    }
+
+    ValT&
+    operator[](KeyT const& key)
+    {
+        return try_emplace(key).first->second;
+    }
+
+    ValT&
+    operator[](KeyT&& key)
+    {
+        return try_emplace(std::move(key)).first->second;
+    }
+
+    iterator
+    erase(const_iterator pos)
+    {
+        eraseIndex(pos.mIndex);
+        iterator next(mCtrl.get(), mSlots, pos.mIndex, mCapacity);
+        next.skipFree();
+        return next;
+    }
+
+    iterator
+    erase(iterator pos)
+    {
+        return erase(const_iterator(pos));
+    }
+
+    size_t
+    erase(KeyT const& key)
+    {
+        auto i = findIndex(key, hashKey(key));
+        if (i == NPOS)
+        {
+            return 0;
+        }
+        eraseIndex(i);
+        return 1;
+    }
+
+    bool
+    operator==(UnorderedFlatMap const& other) const
+    {
+        if (mSize != other.mSize)
+        {
+            return false;
+        }
+        for (auto const& kv : *this)
+        {
+            auto it = other.find(kv.first);
+            if (it == other.end() || !(it->second == kv.second))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool
+    operator!=(UnorderedFlatMap const& other) const
+    {
+        return !(*this == other);
+    }
+};
 }
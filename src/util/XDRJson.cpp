@@ -0,0 +1,270 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/XDRJson.h"
+#include "crypto/KeyUtils.h"
+#include "crypto/SecretKey.h"
+#include "crypto/StrKey.h"
+#include "transactions/TransactionUtils.h"
+#include "util/GlobalChecks.h"
+
+#include <charconv>
+
+namespace stellar
+{
+
+JsonWriter::JsonWriter(std::string& out, unsigned indent)
+    : mOut(out), mIndent(indent)
+{
+}
+
+void
+JsonWriter::indent()
+{
+    mOut.append(mLevels.size() * mIndent, ' ');
+}
+
+void
+JsonWriter::prefix(char const* name)
+{
+    if (mLevels.empty())
+    {
+        // The root value
+        return;
+    }
+    auto& level = mLevels.back();
+    if (level.mInArray)
+    {
+        if (level.mCount > 0)
+        {
+            mOut.push_back(',');
+        }
+        mOut.push_back('\n');
+        indent();
+        ++level.mCount;
+        return;
+    }
+
+    mOut.append(level.mCount > 0 ? ",\n" : "\n");
+    indent();
+    if (name)
+    {
+        appendString(name);
+    }
+    else
+    {
+        appendString("value" + std::to_string(level.mUnnamedCount++));
+    }
+    mOut.append(": ");
+    ++level.mCount;
+}
+
+void
+JsonWriter::end(char close)
+{
+    releaseAssert(!mLevels.empty());
+    auto empty = mLevels.back().mCount == 0;
+    mLevels.pop_back();
+    if (!empty)
+    {
+        mOut.push_back('\n');
+        indent();
+    }
+    mOut.push_back(close);
+}
+
+void
+JsonWriter::startObject(char const* name)
+{
+    prefix(name);
+    mOut.push_back('{');
+    mLevels.push_back({false});
+}
+
+void
+JsonWriter::endObject()
+{
+    releaseAssert(!mLevels.empty() && !mLevels.back().mInArray);
+    end('}');
+}
+
+void
+JsonWriter::startArray(char const* name)
+{
+    prefix(name);
+    mOut.push_back('[');
+    mLevels.push_back({true});
+}
+
+void
+JsonWriter::endArray()
+{
+    releaseAssert(!mLevels.empty() && mLevels.back().mInArray);
+    end(']');
+}
+
+void
+JsonWriter::appendString(std::string_view s)
+{
+    static char const hexDigits[] = "0123456789ABCDEF";
+    mOut.push_back('"');
+    for (char c : s)
+    {
+        auto u = static_cast<unsigned char>(c);
+        switch (u)
+        {
+        case '"':
+            mOut.append("\\\"");
+            break;
+        case '\\':
+            mOut.append("\\\\");
+            break;
+        case '\b':
+            mOut.append("\\b");
+            break;
+        case '\f':
+            mOut.append("\\f");
+            break;
+        case '\n':
+            mOut.append("\\n");
+            break;
+        case '\r':
+            mOut.append("\\r");
+            break;
+        case '\t':
+            mOut.append("\\t");
+            break;
+        default:
+            if (u < 0x20)
+            {
+                mOut.append("\\u00");
+                mOut.push_back(hexDigits[u >> 4]);
+                mOut.push_back(hexDigits[u & 0xF]);
+            }
+            else
+            {
+                // UTF-8 is written as is
+                mOut.push_back(c);
+            }
+        }
+    }
+    mOut.push_back('"');
+}
+
+void
+JsonWriter::writeString(char const* name, std::string_view s)
+{
+    prefix(name);
+    appendString(s);
+}
+
+void
+JsonWriter::writeInt(char const* name, int64_t i)
+{
+    prefix(name);
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), i);
+    mOut.append(buf, res.ptr);
+}
+
+void
+JsonWriter::writeUint(char const* name, uint64_t u)
+{
+    prefix(name);
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), u);
+    mOut.append(buf, res.ptr);
+}
+
+void
+JsonWriter::writeNull(char const* name)
+{
+    prefix(name);
+    mOut.append("null");
+}
+
+namespace xdrjson
+{
+void
+writePublicKey(JsonWriter& w, PublicKey const& pk, char const* name)
+{
+    w.writeString(name, KeyUtils::toStrKey(pk));
+}
+
+void
+writeSCAddress(JsonWriter& w, SCAddress const& addr, char const* name)
+{
+    switch (addr.type())
+    {
+    case SC_ADDRESS_TYPE_CONTRACT:
+        w.writeString(
+            name,
+            strKey::toStrKey(strKey::STRKEY_CONTRACT, addr.contractId()).value);
+        return;
+    case SC_ADDRESS_TYPE_ACCOUNT:
+        writePublicKey(w, addr.accountId(), name);
+        return;
+    default:
+        // this would be a bug
+        abort();
+    }
+}
+
+void
+writeConfigUpgradeSetKey(JsonWriter& w, ConfigUpgradeSetKey const& key,
+                         char const* name)
+{
+    w.startObject(name);
+    w.writeString(
+        "contractID",
+        strKey::toStrKey(strKey::STRKEY_CONTRACT, key.contractID).value);
+    w.writeString("contentHash", binToHex(key.contentHash));
+    w.endObject();
+}
+
+void
+writeMuxedAccount(JsonWriter& w, MuxedAccount const& account,
+                  char const* name)
+{
+    switch (account.type())
+    {
+    case KEY_TYPE_ED25519:
+        writePublicKey(w, toAccountID(account), name);
+        return;
+    case KEY_TYPE_MUXED_ED25519:
+        w.startObject(name);
+        w.writeUint("id", account.med25519().id);
+        writePublicKey(w, toAccountID(account), "accountID");
+        w.endObject();
+        return;
+    default:
+        // this would be a bug
+        abort();
+    }
+}
+
+void
+writePoolAsset(JsonWriter& w, Asset const& asset, char const* name)
+{
+    w.writeString(name, "INVALID");
+}
+
+void
+writePoolAsset(JsonWriter& w, TrustLineAsset const& asset, char const* name)
+{
+    w.writeString(name, binToHex(asset.liquidityPoolID()));
+}
+
+void
+writePoolAsset(JsonWriter& w, ChangeTrustAsset const& asset, char const* name)
+{
+    auto const& cp = asset.liquidityPool().constantProduct();
+    w.startObject(name);
+    writeAsset(w, cp.assetA, "assetA");
+    writeAsset(w, cp.assetB, "assetB");
+    w.writeInt("fee", cp.fee);
+    w.endObject();
+}
+}
+}
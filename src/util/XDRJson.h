@@ -0,0 +1,251 @@
+#pragma once
+
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "crypto/Hex.h"
+#include "util/types.h"
+#include "xdr/Stellar-ledger.h"
+#include <xdrpp/marshal.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace stellar
+{
+
+// Streaming JSON writer that appends straight to a string. It produces
+// exactly the text of cereal's JSONOutputArchive (a rapidjson PrettyWriter),
+// so that its output can replace xdrToCerealString's byte for byte: members
+// and elements on their own lines, indented by `indent` spaces per level
+// (newlines are kept when it is 0), and empty objects and arrays as {} and
+// []. Members without a name are named value0, value1, ... like cereal does.
+class JsonWriter
+{
+  public:
+    JsonWriter(std::string& out, unsigned indent);
+
+    void startObject(char const* name);
+    void endObject();
+    void startArray(char const* name);
+    void endArray();
+
+    void writeString(char const* name, std::string_view s);
+    void writeInt(char const* name, int64_t i);
+    void writeUint(char const* name, uint64_t u);
+    void writeNull(char const* name);
+
+  private:
+    struct Level
+    {
+        bool mInArray;
+        uint32_t mCount{0};
+        uint32_t mUnnamedCount{0};
+    };
+
+    // Writes what goes before a value: the separator, the indentation and,
+    // in an object, the member name
+    void prefix(char const* name);
+    void end(char close);
+    void indent();
+    void appendString(std::string_view s);
+
+    std::string& mOut;
+    unsigned const mIndent;
+    std::vector<Level> mLevels;
+};
+
+// xdrpp archive writing XDR values to a JsonWriter, in the format of the
+// cereal_overrides of XDRCereal.h: keys and contract addresses as strkeys,
+// opaque data as hex, enums by name, assets by code and issuer, and empty
+// optionals as null.
+struct XDRJsonArchive
+{
+    JsonWriter& mWriter;
+};
+
+namespace xdrjson
+{
+template <typename T> struct IsXString : std::false_type
+{
+};
+template <uint32_t N> struct IsXString<xdr::xstring<N>> : std::true_type
+{
+};
+
+template <typename T> struct IsPointer : std::false_type
+{
+};
+template <typename T> struct IsPointer<xdr::pointer<T>> : std::true_type
+{
+};
+
+void writePublicKey(JsonWriter& w, PublicKey const& pk, char const* name);
+void writeSCAddress(JsonWriter& w, SCAddress const& addr, char const* name);
+void writeConfigUpgradeSetKey(JsonWriter& w, ConfigUpgradeSetKey const& key,
+                              char const* name);
+void writeMuxedAccount(JsonWriter& w, MuxedAccount const& account,
+                       char const* name);
+void writePoolAsset(JsonWriter& w, Asset const& asset, char const* name);
+void writePoolAsset(JsonWriter& w, TrustLineAsset const& asset,
+                    char const* name);
+void writePoolAsset(JsonWriter& w, ChangeTrustAsset const& asset,
+                    char const* name);
+
+template <typename T>
+void
+writeAsset(JsonWriter& w, T const& asset, char const* name)
+{
+    switch (asset.type())
+    {
+    case ASSET_TYPE_NATIVE:
+        w.writeString(name, "NATIVE");
+        break;
+    case ASSET_TYPE_POOL_SHARE:
+        writePoolAsset(w, asset, name);
+        break;
+    case ASSET_TYPE_CREDIT_ALPHANUM4:
+    case ASSET_TYPE_CREDIT_ALPHANUM12:
+    {
+        std::string code;
+        if (asset.type() == ASSET_TYPE_CREDIT_ALPHANUM4)
+        {
+            assetCodeToStr(asset.alphaNum4().assetCode, code);
+        }
+        else
+        {
+            assetCodeToStr(asset.alphaNum12().assetCode, code);
+        }
+        w.startObject(name);
+        w.writeString("assetCode", code);
+        writePublicKey(w, getIssuer(asset), "issuer");
+        w.endObject();
+        break;
+    }
+    default:
+        w.writeString(name, "UNKNOWN");
+    }
+}
+}
+}
+
+namespace xdr
+{
+template <> struct archive_adapter<stellar::XDRJsonArchive>
+{
+    template <typename T>
+    static void
+    apply(stellar::XDRJsonArchive& ar, T const& t, char const* name)
+    {
+        using namespace stellar;
+        using U = std::decay_t<T>;
+        auto& w = ar.mWriter;
+        if constexpr (std::is_same_v<U, PublicKey>)
+        {
+            xdrjson::writePublicKey(w, t, name);
+        }
+        else if constexpr (std::is_same_v<U, SCAddress>)
+        {
+            xdrjson::writeSCAddress(w, t, name);
+        }
+        else if constexpr (std::is_same_v<U, ConfigUpgradeSetKey>)
+        {
+            xdrjson::writeConfigUpgradeSetKey(w, t, name);
+        }
+        else if constexpr (std::is_same_v<U, MuxedAccount>)
+        {
+            xdrjson::writeMuxedAccount(w, t, name);
+        }
+        else if constexpr (std::is_same_v<U, Asset> ||
+                           std::is_same_v<U, TrustLineAsset> ||
+                           std::is_same_v<U, ChangeTrustAsset>)
+        {
+            xdrjson::writeAsset(w, t, name);
+        }
+        else if constexpr (std::is_same_v<U, std::string> ||
+                           xdrjson::IsXString<U>::value)
+        {
+            w.writeString(name, t);
+        }
+        else if constexpr (xdr_traits<U>::is_bytes)
+        {
+            w.writeString(name, binToHex(ByteSlice(t.data(), t.size())));
+        }
+        else if constexpr (xdrjson::IsPointer<U>::value)
+        {
+            // Like XDRCereal.h, collapses *T into T and uses null for empty
+            if (t)
+            {
+                archive(ar, *t, name);
+            }
+            else
+            {
+                w.writeNull(name);
+            }
+        }
+        else if constexpr (xdr_traits<U>::is_enum)
+        {
+            // Includes bool, written as TRUE or FALSE
+            auto const np = xdr_traits<U>::enum_name(t);
+            w.writeString(name, np ? std::string(np) : std::to_string(t));
+        }
+        else if constexpr (xdr_traits<U>::is_container)
+        {
+            w.startArray(name);
+            for (auto const& element : t)
+            {
+                archive(ar, element);
+            }
+            w.endArray();
+        }
+        else if constexpr (xdr_traits<U>::is_class)
+        {
+            w.startObject(name);
+            xdr_traits<U>::save(ar, t);
+            w.endObject();
+        }
+        else if constexpr (std::is_signed_v<U>)
+        {
+            w.writeInt(name, t);
+        }
+        else
+        {
+            static_assert(std::is_unsigned_v<U>);
+            w.writeUint(name, t);
+        }
+    }
+};
+}
+
+namespace stellar
+{
+// Appends `t` to `out` as JSON, in the same format as xdrToCerealString,
+// without building the intermediate nodes and strings cereal does. If
+// compact = true, the output will not contain any indentation.
+template <typename T>
+void
+xdrToJson(T const& t, std::string const& name, std::string& out,
+          bool compact = false)
+{
+    // Opaque data doubles in size as hex, names and indentation add more
+    out.reserve(out.size() + 4 * xdr::xdr_size(t));
+    JsonWriter w(out, compact ? 0 : 4);
+    XDRJsonArchive ar{w};
+    w.startObject(nullptr);
+    xdr::archive(ar, t, name.c_str());
+    w.endObject();
+}
+
+template <typename T>
+std::string
+xdrToJson(T const& t, std::string const& name, bool compact = false)
+{
+    std::string out;
+    xdrToJson(t, name, out, compact);
+    return out;
+}
+}
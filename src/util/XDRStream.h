@@ -6,6 +6,7 @@
 
 #include "crypto/ByteSlice.h"
 #include "crypto/SHA.h"
+#include "util/BufferedFileReader.h"
 #include "util/FileSystemException.h"
 #include "util/Fs.h"
 #include "util/GlobalChecks.h"
@@ -14,8 +15,10 @@
 #include "xdrpp/marshal.h"
 #include <Tracy.hpp>
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <optional>
 #include <string>
 #include <vector>
 #ifdef _WIN32
@@ -28,17 +31,24 @@ namespace stellar
 /**
  * Helper for loading a sequence of XDR objects from a file one at a time,
  * rather than all at once.
+ *
+ * Records are decoded in place from a large aligned buffer (see
+ * BufferedFileReader) rather than copied out of the file one by one.
+ * Sequential streams, the default, read the next chunk of the file in the
+ * background; streams used for random lookups should turn that off.
  */
 class XDRInputFileStream
 {
-    std::ifstream mIn;
-    std::vector<char> mBuf;
+    BufferedFileReader mReader;
     size_t mSizeLimit;
-    size_t mSize;
+    // Set when a read hits the end of the file, like an ifstream's eofbit
+    bool mEof{false};
 
   public:
-    XDRInputFileStream(unsigned int sizeLimit = 0)
-        : mSizeLimit{sizeLimit}, mSize{0}
+    XDRInputFileStream(
+        unsigned int sizeLimit = 0, bool sequential = true,
+        size_t bufferSize = BufferedFileReader::DEFAULT_BUFFER_SIZE)
+        : mReader(bufferSize, sequential), mSizeLimit{sizeLimit}
     {
     }
 
@@ -46,25 +56,26 @@ class XDRInputFileStream
     close()
     {
         ZoneScoped;
-        mIn.close();
+        mReader.close();
     }
 
+    // See BufferedFileReader::open for `blocks`
     void
-    open(std::string const& filename)
+    open(std::string const& filename,
+         std::shared_ptr<BlockCompressedFile::Table const> blocks = nullptr)
     {
         ZoneScoped;
-        mIn.open(filename, std::ifstream::binary);
-        if (!mIn)
+        try
+        {
+            mReader.open(filename, std::move(blocks));
+        }
+        catch (FileSystemException const& e)
         {
-            std::string msg("failed to open XDR file: ");
-            msg += filename;
-            msg += ", reason: ";
-            msg += std::to_string(errno);
-            CLOG_ERROR(Fs, "{}", msg);
-            throw FileSystemException(msg);
+            CLOG_ERROR(Fs, "failed to open XDR file: {}, reason: {}",
+                       filename, e.what());
+            throw;
         }
-        mIn.exceptions(std::ios::badbit);
-        mSize = fs::size(mIn);
+        mEof = false;
     }
 
     void
@@ -75,31 +86,30 @@ class XDRInputFileStream
 
     operator bool() const
     {
-        return mIn.good();
+        return !mEof;
     }
 
     size_t
     size() const
     {
-        return mSize;
+        return mReader.size();
     }
 
     std::streamoff
     pos()
     {
-        releaseAssertOrThrow(!mIn.fail());
-        return mIn.tellg();
+        return static_cast<std::streamoff>(mReader.pos());
     }
 
     void
     seek(size_t pos)
     {
-        releaseAssertOrThrow(!mIn.fail());
-        mIn.seekg(pos);
+        mReader.seek(pos);
+        mEof = false;
     }
 
     static inline uint32_t
-    getXDRSize(char* buf)
+    getXDRSize(char const* buf)
     {
         // Read 4 bytes of size, big-endian, with XDR 'continuation' bit cleared
         // (high bit of high byte).
@@ -121,44 +131,30 @@ class XDRInputFileStream
     readOne(T& out, SHA256* hasher = nullptr)
     {
         ZoneScoped;
-        char szBuf[4];
-        if (!mIn.read(szBuf, 4))
-        {
-            // checks that there was no trailing data
-            if (mIn.eof() && mIn.gcount() == 0)
-            {
-                mIn.clear(std::ios_base::eofbit);
-                return false;
-            }
-            else
-            {
-                throw xdr::xdr_runtime_error("IO failure in readOne");
-            }
-        }
-
-        auto sz = getXDRSize(szBuf);
-        if (mSizeLimit != 0 && sz > mSizeLimit)
+        char const* body;
+        auto sz = nextRecord(body, hasher);
+        if (!sz)
         {
             return false;
         }
-        if (sz > mBuf.size())
-        {
-            mBuf.resize(sz);
-        }
-        if (!mIn.read(mBuf.data(), sz))
-        {
-            throw xdr::xdr_runtime_error(
-                "malformed XDR file or IO failure in readOne");
-        }
+        xdr::xdr_get g(body, body + *sz);
+        xdr::xdr_argpack_archive(g, out);
+        return true;
+    }
 
-        if (hasher)
+    // Reads the next record into `out` without decoding it, so that it can be
+    // decoded elsewhere (for example on another thread).
+    bool
+    readRaw(std::vector<char>& out)
+    {
+        ZoneScoped;
+        char const* body;
+        auto sz = nextRecord(body, nullptr);
+        if (!sz)
         {
-            hasher->add(ByteSlice(szBuf, sizeof(szBuf)));
-            hasher->add(ByteSlice(mBuf.data(), sz));
+            return false;
         }
-
-        xdr::xdr_get g(mBuf.data(), mBuf.data() + sz);
-        xdr::xdr_argpack_archive(g, out);
+        out.assign(body, body + *sz);
         return true;
     }
 
@@ -166,61 +162,106 @@ class XDRInputFileStream
     // variable `out`, until it has exceeded `pageSize` bytes or until it finds
     // an `out` value for which `getBucketLedgerKey(out) == key`. It returns
     // `true` if it located such a value, or false if it failed to find one.
+    // Only the page is read from the file (unless it's already buffered), not
+    // a whole buffer.
     template <typename T>
     bool
     readPage(T& out, LedgerKey const& key, size_t pageSize)
     {
-        ZoneScoped;
-        if (mBuf.size() != pageSize)
-        {
-            mBuf.resize(pageSize);
-        }
+        return scanPage(pageSize, [&](char const* body, size_t size) {
+            return decodeAndMatch(body, size, out, key);
+        });
+    }
+
+    // Same as `readPage`, but decodes the page starting at offset `pos` of an
+    // in-memory copy (e.g. a memory mapping) of the whole file, given by
+    // `data` and `size`. No bytes are copied out of `data` before decoding.
+    template <typename T>
+    static bool
+    readPageFromMemory(char const* data, size_t size, size_t pos, T& out,
+                       LedgerKey const& key, size_t pageSize)
+    {
+        return scanPageFromMemory(
+            data, size, pos, pageSize,
+            [&](char const* body, size_t sz) {
+                return decodeAndMatch(body, sz, out, key);
+            });
+    }
 
-        if (!mIn.read(mBuf.data(), pageSize))
+    // Calls `f(body, size)` on the XDR of each record starting within the next
+    // `pageSize` bytes of the stream, until it returns true, and returns
+    // whether it did. `body` points into the read buffer and is only valid
+    // during the call. Lets callers match records without decoding them.
+    template <typename F>
+    bool
+    scanPage(size_t pageSize, F&& f)
+    {
+        ZoneScoped;
+        auto avail = mReader.ensure(pageSize, /*greedy=*/false);
+        if (avail < pageSize)
         {
-            if (mIn.eof())
-            {
-                // Hitting eof just means there's not a full pageSize
-                // worth of data left in the file. Not a problem: resize our
-                // buffer down to the amount the page we _did_ manage to read.
-                mBuf.resize(mIn.gcount());
-                mIn.clear(std::ios_base::eofbit);
-            }
-            else
-            {
-                throw xdr::xdr_runtime_error("IO failure in readPage");
-            }
+            // Not a full pageSize worth of data left in the file, not a
+            // problem
+            mEof = true;
         }
+        size_t const pageEnd = std::min(avail, pageSize);
+        size_t consumed = pageEnd;
 
         size_t xdrStart = 0;
-        while (xdrStart + 4 <= mBuf.size())
+        bool found = false;
+        while (!found && xdrStart + 4 <= pageEnd)
         {
-            const uint32_t xdrSz = getXDRSize(mBuf.data() + xdrStart);
+            const uint32_t xdrSz = getXDRSize(mReader.data() + xdrStart);
             xdrStart += 4;
             const size_t xdrEnd = xdrStart + xdrSz;
 
-            // If entry continues past end of buffer, temporarily expand
-            // it and load the extra bytes. The buffer will be resized
-            // back to pageSize in the next readPage.
-            if (xdrEnd > mBuf.size())
+            // Entries that start in this page may continue past its end, they
+            // are still read in full.
+            if (xdrEnd > avail)
             {
-                const size_t extraStart = mBuf.size();
-                const size_t extraSz = xdrEnd - extraStart;
-                mBuf.resize(xdrEnd);
-                releaseAssert(extraStart + extraSz == mBuf.size());
-                if (!mIn.read(mBuf.data() + extraStart, extraSz))
+                avail = mReader.ensure(xdrEnd, /*greedy=*/false);
+                if (xdrEnd > avail)
                 {
                     throw xdr::xdr_runtime_error(
                         "malformed XDR file or IO failure in readPage");
                 }
             }
+            consumed = std::max(consumed, xdrEnd);
+
+            found = f(mReader.data() + xdrStart, size_t(xdrSz));
+            xdrStart = xdrEnd;
+        }
+
+        mReader.advance(consumed);
+        return found;
+    }
 
-            ZoneNamedN(__unpack, "xdr_unpack_entry", true);
-            releaseAssert(xdrStart <= xdrEnd);
-            releaseAssert(xdrEnd <= mBuf.size());
-            xdr::xdr_get g(mBuf.data() + xdrStart, mBuf.data() + xdrEnd);
-            xdr::xdr_argpack_archive(g, out);
-            if (getBucketLedgerKey(out) == key)
+    // Same as `scanPage`, over the page starting at offset `pos` of an
+    // in-memory copy of the whole file.
+    template <typename F>
+    static bool
+    scanPageFromMemory(char const* data, size_t size, size_t pos,
+                       size_t pageSize, F&& f)
+    {
+        ZoneScoped;
+        releaseAssertOrThrow(pos <= size);
+        size_t const pageEnd = std::min(size, pos + pageSize);
+        size_t xdrStart = pos;
+        while (xdrStart + 4 <= pageEnd)
+        {
+            const uint32_t xdrSz = getXDRSize(data + xdrStart);
+            xdrStart += 4;
+            const size_t xdrEnd = xdrStart + xdrSz;
+
+            // Entries that start in this page may continue past its end, they
+            // are still read in full.
+            if (xdrEnd > size)
+            {
+                throw xdr::xdr_runtime_error(
+                    "malformed XDR file in readPageFromMemory");
+            }
+
+            if (f(data + xdrStart, size_t(xdrSz)))
             {
                 return true;
             }
@@ -230,6 +271,59 @@ class XDRInputFileStream
 
         return false;
     }
+
+  private:
+    template <typename T>
+    static bool
+    decodeAndMatch(char const* body, size_t size, T& out, LedgerKey const& key)
+    {
+        ZoneNamedN(__unpack, "xdr_unpack_entry", true);
+        xdr::xdr_get g(body, body + size);
+        xdr::xdr_argpack_archive(g, out);
+        return getBucketLedgerKey(out) == key;
+    }
+
+    // Consumes the next record and points `body` at it in the read buffer,
+    // where it stays valid until the next read, and returns its size. Returns
+    // nullopt at the end of the stream or if the record exceeds the size
+    // limit.
+    std::optional<uint32_t>
+    nextRecord(char const*& body, SHA256* hasher)
+    {
+        auto avail = mReader.ensure(4);
+        if (avail < 4)
+        {
+            // checks that there was no trailing data
+            if (avail == 0)
+            {
+                mEof = true;
+                return std::nullopt;
+            }
+            throw xdr::xdr_runtime_error("IO failure in readOne");
+        }
+
+        auto sz = getXDRSize(mReader.data());
+        if (mSizeLimit != 0 && sz > mSizeLimit)
+        {
+            mReader.advance(4);
+            return std::nullopt;
+        }
+        size_t const recordSize = size_t(4) + sz;
+        if (mReader.ensure(recordSize) < recordSize)
+        {
+            throw xdr::xdr_runtime_error(
+                "malformed XDR file or IO failure in readOne");
+        }
+
+        auto record = mReader.data();
+        if (hasher)
+        {
+            hasher->add(ByteSlice(record, recordSize));
+        }
+        mReader.advance(recordSize);
+        body = record + 4;
+        return sz;
+    }
 };
 
 /*
@@ -299,6 +393,22 @@ class OutputFileStream
     close()
     {
         ZoneScoped;
+        closeInto(nullptr);
+    }
+
+    // Closes the stream without fsyncing it, leaving it to `group` to sync the
+    // file along with the group's other files, if the stream fsyncs on close.
+    void
+    close(fs::DurabilityGroup& group)
+    {
+        ZoneScoped;
+        closeInto(&group);
+    }
+
+  private:
+    void
+    closeInto(fs::DurabilityGroup* group)
+    {
         if (!isOpen())
         {
             FileSystemException::failWith(
@@ -307,7 +417,14 @@ class OutputFileStream
         flush();
         if (mFsyncOnClose)
         {
-            fs::flushFileChanges(getHandle());
+            if (group)
+            {
+                group->addFile(getHandle());
+            }
+            else
+            {
+                fs::flushFileChanges(getHandle());
+            }
         }
 #ifdef WIN32
         fclose(mOut);
@@ -317,6 +434,7 @@ class OutputFileStream
 #endif
     }
 
+  public:
     void
     fdopen(int fd)
     {
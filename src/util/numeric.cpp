@@ -9,8 +9,40 @@
 #include <algorithm>
 #include <stdexcept>
 
+#if defined(__SIZEOF_INT128__)
+#define STELLAR_NATIVE_UINT128 1
+#elif defined(_MSC_VER) && _MSC_VER >= 1920 && defined(_M_X64)
+#define STELLAR_MSVC_UINT128 1
+#include <intrin.h>
+#endif
+
+// uint128_t is the portable large_int type, whose division works bit by bit.
+// Where the compiler has 128 bit integers (or, for MSVC, 128 by 64 bit
+// multiplication and division intrinsics) the functions below use those
+// instead, and the portable versions are kept in numeric::portable for the
+// other compilers and to test against.
+
 namespace stellar
 {
+
+#ifdef STELLAR_NATIVE_UINT128
+namespace
+{
+using native_uint128 = unsigned __int128;
+
+native_uint128
+toNative(uint128_t const& x)
+{
+    return (native_uint128(uint64_t(x >> 64)) << 64) | uint64_t(x);
+}
+
+uint128_t
+fromNative(native_uint128 x)
+{
+    return (uint128_t(uint64_t(x >> 64)) << 64) | uint128_t(uint64_t(x));
+}
+}
+#endif
 // calculates A*B/C when A*B overflows 64bits
 bool
 bigDivide(int64_t& result, int64_t A, int64_t B, int64_t C, Rounding rounding)
@@ -28,6 +60,8 @@ bigDivide(int64_t& result, int64_t A, int64_t B, int64_t C, Rounding rounding)
     return res;
 }
 
+namespace numeric::portable
+{
 bool
 bigDivideUnsigned(uint64_t& result, uint64_t A, uint64_t B, uint64_t C,
                   Rounding rounding)
@@ -43,6 +77,46 @@ bigDivideUnsigned(uint64_t& result, uint64_t A, uint64_t B, uint64_t C,
     result = (uint64_t)x;
     return (x <= UINT64_MAX);
 }
+}
+
+bool
+bigDivideUnsigned(uint64_t& result, uint64_t A, uint64_t B, uint64_t C,
+                  Rounding rounding)
+{
+#if defined(STELLAR_NATIVE_UINT128)
+    releaseAssertOrThrow(C > 0);
+
+    // A * B + C - 1 <= UINT64_MAX * UINT64_MAX + UINT64_MAX < 2^128
+    native_uint128 x = native_uint128(A) * B;
+    x = rounding == ROUND_DOWN ? x / C : (x + C - 1u) / C;
+
+    result = (uint64_t)x;
+    return (x <= UINT64_MAX);
+#elif defined(STELLAR_MSVC_UINT128)
+    releaseAssertOrThrow(C > 0);
+
+    uint64_t hi;
+    uint64_t lo = _umul128(A, B, &hi);
+    if (rounding == ROUND_UP)
+    {
+        uint64_t prev = lo;
+        lo += C - 1;
+        hi += lo < prev;
+    }
+    // _udiv128 faults when the quotient doesn't fit, leave that case and
+    // its truncated result to the portable version
+    if (hi >= C)
+    {
+        return numeric::portable::bigDivideUnsigned(result, A, B, C,
+                                                    rounding);
+    }
+    uint64_t remainder;
+    result = _udiv128(hi, lo, C, &remainder);
+    return true;
+#else
+    return numeric::portable::bigDivideUnsigned(result, A, B, C, rounding);
+#endif
+}
 
 int64_t
 bigDivideOrThrow(int64_t A, int64_t B, int64_t C, Rounding rounding)
@@ -70,6 +144,8 @@ bigDivide128(int64_t& result, uint128_t const& a, int64_t B, Rounding rounding)
     return res;
 }
 
+namespace numeric::portable
+{
 bool
 bigDivideUnsigned128(uint64_t& result, uint128_t const& a, uint64_t B,
                      Rounding rounding)
@@ -103,6 +179,53 @@ bigDivideUnsigned128(uint64_t& result, uint128_t const& a, uint64_t B,
 
     return (x <= UINT64_MAX);
 }
+}
+
+bool
+bigDivideUnsigned128(uint64_t& result, uint128_t const& a, uint64_t B,
+                     Rounding rounding)
+{
+#if defined(STELLAR_NATIVE_UINT128)
+    releaseAssertOrThrow(B != 0);
+
+    // See the portable version for the overflow check
+    native_uint128 x = toNative(a);
+    if ((rounding == ROUND_UP) && (x > ~native_uint128(0) - (B - 1u)))
+    {
+        return false;
+    }
+    x = rounding == ROUND_DOWN ? x / B : (x + B - 1u) / B;
+
+    result = (uint64_t)x;
+    return (x <= UINT64_MAX);
+#elif defined(STELLAR_MSVC_UINT128)
+    releaseAssertOrThrow(B != 0);
+
+    uint64_t hi = uint64_t(a >> 64);
+    uint64_t lo = uint64_t(a);
+    if (rounding == ROUND_UP)
+    {
+        uint64_t prev = lo;
+        lo += B - 1;
+        hi += lo < prev;
+        // a + B - 1 overflowed
+        if (hi == 0 && lo < prev)
+        {
+            return false;
+        }
+    }
+    if (hi >= B)
+    {
+        return numeric::portable::bigDivideUnsigned128(result, a, B,
+                                                       rounding);
+    }
+    uint64_t remainder;
+    result = _udiv128(hi, lo, B, &remainder);
+    return true;
+#else
+    return numeric::portable::bigDivideUnsigned128(result, a, B, rounding);
+#endif
+}
 
 int64_t
 bigDivideOrThrow128(uint128_t const& a, int64_t B, Rounding rounding)
@@ -115,6 +238,8 @@ bigDivideOrThrow128(uint128_t const& a, int64_t B, Rounding rounding)
     return res;
 }
 
+namespace numeric::portable
+{
 uint128_t
 bigMultiplyUnsigned(uint64_t a, uint64_t b)
 {
@@ -122,6 +247,21 @@ bigMultiplyUnsigned(uint64_t a, uint64_t b)
     uint128_t B(b);
     return A * B;
 }
+}
+
+uint128_t
+bigMultiplyUnsigned(uint64_t a, uint64_t b)
+{
+#if defined(STELLAR_NATIVE_UINT128)
+    return fromNative(native_uint128(a) * b);
+#elif defined(STELLAR_MSVC_UINT128)
+    uint64_t hi;
+    uint64_t lo = _umul128(a, b, &hi);
+    return (uint128_t(hi) << 64) | uint128_t(lo);
+#else
+    return numeric::portable::bigMultiplyUnsigned(a, b);
+#endif
+}
 
 uint128_t
 bigMultiply(int64_t a, int64_t b)
@@ -282,6 +422,8 @@ bigSquareRoot(uint64_t a, uint64_t b)
     return sqrtCeil - 1;
 }
 
+namespace numeric::portable
+{
 bool
 hugeDivide(int64_t& result, int32_t a, uint128_t const& B, uint128_t const& C,
            Rounding rounding)
@@ -330,6 +472,43 @@ hugeDivide(int64_t& result, int32_t a, uint128_t const& B, uint128_t const& C,
     }
     return false;
 }
+}
+
+bool
+hugeDivide(int64_t& result, int32_t a, uint128_t const& B, uint128_t const& C,
+           Rounding rounding)
+{
+#if defined(STELLAR_NATIVE_UINT128)
+    native_uint128 constexpr i32_max((uint32_t)INT32_MAX);
+    native_uint128 constexpr i64_max((uint64_t)INT64_MAX);
+
+    native_uint128 b = toNative(B);
+    native_uint128 c = toNative(C);
+    releaseAssertOrThrow(a >= 0);
+    releaseAssertOrThrow(c != 0);
+    releaseAssertOrThrow(c <= i32_max * i64_max);
+
+    // See the portable version for why none of this overflows
+    native_uint128 q = b / c;
+    native_uint128 r = b % c;
+    if (q > i64_max)
+    {
+        return false;
+    }
+    native_uint128 A((uint32_t)a);
+    native_uint128 res = (rounding == ROUND_DOWN)
+                             ? A * q + A * r / c
+                             : A * q + (A * r + c - 1u) / c;
+    if (res <= i64_max)
+    {
+        result = (int64_t)res;
+        return true;
+    }
+    return false;
+#else
+    return numeric::portable::hugeDivide(result, a, B, C, rounding);
+#endif
+}
 
 uint32_t
 doubleToClampedUint32(double d)
@@ -21,4 +21,18 @@ uint128_t bigMultiply(int64_t a, int64_t b);
 // Compute a * B / C when C < INT32_MAX * INT64_MAX.
 bool hugeDivide(int64_t& result, int32_t a, uint128_t const& B,
                 uint128_t const& C, Rounding rounding);
+
+// Versions of the functions above that only use the portable uint128_t. The
+// functions above use the compiler's 128 bit integers instead where it has
+// them, with the same results.
+namespace numeric::portable
+{
+bool bigDivideUnsigned(uint64_t& result, uint64_t A, uint64_t B, uint64_t C,
+                       Rounding rounding);
+bool bigDivideUnsigned128(uint64_t& result, uint128_t const& a, uint64_t B,
+                          Rounding rounding);
+uint128_t bigMultiplyUnsigned(uint64_t a, uint64_t b);
+bool hugeDivide(int64_t& result, int32_t a, uint128_t const& B,
+                uint128_t const& C, Rounding rounding);
+}
 }
@@ -0,0 +1,46 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/BackgroundWorkQueue.h"
+
+#include "medida/counter.h"
+#include "medida/metrics_registry.h"
+#include "medida/timer.h"
+#include "test/Catch2.h"
+#include <vector>
+
+using namespace stellar;
+
+TEST_CASE("background work runs most urgent class first", "[backgroundwork]")
+{
+    asio::io_context ioContext;
+    medida::MetricsRegistry metrics;
+    BackgroundWorkQueue queue(ioContext, metrics);
+
+    std::vector<std::string> ran;
+    auto post = [&](BackgroundWorkClass cls, std::string name) {
+        queue.post(cls, [&ran, name]() { ran.emplace_back(name); });
+    };
+    post(BackgroundWorkClass::PUBLISH, "publish");
+    post(BackgroundWorkClass::ARCHIVE_MERGE, "archive-merge");
+    post(BackgroundWorkClass::MERGE, "merge-1");
+    post(BackgroundWorkClass::SCP, "scp");
+    post(BackgroundWorkClass::MERGE, "merge-2");
+    post(BackgroundWorkClass::APPLY, "apply");
+    // Posted straight to the io_context, so not reordered
+    asio::post(ioContext, [&ran]() { ran.emplace_back("direct"); });
+
+    REQUIRE(queue.size(BackgroundWorkClass::MERGE) == 2);
+    REQUIRE(metrics.NewCounter({"app", "background-merge", "queue"}).count() ==
+            2);
+
+    ioContext.run();
+    REQUIRE(ran == std::vector<std::string>{"apply", "scp", "merge-1",
+                                            "merge-2", "archive-merge",
+                                            "publish", "direct"});
+    REQUIRE(queue.size(BackgroundWorkClass::MERGE) == 0);
+    REQUIRE(metrics.NewCounter({"app", "background-merge", "queue"}).count() ==
+            0);
+    REQUIRE(metrics.NewTimer({"app", "background-merge", "cpu"}).count() == 2);
+}
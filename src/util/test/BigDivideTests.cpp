@@ -3,8 +3,10 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "test/Catch2.h"
+#include "util/Math.h"
 #include "util/numeric128.h"
 #include "util/types.h"
+#include <algorithm>
 #include <functional>
 
 using namespace stellar;
@@ -499,3 +501,64 @@ TEST_CASE("huge divide", "[bigdivide]")
         checkHugeFail(1 << 29, UINT128_MAX, maxC, ROUND_UP);
     }
 }
+
+TEST_CASE("128 bit fast paths match the portable versions", "[bigdivide]")
+{
+    // Mostly values near the edges, where rounding and overflow happen
+    auto value = []() -> uint64_t {
+        switch (rand_uniform(0, 4))
+        {
+        case 0:
+            return rand_uniform<uint64_t>(0, 100);
+        case 1:
+            return UINT64_MAX - rand_uniform<uint64_t>(0, 100);
+        case 2:
+            return INT64_MAX - rand_uniform<uint64_t>(0, 100);
+        case 3:
+            return rand_uniform<uint64_t>(0, UINT64_MAX) >>
+                   rand_uniform(0, 63);
+        default:
+            return rand_uniform<uint64_t>(0, UINT64_MAX);
+        }
+    };
+    uint128_t const maxC =
+        uint128_t((uint32_t)INT32_MAX) * uint128_t((uint64_t)INT64_MAX);
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        uint64_t A = value();
+        uint64_t B = value();
+        uint64_t C = std::max<uint64_t>(value(), 1);
+        uint128_t a = (uint128_t(value()) << 64) | uint128_t(value());
+        uint128_t c = std::min(
+            std::max((uint128_t(value() >> 33) << 64) | uint128_t(value()),
+                     uint128_t(1u)),
+            maxC);
+        int32_t x = static_cast<int32_t>(rand_uniform<int64_t>(0, INT32_MAX));
+
+        REQUIRE(bigMultiplyUnsigned(A, B) ==
+                numeric::portable::bigMultiplyUnsigned(A, B));
+        for (auto rounding : {ROUND_DOWN, ROUND_UP})
+        {
+            uint64_t fast = 0;
+            uint64_t portable = 0;
+            REQUIRE(bigDivideUnsigned(fast, A, B, C, rounding) ==
+                    numeric::portable::bigDivideUnsigned(portable, A, B, C,
+                                                         rounding));
+            REQUIRE(fast == portable);
+
+            fast = portable = 0;
+            REQUIRE(bigDivideUnsigned128(fast, a, C, rounding) ==
+                    numeric::portable::bigDivideUnsigned128(portable, a, C,
+                                                            rounding));
+            REQUIRE(fast == portable);
+
+            int64_t fastHuge = 0;
+            int64_t portableHuge = 0;
+            REQUIRE(hugeDivide(fastHuge, x, a, c, rounding) ==
+                    numeric::portable::hugeDivide(portableHuge, x, a, c,
+                                                  rounding));
+            REQUIRE(fastHuge == portableHuge);
+        }
+    }
+}
@@ -134,4 +134,73 @@ TEST_CASE("binary fuse filter", "[BinaryFuseFilter][!hide]")
         // The actual false positive rate is 1/ 4 billion
         testFilter<BinaryFuseFilter32>(0);
     }
-}
\ No newline at end of file
+}
+
+template <class FilterT>
+void
+testBatchedLookups()
+{
+    LedgerKeySet keys;
+    while (keys.size() < 10'000)
+    {
+        keys.insert(ledgerKeyGenerator());
+    }
+
+    auto seed = shortHash::getShortHashInitKey();
+    std::vector<uint64_t> hashes;
+    for (auto const& k : keys)
+    {
+        auto keyBuf = xdr::xdr_to_opaque(k);
+        SipHash24 hasher(seed.data());
+        hasher.update(keyBuf.data(), keyBuf.size());
+        hashes.emplace_back(hasher.digest());
+    }
+    FilterT filter(hashes, seed);
+
+    // Mix keys in the filter with random keys, in a batch size that is not a
+    // multiple of the probing group size
+    std::vector<LedgerKey> probes(keys.begin(), keys.end());
+    for (size_t i = 0; i < 10'003; ++i)
+    {
+        probes.emplace_back(ledgerKeyGenerator());
+    }
+
+    std::vector<uint64_t> probeHashes;
+    for (auto const& k : probes)
+    {
+        probeHashes.emplace_back(filter.hashKey(k));
+    }
+
+    std::vector<bool> result;
+    filter.containsHashes(probeHashes, result);
+    REQUIRE(result.size() == probes.size());
+    for (size_t i = 0; i < probes.size(); ++i)
+    {
+        REQUIRE(result[i] == filter.contains(probes[i]));
+        if (i < keys.size())
+        {
+            REQUIRE(result[i]);
+        }
+    }
+
+    filter.containsHashes({}, result);
+    REQUIRE(result.empty());
+}
+
+TEST_CASE("binary fuse filter batched lookups", "[BinaryFuseFilter]")
+{
+    SECTION("8 bit")
+    {
+        testBatchedLookups<BinaryFuseFilter8>();
+    }
+
+    SECTION("16 bit")
+    {
+        testBatchedLookups<BinaryFuseFilter16>();
+    }
+
+    SECTION("32 bit")
+    {
+        testBatchedLookups<BinaryFuseFilter32>();
+    }
+}
@@ -0,0 +1,135 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#ifdef USE_ZLIB
+
+#include "ledger/test/LedgerTestUtils.h"
+#include "test/Catch2.h"
+#include "test/test.h"
+#include "util/BlockCompressedFile.h"
+#include "util/Fs.h"
+#include "util/TmpDir.h"
+#include "util/XDRStream.h"
+#include <fstream>
+
+using namespace stellar;
+
+TEST_CASE("block-compressed files read as the original", "[xdrstream]")
+{
+    VirtualClock clock;
+    TmpDir tmp("blockcompressed");
+    auto rawFilename = tmp.getName() + "/entries.xdr";
+    auto filename = tmp.getName() + "/entries.xdr.bkz";
+
+    auto ledgerEntries = LedgerTestUtils::generateValidLedgerEntries(2000);
+    auto bucketEntries =
+        LiveBucket::convertToBucketEntry(false, {}, ledgerEntries, {});
+    std::vector<size_t> offsets;
+    {
+        XDROutputFileStream out(clock.getIOContext(), /*doFsync=*/false);
+        out.open(rawFilename);
+        size_t bytes = 0;
+        for (auto const& e : bucketEntries)
+        {
+            offsets.emplace_back(bytes);
+            out.writeOne(e, nullptr, &bytes);
+        }
+        out.close();
+    }
+    std::string raw;
+    {
+        std::ifstream in(rawFilename, std::ifstream::binary);
+        raw.assign(std::istreambuf_iterator<char>(in),
+                   std::istreambuf_iterator<char>());
+    }
+
+    // Blocks of a few entries each, so that most reads span blocks
+    {
+        BlockCompressedFile::Writer out(clock.getIOContext(),
+                                        /*fsyncOnClose=*/false);
+        out.open(filename);
+        for (size_t i = 0; i < offsets.size(); ++i)
+        {
+            if (i % 7 == 0)
+            {
+                out.endBlock();
+            }
+            auto end = i + 1 < offsets.size() ? offsets[i + 1] : raw.size();
+            out.write(raw.data() + offsets[i], end - offsets[i]);
+        }
+        out.close();
+    }
+
+    REQUIRE(!BlockCompressedFile::readTable(rawFilename));
+    auto table = BlockCompressedFile::readTable(filename);
+    REQUIRE(table);
+    REQUIRE(table->numBlocks() == (offsets.size() + 6) / 7);
+    REQUIRE(table->rawSize == raw.size());
+    REQUIRE(BlockCompressedFile::originalSize(filename) == raw.size());
+    REQUIRE(fs::size(filename) < raw.size());
+
+    SECTION("raw bytes")
+    {
+        BufferedFileReader in(8192, /*sequential=*/true);
+        in.open(filename);
+        REQUIRE(in.size() == raw.size());
+        std::string read;
+        while (auto n = in.ensure(1))
+        {
+            read.append(in.data(), n);
+            in.advance(n);
+        }
+        REQUIRE(read == raw);
+    }
+
+    SECTION("entries")
+    {
+        for (bool passTable : {true, false})
+        {
+            XDRInputFileStream in(0, /*sequential=*/false, 8192);
+            in.open(filename, passTable ? table : nullptr);
+            REQUIRE(in.size() == raw.size());
+            BucketEntry be;
+            for (size_t i = 0; i < bucketEntries.size(); ++i)
+            {
+                REQUIRE(static_cast<size_t>(in.pos()) == offsets[i]);
+                REQUIRE(in.readOne(be));
+                REQUIRE(be == bucketEntries[i]);
+            }
+            REQUIRE(!in.readOne(be));
+
+            for (size_t i : {size_t(1500), size_t(3), size_t(1999),
+                             size_t(0), size_t(1000)})
+            {
+                in.seek(offsets[i]);
+                REQUIRE(in.readOne(be));
+                REQUIRE(be == bucketEntries[i]);
+            }
+
+            auto key = getBucketLedgerKey(bucketEntries[1234]);
+            in.seek(offsets[1200]);
+            REQUIRE(in.readPage(be, key, offsets[1235] - offsets[1200]));
+            REQUIRE(be == bucketEntries[1234]);
+        }
+    }
+
+    SECTION("malformed")
+    {
+        // Truncating the directory is detected on open
+        std::string stored;
+        {
+            std::ifstream in(filename, std::ifstream::binary);
+            stored.assign(std::istreambuf_iterator<char>(in),
+                          std::istreambuf_iterator<char>());
+        }
+        {
+            std::ofstream out(filename, std::ofstream::binary);
+            out.write(stored.data(), stored.size() - 1);
+        }
+        XDRInputFileStream in;
+        REQUIRE_THROWS(in.open(filename));
+    }
+}
+
+#endif
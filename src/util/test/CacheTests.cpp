@@ -3,9 +3,13 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "test/Catch2.h"
+#include "util/FrequencySketch.h"
 #include "util/RandomEvictionCache.h"
+#include "util/ShardedRandomEvictionCache.h"
+#include <atomic>
 #include <ctime>
 #include <map>
+#include <thread>
 
 using namespace stellar;
 
@@ -151,6 +155,81 @@ TEST_CASE("RandomEvictionCache does not thrash",
     REQUIRE(ctrs.mEvicts < 11);
 }
 
+TEST_CASE("FrequencySketch counts and ages", "[cache][frequencysketch]")
+{
+    size_t capacity = 16;
+    FrequencySketch sketch(capacity);
+    uint64_t const key = std::hash<size_t>{}(42);
+    REQUIRE(sketch.frequency(key) == 0);
+
+    for (size_t i = 1; i <= 20; ++i)
+    {
+        sketch.increment(key);
+        REQUIRE(sketch.frequency(key) == std::min<size_t>(i, 15));
+    }
+
+    // The sketch halves every counter once it has seen 10x capacity accesses
+    for (size_t i = 20; i < 10 * capacity; ++i)
+    {
+        sketch.increment(std::hash<size_t>{}(1000 + i));
+    }
+    REQUIRE(sketch.frequency(key) <= 7);
+    REQUIRE(sketch.frequency(key) > 0);
+}
+
+TEST_CASE("RandomEvictionCache frequency admission resists scans",
+          "[cache][frequencysketch]")
+{
+    size_t sz = 100;
+    RandomEvictionCache<size_t, size_t> cache(sz);
+    FrequencySketch sketch(sz);
+    auto const& ctrs = cache.getCounters();
+
+    auto access = [&](size_t k) {
+        sketch.increment(std::hash<size_t>{}(k));
+        if (!cache.maybeGet(k))
+        {
+            auto freq = sketch.frequency(std::hash<size_t>{}(k));
+            cache.put(k, k, [&](size_t const& victim) {
+                return freq > sketch.frequency(std::hash<size_t>{}(victim));
+            });
+        }
+    };
+
+    // Warm the cache with a hot working set
+    for (size_t round = 0; round < 4; ++round)
+    {
+        for (size_t i = 0; i < sz; ++i)
+        {
+            access(i);
+        }
+    }
+    REQUIRE(cache.size() == sz);
+    REQUIRE(ctrs.mEvicts == 0);
+
+    // A one-off scan over many cold keys should not displace the hot set
+    for (size_t i = 0; i < 5 * sz; ++i)
+    {
+        access(1000 + i);
+    }
+
+    size_t hotKeysLeft = 0;
+    for (size_t i = 0; i < sz; ++i)
+    {
+        if (cache.exists(i, /*countMisses=*/false))
+        {
+            ++hotKeysLeft;
+        }
+    }
+    REQUIRE(hotKeysLeft >= 90 * sz / 100);
+    REQUIRE(ctrs.mRejects >= 4 * sz);
+    REQUIRE(cache.size() == sz);
+
+    // Updating a key that is already cached bypasses admission
+    REQUIRE(cache.put(0, 7, [](size_t const&) { return false; }));
+    REQUIRE(cache.get(0) == 7);
+}
+
 using RandCache = RandomEvictionCache<int, int>;
 
 TEMPLATE_TEST_CASE("cache empty", "[cache][template]", RandCache)
@@ -319,3 +398,110 @@ TEMPLATE_TEST_CASE("cache erase_if removes all nodes", "[cache][template]",
     REQUIRE(!c.exists(3));
     REQUIRE(!c.exists(4));
 }
+
+TEST_CASE("sharded cache limits entries and bytes", "[cache][sharded]")
+{
+    SECTION("entries")
+    {
+        size_t sz = 10'000;
+        ShardedRandomEvictionCache<size_t, size_t> cache(sz);
+        for (size_t i = 0; i < 2 * sz; ++i)
+        {
+            cache.put(i, i);
+        }
+        REQUIRE(cache.size() == sz);
+
+        size_t existing = 0;
+        for (size_t i = 0; i < 2 * sz; ++i)
+        {
+            if (auto v = cache.maybeGet(i))
+            {
+                REQUIRE(*v == i);
+                ++existing;
+            }
+        }
+        REQUIRE(existing == sz);
+
+        auto ctrs = cache.getCounters();
+        REQUIRE(ctrs.mInserts == 2 * sz);
+        REQUIRE(ctrs.mEvicts == sz);
+        REQUIRE(ctrs.mHits == sz);
+        REQUIRE(ctrs.mMisses == sz);
+    }
+
+    SECTION("bytes")
+    {
+        ShardedRandomEvictionCache<int, int> cache(
+            1000, 100, [](int const&, int const& v) { return size_t(v); });
+        for (int i = 0; i < 100; ++i)
+        {
+            cache.put(i, 10);
+        }
+        REQUIRE(cache.size() == 10);
+        REQUIRE(cache.bytes() == 100);
+
+        // Updates are charged for their new size
+        int k = 0;
+        while (!cache.exists(k, false))
+        {
+            ++k;
+        }
+        cache.put(k, 1);
+        REQUIRE(cache.bytes() == 91);
+
+        cache.erase_if([](int const& v) { return v == 10; });
+        REQUIRE(cache.size() == 1);
+        REQUIRE(cache.bytes() == 1);
+        cache.clear();
+        REQUIRE(cache.size() == 0);
+        REQUIRE(cache.bytes() == 0);
+    }
+
+    SECTION("admission")
+    {
+        ShardedRandomEvictionCache<int, int> cache(5);
+        for (int i = 0; i < 5; ++i)
+        {
+            cache.put(i, i);
+        }
+        REQUIRE(!cache.put(5, 5, [](int const&) { return false; }));
+        REQUIRE(cache.getCounters().mRejects == 1);
+        REQUIRE(cache.put(5, 5, [](int const&) { return true; }));
+        REQUIRE(cache.size() == 5);
+        REQUIRE(cache.exists(5));
+    }
+}
+
+TEST_CASE("sharded cache is thread safe", "[cache][sharded]")
+{
+    size_t sz = 10'000;
+    ShardedRandomEvictionCache<size_t, size_t> cache(sz);
+    // Catch2 assertions are not thread safe
+    std::atomic<bool> allValid{true};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&cache, &allValid, t, sz]() {
+            for (size_t i = 0; i < 10 * sz; ++i)
+            {
+                auto k = (i * 7 + t) % (4 * sz);
+                if (auto v = cache.maybeGet(k))
+                {
+                    allValid = allValid && *v == k;
+                }
+                else
+                {
+                    cache.put(k, k);
+                }
+            }
+        });
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+    REQUIRE(allValid);
+    // Concurrent puts may each evict an entry to make room
+    REQUIRE(cache.size() <= sz);
+    REQUIRE(cache.size() > sz / 2);
+}
@@ -3,10 +3,12 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "util/Decoder.h"
+#include "util/Logging.h"
 #include "util/Math.h"
 #include <lib/util/basen.h>
 
 #include <autocheck/autocheck.hpp>
+#include <chrono>
 #include <lib/catch.hpp>
 #include <map>
 
@@ -189,3 +191,71 @@ TEST_CASE("base64 rust identity", "[decoder]")
         REQUIRE(cpp_decoded == rust_decoded);
     }
 }
+
+TEST_CASE("base64 blocks match the generic codec", "[decoder]")
+{
+    // Long enough inputs for the block paths, with damage (padding,
+    // whitespace, other characters) anywhere in them
+    for (int s = 0; s < 1000; s++)
+    {
+        std::vector<uint8_t> in(rand_uniform<size_t>(0, 300));
+        for (auto& b : in)
+        {
+            b = static_cast<uint8_t>(rand_uniform<int>(0, 255));
+        }
+        std::string generic;
+        bn::encode_b64(in.begin(), in.end(), std::back_inserter(generic));
+        auto encoded = decoder::encode_b64(in);
+        REQUIRE(encoded == generic);
+
+        std::vector<uint8_t> decoded;
+        decoder::decode_b64(encoded, decoded);
+        REQUIRE(decoded == in);
+
+        if (!encoded.empty() && rand_flip())
+        {
+            auto i = rand_uniform<size_t>(0, encoded.size() - 1);
+            encoded[i] = rand_element(std::vector<char>{'=', '\n', ' ', '-',
+                                                        '\0', '\xff'});
+        }
+        std::vector<uint8_t> genericDecoded;
+        bn::decode_b64(encoded.begin(), encoded.end(),
+                       std::back_inserter(genericDecoded));
+        decoder::decode_b64(encoded, decoded);
+        REQUIRE(decoded == genericDecoded);
+    }
+}
+
+TEST_CASE("base64 bench", "[!hide][b64-bench]")
+{
+    size_t const n = 10000;
+    // About the size of a transaction envelope
+    std::vector<uint8_t> in(400);
+    for (auto& b : in)
+    {
+        b = static_cast<uint8_t>(rand_uniform<int>(0, 255));
+    }
+    std::string encoded;
+    std::vector<uint8_t> decoded;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; ++i)
+    {
+        encoded = decoder::encode_b64(in);
+        decoder::decode_b64(encoded, decoded);
+    }
+    auto step1 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; ++i)
+    {
+        encoded.clear();
+        bn::encode_b64(in.begin(), in.end(), std::back_inserter(encoded));
+        decoded.clear();
+        bn::decode_b64(encoded.begin(), encoded.end(),
+                       std::back_inserter(decoded));
+    }
+    auto step2 = std::chrono::steady_clock::now();
+    REQUIRE(decoded == in);
+    LOG_INFO(DEFAULT_LOG, "base64 round trip of {} bytes: {} per iteration",
+             in.size(), (step1 - start) / n);
+    LOG_INFO(DEFAULT_LOG, "generic base64 round trip: {} per iteration",
+             (step2 - step1) / n);
+}
@@ -43,6 +43,53 @@ TEST_CASE("filesystem durable rename", "[fs]")
     REQUIRE(fs::exists(fileB.string()));
 }
 
+TEST_CASE("filesystem durability group", "[fs]")
+{
+    TmpDir tmp("fstests");
+    stdfs::path root(tmp.getName());
+    stdfs::path sub = root / "sub";
+    fs::mkdir(sub.string());
+
+    for (bool enabled : {true, false})
+    {
+        std::vector<std::pair<stdfs::path, stdfs::path>> renames = {
+            {root / "a.tmp", root / "a.txt"},
+            {root / "b.tmp", root / "b.txt"},
+            {root / "c.tmp", sub / "c.txt"}};
+        fs::DurabilityGroup group(enabled);
+        for (auto const& [src, dst] : renames)
+        {
+            {
+                std::ofstream out(src.string());
+                out << src.filename().string();
+            }
+            // The group keeps its own handle on the file
+            auto h = fs::openFileToWrite(src.string());
+            group.addFile(h);
+            fs::closeHandle(h);
+        }
+        for (auto const& [src, dst] : renames)
+        {
+            REQUIRE(group.rename(src.string(), dst.string(),
+                                 dst.parent_path().string()));
+            REQUIRE(!fs::exists(src.string()));
+            REQUIRE(fs::exists(dst.string()));
+        }
+        REQUIRE(!group.rename((root / "missing").string(),
+                              (root / "other").string(), root.string()));
+        group.commit();
+
+        for (auto const& [src, dst] : renames)
+        {
+            std::ifstream in(dst.string());
+            std::string content;
+            in >> content;
+            REQUIRE(content == src.filename().string());
+            stdfs::remove(dst);
+        }
+    }
+}
+
 TEST_CASE("filesystem findfiles", "[fs]")
 {
     TmpDir tmp("fstests");
@@ -0,0 +1,86 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#ifdef USE_ZLIB
+
+#include "test/Catch2.h"
+#include "util/GunzipStream.h"
+#include <algorithm>
+#include <string>
+#include <zlib.h>
+
+using namespace stellar;
+
+namespace
+{
+std::string
+gzip(std::string const& data)
+{
+    z_stream strm{};
+    REQUIRE(deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+                         Z_DEFAULT_STRATEGY) == Z_OK);
+    std::string out(deflateBound(&strm, data.size()), '\0');
+    strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    strm.avail_in = static_cast<uInt>(data.size());
+    strm.next_out = reinterpret_cast<Bytef*>(out.data());
+    strm.avail_out = static_cast<uInt>(out.size());
+    REQUIRE(deflate(&strm, Z_FINISH) == Z_STREAM_END);
+    out.resize(strm.total_out);
+    deflateEnd(&strm);
+    return out;
+}
+
+std::string
+gunzip(std::string const& gz, size_t step)
+{
+    std::string out;
+    GunzipStream stream(
+        [&](char const* data, size_t size) { out.append(data, size); });
+    for (size_t i = 0; i < gz.size(); i += step)
+    {
+        stream.add(gz.data() + i, std::min(step, gz.size() - i));
+    }
+    stream.finish();
+    REQUIRE(stream.getDecompressedSize() == out.size());
+    return out;
+}
+}
+
+TEST_CASE("gunzip stream", "[gunzip]")
+{
+    std::string data;
+    for (size_t i = 0; data.size() < 2 * 1024 * 1024; ++i)
+    {
+        data += std::to_string(i * 7919) + ",";
+    }
+    auto gz = gzip(data);
+
+    SECTION("any split of the input")
+    {
+        for (size_t step :
+             {size_t(1), size_t(13), size_t(64 * 1024), gz.size()})
+        {
+            REQUIRE(gunzip(gz, step) == data);
+        }
+    }
+    SECTION("concatenated members")
+    {
+        REQUIRE(gunzip(gz + gzip("tail"), 4096) == data + "tail");
+    }
+    SECTION("empty input")
+    {
+        REQUIRE(gunzip("", 1).empty());
+    }
+    SECTION("truncated input")
+    {
+        REQUIRE_THROWS_AS(gunzip(gz.substr(0, gz.size() / 2), 4096),
+                          std::runtime_error);
+    }
+    SECTION("corrupt input")
+    {
+        REQUIRE_THROWS_AS(gunzip("not gzip data", 4096), std::runtime_error);
+    }
+}
+
+#endif
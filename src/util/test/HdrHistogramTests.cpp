@@ -0,0 +1,115 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "lib/json/json.h"
+#include "test/Catch2.h"
+#include "util/HdrHistogram.h"
+#include <thread>
+#include <vector>
+
+using namespace stellar;
+
+TEST_CASE("hdr histogram buckets", "[hdrhistogram]")
+{
+    // Small values are counted exactly
+    for (uint64_t v = 0; v < HdrHistogram::SUB_BUCKET_COUNT; ++v)
+    {
+        REQUIRE(HdrHistogram::getBucketUpperBound(
+                    HdrHistogram::getBucketIndex(v)) == v);
+    }
+
+    // Buckets are contiguous and within the resolution of their values
+    uint64_t lower = 0;
+    for (size_t i = 0; i < HdrHistogram::BUCKET_COUNT; ++i)
+    {
+        auto upper = HdrHistogram::getBucketUpperBound(i);
+        REQUIRE(upper >= lower);
+        REQUIRE(HdrHistogram::getBucketIndex(lower) == i);
+        REQUIRE(HdrHistogram::getBucketIndex(upper) == i);
+        REQUIRE((upper - lower) * 64 <= lower);
+        lower = upper + 1;
+    }
+    REQUIRE(lower - 1 == HdrHistogram::MAX_VALUE);
+    REQUIRE(HdrHistogram::getBucketIndex(UINT64_MAX) ==
+            HdrHistogram::BUCKET_COUNT - 1);
+}
+
+TEST_CASE("hdr histogram quantiles", "[hdrhistogram]")
+{
+    HdrHistogram h;
+    REQUIRE(h.getSnapshot().count() == 0);
+    REQUIRE(h.getSnapshot().getValueAtQuantile(0.99) == 0);
+
+    for (uint64_t v = 1; v <= 100000; ++v)
+    {
+        h.record(v * 1000);
+    }
+    auto snap = h.getSnapshot();
+    REQUIRE(snap.count() == 100000);
+    REQUIRE(snap.min() == 1000);
+    REQUIRE(snap.max() == 100000000);
+    REQUIRE(snap.mean() == Approx(50000500.0));
+    for (double q : {0.5, 0.9, 0.99, 0.999, 0.9999})
+    {
+        REQUIRE(static_cast<double>(snap.getValueAtQuantile(q)) ==
+                Approx(q * 100000000).epsilon(0.02));
+    }
+    REQUIRE(snap.getValueAtQuantile(1.0) == 100000000);
+
+    h.clear();
+    REQUIRE(h.getSnapshot().count() == 0);
+}
+
+TEST_CASE("hdr histogram concurrent recording", "[hdrhistogram]")
+{
+    HdrHistogram h;
+    size_t const nThreads = HdrHistogram::STRIPE_COUNT + 3;
+    uint64_t const perThread = 10000;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < nThreads; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            for (uint64_t i = 0; i < perThread; ++i)
+            {
+                h.record(t * perThread + i);
+            }
+        });
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+    auto snap = h.getSnapshot();
+    auto total = nThreads * perThread;
+    REQUIRE(snap.count() == total);
+    REQUIRE(snap.sum() == total * (total - 1) / 2);
+    REQUIRE(snap.min() == 0);
+    REQUIRE(snap.max() == total - 1);
+}
+
+TEST_CASE("hdr timer registry", "[hdrhistogram]")
+{
+    HdrMetricsRegistry registry;
+    auto& timer = registry.NewTimer({"a", "b", "c"});
+    REQUIRE(&registry.NewTimer({"a", "b", "c"}) == &timer);
+    auto& other = registry.NewTimer({"d", "b", "c"});
+
+    timer.Update(std::chrono::milliseconds(3));
+    {
+        auto scope = other.TimeScope();
+    }
+    REQUIRE(timer.count() == 1);
+    REQUIRE(other.count() == 1);
+
+    Json::Value json;
+    timer.toJson(json);
+    REQUIRE(json["type"].asString() == "hdr-timer");
+    REQUIRE(json["count"].asUInt64() == 1);
+    REQUIRE(json["max"].asDouble() == Approx(3.0));
+
+    registry.clear("a");
+    REQUIRE(timer.count() == 0);
+    REQUIRE(other.count() == 1);
+    REQUIRE(registry.GetAllTimers().size() == 2);
+}
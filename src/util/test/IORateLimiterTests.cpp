@@ -0,0 +1,64 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/IORateLimiter.h"
+
+#include "test/Catch2.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace stellar;
+
+namespace
+{
+std::chrono::duration<double>
+timeToConsume(IORateLimiter& limiter, size_t bytes, size_t threads)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < threads; ++i)
+    {
+        readers.emplace_back([&]() {
+            // In chunks, the way index builds report their reads
+            for (size_t done = 0; done < bytes; done += 1024)
+            {
+                limiter.consume(1024);
+            }
+        });
+    }
+    for (auto& t : readers)
+    {
+        t.join();
+    }
+    return std::chrono::steady_clock::now() - start;
+}
+}
+
+TEST_CASE("IORateLimiter", "[util]")
+{
+    SECTION("unlimited")
+    {
+        IORateLimiter limiter(0);
+        REQUIRE(!limiter.isLimited());
+        REQUIRE(timeToConsume(limiter, 1024 * 1024 * 1024, 1).count() < 1);
+    }
+
+    SECTION("a second of budget is available up front")
+    {
+        IORateLimiter limiter(1024 * 1024);
+        REQUIRE(limiter.isLimited());
+        REQUIRE(timeToConsume(limiter, 512 * 1024, 1).count() < 0.25);
+    }
+
+    SECTION("readers share the budget")
+    {
+        IORateLimiter limiter(1024 * 1024);
+        // 1.5 MB in total: the first MB is the initial budget, the rest
+        // takes half a second
+        auto elapsed = timeToConsume(limiter, 384 * 1024, 4);
+        REQUIRE(elapsed.count() >= 0.4);
+        REQUIRE(elapsed.count() < 5);
+    }
+}
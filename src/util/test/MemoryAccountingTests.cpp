@@ -0,0 +1,67 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "test/Catch2.h"
+#include "util/MemoryAccounting.h"
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace stellar;
+
+TEST_CASE("memory accounting attributes allocations to scopes",
+          "[memoryaccounting]")
+{
+    if (!memoryaccounting::isEnabled())
+    {
+        REQUIRE(memoryaccounting::getUsage(MemorySubsystem::FLOODGATE)
+                    .mTotalAllocations == 0);
+        return;
+    }
+
+    auto before = memoryaccounting::getUsage(MemorySubsystem::FLOODGATE);
+    std::unique_ptr<std::vector<char>> kept;
+    {
+        MEMORY_ACCOUNTING_SCOPE(FLOODGATE);
+        kept = std::make_unique<std::vector<char>>(1000);
+        std::vector<char> freed(500);
+    }
+    auto during = memoryaccounting::getUsage(MemorySubsystem::FLOODGATE);
+    REQUIRE(during.mLiveBytes - before.mLiveBytes ==
+            static_cast<int64_t>(sizeof(std::vector<char>) + 1000));
+    REQUIRE(during.mLiveAllocations - before.mLiveAllocations == 2);
+    REQUIRE(during.mTotalAllocations - before.mTotalAllocations == 3);
+
+    // Frees are attributed to the subsystem of the allocation, whatever the
+    // thread and scope they happen in
+    std::thread([&]() { kept.reset(); }).join();
+    auto after = memoryaccounting::getUsage(MemorySubsystem::FLOODGATE);
+    REQUIRE(after.mLiveBytes == before.mLiveBytes);
+    REQUIRE(after.mLiveAllocations == before.mLiveAllocations);
+}
+
+TEST_CASE("memory accounting scopes nest", "[memoryaccounting]")
+{
+    if (!memoryaccounting::isEnabled())
+    {
+        return;
+    }
+
+    auto txq = memoryaccounting::getUsage(MemorySubsystem::TRANSACTION_QUEUE)
+                   .mTotalAllocations;
+    auto ltx = memoryaccounting::getUsage(MemorySubsystem::LEDGER_TXN)
+                   .mTotalAllocations;
+    {
+        MEMORY_ACCOUNTING_SCOPE(TRANSACTION_QUEUE);
+        {
+            MEMORY_ACCOUNTING_SCOPE(LEDGER_TXN);
+            auto inner = std::make_unique<int>(1);
+        }
+        auto outer = std::make_unique<int>(2);
+    }
+    REQUIRE(memoryaccounting::getUsage(MemorySubsystem::TRANSACTION_QUEUE)
+                .mTotalAllocations == txq + 1);
+    REQUIRE(memoryaccounting::getUsage(MemorySubsystem::LEDGER_TXN)
+                .mTotalAllocations == ltx + 1);
+}
@@ -0,0 +1,63 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "test/Catch2.h"
+#include "util/PoolAllocator.h"
+#include <array>
+#include <string>
+#include <thread>
+
+using namespace stellar;
+
+TEST_CASE("pool allocator recycles blocks", "[poolallocator]")
+{
+    auto startBytes = SmallBlockPool::getCachedBytes();
+
+    void* first = nullptr;
+    {
+        auto p = makePooledShared<std::string const>("pooled");
+        REQUIRE(*p == "pooled");
+        first = const_cast<std::string*>(p.get());
+    }
+    auto cachedBytes = SmallBlockPool::getCachedBytes();
+    REQUIRE(cachedBytes > startBytes);
+
+    // The freed block is reused by the next allocation of the same size
+    auto p = makePooledShared<std::string const>("again");
+    REQUIRE(p.get() == first);
+    REQUIRE(SmallBlockPool::getCachedBytes() < cachedBytes);
+}
+
+TEST_CASE("pool allocator containers", "[poolallocator]")
+{
+    PooledUnorderedMap<int, std::string> m;
+    for (int i = 0; i < 1000; ++i)
+    {
+        m.emplace(i, std::to_string(i));
+    }
+    m.erase(500);
+    REQUIRE(m.size() == 999);
+    REQUIRE(m.at(999) == "999");
+
+    auto beforeClear = SmallBlockPool::getCachedBytes();
+    m.clear();
+    REQUIRE(SmallBlockPool::getCachedBytes() > beforeClear);
+
+    // Large objects bypass the pool
+    auto big = makePooledShared<std::array<char, 4096>>();
+    auto cached = SmallBlockPool::getCachedBytes();
+    big.reset();
+    REQUIRE(SmallBlockPool::getCachedBytes() == cached);
+}
+
+TEST_CASE("pool allocator frees across threads", "[poolallocator]")
+{
+    std::shared_ptr<std::string> p;
+    std::thread t([&]() { p = makePooledShared<std::string>("other"); });
+    t.join();
+
+    auto cached = SmallBlockPool::getCachedBytes();
+    p.reset();
+    REQUIRE(SmallBlockPool::getCachedBytes() > cached);
+}
@@ -0,0 +1,103 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "medida/buckets.h"
+#include "medida/counter.h"
+#include "medida/meter.h"
+#include "medida/metrics_registry.h"
+#include "medida/timer.h"
+#include "test/Catch2.h"
+#include "util/HdrHistogram.h"
+#include "util/PrometheusExporter.h"
+
+using namespace stellar;
+
+namespace
+{
+bool
+contains(std::string const& text, std::string const& line)
+{
+    return text.find(line + "\n") != std::string::npos;
+}
+}
+
+TEST_CASE("prometheus exposition", "[prometheus]")
+{
+    medida::MetricsRegistry registry;
+    HdrMetricsRegistry hdrRegistry;
+    PrometheusExporter exporter;
+
+    registry.NewCounter({"overlay", "connection", "authenticated"})
+        .set_count(7);
+    registry.NewMeter({"ledger", "apply", "success"}, "tx").Mark(3);
+    registry.NewTimer({"ledger", "ledger", "close"})
+        .Update(std::chrono::milliseconds(250));
+    registry
+        .NewBuckets({"ledger", "age", "closed"}, {5000, 7000},
+                    std::chrono::milliseconds(1))
+        .Update(std::chrono::milliseconds(6000));
+    hdrRegistry.NewTimer({"overlay", "flood", "latency"})
+        .Update(std::chrono::milliseconds(2));
+
+    auto text = exporter.render(registry.GetAllMetrics(),
+                                hdrRegistry.GetAllTimers());
+
+    REQUIRE(contains(text, "# TYPE stellar_core_overlay_connection_"
+                           "authenticated gauge"));
+    REQUIRE(contains(text, "stellar_core_overlay_connection_authenticated 7"));
+    REQUIRE(contains(text,
+                     "# TYPE stellar_core_ledger_apply_success_total counter"));
+    REQUIRE(contains(text, "stellar_core_ledger_apply_success_total 3"));
+    REQUIRE(contains(text, "# TYPE stellar_core_ledger_ledger_close_"
+                           "seconds summary"));
+    REQUIRE(
+        contains(text, "stellar_core_ledger_ledger_close_seconds_sum 0.25"));
+    REQUIRE(
+        contains(text, "stellar_core_ledger_ledger_close_seconds_count 1"));
+    REQUIRE(contains(
+        text, "stellar_core_ledger_age_closed_seconds_bucket{le=\"5\"} 0"));
+    REQUIRE(contains(
+        text, "stellar_core_ledger_age_closed_seconds_bucket{le=\"7\"} 1"));
+    REQUIRE(contains(
+        text, "stellar_core_ledger_age_closed_seconds_bucket{le=\"+Inf\"} 1"));
+    REQUIRE(contains(text, "stellar_core_ledger_age_closed_seconds_count 1"));
+    REQUIRE(
+        contains(text, "stellar_core_overlay_flood_latency_seconds_count 1"));
+    REQUIRE(exporter.getLastRenderedCount() == 5);
+
+    SECTION("only changed metrics are rendered again")
+    {
+        REQUIRE(exporter.render(registry.GetAllMetrics(),
+                                hdrRegistry.GetAllTimers()) == text);
+        REQUIRE(exporter.getLastRenderedCount() == 0);
+
+        registry.NewMeter({"ledger", "apply", "success"}, "tx").Mark();
+        hdrRegistry.NewTimer({"overlay", "flood", "latency"})
+            .Update(std::chrono::milliseconds(3));
+        text = exporter.render(registry.GetAllMetrics(),
+                               hdrRegistry.GetAllTimers());
+        REQUIRE(exporter.getLastRenderedCount() == 2);
+        REQUIRE(contains(text, "stellar_core_ledger_apply_success_total 4"));
+        REQUIRE(contains(text,
+                         "stellar_core_overlay_flood_latency_seconds_count 2"));
+        REQUIRE(contains(text,
+                         "stellar_core_overlay_connection_authenticated 7"));
+    }
+
+    SECTION("removed metrics are dropped")
+    {
+        text = exporter.render({}, hdrRegistry.GetAllTimers());
+        REQUIRE(exporter.getLastRenderedCount() == 0);
+        REQUIRE(text.find("stellar_core_ledger") == std::string::npos);
+        REQUIRE(contains(
+            text, "stellar_core_overlay_flood_latency_seconds_count 1"));
+    }
+}
+
+TEST_CASE("prometheus metric names", "[prometheus]")
+{
+    REQUIRE(PrometheusExporter::toPrometheusName(
+                {"soroban", "host-fn-op", "read-entry"}) ==
+            "stellar_core_soroban_host_fn_op_read_entry");
+}
@@ -14,6 +14,8 @@
 #include "test/test.h"
 #include "util/Logging.h"
 #include <chrono>
+#include <fmt/format.h>
+#include <thread>
 
 using namespace stellar;
 
@@ -263,3 +265,45 @@ TEST_CASE("timer cancels", "[timer]")
     REQUIRE(timerFired == 8);
     REQUIRE(timerCancelled == 2);
 }
+
+TEST_CASE("actions posted from many threads all run in posting order",
+          "[timer]")
+{
+    VirtualClock clock(VirtualClock::REAL_TIME);
+    size_t const nThreads = 4;
+    size_t const nPerThread = 1000;
+    std::vector<std::vector<size_t>> ran(nThreads);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < nThreads; ++t)
+    {
+        threads.emplace_back([&clock, &ran, t, nPerThread]() {
+            for (size_t i = 0; i < nPerThread; ++i)
+            {
+                clock.postAction([&ran, t, i]() { ran[t].emplace_back(i); },
+                                 fmt::format("poster-{}", t),
+                                 Scheduler::ActionType::NORMAL_ACTION);
+            }
+        });
+    }
+    for (auto& th : threads)
+    {
+        th.join();
+    }
+    REQUIRE(clock.getPostedActionCount(Scheduler::ActionType::NORMAL_ACTION) ==
+            nThreads * nPerThread);
+    REQUIRE(clock.getPostWakeupCount() >= 1);
+    REQUIRE(clock.getPostWakeupCount() <= nThreads * nPerThread);
+
+    while (clock.getActionQueueSize() > 0)
+    {
+        clock.crank(false);
+    }
+    for (auto const& r : ran)
+    {
+        REQUIRE(r.size() == nPerThread);
+        for (size_t i = 0; i < nPerThread; ++i)
+        {
+            REQUIRE(r[i] == i);
+        }
+    }
+}
@@ -0,0 +1,100 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "lib/json/json.h"
+#include "test/Catch2.h"
+#include "util/TmpDir.h"
+#include "util/TraceCapture.h"
+
+#include <fstream>
+#include <thread>
+
+using namespace stellar;
+
+// Zones only reach the capture in builds configured with --enable-tracecapture
+#ifdef USE_TRACECAPTURE
+namespace
+{
+Json::Value
+readTrace(std::string const& path)
+{
+    std::ifstream in(path);
+    Json::Value res;
+    Json::Reader reader;
+    REQUIRE(reader.parse(in, res));
+    return res;
+}
+
+size_t
+countEvents(Json::Value const& trace, std::string const& name)
+{
+    size_t res = 0;
+    for (auto const& e : trace["traceEvents"])
+    {
+        if (e["ph"].asString() == "X" && e["name"].asString() == name)
+        {
+            ++res;
+        }
+    }
+    return res;
+}
+
+void
+tracedFunction()
+{
+    ZoneScoped;
+}
+}
+
+TEST_CASE("trace capture", "[tracecapture]")
+{
+    TmpDir tmp("tracecapture");
+    auto path = tmp.getName() + "/trace.json";
+
+    tracedFunction();
+    REQUIRE_THROWS_AS(tracecapture::stopAndWrite(path), std::runtime_error);
+
+    tracecapture::start();
+    REQUIRE_THROWS_AS(tracecapture::start(), std::runtime_error);
+    tracedFunction();
+    tracedFunction();
+    std::thread([] { ZoneScopedN("other thread"); }).join();
+    {
+        ZoneNamedN(inactiveZone, "inactive", false);
+    }
+    REQUIRE(tracecapture::stopAndWrite(path) == 3);
+    tracedFunction();
+
+    auto trace = readTrace(path);
+    REQUIRE(countEvents(trace, "tracedFunction") == 2);
+    REQUIRE(countEvents(trace, "other thread") == 1);
+    REQUIRE(countEvents(trace, "inactive") == 0);
+    for (auto const& e : trace["traceEvents"])
+    {
+        if (e["ph"].asString() == "X")
+        {
+            REQUIRE(e["dur"].asDouble() >= 0);
+            REQUIRE(e["args"]["line"].asUInt() > 0);
+        }
+    }
+
+    SECTION("a new capture starts empty")
+    {
+        tracecapture::start();
+        REQUIRE(tracecapture::stopAndWrite(path) == 0);
+        REQUIRE(readTrace(path)["traceEvents"].empty());
+    }
+
+    SECTION("only the last zones of a thread are kept")
+    {
+        tracecapture::start();
+        for (size_t i = 0; i < tracecapture::EVENTS_PER_THREAD + 10; ++i)
+        {
+            tracedFunction();
+        }
+        REQUIRE(tracecapture::stopAndWrite(path) ==
+                tracecapture::EVENTS_PER_THREAD);
+    }
+}
+#endif
@@ -0,0 +1,153 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "ledger/LedgerHashUtils.h"
+#include "ledger/test/LedgerTestUtils.h"
+#include "test/Catch2.h"
+#include "util/Logging.h"
+#include "util/Math.h"
+#include "util/UnorderedMap.h"
+#include <chrono>
+#include <map>
+#include <string>
+
+using namespace stellar;
+
+TEST_CASE("flat map matches reference map", "[unorderedmap]")
+{
+    UnorderedFlatMap<std::string, int> flat;
+    std::map<std::string, int> ref;
+
+    auto checkSame = [&]() {
+        REQUIRE(flat.size() == ref.size());
+        size_t n = 0;
+        for (auto const& [k, v] : flat)
+        {
+            REQUIRE(ref.at(k) == v);
+            ++n;
+        }
+        REQUIRE(n == ref.size());
+    };
+
+    for (int i = 0; i < 50000; ++i)
+    {
+        auto k = std::to_string(rand_uniform<int>(0, 2000));
+        switch (rand_uniform<int>(0, 4))
+        {
+        case 0:
+            REQUIRE(flat.erase(k) == ref.erase(k));
+            break;
+        case 1:
+        {
+            auto [it, inserted] = flat.emplace(k, i);
+            auto [refIt, refInserted] = ref.emplace(k, i);
+            REQUIRE(inserted == refInserted);
+            REQUIRE(it->second == refIt->second);
+            break;
+        }
+        case 2:
+            flat[k] = i;
+            ref[k] = i;
+            break;
+        case 3:
+        {
+            auto it = flat.find(k);
+            auto refIt = ref.find(k);
+            REQUIRE((it == flat.end()) == (refIt == ref.end()));
+            if (it != flat.end())
+            {
+                REQUIRE(it->second == refIt->second);
+            }
+            break;
+        }
+        default:
+            REQUIRE(flat.count(k) == ref.count(k));
+            break;
+        }
+    }
+    checkSame();
+
+    SECTION("erase while iterating")
+    {
+        for (auto it = flat.begin(); it != flat.end();)
+        {
+            if (it->second % 2 == 0)
+            {
+                ref.erase(it->first);
+                it = flat.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        checkSame();
+    }
+
+    SECTION("copy, move and swap")
+    {
+        auto copy = flat;
+        REQUIRE(copy == flat);
+
+        UnorderedFlatMap<std::string, int> moved(std::move(copy));
+        REQUIRE(moved == flat);
+        REQUIRE(copy.empty());
+
+        UnorderedFlatMap<std::string, int> other;
+        other.swap(moved);
+        REQUIRE(other == flat);
+        REQUIRE(moved.empty());
+    }
+
+    SECTION("clear and reuse")
+    {
+        flat.clear();
+        ref.clear();
+        checkSame();
+        REQUIRE(flat.begin() == flat.end());
+
+        flat.reserve(100);
+        for (int i = 0; i < 100; ++i)
+        {
+            flat[std::to_string(i)] = i;
+            ref[std::to_string(i)] = i;
+        }
+        checkSame();
+        REQUIRE_THROWS_AS(flat.at("missing"), std::out_of_range);
+    }
+}
+
+TEST_CASE("flat map bench", "[bench][unorderedmap][!hide]")
+{
+    auto keys =
+        LedgerTestUtils::generateValidUniqueLedgerEntryKeysWithExclusions(
+            {CONFIG_SETTING}, 20000);
+
+    auto run = [&](auto map, std::string const& name) {
+        auto start = std::chrono::steady_clock::now();
+        size_t found = 0;
+        for (int round = 0; round < 20; ++round)
+        {
+            map.clear();
+            for (auto const& k : keys)
+            {
+                map.emplace(k, round);
+            }
+            for (int lookups = 0; lookups < 4; ++lookups)
+            {
+                for (auto const& k : keys)
+                {
+                    found += map.find(k) != map.end();
+                }
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        REQUIRE(found == 20 * 4 * keys.size());
+        LOG_INFO(DEFAULT_LOG, "{}: {} per key", name,
+                 (end - start) / (20 * 5 * keys.size()));
+    };
+
+    run(UnorderedMap<LedgerKey, int>(), "UnorderedMap");
+    run(UnorderedFlatMap<LedgerKey, int>(), "UnorderedFlatMap");
+}
@@ -0,0 +1,86 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "ledger/test/LedgerTestUtils.h"
+#include "test/Catch2.h"
+#include "test/TxTests.h"
+#include "test/test.h"
+#include "transactions/TransactionUtils.h"
+#include "util/XDRCereal.h"
+#include "util/XDRJson.h"
+
+using namespace stellar;
+
+namespace
+{
+template <typename T>
+void
+checkMatchesCereal(T const& t, std::string const& name)
+{
+    REQUIRE(xdrToJson(t, name) == xdrToCerealString(t, name));
+    REQUIRE(xdrToJson(t, name, /* compact */ true) ==
+            xdrToCerealString(t, name, /* compact */ true));
+}
+}
+
+TEST_CASE("xdrToJson matches xdrToCerealString", "[xdrjson]")
+{
+    SECTION("ledger entries")
+    {
+        // Random SCAddresses may be of types neither writer supports
+        xdr::xvector<LedgerEntry> entries;
+        for (auto const& e :
+             LedgerTestUtils::generateValidUniqueLedgerEntriesWithTypes(
+                 {ACCOUNT, TRUSTLINE, OFFER, DATA, CLAIMABLE_BALANCE,
+                  LIQUIDITY_POOL, CONFIG_SETTING},
+                 100))
+        {
+            checkMatchesCereal(e, "entry");
+            checkMatchesCereal(LedgerEntryKey(e), "key");
+            entries.emplace_back(e);
+        }
+        checkMatchesCereal(entries, "entries");
+    }
+
+    SECTION("muxed accounts")
+    {
+        auto key = SecretKey::pseudoRandomForTesting();
+        MuxedAccount account(KEY_TYPE_MUXED_ED25519);
+        account.med25519().id = 0xFFFFFFFFFFFFFFFF;
+        account.med25519().ed25519 = key.getPublicKey().ed25519();
+        checkMatchesCereal(account, "account");
+        checkMatchesCereal(toMuxedAccount(key.getPublicKey()), "account");
+    }
+
+    SECTION("pool share assets")
+    {
+        ChangeTrustAsset asset(ASSET_TYPE_POOL_SHARE);
+        auto& cp = asset.liquidityPool().constantProduct();
+        cp.assetA =
+            txtest::makeAsset(SecretKey::pseudoRandomForTesting(), "USD");
+        cp.assetB.type(ASSET_TYPE_NATIVE);
+        cp.fee = 30;
+        checkMatchesCereal(asset, "asset");
+        checkMatchesCereal(TrustLineAsset(ASSET_TYPE_POOL_SHARE), "asset");
+    }
+
+    SECTION("strings with escapes and empty containers")
+    {
+        DataEntry data;
+        data.dataName = "a\"b\\c\n\x01\x7f\xc3\xa9";
+        checkMatchesCereal(data, "data");
+
+        AccountEntry account;
+        REQUIRE(account.signers.empty());
+        checkMatchesCereal(account, "account");
+    }
+}
+
+TEST_CASE("xdrToJson appends to its buffer", "[xdrjson]")
+{
+    auto entry = LedgerTestUtils::generateValidLedgerEntryWithTypes({ACCOUNT});
+    std::string out = "prefix";
+    xdrToJson(entry, "entry", out);
+    REQUIRE(out == "prefix" + xdrToCerealString(entry, "entry"));
+}
@@ -6,6 +6,7 @@
 #include "test/Catch2.h"
 #include "test/test.h"
 #include "util/Logging.h"
+#include "util/TmpDir.h"
 #include "util/XDRStream.h"
 #include <fmt/format.h>
 
@@ -93,3 +94,71 @@ TEST_CASE("XDROutputFileStream fsync bench", "[!hide][xdrstream][bench]")
                   elapsed.count());
     }
 }
+
+TEST_CASE("XDRInputFileStream buffered reads", "[xdrstream]")
+{
+    VirtualClock clock;
+    TmpDir tmp("xdrstream");
+    auto filename = tmp.getName() + "/entries.xdr";
+
+    auto ledgerEntries = LedgerTestUtils::generateValidLedgerEntries(2000);
+    auto bucketEntries =
+        LiveBucket::convertToBucketEntry(false, {}, ledgerEntries, {});
+    std::vector<size_t> offsets;
+    SHA256 writeHasher;
+    {
+        XDROutputFileStream out(clock.getIOContext(), /*doFsync=*/false);
+        out.open(filename);
+        size_t bytes = 0;
+        for (auto const& e : bucketEntries)
+        {
+            offsets.emplace_back(bytes);
+            out.writeOne(e, &writeHasher, &bytes);
+        }
+        out.close();
+    }
+    auto writeHash = writeHasher.finish();
+
+    // Buffers smaller than some of the entries, and large enough for the whole
+    // file, with and without read-ahead
+    for (size_t bufferSize : {size_t(8192), size_t(64 * 1024),
+                              BufferedFileReader::DEFAULT_BUFFER_SIZE})
+    {
+        for (bool sequential : {true, false})
+        {
+            XDRInputFileStream in(0, sequential, bufferSize);
+            in.open(filename);
+            SHA256 readHasher;
+            BucketEntry be;
+            for (size_t i = 0; i < bucketEntries.size(); ++i)
+            {
+                REQUIRE(static_cast<size_t>(in.pos()) == offsets[i]);
+                REQUIRE(in.readOne(be, &readHasher));
+                REQUIRE(be == bucketEntries[i]);
+            }
+            REQUIRE(static_cast<size_t>(in.pos()) == in.size());
+            REQUIRE(!in.readOne(be));
+            REQUIRE(!in);
+            REQUIRE(readHasher.finish() == writeHash);
+
+            // Backwards and forwards seeks, within and outside the buffer
+            for (size_t i : {size_t(1500), size_t(3), size_t(4),
+                             size_t(1999), size_t(0), size_t(1000)})
+            {
+                in.seek(offsets[i]);
+                REQUIRE(in);
+                REQUIRE(in.readOne(be));
+                REQUIRE(be == bucketEntries[i]);
+            }
+
+            // Pages find entries that start in them, and only those
+            auto key = getBucketLedgerKey(bucketEntries[1234]);
+            in.seek(offsets[1200]);
+            REQUIRE(in.readPage(be, key, offsets[1235] - offsets[1200]));
+            REQUIRE(be == bucketEntries[1234]);
+            in.seek(offsets[1200]);
+            REQUIRE(!in.readPage(be, key, offsets[1234] - offsets[1200]));
+            in.close();
+        }
+    }
+}
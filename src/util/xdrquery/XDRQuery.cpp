@@ -10,6 +10,35 @@ XDRMatcher::XDRMatcher(std::string const& query) : mQuery(query)
 {
 }
 
+void
+XDRMatcher::compileLedgerEntryTypes()
+{
+    using DataT = decltype(stellar::LedgerEntry::data);
+    std::set<std::string> arms;
+    for (auto type : DataT::_xdr_case_values())
+    {
+        if (auto name = xdr::xdr_traits<DataT>::union_field_name(type))
+        {
+            arms.emplace(name);
+        }
+    }
+
+    auto required = mEvalRoot->getRequiredArms("data", arms);
+    if (!required)
+    {
+        return;
+    }
+    mLedgerEntryTypes.emplace();
+    for (auto type : DataT::_xdr_case_values())
+    {
+        auto name = xdr::xdr_traits<DataT>::union_field_name(type);
+        if (name && required->count(name) != 0)
+        {
+            mLedgerEntryTypes->emplace_back(type);
+        }
+    }
+}
+
 XDRFieldExtractor::XDRFieldExtractor(std::string const& query) : mQuery(query)
 {
 }
@@ -8,30 +8,43 @@
 #include "util/xdrquery/XDRQueryEval.h"
 #include "util/xdrquery/XDRQueryParser.h"
 
+#include <algorithm>
 #include <string>
 #include <variant>
+#include <vector>
 
 namespace xdrquery
 {
 
+// Per-message cache of resolved fields, indexed by field slot.
+using FieldCache = std::vector<std::optional<ResultType>>;
+
 // Concrete implementation of DynamicXDRGetter for a given XDR message type T.
+// When given a cache, each field slot is only resolved once.
 template <typename T>
 class TypedDynamicXDRGetterResolver : public DynamicXDRGetter
 {
   public:
-    TypedDynamicXDRGetterResolver(T const& xdrMessage, bool validate)
-        : mXdrMessage(xdrMessage), mValidate(validate)
+    TypedDynamicXDRGetterResolver(T const& xdrMessage, bool validate,
+                                  FieldCache* fieldCache = nullptr)
+        : mXdrMessage(xdrMessage), mValidate(validate), mFieldCache(fieldCache)
     {
     }
 
     ResultType
-    getField(std::vector<std::string> const& fieldPath) const override
+    getField(std::vector<std::string> const& fieldPath,
+             size_t slot) const override
     {
-        if (mValidate)
+        if (mFieldCache == nullptr || slot >= mFieldCache->size())
         {
-            return getXDRFieldValidated(mXdrMessage, fieldPath);
+            return resolve(fieldPath);
         }
-        return getXDRField(mXdrMessage, fieldPath);
+        auto& cached = (*mFieldCache)[slot];
+        if (!cached)
+        {
+            cached = resolve(fieldPath);
+        }
+        return *cached;
     }
 
     uint64_t
@@ -43,24 +56,30 @@ class TypedDynamicXDRGetterResolver : public DynamicXDRGetter
     ~TypedDynamicXDRGetterResolver() override = default;
 
   private:
+    ResultType
+    resolve(std::vector<std::string> const& fieldPath) const
+    {
+        if (mValidate)
+        {
+            return getXDRFieldValidated(mXdrMessage, fieldPath);
+        }
+        return getXDRField(mXdrMessage, fieldPath);
+    }
+
     T const& mXdrMessage;
     bool mValidate;
+    FieldCache* mFieldCache;
 };
 
-template <typename T>
-std::unique_ptr<DynamicXDRGetter>
-createXDRGetter(T const& xdrMessage, bool validate)
-{
-    return std::make_unique<TypedDynamicXDRGetterResolver<T>>(xdrMessage,
-                                                              validate);
-}
-
 // Helper to match multiple XDR messages of the same type using the provided
 // query.
 // Queries may consist of literals, XDR fields, comparisons and boolean
 // operations, e.g.
 // `data.account.balance >= 100000 || data.trustLine.balance < 5000`
 // See more examples in `XDRQueryTests`.
+// The query is compiled on first use: fields used several times are only
+// resolved once per message, and when matching `LedgerEntry`s, entries of
+// types the query can't match are rejected without resolving any field.
 class XDRMatcher
 {
   public:
@@ -84,13 +103,37 @@ class XDRMatcher
                 throw XDRQueryError("The query doesn't evaluate to bool.");
             }
             mEvalRoot = std::get<std::shared_ptr<BoolEvalNode>>(statement);
+            mFieldCache.resize(compileFields(*mEvalRoot));
+            if constexpr (std::is_same_v<T, stellar::LedgerEntry>)
+            {
+                compileLedgerEntryTypes();
+            }
+        }
+        else if constexpr (std::is_same_v<T, stellar::LedgerEntry>)
+        {
+            // The first entry is always evaluated so that the query gets
+            // validated.
+            if (mLedgerEntryTypes &&
+                std::find(mLedgerEntryTypes->begin(), mLedgerEntryTypes->end(),
+                          xdrMessage.data.type()) == mLedgerEntryTypes->end())
+            {
+                return false;
+            }
         }
-        return mEvalRoot->evalBool(*createXDRGetter(xdrMessage, firstEval));
+        std::fill(mFieldCache.begin(), mFieldCache.end(), std::nullopt);
+        TypedDynamicXDRGetterResolver<T> getter(xdrMessage, firstEval,
+                                                &mFieldCache);
+        return mEvalRoot->evalBool(getter);
     }
 
   private:
+    // Finds the entry types the query can match, if it doesn't match all.
+    void compileLedgerEntryTypes();
+
     std::string const mQuery;
     std::shared_ptr<BoolEvalNode> mEvalRoot;
+    FieldCache mFieldCache;
+    std::optional<std::vector<stellar::LedgerEntryType>> mLedgerEntryTypes;
 };
 
 // Helper to extract leaf fields from multiple XDR messages using the provided
@@ -121,7 +164,8 @@ class XDRFieldExtractor
             }
             mFieldList = std::get<std::shared_ptr<ColumnList>>(statement);
         }
-        return mFieldList->getValues(*createXDRGetter(xdrMessage, firstEval));
+        TypedDynamicXDRGetterResolver<T> getter(xdrMessage, firstEval);
+        return mFieldList->getValues(getter);
     }
 
     // Gets names of the fields from the query.
@@ -164,7 +208,8 @@ class XDRAccumulator
             mAccumulatorList =
                 std::get<std::shared_ptr<AccumulatorList>>(statement);
         }
-        mAccumulatorList->addEntry(*createXDRGetter(xdrMessage, firstEval));
+        TypedDynamicXDRGetterResolver<T> getter(xdrMessage, firstEval);
+        mAccumulatorList->addEntry(getter);
     }
 
     // Gets the accumulators with aggregated values of each field.
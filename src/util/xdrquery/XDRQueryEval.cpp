@@ -5,9 +5,55 @@
 #include "util/xdrquery/XDRQueryEval.h"
 #include "fmt/format.h"
 #include "util/xdrquery/XDRQueryError.h"
+#include <algorithm>
+#include <iterator>
+#include <map>
 
 namespace xdrquery
 {
+namespace
+{
+FieldNameSet
+intersectNames(FieldNameSet const& a, FieldNameSet const& b)
+{
+    if (!a)
+    {
+        return b;
+    }
+    if (!b)
+    {
+        return a;
+    }
+    std::set<std::string> res;
+    std::set_intersection(a->begin(), a->end(), b->begin(), b->end(),
+                          std::inserter(res, res.end()));
+    return res;
+}
+
+FieldNameSet
+uniteNames(FieldNameSet a, FieldNameSet const& b)
+{
+    if (!a || !b)
+    {
+        return std::nullopt;
+    }
+    a->insert(b->begin(), b->end());
+    return a;
+}
+}
+
+void
+EvalNode::forEachField(std::function<void(FieldNode&)> const& f)
+{
+}
+
+FieldNameSet
+EvalNode::getRequiredArms(std::string const& parent,
+                          std::set<std::string> const& unionArms) const
+{
+    return std::nullopt;
+}
+
 bool
 NullField::operator==(NullField other) const
 {
@@ -132,7 +178,7 @@ FieldNode::FieldNode(std::string const& initField)
 ResultType
 FieldNode::eval(DynamicXDRGetter const& xdrGetter) const
 {
-    return xdrGetter.getField(mFieldPath);
+    return xdrGetter.getField(mFieldPath, mSlot);
 }
 
 EvalNodeType
@@ -147,6 +193,24 @@ FieldNode::getName() const
     return fmt::to_string(fmt::join(mFieldPath, "."));
 }
 
+void
+FieldNode::forEachField(std::function<void(FieldNode&)> const& f)
+{
+    f(*this);
+}
+
+FieldNameSet
+FieldNode::getRequiredArms(std::string const& parent,
+                           std::set<std::string> const& unionArms) const
+{
+    if (mFieldPath.size() > 1 && mFieldPath[0] == parent &&
+        unionArms.count(mFieldPath[1]) != 0)
+    {
+        return std::set<std::string>{mFieldPath[1]};
+    }
+    return std::nullopt;
+}
+
 ResultType
 EntrySizeNode::eval(DynamicXDRGetter const& xdrGetter) const
 {
@@ -196,6 +260,28 @@ BoolOpNode::getType() const
     return EvalNodeType();
 }
 
+void
+BoolOpNode::forEachField(std::function<void(FieldNode&)> const& f)
+{
+    mLeft->forEachField(f);
+    mRight->forEachField(f);
+}
+
+FieldNameSet
+BoolOpNode::getRequiredArms(std::string const& parent,
+                            std::set<std::string> const& unionArms) const
+{
+    auto left = mLeft->getRequiredArms(parent, unionArms);
+    auto right = mRight->getRequiredArms(parent, unionArms);
+    switch (mType)
+    {
+    case BoolOpNodeType::AND:
+        return intersectNames(left, right);
+    case BoolOpNodeType::OR:
+        return uniteNames(std::move(left), right);
+    }
+}
+
 ComparisonNode::ComparisonNode(ComparisonNodeType nodeType,
                                std::shared_ptr<EvalNode> left,
                                std::shared_ptr<EvalNode> right)
@@ -295,6 +381,22 @@ ComparisonNode::getType() const
     return EvalNodeType::COMPARISON_OP;
 }
 
+void
+ComparisonNode::forEachField(std::function<void(FieldNode&)> const& f)
+{
+    mLeft->forEachField(f);
+    mRight->forEachField(f);
+}
+
+FieldNameSet
+ComparisonNode::getRequiredArms(std::string const& parent,
+                                std::set<std::string> const& unionArms) const
+{
+    // Comparisons with a value that is not defined are always false
+    return intersectNames(mLeft->getRequiredArms(parent, unionArms),
+                          mRight->getRequiredArms(parent, unionArms));
+}
+
 bool
 ComparisonNode::compareNullFields(bool leftIsNull, bool rightIsNull) const
 {
@@ -479,6 +581,17 @@ ColumnList::getColumnNames() const
     return names;
 }
 
+size_t
+compileFields(EvalNode& root)
+{
+    std::map<std::vector<std::string>, size_t> slots;
+    root.forEachField([&slots](FieldNode& field) {
+        auto slot = slots.size();
+        field.mSlot = slots.emplace(field.mFieldPath, slot).first->second;
+    });
+    return slots.size();
+}
+
 inline std::string
 format_as(const NullField&)
 {
@@ -7,6 +7,7 @@
 #include <functional>
 #include <memory>
 #include <optional>
+#include <set>
 #include <stdexcept>
 #include <string>
 #include <variant>
@@ -41,12 +42,17 @@ using ResultValueType = std::variant<NullField, bool, int32_t, uint32_t,
 // when an XDR union has an alternative selected that is not in the field path.
 using ResultType = std::optional<ResultValueType>;
 
+// Marks a field that has not been assigned a slot by `compileFields`.
+size_t constexpr NO_FIELD_SLOT = static_cast<size_t>(-1);
+
 // An interface for getting information from XDR structs.
 struct DynamicXDRGetter
 {
-    // Gets a field specified by the provided path.
-    virtual ResultType
-    getField(std::vector<std::string> const& fieldPath) const = 0;
+    // Gets a field specified by the provided path. Fields sharing a `slot`
+    // other than NO_FIELD_SLOT are the same field, so getters may resolve it
+    // only once per struct.
+    virtual ResultType getField(std::vector<std::string> const& fieldPath,
+                                size_t slot) const = 0;
 
     // Gets the serialized XDR size of the entire struct.
     virtual uint64_t getSize() const = 0;
@@ -56,6 +62,11 @@ struct DynamicXDRGetter
 
 std::string resultToString(ResultValueType const& result);
 
+// Set of field names, where std::nullopt stands for any name.
+using FieldNameSet = std::optional<std::set<std::string>>;
+
+struct FieldNode;
+
 enum class EvalNodeType
 {
     LITERAL,
@@ -70,6 +81,17 @@ struct EvalNode
     virtual ResultType eval(DynamicXDRGetter const& xdrGetter) const = 0;
     virtual EvalNodeType getType() const = 0;
 
+    // Calls `f` on every XDR field node of the expression.
+    virtual void forEachField(std::function<void(FieldNode&)> const& f);
+
+    // Returns the names that the field following `parent` in a field path
+    // must have for this expression to evaluate to a value (or to `true` for
+    // bool expressions). Only the names in `unionArms` are considered, since
+    // only an unselected union arm makes a field evaluate to std::nullopt.
+    virtual FieldNameSet
+    getRequiredArms(std::string const& parent,
+                    std::set<std::string> const& unionArms) const;
+
     virtual ~EvalNode() = default;
 };
 
@@ -117,7 +139,14 @@ struct FieldNode : public ColumnNode
 
     virtual std::string getName() const override;
 
+    void forEachField(std::function<void(FieldNode&)> const& f) override;
+
+    FieldNameSet
+    getRequiredArms(std::string const& parent,
+                    std::set<std::string> const& unionArms) const override;
+
     std::vector<std::string> mFieldPath;
+    size_t mSlot = NO_FIELD_SLOT;
 };
 
 // Node representing the size of an XDR entry in expression.
@@ -154,6 +183,12 @@ struct BoolOpNode : public BoolEvalNode
 
     EvalNodeType getType() const override;
 
+    void forEachField(std::function<void(FieldNode&)> const& f) override;
+
+    FieldNameSet
+    getRequiredArms(std::string const& parent,
+                    std::set<std::string> const& unionArms) const override;
+
   private:
     BoolOpNodeType mType;
     std::shared_ptr<BoolEvalNode> mLeft;
@@ -180,6 +215,12 @@ struct ComparisonNode : public BoolEvalNode
 
     EvalNodeType getType() const override;
 
+    void forEachField(std::function<void(FieldNode&)> const& f) override;
+
+    FieldNameSet
+    getRequiredArms(std::string const& parent,
+                    std::set<std::string> const& unionArms) const override;
+
   private:
     bool compareNullFields(bool leftIsNull, bool rightIsNull) const;
 
@@ -242,6 +283,10 @@ struct ColumnList
     std::vector<std::shared_ptr<ColumnNode>> mColumns;
 };
 
+// Assigns the same slot to all the nodes of `root` referring to the same field
+// and returns the number of distinct fields.
+size_t compileFields(EvalNode& root);
+
 using XDRQueryStatement =
     std::variant<std::shared_ptr<BoolEvalNode>,
                  std::shared_ptr<AccumulatorList>, std::shared_ptr<ColumnList>>;
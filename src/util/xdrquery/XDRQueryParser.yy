@@ -157,6 +157,8 @@ column_list: column { $$ = std::make_shared<ColumnList>(std::move($1)); }
 #include <sanitizer/lsan_interface.h>   
 #endif
 
+#include <mutex>
+
 void beginScan(char const* s);
 void endScan();
 
@@ -171,6 +173,11 @@ XDRQueryParser::error(std::string const& error)
 XDRQueryStatement
 parseXDRQuery(std::string const& query)
 {
+    // The scanner keeps its state in globals, so only one query can be
+    // parsed at a time.
+    static std::mutex parseMutex;
+    std::lock_guard<std::mutex> lock(parseMutex);
+
     // LeakSantizer (likely) incorrectly identifies some small leaks in 
     // lexer, hence disable it for the query parsing. According
     // to the docs, calling `yylex_destoy` should be enough to do the proper
@@ -7,6 +7,7 @@
 #include "xdr/Stellar-ledger-entries.h"
 
 #include <algorithm>
+#include <set>
 #include <lib/catch.hpp>
 
 namespace xdrquery
@@ -466,6 +467,52 @@ TEST_CASE("XDR matcher", "[xdrquery]")
     }
 }
 
+TEST_CASE("XDR matcher compilation", "[xdrquery]")
+{
+    auto parse = [](std::string const& query) {
+        return std::get<std::shared_ptr<BoolEvalNode>>(parseXDRQuery(query));
+    };
+    std::set<std::string> const arms = {"account", "offer", "trustLine"};
+
+    SECTION("repeated fields share a slot")
+    {
+        auto root = parse("data.account.balance > 1 && "
+                          "data.account.balance < 5 || data.type == 'OFFER'");
+        REQUIRE(compileFields(*root) == 2);
+    }
+
+    SECTION("required arms")
+    {
+        auto requiredArms = [&](std::string const& query) {
+            return parse(query)->getRequiredArms("data", arms);
+        };
+        using Names = std::set<std::string>;
+
+        REQUIRE(requiredArms("data.account.balance > 1") == Names{"account"});
+        REQUIRE(requiredArms("data.type == 'OFFER'") == std::nullopt);
+        REQUIRE(requiredArms("entry_size() > 100") == std::nullopt);
+        REQUIRE(requiredArms("data.account.balance > 1 || "
+                             "data.offer.amount > 1") ==
+                Names{"account", "offer"});
+        REQUIRE(requiredArms("data.account.balance > 1 || "
+                             "entry_size() > 100") == std::nullopt);
+        REQUIRE(requiredArms("data.type != 'OFFER' && "
+                             "data.offer.amount > 1") == Names{"offer"});
+        REQUIRE(requiredArms("data.account.balance > 1 && "
+                             "data.offer.amount > 1") == Names{});
+    }
+
+    SECTION("matching skips other entry types")
+    {
+        XDRMatcher matcher("data.account.balance == 100 && "
+                           "data.account.balance != 200");
+        REQUIRE(matcher.matchXDR(makeAccountEntry(100)));
+        REQUIRE(!matcher.matchXDR(makeOfferEntry("foo")));
+        REQUIRE(!matcher.matchXDR(makeAccountEntry(200)));
+        REQUIRE(matcher.matchXDR(makeAccountEntry(100)));
+    }
+}
+
 TEST_CASE("XDR field extractor", "[xdrquery]")
 {
     std::vector<LedgerEntry> entries = {makeAccountEntry(100),
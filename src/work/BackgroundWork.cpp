@@ -0,0 +1,104 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "work/BackgroundWork.h"
+#include "util/GlobalChecks.h"
+#include "util/Logging.h"
+#include <Tracy.hpp>
+
+namespace stellar
+{
+
+BackgroundWork::BackgroundWork(Application& app, std::string name,
+                               size_t maxRetries, BackgroundWorkClass cls)
+    : BasicWork(app, std::move(name), maxRetries), mClass(cls)
+{
+}
+
+BasicWork::State
+BackgroundWork::onBackgroundDone(State result)
+{
+    return result;
+}
+
+BasicWork::State
+BackgroundWork::onRun()
+{
+    if (mResult)
+    {
+        auto result = *mResult;
+        mResult.reset();
+        return onBackgroundDone(result);
+    }
+    if (!mInFlight)
+    {
+        postStep();
+    }
+    return State::WORK_WAITING;
+}
+
+bool
+BackgroundWork::onAbort()
+{
+    // The step may still be using the work's members
+    return !mInFlight;
+}
+
+void
+BackgroundWork::onReset()
+{
+    releaseAssert(!mInFlight);
+    mResult.reset();
+}
+
+void
+BackgroundWork::postStep()
+{
+    mInFlight = true;
+    std::weak_ptr<BackgroundWork> weak(
+        std::static_pointer_cast<BackgroundWork>(shared_from_this()));
+    mApp.postOnBackgroundThread(
+        [weak]() {
+            auto self = weak.lock();
+            if (!self)
+            {
+                return;
+            }
+
+            auto result = State::WORK_FAILURE;
+            if (!self->isAborting())
+            {
+                ZoneScoped;
+                ZoneText(self->getName().c_str(), self->getName().size());
+                try
+                {
+                    result = self->runInBackground();
+                }
+                catch (std::exception const& e)
+                {
+                    CLOG_ERROR(Work, "{} failed in background: {}",
+                               self->getName(), e.what());
+                    result = State::WORK_FAILURE;
+                }
+                releaseAssert(result != State::WORK_WAITING);
+            }
+
+            // Hand our reference to the main thread so the work isn't
+            // destroyed here
+            auto& app = self->mApp;
+            auto name = self->getName() + ": background step done";
+            app.postOnMainThread(
+                [self = std::move(self), result]() {
+                    self->mInFlight = false;
+                    if (!self->isAborting())
+                    {
+                        self->mResult = result;
+                        self->wakeUp();
+                    }
+                },
+                std::move(name));
+        },
+        getName() + ": background step", mClass);
+}
+}
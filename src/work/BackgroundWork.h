@@ -0,0 +1,56 @@
+// Copyright 2025 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+#pragma once
+
+#include "work/BasicWork.h"
+#include <optional>
+
+namespace stellar
+{
+
+/**
+ * BackgroundWork is a BasicWork whose step runs on a worker thread instead of
+ * the main thread. Implementers override `runInBackground`, which does the
+ * CPU- or IO-heavy part of the work and returns what `onRun` would have.
+ * While it runs the work is WAITING, so the main thread and any siblings keep
+ * going; when it returns, the outcome is posted back to the main thread,
+ * handed to `onBackgroundDone` and the work wakes up with it. Independent
+ * BackgroundWorks added as children of the same Work (or yielded by a
+ * BatchWork) therefore run in parallel across the worker threads.
+ *
+ * `runInBackground` runs concurrently with the main thread, so it may only
+ * use members that nothing on the main thread touches until it returns, and
+ * const queries of the work's state such as `isAborting`. Returning
+ * WORK_RUNNING runs it again in the background; WORK_WAITING is not allowed
+ * as there is nobody on the worker thread to wake the work back up.
+ *
+ * Only one step is ever in flight. Shutting the work down while a step runs
+ * waits for the step to finish, and its outcome is then dropped.
+ */
+class BackgroundWork : public BasicWork
+{
+  public:
+    BackgroundWork(Application& app, std::string name, size_t maxRetries,
+                   BackgroundWorkClass cls);
+
+  protected:
+    virtual State runInBackground() = 0;
+
+    // Runs on the main thread once `runInBackground` returned `result`, if the
+    // work isn't aborting. The default just passes the result on.
+    virtual State onBackgroundDone(State result);
+
+    State onRun() final;
+    bool onAbort() override;
+    // Implementers overriding this must call it
+    void onReset() override;
+
+  private:
+    BackgroundWorkClass const mClass;
+    bool mInFlight{false};
+    std::optional<State> mResult;
+
+    void postStep();
+};
+}
@@ -61,6 +61,12 @@ BatchWork::doWork()
     return State::WORK_RUNNING;
 }
 
+size_t
+BatchWork::getMaxBatchSize() const
+{
+    return mApp.getConfig().MAX_CONCURRENT_SUBPROCESSES;
+}
+
 void
 BatchWork::addMoreWorkIfNeeded()
 {
@@ -70,7 +76,7 @@ BatchWork::addMoreWorkIfNeeded()
         throw std::runtime_error(getName() + " is being aborted!");
     }
 
-    size_t nChildren = mApp.getConfig().MAX_CONCURRENT_SUBPROCESSES;
+    size_t nChildren = getMaxBatchSize();
     while (mBatch.size() < nChildren && hasNext())
     {
         auto w = yieldMoreWork();
@@ -15,6 +15,7 @@ namespace stellar
    * Terminate with a failure if _any_ child work failed
    * Finish only if all children finished
    * Add more more if number of running children is less than bandwidth
+     (MAX_CONCURRENT_SUBPROCESSES, unless the child class says otherwise)
 **/
 class BatchWork : public Work
 {
@@ -41,5 +42,8 @@ class BatchWork : public Work
     virtual bool hasNext() const = 0;
     virtual std::shared_ptr<BasicWork> yieldMoreWork() = 0;
     virtual void resetIter() = 0;
+
+    // How many children may be in the batch at once
+    virtual size_t getMaxBatchSize() const;
 };
 }
@@ -7,13 +7,16 @@
 #include "test/Catch2.h"
 #include "test/TestUtils.h"
 #include "test/test.h"
+#include "util/GlobalChecks.h"
 #include "work/WorkScheduler.h"
 #include <fmt/format.h>
 
 #include "historywork/RunCommandWork.h"
+#include "work/BackgroundWork.h"
 #include "work/BatchWork.h"
 #include "work/ConditionalWork.h"
 
+#include <atomic>
 #include <thread>
 
 using namespace stellar;
@@ -416,6 +419,108 @@ TEST_CASE("work with children", "[work]")
     }
 }
 
+// ======= BackgroundWork tests ======== //
+class TestBackgroundWork : public BackgroundWork
+{
+    bool const mShouldFail;
+    size_t mSteps;
+
+  public:
+    std::atomic<size_t> mBackgroundSteps{0};
+    std::atomic<bool> mRanOnMainThread{false};
+    size_t mDoneCount{0};
+
+    TestBackgroundWork(Application& app, std::string name, bool fail = false,
+                       size_t steps = 2)
+        : BackgroundWork(app, std::move(name), BasicWork::RETRY_NEVER,
+                         BackgroundWorkClass::MERGE)
+        , mShouldFail(fail)
+        , mSteps(steps)
+    {
+    }
+
+  protected:
+    State
+    runInBackground() override
+    {
+        if (threadIsMain())
+        {
+            mRanOnMainThread = true;
+        }
+        ++mBackgroundSteps;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        if (--mSteps > 0)
+        {
+            return State::WORK_RUNNING;
+        }
+        return mShouldFail ? State::WORK_FAILURE : State::WORK_SUCCESS;
+    }
+
+    State
+    onBackgroundDone(State result) override
+    {
+        REQUIRE(threadIsMain());
+        ++mDoneCount;
+        return result;
+    }
+};
+
+TEST_CASE("background work", "[work]")
+{
+    VirtualClock clock;
+    Application::pointer appPtr = createTestApplication(clock, getTestConfig());
+    auto& wm = appPtr->getWorkScheduler();
+
+    auto w = wm.scheduleWork<TestWork>("test-work");
+    std::vector<std::shared_ptr<TestBackgroundWork>> children;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        children.emplace_back(w->addTestWork<TestBackgroundWork>(
+            fmt::format("background-{:d}", i)));
+    }
+
+    SECTION("success")
+    {
+        while (!wm.allChildrenDone())
+        {
+            clock.crank();
+        }
+        REQUIRE(w->getState() == BasicWork::State::WORK_SUCCESS);
+        for (auto const& c : children)
+        {
+            REQUIRE(c->getState() == BasicWork::State::WORK_SUCCESS);
+            REQUIRE(c->mBackgroundSteps == 2);
+            REQUIRE(c->mDoneCount == 2);
+            REQUIRE(!c->mRanOnMainThread);
+        }
+    }
+    SECTION("failure")
+    {
+        auto f = w->addTestWork<TestBackgroundWork>("background-fail", true, 1);
+        while (!wm.allChildrenDone())
+        {
+            clock.crank();
+        }
+        REQUIRE(f->getState() == BasicWork::State::WORK_FAILURE);
+        REQUIRE(w->getState() == BasicWork::State::WORK_FAILURE);
+    }
+    SECTION("shutdown")
+    {
+        // Let the first steps get posted
+        clock.crank(false);
+        wm.shutdown();
+        while (!wm.allChildrenDone())
+        {
+            clock.crank();
+        }
+        REQUIRE(w->getState() == BasicWork::State::WORK_ABORTED);
+        for (auto const& c : children)
+        {
+            REQUIRE(c->getState() == BasicWork::State::WORK_ABORTED);
+        }
+    }
+}
+
 TEST_CASE("work scheduling and run count", "[work]")
 {
     VirtualClock clock;